@@ -2,6 +2,9 @@
   Bruce A. Maxwell
   January 2025
   Depth Anything V2 Network wrapper using ONNX Runtime with CUDA GPU support.
+  Input and output tensors are persistent and bound through IoBinding, so
+  per-frame inference performs no heap allocation. The execution provider
+  chain and the Ort::Env come from the shared cvcore inference runtime.
 */
 #ifndef DA2NETWORK_HPP
 #define DA2NETWORK_HPP
@@ -14,169 +17,347 @@
 #include <vector>
 #include <iostream>
 #include <onnxruntime_cxx_api.h>
+#include <cvcore/inference.hpp>
 #include <opencv2/opencv.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+/*
+  Execution providers, tried in the order given in DA2Options::providers.
+  Providers that are not compiled into the linked ONNX Runtime are skipped;
+  the CPU provider is always available and ends every chain.
+*/
+enum DA2Provider {
+  DA2_PROVIDER_TENSORRT,
+  DA2_PROVIDER_CUDA,
+  DA2_PROVIDER_OPENVINO,
+  DA2_PROVIDER_CPU
+};
+
+struct DA2Options {
+  std::vector<DA2Provider> providers{DA2_PROVIDER_CUDA, DA2_PROVIDER_CPU};
+  int device_id = 0;
+  std::string trt_cache_dir = "trt_cache";  // TensorRT engine cache
+  bool trt_fp16 = true;
+  bool trt_int8 = false;                    // needs a calibrated/QDQ model
+  std::string openvino_device = "CPU";
+  int intra_op_threads = 0;                 // 0 = ONNX Runtime default
+
+  /*
+    Parses a comma separated provider list, e.g. "tensorrt,cuda,cpu".
+    Unknown names are ignored. Returns false if nothing was recognised.
+  */
+  bool parseProviders(const std::string &list) {
+    std::vector<DA2Provider> parsed;
+    size_t start = 0;
+    while(start <= list.size()) {
+      size_t end = list.find(',', start);
+      if(end == std::string::npos) end = list.size();
+      std::string name = list.substr(start, end - start);
+      if(name == "tensorrt" || name == "trt") parsed.push_back(DA2_PROVIDER_TENSORRT);
+      else if(name == "cuda") parsed.push_back(DA2_PROVIDER_CUDA);
+      else if(name == "openvino") parsed.push_back(DA2_PROVIDER_OPENVINO);
+      else if(name == "cpu") parsed.push_back(DA2_PROVIDER_CPU);
+      start = end + 1;
+    }
+    if(parsed.empty()) return false;
+    this->providers = parsed;
+    return true;
+  }
+};
 
 class DA2Network {
 public:
-  DA2Network(const char *network_path) {
+  DA2Network(const char *network_path, const DA2Options &options = DA2Options()) {
     std::strncpy(network_path_, network_path, 255);
     std::strncpy(input_names_, "pixel_values", 255);
     std::strncpy(output_names_, "predicted_depth", 255);
-    initSession(network_path);
+    initSession(network_path, options);
   }
 
-  DA2Network(const char *network_path, const char *input_layer_name, const char *output_layer_name) {
+  DA2Network(const char *network_path, const char *input_layer_name, const char *output_layer_name,
+             const DA2Options &options = DA2Options()) {
     std::strncpy(network_path_, network_path, 255);
     std::strncpy(input_names_, input_layer_name, 255);
     std::strncpy(output_names_, output_layer_name, 255);
-    initSession(network_path);
+    initSession(network_path, options);
   }
 
   ~DA2Network() {
-    if(this->input_data_ != nullptr) { 
-      delete[] this->input_data_;
-      this->input_data_ = nullptr;
-    }
     if(this->session_ != nullptr) {
+      // Bound values reference the session; release them first
+      this->io_binding_ = Ort::IoBinding(nullptr);
       delete this->session_;
       this->session_ = nullptr;
     }
   }
 
+  const char *provider_name() { return this->provider_name_.c_str(); }
   int in_height() { return this->height_; }
   int in_width() { return this->width_; }
   int out_height() { return this->out_height_; }
   int out_width() { return this->out_width_; }
+  int batch_size() { return this->batch_; }
 
+  /*
+    Copies src into the network input tensor in planar RGB format with
+    ImageNet normalization. The input buffer, the resize buffer and the
+    ORT tensor wrapping them are persistent and only rebuilt when the
+    input size changes, so steady-state calls do not touch the heap.
+  */
   int set_input(const cv::Mat &src, const float scale_factor = 1.0f) {
-    if(src.empty()) return -1;
+    if(src.empty() || src.type() != CV_8UC3) return -1;
     
-    cv::Mat tmp;
+    const cv::Mat *img = &src;
     if(scale_factor != 1.0f) {
-      cv::resize(src, tmp, cv::Size(), scale_factor, scale_factor);
-    } else {
-      tmp = src;
+      cv::resize(src, this->resized_, cv::Size(), scale_factor, scale_factor);
+      img = &this->resized_;
     }
 
-    // Allocate memory if size changed
-    if(tmp.rows != this->height_ || tmp.cols != this->width_) {
-      this->height_ = tmp.rows;
-      this->width_ = tmp.cols;
+    prepareInput(img->rows, img->cols, 1);
+    normalizeImage(*img, 0);
+    return 0;
+  }
 
-      if(this->input_data_ != nullptr) {
-        delete[] this->input_data_;
-      }
-      
-      this->input_data_ = new float[this->height_ * this->width_ * 3];
-      this->input_shape_[2] = this->height_;
-      this->input_shape_[3] = this->width_;
+  /*
+    Fills a batch of frames into one input tensor of shape [N, 3, H, W].
+    All frames must have the same size (after scaling). Models exported
+    with a fixed batch of 1 fail in run_network_batch; callers fall back
+    to one set_input/run_network per frame.
+  */
+  int set_input_batch(const std::vector<cv::Mat> &srcs, const float scale_factor = 1.0f) {
+    if(srcs.empty()) return -1;
+    for(const cv::Mat &src : srcs) {
+      if(src.empty() || src.type() != CV_8UC3 || src.size() != srcs[0].size()) return -1;
     }
 
-    // Copy data in planar format with ImageNet normalization
-    const int image_size = this->height_ * this->width_;
-    for(int i = 0; i < tmp.rows; i++) {
-      const cv::Vec3b *ptr = tmp.ptr<cv::Vec3b>(i);
-      float *fptrR = &(this->input_data_[i * this->width_]);
-      float *fptrG = &(this->input_data_[image_size + i * this->width_]);
-      float *fptrB = &(this->input_data_[image_size * 2 + i * this->width_]);
-      for(int j = 0; j < tmp.cols; j++) {
-        fptrR[j] = ((ptr[j][2] / 255.0f) - 0.485f) / 0.229f;
-        fptrG[j] = ((ptr[j][1] / 255.0f) - 0.456f) / 0.224f;
-        fptrB[j] = ((ptr[j][0] / 255.0f) - 0.406f) / 0.225f;
+    for(size_t b = 0; b < srcs.size(); b++) {
+      const cv::Mat *img = &srcs[b];
+      if(scale_factor != 1.0f) {
+        cv::resize(srcs[b], this->resized_, cv::Size(), scale_factor, scale_factor);
+        img = &this->resized_;
       }
+      if(b == 0) {
+        prepareInput(img->rows, img->cols, static_cast<int>(srcs.size()));
+      }
+      normalizeImage(*img, static_cast<int>(b));
     }
-    
     return 0;
   }
 
+  /*
+    Runs the network through a persistent IoBinding. The output is bound to
+    a host buffer owned by this object once its shape is known (after the
+    first run at a given input size); later runs write straight into it.
+    dst is reused by cv::resize when it already has output_size; an empty
+    output_size keeps the map at network resolution (out_width x out_height).
+  */
   int run_network(cv::Mat &dst, const cv::Size &output_size) {
-    if(this->session_ == nullptr || this->height_ == 0 || this->input_data_ == nullptr) {
-      return -1;
+    if(runSession() != 0) return -1;
+    return normalizeOutput(0, dst, output_size);
+  }
+
+  /*
+    Runs the batch filled by set_input_batch. Each depth map is normalized
+    to [0, 255] on its own and resized to the matching entry of sizes.
+  */
+  int run_network_batch(std::vector<cv::Mat> &dsts, const std::vector<cv::Size> &sizes) {
+    if(static_cast<int>(sizes.size()) != this->batch_ || runSession() != 0) return -1;
+    dsts.resize(sizes.size());
+    for(int b = 0; b < this->batch_; b++) {
+      if(normalizeOutput(b, dsts[b], sizes[b]) != 0) return -1;
     }
+    return 0;
+  }
 
-    try {
-      auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
-      
-      Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-        memory_info,
-        this->input_data_,
-        this->height_ * this->width_ * 3,
-        this->input_shape_.data(),
-        this->input_shape_.size()
-      );
-
-      const char* input_names[] = { input_names_ };
-      const char* output_names[] = { output_names_ };
-      
-      auto output_tensors = session_->Run(
-        Ort::RunOptions{nullptr}, 
-        input_names, 
-        &input_tensor, 
-        1, 
-        output_names, 
-        1
-      );
-
-      // Get output dimensions
-      auto shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
-      
-      if(shape.size() == 3) {
-        this->out_height_ = static_cast<int>(shape[1]);
-        this->out_width_ = static_cast<int>(shape[2]);
-      } else if(shape.size() == 2) {
-        this->out_height_ = static_cast<int>(shape[0]);
-        this->out_width_ = static_cast<int>(shape[1]);
-      } else if(shape.size() == 4) {
-        this->out_height_ = static_cast<int>(shape[2]);
-        this->out_width_ = static_cast<int>(shape[3]);
-      } else {
+  /*
+    Runs the network on a mid-grey frame of the given input size so that
+    provider setup (CUDA context, cuDNN autotuning, TensorRT engine build)
+    happens at startup instead of on the first live depth frame.
+  */
+  int warmup(const cv::Size &input_size, int runs = 1) {
+    cv::Mat grey(input_size, CV_8UC3, cv::Scalar(128, 128, 128));
+    cv::Mat out;
+    int64 start = cv::getTickCount();
+    for(int i = 0; i < runs; i++) {
+      if(this->set_input(grey) != 0 || this->run_network(out, input_size) != 0) {
         return -1;
       }
+    }
+    double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+    std::cout << "DA2Network: Warm-up at " << input_size.width << "x" << input_size.height
+              << " took " << ms << " ms" << std::endl;
+    return 0;
+  }
 
-      const float *tensorData = output_tensors[0].GetTensorData<float>();
-      if(tensorData == nullptr) return -1;
+private:
+  /*
+    Sizes the persistent input buffer and tensor for batch x 3 x rows x cols.
+    Reallocates (and marks the bindings dirty) only when the shape changes.
+  */
+  void prepareInput(int rows, int cols, int batch) {
+    if(rows == this->height_ && cols == this->width_ && batch == this->batch_) return;
 
-      // Find min/max for normalization
-      float max_val = -1e+6f, min_val = 1e+6f;
-      int total_pixels = out_height_ * out_width_;
-      
-      for(int i = 0; i < total_pixels; i++) {
-        if(tensorData[i] < min_val) min_val = tensorData[i];
-        if(tensorData[i] > max_val) max_val = tensorData[i];
+    this->height_ = rows;
+    this->width_ = cols;
+    this->batch_ = batch;
+    this->input_shape_[0] = batch;
+    this->input_shape_[2] = rows;
+    this->input_shape_[3] = cols;
+
+    this->input_data_.resize(static_cast<size_t>(batch) * rows * cols * 3);
+    this->input_tensor_ = Ort::Value::CreateTensor<float>(
+      this->memory_info_,
+      this->input_data_.data(),
+      this->input_data_.size(),
+      this->input_shape_.data(),
+      this->input_shape_.size()
+    );
+    this->bindings_dirty_ = true;
+  }
+
+  // Fused normalize + HWC->CHW transpose of one image into batch slot b
+  void normalizeImage(const cv::Mat &img, int b) {
+    const size_t image_size = static_cast<size_t>(this->height_) * this->width_;
+    float *base = &(this->input_data_[image_size * 3 * b]);
+    for(int i = 0; i < img.rows; i++) {
+      normalizeRow(img.ptr<uchar>(i),
+                   base + i * this->width_,
+                   base + image_size + i * this->width_,
+                   base + image_size * 2 + i * this->width_,
+                   img.cols);
+    }
+  }
+
+  /*
+    Runs the session on the current input. On the first run at a given
+    input shape the output shape is read back ([N,H,W], [N,1,H,W] or
+    [H,W] for single frames) and a persistent host buffer is bound.
+  */
+  int runSession() {
+    if(this->session_ == nullptr || this->height_ == 0 || this->input_data_.empty()) {
+      return -1;
+    }
+
+    try {
+      if(this->bindings_dirty_) {
+        // New input shape: rebind input, let ORT allocate the first output
+        this->io_binding_.ClearBoundInputs();
+        this->io_binding_.ClearBoundOutputs();
+        this->io_binding_.BindInput(input_names_, this->input_tensor_);
+        this->io_binding_.BindOutput(output_names_, this->memory_info_);
+        this->output_bound_ = false;
+        this->bindings_dirty_ = false;
       }
 
-      // Normalize to [0, 255]
-      cv::Mat tmp(out_height_, out_width_, CV_8UC1);
-      float range = (max_val - min_val > 1e-6f) ? (max_val - min_val) : 1.0f;
-      
-      for(int i = 0, k = 0; i < out_height_; i++) {
-        uchar *ptr = tmp.ptr<uchar>(i);
-        for(int j = 0; j < out_width_; j++, k++) {
-          float value = 255.0f * (tensorData[k] - min_val) / range;
-          ptr[j] = static_cast<uchar>(std::min(255.0f, std::max(0.0f, value)));
+      session_->Run(Ort::RunOptions{nullptr}, this->io_binding_);
+
+      if(!this->output_bound_) {
+        std::vector<Ort::Value> outputs = this->io_binding_.GetOutputValues();
+        if(outputs.empty()) return -1;
+
+        // Get output dimensions
+        auto shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        int64_t batch = 1;
+        
+        if(shape.size() == 3) {
+          batch = shape[0];
+          this->out_height_ = static_cast<int>(shape[1]);
+          this->out_width_ = static_cast<int>(shape[2]);
+        } else if(shape.size() == 2) {
+          this->out_height_ = static_cast<int>(shape[0]);
+          this->out_width_ = static_cast<int>(shape[1]);
+        } else if(shape.size() == 4) {
+          batch = shape[0];
+          this->out_height_ = static_cast<int>(shape[2]);
+          this->out_width_ = static_cast<int>(shape[3]);
+        } else {
+          return -1;
         }
+        if(batch != this->batch_) {
+          this->bindings_dirty_ = true;
+          return -1;
+        }
+
+        const float *tensorData = outputs[0].GetTensorData<float>();
+        if(tensorData == nullptr) return -1;
+
+        // Keep this result, then bind a persistent buffer for later runs
+        const size_t total = static_cast<size_t>(this->batch_) * out_height_ * out_width_;
+        this->output_shape_ = shape;
+        this->output_data_.assign(tensorData, tensorData + total);
+        this->output_tensor_ = Ort::Value::CreateTensor<float>(
+          this->memory_info_,
+          this->output_data_.data(),
+          this->output_data_.size(),
+          this->output_shape_.data(),
+          this->output_shape_.size()
+        );
+        this->io_binding_.ClearBoundOutputs();
+        this->io_binding_.BindOutput(output_names_, this->output_tensor_);
+        this->output_bound_ = true;
       }
-      
-      cv::resize(tmp, dst, output_size);
       return 0;
       
     } catch (...) {
+      // Rebind from scratch next time (e.g. after a rejected batch size)
+      this->bindings_dirty_ = true;
       return -1;
     }
   }
 
-private:
-  void initSession(const char *network_path) {
+  // Normalizes output map b of the last run to [0, 255] and resizes it
+  int normalizeOutput(int b, cv::Mat &dst, const cv::Size &output_size) {
+    if(!this->output_bound_ || b < 0 || b >= this->batch_) return -1;
+
+    // Header over the bound output buffer (no copy)
+    const size_t plane = static_cast<size_t>(out_height_) * out_width_;
+    cv::Mat depth(out_height_, out_width_, CV_32FC1, this->output_data_.data() + plane * b);
+
+    // Find min/max for normalization
+    double min_val = 0.0, max_val = 0.0;
+    cv::minMaxLoc(depth, &min_val, &max_val);
+
+    // Normalize to [0, 255] into a reusable 8-bit buffer
+    double range = (max_val - min_val > 1e-6) ? (max_val - min_val) : 1.0;
+    depth.convertTo(this->depth8_, CV_8U, 255.0 / range, -min_val * 255.0 / range);
+    
+    if(output_size.width <= 0 || output_size.height <= 0) {
+      this->depth8_.copyTo(dst);
+    } else {
+      cv::resize(this->depth8_, dst, output_size);
+    }
+    return 0;
+  }
+
+  // Maps the DA2 options onto the shared cvcore provider chain
+  static cvcore::InferenceOptions sharedOptions(const DA2Options &options) {
+    cvcore::InferenceOptions shared;
+    shared.providers.clear();
+    for(DA2Provider provider : options.providers) {
+      switch(provider) {
+        case DA2_PROVIDER_TENSORRT: shared.providers.push_back(cvcore::Provider::TensorRT); break;
+        case DA2_PROVIDER_CUDA: shared.providers.push_back(cvcore::Provider::CUDA); break;
+        case DA2_PROVIDER_OPENVINO: shared.providers.push_back(cvcore::Provider::OpenVINO); break;
+        case DA2_PROVIDER_CPU: shared.providers.push_back(cvcore::Provider::CPU); break;
+      }
+    }
+    shared.deviceId = options.device_id;
+    shared.trtCacheDir = options.trt_cache_dir;
+    shared.trtFp16 = options.trt_fp16;
+    shared.trtInt8 = options.trt_int8;
+    shared.openvinoDevice = options.openvino_device;
+    shared.intraOpThreads = options.intra_op_threads;
+    return shared;
+  }
+
+  void initSession(const char *network_path, const DA2Options &options) {
     try {
       Ort::SessionOptions session_options;
       
-      // CUDA GPU options
-      OrtCUDAProviderOptions cuda_options;
-      cuda_options.device_id = 0;
-      cuda_options.arena_extend_strategy = 0;
-      cuda_options.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchExhaustive;
-      cuda_options.do_copy_in_default_stream = 1;
-      session_options.AppendExecutionProvider_CUDA(cuda_options);
+      // Provider chain and environment are shared with every other ONNX
+      // Runtime session in the process (cvcore/inference.hpp)
+      this->provider_name_ = cvcore::configureProviders(session_options, sharedOptions(options),
+                                                        "DA2Network");
       
       // Optimization settings
       session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
@@ -184,12 +365,14 @@ private:
       #ifdef _WIN32
         std::string path_str(network_path);
         std::wstring wpath(path_str.begin(), path_str.end());
-        this->session_ = new Ort::Session(env_, wpath.c_str(), session_options);
+        this->session_ = new Ort::Session(cvcore::sharedEnv(), wpath.c_str(), session_options);
       #else
-        this->session_ = new Ort::Session(env_, network_path, session_options);
+        this->session_ = new Ort::Session(cvcore::sharedEnv(), network_path, session_options);
       #endif
+
+      this->io_binding_ = Ort::IoBinding(*this->session_);
       
-      std::cout << "DA2Network: Model loaded with CUDA GPU acceleration" << std::endl;
+      std::cout << "DA2Network: Model loaded, providers: " << this->provider_name_ << std::endl;
       
     } catch (const Ort::Exception& e) {
       std::cerr << "DA2Network error: " << e.what() << std::endl;
@@ -198,13 +381,74 @@ private:
     }
   }
 
-  int height_ = 0, width_ = 0;
+  /*
+    Normalizes one interleaved BGR row into the three planar RGB channels:
+    out = (v / 255 - mean) / std == v * (1 / (255 * std)) - mean / std.
+    The SIMD path deinterleaves 16 pixels at a time.
+  */
+  static void normalizeRow(const uchar *bgr, float *outR, float *outG, float *outB, int cols) {
+    const float scaleR = 1.0f / (255.0f * 0.229f), biasR = -0.485f / 0.229f;
+    const float scaleG = 1.0f / (255.0f * 0.224f), biasG = -0.456f / 0.224f;
+    const float scaleB = 1.0f / (255.0f * 0.225f), biasB = -0.406f / 0.225f;
+
+    int j = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 vScaleR = cv::v_setall_f32(scaleR), vBiasR = cv::v_setall_f32(biasR);
+    const cv::v_float32x4 vScaleG = cv::v_setall_f32(scaleG), vBiasG = cv::v_setall_f32(biasG);
+    const cv::v_float32x4 vScaleB = cv::v_setall_f32(scaleB), vBiasB = cv::v_setall_f32(biasB);
+    for(; j + 16 <= cols; j += 16) {
+      cv::v_uint8x16 b, g, r;
+      cv::v_load_deinterleave(bgr + j * 3, b, g, r);
+      storeNormalized(r, vScaleR, vBiasR, outR + j);
+      storeNormalized(g, vScaleG, vBiasG, outG + j);
+      storeNormalized(b, vScaleB, vBiasB, outB + j);
+    }
+#endif
+    for(; j < cols; j++) {
+      outR[j] = bgr[j * 3 + 2] * scaleR + biasR;
+      outG[j] = bgr[j * 3 + 1] * scaleG + biasG;
+      outB[j] = bgr[j * 3 + 0] * scaleB + biasB;
+    }
+  }
+
+#if CV_SIMD128
+  // Widens 16 uint8 values to float and applies scale/bias
+  static void storeNormalized(const cv::v_uint8x16 &v, const cv::v_float32x4 &scale,
+                              const cv::v_float32x4 &bias, float *out) {
+    cv::v_uint16x8 lo16, hi16;
+    cv::v_expand(v, lo16, hi16);
+    cv::v_uint32x4 q0, q1, q2, q3;
+    cv::v_expand(lo16, q0, q1);
+    cv::v_expand(hi16, q2, q3);
+    cv::v_store(out,      cv::v_fma(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q0)), scale, bias));
+    cv::v_store(out + 4,  cv::v_fma(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q1)), scale, bias));
+    cv::v_store(out + 8,  cv::v_fma(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q2)), scale, bias));
+    cv::v_store(out + 12, cv::v_fma(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q3)), scale, bias));
+  }
+#endif
+
+  int height_ = 0, width_ = 0, batch_ = 0;
   int out_height_ = 0, out_width_ = 0;
   char network_path_[256], input_names_[256], output_names_[256];
-  Ort::Env env_{ORT_LOGGING_LEVEL_WARNING, "DA2Network"};
   Ort::Session *session_ = nullptr;
-  float *input_data_ = nullptr;
+  std::string provider_name_;
+  Ort::MemoryInfo memory_info_ = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+  Ort::IoBinding io_binding_{nullptr};
+
+  // Persistent input: planar float buffer and the tensor wrapping it
+  std::vector<float> input_data_;
   std::array<int64_t, 4> input_shape_{1, 3, 0, 0};
+  Ort::Value input_tensor_{nullptr};
+  cv::Mat resized_;
+
+  // Persistent output: host buffer bound once its shape is known
+  std::vector<float> output_data_;
+  std::vector<int64_t> output_shape_;
+  Ort::Value output_tensor_{nullptr};
+  cv::Mat depth8_;
+
+  bool bindings_dirty_ = true;
+  bool output_bound_ = false;
 };
 
 #endif // DA2NETWORK_HPP
\ No newline at end of file
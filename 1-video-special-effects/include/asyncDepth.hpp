@@ -0,0 +1,148 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Asynchronous depth estimation stage for DA2Network.
+           Runs inference on a dedicated thread so the capture/display loop
+           runs at camera rate while depth updates at the network's own rate.
+*/
+
+#ifndef ASYNC_DEPTH_HPP
+#define ASYNC_DEPTH_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DA2Network.hpp"
+
+/**
+ * @brief One finished depth map and the frame it was estimated from
+ */
+struct DepthFrame {
+    cv::Mat depth;   ///< CV_8UC1, 0 = far, 255 = close
+    cv::Mat guide;   ///< Input frame at the map's size (CV_8UC3, native resolution only)
+};
+
+/**
+ * @class AsyncDepthEstimator
+ * @brief Runs DA2Network on a worker thread with latest-frame-wins input
+ *
+ * Input queue: a single pending slot. submit() overwrites any frame that the
+ * worker has not picked up yet, so the queue never grows and the network
+ * always works on the most recent frame.
+ *
+ * Output: depth maps are published as shared pointers, either resized to
+ * the input frame or at network resolution together with the input frame
+ * shrunk to match (for DepthUpsampler). latest() does an
+ * atomic load and never blocks on inference. The worker recycles output
+ * buffers (double-buffering), only reusing a buffer that neither the
+ * published slot nor any reader still references.
+ *
+ * The DA2Network instance is not thread-safe; once handed to this class it
+ * must only be used through it. The caller keeps ownership and must destroy
+ * the network after this object.
+ */
+class AsyncDepthEstimator {
+public:
+    /**
+     * @brief Start the inference thread
+     *
+     * @param network Depth network (not owned, must outlive this object)
+     * @param scaleFactor Input scale passed to DA2Network::set_input (default: 1.0)
+     * @param nativeResolution Publish depth at network resolution instead of
+     *                         resizing it to the input frame
+     */
+    explicit AsyncDepthEstimator(DA2Network *network, float scaleFactor = 1.0f,
+                                 bool nativeResolution = false);
+
+    /**
+     * @brief Stop the worker thread and wait for the current inference to finish
+     */
+    ~AsyncDepthEstimator();
+
+    AsyncDepthEstimator(const AsyncDepthEstimator &) = delete;
+    AsyncDepthEstimator &operator=(const AsyncDepthEstimator &) = delete;
+
+    /**
+     * @brief Offer a frame for depth estimation
+     *
+     * Only every Nth call (see setInterval) actually queues the frame. The
+     * frame is copied into a reusable buffer, so the caller may modify it
+     * immediately afterwards.
+     *
+     * @param frame Input color frame (CV_8UC3)
+     * @return true if the frame was queued, false if skipped by the interval
+     */
+    bool submit(const cv::Mat &frame);
+
+    /**
+     * @brief Most recent depth map, or nullptr before the first result
+     *
+     * Lock-free with respect to inference. Hold on to the returned pointer
+     * for as long as the map is being read; the buffer will not be reused
+     * while any reference is alive.
+     *
+     * @return Shared pointer to a CV_8UC1 depth map (0 = far, 255 = close)
+     */
+    std::shared_ptr<const cv::Mat> latest() const;
+
+    /**
+     * @brief Most recent depth map with its guide frame, or nullptr
+     *
+     * Same lifetime rules as latest(). A new pointer means a new map.
+     */
+    std::shared_ptr<const DepthFrame> latestFrame() const;
+
+    /**
+     * @brief Run depth on every Nth submitted frame and reuse it in between
+     *
+     * @param interval Frame interval (1 = every frame)
+     */
+    void setInterval(int interval);
+
+    int interval() const { return interval_.load(); }
+
+    /** @brief Frames that produced a depth map */
+    long completedCount() const { return completed_.load(); }
+
+    /** @brief Frames overwritten before the worker picked them up */
+    long droppedCount() const { return dropped_.load(); }
+
+    /** @brief Duration of the most recent inference in milliseconds */
+    double lastInferenceMs() const { return lastInferenceMs_.load(); }
+
+private:
+    void workerLoop();
+    std::shared_ptr<DepthFrame> acquireOutputBuffer();
+
+    DA2Network *network_;
+    float scaleFactor_;
+    bool nativeResolution_;
+
+    // Pending input slot (guarded by mutex_)
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    cv::Mat pendingFrame_;
+    bool hasPending_ = false;
+    bool stop_ = false;
+
+    // Worker-owned state
+    cv::Mat workFrame_;
+    std::vector<std::shared_ptr<DepthFrame>> outputBuffers_;
+
+    // Published result, accessed with std::atomic_load/atomic_store
+    std::shared_ptr<DepthFrame> latest_;
+
+    std::atomic<int> interval_{1};
+    std::atomic<long> submitCalls_{0};
+    std::atomic<long> completed_{0};
+    std::atomic<long> dropped_{0};
+    std::atomic<double> lastInferenceMs_{0.0};
+
+    std::thread worker_;
+};
+
+#endif // ASYNC_DEPTH_HPP
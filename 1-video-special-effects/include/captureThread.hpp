@@ -0,0 +1,104 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Header file for the capture thread. A dedicated thread reads a
+           cvcore::FrameSource continuously into a three-slot lock-free ring,
+           so the processing loop always gets the newest frame and camera
+           latency no longer adds to processing latency.
+*/
+
+#ifndef CAPTURE_THREAD_HPP
+#define CAPTURE_THREAD_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/capture.hpp>
+#include <atomic>
+#include <thread>
+
+/**
+ * @brief A frame handed out by CaptureThread (image, sequence, timestamps)
+ */
+typedef cvcore::Frame CapturedFrame;
+
+/**
+ * @class CaptureThread
+ * @brief Reads a frame source on its own thread, latest frame wins
+ *
+ * The ring is a triple buffer: the capture thread fills its back slot and
+ * publishes it by atomically exchanging it with the middle slot; next()
+ * exchanges its front slot with the middle slot when that holds a fresh
+ * frame. Neither side ever blocks the other. A frame that is replaced in
+ * the middle slot before next() takes it is dropped and counted.
+ *
+ * Frame buffers circulate between the slots and the caller (next() swaps
+ * images), so steady state does not allocate.
+ */
+class CaptureThread {
+public:
+    /**
+     * @param source Opened frame source (not owned; only used by the
+     *               capture thread between start() and stop())
+     */
+    explicit CaptureThread(cvcore::FrameSource &source);
+
+    /**
+     * @brief Stop the thread if it is running
+     */
+    ~CaptureThread();
+
+    CaptureThread(const CaptureThread &) = delete;
+    CaptureThread &operator=(const CaptureThread &) = delete;
+
+    /**
+     * @brief Start reading frames
+     * @return 0 on success, -1 if the thread is already running
+     */
+    int start();
+
+    /**
+     * @brief Stop reading and wait for the thread
+     */
+    void stop();
+
+    /**
+     * @brief Wait for a frame newer than the previous call and take it
+     *
+     * @param frame Receives the frame; its previous image buffer goes back
+     *              into the ring for reuse
+     * @param timeoutMs Longest wait for a new frame
+     * @return true on success, false on timeout or once the device stopped
+     *         delivering and the last frame was taken
+     */
+    bool next(CapturedFrame &frame, int timeoutMs = 2000);
+
+    /** @brief Frames read from the device */
+    long capturedCount() const { return captured_.load(); }
+
+    /** @brief Frames overwritten in the ring before next() took them */
+    long droppedCount() const { return dropped_.load(); }
+
+    /** @brief True once a read failed (device unplugged, end of file) */
+    bool finished() const { return finished_.load(); }
+
+private:
+    void captureLoop();
+
+    // Slot index in bits 0-1, FRESH set while the slot holds an unread frame
+    static const int FRESH = 4;
+
+    cvcore::FrameSource &source_;
+
+    CapturedFrame slots_[3];
+    int back_;                 // Capture-thread owned
+    int front_;                // Reader owned
+    std::atomic<int> middle_;  // Shared slot, exchanged by both sides
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> finished_{false};
+    std::atomic<long> captured_{0};
+    std::atomic<long> dropped_{0};
+
+    std::thread thread_;
+};
+
+#endif // CAPTURE_THREAD_HPP
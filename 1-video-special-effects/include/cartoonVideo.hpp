@@ -9,8 +9,40 @@
 #define CARTOON_VIDEO_HPP
 
 #include <opencv2/opencv.hpp>
+#include <opencv2/core/ocl.hpp>
+#include <string>
 #include <vector>
 
+/**
+ * @brief Execution backend for the cartoon pipeline
+ */
+enum CartoonBackend {
+    CARTOON_BACKEND_CPU,     ///< cv::Mat on the CPU (reference path)
+    CARTOON_BACKEND_OPENCL   ///< cv::UMat / T-API, frame stays on the GPU
+};
+
+/**
+ * @brief Edge-preserving smoother used for step 1 of the pipeline
+ */
+enum CartoonSmoother {
+    CARTOON_SMOOTH_BILATERAL,         ///< cv::bilateralFilter (reference)
+    CARTOON_SMOOTH_DOMAIN_TRANSFORM,  ///< Recursive domain-transform filter
+    CARTOON_SMOOTH_BILATERAL_GRID,    ///< Luminance bilateral grid
+    CARTOON_SMOOTH_GUIDED             ///< Self-guided box filter
+};
+
+/**
+ * @brief Short display name of a smoother ("bilateral", "domain", "grid", "guided")
+ */
+const char *cartoonSmootherName(CartoonSmoother smoother);
+
+/**
+ * @brief Parse a smoother name as printed by cartoonSmootherName
+ *
+ * @return true and sets smoother if name is known
+ */
+bool parseCartoonSmoother(const std::string &name, CartoonSmoother &smoother);
+
 /**
  * @class CartoonVideo
  * @brief Implements real-time video abstraction/cartoonization
@@ -74,6 +106,33 @@ public:
      */
     void applyBilateralFilter(const cv::Mat &src, cv::Mat &dst);
     
+    /**
+     * @brief Apply the selected edge-preserving smoother
+     * 
+     * Dispatches to applyBilateralFilter or one of the O(1)-per-pixel
+     * smoothers in edgePreserving.hpp. Their parameters are derived from
+     * the bilateral ones: the spatial sigma is capped at half the bilateral
+     * diameter (cv::bilateralFilter truncates its kernel there) and the
+     * range sigma is the bilateral colour sigma.
+     * 
+     * @param src Input image (CV_8UC3)
+     * @param dst Output smoothed image
+     */
+    void applySmoothing(const cv::Mat &src, cv::Mat &dst);
+    
+    /**
+     * @brief Render the selected smoother next to the bilateral reference
+     * 
+     * Both halves run the full pipeline without temporal smoothing. Each
+     * half is labelled with its smoother and smoothing time; the right half
+     * also shows the PSNR of its smoothed frame against the bilateral one.
+     * 
+     * @param src Input color frame (CV_8UC3)
+     * @param dst Output image, twice as wide as src
+     * @return 0 on success, -1 on error
+     */
+    int renderComparison(const cv::Mat &src, cv::Mat &dst);
+    
     /**
      * @brief Detect edges using Difference-of-Gaussians (DoG)
      * 
@@ -130,6 +189,61 @@ public:
      */
     void setBilateralParams(int d, double sigmaColor, double sigmaSpace);
     
+    /**
+     * @brief Set the processing downscale factor for the smoothing stage
+     * 
+     * With a factor of 2 or 4 the bilateral filter runs on a 1/2 or 1/4
+     * resolution copy and the result is restored with a guided upsampler
+     * (guide = full-resolution frame). DoG edges, quantization and the
+     * combine step still run at full resolution, so outlines stay crisp.
+     * 
+     * @param scale 1 (full quality), 2 or 4; other values are rounded down
+     */
+    void setProcessingScale(int scale);
+    
+    /**
+     * @brief Current processing downscale factor
+     */
+    int processingScale() const { return processingScale_; }
+    
+    /**
+     * @brief Select the edge-preserving smoother (default: bilateral)
+     */
+    void setSmoother(CartoonSmoother smoother) { smoother_ = smoother; lastCartoon_.release(); }
+    
+    /**
+     * @brief Current edge-preserving smoother
+     */
+    CartoonSmoother smoother() const { return smoother_; }
+    
+    /**
+     * @brief Enable change-driven incremental rendering (CPU backend)
+     * 
+     * Each frame is downsampled 4x and compared per tile (SAD, mean
+     * absolute difference per channel) against the frame each tile was last
+     * rendered from. Only tiles above the threshold are re-rendered, in
+     * horizontal runs padded by a halo covering the smoothing and DoG
+     * footprints; clean tiles keep their previous cartoon output. The DoG
+     * normalization range of the last full frame is reused for partial
+     * updates. A full frame is rendered when more than half the tiles are
+     * dirty, after any parameter change, and every 60 frames to bound drift.
+     * 
+     * @param enable True to enable
+     * @param tileSize Tile edge in pixels (rounded to a multiple of 8, >= 16)
+     * @param threshold Mean absolute difference (0-255) that marks a tile dirty
+     */
+    void setIncremental(bool enable, int tileSize = 64, double threshold = 3.0);
+    
+    /**
+     * @brief True if incremental rendering is enabled
+     */
+    bool incremental() const { return incremental_; }
+    
+    /**
+     * @brief Fraction of tiles re-rendered for the last frame (1 = full frame)
+     */
+    double dirtyFraction() const { return lastDirtyFraction_; }
+    
     /**
      * @brief Set DoG edge detection parameters
      */
@@ -140,11 +254,49 @@ public:
      */
     void setQuantizeLevels(int levels);
     
+    /**
+     * @brief Select the fused CPU stylization (default: on)
+     * 
+     * The fused path computes greyscale and both Gaussians of the DoG in
+     * fixed-point integers per row band and thresholds straight into an
+     * edge mask, then one LUT pass quantizes, applies the 2x2 edge dilation
+     * and darkens edges: two full-frame passes after smoothing instead of
+     * eight. The DoG is normalized with the range measured on the previous
+     * full frame (measured in the same pass for the next one), so there is
+     * no separate min/max pass; the first frame after a reset or parameter
+     * change measures its range first. Off runs the reference stages
+     * (detectEdgesDoG, quantizeColors, combineEdgesAndColors).
+     */
+    void setFusedStylize(bool enable) { fusedStylize_ = enable; lastCartoon_.release(); }
+    
+    /**
+     * @brief True if the fused CPU stylization is selected
+     */
+    bool fusedStylize() const { return fusedStylize_; }
+    
     /**
      * @brief Enable/disable temporal smoothing
      */
     void setTemporalSmoothing(bool enable);
     
+    /**
+     * @brief Select the execution backend
+     * 
+     * CARTOON_BACKEND_OPENCL uploads the frame once, runs every stage on
+     * cv::UMat (bilateral, DoG, a fused quantize+combine kernel, temporal
+     * blend) and downloads only the final frame. Falls back to the CPU
+     * backend if no OpenCL device is available.
+     * 
+     * @param backend Requested backend
+     * @return The backend actually in use
+     */
+    CartoonBackend setBackend(CartoonBackend backend);
+    
+    /**
+     * @brief Current execution backend
+     */
+    CartoonBackend backend() const { return backend_; }
+    
     /**
      * @brief Set temporal smoothing strength
      * 
@@ -153,6 +305,56 @@ public:
     void setTemporalAlpha(double alpha);
 
 private:
+    /**
+     * @brief Step 1 on the CPU: smoothing, at 1/processingScale_ if set
+     */
+    int smoothFrame(const cv::Mat &src, cv::Mat &dst);
+    
+    /**
+     * @brief Steps 2-4 on the CPU: DoG edges, quantization, combine
+     * 
+     * @param fixedRange Normalize the DoG with the range of the last full
+     *                   frame instead of the range of smoothed
+     */
+    void stylize(const cv::Mat &smoothed, cv::Mat &dst, bool fixedRange = false);
+    
+    /**
+     * @brief detectEdgesDoG, optionally with the stored normalization range
+     */
+    void detectEdgesDoG(const cv::Mat &src, cv::Mat &edges, bool fixedRange);
+    
+    /**
+     * @brief Steps 2-4 as two fused passes (see setFusedStylize)
+     */
+    void stylizeFused(const cv::Mat &smoothed, cv::Mat &dst, bool fixedRange);
+    
+    /**
+     * @brief Fixed-point DoG of smoothed, thresholded into edgeMask_
+     * 
+     * @param threshold Edge where g1 - g2 < threshold (integer grey levels)
+     * @param dogMin, dogMax Range of g1 - g2 over the frame
+     */
+    void fusedDoGEdges(const cv::Mat &smoothed, int threshold, int &dogMin, int &dogMax);
+    
+    /**
+     * @brief Steps 1-4 for the dirty tiles only; result in lastCartoon_
+     */
+    int processIncremental(const cv::Mat &src);
+    
+    /**
+     * @brief processFrame implementation for CARTOON_BACKEND_OPENCL
+     */
+    int processFrameOpenCL(const cv::Mat &src, cv::Mat &dst);
+    
+    /**
+     * @brief Fused quantize + edge darkening on the device
+     * 
+     * Runs a single OpenCL kernel over the smoothed frame; if the kernel
+     * cannot be built, uses two T-API LUTs and a masked copy instead.
+     */
+    void quantizeAndCombineOpenCL(const cv::UMat &smoothed, 
+                                  const cv::UMat &edges, cv::UMat &dst);
+    
     // Bilateral filter parameters
     int bilateralD_;              ///< Diameter of pixel neighborhood
     double bilateralSigmaColor_;  ///< Filter sigma in color space
@@ -162,15 +364,44 @@ private:
     double dogSigma1_;            ///< Smaller Gaussian sigma
     double dogSigma2_;            ///< Larger Gaussian sigma
     double dogThreshold_;         ///< Edge detection threshold
+    double dogMin_, dogMax_;      ///< DoG range of the last full-frame pass
+    bool dogRangeValid_;          ///< dogMin_/dogMax_ were measured
     
     // Color quantization
     int quantizeLevels_;          ///< Number of color levels
     
+    // Fused CPU stylization
+    bool fusedStylize_;           ///< Use stylizeFused
+    std::vector<int> dogKernel1_, dogKernel2_; ///< Fixed-point Gaussian taps (sum 256)
+    double dogKernelSigma1_, dogKernelSigma2_; ///< Sigmas the taps were built for
+    cv::Mat edgeMask_;            ///< Undilated DoG edges, 0 / 1 per pixel
+    
+    // Quality / performance
+    int processingScale_;         ///< Smoothing runs at 1/processingScale_
+    CartoonSmoother smoother_;    ///< Edge-preserving smoother for step 1
+    
+    // Incremental rendering
+    bool incremental_;            ///< Re-render changed tiles only
+    int tileSize_;                ///< Tile edge in pixels
+    double changeThreshold_;      ///< Mean abs difference marking a tile dirty
+    int framesSinceRefresh_;      ///< Partial frames since the last full one
+    double lastDirtyFraction_;    ///< Share of tiles re-rendered last frame
+    cv::Mat lastCartoon_;         ///< Cartoon output before temporal smoothing
+    cv::Mat changeSmall_, changeRef_, changeDiff_; ///< 1/4-size change detection
+    std::vector<uchar> dirty_;    ///< Per-tile dirty flags
+    
     // Temporal coherence
     bool useTemporalSmoothing_;   ///< Enable temporal smoothing
     double temporalAlpha_;        ///< Temporal blending factor
     cv::Mat previousFrame_;       ///< Previous frame buffer
     bool hasFirstFrame_;          ///< First frame flag
+    
+    // OpenCL backend (device-resident buffers, reused between frames)
+    CartoonBackend backend_;      ///< Active backend
+    cv::UMat uSrc_, uLow_, uLowSmoothed_, uSmoothed_, uGray_, uGauss1_, uGauss2_, uDog_;
+    cv::UMat uEdges_, uCartoon_, uPrevious_;
+    cv::ocl::Kernel combineKernel_; ///< Fused quantize+combine kernel
+    bool kernelTried_;            ///< Kernel build attempted
 };
 
 #endif // CARTOON_VIDEO_HPP
\ No newline at end of file
@@ -0,0 +1,126 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Shared depth inference server for multi-camera capture. One
+           DA2Network serves several sources; the worker thread collects the
+           newest pending frame of every source and runs them as one batch.
+*/
+
+#ifndef DEPTH_SERVER_HPP
+#define DEPTH_SERVER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DA2Network.hpp"
+
+/**
+ * @class DepthServer
+ * @brief Batched DA2Network inference shared by several frame sources
+ *
+ * Each source has a latest-frame-wins input slot and a published output,
+ * exactly like AsyncDepthEstimator. The worker takes every pending slot
+ * (up to maxBatch) at once, resizes the frames to the size of the first
+ * one and runs a single [N, 3, H, W] inference. If the model rejects a
+ * batch (fixed batch dimension), the server switches permanently to one
+ * inference per frame.
+ *
+ * The network is not owned and must only be used through this object while
+ * it runs; destroy the network after the server.
+ */
+class DepthServer {
+public:
+    /**
+     * @brief Start the inference thread
+     *
+     * @param network Depth network (not owned, must outlive this object)
+     * @param sources Number of frame sources (cameras)
+     * @param scaleFactor Input scale passed to DA2Network (default: 1.0)
+     * @param maxBatch Largest batch to run at once (default: 4)
+     */
+    DepthServer(DA2Network *network, int sources, float scaleFactor = 1.0f, int maxBatch = 4);
+
+    /**
+     * @brief Stop the worker thread and wait for the current batch to finish
+     */
+    ~DepthServer();
+
+    DepthServer(const DepthServer &) = delete;
+    DepthServer &operator=(const DepthServer &) = delete;
+
+    /**
+     * @brief Offer a frame from a source; replaces any frame still pending
+     *
+     * @param source Source index in [0, sources)
+     * @param frame Input color frame (CV_8UC3), copied
+     * @return true if queued, false on invalid input
+     */
+    bool submit(int source, const cv::Mat &frame);
+
+    /**
+     * @brief Most recent depth map of a source, or nullptr before the first
+     *
+     * Hold the pointer while reading; the buffer is not reused until every
+     * reference is released.
+     */
+    std::shared_ptr<const cv::Mat> latest(int source) const;
+
+    /** @brief Depth maps produced for a source */
+    long completedCount(int source) const;
+
+    /** @brief Frames of a source overwritten before inference */
+    long droppedCount(int source) const;
+
+    /** @brief Duration of the most recent batch in milliseconds */
+    double lastBatchMs() const { return lastBatchMs_.load(); }
+
+    /** @brief Number of frames in the most recent batch */
+    int lastBatchSize() const { return lastBatchSize_.load(); }
+
+    /** @brief False once the model has rejected a batch larger than one */
+    bool batching() const { return batching_.load(); }
+
+private:
+    struct Source {
+        cv::Mat pending;                 // Guarded by mutex_
+        bool hasPending = false;         // Guarded by mutex_
+        cv::Mat work;                    // Worker-owned
+        std::vector<std::shared_ptr<cv::Mat>> buffers;  // Worker-owned
+        std::shared_ptr<cv::Mat> latest; // std::atomic_load/atomic_store
+        std::atomic<long> completed{0};
+        std::atomic<long> dropped{0};
+    };
+
+    void workerLoop();
+    std::shared_ptr<cv::Mat> acquireOutputBuffer(Source &source);
+
+    // Run the collected sources (batched or one by one) and publish
+    void runBatch(const std::vector<int> &ids);
+
+    DA2Network *network_;
+    float scaleFactor_;
+    int maxBatch_;
+    std::vector<std::unique_ptr<Source>> sources_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+    int nextSource_ = 0;  // Round-robin start when more than maxBatch wait
+
+    // Worker-owned batch buffers
+    std::vector<cv::Mat> batchFrames_;
+    std::vector<cv::Mat> batchDepth_;
+    std::vector<cv::Size> batchSizes_;
+
+    std::atomic<bool> batching_{true};
+    std::atomic<double> lastBatchMs_{0.0};
+    std::atomic<int> lastBatchSize_{0};
+
+    std::thread worker_;
+};
+
+#endif // DEPTH_SERVER_HPP
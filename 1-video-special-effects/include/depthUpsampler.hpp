@@ -0,0 +1,99 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Header file for the depth upsampler. Depth maps stay at network
+           resolution; each displayed frame gets its depth by warping the
+           last map to the frame with dense optical flow (so inference can
+           run at a fraction of camera rate) and guided-filter upsampling
+           it to display resolution with the colour frame as guide.
+*/
+
+#ifndef DEPTH_UPSAMPLER_HPP
+#define DEPTH_UPSAMPLER_HPP
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class DepthUpsampler
+ * @brief Low-resolution depth to display-resolution depth, per frame
+ *
+ * update() takes each new depth map together with the colour frame it was
+ * estimated from (the key frame). render() is called for every displayed
+ * frame:
+ *   1. The frame is shrunk to the depth map's size.
+ *   2. With motion compensation on, DIS optical flow from the shrunk frame
+ *      back to the key frame warps the key depth map onto the current frame.
+ *      Flow is always measured against the key frame, so errors do not
+ *      accumulate between depth updates.
+ *   3. A fast guided filter fits depth = a * grey + b at depth resolution
+ *      and applies the upsampled coefficients to the full-resolution grey
+ *      frame, so depth edges follow image edges instead of the blocky
+ *      bilinear resize.
+ *
+ * Everything except the final linear model runs at depth resolution, and
+ * all buffers persist between calls.
+ */
+class DepthUpsampler {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param radius Guided filter box radius at depth resolution
+     * @param eps Guided filter regularization (0-1 intensity units)
+     */
+    explicit DepthUpsampler(int radius = 4, double eps = 1e-3);
+
+    /**
+     * @brief Set a new key frame
+     *
+     * @param depth Depth map at network resolution (CV_8UC1)
+     * @param keyFrame Colour frame the depth was estimated from (CV_8UC3, any size)
+     * @return 0 on success, -1 on error
+     */
+    int update(const cv::Mat &depth, const cv::Mat &keyFrame);
+
+    /**
+     * @brief Depth for a displayed frame at the frame's resolution
+     *
+     * @param frame Current colour frame (CV_8UC3)
+     * @param depth Output depth map (CV_8UC1, frame size)
+     * @return 0 on success, -1 before the first update or on error
+     */
+    int render(const cv::Mat &frame, cv::Mat &depth);
+
+    /**
+     * @brief Warp the key depth to each frame with optical flow (default on)
+     */
+    void setMotionCompensation(bool enabled) { motionCompensation_ = enabled; }
+    bool motionCompensation() const { return motionCompensation_; }
+
+    /**
+     * @brief Forget the key frame; render() fails until the next update()
+     */
+    void reset();
+
+    bool hasDepth() const { return !keyDepth_.empty(); }
+
+    /** @brief Duration of the last render() in milliseconds */
+    double lastRenderMs() const { return lastRenderMs_; }
+
+private:
+    // Shrink a colour frame to the depth size and convert it to grey
+    void shrinkToGrey(const cv::Mat &frame, cv::Mat &grey);
+
+    int radius_;
+    double eps_;
+    bool motionCompensation_ = true;
+    double lastRenderMs_ = 0.0;
+
+    cv::Mat keyDepth_;           ///< Depth map of the key frame (CV_8UC1)
+    cv::Mat keyGrey_;            ///< Key frame at depth size (CV_8UC1)
+    cv::Ptr<cv::DISOpticalFlow> flow_;
+
+    // Per-call buffers, reused while the sizes stay the same
+    cv::Mat small_, curGrey_, flowField_, mapX_, mapY_, warped_;
+    cv::Mat I_, p_, tmp_, meanI_, meanP_, meanIP_, meanII_, a_, b_;
+    cv::Mat aUp_, bUp_, fullGrey_, fullI_;
+};
+
+#endif // DEPTH_UPSAMPLER_HPP
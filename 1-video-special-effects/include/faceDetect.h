@@ -11,6 +11,10 @@
 // put the path to the haar cascade file here
 #define FACE_CASCADE_FILE "./haarcascade_frontalface_alt2.xml"
 
+// put the path to the YuNet face detection model here; when it is present
+// detectFaces uses it, otherwise it falls back to the Haar cascade
+#define FACE_YUNET_FILE "./face_detection_yunet_2023mar.onnx"
+
 // prototypes
 
 /*
@@ -23,6 +27,25 @@
 */
 int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces );
 
+/*
+  Function: setFaceDetector
+  Purpose: Choose the detector used by detectFaces
+  Arguments:
+    yunetFile - YuNet ONNX model, or NULL / "" for the Haar cascade
+    scoreThreshold - minimum YuNet face score (default: 0.8)
+    inputSize - longest side of the image YuNet runs on (default: 320)
+  Return value: 0 on success, -1 if the model could not be loaded (the
+    Haar cascade is used)
+*/
+int setFaceDetector( const char *yunetFile, float scoreThreshold = 0.8f, int inputSize = 320 );
+
+/*
+  Function: faceDetectorName
+  Purpose: Name of the detector detectFaces currently uses
+  Return value: "YuNet" or "Haar"
+*/
+const char *faceDetectorName();
+
 /*
   Function: drawBoxes
   Purpose: Draw bounding boxes around detected faces on the input frame
@@ -0,0 +1,91 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 25, 2026
+  Purpose: Header file for the temporally coherent face tracker. The Haar
+           cascade (detectFaces) runs only every N frames, or when tracking
+           confidence drops, and mostly on small regions around the previous
+           boxes; in between, boxes are propagated with pyramidal Lucas-Kanade
+           optical flow on a few feature points per face.
+*/
+
+#ifndef FACE_TRACKER_HPP
+#define FACE_TRACKER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Face boxes tracked between sparse Haar cascade detections
+ *
+ * Consumers (faceHighlight, faceBulgeEffect, sparkleEffect, drawBoxes) get
+ * the same std::vector<cv::Rect> they would get from detectFaces.
+ */
+class FaceTracker {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param detectInterval Run the cascade at least every this many frames
+     * @param minConfidence Fraction of flow points that must survive the
+     *                      forward-backward check to keep a track without
+     *                      re-detecting
+     */
+    explicit FaceTracker(int detectInterval = 5, double minConfidence = 0.5);
+
+    /**
+     * @brief Update the tracks for a new frame and return the face boxes
+     *
+     * Frames must be passed in order; a gap in frameIndex (e.g. the faces
+     * were not needed for a while) or a size change forces a full-frame
+     * detection.
+     *
+     * @param grey Greyscale frame (CV_8UC1)
+     * @param faces Output face rectangles in frame coordinates
+     * @param frameIndex Monotonic index of the frame
+     * @return 0 on success, -1 on error
+     */
+    int update(const cv::Mat &grey, std::vector<cv::Rect> &faces, long frameIndex);
+
+    /**
+     * @brief Drop all tracks; the next update runs a full-frame detection
+     */
+    void reset();
+
+    /**
+     * @brief Set how often the cascade runs (1 = every frame, no tracking)
+     */
+    void setDetectInterval(int frames);
+    int detectInterval() const { return detectInterval_; }
+
+    /**
+     * @brief Number of cascade runs (full frame + ROI) since construction
+     */
+    long cascadeRuns() const { return cascadeRuns_; }
+
+private:
+    struct Track {
+        cv::Rect2f box;                    // Current box (sub-pixel)
+        std::vector<cv::Point2f> points;   // Flow points inside the box
+        float confidence;                  // Surviving point fraction
+    };
+
+    // Run detectFaces on the whole frame or on a region (results offset)
+    void detectIn(const cv::Mat &grey, const cv::Rect &region, std::vector<cv::Rect> &found);
+
+    // Choose feature points inside the inner part of a track's box
+    void seedPoints(const cv::Mat &grey, Track &track);
+
+    // Move a track from prevGrey_ to grey; updates its confidence
+    void propagate(const cv::Mat &grey, Track &track);
+
+    int detectInterval_;
+    double minConfidence_;
+    std::vector<Track> tracks_;
+    cv::Mat prevGrey_;
+    long lastFrame_;
+    int framesSinceDetect_;
+    int detectsSinceFull_;
+    long cascadeRuns_;
+};
+
+#endif // FACE_TRACKER_HPP
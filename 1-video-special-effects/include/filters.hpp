@@ -4,6 +4,13 @@
   Purpose: Header file for image filtering and manipulation functions.
            Contains declarations for greyscale, blur, Sobel, and special effects filters.
            Includes sparkle animation effect for face detection.
+
+           The per-pixel filters (greyscale, sepiaTone, blur5x5_simd, sobelX3x3,
+           sobelY3x3, magnitude, sobelMagnitude3x3, blurQuantize, embossEffect)
+           run across all cores through the row-band tiling layer in
+           tiling.hpp. Their output is bit-identical to single-threaded
+           execution; use cv::setNumThreads() to control the worker count.
+           negativeEffect goes through cv::LUT, which parallelizes itself.
 */
 
 #ifndef FILTERS_HPP
@@ -41,6 +48,7 @@ struct Sparkle {
  * Uses a custom greyscale conversion that emphasizes color differences:
  * grey = |R - B| + G/2
  * This creates a unique look that highlights edges and color boundaries.
+ * Integer-only; 16 pixels per step with SIMD when cv::useOptimized().
  * 
  * @param src Input color image (CV_8UC3, BGR format)
  * @param dst Output greyscale image (CV_8UC3, all channels identical)
@@ -61,6 +69,10 @@ int greyscale(cv::Mat &src, cv::Mat &dst);
  *   G' = 0.349*R + 0.686*G + 0.168*B
  *   B' = 0.272*R + 0.534*G + 0.131*B
  * 
+ * The matrix is compiled into per-channel fixed-point lookup tables, and
+ * the vignette gain is a CV_16U map cached per frame size, so no
+ * floating point or sqrt runs per pixel in steady state.
+ * 
  * @param src Input color image (CV_8UC3)
  * @param dst Output sepia-toned image (CV_8UC3)
  * @param applyVignetting If true, adds darkening at edges (default: true)
@@ -104,6 +116,27 @@ int blur5x5_1(cv::Mat &src, cv::Mat &dst);
  */
 int blur5x5_2(cv::Mat &src, cv::Mat &dst);
 
+/**
+ * @brief Apply 5x5 Gaussian blur using separable filters with SIMD inner loops
+ *
+ * Same [1 2 4 2 1] separable kernel as blur5x5_2, restructured for speed:
+ * - Horizontal pass writes into a rolling 5-row window of 16-bit sums,
+ *   so the intermediate never touches a full-frame buffer
+ * - Border clamping is done once per row (first/last two pixels and
+ *   first/last two rows); the interior runs without any bounds checks
+ * - Interior loops use OpenCV universal intrinsics, which compile to
+ *   SSE4/AVX2 on x86 and NEON on ARM depending on the build's CPU baseline
+ *
+ * The SIMD path is chosen at runtime when cv::useOptimized() is true;
+ * otherwise the identical scalar loop is used. The single division by 100
+ * happens after both passes, so the output is bit-identical to blur5x5_1.
+ *
+ * @param src Input color image (CV_8UC3)
+ * @param dst Output blurred image (CV_8UC3)
+ * @return 0 on success, -1 on error
+ */
+int blur5x5_simd(cv::Mat &src, cv::Mat &dst);
+
 // ============================================================================
 // TASK 7: SOBEL EDGE DETECTION FILTERS
 // ============================================================================
@@ -166,6 +199,24 @@ int sobelY3x3(cv::Mat &src, cv::Mat &dst);
  */
 int magnitude(cv::Mat &sx, cv::Mat &sy, cv::Mat &dst);
 
+/**
+ * @brief Fused Sobel X/Y and gradient magnitude in a single sweep
+ * 
+ * Equivalent to sobelX3x3 + sobelY3x3 + magnitude, but computes both
+ * gradients per pixel directly from a rolling 3-row window of the source
+ * and writes only the final magnitude. No CV_16SC3 intermediates are
+ * materialised and the frame is read once instead of three times.
+ * 
+ * Output is bit-identical to the three-call chain (including the zeroed
+ * one-pixel border). embossEffect and cartoonEffect use the same fused
+ * gradient path internally.
+ * 
+ * @param src Input color image (CV_8UC3)
+ * @param dst Output magnitude image (CV_8UC3)
+ * @return 0 on success, -1 on error
+ */
+int sobelMagnitude3x3(cv::Mat &src, cv::Mat &dst);
+
 // ============================================================================
 // TASK 9: BLUR AND QUANTIZE
 // ============================================================================
@@ -204,6 +255,9 @@ int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels);
  * 
  * Depth map interpretation: 0=close, 255=far
  * 
+ * The fog curve is evaluated once per intensity into a 256-entry Q8 table
+ * indexed by depth; the per-pixel blend is integer and SIMD.
+ * 
  * @param src Input color image (CV_8UC3)
  * @param depth Depth map (CV_8UC1, 0=close, 255=far)
  * @param dst Output image with fog effect (CV_8UC3)
@@ -219,9 +273,11 @@ int depthFog(cv::Mat &src, cv::Mat &depth, cv::Mat &dst, float intensity = 3.0f)
  * Simulates shallow depth of field effect from DSLR cameras.
  * 
  * Algorithm:
- * 1. Create heavily blurred version of image
- * 2. Calculate blur amount based on distance from focus depth
- * 3. Blend sharp and blurred versions using smooth transition
+ * 1. Build a Gaussian pyramid once (levels 1-4, increasingly blurred)
+ * 2. Map each depth value to a fractional blur level through a 256-entry
+ *    Q8 weight table, rebuilt only when focusDepth/focusRange change
+ * 3. Blend the two neighbouring levels per pixel in fixed point (SIMD);
+ *    levels unused by the frame's depth range are not built
  * 
  * @param src Input color image (CV_8UC3)
  * @param depth Depth map (CV_8UC1)
@@ -261,7 +317,8 @@ int embossEffect(cv::Mat &src, cv::Mat &dst);
  * Simple pixel-wise inversion:
  *   output = 255 - input for each channel
  * 
- * Creates photographic negative effect.
+ * Creates photographic negative effect. Applied as a precomputed 256-entry
+ * table through cv::LUT.
  * 
  * @param src Input color image (CV_8UC3)
  * @param dst Output negative image (CV_8UC3)
@@ -280,7 +337,9 @@ int negativeEffect(cv::Mat &src, cv::Mat &dst);
  * 3. Blur mask for smooth transition
  * 4. Blend color faces with grayscale background
  * 
- * Face regions expanded 12.5% for better coverage.
+ * Face regions expanded 12.5% for better coverage. Steps 2-4 only run in
+ * windows around the faces (the blurred ellipse plus its blur radius), so
+ * their cost follows the face area. Safe to call in-place.
  * 
  * @param src Input color image (CV_8UC3)
  * @param dst Output image with highlighted faces (CV_8UC3)
@@ -300,11 +359,45 @@ int faceHighlight(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &faces
  * 3. Quantize colors (8 levels)
  * 4. Darken edge pixels to create outlines
  * 
+ * With scale > 1 the blur-quantize step runs at 1/scale resolution and is
+ * brought back with guidedUpsample; edges are still computed at full
+ * resolution so outlines stay crisp.
+ * 
  * @param src Input color image (CV_8UC3)
  * @param dst Output cartoon image (CV_8UC3)
+ * @param scale Processing downscale factor for the color path (1, 2 or 4)
  * @return 0 on success, -1 on error
  */
-int cartoonEffect(cv::Mat &src, cv::Mat &dst);
+int cartoonEffect(cv::Mat &src, cv::Mat &dst, int scale = 1);
+
+/**
+ * @brief Edge-aware upsampling of a low-resolution result (fast guided filter)
+ * 
+ * Fits the local linear model target = a * guide + b on the low-resolution
+ * pair (He et al., guided filter), bilinearly upsamples the box-averaged
+ * coefficients and applies them to the full-resolution guide. Edges of the
+ * output follow the full-resolution guide instead of being blurred by the
+ * resize. Each channel of the target is guided by the same channel of the
+ * guide.
+ * 
+ * @param lowTarget Low-resolution processed image (CV_8UC3)
+ * @param lowGuide Guide at the same low resolution (CV_8UC3)
+ * @param fullGuide Full-resolution guide (CV_8UC3)
+ * @param dst Output at fullGuide's size (CV_8UC3)
+ * @param radius Box radius at low resolution
+ * @param eps Regularization in [0,1]-normalized intensity units
+ * @return 0 on success, -1 on error
+ */
+int guidedUpsample(const cv::Mat &lowTarget, const cv::Mat &lowGuide,
+                   const cv::Mat &fullGuide, cv::Mat &dst,
+                   int radius = 2, double eps = 1e-3);
+
+/**
+ * @brief guidedUpsample on the T-API (device-resident buffers)
+ */
+int guidedUpsample(const cv::UMat &lowTarget, const cv::UMat &lowGuide,
+                   const cv::UMat &fullGuide, cv::UMat &dst,
+                   int radius = 2, double eps = 1e-3);
 
 // ============================================================================
 // EXTENSION: WARP EFFECTS
@@ -322,7 +415,10 @@ int cartoonEffect(cv::Mat &src, cv::Mat &dst);
  * strength < 1.0: bulge outward (fisheye effect)
  * strength > 1.0: pinch inward
  * 
- * Uses bilinear interpolation for smooth result.
+ * Uses bilinear interpolation for smooth result. Source coordinates are
+ * cached per (frame size, strength) in WarpMapCache, so each frame costs a
+ * single cv::remap; the same applies to waveEffect, swirlEffect and
+ * faceBulgeEffect.
  * 
  * @param src Input color image (CV_8UC3)
  * @param dst Output warped image (CV_8UC3)
@@ -373,7 +469,9 @@ int swirlEffect(cv::Mat &src, cv::Mat &dst, float angle = 2.0f);
  * Creates "big head" caricature effect on faces.
  * Combines face detection with local coordinate warping.
  * 
- * Each face gets independent bulge transformation.
+ * Each face gets independent bulge transformation, remapping only the
+ * window around the face with tables cached per face size. In-place calls
+ * save just those windows instead of copying the frame.
  * Useful for humorous photo effects.
  * 
  * @param src Input color image (CV_8UC3)
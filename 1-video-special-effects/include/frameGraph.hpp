@@ -0,0 +1,123 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Header file for the per-frame filter graph used by vidDisplay.
+           Intermediate results (greyscale, blur, Sobel gradients, depth,
+           detected faces) are graph nodes evaluated lazily on first use and
+           memoised until the next frame, so display modes that need the same
+           intermediate share one computation.
+*/
+
+#ifndef FRAME_GRAPH_HPP
+#define FRAME_GRAPH_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/frameContext.hpp>
+#include <vector>
+
+class FaceTracker;
+
+/**
+ * @brief Nodes of the frame graph
+ *
+ * Dependencies: NODE_FACES <- NODE_GREY, NODE_MAGNITUDE <- NODE_SOBEL_X +
+ * NODE_SOBEL_Y (when both are already evaluated), NODE_DEPTH_INVERTED <-
+ * NODE_DEPTH. All other nodes read only the source frame.
+ */
+enum FrameNode {
+    NODE_GREY,            // cvtColor BGR2GRAY (CV_8UC1)
+    NODE_BLUR,            // blur5x5_simd (CV_8UC3)
+    NODE_SOBEL_X,         // sobelX3x3 (CV_16SC3)
+    NODE_SOBEL_Y,         // sobelY3x3 (CV_16SC3)
+    NODE_MAGNITUDE,       // gradient magnitude (CV_8UC3)
+    NODE_DEPTH,           // depth map supplied with the frame (CV_8UC1)
+    NODE_DEPTH_INVERTED,  // 255 - depth, near = dark
+    NODE_FACES,           // Face boxes on NODE_GREY (cascade or tracker)
+    NODE_COUNT
+};
+
+/**
+ * @brief Lazily evaluated, per-frame memoised set of intermediate images
+ *
+ * Call beginFrame() once per captured frame; it invalidates every node. Each
+ * accessor computes its node (and any dependencies) on first use and returns
+ * the cached result afterwards. Buffers are kept between frames, so
+ * steady-state evaluation does not reallocate.
+ *
+ * Colour-space conversions come from a cvcore::FrameContext of the frame:
+ * NODE_GREY is its gray(), and effects needing HSV, Lab or CLAHE ask
+ * context() so they share those conversions as well.
+ */
+class FrameGraph {
+public:
+    FrameGraph();
+
+    /**
+     * @brief Start a new frame and invalidate all memoised nodes
+     *
+     * @param frame Source BGR frame (not copied; must outlive the frame)
+     * @param depthMap Latest depth map, or an empty Mat if unavailable
+     */
+    void beginFrame(cv::Mat &frame, const cv::Mat &depthMap);
+
+    /**
+     * @brief The source frame passed to beginFrame()
+     */
+    cv::Mat &color() { return frame_; }
+
+    /**
+     * @brief Memoised colour conversions of the current frame
+     */
+    cvcore::FrameContext &context() { return context_; }
+
+    cv::Mat &grey();
+    cv::Mat &blur();
+    cv::Mat &sobelX();
+    cv::Mat &sobelY();
+    cv::Mat &magnitude();
+
+    /**
+     * @brief True if a depth map was supplied for this frame
+     */
+    bool hasDepth() const { return !depth_.empty(); }
+    cv::Mat &depth() { return depth_; }
+    cv::Mat &invertedDepth();
+
+    std::vector<cv::Rect> &faces();
+
+    /**
+     * @brief Route NODE_FACES through a tracker instead of detectFaces
+     *
+     * The tracker sees frames in order through the graph's frame counter,
+     * so it detects a gap when faces were not requested for a while.
+     *
+     * @param tracker Tracker to use (not owned), or nullptr for per-frame detection
+     */
+    void setFaceTracker(FaceTracker *tracker) { faceTracker_ = tracker; }
+
+    /**
+     * @brief True if the node has already been evaluated for this frame
+     */
+    bool isValid(FrameNode node) const { return (valid_ & (1u << node)) != 0; }
+
+    /**
+     * @brief Number of node evaluations performed for the current frame
+     */
+    int evaluations() const { return evaluations_; }
+
+private:
+    // Marks a node computed and counts the evaluation
+    void markValid(FrameNode node);
+
+    cv::Mat frame_;
+    cvcore::FrameContext context_;
+    cv::Mat depth_;
+    cv::Mat grey_, blur_, sobelX_, sobelY_, magnitude_, invertedDepth_;
+    std::vector<cv::Rect> faces_;
+    FaceTracker *faceTracker_;
+    long frameIndex_;
+    unsigned int valid_;
+    int evaluations_;
+};
+
+#endif // FRAME_GRAPH_HPP
@@ -0,0 +1,122 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Header file for the frame buffer pool. Filters and display presets
+           borrow their per-frame temporaries (masks, in-place copies, pyramid
+           levels, band scratch rows) from a pool of recycled cv::Mat buffers
+           keyed by size and type, so steady-state processing does not
+           allocate pixel buffers.
+*/
+
+#ifndef FRAME_POOL_HPP
+#define FRAME_POOL_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <vector>
+
+/**
+ * @class FrameLease
+ * @brief A buffer borrowed from a FramePool, returned when the lease ends
+ *
+ * The lease holds a reference to one of the pool's buffers; the buffer is
+ * available again as soon as no lease or other cv::Mat header refers to it
+ * (the same use-count rule as AsyncDepthEstimator's output buffers). Copying
+ * the Mat out of the lease therefore keeps the buffer reserved for as long
+ * as the copy lives.
+ */
+class FrameLease {
+public:
+    FrameLease() {}
+    FrameLease(FrameLease &&) = default;
+    FrameLease &operator=(FrameLease &&) = default;
+    FrameLease(const FrameLease &) = delete;
+    FrameLease &operator=(const FrameLease &) = delete;
+
+    /**
+     * @brief The borrowed buffer (contents are left from its previous use)
+     */
+    cv::Mat &mat() { return mat_; }
+
+    /**
+     * @brief Give the buffer back before the lease goes out of scope
+     */
+    void release() { mat_.release(); }
+
+private:
+    friend class FramePool;
+    explicit FrameLease(const cv::Mat &buffer) : mat_(buffer) {}
+
+    cv::Mat mat_;
+};
+
+/**
+ * @class FramePool
+ * @brief Recycled cv::Mat buffers keyed by size and type
+ *
+ * acquire() returns a free buffer of the requested shape, allocating one
+ * only on a miss; misses are counted, so a constant allocations() over a run
+ * of frames verifies that the steady state is allocation-free. When the pool
+ * holds maxBuffers entries, a miss replaces the oldest free buffer of another
+ * shape (e.g. after a resolution change) instead of growing.
+ *
+ * A pool is not thread-safe: filters use FramePool::local(), one pool per
+ * thread, which also serves cv::parallel_for_ workers (they are persistent).
+ */
+class FramePool {
+public:
+    /**
+     * @param maxBuffers Largest number of buffers kept (default: 64)
+     */
+    explicit FramePool(int maxBuffers = 64);
+
+    /**
+     * @brief Borrow a buffer of the given size and type
+     *
+     * @param size Buffer size
+     * @param type OpenCV type, e.g. CV_8UC3
+     * @return Lease on an uninitialized buffer
+     */
+    FrameLease acquire(cv::Size size, int type);
+
+    /**
+     * @brief Borrow a buffer with the same size and type as like
+     */
+    FrameLease acquireLike(const cv::Mat &like) { return acquire(like.size(), like.type()); }
+
+    /**
+     * @brief Borrow a buffer holding a copy of src
+     */
+    FrameLease copyOf(const cv::Mat &src);
+
+    /** @brief Buffers allocated by this pool (misses) */
+    long allocations() const { return allocations_; }
+
+    /** @brief Buffers currently held by the pool, free or leased */
+    int bufferCount() const { return static_cast<int>(buffers_.size()); }
+
+    /** @brief Free every buffer that is not leased */
+    void trim();
+
+    /**
+     * @brief The calling thread's pool
+     */
+    static FramePool &local();
+
+    /**
+     * @brief Allocations summed over every pool in the process
+     */
+    static long totalAllocations() { return totalAllocations_.load(); }
+
+private:
+    // True if only the pool refers to the buffer
+    static bool isFree(const cv::Mat &buffer);
+
+    std::vector<cv::Mat> buffers_;
+    int maxBuffers_;
+    long allocations_;
+
+    static std::atomic<long> totalAllocations_;
+};
+
+#endif // FRAME_POOL_HPP
@@ -0,0 +1,157 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Asynchronous snapshot and recording writer. JPEG/PNG encoding and
+           video encoding run on a worker thread fed by a bounded queue, so
+           saving a frame or recording never stalls the display loop.
+*/
+
+#ifndef FRAME_WRITER_HPP
+#define FRAME_WRITER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Snapshot of the writer's counters
+ */
+struct FrameWriterStats {
+    long snapshots = 0;       ///< Images written
+    long recorded = 0;        ///< Video frames written
+    long dropped = 0;         ///< Frames refused because the queue was full
+    long failed = 0;          ///< Encode or write errors
+    int queued = 0;           ///< Frames waiting for the worker
+    int capacity = 0;         ///< Queue capacity
+    int peakQueued = 0;       ///< Highest queue depth seen
+    double lastEncodeMs = 0.0;///< Duration of the most recent encode
+    bool recording = false;   ///< A recording is open
+    bool hwEncode = false;    ///< The video backend reports hardware encoding
+};
+
+/**
+ * @class FrameWriter
+ * @brief Writes snapshots and recordings on a worker thread
+ *
+ * Frames are handed over by swapping buffers: the caller's Mat moves into
+ * the queue and receives a buffer the worker has finished with, so a
+ * recording does not allocate in steady state and nothing is copied on the
+ * caller's thread. The queue is bounded; when the worker falls behind, new
+ * frames are dropped and counted instead of blocking the caller.
+ *
+ * Recordings go through cv::VideoWriter with CAP_FFMPEG and
+ * VIDEOWRITER_PROP_HW_ACCELERATION (NVENC, QSV, VAAPI, ... when the FFmpeg
+ * build has them), falling back to software encoding. The writer is opened
+ * on the worker with the size of the first recorded frame.
+ */
+class FrameWriter {
+public:
+    /**
+     * @brief Start the worker thread
+     *
+     * @param capacity Frames the queue holds before new ones are dropped
+     */
+    explicit FrameWriter(int capacity = 8);
+
+    /**
+     * @brief Finish queued work, close any recording and stop the worker
+     */
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    /**
+     * @brief Queue frame to be written as an image (format from the extension)
+     *
+     * @param frame Frame to save; swapped with a recycled buffer, so it no
+     *              longer holds the image afterwards
+     * @param path Output file
+     * @return false if the queue was full and the frame was dropped
+     */
+    bool saveImage(cv::Mat &frame, const std::string &path);
+
+    /**
+     * @brief Open a recording; frames follow through record()
+     *
+     * @param path Output video (.mp4, .avi, ...)
+     * @param fps Frame rate written to the file (30 if <= 0)
+     * @param fourcc Codec, e.g. cv::VideoWriter::fourcc('m','p','4','v')
+     */
+    void startRecording(const std::string &path, double fps,
+                        int fourcc = cv::VideoWriter::fourcc('m', 'p', '4', 'v'));
+
+    /**
+     * @brief Close the recording after the frames already queued
+     */
+    void stopRecording();
+
+    /** @brief True between startRecording() and stopRecording() */
+    bool recording() const { return recording_.load(); }
+
+    /**
+     * @brief Queue frame for the open recording
+     *
+     * @param frame Frame to record; swapped with a recycled buffer
+     * @return false if not recording or the frame was dropped
+     */
+    bool record(cv::Mat &frame);
+
+    /**
+     * @brief Counters and queue depth
+     */
+    FrameWriterStats stats() const;
+
+    /**
+     * @brief One-line summary for a window title or the info output,
+     *        e.g. "REC 12.4 s, 372 frames (HW), queue 1/8, 0 dropped"
+     */
+    std::string status() const;
+
+private:
+    enum JobKind { JOB_IMAGE, JOB_VIDEO_FRAME, JOB_OPEN, JOB_CLOSE };
+
+    struct Job {
+        JobKind kind;
+        cv::Mat image;
+        std::string path;
+        double fps = 0.0;
+        int fourcc = 0;
+    };
+
+    bool enqueueFrame(JobKind kind, cv::Mat &frame, const std::string &path);
+    void enqueueControl(Job job);
+    void workerLoop();
+    void writeVideoFrame(const cv::Mat &image);
+
+    int capacity_;
+
+    mutable std::mutex mutex_;        ///< Guards everything below
+    std::condition_variable cond_;
+    std::deque<Job> queue_;
+    std::vector<cv::Mat> spare_;      ///< Buffers returned by the worker
+    int queuedFrames_ = 0;            ///< Frame jobs in queue_ (control jobs excluded)
+    bool stop_ = false;
+    FrameWriterStats stats_;
+
+    std::atomic<bool> recording_{false};
+    cv::int64 recordStartTicks_ = 0;
+
+    // Worker-owned recording state
+    cv::VideoWriter video_;
+    std::string videoPath_;
+    double videoFps_ = 30.0;
+    int videoFourcc_ = 0;
+    cv::Size videoSize_;
+    bool videoPending_ = false;       ///< Open on the next recorded frame
+    cv::Mat converted_;               ///< Greyscale frames expanded to BGR
+
+    std::thread worker_;
+};
+
+#endif // FRAME_WRITER_HPP
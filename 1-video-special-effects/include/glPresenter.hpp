@@ -0,0 +1,109 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 27, 2026
+  Purpose: Header file for the OpenGL presenter. Frames are streamed into a
+           persistent texture through pixel buffer objects and blitted to a
+           GLFW window, with keyboard input from GLFW callbacks; a lower
+           latency replacement for imshow + waitKey.
+*/
+
+#ifndef GL_PRESENTER_HPP
+#define GL_PRESENTER_HPP
+
+#include <opencv2/core.hpp>
+#include <deque>
+#include <memory>
+#include <string>
+
+struct GLFWwindow;
+
+/**
+ * @class GLPresenter
+ * @brief Shows BGR / BGRA / grey frames in an OpenGL window
+ *
+ * present() copies the frame into one of two pixel buffer objects and
+ * updates the texture from it, so the driver uploads asynchronously while
+ * the next frame is processed (the copy goes into memory the driver owns,
+ * no HighGUI conversion or extra window bitmap). The texture is kept for as
+ * long as the frame size does not change and is drawn with a framebuffer
+ * blit, letterboxed to the window. Grey and BGRA frames are converted to
+ * BGR while being copied, so the texture is always 3-channel.
+ *
+ * Vsync is a choice: on (swap interval 1) never tears but can wait up to a
+ * refresh for the swap; off presents immediately.
+ *
+ * Keys arrive through GLFW callbacks and are queued; pollKey() returns them
+ * in order with the codes waitKey would (printable characters, 27 for ESC,
+ * 13 for Enter). All calls must come from the thread that called open().
+ */
+class GLPresenter {
+public:
+    GLPresenter();
+    ~GLPresenter();
+
+    GLPresenter(const GLPresenter &) = delete;
+    GLPresenter &operator=(const GLPresenter &) = delete;
+
+    /**
+     * @brief Create the window and its OpenGL 3.3 context
+     * @param title Window title
+     * @param size Initial client size (the frame size, like WINDOW_AUTOSIZE)
+     * @param vsync Wait for the display refresh when presenting
+     * @return true on success, false if GLFW or the context is unavailable
+     */
+    bool open(const std::string &title, cv::Size size, bool vsync = true);
+
+    /** @brief Destroy the window (also done by the destructor) */
+    void close();
+
+    /** @brief True until the window was closed by the user or close() */
+    bool isOpen() const;
+
+    /**
+     * @brief Upload frame and show it
+     * @param frame CV_8UC3 (BGR), CV_8UC4 (BGRA) or CV_8UC1
+     */
+    void present(const cv::Mat &frame);
+
+    /**
+     * @brief Process window events and take the oldest pending key
+     * @param timeoutMs Longest wait for a key when none is pending; 0 only
+     *                  polls (waitKey(1) without its sleep)
+     * @return Key code, -1 if none is pending
+     */
+    int pollKey(int timeoutMs = 0);
+
+    void setTitle(const std::string &title);
+
+    void setVsync(bool vsync);
+    bool vsync() const { return vsync_; }
+
+    /**
+     * @brief The texture holding the last presented frame (0 before the
+     *        first), for GPU paths that render into it directly
+     */
+    unsigned int texture() const { return texture_; }
+
+private:
+    struct GLFunctions;
+
+    static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+    static void charCallback(GLFWwindow *window, unsigned int codepoint);
+
+    // (Re)creates the texture, its framebuffer and the buffers for a new
+    // frame size
+    bool allocate(cv::Size size);
+    void releaseBuffers();
+
+    GLFWwindow *window_;
+    std::unique_ptr<GLFunctions> gl_;
+    bool vsync_;
+    unsigned int texture_;
+    unsigned int framebuffer_;
+    unsigned int pbo_[2];
+    int nextPbo_;
+    cv::Size textureSize_;
+    std::deque<int> keys_;
+};
+
+#endif // GL_PRESENTER_HPP
@@ -0,0 +1,166 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Header file for multi-camera capture. Every camera gets a capture
+           thread and a filter thread connected by a latest-frame slot, and a
+           compositor tiles the processed outputs into one image with
+           per-camera frame rates and drop counts.
+*/
+
+#ifndef MULTI_CAMERA_HPP
+#define MULTI_CAMERA_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/capture.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frameGraph.hpp"
+#include "faceTracker.hpp"
+
+/**
+ * @brief Snapshot of one camera's throughput counters
+ */
+struct CameraStats {
+    int cameraIndex;      ///< Camera index passed to cvcore::FrameSource::open
+    double captureFps;    ///< Frames read from the device per second
+    double processFps;    ///< Frames filtered per second
+    long captured;        ///< Frames read since start
+    long processed;       ///< Frames filtered since start
+    long captureDrops;    ///< Captured frames replaced before the filter took them
+    long displayDrops;    ///< Filtered frames replaced before the compositor took them
+};
+
+/**
+ * @brief Renders one camera's output from its frame graph
+ *
+ * Called on the camera's filter thread; slot is the camera's position in
+ * the rig, for per-camera state such as particle pools.
+ */
+typedef std::function<int(int slot, FrameGraph &graph, cv::Mat &dst)> CameraFilter;
+
+/**
+ * @brief Supplies the depth map for a frame, or nullptr if none is needed
+ *
+ * Called on the filter thread before beginFrame(); the returned pointer is
+ * held until the next frame so the buffer cannot be recycled mid-filter.
+ */
+typedef std::function<std::shared_ptr<const cv::Mat>(int slot, const cv::Mat &frame)> CameraDepthSource;
+
+/**
+ * @class CameraWorker
+ * @brief Capture and filter threads for one camera
+ *
+ * The capture thread reads the device as fast as it delivers and publishes
+ * into a single slot; if the filter thread has not taken the previous frame
+ * yet, that frame is dropped and counted. The filter output is published the
+ * same way to the compositor. Frame buffers are swapped between the slots,
+ * so steady state does not allocate.
+ */
+class CameraWorker {
+public:
+    CameraWorker(int slot, int cameraIndex);
+    ~CameraWorker();
+
+    CameraWorker(const CameraWorker &) = delete;
+    CameraWorker &operator=(const CameraWorker &) = delete;
+
+    /**
+     * @brief Open the device
+     * @return 0 on success, -1 if the camera could not be opened
+     */
+    int open();
+
+    /**
+     * @brief Nominal frame size reported by the device (after open)
+     */
+    cv::Size frameSize() const { return frameSize_; }
+
+    /**
+     * @brief Start the capture and filter threads
+     */
+    void start(const CameraFilter &filter, const CameraDepthSource &depth);
+
+    /**
+     * @brief Stop both threads and wait for them
+     */
+    void stop();
+
+    /**
+     * @brief Take the newest filtered frame
+     *
+     * @param out Receives the frame (buffers are swapped, not copied)
+     * @return true if a frame newer than the last call was available
+     */
+    bool takeOutput(cv::Mat &out);
+
+    /**
+     * @brief Counters and measured rates
+     */
+    CameraStats stats() const;
+
+private:
+    void captureLoop();
+    void filterLoop();
+
+    int slot_;
+    int cameraIndex_;
+    std::unique_ptr<cvcore::FrameSource> capture_;
+    cv::Size frameSize_;
+
+    CameraFilter filter_;
+    CameraDepthSource depth_;
+
+    // Capture -> filter slot
+    std::mutex inputMutex_;
+    std::condition_variable inputCond_;
+    cv::Mat grabbed_, pending_;
+    bool hasInput_ = false;
+
+    // Filter-thread state
+    cv::Mat work_, rendered_;
+    FrameGraph graph_;
+    FaceTracker tracker_;
+
+    // Filter -> compositor slot
+    std::mutex outputMutex_;
+    cv::Mat output_;
+    bool hasOutput_ = false;
+
+    std::atomic<bool> stop_{false};
+    std::atomic<long> captured_{0}, processed_{0};
+    std::atomic<long> captureDrops_{0}, displayDrops_{0};
+    std::atomic<double> captureFps_{0.0}, processFps_{0.0};
+
+    std::thread captureThread_, filterThread_;
+};
+
+/**
+ * @brief Tile camera outputs into one image, row-major in a near-square grid
+ *
+ * Each tile is resized to tileSize and labelled with the camera index, its
+ * capture/filter rates and its drop counts. Empty tiles (camera not yet
+ * delivering) are drawn black.
+ *
+ * @param tiles Latest output of each camera (CV_8UC3 or CV_8UC1)
+ * @param stats Counters of each camera, same order as tiles
+ * @param tileSize Size of one tile in the composite
+ * @param canvas Output composite (reused between calls)
+ * @return 0 on success, -1 on error
+ */
+int composeTiles(const std::vector<cv::Mat> &tiles, const std::vector<CameraStats> &stats,
+                 const cv::Size &tileSize, cv::Mat &canvas);
+
+/**
+ * @brief Parse a comma separated camera list such as "0,1,2,3"
+ *
+ * @return 0 on success, -1 if any entry is not a non-negative integer
+ */
+int parseCameraList(const std::string &list, std::vector<int> &cameras);
+
+#endif // MULTI_CAMERA_HPP
@@ -0,0 +1,214 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Composable pointwise operations. pipe(sepia(), vignette(), negative())
+           builds a filter that runs the whole chain in one pass over the
+           frame: each pixel is loaded once, passed through every op in
+           registers and stored once, instead of one full pass and one
+           intermediate image per filter.
+*/
+
+#ifndef POINT_OPS_HPP
+#define POINT_OPS_HPP
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include "tiling.hpp"
+
+// Fixed-point precision of the sepia tables and of the vignette gain map
+const int SEPIA_LUT_BITS = 10;
+const int VIGNETTE_GAIN_BITS = 15;
+
+/**
+ * @brief Sepia matrix compiled into nine per-channel tables
+ *
+ * Entry [out][in][v] is round(coefficient * v) in Q10, so each output
+ * channel is three lookups and one shift. Shared by sepiaTone and OpSepia.
+ */
+struct SepiaTables {
+    int lut[3][3][256];  ///< [B', G', R'][B, G, R][value]
+    SepiaTables();
+};
+
+/**
+ * @brief The process-wide sepia tables (built on first use)
+ */
+const SepiaTables &sepiaTables();
+
+/**
+ * @brief Vignette gain map in Q15 (CV_16U, 32768 = 1.0)
+ *
+ * Cached for the last size and strength requested; shared by sepiaTone
+ * and OpVignette.
+ */
+std::shared_ptr<const cv::Mat> vignetteGainMap(cv::Size size, float strength);
+
+/**
+ * @brief One BGR pixel as it moves through an op chain
+ *
+ * Every op takes and returns channel values in [0, 255].
+ */
+struct PointPixel {
+    int b, g, r;
+};
+
+/*
+ * An op is a small copyable struct with
+ *   void prepare(cv::Size size)        once per call, before any row
+ *   void beginRow(int row)             once per row, before its pixels
+ *   PointPixel operator()(PointPixel p, int col) const
+ * Ops are copied per row band, so row state set in beginRow is band-local.
+ */
+
+/**
+ * @brief Sepia tone matrix (the colour part of sepiaTone)
+ */
+struct OpSepia {
+    const SepiaTables *tables = &sepiaTables();
+
+    void prepare(cv::Size) {}
+    void beginRow(int) {}
+    PointPixel operator()(PointPixel p, int) const {
+        const SepiaTables &t = *tables;
+        PointPixel o;
+        o.b = std::min((t.lut[0][0][p.b] + t.lut[0][1][p.g] + t.lut[0][2][p.r]) >> SEPIA_LUT_BITS, 255);
+        o.g = std::min((t.lut[1][0][p.b] + t.lut[1][1][p.g] + t.lut[1][2][p.r]) >> SEPIA_LUT_BITS, 255);
+        o.r = std::min((t.lut[2][0][p.b] + t.lut[2][1][p.g] + t.lut[2][2][p.r]) >> SEPIA_LUT_BITS, 255);
+        return o;
+    }
+};
+
+/**
+ * @brief Radial vignette (the darkening part of sepiaTone)
+ */
+struct OpVignette {
+    float strength = 1.2f;
+    std::shared_ptr<const cv::Mat> gain;
+    const ushort *gainRow = nullptr;
+
+    void prepare(cv::Size size) { gain = vignetteGainMap(size, strength); }
+    void beginRow(int row) { gainRow = gain->ptr<ushort>(row); }
+    PointPixel operator()(PointPixel p, int col) const {
+        const int k = gainRow[col];
+        return {(p.b * k) >> VIGNETTE_GAIN_BITS, (p.g * k) >> VIGNETTE_GAIN_BITS,
+                (p.r * k) >> VIGNETTE_GAIN_BITS};
+    }
+};
+
+/**
+ * @brief 255 - value (negativeEffect)
+ */
+struct OpNegate {
+    void prepare(cv::Size) {}
+    void beginRow(int) {}
+    PointPixel operator()(PointPixel p, int) const {
+        return {255 - p.b, 255 - p.g, 255 - p.r};
+    }
+};
+
+/**
+ * @brief Channel-difference greyscale |R - B| + G / 2 (greyscale)
+ */
+struct OpGrey {
+    void prepare(cv::Size) {}
+    void beginRow(int) {}
+    PointPixel operator()(PointPixel p, int) const {
+        const int v = std::min(std::abs(p.r - p.b) + p.g / 2, 255);
+        return {v, v, v};
+    }
+};
+
+/**
+ * @brief Uniform quantization (value / bucket) * bucket (blurQuantize step 2)
+ */
+struct OpQuantize {
+    uchar table[256];
+
+    explicit OpQuantize(int levels) {
+        const int bucket = 255 / std::max(1, std::min(levels, 255));
+        for (int v = 0; v < 256; v++) {
+            table[v] = static_cast<uchar>((v / bucket) * bucket);
+        }
+    }
+    void prepare(cv::Size) {}
+    void beginRow(int) {}
+    PointPixel operator()(PointPixel p, int) const {
+        return {table[p.b], table[p.g], table[p.r]};
+    }
+};
+
+inline OpSepia sepia() { return OpSepia(); }
+inline OpVignette vignette(float strength = 1.2f) { OpVignette op; op.strength = strength; return op; }
+inline OpNegate negative() { return OpNegate(); }
+inline OpGrey grey() { return OpGrey(); }
+inline OpQuantize quantize(int levels) { return OpQuantize(levels); }
+
+/**
+ * @class PointPipeline
+ * @brief A chain of pointwise ops applied in a single pass
+ *
+ * The ops are template parameters, so the per-pixel chain is one inlined
+ * function body the compiler can keep in registers and vectorise where the
+ * ops are plain arithmetic (negate, grey); table ops stay scalar lookups.
+ * Rows run in parallel bands; src and dst may be the same image.
+ */
+template <typename... Ops>
+class PointPipeline {
+public:
+    explicit PointPipeline(Ops... ops) : ops_(ops...) {}
+
+    /**
+     * @brief Apply the chain; same signature as the filters in filters.hpp
+     *
+     * @param src Input image (CV_8UC3)
+     * @param dst Output image (CV_8UC3), may alias src
+     * @return 0 on success, -1 on error
+     */
+    int operator()(const cv::Mat &src, cv::Mat &dst) const {
+        if (src.empty() || src.type() != CV_8UC3) {
+            std::cerr << "Error: Point op chain needs a CV_8UC3 image" << std::endl;
+            return -1;
+        }
+        dst.create(src.size(), src.type());
+
+        std::tuple<Ops...> prepared = ops_;
+        std::apply([&](auto &... op) { (op.prepare(src.size()), ...); }, prepared);
+
+        parallelRowBands(src.rows, src.step + dst.step, [&](const cv::Range &band) {
+            std::tuple<Ops...> ops = prepared;
+            for (int row = band.start; row < band.end; row++) {
+                std::apply([&](auto &... op) { (op.beginRow(row), ...); }, ops);
+                const uchar *srcRow = src.ptr<uchar>(row);
+                uchar *dstRow = dst.ptr<uchar>(row);
+                for (int col = 0; col < src.cols; col++) {
+                    PointPixel p = {srcRow[col * 3], srcRow[col * 3 + 1], srcRow[col * 3 + 2]};
+                    std::apply([&](const auto &... op) { ((p = op(p, col)), ...); }, ops);
+                    dstRow[col * 3] = static_cast<uchar>(p.b);
+                    dstRow[col * 3 + 1] = static_cast<uchar>(p.g);
+                    dstRow[col * 3 + 2] = static_cast<uchar>(p.r);
+                }
+            }
+        });
+        return 0;
+    }
+
+private:
+    std::tuple<Ops...> ops_;
+};
+
+/**
+ * @brief Compose pointwise ops, applied left to right
+ *
+ * Example: pipe(sepia(), vignette(), negative())(src, dst) equals sepiaTone
+ * with vignetting followed by negativeEffect, in one pass.
+ */
+template <typename... Ops>
+PointPipeline<Ops...> pipe(Ops... ops) {
+    return PointPipeline<Ops...>(ops...);
+}
+
+#endif // POINT_OPS_HPP
@@ -0,0 +1,173 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Header file for the lightweight per-stage latency profiler used by
+           vidDisplay. Stages record samples into fixed-size lock-free ring
+           buffers; statistics, an on-screen overlay and CSV / Chrome trace
+           dumps are computed from the most recent samples.
+*/
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/allocTracking.hpp>
+#include <cvcore/metrics.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Maximum number of distinct stages a Profiler can track
+ */
+const int PROFILER_MAX_STAGES = 48;
+
+/**
+ * @brief Number of samples retained per stage (older samples are overwritten)
+ */
+const int PROFILER_RING_SIZE = 512;
+
+/**
+ * @brief Latency statistics of one stage over its retained samples
+ */
+struct StageStats {
+    std::string name;
+    size_t count;   // Samples used (at most PROFILER_RING_SIZE)
+    double mean;    // Milliseconds
+    double p50;
+    double p95;
+    double p99;
+    uint64_t allocs;   // Heap + cv::Mat allocations of the last ScopedTimer
+};
+
+/**
+ * @brief Per-stage latency recorder with lock-free ring buffers
+ *
+ * Each stage has a single writer thread (the thread that registered it).
+ * record() writes the sample slot and then publishes it by advancing an
+ * atomic head index, so the hot path takes no lock. Readers copy the slots
+ * behind the head; a slot being overwritten while read can at worst yield
+ * one stale sample, which is acceptable for percentile statistics.
+ */
+class Profiler {
+public:
+    Profiler();
+
+    /**
+     * @brief Register (or look up) a stage by name
+     *
+     * Takes a lock; call once per stage and keep the returned id.
+     *
+     * @param name Stage name shown in the overlay and dumps
+     * @param threadId Track id used in the Chrome trace (0 = main thread)
+     * @return Stage id, or -1 if PROFILER_MAX_STAGES is exceeded
+     */
+    int stage(const std::string& name, int threadId = 0);
+
+    /**
+     * @brief Record one sample for a stage
+     *
+     * @param stageId Id returned by stage()
+     * @param startUs Start time in microseconds since the profiler was created
+     * @param durationMs Duration in milliseconds
+     */
+    void record(int stageId, double startUs, double durationMs);
+
+    /**
+     * @brief Allocation totals of a stage (cvcore, CVCORE_ALLOC_TRACKING)
+     *
+     * @param stageId Id returned by stage(); -1 gives a shared "unassigned" stage
+     */
+    cvcore::AllocStage& allocStage(int stageId);
+
+    /**
+     * @brief Current time in microseconds since the profiler was created
+     */
+    double nowUs() const;
+
+    /**
+     * @brief Statistics for all stages that have at least one sample
+     */
+    std::vector<StageStats> stats() const;
+
+    /**
+     * @brief Draw a translucent table of p50/p95/p99 per stage onto a frame
+     *
+     * @param frame BGR frame to draw on (modified in place)
+     */
+    void drawOverlay(cv::Mat& frame) const;
+
+    /**
+     * @brief Write every retained sample as CSV (stage,start_us,duration_ms)
+     *
+     * @param path Output file path
+     * @return 0 on success, -1 on error
+     */
+    int writeCSV(const std::string& path) const;
+
+    /**
+     * @brief Write retained samples in Chrome trace event format
+     *
+     * The file can be opened in chrome://tracing or Perfetto.
+     *
+     * @param path Output file path
+     * @return 0 on success, -1 on error
+     */
+    int writeChromeTrace(const std::string& path) const;
+
+private:
+    struct Sample {
+        double startUs;
+        float durationMs;
+    };
+
+    struct StageRing {
+        std::array<Sample, PROFILER_RING_SIZE> samples;
+        std::atomic<uint64_t> head;
+        std::string name;
+        int threadId;
+        cvcore::Histogram* metric;   ///< vfx_stage_seconds{stage=name}
+        cvcore::AllocStage* allocs;  ///< Allocations inside ScopedTimers
+    };
+
+    // Copies the retained samples of one stage, oldest first
+    std::vector<Sample> snapshot(int stageId) const;
+
+    std::chrono::steady_clock::time_point epoch_;
+    std::array<StageRing, PROFILER_MAX_STAGES> rings_;
+    std::atomic<int> stageCount_;
+    mutable std::mutex registerMutex_;
+};
+
+/**
+ * @brief RAII timer that records the lifetime of a scope into a stage
+ *
+ * Allocations made on the calling thread inside the scope are added to the
+ * stage's cvcore::AllocStage (counted only with CVCORE_ALLOC_TRACKING).
+ *
+ * Usage: { ScopedTimer t(profiler, captureStage); capdev >> frame; }
+ */
+class ScopedTimer {
+public:
+    ScopedTimer(Profiler& profiler, int stageId)
+        : profiler_(profiler), stageId_(stageId), allocs_(profiler.allocStage(stageId)),
+          startUs_(profiler.nowUs()) {}
+
+    ~ScopedTimer() {
+        profiler_.record(stageId_, startUs_, (profiler_.nowUs() - startUs_) / 1000.0);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Profiler& profiler_;
+    int stageId_;
+    cvcore::AllocStageScope allocs_;
+    double startUs_;
+};
+
+#endif // PROFILER_HPP
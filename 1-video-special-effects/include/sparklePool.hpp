@@ -0,0 +1,112 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 25, 2026
+  Purpose: Header file for the batched sparkle particle system. Particles are
+           stored as a structure of arrays in a fixed-capacity arena, updated
+           four at a time with SIMD, splatted additively into one float
+           overlay and composited onto the frame once.
+*/
+
+#ifndef SPARKLE_POOL_HPP
+#define SPARKLE_POOL_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Fixed-capacity pool of sparkles orbiting detected faces
+ *
+ * Replaces the per-particle drawSparkle loop of sparkleEffect for large
+ * particle counts. The motion model is the same (tilted elliptical orbit,
+ * depth-scaled size and brightness, pulsing), but:
+ * - Each attribute lives in its own contiguous array, so the per-frame
+ *   update is a straight SIMD sweep. The orbit angle is kept as a unit
+ *   (cos, sin) pair advanced by a per-particle rotation, which removes all
+ *   trigonometry from the update.
+ * - Glow sprites are precomputed per size bucket and accumulated
+ *   additively into a CV_32FC3 overlay. Additive light is order
+ *   independent, so no depth sort is needed.
+ * - The overlay is added to the frame with one saturating composite over
+ *   the bounding box of the splats.
+ *
+ * The arena is allocated once in the constructor; changing the particle
+ * count or the number of faces re-seeds particles in place.
+ */
+class SparklePool {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Maximum number of live particles across all faces
+     */
+    explicit SparklePool(int capacity = 8192);
+
+    /**
+     * @brief Set the number of particles emitted per face
+     *
+     * Takes effect on the next render(); the total is clamped to capacity().
+     */
+    void setParticlesPerFace(int count);
+    int particlesPerFace() const { return particlesPerFace_; }
+
+    int capacity() const { return capacity_; }
+
+    /**
+     * @brief Number of live particles after the last render()
+     */
+    int liveCount() const { return count_; }
+
+    /**
+     * @brief Advance the particles one step and draw them onto src
+     *
+     * @param src Source image (CV_8UC3)
+     * @param dst Destination image (src plus sparkle light)
+     * @param faces Face rectangles the particles orbit
+     * @param time Animation time in seconds (drives the pulsing)
+     * @return 0 on success, -1 on error
+     */
+    int render(const cv::Mat &src, cv::Mat &dst,
+               const std::vector<cv::Rect> &faces, float time);
+
+private:
+    // Seed particlesPerFace_ particles around each face
+    void spawn(const std::vector<cv::Rect> &faces);
+
+    // SIMD sweep: rotate orbits, project, compute splat size and brightness
+    void update(float time);
+
+    // Accumulate every particle's sprite into overlay_; returns dirty box
+    cv::Rect splat(const std::vector<cv::Rect> &faces);
+
+    // Precompute glow sprites (with and without the center cross)
+    void buildSprites();
+
+    int capacity_;
+    int particlesPerFace_;
+    int count_;
+    size_t spawnedFaces_;   // Face count the particles were seeded for
+    bool reseed_;           // Particle count changed since the last spawn
+
+    // Structure of arrays, capacity_ floats each (face index as int)
+    std::vector<float> cosA_, sinA_;        // Orbit angle as unit vector
+    std::vector<float> cosStep_, sinStep_;  // Per-frame rotation
+    std::vector<float> radius_;
+    std::vector<float> cosPhase_, sinPhase_;
+    std::vector<float> size_;
+    std::vector<float> colorB_, colorG_, colorR_;
+    std::vector<int> face_;
+
+    // Update outputs
+    std::vector<float> posX_, posY_;        // Offset from face center
+    std::vector<float> drawSize_;
+    std::vector<float> alpha_;
+
+    // sprites_[cross][bucket]: CV_32FC1 glow kernel for radius bucket/2 px
+    std::vector<cv::Mat> sprites_[2];
+
+    cv::Mat overlay_;      // CV_32FC3 light accumulator
+    cv::Mat overlay8_;     // Saturated CV_8UC3 copy of the dirty box
+    cv::Rect dirty_;       // Overlay region touched by the previous frame
+};
+
+#endif // SPARKLE_POOL_HPP
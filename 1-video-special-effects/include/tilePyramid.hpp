@@ -0,0 +1,126 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Header file for the tiled image pyramid used by imgDisplay's
+           tiled mode. A large image is decoded once into fixed-size tiles
+           per pyramid level, stored on disk and memory-mapped, so viewing
+           touches only the tiles on screen; processed tiles are kept in a
+           bounded LRU cache.
+*/
+
+#ifndef TILE_PYRAMID_HPP
+#define TILE_PYRAMID_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/mappedFile.hpp>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TilePyramid
+ * @brief Memory-mapped tiles of every level of an image pyramid
+ *
+ * Level 0 is the full image; each further level halves both sides
+ * (INTER_AREA) until the whole image fits in one tile. Each level is one
+ * file of tileSize x tileSize BGR tiles in row-major tile order (edge tiles
+ * padded by replication), next to a "pyramid.yml" header. The cache
+ * directory is reused as long as the source file's size and modification
+ * time match, so the slow decode happens once per image.
+ */
+class TilePyramid {
+public:
+    /**
+     * @brief Open the tile cache for an image, building it if needed
+     *
+     * @param imagePath Source image
+     * @param cacheDir Tile directory; empty = "<imagePath>.tiles"
+     * @param tileSize Tile side in pixels (used when building)
+     * @return 0 on success, -1 on error
+     */
+    int open(const std::string &imagePath, const std::string &cacheDir = "",
+             int tileSize = 256);
+
+    int levels() const { return static_cast<int>(levels_.size()); }
+    int tileSize() const { return tileSize_; }
+
+    /** @brief Image size at a level */
+    cv::Size levelSize(int level) const { return levels_[level].size; }
+
+    /** @brief Number of tiles across and down at a level */
+    cv::Size tileGrid(int level) const { return levels_[level].grid; }
+
+    /**
+     * @brief One tile as a read-only view into the mapping (no copy)
+     *
+     * Edge tiles are cropped to the image; the caller must not write to it.
+     *
+     * @return CV_8UC3 tile, empty if out of range
+     */
+    cv::Mat tile(int level, int tx, int ty) const;
+
+    /** @brief Bytes of tile data on disk over all levels */
+    size_t cacheBytes() const;
+
+private:
+    struct Level {
+        cv::Size size;
+        cv::Size grid;
+        std::unique_ptr<cvcore::MappedFile> file;
+    };
+
+    // Decode the source and write every level's tile file and the header
+    int build(const std::string &imagePath, const std::string &cacheDir);
+
+    // Read the header; false if missing or written for another source
+    bool readHeader(const std::string &cacheDir, const std::string &imagePath);
+
+    int tileSize_ = 256;
+    std::vector<Level> levels_;
+};
+
+/**
+ * @class TileCache
+ * @brief Bounded LRU of processed tiles
+ *
+ * Tiles are keyed by level, tile position and a filter version; bumping
+ * the version (new filter settings) makes every old entry a miss, and old
+ * entries age out of the LRU as new ones are added.
+ */
+class TileCache {
+public:
+    /// Produces a processed tile from a source tile
+    using TileFilter = std::function<void(const cv::Mat &src, cv::Mat &dst)>;
+
+    explicit TileCache(size_t capacity = 256) : capacity_(capacity) {}
+
+    /**
+     * @brief Processed tile, computed with filter on a miss
+     */
+    const cv::Mat &get(const TilePyramid &pyramid, int level, int tx, int ty,
+                       uint32_t version, const TileFilter &filter);
+
+    void clear();
+    size_t size() const { return entries_.size(); }
+    size_t capacity() const { return capacity_; }
+    long hits() const { return hits_; }
+    long misses() const { return misses_; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        cv::Mat tile;
+    };
+
+    size_t capacity_;
+    std::list<Entry> entries_;   ///< Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    long hits_ = 0;
+    long misses_ = 0;
+};
+
+#endif // TILE_PYRAMID_HPP
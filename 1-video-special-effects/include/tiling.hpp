@@ -0,0 +1,20 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Header file for the row-band tiling layer used to run per-pixel
+           filters across all cores. The implementation lives in the shared
+           cvcore library (cvcore/parallel.hpp); this header keeps the
+           unqualified names the filters use.
+*/
+
+#ifndef TILING_HPP
+#define TILING_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/parallel.hpp>
+
+using cvcore::TILE_BAND_BYTES;
+using cvcore::tileBandRows;
+using cvcore::parallelRowBands;
+
+#endif // TILING_HPP
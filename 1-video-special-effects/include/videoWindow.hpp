@@ -0,0 +1,67 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 27, 2026
+  Purpose: Header file for the video window used by the live applications:
+           the OpenGL presenter when it was built, HighGUI otherwise.
+*/
+
+#ifndef VIDEO_WINDOW_HPP
+#define VIDEO_WINDOW_HPP
+
+#include <opencv2/core.hpp>
+#include <string>
+
+#ifdef USE_GL_PRESENTER
+#include "glPresenter.hpp"
+#endif
+
+/**
+ * @class VideoWindow
+ * @brief One display window with imshow / waitKey semantics
+ *
+ * With USE_GL_PRESENTER the window is a GLPresenter (PBO upload, no
+ * HighGUI copy, waitKey(1) does not sleep); the HighGUI window is the
+ * fallback when the build has no GLFW, the OpenGL context cannot be
+ * created, or VFX_DISPLAY=highgui is set. VFX_VSYNC=0 presents without
+ * waiting for the display refresh (the OpenGL window only; HighGUI leaves
+ * vsync to its backend).
+ *
+ * The window opens on the first show(), sized to that frame.
+ */
+class VideoWindow {
+public:
+    explicit VideoWindow(const std::string &title);
+    ~VideoWindow();
+
+    VideoWindow(const VideoWindow &) = delete;
+    VideoWindow &operator=(const VideoWindow &) = delete;
+
+    /** @brief Show a CV_8UC1, CV_8UC3 or CV_8UC4 frame (imshow) */
+    void show(const cv::Mat &frame);
+
+    /**
+     * @brief Next key press (waitKey)
+     * @param delayMs Longest wait for a key; 1 only polls in the OpenGL window
+     * @return Key code, -1 if none; 27 (ESC) once the OpenGL window was closed
+     */
+    int waitKey(int delayMs = 1);
+
+    void setTitle(const std::string &title);
+
+    /** @brief True when frames go through the OpenGL presenter */
+    bool usesOpenGL() const { return useGL_; }
+
+    /** @brief "OpenGL (vsync on)", "HighGUI", ... for the startup log */
+    std::string description() const;
+
+private:
+    std::string title_;
+    bool opened_;
+    bool useGL_;
+    bool vsync_;
+#ifdef USE_GL_PRESENTER
+    GLPresenter presenter_;
+#endif
+};
+
+#endif // VIDEO_WINDOW_HPP
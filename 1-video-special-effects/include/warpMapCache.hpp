@@ -0,0 +1,108 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Header file for the remap table cache used by the warp effects.
+           Bulge, wave, swirl and face bulge warps precompute their per-pixel
+           source coordinates once per parameter set and then cost a single
+           cv::remap per frame.
+*/
+
+#ifndef WARP_MAP_CACHE_HPP
+#define WARP_MAP_CACHE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @enum WarpType
+ * @brief Identifies which warp a cached remap table belongs to
+ */
+enum WarpType {
+    WARP_BULGE,       ///< Full-frame bulge/pinch (param1 = strength)
+    WARP_WAVE,        ///< Full-frame sine wave (param1 = amplitude, param2 = frequency)
+    WARP_SWIRL,       ///< Full-frame swirl (param1 = angle in radians)
+    WARP_FACE_BULGE   ///< Face-local bulge (size = face size, param1 = strength)
+};
+
+/**
+ * @struct WarpMaps
+ * @brief Fixed-point remap tables for one warp configuration
+ *
+ * map1/map2 are the CV_16SC2 / CV_16UC1 pair produced by cv::convertMaps,
+ * which cv::remap consumes fastest. For WARP_FACE_BULGE the maps are local:
+ * coordinates are relative to the face rectangle's top-left corner, the
+ * table covers a window starting at `origin` (also relative to the face),
+ * and `mask` marks the pixels inside the bulge radius.
+ */
+struct WarpMaps {
+    cv::Mat map1;        ///< Integer coordinates + interpolation index (CV_16SC2)
+    cv::Mat map2;        ///< Interpolation table indices (CV_16UC1)
+    cv::Mat mask;        ///< Pixels affected by the warp (CV_8UC1), face bulge only
+    cv::Point origin;    ///< Window offset relative to the face, face bulge only
+};
+
+/**
+ * @class WarpMapCache
+ * @brief Small LRU cache of remap tables keyed by (effect, size, parameters)
+ *
+ * Tables are rebuilt only when the frame size or an effect parameter changes
+ * (for example when warpStrength is adjusted with +/-). Lookups are
+ * thread-safe; returned WarpMaps share data with the cache entry through
+ * cv::Mat reference counting, so they stay valid after eviction.
+ */
+class WarpMapCache {
+public:
+    /**
+     * @brief Construct a cache holding at most `capacity` tables
+     *
+     * @param capacity Maximum number of cached configurations (default: 8)
+     */
+    explicit WarpMapCache(size_t capacity = 8);
+
+    /**
+     * @brief Get (building if necessary) the remap tables for a warp
+     *
+     * @param type Warp effect
+     * @param size Frame size (or face size for WARP_FACE_BULGE)
+     * @param param1 First effect parameter (strength, amplitude or angle)
+     * @param param2 Second effect parameter (wave frequency, otherwise 0)
+     * @return Remap tables for the requested configuration
+     */
+    WarpMaps get(WarpType type, cv::Size size, float param1, float param2 = 0.0f);
+
+    /**
+     * @brief Drop all cached tables
+     */
+    void clear();
+
+    /**
+     * @brief Number of configurations currently cached
+     */
+    size_t size() const;
+
+    /**
+     * @brief Process-wide cache shared by the warp effects in filters.cpp
+     */
+    static WarpMapCache &shared();
+
+private:
+    struct Entry {
+        WarpType type;
+        cv::Size size;
+        float param1;
+        float param2;
+        uint64_t lastUsed;
+        WarpMaps maps;
+    };
+
+    static WarpMaps build(WarpType type, cv::Size size, float param1, float param2);
+
+    size_t capacity_;
+    uint64_t clock_;
+    std::vector<Entry> entries_;
+    mutable std::mutex mutex_;
+};
+
+#endif // WARP_MAP_CACHE_HPP
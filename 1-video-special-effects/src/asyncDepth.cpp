@@ -0,0 +1,119 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the asynchronous depth estimation stage.
+*/
+
+#include "asyncDepth.hpp"
+#include <algorithm>
+#include <chrono>
+
+AsyncDepthEstimator::AsyncDepthEstimator(DA2Network *network, float scaleFactor,
+                                         bool nativeResolution)
+    : network_(network),
+      scaleFactor_(scaleFactor),
+      nativeResolution_(nativeResolution) {
+    worker_ = std::thread(&AsyncDepthEstimator::workerLoop, this);
+}
+
+AsyncDepthEstimator::~AsyncDepthEstimator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool AsyncDepthEstimator::submit(const cv::Mat &frame) {
+    if (frame.empty() || network_ == nullptr) {
+        return false;
+    }
+
+    // Every Nth frame only; in between the last depth map is reused
+    long call = submitCalls_++;
+    if (call % interval_.load() != 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (hasPending_) {
+            // Latest frame wins: the older pending frame is never processed
+            dropped_++;
+        }
+        frame.copyTo(pendingFrame_);
+        hasPending_ = true;
+    }
+    cond_.notify_one();
+    return true;
+}
+
+std::shared_ptr<const cv::Mat> AsyncDepthEstimator::latest() const {
+    std::shared_ptr<DepthFrame> frame = std::atomic_load(&latest_);
+    if (!frame) {
+        return nullptr;
+    }
+    // Aliasing pointer: holding the map keeps its whole DepthFrame alive
+    return std::shared_ptr<const cv::Mat>(frame, &frame->depth);
+}
+
+std::shared_ptr<const DepthFrame> AsyncDepthEstimator::latestFrame() const {
+    return std::atomic_load(&latest_);
+}
+
+void AsyncDepthEstimator::setInterval(int interval) {
+    interval_.store(std::max(1, interval));
+}
+
+std::shared_ptr<DepthFrame> AsyncDepthEstimator::acquireOutputBuffer() {
+    std::shared_ptr<DepthFrame> published = std::atomic_load(&latest_);
+
+    // A buffer is free when only this pool holds it: not published and no
+    // reader still has it. Only this thread creates new references to pool
+    // buffers, so use_count() == 1 cannot race upwards.
+    for (const std::shared_ptr<DepthFrame> &buffer : outputBuffers_) {
+        if (buffer != published && buffer.use_count() == 1) {
+            return buffer;
+        }
+    }
+
+    outputBuffers_.push_back(std::make_shared<DepthFrame>());
+    return outputBuffers_.back();
+}
+
+void AsyncDepthEstimator::workerLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return stop_ || hasPending_; });
+            if (stop_) {
+                break;
+            }
+
+            // Swap rather than copy: the old work frame becomes the next
+            // pending buffer, so steady state needs no allocation
+            cv::swap(pendingFrame_, workFrame_);
+            hasPending_ = false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::shared_ptr<DepthFrame> output = acquireOutputBuffer();
+        if (network_->set_input(workFrame_, scaleFactor_) == 0 &&
+            network_->run_network(output->depth,
+                                  nativeResolution_ ? cv::Size() : workFrame_.size()) == 0) {
+            if (nativeResolution_) {
+                cv::resize(workFrame_, output->guide, output->depth.size(), 0, 0, cv::INTER_AREA);
+            }
+            std::atomic_store(&latest_, output);
+            completed_++;
+        }
+
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        lastInferenceMs_.store(elapsed.count());
+    }
+}
@@ -0,0 +1,113 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Benchmark comparing the three 5x5 Gaussian blur implementations
+           (blur5x5_1 naive, blur5x5_2 separable, blur5x5_simd vectorized),
+           timed and reported by the shared harness (cvcore/benchmark.hpp).
+*/
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/benchmark.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "filters.hpp"
+
+using namespace cv;
+using namespace std;
+
+/*
+  Function: timeBlur
+  Purpose: Time a blur function through the harness and print its median
+  Arguments:
+    suite - harness collecting the results
+    name - case name
+    fn - blur function to benchmark
+    src - input image
+    dst - output image (result of the last run)
+  Return value: median milliseconds per call, 0 if --filter skips it, or -1 on error
+*/
+double timeBlur(cvcore::BenchSuite &suite, const string& name, int (*fn)(Mat&, Mat&), Mat& src,
+                Mat& dst) {
+    if (!suite.selected(name)) {
+        return 0.0;
+    }
+    const cvcore::BenchResult *r = suite.run(name, [&]() { return fn(src, dst) == 0; },
+                                             (double)src.total(), "pixel");
+    if (r == nullptr) {
+        cerr << "Error: " << name << " failed" << endl;
+        return -1.0;
+    }
+
+    cout << "  " << left << setw(14) << name << right << fixed << setprecision(3)
+         << setw(10) << r->p50Ms << " ms/frame" << setw(10) << setprecision(3)
+         << r->p99Ms << " ms p99" << setw(10) << setprecision(1)
+         << (1000.0 / r->p50Ms) << " fps" << endl;
+    return r->p50Ms;
+}
+
+/*
+  Function: main
+  Purpose: Benchmark entry point
+  Arguments:
+    [image] - optional image path (default: synthetic 1920x1080 frame)
+    [iterations] - optional fixed iteration count (default: harness --min-time)
+    harness options (--json, --compare, ...) in any position
+  Return value: 0 on success, -1 if outputs disagree, on error or regression
+*/
+int main(int argc, char* argv[]) {
+    cvcore::BenchOptions options;
+    vector<string> positional;
+    for (int i = 1; i < argc; i++) {
+        if (!options.consume(i, argc, argv)) {
+            positional.push_back(argv[i]);
+        }
+    }
+
+    Mat src;
+    if (!positional.empty()) {
+        src = imread(positional[0], IMREAD_COLOR);
+        if (src.empty()) {
+            cerr << "Error: Unable to read image " << positional[0] << endl;
+            return -1;
+        }
+    } else {
+        src = cvcore::syntheticImage(Size(1920, 1080));
+    }
+
+    if (positional.size() > 1) {
+        options.minIterations = options.maxIterations = max(1, atoi(positional[1].c_str()));
+        options.minSeconds = 0.0;
+    }
+
+    cvcore::BenchSuite suite("blurBench", options);
+    cout << "=== 5x5 Blur Benchmark ===" << endl;
+    suite.printEnvironment(cout);
+    cout << "Frame size: " << src.cols << " x " << src.rows << endl;
+    cout << endl;
+
+    Mat out1, out2, outSimd;
+    double t1 = timeBlur(suite, "blur5x5_1", blur5x5_1, src, out1);
+    double t2 = timeBlur(suite, "blur5x5_2", blur5x5_2, src, out2);
+    double t3 = timeBlur(suite, "blur5x5_simd", blur5x5_simd, src, outSimd);
+
+    if (t1 < 0 || t2 < 0 || t3 < 0) {
+        return -1;
+    }
+
+    if (t1 > 0 && t2 > 0 && t3 > 0) {
+        cout << endl;
+        cout << "Speedup vs blur5x5_1: " << setprecision(1) << (t1 / t3) << "x" << endl;
+        cout << "Speedup vs blur5x5_2: " << setprecision(1) << (t2 / t3) << "x" << endl;
+
+        // blur5x5_simd normalizes once, so it must match the naive version exactly
+        double maxDiff = norm(out1, outSimd, NORM_INF);
+        cout << "Max difference vs blur5x5_1: " << maxDiff << endl;
+        if (maxDiff != 0.0) {
+            cerr << "Error: blur5x5_simd output differs from blur5x5_1" << endl;
+            return -1;
+        }
+    }
+
+    return suite.finish() ? 0 : -1;
+}
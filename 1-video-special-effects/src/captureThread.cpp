@@ -0,0 +1,82 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the capture thread and its latest-frame ring.
+*/
+
+#include "captureThread.hpp"
+#include <chrono>
+#include <iostream>
+
+CaptureThread::CaptureThread(cvcore::FrameSource &source)
+    : source_(source), back_(0), front_(1), middle_(2) {}
+
+CaptureThread::~CaptureThread() {
+    stop();
+}
+
+int CaptureThread::start() {
+    if (thread_.joinable()) {
+        std::cerr << "Error: Capture thread is already running" << std::endl;
+        return -1;
+    }
+    stop_ = false;
+    finished_ = false;
+    thread_ = std::thread(&CaptureThread::captureLoop, this);
+    return 0;
+}
+
+void CaptureThread::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void CaptureThread::captureLoop() {
+    while (!stop_) {
+        CapturedFrame &slot = slots_[back_];
+        if (!source_.read(slot)) {
+            std::cerr << "Error: Capture device stopped delivering frames" << std::endl;
+            finished_ = true;
+            break;
+        }
+        // A V4L2 driver buffer goes back to the device on the next read
+        slot.raw.release();
+        captured_++;
+
+        // Publish: the filled slot becomes the middle one, the old middle
+        // slot is ours to overwrite next
+        int previous = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+        if (previous & FRESH) {
+            dropped_++;
+        }
+        back_ = previous & 3;
+    }
+}
+
+bool CaptureThread::next(CapturedFrame &frame, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    // Only the capture thread sets FRESH and only this side clears it, so a
+    // fresh middle slot stays fresh until the exchange below
+    while ((middle_.load(std::memory_order_acquire) & FRESH) == 0) {
+        if (finished_ || std::chrono::steady_clock::now() >= deadline) {
+            // A frame published just before the device stopped is still taken
+            if ((middle_.load(std::memory_order_acquire) & FRESH) != 0) {
+                break;
+            }
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & 3;
+
+    CapturedFrame &slot = slots_[front_];
+    cv::swap(slot.image, frame.image);
+    frame.sequence = slot.sequence;
+    frame.ticks = slot.ticks;
+    frame.deviceMs = slot.deviceMs;
+    return true;
+}
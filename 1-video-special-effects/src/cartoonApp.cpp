@@ -8,6 +8,10 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include "cartoonVideo.hpp"
+#include "captureThread.hpp"
+#include "frameWriter.hpp"
+#include "filters.hpp"
+#include "videoWindow.hpp"
 
 using namespace cv;
 using namespace std;
@@ -15,66 +19,155 @@ using namespace std;
 /**
  * @brief Main application entry point
  * 
- * Simple cartoon video stream with no user controls.
- * Press 'q' or ESC to quit.
+ * Simple cartoon video stream. Press 's' to save a frame, 'v' to start or
+ * stop recording (both encoded on a writer thread), 'm' to cycle the
+ * edge-preserving smoother, 'c' to show it side by side with the bilateral
+ * reference, 'x' to toggle incremental (changed tiles only) rendering,
+ * 'f' to switch between the fused and the reference stylization stages,
+ * 'q' or ESC to quit.
  * 
  * @param argc Number of command line arguments
- * @param argv Command line arguments (optional camera index)
+ * @param argv Command line arguments (argv[1] = optional camera index, video
+ *             file, stream URL or image sequence,
+ *             argv[2] = optional backend: "cpu" (default) or "ocl",
+ *             argv[3] = optional processing scale: 1 (default), 2 or 4,
+ *             argv[4] = optional smoother: "bilateral" (default), "domain",
+ *             "grid" or "guided")
  * @return 0 on success, -1 on error
  */
 int main(int argc, char* argv[]) {
     cout << "=== Cartoon Video Application ===" << endl;
     cout << "Based on Winnemoller et al. (2006)" << endl;
-    cout << "Press 'q' or ESC to quit\n" << endl;
+    cout << "Press 's' to save a frame, 'v' to record, 'm' to change smoother," << endl;
+    cout << "'c' to compare with bilateral, 'x' for incremental rendering," << endl;
+    cout << "'f' for fused / reference stylization, 'q' or ESC to quit\n" << endl;
     
-    // Get camera index
-    int cameraIndex = 0;
-    if (argc > 1) {
-        cameraIndex = atoi(argv[1]);
-    }
-    
-    // Open video capture
-    VideoCapture capdev(cameraIndex);
-    if (!capdev.isOpened()) {
+    // Open the camera (default 0) or the source given on the command line
+    unique_ptr<cvcore::FrameSource> source = cvcore::FrameSource::open(argc > 1 ? argv[1] : "");
+    if (!source) {
         cerr << "Error: Unable to open video device" << endl;
         return -1;
     }
     
-    cout << "Video device opened successfully!" << endl;
+    cout << "Video source opened: " << source->description() << endl;
     
     // Create cartoon processor with default parameters
     CartoonVideo cartoon;
+    if (argc > 2 && string(argv[2]) == "ocl") {
+        cartoon.setBackend(CARTOON_BACKEND_OPENCL);
+    }
+    if (argc > 3) {
+        cartoon.setProcessingScale(atoi(argv[3]));
+    }
+    if (argc > 4) {
+        CartoonSmoother smoother;
+        if (parseCartoonSmoother(argv[4], smoother)) {
+            cartoon.setSmoother(smoother);
+        } else {
+            cerr << "Error: Unknown smoother '" << argv[4] << "', using bilateral" << endl;
+        }
+    }
+    cout << "Processing scale: 1/" << cartoon.processingScale() << endl;
+    cout << "Smoother: " << cartoonSmootherName(cartoon.smoother()) << endl;
+    cout << "Backend: " << (cartoon.backend() == CARTOON_BACKEND_OPENCL ? "OpenCL (T-API)" : "CPU") << endl;
     
-    // Create display window
-    namedWindow("Cartoon Video", WINDOW_AUTOSIZE);
+    // Create display window (OpenGL presenter when built with GLFW)
+    VideoWindow window("Cartoon Video");
+    cout << "Display: " << window.description() << endl;
     
-    Mat frame, displayFrame;
+    // Camera reads run on their own thread; the loop always gets the newest
+    // frame, so a slow cartoon pass drops frames instead of queueing them
+    CaptureThread captureThread(*source);
+    if (captureThread.start() != 0) {
+        return -1;
+    }
+    
+    // Snapshots and recordings are encoded off the display loop
+    FrameWriter writer;
+    
+    CapturedFrame captured;
+    Mat &frame = captured.image;
+    Mat displayFrame;
+    bool compare = false;
+    long frameCount = 0;
     
     // Main video loop
     while (true) {
-        capdev >> frame;
-        
-        if (frame.empty()) {
+        if (!captureThread.next(captured) || frame.empty()) {
             cerr << "Error: Frame is empty" << endl;
             break;
         }
         
-        // Process frame
-        if (cartoon.processFrame(frame, displayFrame) != 0) {
-            displayFrame = frame.clone();
+        // Process frame (or the smoother comparison)
+        int status = compare ? cartoon.renderComparison(frame, displayFrame)
+                             : cartoon.processFrame(frame, displayFrame);
+        if (status != 0) {
+            frame.copyTo(displayFrame);
         }
         
-        imshow("Cartoon Video", displayFrame);
+        window.show(displayFrame);
+        
+        // Share of tiles re-rendered, in the title so it is not recorded
+        if (cartoon.incremental() && ++frameCount % 15 == 0) {
+            window.setTitle(format("Cartoon Video - incremental, %.0f%% of tiles",
+                                   100.0 * cartoon.dirtyFraction()));
+        }
         
         // Check for quit key
-        char key = (char)waitKey(1);
+        char key = (char)window.waitKey(1);
         if (key == 'q' || key == 'Q' || key == 27) {
             break;
         }
+        
+        // The writer takes displayFrame's buffer; it is refilled next frame
+        if (key == 's' || key == 'S') {
+            Mat shot = writer.recording() ? displayFrame.clone() : Mat();
+            if (!writer.saveImage(shot.empty() ? displayFrame : shot,
+                                  generateTimestampFilename("cartoon", ".jpg"))) {
+                cout << "Snapshot dropped: writer queue full" << endl;
+            }
+        }
+        if (writer.recording()) {
+            writer.record(displayFrame);
+        }
+        if (key == 'v' || key == 'V') {
+            if (writer.recording()) {
+                writer.stopRecording();
+                cout << "Recording stopped (" << writer.status() << ")" << endl;
+            } else {
+                writer.startRecording(generateTimestampFilename("cartoon", ".mp4"), source->fps());
+                cout << "Recording started (v to stop)" << endl;
+            }
+        }
+        if (key == 'm' || key == 'M') {
+            cartoon.setSmoother(static_cast<CartoonSmoother>((cartoon.smoother() + 1) % 4));
+            cartoon.resetTemporalBuffer();
+            cout << "Smoother: " << cartoonSmootherName(cartoon.smoother()) << endl;
+        }
+        if (key == 'x' || key == 'X') {
+            cartoon.setIncremental(!cartoon.incremental());
+            if (!cartoon.incremental()) {
+                window.setTitle("Cartoon Video");
+            }
+            cout << "Incremental rendering " << (cartoon.incremental() ? "on" : "off") << endl;
+        }
+        if (key == 'f' || key == 'F') {
+            cartoon.setFusedStylize(!cartoon.fusedStylize());
+            cout << "Stylization: " << (cartoon.fusedStylize() ? "fused" : "reference") << endl;
+        }
+        if (key == 'c' || key == 'C') {
+            compare = !compare;
+            cartoon.resetTemporalBuffer();
+            cout << "Comparison " << (compare ? "on" : "off") << endl;
+        }
     }
     
     // Cleanup
-    destroyAllWindows();
+    captureThread.stop();
+    writer.stopRecording();
+    cout << "Frames captured: " << captureThread.capturedCount()
+         << ", dropped: " << captureThread.droppedCount() << endl;
+    cout << "Frame writer: " << writer.status() << endl;
     cout << "Video capture closed." << endl;
     return 0;
 }
\ No newline at end of file
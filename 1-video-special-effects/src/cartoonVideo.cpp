@@ -6,7 +6,70 @@
 */
 
 #include "cartoonVideo.hpp"
+#include "filters.hpp"
+#include "edgePreserving.hpp"
+#include <cvcore/color.hpp>
+#include <cvcore/filter.hpp>
+#include <cvcore/parallel.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <mutex>
+
+// Change detection runs on a copy downsampled by this factor
+static const int CHANGE_DOWNSAMPLE = 4;
+
+// Incremental mode renders a full frame at least this often
+static const int INCREMENTAL_REFRESH_FRAMES = 60;
+
+// Fixed-point Gaussian taps: 8 fractional bits per direction
+static const int DOG_TAP_BITS = 8;
+
+// Edge pixels keep this share of their quantized colour
+static const float EDGE_DARKENING = 0.3f;
+
+/**
+ * @brief Gaussian taps scaled to sum exactly 1 << DOG_TAP_BITS
+ * 
+ * Same kernel size rule as detectEdgesDoG; rounding error goes to the
+ * centre tap.
+ */
+static std::vector<int> fixedPointGaussian(double sigma) {
+    int ksize = 2 * static_cast<int>(std::round(3 * sigma)) + 1;
+    if (ksize % 2 == 0) ksize++;
+    cv::Mat kernel = cv::getGaussianKernel(ksize, sigma, CV_64F);
+    std::vector<int> taps(ksize);
+    int sum = 0;
+    for (int i = 0; i < ksize; i++) {
+        taps[i] = static_cast<int>(std::lround(kernel.at<double>(i) * (1 << DOG_TAP_BITS)));
+        sum += taps[i];
+    }
+    taps[ksize / 2] += (1 << DOG_TAP_BITS) - sum;
+    return taps;
+}
+
+const char *cartoonSmootherName(CartoonSmoother smoother) {
+    switch (smoother) {
+    case CARTOON_SMOOTH_DOMAIN_TRANSFORM: return "domain";
+    case CARTOON_SMOOTH_BILATERAL_GRID:   return "grid";
+    case CARTOON_SMOOTH_GUIDED:           return "guided";
+    default:                              return "bilateral";
+    }
+}
+
+bool parseCartoonSmoother(const std::string &name, CartoonSmoother &smoother) {
+    const CartoonSmoother all[] = {CARTOON_SMOOTH_BILATERAL, CARTOON_SMOOTH_DOMAIN_TRANSFORM,
+                                   CARTOON_SMOOTH_BILATERAL_GRID, CARTOON_SMOOTH_GUIDED};
+    for (CartoonSmoother s : all) {
+        if (name == cartoonSmootherName(s)) {
+            smoother = s;
+            return true;
+        }
+    }
+    return false;
+}
 
 /**
  * @brief Default constructor with recommended parameters
@@ -24,10 +87,25 @@ CartoonVideo::CartoonVideo()
       dogSigma1_(0.5),
       dogSigma2_(2.0),
       dogThreshold_(0.01),
+      dogMin_(0.0),
+      dogMax_(0.0),
+      dogRangeValid_(false),
       quantizeLevels_(8),
+      fusedStylize_(true),
+      dogKernelSigma1_(0.0),
+      dogKernelSigma2_(0.0),
+      processingScale_(1),
+      smoother_(CARTOON_SMOOTH_BILATERAL),
+      incremental_(false),
+      tileSize_(64),
+      changeThreshold_(3.0),
+      framesSinceRefresh_(0),
+      lastDirtyFraction_(1.0),
       useTemporalSmoothing_(true),
       temporalAlpha_(0.7),
-      hasFirstFrame_(false) {
+      hasFirstFrame_(false),
+      backend_(CARTOON_BACKEND_CPU),
+      kernelTried_(false) {
 }
 
 /**
@@ -52,10 +130,25 @@ CartoonVideo::CartoonVideo(int bilateralD, double bilateralSigmaColor,
       dogSigma1_(dogSigma1),
       dogSigma2_(dogSigma2),
       dogThreshold_(dogThreshold),
+      dogMin_(0.0),
+      dogMax_(0.0),
+      dogRangeValid_(false),
       quantizeLevels_(quantizeLevels),
+      fusedStylize_(true),
+      dogKernelSigma1_(0.0),
+      dogKernelSigma2_(0.0),
+      processingScale_(1),
+      smoother_(CARTOON_SMOOTH_BILATERAL),
+      incremental_(false),
+      tileSize_(64),
+      changeThreshold_(3.0),
+      framesSinceRefresh_(0),
+      lastDirtyFraction_(1.0),
       useTemporalSmoothing_(true),
       temporalAlpha_(0.7),
-      hasFirstFrame_(false) {
+      hasFirstFrame_(false),
+      backend_(CARTOON_BACKEND_CPU),
+      kernelTried_(false) {
 }
 
 /**
@@ -78,29 +171,185 @@ int CartoonVideo::processFrame(const cv::Mat &src, cv::Mat &dst) {
         return -1;
     }
     
-    // Step 1: Apply bilateral filter for edge-preserving smoothing
-    cv::Mat smoothed;
-    applyBilateralFilter(src, smoothed);
+    if (backend_ == CARTOON_BACKEND_OPENCL) {
+        return processFrameOpenCL(src, dst);
+    }
+    
+    cv::Mat cartoon;
+    if (incremental_) {
+        // Steps 1-4 for the tiles that changed only
+        if (processIncremental(src) != 0) {
+            return -1;
+        }
+        cartoon = lastCartoon_;
+    } else {
+        // Step 1: Edge-preserving smoothing
+        cv::Mat smoothed;
+        if (smoothFrame(src, smoothed) != 0) {
+            return -1;
+        }
+        
+        // Steps 2-4: DoG edges, quantization, combine
+        stylize(smoothed, cartoon);
+    }
+    
+    // Step 5: Apply temporal smoothing for video coherence
+    if (useTemporalSmoothing_) {
+        applyTemporalSmoothing(cartoon, dst);
+    } else {
+        dst = cartoon.clone();
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Edge-preserving smoothing with the selected smoother
+ * 
+ * Optionally at reduced resolution, restored with a guided upsampler.
+ * 
+ * @param src Input frame (BGR color image)
+ * @param dst Output smoothed frame
+ * @return 0 on success, -1 on error
+ */
+int CartoonVideo::smoothFrame(const cv::Mat &src, cv::Mat &dst) {
+    if (processingScale_ > 1) {
+        cv::Mat low, lowSmoothed;
+        cv::resize(src, low, cv::Size(), 1.0 / processingScale_, 
+                  1.0 / processingScale_, cv::INTER_AREA);
+        applySmoothing(low, lowSmoothed);
+        return guidedUpsample(lowSmoothed, low, src, dst);
+    }
+    applySmoothing(src, dst);
+    return 0;
+}
+
+/**
+ * @brief DoG edges, quantization and combine on a smoothed frame
+ * 
+ * @param smoothed Output of smoothFrame
+ * @param dst Output cartoon frame (before temporal smoothing)
+ * @param fixedRange Reuse the DoG range of the last full frame
+ */
+void CartoonVideo::stylize(const cv::Mat &smoothed, cv::Mat &dst, bool fixedRange) {
+    if (fusedStylize_) {
+        stylizeFused(smoothed, dst, fixedRange);
+        return;
+    }
     
     // Step 2: Detect edges using Difference-of-Gaussians
     cv::Mat edges;
-    detectEdgesDoG(smoothed, edges);
+    detectEdgesDoG(smoothed, edges, fixedRange);
     
     // Step 3: Quantize colors
     cv::Mat quantized;
     quantizeColors(smoothed, quantized);
     
     // Step 4: Combine edges with quantized colors
-    cv::Mat cartoon;
-    combineEdgesAndColors(quantized, edges, cartoon);
+    combineEdgesAndColors(quantized, edges, dst);
+}
+
+/**
+ * @brief Re-render the tiles whose content changed
+ * 
+ * Tile means of |frame - reference| are taken on a 1/4-size copy; the
+ * reference of a tile is only updated when the tile is re-rendered, so
+ * slow drift accumulates until it crosses the threshold. Dirty tiles are
+ * rendered in horizontal runs, each padded by a halo covering the
+ * bilateral window and the DoG support, so results inside the run match a
+ * full-frame pass (closely, for the recursive domain-transform smoother).
+ * 
+ * @param src Input frame (BGR color image)
+ * @return 0 on success, -1 on error
+ */
+int CartoonVideo::processIncremental(const cv::Mat &src) {
+    const cv::Size smallSize(std::max(1, src.cols / CHANGE_DOWNSAMPLE),
+                             std::max(1, src.rows / CHANGE_DOWNSAMPLE));
+    cv::resize(src, changeSmall_, smallSize, 0, 0, cv::INTER_AREA);
     
-    // Step 5: Apply temporal smoothing for video coherence
-    if (useTemporalSmoothing_) {
-        applyTemporalSmoothing(cartoon, dst);
-    } else {
-        dst = cartoon.clone();
+    const int tilesX = (src.cols + tileSize_ - 1) / tileSize_;
+    const int tilesY = (src.rows + tileSize_ - 1) / tileSize_;
+    const int tiles = tilesX * tilesY;
+    bool full = lastCartoon_.size() != src.size() || changeRef_.size() != smallSize ||
+                framesSinceRefresh_ >= INCREMENTAL_REFRESH_FRAMES;
+    
+    // Mark tiles whose mean absolute difference exceeds the threshold
+    int dirtyCount = 0;
+    dirty_.assign(tiles, 0);
+    if (!full) {
+        cv::absdiff(changeSmall_, changeRef_, changeDiff_);
+        const int smallTile = tileSize_ / CHANGE_DOWNSAMPLE;
+        const cv::Rect smallBounds(0, 0, smallSize.width, smallSize.height);
+        for (int ty = 0; ty < tilesY; ty++) {
+            for (int tx = 0; tx < tilesX; tx++) {
+                cv::Rect r = cv::Rect(tx * smallTile, ty * smallTile, smallTile, smallTile) & smallBounds;
+                if (r.area() == 0) {
+                    // Edge tile lost to the downsample rounding: use the last row/column
+                    r = cv::Rect(std::min(tx * smallTile, smallSize.width - 1),
+                                 std::min(ty * smallTile, smallSize.height - 1), 1, 1);
+                }
+                cv::Scalar sad = cv::sum(changeDiff_(r));
+                double mean = (sad[0] + sad[1] + sad[2]) / (3.0 * r.area());
+                if (mean > changeThreshold_) {
+                    dirty_[ty * tilesX + tx] = 1;
+                    dirtyCount++;
+                }
+            }
+        }
+        // Past half the frame, the halos make a full pass cheaper
+        full = dirtyCount * 2 > tiles;
+    }
+    
+    if (full) {
+        cv::Mat smoothed;
+        if (smoothFrame(src, smoothed) != 0) {
+            return -1;
+        }
+        stylize(smoothed, lastCartoon_);
+        changeSmall_.copyTo(changeRef_);
+        framesSinceRefresh_ = 0;
+        lastDirtyFraction_ = 1.0;
+        return 0;
     }
     
+    // Halo: smoothing footprint (in full-resolution pixels), DoG support
+    // and the 2x2 edge dilation
+    const int halo = processingScale_ * std::max(bilateralD_, 8) +
+                     static_cast<int>(std::ceil(3.0 * dogSigma2_)) + 2;
+    const cv::Rect frame(0, 0, src.cols, src.rows);
+    cv::Mat smoothed, region;
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            if (!dirty_[ty * tilesX + tx]) {
+                continue;
+            }
+            int runEnd = tx + 1;
+            while (runEnd < tilesX && dirty_[ty * tilesX + runEnd]) {
+                runEnd++;
+            }
+            
+            const cv::Rect run = cv::Rect(tx * tileSize_, ty * tileSize_,
+                                          (runEnd - tx) * tileSize_, tileSize_) & frame;
+            const cv::Rect padded = cv::Rect(run.x - halo, run.y - halo,
+                                             run.width + 2 * halo, run.height + 2 * halo) & frame;
+            if (smoothFrame(src(padded), smoothed) != 0) {
+                return -1;
+            }
+            stylize(smoothed, region, true);
+            region(run - padded.tl()).copyTo(lastCartoon_(run));
+            
+            // The run becomes the new reference for its tiles
+            const cv::Rect smallRun = cv::Rect(run.x / CHANGE_DOWNSAMPLE, run.y / CHANGE_DOWNSAMPLE,
+                                               (run.width + CHANGE_DOWNSAMPLE - 1) / CHANGE_DOWNSAMPLE,
+                                               (run.height + CHANGE_DOWNSAMPLE - 1) / CHANGE_DOWNSAMPLE) &
+                                      cv::Rect(0, 0, smallSize.width, smallSize.height);
+            changeSmall_(smallRun).copyTo(changeRef_(smallRun));
+            tx = runEnd - 1;
+        }
+    }
+    
+    framesSinceRefresh_++;
+    lastDirtyFraction_ = static_cast<double>(dirtyCount) / tiles;
     return 0;
 }
 
@@ -127,6 +376,84 @@ void CartoonVideo::applyBilateralFilter(const cv::Mat &src, cv::Mat &dst) {
                        bilateralSigmaColor_, bilateralSigmaSpace_);
 }
 
+/**
+ * @brief Apply the selected edge-preserving smoother
+ * 
+ * cv::bilateralFilter cost grows with d^2; the alternatives are O(1) per
+ * pixel. With the default d = 9 the bilateral kernel is truncated at a
+ * radius of 4, far inside sigmaSpace = 90, so the fast smoothers use
+ * d / 2 as their spatial sigma to cover the same footprint.
+ * 
+ * @param src Input image
+ * @param dst Output smoothed image
+ */
+void CartoonVideo::applySmoothing(const cv::Mat &src, cv::Mat &dst) {
+    const double sigmaSpace = std::max(1.0, std::min(bilateralSigmaSpace_, bilateralD_ / 2.0));
+    const double sigmaColor = bilateralSigmaColor_;
+    
+    switch (smoother_) {
+    case CARTOON_SMOOTH_DOMAIN_TRANSFORM:
+        domainTransformFilter(src, dst, sigmaSpace, sigmaColor);
+        break;
+    case CARTOON_SMOOTH_BILATERAL_GRID:
+        bilateralGridFilter(src, dst, sigmaSpace, sigmaColor);
+        break;
+    case CARTOON_SMOOTH_GUIDED: {
+        // sqrt(eps) plays the role of the range sigma on 0-1 intensities
+        const double range = sigmaColor / 255.0;
+        guidedFilter(src, dst, static_cast<int>(std::ceil(sigmaSpace)), range * range);
+        break;
+    }
+    default:
+        applyBilateralFilter(src, dst);
+        break;
+    }
+}
+
+/**
+ * @brief Side-by-side comparison of the selected smoother and the reference
+ * 
+ * @param src Input frame (BGR color image)
+ * @param dst Output image: bilateral on the left, selected smoother right
+ * @return 0 on success, -1 on error
+ */
+int CartoonVideo::renderComparison(const cv::Mat &src, cv::Mat &dst) {
+    if (src.empty() || src.channels() != 3) {
+        std::cerr << "CartoonVideo: Invalid input image" << std::endl;
+        return -1;
+    }
+    
+    const CartoonSmoother selected = smoother_;
+    cv::Mat smoothed[2], cartoon[2];
+    double ms[2];
+    const CartoonSmoother order[2] = {CARTOON_SMOOTH_BILATERAL, selected};
+    for (int i = 0; i < 2; i++) {
+        smoother_ = order[i];
+        cv::int64 start = cv::getTickCount();
+        int status = smoothFrame(src, smoothed[i]);
+        ms[i] = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+        if (status != 0) {
+            smoother_ = selected;
+            return -1;
+        }
+        stylize(smoothed[i], cartoon[i]);
+    }
+    smoother_ = selected;
+    
+    char label[2][96];
+    std::snprintf(label[0], sizeof(label[0]), "bilateral %.1f ms", ms[0]);
+    std::snprintf(label[1], sizeof(label[1]), "%s %.1f ms, PSNR %.1f dB",
+                  cartoonSmootherName(selected), ms[1], cv::PSNR(smoothed[0], smoothed[1]));
+    for (int i = 0; i < 2; i++) {
+        cv::putText(cartoon[i], label[i], cv::Point(10, 25), cv::FONT_HERSHEY_SIMPLEX,
+                    0.6, cv::Scalar(0, 0, 0), 3);
+        cv::putText(cartoon[i], label[i], cv::Point(10, 25), cv::FONT_HERSHEY_SIMPLEX,
+                    0.6, cv::Scalar(255, 255, 255), 1);
+    }
+    cv::hconcat(cartoon[0], cartoon[1], dst);
+    return 0;
+}
+
 /**
  * @brief Detect edges using Difference-of-Gaussians (DoG)
  * 
@@ -145,6 +472,21 @@ void CartoonVideo::applyBilateralFilter(const cv::Mat &src, cv::Mat &dst) {
  * @param edges Output binary edge map
  */
 void CartoonVideo::detectEdgesDoG(const cv::Mat &src, cv::Mat &edges) {
+    detectEdgesDoG(src, edges, false);
+}
+
+/**
+ * @brief DoG edges, normalized by this image's range or the stored one
+ * 
+ * Partial frames in incremental mode see only part of the image, so their
+ * own min/max would shift the threshold from tile to tile; they reuse the
+ * range of the last full frame instead.
+ * 
+ * @param src Input image (should be smoothed)
+ * @param edges Output binary edge map
+ * @param fixedRange Use dogMin_/dogMax_ rather than measuring src
+ */
+void CartoonVideo::detectEdgesDoG(const cv::Mat &src, cv::Mat &edges, bool fixedRange) {
     // Convert to grayscale for edge detection
     cv::Mat gray;
     cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
@@ -168,11 +510,13 @@ void CartoonVideo::detectEdgesDoG(const cv::Mat &src, cv::Mat &edges) {
     cv::subtract(gauss1, gauss2, dog, cv::noArray(), CV_32F);
     
     // Normalize DoG to [0, 1] range
-    double minVal, maxVal;
-    cv::minMaxLoc(dog, &minVal, &maxVal);
+    if (!fixedRange) {
+        cv::minMaxLoc(dog, &dogMin_, &dogMax_);
+        dogRangeValid_ = true;
+    }
     
-    if (maxVal - minVal > 1e-6) {
-        dog = (dog - minVal) / (maxVal - minVal);
+    if (dogMax_ - dogMin_ > 1e-6) {
+        dog = (dog - dogMin_) / (dogMax_ - dogMin_);
     }
     
     // Threshold to create binary edge map
@@ -196,6 +540,170 @@ void CartoonVideo::detectEdgesDoG(const cv::Mat &src, cv::Mat &edges) {
     cv::dilate(edges, edges, kernel);
 }
 
+/**
+ * @brief Steps 2-4 in two full-frame passes
+ * 
+ * Pass 1 (fusedDoGEdges) reads the smoothed frame once per row band and
+ * writes the undilated edge mask. Pass 2 quantizes through a LUT, ORs the
+ * 2x2 neighbourhood of the mask (the reference path's cv::dilate) and
+ * darkens edge pixels. Both Gaussians round to 8 bits like GaussianBlur on
+ * CV_8U, so g1 - g2 is an integer grey-level difference as in the
+ * reference path and the normalized threshold becomes an integer one.
+ * 
+ * @param smoothed Output of smoothFrame (CV_8UC3)
+ * @param dst Output cartoon frame; must not alias smoothed
+ * @param fixedRange Keep the stored DoG range instead of updating it
+ */
+void CartoonVideo::stylizeFused(const cv::Mat &smoothed, cv::Mat &dst, bool fixedRange) {
+    if (dogKernel1_.empty() || dogKernelSigma1_ != dogSigma1_ || dogKernelSigma2_ != dogSigma2_) {
+        dogKernel1_ = fixedPointGaussian(dogSigma1_);
+        dogKernel2_ = fixedPointGaussian(dogSigma2_);
+        dogKernelSigma1_ = dogSigma1_;
+        dogKernelSigma2_ = dogSigma2_;
+    }
+    
+    int dogMin, dogMax;
+    if (!dogRangeValid_) {
+        // No previous frame to take the range from: measure it first
+        fusedDoGEdges(smoothed, INT_MIN, dogMin, dogMax);
+        dogMin_ = dogMin;
+        dogMax_ = dogMax;
+        dogRangeValid_ = true;
+    }
+    
+    // normalized < t  <=>  dog < min + t * (max - min); dog is an integer
+    const double range = dogMax_ - dogMin_;
+    const double limit = range > 1e-6 ? dogMin_ + dogThreshold_ * range : dogThreshold_;
+    fusedDoGEdges(smoothed, static_cast<int>(std::ceil(limit)), dogMin, dogMax);
+    if (!fixedRange) {
+        // Normalizes the next frame
+        dogMin_ = dogMin;
+        dogMax_ = dogMax;
+    }
+    
+    uchar quantized[256], darkened[256];
+    const int bucketSize = 255 / quantizeLevels_;
+    for (int v = 0; v < 256; v++) {
+        const int q = (v / bucketSize) * bucketSize;
+        quantized[v] = static_cast<uchar>(q);
+        darkened[v] = static_cast<uchar>(q * EDGE_DARKENING);
+    }
+    
+    const int cols = smoothed.cols;
+    dst.create(smoothed.size(), CV_8UC3);
+    cvcore::parallelRowBands(smoothed.rows, static_cast<size_t>(cols) * 8, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            const uchar *edge = edgeMask_.ptr<uchar>(y);
+            const uchar *edgeAbove = y > 0 ? edgeMask_.ptr<uchar>(y - 1) : edge;
+            const uchar *in = smoothed.ptr<uchar>(y);
+            uchar *out = dst.ptr<uchar>(y);
+            uchar left = 0;
+            for (int x = 0; x < cols; x++) {
+                // 2x2 dilation: this pixel, left, above, above-left
+                const uchar here = edge[x] | edgeAbove[x];
+                const uchar *table = (here | left) ? darkened : quantized;
+                left = here;
+                out[3 * x] = table[in[3 * x]];
+                out[3 * x + 1] = table[in[3 * x + 1]];
+                out[3 * x + 2] = table[in[3 * x + 2]];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Fixed-point DoG edges of a smoothed frame into edgeMask_
+ * 
+ * Each row band converts its rows plus a halo of the larger kernel radius
+ * to grey, keeps the horizontal sums of both kernels and combines them
+ * vertically; nothing but the one-byte mask is written per pixel. Borders
+ * reflect (BORDER_REFLECT_101) like GaussianBlur.
+ * 
+ * @param smoothed Smoothed frame (CV_8UC3)
+ * @param threshold Edge where g1 - g2 < threshold; INT_MIN measures only
+ * @param dogMin Smallest g1 - g2 over the frame
+ * @param dogMax Largest g1 - g2 over the frame
+ */
+void CartoonVideo::fusedDoGEdges(const cv::Mat &smoothed, int threshold, int &dogMin, int &dogMax) {
+    const int rows = smoothed.rows;
+    const int cols = smoothed.cols;
+    const int r1 = static_cast<int>(dogKernel1_.size()) / 2;
+    const int r2 = static_cast<int>(dogKernel2_.size()) / 2;
+    const int radius = std::max(r1, r2);
+    const int round = 1 << (2 * DOG_TAP_BITS - 1);
+    edgeMask_.create(smoothed.size(), CV_8UC1);
+    
+    // Padded column index of every tap, built once for all rows
+    std::vector<int> colIndex(static_cast<size_t>(cols + 2 * radius));
+    for (int x = -radius; x < cols + radius; x++) {
+        colIndex[x + radius] = cvcore::reflect101(std::max(-cols + 1, std::min(x, 2 * cols - 2)), cols);
+    }
+    
+    std::mutex rangeMutex;
+    dogMin = INT_MAX;
+    dogMax = INT_MIN;
+    const size_t bytesPerRow = static_cast<size_t>(cols) * (4 + 2 * sizeof(int) * (2 * radius + 1));
+    cvcore::parallelRowBands(rows, bytesPerRow, [&](const cv::Range &band) {
+        const int first = band.start - radius;
+        const int count = band.end - band.start + 2 * radius;
+        std::vector<uchar> gray(cols);
+        std::vector<int> h1(static_cast<size_t>(count) * cols), h2(h1.size());
+        
+        for (int i = 0; i < count; i++) {
+            const int y = cvcore::reflect101(std::max(-rows + 1, std::min(first + i, 2 * rows - 2)), rows);
+            cvcore::bgrToGrayRow(smoothed.ptr<uchar>(y), gray.data(), cols);
+            int *out1 = &h1[static_cast<size_t>(i) * cols];
+            int *out2 = &h2[static_cast<size_t>(i) * cols];
+            for (int x = 0; x < cols; x++) {
+                const int *idx1 = &colIndex[x + radius - r1];
+                const int *idx2 = &colIndex[x + radius - r2];
+                int sum1 = 0, sum2 = 0;
+                for (int k = 0; k <= 2 * r1; k++) {
+                    sum1 += dogKernel1_[k] * gray[idx1[k]];
+                }
+                for (int k = 0; k <= 2 * r2; k++) {
+                    sum2 += dogKernel2_[k] * gray[idx2[k]];
+                }
+                out1[x] = sum1;
+                out2[x] = sum2;
+            }
+        }
+        
+        std::vector<int> acc1(cols), acc2(cols);
+        int bandMin = INT_MAX, bandMax = INT_MIN;
+        for (int y = band.start; y < band.end; y++) {
+            std::fill(acc1.begin(), acc1.end(), round);
+            std::fill(acc2.begin(), acc2.end(), round);
+            const int row = y - band.start + radius;
+            for (int k = 0; k <= 2 * r1; k++) {
+                const int *h = &h1[static_cast<size_t>(row - r1 + k) * cols];
+                const int w = dogKernel1_[k];
+                for (int x = 0; x < cols; x++) {
+                    acc1[x] += w * h[x];
+                }
+            }
+            for (int k = 0; k <= 2 * r2; k++) {
+                const int *h = &h2[static_cast<size_t>(row - r2 + k) * cols];
+                const int w = dogKernel2_[k];
+                for (int x = 0; x < cols; x++) {
+                    acc2[x] += w * h[x];
+                }
+            }
+            uchar *mask = edgeMask_.ptr<uchar>(y);
+            for (int x = 0; x < cols; x++) {
+                const int dog = (acc1[x] >> (2 * DOG_TAP_BITS)) - (acc2[x] >> (2 * DOG_TAP_BITS));
+                bandMin = std::min(bandMin, dog);
+                bandMax = std::max(bandMax, dog);
+                mask[x] = dog < threshold ? 1 : 0;
+            }
+        }
+        
+        std::lock_guard<std::mutex> lock(rangeMutex);
+        dogMin = std::min(dogMin, bandMin);
+        dogMax = std::max(dogMax, bandMax);
+    });
+}
+
 /**
  * @brief Quantize colors into discrete levels (posterization)
  * 
@@ -314,7 +822,173 @@ void CartoonVideo::applyTemporalSmoothing(const cv::Mat &current, cv::Mat &dst)
  */
 void CartoonVideo::resetTemporalBuffer() {
     hasFirstFrame_ = false;
+    dogRangeValid_ = false;
+    lastCartoon_.release();
     previousFrame_.release();
+    uPrevious_.release();
+}
+
+// OpenCL source for the fused quantize + edge darkening kernel. One work
+// item per pixel; matches quantizeColors followed by combineEdgesAndColors.
+static const char *CARTOON_COMBINE_KERNEL =
+    "__kernel void cartoonCombine(\n"
+    "    __global const uchar *src, int src_step, int src_offset,\n"
+    "    __global const uchar *edges, int edges_step, int edges_offset,\n"
+    "    __global uchar *dst, int dst_step, int dst_offset, int rows, int cols,\n"
+    "    int bucket, float darken)\n"
+    "{\n"
+    "    int x = get_global_id(0);\n"
+    "    int y = get_global_id(1);\n"
+    "    if (x >= cols || y >= rows) return;\n"
+    "    __global const uchar *s = src + mad24(y, src_step, src_offset + x * 3);\n"
+    "    uchar e = edges[mad24(y, edges_step, edges_offset + x)];\n"
+    "    __global uchar *d = dst + mad24(y, dst_step, dst_offset + x * 3);\n"
+    "    for (int c = 0; c < 3; c++) {\n"
+    "        int q = (s[c] / bucket) * bucket;\n"
+    "        d[c] = e ? (uchar)(q * darken) : (uchar)q;\n"
+    "    }\n"
+    "}\n";
+
+/**
+ * @brief Select the execution backend
+ * 
+ * @param backend Requested backend
+ * @return The backend actually in use
+ */
+CartoonBackend CartoonVideo::setBackend(CartoonBackend backend) {
+    if (backend == CARTOON_BACKEND_OPENCL && !cv::ocl::haveOpenCL()) {
+        std::cerr << "CartoonVideo: OpenCL not available, using CPU backend" << std::endl;
+        backend = CARTOON_BACKEND_CPU;
+    }
+    if (backend == CARTOON_BACKEND_OPENCL) {
+        cv::ocl::setUseOpenCL(true);
+    }
+    if (backend != backend_) {
+        // Temporal state lives in a different buffer per backend
+        resetTemporalBuffer();
+    }
+    backend_ = backend;
+    return backend_;
+}
+
+/**
+ * @brief Cartoon pipeline on the T-API
+ * 
+ * Same stages as the CPU path. The source is uploaded once, every
+ * intermediate stays in a device buffer, and only the final blended frame
+ * is downloaded. The DoG threshold is applied with cv::compare against
+ * min + threshold * (max - min), which equals thresholding the normalized
+ * response without materializing it.
+ * 
+ * @param src Input frame (BGR color image)
+ * @param dst Output cartoon frame
+ * @return 0 on success, -1 on error
+ */
+int CartoonVideo::processFrameOpenCL(const cv::Mat &src, cv::Mat &dst) {
+    // Step 1: Smoothing. The fast smoothers are CPU code; their result is
+    // uploaded and the remaining stages stay on the device.
+    if (smoother_ != CARTOON_SMOOTH_BILATERAL) {
+        cv::Mat smoothed;
+        if (smoothFrame(src, smoothed) != 0) {
+            return -1;
+        }
+        smoothed.copyTo(uSmoothed_);
+    } else if (processingScale_ > 1) {
+        src.copyTo(uSrc_);
+        cv::resize(uSrc_, uLow_, cv::Size(), 1.0 / processingScale_, 
+                  1.0 / processingScale_, cv::INTER_AREA);
+        cv::bilateralFilter(uLow_, uLowSmoothed_, bilateralD_, 
+                           bilateralSigmaColor_, bilateralSigmaSpace_);
+        if (guidedUpsample(uLowSmoothed_, uLow_, uSrc_, uSmoothed_) != 0) {
+            return -1;
+        }
+    } else {
+        src.copyTo(uSrc_);
+        cv::bilateralFilter(uSrc_, uSmoothed_, bilateralD_, 
+                           bilateralSigmaColor_, bilateralSigmaSpace_);
+    }
+    
+    // Step 2: DoG edges
+    cv::cvtColor(uSmoothed_, uGray_, cv::COLOR_BGR2GRAY);
+    int ksize1 = 2 * static_cast<int>(std::round(3 * dogSigma1_)) + 1;
+    int ksize2 = 2 * static_cast<int>(std::round(3 * dogSigma2_)) + 1;
+    if (ksize1 % 2 == 0) ksize1++;
+    if (ksize2 % 2 == 0) ksize2++;
+    cv::GaussianBlur(uGray_, uGauss1_, cv::Size(ksize1, ksize1), dogSigma1_);
+    cv::GaussianBlur(uGray_, uGauss2_, cv::Size(ksize2, ksize2), dogSigma2_);
+    cv::subtract(uGauss1_, uGauss2_, uDog_, cv::noArray(), CV_32F);
+    
+    double minVal, maxVal;
+    cv::minMaxLoc(uDog_, &minVal, &maxVal);
+    double cutoff = (maxVal - minVal > 1e-6) 
+                    ? minVal + dogThreshold_ * (maxVal - minVal) 
+                    : dogThreshold_;
+    cv::compare(uDog_, cv::Scalar(cutoff), uEdges_, cv::CMP_LT);
+    
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
+    cv::dilate(uEdges_, uEdges_, kernel);
+    
+    // Steps 3+4: Fused quantize and combine
+    quantizeAndCombineOpenCL(uSmoothed_, uEdges_, uCartoon_);
+    
+    // Step 5: Temporal smoothing, kept on the device
+    if (useTemporalSmoothing_ && !uPrevious_.empty() && 
+        uPrevious_.size() == uCartoon_.size()) {
+        cv::addWeighted(uCartoon_, temporalAlpha_, 
+                       uPrevious_, 1.0 - temporalAlpha_, 0, uPrevious_);
+    } else {
+        uCartoon_.copyTo(uPrevious_);
+    }
+    
+    // Only the final frame leaves the device
+    uPrevious_.copyTo(dst);
+    return 0;
+}
+
+/**
+ * @brief Fused quantize + edge darkening on the device
+ * 
+ * @param smoothed Bilateral-filtered frame (CV_8UC3)
+ * @param edges Binary edge map (CV_8UC1)
+ * @param dst Output cartoon frame (CV_8UC3)
+ */
+void CartoonVideo::quantizeAndCombineOpenCL(const cv::UMat &smoothed, 
+                                           const cv::UMat &edges, cv::UMat &dst) {
+    const float edgeDarkeningFactor = 0.3f;
+    int bucketSize = 255 / quantizeLevels_;
+    dst.create(smoothed.size(), smoothed.type());
+    
+    if (!kernelTried_) {
+        kernelTried_ = true;
+        cv::String buildErrors;
+        cv::ocl::ProgramSource source(CARTOON_COMBINE_KERNEL);
+        if (!combineKernel_.create("cartoonCombine", source, "", &buildErrors)) {
+            std::cerr << "CartoonVideo: Fused kernel unavailable, using LUT path" << std::endl;
+        }
+    }
+    
+    if (!combineKernel_.empty()) {
+        combineKernel_.args(cv::ocl::KernelArg::ReadOnlyNoSize(smoothed),
+                            cv::ocl::KernelArg::ReadOnlyNoSize(edges),
+                            cv::ocl::KernelArg::WriteOnly(dst),
+                            bucketSize, edgeDarkeningFactor);
+        size_t globalSize[2] = {(size_t)smoothed.cols, (size_t)smoothed.rows};
+        if (combineKernel_.run(2, globalSize, NULL, false)) {
+            return;
+        }
+    }
+    
+    // Fallback: two LUTs (quantized, quantized*darken) and a masked copy
+    cv::Mat quantLut(1, 256, CV_8U), darkLut(1, 256, CV_8U);
+    for (int v = 0; v < 256; v++) {
+        int q = (v / bucketSize) * bucketSize;
+        quantLut.at<uchar>(v) = static_cast<uchar>(q);
+        darkLut.at<uchar>(v) = static_cast<uchar>(q * edgeDarkeningFactor);
+    }
+    cv::UMat darkened;
+    cv::LUT(smoothed, quantLut, dst);
+    cv::LUT(smoothed, darkLut, darkened);
+    darkened.copyTo(dst, edges);
 }
 
 /**
@@ -328,6 +1002,36 @@ void CartoonVideo::setBilateralParams(int d, double sigmaColor, double sigmaSpac
     bilateralD_ = d;
     bilateralSigmaColor_ = sigmaColor;
     bilateralSigmaSpace_ = sigmaSpace;
+    lastCartoon_.release();
+}
+
+/**
+ * @brief Set the processing downscale factor for the smoothing stage
+ * 
+ * Bilateral cost scales with pixel count, so 2 gives roughly 4x and 4
+ * roughly 16x less smoothing work. The filter diameter is kept in
+ * low-resolution pixels, which widens its footprint on the full frame.
+ * 
+ * @param scale 1, 2 or 4
+ */
+void CartoonVideo::setProcessingScale(int scale) {
+    processingScale_ = (scale >= 4) ? 4 : (scale >= 2) ? 2 : 1;
+    lastCartoon_.release();
+}
+
+/**
+ * @brief Enable change-driven incremental rendering
+ * 
+ * @param enable True to enable
+ * @param tileSize Tile edge in pixels
+ * @param threshold Mean absolute difference marking a tile dirty
+ */
+void CartoonVideo::setIncremental(bool enable, int tileSize, double threshold) {
+    incremental_ = enable;
+    tileSize_ = std::max(16, (tileSize / 8) * 8);
+    changeThreshold_ = std::max(0.0, threshold);
+    lastCartoon_.release();
+    lastDirtyFraction_ = 1.0;
 }
 
 /**
@@ -341,6 +1045,8 @@ void CartoonVideo::setDoGParams(double sigma1, double sigma2, double threshold)
     dogSigma1_ = sigma1;
     dogSigma2_ = sigma2;
     dogThreshold_ = threshold;
+    dogRangeValid_ = false;
+    lastCartoon_.release();
 }
 
 /**
@@ -350,6 +1056,7 @@ void CartoonVideo::setDoGParams(double sigma1, double sigma2, double threshold)
  */
 void CartoonVideo::setQuantizeLevels(int levels) {
     quantizeLevels_ = std::max(2, std::min(255, levels));
+    lastCartoon_.release();
 }
 
 /**
@@ -0,0 +1,170 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the shared batched depth inference server.
+*/
+
+#include "depthServer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+DepthServer::DepthServer(DA2Network *network, int sources, float scaleFactor, int maxBatch)
+    : network_(network),
+      scaleFactor_(scaleFactor),
+      maxBatch_(std::max(1, maxBatch)) {
+    for (int i = 0; i < std::max(1, sources); i++) {
+        sources_.push_back(std::unique_ptr<Source>(new Source()));
+    }
+    worker_ = std::thread(&DepthServer::workerLoop, this);
+}
+
+DepthServer::~DepthServer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool DepthServer::submit(int source, const cv::Mat &frame) {
+    if (frame.empty() || network_ == nullptr ||
+        source < 0 || source >= static_cast<int>(sources_.size())) {
+        return false;
+    }
+
+    Source &s = *sources_[source];
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (s.hasPending) {
+            // Latest frame wins: the older pending frame is never processed
+            s.dropped++;
+        }
+        frame.copyTo(s.pending);
+        s.hasPending = true;
+    }
+    cond_.notify_one();
+    return true;
+}
+
+std::shared_ptr<const cv::Mat> DepthServer::latest(int source) const {
+    if (source < 0 || source >= static_cast<int>(sources_.size())) {
+        return nullptr;
+    }
+    return std::atomic_load(&sources_[source]->latest);
+}
+
+long DepthServer::completedCount(int source) const {
+    return (source >= 0 && source < static_cast<int>(sources_.size()))
+               ? sources_[source]->completed.load() : 0;
+}
+
+long DepthServer::droppedCount(int source) const {
+    return (source >= 0 && source < static_cast<int>(sources_.size()))
+               ? sources_[source]->dropped.load() : 0;
+}
+
+std::shared_ptr<cv::Mat> DepthServer::acquireOutputBuffer(Source &source) {
+    std::shared_ptr<cv::Mat> published = std::atomic_load(&source.latest);
+
+    // Same rule as AsyncDepthEstimator: free when only the pool holds it
+    for (const std::shared_ptr<cv::Mat> &buffer : source.buffers) {
+        if (buffer != published && buffer.use_count() == 1) {
+            return buffer;
+        }
+    }
+
+    source.buffers.push_back(std::make_shared<cv::Mat>());
+    return source.buffers.back();
+}
+
+void DepthServer::workerLoop() {
+    std::vector<int> ids;
+    const int count = static_cast<int>(sources_.size());
+
+    while (true) {
+        ids.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] {
+                if (stop_) return true;
+                for (const std::unique_ptr<Source> &s : sources_) {
+                    if (s->hasPending) return true;
+                }
+                return false;
+            });
+            if (stop_) {
+                break;
+            }
+
+            // Take up to maxBatch pending sources, rotating the start so a
+            // large rig does not starve the last cameras
+            for (int k = 0; k < count && static_cast<int>(ids.size()) < maxBatch_; k++) {
+                int id = (nextSource_ + k) % count;
+                Source &s = *sources_[id];
+                if (s.hasPending) {
+                    cv::swap(s.pending, s.work);
+                    s.hasPending = false;
+                    ids.push_back(id);
+                }
+            }
+            nextSource_ = (ids.back() + 1) % count;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        runBatch(ids);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        lastBatchMs_.store(elapsed.count());
+        lastBatchSize_.store(static_cast<int>(ids.size()));
+    }
+}
+
+void DepthServer::runBatch(const std::vector<int> &ids) {
+    const size_t n = ids.size();
+    batchFrames_.resize(n);
+    batchDepth_.resize(n);
+    batchSizes_.resize(n);
+
+    std::vector<std::shared_ptr<cv::Mat>> outputs(n);
+    for (size_t i = 0; i < n; i++) {
+        const cv::Mat &work = sources_[ids[i]]->work;
+        // One tensor needs one input size: match the first frame
+        if (i == 0 || work.size() == batchFrames_[0].size()) {
+            batchFrames_[i] = work;
+        } else {
+            cv::resize(work, batchFrames_[i], batchFrames_[0].size());
+        }
+        batchSizes_[i] = work.size();
+
+        // Results are written straight into the recycled output buffers
+        outputs[i] = acquireOutputBuffer(*sources_[ids[i]]);
+        batchDepth_[i] = *outputs[i];
+    }
+
+    bool ok = false;
+    if (n > 1 && batching_.load()) {
+        ok = network_->set_input_batch(batchFrames_, scaleFactor_) == 0 &&
+             network_->run_network_batch(batchDepth_, batchSizes_) == 0;
+        if (!ok) {
+            batching_.store(false);
+            std::cerr << "Warning: Depth model rejected a batch of " << n
+                      << ", running one frame at a time" << std::endl;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        Source &s = *sources_[ids[i]];
+        if (!ok && (network_->set_input(s.work, scaleFactor_) != 0 ||
+                    network_->run_network(batchDepth_[i], batchSizes_[i]) != 0)) {
+            continue;
+        }
+        // resize may have reallocated: the buffer adopts the result
+        *outputs[i] = batchDepth_[i];
+        std::atomic_store(&s.latest, outputs[i]);
+        s.completed++;
+    }
+}
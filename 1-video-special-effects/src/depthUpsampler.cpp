@@ -0,0 +1,112 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the flow-warped, guided depth upsampler.
+*/
+
+#include "depthUpsampler.hpp"
+#include <algorithm>
+
+DepthUpsampler::DepthUpsampler(int radius, double eps)
+    : radius_(std::max(1, radius)),
+      eps_(eps) {
+}
+
+void DepthUpsampler::reset() {
+    keyDepth_.release();
+    keyGrey_.release();
+}
+
+void DepthUpsampler::shrinkToGrey(const cv::Mat &frame, cv::Mat &grey) {
+    if (frame.size() == keyDepth_.size()) {
+        cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
+    } else {
+        cv::resize(frame, small_, keyDepth_.size(), 0, 0, cv::INTER_AREA);
+        cv::cvtColor(small_, grey, cv::COLOR_BGR2GRAY);
+    }
+}
+
+int DepthUpsampler::update(const cv::Mat &depth, const cv::Mat &keyFrame) {
+    if (depth.empty() || depth.type() != CV_8UC1 || keyFrame.empty() ||
+        keyFrame.type() != CV_8UC3) {
+        std::cerr << "Error: DepthUpsampler needs a CV_8UC1 depth map and a CV_8UC3 key frame" << std::endl;
+        return -1;
+    }
+    depth.copyTo(keyDepth_);
+    shrinkToGrey(keyFrame, keyGrey_);
+    return 0;
+}
+
+int DepthUpsampler::render(const cv::Mat &frame, cv::Mat &depth) {
+    if (keyDepth_.empty()) {
+        return -1;
+    }
+    if (frame.empty() || frame.type() != CV_8UC3) {
+        std::cerr << "Error: DepthUpsampler needs a CV_8UC3 frame" << std::endl;
+        return -1;
+    }
+    int64 start = cv::getTickCount();
+
+    shrinkToGrey(frame, curGrey_);
+
+    // Warp the key depth onto this frame: flow from the current frame back
+    // to the key frame says where each current pixel was in the key frame
+    const cv::Mat *lowDepth = &keyDepth_;
+    if (motionCompensation_) {
+        if (flow_.empty()) {
+            flow_ = cv::DISOpticalFlow::create(cv::DISOpticalFlow::PRESET_ULTRAFAST);
+        }
+        flow_->calc(curGrey_, keyGrey_, flowField_);
+        for (int y = 0; y < flowField_.rows; y++) {
+            cv::Point2f *row = flowField_.ptr<cv::Point2f>(y);
+            for (int x = 0; x < flowField_.cols; x++) {
+                row[x].x += static_cast<float>(x);
+                row[x].y += static_cast<float>(y);
+            }
+        }
+        cv::remap(keyDepth_, warped_, flowField_, cv::noArray(), cv::INTER_LINEAR,
+                  cv::BORDER_REPLICATE);
+        lowDepth = &warped_;
+    }
+
+    // Fast guided filter: depth = a * grey + b fitted at depth resolution
+    const cv::Size box(2 * radius_ + 1, 2 * radius_ + 1);
+    curGrey_.convertTo(I_, CV_32F, 1.0 / 255.0);
+    lowDepth->convertTo(p_, CV_32F, 1.0 / 255.0);
+    cv::boxFilter(I_, meanI_, CV_32F, box);
+    cv::boxFilter(p_, meanP_, CV_32F, box);
+    cv::multiply(I_, p_, tmp_);
+    cv::boxFilter(tmp_, meanIP_, CV_32F, box);
+    cv::multiply(I_, I_, tmp_);
+    cv::boxFilter(tmp_, meanII_, CV_32F, box);
+
+    // a = cov(I, p) / (var(I) + eps), b = mean(p) - a * mean(I)
+    cv::multiply(meanI_, meanP_, tmp_);
+    cv::subtract(meanIP_, tmp_, a_);
+    cv::multiply(meanI_, meanI_, tmp_);
+    cv::subtract(meanII_, tmp_, tmp_);
+    cv::add(tmp_, cv::Scalar::all(eps_), tmp_);
+    cv::divide(a_, tmp_, a_);
+    cv::multiply(a_, meanI_, tmp_);
+    cv::subtract(meanP_, tmp_, b_);
+    cv::boxFilter(a_, a_, CV_32F, box);
+    cv::boxFilter(b_, b_, CV_32F, box);
+
+    // Apply the smooth coefficients to the sharp full-resolution grey frame
+    if (frame.size() == keyDepth_.size()) {
+        I_.copyTo(fullI_);
+        a_.copyTo(aUp_);
+        b_.copyTo(bUp_);
+    } else {
+        cv::cvtColor(frame, fullGrey_, cv::COLOR_BGR2GRAY);
+        fullGrey_.convertTo(fullI_, CV_32F, 1.0 / 255.0);
+        cv::resize(a_, aUp_, frame.size(), 0, 0, cv::INTER_LINEAR);
+        cv::resize(b_, bUp_, frame.size(), 0, 0, cv::INTER_LINEAR);
+    }
+    cv::multiply(aUp_, fullI_, aUp_);
+    cv::add(aUp_, bUp_, aUp_);
+    aUp_.convertTo(depth, CV_8U, 255.0);
+
+    lastRenderMs_ = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+    return 0;
+}
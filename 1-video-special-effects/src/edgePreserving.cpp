@@ -0,0 +1,318 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the fast edge-preserving smoothers.
+*/
+
+#include "edgePreserving.hpp"
+#include "tiling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static bool smootherArgsValid(const cv::Mat &src, const char *name) {
+    if (src.empty() || src.type() != CV_8UC3) {
+        std::cerr << "Error: " << name << " needs a CV_8UC3 image" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Domain transform
+// ---------------------------------------------------------------------------
+
+// Intermediates of domainTransformFilter, one set per thread so repeated
+// calls at the same size do not allocate
+struct DomainTransformScratch {
+    cv::Mat image;       ///< Working image, CV_32FC3
+    cv::Mat dHdx, dVdy;  ///< Domain-transform derivatives, CV_32F
+    cv::Mat wH, wV;      ///< Per-iteration feedback weights a^d
+};
+
+// One horizontal pass: causal then anti-causal sweep along every row.
+// w(y, x) couples pixel x to pixel x - 1.
+static void recursiveRows(cv::Mat &image, const cv::Mat &w) {
+    const int cols = image.cols;
+    parallelRowBands(image.rows, image.step + w.step, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            float *J = image.ptr<float>(y);
+            const float *a = w.ptr<float>(y);
+            for (int x = 1; x < cols; x++) {
+                for (int c = 0; c < 3; c++) {
+                    J[3 * x + c] += a[x] * (J[3 * (x - 1) + c] - J[3 * x + c]);
+                }
+            }
+            for (int x = cols - 2; x >= 0; x--) {
+                for (int c = 0; c < 3; c++) {
+                    J[3 * x + c] += a[x + 1] * (J[3 * (x + 1) + c] - J[3 * x + c]);
+                }
+            }
+        }
+    });
+}
+
+// One vertical pass: the same sweeps down and up the columns. Rows are
+// processed whole so the inner loop is contiguous; threads split the width.
+static void recursiveCols(cv::Mat &image, const cv::Mat &w) {
+    const int rows = image.rows;
+    const int cols = image.cols;
+    const int stripes = std::max(1, std::min(cv::getNumThreads(), cols / 64));
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range &range) {
+        for (int s = range.start; s < range.end; s++) {
+            const int x0 = cols * s / stripes;
+            const int x1 = cols * (s + 1) / stripes;
+            for (int y = 1; y < rows; y++) {
+                float *J = image.ptr<float>(y);
+                const float *P = image.ptr<float>(y - 1);
+                const float *a = w.ptr<float>(y);
+                for (int x = x0; x < x1; x++) {
+                    for (int c = 0; c < 3; c++) {
+                        J[3 * x + c] += a[x] * (P[3 * x + c] - J[3 * x + c]);
+                    }
+                }
+            }
+            for (int y = rows - 2; y >= 0; y--) {
+                float *J = image.ptr<float>(y);
+                const float *N = image.ptr<float>(y + 1);
+                const float *a = w.ptr<float>(y + 1);
+                for (int x = x0; x < x1; x++) {
+                    for (int c = 0; c < 3; c++) {
+                        J[3 * x + c] += a[x] * (N[3 * x + c] - J[3 * x + c]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+int domainTransformFilter(const cv::Mat &src, cv::Mat &dst, double sigmaSpace,
+                          double sigmaColor, int iterations) {
+    if (!smootherArgsValid(src, "domainTransformFilter")) {
+        return -1;
+    }
+    sigmaSpace = std::max(sigmaSpace, 0.5);
+    sigmaColor = std::max(sigmaColor, 1.0);
+    iterations = std::max(iterations, 1);
+
+    static thread_local DomainTransformScratch s;
+    src.convertTo(s.image, CV_32F);
+    const int rows = src.rows;
+    const int cols = src.cols;
+
+    // Derivatives of the transformed domain: 1 + sigmaS / sigmaR * sum |dI|,
+    // stored at the second pixel of each pair (column / row 0 unused)
+    const float ratio = static_cast<float>(sigmaSpace / sigmaColor);
+    s.dHdx.create(rows, cols, CV_32F);
+    s.dVdy.create(rows, cols, CV_32F);
+    parallelRowBands(rows, 2 * s.image.step, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            const float *I = s.image.ptr<float>(y);
+            const float *P = s.image.ptr<float>(y > 0 ? y - 1 : 0);
+            float *dh = s.dHdx.ptr<float>(y);
+            float *dv = s.dVdy.ptr<float>(y);
+            dh[0] = 1.0f;
+            for (int x = 1; x < cols; x++) {
+                float d = std::abs(I[3 * x] - I[3 * x - 3]) +
+                          std::abs(I[3 * x + 1] - I[3 * x - 2]) +
+                          std::abs(I[3 * x + 2] - I[3 * x - 1]);
+                dh[x] = 1.0f + ratio * d;
+            }
+            for (int x = 0; x < cols; x++) {
+                float d = std::abs(I[3 * x] - P[3 * x]) +
+                          std::abs(I[3 * x + 1] - P[3 * x + 1]) +
+                          std::abs(I[3 * x + 2] - P[3 * x + 2]);
+                dv[x] = 1.0f + ratio * d;
+            }
+        }
+    });
+
+    // Each iteration halves the kernel; the sigmas are chosen so the
+    // variances of all iterations add up to sigmaSpace^2
+    for (int i = 0; i < iterations; i++) {
+        double sigmaH = sigmaSpace * std::sqrt(3.0) * std::pow(2.0, iterations - i - 1) /
+                        std::sqrt(std::pow(4.0, iterations) - 1.0);
+        double logA = -std::sqrt(2.0) / sigmaH;
+
+        // a^d = exp(d * ln a), vectorised by cv::exp
+        cv::multiply(s.dHdx, cv::Scalar(logA), s.wH);
+        cv::exp(s.wH, s.wH);
+        cv::multiply(s.dVdy, cv::Scalar(logA), s.wV);
+        cv::exp(s.wV, s.wV);
+
+        recursiveRows(s.image, s.wH);
+        recursiveCols(s.image, s.wV);
+    }
+
+    s.image.convertTo(dst, CV_8U);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Bilateral grid
+// ---------------------------------------------------------------------------
+
+// Cells around the data so the blur and the trilinear slice never index
+// outside the grid
+static const int GRID_PAD = 1;
+
+// Grid storage reused between calls, one per thread
+struct BilateralGridScratch {
+    std::vector<cv::Vec4f> grid, blurred;
+    cv::Mat luma;
+};
+
+// [1 2 1] / 4 along one axis of a (gh x gw x gd) grid, stride in cells
+static void blurGridAxis(const std::vector<cv::Vec4f> &in, std::vector<cv::Vec4f> &out,
+                         int cells, int stride, int length) {
+    // Index along the axis is (i / stride) % length; the end cells see a
+    // zero neighbour, which the padding keeps empty anyway
+    cv::parallel_for_(cv::Range(0, cells), [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; i++) {
+            const int pos = (i / stride) % length;
+            cv::Vec4f v = in[i] * 2.0f;
+            if (pos > 0) {
+                v += in[i - stride];
+            }
+            if (pos < length - 1) {
+                v += in[i + stride];
+            }
+            out[i] = v * 0.25f;
+        }
+    }, cells / 65536.0);
+}
+
+int bilateralGridFilter(const cv::Mat &src, cv::Mat &dst, double sigmaSpace,
+                        double sigmaColor) {
+    if (!smootherArgsValid(src, "bilateralGridFilter")) {
+        return -1;
+    }
+    const float ss = static_cast<float>(std::max(sigmaSpace, 1.0));
+    const float sr = static_cast<float>(std::max(sigmaColor, 1.0));
+    const int rows = src.rows;
+    const int cols = src.cols;
+
+    // Layout [gy][gx][gz]: the range axis is contiguous, so a trilinear
+    // lookup touches two short runs per (gx, gy) corner
+    const int gw = static_cast<int>(std::ceil((cols - 1) / ss)) + 1 + 2 * GRID_PAD;
+    const int gh = static_cast<int>(std::ceil((rows - 1) / ss)) + 1 + 2 * GRID_PAD;
+    const int gd = static_cast<int>(std::ceil(255.0f / sr)) + 1 + 2 * GRID_PAD;
+    const int cells = gw * gh * gd;
+
+    static thread_local BilateralGridScratch s;
+    s.grid.assign(cells, cv::Vec4f::all(0.0f));
+    s.blurred.resize(cells);
+    cv::cvtColor(src, s.luma, cv::COLOR_BGR2GRAY);
+
+    // Splat: nearest cell, homogeneous (B, G, R, 1). Image rows that round
+    // to the same grid row stay on one thread, so no two threads write the
+    // same cell.
+    const int dataRows = gh - 2 * GRID_PAD;
+    cv::parallel_for_(cv::Range(0, dataRows), [&](const cv::Range &range) {
+        for (int gy = range.start; gy < range.end; gy++) {
+            const int y0 = std::max(0, static_cast<int>(std::ceil((gy - 0.5f) * ss)));
+            const int y1 = std::min(rows, static_cast<int>(std::ceil((gy + 0.5f) * ss)));
+            for (int y = y0; y < y1; y++) {
+                if (static_cast<int>(y / ss + 0.5f) != gy) {
+                    continue;
+                }
+                const cv::Vec3b *px = src.ptr<cv::Vec3b>(y);
+                const uchar *L = s.luma.ptr<uchar>(y);
+                cv::Vec4f *gridRow = &s.grid[(gy + GRID_PAD) * gw * gd];
+                for (int x = 0; x < cols; x++) {
+                    const int gx = static_cast<int>(x / ss + 0.5f) + GRID_PAD;
+                    const int gz = static_cast<int>(L[x] / sr + 0.5f) + GRID_PAD;
+                    cv::Vec4f &cell = gridRow[gx * gd + gz];
+                    cell[0] += px[x][0];
+                    cell[1] += px[x][1];
+                    cell[2] += px[x][2];
+                    cell[3] += 1.0f;
+                }
+            }
+        }
+    });
+
+    // Blur: x, y, then range
+    blurGridAxis(s.grid, s.blurred, cells, gd, gw);
+    blurGridAxis(s.blurred, s.grid, cells, gw * gd, gh);
+    blurGridAxis(s.grid, s.blurred, cells, 1, gd);
+    const std::vector<cv::Vec4f> &g = s.blurred;
+
+    // Slice: trilinear interpolation at each pixel's continuous grid position
+    dst.create(src.size(), CV_8UC3);
+    parallelRowBands(rows, 2 * src.step, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            const float fy = y / ss + GRID_PAD;
+            const int iy = static_cast<int>(fy);
+            const float ty = fy - iy;
+            const uchar *L = s.luma.ptr<uchar>(y);
+            cv::Vec3b *out = dst.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < cols; x++) {
+                const float fx = x / ss + GRID_PAD;
+                const float fz = L[x] / sr + GRID_PAD;
+                const int ix = static_cast<int>(fx);
+                const int iz = static_cast<int>(fz);
+                const float tx = fx - ix;
+                const float tz = fz - iz;
+
+                cv::Vec4f acc = cv::Vec4f::all(0.0f);
+                for (int dy = 0; dy < 2; dy++) {
+                    const float wy = dy ? ty : 1.0f - ty;
+                    for (int dx = 0; dx < 2; dx++) {
+                        const float wxy = wy * (dx ? tx : 1.0f - tx);
+                        const cv::Vec4f *cell = &g[((iy + dy) * gw + ix + dx) * gd + iz];
+                        acc += cell[0] * (wxy * (1.0f - tz)) + cell[1] * (wxy * tz);
+                    }
+                }
+                const float inv = acc[3] > 1e-6f ? 1.0f / acc[3] : 0.0f;
+                out[x] = cv::Vec3b(cv::saturate_cast<uchar>(acc[0] * inv),
+                                   cv::saturate_cast<uchar>(acc[1] * inv),
+                                   cv::saturate_cast<uchar>(acc[2] * inv));
+            }
+        }
+    });
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Guided filter
+// ---------------------------------------------------------------------------
+
+// Intermediates of guidedFilter, one set per thread
+struct GuidedFilterScratch {
+    cv::Mat I, meanI, meanII, var, a, b, tmp;
+};
+
+int guidedFilter(const cv::Mat &src, cv::Mat &dst, int radius, double eps) {
+    if (!smootherArgsValid(src, "guidedFilter")) {
+        return -1;
+    }
+    radius = std::max(radius, 1);
+    eps = std::max(eps, 1e-6);
+    const cv::Size box(2 * radius + 1, 2 * radius + 1);
+
+    // Every channel guides itself, so cov(I, p) = var(I) and the per-channel
+    // arithmetic runs on the three-channel image directly
+    static thread_local GuidedFilterScratch s;
+    src.convertTo(s.I, CV_32F, 1.0 / 255.0);
+    cv::boxFilter(s.I, s.meanI, CV_32F, box);
+    cv::multiply(s.I, s.I, s.tmp);
+    cv::boxFilter(s.tmp, s.meanII, CV_32F, box);
+    cv::multiply(s.meanI, s.meanI, s.tmp);
+    cv::subtract(s.meanII, s.tmp, s.var);
+
+    // a = var / (var + eps), b = mean * (1 - a)
+    cv::add(s.var, cv::Scalar::all(eps), s.tmp);
+    cv::divide(s.var, s.tmp, s.a);
+    cv::multiply(s.a, s.meanI, s.tmp);
+    cv::subtract(s.meanI, s.tmp, s.b);
+
+    // Average the coefficients over every window covering a pixel
+    cv::boxFilter(s.a, s.a, CV_32F, box);
+    cv::boxFilter(s.b, s.b, CV_32F, box);
+    cv::multiply(s.a, s.I, s.tmp);
+    cv::add(s.tmp, s.b, s.tmp);
+    s.tmp.convertTo(dst, CV_8U, 255.0);
+    return 0;
+}
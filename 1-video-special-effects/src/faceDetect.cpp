@@ -5,14 +5,74 @@
 
   Functions for finding faces and drawing boxes around them
 
-  The path to the Haar cascade file is define in faceDetect.h
+  The paths to the Haar cascade file and the YuNet model are defined in
+  faceDetect.h. YuNet (through the shared cvcore::FaceDetectorService) is
+  used when its model loads; the Haar cascade is the fallback.
 */
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
+#include "cvcore/faceDetector.hpp"
 #include "faceDetect.h"
 
+// the YuNet service shared by every thread (null = use the Haar cascade)
+static std::mutex yunet_mutex;
+static std::shared_ptr<cvcore::FaceDetectorService> yunet_service;
+static bool yunet_chosen = false;
+
+/*
+  Returns the YuNet service, loading the default model on first use if the
+  file exists and no detector has been chosen with setFaceDetector
+ */
+static std::shared_ptr<cvcore::FaceDetectorService> yunetService() {
+  std::lock_guard<std::mutex> lock( yunet_mutex );
+  if( !yunet_chosen ) {
+    yunet_chosen = true;
+    if( std::ifstream( FACE_YUNET_FILE ).good() ) {
+      yunet_service = cvcore::FaceDetectorService::shared( FACE_YUNET_FILE );
+      if( yunet_service ) {
+        printf("Using YuNet face detector %s\n", FACE_YUNET_FILE);
+      }
+    }
+  }
+  return yunet_service;
+}
+
+/*
+  Arguments:
+  const char *yunetFile - YuNet model file, or NULL / "" to use the Haar cascade
+  float scoreThreshold - minimum face score
+  int inputSize - longest side of the detector input
+ */
+int setFaceDetector( const char *yunetFile, float scoreThreshold, int inputSize ) {
+  std::shared_ptr<cvcore::FaceDetectorService> service;
+  int result = 0;
+
+  if( yunetFile && yunetFile[0] ) {
+    cvcore::FaceDetectorOptions options;
+    options.scoreThreshold = scoreThreshold;
+    options.inputSize = inputSize;
+    service = cvcore::FaceDetectorService::shared( yunetFile, options );
+    if( !service ) {
+      printf("Unable to load YuNet model %s, using the Haar cascade\n", yunetFile);
+      result = -1;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock( yunet_mutex );
+  yunet_service = service;
+  yunet_chosen = true;
+  return(result);
+}
+
+const char *faceDetectorName() {
+  return yunetService() ? "YuNet" : "Haar";
+}
+
 
 /*
   Arguments:
@@ -21,11 +81,21 @@
      if the length of the vector is zero, no faces were found
  */
 int detectFaces( cv::Mat &grey, std::vector<cv::Rect> &faces ) {
-  // a static variable to hold a half-size image
-  static cv::Mat half;
+  // YuNet runs on a shrunk copy of the frame and has far fewer false
+  // positives than the cascade
+  std::shared_ptr<cvcore::FaceDetectorService> yunet = yunetService();
+  if( yunet ) {
+    faces = yunet->detect( grey );
+    return(0);
+  }
+
+  // a static variable to hold a half-size image (one per thread, so
+  // several camera threads can detect at once)
+  static thread_local cv::Mat half;
   
-  // a static variable to hold the classifier
-  static cv::CascadeClassifier face_cascade;
+  // a static variable to hold the classifier (not safe to share between
+  // threads; each thread loads its own copy on first use)
+  static thread_local cv::CascadeClassifier face_cascade;
 
   // the path to the haar cascade file
   static cv::String face_cascade_file(FACE_CASCADE_FILE);
@@ -0,0 +1,255 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 25, 2026
+  Purpose: Implementation of the temporally coherent face tracker.
+*/
+
+#include "faceTracker.hpp"
+#include "faceDetect.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+// Every FULL_DETECT_EVERY-th detection scans the whole frame so new faces
+// are picked up; the others only search around existing tracks
+static const int FULL_DETECT_EVERY = 4;
+
+// Flow points per face and forward-backward error limit in pixels
+static const int MAX_POINTS = 30;
+static const float MAX_FB_ERROR = 1.0f;
+
+// Detections overlapping a track by more than this IoU replace it
+static const float MATCH_IOU = 0.3f;
+
+/*
+  Function: iou
+  Purpose: Intersection over union of two rectangles
+*/
+static float iou(const Rect2f &a, const Rect2f &b) {
+    float inter = (a & b).area();
+    float uni = a.area() + b.area() - inter;
+    return (uni > 0.0f) ? inter / uni : 0.0f;
+}
+
+/*
+  Function: median
+  Purpose: Median of a vector (reorders it)
+*/
+static float median(vector<float> &v) {
+    size_t mid = v.size() / 2;
+    nth_element(v.begin(), v.begin() + mid, v.end());
+    return v[mid];
+}
+
+FaceTracker::FaceTracker(int detectInterval, double minConfidence)
+    : detectInterval_(max(1, detectInterval)),
+      minConfidence_(minConfidence),
+      lastFrame_(-2),
+      framesSinceDetect_(0),
+      detectsSinceFull_(0),
+      cascadeRuns_(0) {
+}
+
+void FaceTracker::reset() {
+    tracks_.clear();
+    prevGrey_.release();
+    lastFrame_ = -2;
+    framesSinceDetect_ = 0;
+    detectsSinceFull_ = 0;
+}
+
+void FaceTracker::setDetectInterval(int frames) {
+    detectInterval_ = max(1, frames);
+}
+
+void FaceTracker::detectIn(const Mat &grey, const Rect &region, vector<Rect> &found) {
+    Mat roi = grey(region);
+    vector<Rect> local;
+    detectFaces(roi, local);
+    cascadeRuns_++;
+    for (const Rect &r : local) {
+        found.push_back(Rect(r.x + region.x, r.y + region.y, r.width, r.height));
+    }
+}
+
+void FaceTracker::seedPoints(const Mat &grey, Track &track) {
+    track.points.clear();
+
+    // Inner 60% of the box: avoids background at the edges of the face
+    Rect2f b = track.box;
+    Rect inner(cvRound(b.x + b.width * 0.2f), cvRound(b.y + b.height * 0.2f),
+               cvRound(b.width * 0.6f), cvRound(b.height * 0.6f));
+    inner &= Rect(0, 0, grey.cols, grey.rows);
+    if (inner.width < 4 || inner.height < 4) {
+        return;
+    }
+
+    goodFeaturesToTrack(grey(inner), track.points, MAX_POINTS, 0.01, 3);
+
+    // Flat faces (low texture): fall back to a regular grid
+    if (track.points.size() < 4) {
+        track.points.clear();
+        for (int gy = 1; gy <= 4; gy++) {
+            for (int gx = 1; gx <= 4; gx++) {
+                track.points.push_back(Point2f(inner.width * gx / 5.0f, inner.height * gy / 5.0f));
+            }
+        }
+    }
+
+    for (Point2f &p : track.points) {
+        p.x += inner.x;
+        p.y += inner.y;
+    }
+}
+
+void FaceTracker::propagate(const Mat &grey, Track &track) {
+    if (track.points.size() < 4) {
+        track.confidence = 0.0f;
+        return;
+    }
+
+    vector<Point2f> next, back;
+    vector<uchar> status, backStatus;
+    vector<float> err;
+    Size window(15, 15);
+    calcOpticalFlowPyrLK(prevGrey_, grey, track.points, next, status, err, window, 2);
+    calcOpticalFlowPyrLK(grey, prevGrey_, next, back, backStatus, err, window, 2);
+
+    // Keep points that track consistently forward and backward
+    vector<Point2f> oldGood, newGood;
+    for (size_t i = 0; i < track.points.size(); i++) {
+        if (status[i] && backStatus[i] && norm(back[i] - track.points[i]) < MAX_FB_ERROR) {
+            oldGood.push_back(track.points[i]);
+            newGood.push_back(next[i]);
+        }
+    }
+
+    track.confidence = (float)newGood.size() / track.points.size();
+    if (newGood.size() < 4) {
+        track.confidence = 0.0f;
+        return;
+    }
+
+    // Median translation and median pairwise scale change
+    vector<float> dx, dy, ratios;
+    for (size_t i = 0; i < newGood.size(); i++) {
+        dx.push_back(newGood[i].x - oldGood[i].x);
+        dy.push_back(newGood[i].y - oldGood[i].y);
+        size_t j = (i + 1) % newGood.size();
+        float before = (float)norm(oldGood[i] - oldGood[j]);
+        if (before > 1.0f) {
+            ratios.push_back((float)norm(newGood[i] - newGood[j]) / before);
+        }
+    }
+    float scale = ratios.empty() ? 1.0f : median(ratios);
+    float mx = median(dx), my = median(dy);
+
+    Point2f center(track.box.x + track.box.width * 0.5f + mx,
+                   track.box.y + track.box.height * 0.5f + my);
+    float w = track.box.width * scale, h = track.box.height * scale;
+    track.box = Rect2f(center.x - w * 0.5f, center.y - h * 0.5f, w, h);
+    track.points = newGood;
+}
+
+int FaceTracker::update(const Mat &grey, vector<Rect> &faces, long frameIndex) {
+    faces.clear();
+    if (grey.empty() || grey.type() != CV_8UC1) {
+        return -1;
+    }
+
+    Rect frameRect(0, 0, grey.cols, grey.rows);
+    bool continuous = (frameIndex == lastFrame_ + 1) && !prevGrey_.empty() &&
+                      prevGrey_.size() == grey.size();
+    if (!continuous) {
+        tracks_.clear();
+    }
+
+    // Propagate existing tracks with optical flow
+    bool lowConfidence = false;
+    for (Track &t : tracks_) {
+        propagate(grey, t);
+        if (t.confidence < minConfidence_) {
+            lowConfidence = true;
+        }
+    }
+
+    bool needDetect = tracks_.empty() || lowConfidence ||
+                      ++framesSinceDetect_ >= detectInterval_;
+    if (needDetect) {
+        vector<Rect> found;
+        bool full = tracks_.empty() || detectsSinceFull_ + 1 >= FULL_DETECT_EVERY;
+
+        if (full) {
+            detectIn(grey, frameRect, found);
+            detectsSinceFull_ = 0;
+        } else {
+            // Search a region twice the size of each track around its box
+            for (const Track &t : tracks_) {
+                Rect2f b = t.box;
+                Rect region(cvRound(b.x - b.width * 0.5f), cvRound(b.y - b.height * 0.5f),
+                            cvRound(b.width * 2.0f), cvRound(b.height * 2.0f));
+                region &= frameRect;
+                if (region.width >= 24 && region.height >= 24) {
+                    detectIn(grey, region, found);
+                }
+            }
+            detectsSinceFull_++;
+        }
+
+        // Detections replace the tracks they overlap; unmatched confident
+        // tracks survive ROI passes (a full scan is authoritative)
+        vector<Track> updated;
+        vector<bool> used(tracks_.size(), false);
+        for (const Rect &r : found) {
+            Track t;
+            t.box = Rect2f(r);
+            t.confidence = 1.0f;
+            bool duplicate = false;
+            for (const Track &u : updated) {
+                if (iou(u.box, t.box) > MATCH_IOU) {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (duplicate) {
+                continue;
+            }
+            for (size_t i = 0; i < tracks_.size(); i++) {
+                if (iou(tracks_[i].box, t.box) > MATCH_IOU) {
+                    used[i] = true;
+                }
+            }
+            seedPoints(grey, t);
+            updated.push_back(t);
+        }
+        if (!full) {
+            for (size_t i = 0; i < tracks_.size(); i++) {
+                if (!used[i] && tracks_[i].confidence >= minConfidence_) {
+                    updated.push_back(tracks_[i]);
+                }
+            }
+        }
+        tracks_.swap(updated);
+        framesSinceDetect_ = 0;
+    } else {
+        // Replenish points on tracks that lost many of them
+        for (Track &t : tracks_) {
+            if ((int)t.points.size() < MAX_POINTS / 2) {
+                seedPoints(grey, t);
+            }
+        }
+    }
+
+    for (const Track &t : tracks_) {
+        Rect r = Rect(cvRound(t.box.x), cvRound(t.box.y),
+                      cvRound(t.box.width), cvRound(t.box.height)) & frameRect;
+        if (r.area() > 0) {
+            faces.push_back(r);
+        }
+    }
+
+    grey.copyTo(prevGrey_);
+    lastFrame_ = frameIndex;
+    return 0;
+}
@@ -6,10 +6,61 @@
 
 #define _USE_MATH_DEFINES
 #include "filters.hpp"
+#include "tiling.hpp"
+#include "pointOps.hpp"
+#include "warpMapCache.hpp"
+#include "framePool.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <cmath>
 #include <ctime>
 
+// Source for a filter that may be called in-place: a pooled copy of src when
+// dst aliases it, src itself otherwise. copy holds the lease until return.
+static cv::Mat inPlaceSource(const cv::Mat &src, const cv::Mat &dst, FrameLease &copy) {
+    if (src.data != dst.data) {
+        return src;
+    }
+    copy = FramePool::local().copyOf(src);
+    return copy.mat();
+}
+
+// inPlaceSource for a filter that only reads the given regions of src: when
+// dst aliases it, just those regions are copied (at their frame position)
+static cv::Mat inPlaceRegions(const cv::Mat &src, const cv::Mat &dst,
+                              const std::vector<cv::Rect> &regions, FrameLease &copy) {
+    if (src.data != dst.data) {
+        return src;
+    }
+    copy = FramePool::local().acquireLike(src);
+    for (const cv::Rect &region : regions) {
+        src(region).copyTo(copy.mat()(region));
+    }
+    return copy.mat();
+}
+
+// Merges overlapping rectangles until the list is disjoint, so every pixel
+// is processed by at most one of them
+static void mergeOverlapping(std::vector<cv::Rect> &rects) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; i++) {
+            for (size_t j = i + 1; j < rects.size(); j++) {
+                if ((rects[i] & rects[j]).area() > 0) {
+                    rects[i] |= rects[j];
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
 // Task 4: Custom greyscale conversion
 int greyscale(cv::Mat &src, cv::Mat &dst) {
     // Check if source image is valid
@@ -25,108 +76,160 @@ int greyscale(cv::Mat &src, cv::Mat &dst) {
     // This creates a unique greyscale based on color contrast
     // Formula: grey = |R - B| + G/2
     // This emphasizes color differences and gives a distinct look
-    
-    // Iterate through each row using row pointers (efficient)
-    for (int row = 0; row < src.rows; row++) {
-        // Get pointers to current row in source and destination
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
-        
-        // Iterate through each pixel in the row
-        for (int col = 0; col < src.cols; col++) {
-            // Get BGR values from source pixel
-            int blue = srcRow[col][0];
-            int green = srcRow[col][1];
-            int red = srcRow[col][2];
+    const bool useSimd = cv::useOptimized();
+    
+    // Rows are independent: process cache-sized bands on all cores
+    parallelRowBands(src.rows, src.step + dst.step, [&](const cv::Range &band) {
+        // Iterate through each row using row pointers (efficient)
+        for (int row = band.start; row < band.end; row++) {
+            const uchar* srcRow = src.ptr<uchar>(row);
+            uchar* dstRow = dst.ptr<uchar>(row);
+            int col = 0;
+            
+#if CV_SIMD128
+            // Fused kernel, 16 pixels per step: 8-bit adds saturate, which
+            // is exactly the clip to 255 of the scalar path
+            if (useSimd) {
+                for (; col + 16 <= src.cols; col += 16) {
+                    cv::v_uint8x16 b, g, r;
+                    cv::v_load_deinterleave(srcRow + col * 3, b, g, r);
+                    cv::v_uint16x8 gLo, gHi;
+                    cv::v_expand(g, gLo, gHi);
+                    cv::v_uint8x16 halfG = cv::v_pack(cv::v_shr<1>(gLo), cv::v_shr<1>(gHi));
+                    cv::v_uint8x16 grey = cv::v_absdiff(r, b) + halfG;
+                    cv::v_store_interleave(dstRow + col * 3, grey, grey, grey);
+                }
+            }
+#endif
+            
+            for (; col < src.cols; col++) {
+                // Get BGR values from source pixel
+                int blue = srcRow[col * 3 + 0];
+                int green = srcRow[col * 3 + 1];
+                int red = srcRow[col * 3 + 2];
             
-            // Custom greyscale calculation
-            // Use channel difference
-            // Emphasizes edges and color boundaries
-            int diff = std::abs(red - blue);
-            int grey = diff + (green / 2);
+                // Use channel difference; emphasizes edges and color boundaries
+                int grey = std::abs(red - blue) + (green / 2);
             
-            // Clip to valid range [0, 255]
-            if (grey > 255) grey = 255;
+                // Clip to valid range [0, 255]
+                if (grey > 255) grey = 255;
             
-            // Set all three channels to the same value (greyscale)
-            uchar greyValue = static_cast<uchar>(grey);
-            dstRow[col][0] = greyValue;  // Blue
-            dstRow[col][1] = greyValue;  // Green
-            dstRow[col][2] = greyValue;  // Red
+                // Set all three channels to the same value (greyscale)
+                uchar greyValue = static_cast<uchar>(grey);
+                dstRow[col * 3 + 0] = greyValue;  // Blue
+                dstRow[col * 3 + 1] = greyValue;  // Green
+                dstRow[col * 3 + 2] = greyValue;  // Red
+            }
         }
-    }
+    });
     
     return 0;
 }
 
+// Sepia matrix compiled into per-channel tables (see pointOps.hpp). Built
+// once on first use (thread-safe static init).
+SepiaTables::SepiaTables() {
+    static const float coeff[3][3] = {
+        {0.131f, 0.534f, 0.272f},  // B' from B, G, R
+        {0.168f, 0.686f, 0.349f},  // G'
+        {0.189f, 0.769f, 0.393f}   // R'
+    };
+    for (int o = 0; o < 3; o++) {
+        for (int i = 0; i < 3; i++) {
+            for (int v = 0; v < 256; v++) {
+                lut[o][i][v] = cvRound(coeff[o][i] * v * (1 << SEPIA_LUT_BITS));
+            }
+        }
+    }
+}
+
+const SepiaTables &sepiaTables() {
+    static const SepiaTables tables;
+    return tables;
+}
+
+// Vignette gain map in Q15 (CV_16U, 32768 = 1.0), cached per frame size and
+// strength. The sqrt per pixel runs only when either changes.
+std::shared_ptr<const cv::Mat> vignetteGainMap(cv::Size size, float strength) {
+    static std::mutex cacheMutex;
+    static std::shared_ptr<const cv::Mat> cached;
+    static cv::Size cachedSize;
+    static float cachedStrength = -1.0f;
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cached && cachedSize == size && cachedStrength == strength) {
+        return cached;
+    }
+    
+    std::shared_ptr<cv::Mat> gain = std::make_shared<cv::Mat>(size, CV_16UC1);
+    float centerX = size.width / 2.0f;
+    float centerY = size.height / 2.0f;
+    float maxDist = sqrt(centerX * centerX + centerY * centerY);
+    for (int row = 0; row < size.height; row++) {
+        ushort* gainRow = gain->ptr<ushort>(row);
+        float dy = row - centerY;
+        for (int col = 0; col < size.width; col++) {
+            float dx = col - centerX;
+            float d = sqrt(dx * dx + dy * dy) / maxDist;
+            // Quadratic falloff: 1.0 at the center, darker towards the edges
+            float vignette = std::max(1.0f - strength * d * d, 0.0f);
+            gainRow[col] = static_cast<ushort>(cvRound(vignette * (1 << VIGNETTE_GAIN_BITS)));
+        }
+    }
+    
+    cached = gain;
+    cachedSize = size;
+    cachedStrength = strength;
+    return cached;
+}
+
 // Task 5: Sepia tone filter
 int sepiaTone(cv::Mat &src, cv::Mat &dst, bool applyVignetting) {
-    // Create destination image if needed
-    dst.create(src.size(), src.type());
-    
     // Check if source is valid 3-channel color image
     if (src.empty() || src.channels() != 3) {
         std::cerr << "Error: Source must be a 3-channel color image" << std::endl;
         return -1;
     }
     
-    // Pre-calculate vignetting parameters if enabled
-    float centerX = src.cols / 2.0f;
-    float centerY = src.rows / 2.0f;
-    float maxDist = sqrt(centerX * centerX + centerY * centerY);
-    float vignetteStrength = 1.2f;  // Adjustable strength
+    // Create destination image if needed
+    dst.create(src.size(), src.type());
     
-    // Iterate through each row using row pointers
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
-        
-        // Pre-calculate y distance for vignetting (optimization)
-        float dy = row - centerY;
+    const float vignetteStrength = 1.2f;  // Adjustable strength
+    const SepiaTables &tables = sepiaTables();
+    std::shared_ptr<const cv::Mat> gain;
+    if (applyVignetting) {
+        gain = vignetteGainMap(src.size(), vignetteStrength);
+    }
+    
+    // Rows are independent: process cache-sized bands on all cores
+    size_t bytesPerRow = src.step + dst.step + (gain ? gain->step : 0);
+    parallelRowBands(src.rows, bytesPerRow, [&](const cv::Range &band) {
+        // Fused apply: 9 table lookups, clamp, fixed-point vignette
+        for (int row = band.start; row < band.end; row++) {
+            const uchar* srcRow = src.ptr<uchar>(row);
+            uchar* dstRow = dst.ptr<uchar>(row);
+            const ushort* gainRow = gain ? gain->ptr<ushort>(row) : nullptr;
         
-        for (int col = 0; col < src.cols; col++) {
-            // Get original BGR values (use float for precision)
-            float blue = srcRow[col][0];
-            float green = srcRow[col][1];
-            float red = srcRow[col][2];
-            
-            // Apply sepia tone transformation using original values
-            // IMPORTANT: Use original R, G, B for all calculations
-            float newRed   = 0.393f * red + 0.769f * green + 0.189f * blue;
-            float newGreen = 0.349f * red + 0.686f * green + 0.168f * blue;
-            float newBlue  = 0.272f * red + 0.534f * green + 0.131f * blue;
-            
-            // Clamp sepia values to [0, 255]
-            newRed   = std::min(newRed, 255.0f);
-            newGreen = std::min(newGreen, 255.0f);
-            newBlue  = std::min(newBlue, 255.0f);
-            
-            // Apply vignetting if enabled
-            if (applyVignetting) {
-                float dx = col - centerX;
-                
-                // Calculate distance from center
-                float dist = sqrt(dx * dx + dy * dy);
+            for (int col = 0; col < src.cols; col++) {
+                int blue = srcRow[col * 3 + 0];
+                int green = srcRow[col * 3 + 1];
+                int red = srcRow[col * 3 + 2];
                 
-                // Normalize distance to [0, 1]
-                float d = dist / maxDist;
-                
-                // Quadratic falloff: vignette factor from 1.0 (center) to darker (edges)
-                float vignette = 1.0f - vignetteStrength * d * d;
-                vignette = std::max(vignette, 0.0f);
-                
-                // Apply vignetting
-                newRed   *= vignette;
-                newGreen *= vignette;
-                newBlue  *= vignette;
+                for (int o = 0; o < 3; o++) {
+                    // Sepia value for output channel o, clamped to [0, 255]
+                    int v = (tables.lut[o][0][blue] + tables.lut[o][1][green] + 
+                             tables.lut[o][2][red]) >> SEPIA_LUT_BITS;
+                    v = std::min(v, 255);
+                    
+                    // Vignetting only darkens, so no second clamp is needed
+                    if (gainRow != nullptr) {
+                        v = (v * gainRow[col]) >> VIGNETTE_GAIN_BITS;
+                    }
+                    dstRow[col * 3 + o] = static_cast<uchar>(v);
+                }
             }
-            
-            // Write to destination (no need to clamp again, vignetting only darkens)
-            dstRow[col][0] = static_cast<uchar>(newBlue);
-            dstRow[col][1] = static_cast<uchar>(newGreen);
-            dstRow[col][2] = static_cast<uchar>(newRed);
         }
-    }
+    });
     
     return 0;
 }
@@ -267,6 +370,133 @@ int blur5x5_2(cv::Mat &src, cv::Mat &dst) {
     return 0;
 }
 
+// Helper for blur5x5_simd: horizontal [1 2 4 2 1] pass over one BGR row
+// Writes unnormalized 16-bit sums (max 10 * 255 = 2550). Neighbouring pixels
+// of the same channel are 3 bytes apart in the interleaved row.
+static void blurRowH5(const uchar* srcRow, ushort* hRow, int cols, bool useSimd) {
+    static const int kernel1D[5] = {1, 2, 4, 2, 1};
+    const int n = cols * 3;
+
+    // Border columns: clamp coordinates once per row
+    auto borderPixel = [&](int col) {
+        for (int c = 0; c < 3; c++) {
+            int sum = 0;
+            for (int k = -2; k <= 2; k++) {
+                int nx = std::max(0, std::min(col + k, cols - 1));
+                sum += srcRow[nx * 3 + c] * kernel1D[k + 2];
+            }
+            hRow[col * 3 + c] = static_cast<ushort>(sum);
+        }
+    };
+    for (int col = 0; col < std::min(2, cols); col++) {
+        borderPixel(col);
+    }
+    for (int col = std::max(2, cols - 2); col < cols; col++) {
+        borderPixel(col);
+    }
+
+    // Interior columns [2, cols-2): no clamping required
+    int i = 6;
+    const int end = n - 6;
+#if CV_SIMD128
+    if (useSimd) {
+        for (; i + 8 <= end; i += 8) {
+            cv::v_uint16x8 a = cv::v_load_expand(srcRow + i - 6);
+            cv::v_uint16x8 b = cv::v_load_expand(srcRow + i - 3);
+            cv::v_uint16x8 c = cv::v_load_expand(srcRow + i);
+            cv::v_uint16x8 d = cv::v_load_expand(srcRow + i + 3);
+            cv::v_uint16x8 e = cv::v_load_expand(srcRow + i + 6);
+            cv::v_uint16x8 bd = b + d;
+            cv::v_uint16x8 cc = c + c;
+            cv::v_store(hRow + i, a + e + bd + bd + cc + cc);
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        hRow[i] = static_cast<ushort>(srcRow[i - 6] + 2 * (srcRow[i - 3] + srcRow[i + 3]) +
+                                      4 * srcRow[i] + srcRow[i + 6]);
+    }
+}
+
+// Helper for blur5x5_simd: vertical [1 2 4 2 1] pass over five horizontal
+// sum rows, followed by the single normalization by 100 (max sum 25500).
+static void blurRowV5(const ushort* r0, const ushort* r1, const ushort* r2,
+                      const ushort* r3, const ushort* r4,
+                      uchar* dstRow, int n, bool useSimd) {
+    int i = 0;
+#if CV_SIMD128
+    if (useSimd) {
+        // x / 100 == (x * 41944) >> 22 exactly for 0 <= x <= 25500
+        const cv::v_uint32x4 magic = cv::v_setall_u32(41944);
+        for (; i + 8 <= n; i += 8) {
+            cv::v_uint16x8 a = cv::v_load(r0 + i);
+            cv::v_uint16x8 b = cv::v_load(r1 + i);
+            cv::v_uint16x8 c = cv::v_load(r2 + i);
+            cv::v_uint16x8 d = cv::v_load(r3 + i);
+            cv::v_uint16x8 e = cv::v_load(r4 + i);
+            cv::v_uint16x8 bd = b + d;
+            cv::v_uint16x8 cc = c + c;
+            cv::v_uint16x8 sum = a + e + bd + bd + cc + cc;
+
+            cv::v_uint32x4 lo, hi;
+            cv::v_expand(sum, lo, hi);
+            lo = cv::v_shr<22>(lo * magic);
+            hi = cv::v_shr<22>(hi * magic);
+            cv::v_pack_store(dstRow + i, cv::v_pack(lo, hi));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        int sum = r0[i] + 2 * (r1[i] + r3[i]) + 4 * r2[i] + r4[i];
+        dstRow[i] = static_cast<uchar>(sum / 100);
+    }
+}
+
+// Task 6: 5x5 Gaussian blur (separable, rolling row window, SIMD interior)
+int blur5x5_simd(cv::Mat &src, cv::Mat &dst) {
+    if (src.empty() || src.type() != CV_8UC3) {
+        std::cerr << "Error: Source must be a 3-channel color image" << std::endl;
+        return -1;
+    }
+
+    // Allow in-place use: the rolling window reads source rows ahead of the
+    // row being written, so keep the input alive separately if dst aliases it
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceSource(src, dst, inputCopy);
+    dst.create(input.size(), input.type());
+
+    const int rows = input.rows;
+    const int cols = input.cols;
+    const int n = cols * 3;
+    const bool useSimd = cv::useOptimized();
+
+    // Each band keeps its own rolling window of five horizontally-blurred
+    // rows (indexed by row % 5), primed with the two halo rows above it
+    parallelRowBands(rows, 2 * static_cast<size_t>(n), [&](const cv::Range &band) {
+        FrameLease windowRows = FramePool::local().acquire(cv::Size(n, 5), CV_16UC1);
+        ushort* window = windowRows.mat().ptr<ushort>();
+        auto hRow = [&](int row) { return window + (row % 5) * static_cast<size_t>(n); };
+        auto clampRow = [&](int r) { return std::max(0, std::min(r, rows - 1)); };
+
+        int lastComputed = std::max(0, band.start - 2) - 1;
+        for (int row = band.start; row < band.end; row++) {
+            // Horizontal pass for every source row this output row needs
+            int needed = std::min(row + 2, rows - 1);
+            while (lastComputed < needed) {
+                lastComputed++;
+                blurRowH5(input.ptr<uchar>(lastComputed), hRow(lastComputed), cols, useSimd);
+            }
+
+            // Border rows clamp to the first/last source row
+            blurRowV5(hRow(clampRow(row - 2)), hRow(clampRow(row - 1)), hRow(row),
+                      hRow(clampRow(row + 1)), hRow(clampRow(row + 2)),
+                      dst.ptr<uchar>(row), n, useSimd);
+        }
+    });
+
+    return 0;
+}
+
 // Task 7: Sobel X filter (detects vertical edges)
 int sobelX3x3(cv::Mat &src, cv::Mat &dst) {
     // Check if source is valid 3-channel color image
@@ -283,59 +513,67 @@ int sobelX3x3(cv::Mat &src, cv::Mat &dst) {
     // Horizontal derivative: [-1, 0, 1]
     // Vertical smoothing: [1, 2, 1]
     
-    int horizKernel[3] = {-1, 0, 1};   // Derivative
-    int vertKernel[3] = {1, 2, 1};     // Smoothing, sum = 4
-    
-    // Create temporary image for intermediate result (after horizontal pass)
-    cv::Mat temp(src.size(), CV_16SC3);
-    temp.setTo(0);
+    const int horizKernel[3] = {-1, 0, 1};   // Derivative
+    const int vertKernel[3] = {1, 2, 1};     // Smoothing, sum = 4
     
-    // First pass: Apply horizontal derivative [-1, 0, 1]
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        cv::Vec3s* tempRow = temp.ptr<cv::Vec3s>(row);
+    // Each band recomputes its one-row halo into a band-local temporary,
+    // so bands never share intermediate rows
+    parallelRowBands(src.rows, src.step + 2 * dst.step, [&](const cv::Range &band) {
+        int haloStart = std::max(0, band.start - 1);
+        int haloEnd = std::min(src.rows, band.end + 1);
         
-        for (int col = 1; col < src.cols - 1; col++) {
-            int sumB = 0, sumG = 0, sumR = 0;
+        // Temporary image for intermediate result (after horizontal pass)
+        cv::Mat temp(haloEnd - haloStart, src.cols, CV_16SC3, cv::Scalar::all(0));
+        
+        // First pass: Apply horizontal derivative [-1, 0, 1]
+        for (int row = haloStart; row < haloEnd; row++) {
+            const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
+            cv::Vec3s* tempRow = temp.ptr<cv::Vec3s>(row - haloStart);
             
-            for (int k = -1; k <= 1; k++) {
-                cv::Vec3b pixel = srcRow[col + k];
-                int weight = horizKernel[k + 1];
+            for (int col = 1; col < src.cols - 1; col++) {
+                int sumB = 0, sumG = 0, sumR = 0;
                 
-                sumB += pixel[0] * weight;
-                sumG += pixel[1] * weight;
-                sumR += pixel[2] * weight;
+                for (int k = -1; k <= 1; k++) {
+                    cv::Vec3b pixel = srcRow[col + k];
+                    int weight = horizKernel[k + 1];
+                    
+                    sumB += pixel[0] * weight;
+                    sumG += pixel[1] * weight;
+                    sumR += pixel[2] * weight;
+                }
+                
+                // Store signed values (can be negative)
+                tempRow[col][0] = static_cast<short>(sumB);
+                tempRow[col][1] = static_cast<short>(sumG);
+                tempRow[col][2] = static_cast<short>(sumR);
             }
-            
-            // Store signed values (can be negative)
-            tempRow[col][0] = static_cast<short>(sumB);
-            tempRow[col][1] = static_cast<short>(sumG);
-            tempRow[col][2] = static_cast<short>(sumR);
         }
-    }
-    
-    // Second pass: Apply vertical smoothing [1, 2, 1]
-    for (int row = 1; row < temp.rows - 1; row++) {
-        cv::Vec3s* dstRow = dst.ptr<cv::Vec3s>(row);
         
-        for (int col = 1; col < temp.cols - 1; col++) {
-            int sumB = 0, sumG = 0, sumR = 0;
+        // Second pass: Apply vertical smoothing [1, 2, 1]
+        int rowStart = std::max(1, band.start);
+        int rowEnd = std::min(src.rows - 1, band.end);
+        for (int row = rowStart; row < rowEnd; row++) {
+            cv::Vec3s* dstRow = dst.ptr<cv::Vec3s>(row);
             
-            for (int k = -1; k <= 1; k++) {
-                const cv::Vec3s* tempRowK = temp.ptr<cv::Vec3s>(row + k);
-                int weight = vertKernel[k + 1];
+            for (int col = 1; col < src.cols - 1; col++) {
+                int sumB = 0, sumG = 0, sumR = 0;
                 
-                sumB += tempRowK[col][0] * weight;
-                sumG += tempRowK[col][1] * weight;
-                sumR += tempRowK[col][2] * weight;
+                for (int k = -1; k <= 1; k++) {
+                    const cv::Vec3s* tempRowK = temp.ptr<cv::Vec3s>(row + k - haloStart);
+                    int weight = vertKernel[k + 1];
+                    
+                    sumB += tempRowK[col][0] * weight;
+                    sumG += tempRowK[col][1] * weight;
+                    sumR += tempRowK[col][2] * weight;
+                }
+                
+                // Divide by vertical kernel sum (4)
+                dstRow[col][0] = static_cast<short>(sumB / 4);
+                dstRow[col][1] = static_cast<short>(sumG / 4);
+                dstRow[col][2] = static_cast<short>(sumR / 4);
             }
-            
-            // Divide by vertical kernel sum (4)
-            dstRow[col][0] = static_cast<short>(sumB / 4);
-            dstRow[col][1] = static_cast<short>(sumG / 4);
-            dstRow[col][2] = static_cast<short>(sumR / 4);
         }
-    }
+    });
     
     return 0;
 }
@@ -356,59 +594,67 @@ int sobelY3x3(cv::Mat &src, cv::Mat &dst) {
     // Horizontal smoothing: [1, 2, 1]
     // Vertical derivative: [1, 0, -1] (positive up means [1, 0, -1])
     
-    int horizKernel[3] = {1, 2, 1};    // Smoothing, sum = 4
-    int vertKernel[3] = {1, 0, -1};    // Derivative (positive up)
-    
-    // Create temporary image for intermediate result
-    cv::Mat temp(src.size(), CV_16SC3);
-    temp.setTo(0);
+    const int horizKernel[3] = {1, 2, 1};    // Smoothing, sum = 4
+    const int vertKernel[3] = {1, 0, -1};    // Derivative (positive up)
     
-    // First pass: Apply horizontal smoothing [1, 2, 1]
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        cv::Vec3s* tempRow = temp.ptr<cv::Vec3s>(row);
+    // Each band recomputes its one-row halo into a band-local temporary,
+    // so bands never share intermediate rows
+    parallelRowBands(src.rows, src.step + 2 * dst.step, [&](const cv::Range &band) {
+        int haloStart = std::max(0, band.start - 1);
+        int haloEnd = std::min(src.rows, band.end + 1);
         
-        for (int col = 1; col < src.cols - 1; col++) {
-            int sumB = 0, sumG = 0, sumR = 0;
+        // Temporary image for intermediate result
+        cv::Mat temp(haloEnd - haloStart, src.cols, CV_16SC3, cv::Scalar::all(0));
+        
+        // First pass: Apply horizontal smoothing [1, 2, 1]
+        for (int row = haloStart; row < haloEnd; row++) {
+            const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
+            cv::Vec3s* tempRow = temp.ptr<cv::Vec3s>(row - haloStart);
             
-            for (int k = -1; k <= 1; k++) {
-                cv::Vec3b pixel = srcRow[col + k];
-                int weight = horizKernel[k + 1];
+            for (int col = 1; col < src.cols - 1; col++) {
+                int sumB = 0, sumG = 0, sumR = 0;
                 
-                sumB += pixel[0] * weight;
-                sumG += pixel[1] * weight;
-                sumR += pixel[2] * weight;
+                for (int k = -1; k <= 1; k++) {
+                    cv::Vec3b pixel = srcRow[col + k];
+                    int weight = horizKernel[k + 1];
+                    
+                    sumB += pixel[0] * weight;
+                    sumG += pixel[1] * weight;
+                    sumR += pixel[2] * weight;
+                }
+                
+                // Divide by horizontal kernel sum (4)
+                tempRow[col][0] = static_cast<short>(sumB / 4);
+                tempRow[col][1] = static_cast<short>(sumG / 4);
+                tempRow[col][2] = static_cast<short>(sumR / 4);
             }
-            
-            // Divide by horizontal kernel sum (4)
-            tempRow[col][0] = static_cast<short>(sumB / 4);
-            tempRow[col][1] = static_cast<short>(sumG / 4);
-            tempRow[col][2] = static_cast<short>(sumR / 4);
         }
-    }
-    
-    // Second pass: Apply vertical derivative [1, 0, -1]
-    for (int row = 1; row < temp.rows - 1; row++) {
-        cv::Vec3s* dstRow = dst.ptr<cv::Vec3s>(row);
         
-        for (int col = 1; col < temp.cols - 1; col++) {
-            int sumB = 0, sumG = 0, sumR = 0;
+        // Second pass: Apply vertical derivative [1, 0, -1]
+        int rowStart = std::max(1, band.start);
+        int rowEnd = std::min(src.rows - 1, band.end);
+        for (int row = rowStart; row < rowEnd; row++) {
+            cv::Vec3s* dstRow = dst.ptr<cv::Vec3s>(row);
             
-            for (int k = -1; k <= 1; k++) {
-                const cv::Vec3s* tempRowK = temp.ptr<cv::Vec3s>(row + k);
-                int weight = vertKernel[k + 1];
+            for (int col = 1; col < src.cols - 1; col++) {
+                int sumB = 0, sumG = 0, sumR = 0;
                 
-                sumB += tempRowK[col][0] * weight;
-                sumG += tempRowK[col][1] * weight;
-                sumR += tempRowK[col][2] * weight;
+                for (int k = -1; k <= 1; k++) {
+                    const cv::Vec3s* tempRowK = temp.ptr<cv::Vec3s>(row + k - haloStart);
+                    int weight = vertKernel[k + 1];
+                    
+                    sumB += tempRowK[col][0] * weight;
+                    sumG += tempRowK[col][1] * weight;
+                    sumR += tempRowK[col][2] * weight;
+                }
+                
+                // Store signed values (no division for derivative)
+                dstRow[col][0] = static_cast<short>(sumB);
+                dstRow[col][1] = static_cast<short>(sumG);
+                dstRow[col][2] = static_cast<short>(sumR);
             }
-            
-            // Store signed values (no division for derivative)
-            dstRow[col][0] = static_cast<short>(sumB);
-            dstRow[col][1] = static_cast<short>(sumG);
-            dstRow[col][2] = static_cast<short>(sumR);
         }
-    }
+    });
     
     return 0;
 }
@@ -430,29 +676,105 @@ int magnitude(cv::Mat &sx, cv::Mat &sy, cv::Mat &dst) {
     // Create destination as 8-bit unsigned 3-channel image
     dst.create(sx.size(), CV_8UC3);
     
-    // Calculate magnitude for each pixel: sqrt(sx^2 + sy^2)
-    for (int row = 0; row < sx.rows; row++) {
-        const cv::Vec3s* sxRow = sx.ptr<cv::Vec3s>(row);
-        const cv::Vec3s* syRow = sy.ptr<cv::Vec3s>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
+    // Rows are independent: process cache-sized bands on all cores
+    parallelRowBands(sx.rows, sx.step + sy.step + dst.step, [&](const cv::Range &band) {
+        // Calculate magnitude for each pixel: sqrt(sx^2 + sy^2)
+        for (int row = band.start; row < band.end; row++) {
+            const cv::Vec3s* sxRow = sx.ptr<cv::Vec3s>(row);
+            const cv::Vec3s* syRow = sy.ptr<cv::Vec3s>(row);
+            cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
         
-        for (int col = 0; col < sx.cols; col++) {
-            // Calculate magnitude for each color channel separately
-            for (int c = 0; c < 3; c++) {
-                // Get signed short values
-                short sxVal = sxRow[col][c];
-                short syVal = syRow[col][c];
+            for (int col = 0; col < sx.cols; col++) {
+                // Calculate magnitude for each color channel separately
+                for (int c = 0; c < 3; c++) {
+                    // Get signed short values
+                    short sxVal = sxRow[col][c];
+                    short syVal = syRow[col][c];
                 
-                // Calculate magnitude: sqrt(sx^2 + sy^2)
-                double mag = sqrt(static_cast<double>(sxVal * sxVal + syVal * syVal));
+                    // Calculate magnitude: sqrt(sx^2 + sy^2)
+                    double mag = sqrt(static_cast<double>(sxVal * sxVal + syVal * syVal));
                 
-                // Clamp to [0, 255] and convert to uchar
-                mag = std::min(255.0, std::max(0.0, mag));
-                dstRow[col][c] = static_cast<uchar>(mag);
+                    // Clamp to [0, 255] and convert to uchar
+                    mag = std::min(255.0, std::max(0.0, mag));
+                    dstRow[col][c] = static_cast<uchar>(mag);
+                }
             }
         }
+    });
+    
+    return 0;
+}
+
+// Fused gradient helper: Sobel X and Y for one row, computed directly from
+// the three source rows around it (the rolling 3-row window). Reproduces the
+// intermediate divisions and zeroed borders of sobelX3x3/sobelY3x3 exactly,
+// so consumers get identical gradients without any full-frame temporaries.
+static void sobelRowXY(const cv::Mat &src, int row, short* gx, short* gy) {
+    const int n = src.cols * 3;
+    std::fill(gx, gx + n, static_cast<short>(0));
+    std::fill(gy, gy + n, static_cast<short>(0));
+    
+    // First and last rows have no vertical neighbours: gradient is zero
+    if (row == 0 || row == src.rows - 1) {
+        return;
+    }
+    
+    const uchar* up = src.ptr<uchar>(row - 1);
+    const uchar* mid = src.ptr<uchar>(row);
+    const uchar* down = src.ptr<uchar>(row + 1);
+    
+    // Interior columns only; neighbours of the same channel are 3 bytes apart
+    for (int i = 3; i < n - 3; i++) {
+        // Sobel X: horizontal derivative, then [1 2 1] vertical smoothing / 4
+        int dUp = up[i + 3] - up[i - 3];
+        int dMid = mid[i + 3] - mid[i - 3];
+        int dDown = down[i + 3] - down[i - 3];
+        gx[i] = static_cast<short>((dUp + 2 * dMid + dDown) / 4);
+        
+        // Sobel Y: [1 2 1] horizontal smoothing / 4, then [1 0 -1] vertically
+        int sUp = (up[i - 3] + 2 * up[i] + up[i + 3]) / 4;
+        int sDown = (down[i - 3] + 2 * down[i] + down[i + 3]) / 4;
+        gy[i] = static_cast<short>(sUp - sDown);
+    }
+}
+
+// Task 8: Fused Sobel X/Y + gradient magnitude in a single sweep
+int sobelMagnitude3x3(cv::Mat &src, cv::Mat &dst) {
+    if (src.empty() || src.type() != CV_8UC3) {
+        std::cerr << "Error: Source must be a 3-channel color image" << std::endl;
+        return -1;
     }
     
+    // Rows are read one ahead of the row being written, so keep the input
+    // alive separately when called in-place
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceSource(src, dst, inputCopy);
+    dst.create(input.size(), CV_8UC3);
+    
+    const int n = input.cols * 3;
+    
+    parallelRowBands(input.rows, input.step + dst.step, [&](const cv::Range &band) {
+        // One row of gradients per band, reused for every row in the band
+        FrameLease gradRows = FramePool::local().acquire(cv::Size(n, 2), CV_16SC1);
+        short* gx = gradRows.mat().ptr<short>(0);
+        short* gy = gradRows.mat().ptr<short>(1);
+        
+        for (int row = band.start; row < band.end; row++) {
+            sobelRowXY(input, row, gx, gy);
+            uchar* dstRow = dst.ptr<uchar>(row);
+            
+            for (int i = 0; i < n; i++) {
+                int gxVal = gx[i];
+                int gyVal = gy[i];
+                
+                // Same arithmetic as magnitude(): sqrt(sx^2 + sy^2), clamped
+                double mag = sqrt(static_cast<double>(gxVal * gxVal + gyVal * gyVal));
+                mag = std::min(255.0, std::max(0.0, mag));
+                dstRow[i] = static_cast<uchar>(mag);
+            }
+        }
+    });
+    
     return 0;
 }
 
@@ -471,8 +793,9 @@ int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels) {
     }
     
     // Step 1: Blur the image using separable blur filter
-    cv::Mat blurred;
-    if (blur5x5_2(src, blurred) != 0) {
+    FrameLease blurredLease = FramePool::local().acquireLike(src);
+    cv::Mat &blurred = blurredLease.mat();
+    if (blur5x5_simd(src, blurred) != 0) {
         std::cerr << "Error: Blur operation failed" << std::endl;
         return -1;
     }
@@ -483,31 +806,65 @@ int blurQuantize(cv::Mat &src, cv::Mat &dst, int levels) {
     // Calculate bucket size
     int bucketSize = 255 / levels;
     
-    // Quantize each pixel
-    for (int row = 0; row < blurred.rows; row++) {
-        const cv::Vec3b* blurredRow = blurred.ptr<cv::Vec3b>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
+    // Rows are independent: process cache-sized bands on all cores
+    parallelRowBands(blurred.rows, blurred.step + dst.step, [&](const cv::Range &band) {
+        // Quantize each pixel
+        for (int row = band.start; row < band.end; row++) {
+            const cv::Vec3b* blurredRow = blurred.ptr<cv::Vec3b>(row);
+            cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
         
-        for (int col = 0; col < blurred.cols; col++) {
-            // Quantize each color channel
-            for (int c = 0; c < 3; c++) {
-                int value = blurredRow[col][c];
+            for (int col = 0; col < blurred.cols; col++) {
+                // Quantize each color channel
+                for (int c = 0; c < 3; c++) {
+                    int value = blurredRow[col][c];
                 
-                // Quantize: xt = x / bucketSize, then xf = xt * bucketSize
-                int xt = value / bucketSize;
-                int xf = xt * bucketSize;
+                    // Quantize: xt = x / bucketSize, then xf = xt * bucketSize
+                    int xt = value / bucketSize;
+                    int xf = xt * bucketSize;
                 
-                dstRow[col][c] = static_cast<uchar>(xf);
+                    dstRow[col][c] = static_cast<uchar>(xf);
+                }
             }
         }
-    }
+    });
     
     return 0;
 }
 
+// Fixed-point precision of the depth-indexed blend weights (256 = 1.0)
+static const int DEPTH_BLEND_BITS = 8;
+static const int DEPTH_BLEND_ONE = 1 << DEPTH_BLEND_BITS;
+
+// Per-depth fraction of the original pixel kept by depthFog, in Q8
+// (1x256 CV_16U). Rebuilt only when the intensity changes.
+static std::shared_ptr<const cv::Mat> depthFogTable(float intensity) {
+    static std::mutex cacheMutex;
+    static std::shared_ptr<const cv::Mat> cached;
+    static float cachedIntensity = -1.0f;
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cached && cachedIntensity == intensity) {
+        return cached;
+    }
+    
+    std::shared_ptr<cv::Mat> table = std::make_shared<cv::Mat>(1, 256, CV_16UC1);
+    ushort* keep = table->ptr<ushort>(0);
+    for (int d = 0; d < 256; d++) {
+        float depthNorm = d / 255.0f;
+        float fogFactor = 1.0f - exp(-intensity * depthNorm * depthNorm);
+        fogFactor = std::max(0.0f, std::min(1.0f, fogFactor));
+        keep[d] = static_cast<ushort>(cvRound((1.0f - fogFactor) * DEPTH_BLEND_ONE));
+    }
+    
+    cached = table;
+    cachedIntensity = intensity;
+    return cached;
+}
+
 // Task 11/12: Depth-based fog effect
 int depthFog(cv::Mat &src, cv::Mat &depth, cv::Mat &dst, float intensity) {
-    if (src.empty() || depth.empty() || src.size() != depth.size()) {
+    if (src.empty() || depth.empty() || src.size() != depth.size() ||
+        src.type() != CV_8UC3 || depth.type() != CV_8UC1) {
         std::cerr << "Error: Invalid input for depth fog" << std::endl;
         return -1;
     }
@@ -515,32 +872,62 @@ int depthFog(cv::Mat &src, cv::Mat &depth, cv::Mat &dst, float intensity) {
     dst.create(src.size(), src.type());
     
     // Fog color (light bluish-gray for atmospheric effect)
-    cv::Vec3b fogColor(220, 220, 200);
-    
-    // Apply fog based on depth using row pointers
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        const uchar* depthRow = depth.ptr<uchar>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
+    const int fogB = 220, fogG = 220, fogR = 200;
+    
+    // The exponential fog curve only depends on the 8-bit depth value, so it
+    // is a 256-entry table; the blend is then integer:
+    //   out = (pixel * keep[d] + fog * (256 - keep[d]) + 128) >> 8
+    std::shared_ptr<const cv::Mat> table = depthFogTable(intensity);
+    const ushort* keepLut = table->ptr<ushort>(0);
+    const bool useSimd = cv::useOptimized();
+    
+    parallelRowBands(src.rows, src.step + dst.step + depth.step, [&](const cv::Range &band) {
+        FrameLease keepRow = FramePool::local().acquire(cv::Size(src.cols, 1), CV_16UC1);
+        ushort* keep = keepRow.mat().ptr<ushort>();
         
-        for (int col = 0; col < src.cols; col++) {
-            // Depth value: 0=close, 255=far
-            float depthNorm = depthRow[col] / 255.0f;
+        for (int row = band.start; row < band.end; row++) {
+            const uchar* srcRow = src.ptr<uchar>(row);
+            const uchar* depthRow = depth.ptr<uchar>(row);
+            uchar* dstRow = dst.ptr<uchar>(row);
             
-            // Exponential fog: distant objects get more fog
-            // fogFactor increases with distance
-            float fogFactor = 1.0f - exp(-intensity * depthNorm * depthNorm);
-            fogFactor = std::max(0.0f, std::min(1.0f, fogFactor));
+            for (int col = 0; col < src.cols; col++) {
+                keep[col] = keepLut[depthRow[col]];
+            }
             
-            // Blend original pixel with fog color
-            for (int c = 0; c < 3; c++) {
-                dstRow[col][c] = static_cast<uchar>(
-                    srcRow[col][c] * (1.0f - fogFactor) + 
-                    fogColor[c] * fogFactor
-                );
+            int col = 0;
+#if CV_SIMD128
+            if (useSimd) {
+                const cv::v_uint16x8 one = cv::v_setall_u16(DEPTH_BLEND_ONE);
+                const cv::v_uint16x8 half = cv::v_setall_u16(DEPTH_BLEND_ONE / 2);
+                const cv::v_uint16x8 vFog[3] = {cv::v_setall_u16(fogB), cv::v_setall_u16(fogG),
+                                                cv::v_setall_u16(fogR)};
+                for (; col + 16 <= src.cols; col += 16) {
+                    cv::v_uint8x16 px[3];
+                    cv::v_load_deinterleave(srcRow + col * 3, px[0], px[1], px[2]);
+                    cv::v_uint16x8 k0 = cv::v_load(&keep[col]), k1 = cv::v_load(&keep[col + 8]);
+                    cv::v_uint16x8 f0 = one - k0, f1 = one - k1;
+                    
+                    // Max sum 255 * 256 + 128: no 16-bit overflow
+                    for (int c = 0; c < 3; c++) {
+                        cv::v_uint16x8 lo, hi;
+                        cv::v_expand(px[c], lo, hi);
+                        lo = cv::v_shr<DEPTH_BLEND_BITS>(lo * k0 + vFog[c] * f0 + half);
+                        hi = cv::v_shr<DEPTH_BLEND_BITS>(hi * k1 + vFog[c] * f1 + half);
+                        px[c] = cv::v_pack(lo, hi);
+                    }
+                    cv::v_store_interleave(dstRow + col * 3, px[0], px[1], px[2]);
+                }
+            }
+#endif
+            for (; col < src.cols; col++) {
+                int k = keep[col];
+                int f = DEPTH_BLEND_ONE - k;
+                dstRow[col * 3 + 0] = static_cast<uchar>((srcRow[col * 3 + 0] * k + fogB * f + 128) >> DEPTH_BLEND_BITS);
+                dstRow[col * 3 + 1] = static_cast<uchar>((srcRow[col * 3 + 1] * k + fogG * f + 128) >> DEPTH_BLEND_BITS);
+                dstRow[col * 3 + 2] = static_cast<uchar>((srcRow[col * 3 + 2] * k + fogR * f + 128) >> DEPTH_BLEND_BITS);
             }
         }
-    }
+    });
     
     return 0;
 }
@@ -553,14 +940,11 @@ int embossEffect(cv::Mat &src, cv::Mat &dst) {
         return -1;
     }
     
-    // Get Sobel X and Y gradients
-    cv::Mat sobelX, sobelY;
-    if (sobelX3x3(src, sobelX) != 0 || sobelY3x3(src, sobelY) != 0) {
-        std::cerr << "Error: Sobel filters failed in emboss" << std::endl;
-        return -1;
-    }
-    
-    dst.create(src.size(), src.type());
+    // Gradients come from the fused per-row Sobel path; keep the input
+    // alive separately when called in-place since rows are read one ahead
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceSource(src, dst, inputCopy);
+    dst.create(input.size(), input.type());
     
     // Light direction vector (normalized 45-degree angle from top-left)
     // (0.7071, 0.7071) = (1/sqrt(2), 1/sqrt(2))
@@ -570,17 +954,24 @@ int embossEffect(cv::Mat &src, cv::Mat &dst) {
     // Emboss strength
     const float strength = 1.5f;
     
-    // Process each pixel
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3s* sxRow = sobelX.ptr<cv::Vec3s>(row);
-        const cv::Vec3s* syRow = sobelY.ptr<cv::Vec3s>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
+    const int n = input.cols * 3;
+    
+    // Rows are independent: process cache-sized bands on all cores
+    parallelRowBands(input.rows, input.step + dst.step, [&](const cv::Range &band) {
+        // One row of Sobel X/Y gradients per band
+        FrameLease gradRows = FramePool::local().acquire(cv::Size(n, 2), CV_16SC1);
+        short* sxRow = gradRows.mat().ptr<short>(0);
+        short* syRow = gradRows.mat().ptr<short>(1);
         
-        for (int col = 0; col < src.cols; col++) {
-            for (int c = 0; c < 3; c++) {
+        // Process each pixel
+        for (int row = band.start; row < band.end; row++) {
+            sobelRowXY(input, row, sxRow, syRow);
+            uchar* dstRow = dst.ptr<uchar>(row);
+        
+            for (int i = 0; i < n; i++) {
                 // Get gradient values
-                float gx = static_cast<float>(sxRow[col][c]);
-                float gy = static_cast<float>(syRow[col][c]);
+                float gx = static_cast<float>(sxRow[i]);
+                float gy = static_cast<float>(syRow[i]);
                 
                 // Dot product with light direction
                 // This gives us how much the surface faces the light
@@ -591,10 +982,10 @@ int embossEffect(cv::Mat &src, cv::Mat &dst) {
                 
                 // Clamp to valid range
                 value = std::max(0.0f, std::min(255.0f, value));
-                dstRow[col][c] = static_cast<uchar>(value);
+                dstRow[i] = static_cast<uchar>(value);
             }
         }
-    }
+    });
     
     return 0;
 }
@@ -607,20 +998,17 @@ int negativeEffect(cv::Mat &src, cv::Mat &dst) {
         return -1;
     }
     
-    dst.create(src.size(), src.type());
-    
-    // Process each pixel using row pointers for efficiency
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
-        
-        for (int col = 0; col < src.cols; col++) {
-            // Invert each channel: 255 - value
-            dstRow[col][0] = 255 - srcRow[col][0];  // Blue
-            dstRow[col][1] = 255 - srcRow[col][1];  // Green
-            dstRow[col][2] = 255 - srcRow[col][2];  // Red
+    // Invert each channel through a 256-entry table: 255 - value
+    static const cv::Mat invertLut = []() {
+        cv::Mat lut(1, 256, CV_8U);
+        for (int v = 0; v < 256; v++) {
+            lut.at<uchar>(v) = static_cast<uchar>(255 - v);
         }
-    }
+        return lut;
+    }();
+    
+    // cv::LUT applies the table to every channel (vectorized, multithreaded)
+    cv::LUT(src, invertLut, dst);
     
     return 0;
 }
@@ -628,62 +1016,98 @@ int negativeEffect(cv::Mat &src, cv::Mat &dst) {
 // Task 12: Face Highlight Effect
 // Keeps detected faces in color while rest of image is grayscale
 // faces: vector of face rectangles from face detection
+//
+// Outside the blurred face ellipses the result is plain grey, so the mask,
+// its blur and the blend only run in padded windows around the faces
 int faceHighlight(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &faces) {
     if (src.empty() || src.channels() != 3) {
         std::cerr << "Error: Source must be a 3-channel color image" << std::endl;
         return -1;
     }
     
-    // First convert entire image to grayscale
-    cv::Mat grey;
-    cv::cvtColor(src, grey, cv::COLOR_BGR2GRAY);
-    
-    // Convert grayscale back to 3-channel for consistent output
-    cv::cvtColor(grey, dst, cv::COLOR_GRAY2BGR);
-    
-    // If no faces detected, return grayscale image
-    if (faces.empty()) {
-        return 0;
-    }
-    
-    // Create a mask for face regions with smooth edges
-    cv::Mat mask = cv::Mat::zeros(src.size(), CV_8UC1);
+    // Mask blur: 31x31 Gaussian, sigma 15
+    const int blurRadius = 15;
+    const cv::Rect frame(0, 0, src.cols, src.rows);
     
+    // Ellipse of each face, expanded slightly for better coverage, and the
+    // window its blurred mask can reach
+    std::vector<cv::Point> centers;
+    std::vector<cv::Size> axes;
+    std::vector<cv::Rect> windows;
     for (const cv::Rect& face : faces) {
-        // Expand face region slightly for better coverage
         int expandX = face.width / 8;
         int expandY = face.height / 8;
         
-        cv::Rect expanded(
-            std::max(0, face.x - expandX),
-            std::max(0, face.y - expandY),
-            std::min(src.cols - face.x + expandX, face.width + 2 * expandX),
-            std::min(src.rows - face.y + expandY, face.height + 2 * expandY)
-        );
-        
-        // Draw filled ellipse for face region (more natural than rectangle)
         cv::Point center(face.x + face.width / 2, face.y + face.height / 2);
-        cv::Size axes(face.width / 2 + expandX, face.height / 2 + expandY);
-        cv::ellipse(mask, center, axes, 0, 0, 360, cv::Scalar(255), -1);
+        cv::Size faceAxes(face.width / 2 + expandX, face.height / 2 + expandY);
+        centers.push_back(center);
+        axes.push_back(faceAxes);
+        
+        // One extra pixel for the ellipse rasterisation
+        int padX = faceAxes.width + blurRadius + 1;
+        int padY = faceAxes.height + blurRadius + 1;
+        cv::Rect window = cv::Rect(center.x - padX, center.y - padY,
+                                   2 * padX + 1, 2 * padY + 1) & frame;
+        if (!window.empty()) {
+            windows.push_back(window);
+        }
     }
+    mergeOverlapping(windows);
     
-    // Blur the mask for smooth transition
-    cv::GaussianBlur(mask, mask, cv::Size(31, 31), 15);
+    // Colour source for the windows, saved before dst is overwritten
+    FrameLease colorCopy;
+    cv::Mat color = inPlaceRegions(src, dst, windows, colorCopy);
     
-    // Blend color face with grayscale background using the mask
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        const uchar* maskRow = mask.ptr<uchar>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
+    // Convert entire image to grayscale, back to 3-channel for the output
+    FrameLease greyLease = FramePool::local().acquire(src.size(), CV_8UC1);
+    cv::Mat &grey = greyLease.mat();
+    cv::cvtColor(src, grey, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(grey, dst, cv::COLOR_GRAY2BGR);
+    
+    // If no faces detected, return grayscale image
+    if (windows.empty()) {
+        return 0;
+    }
+    
+    // Window sizes change every frame: lease a frame-sized mask and work in
+    // its top-left corner so the pool sees one shape
+    FrameLease maskLease = FramePool::local().acquire(src.size(), CV_8UC1);
+    
+    for (const cv::Rect& window : windows) {
+        // The blur reads blurRadius pixels around the window
+        cv::Rect source(window.x - blurRadius, window.y - blurRadius,
+                        window.width + 2 * blurRadius, window.height + 2 * blurRadius);
+        source &= frame;
+        cv::Mat mask = maskLease.mat()(cv::Rect(0, 0, source.width, source.height));
+        mask.setTo(cv::Scalar(0));
         
-        for (int col = 0; col < src.cols; col++) {
-            float alpha = maskRow[col] / 255.0f;
+        // Draw filled ellipse for face region (more natural than rectangle);
+        // every face, as a neighbour's ellipse may reach into this window
+        for (size_t i = 0; i < centers.size(); i++) {
+            cv::ellipse(mask, centers[i] - source.tl(), axes[i], 0, 0, 360, cv::Scalar(255), -1);
+        }
+        
+        // Blur the mask for smooth transition. Isolated: sides that stop
+        // short of the frame edge already hold the zeros the blur needs
+        cv::GaussianBlur(mask, mask, cv::Size(2 * blurRadius + 1, 2 * blurRadius + 1),
+                         blurRadius, 0, cv::BORDER_REFLECT_101 | cv::BORDER_ISOLATED);
+        
+        // Blend color face with grayscale background using the mask
+        const cv::Point offset = window.tl() - source.tl();
+        for (int row = 0; row < window.height; row++) {
+            const cv::Vec3b* srcRow = color.ptr<cv::Vec3b>(window.y + row) + window.x;
+            const uchar* maskRow = mask.ptr<uchar>(offset.y + row) + offset.x;
+            cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(window.y + row) + window.x;
             
-            // Blend: result = alpha * color + (1 - alpha) * grayscale
-            for (int c = 0; c < 3; c++) {
-                dstRow[col][c] = static_cast<uchar>(
-                    alpha * srcRow[col][c] + (1.0f - alpha) * dstRow[col][c]
-                );
+            for (int col = 0; col < window.width; col++) {
+                float alpha = maskRow[col] / 255.0f;
+                
+                // Blend: result = alpha * color + (1 - alpha) * grayscale
+                for (int c = 0; c < 3; c++) {
+                    dstRow[col][c] = static_cast<uchar>(
+                        alpha * srcRow[col][c] + (1.0f - alpha) * dstRow[col][c]
+                    );
+                }
             }
         }
     }
@@ -693,41 +1117,56 @@ int faceHighlight(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &faces
 
 // Task 12: Cartoon Effect (bonus)
 // Combines edge detection with color quantization for cartoon look
-int cartoonEffect(cv::Mat &src, cv::Mat &dst) {
+// scale > 1: blur-quantize at low resolution, guided upsample back
+int cartoonEffect(cv::Mat &src, cv::Mat &dst, int scale) {
     if (src.empty() || src.channels() != 3) {
         std::cerr << "Error: Source must be a 3-channel color image" << std::endl;
         return -1;
     }
     
-    // Step 1: Get edges using gradient magnitude
-    cv::Mat sobelX, sobelY, edges;
-    if (sobelX3x3(src, sobelX) != 0 || sobelY3x3(src, sobelY) != 0) {
-        return -1;
-    }
-    if (magnitude(sobelX, sobelY, edges) != 0) {
+    // Step 1: Get edges using gradient magnitude (fused single pass)
+    FramePool &pool = FramePool::local();
+    FrameLease edgesLease = pool.acquire(src.size(), CV_8UC3);
+    cv::Mat &edges = edgesLease.mat();
+    if (sobelMagnitude3x3(src, edges) != 0) {
         return -1;
     }
     
     // Convert edges to grayscale
-    cv::Mat edgesGray;
+    FrameLease edgesGrayLease = pool.acquire(src.size(), CV_8UC1);
+    cv::Mat &edgesGray = edgesGrayLease.mat();
     cv::cvtColor(edges, edgesGray, cv::COLOR_BGR2GRAY);
     
     // Threshold edges to get strong edges only
-    cv::Mat edgeMask;
+    FrameLease edgeMaskLease = pool.acquire(src.size(), CV_8UC1);
+    cv::Mat &edgeMask = edgeMaskLease.mat();
     cv::threshold(edgesGray, edgeMask, 30, 255, cv::THRESH_BINARY);
     
     // Dilate edges slightly
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
+    static const cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
     cv::dilate(edgeMask, edgeMask, kernel);
     
     // Step 2: Quantize colors
-    cv::Mat quantized;
-    if (blurQuantize(src, quantized, 8) != 0) {
+    FrameLease quantizedLease = pool.acquire(src.size(), CV_8UC3);
+    cv::Mat &quantized = quantizedLease.mat();
+    if (scale > 1) {
+        // Same rounding as cv::resize with fx = fy = 1 / scale
+        cv::Size lowSize(cvRound(src.cols * (1.0 / scale)), cvRound(src.rows * (1.0 / scale)));
+        FrameLease lowLease = pool.acquire(lowSize, CV_8UC3);
+        FrameLease lowQuantizedLease = pool.acquire(lowSize, CV_8UC3);
+        cv::Mat &low = lowLease.mat();
+        cv::Mat &lowQuantized = lowQuantizedLease.mat();
+        cv::resize(src, low, lowSize, 0, 0, cv::INTER_AREA);
+        if (blurQuantize(low, lowQuantized, 8) != 0 ||
+            guidedUpsample(lowQuantized, low, src, quantized) != 0) {
+            return -1;
+        }
+    } else if (blurQuantize(src, quantized, 8) != 0) {
         return -1;
     }
     
     // Step 3: Combine - darken edges on quantized image
-    dst = quantized.clone();
+    quantized.copyTo(dst);
     
     for (int row = 0; row < dst.rows; row++) {
         const uchar* edgeRow = edgeMask.ptr<uchar>(row);
@@ -746,82 +1185,273 @@ int cartoonEffect(cv::Mat &src, cv::Mat &dst) {
     return 0;
 }
 
+// Fast guided filter upsampling, shared by the cv::Mat and cv::UMat entry
+// points. All arithmetic is on CV_32F images normalized to [0,1].
+// Intermediates of guidedUpsampleImpl; the cv::Mat path keeps one set per
+// thread so repeated calls at the same size reuse the buffers
+template <typename M>
+struct GuidedScratch {
+    M I, p, tmp, meanI, meanP, meanIP, meanII, covIP, varI;
+    M a, b, meanA, meanB, aUp, bUp, Ifull;
+};
+
+template <typename M>
+static void guidedUpsampleImpl(const M &lowTarget, const M &lowGuide,
+                               const M &fullGuide, M &dst, int radius, double eps,
+                               GuidedScratch<M> &s) {
+    const cv::Size box(2 * radius + 1, 2 * radius + 1);
+    M &I = s.I, &p = s.p, &tmp = s.tmp;
+    lowGuide.convertTo(I, CV_32F, 1.0 / 255.0);
+    lowTarget.convertTo(p, CV_32F, 1.0 / 255.0);
+    
+    // Local means and (co)variances
+    M &meanI = s.meanI, &meanP = s.meanP, &meanIP = s.meanIP, &meanII = s.meanII;
+    cv::boxFilter(I, meanI, CV_32F, box);
+    cv::boxFilter(p, meanP, CV_32F, box);
+    cv::multiply(I, p, tmp);
+    cv::boxFilter(tmp, meanIP, CV_32F, box);
+    cv::multiply(I, I, tmp);
+    cv::boxFilter(tmp, meanII, CV_32F, box);
+    
+    M &covIP = s.covIP, &varI = s.varI;
+    cv::multiply(meanI, meanP, tmp);
+    cv::subtract(meanIP, tmp, covIP);
+    cv::multiply(meanI, meanI, tmp);
+    cv::subtract(meanII, tmp, varI);
+    cv::add(varI, cv::Scalar::all(eps), varI);
+    
+    // Linear coefficients, averaged over every window covering a pixel
+    M &a = s.a, &b = s.b, &meanA = s.meanA, &meanB = s.meanB;
+    cv::divide(covIP, varI, a);
+    cv::multiply(a, meanI, tmp);
+    cv::subtract(meanP, tmp, b);
+    cv::boxFilter(a, meanA, CV_32F, box);
+    cv::boxFilter(b, meanB, CV_32F, box);
+    
+    // Upsample the smooth coefficients, apply them to the sharp guide
+    M &aUp = s.aUp, &bUp = s.bUp, &Ifull = s.Ifull;
+    cv::resize(meanA, aUp, fullGuide.size(), 0, 0, cv::INTER_LINEAR);
+    cv::resize(meanB, bUp, fullGuide.size(), 0, 0, cv::INTER_LINEAR);
+    fullGuide.convertTo(Ifull, CV_32F, 1.0 / 255.0);
+    cv::multiply(aUp, Ifull, tmp);
+    cv::add(tmp, bUp, tmp);
+    tmp.convertTo(dst, CV_8U, 255.0);
+}
+
+// Shared argument checks for both guidedUpsample overloads
+template <typename M>
+static bool guidedUpsampleArgsValid(const M &lowTarget, const M &lowGuide, const M &fullGuide) {
+    if (lowTarget.empty() || lowGuide.empty() || fullGuide.empty() ||
+        lowTarget.type() != CV_8UC3 || lowGuide.type() != CV_8UC3 ||
+        fullGuide.type() != CV_8UC3 || lowTarget.size() != lowGuide.size()) {
+        std::cerr << "Error: guidedUpsample needs CV_8UC3 inputs with matching low-resolution sizes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int guidedUpsample(const cv::Mat &lowTarget, const cv::Mat &lowGuide,
+                   const cv::Mat &fullGuide, cv::Mat &dst, int radius, double eps) {
+    if (!guidedUpsampleArgsValid(lowTarget, lowGuide, fullGuide)) {
+        return -1;
+    }
+    static thread_local GuidedScratch<cv::Mat> scratch;
+    guidedUpsampleImpl(lowTarget, lowGuide, fullGuide, dst, radius, eps, scratch);
+    return 0;
+}
+
+int guidedUpsample(const cv::UMat &lowTarget, const cv::UMat &lowGuide,
+                   const cv::UMat &fullGuide, cv::UMat &dst, int radius, double eps) {
+    if (!guidedUpsampleArgsValid(lowTarget, lowGuide, fullGuide)) {
+        return -1;
+    }
+    GuidedScratch<cv::UMat> scratch;
+    guidedUpsampleImpl(lowTarget, lowGuide, fullGuide, dst, radius, eps, scratch);
+    return 0;
+}
+
+// Blur levels used by depthFocus: 0 = sharp source, k = pyramid level k
+// upsampled to full resolution (level 4 is close to the former 31x31,
+// sigma 15 Gaussian)
+static const int FOCUS_LEVELS = 5;
+
+// Per-depth Q8 weight of each blur level (FOCUS_LEVELS x 256 CV_16U).
+// The blur amount from the focus distance is mapped to a fractional level
+// and split between the two neighbouring levels, so every column sums to
+// 256. Rebuilt only when focusDepth or focusRange change.
+static std::shared_ptr<const cv::Mat> depthFocusTable(int focusDepth, int focusRange) {
+    static std::mutex cacheMutex;
+    static std::shared_ptr<const cv::Mat> cached;
+    static int cachedDepth = -1, cachedRange = -1;
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cached && cachedDepth == focusDepth && cachedRange == focusRange) {
+        return cached;
+    }
+    
+    std::shared_ptr<cv::Mat> table = std::make_shared<cv::Mat>(cv::Mat::zeros(FOCUS_LEVELS, 256, CV_16UC1));
+    for (int d = 0; d < 256; d++) {
+        // Blur amount (0 = sharp, 1 = full blur) as in the float version
+        int depthDiff = std::abs(d - focusDepth);
+        float blurAmount = 0.0f;
+        if (depthDiff > focusRange) {
+            blurAmount = std::min(1.0f, (depthDiff - focusRange) / 80.0f);
+        }
+        
+        float level = blurAmount * (FOCUS_LEVELS - 1);
+        int lo = std::min(static_cast<int>(level), FOCUS_LEVELS - 2);
+        int upper = cvRound((level - lo) * DEPTH_BLEND_ONE);
+        table->at<ushort>(lo, d) = static_cast<ushort>(DEPTH_BLEND_ONE - upper);
+        table->at<ushort>(lo + 1, d) = static_cast<ushort>(upper);
+    }
+    
+    cached = table;
+    cachedDepth = focusDepth;
+    cachedRange = focusRange;
+    return cached;
+}
+
+// Helper for depthFocus: acc{B,G,R} += level pixel * weight, 16 pixels per
+// step. Weights of all levels sum to 256, so the accumulators stay below
+// 255 * 256 + 128.
+static void accumulateWeightedRow(const uchar* px, const ushort* weight,
+                                  ushort* accB, ushort* accG, ushort* accR,
+                                  int n, bool useSimd) {
+    int col = 0;
+#if CV_SIMD128
+    if (useSimd) {
+        ushort* acc[3] = {accB, accG, accR};
+        for (; col + 16 <= n; col += 16) {
+            cv::v_uint8x16 ch[3];
+            cv::v_load_deinterleave(px + col * 3, ch[0], ch[1], ch[2]);
+            cv::v_uint16x8 w0 = cv::v_load(weight + col), w1 = cv::v_load(weight + col + 8);
+            for (int c = 0; c < 3; c++) {
+                cv::v_uint16x8 lo, hi;
+                cv::v_expand(ch[c], lo, hi);
+                cv::v_store(acc[c] + col, cv::v_load(acc[c] + col) + lo * w0);
+                cv::v_store(acc[c] + col + 8, cv::v_load(acc[c] + col + 8) + hi * w1);
+            }
+        }
+    }
+#endif
+    for (; col < n; col++) {
+        accB[col] = static_cast<ushort>(accB[col] + px[col * 3 + 0] * weight[col]);
+        accG[col] = static_cast<ushort>(accG[col] + px[col * 3 + 1] * weight[col]);
+        accR[col] = static_cast<ushort>(accR[col] + px[col * 3 + 2] * weight[col]);
+    }
+}
+
+// Helper for depthFocus: dst = acc >> 8, re-interleaved to BGR
+static void storeAccumulatedRow(const ushort* accB, const ushort* accG, const ushort* accR,
+                                uchar* dstRow, int n, bool useSimd) {
+    int col = 0;
+#if CV_SIMD128
+    if (useSimd) {
+        for (; col + 16 <= n; col += 16) {
+            cv::v_uint8x16 b = cv::v_pack(cv::v_shr<DEPTH_BLEND_BITS>(cv::v_load(accB + col)),
+                                          cv::v_shr<DEPTH_BLEND_BITS>(cv::v_load(accB + col + 8)));
+            cv::v_uint8x16 g = cv::v_pack(cv::v_shr<DEPTH_BLEND_BITS>(cv::v_load(accG + col)),
+                                          cv::v_shr<DEPTH_BLEND_BITS>(cv::v_load(accG + col + 8)));
+            cv::v_uint8x16 r = cv::v_pack(cv::v_shr<DEPTH_BLEND_BITS>(cv::v_load(accR + col)),
+                                          cv::v_shr<DEPTH_BLEND_BITS>(cv::v_load(accR + col + 8)));
+            cv::v_store_interleave(dstRow + col * 3, b, g, r);
+        }
+    }
+#endif
+    for (; col < n; col++) {
+        dstRow[col * 3 + 0] = static_cast<uchar>(accB[col] >> DEPTH_BLEND_BITS);
+        dstRow[col * 3 + 1] = static_cast<uchar>(accG[col] >> DEPTH_BLEND_BITS);
+        dstRow[col * 3 + 2] = static_cast<uchar>(accR[col] >> DEPTH_BLEND_BITS);
+    }
+}
+
 // Extension: Depth-based focus effect (portrait mode)
 // Blurs areas that are far from the focus depth
 int depthFocus(cv::Mat &src, cv::Mat &depth, cv::Mat &dst, int focusDepth, int focusRange) {
-    if (src.empty() || depth.empty() || src.size() != depth.size()) {
+    if (src.empty() || depth.empty() || src.size() != depth.size() ||
+        src.type() != CV_8UC3 || depth.type() != CV_8UC1) {
         std::cerr << "Error: Invalid input for depth focus" << std::endl;
         return -1;
     }
     
-    // Create heavily blurred version for background
-    cv::Mat blurred;
-    cv::GaussianBlur(src, blurred, cv::Size(31, 31), 15);
+    std::shared_ptr<const cv::Mat> table = depthFocusTable(focusDepth, focusRange);
+    
+    // Only levels with a non-zero weight somewhere in this frame's depth
+    // range are built and blended
+    double minDepth = 0.0, maxDepth = 0.0;
+    cv::minMaxLoc(depth, &minDepth, &maxDepth);
+    int active[FOCUS_LEVELS];
+    int activeCount = 0;
+    for (int k = 0; k < FOCUS_LEVELS; k++) {
+        const ushort* weights = table->ptr<ushort>(k);
+        for (int d = static_cast<int>(minDepth); d <= static_cast<int>(maxDepth); d++) {
+            if (weights[d] != 0) {
+                active[activeCount++] = k;
+                break;
+            }
+        }
+    }
+    
+    // One pyramid per frame instead of a full-resolution 31x31 blur; each
+    // active coarse level is upsampled once and indexed by depth. Levels
+    // are pooled: same sizes as cv::buildPyramid, no per-frame allocation
+    FramePool &pool = FramePool::local();
+    FrameLease pyramid[FOCUS_LEVELS];
+    FrameLease upsampled[FOCUS_LEVELS];
+    cv::Mat levels[FOCUS_LEVELS];
+    FrameLease inputCopy;
+    levels[0] = inPlaceSource(src, dst, inputCopy);
+    
+    const int deepest = activeCount > 0 ? active[activeCount - 1] : 0;
+    cv::Mat prev = levels[0];
+    for (int k = 1; k <= deepest; k++) {
+        pyramid[k] = pool.acquire(cv::Size((prev.cols + 1) / 2, (prev.rows + 1) / 2), src.type());
+        cv::pyrDown(prev, pyramid[k].mat(), pyramid[k].mat().size());
+        prev = pyramid[k].mat();
+    }
+    for (int i = 0; i < activeCount; i++) {
+        int k = active[i];
+        if (k > 0) {
+            upsampled[k] = pool.acquire(src.size(), src.type());
+            levels[k] = upsampled[k].mat();
+            cv::resize(pyramid[k].mat(), levels[k], src.size(), 0, 0, cv::INTER_LINEAR);
+        }
+    }
     
     dst.create(src.size(), src.type());
-    
-    // Blend based on depth distance from focus point
-    for (int row = 0; row < src.rows; row++) {
-        const cv::Vec3b* srcRow = src.ptr<cv::Vec3b>(row);
-        const cv::Vec3b* blurRow = blurred.ptr<cv::Vec3b>(row);
-        const uchar* depthRow = depth.ptr<uchar>(row);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(row);
+    const bool useSimd = cv::useOptimized();
+    
+    size_t bytesPerRow = src.step * (activeCount + 1) + depth.step;
+    parallelRowBands(src.rows, bytesPerRow, [&](const cv::Range &band) {
+        const int n = src.cols;
+        // Rows 0-2: B/G/R accumulators, row 3: weights of the current level
+        FrameLease scratch = FramePool::local().acquire(cv::Size(n, 4), CV_16UC1);
+        ushort* accB = scratch.mat().ptr<ushort>(0);
+        ushort* accG = scratch.mat().ptr<ushort>(1);
+        ushort* accR = scratch.mat().ptr<ushort>(2);
+        ushort* weight = scratch.mat().ptr<ushort>(3);
         
-        for (int col = 0; col < src.cols; col++) {
-            // Calculate distance from focus depth
-            int depthDiff = std::abs(static_cast<int>(depthRow[col]) - focusDepth);
+        for (int row = band.start; row < band.end; row++) {
+            const uchar* depthRow = depth.ptr<uchar>(row);
+            std::fill(accB, accB + n, static_cast<ushort>(DEPTH_BLEND_ONE / 2));
+            std::fill(accG, accG + n, static_cast<ushort>(DEPTH_BLEND_ONE / 2));
+            std::fill(accR, accR + n, static_cast<ushort>(DEPTH_BLEND_ONE / 2));
             
-            // Calculate blur amount (0 = sharp, 1 = full blur)
-            float blurAmount = 0.0f;
-            if (depthDiff > focusRange) {
-                // Smooth transition beyond focus range
-                blurAmount = std::min(1.0f, (depthDiff - focusRange) / 80.0f);
-            }
-            
-            // Blend sharp and blurred
-            for (int c = 0; c < 3; c++) {
-                dstRow[col][c] = static_cast<uchar>(
-                    srcRow[col][c] * (1.0f - blurAmount) + 
-                    blurRow[col][c] * blurAmount
-                );
+            for (int i = 0; i < activeCount; i++) {
+                const ushort* lut = table->ptr<ushort>(active[i]);
+                for (int col = 0; col < n; col++) {
+                    weight[col] = lut[depthRow[col]];
+                }
+                accumulateWeightedRow(levels[active[i]].ptr<uchar>(row), weight,
+                                      accB, accG, accR, n, useSimd);
             }
+            storeAccumulatedRow(accB, accG, accR, dst.ptr<uchar>(row), n, useSimd);
         }
-    }
+    });
     
     return 0;
 }
 
-// Helper function for bilinear interpolation
-// Provides smooth pixel values for non-integer coordinates
-static cv::Vec3b bilinearInterpolate(const cv::Mat &src, float x, float y) {
-    // Bounds check
-    if (x < 0 || x >= src.cols - 1 || y < 0 || y >= src.rows - 1) {
-        return cv::Vec3b(0, 0, 0);
-    }
-    
-    int x0 = static_cast<int>(x);
-    int y0 = static_cast<int>(y);
-    float fx = x - x0;
-    float fy = y - y0;
-    
-    // Get four neighboring pixels
-    const cv::Vec3b& p00 = src.at<cv::Vec3b>(y0, x0);
-    const cv::Vec3b& p01 = src.at<cv::Vec3b>(y0, x0 + 1);
-    const cv::Vec3b& p10 = src.at<cv::Vec3b>(y0 + 1, x0);
-    const cv::Vec3b& p11 = src.at<cv::Vec3b>(y0 + 1, x0 + 1);
-    
-    cv::Vec3b result;
-    for (int c = 0; c < 3; c++) {
-        float val = (1 - fx) * (1 - fy) * p00[c] +
-                    fx * (1 - fy) * p01[c] +
-                    (1 - fx) * fy * p10[c] +
-                    fx * fy * p11[c];
-        result[c] = static_cast<uchar>(std::min(255.0f, std::max(0.0f, val)));
-    }
-    
-    return result;
-}
-
 /*
   Bulge Effect Implementation
   
@@ -831,68 +1461,23 @@ static cv::Vec3b bilinearInterpolate(const cv::Mat &src, float x, float y) {
   - Convert back to Cartesian coordinates
   - For strength < 1: pixels move outward (bulge)
   - For strength > 1: pixels move inward (pinch)
+  
+  The per-pixel source coordinates only depend on frame size and strength,
+  so they are precomputed into a remap table (WarpMapCache) and each frame
+  costs a single bilinear cv::remap.
 */
 int bulgeEffect(cv::Mat &src, cv::Mat &dst, float strength) {
     if (src.empty() || src.channels() != 3) {
         return -1;
     }
     
-    dst.create(src.size(), src.type());
-    
-    float cx = src.cols / 2.0f;
-    float cy = src.rows / 2.0f;
-    float radius = std::min(cx, cy) * 0.9f;
-    
-    // Invert strength: lower value = more bulge
-    // Map 0.1-1.0 to exponent that creates bulge
-    float exponent = 1.0f / (strength + 0.5f);
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceSource(src, dst, inputCopy);
+    WarpMaps maps = WarpMapCache::shared().get(WARP_BULGE, input.size(), strength);
     
-    for (int y = 0; y < src.rows; y++) {
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(y);
-        
-        for (int x = 0; x < src.cols; x++) {
-            float dx = x - cx;
-            float dy = y - cy;
-            float dist = std::sqrt(dx * dx + dy * dy);
-            
-            float srcX, srcY;
-            
-            if (dist < radius && dist > 0.001f) {
-                float normalizedDist = dist / radius;
-                
-                // Bulge: sample from inner radius to spread outward
-                float warpedDist = std::pow(normalizedDist, exponent);
-                float scale = warpedDist / normalizedDist;
-                
-                srcX = cx + dx * scale;
-                srcY = cy + dy * scale;
-            } else {
-                srcX = static_cast<float>(x);
-                srcY = static_cast<float>(y);
-            }
-            
-            // Bilinear interpolation
-            if (srcX >= 0 && srcX < src.cols - 1 && srcY >= 0 && srcY < src.rows - 1) {
-                int x0 = static_cast<int>(srcX);
-                int y0 = static_cast<int>(srcY);
-                float fx = srcX - x0;
-                float fy = srcY - y0;
-                
-                const cv::Vec3b& p00 = src.at<cv::Vec3b>(y0, x0);
-                const cv::Vec3b& p01 = src.at<cv::Vec3b>(y0, x0 + 1);
-                const cv::Vec3b& p10 = src.at<cv::Vec3b>(y0 + 1, x0);
-                const cv::Vec3b& p11 = src.at<cv::Vec3b>(y0 + 1, x0 + 1);
-                
-                for (int c = 0; c < 3; c++) {
-                    float val = (1-fx)*(1-fy)*p00[c] + fx*(1-fy)*p01[c] +
-                               (1-fx)*fy*p10[c] + fx*fy*p11[c];
-                    dstRow[x][c] = static_cast<uchar>(std::min(255.0f, std::max(0.0f, val)));
-                }
-            } else {
-                dstRow[x] = cv::Vec3b(0, 0, 0);
-            }
-        }
-    }
+    // Samples outside the frame become black, as before
+    cv::remap(input, dst, maps.map1, maps.map2, cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT, cv::Scalar::all(0));
     
     return 0;
 }
@@ -905,6 +1490,9 @@ int bulgeEffect(cv::Mat &src, cv::Mat &dst, float strength) {
   - Horizontal wave: x' = x + amplitude * sin(frequency * y * 2π)
   - Vertical wave: y' = y + amplitude * sin(frequency * x * 2π)
   - Creates ripple pattern across image
+  
+  The displacement is separable, so the remap table is built from one sine
+  lookup table per axis and cached per (size, amplitude, frequency).
 */
 int waveEffect(cv::Mat &src, cv::Mat &dst, float amplitude, float frequency) {
     if (src.empty() || src.channels() != 3) {
@@ -912,32 +1500,12 @@ int waveEffect(cv::Mat &src, cv::Mat &dst, float amplitude, float frequency) {
         return -1;
     }
     
-    dst.create(src.size(), src.type());
-    
-    const float PI = 3.14159265358979f;
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceSource(src, dst, inputCopy);
+    WarpMaps maps = WarpMapCache::shared().get(WARP_WAVE, input.size(), amplitude, frequency);
     
-    for (int y = 0; y < src.rows; y++) {
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(y);
-        
-        for (int x = 0; x < src.cols; x++) {
-            // Sinusoidal displacement
-            float offsetX = amplitude * std::sin(frequency * y * 2.0f * PI);
-            float offsetY = amplitude * std::sin(frequency * x * 2.0f * PI);
-            
-            float srcX = x + offsetX;
-            float srcY = y + offsetY;
-            
-            // Bounds check and sample
-            if (srcX >= 0 && srcX < src.cols - 1 && srcY >= 0 && srcY < src.rows - 1) {
-                dstRow[x] = bilinearInterpolate(src, srcX, srcY);
-            } else {
-                // Mirror at boundaries for smoother edges
-                srcX = std::max(0.0f, std::min(static_cast<float>(src.cols - 1), srcX));
-                srcY = std::max(0.0f, std::min(static_cast<float>(src.rows - 1), srcY));
-                dstRow[x] = src.at<cv::Vec3b>(static_cast<int>(srcY), static_cast<int>(srcX));
-            }
-        }
-    }
+    // Table coordinates are already clamped; replicate covers the last pixel
+    cv::remap(input, dst, maps.map1, maps.map2, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
     
     return 0;
 }
@@ -953,6 +1521,8 @@ int waveEffect(cv::Mat &src, cv::Mat &dst, float amplitude, float frequency) {
   
   Reference: This is a classic image warping technique used in 
   photo editing software like Photoshop's Twirl filter
+  
+  Trig is evaluated once per (size, angle) into a cached remap table.
 */
 int swirlEffect(cv::Mat &src, cv::Mat &dst, float angle) {
     if (src.empty() || src.channels() != 3) {
@@ -960,41 +1530,12 @@ int swirlEffect(cv::Mat &src, cv::Mat &dst, float angle) {
         return -1;
     }
     
-    dst.create(src.size(), src.type());
-    
-    float cx = src.cols / 2.0f;
-    float cy = src.rows / 2.0f;
-    float maxRadius = std::sqrt(cx * cx + cy * cy);
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceSource(src, dst, inputCopy);
+    WarpMaps maps = WarpMapCache::shared().get(WARP_SWIRL, input.size(), angle);
     
-    for (int y = 0; y < src.rows; y++) {
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(y);
-        
-        for (int x = 0; x < src.cols; x++) {
-            float dx = x - cx;
-            float dy = y - cy;
-            float dist = std::sqrt(dx * dx + dy * dy);
-            
-            // Rotation angle decreases with distance from center
-            // This creates the swirl effect
-            float theta = angle * (1.0f - dist / maxRadius);
-            
-            // Apply rotation transformation
-            // x' = x*cos(θ) - y*sin(θ)
-            // y' = x*sin(θ) + y*cos(θ)
-            float cosTheta = std::cos(theta);
-            float sinTheta = std::sin(theta);
-            
-            float srcX = cx + dx * cosTheta - dy * sinTheta;
-            float srcY = cy + dx * sinTheta + dy * cosTheta;
-            
-            // Sample with bilinear interpolation
-            if (srcX >= 0 && srcX < src.cols - 1 && srcY >= 0 && srcY < src.rows - 1) {
-                dstRow[x] = bilinearInterpolate(src, srcX, srcY);
-            } else {
-                dstRow[x] = cv::Vec3b(0, 0, 0);
-            }
-        }
-    }
+    cv::remap(input, dst, maps.map1, maps.map2, cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT, cv::Scalar::all(0));
     
     return 0;
 }
@@ -1010,6 +1551,11 @@ int swirlEffect(cv::Mat &src, cv::Mat &dst, float angle) {
   The key fix: We need to INVERT the mapping direction.
   Instead of asking "where does this destination pixel come from?"
   with a shrinking factor, we use an EXPANDING factor.
+  
+  The warp is local to each face and depends only on the face size and
+  strength, so the cache stores a face-relative table plus a mask of the
+  bulge circle. Each face then shifts the table to its position and remaps
+  just the window around it.
 */
 int faceBulgeEffect(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &faces, float strength) {
     if (src.empty() || src.channels() != 3) {
@@ -1017,77 +1563,72 @@ int faceBulgeEffect(cv::Mat &src, cv::Mat &dst, const std::vector<cv::Rect> &fac
         return -1;
     }
     
-    // Start with original image
-    dst = src.clone();
-    
     if (faces.empty()) {
+        if (src.data != dst.data) {
+            src.copyTo(dst);
+        }
         return 0;
     }
     
-    // Invert strength for intuitive control: lower = more bulge
-    // Map strength 0.1-1.0 to exponent 2.0-1.0 (inverted power)
-    float exponent = 1.0f / (strength + 0.5f);  // strength 0.5 -> exp 1.33, strength 0.1 -> exp 1.67
+    const cv::Rect frame(0, 0, src.cols, src.rows);
     
+    // Cached face-relative table of each face and the window it covers,
+    // clipped to the frame. Sources lie inside the bulge circle; one more
+    // pixel for the bilinear neighbours
+    std::vector<WarpMaps> faceMaps;
+    std::vector<cv::Rect> sources;
     for (const cv::Rect& face : faces) {
-        // Face center
-        float cx = face.x + face.width / 2.0f;
-        float cy = face.y + face.height / 2.0f;
+        faceMaps.push_back(WarpMapCache::shared().get(WARP_FACE_BULGE, face.size(), strength));
+        const WarpMaps &maps = faceMaps.back();
+        cv::Rect source(face.x + maps.origin.x - 1, face.y + maps.origin.y - 1,
+                        maps.map1.cols + 2, maps.map1.rows + 2);
+        source &= frame;
+        if (!source.empty()) {
+            sources.push_back(source);
+        }
+    }
+    
+    // Start with original image: one full copy, none when working in place
+    // (then only the face windows are saved)
+    FrameLease inputCopy;
+    cv::Mat input = inPlaceRegions(src, dst, sources, inputCopy);
+    if (src.data != dst.data) {
+        src.copyTo(dst);
+    }
+    
+    // Face windows change size every frame: lease frame-sized buffers and
+    // work in their top-left corner so the pool sees one shape
+    FramePool &pool = FramePool::local();
+    FrameLease mapLease = pool.acquire(input.size(), CV_16SC2);
+    FrameLease warpedLease = pool.acquire(input.size(), CV_8UC3);
+    
+    for (size_t i = 0; i < faces.size(); i++) {
+        const cv::Rect &face = faces[i];
+        const WarpMaps &maps = faceMaps[i];
         
-        // Effect radius - covers the face
-        float radius = std::max(face.width, face.height) * 0.75f;
+        // Window covered by the table, clipped to the frame
+        cv::Rect window(face.x + maps.origin.x, face.y + maps.origin.y,
+                        maps.map1.cols, maps.map1.rows);
+        cv::Rect clipped = window & frame;
+        if (clipped.empty()) {
+            continue;
+        }
+        cv::Rect local(clipped.x - window.x, clipped.y - window.y,
+                       clipped.width, clipped.height);
         
-        // Process region around face
-        int pad = static_cast<int>(radius * 1.2f);
-        int x1 = std::max(0, static_cast<int>(cx - radius - pad));
-        int y1 = std::max(0, static_cast<int>(cy - radius - pad));
-        int x2 = std::min(src.cols, static_cast<int>(cx + radius + pad));
-        int y2 = std::min(src.rows, static_cast<int>(cy + radius + pad));
+        // Shift face-relative integer coordinates to frame coordinates
+        const cv::Rect corner(0, 0, clipped.width, clipped.height);
+        cv::Mat frameMap1 = mapLease.mat()(corner);
+        cv::add(maps.map1(local), cv::Scalar(face.x, face.y), frameMap1);
         
-        for (int y = y1; y < y2; y++) {
-            cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(y);
-            
-            for (int x = x1; x < x2; x++) {
-                float dx = x - cx;
-                float dy = y - cy;
-                float dist = std::sqrt(dx * dx + dy * dy);
-                
-                if (dist < radius && dist > 0.001f) {
-                    // Normalize distance to [0, 1]
-                    float normalizedDist = dist / radius;
-                    
-                    // Apply inverse power for bulge effect
-                    // When exponent > 1: pixels from center spread outward (bulge)
-                    // This makes the face appear larger
-                    float warpedDist = std::pow(normalizedDist, exponent);
-                    
-                    // Calculate source coordinates (where to sample FROM)
-                    // We sample from a SMALLER radius to create enlargement
-                    float scale = warpedDist / normalizedDist;
-                    
-                    float srcX = cx + dx * scale;
-                    float srcY = cy + dy * scale;
-                    
-                    // Bilinear interpolation
-                    if (srcX >= 0 && srcX < src.cols - 1 && srcY >= 0 && srcY < src.rows - 1) {
-                        int x0 = static_cast<int>(srcX);
-                        int y0 = static_cast<int>(srcY);
-                        float fx = srcX - x0;
-                        float fy = srcY - y0;
-                        
-                        const cv::Vec3b& p00 = src.at<cv::Vec3b>(y0, x0);
-                        const cv::Vec3b& p01 = src.at<cv::Vec3b>(y0, x0 + 1);
-                        const cv::Vec3b& p10 = src.at<cv::Vec3b>(y0 + 1, x0);
-                        const cv::Vec3b& p11 = src.at<cv::Vec3b>(y0 + 1, x0 + 1);
-                        
-                        for (int c = 0; c < 3; c++) {
-                            float val = (1-fx)*(1-fy)*p00[c] + fx*(1-fy)*p01[c] +
-                                       (1-fx)*fy*p10[c] + fx*fy*p11[c];
-                            dstRow[x][c] = static_cast<uchar>(std::min(255.0f, std::max(0.0f, val)));
-                        }
-                    }
-                }
-            }
-        }
+        // Transparent border: pixels whose source falls outside stay unchanged
+        cv::Mat warped = warpedLease.mat()(corner);
+        dst(clipped).copyTo(warped);
+        cv::remap(input, warped, frameMap1, maps.map2(local), cv::INTER_LINEAR,
+                  cv::BORDER_TRANSPARENT);
+        
+        // Only pixels inside the bulge radius are replaced
+        warped.copyTo(dst(clipped), maps.mask(local));
     }
     
     return 0;
@@ -1281,7 +1822,7 @@ int sparkleEffect(cv::Mat &src, cv::Mat &dst,
     }
     
     // Start with original image
-    dst = src.clone();
+    src.copyTo(dst);
     
     if (faces.empty()) {
         return 0;
@@ -0,0 +1,301 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Micro-benchmark suite for every filter in filters.hpp, the
+           edge-preserving smoothers and CartoonVideo::processFrame. Runs each case over synthetic 480p,
+           720p, 1080p and 4K frames and reports ns/pixel, throughput and
+           allocations per call. Timing, the JSON report and the comparison
+           against a previous run come from the shared harness
+           (cvcore/benchmark.hpp), which makes the suite a regression gate.
+           Allocation columns need cvcore built with CVCORE_ALLOC_TRACKING.
+*/
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/benchmark.hpp>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "filters.hpp"
+#include "cartoonVideo.hpp"
+#include "edgePreserving.hpp"
+#include "pointOps.hpp"
+#include "separableFilter.hpp"
+#include "framePool.hpp"
+
+using namespace cv;
+using namespace std;
+
+// ============================================================================
+// Benchmark cases
+// ============================================================================
+
+/*
+  Struct: BenchInput
+  Purpose: Synthetic inputs for one frame size, shared by all cases
+*/
+struct BenchInput {
+    string label;
+    Mat color;                // CV_8UC3 gradients, shapes and noise
+    Mat depth;                // CV_8UC1 vertical ramp, 0 = close
+    Mat sobelX, sobelY;       // Precomputed gradients for magnitude()
+    Mat lowTarget, lowGuide;  // Half-size images for guidedUpsample
+    vector<Rect> faces;       // Two fixed face boxes (no cascade)
+};
+
+/*
+  Function: makeInput
+  Purpose: Build the inputs around the harness's deterministic synthetic
+           frame (gradients, hard-edged shapes, mild noise)
+*/
+BenchInput makeInput(const string &label, Size size) {
+    BenchInput in;
+    in.label = label;
+    in.color = cvcore::syntheticImage(size, CV_8UC3);
+
+    in.depth.create(size, CV_8UC1);
+    for (int y = 0; y < size.height; y++) {
+        in.depth.row(y).setTo(Scalar(255 * y / size.height));
+    }
+
+    sobelX3x3(in.color, in.sobelX);
+    sobelY3x3(in.color, in.sobelY);
+    resize(in.color, in.lowGuide, Size(size.width / 2, size.height / 2), 0, 0, INTER_AREA);
+    GaussianBlur(in.lowGuide, in.lowTarget, Size(9, 9), 0);
+
+    int fw = size.width / 6, fh = size.height / 4;
+    in.faces.push_back(Rect(size.width / 4 - fw / 2, size.height / 3, fw, fh));
+    in.faces.push_back(Rect(3 * size.width / 4 - fw / 2, size.height / 3, fw, fh));
+    return in;
+}
+
+typedef function<int(BenchInput &, Mat &)> BenchFn;
+
+struct BenchCase {
+    string name;
+    BenchFn run;
+};
+
+/*
+  Function: makeCases
+  Purpose: One case per public filter (plus variants of the main options)
+  Arguments:
+    cartoon - CartoonVideo instances reused across calls (temporal state);
+              cartoonReference runs the unfused stylization stages
+    sparkles - persistent sparkle state for sparkleEffect
+*/
+vector<BenchCase> makeCases(CartoonVideo &cartoon, CartoonVideo &cartoonHalf,
+                            CartoonVideo &cartoonFast, CartoonVideo &cartoonIncremental,
+                            CartoonVideo &cartoonReference, vector<vector<Sparkle>> &sparkles) {
+    vector<BenchCase> c;
+    c.push_back({"greyscale", [](BenchInput &in, Mat &d) { return greyscale(in.color, d); }});
+    c.push_back({"sepiaTone", [](BenchInput &in, Mat &d) { return sepiaTone(in.color, d, true); }});
+    c.push_back({"sepiaTone/noVignette", [](BenchInput &in, Mat &d) { return sepiaTone(in.color, d, false); }});
+    c.push_back({"blur5x5_1", [](BenchInput &in, Mat &d) { return blur5x5_1(in.color, d); }});
+    c.push_back({"blur5x5_2", [](BenchInput &in, Mat &d) { return blur5x5_2(in.color, d); }});
+    c.push_back({"blur5x5_simd", [](BenchInput &in, Mat &d) { return blur5x5_simd(in.color, d); }});
+    c.push_back({"sobelX3x3", [](BenchInput &in, Mat &d) { return sobelX3x3(in.color, d); }});
+    c.push_back({"sobelY3x3", [](BenchInput &in, Mat &d) { return sobelY3x3(in.color, d); }});
+    // Template separable engine vs. the hand-written kernels above
+    c.push_back({"blurBinomial3", [](BenchInput &in, Mat &d) { return blurBinomial3(in.color, d); }});
+    c.push_back({"blurBinomial5", [](BenchInput &in, Mat &d) { return blurBinomial5(in.color, d); }});
+    c.push_back({"blurBinomial7", [](BenchInput &in, Mat &d) { return blurBinomial7(in.color, d); }});
+    c.push_back({"sobelXSeparable", [](BenchInput &in, Mat &d) { return sobelXSeparable(in.color, d); }});
+    c.push_back({"sobelYSeparable", [](BenchInput &in, Mat &d) { return sobelYSeparable(in.color, d); }});
+    c.push_back({"scharrXSeparable", [](BenchInput &in, Mat &d) { return scharrXSeparable(in.color, d); }});
+    c.push_back({"embossSeparable", [](BenchInput &in, Mat &d) { return embossSeparable(in.color, d); }});
+    c.push_back({"magnitude", [](BenchInput &in, Mat &d) { return magnitude(in.sobelX, in.sobelY, d); }});
+    c.push_back({"sobelMagnitude3x3", [](BenchInput &in, Mat &d) { return sobelMagnitude3x3(in.color, d); }});
+    c.push_back({"blurQuantize", [](BenchInput &in, Mat &d) { return blurQuantize(in.color, d, 10); }});
+    c.push_back({"depthFog", [](BenchInput &in, Mat &d) { return depthFog(in.color, in.depth, d, 3.0f); }});
+    c.push_back({"depthFocus", [](BenchInput &in, Mat &d) { return depthFocus(in.color, in.depth, d, 200, 40); }});
+    c.push_back({"embossEffect", [](BenchInput &in, Mat &d) { return embossEffect(in.color, d); }});
+    c.push_back({"negativeEffect", [](BenchInput &in, Mat &d) { return negativeEffect(in.color, d); }});
+    c.push_back({"faceHighlight", [](BenchInput &in, Mat &d) { return faceHighlight(in.color, d, in.faces); }});
+    c.push_back({"cartoonEffect", [](BenchInput &in, Mat &d) { return cartoonEffect(in.color, d, 1); }});
+    c.push_back({"cartoonEffect/scale2", [](BenchInput &in, Mat &d) { return cartoonEffect(in.color, d, 2); }});
+    c.push_back({"guidedUpsample", [](BenchInput &in, Mat &d) {
+        return guidedUpsample(in.lowTarget, in.lowGuide, in.color, d);
+    }});
+    // Pointwise chains: fused into one pass vs. one filter call per step
+    c.push_back({"pipe(sepia,vignette,negative)", [](BenchInput &in, Mat &d) {
+        return pipe(sepia(), vignette(), negative())(in.color, d);
+    }});
+    c.push_back({"sepiaTone+negativeEffect", [](BenchInput &in, Mat &d) {
+        FrameLease tmp = FramePool::local().acquireLike(in.color);
+        if (sepiaTone(in.color, tmp.mat(), true) != 0) {
+            return -1;
+        }
+        return negativeEffect(tmp.mat(), d);
+    }});
+    c.push_back({"pipe(grey,quantize)", [](BenchInput &in, Mat &d) {
+        return pipe(grey(), quantize(10))(in.color, d);
+    }});
+    // Edge-preserving smoothers at the cartoon defaults (d = 9, sigmaColor = 90)
+    c.push_back({"bilateralFilter/reference", [](BenchInput &in, Mat &d) {
+        bilateralFilter(in.color, d, 9, 90.0, 90.0);
+        return 0;
+    }});
+    c.push_back({"domainTransformFilter", [](BenchInput &in, Mat &d) {
+        return domainTransformFilter(in.color, d, 4.5, 90.0);
+    }});
+    c.push_back({"bilateralGridFilter", [](BenchInput &in, Mat &d) {
+        return bilateralGridFilter(in.color, d, 4.5, 90.0);
+    }});
+    c.push_back({"guidedFilter", [](BenchInput &in, Mat &d) { return guidedFilter(in.color, d, 5, 0.125); }});
+    c.push_back({"bulgeEffect", [](BenchInput &in, Mat &d) { return bulgeEffect(in.color, d, 0.5f); }});
+    c.push_back({"waveEffect", [](BenchInput &in, Mat &d) { return waveEffect(in.color, d, 10.0f, 0.035f); }});
+    c.push_back({"swirlEffect", [](BenchInput &in, Mat &d) { return swirlEffect(in.color, d, 2.0f); }});
+    c.push_back({"faceBulgeEffect", [](BenchInput &in, Mat &d) {
+        return faceBulgeEffect(in.color, d, in.faces, 0.4f);
+    }});
+    c.push_back({"sparkleEffect", [&sparkles](BenchInput &in, Mat &d) {
+        return sparkleEffect(in.color, d, in.faces, sparkles, 1.0f);
+    }});
+    c.push_back({"initializeSparkles", [&sparkles](BenchInput &in, Mat &) {
+        initializeSparkles(sparkles, in.faces, 12);
+        return 0;
+    }});
+    c.push_back({"CartoonVideo::processFrame", [&cartoon](BenchInput &in, Mat &d) {
+        return cartoon.processFrame(in.color, d);
+    }});
+    c.push_back({"CartoonVideo::processFrame/unfused", [&cartoonReference](BenchInput &in, Mat &d) {
+        return cartoonReference.processFrame(in.color, d);
+    }});
+    c.push_back({"CartoonVideo::processFrame/scale2", [&cartoonHalf](BenchInput &in, Mat &d) {
+        return cartoonHalf.processFrame(in.color, d);
+    }});
+    c.push_back({"CartoonVideo::processFrame/domain", [&cartoonFast](BenchInput &in, Mat &d) {
+        return cartoonFast.processFrame(in.color, d);
+    }});
+    // Static input: after the first call no tile is dirty
+    c.push_back({"CartoonVideo::processFrame/incremental", [&cartoonIncremental](BenchInput &in, Mat &d) {
+        return cartoonIncremental.processFrame(in.color, d);
+    }});
+    return c;
+}
+
+// ============================================================================
+// Measurement and reporting
+// ============================================================================
+
+/*
+  Function: runCase
+  Purpose: Time one case through the harness (one warm-up call allocates
+           outputs and caches, then the median of the timed calls) and add
+           the FramePool allocations of the timed calls
+  Return value: the recorded result, or nullptr if the filter reports an error
+*/
+cvcore::BenchResult *runCase(cvcore::BenchSuite &suite, const BenchCase &bc, BenchInput &in,
+                             int warmup) {
+    Mat dst;
+    int calls = 0;
+    long poolAllocations = 0;
+    cvcore::BenchResult *r = suite.run(bc.name + "@" + in.label, [&]() {
+        long before = FramePool::totalAllocations();
+        bool ok = bc.run(in, dst) == 0;
+        if (calls++ >= warmup) {
+            poolAllocations += FramePool::totalAllocations() - before;
+        }
+        return ok;
+    }, (double)in.color.cols * in.color.rows, "pixel");
+    if (r != nullptr) {
+        r->labels["case"] = bc.name;
+        r->labels["size"] = in.label;
+        r->extra["ns_per_pixel"] = r->p50Ms * 1e6 / ((double)in.color.cols * in.color.rows);
+        r->extra["pool_allocs_per_call"] = (double)poolAllocations / r->iterations;
+    }
+    return r;
+}
+
+/*
+  Function: printUsage
+  Purpose: Print command line help
+*/
+void printUsage(const char *prog) {
+    cout << "Usage: " << prog << " [options]" << endl;
+    cout << "  --sizes <list>      comma separated subset of 480p,720p,1080p,4k (default: all)" << endl;
+    cout << cvcore::BenchOptions::usage();
+}
+
+/*
+  Function: main
+  Purpose: Benchmark entry point
+  Return value: 0 on success, -1 on error or regression
+*/
+int main(int argc, char *argv[]) {
+    cvcore::BenchOptions options;
+    string sizeList = "480p,720p,1080p,4k";
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) sizeList = argv[++i];
+        else if (!options.consume(i, argc, argv)) {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    static const struct { const char *label; Size size; } SIZES[] = {
+        {"480p", Size(640, 480)},
+        {"720p", Size(1280, 720)},
+        {"1080p", Size(1920, 1080)},
+        {"4k", Size(3840, 2160)}
+    };
+
+    CartoonVideo cartoon, cartoonHalf, cartoonFast, cartoonIncremental, cartoonReference;
+    cartoonHalf.setProcessingScale(2);
+    cartoonReference.setFusedStylize(false);
+    cartoonFast.setSmoother(CARTOON_SMOOTH_DOMAIN_TRANSFORM);
+    cartoonIncremental.setIncremental(true);
+    vector<vector<Sparkle>> sparkles;
+    vector<BenchCase> cases = makeCases(cartoon, cartoonHalf, cartoonFast, cartoonIncremental,
+                                        cartoonReference, sparkles);
+
+    cvcore::BenchSuite suite("filtersBench", options);
+    cout << "=== Filter Benchmark ===" << endl;
+    suite.printEnvironment(cout);
+    cout << left << setw(36) << "case" << setw(7) << "size" << right << setw(8) << "iters"
+         << setw(11) << "ms" << setw(10) << "ns/px" << setw(11) << "Mpix/s"
+         << setw(8) << "heap" << setw(7) << "mats" << setw(7) << "pool" << endl;
+
+    bool failed = false;
+    for (const auto &sz : SIZES) {
+        if (("," + sizeList + ",").find(string(",") + sz.label + ",") == string::npos) {
+            continue;
+        }
+        BenchInput input = makeInput(sz.label, sz.size);
+
+        for (const BenchCase &bc : cases) {
+            if (!suite.selected(bc.name + "@" + sz.label)) {
+                continue;
+            }
+            // Temporal state must not carry over between frame sizes
+            cartoon.resetTemporalBuffer();
+            cartoonHalf.resetTemporalBuffer();
+            cartoonFast.resetTemporalBuffer();
+            cartoonIncremental.resetTemporalBuffer();
+            cartoonReference.resetTemporalBuffer();
+
+            const cvcore::BenchResult *r = runCase(suite, bc, input, options.warmup);
+            if (r == nullptr) {
+                cerr << "Error: " << bc.name << " failed at " << sz.label << endl;
+                failed = true;
+                continue;
+            }
+            // Allocation columns are -1 without CVCORE_ALLOC_TRACKING
+            cout << left << setw(36) << bc.name << setw(7) << sz.label << right << setw(8) << r->iterations
+                 << fixed << setprecision(3) << setw(11) << r->p50Ms
+                 << setprecision(2) << setw(10) << r->extra.at("ns_per_pixel")
+                 << setprecision(1) << setw(11) << r->throughput / 1e6
+                 << setprecision(1) << setw(8) << r->heapAllocsPerCall
+                 << setw(7) << r->matAllocsPerCall << setw(7) << r->extra.at("pool_allocs_per_call") << endl;
+        }
+    }
+
+    if (!suite.finish()) {
+        return -1;
+    }
+    return failed ? -1 : 0;
+}
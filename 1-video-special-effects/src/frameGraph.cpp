@@ -0,0 +1,113 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Implementation of the lazily evaluated per-frame filter graph.
+*/
+
+#include "frameGraph.hpp"
+#include "filters.hpp"
+#include "faceDetect.h"
+#include "faceTracker.hpp"
+
+using namespace cv;
+using namespace std;
+
+FrameGraph::FrameGraph() : faceTracker_(nullptr), frameIndex_(0), valid_(0), evaluations_(0) {}
+
+void FrameGraph::beginFrame(Mat &frame, const Mat &depthMap) {
+    frame_ = frame;
+    // Drop the graph's view of the old grey first, so the context reuses
+    // its buffer instead of leaving it to us
+    grey_.release();
+    context_.reset(frame_);
+    depth_ = depthMap;
+    faces_.clear();
+    frameIndex_++;
+    valid_ = 0;
+    evaluations_ = 0;
+}
+
+void FrameGraph::markValid(FrameNode node) {
+    valid_ |= (1u << node);
+    evaluations_++;
+}
+
+Mat &FrameGraph::grey() {
+    if (!isValid(NODE_GREY)) {
+        grey_ = context_.gray();
+        markValid(NODE_GREY);
+    }
+    return grey_;
+}
+
+Mat &FrameGraph::blur() {
+    if (!isValid(NODE_BLUR)) {
+        if (blur5x5_simd(frame_, blur_) != 0) {
+            frame_.copyTo(blur_);
+        }
+        markValid(NODE_BLUR);
+    }
+    return blur_;
+}
+
+Mat &FrameGraph::sobelX() {
+    if (!isValid(NODE_SOBEL_X)) {
+        if (sobelX3x3(frame_, sobelX_) != 0) {
+            sobelX_ = Mat::zeros(frame_.size(), CV_16SC3);
+        }
+        markValid(NODE_SOBEL_X);
+    }
+    return sobelX_;
+}
+
+Mat &FrameGraph::sobelY() {
+    if (!isValid(NODE_SOBEL_Y)) {
+        if (sobelY3x3(frame_, sobelY_) != 0) {
+            sobelY_ = Mat::zeros(frame_.size(), CV_16SC3);
+        }
+        markValid(NODE_SOBEL_Y);
+    }
+    return sobelY_;
+}
+
+Mat &FrameGraph::magnitude() {
+    if (!isValid(NODE_MAGNITUDE)) {
+        // Reuse the separate gradients if another consumer already paid for
+        // them; otherwise the fused sweep is cheaper than computing both
+        int status;
+        if (isValid(NODE_SOBEL_X) && isValid(NODE_SOBEL_Y)) {
+            status = ::magnitude(sobelX_, sobelY_, magnitude_);
+        } else {
+            status = sobelMagnitude3x3(frame_, magnitude_);
+        }
+        if (status != 0) {
+            magnitude_ = Mat::zeros(frame_.size(), CV_8UC3);
+        }
+        markValid(NODE_MAGNITUDE);
+    }
+    return magnitude_;
+}
+
+Mat &FrameGraph::invertedDepth() {
+    if (!isValid(NODE_DEPTH_INVERTED)) {
+        if (hasDepth()) {
+            subtract(255, depth_, invertedDepth_);
+        } else {
+            invertedDepth_.release();
+        }
+        markValid(NODE_DEPTH_INVERTED);
+    }
+    return invertedDepth_;
+}
+
+vector<Rect> &FrameGraph::faces() {
+    if (!isValid(NODE_FACES)) {
+        if (faceTracker_ != nullptr) {
+            faceTracker_->update(grey(), faces_, frameIndex_);
+        } else {
+            detectFaces(grey(), faces_);
+        }
+        markValid(NODE_FACES);
+    }
+    return faces_;
+}
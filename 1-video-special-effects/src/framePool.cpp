@@ -0,0 +1,65 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the recycled frame buffer pool.
+*/
+
+#include "framePool.hpp"
+#include <algorithm>
+
+std::atomic<long> FramePool::totalAllocations_(0);
+
+FramePool::FramePool(int maxBuffers)
+    : maxBuffers_(std::max(1, maxBuffers)), allocations_(0) {
+    // Growing the index would itself allocate; reserve it once
+    buffers_.reserve(maxBuffers_);
+}
+
+bool FramePool::isFree(const cv::Mat &buffer) {
+    return buffer.u != nullptr && buffer.u->refcount == 1;
+}
+
+FrameLease FramePool::acquire(cv::Size size, int type) {
+    if (size.width <= 0 || size.height <= 0) {
+        return FrameLease();
+    }
+
+    for (const cv::Mat &buffer : buffers_) {
+        if (buffer.rows == size.height && buffer.cols == size.width &&
+            buffer.type() == type && isFree(buffer)) {
+            return FrameLease(buffer);
+        }
+    }
+
+    // Miss: make room by dropping the oldest free buffer when full
+    if (static_cast<int>(buffers_.size()) >= maxBuffers_) {
+        auto oldest = std::find_if(buffers_.begin(), buffers_.end(), isFree);
+        if (oldest == buffers_.end()) {
+            // Every buffer is leased: hand out an unpooled one
+            allocations_++;
+            totalAllocations_++;
+            return FrameLease(cv::Mat(size, type));
+        }
+        buffers_.erase(oldest);
+    }
+
+    allocations_++;
+    totalAllocations_++;
+    buffers_.push_back(cv::Mat(size, type));
+    return FrameLease(buffers_.back());
+}
+
+FrameLease FramePool::copyOf(const cv::Mat &src) {
+    FrameLease lease = acquireLike(src);
+    src.copyTo(lease.mat());
+    return lease;
+}
+
+void FramePool::trim() {
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), isFree), buffers_.end());
+}
+
+FramePool &FramePool::local() {
+    static thread_local FramePool pool;
+    return pool;
+}
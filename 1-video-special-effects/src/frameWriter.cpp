@@ -0,0 +1,228 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the asynchronous snapshot and recording writer.
+*/
+
+#include "frameWriter.hpp"
+#include <cstdio>
+#include <iostream>
+
+FrameWriter::FrameWriter(int capacity)
+    : capacity_(capacity > 0 ? capacity : 1) {
+    stats_.capacity = capacity_;
+    worker_ = std::thread(&FrameWriter::workerLoop, this);
+}
+
+FrameWriter::~FrameWriter() {
+    stopRecording();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool FrameWriter::saveImage(cv::Mat &frame, const std::string &path) {
+    return enqueueFrame(JOB_IMAGE, frame, path);
+}
+
+void FrameWriter::startRecording(const std::string &path, double fps, int fourcc) {
+    if (recording_) {
+        stopRecording();
+    }
+    Job job;
+    job.kind = JOB_OPEN;
+    job.path = path;
+    job.fps = fps > 0.0 ? fps : 30.0;
+    job.fourcc = fourcc;
+    enqueueControl(std::move(job));
+    recordStartTicks_ = cv::getTickCount();
+    recording_ = true;
+}
+
+void FrameWriter::stopRecording() {
+    if (!recording_) {
+        return;
+    }
+    recording_ = false;
+    Job job;
+    job.kind = JOB_CLOSE;
+    enqueueControl(std::move(job));
+}
+
+bool FrameWriter::record(cv::Mat &frame) {
+    if (!recording_) {
+        return false;
+    }
+    return enqueueFrame(JOB_VIDEO_FRAME, frame, std::string());
+}
+
+FrameWriterStats FrameWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FrameWriterStats s = stats_;
+    s.queued = queuedFrames_;
+    s.recording = recording_;
+    return s;
+}
+
+std::string FrameWriter::status() const {
+    FrameWriterStats s = stats();
+    char text[160];
+    if (s.recording) {
+        double seconds = (cv::getTickCount() - recordStartTicks_) / cv::getTickFrequency();
+        std::snprintf(text, sizeof(text), "REC %.1f s, %ld frames (%s), queue %d/%d, %ld dropped",
+                      seconds, s.recorded, s.hwEncode ? "HW" : "SW",
+                      s.queued, s.capacity, s.dropped);
+    } else {
+        std::snprintf(text, sizeof(text), "queue %d/%d (peak %d), %ld dropped, %ld failed",
+                      s.queued, s.capacity, s.peakQueued, s.dropped, s.failed);
+    }
+    return text;
+}
+
+bool FrameWriter::enqueueFrame(JobKind kind, cv::Mat &frame, const std::string &path) {
+    if (frame.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queuedFrames_ >= capacity_) {
+        // Back-pressure: the caller never waits for the encoder
+        stats_.dropped++;
+        return false;
+    }
+
+    Job job;
+    job.kind = kind;
+    job.path = path;
+    cv::Mat spare;
+    if (!spare_.empty()) {
+        spare = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    job.image = std::move(frame);
+    frame = std::move(spare);
+    queue_.push_back(std::move(job));
+
+    queuedFrames_++;
+    if (queuedFrames_ > stats_.peakQueued) {
+        stats_.peakQueued = queuedFrames_;
+    }
+    cond_.notify_one();
+    return true;
+}
+
+void FrameWriter::enqueueControl(Job job) {
+    // Control jobs are never dropped and do not count against the capacity
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(job));
+    cond_.notify_one();
+}
+
+void FrameWriter::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                break;  // Stopped and drained
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            if (job.kind == JOB_IMAGE || job.kind == JOB_VIDEO_FRAME) {
+                queuedFrames_--;
+            }
+        }
+
+        cv::int64 start = cv::getTickCount();
+        bool ok = true;
+        switch (job.kind) {
+        case JOB_IMAGE:
+            ok = cv::imwrite(job.path, job.image);
+            if (ok) {
+                std::cout << "Saved: " << job.path << std::endl;
+            } else {
+                std::cerr << "Error: Could not write " << job.path << std::endl;
+            }
+            break;
+        case JOB_VIDEO_FRAME:
+            writeVideoFrame(job.image);
+            break;
+        case JOB_OPEN:
+            video_.release();
+            videoPath_ = job.path;
+            videoFps_ = job.fps;
+            videoFourcc_ = job.fourcc;
+            videoPending_ = true;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.recorded = 0;
+                stats_.hwEncode = false;
+            }
+            break;
+        case JOB_CLOSE:
+            if (video_.isOpened()) {
+                video_.release();
+                std::cout << "Recording saved: " << videoPath_ << std::endl;
+            }
+            videoPending_ = false;
+            break;
+        }
+        double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (job.kind == JOB_IMAGE || job.kind == JOB_VIDEO_FRAME) {
+            stats_.lastEncodeMs = ms;
+            if (job.kind == JOB_IMAGE) {
+                ok ? stats_.snapshots++ : stats_.failed++;
+            }
+            // The buffer goes back to the caller through the next hand-off
+            if (static_cast<int>(spare_.size()) < capacity_) {
+                spare_.push_back(std::move(job.image));
+            }
+        }
+    }
+
+    video_.release();
+}
+
+void FrameWriter::writeVideoFrame(const cv::Mat &image) {
+    if (videoPending_) {
+        videoPending_ = false;
+        videoSize_ = image.size();
+        // Hardware encoder where the FFmpeg build has one, software otherwise
+        std::vector<int> params = {cv::VIDEOWRITER_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_ANY};
+        if (!video_.open(videoPath_, cv::CAP_FFMPEG, videoFourcc_, videoFps_, videoSize_, params) &&
+            !video_.open(videoPath_, videoFourcc_, videoFps_, videoSize_, true)) {
+            std::cerr << "Error: Could not open recording " << videoPath_ << std::endl;
+        } else {
+            const bool hw = video_.get(cv::VIDEOWRITER_PROP_HW_ACCELERATION) > 0;
+            std::cout << "Recording: " << videoPath_ << " (" << image.cols << " x " << image.rows
+                      << ", " << videoFps_ << " fps, " << (hw ? "hardware" : "software")
+                      << " encoder)" << std::endl;
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.hwEncode = hw;
+        }
+    }
+
+    bool ok = false;
+    if (video_.isOpened()) {
+        // Greyscale modes are expanded to BGR; frames of another size are skipped
+        ok = image.size() == videoSize_ && image.depth() == CV_8U;
+        if (ok && image.channels() == 1) {
+            cv::cvtColor(image, converted_, cv::COLOR_GRAY2BGR);
+            video_.write(converted_);
+        } else if (ok && image.channels() == 3) {
+            video_.write(image);
+        } else {
+            ok = false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ok ? stats_.recorded++ : stats_.failed++;
+}
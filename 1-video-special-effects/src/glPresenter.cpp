@@ -0,0 +1,343 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 27, 2026
+  Purpose: Implementation of the OpenGL presenter (PBO texture streaming,
+           framebuffer blit, GLFW keyboard callbacks).
+*/
+
+#include "glPresenter.hpp"
+#include <GLFW/glfw3.h>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+// The system GL header only declares OpenGL 1.1; the few later entry points
+// the presenter needs are loaded through GLFW
+#if defined(_WIN32)
+#define GLP_APIENTRY __stdcall
+#else
+#define GLP_APIENTRY
+#endif
+
+#ifndef GL_BGR
+#define GL_BGR 0x80E0
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+
+struct GLPresenter::GLFunctions {
+    typedef void (GLP_APIENTRY *GenBuffersFn)(GLsizei, GLuint *);
+    typedef void (GLP_APIENTRY *DeleteBuffersFn)(GLsizei, const GLuint *);
+    typedef void (GLP_APIENTRY *BindBufferFn)(GLenum, GLuint);
+    typedef void (GLP_APIENTRY *BufferDataFn)(GLenum, std::ptrdiff_t, const void *, GLenum);
+    typedef void *(GLP_APIENTRY *MapBufferRangeFn)(GLenum, std::ptrdiff_t, std::ptrdiff_t, GLbitfield);
+    typedef GLboolean (GLP_APIENTRY *UnmapBufferFn)(GLenum);
+    typedef void (GLP_APIENTRY *GenFramebuffersFn)(GLsizei, GLuint *);
+    typedef void (GLP_APIENTRY *DeleteFramebuffersFn)(GLsizei, const GLuint *);
+    typedef void (GLP_APIENTRY *BindFramebufferFn)(GLenum, GLuint);
+    typedef void (GLP_APIENTRY *FramebufferTexture2DFn)(GLenum, GLenum, GLenum, GLuint, GLint);
+    typedef GLenum (GLP_APIENTRY *CheckFramebufferStatusFn)(GLenum);
+    typedef void (GLP_APIENTRY *BlitFramebufferFn)(GLint, GLint, GLint, GLint, GLint, GLint,
+                                                   GLint, GLint, GLbitfield, GLenum);
+
+    GenBuffersFn genBuffers = nullptr;
+    DeleteBuffersFn deleteBuffers = nullptr;
+    BindBufferFn bindBuffer = nullptr;
+    BufferDataFn bufferData = nullptr;
+    MapBufferRangeFn mapBufferRange = nullptr;
+    UnmapBufferFn unmapBuffer = nullptr;
+    GenFramebuffersFn genFramebuffers = nullptr;
+    DeleteFramebuffersFn deleteFramebuffers = nullptr;
+    BindFramebufferFn bindFramebuffer = nullptr;
+    FramebufferTexture2DFn framebufferTexture2D = nullptr;
+    CheckFramebufferStatusFn checkFramebufferStatus = nullptr;
+    BlitFramebufferFn blitFramebuffer = nullptr;
+
+    // Needs the context to be current; false if an entry point is missing
+    bool load() {
+        genBuffers = reinterpret_cast<GenBuffersFn>(glfwGetProcAddress("glGenBuffers"));
+        deleteBuffers = reinterpret_cast<DeleteBuffersFn>(glfwGetProcAddress("glDeleteBuffers"));
+        bindBuffer = reinterpret_cast<BindBufferFn>(glfwGetProcAddress("glBindBuffer"));
+        bufferData = reinterpret_cast<BufferDataFn>(glfwGetProcAddress("glBufferData"));
+        mapBufferRange = reinterpret_cast<MapBufferRangeFn>(glfwGetProcAddress("glMapBufferRange"));
+        unmapBuffer = reinterpret_cast<UnmapBufferFn>(glfwGetProcAddress("glUnmapBuffer"));
+        genFramebuffers = reinterpret_cast<GenFramebuffersFn>(glfwGetProcAddress("glGenFramebuffers"));
+        deleteFramebuffers = reinterpret_cast<DeleteFramebuffersFn>(
+            glfwGetProcAddress("glDeleteFramebuffers"));
+        bindFramebuffer = reinterpret_cast<BindFramebufferFn>(glfwGetProcAddress("glBindFramebuffer"));
+        framebufferTexture2D = reinterpret_cast<FramebufferTexture2DFn>(
+            glfwGetProcAddress("glFramebufferTexture2D"));
+        checkFramebufferStatus = reinterpret_cast<CheckFramebufferStatusFn>(
+            glfwGetProcAddress("glCheckFramebufferStatus"));
+        blitFramebuffer = reinterpret_cast<BlitFramebufferFn>(glfwGetProcAddress("glBlitFramebuffer"));
+
+        return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBufferRange &&
+               unmapBuffer && genFramebuffers && deleteFramebuffers && bindFramebuffer &&
+               framebufferTexture2D && checkFramebufferStatus && blitFramebuffer;
+    }
+};
+
+GLPresenter::GLPresenter()
+    : window_(nullptr),
+      vsync_(true),
+      texture_(0),
+      framebuffer_(0),
+      nextPbo_(0) {
+    pbo_[0] = pbo_[1] = 0;
+}
+
+GLPresenter::~GLPresenter() {
+    close();
+}
+
+bool GLPresenter::open(const std::string &title, cv::Size size, bool vsync) {
+    close();
+
+    if (!glfwInit()) {
+        std::cerr << "Error: GLFW initialisation failed" << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+#endif
+
+    window_ = glfwCreateWindow(std::max(1, size.width), std::max(1, size.height),
+                               title.c_str(), nullptr, nullptr);
+    if (!window_) {
+        std::cerr << "Error: Could not create an OpenGL 3.3 window" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window_);
+
+    gl_.reset(new GLFunctions);
+    if (!gl_->load()) {
+        std::cerr << "Error: OpenGL driver lacks buffer / framebuffer objects" << std::endl;
+        close();
+        return false;
+    }
+
+    glfwSetWindowUserPointer(window_, this);
+    glfwSetKeyCallback(window_, keyCallback);
+    glfwSetCharCallback(window_, charCallback);
+    setVsync(vsync);
+    return true;
+}
+
+void GLPresenter::close() {
+    if (!window_) {
+        return;
+    }
+    glfwMakeContextCurrent(window_);
+    releaseBuffers();
+    glfwDestroyWindow(window_);
+    glfwTerminate();
+    window_ = nullptr;
+    gl_.reset();
+    keys_.clear();
+}
+
+bool GLPresenter::isOpen() const {
+    return window_ && !glfwWindowShouldClose(window_);
+}
+
+void GLPresenter::setTitle(const std::string &title) {
+    if (window_) {
+        glfwSetWindowTitle(window_, title.c_str());
+    }
+}
+
+void GLPresenter::setVsync(bool vsync) {
+    vsync_ = vsync;
+    if (window_) {
+        glfwSwapInterval(vsync ? 1 : 0);
+    }
+}
+
+void GLPresenter::releaseBuffers() {
+    if (!gl_) {
+        return;
+    }
+    if (pbo_[0] != 0) {
+        gl_->deleteBuffers(2, pbo_);
+        pbo_[0] = pbo_[1] = 0;
+    }
+    if (framebuffer_ != 0) {
+        gl_->deleteFramebuffers(1, &framebuffer_);
+        framebuffer_ = 0;
+    }
+    if (texture_ != 0) {
+        glDeleteTextures(1, &texture_);
+        texture_ = 0;
+    }
+    textureSize_ = cv::Size();
+}
+
+bool GLPresenter::allocate(cv::Size size) {
+    releaseBuffers();
+
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, size.width, size.height, 0,
+                 GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+
+    // The texture is the colour buffer of a read framebuffer, so presenting
+    // is a single blit (no shaders or vertex state)
+    gl_->genFramebuffers(1, &framebuffer_);
+    gl_->bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    gl_->framebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                              texture_, 0);
+    if (gl_->checkFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Error: Frame texture is not a complete framebuffer" << std::endl;
+        releaseBuffers();
+        return false;
+    }
+
+    const std::ptrdiff_t bytes = static_cast<std::ptrdiff_t>(size.area()) * 3;
+    gl_->genBuffers(2, pbo_);
+    for (GLuint pbo : pbo_) {
+        gl_->bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        gl_->bufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    }
+    gl_->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    textureSize_ = size;
+    nextPbo_ = 0;
+    return true;
+}
+
+void GLPresenter::present(const cv::Mat &frame) {
+    CV_Assert(frame.depth() == CV_8U &&
+              (frame.channels() == 1 || frame.channels() == 3 || frame.channels() == 4));
+    if (!window_ || frame.empty()) {
+        return;
+    }
+    if (frame.size() != textureSize_ && !allocate(frame.size())) {
+        return;
+    }
+
+    // Alternate buffers: the driver may still be uploading from the other
+    // one. Orphaning before mapping never waits for that upload either
+    const std::ptrdiff_t bytes = static_cast<std::ptrdiff_t>(frame.total()) * 3;
+    gl_->bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_[nextPbo_]);
+    gl_->bufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void *mapped = gl_->mapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        // Same size and type: copyTo and cvtColor write into the mapping
+        cv::Mat staging(frame.size(), CV_8UC3, mapped);
+        if (frame.channels() == 3) {
+            frame.copyTo(staging);
+        } else {
+            cv::cvtColor(frame, staging,
+                         frame.channels() == 4 ? cv::COLOR_BGRA2BGR : cv::COLOR_GRAY2BGR);
+        }
+        gl_->unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // Sourced from the bound buffer: returns without waiting for the copy
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame.cols, frame.rows,
+                        GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    }
+    gl_->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    nextPbo_ ^= 1;
+
+    // Letterbox into the window, keeping the aspect ratio
+    int windowW = 0, windowH = 0;
+    glfwGetFramebufferSize(window_, &windowW, &windowH);
+    double scale = std::min(static_cast<double>(windowW) / frame.cols,
+                            static_cast<double>(windowH) / frame.rows);
+    int drawW = static_cast<int>(frame.cols * scale);
+    int drawH = static_cast<int>(frame.rows * scale);
+    int x0 = (windowW - drawW) / 2;
+    int y0 = (windowH - drawH) / 2;
+
+    gl_->bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowW, windowH);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Row 0 of the frame is the bottom row of the texture: flip while blitting
+    gl_->bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    gl_->blitFramebuffer(0, 0, frame.cols, frame.rows,
+                         x0, y0 + drawH, x0 + drawW, y0,
+                         GL_COLOR_BUFFER_BIT,
+                         (drawW == frame.cols && drawH == frame.rows) ? GL_NEAREST : GL_LINEAR);
+
+    glfwSwapBuffers(window_);
+}
+
+int GLPresenter::pollKey(int timeoutMs) {
+    if (!window_) {
+        return -1;
+    }
+    glfwPollEvents();
+    if (keys_.empty() && timeoutMs > 0) {
+        glfwWaitEventsTimeout(timeoutMs / 1000.0);
+    }
+    if (keys_.empty()) {
+        return -1;
+    }
+    int key = keys_.front();
+    keys_.pop_front();
+    return key;
+}
+
+void GLPresenter::keyCallback(GLFWwindow *window, int key, int, int action, int) {
+    if (action == GLFW_RELEASE) {
+        return;
+    }
+    GLPresenter *presenter = static_cast<GLPresenter *>(glfwGetWindowUserPointer(window));
+
+    // Printable keys come through charCallback (with layout and shift applied)
+    switch (key) {
+        case GLFW_KEY_ESCAPE:    presenter->keys_.push_back(27); break;
+        case GLFW_KEY_ENTER:
+        case GLFW_KEY_KP_ENTER:  presenter->keys_.push_back(13); break;
+        case GLFW_KEY_BACKSPACE: presenter->keys_.push_back(8); break;
+        case GLFW_KEY_TAB:       presenter->keys_.push_back(9); break;
+        default: break;
+    }
+}
+
+void GLPresenter::charCallback(GLFWwindow *window, unsigned int codepoint) {
+    // The apps only bind ASCII keys
+    if (codepoint < 128) {
+        GLPresenter *presenter = static_cast<GLPresenter *>(glfwGetWindowUserPointer(window));
+        presenter->keys_.push_back(static_cast<int>(codepoint));
+    }
+}
@@ -3,12 +3,16 @@
   Date: January 24, 2026
   Purpose: Read and display an image from a file using OpenCV.
            Task 1: Basic image display with keyboard controls.
+           With --tiled, very large images are viewed through a memory-mapped
+           tile pyramid: filters run only on the tiles on screen.
 */
 
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <string>
 #include <ctime>
+#include <algorithm>
+#include "tilePyramid.hpp"
 
 using namespace cv;
 using namespace std;
@@ -149,12 +153,239 @@ void adjustBrightness(const Mat& src, Mat& dst, float brightness) {
     }
 }
 
+/*
+  Function: printTiledControls
+  Purpose: Display the keyboard controls of the tiled viewer
+  Arguments: none
+  Return value: none
+*/
+void printTiledControls() {
+    cout << "\n=== Tiled Viewer Controls ===" << endl;
+    cout << "  q/ESC : Quit application" << endl;
+    cout << "  s     : Save the current view" << endl;
+    cout << "  i     : Display pyramid and tile cache information" << endl;
+    cout << "  r     : Reset filters" << endl;
+    cout << "  g     : Toggle greyscale" << endl;
+    cout << "  h     : Show this help" << endl;
+    cout << "  +/=   : Increase brightness" << endl;
+    cout << "  -/_   : Decrease brightness" << endl;
+    cout << "  w/a/x/d : Pan up / left / down / right" << endl;
+    cout << "  ]/[   : Zoom in / out (one pyramid level)" << endl;
+    cout << "=============================\n" << endl;
+}
+
+// Viewport size of the tiled viewer and how many processed tiles it keeps
+static const int TILED_VIEW_WIDTH = 1280;
+static const int TILED_VIEW_HEIGHT = 800;
+static const size_t TILED_CACHE_TILES = 256;
+
+/*
+  Function: renderTiledView
+  Purpose: Compose the viewport from processed tiles of one pyramid level
+  Arguments:
+    pyramid - tile pyramid of the image
+    cache - LRU of processed tiles
+    level - pyramid level shown 1:1
+    center - view centre in level-0 pixels
+    version - filter version (changes whenever the filter settings change)
+    filter - per-tile filter, applied only to tiles missing from the cache
+    view - output viewport (CV_8UC3)
+  Return value: none
+*/
+void renderTiledView(const TilePyramid& pyramid, TileCache& cache, int level,
+                     Point2d center, uint32_t version, const TileCache::TileFilter& filter,
+                     Mat& view) {
+    view.create(TILED_VIEW_HEIGHT, TILED_VIEW_WIDTH, CV_8UC3);
+    view.setTo(Scalar::all(0));
+    
+    // Top-left of the view in level pixels; a level smaller than the view
+    // is centred
+    const Size size = pyramid.levelSize(level);
+    const double scale = 1.0 / (1 << level);
+    int x0 = cvRound(center.x * scale) - TILED_VIEW_WIDTH / 2;
+    int y0 = cvRound(center.y * scale) - TILED_VIEW_HEIGHT / 2;
+    x0 = (size.width <= TILED_VIEW_WIDTH) ? (size.width - TILED_VIEW_WIDTH) / 2
+                                          : std::max(0, std::min(x0, size.width - TILED_VIEW_WIDTH));
+    y0 = (size.height <= TILED_VIEW_HEIGHT) ? (size.height - TILED_VIEW_HEIGHT) / 2
+                                            : std::max(0, std::min(y0, size.height - TILED_VIEW_HEIGHT));
+    
+    // Only the tiles that intersect the view are fetched and filtered
+    const int t = pyramid.tileSize();
+    const Size grid = pyramid.tileGrid(level);
+    const Rect viewRect(0, 0, TILED_VIEW_WIDTH, TILED_VIEW_HEIGHT);
+    const int txEnd = std::min(grid.width - 1, (x0 + TILED_VIEW_WIDTH - 1) / t);
+    const int tyEnd = std::min(grid.height - 1, (y0 + TILED_VIEW_HEIGHT - 1) / t);
+    for (int ty = std::max(0, y0 / t); ty <= tyEnd; ty++) {
+        for (int tx = std::max(0, x0 / t); tx <= txEnd; tx++) {
+            const Mat& tile = cache.get(pyramid, level, tx, ty, version, filter);
+            const Rect tileRect(tx * t - x0, ty * t - y0, tile.cols, tile.rows);
+            const Rect visible = tileRect & viewRect;
+            if (visible.area() > 0) {
+                tile(visible - tileRect.tl()).copyTo(view(visible));
+            }
+        }
+    }
+}
+
+/*
+  Function: runTiledViewer
+  Purpose: View a very large image through a memory-mapped tile pyramid.
+           The image is decoded once into the tile cache; afterwards every
+           keypress filters only the visible tiles that are not cached yet.
+  Arguments:
+    imagePath - image to view
+  Return value: 0 on success, -1 on error
+*/
+int runTiledViewer(const string& imagePath) {
+    TilePyramid pyramid;
+    if (pyramid.open(imagePath) != 0) {
+        cout << "Error: Could not build the tile cache for: " << imagePath << endl;
+        return -1;
+    }
+    
+    const Size fullSize = pyramid.levelSize(0);
+    cout << "Image: " << fullSize.width << " x " << fullSize.height << " pixels, "
+         << pyramid.levels() << " pyramid levels, " << (pyramid.cacheBytes() / (1024.0 * 1024.0))
+         << " MB of tiles" << endl;
+    printTiledControls();
+    
+    // Start at the coarsest level that still fills the view
+    int level = pyramid.levels() - 1;
+    while (level > 0 && pyramid.levelSize(level - 1).width <= TILED_VIEW_WIDTH &&
+           pyramid.levelSize(level - 1).height <= TILED_VIEW_HEIGHT) {
+        level--;
+    }
+    Point2d center(fullSize.width / 2.0, fullSize.height / 2.0);
+    
+    // Filter state; version changes make every cached tile stale
+    float brightnessLevel = 0.0f;
+    bool grey = false;
+    uint32_t version = 0;
+    TileCache cache(TILED_CACHE_TILES);
+    TileCache::TileFilter tileFilter = [&](const Mat& src, Mat& dst) {
+        if (grey) {
+            Mat g;
+            cvtColor(src, g, COLOR_BGR2GRAY);
+            cvtColor(g, dst, COLOR_GRAY2BGR);
+        } else {
+            src.copyTo(dst);
+        }
+        if (brightnessLevel != 0.0f) {
+            adjustBrightness(dst, dst, brightnessLevel);
+        }
+    };
+    
+    string windowName = "Tiled Image Display - " + imagePath;
+    namedWindow(windowName, WINDOW_AUTOSIZE);
+    Mat view;
+    int savedCount = 0;
+    bool redraw = true;
+    
+    while (true) {
+        if (redraw) {
+            int64 start = getTickCount();
+            long missesBefore = cache.misses();
+            renderTiledView(pyramid, cache, level, center, version, tileFilter, view);
+            double ms = (getTickCount() - start) * 1000.0 / getTickFrequency();
+            imshow(windowName, view);
+            setWindowTitle(windowName, windowName + " - level " + to_string(level) + ", " +
+                           to_string(cache.misses() - missesBefore) + " tiles filtered, " +
+                           to_string(cvRound(ms)) + " ms");
+            redraw = false;
+        }
+        
+        int key = waitKey(1);
+        if (key == -1) {
+            continue;
+        }
+        
+        // Pan by half a view, in level-0 pixels
+        const double step = 0.5 * (1 << level);
+        if (key == 'q' || key == 'Q' || key == 27) {
+            cout << "\nQuitting tiled viewer..." << endl;
+            cout << "Total views saved: " << savedCount << endl;
+            break;
+        }
+        else if (key == 's' || key == 'S') {
+            string filename = generateTimestampFilename("saved_view", ".jpg");
+            if (imwrite(filename, view)) {
+                savedCount++;
+                cout << "View saved as: " << filename << endl;
+            } else {
+                cout << "Error: Failed to save view" << endl;
+            }
+        }
+        else if (key == 'i' || key == 'I') {
+            cout << "\n=== Tiled View Information ===" << endl;
+            cout << "Image: " << fullSize.width << " x " << fullSize.height << " pixels" << endl;
+            cout << "Level: " << level << " of " << pyramid.levels() - 1 << " ("
+                 << pyramid.levelSize(level).width << " x " << pyramid.levelSize(level).height << ")" << endl;
+            cout << "Centre: " << cvRound(center.x) << ", " << cvRound(center.y) << endl;
+            cout << "Tile cache: " << cache.size() << "/" << cache.capacity() << " tiles, "
+                 << cache.hits() << " hits, " << cache.misses() << " misses" << endl;
+            cout << "==============================\n" << endl;
+        }
+        else if (key == 'h' || key == 'H') {
+            printTiledControls();
+        }
+        else if (key == 'r' || key == 'R') {
+            brightnessLevel = 0.0f;
+            grey = false;
+            version++;
+            redraw = true;
+            cout << "Filters reset" << endl;
+        }
+        else if (key == 'g' || key == 'G') {
+            grey = !grey;
+            version++;
+            redraw = true;
+            cout << "Greyscale: " << (grey ? "on" : "off") << endl;
+        }
+        else if (key == '+' || key == '=' || key == '-' || key == '_') {
+            const float delta = (key == '+' || key == '=') ? 0.1f : -0.1f;
+            brightnessLevel = std::max(-1.0f, std::min(1.0f, brightnessLevel + delta));
+            version++;
+            redraw = true;
+            cout << "Brightness: " << (brightnessLevel >= 0 ? "+" : "")
+                 << static_cast<int>(brightnessLevel * 100.0f) << "%" << endl;
+        }
+        else if (key == 'w' || key == 'W') {
+            center.y = std::max(0.0, center.y - step * TILED_VIEW_HEIGHT);
+            redraw = true;
+        }
+        else if (key == 'x' || key == 'X') {
+            center.y = std::min(static_cast<double>(fullSize.height), center.y + step * TILED_VIEW_HEIGHT);
+            redraw = true;
+        }
+        else if (key == 'a' || key == 'A') {
+            center.x = std::max(0.0, center.x - step * TILED_VIEW_WIDTH);
+            redraw = true;
+        }
+        else if (key == 'd' || key == 'D') {
+            center.x = std::min(static_cast<double>(fullSize.width), center.x + step * TILED_VIEW_WIDTH);
+            redraw = true;
+        }
+        else if (key == ']' && level > 0) {
+            level--;
+            redraw = true;
+        }
+        else if (key == '[' && level < pyramid.levels() - 1) {
+            level++;
+            redraw = true;
+        }
+    }
+    
+    destroyAllWindows();
+    return 0;
+}
+
 /*
   Function: main
   Purpose: Read an image file, display it in a window, and handle user keypresses
   Arguments:
     argc - number of command line arguments
-    argv - array of command line argument strings (expects image path as argv[1])
+    argv - array of command line argument strings (expects image path as
+           argv[1], optional --tiled as argv[2])
   Return value: 0 on success, -1 on error
 */
 int main(int argc, char** argv) {
@@ -162,9 +393,10 @@ int main(int argc, char** argv) {
     cout << "Task 1: Read and display image from file\n" << endl;
     
     // Check if image path was provided as command line argument
-    if (argc != 2) {
-        cout << "Usage: " << argv[0] << " <image_path>" << endl;
+    if (argc < 2 || argc > 3 || (argc == 3 && string(argv[2]) != "--tiled")) {
+        cout << "Usage: " << argv[0] << " <image_path> [--tiled]" << endl;
         cout << "Example: " << argv[0] << " image.jpg" << endl;
+        cout << "         " << argv[0] << " inspection.tif --tiled   (very large images)" << endl;
         cout << "\nPress Enter to exit...";
         cin.get();
         return -1;
@@ -173,6 +405,11 @@ int main(int argc, char** argv) {
     // Get the image path from command line arguments
     string imagePath = argv[1];
     
+    // Large images: decode once into a tile cache and view it lazily
+    if (argc == 3) {
+        return runTiledViewer(imagePath);
+    }
+    
     // Read the image from file
     // IMREAD_COLOR ensures we get a color image (BGR format)
     Mat originalImage = imread(imagePath, IMREAD_COLOR);
@@ -0,0 +1,221 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of multi-camera capture workers and the tile
+           compositor.
+*/
+
+#include "multiCamera.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+/*
+  Class: RateMeter
+  Purpose: Events per second over one-second windows. Owned by a single
+           thread; the rate is published through an atomic.
+*/
+class RateMeter {
+public:
+    explicit RateMeter(atomic<double> &rate) : rate_(rate), start_(getTickCount()), count_(0) {}
+
+    void tick() {
+        count_++;
+        double seconds = (getTickCount() - start_) / getTickFrequency();
+        if (seconds >= 1.0) {
+            rate_.store(count_ / seconds);
+            start_ = getTickCount();
+            count_ = 0;
+        }
+    }
+
+private:
+    atomic<double> &rate_;
+    int64 start_;
+    long count_;
+};
+
+CameraWorker::CameraWorker(int slot, int cameraIndex)
+    : slot_(slot), cameraIndex_(cameraIndex), tracker_(5) {
+    graph_.setFaceTracker(&tracker_);
+}
+
+CameraWorker::~CameraWorker() {
+    stop();
+}
+
+int CameraWorker::open() {
+    capture_ = cvcore::FrameSource::open("", cameraIndex_);
+    if (!capture_) {
+        cerr << "Error: Unable to open camera " << cameraIndex_ << endl;
+        return -1;
+    }
+    frameSize_ = capture_->frameSize();
+    return 0;
+}
+
+void CameraWorker::start(const CameraFilter &filter, const CameraDepthSource &depth) {
+    filter_ = filter;
+    depth_ = depth;
+    stop_ = false;
+    captureThread_ = thread(&CameraWorker::captureLoop, this);
+    filterThread_ = thread(&CameraWorker::filterLoop, this);
+}
+
+void CameraWorker::stop() {
+    {
+        // Under the lock so the filter thread cannot miss the wake-up
+        lock_guard<mutex> lock(inputMutex_);
+        stop_ = true;
+    }
+    inputCond_.notify_all();
+    if (captureThread_.joinable()) {
+        captureThread_.join();
+    }
+    if (filterThread_.joinable()) {
+        filterThread_.join();
+    }
+}
+
+void CameraWorker::captureLoop() {
+    RateMeter meter(captureFps_);
+    while (!stop_) {
+        if (!capture_->read(grabbed_)) {
+            cerr << "Error: Camera " << cameraIndex_ << " stopped delivering frames" << endl;
+            break;
+        }
+        captured_++;
+        meter.tick();
+
+        {
+            lock_guard<mutex> lock(inputMutex_);
+            if (hasInput_) {
+                // The filter is behind: newest frame wins
+                captureDrops_++;
+            }
+            cv::swap(grabbed_, pending_);
+            hasInput_ = true;
+        }
+        inputCond_.notify_one();
+    }
+}
+
+void CameraWorker::filterLoop() {
+    RateMeter meter(processFps_);
+    shared_ptr<const Mat> depth;  // Keeps the current depth buffer alive
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(inputMutex_);
+            inputCond_.wait(lock, [this] { return hasInput_ || stop_; });
+            if (stop_) {
+                break;
+            }
+            cv::swap(pending_, work_);
+            hasInput_ = false;
+        }
+
+        depth = depth_ ? depth_(slot_, work_) : nullptr;
+        graph_.beginFrame(work_, depth ? *depth : Mat());
+        if (!filter_ || filter_(slot_, graph_, rendered_) != 0) {
+            work_.copyTo(rendered_);
+        }
+        processed_++;
+        meter.tick();
+
+        {
+            lock_guard<mutex> lock(outputMutex_);
+            if (hasOutput_) {
+                // The compositor is behind: newest frame wins
+                displayDrops_++;
+            }
+            cv::swap(rendered_, output_);
+            hasOutput_ = true;
+        }
+    }
+}
+
+bool CameraWorker::takeOutput(Mat &out) {
+    lock_guard<mutex> lock(outputMutex_);
+    if (!hasOutput_) {
+        return false;
+    }
+    // The caller's previous frame becomes the filter's next output buffer
+    cv::swap(output_, out);
+    hasOutput_ = false;
+    return true;
+}
+
+CameraStats CameraWorker::stats() const {
+    CameraStats s;
+    s.cameraIndex = cameraIndex_;
+    s.captureFps = captureFps_.load();
+    s.processFps = processFps_.load();
+    s.captured = captured_.load();
+    s.processed = processed_.load();
+    s.captureDrops = captureDrops_.load();
+    s.displayDrops = displayDrops_.load();
+    return s;
+}
+
+int composeTiles(const vector<Mat> &tiles, const vector<CameraStats> &stats,
+                 const Size &tileSize, Mat &canvas) {
+    if (tiles.empty() || tiles.size() != stats.size() || tileSize.area() <= 0) {
+        cerr << "Error: composeTiles needs one stats entry per tile" << endl;
+        return -1;
+    }
+
+    int n = (int)tiles.size();
+    int cols = (int)std::ceil(std::sqrt((double)n));
+    int rows = (n + cols - 1) / cols;
+    canvas.create(tileSize.height * rows, tileSize.width * cols, CV_8UC3);
+    canvas.setTo(Scalar::all(0));
+
+    for (int i = 0; i < n; i++) {
+        Rect cell((i % cols) * tileSize.width, (i / cols) * tileSize.height,
+                  tileSize.width, tileSize.height);
+        Mat dst = canvas(cell);
+
+        if (!tiles[i].empty()) {
+            if (tiles[i].channels() == 1) {
+                Mat small;
+                resize(tiles[i], small, tileSize, 0, 0, INTER_AREA);
+                cvtColor(small, dst, COLOR_GRAY2BGR);
+            } else {
+                resize(tiles[i], dst, tileSize, 0, 0, INTER_AREA);
+            }
+        }
+
+        const CameraStats &s = stats[i];
+        char line1[96], line2[96];
+        snprintf(line1, sizeof(line1), "cam %d  capture %.1f fps  filter %.1f fps",
+                 s.cameraIndex, s.captureFps, s.processFps);
+        snprintf(line2, sizeof(line2), "drops: capture %ld  display %ld",
+                 s.captureDrops, s.displayDrops);
+        rectangle(dst, Rect(0, 0, tileSize.width, 44), Scalar(0, 0, 0), FILLED);
+        putText(dst, line1, Point(6, 18), FONT_HERSHEY_SIMPLEX, 0.45, Scalar(0, 255, 0), 1, LINE_AA);
+        putText(dst, line2, Point(6, 36), FONT_HERSHEY_SIMPLEX, 0.45, Scalar(0, 255, 255), 1, LINE_AA);
+    }
+    return 0;
+}
+
+int parseCameraList(const string &list, vector<int> &cameras) {
+    cameras.clear();
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) end = list.size();
+        string entry = list.substr(start, end - start);
+        start = end + 1;
+
+        if (entry.empty() || entry.find_first_not_of("0123456789") != string::npos) {
+            return -1;
+        }
+        cameras.push_back(atoi(entry.c_str()));
+    }
+    return cameras.empty() ? -1 : 0;
+}
@@ -0,0 +1,205 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Implementation of the per-stage latency profiler (ring buffers,
+           percentile statistics, overlay drawing and trace dumps).
+*/
+
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+Profiler::Profiler() : epoch_(chrono::steady_clock::now()), stageCount_(0) {
+    for (StageRing& ring : rings_) {
+        ring.head.store(0, memory_order_relaxed);
+        ring.threadId = 0;
+        ring.metric = nullptr;
+        ring.allocs = nullptr;
+    }
+}
+
+int Profiler::stage(const string& name, int threadId) {
+    lock_guard<mutex> lock(registerMutex_);
+
+    int count = stageCount_.load(memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (rings_[i].name == name) {
+            return i;
+        }
+    }
+    if (count >= PROFILER_MAX_STAGES) {
+        cerr << "Error: Profiler stage limit reached, ignoring " << name << endl;
+        return -1;
+    }
+
+    rings_[count].name = name;
+    rings_[count].threadId = threadId;
+    rings_[count].metric = &cvcore::MetricsRegistry::global().histogram(
+        "vfx_stage_seconds", "vidDisplay pipeline stage latency", "stage=\"" + name + "\"");
+    rings_[count].allocs = &cvcore::AllocStage::get(name);
+    // Publish the name before readers can see the new stage
+    stageCount_.store(count + 1, memory_order_release);
+    return count;
+}
+
+void Profiler::record(int stageId, double startUs, double durationMs) {
+    if (stageId < 0 || stageId >= PROFILER_MAX_STAGES) {
+        return;
+    }
+    StageRing& ring = rings_[stageId];
+    uint64_t head = ring.head.load(memory_order_relaxed);
+    ring.samples[head % PROFILER_RING_SIZE] = {startUs, (float)durationMs};
+    ring.head.store(head + 1, memory_order_release);
+    ring.metric->observeMs(durationMs);
+}
+
+cvcore::AllocStage& Profiler::allocStage(int stageId) {
+    if (stageId < 0 || stageId >= stageCount_.load(memory_order_acquire)) {
+        return cvcore::AllocStage::get("unassigned");
+    }
+    return *rings_[stageId].allocs;
+}
+
+double Profiler::nowUs() const {
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - epoch_).count();
+}
+
+vector<Profiler::Sample> Profiler::snapshot(int stageId) const {
+    const StageRing& ring = rings_[stageId];
+    uint64_t head = ring.head.load(memory_order_acquire);
+    uint64_t count = min<uint64_t>(head, PROFILER_RING_SIZE);
+
+    vector<Sample> samples;
+    samples.reserve((size_t)count);
+    for (uint64_t i = head - count; i < head; i++) {
+        samples.push_back(ring.samples[i % PROFILER_RING_SIZE]);
+    }
+    return samples;
+}
+
+/*
+  Function: percentile
+  Purpose: Nearest-rank percentile of a sorted vector
+*/
+static double percentile(const vector<float>& sorted, double p) {
+    size_t rank = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(rank, sorted.size() - 1)];
+}
+
+vector<StageStats> Profiler::stats() const {
+    vector<StageStats> result;
+    int count = stageCount_.load(memory_order_acquire);
+
+    for (int i = 0; i < count; i++) {
+        vector<Sample> samples = snapshot(i);
+        if (samples.empty()) {
+            continue;
+        }
+
+        vector<float> durations;
+        durations.reserve(samples.size());
+        double sum = 0.0;
+        for (const Sample& s : samples) {
+            durations.push_back(s.durationMs);
+            sum += s.durationMs;
+        }
+        sort(durations.begin(), durations.end());
+
+        StageStats st;
+        st.name = rings_[i].name;
+        st.count = durations.size();
+        st.mean = sum / durations.size();
+        st.p50 = percentile(durations, 50.0);
+        st.p95 = percentile(durations, 95.0);
+        st.p99 = percentile(durations, 99.0);
+        const cvcore::AllocCounts last = rings_[i].allocs->last();
+        st.allocs = last.heapCount + last.matCount;
+        result.push_back(st);
+    }
+    return result;
+}
+
+void Profiler::drawOverlay(Mat& frame) const {
+    vector<StageStats> all = stats();
+    if (all.empty() || frame.empty()) {
+        return;
+    }
+
+    // Allocations per call are only known with CVCORE_ALLOC_TRACKING
+    const bool allocs = cvcore::allocTrackingEnabled();
+    const int lineHeight = 16;
+    const int panelWidth = min(frame.cols, allocs ? 440 : 380);
+    const int panelHeight = min(frame.rows, lineHeight * ((int)all.size() + 1) + 8);
+
+    // Darken the panel area so the text stays readable on any effect
+    Mat panel = frame(Rect(0, 0, panelWidth, panelHeight));
+    panel.convertTo(panel, -1, 0.35, 0);
+
+    char line[128];
+    snprintf(line, sizeof(line), "%-22s %7s %7s %7s%s", "stage (ms)", "p50", "p95", "p99",
+             allocs ? "  alloc" : "");
+    putText(frame, line, Point(6, lineHeight), FONT_HERSHEY_PLAIN, 0.9,
+            Scalar(0, 255, 255), 1, LINE_AA);
+
+    for (size_t i = 0; i < all.size(); i++) {
+        int y = lineHeight * ((int)i + 2);
+        if (y > panelHeight) {
+            break;
+        }
+        int n = snprintf(line, sizeof(line), "%-22.22s %7.2f %7.2f %7.2f",
+                         all[i].name.c_str(), all[i].p50, all[i].p95, all[i].p99);
+        if (allocs) {
+            snprintf(line + n, sizeof(line) - n, " %6llu", (unsigned long long)all[i].allocs);
+        }
+        putText(frame, line, Point(6, y), FONT_HERSHEY_PLAIN, 0.9,
+                Scalar(255, 255, 255), 1, LINE_AA);
+    }
+}
+
+int Profiler::writeCSV(const string& path) const {
+    ofstream out(path);
+    if (!out.is_open()) {
+        cerr << "Error: Unable to open " << path << " for writing" << endl;
+        return -1;
+    }
+
+    out << "stage,start_us,duration_ms\n";
+    int count = stageCount_.load(memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        for (const Sample& s : snapshot(i)) {
+            out << rings_[i].name << ',' << (long long)s.startUs << ',' << s.durationMs << '\n';
+        }
+    }
+    return 0;
+}
+
+int Profiler::writeChromeTrace(const string& path) const {
+    ofstream out(path);
+    if (!out.is_open()) {
+        cerr << "Error: Unable to open " << path << " for writing" << endl;
+        return -1;
+    }
+
+    // Complete ("X") events; stage names never contain quotes or backslashes
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    int count = stageCount_.load(memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        for (const Sample& s : snapshot(i)) {
+            if (!first) {
+                out << ",\n";
+            }
+            first = false;
+            out << "{\"name\":\"" << rings_[i].name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+                << rings_[i].threadId << ",\"ts\":" << (long long)s.startUs
+                << ",\"dur\":" << (long long)(s.durationMs * 1000.0f) << "}";
+        }
+    }
+    out << "\n]}\n";
+    return 0;
+}
@@ -0,0 +1,292 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 25, 2026
+  Purpose: Implementation of the batched sparkle particle system.
+*/
+
+#define _USE_MATH_DEFINES
+#include "sparklePool.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+// Sprites exist for radii 0.5 .. MAX_SPRITE_BUCKET/2 px in half-pixel steps
+// (base size 3-7 px times the depth factor 0.3-1.0 stays below 8 px)
+static const int MAX_SPRITE_BUCKET = 16;
+
+// Orbit advance per frame at speed 1.0, as in sparkleEffect
+static const float ANGLE_STEP = 0.02f;
+
+// Depth ellipse ratio of the tilted orbit (z = r sin(a) sin(phase) * ratio)
+static const float ELLIPSE_RATIO = 0.7f;
+
+SparklePool::SparklePool(int capacity)
+    : capacity_(max(1, capacity)),
+      particlesPerFace_(12),
+      count_(0),
+      spawnedFaces_(0),
+      reseed_(true) {
+    // The arena: every attribute array is sized once, never reallocated
+    vector<float> *arrays[] = {&cosA_, &sinA_, &cosStep_, &sinStep_, &radius_,
+                               &cosPhase_, &sinPhase_, &size_, &colorB_, &colorG_,
+                               &colorR_, &posX_, &posY_, &drawSize_, &alpha_};
+    for (vector<float> *a : arrays) {
+        a->assign(capacity_, 0.0f);
+    }
+    face_.assign(capacity_, 0);
+    buildSprites();
+}
+
+void SparklePool::setParticlesPerFace(int count) {
+    count = max(1, min(capacity_, count));
+    if (count != particlesPerFace_) {
+        particlesPerFace_ = count;
+        reseed_ = true;
+    }
+}
+
+/*
+  Sprite weights reproduce drawSparkle's four glow layers: layer l has radius
+  size + 1.5 l and peak alpha 1 - 0.25 l with a linear falloff, and the
+  layers' combined coverage is 1 - prod(1 - alpha_l). The cross variant adds
+  the 1 px horizontal and vertical arms of length 1.5 * size that
+  drawSparkle draws for bright sparkles.
+*/
+void SparklePool::buildSprites() {
+    for (int cross = 0; cross < 2; cross++) {
+        sprites_[cross].resize(MAX_SPRITE_BUCKET + 1);
+        for (int bucket = 0; bucket <= MAX_SPRITE_BUCKET; bucket++) {
+            float size = max(0.5f, bucket * 0.5f);
+            int half = static_cast<int>(std::ceil(size + 4.5f));
+            Mat sprite(2 * half + 1, 2 * half + 1, CV_32FC1);
+
+            for (int dy = -half; dy <= half; dy++) {
+                float *row = sprite.ptr<float>(dy + half);
+                for (int dx = -half; dx <= half; dx++) {
+                    float dist = std::sqrt(static_cast<float>(dx * dx + dy * dy));
+                    float transmit = 1.0f;
+                    for (int layer = 0; layer < 4; layer++) {
+                        float layerSize = size + layer * 1.5f;
+                        if (dist <= layerSize) {
+                            float a = (1.0f - layer * 0.25f) * (1.0f - dist / layerSize);
+                            transmit *= 1.0f - a;
+                        }
+                    }
+                    row[dx + half] = 1.0f - transmit;
+                }
+            }
+
+            if (cross) {
+                int crossLen = min(half, static_cast<int>(size * 1.5f));
+                for (int d = -crossLen; d <= crossLen; d++) {
+                    sprite.at<float>(half, half + d) = 1.0f;
+                    sprite.at<float>(half + d, half) = 1.0f;
+                }
+            }
+            sprites_[cross][bucket] = sprite;
+        }
+    }
+}
+
+/*
+  Same randomization as initializeSparkles: evenly spaced start angles,
+  radius 0.9-1.2 x 60% of the face size, random tilt, size 3-7 px,
+  speed 0.8-1.2 and a gold / white / light blue / pink palette.
+*/
+void SparklePool::spawn(const vector<Rect> &faces) {
+    static const float PALETTE[4][3] = {
+        {102, 204, 255},  // Gold
+        {255, 255, 255},  // White
+        {255, 200, 150},  // Light blue
+        {203, 192, 255}   // Pink
+    };
+
+    int perFace = faces.empty() ? 0 :
+                  min(particlesPerFace_, capacity_ / static_cast<int>(faces.size()));
+    count_ = 0;
+
+    for (size_t faceIdx = 0; faceIdx < faces.size(); faceIdx++) {
+        float faceRadius = max(faces[faceIdx].width, faces[faceIdx].height) * 0.6f;
+
+        for (int i = 0; i < perFace; i++, count_++) {
+            int k = count_;
+            float angle = (2.0f * M_PI * i) / perFace;
+            float phase = (rand() % 100) / 100.0f * 2.0f * M_PI;
+            float step = (0.8f + 0.4f * (rand() % 100) / 100.0f) * ANGLE_STEP;
+            const float *color = PALETTE[rand() % 4];
+
+            cosA_[k] = std::cos(angle);
+            sinA_[k] = std::sin(angle);
+            cosStep_[k] = std::cos(step);
+            sinStep_[k] = std::sin(step);
+            radius_[k] = faceRadius * (0.9f + 0.3f * (rand() % 100) / 100.0f);
+            cosPhase_[k] = std::cos(phase);
+            sinPhase_[k] = std::sin(phase);
+            size_[k] = 3.0f + (rand() % 5);
+            colorB_[k] = color[0];
+            colorG_[k] = color[1];
+            colorR_[k] = color[2];
+            face_[k] = static_cast<int>(faceIdx);
+        }
+    }
+
+    spawnedFaces_ = faces.size();
+    reseed_ = false;
+}
+
+/*
+  Per particle, with (c, s) = (cos a, sin a):
+    (c, s)  <- rotate by the particle's step, then renormalize to unit length
+               (first-order: k = 1.5 - 0.5 (c^2 + s^2)) so rounding never
+               makes the orbit drift
+    x, y    =  r c, r s cos(phase)
+    u       =  (z + r) / 2r = 0.5 + 0.5 * ratio * s sin(phase)
+    behind  =  z < 0: depth factor 0.3 + 0.4 u, brightness 0.4 + 0.3 df
+    front   :         depth factor 0.7 + 0.3 u, brightness 0.7 + 0.3 df
+    pulse   =  0.8 + 0.2 sin(3t + phase), expanded with the angle-sum
+               identity so only sin(3t) and cos(3t) are evaluated per frame
+*/
+void SparklePool::update(float time) {
+    const float s3 = std::sin(time * 3.0f);
+    const float c3 = std::cos(time * 3.0f);
+    const float halfRatio = 0.5f * ELLIPSE_RATIO;
+    int i = 0;
+
+#if CV_SIMD128
+    if (useOptimized()) {
+        const v_float32x4 vHalf = v_setall_f32(0.5f), vOneHalf = v_setall_f32(1.5f);
+        const v_float32x4 vHalfRatio = v_setall_f32(halfRatio), vZero = v_setzero_f32();
+        const v_float32x4 vS3 = v_setall_f32(s3), vC3 = v_setall_f32(c3);
+        const v_float32x4 vBackDf = v_setall_f32(0.3f), vBackDfGain = v_setall_f32(0.4f);
+        const v_float32x4 vFrontDf = v_setall_f32(0.7f), vFrontDfGain = v_setall_f32(0.3f);
+        const v_float32x4 vBackBr = v_setall_f32(0.4f), vFrontBr = v_setall_f32(0.7f);
+        const v_float32x4 vPulseBase = v_setall_f32(0.8f), vPulseGain = v_setall_f32(0.2f);
+
+        for (; i + 4 <= count_; i += 4) {
+            v_float32x4 c = v_load(&cosA_[i]), s = v_load(&sinA_[i]);
+            v_float32x4 cs = v_load(&cosStep_[i]), ss = v_load(&sinStep_[i]);
+            v_float32x4 nc = c * cs - s * ss;
+            v_float32x4 ns = v_fma(c, ss, s * cs);
+            v_float32x4 k = vOneHalf - vHalf * v_fma(nc, nc, ns * ns);
+            nc = nc * k;
+            ns = ns * k;
+            v_store(&cosA_[i], nc);
+            v_store(&sinA_[i], ns);
+
+            v_float32x4 r = v_load(&radius_[i]);
+            v_float32x4 cp = v_load(&cosPhase_[i]), sp = v_load(&sinPhase_[i]);
+            v_store(&posX_[i], r * nc);
+            v_store(&posY_[i], r * ns * cp);
+
+            v_float32x4 zs = ns * sp;
+            v_float32x4 u = v_fma(vHalfRatio, zs, vHalf);
+            v_float32x4 behind = zs < vZero;
+            v_float32x4 df = v_select(behind, v_fma(vBackDfGain, u, vBackDf),
+                                      v_fma(vFrontDfGain, u, vFrontDf));
+            v_float32x4 bright = v_fma(vFrontDfGain, df, v_select(behind, vBackBr, vFrontBr));
+            v_float32x4 pulse = v_fma(vPulseGain, v_fma(vS3, cp, vC3 * sp), vPulseBase);
+
+            v_store(&drawSize_[i], v_load(&size_[i]) * df);
+            v_store(&alpha_[i], bright * pulse);
+        }
+    }
+#endif
+
+    for (; i < count_; i++) {
+        float c = cosA_[i] * cosStep_[i] - sinA_[i] * sinStep_[i];
+        float s = cosA_[i] * sinStep_[i] + sinA_[i] * cosStep_[i];
+        float k = 1.5f - 0.5f * (c * c + s * s);
+        cosA_[i] = c * k;
+        sinA_[i] = s * k;
+
+        posX_[i] = radius_[i] * cosA_[i];
+        posY_[i] = radius_[i] * sinA_[i] * cosPhase_[i];
+
+        float zs = sinA_[i] * sinPhase_[i];
+        float u = 0.5f + halfRatio * zs;
+        bool behind = zs < 0.0f;
+        float df = behind ? 0.3f + 0.4f * u : 0.7f + 0.3f * u;
+        float bright = (behind ? 0.4f : 0.7f) + 0.3f * df;
+        float pulse = 0.8f + 0.2f * (s3 * cosPhase_[i] + c3 * sinPhase_[i]);
+
+        drawSize_[i] = size_[i] * df;
+        alpha_[i] = bright * pulse;
+    }
+}
+
+cv::Rect SparklePool::splat(const vector<Rect> &faces) {
+    Rect frameRect(0, 0, overlay_.cols, overlay_.rows);
+    Rect box;
+
+    for (int i = 0; i < count_; i++) {
+        const Rect &face = faces[face_[i]];
+        int px = face.x + face.width / 2 + static_cast<int>(posX_[i]);
+        int py = face.y + face.height / 2 + static_cast<int>(posY_[i]);
+        if (!frameRect.contains(Point(px, py))) {
+            continue;
+        }
+
+        int bucket = max(1, min(MAX_SPRITE_BUCKET, cvRound(drawSize_[i] * 2.0f)));
+        const Mat &sprite = sprites_[alpha_[i] > 0.5f ? 1 : 0][bucket];
+        int half = sprite.cols / 2;
+        Rect rect = Rect(px - half, py - half, sprite.cols, sprite.rows) & frameRect;
+
+        // Color pre-scaled by brightness: one multiply-add per channel per pixel
+        const float cb = colorB_[i] * alpha_[i];
+        const float cg = colorG_[i] * alpha_[i];
+        const float cr = colorR_[i] * alpha_[i];
+        const int sx = rect.x - (px - half);
+
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            const float *w = sprite.ptr<float>(y - (py - half)) + sx;
+            float *o = overlay_.ptr<float>(y) + rect.x * 3;
+            for (int x = 0; x < rect.width; x++, o += 3) {
+                o[0] += w[x] * cb;
+                o[1] += w[x] * cg;
+                o[2] += w[x] * cr;
+            }
+        }
+        box = box.empty() ? rect : (box | rect);
+    }
+    return box;
+}
+
+int SparklePool::render(const Mat &src, Mat &dst, const vector<Rect> &faces, float time) {
+    if (src.empty() || src.type() != CV_8UC3) {
+        std::cerr << "Error: SparklePool::render requires a CV_8UC3 image" << std::endl;
+        return -1;
+    }
+
+    // Clear only what the previous frame lit
+    if (overlay_.size() != src.size()) {
+        overlay_ = Mat::zeros(src.size(), CV_32FC3);
+        dirty_ = Rect();
+    } else if (!dirty_.empty()) {
+        overlay_(dirty_).setTo(Scalar::all(0));
+    }
+
+    src.copyTo(dst);
+    if (faces.empty()) {
+        dirty_ = Rect();
+        return 0;
+    }
+
+    if (reseed_ || faces.size() != spawnedFaces_) {
+        spawn(faces);
+    }
+    update(time);
+    dirty_ = splat(faces);
+
+    // Single saturating composite over the lit region
+    if (!dirty_.empty()) {
+        overlay_(dirty_).convertTo(overlay8_, CV_8UC3);
+        Mat region = dst(dirty_);
+        add(region, overlay8_, region);
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 26, 2026
+  Purpose: Implementation of the memory-mapped tile pyramid and the LRU of
+           processed tiles.
+*/
+
+#include "tilePyramid.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+// Identifies the source file a cache was built from
+static std::string sourceStamp(const std::string &imagePath) {
+    std::error_code ec;
+    const uintmax_t bytes = fs::file_size(imagePath, ec);
+    if (ec) {
+        return "";
+    }
+    const auto time = fs::last_write_time(imagePath, ec);
+    if (ec) {
+        return "";
+    }
+    return std::to_string(bytes) + ":" + std::to_string(time.time_since_epoch().count());
+}
+
+static std::string levelPath(const std::string &cacheDir, int level) {
+    return (fs::path(cacheDir) / ("level" + std::to_string(level) + ".raw")).string();
+}
+
+static cv::Size gridFor(cv::Size size, int tileSize) {
+    return cv::Size((size.width + tileSize - 1) / tileSize, (size.height + tileSize - 1) / tileSize);
+}
+
+int TilePyramid::open(const std::string &imagePath, const std::string &cacheDir, int tileSize) {
+    levels_.clear();
+    const std::string dir = cacheDir.empty() ? imagePath + ".tiles" : cacheDir;
+
+    if (!readHeader(dir, imagePath)) {
+        tileSize_ = std::max(64, tileSize);
+        if (build(imagePath, dir) != 0 || !readHeader(dir, imagePath)) {
+            levels_.clear();
+            return -1;
+        }
+    }
+
+    // Map every level; pages are read from disk only when a tile is viewed
+    const size_t tileBytes = static_cast<size_t>(tileSize_) * tileSize_ * 3;
+    for (int level = 0; level < levels(); level++) {
+        Level &l = levels_[level];
+        l.file.reset(new cvcore::MappedFile());
+        if (!l.file->open(levelPath(dir, level)) ||
+            l.file->size() != static_cast<size_t>(l.grid.area()) * tileBytes) {
+            std::cerr << "Error: Tile cache level " << level << " in " << dir
+                      << " is missing or truncated" << std::endl;
+            levels_.clear();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+bool TilePyramid::readHeader(const std::string &cacheDir, const std::string &imagePath) {
+    const std::string header = (fs::path(cacheDir) / "pyramid.yml").string();
+    if (!fs::exists(header)) {
+        return false;
+    }
+    cv::FileStorage fsIn(header, cv::FileStorage::READ);
+    if (!fsIn.isOpened()) {
+        return false;
+    }
+
+    std::string stamp;
+    int width = 0, height = 0, tile = 0, count = 0;
+    fsIn["source_stamp"] >> stamp;
+    fsIn["width"] >> width;
+    fsIn["height"] >> height;
+    fsIn["tile"] >> tile;
+    fsIn["levels"] >> count;
+    if (stamp.empty() || stamp != sourceStamp(imagePath) || width <= 0 || height <= 0 ||
+        tile <= 0 || count <= 0) {
+        return false;
+    }
+
+    tileSize_ = tile;
+    levels_.clear();
+    levels_.resize(count);
+    cv::Size size(width, height);
+    for (Level &l : levels_) {
+        l.size = size;
+        l.grid = gridFor(size, tileSize_);
+        size = cv::Size(std::max(1, (size.width + 1) / 2), std::max(1, (size.height + 1) / 2));
+    }
+    return true;
+}
+
+int TilePyramid::build(const std::string &imagePath, const std::string &cacheDir) {
+    std::cout << "Building tile cache in " << cacheDir << " (one-time decode)..." << std::endl;
+    int64 start = cv::getTickCount();
+
+    cv::Mat level = cv::imread(imagePath, cv::IMREAD_COLOR);
+    if (level.empty()) {
+        std::cerr << "Error: Could not decode " << imagePath << std::endl;
+        return -1;
+    }
+    const cv::Size fullSize = level.size();
+
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    fs::remove(fs::path(cacheDir) / "pyramid.yml", ec);
+
+    cv::Mat padded(tileSize_, tileSize_, CV_8UC3);
+    cv::Mat next;
+    int count = 0;
+    while (true) {
+        std::ofstream out(levelPath(cacheDir, count), std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: Cannot write tile cache in " << cacheDir << std::endl;
+            return -1;
+        }
+
+        // Row-major tiles, edge tiles padded by replication to full size
+        const cv::Size grid = gridFor(level.size(), tileSize_);
+        for (int ty = 0; ty < grid.height; ty++) {
+            for (int tx = 0; tx < grid.width; tx++) {
+                const cv::Rect r = cv::Rect(tx * tileSize_, ty * tileSize_, tileSize_, tileSize_) &
+                                   cv::Rect(0, 0, level.cols, level.rows);
+                cv::copyMakeBorder(level(r), padded, 0, tileSize_ - r.height, 0,
+                                   tileSize_ - r.width, cv::BORDER_REPLICATE);
+                out.write(reinterpret_cast<const char *>(padded.data),
+                          static_cast<std::streamsize>(padded.total() * padded.elemSize()));
+            }
+        }
+        if (!out) {
+            std::cerr << "Error: Cannot write tile cache in " << cacheDir << std::endl;
+            return -1;
+        }
+        count++;
+
+        if (level.cols <= tileSize_ && level.rows <= tileSize_) {
+            break;
+        }
+        cv::resize(level, next, cv::Size(std::max(1, (level.cols + 1) / 2),
+                                         std::max(1, (level.rows + 1) / 2)),
+                   0, 0, cv::INTER_AREA);
+        cv::swap(level, next);
+    }
+
+    // The header goes last: a cache without one is rebuilt
+    cv::FileStorage fsOut((fs::path(cacheDir) / "pyramid.yml").string(), cv::FileStorage::WRITE);
+    fsOut << "source_stamp" << sourceStamp(imagePath);
+    fsOut << "width" << fullSize.width << "height" << fullSize.height;
+    fsOut << "tile" << tileSize_ << "levels" << count;
+    fsOut.release();
+
+    double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+    std::cout << "Tile cache built: " << count << " levels in " << ms << " ms" << std::endl;
+    return 0;
+}
+
+cv::Mat TilePyramid::tile(int level, int tx, int ty) const {
+    if (level < 0 || level >= levels()) {
+        return cv::Mat();
+    }
+    const Level &l = levels_[level];
+    if (tx < 0 || ty < 0 || tx >= l.grid.width || ty >= l.grid.height) {
+        return cv::Mat();
+    }
+
+    const size_t tileBytes = static_cast<size_t>(tileSize_) * tileSize_ * 3;
+    char *data = const_cast<char *>(l.file->data()) +
+                 (static_cast<size_t>(ty) * l.grid.width + tx) * tileBytes;
+    cv::Mat full(tileSize_, tileSize_, CV_8UC3, data);
+    const int w = std::min(tileSize_, l.size.width - tx * tileSize_);
+    const int h = std::min(tileSize_, l.size.height - ty * tileSize_);
+    return full(cv::Rect(0, 0, w, h));
+}
+
+size_t TilePyramid::cacheBytes() const {
+    size_t total = 0;
+    for (const Level &l : levels_) {
+        total += l.file ? l.file->size() : 0;
+    }
+    return total;
+}
+
+const cv::Mat &TileCache::get(const TilePyramid &pyramid, int level, int tx, int ty,
+                              uint32_t version, const TileFilter &filter) {
+    const uint64_t key = (static_cast<uint64_t>(version & 0xFFFFF) << 44) |
+                         (static_cast<uint64_t>(level & 0xF) << 40) |
+                         (static_cast<uint64_t>(ty & 0xFFFFF) << 20) |
+                         static_cast<uint64_t>(tx & 0xFFFFF);
+
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        hits_++;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return found->second->tile;
+    }
+    misses_++;
+
+    // Reuse the least recently used tile's buffer when the cache is full
+    Entry entry;
+    entry.key = key;
+    if (entries_.size() >= std::max<size_t>(1, capacity_)) {
+        index_.erase(entries_.back().key);
+        entry.tile = entries_.back().tile;
+        entries_.pop_back();
+    }
+    filter(pyramid.tile(level, tx, ty), entry.tile);
+
+    entries_.push_front(entry);
+    index_[key] = entries_.begin();
+    return entries_.front().tile;
+}
+
+void TileCache::clear() {
+    entries_.clear();
+    index_.clear();
+}
@@ -0,0 +1,295 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 25, 2026
+  Purpose: Headless batch processing of recorded footage. Reads a video file
+           or image sequence, applies a filter chain (or CartoonVideo) and
+           writes the result with cv::VideoWriter. Decode, process and encode
+           run as a three-stage pipeline on separate threads connected by
+           bounded queues.
+*/
+
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cvcore/capture.hpp>
+#include "filters.hpp"
+#include "cartoonVideo.hpp"
+
+using namespace cv;
+using namespace std;
+
+// Frames in flight between two stages; bounds memory and lets a slow stage
+// apply back-pressure to the one before it
+const size_t QUEUE_CAPACITY = 8;
+
+/*
+  Class: BoundedQueue
+  Purpose: Blocking single-producer / single-consumer queue of frames with a
+           fixed capacity. close() wakes the consumer once the producer is done.
+*/
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity), closed_(false) {}
+
+    // Blocks while full; returns false if the queue was closed
+    bool push(Mat frame) {
+        unique_lock<mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(frame));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Blocks while empty; returns false once closed and drained
+    bool pop(Mat &frame) {
+        unique_lock<mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        frame = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_;
+    deque<Mat> items_;
+    mutex mutex_;
+    condition_variable notEmpty_, notFull_;
+};
+
+typedef function<int(Mat &, Mat &)> FrameFilter;
+
+/*
+  Function: makeFilter
+  Purpose: Map a filter name from the command line to a frame filter
+  Arguments:
+    name - filter name (see printUsage)
+    cartoon - CartoonVideo instance used by the "cartoonvideo" filter
+    filter - output filter function
+  Return value: 0 on success, -1 if the name is unknown
+*/
+int makeFilter(const string &name, CartoonVideo &cartoon, FrameFilter &filter) {
+    if (name == "grey") {
+        filter = [](Mat &s, Mat &d) { return greyscale(s, d); };
+    } else if (name == "sepia") {
+        filter = [](Mat &s, Mat &d) { return sepiaTone(s, d, true); };
+    } else if (name == "blur") {
+        filter = [](Mat &s, Mat &d) { return blur5x5_simd(s, d); };
+    } else if (name == "sobelx" || name == "sobely") {
+        bool x = (name == "sobelx");
+        filter = [x](Mat &s, Mat &d) {
+            Mat grad;
+            int status = x ? sobelX3x3(s, grad) : sobelY3x3(s, grad);
+            if (status == 0) {
+                convertScaleAbs(grad, d, 2.0, 128.0);
+            }
+            return status;
+        };
+    } else if (name == "magnitude") {
+        filter = [](Mat &s, Mat &d) {
+            Mat mag;
+            int status = sobelMagnitude3x3(s, mag);
+            if (status == 0) {
+                convertScaleAbs(mag, d, 4.0, 0);
+            }
+            return status;
+        };
+    } else if (name == "quantize") {
+        filter = [](Mat &s, Mat &d) { return blurQuantize(s, d, 10); };
+    } else if (name == "emboss") {
+        filter = [](Mat &s, Mat &d) { return embossEffect(s, d); };
+    } else if (name == "negative") {
+        filter = [](Mat &s, Mat &d) { return negativeEffect(s, d); };
+    } else if (name == "cartoon") {
+        filter = [](Mat &s, Mat &d) { return cartoonEffect(s, d); };
+    } else if (name == "bulge") {
+        filter = [](Mat &s, Mat &d) { return bulgeEffect(s, d, 0.5f); };
+    } else if (name == "wave") {
+        filter = [](Mat &s, Mat &d) { return waveEffect(s, d, 10.0f, 0.035f); };
+    } else if (name == "swirl") {
+        filter = [](Mat &s, Mat &d) { return swirlEffect(s, d, 2.0f); };
+    } else if (name == "cartoonvideo") {
+        filter = [&cartoon](Mat &s, Mat &d) { return cartoon.processFrame(s, d); };
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+  Function: printUsage
+  Purpose: Print command line help
+*/
+void printUsage(const char *prog) {
+    cout << "Usage: " << prog << " <input> <output> [filters] [fourcc]" << endl;
+    cout << "  input   : video file, stream URL or image sequence (folder, .txt list" << endl;
+    cout << "            or pattern such as frames/img_%04d.png)" << endl;
+    cout << "  output  : output video file (e.g. out.mp4)" << endl;
+    cout << "  filters : comma separated chain, applied left to right (default: cartoonvideo)" << endl;
+    cout << "            grey, sepia, blur, sobelx, sobely, magnitude, quantize, emboss," << endl;
+    cout << "            negative, cartoon, bulge, wave, swirl, cartoonvideo" << endl;
+    cout << "  fourcc  : four character codec code (default: mp4v)" << endl;
+}
+
+/*
+  Function: main
+  Purpose: Batch processing entry point
+  Return value: 0 on success, -1 on error
+*/
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return -1;
+    }
+
+    string inputPath = argv[1];
+    string outputPath = argv[2];
+    string chainSpec = (argc > 3) ? argv[3] : "cartoonvideo";
+    string fourccSpec = (argc > 4) ? argv[4] : "mp4v";
+    if (fourccSpec.size() != 4) {
+        cerr << "Error: fourcc must be four characters" << endl;
+        return -1;
+    }
+
+    // Build the filter chain
+    CartoonVideo cartoon;
+    vector<FrameFilter> chain;
+    size_t start = 0;
+    while (start <= chainSpec.size()) {
+        size_t end = chainSpec.find(',', start);
+        if (end == string::npos) end = chainSpec.size();
+        string name = chainSpec.substr(start, end - start);
+        start = end + 1;
+        if (name.empty()) continue;
+
+        FrameFilter filter;
+        if (makeFilter(name, cartoon, filter) != 0) {
+            cerr << "Error: Unknown filter '" << name << "'" << endl;
+            printUsage(argv[0]);
+            return -1;
+        }
+        chain.push_back(filter);
+    }
+
+    // Files are hardware-decoded where available; image sequences are read ahead
+    unique_ptr<cvcore::FrameSource> capture = cvcore::FrameSource::open(inputPath);
+    if (!capture) {
+        cerr << "Error: Unable to open input " << inputPath << endl;
+        return -1;
+    }
+
+    double fps = capture->fps();
+    if (fps <= 0.0) {
+        fps = 30.0;  // Image sequences report no frame rate
+    }
+
+    cout << "=== VFX Batch ===" << endl;
+    cout << "Input: " << inputPath << endl;
+    cout << "Output: " << outputPath << " (" << fourccSpec << ", " << fps << " fps)" << endl;
+    cout << "Filters: " << chainSpec << endl;
+
+    BoundedQueue decoded(QUEUE_CAPACITY);
+    BoundedQueue processed(QUEUE_CAPACITY);
+    bool processFailed = false;
+
+    int64 startTicks = getTickCount();
+
+    // Stage 1: decode
+    thread decodeThread([&]() {
+        while (true) {
+            // Fresh Mat per frame: the queue owns it, the decoder can't reuse it
+            Mat frame;
+            if (!capture->read(frame) || !decoded.push(frame)) {
+                break;
+            }
+        }
+        decoded.close();
+    });
+
+    // Stage 2: process (single thread keeps CartoonVideo's temporal state in order)
+    thread processThread([&]() {
+        Mat frame;
+        while (decoded.pop(frame)) {
+            Mat current = frame;
+            for (FrameFilter &filter : chain) {
+                Mat out;
+                if (filter(current, out) != 0) {
+                    processFailed = true;
+                    out = current;
+                }
+                current = out;
+            }
+            if (current.channels() == 1) {
+                cvtColor(current, current, COLOR_GRAY2BGR);
+            }
+            if (!processed.push(current)) {
+                break;
+            }
+        }
+        processed.close();
+    });
+
+    // Stage 3: encode (this thread)
+    VideoWriter writer;
+    long frameCount = 0;
+    int status = 0;
+    Mat frame;
+    while (processed.pop(frame)) {
+        if (!writer.isOpened()) {
+            int fourcc = VideoWriter::fourcc(fourccSpec[0], fourccSpec[1], fourccSpec[2], fourccSpec[3]);
+            if (!writer.open(outputPath, fourcc, fps, frame.size(), true)) {
+                cerr << "Error: Unable to open output " << outputPath << endl;
+                status = -1;
+                break;
+            }
+        }
+        writer.write(frame);
+        frameCount++;
+    }
+
+    // Unblock the upstream stages if encoding stopped early
+    processed.close();
+    decoded.close();
+    processThread.join();
+    decodeThread.join();
+    writer.release();
+
+    double seconds = (getTickCount() - startTicks) / getTickFrequency();
+
+    if (processFailed) {
+        cerr << "Warning: Some frames failed a filter and were passed through" << endl;
+    }
+    cout << "Frames written: " << frameCount << endl;
+    cout << "Elapsed: " << fixed << setprecision(2) << seconds << " s" << endl;
+    if (seconds > 0.0) {
+        cout << "Throughput: " << setprecision(1) << (frameCount / seconds) << " frames/sec" << endl;
+    }
+
+    if (frameCount == 0 && status == 0) {
+        cerr << "Error: No frames read from " << inputPath << endl;
+        status = -1;
+    }
+    return status;
+}
@@ -10,17 +10,41 @@
 #include <string>
 #include <ctime>
 #include <chrono>
+#include <atomic>
+#include <memory>
 #include "filters.hpp"
 #include "faceDetect.h"
+#include "profiler.hpp"
+#include <cvcore/metrics.hpp>
+#include <cvcore/assetLoader.hpp>
+#include <cvcore/matPool.hpp>
+#include "frameGraph.hpp"
+#include "faceTracker.hpp"
+#include "sparklePool.hpp"
+#include "multiCamera.hpp"
+#include "framePool.hpp"
+#include "captureThread.hpp"
+#include "frameWriter.hpp"
+#include "pointOps.hpp"
+#include "videoWindow.hpp"
 
 #ifdef USE_ONNXRUNTIME
 #include "DA2Network.hpp"
+#include "asyncDepth.hpp"
+#include "depthServer.hpp"
+#include "depthUpsampler.hpp"
 #endif
 
 using namespace cv;
 using namespace std;
 using namespace chrono;
 
+#ifdef USE_ONNXRUNTIME
+// The depth network runs on frames shrunk by this factor; its maps are
+// warped and guided-upsampled to display resolution by DepthUpsampler
+static const float DEPTH_INPUT_SCALE = 0.5f;
+#endif
+
 // Display mode enumeration
 enum DisplayMode {
     MODE_COLOR,           // Normal color video (Task 2)
@@ -44,7 +68,12 @@ enum DisplayMode {
     MODE_WAVE,            // Wave warp (Extension)
     MODE_SWIRL,           // Swirl warp (Extension)
     MODE_FACE_BULGE,      // Face Bulge warp (Extension)
-    MODE_SPARKLES         // Sparkles around face (Extension)
+    MODE_SPARKLES,        // Sparkles around face (Extension)
+    MODE_FACE_FOG,        // Face Highlight over Depth Fog (composite)
+    MODE_CARTOON_SPARKLES,// Cartoon with Sparkles (composite)
+    MODE_SEPIA_NEGATIVE,  // Negative of vignetted sepia (fused point ops)
+    MODE_GREY_QUANTIZE,   // Quantized custom greyscale (fused point ops)
+    MODE_COUNT            // Number of modes (not a mode)
 };
 
 /**
@@ -77,6 +106,10 @@ string getModeString(DisplayMode mode) {
         case MODE_SWIRL: return "Swirl Warp";
         case MODE_FACE_BULGE: return "Face Bulge";
         case MODE_SPARKLES: return "Sparkles";
+        case MODE_FACE_FOG: return "Face Highlight + Fog";
+        case MODE_CARTOON_SPARKLES: return "Cartoon + Sparkles";
+        case MODE_SEPIA_NEGATIVE: return "Sepia + Negative";
+        case MODE_GREY_QUANTIZE: return "Greyscale + Quantize";
         default: return "Unknown";
     }
 }
@@ -91,7 +124,8 @@ string getModeString(DisplayMode mode) {
 void printControls() {
     cout << "\n=== Video Display Controls ===" << endl;
     cout << "  q/ESC : Quit application" << endl;
-    cout << "  s     : Save current frame" << endl;
+    cout << "  s     : Save current frame (written in the background)" << endl;
+    cout << "  v     : Start / stop recording the display to video" << endl;
     cout << "  i     : Display video information" << endl;
     cout << "  p     : Show this help" << endl;
     cout << "\n--- Display Modes ---" << endl;
@@ -119,8 +153,17 @@ void printControls() {
     cout << "  9     : Swirl - twirl distortion" << endl;
     cout << "  0     : Face Bulge - caricature effect" << endl;
     cout << "  [     : Sparkles - magical effect around face" << endl;
+    cout << "  ]     : Face Highlight + Depth Fog (composite)" << endl;
+    cout << "  \\     : Cartoon + Sparkles (composite)" << endl;
+    cout << "  ;     : Sepia + Negative (fused, one pass)" << endl;
+    cout << "  '     : Custom Greyscale + Quantize (fused, one pass)" << endl;
     cout << "\n--- Adjustments ---" << endl;
-    cout << "  +/-   : Adjust effect strength / quantize levels" << endl;
+    cout << "  +/-   : Adjust effect strength / quantize levels / sparkle count" << endl;
+    cout << "  n     : Cycle depth interval (run depth every 1/2/4 frames)" << endl;
+    cout << "  u     : Toggle depth motion compensation between depth updates" << endl;
+    cout << "  r     : Toggle face tracking between detections" << endl;
+    cout << "  k     : Cycle cartoon quality (color path at 1/1, 1/2, 1/4 resolution)" << endl;
+    cout << "  o     : Toggle latency profiler overlay (dumps trace on exit)" << endl;
     cout << "==============================\n" << endl;
 }
 
@@ -129,18 +172,26 @@ void printControls() {
  * 
  * @param frame Current video frame for size/type information
  * @param frameCount Total number of frames captured since start
- * @param savedCount Number of frames saved to disk
+ * @param savedCount Number of frames queued for saving
  * @param fps Camera frames per second
  * @param mode Current display mode
+ * @param profiler Latency profiler providing the measured frame rate
  */
 void displayVideoInfo(const Mat& frame, int frameCount, int savedCount, 
-                      double fps, DisplayMode mode) {
+                      double fps, DisplayMode mode,
+                      const Profiler& profiler) {
     cout << "\n=== Video Information ===" << endl;
     cout << "Current mode: " << getModeString(mode) << endl;
     cout << "Frame size: " << frame.cols << " x " << frame.rows << " pixels" << endl;
     cout << "Channels: " << frame.channels() << endl;
     cout << "Type: " << frame.type() << endl;
     cout << "FPS (camera): " << fps << endl;
+    for (const StageStats& st : profiler.stats()) {
+        if (st.name == "frame" && st.mean > 0.0) {
+            cout << "FPS (measured): " << (1000.0 / st.mean) << " (p95 frame "
+                 << st.p95 << " ms)" << endl;
+        }
+    }
     cout << "Frames captured: " << frameCount << endl;
     cout << "Frames saved: " << savedCount << endl;
     cout << "Size per frame: " << (frame.total() * frame.elemSize() / 1024.0) << " KB" << endl;
@@ -148,231 +199,534 @@ void displayVideoInfo(const Mat& frame, int frameCount, int savedCount,
 }
 
 /**
- * @brief Processes a video frame by applying the selected filter/effect.
+ * @brief Parameters shared by the display mode presets.
+ */
+struct EffectParams {
+    int quantizeLevels;                    // Levels for blur-quantize
+    float warpStrength;                    // Warp strength [0.1-1.0]
+    float time;                            // Animation time in seconds
+    int cartoonScale;                      // Cartoon color path downscale (1/2/4)
+    int sparkleCount;                      // Sparkle particles per face
+    SparklePool *sparkles;                 // Persistent particle pool
+};
+
+/**
+ * @brief A display mode: renders dst from the nodes of a frame graph.
+ *
+ * Presets pull intermediates (greyscale, gradients, faces, depth) from the
+ * graph instead of computing them, so composite modes and consecutive
+ * consumers within a frame share one evaluation. Presets copy node results
+ * into dst rather than aliasing them, leaving the memoised nodes intact.
+ *
+ * @return 0 on success, -1 on error (caller falls back to the color frame)
+ */
+typedef int (*ModePreset)(FrameGraph &graph, const EffectParams &params, Mat &dst);
+
+// Writes the frame with a "Depth not available" notice
+static int presetNoDepth(FrameGraph &graph, Mat &dst) {
+    graph.color().copyTo(dst);
+    putText(dst, "Depth not available", Point(50, dst.rows/2),
+            FONT_HERSHEY_SIMPLEX, 1.0, Scalar(0, 0, 255), 2);
+    return 0;
+}
+
+static int presetColor(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    graph.color().copyTo(dst);
+    return 0;
+}
+
+static int presetGreyscaleCV(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    cvtColor(graph.grey(), dst, COLOR_GRAY2BGR);
+    return 0;
+}
+
+static int presetGreyscaleCustom(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    return greyscale(graph.color(), dst);
+}
+
+static int presetSepia(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    return sepiaTone(graph.color(), dst, true);
+}
+
+static int presetBlur(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    graph.blur().copyTo(dst);
+    return 0;
+}
+
+static int presetSobelX(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    // Scale by 2 and add 128 offset to center around gray
+    convertScaleAbs(graph.sobelX(), dst, 2.0, 128.0);
+    return 0;
+}
+
+static int presetSobelY(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    // Scale by 2 and add 128 offset to center around gray
+    convertScaleAbs(graph.sobelY(), dst, 2.0, 128.0);
+    return 0;
+}
+
+static int presetMagnitude(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    // Magnitude doesn't need offset, just scaling
+    convertScaleAbs(graph.magnitude(), dst, 4.0, 0);
+    return 0;
+}
+
+static int presetQuantize(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    return blurQuantize(graph.color(), dst, params.quantizeLevels);
+}
+
+static int presetFaceDetect(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    graph.color().copyTo(dst);
+    return drawBoxes(dst, graph.faces());
+}
+
+static int presetDepth(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    if (!graph.hasDepth()) {
+        return presetNoDepth(graph, dst);
+    }
+    applyColorMap(graph.invertedDepth(), dst, COLORMAP_INFERNO);
+    return 0;
+}
+
+static int presetDepthFog(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    if (!graph.hasDepth()) {
+        return presetNoDepth(graph, dst);
+    }
+    return depthFog(graph.color(), graph.invertedDepth(), dst, 3.0f);
+}
+
+static int presetEmboss(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    return embossEffect(graph.color(), dst);
+}
+
+static int presetNegative(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    return negativeEffect(graph.color(), dst);
+}
+
+static int presetFaceHighlight(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    return faceHighlight(graph.color(), dst, graph.faces());
+}
+
+static int presetCartoon(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    return cartoonEffect(graph.color(), dst, params.cartoonScale);
+}
+
+static int presetDepthFocus(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    if (!graph.hasDepth()) {
+        return presetNoDepth(graph, dst);
+    }
+    return depthFocus(graph.color(), graph.depth(), dst, 200, 40);
+}
+
+static int presetBulge(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    return bulgeEffect(graph.color(), dst, params.warpStrength);
+}
+
+static int presetWave(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    // amplitude = warpStrength * 20, frequency based on strength
+    return waveEffect(graph.color(), dst, params.warpStrength * 20.0f,
+                      0.02f + params.warpStrength * 0.03f);
+}
+
+static int presetSwirl(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    // angle = warpStrength * 4 radians
+    return swirlEffect(graph.color(), dst, params.warpStrength * 4.0f);
+}
+
+static int presetFaceBulge(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    return faceBulgeEffect(graph.color(), dst, graph.faces(), params.warpStrength);
+}
+
+static int presetSparkles(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    params.sparkles->setParticlesPerFace(params.sparkleCount);
+    return params.sparkles->render(graph.color(), dst, graph.faces(), params.time);
+}
+
+// Composite: color faces on grey, then fog everything by depth
+static int presetFaceFog(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    if (!graph.hasDepth()) {
+        return presetNoDepth(graph, dst);
+    }
+    FrameLease highlighted = FramePool::local().acquireLike(graph.color());
+    if (faceHighlight(graph.color(), highlighted.mat(), graph.faces()) != 0) {
+        return -1;
+    }
+    return depthFog(highlighted.mat(), graph.invertedDepth(), dst, 3.0f);
+}
+
+// Composite: sparkles orbit faces found on the original frame
+static int presetCartoonSparkles(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    FrameLease cartoon = FramePool::local().acquireLike(graph.color());
+    if (cartoonEffect(graph.color(), cartoon.mat(), params.cartoonScale) != 0) {
+        return -1;
+    }
+    params.sparkles->setParticlesPerFace(params.sparkleCount);
+    return params.sparkles->render(cartoon.mat(), dst, graph.faces(), params.time);
+}
+
+// Composite: sepia, vignette and negative fused into one pass
+static int presetSepiaNegative(FrameGraph &graph, const EffectParams &, Mat &dst) {
+    static const auto chain = pipe(sepia(), vignette(), negative());
+    return chain(graph.color(), dst);
+}
+
+// Composite: custom greyscale and quantization fused into one pass
+static int presetGreyQuantize(FrameGraph &graph, const EffectParams &params, Mat &dst) {
+    return pipe(grey(), quantize(params.quantizeLevels))(graph.color(), dst);
+}
+
+/**
+ * @brief Preset graph for each display mode, indexed by DisplayMode.
+ */
+static const ModePreset MODE_PRESETS[MODE_COUNT] = {
+    presetColor,            // MODE_COLOR
+    presetGreyscaleCV,      // MODE_GREYSCALE_CV
+    presetGreyscaleCustom,  // MODE_GREYSCALE_CUSTOM
+    presetSepia,            // MODE_SEPIA
+    presetBlur,             // MODE_BLUR
+    presetSobelX,           // MODE_SOBEL_X
+    presetSobelY,           // MODE_SOBEL_Y
+    presetMagnitude,        // MODE_MAGNITUDE
+    presetQuantize,         // MODE_QUANTIZE
+    presetFaceDetect,       // MODE_FACE_DETECT
+    presetDepth,            // MODE_DEPTH
+    presetDepthFog,         // MODE_DEPTH_FOG
+    presetEmboss,           // MODE_EMBOSS
+    presetNegative,         // MODE_NEGATIVE
+    presetFaceHighlight,    // MODE_FACE_HIGHLIGHT
+    presetCartoon,          // MODE_CARTOON
+    presetDepthFocus,       // MODE_DEPTH_FOCUS
+    presetBulge,            // MODE_BULGE
+    presetWave,             // MODE_WAVE
+    presetSwirl,            // MODE_SWIRL
+    presetFaceBulge,        // MODE_FACE_BULGE
+    presetSparkles,         // MODE_SPARKLES
+    presetFaceFog,          // MODE_FACE_FOG
+    presetCartoonSparkles,  // MODE_CARTOON_SPARKLES
+    presetSepiaNegative,    // MODE_SEPIA_NEGATIVE
+    presetGreyQuantize      // MODE_GREY_QUANTIZE
+};
+
+/**
+ * @brief Renders the current display mode from the frame graph.
  * 
- * Central function that applies the appropriate image processing effect based
- * on the current display mode. Handles all filter pipelines including basic
- * filters, edge detection, face detection, depth effects, and warp effects.
+ * The graph must have been started for this frame with beginFrame(); the
+ * mode's preset pulls the intermediates it needs, and anything already
+ * evaluated this frame (e.g. faces, inverted depth) is reused.
  * 
- * @param frame Input video frame (3-channel BGR image)
+ * @param graph Frame graph holding the current frame and depth map
  * @param displayFrame Output frame with effect applied
- * @param mode Current display mode determining which effect to apply
- * @param sobelX Temporary storage for Sobel X gradient
- * @param sobelY Temporary storage for Sobel Y gradient
- * @param quantizeLevels Number of quantization levels for blur-quantize effect
- * @param depthMap Pre-computed depth map (if available)
- * @param warpStrength Strength parameter for warp effects [0.1-1.0]
- * @param sparkles Persistent sparkle state data for animation
- * @param time Current animation time in seconds for time-based effects
+ * @param mode Current display mode determining which preset to run
+ * @param params Effect parameters (quantize levels, warp strength, animation)
  * @return 0 on success
  */
-int processFrame(Mat &frame, Mat &displayFrame, DisplayMode mode,
-                 Mat &sobelX, Mat &sobelY, int quantizeLevels, Mat &depthMap,
-                 float warpStrength, vector<vector<Sparkle>> &sparkles, float time) {
+int processFrame(FrameGraph &graph, Mat &displayFrame, DisplayMode mode,
+                 const EffectParams &params) {
     
-    switch (mode) {
-        case MODE_COLOR:
-            displayFrame = frame.clone();
-            break;
-            
-        case MODE_GREYSCALE_CV:
-            {
-                Mat greyImage;
-                cvtColor(frame, greyImage, COLOR_BGR2GRAY);
-                cvtColor(greyImage, displayFrame, COLOR_GRAY2BGR);
-            }
-            break;
-            
-        case MODE_GREYSCALE_CUSTOM:
-            if (greyscale(frame, displayFrame) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_SEPIA:
-            if (sepiaTone(frame, displayFrame, true) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_BLUR:
-            if (blur5x5_2(frame, displayFrame) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_SOBEL_X:
-            if (sobelX3x3(frame, sobelX) != 0) {
-                displayFrame = frame.clone();
-            } else {
-                // Scale by 2 and add 128 offset to center around gray
-                convertScaleAbs(sobelX, displayFrame, 2.0, 128.0);
-            }
-            break;
-            
-        case MODE_SOBEL_Y:
-            if (sobelY3x3(frame, sobelY) != 0) {
-                displayFrame = frame.clone();
-            } else {
-                // Scale by 2 and add 128 offset to center around gray
-                convertScaleAbs(sobelY, displayFrame, 2.0, 128.0);
-            }
-            break;
-            
-        case MODE_MAGNITUDE:
-            if (sobelX3x3(frame, sobelX) != 0 || sobelY3x3(frame, sobelY) != 0) {
-                displayFrame = frame.clone();
-            } else {
-                Mat magTemp;
-                if (magnitude(sobelX, sobelY, magTemp) != 0) {
-                    displayFrame = frame.clone();
-                } else {
-                    // Magnitude doesn't need offset, just scaling
-                    convertScaleAbs(magTemp, displayFrame, 4.0, 0);
-                }
-            }
-            break;
-            
-        case MODE_QUANTIZE:
-            if (blurQuantize(frame, displayFrame, quantizeLevels) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_FACE_DETECT:
-            {
-                Mat grey;
-                cvtColor(frame, grey, COLOR_BGR2GRAY);
-                vector<Rect> faces;
-                detectFaces(grey, faces);
-                displayFrame = frame.clone();
-                drawBoxes(displayFrame, faces);
-            }
-            break;
-            
-        case MODE_DEPTH:
-            if (!depthMap.empty()) {
-                Mat inverted;
-                cv::subtract(255, depthMap, inverted);
-                cv::applyColorMap(inverted, displayFrame, COLORMAP_INFERNO);
-            } else {
-                displayFrame = frame.clone();
-                putText(displayFrame, "Depth not available", 
-                       Point(50, frame.rows/2),
-                       FONT_HERSHEY_SIMPLEX, 1.0, Scalar(0, 0, 255), 2);
-            }
-            break;
-            
-        case MODE_DEPTH_FOG:
-            if (!depthMap.empty()) {
-                Mat invertedDepth;
-                cv::subtract(255, depthMap, invertedDepth);
-                if (depthFog(frame, invertedDepth, displayFrame, 3.0f) != 0) {
-                    displayFrame = frame.clone();
-                }
-            } else {
-                displayFrame = frame.clone();
-                putText(displayFrame, "Depth not available", 
-                       Point(50, frame.rows/2),
-                       FONT_HERSHEY_SIMPLEX, 1.0, Scalar(0, 0, 255), 2);
-            }
-            break;
+    if (mode < 0 || mode >= MODE_COUNT || MODE_PRESETS[mode](graph, params, displayFrame) != 0) {
+        graph.color().copyTo(displayFrame);
+    }
+    
+    return 0;
+}
 
-        case MODE_EMBOSS:
-            if (embossEffect(frame, displayFrame) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_NEGATIVE:
-            if (negativeEffect(frame, displayFrame) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
+/**
+ * @brief True for the modes that read the depth map.
+ */
+static bool modeNeedsDepth(DisplayMode mode) {
+    return mode == MODE_DEPTH || mode == MODE_DEPTH_FOG ||
+           mode == MODE_DEPTH_FOCUS || mode == MODE_FACE_FOG;
+}
 
-        case MODE_FACE_HIGHLIGHT:
-            {
-                Mat grey;
-                cvtColor(frame, grey, COLOR_BGR2GRAY);
-                vector<Rect> faces;
-                detectFaces(grey, faces);
-                
-                if (faceHighlight(frame, displayFrame, faces) != 0) {
-                    displayFrame = frame.clone();
-                }
-            }
-            break;
+/**
+ * @brief Maps a mode key (see printControls) to its display mode.
+ *
+ * @param key Key returned by waitKey
+ * @param mode Set to the selected mode if the key selects one
+ * @return true if the key selects a mode
+ */
+static bool modeForKey(char key, DisplayMode &mode) {
+    switch (key) {
+        // Basic modes
+        case 'c': case 'C': mode = MODE_COLOR; break;
+        case 'g': case 'G': mode = MODE_GREYSCALE_CV; break;
+        case 'h': case 'H': mode = MODE_GREYSCALE_CUSTOM; break;
+        case 't': case 'T': mode = MODE_SEPIA; break;
+        case 'b': case 'B': mode = MODE_BLUR; break;
+        case 'x': case 'X': mode = MODE_SOBEL_X; break;
+        case 'y': case 'Y': mode = MODE_SOBEL_Y; break;
+        case 'm': case 'M': mode = MODE_MAGNITUDE; break;
+        case 'l': case 'L': mode = MODE_QUANTIZE; break;
+        case 'f': case 'F': mode = MODE_FACE_DETECT; break;
+        case 'd': case 'D': mode = MODE_DEPTH; break;
+        // Custom effects (Task 12)
+        case '1': mode = MODE_DEPTH_FOG; break;
+        case '2': mode = MODE_EMBOSS; break;
+        case '3': mode = MODE_NEGATIVE; break;
+        case '4': mode = MODE_FACE_HIGHLIGHT; break;
+        case '5': mode = MODE_CARTOON; break;
+        case '6': mode = MODE_DEPTH_FOCUS; break;
+        // Warp effects (Extension)
+        case '7': mode = MODE_BULGE; break;
+        case '8': mode = MODE_WAVE; break;
+        case '9': mode = MODE_SWIRL; break;
+        case '0': mode = MODE_FACE_BULGE; break;
+        case '[': case '{': mode = MODE_SPARKLES; break;
+        case ']': case '}': mode = MODE_FACE_FOG; break;
+        case '\\': case '|': mode = MODE_CARTOON_SPARKLES; break;
+        case ';': case ':': mode = MODE_SEPIA_NEGATIVE; break;
+        case '\'': case '"': mode = MODE_GREY_QUANTIZE; break;
+        default: return false;
+    }
+    return true;
+}
 
-        case MODE_CARTOON:
-            if (cartoonEffect(frame, displayFrame) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
+/**
+ * @brief Logs a mode switch; warp modes also show the current strength.
+ */
+static void printMode(DisplayMode mode, float warpStrength) {
+    cout << "Mode: " << getModeString(mode);
+    if (mode == MODE_BULGE || mode == MODE_WAVE || mode == MODE_SWIRL || mode == MODE_FACE_BULGE) {
+        cout << " (strength: " << warpStrength << ")";
+    }
+    cout << endl;
+}
 
-        case MODE_DEPTH_FOCUS:
-            if (!depthMap.empty()) {
-                if (depthFocus(frame, depthMap, displayFrame, 200, 40) != 0) {
-                    displayFrame = frame.clone();
-                }
+#ifdef USE_ONNXRUNTIME
+/**
+ * @brief Loads and warms up the depth network selected on the command line.
+ *
+ * @param argc Number of command line arguments
+ * @param argv argv[2] = model variant ("fp16", "int8" or a path),
+ *             argv[3] = provider chain
+ * @param inputSize Frame size used for the warm-up run
+ * @return The network, or nullptr if it could not be loaded
+ */
+static DA2Network *createDepthNetwork(int argc, char *argv[], const Size &inputSize) {
+    try {
+        string modelPath = "model_fp16.onnx";
+        if (argc > 2) {
+            string variant = argv[2];
+            if (variant == "fp16" || variant == "int8") {
+                modelPath = "model_" + variant + ".onnx";
             } else {
-                displayFrame = frame.clone();
-                putText(displayFrame, "Depth not available", 
-                       Point(50, frame.rows/2),
-                       FONT_HERSHEY_SIMPLEX, 1.0, Scalar(0, 0, 255), 2);
+                modelPath = variant;
             }
-            break;
-
-        // === WARP EFFECTS (Extension) ===
+        }
         
-        case MODE_BULGE:
-            if (bulgeEffect(frame, displayFrame, warpStrength) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_WAVE:
-            // amplitude = warpStrength * 20, frequency based on strength
-            if (waveEffect(frame, displayFrame, warpStrength * 20.0f, 0.02f + warpStrength * 0.03f) != 0) {
-                displayFrame = frame.clone();
-            }
-            break;
-            
-        case MODE_SWIRL:
-            // angle = warpStrength * 4 radians
-            if (swirlEffect(frame, displayFrame, warpStrength * 4.0f) != 0) {
-                displayFrame = frame.clone();
+        DA2Options depthOptions;
+        if (argc > 3 && !depthOptions.parseProviders(argv[3])) {
+            cerr << "Warning: Unknown provider list '" << argv[3] << "', using default" << endl;
+        }
+        
+        DA2Network *depthNet = new DA2Network(modelPath.c_str(), depthOptions);
+        cout << "Depth Anything V2 network initialized (" << modelPath << ", "
+             << depthNet->provider_name() << ")" << endl;
+        
+        // Warm up at the live input size so the first depth frame doesn't stall
+        depthNet->warmup(inputSize);
+        return depthNet;
+    } catch (const exception& e) {
+        cerr << "Warning: Could not load depth network: " << e.what() << endl;
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Starts loading the depth network on a background thread.
+ *
+ * The live feed starts at once; depth modes show the model's status until
+ * it is ready.
+ */
+static void startDepthNetwork(cvcore::Asset<DA2Network> &depthModel, int argc, char *argv[],
+                              const Size &inputSize) {
+    depthModel.start("Depth model", [argc, argv, inputSize] {
+        return unique_ptr<DA2Network>(createDepthNetwork(argc, argv, inputSize));
+    });
+}
+
+/**
+ * @brief Draws a one-line status (e.g. "Depth model: loading (1.2 s)") at the bottom left.
+ */
+static void drawAssetStatus(Mat &frame, const cvcore::AssetLoad &asset) {
+    const string text = asset.status();
+    const Point org(10, frame.rows - 12);
+    putText(frame, text, org, FONT_HERSHEY_SIMPLEX, 0.6, Scalar(0, 0, 0), 3, LINE_AA);
+    putText(frame, text, org, FONT_HERSHEY_SIMPLEX, 0.6, Scalar(0, 220, 255), 1, LINE_AA);
+}
+#endif
+
+/**
+ * @brief Prints one line of counters per camera.
+ */
+static void printCameraStats(const vector<CameraStats> &stats) {
+    cout << "\n=== Camera Statistics ===" << endl;
+    for (const CameraStats &s : stats) {
+        cout << "Camera " << s.cameraIndex << ": capture " << s.captureFps << " fps, filter "
+             << s.processFps << " fps, frames " << s.captured << "/" << s.processed
+             << ", drops capture " << s.captureDrops << " display " << s.displayDrops << endl;
+    }
+    cout << "=========================\n" << endl;
+}
+
+/**
+ * @brief Multi-camera mode: one capture and one filter thread per camera.
+ *
+ * All cameras run the same display mode, each with its own frame graph,
+ * face tracker and particle pool. Depth modes share one batched DepthServer,
+ * created once the depth network has loaded in the background.
+ * The main thread tiles the newest output of every camera into one window;
+ * each tile shows that camera's capture/filter rates and drop counts, so a
+ * camera whose filter rate falls below its capture rate is the bottleneck.
+ *
+ * @param cameras Device indices
+ * @param argc Number of command line arguments (depth model options)
+ * @param argv Command line arguments
+ * @return 0 on success, -1 on error
+ */
+static int runMultiCamera(const vector<int> &cameras, int argc, char *argv[]) {
+    const int n = (int)cameras.size();
+    vector<unique_ptr<CameraWorker>> workers;
+    for (int i = 0; i < n; i++) {
+        workers.push_back(unique_ptr<CameraWorker>(new CameraWorker(i, cameras[i])));
+        if (workers.back()->open() != 0) {
+            return -1;
+        }
+        Size size = workers.back()->frameSize();
+        cout << "Camera " << cameras[i] << ": " << size.width << " x " << size.height << endl;
+    }
+    
+    // Settings shared with the filter threads
+    atomic<int> currentMode(MODE_COLOR);
+    atomic<int> quantizeLevels(10);
+    atomic<float> warpStrength(0.5f);
+    atomic<int> cartoonScale(1);
+    atomic<int> sparkleCount(12);
+    vector<SparklePool> sparkles(n);
+    auto startTime = high_resolution_clock::now();
+    
+    #ifdef USE_ONNXRUNTIME
+    cvcore::Asset<DA2Network> depthModel;
+    startDepthNetwork(depthModel, argc, argv, workers[0]->frameSize());
+    atomic<DepthServer *> depthServer(nullptr);   // read by the filter threads
+    #else
+    (void)argc;
+    (void)argv;
+    #endif
+    
+    CameraFilter filter = [&](int slot, FrameGraph &graph, Mat &dst) {
+        duration<float> elapsed = high_resolution_clock::now() - startTime;
+        EffectParams params = {quantizeLevels.load(), warpStrength.load(), elapsed.count(),
+                               cartoonScale.load(), sparkleCount.load(), &sparkles[slot]};
+        return processFrame(graph, dst, (DisplayMode)currentMode.load(), params);
+    };
+    
+    CameraDepthSource depth = [&](int slot, const Mat &frame) -> shared_ptr<const Mat> {
+        #ifdef USE_ONNXRUNTIME
+        DepthServer *server = depthServer.load();
+        if (server != nullptr && modeNeedsDepth((DisplayMode)currentMode.load())) {
+            server->submit(slot, frame);
+            shared_ptr<const Mat> result = server->latest(slot);
+            if (result && result->size() == frame.size()) {
+                return result;
             }
+        }
+        #else
+        (void)slot;
+        (void)frame;
+        #endif
+        return nullptr;
+    };
+    
+    for (unique_ptr<CameraWorker> &w : workers) {
+        w->start(filter, depth);
+    }
+    
+    printControls();
+    cout << "Multi-camera mode: " << n << " cameras (mode keys, +/-, k, i, q)" << endl;
+    VideoWindow window("Multi-Camera Display");
+    
+    // Tiles keep the last output of a camera until it delivers a new one
+    const Size tileSize(640, 480);
+    vector<Mat> tiles(n);
+    vector<CameraStats> stats(n);
+    Mat canvas;
+    
+    while (true) {
+        for (int i = 0; i < n; i++) {
+            workers[i]->takeOutput(tiles[i]);
+            stats[i] = workers[i]->stats();
+        }
+        composeTiles(tiles, stats, tileSize, canvas);
+        #ifdef USE_ONNXRUNTIME
+        if (depthServer.load() == nullptr && depthModel.ready()) {
+            depthServer = new DepthServer(depthModel.get(), n, 1.0f, n);
+        }
+        if (depthServer.load() == nullptr && modeNeedsDepth((DisplayMode)currentMode.load())) {
+            drawAssetStatus(canvas, depthModel);
+        }
+        #endif
+        window.show(canvas);
+        
+        char key = (char)window.waitKey(10);
+        if (key == -1) continue;
+        
+        DisplayMode mode = (DisplayMode)currentMode.load();
+        if (key == 'q' || key == 'Q' || key == 27) {
             break;
-            
-        case MODE_FACE_BULGE:
-            {
-                Mat grey;
-                cvtColor(frame, grey, COLOR_BGR2GRAY);
-                vector<Rect> faces;
-                detectFaces(grey, faces);
-                
-                if (faceBulgeEffect(frame, displayFrame, faces, warpStrength) != 0) {
-                    displayFrame = frame.clone();
-                }
+        }
+        else if (key == 'i' || key == 'I') {
+            printCameraStats(stats);
+            #ifdef USE_ONNXRUNTIME
+            DepthServer *server = depthServer.load();
+            if (server != nullptr) {
+                cout << "Depth batch: " << server->lastBatchSize() << " frame(s) in "
+                     << server->lastBatchMs() << " ms"
+                     << (server->batching() ? "" : " (model does not batch)") << "\n" << endl;
+            } else {
+                cout << depthModel.status() << "\n" << endl;
             }
-            break;
-
-        case MODE_SPARKLES:
-            {
-                Mat grey;
-                cvtColor(frame, grey, COLOR_BGR2GRAY);
-                vector<Rect> faces;
-                detectFaces(grey, faces);
-                
-                if (sparkleEffect(frame, displayFrame, faces, sparkles, time) != 0) {
-                    displayFrame = frame.clone();
-                }
+            #endif
+        }
+        else if (key == 'p' || key == 'P') {
+            printControls();
+        }
+        else if (modeForKey(key, mode)) {
+            currentMode = mode;
+            printMode(mode, warpStrength.load());
+        }
+        else if (key == '+' || key == '=' || key == '-' || key == '_') {
+            bool up = (key == '+' || key == '=');
+            if (mode == MODE_QUANTIZE || mode == MODE_GREY_QUANTIZE) {
+                quantizeLevels = up ? std::min(25, quantizeLevels + 1) : std::max(2, quantizeLevels - 1);
+                cout << "Quantize levels: " << quantizeLevels << endl;
+            } else if (mode == MODE_SPARKLES || mode == MODE_CARTOON_SPARKLES) {
+                sparkleCount = up ? std::min(3072, sparkleCount * 2) : std::max(12, sparkleCount / 2);
+                cout << "Sparkles per face: " << sparkleCount << endl;
+            } else {
+                float w = warpStrength.load() + (up ? 0.1f : -0.1f);
+                warpStrength = std::max(0.1f, std::min(1.0f, w));
+                cout << "Warp strength: " << warpStrength << endl;
             }
-            break;
-
-        default:
-            displayFrame = frame.clone();
+        }
+        else if (key == 'k' || key == 'K') {
+            cartoonScale = (cartoonScale >= 4) ? 1 : cartoonScale * 2;
+            cout << "Cartoon processing scale: 1/" << cartoonScale << endl;
+        }
+    }
+    
+    // Stop the cameras before the depth server they submit to
+    for (unique_ptr<CameraWorker> &w : workers) {
+        w->stop();
     }
+    for (int i = 0; i < n; i++) {
+        stats[i] = workers[i]->stats();
+    }
+    printCameraStats(stats);
+    
+    #ifdef USE_ONNXRUNTIME
+    delete depthServer.load();
+    #endif
     
     return 0;
 }
@@ -385,11 +739,15 @@ int processFrame(Mat &frame, Mat &displayFrame, DisplayMode mode,
  * Supports optional depth estimation via ONNX Runtime if compiled with USE_ONNXRUNTIME.
  * 
  * @param argc Number of command line arguments
- * @param argv Command line arguments (argv[1] = optional camera index)
+ * @param argv Command line arguments (argv[1] = optional camera index, video
+ *             file, stream URL or image sequence, or a comma separated
+ *             camera list such as "0,1,2,3" for multi-camera mode,
+ *             argv[2] = optional depth model: "fp16" (default), "int8" or a path,
+ *             argv[3] = optional provider chain, e.g. "tensorrt,cuda,cpu")
  * @return 0 on successful execution, -1 on error
  * 
  * Main Loop:
- * 1. Capture frame from camera
+ * 1. Take the newest frame from the capture thread
  * 2. Update animation time
  * 3. Compute depth map if needed
  * 4. Process frame with current effect
@@ -400,68 +758,132 @@ int main(int argc, char* argv[]) {
     cout << "=== Video Display Application ===" << endl;
     cout << "Tasks 2-12 + Extensions: Live video with filters\n" << endl;
     
-    int cameraIndex = 0;
-    if (argc > 1) {
-        cameraIndex = atoi(argv[1]);
-        cout << "Using camera index: " << cameraIndex << endl;
-    }
+    // Frame-sized Mats come from a huge-page pool instead of fresh mappings
+    cvcore::installMatPool();
     
-    VideoCapture capdev(cameraIndex);
+    if (argc > 1 && string(argv[1]).find(',') != string::npos) {
+        vector<int> cameras;
+        if (parseCameraList(argv[1], cameras) != 0) {
+            cerr << "Error: Invalid camera list '" << argv[1] << "'" << endl;
+            return -1;
+        }
+        return runMultiCamera(cameras, argc, argv);
+    }
+    // Camera 0 by default; any cvcore::FrameSource spec otherwise
+    unique_ptr<cvcore::FrameSource> source = cvcore::FrameSource::open(argc > 1 ? argv[1] : "");
     
-    if (!capdev.isOpened()) {
+    if (!source) {
         cerr << "Error: Unable to open video device" << endl;
         return -1;
     }
     
-    Size refS((int)capdev.get(CAP_PROP_FRAME_WIDTH),
-              (int)capdev.get(CAP_PROP_FRAME_HEIGHT));
-    double fps = capdev.get(CAP_PROP_FPS);
+    Size refS = source->frameSize();
+    double fps = source->fps();
     
-    cout << "Video device opened successfully!" << endl;
+    cout << "Video source opened: " << source->description() << endl;
     cout << "Frame size: " << refS.width << " x " << refS.height << endl;
     cout << "Camera FPS: " << fps << endl;
     
     printControls();
     
-    namedWindow("Video Display", WINDOW_AUTOSIZE);
+    // OpenGL presenter when built with GLFW, HighGUI otherwise
+    VideoWindow window("Video Display");
+    cout << "Display: " << window.description() << endl;
     
     // State variables
     DisplayMode currentMode = MODE_COLOR;
-    Mat frame, displayFrame;
-    Mat sobelX, sobelY;
+    CapturedFrame captured;     // Newest frame from the capture thread
+    Mat &frame = captured.image;
+    Mat displayFrame;
+    FrameGraph graph;
+    FaceTracker faceTracker(5);  // Cascade every 5 frames, optical flow between
+    graph.setFaceTracker(&faceTracker);
     int frameCount = 0;
     int savedCount = 0;
     int quantizeLevels = 10;
     float warpStrength = 0.5f;  // Adjustable warp strength [0.1 - 1.0]
+    int cartoonScale = 1;       // Cartoon color path at 1/1, 1/2 or 1/4 resolution
+    int sparkleCount = 12;      // Sparkle particles per face [12 - 3072]
+    long poolAllocations = 0;   // FramePool misses seen so far
+    int lastPoolAllocFrame = 0; // Frame of the most recent pool allocation
     
     // Sparkle animation variables
-    vector<vector<Sparkle>> sparkles;
+    SparklePool sparkles;
     auto startTime = high_resolution_clock::now();
     
     // Depth estimation variables
     #ifdef USE_ONNXRUNTIME
-    DA2Network* depthNet = nullptr;
+    cvcore::Asset<DA2Network> depthModel;    // Loaded in the background
+    AsyncDepthEstimator* asyncDepth = nullptr;
+    shared_ptr<const DepthFrame> depthResult;  // Key frame last given to the upsampler
+    DepthUpsampler depthUpsampler;
     #endif
     Mat depthMap;
     
     #ifdef USE_ONNXRUNTIME
-    try {
-        depthNet = new DA2Network("model_fp16.onnx");
-        cout << "Depth Anything V2 network initialized with GPU!" << endl;
-    } catch (const exception& e) {
-        cerr << "Warning: Could not load depth network: " << e.what() << endl;
-        depthNet = nullptr;
+    const Size depthInputSize(cvRound(refS.width * DEPTH_INPUT_SCALE),
+                              cvRound(refS.height * DEPTH_INPUT_SCALE));
+    startDepthNetwork(depthModel, argc, argv, depthInputSize);
+    #endif
+    
+    // Latency profiler: one stage per pipeline step, one per filter mode
+    Profiler profiler;
+    const int frameStage = profiler.stage("frame");
+    const int captureStage = profiler.stage("capture");
+    const int presentStage = profiler.stage("present");
+    const int keyStage = profiler.stage("key input");
+    const int latencyStage = profiler.stage("capture to display");
+    vector<int> modeStages(MODE_COUNT);
+    for (int m = 0; m < MODE_COUNT; m++) {
+        modeStages[m] = profiler.stage("process: " + getModeString((DisplayMode)m));
     }
+    bool showProfiler = false;
+    bool profilerUsed = false;
+    #ifdef USE_ONNXRUNTIME
+    const int depthStage = profiler.stage("depth (async)", 1);
+    const int upsampleStage = profiler.stage("depth upsample");
+    long lastDepthCount = 0;
     #endif
     
+    // Stage latencies reach the metrics through the profiler; exported only
+    // when CVCORE_METRICS_PORT or CVCORE_STATSD is set
+    cvcore::startMetricsFromEnvironment("vidDisplay");
+    cvcore::MetricsRegistry& metrics = cvcore::MetricsRegistry::global();
+    cvcore::Counter& framesMetric = metrics.counter("vfx_frames_total", "Frames processed");
+    cvcore::Counter& captureDropMetric = metrics.counter(
+        "vfx_dropped_frames_total", "Frames dropped before use", "queue=\"capture\"");
+    cvcore::Counter& writerDropMetric = metrics.counter(
+        "vfx_dropped_frames_total", "Frames dropped before use", "queue=\"writer\"");
+    cvcore::Gauge& writerQueueMetric = metrics.gauge(
+        "vfx_queue_depth", "Frames waiting in a queue", "queue=\"writer\"");
+    #ifdef USE_ONNXRUNTIME
+    cvcore::Counter& depthDropMetric = metrics.counter(
+        "vfx_dropped_frames_total", "Frames dropped before use", "queue=\"depth\"");
+    #endif
+    
+    // The camera is read on its own thread; the loop takes the newest frame
+    CaptureThread captureThread(*source);
+    if (captureThread.start() != 0) {
+        return -1;
+    }
+    
+    // Snapshots and recordings are encoded on the writer's thread
+    FrameWriter writer;
+    
     cout << "Starting video capture... Current mode: " << getModeString(currentMode) << endl;
     cout << "Warp strength: " << warpStrength << " (adjust with +/-)" << endl;
     
     // Main video loop
     while (true) {
-        capdev >> frame;
+        double frameStartUs = profiler.nowUs();
+        bool gotFrame;
+        {
+            // Waits only if the newest frame was already processed
+            ScopedTimer t(profiler, captureStage);
+            gotFrame = captureThread.next(captured);
+        }
         
-        if (frame.empty()) {
+        if (!gotFrame || frame.empty()) {
             cerr << "Error: Frame is empty" << endl;
             break;
         }
@@ -473,89 +895,222 @@ int main(int argc, char* argv[]) {
         duration<float> elapsed = currentTime - startTime;
         float time = elapsed.count();
         
-        // Compute depth when needed
+        // Hand frames to the async depth stage when needed; the most recent
+        // finished map becomes the upsampler's key frame and is warped to
+        // every frame until the next one. Inference never blocks this loop
         #ifdef USE_ONNXRUNTIME
-        bool needsDepth = (currentMode == MODE_DEPTH || currentMode == MODE_DEPTH_FOG ||
-                          currentMode == MODE_DEPTH_FOCUS);
+        if (asyncDepth == nullptr && depthModel.ready()) {
+            // Inference runs on its own thread at network resolution; the loop
+            // reads the latest result and upsamples it to each frame
+            asyncDepth = new AsyncDepthEstimator(depthModel.get(), DEPTH_INPUT_SCALE, true);
+        }
+        if (asyncDepth != nullptr && modeNeedsDepth(currentMode)) {
+            asyncDepth->submit(frame);
+            shared_ptr<const DepthFrame> result = asyncDepth->latestFrame();
+            if (result && result != depthResult) {
+                depthResult = result;
+                depthUpsampler.update(result->depth, result->guide);
+            }
+            ScopedTimer t(profiler, upsampleStage);
+            depthUpsampler.render(frame, depthMap);
+        }
         
-        if (depthNet != nullptr && needsDepth) {
-            depthNet->set_input(frame, 1.0f);
-            depthNet->run_network(depthMap, frame.size());
+        // Inference runs on the depth thread; log each finished map here
+        if (asyncDepth != nullptr && asyncDepth->completedCount() != lastDepthCount) {
+            lastDepthCount = asyncDepth->completedCount();
+            double ms = asyncDepth->lastInferenceMs();
+            profiler.record(depthStage, profiler.nowUs() - ms * 1000.0, ms);
         }
         #endif
         
         // Process frame based on current mode
-        processFrame(frame, displayFrame, currentMode, sobelX, sobelY, 
-                    quantizeLevels, depthMap, warpStrength, sparkles, time);
+        {
+            ScopedTimer t(profiler, modeStages[currentMode]);
+            graph.beginFrame(frame, depthMap);
+            EffectParams params = {quantizeLevels, warpStrength, time, cartoonScale,
+                                   sparkleCount, &sparkles};
+            processFrame(graph, displayFrame, currentMode, params);
+        }
         
-        imshow("Video Display", displayFrame);
+        // Steady state must not allocate: remember when the pool last missed
+        if (FramePool::totalAllocations() != poolAllocations) {
+            poolAllocations = FramePool::totalAllocations();
+            lastPoolAllocFrame = frameCount;
+        }
         
-        char key = (char)waitKey(1);
+        #ifdef USE_ONNXRUNTIME
+        if (asyncDepth == nullptr && modeNeedsDepth(currentMode)) {
+            drawAssetStatus(displayFrame, depthModel);
+        }
+        #endif
         
-        if (key == -1) continue;
+        if (showProfiler) {
+            profiler.drawOverlay(displayFrame);
+        }
         
-        // Handle keyboard input
-        if (key == 'q' || key == 'Q' || key == 27) {
-            cout << "\nQuitting... Frames: " << frameCount << ", Saved: " << savedCount << endl;
-            break;
+        {
+            ScopedTimer t(profiler, presentStage);
+            window.show(displayFrame);
+        }
+        double latencyMs = captured.ageMs();
+        profiler.record(latencyStage, profiler.nowUs() - latencyMs * 1000.0, latencyMs);
+        
+        char key;
+        {
+            ScopedTimer t(profiler, keyStage);
+            key = (char)window.waitKey(1);
+        }
+        profiler.record(frameStage, frameStartUs, (profiler.nowUs() - frameStartUs) / 1000.0);
+        
+        // Drop counts are cumulative; the counters take the difference
+        framesMetric.inc();
+        captureDropMetric.inc(captureThread.droppedCount() - captureDropMetric.value());
+        FrameWriterStats writerStats = writer.stats();
+        writerDropMetric.inc(writerStats.dropped - writerDropMetric.value());
+        writerQueueMetric.set(writerStats.queued);
+        #ifdef USE_ONNXRUNTIME
+        if (asyncDepth != nullptr) {
+            depthDropMetric.inc(asyncDepth->droppedCount() - depthDropMetric.value());
         }
-        else if (key == 's' || key == 'S') {
+        #endif
+        
+        // Hand the shown frame to the writer thread (buffers are swapped, so
+        // displayFrame is refilled next frame); a snapshot taken while
+        // recording gets its own copy
+        if (key == 's' || key == 'S') {
             string modePrefix = getModeString(currentMode);
             modePrefix.erase(remove(modePrefix.begin(), modePrefix.end(), ' '), modePrefix.end());
             modePrefix.erase(remove(modePrefix.begin(), modePrefix.end(), '('), modePrefix.end());
             modePrefix.erase(remove(modePrefix.begin(), modePrefix.end(), ')'), modePrefix.end());
             string filename = generateTimestampFilename("frame_" + modePrefix, ".jpg");
             
-            if (imwrite(filename, displayFrame)) {
+            Mat shot = writer.recording() ? displayFrame.clone() : Mat();
+            if (writer.saveImage(shot.empty() ? displayFrame : shot, filename)) {
                 savedCount++;
-                cout << "Saved: " << filename << endl;
+            } else {
+                cout << "Snapshot dropped: writer queue full (" << writer.status() << ")" << endl;
+            }
+        }
+        if (writer.recording()) {
+            writer.record(displayFrame);
+            if (frameCount % 15 == 0) {
+                window.setTitle("Video Display - " + writer.status());
+            }
+        }
+        
+        if (key == -1) continue;
+        
+        // Handle keyboard input
+        if (key == 'q' || key == 'Q' || key == 27) {
+            cout << "\nQuitting... Frames: " << frameCount << ", Saved: " << savedCount << endl;
+            break;
+        }
+        else if (key == 'v' || key == 'V') {
+            if (writer.recording()) {
+                writer.stopRecording();
+                window.setTitle("Video Display");
+                cout << "Recording stopped (" << writer.status() << ")" << endl;
+            } else {
+                writer.startRecording(generateTimestampFilename("video", ".mp4"), fps);
+                cout << "Recording started (v to stop)" << endl;
             }
         }
         else if (key == 'i' || key == 'I') {
-            displayVideoInfo(displayFrame, frameCount, savedCount, fps, currentMode);
+            // displayFrame may have been handed to the recorder; describe the camera frame
+            displayVideoInfo(frame, frameCount, savedCount, fps, currentMode, profiler);
+            cout << "Frame writer: " << writer.status() << ", last encode "
+                 << writer.stats().lastEncodeMs << " ms" << endl;
+            cout << "Frame pool: " << poolAllocations << " buffer allocations, last at frame "
+                 << lastPoolAllocFrame << " (" << (frameCount - lastPoolAllocFrame)
+                 << " frames allocation-free)" << endl;
+            if (cvcore::matPoolInstalled()) {
+                cvcore::MatPoolStats pool = cvcore::matPoolStats();
+                cout << "Mat pool: " << pool.hits << " hits, " << pool.misses << " misses, "
+                     << pool.mappedBytes / (1024 * 1024) << " MB mapped ("
+                     << pool.hugeBytes / (1024 * 1024) << " MB huge pages)" << endl;
+            }
+            cout << "Capture thread: " << captureThread.capturedCount() << " frames read, "
+                 << captureThread.droppedCount() << " dropped (newest frame wins)" << endl;
+            cout << "Last frame: #" << captured.sequence << ", " << captured.ageMs()
+                 << " ms since capture";
+            if (captured.deviceMs >= 0.0) {
+                cout << ", device timestamp " << captured.deviceMs << " ms";
+            }
+            cout << "\n" << endl;
+            #ifdef USE_ONNXRUNTIME
+            if (asyncDepth != nullptr) {
+                cout << "Depth interval: every " << asyncDepth->interval() << " frame(s)" << endl;
+                cout << "Depth maps computed: " << asyncDepth->completedCount()
+                     << ", dropped frames: " << asyncDepth->droppedCount() << endl;
+                cout << "Last depth inference: " << asyncDepth->lastInferenceMs() << " ms" << endl;
+                cout << "Depth upsampling: " << depthUpsampler.lastRenderMs() << " ms, motion compensation "
+                     << (depthUpsampler.motionCompensation() ? "on" : "off") << "\n" << endl;
+            }
+            #endif
         }
         else if (key == 'p' || key == 'P') {
             printControls();
         }
-        // Basic modes
-        else if (key == 'c' || key == 'C') { currentMode = MODE_COLOR; cout << "Mode: Color" << endl; }
-        else if (key == 'g' || key == 'G') { currentMode = MODE_GREYSCALE_CV; cout << "Mode: Greyscale (CV)" << endl; }
-        else if (key == 'h' || key == 'H') { currentMode = MODE_GREYSCALE_CUSTOM; cout << "Mode: Greyscale (Custom)" << endl; }
-        else if (key == 't' || key == 'T') { currentMode = MODE_SEPIA; cout << "Mode: Sepia" << endl; }
-        else if (key == 'b' || key == 'B') { currentMode = MODE_BLUR; cout << "Mode: Blur" << endl; }
-        else if (key == 'x' || key == 'X') { currentMode = MODE_SOBEL_X; cout << "Mode: Sobel X" << endl; }
-        else if (key == 'y' || key == 'Y') { currentMode = MODE_SOBEL_Y; cout << "Mode: Sobel Y" << endl; }
-        else if (key == 'm' || key == 'M') { currentMode = MODE_MAGNITUDE; cout << "Mode: Magnitude" << endl; }
-        else if (key == 'l' || key == 'L') { currentMode = MODE_QUANTIZE; cout << "Mode: Quantize" << endl; }
-        else if (key == 'f' || key == 'F') { currentMode = MODE_FACE_DETECT; cout << "Mode: Face Detect" << endl; }
-        else if (key == 'd' || key == 'D') { currentMode = MODE_DEPTH; cout << "Mode: Depth" << endl; }
-        // Custom effects (Task 12)
-        else if (key == '1') { currentMode = MODE_DEPTH_FOG; cout << "Mode: Depth Fog" << endl; }
-        else if (key == '2') { currentMode = MODE_EMBOSS; cout << "Mode: Emboss" << endl; }
-        else if (key == '3') { currentMode = MODE_NEGATIVE; cout << "Mode: Negative" << endl; }
-        else if (key == '4') { currentMode = MODE_FACE_HIGHLIGHT; cout << "Mode: Face Highlight" << endl; }
-        else if (key == '5') { currentMode = MODE_CARTOON; cout << "Mode: Cartoon" << endl; }
-        else if (key == '6') { currentMode = MODE_DEPTH_FOCUS; cout << "Mode: Depth Focus" << endl; }
-        // Warp effects (Extension)
-        else if (key == '7') { currentMode = MODE_BULGE; cout << "Mode: Bulge Warp (strength: " << warpStrength << ")" << endl; }
-        else if (key == '8') { currentMode = MODE_WAVE; cout << "Mode: Wave Warp (strength: " << warpStrength << ")" << endl; }
-        else if (key == '9') { currentMode = MODE_SWIRL; cout << "Mode: Swirl Warp (strength: " << warpStrength << ")" << endl; }
-        else if (key == '0') { currentMode = MODE_FACE_BULGE; cout << "Mode: Face Bulge (strength: " << warpStrength << ")" << endl; }
-        else if (key == '[' || key == '{') { currentMode = MODE_SPARKLES; cout << "Mode: Sparkles" << endl; }
+        // Display modes
+        else if (modeForKey(key, currentMode)) {
+            printMode(currentMode, warpStrength);
+        }
         // Adjustments
         else if (key == '+' || key == '=') {
-            if (currentMode == MODE_QUANTIZE) {
+            if (currentMode == MODE_QUANTIZE || currentMode == MODE_GREY_QUANTIZE) {
                 quantizeLevels = std::min(25, quantizeLevels + 1);
                 cout << "Quantize levels: " << quantizeLevels << endl;
+            } else if (currentMode == MODE_SPARKLES || currentMode == MODE_CARTOON_SPARKLES) {
+                sparkleCount = std::min(3072, sparkleCount * 2);
+                cout << "Sparkles per face: " << sparkleCount << endl;
             } else {
                 warpStrength = std::min(1.0f, warpStrength + 0.1f);
                 cout << "Warp strength: " << warpStrength << endl;
             }
         }
+        else if (key == 'r' || key == 'R') {
+            // Toggle between tracked faces and per-frame cascade detection
+            bool tracking = (faceTracker.detectInterval() == 1);
+            faceTracker.setDetectInterval(tracking ? 5 : 1);
+            faceTracker.reset();
+            cout << "Face tracking: " << (tracking ? "on (detect every 5 frames)" : "off (detect every frame)") << endl;
+        }
+        else if (key == 'k' || key == 'K') {
+            cartoonScale = (cartoonScale >= 4) ? 1 : cartoonScale * 2;
+            cout << "Cartoon processing scale: 1/" << cartoonScale << endl;
+        }
+        else if (key == 'o' || key == 'O') {
+            showProfiler = !showProfiler;
+            profilerUsed = true;
+            cout << "Profiler overlay: " << (showProfiler ? "on" : "off") << endl;
+        }
+        else if (key == 'n' || key == 'N') {
+            #ifdef USE_ONNXRUNTIME
+            if (asyncDepth != nullptr) {
+                int next = (asyncDepth->interval() >= 4) ? 1 : asyncDepth->interval() * 2;
+                asyncDepth->setInterval(next);
+                cout << "Depth interval: every " << next << " frame(s)" << endl;
+            }
+            #else
+            cout << "Depth estimation not available" << endl;
+            #endif
+        }
+        else if (key == 'u' || key == 'U') {
+            #ifdef USE_ONNXRUNTIME
+            depthUpsampler.setMotionCompensation(!depthUpsampler.motionCompensation());
+            cout << "Depth motion compensation: "
+                 << (depthUpsampler.motionCompensation() ? "on" : "off") << endl;
+            #else
+            cout << "Depth estimation not available" << endl;
+            #endif
+        }
         else if (key == '-' || key == '_') {
-            if (currentMode == MODE_QUANTIZE) {
+            if (currentMode == MODE_QUANTIZE || currentMode == MODE_GREY_QUANTIZE) {
                 quantizeLevels = std::max(2, quantizeLevels - 1);
                 cout << "Quantize levels: " << quantizeLevels << endl;
+            } else if (currentMode == MODE_SPARKLES || currentMode == MODE_CARTOON_SPARKLES) {
+                sparkleCount = std::max(12, sparkleCount / 2);
+                cout << "Sparkles per face: " << sparkleCount << endl;
             } else {
                 warpStrength = std::max(0.1f, warpStrength - 0.1f);
                 cout << "Warp strength: " << warpStrength << endl;
@@ -563,14 +1118,24 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    // Cleanup
+    // Dump the profile if it was looked at during this session
+    if (profilerUsed) {
+        string csvName = generateTimestampFilename("profile", ".csv");
+        string traceName = generateTimestampFilename("profile_trace", ".json");
+        if (profiler.writeCSV(csvName) == 0 && profiler.writeChromeTrace(traceName) == 0) {
+            cout << "Profile written: " << csvName << ", " << traceName << endl;
+        }
+    }
+    
+    // Cleanup (stop the depth thread before depthModel destroys its network)
+    captureThread.stop();
+    writer.stopRecording();
     #ifdef USE_ONNXRUNTIME
-    if (depthNet != nullptr) {
-        delete depthNet;
+    if (asyncDepth != nullptr) {
+        delete asyncDepth;
     }
     #endif
     
-    destroyAllWindows();
     cout << "Video capture closed." << endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 27, 2026
+  Purpose: Implementation of the video window (OpenGL presenter or HighGUI).
+*/
+
+#include "videoWindow.hpp"
+#include <opencv2/highgui.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+VideoWindow::VideoWindow(const std::string &title)
+    : title_(title),
+      opened_(false),
+      useGL_(false),
+      vsync_(true) {
+    const char *vsync = std::getenv("VFX_VSYNC");
+    vsync_ = !(vsync && std::strcmp(vsync, "0") == 0);
+#ifdef USE_GL_PRESENTER
+    const char *display = std::getenv("VFX_DISPLAY");
+    useGL_ = !(display && std::strcmp(display, "highgui") == 0);
+#endif
+}
+
+VideoWindow::~VideoWindow() {
+#ifdef USE_GL_PRESENTER
+    presenter_.close();
+#endif
+    if (opened_ && !useGL_) {
+        cv::destroyWindow(title_);
+    }
+}
+
+void VideoWindow::show(const cv::Mat &frame) {
+    if (!opened_) {
+        opened_ = true;
+#ifdef USE_GL_PRESENTER
+        if (useGL_ && !presenter_.open(title_, frame.size(), vsync_)) {
+            std::cerr << "OpenGL display unavailable, using HighGUI" << std::endl;
+            useGL_ = false;
+        }
+#endif
+        if (!useGL_) {
+            cv::namedWindow(title_, cv::WINDOW_AUTOSIZE);
+        }
+    }
+
+#ifdef USE_GL_PRESENTER
+    if (useGL_) {
+        presenter_.present(frame);
+        return;
+    }
+#endif
+    cv::imshow(title_, frame);
+}
+
+int VideoWindow::waitKey(int delayMs) {
+#ifdef USE_GL_PRESENTER
+    if (useGL_) {
+        // Closing the window quits like ESC
+        if (opened_ && !presenter_.isOpen()) {
+            return 27;
+        }
+        return presenter_.pollKey(delayMs > 1 ? delayMs : 0);
+    }
+#endif
+    return cv::waitKey(delayMs);
+}
+
+void VideoWindow::setTitle(const std::string &title) {
+#ifdef USE_GL_PRESENTER
+    if (useGL_) {
+        presenter_.setTitle(title);
+        return;
+    }
+#endif
+    if (opened_) {
+        cv::setWindowTitle(title_, title);
+    }
+}
+
+std::string VideoWindow::description() const {
+    if (useGL_) {
+        return std::string("OpenGL (vsync ") + (vsync_ ? "on" : "off") + ")";
+    }
+    return "HighGUI";
+}
@@ -0,0 +1,221 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: January 24, 2026
+  Purpose: Implementation of the remap table cache used by the warp effects.
+*/
+
+#include "warpMapCache.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+  Bulge table: r' = r^exponent inside 90% of the half-size circle,
+  identity elsewhere (see bulgeEffect in filters.cpp for the derivation)
+*/
+static void buildBulgeMap(cv::Size size, float strength, cv::Mat &mapXY) {
+    mapXY.create(size, CV_32FC2);
+
+    float cx = size.width / 2.0f;
+    float cy = size.height / 2.0f;
+    float radius = std::min(cx, cy) * 0.9f;
+    float exponent = 1.0f / (strength + 0.5f);
+
+    for (int y = 0; y < size.height; y++) {
+        cv::Vec2f* mapRow = mapXY.ptr<cv::Vec2f>(y);
+
+        for (int x = 0; x < size.width; x++) {
+            float dx = x - cx;
+            float dy = y - cy;
+            float dist = std::sqrt(dx * dx + dy * dy);
+
+            if (dist < radius && dist > 0.001f) {
+                float normalizedDist = dist / radius;
+                float scale = std::pow(normalizedDist, exponent) / normalizedDist;
+                mapRow[x] = cv::Vec2f(cx + dx * scale, cy + dy * scale);
+            } else {
+                mapRow[x] = cv::Vec2f(static_cast<float>(x), static_cast<float>(y));
+            }
+        }
+    }
+}
+
+/*
+  Wave table: the displacement is separable (x offset depends only on y,
+  y offset only on x), so the sines are evaluated once per row and once per
+  column into lookup tables and the map is filled from those.
+*/
+static void buildWaveMap(cv::Size size, float amplitude, float frequency, cv::Mat &mapXY) {
+    mapXY.create(size, CV_32FC2);
+
+    const float PI = 3.14159265358979f;
+
+    // Separable sine LUTs
+    std::vector<float> offsetX(size.height), offsetY(size.width);
+    for (int y = 0; y < size.height; y++) {
+        offsetX[y] = amplitude * std::sin(frequency * y * 2.0f * PI);
+    }
+    for (int x = 0; x < size.width; x++) {
+        offsetY[x] = amplitude * std::sin(frequency * x * 2.0f * PI);
+    }
+
+    // Out-of-range samples are clamped to the border, like waveEffect
+    const float maxX = static_cast<float>(size.width - 1);
+    const float maxY = static_cast<float>(size.height - 1);
+
+    for (int y = 0; y < size.height; y++) {
+        cv::Vec2f* mapRow = mapXY.ptr<cv::Vec2f>(y);
+        for (int x = 0; x < size.width; x++) {
+            float srcX = std::max(0.0f, std::min(maxX, x + offsetX[y]));
+            float srcY = std::max(0.0f, std::min(maxY, y + offsetY[x]));
+            mapRow[x] = cv::Vec2f(srcX, srcY);
+        }
+    }
+}
+
+/*
+  Swirl table: θ' = θ + angle * (1 - r/maxRadius)
+*/
+static void buildSwirlMap(cv::Size size, float angle, cv::Mat &mapXY) {
+    mapXY.create(size, CV_32FC2);
+
+    float cx = size.width / 2.0f;
+    float cy = size.height / 2.0f;
+    float maxRadius = std::sqrt(cx * cx + cy * cy);
+
+    for (int y = 0; y < size.height; y++) {
+        cv::Vec2f* mapRow = mapXY.ptr<cv::Vec2f>(y);
+
+        for (int x = 0; x < size.width; x++) {
+            float dx = x - cx;
+            float dy = y - cy;
+            float dist = std::sqrt(dx * dx + dy * dy);
+
+            float theta = angle * (1.0f - dist / maxRadius);
+            float cosTheta = std::cos(theta);
+            float sinTheta = std::sin(theta);
+
+            mapRow[x] = cv::Vec2f(cx + dx * cosTheta - dy * sinTheta,
+                                  cy + dx * sinTheta + dy * cosTheta);
+        }
+    }
+}
+
+/*
+  Face bulge table: local to the face rectangle. Coordinates are relative to
+  the face's top-left corner, so one table serves every face of the same size
+  regardless of where it is in the frame.
+*/
+static void buildFaceBulgeMap(cv::Size faceSize, float strength,
+                              cv::Mat &mapXY, cv::Mat &mask, cv::Point &origin) {
+    float exponent = 1.0f / (strength + 0.5f);
+
+    float cx = faceSize.width / 2.0f;
+    float cy = faceSize.height / 2.0f;
+    float radius = std::max(faceSize.width, faceSize.height) * 0.75f;
+
+    // Bounding box of the bulge circle, relative to the face corner
+    int x0 = static_cast<int>(std::floor(cx - radius));
+    int y0 = static_cast<int>(std::floor(cy - radius));
+    int x1 = static_cast<int>(std::ceil(cx + radius));
+    int y1 = static_cast<int>(std::ceil(cy + radius));
+    origin = cv::Point(x0, y0);
+
+    mapXY.create(y1 - y0 + 1, x1 - x0 + 1, CV_32FC2);
+    mask = cv::Mat::zeros(mapXY.size(), CV_8UC1);
+
+    for (int j = 0; j < mapXY.rows; j++) {
+        cv::Vec2f* mapRow = mapXY.ptr<cv::Vec2f>(j);
+        uchar* maskRow = mask.ptr<uchar>(j);
+        float y = static_cast<float>(y0 + j);
+
+        for (int i = 0; i < mapXY.cols; i++) {
+            float x = static_cast<float>(x0 + i);
+            float dx = x - cx;
+            float dy = y - cy;
+            float dist = std::sqrt(dx * dx + dy * dy);
+
+            if (dist < radius && dist > 0.001f) {
+                float normalizedDist = dist / radius;
+                float scale = std::pow(normalizedDist, exponent) / normalizedDist;
+                mapRow[i] = cv::Vec2f(cx + dx * scale, cy + dy * scale);
+                maskRow[i] = 255;
+            } else {
+                mapRow[i] = cv::Vec2f(x, y);
+            }
+        }
+    }
+}
+
+WarpMapCache::WarpMapCache(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)),
+      clock_(0) {
+}
+
+WarpMaps WarpMapCache::get(WarpType type, cv::Size size, float param1, float param2) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clock_++;
+
+    for (Entry &entry : entries_) {
+        if (entry.type == type && entry.size == size &&
+            entry.param1 == param1 && entry.param2 == param2) {
+            entry.lastUsed = clock_;
+            return entry.maps;
+        }
+    }
+
+    // Miss: evict the least recently used entry when full
+    if (entries_.size() >= capacity_) {
+        auto oldest = std::min_element(entries_.begin(), entries_.end(),
+            [](const Entry &a, const Entry &b) { return a.lastUsed < b.lastUsed; });
+        entries_.erase(oldest);
+    }
+
+    Entry entry;
+    entry.type = type;
+    entry.size = size;
+    entry.param1 = param1;
+    entry.param2 = param2;
+    entry.lastUsed = clock_;
+    entry.maps = build(type, size, param1, param2);
+    entries_.push_back(entry);
+    return entry.maps;
+}
+
+void WarpMapCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+size_t WarpMapCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+WarpMapCache &WarpMapCache::shared() {
+    static WarpMapCache cache;
+    return cache;
+}
+
+WarpMaps WarpMapCache::build(WarpType type, cv::Size size, float param1, float param2) {
+    WarpMaps maps;
+    cv::Mat mapXY;
+
+    switch (type) {
+        case WARP_BULGE:
+            buildBulgeMap(size, param1, mapXY);
+            break;
+        case WARP_WAVE:
+            buildWaveMap(size, param1, param2, mapXY);
+            break;
+        case WARP_SWIRL:
+            buildSwirlMap(size, param1, mapXY);
+            break;
+        case WARP_FACE_BULGE:
+            buildFaceBulgeMap(size, param1, mapXY, maps.mask, maps.origin);
+            break;
+    }
+
+    // Fixed-point maps make cv::remap roughly twice as fast as float maps
+    cv::convertMaps(mapXY, cv::noArray(), maps.map1, maps.map2, CV_16SC2);
+    return maps;
+}
@@ -5,19 +5,50 @@
 //              Pre-computes features for all images in a directory and saves
 //              them to a CSV file for fast querying.
 //
-// Usage: buildFeatureDB <image_dir> <feature_type> <output_csv>
+// Usage: buildFeatureDB <image_dir> <feature_type> <output_csv> [options]
 // Example: buildFeatureDB data/images histogram histogram_features.csv
+//          buildFeatureDB /data/1M histogram big.fdb --workers 8 --reduced-decode 4
+//          buildFeatureDB /data/1M histogram big.fdb --reduced-decode 4 --max-side 256
+//          buildFeatureDB /data/1M histogram big.fdb --update
+//          buildFeatureDB data/images histogram,texturecolor,gabor h.fdb,t.fdb,g.fdb
+//          buildFeatureDB /data/10M histogram big.fdb --shards 8
+//          buildFeatureDB data/images histogram hist.fdb --thumbnails 256
+//          buildFeatureDB /data/1M histogram,texturecolor h.fdb,t.fdb --gpu-histograms
+//          buildFeatureDB s3://catalogue/images/ histogram big.fdb --read-depth 128
 //
 // Workflow:
 //   1. Scan image directory for all image files
-//   2. Extract features from each image using specified feature type
-//   3. Store features in memory (FeatureDatabase map)
+//   2. Decode and extract features in a thread pipeline (DatabaseBuilder),
+//      checkpointing finished rows to <output_csv>.partial
+//   3. Store features in memory (FeatureDatabase)
 //   4. Save all features to CSV file for persistence
 //
+// With --update, only new, changed and deleted images are processed and the
+// changes are appended to <output_csv>.log (see FeatureDatabase::putFeatures).
+//
+// With --thumbnails, every decoded image is also shrunk and encoded into a
+// packed thumbnail atlas <output>.thumbs (see ThumbnailAtlas) that
+// cbirServer and the GUI use to display results.
+//
+// With --gpu-histograms, histogram, multi-histogram and texture-color
+// features count batches of decoded images on an OpenCL device (see
+// GpuHistogram); the features are the same as on the CPU.
+//
+// An s3:// or http:// image_dir builds straight from object storage: the
+// images under the prefix are listed and fetched ahead of the decoders
+// (see ObjectStore and BatchReader); nothing is written to local disk but
+// the checkpoint and the databases.
+//
+// Comma-separated feature types and outputs build several databases in one
+// pass: each image is decoded once and shares grayscale, gradients and face
+// boxes between the feature types (see CompositeExtractor).
+//
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "FeatureDatabase.h"
+#include "DatabaseBuilder.h"
+#include "CompositeExtractor.h"
 #include "BaselineFeature.h"
 #include "HistogramFeature.h"
 #include "MultiHistogramFeature.h"
@@ -26,8 +57,17 @@
 #include "DNNFeature.h"
 #include "ProductMatcherFeature.h"
 #include "FaceAwareFeature.h"
+#include "ThumbnailAtlas.h"
+#include "ObjectStore.h"
 #include <iostream>
 #include <string>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+#include <cstdio>
 
 using namespace std;
 using namespace cbir;
@@ -40,23 +80,92 @@ void printUsage(const char* programName) {
     cout << "CBIR Feature Database Builder" << endl;
     cout << "========================================" << endl;
     cout << endl;
-    cout << "Usage: " << programName << " <image_dir> <feature_type> <output_csv>" << endl;
+    cout << "Usage: " << programName << " <image_dir> <feature_type> <output_csv> [options]" << endl;
     cout << endl;
     cout << "Arguments:" << endl;
-    cout << "  image_dir    : Directory containing images" << endl;
+    cout << "  image_dir    : Directory containing images, or an object storage" << endl;
+    cout << "                 prefix (s3://bucket/prefix/, http://host:port/bucket/prefix/)" << endl;
     cout << "  feature_type : Type of features to extract" << endl;
     cout << "                 Options: baseline, histogram, chromaticity," << endl;
-    cout << "                          multihistogram, texturecolor, gabor," << endl;
+    cout << "                          multihistogram, pyramid, texturecolor, gabor," << endl;
     cout << "                          dnn, productmatcher" << endl;  // ⭐ UPDATED
-    cout << "  output_csv   : Output CSV file for features" << endl;
+    cout << "  output_csv   : Output CSV file for features (.fdb/.bin: packed binary)" << endl;
+    cout << "                 Several types with matching outputs, comma-separated," << endl;
+    cout << "                 are extracted in one pass over the images" << endl;
+    cout << endl;
+    cout << "Options:" << endl;
+    cout << "  --workers <n>        : Feature extractor threads (default: all cores)" << endl;
+    cout << "  --decoders <n>       : Image decoder threads (default: 2)" << endl;
+    cout << "  --read-depth <n>     : Image file reads in flight, through io_uring" << endl;
+    cout << "                         where available (default: 32; 0 = cv::imread" << endl;
+    cout << "                         in the decoder threads); for object storage," << endl;
+    cout << "                         concurrent HTTP fetches (try 64-256)" << endl;
+    cout << "  --prefetch-mb <n>    : Memory for files read ahead of the decoders" << endl;
+    cout << "                         (default: 256)" << endl;
+    cout << "  --reduced-decode <f> : Decode at 1/f resolution (2, 4, 8) when the" << endl;
+    cout << "                         feature type allows it (normalized histograms)" << endl;
+    cout << "  --max-side <n>       : Shrink decoded images to a longest side of n" << endl;
+    cout << "                         pixels when the feature type allows it; binary" << endl;
+    cout << "                         outputs record the policy for queryImage" << endl;
+    cout << "  --full-decode        : Decode whole JPEGs even when the feature type" << endl;
+    cout << "                         reads only the centre (baseline, productmatcher)" << endl;
+    cout << "  --restart            : Ignore <output_csv>.partial and start over" << endl;
+    cout << "  --update             : Update an existing database in place: extract" << endl;
+    cout << "                         new / changed images, drop deleted ones, and" << endl;
+    cout << "                         record the changes in <output_csv>.log" << endl;
+    cout << "  --compact            : With --update, always fold the log into a new" << endl;
+    cout << "                         base file (default: when changes > 10% of rows)" << endl;
+    cout << "  --shards <n>         : Split each output by image name hash into n files" << endl;
+    cout << "                         (big.fdb -> big.shard0of8.fdb, ...) for" << endl;
+    cout << "                         cbirServer --sharded" << endl;
+    cout << "  --storage <type>     : Binary outputs: float32 (default), float16, or" << endl;
+    cout << "                         uint8 (quantised, non-negative features such as" << endl;
+    cout << "                         histograms); --update keeps the file's storage" << endl;
+    cout << "  --compress <codec>   : Binary outputs: none (default) or zstd (blocks of" << endl;
+    cout << "                         rows compressed on disk, decompressed per block" << endl;
+    cout << "                         during scans); --update keeps the file's setting" << endl;
+    cout << "  --thumbnails <side>  : Also write <output_csv>.thumbs, a packed atlas of" << endl;
+    cout << "                         thumbnails (longest side in pixels) for result" << endl;
+    cout << "                         display; beside the first output" << endl;
+    cout << "  --thumb-format <f>   : Thumbnail encoding: jpg (default) or webp" << endl;
+    cout << "  --dnn-model <onnx>   : Compute dnn features natively with this model" << endl;
+    cout << "                         (N x 3 x 224 x 224 ImageNet input, embedding" << endl;
+    cout << "                         output) instead of the pre-computed CSV; the" << endl;
+    cout << "                         workers share one batched ONNX Runtime session" << endl;
+    cout << "  --gpu-histograms     : Count histogram, multihistogram, pyramid and" << endl;
+    cout << "                         texturecolor features in batches on an OpenCL" << endl;
+    cout << "                         device (identical features; CPU without one)" << endl;
+    cout << endl;
+    cout << "An interrupted build resumes from <output_csv>.partial when re-run" << endl;
+    cout << "with the same arguments." << endl;
     cout << endl;
     cout << "Example:" << endl;
     cout << "  " << programName << " data/images baseline baseline_features.csv" << endl;
     cout << "  " << programName << " data/images histogram histogram_features.csv" << endl;
     cout << "  " << programName << " data/images productmatcher product_features.csv" << endl;
+    cout << "  " << programName << " data/images histogram,gabor hist.fdb,gabor.fdb" << endl;
     cout << endl;
 }
 
+/**
+ * Switch a histogram extractor to batched counting on the OpenCL device
+ * 
+ * @param extractor Any extractor; others are left unchanged
+ * @return True if the extractor now counts batches on the device
+ */
+bool enableGpuHistograms(cbir::FeatureExtractor* extractor) {
+    if (auto* histogram = dynamic_cast<cbir::HistogramFeature*>(extractor)) {
+        return histogram->setUseGpu(true);
+    }
+    if (auto* multi = dynamic_cast<cbir::MultiHistogramFeature*>(extractor)) {
+        return multi->setUseGpu(true);
+    }
+    if (auto* textureColor = dynamic_cast<cbir::TextureColorFeature*>(extractor)) {
+        return textureColor->setUseGpu(true);
+    }
+    return false;
+}
+
 /**
  * Factory function to create appropriate feature extractor based on type
  * 
@@ -66,9 +175,14 @@ void printUsage(const char* programName) {
  *   - "chromaticity" or "rg": RG chromaticity histogram (16x16 = 256 values)
  * 
  * @param featureType Type of feature extractor to create
+ * @param dnnModel ONNX model computing "dnn" features natively (empty:
+ *                 pre-computed CSV)
+ * @param dnnBatch Images per forward pass of the shared DNN model
  * @return Pointer to created feature extractor, nullptr if type unknown
  */
-cbir::FeatureExtractor* createFeatureExtractor(const string& featureType) {
+cbir::FeatureExtractor* createFeatureExtractor(const string& featureType,
+                                               const string& dnnModel = "",
+                                               int dnnBatch = 8) {
     string type = cbir::Utils::toLower(featureType);
     
     if (type == "baseline") {
@@ -101,6 +215,18 @@ cbir::FeatureExtractor* createFeatureExtractor(const string& featureType) {
             8,
             true
         );
+    } else if (type == "pyramid" || type == "spatialpyramid") {
+        // Spatial pyramid RGB histogram
+        // Levels: 2 (whole image + 2×2 quadrants) = 5 regions
+        // Each region: 8×8×8 = 512 bins
+        // Total: 5 × 512 = 2560 values
+        return new cbir::MultiHistogramFeature(
+            cbir::MultiHistogramFeature::SplitType::PYRAMID,
+            2,
+            cbir::HistogramFeature::HistogramType::RGB,
+            8,
+            true
+        );
     } else if (type == "texturecolor" || type == "texture") {
         // Texture + Color: Sobel gradient histogram + RGB histogram
         // Texture: 16 bins (gradient magnitudes 0-255)
@@ -125,9 +251,14 @@ cbir::FeatureExtractor* createFeatureExtractor(const string& featureType) {
         );
     } else if (type == "dnn" || type == "resnet") {
         // Task 5: DNN features (pre-computed, loaded from CSV)
-        // NOTE: For DNN, buildFeatureDB just copies the existing CSV
-        // No feature extraction is performed
-        return new cbir::DNNFeature();
+        // NOTE: Without --dnn-model, buildFeatureDB just points at the
+        // existing CSV and no feature extraction is performed
+        cbir::DNNFeature* dnn = new cbir::DNNFeature();
+        if (!dnnModel.empty() && !dnn->loadModel(dnnModel, dnnBatch)) {
+            delete dnn;
+            return nullptr;
+        }
+        return dnn;
     } else if (type == "productmatcher" || type == "product") {
         // Task 7: Custom ProductMatcher feature
         // DNN (85%) + Center-region color (15%)
@@ -145,11 +276,141 @@ cbir::FeatureExtractor* createFeatureExtractor(const string& featureType) {
     }
 
     cerr << "Error: Unknown feature type '" << featureType << "'" << endl;
-    cerr << "Available: baseline, histogram, chromaticity, multihistogram, texturecolor, gabor, dnn, productmatcher, faceaware" << endl;
+    cerr << "Available: baseline, histogram, chromaticity, multihistogram, pyramid, texturecolor, gabor, dnn, productmatcher, faceaware" << endl;
     return nullptr;
 }
 
 
+/**
+ * Incrementally update an existing database from the image directory
+ * 
+ * Process:
+ *   1. Load the database (base file + change log)
+ *   2. Classify every image by its file stamp: unchanged, touched, changed, new
+ *   3. Extract features for changed and new images, log them with putFeatures()
+ *   4. Remove rows whose image file is gone
+ *   5. Compact when requested or when the log holds many changes
+ * 
+ * @param imageFiles Current image files
+ * @param outputPath Existing database file
+ * @param extractors One extractor per worker
+ * @param options Pipeline options
+ * @param forceCompact Always compact at the end
+ * @return 0 on success, 1 on error
+ */
+int updateDatabase(const vector<string>& imageFiles, const string& outputPath,
+                   const vector<FeatureExtractor*>& extractors,
+                   const BuildOptions& options, bool forceCompact) {
+    cout << "Step 1: Loading existing database..." << endl;
+    cout << "-------------------------------------------" << endl;
+    FeatureDatabase database;
+    if (!Utils::fileExists(outputPath) || !database.load(outputPath)) {
+        cerr << "Error: --update needs an existing database: " << outputPath << endl;
+        return 1;
+    }
+    cout << endl;
+    
+    // Classify files by stamp
+    cout << "Step 2: Checking " << imageFiles.size() << " images for changes..." << endl;
+    cout << "-------------------------------------------" << endl;
+    vector<string> pendingFiles;
+    map<string, FileStamp> pendingStamps;
+    vector<pair<string, FileStamp>> touched;
+    set<string> present;
+    int added = 0;
+    int modified = 0;
+    for (const auto& imagePath : imageFiles) {
+        present.insert(Utils::getFilename(imagePath));
+        FileStamp stamp;
+        switch (database.checkFile(imagePath, stamp)) {
+        case FileChange::Unchanged:
+            break;
+        case FileChange::Touched:
+            touched.emplace_back(imagePath, stamp);
+            break;
+        case FileChange::Modified:
+            modified++;
+            pendingFiles.push_back(imagePath);
+            pendingStamps[Utils::getFilename(imagePath)] = stamp;
+            break;
+        case FileChange::Added:
+            added++;
+            pendingFiles.push_back(imagePath);
+            pendingStamps[Utils::getFilename(imagePath)] = stamp;
+            break;
+        }
+    }
+    
+    vector<string> deleted;
+    for (const auto& name : database.getImageNames()) {
+        if (present.count(name) == 0) {
+            deleted.push_back(name);
+        }
+    }
+    cout << "  New:       " << added << endl;
+    cout << "  Changed:   " << modified << endl;
+    cout << "  Deleted:   " << deleted.size() << endl;
+    cout << "  Unchanged: " << (imageFiles.size() - added - modified) << endl;
+    cout << endl;
+    
+    // Extract only what changed
+    int failed = 0;
+    if (!pendingFiles.empty()) {
+        cout << "Step 3: Extracting features from " << pendingFiles.size() << " images..." << endl;
+        cout << "-------------------------------------------" << endl;
+        // New rows must be decoded like the existing ones
+        BuildOptions updateOptions = options;
+        const DecodePolicy& policy = database.getDecodePolicy();
+        if (options.decodeReduction != 1 || options.maxImageSide != 0) {
+            cout << "Note: --update keeps the database's decode policy ("
+                 << policy.describe() << ")" << endl;
+        }
+        updateOptions.decodeReduction = policy.reduction;
+        updateOptions.maxImageSide = policy.maxSide;
+        updateOptions.checkpointPath = outputPath + ".update.partial";
+        FeatureDatabase changes;
+        DatabaseBuilder builder(updateOptions);
+        builder.build(pendingFiles, extractors, changes);
+        failed = builder.getFailCount();
+        
+        for (size_t row = 0; row < changes.size(); row++) {
+            string name = changes.getName(row);
+            if (!database.putFeatures(name, changes.getFeaturesAt(row), pendingStamps[name])) {
+                cerr << "Error: Failed to update " << name << endl;
+                return 1;
+            }
+        }
+        builder.removeCheckpoint();
+        cout << endl;
+    }
+    
+    database.removeFeatures(deleted);
+    database.stampFiles(touched);
+    
+    // Fold the log into the base file once it is a sizeable fraction of it
+    bool compactNow = forceCompact || database.pendingChanges() * 10 > database.size();
+    if (compactNow && database.pendingChanges() > 0) {
+        cout << "Step 4: Compacting " << database.pendingChanges() << " changes..." << endl;
+        cout << "-------------------------------------------" << endl;
+        if (!database.compact(false)) {
+            cerr << "Error: Compaction failed; changes remain in the log" << endl;
+            return 1;
+        }
+        cout << endl;
+    }
+    
+    cout << "========================================" << endl;
+    cout << "SUCCESS!" << endl;
+    cout << "========================================" << endl;
+    cout << "Database: " << outputPath << " (" << database.size() << " images)" << endl;
+    cout << "Pending log changes: " << database.pendingChanges() << endl;
+    if (failed > 0) {
+        cout << "Failed images: " << failed << " (retried on the next update)" << endl;
+    }
+    cout << "========================================" << endl;
+    return 0;
+}
+
 /**
  * Main function - Build feature database from image directory
  * 
@@ -157,15 +418,15 @@ cbir::FeatureExtractor* createFeatureExtractor(const string& featureType) {
  *   1. Validate command line arguments
  *   2. Check if image directory exists
  *   3. Create appropriate feature extractor
- *   4. Build feature database (extract features from all images)
- *   5. Save features to CSV file
+ *   4. Build feature database (pipelined, resumable extraction)
+ *   5. Save features to CSV file and drop the checkpoint
  * 
  * @param argc Argument count
  * @param argv Argument values
  * @return 0 on success, 1 on error
  */
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
+    if (argc < 4) {
         printUsage(argv[0]);
         return 1;
     }
@@ -173,9 +434,139 @@ int main(int argc, char* argv[]) {
     string imageDir = argv[1];
     string featureType = argv[2];
     string outputCSV = argv[3];
+    vector<string> featureTypes = Utils::split(featureType, ',');
+    vector<string> outputPaths = Utils::split(outputCSV, ',');
+    if (featureTypes.empty() || featureTypes.size() != outputPaths.size()) {
+        cerr << "Error: Give one output file per feature type" << endl;
+        return 1;
+    }
+    const bool multiple = featureTypes.size() > 1;
+    
+    // Parse pipeline options
+    int workerCount = static_cast<int>(std::thread::hardware_concurrency());
+    BuildOptions options;
+    for (const auto& outputPath : outputPaths) {
+        options.checkpointPaths.push_back(outputPath + ".partial");
+    }
+    options.progressInterval = 100;
+    bool restart = false;
+    bool update = false;
+    bool forceCompact = false;
+    int shardCount = 1;
+    FeatureStorage storage = FeatureStorage::Float32;
+    FeatureCompression compression = FeatureCompression::None;
+    int thumbnailSide = 0;
+    string thumbnailFormat = "jpg";
+    string dnnModel;
+    bool gpuHistograms = false;
+    for (int i = 4; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--workers" && i + 1 < argc) {
+            workerCount = stoi(argv[++i]);
+        } else if (option == "--decoders" && i + 1 < argc) {
+            options.decoderThreads = stoi(argv[++i]);
+        } else if (option == "--read-depth" && i + 1 < argc) {
+            options.readQueueDepth = stoi(argv[++i]);
+        } else if (option == "--prefetch-mb" && i + 1 < argc) {
+            options.prefetchBytes = static_cast<size_t>(max(1, stoi(argv[++i]))) << 20;
+        } else if (option == "--reduced-decode" && i + 1 < argc) {
+            options.decodeReduction = stoi(argv[++i]);
+        } else if (option == "--max-side" && i + 1 < argc) {
+            options.maxImageSide = stoi(argv[++i]);
+        } else if (option == "--full-decode") {
+            options.regionDecode = false;
+        } else if (option == "--restart") {
+            restart = true;
+        } else if (option == "--update") {
+            update = true;
+        } else if (option == "--compact") {
+            forceCompact = true;
+        } else if (option == "--shards" && i + 1 < argc) {
+            shardCount = stoi(argv[++i]);
+            if (shardCount < 1) {
+                cerr << "Error: --shards needs at least 1" << endl;
+                return 1;
+            }
+        } else if (option == "--thumbnails" && i + 1 < argc) {
+            thumbnailSide = stoi(argv[++i]);
+            if (thumbnailSide < 16) {
+                cerr << "Error: --thumbnails needs a side of at least 16 pixels" << endl;
+                return 1;
+            }
+        } else if (option == "--thumb-format" && i + 1 < argc) {
+            thumbnailFormat = Utils::toLower(argv[++i]);
+            if (thumbnailFormat != "jpg" && thumbnailFormat != "webp") {
+                cerr << "Error: Unknown thumbnail format '" << thumbnailFormat
+                     << "' (jpg, webp)" << endl;
+                return 1;
+            }
+        } else if (option == "--dnn-model" && i + 1 < argc) {
+            dnnModel = argv[++i];
+        } else if (option == "--gpu-histograms") {
+            gpuHistograms = true;
+        } else if (option == "--storage" && i + 1 < argc) {
+            string name = Utils::toLower(argv[++i]);
+            if (name == "float32") {
+                storage = FeatureStorage::Float32;
+            } else if (name == "float16") {
+                storage = FeatureStorage::Float16;
+            } else if (name == "uint8") {
+                storage = FeatureStorage::UInt8;
+            } else {
+                cerr << "Error: Unknown storage '" << name << "' (float32, float16, uint8)" << endl;
+                return 1;
+            }
+        } else if (option == "--compress" && i + 1 < argc) {
+            string name = Utils::toLower(argv[++i]);
+            if (name == "none") {
+                compression = FeatureCompression::None;
+            } else if (name == "zstd") {
+                compression = FeatureCompression::Zstd;
+            } else {
+                cerr << "Error: Unknown compression '" << name << "' (none, zstd)" << endl;
+                return 1;
+            }
+            if (!FeatureDatabase::compressionAvailable(compression)) {
+                cerr << "Error: This build has no " << name << " support" << endl;
+                return 1;
+            }
+        } else {
+            cerr << "Error: Unknown option '" << option << "'" << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    workerCount = max(1, workerCount);
+    
+    const bool remote = ObjectStore::isUrl(imageDir);
+    if (multiple && update) {
+        cerr << "Error: --update takes a single feature type" << endl;
+        return 1;
+    }
+    if (remote && update) {
+        cerr << "Error: --update needs a local image directory (it compares file stamps)"
+             << endl;
+        return 1;
+    }
+    if (thumbnailSide > 0 && update) {
+        cerr << "Error: --thumbnails needs a full build (the atlas is rewritten)" << endl;
+        return 1;
+    }
+    if (shardCount > 1 && update) {
+        cerr << "Error: --update cannot be combined with --shards; rebuild the shards" << endl;
+        return 1;
+    }
+    for (const auto& type : featureTypes) {
+        string lower = Utils::toLower(type);
+        if (multiple && dnnModel.empty() && (lower == "dnn" || lower == "resnet")) {
+            cerr << "Error: dnn features are pre-computed; build them on their own" << endl;
+            return 1;
+        }
+    }
 
-    // Special case for pure DNN features
-    if (Utils::toLower(featureType) == "dnn" || Utils::toLower(featureType) == "resnet") {
+    // Special case for pure DNN features without a model to compute them
+    if (dnnModel.empty() &&
+        (Utils::toLower(featureType) == "dnn" || Utils::toLower(featureType) == "resnet")) {
         cout << "========================================" << endl;
         cout << "DNN Features (Pre-computed)" << endl;
         cout << "========================================" << endl;
@@ -194,131 +585,246 @@ int main(int argc, char* argv[]) {
     cout << "Image directory : " << imageDir << endl;
     cout << "Feature type    : " << featureType << endl;
     cout << "Output CSV      : " << outputCSV << endl;
+    cout << "Workers         : " << workerCount << " extractor(s), "
+         << options.decoderThreads << " decoder(s)" << endl;
     cout << "========================================" << endl;
     cout << endl;
     
-    if (!Utils::directoryExists(imageDir)) {
+    if (!remote && !Utils::directoryExists(imageDir)) {
         cerr << "Error: Image directory does not exist: " << imageDir << endl;
         return 1;
     }
     
-    FeatureExtractor* extractor = createFeatureExtractor(featureType);
-    if (extractor == nullptr) {
-        return 1;
+    // One extractor per worker and feature type: extractors keep per-image
+    // state. Each worker's extractors share one decoded image per file;
+    // extractors with a preferred batch size (a loaded DNN model) get up to
+    // that many decoded images per extractBatch() call.
+    vector<unique_ptr<FeatureExtractor>> ownedExtractors;
+    vector<unique_ptr<CompositeExtractor>> ownedComposites;
+    vector<CompositeExtractor*> workers;
+    vector<FeatureExtractor*> extractors;   // first feature type, for --update
+    for (int i = 0; i < workerCount; i++) {
+        vector<FeatureExtractor*> members;
+        for (const auto& type : featureTypes) {
+            FeatureExtractor* extractor = createFeatureExtractor(type, dnnModel,
+                                                                   max(8, workerCount));
+            if (extractor == nullptr) {
+                return 1;
+            }
+            ownedExtractors.emplace_back(extractor);
+            members.push_back(extractor);
+        }
+        extractors.push_back(members.front());
+        ownedComposites.emplace_back(new CompositeExtractor(members));
+        workers.push_back(ownedComposites.back().get());
     }
     
-    // Check for special feature types that need filename-based extraction
-    ProductMatcherFeature* productMatcher = dynamic_cast<ProductMatcherFeature*>(extractor);
-    FaceAwareFeature* faceAware = dynamic_cast<FaceAwareFeature*>(extractor);
-    
-    if (productMatcher) {
-        cout << "ProductMatcher mode: Combining DNN + Center-region color" << endl;
-        cout << endl;
+    bool gpuHistogramsUsed = false;
+    for (size_t k = 0; k < featureTypes.size(); k++) {
+        // Batched device counting; every worker's copy of the feature type
+        if (gpuHistograms) {
+            bool enabled = false;
+            for (CompositeExtractor* worker : workers) {
+                enabled = enableGpuHistograms(worker->getExtractor(k)) || enabled;
+            }
+            if (enabled) {
+                cout << "GPU histograms: " << featureTypes[k] << " counted in batches of "
+                     << GpuHistogram::PREFERRED_BATCH << " on the OpenCL device" << endl;
+                cout << endl;
+                gpuHistogramsUsed = true;
+            }
+        }
+        
+        // Native DNN features: provider setup before the first image
+        if (DNNFeature* dnn = dynamic_cast<DNNFeature*>(workers.front()->getExtractor(k))) {
+            if (dnn->hasModel()) {
+                cout << "DNN mode: Computing embeddings with " << dnnModel << endl;
+                dnn->warmup();
+                cout << endl;
+            }
+        }
+        
+        if (dynamic_cast<ProductMatcherFeature*>(workers.front()->getExtractor(k))) {
+            cout << "ProductMatcher mode: Combining DNN + Center-region color" << endl;
+            cout << endl;
+        }
+        
+        if (dynamic_cast<FaceAwareFeature*>(workers.front()->getExtractor(k))) {
+            cout << "FaceAware mode: Adaptive feature selection based on face detection" << endl;
+            cout << endl;
+        }
     }
     
-    if (faceAware) {
-        cout << "FaceAware mode: Adaptive feature selection based on face detection" << endl;
-        cout << endl;
+    if (gpuHistograms && !gpuHistogramsUsed) {
+        cerr << "Warning: --gpu-histograms found no OpenCL device or no histogram feature;"
+             << " extracting on the CPU" << endl;
     }
     
     // Get list of image files
-    cout << "Scanning image directory..." << endl;
-    vector<string> imageFiles = Utils::getImageFiles(imageDir, false);
+    ObjectStore store;
+    vector<string> imageFiles;
+    if (remote) {
+        cout << "Listing " << imageDir << (store.isSigned() ? "" : " (anonymous)") << "..." << endl;
+        vector<ObjectInfo> objects;
+        string error;
+        if (!store.list(imageDir, objects, &error)) {
+            cerr << "Error: Cannot list " << imageDir << ": " << error << endl;
+            return 1;
+        }
+        for (const auto& object : objects) {
+            imageFiles.push_back(object.url);
+        }
+    } else {
+        cout << "Scanning image directory..." << endl;
+        imageFiles = Utils::getImageFiles(imageDir, false);
+    }
     
     if (imageFiles.empty()) {
         cerr << "Error: No image files found in " << imageDir << endl;
-        delete extractor;
         return 1;
     }
     
     cout << "Found " << imageFiles.size() << " images" << endl;
     cout << endl;
     
+    if (restart) {
+        for (const auto& checkpointPath : options.checkpointPaths) {
+            std::remove(checkpointPath.c_str());
+        }
+    }
+    
+    if (update) {
+        options.checkpointPath = options.checkpointPaths.front();
+        options.checkpointPaths.clear();
+        return updateDatabase(imageFiles, outputCSV, extractors, options, forceCompact);
+    }
+    
     // Step 1: Extract features from all images
     cout << "Step 1: Extracting features from images..." << endl;
     cout << "-------------------------------------------" << endl;
     
-    // Create feature database
-    FeatureDatabase database;
-    int successCount = 0;
-    int failCount = 0;
-    
-    for (const auto& imagePath : imageFiles) {
-        // Load image
-        cv::Mat image = Utils::loadImage(imagePath);
-        
-        if (image.empty()) {
-            cerr << "Warning: Failed to load " << imagePath << endl;
-            failCount++;
-            continue;
-        }
-        
-        // Extract features
-        string filename = Utils::getFilename(imagePath);
-        cv::Mat featureVec;  // ⭐ Single feature vector (cv::Mat)
-        
-        if (productMatcher) {
-            // Special: ProductMatcher needs filename
-            featureVec = productMatcher->extractFeaturesWithFilename(image, filename);
-        } else if (faceAware) {
-            // Special: FaceAware needs filename
-            featureVec = faceAware->extractFeaturesWithFilename(image, filename);
-        } else {
-            // Normal: Extract from image only
-            featureVec = extractor->extractFeatures(image);
-        }
-        
-        if (featureVec.empty()) {
-            cerr << "Warning: Failed to extract features from " << filename << endl;
-            failCount++;
-            continue;
-        }
-        
-        // Store features in database
-        database.addFeatures(filename, featureVec);
-        successCount++;
-        
-        // Progress indicator
-        if ((successCount + failCount) % 100 == 0) {
-            cout << "  Processed " << (successCount + failCount) 
-                 << "/" << imageFiles.size() << " images..." << endl;
+    vector<FeatureDatabase> databases(featureTypes.size());
+    vector<FeatureDatabase*> databasePointers;
+    for (auto& database : databases) {
+        databasePointers.push_back(&database);
+    }
+    ThumbnailAtlasWriter thumbnails(thumbnailSide, thumbnailFormat);
+    const string atlasPath = ThumbnailAtlas::pathFor(outputPaths.front());
+    if (thumbnailSide > 0) {
+        if (!thumbnails.open(atlasPath)) {
+            return 1;
         }
+        options.thumbnails = &thumbnails;
     }
-    
-    cout << "Feature extraction complete!" << endl;
-    cout << "  Success: " << successCount << endl;
-    cout << "  Failed:  " << failCount << endl;
+    DatabaseBuilder builder(options);
+    builder.build(imageFiles, workers, databasePointers);
     cout << endl;
     
-    if (successCount == 0) {
-        cerr << "Error: No features extracted" << endl;
-        delete extractor;
-        return 1;
+    for (size_t k = 0; k < databases.size(); k++) {
+        if (databases[k].empty()) {
+            cerr << "Error: No " << featureTypes[k] << " features extracted" << endl;
+            return 1;
+        }
     }
     
-    // Step 2: Save features to CSV
-    cout << "Step 2: Saving features to CSV..." << endl;
+    // Step 2: Save features (binary for .fdb/.bin, CSV otherwise)
+    cout << "Step 2: Saving feature database" << (multiple ? "s" : "") << "..." << endl;
     cout << "-------------------------------------------" << endl;
     
-    bool saveSuccess = database.saveToCSV(outputCSV);
+    const DecodePolicy& policy = databases.front().getDecodePolicy();
+    if (!policy.isFullResolution()) {
+        for (const auto& outputPath : outputPaths) {
+            if (!FeatureDatabase::isBinaryPath(outputPath)) {
+                cout << "Note: " << outputPath << " is CSV and does not record the decode"
+                     << " policy (" << policy.describe() << "); queries will decode at"
+                     << " full resolution. Use a .fdb output to keep them consistent." << endl;
+            }
+        }
+    }
+    for (size_t k = 0; k < databases.size(); k++) {
+        bool saved = shardCount > 1
+            ? databases[k].saveShards(outputPaths[k], shardCount, storage, compression)
+            : databases[k].save(outputPaths[k], storage, compression);
+        if (!saved) {
+            cerr << "Error: Failed to save feature database " << outputPaths[k] << endl;
+            cerr << "Finished rows are kept in " << options.checkpointPaths[k] << endl;
+            return 1;
+        }
+    }
+    builder.removeCheckpoint();
     
-    if (!saveSuccess) {
-        cerr << "Error: Failed to save features to CSV" << endl;
-        delete extractor;
-        return 1;
+    if (thumbnailSide > 0) {
+        // Images restored from a checkpoint were not decoded by this run
+        const DecodePolicy& thumbnailPolicy = databases.front().getDecodePolicy();
+        size_t missing = 0;
+        for (const auto& imagePath : imageFiles) {
+            if (!thumbnails.contains(imagePath) && databases.front().indexOf(imagePath) >= 0) {
+                cv::Mat image;
+                vector<unsigned char> bytes;
+                if (!remote) {
+                    image = thumbnailPolicy.load(imagePath);
+                } else if (store.fetch(imagePath, bytes)) {
+                    image = thumbnailPolicy.decode(bytes);
+                }
+                thumbnails.add(imagePath, image);
+                missing++;
+            }
+        }
+        if (missing > 0) {
+            cout << "Encoded " << missing << " thumbnails of resumed images" << endl;
+        }
+        if (!thumbnails.finish()) {
+            cerr << "Warning: Thumbnail atlas was not written" << endl;
+        } else {
+            cout << "Thumbnail atlas saved to: " << atlasPath << " (" << thumbnails.size()
+                 << " images, " << thumbnailSide << " px)" << endl;
+        }
+    }
+    
+    // Start fresh change logs holding the file stamps for later --update runs
+    // (object storage builds have no file stamps and are rebuilt instead)
+    vector<pair<string, FileStamp>> stamps;
+    stamps.reserve(imageFiles.size());
+    for (size_t i = 0; i < imageFiles.size() && !remote; i++) {
+        stamps.emplace_back(imageFiles[i], FileStamp::of(imageFiles[i], false));
+    }
+    for (size_t k = 0; k < databases.size() && !remote; k++) {
+        for (int shard = 0; shard < shardCount; shard++) {
+            const string path = shardCount > 1
+                ? FeatureDatabase::shardPath(outputPaths[k], shard, shardCount) : outputPaths[k];
+            if (!Utils::fileExists(path)) {
+                continue;   // empty shard
+            }
+            // Each shard's log stamps only its own images (stampFiles skips the rest)
+            FeatureDatabase shardDatabase;
+            FeatureDatabase& target = shardCount > 1 ? shardDatabase : databases[k];
+            if (shardCount > 1) {
+                std::remove(DeltaLog::pathFor(path).c_str());   // stale log of an older build
+            }
+            bool ok = shardCount == 1 || shardDatabase.load(path);
+            if (!ok || !target.attachLog(path, true) || !target.stampFiles(stamps)) {
+                cerr << "Warning: Could not record file stamps for " << path
+                     << "; the first --update will re-extract" << endl;
+            }
+        }
     }
     
     cout << endl;
     cout << "========================================" << endl;
     cout << "SUCCESS!" << endl;
     cout << "========================================" << endl;
-    cout << "Feature database saved to: " << outputCSV << endl;
-    cout << "Total images processed: " << successCount << endl;
+    for (size_t k = 0; k < databases.size(); k++) {
+        if (shardCount > 1) {
+            cout << "Feature database saved to " << shardCount << " shards: "
+                 << FeatureDatabase::shardPath(outputPaths[k], 0, shardCount) << " ..." << endl;
+        } else {
+            cout << "Feature database saved to: " << outputPaths[k] << endl;
+        }
+    }
+    cout << "Total images processed: " << databases.front().size() << endl;
     cout << endl;
     cout << "Next step: Query images using queryImage" << endl;
     cout << "========================================" << endl;
     
-    delete extractor;
-    
     return 0;
 }
@@ -0,0 +1,783 @@
+////////////////////////////////////////////////////////////////////////////////
+// cbirBench.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Retrieval benchmark. Runs a query list against one or more
+//              (feature type, database, metric, index) combinations and
+//              reports database load time, memory, per-query latency
+//              percentiles, multi-threaded throughput and retrieval quality,
+//              as a console table and optionally JSON / CSV for tracking
+//              regressions between builds. The JSON report and the baseline
+//              comparison come from the shared harness (cvcore/benchmark.hpp).
+//
+// Usage: cbirBench <queries> --run <feature_type> <feature_db> <metric> [--run ...] [options]
+// Example: cbirBench data/queries.txt --run histogram hist.fdb histogram
+//              --run dnn dnn.fdb cosine --index exact,hnsw,ivfpq
+//              --ground-truth data/relevant.csv --top 10 --json bench.json
+//              --compare baseline.json --tolerance 0.15
+//
+// Measurements (per combination):
+//   1. Load the database (timed) and open the index (load or build, timed)
+//   2. Decode and extract every query once (timed per query)
+//   3. Single-threaded pass: search latency of every query (p50 / p99)
+//   4. Multi-threaded pass: the queries repeated over N client threads,
+//      each with its own extractor and metric (queries per second)
+//   5. Precision / recall@K against the ground truth, and for ANN indexes
+//      recall@K against exact search
+//
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ImageRetrieval.h"
+#include "FeatureFactory.h"
+#include "AnnIndex.h"
+#include "HnswIndex.h"
+#include "IvfPqIndex.h"
+#include <cvcore/benchmark.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace cbir;
+
+namespace {
+
+/// Matches per query unless --top is given
+const int DEFAULT_TOP_K = 10;
+
+/// Untimed queries before the latency pass (warms caches and lazy loads)
+const int DEFAULT_WARMUP = 5;
+
+/// Passes over the query list in the throughput phase
+const int DEFAULT_REPEAT = 3;
+
+double elapsedMs(int64 start, int64 end) {
+    return 1000.0 * (end - start) / cv::getTickFrequency();
+}
+
+/**
+ * Nearest-rank percentile of sorted samples (same rule as cbirServer /stats)
+ */
+double percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+double mean(const vector<double>& samples) {
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    return samples.empty() ? 0.0 : sum / samples.size();
+}
+
+/**
+ * Resident set size of this process in bytes (0 where unsupported)
+ */
+size_t residentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Discards std::cout while alive; the retrieval engine logs every query,
+ * which would dominate the timings and bury the report
+ */
+class QuietStdout {
+public:
+    QuietStdout() : saved_(cout.rdbuf(&sink_)) {}
+    ~QuietStdout() { cout.rdbuf(saved_); }
+
+private:
+    struct NullBuffer : public streambuf {
+        int overflow(int c) override { return c; }
+    };
+    NullBuffer sink_;
+    streambuf* saved_;
+};
+
+/**
+ * One --run: feature type, database and metric
+ */
+struct RunSpec {
+    string featureType;
+    string databasePath;
+    string metricType;
+};
+
+/**
+ * Measurements for one (run, index) combination
+ */
+struct BenchResult {
+    string featureType;
+    string databasePath;
+    string metricType;
+    string indexType;
+    string error;              ///< Non-empty if the combination could not run
+    size_t images = 0;
+    int dimension = 0;
+    size_t queries = 0;        ///< Queries with features
+    size_t failed = 0;         ///< Queries that could not be decoded / extracted
+    double loadMs = 0.0;
+    double indexMs = 0.0;      ///< Index load or build (0 for exact)
+    size_t databaseBytes = 0;  ///< Packed feature matrix
+    size_t indexBytes = 0;     ///< ANN structure
+    size_t residentBytes = 0;  ///< Process RSS once database and index are ready
+    double extractMeanMs = 0.0;
+    double searchMeanMs = 0.0;
+    double searchP50Ms = 0.0;
+    double searchP99Ms = 0.0;
+    double endToEndP50Ms = 0.0;
+    double endToEndP99Ms = 0.0;
+    int threads = 0;
+    double qps = 0.0;
+    size_t judged = 0;         ///< Queries with ground truth
+    double precision = -1.0;   ///< Mean precision@K (-1 = no ground truth)
+    double recall = -1.0;      ///< Mean recall@K (-1 = no ground truth)
+    double recallVsExact = -1.0;  ///< ANN recall@K against exact (-1 = exact)
+    vector<double> searchMs;   ///< Single-client search latencies, sorted
+};
+
+/**
+ * Print usage information and examples
+ */
+void printUsage(const char* programName) {
+    cout << "========================================" << endl;
+    cout << "CBIR Retrieval Benchmark" << endl;
+    cout << "========================================" << endl;
+    cout << endl;
+    cout << "Usage: " << programName
+         << " <queries> --run <feature_type> <feature_db> <metric> [--run ...] [options]" << endl;
+    cout << endl;
+    cout << "Arguments:" << endl;
+    cout << "  queries      : Text file with one query image path per line, or a" << endl;
+    cout << "                 directory of query images" << endl;
+    cout << "  --run        : A combination to measure, with the same arguments as" << endl;
+    cout << "                 queryImage (repeat for several)" << endl;
+    cout << endl;
+    cout << "Options:" << endl;
+    cout << "  --index <list>       : Comma-separated search methods per run: exact," << endl;
+    cout << "                         hnsw, ivfpq, pq, opq (ssd or cosine), inverted" << endl;
+    cout << "                         (histogram); default exact" << endl;
+    cout << "  --top <k>            : Matches per query, K of precision/recall@K"
+         << " (default " << DEFAULT_TOP_K << ")" << endl;
+    cout << "  --threads <n>        : Client threads in the throughput phase" << endl;
+    cout << "                         (default all cores)" << endl;
+    cout << "  --repeat <n>         : Passes over the queries in the throughput phase"
+         << " (default " << DEFAULT_REPEAT << ")" << endl;
+    cout << "  --warmup <n>         : Untimed queries before the latency pass"
+         << " (default " << DEFAULT_WARMUP << ")" << endl;
+    cout << "  --ground-truth <csv> : Lines of query,relevant,relevant,... (filenames)" << endl;
+    cout << "  --exclude-self       : Do not count the query image among its matches" << endl;
+    cout << "  --ef <n>             : HNSW search beam width" << endl;
+    cout << "  --nprobe <n>         : IVF-PQ lists visited per query" << endl;
+    cout << "  --rebuild-index      : Rebuild ANN indexes even if saved ones exist" << endl;
+    cout << "  --csv <file>         : Write the results as CSV (one row per combination)" << endl;
+    cout << endl;
+    cout << "Report options (search latency per combination, names feature/metric/index):"
+         << endl;
+    cout << cvcore::BenchOptions::usage();
+    cout << endl;
+    cout << "Examples:" << endl;
+    cout << "  " << programName << " data/queries.txt --run histogram hist.fdb histogram" << endl;
+    cout << "  " << programName << " data/queries --run dnn dnn.fdb cosine --index exact,hnsw \\" << endl;
+    cout << "      --ground-truth data/relevant.csv --exclude-self --csv bench.csv" << endl;
+    cout << endl;
+}
+
+/**
+ * Query image paths from a list file or a directory
+ */
+bool readQueries(const string& source, vector<string>& paths) {
+    if (Utils::directoryExists(source)) {
+        paths = Utils::getImageFiles(source);
+    } else {
+        ifstream file(source);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open query list " << source << endl;
+            return false;
+        }
+        string line;
+        while (getline(file, line)) {
+            line = Utils::trim(line);
+            if (!line.empty() && line[0] != '#') {
+                paths.push_back(line);
+            }
+        }
+    }
+    if (paths.empty()) {
+        cerr << "Error: No query images in " << source << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Relevant image filenames per query filename
+ */
+bool readGroundTruth(const string& filename, map<string, set<string>>& truth) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot open ground truth " << filename << endl;
+        return false;
+    }
+    string line;
+    while (getline(file, line)) {
+        vector<string> fields = Utils::split(line, ',');
+        if (fields.size() < 2 || Utils::trim(fields[0]).empty() ||
+            Utils::trim(fields[0])[0] == '#') {
+            continue;
+        }
+        set<string>& relevant = truth[Utils::getFilename(Utils::trim(fields[0]))];
+        for (size_t i = 1; i < fields.size(); i++) {
+            string name = Utils::getFilename(Utils::trim(fields[i]));
+            if (!name.empty()) {
+                relevant.insert(name);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Extractor and metric pair for one thread; the database and index are shared
+ */
+unique_ptr<ImageRetrieval> makeEngine(const RunSpec& run, FeatureDatabase& database,
+                                      AnnIndex* index) {
+    FeatureExtractor* extractor = FeatureFactory::createExtractor(run.featureType);
+    DistanceMetric* metric = FeatureFactory::createMetric(run.metricType);
+    if (extractor == nullptr || metric == nullptr) {
+        delete extractor;
+        delete metric;
+        return nullptr;
+    }
+    unique_ptr<ImageRetrieval> engine(new ImageRetrieval());
+    engine->setFeatureDatabase(&database);
+    engine->setFeatureExtractor(extractor);
+    engine->setDistanceMetric(metric);
+    engine->setAnnIndex(index);
+    return engine;
+}
+
+/**
+ * Top K for a query, optionally without the query image itself
+ */
+vector<ImageMatch> searchTopK(ImageRetrieval& engine, const cv::Mat& features, int topK,
+                              const string& queryName, bool excludeSelf, bool exact) {
+    const int fetch = excludeSelf ? topK + 1 : topK;
+    vector<ImageMatch> matches = exact ? engine.queryExact(features, fetch)
+                                       : engine.queryWithFeatures(features, fetch);
+    if (excludeSelf) {
+        matches.erase(remove_if(matches.begin(), matches.end(),
+                                [&queryName](const ImageMatch& match) {
+                                    return match.filename == queryName;
+                                }),
+                      matches.end());
+    }
+    if (matches.size() > static_cast<size_t>(topK)) {
+        matches.resize(topK);
+    }
+    return matches;
+}
+
+/**
+ * Run every measurement for one (run, index) combination
+ *
+ * The database is loaded by the caller and shared by the combinations of
+ * one run; index is nullptr for exact search.
+ */
+void measure(const RunSpec& run, FeatureDatabase& database, AnnIndex* index,
+             const vector<string>& queryPaths, const map<string, set<string>>& truth,
+             int topK, int threads, int repeat, int warmup, bool excludeSelf,
+             BenchResult& result) {
+    unique_ptr<ImageRetrieval> engine = makeEngine(run, database, index);
+    if (!engine) {
+        result.error = "unknown feature type or metric";
+        return;
+    }
+    FeatureExtractor* extractor = FeatureFactory::createExtractor(run.featureType);
+    unique_ptr<FeatureExtractor> extractorOwner(extractor);
+
+    // Decode and extract each query once, decoded like the database images
+    const DecodePolicy& decodePolicy = database.getDecodePolicy();
+    vector<cv::Mat> features;
+    vector<string> names;
+    vector<double> extractMs;
+    {
+        QuietStdout quiet;
+        for (const string& path : queryPaths) {
+            const int64 start = cv::getTickCount();
+            cv::Mat image = decodePolicy.load(path);
+            cv::Mat queryFeatures = image.empty() ? cv::Mat()
+                : FeatureFactory::extractQueryFeatures(extractor, image, path);
+            const int64 end = cv::getTickCount();
+            if (queryFeatures.empty() ||
+                static_cast<int>(queryFeatures.total()) != result.dimension) {
+                result.failed++;
+                continue;
+            }
+            features.push_back(queryFeatures);
+            names.push_back(Utils::getFilename(path));
+            extractMs.push_back(elapsedMs(start, end));
+        }
+    }
+    result.queries = features.size();
+    if (features.empty()) {
+        result.error = "no query could be extracted";
+        return;
+    }
+    result.extractMeanMs = mean(extractMs);
+
+    // Single client: latency per query, and quality of its answers
+    vector<double> searchMs;
+    vector<double> endToEndMs;
+    double precisionSum = 0.0;
+    double recallSum = 0.0;
+    double exactRecallSum = 0.0;
+    {
+        QuietStdout quiet;
+        for (int i = 0; i < warmup; i++) {
+            engine->queryWithFeatures(features[i % features.size()], topK);
+        }
+        for (size_t q = 0; q < features.size(); q++) {
+            const int64 start = cv::getTickCount();
+            vector<ImageMatch> matches =
+                searchTopK(*engine, features[q], topK, names[q], excludeSelf, false);
+            const double ms = elapsedMs(start, cv::getTickCount());
+            searchMs.push_back(ms);
+            endToEndMs.push_back(ms + extractMs[q]);
+
+            auto relevant = truth.find(names[q]);
+            if (relevant != truth.end() && !relevant->second.empty()) {
+                size_t hits = 0;
+                for (const ImageMatch& match : matches) {
+                    hits += relevant->second.count(match.filename);
+                }
+                precisionSum += static_cast<double>(hits) / topK;
+                recallSum += static_cast<double>(hits) / relevant->second.size();
+                result.judged++;
+            }
+
+            if (index != nullptr) {
+                vector<ImageMatch> exact =
+                    searchTopK(*engine, features[q], topK, names[q], excludeSelf, true);
+                set<string> expected;
+                for (const ImageMatch& match : exact) {
+                    expected.insert(match.filename);
+                }
+                size_t hits = 0;
+                for (const ImageMatch& match : matches) {
+                    hits += expected.count(match.filename);
+                }
+                exactRecallSum += expected.empty() ? 1.0
+                    : static_cast<double>(hits) / expected.size();
+            }
+        }
+    }
+    sort(searchMs.begin(), searchMs.end());
+    sort(endToEndMs.begin(), endToEndMs.end());
+    result.searchMeanMs = mean(searchMs);
+    result.searchP50Ms = percentile(searchMs, 0.50);
+    result.searchP99Ms = percentile(searchMs, 0.99);
+    result.endToEndP50Ms = percentile(endToEndMs, 0.50);
+    result.endToEndP99Ms = percentile(endToEndMs, 0.99);
+    result.searchMs = searchMs;
+    if (result.judged > 0) {
+        result.precision = precisionSum / result.judged;
+        result.recall = recallSum / result.judged;
+    }
+    if (index != nullptr) {
+        result.recallVsExact = exactRecallSum / features.size();
+    }
+
+    // Many clients: each thread has its own engine, all share the database
+    vector<unique_ptr<ImageRetrieval>> engines;
+    {
+        QuietStdout quiet;
+        for (int t = 0; t < threads; t++) {
+            engines.push_back(t == 0 ? move(engine) : makeEngine(run, database, index));
+        }
+    }
+    const size_t total = features.size() * static_cast<size_t>(max(1, repeat));
+    atomic<size_t> next(0);
+    {
+        QuietStdout quiet;
+        const int64 start = cv::getTickCount();
+        vector<thread> clients;
+        for (int t = 0; t < threads; t++) {
+            clients.emplace_back([&, t]() {
+                for (size_t i = next++; i < total; i = next++) {
+                    engines[t]->queryWithFeatures(features[i % features.size()], topK);
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        const double seconds = elapsedMs(start, cv::getTickCount()) / 1000.0;
+        result.threads = threads;
+        result.qps = seconds > 0.0 ? total / seconds : 0.0;
+    }
+}
+
+/**
+ * Name of a combination in the harness report and for --filter
+ */
+string caseName(const BenchResult& result) {
+    return result.featureType + "/" + result.metricType + "/" + result.indexType;
+}
+
+/**
+ * Add one measured combination to the harness report: search latency as the
+ * compared distribution, everything else as extra numbers
+ */
+void addToSuite(cvcore::BenchSuite& suite, const BenchResult& result, int topK) {
+    cvcore::BenchResult& r = suite.addSamples(caseName(result), result.searchMs, 1.0, "query");
+    r.labels["database"] = result.databasePath;
+    r.extra["images"] = static_cast<double>(result.images);
+    r.extra["dimension"] = result.dimension;
+    r.extra["queries"] = static_cast<double>(result.queries);
+    r.extra["failed_queries"] = static_cast<double>(result.failed);
+    r.extra["load_ms"] = result.loadMs;
+    r.extra["index_ms"] = result.indexMs;
+    r.extra["database_bytes"] = static_cast<double>(result.databaseBytes);
+    r.extra["index_bytes"] = static_cast<double>(result.indexBytes);
+    r.extra["resident_bytes"] = static_cast<double>(result.residentBytes);
+    r.extra["extract_mean_ms"] = result.extractMeanMs;
+    r.extra["end_to_end_p50_ms"] = result.endToEndP50Ms;
+    r.extra["end_to_end_p99_ms"] = result.endToEndP99Ms;
+    r.extra["threads"] = result.threads;
+    r.extra["qps"] = result.qps;
+    r.extra["top_k"] = topK;
+    r.extra["judged_queries"] = static_cast<double>(result.judged);
+    if (result.precision >= 0.0) {
+        r.extra["precision"] = result.precision;
+        r.extra["recall"] = result.recall;
+    }
+    if (result.recallVsExact >= 0.0) {
+        r.extra["recall_vs_exact"] = result.recallVsExact;
+    }
+}
+
+string csvField(const string& value) {
+    if (value.find_first_of(",\"") == string::npos) {
+        return value;
+    }
+    string quoted = "\"";
+    for (char c : value) {
+        quoted += c == '"' ? string("\"\"") : string(1, c);
+    }
+    return quoted + "\"";
+}
+
+string optionalNumber(double value) {
+    if (value < 0.0) {
+        return "";
+    }
+    ostringstream text;
+    text << setprecision(6) << value;
+    return text.str();
+}
+
+bool writeCsv(const string& filename, const vector<BenchResult>& results, int topK) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot write " << filename << endl;
+        return false;
+    }
+    file << "feature,database,metric,index,error,images,dimension,queries,failed_queries,"
+         << "top_k,load_ms,index_ms,database_bytes,index_bytes,resident_bytes,"
+         << "extract_mean_ms,search_mean_ms,search_p50_ms,search_p99_ms,"
+         << "end_to_end_p50_ms,end_to_end_p99_ms,threads,qps,judged_queries,"
+         << "precision,recall,recall_vs_exact" << "\n";
+    for (const BenchResult& r : results) {
+        file << csvField(r.featureType) << "," << csvField(r.databasePath) << ","
+             << csvField(r.metricType) << "," << r.indexType << "," << csvField(r.error) << ","
+             << r.images << "," << r.dimension << "," << r.queries << "," << r.failed << ","
+             << topK << "," << r.loadMs << "," << r.indexMs << "," << r.databaseBytes << ","
+             << r.indexBytes << "," << r.residentBytes << "," << r.extractMeanMs << ","
+             << r.searchMeanMs << "," << r.searchP50Ms << "," << r.searchP99Ms << ","
+             << r.endToEndP50Ms << "," << r.endToEndP99Ms << "," << r.threads << ","
+             << r.qps << "," << r.judged << "," << optionalNumber(r.precision) << ","
+             << optionalNumber(r.recall) << "," << optionalNumber(r.recallVsExact) << "\n";
+    }
+    return file.good();
+}
+
+/**
+ * Console summary, one line per combination
+ */
+void displayResults(const vector<BenchResult>& results, int topK) {
+    cout << endl;
+    cout << "========================================" << endl;
+    cout << "Benchmark Results (K = " << topK << ")" << endl;
+    cout << "========================================" << endl;
+    cout << left << setw(16) << "Feature" << setw(16) << "Metric" << setw(8) << "Index"
+         << right << setw(10) << "Load ms" << setw(10) << "p50 ms" << setw(10) << "p99 ms"
+         << setw(10) << "QPS" << setw(8) << "P@K" << setw(8) << "R@K"
+         << setw(10) << "R@K/exact" << setw(10) << "Mem MB" << endl;
+    cout << string(116, '-') << endl;
+    for (const BenchResult& r : results) {
+        cout << left << setw(16) << r.featureType << setw(16) << r.metricType
+             << setw(8) << r.indexType << right;
+        if (!r.error.empty()) {
+            cout << "  " << r.error << endl;
+            continue;
+        }
+        auto quality = [](double value) {
+            ostringstream text;
+            if (value < 0.0) {
+                text << "-";
+            } else {
+                text << fixed << setprecision(3) << value;
+            }
+            return text.str();
+        };
+        cout << fixed << setprecision(1) << setw(10) << r.loadMs
+             << setprecision(3) << setw(10) << r.searchP50Ms << setw(10) << r.searchP99Ms
+             << setprecision(1) << setw(10) << r.qps
+             << setw(8) << quality(r.precision) << setw(8) << quality(r.recall)
+             << setw(10) << quality(r.recallVsExact) << setw(10)
+             << (r.databaseBytes + r.indexBytes) / (1024.0 * 1024.0) << endl;
+    }
+    cout << "========================================" << endl;
+    cout << endl;
+}
+
+} // namespace
+
+/**
+ * Main function - Benchmark retrieval combinations over a query list
+ *
+ * @param argc Argument count
+ * @param argv Argument values
+ * @return 0 if every combination ran, 1 on error
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 6) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    string querySource = argv[1];
+    vector<RunSpec> runs;
+    vector<string> indexTypes{"exact"};
+    int topK = DEFAULT_TOP_K;
+    int threads = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    int repeat = DEFAULT_REPEAT;
+    int warmup = DEFAULT_WARMUP;
+    string groundTruthPath;
+    bool excludeSelf = false;
+    int efSearch = 0;
+    int probeCount = 0;
+    bool rebuildIndex = false;
+    string csvPath;
+    cvcore::BenchOptions benchOptions;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--run" && i + 3 < argc) {
+            RunSpec run;
+            run.featureType = argv[++i];
+            run.databasePath = argv[++i];
+            run.metricType = argv[++i];
+            runs.push_back(run);
+        } else if (option == "--index" && i + 1 < argc) {
+            indexTypes.clear();
+            for (const string& type : Utils::split(argv[++i], ',')) {
+                string name = Utils::toLower(Utils::trim(type));
+                if (name != "exact" && name != "hnsw" && name != "ivfpq" && name != "pq" &&
+                    name != "opq" && name != "inverted") {
+                    cerr << "Error: Unknown index '" << type
+                         << "' (exact, hnsw, ivfpq, pq, opq, inverted)"
+                         << endl;
+                    return 1;
+                }
+                indexTypes.push_back(name);
+            }
+        } else if (option == "--top" && i + 1 < argc) {
+            topK = max(1, stoi(argv[++i]));
+        } else if (option == "--threads" && i + 1 < argc) {
+            threads = max(1, stoi(argv[++i]));
+        } else if (option == "--repeat" && i + 1 < argc) {
+            repeat = max(1, stoi(argv[++i]));
+        } else if (option == "--warmup" && i + 1 < argc) {
+            warmup = max(0, stoi(argv[++i]));
+        } else if (option == "--ground-truth" && i + 1 < argc) {
+            groundTruthPath = argv[++i];
+        } else if (option == "--exclude-self") {
+            excludeSelf = true;
+        } else if (option == "--ef" && i + 1 < argc) {
+            efSearch = stoi(argv[++i]);
+        } else if (option == "--nprobe" && i + 1 < argc) {
+            probeCount = stoi(argv[++i]);
+        } else if (option == "--rebuild-index") {
+            rebuildIndex = true;
+        } else if (option == "--csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (benchOptions.consume(i, argc, argv)) {
+            // --json, --compare, --tolerance, --metric, --filter
+        } else {
+            cerr << "Error: Unknown option '" << option << "'" << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (runs.empty()) {
+        cerr << "Error: Give at least one --run <feature_type> <feature_db> <metric>" << endl;
+        return 1;
+    }
+
+    vector<string> queryPaths;
+    map<string, set<string>> truth;
+    if (!readQueries(querySource, queryPaths) ||
+        (!groundTruthPath.empty() && !readGroundTruth(groundTruthPath, truth))) {
+        return 1;
+    }
+
+    cout << "========================================" << endl;
+    cout << "CBIR Retrieval Benchmark" << endl;
+    cout << "========================================" << endl;
+    cout << "Queries         : " << queryPaths.size() << " (" << querySource << ")" << endl;
+    cout << "Combinations    : " << runs.size() * indexTypes.size() << endl;
+    cout << "Top K           : " << topK << (excludeSelf ? " (query image excluded)" : "") << endl;
+    cout << "Client threads  : " << threads << " x " << repeat << " passes" << endl;
+    if (!groundTruthPath.empty()) {
+        cout << "Ground truth    : " << truth.size() << " queries (" << groundTruthPath << ")"
+             << endl;
+    }
+    cout << "========================================" << endl;
+    cout << endl;
+
+    cvcore::BenchSuite suite("cbirBench", benchOptions);
+    cout << "Machine         : ";
+    suite.printEnvironment(cout);
+    cout << endl;
+
+    vector<BenchResult> results;
+    bool allRan = true;
+    for (const RunSpec& run : runs) {
+        BenchResult base;
+        base.featureType = run.featureType;
+        base.databasePath = run.databasePath;
+        base.metricType = run.metricType;
+
+        cout << "Loading " << run.featureType << " database " << run.databasePath << "..." << endl;
+        FeatureDatabase database;
+        const int64 loadStart = cv::getTickCount();
+        bool loaded = Utils::fileExists(run.databasePath) && database.load(run.databasePath);
+        base.loadMs = elapsedMs(loadStart, cv::getTickCount());
+        if (loaded) {
+            cv::Mat matrix = database.matrix();
+            base.images = database.size();
+            base.dimension = matrix.cols;
+            base.databaseBytes = matrix.total() * matrix.elemSize();
+        }
+
+        for (const string& indexType : indexTypes) {
+            BenchResult result = base;
+            result.indexType = indexType;
+            if (!suite.selected(caseName(result))) {
+                continue;
+            }
+            if (!loaded) {
+                result.error = "cannot load database";
+                results.push_back(result);
+                allRan = false;
+                continue;
+            }
+
+            unique_ptr<AnnIndex> index;
+            if (indexType != "exact") {
+                AnnMetric annMetric;
+                if (!AnnIndex::metricFromName(run.metricType, annMetric)) {
+                    result.error = "indexes support ssd, cosine and histogram only";
+                    results.push_back(result);
+                    continue;
+                }
+                const int64 indexStart = cv::getTickCount();
+                index = AnnIndex::open(indexType, annMetric, database, run.databasePath,
+                                       rebuildIndex);
+                result.indexMs = elapsedMs(indexStart, cv::getTickCount());
+                if (!index) {
+                    result.error = "cannot open index";
+                    results.push_back(result);
+                    allRan = false;
+                    continue;
+                }
+                if (HnswIndex* hnsw = dynamic_cast<HnswIndex*>(index.get())) {
+                    if (efSearch > 0) {
+                        hnsw->setEfSearch(efSearch);
+                    }
+                } else if (IvfPqIndex* ivfpq = dynamic_cast<IvfPqIndex*>(index.get())) {
+                    if (probeCount > 0) {
+                        ivfpq->setProbeCount(probeCount);
+                    }
+                }
+                result.indexBytes = index->memoryBytes();
+            }
+            result.residentBytes = residentBytes();
+
+            cout << "Measuring " << run.featureType << " / " << run.metricType << " / "
+                 << indexType << "..." << endl;
+            measure(run, database, index.get(), queryPaths, truth, topK, threads, repeat,
+                    warmup, excludeSelf, result);
+            if (!result.error.empty()) {
+                cerr << "Error: " << run.featureType << " / " << run.metricType << " / "
+                     << indexType << ": " << result.error << endl;
+                allRan = false;
+            } else {
+                addToSuite(suite, result, topK);
+            }
+            results.push_back(result);
+        }
+    }
+
+    displayResults(results, topK);
+
+    if (!csvPath.empty()) {
+        if (!writeCsv(csvPath, results, topK)) {
+            return 1;
+        }
+        cout << "CSV results written to " << csvPath << endl;
+    }
+    if (!suite.finish()) {
+        return 1;
+    }
+
+    return allRan ? 0 : 1;
+}
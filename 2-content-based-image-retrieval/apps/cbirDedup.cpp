@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+// cbirDedup.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Near-duplicate detection job. Finds every group of images in
+//              a feature database whose features are within a distance
+//              threshold of each other, using LSH bucketing (DuplicateFinder)
+//              instead of one query per image, and writes the clusters.
+//
+// Usage: cbirDedup <feature_db> <metric> <threshold> [options]
+// Example: cbirDedup dnn.fdb cosine 0.02 --output duplicates.csv
+//
+// Output CSV: one line per image in a cluster of two or more,
+//             cluster,size,image (largest cluster first)
+//
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DuplicateFinder.h"
+#include "FeatureFactory.h"
+#include "Utils.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cbir;
+
+namespace {
+
+/**
+ * Print usage information and examples
+ */
+void printUsage(const char* programName) {
+    const DuplicateOptions defaults;
+    cout << "========================================" << endl;
+    cout << "CBIR Near-Duplicate Detection" << endl;
+    cout << "========================================" << endl;
+    cout << endl;
+    cout << "Usage: " << programName << " <feature_db> <metric> <threshold> [options]" << endl;
+    cout << endl;
+    cout << "Arguments:" << endl;
+    cout << "  feature_db : Feature database (.fdb binary or CSV)" << endl;
+    cout << "  metric     : Exact distance used to confirm duplicates (cosine for" << endl;
+    cout << "               dnn, histogram for histogram features, ...)" << endl;
+    cout << "  threshold  : Largest distance between two duplicates" << endl;
+    cout << endl;
+    cout << "Options:" << endl;
+    cout << "  --output <csv>     : Write cluster,size,image lines (default stdout)" << endl;
+    cout << "  --bands <n>        : Signature bands; more finds more duplicates"
+         << " (default " << defaults.bands << ")" << endl;
+    cout << "  --band-bits <n>    : Hyperplanes per band, 1-32; more means fewer"
+         << " candidates (default " << defaults.bandBits << ")" << endl;
+    cout << "  --max-bucket <n>   : Skip buckets with more images"
+         << " (default " << defaults.maxBucket << ")" << endl;
+    cout << "  --seed <n>         : Hyperplane seed" << endl;
+    cout << endl;
+    cout << "Examples:" << endl;
+    cout << "  " << programName << " dnn.fdb cosine 0.02 --output duplicates.csv" << endl;
+    cout << "  " << programName << " hist.fdb histogram 0.05 --bands 16" << endl;
+    cout << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    string databasePath = argv[1];
+    string metricType = argv[2];
+    DuplicateOptions options;
+    options.threshold = stod(argv[3]);
+    string outputPath;
+    for (int i = 4; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (option == "--bands" && i + 1 < argc) {
+            options.bands = stoi(argv[++i]);
+        } else if (option == "--band-bits" && i + 1 < argc) {
+            options.bandBits = stoi(argv[++i]);
+        } else if (option == "--max-bucket" && i + 1 < argc) {
+            options.maxBucket = static_cast<size_t>(stoull(argv[++i]));
+        } else if (option == "--seed" && i + 1 < argc) {
+            options.seed = stoull(argv[++i]);
+        } else {
+            cerr << "Error: Unknown option " << option << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    unique_ptr<DistanceMetric> metric(FeatureFactory::createMetric(metricType));
+    if (!metric) {
+        cerr << "Error: Unknown metric " << metricType << endl;
+        return 1;
+    }
+
+    FeatureDatabase database;
+    if (!Utils::fileExists(databasePath) || !database.load(databasePath)) {
+        cerr << "Error: Cannot load feature database " << databasePath << endl;
+        return 1;
+    }
+
+    // Progress goes to stderr when the clusters are written to stdout
+    ostream& log = outputPath.empty() ? cerr : cout;
+    log << "Searching " << database.size() << " images for duplicates ("
+        << metric->getMetricName() << " <= " << options.threshold << ", "
+        << options.bands << " x " << options.bandBits << "-bit bands)..." << endl;
+
+    DuplicateFinder finder(options);
+    vector<vector<int>> clusters;
+    if (!finder.find(database, *metric, clusters)) {
+        return 1;
+    }
+
+    ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot write " << outputPath << endl;
+            return 1;
+        }
+    }
+    ostream& out = outputPath.empty() ? cout : file;
+    out << "cluster,size,image\n";
+    size_t duplicates = 0;
+    for (size_t cluster = 0; cluster < clusters.size(); cluster++) {
+        for (int row : clusters[cluster]) {
+            out << cluster << "," << clusters[cluster].size() << "," << database.getName(row)
+                << "\n";
+        }
+        duplicates += clusters[cluster].size() - 1;
+    }
+    out.flush();
+
+    const DuplicateStats& stats = finder.stats();
+    log << "Signatures: " << stats.signatureMs << " ms, verification: " << stats.verifyMs
+        << " ms" << endl;
+    log << "Candidate pairs: " << stats.candidatePairs << ", within threshold: "
+        << stats.duplicatePairs << endl;
+    if (stats.skippedBuckets > 0) {
+        log << "Warning: " << stats.skippedBuckets << " buckets over " << options.maxBucket
+            << " images were skipped (raise --band-bits or --max-bucket)" << endl;
+    }
+    log << clusters.size() << " clusters, " << duplicates << " redundant images" << endl;
+    return 0;
+}
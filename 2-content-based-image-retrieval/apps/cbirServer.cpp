@@ -0,0 +1,1065 @@
+////////////////////////////////////////////////////////////////////////////////
+// cbirServer.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Long-running CBIR query server. Loads each feature database
+//              and its extractors once, then answers JSON queries over local
+//              HTTP so clients avoid the per-query start-up cost of
+//              queryImage (database load, extractor and model set-up).
+//
+// Usage: cbirServer [options] --collection <feature_type> <feature_db> <metric> ...
+// Example: cbirServer --port 8765 --threads 4
+//              --collection histogram histogram_features.csv histogram
+//              --collection dnn dnn_features.fdb cosine
+//          cbirServer --port 8700 --sharded histogram histogram
+//              10.0.0.1:8765,10.0.0.2:8765 --shard-timeout 500
+//
+// Protocol (JSON over HTTP/1.1, one request per connection):
+//   GET  /health          {"status":"ok","uptimeSeconds":...}
+//   GET  /collections     Loaded collections with feature type, metric, size
+//   GET  /stats           Per-endpoint request counts and latency percentiles,
+//                         query cache hit rates per collection
+//   GET  /metrics         The same latencies in the Prometheus text format
+//                         (cvcore metrics registry)
+//   POST /query           {"collection":"histogram","image":"a.jpg","top":10}
+//                         "images":[...] or "features":[[...],...] query a
+//                         batch; all queries are scored in one database pass
+//
+// When a thumbnail atlas (buildFeatureDB --thumbnails) lies beside a
+// database, replies name it in "thumbnails" and every match carries the
+// "thumbnail" offset and size of its blob, so clients read a few
+// contiguous bytes instead of the full-resolution image.
+//
+// Each collection caches the features and ranked matches of query images
+// (--cache-mb), so browsing the same catalogue images again skips both
+// extraction and the database scan.
+//
+// Sharded collections (--sharded) have no local database: this server
+// extracts the query features and fans them out to the shard servers
+// (ShardCoordinator), merging their top-K lists. Replies carry a "shards"
+// object; "partial":true means some shards missed the deadline.
+//
+// Queries are scheduled (QueryScheduler): --threads execution slots are
+// handed out by priority class (interactive, normal, batch; from the
+// "priority" field, or fixed per client with --client), waiting queries are
+// bounded by --queue and the lowest class is shed with 503 when it is full.
+// A query has a deadline ("timeoutMs", or the class default): it leaves the
+// queue with 504 when it passes, later queries of the request are skipped
+// and the reply is marked partial, and sharded collections give the shards
+// only the time left. Small concurrent queries of a collection share one
+// database scan (QueryCoalescer). "timing" reports the wait for a slot
+// separately from the execution.
+//
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ImageRetrieval.h"
+#include "FeatureFactory.h"
+#include "HttpServer.h"
+#include "QueryCache.h"
+#include "QueryScheduler.h"
+#include "ShardCoordinator.h"
+#include "ThumbnailAtlas.h"
+#include "Json.h"
+#include <cvcore/allocTracking.hpp>
+#include <cvcore/metrics.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace cbir;
+
+namespace {
+
+/// Matches returned when a request does not say
+const int DEFAULT_TOP_N = 10;
+
+/// Upper bound on matches per query
+const int MAX_TOP_N = 1000;
+
+/// Upper bound on queries per request
+const size_t MAX_BATCH_QUERIES = 1024;
+
+/// Latency samples kept per endpoint for percentiles
+const size_t LATENCY_WINDOW = 1024;
+
+/// Default deadline for shard requests of sharded collections
+const int DEFAULT_SHARD_TIMEOUT_MS = 1000;
+
+/// Default query cache budget per collection (MB)
+const int DEFAULT_CACHE_MB = 64;
+
+/// Default queries waiting for an execution slot
+const int DEFAULT_QUEUE_CAPACITY = 64;
+
+/// Default deadline of interactive queries (other classes have none)
+const int DEFAULT_INTERACTIVE_DEADLINE_MS = 2000;
+
+/// HTTP workers beyond slots + queue, so a new query can always be read
+/// and either queued (evicting a lower class) or shed at once
+const int SPARE_HTTP_WORKERS = 4;
+
+/**
+ * Scheduling settings from the command line
+ */
+struct SchedulingConfig {
+    size_t queueCapacity = DEFAULT_QUEUE_CAPACITY;
+    int deadlineMs[QUERY_PRIORITY_COUNT] = {DEFAULT_INTERACTIVE_DEADLINE_MS, 0, 0};  ///< 0 = none
+    map<string, QueryPriority> clients;      ///< Fixed class per client name
+};
+
+JsonValue cacheStatsToJson(const QueryCacheStats& stats) {
+    JsonValue json = JsonValue::object();
+    json.set("hits", static_cast<long long>(stats.hits));
+    json.set("misses", static_cast<long long>(stats.misses));
+    json.set("hitRate", stats.hitRate());
+    json.set("evictions", static_cast<long long>(stats.evictions));
+    json.set("entries", static_cast<long long>(stats.entries));
+    json.set("bytes", static_cast<long long>(stats.bytes));
+    json.set("capacityBytes", static_cast<long long>(stats.capacityBytes));
+    return json;
+}
+
+double elapsedMs(int64 start, int64 end) {
+    return 1000.0 * (end - start) / cv::getTickFrequency();
+}
+
+/**
+ * Request counts and a sliding window of latencies for one endpoint
+ */
+class LatencyStats {
+public:
+    LatencyStats() : count_(0), errors_(0), totalMs_(0.0), maxMs_(0.0), next_(0) {}
+
+    void record(double ms, bool ok) {
+        lock_guard<mutex> lock(mutex_);
+        count_++;
+        errors_ += ok ? 0 : 1;
+        totalMs_ += ms;
+        maxMs_ = max(maxMs_, ms);
+        if (window_.size() < LATENCY_WINDOW) {
+            window_.push_back(ms);
+        } else {
+            window_[next_] = ms;
+            next_ = (next_ + 1) % LATENCY_WINDOW;
+        }
+    }
+
+    JsonValue toJson() const {
+        lock_guard<mutex> lock(mutex_);
+        vector<double> sorted = window_;
+        sort(sorted.begin(), sorted.end());
+
+        JsonValue stats = JsonValue::object();
+        stats.set("count", static_cast<long long>(count_));
+        stats.set("errors", static_cast<long long>(errors_));
+        stats.set("meanMs", count_ > 0 ? totalMs_ / count_ : 0.0);
+        stats.set("p50Ms", percentile(sorted, 0.50));
+        stats.set("p95Ms", percentile(sorted, 0.95));
+        stats.set("p99Ms", percentile(sorted, 0.99));
+        stats.set("maxMs", maxMs_);
+        return stats;
+    }
+
+private:
+    mutable mutex mutex_;
+    size_t count_;
+    size_t errors_;
+    double totalMs_;
+    double maxMs_;
+    vector<double> window_;
+    size_t next_;
+
+    static double percentile(const vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[min(index, sorted.size() - 1)];
+    }
+};
+
+/**
+ * Gives an admitted query's execution slot back when it goes out of scope
+ */
+class SlotGuard {
+public:
+    SlotGuard(QueryScheduler& scheduler, const QueryTicket& ticket)
+        : scheduler_(scheduler), ticket_(ticket) {}
+    ~SlotGuard() { scheduler_.release(ticket_); }
+
+    SlotGuard(const SlotGuard&) = delete;
+    SlotGuard& operator=(const SlotGuard&) = delete;
+
+private:
+    QueryScheduler& scheduler_;
+    QueryTicket ticket_;
+};
+
+/**
+ * One extractor + metric pair; used by one execution slot at a time
+ */
+struct Engine {
+    ImageRetrieval retrieval;
+    FeatureExtractor* extractor = nullptr;   ///< Owned by retrieval
+};
+
+/**
+ * A feature database with one engine per execution slot
+ *
+ * Extractors keep per-image state (face detection results, scratch
+ * buffers), so workers never share one. The database itself is read-only
+ * while the server runs and is shared by all engines.
+ *
+ * A sharded collection has no local database: engines only extract, and
+ * the search runs on the shard servers through the coordinator.
+ *
+ * All engines share one query cache. Sharded collections only cache
+ * features, since the shard databases may change behind the coordinator.
+ * Local searches go through the coalescer, so concurrent small queries
+ * share a scan.
+ */
+struct Collection {
+    string name;
+    string featureType;
+    string metricType;
+    string databasePath;
+    FeatureDatabase database;
+    unique_ptr<ShardCoordinator> shards;     ///< Set for sharded collections
+    vector<unique_ptr<Engine>> engines;
+    shared_ptr<QueryCache> cache;            ///< Null when caching is off
+    ThumbnailAtlas thumbnails;               ///< "<database>.thumbs" if present
+    string thumbnailPath;                    ///< Absolute atlas path for clients
+    QueryCoalescer coalescer;                ///< Shared scans of local searches
+
+    bool open(int workers, size_t cacheBytes, ScanBackend backend) {
+        if (shards) {
+            cout << "Connecting collection '" << name << "' to " << shards->shardCount()
+                 << " shard(s)..." << endl;
+            if (!shards->connect()) {
+                return false;
+            }
+        } else {
+            cout << "Loading collection '" << name << "' from " << databasePath << "..." << endl;
+            if (!database.load(databasePath)) {
+                cerr << "Error: Failed to load feature database " << databasePath << endl;
+                return false;
+            }
+            if (thumbnails.open(ThumbnailAtlas::pathFor(databasePath))) {
+                error_code error;
+                thumbnailPath = filesystem::absolute(thumbnails.getPath(), error).string();
+                cout << "  Thumbnail atlas: " << thumbnails.size() << " images, "
+                     << thumbnails.getMaxSide() << " px " << thumbnails.getFormat() << endl;
+            }
+        }
+
+        if (cacheBytes > 0) {
+            // A quarter for result lists, the rest for feature vectors
+            const size_t resultBytes = shards ? 0 : cacheBytes / 4;
+            cache = make_shared<QueryCache>(resultBytes, cacheBytes - resultBytes);
+        }
+
+        // One device copy (or one set of node partitions) for all workers
+        shared_ptr<GpuScanner> scanner;
+        shared_ptr<NumaScanner> numaScanner;
+        if (!shards && backend == ScanBackend::Numa) {
+            numaScanner = make_shared<NumaScanner>();
+        } else if (!shards && backend != ScanBackend::Cpu) {
+            scanner = make_shared<GpuScanner>();
+        }
+
+        for (int i = 0; i < workers; i++) {
+            unique_ptr<Engine> engine(new Engine());
+            engine->extractor = FeatureFactory::createExtractor(featureType);
+            DistanceMetric* metric = FeatureFactory::createMetric(metricType);
+            if (engine->extractor == nullptr || metric == nullptr) {
+                delete engine->extractor;
+                delete metric;
+                return false;
+            }
+            if (!shards) {
+                engine->retrieval.setFeatureDatabase(&database);
+            }
+            engine->retrieval.setFeatureExtractor(engine->extractor);
+            engine->retrieval.setDistanceMetric(metric);
+            engine->retrieval.setQueryCache(cache);
+            if (scanner) {
+                engine->retrieval.setBackend(backend, scanner);
+            } else if (numaScanner) {
+                engine->retrieval.setBackend(backend, numaScanner);
+            }
+            engines.push_back(move(engine));
+        }
+
+        cout << "  " << size() << " images, " << dimension()
+             << " features, metric " << engines[0]->retrieval.getDistanceMetricName();
+        if (!decodePolicy().isFullResolution()) {
+            cout << ", " << decodePolicy().describe();
+        }
+        cout << endl;
+        return true;
+    }
+
+    size_t size() const { return shards ? shards->size() : database.size(); }
+    int dimension() const { return shards ? shards->dimension() : database.dimension(); }
+    const DecodePolicy& decodePolicy() const {
+        return shards ? shards->getDecodePolicy() : database.getDecodePolicy();
+    }
+};
+
+/**
+ * Request routing, query execution and metrics
+ */
+class QueryService {
+public:
+    QueryService(int workers, size_t cacheBytes, ScanBackend backend,
+                 const SchedulingConfig& scheduling)
+        : workers_(workers), cacheBytes_(cacheBytes), backend_(backend),
+          startTicks_(cv::getTickCount()), scheduling_(scheduling),
+          scheduler_(workers, scheduling.queueCapacity) {
+        cvcore::MetricsRegistry& metrics = cvcore::MetricsRegistry::global();
+        for (const char* path :
+             {"/query", "/health", "/collections", "/stats", "/metrics", "other"}) {
+            const string labels = string("endpoint=\"") + path + "\"";
+            requestMetrics_[path] = &metrics.histogram(
+                "cbir_request_seconds", "Accept to reply per endpoint", labels);
+            errorMetrics_[path] = &metrics.counter(
+                "cbir_request_errors_total", "Replies other than 200", labels);
+        }
+        for (const char* stage : {"queue", "extract", "search"}) {
+            queryStageMetrics_[stage] = &metrics.histogram(
+                "cbir_query_stage_seconds", "POST /query time per stage",
+                string("stage=\"") + stage + "\"");
+        }
+        for (int p = 0; p < QUERY_PRIORITY_COUNT; p++) {
+            const string cls = string("class=\"") +
+                               queryPriorityName(static_cast<QueryPriority>(p)) + "\"";
+            queueMetrics_[p] = &metrics.histogram(
+                "cbir_query_queue_seconds", "POST /query accept to execution slot", cls);
+            executionMetrics_[p] = &metrics.histogram(
+                "cbir_query_execution_seconds", "POST /query execution slot to reply", cls);
+            shedMetrics_[p] = &metrics.counter(
+                "cbir_query_shed_total", "Queries not admitted", cls + ",reason=\"busy\"");
+            expiredMetrics_[p] = &metrics.counter(
+                "cbir_query_shed_total", "Queries not admitted", cls + ",reason=\"deadline\"");
+        }
+    }
+
+    bool addCollection(const string& featureType, const string& databasePath,
+                       const string& metricType,
+                       unique_ptr<ShardCoordinator> shards = nullptr) {
+        unique_ptr<Collection> collection(new Collection());
+        collection->name = Utils::toLower(featureType);
+        collection->featureType = featureType;
+        collection->metricType = metricType;
+        collection->databasePath = databasePath;
+        collection->shards = move(shards);
+        if (collections_.count(collection->name) > 0) {
+            cerr << "Error: Duplicate collection '" << collection->name << "'" << endl;
+            return false;
+        }
+        if (!collection->open(workers_, cacheBytes_, backend_)) {
+            return false;
+        }
+        collections_[collection->name] = move(collection);
+        return true;
+    }
+
+    HttpResponse handle(const HttpRequest& request) {
+        const int64 start = cv::getTickCount();
+        HttpResponse response;
+
+        if (request.path == "/query") {
+            response = request.method == "POST" ? query(request) : error(405, "Use POST");
+        } else if (request.method != "GET") {
+            response = error(405, "Use GET");
+        } else if (request.path == "/health") {
+            JsonValue body = JsonValue::object();
+            body.set("status", "ok");
+            body.set("uptimeSeconds", uptimeSeconds());
+            response.body = body.dump();
+        } else if (request.path == "/collections") {
+            response.body = listCollections().dump();
+        } else if (request.path == "/stats") {
+            response.body = stats().dump();
+        } else if (request.path == "/metrics") {
+            response.contentType = "text/plain; version=0.0.4";
+            response.body = cvcore::MetricsRegistry::global().prometheusText();
+        } else {
+            response = error(404, "Unknown endpoint " + request.path);
+        }
+
+        const int64 end = cv::getTickCount();
+        const double totalMs = elapsedMs(request.acceptedTicks, end);
+        const bool known = requestMetrics_.count(request.path) > 0;
+        const string endpoint = known ? request.path : "other";
+        endpointStats(endpoint).record(totalMs, response.status == 200);
+        requestMetrics_.at(endpoint)->observeMs(totalMs);
+        if (response.status != 200) {
+            errorMetrics_.at(endpoint)->inc();
+        }
+
+        cout << request.method << " " << request.path << " " << response.status << " "
+             << fixed << setprecision(2) << totalMs << " ms (handler "
+             << elapsedMs(start, end) << " ms, worker " << request.worker << ")" << endl;
+        return response;
+    }
+
+private:
+    int workers_;
+    size_t cacheBytes_;
+    ScanBackend backend_;
+    int64 startTicks_;
+    map<string, unique_ptr<Collection>> collections_;
+    map<string, LatencyStats> endpointStats_;
+    mutex statsMutex_;
+
+    // Registry metrics, looked up once (read-only after construction)
+    map<string, cvcore::Histogram*> requestMetrics_;
+    map<string, cvcore::Counter*> errorMetrics_;
+    map<string, cvcore::Histogram*> queryStageMetrics_;
+    cvcore::Histogram* queueMetrics_[QUERY_PRIORITY_COUNT];
+    cvcore::Histogram* executionMetrics_[QUERY_PRIORITY_COUNT];
+    cvcore::Counter* shedMetrics_[QUERY_PRIORITY_COUNT];
+    cvcore::Counter* expiredMetrics_[QUERY_PRIORITY_COUNT];
+
+    // Admission control
+    SchedulingConfig scheduling_;
+    QueryScheduler scheduler_;
+    LatencyStats queueStats_[QUERY_PRIORITY_COUNT];       ///< Accept to slot (ms)
+    LatencyStats executionStats_[QUERY_PRIORITY_COUNT];   ///< Slot to reply (ms)
+
+    double uptimeSeconds() const {
+        return (cv::getTickCount() - startTicks_) / cv::getTickFrequency();
+    }
+
+    LatencyStats& endpointStats(const string& path) {
+        lock_guard<mutex> lock(statsMutex_);
+        return endpointStats_[path];   // map nodes are stable once inserted
+    }
+
+    static HttpResponse error(int status, const string& message) {
+        JsonValue body = JsonValue::object();
+        body.set("error", message);
+        HttpResponse response;
+        response.status = status;
+        response.body = body.dump();
+        return response;
+    }
+
+    JsonValue listCollections() const {
+        JsonValue list = JsonValue::array();
+        for (const auto& entry : collections_) {
+            const Collection& collection = *entry.second;
+            JsonValue item = JsonValue::object();
+            item.set("name", collection.name);
+            item.set("feature", collection.featureType);
+            item.set("metric", collection.metricType);
+            item.set("database", collection.databasePath);
+            item.set("images", static_cast<long long>(collection.size()));
+            item.set("dimension", collection.dimension());
+            item.set("decode", collection.decodePolicy().describe());
+            item.set("decodeReduction", collection.decodePolicy().reduction);
+            item.set("decodeMaxSide", collection.decodePolicy().maxSide);
+            if (collection.shards) {
+                item.set("shards", static_cast<long long>(collection.shards->shardCount()));
+            }
+            if (collection.thumbnails.isOpen()) {
+                item.set("thumbnails", collection.thumbnailPath);
+            }
+            list.push(move(item));
+        }
+        return list;
+    }
+
+    JsonValue stats() {
+        JsonValue body = JsonValue::object();
+        body.set("uptimeSeconds", uptimeSeconds());
+        body.set("threads", workers_);
+        JsonValue endpoints = JsonValue::object();
+        {
+            lock_guard<mutex> lock(statsMutex_);
+            for (const auto& entry : endpointStats_) {
+                endpoints.set(entry.first, entry.second.toJson());
+            }
+        }
+        body.set("endpoints", move(endpoints));
+
+        JsonValue caches = JsonValue::object();
+        for (const auto& entry : collections_) {
+            const Collection& collection = *entry.second;
+            if (collection.cache) {
+                JsonValue cache = JsonValue::object();
+                cache.set("results", cacheStatsToJson(collection.cache->resultStats()));
+                cache.set("features", cacheStatsToJson(collection.cache->featureStats()));
+                caches.set(collection.name, move(cache));
+            }
+        }
+        body.set("caches", move(caches));
+
+        JsonValue scheduler = JsonValue::object();
+        scheduler.set("slots", scheduler_.getSlots());
+        scheduler.set("queueCapacity", static_cast<long long>(scheduler_.getQueueCapacity()));
+        scheduler.set("running", scheduler_.running());
+        for (int p = 0; p < QUERY_PRIORITY_COUNT; p++) {
+            const QueryPriority priority = static_cast<QueryPriority>(p);
+            const SchedulerClassStats counts = scheduler_.stats(priority);
+            JsonValue item = JsonValue::object();
+            item.set("deadlineMs", scheduling_.deadlineMs[p]);
+            item.set("admitted", static_cast<long long>(counts.admitted));
+            item.set("shed", static_cast<long long>(counts.shed));
+            item.set("expired", static_cast<long long>(counts.expired));
+            item.set("queued", static_cast<long long>(counts.queued));
+            item.set("queue", queueStats_[p].toJson());
+            item.set("execution", executionStats_[p].toJson());
+            scheduler.set(queryPriorityName(priority), move(item));
+        }
+        body.set("scheduler", move(scheduler));
+
+        JsonValue coalescing = JsonValue::object();
+        for (const auto& entry : collections_) {
+            const Collection& collection = *entry.second;
+            if (!collection.shards) {
+                JsonValue item = JsonValue::object();
+                item.set("scans", static_cast<long long>(collection.coalescer.getScans()));
+                item.set("requests", static_cast<long long>(collection.coalescer.getRequests()));
+                coalescing.set(collection.name, move(item));
+            }
+        }
+        body.set("coalescing", move(coalescing));
+        return body;
+    }
+
+    /**
+     * Class of a request: fixed for a client named with --client, else the
+     * "priority" field or X-Cbir-Priority header (default normal)
+     */
+    QueryPriority requestPriority(const HttpRequest& request, const JsonValue& body) const {
+        string client = body.get("client").asString();
+        auto header = request.headers.find("x-cbir-client");
+        if (client.empty() && header != request.headers.end()) {
+            client = header->second;
+        }
+        auto mapped = scheduling_.clients.find(Utils::toLower(client));
+        if (mapped != scheduling_.clients.end()) {
+            return mapped->second;
+        }
+
+        string name = body.get("priority").asString();
+        header = request.headers.find("x-cbir-priority");
+        if (name.empty() && header != request.headers.end()) {
+            name = header->second;
+        }
+        QueryPriority priority = QueryPriority::Normal;
+        parseQueryPriority(name, priority);
+        return priority;
+    }
+
+    /**
+     * POST /query: wait for an execution slot, extract every query, then
+     * one batched database pass
+     *
+     * Queries that fail (unreadable image, missing embedding, wrong
+     * dimension) get an "error" entry; the rest are still answered.
+     * Image queries seen before are answered from the collection cache
+     * and never reach the batch. Queries still to be extracted or searched
+     * when the deadline passes get an error and the reply is partial.
+     */
+    HttpResponse query(const HttpRequest& request) {
+        JsonValue body;
+        string parseError;
+        if (!JsonValue::parse(request.body, body, &parseError) || !body.isObject()) {
+            return error(400, "Invalid JSON: " + parseError);
+        }
+
+        const string name = Utils::toLower(body.get("collection").asString());
+        auto found = collections_.find(name);
+        if (found == collections_.end()) {
+            return error(404, "Unknown collection '" + name + "'");
+        }
+        Collection& collection = *found->second;
+
+        const int topN = static_cast<int>(body.get("top").asNumber(DEFAULT_TOP_N));
+        if (topN <= 0 || topN > MAX_TOP_N) {
+            return error(400, "\"top\" must be between 1 and " + to_string(MAX_TOP_N));
+        }
+
+        // Query list: a single image, a batch of images, or raw feature rows
+        JsonValue images = JsonValue::array();
+        if (body.has("image")) {
+            images.push(body.get("image"));
+        } else if (body.get("images").isArray()) {
+            images = body.get("images");
+        }
+        const JsonValue& features = body.get("features");
+        const size_t queryCount = images.size() + features.size();
+        if (queryCount == 0) {
+            return error(400, "Request needs \"image\", \"images\" or \"features\"");
+        }
+        if (queryCount > MAX_BATCH_QUERIES) {
+            return error(400, "At most " + to_string(MAX_BATCH_QUERIES) + " queries per request");
+        }
+
+        // Admission: the deadline runs from accept, so time spent waiting
+        // for an HTTP worker or a slot counts against it
+        const QueryPriority priority = requestPriority(request, body);
+        const int cls = static_cast<int>(priority);
+        const double requestedMs = body.get("timeoutMs").asNumber(0);
+        const double deadlineMs = requestedMs > 0 ? requestedMs : scheduling_.deadlineMs[cls];
+        auto remainingMs = [&]() {
+            return deadlineMs - elapsedMs(request.acceptedTicks, cv::getTickCount());
+        };
+        auto expired = [&]() { return deadlineMs > 0 && remainingMs() <= 0.0; };
+
+        const QueryTicket ticket =
+            scheduler_.acquire(priority, deadlineMs > 0 ? max(0.0, remainingMs()) : -1.0);
+        if (!ticket.admitted) {
+            if (ticket.status == 504) {
+                expiredMetrics_[cls]->inc();
+            } else {
+                shedMetrics_[cls]->inc();
+            }
+            return error(ticket.status, ticket.reason);
+        }
+        SlotGuard slotGuard(scheduler_, ticket);
+        Engine& engine = *collection.engines[ticket.slot % collection.engines.size()];
+        const int64 admitted = cv::getTickCount();
+        bool partial = false;
+
+        // Extraction (per query) into one batch matrix
+        const int dimension = collection.dimension();
+        cv::Mat batch(0, dimension, CV_32F);
+        vector<JsonValue> results(queryCount);
+        vector<size_t> batchSlots;
+        QueryCache* cache = collection.cache.get();
+        vector<uint64_t> imageKeys(images.size(), 0);
+        size_t cached = 0;
+
+        auto setMatches = [&](size_t slot, const vector<ImageMatch>& matches) {
+            JsonValue list = JsonValue::array();
+            for (const ImageMatch& match : matches) {
+                JsonValue item = JsonValue::object();
+                item.set("filename", match.filename);
+                item.set("distance", match.distance);
+                ThumbnailEntry thumbnail;
+                if (collection.thumbnails.find(match.filename, thumbnail)) {
+                    JsonValue location = JsonValue::object();
+                    location.set("offset", static_cast<long long>(thumbnail.offset));
+                    location.set("size", static_cast<long long>(thumbnail.size));
+                    item.set("thumbnail", move(location));
+                }
+                list.push(move(item));
+            }
+            if (list.size() == 0) {
+                results[slot].set("error", "No matches found");
+            }
+            results[slot].set("matches", move(list));
+        };
+        auto resultKey = [&](size_t slot) {
+            ResultKey key;
+            key.imageHash = imageKeys[slot];
+            key.scope = collection.featureType + "|" + collection.metricType;
+            key.topN = topN;
+            key.databaseVersion = collection.database.version();
+            return key;
+        };
+
+        auto addRow = [&](size_t slot, const cv::Mat& row) {
+            cv::Mat flat;
+            cv::Mat continuous = row.isContinuous() ? row : row.clone();
+            continuous.reshape(1, 1).convertTo(flat, CV_32F);
+            if (flat.cols != dimension) {
+                results[slot].set("error", "Query has " + to_string(flat.cols) +
+                                  " features, database has " + to_string(dimension));
+                return;
+            }
+            batch.push_back(flat);
+            batchSlots.push_back(slot);
+        };
+
+        for (size_t i = 0; i < images.size(); i++) {
+            // Decode and extraction of one query (CVCORE_ALLOC_TRACKING builds)
+            CVCORE_ALLOC_SCOPE("cbir extract");
+            const string path = images.at(i).asString();
+            results[i] = JsonValue::object();
+            results[i].set("query", path);
+            if (expired()) {
+                results[i].set("error", "Deadline passed before extraction");
+                partial = true;
+                continue;
+            }
+            cv::Mat image = path.empty() ? cv::Mat()
+                                         : collection.decodePolicy().load(path);
+            if (image.empty()) {
+                results[i].set("error", "Cannot read image '" + path + "'");
+                continue;
+            }
+
+            cv::Mat row;
+            if (cache != nullptr) {
+                // Embedding extractors look features up by file name, so the
+                // name is part of the key as well as the pixels
+                imageKeys[i] = QueryCache::hashImage(image) ^
+                               (hash<string>()(path) * 0x9E3779B97F4A7C15ULL);
+                vector<ImageMatch> matches;
+                if (cache->findResults(resultKey(i), matches)) {
+                    setMatches(i, matches);
+                    cached++;
+                    continue;
+                }
+                cache->findFeatures(imageKeys[i], collection.featureType, row);
+            }
+            if (row.empty()) {
+                row = FeatureFactory::extractQueryFeatures(engine.extractor, image, path);
+                if (row.empty()) {
+                    results[i].set("error", "Feature extraction failed");
+                    continue;
+                }
+                if (cache != nullptr) {
+                    cache->insertFeatures(imageKeys[i], collection.featureType, row);
+                }
+            }
+            addRow(i, row);
+        }
+
+        for (size_t i = 0; i < features.size(); i++) {
+            const size_t slot = images.size() + i;
+            const JsonValue& values = features.at(i);
+            results[slot] = JsonValue::object();
+            results[slot].set("query", static_cast<int>(i));
+            if (!values.isArray() || values.size() == 0) {
+                results[slot].set("error", "Feature vector must be a non-empty array");
+                continue;
+            }
+            cv::Mat row(1, static_cast<int>(values.size()), CV_32F);
+            for (size_t j = 0; j < values.size(); j++) {
+                row.at<float>(static_cast<int>(j)) = static_cast<float>(values.at(j).asNumber());
+            }
+            addRow(slot, row);
+        }
+        const int64 extracted = cv::getTickCount();
+
+        // Search: every extracted query in one pass over the database
+        // (shared with concurrent requests), or one request per shard given
+        // the time left
+        ShardReport shardReport;
+        int scanRows = 0;
+        if (!batchSlots.empty() && expired()) {
+            for (size_t slot : batchSlots) {
+                results[slot].set("error", "Deadline passed before the search");
+            }
+            partial = true;
+        } else if (!batchSlots.empty()) {
+            CVCORE_ALLOC_SCOPE("cbir search");
+            vector<vector<ImageMatch>> matches;
+            if (collection.shards) {
+                int timeoutMs = 0;   // coordinator default
+                if (deadlineMs > 0) {
+                    const int left = max(1, static_cast<int>(remainingMs()));
+                    timeoutMs = requestedMs > 0 ? left
+                                                : min(left, collection.shards->getTimeoutMs());
+                }
+                matches = collection.shards->query(batch, topN, &shardReport, timeoutMs,
+                                                   queryPriorityName(priority));
+                partial = partial || shardReport.partial();
+            } else {
+                matches = collection.coalescer.search(
+                    batch, topN, priority,
+                    [&engine](const cv::Mat& rows, int n) {
+                        return engine.retrieval.queryBatch(rows, n);
+                    },
+                    &scanRows);
+            }
+            for (size_t b = 0; b < batchSlots.size(); b++) {
+                const size_t slot = batchSlots[b];
+                setMatches(slot, matches[b]);
+                if (cache != nullptr && !collection.shards && slot < images.size() &&
+                    !matches[b].empty()) {
+                    cache->insertResults(resultKey(slot), matches[b]);
+                }
+            }
+        }
+        const int64 searched = cv::getTickCount();
+
+        JsonValue reply = JsonValue::object();
+        reply.set("collection", collection.name);
+        reply.set("metric", collection.metricType);
+        reply.set("priority", queryPriorityName(priority));
+        reply.set("partial", partial);
+        JsonValue resultList = JsonValue::array();
+        for (auto& result : results) {
+            resultList.push(move(result));
+        }
+        reply.set("results", move(resultList));
+        if (collection.shards) {
+            reply.set("shards", shardsToJson(shardReport, collection.shards->shardCount()));
+        }
+        if (collection.thumbnails.isOpen()) {
+            reply.set("thumbnails", collection.thumbnailPath);
+        }
+
+        const double queueMs = elapsedMs(request.acceptedTicks, admitted);
+        const double executionMs = elapsedMs(admitted, searched);
+        queryStageMetrics_.at("queue")->observeMs(queueMs);
+        queryStageMetrics_.at("extract")->observeMs(elapsedMs(admitted, extracted));
+        queryStageMetrics_.at("search")->observeMs(elapsedMs(extracted, searched));
+        queueMetrics_[cls]->observeMs(queueMs);
+        executionMetrics_[cls]->observeMs(executionMs);
+        queueStats_[cls].record(queueMs, true);
+        executionStats_[cls].record(executionMs, true);
+
+        JsonValue timing = JsonValue::object();
+        timing.set("queueMs", queueMs);
+        timing.set("admissionMs", ticket.waitMs);
+        timing.set("executionMs", executionMs);
+        timing.set("extractMs", elapsedMs(admitted, extracted));
+        timing.set("searchMs", elapsedMs(extracted, searched));
+        timing.set("totalMs", elapsedMs(request.acceptedTicks, searched));
+        timing.set("cached", static_cast<long long>(cached));
+        if (scanRows > 0) {
+            timing.set("scanQueries", scanRows);
+        }
+        reply.set("timing", move(timing));
+
+        HttpResponse response;
+        response.body = reply.dump();
+        return response;
+    }
+
+    /**
+     * Shard outcomes of one request: counts plus every shard that failed
+     */
+    static JsonValue shardsToJson(const ShardReport& report, size_t shardCount) {
+        JsonValue shards = JsonValue::object();
+        shards.set("total", static_cast<long long>(shardCount));
+        shards.set("answered", report.answered);
+        shards.set("partial", report.shards.empty() ? false : report.partial());
+        shards.set("fanoutMs", report.elapsedMs);
+        JsonValue failed = JsonValue::array();
+        for (const ShardStatus& status : report.shards) {
+            if (!status.answered) {
+                JsonValue item = JsonValue::object();
+                item.set("shard", status.endpoint);
+                item.set("error", status.error);
+                item.set("ms", status.ms);
+                failed.push(move(item));
+            }
+        }
+        shards.set("failed", move(failed));
+        return shards;
+    }
+};
+
+} // namespace
+
+/**
+ * Print usage information and examples
+ */
+void printUsage(const char* programName) {
+    cout << "========================================" << endl;
+    cout << "CBIR Query Server" << endl;
+    cout << "========================================" << endl;
+    cout << endl;
+    cout << "Usage: " << programName << " [options] --collection <feature_type> <feature_db> <metric> ..." << endl;
+    cout << endl;
+    cout << "Options:" << endl;
+    cout << "  --collection <feature_type> <feature_db> <metric>" << endl;
+    cout << "                   : Serve a database (repeatable); queries name it by" << endl;
+    cout << "                     feature type, arguments as for queryImage" << endl;
+    cout << "  --sharded <feature_type> <metric> <host:port,...>" << endl;
+    cout << "                   : Serve a collection split over shard servers" << endl;
+    cout << "                     (buildFeatureDB --shards); queries are extracted" << endl;
+    cout << "                     here and fanned out, top-K lists merged" << endl;
+    cout << "  --shard-timeout <ms> : Deadline per shard request (default "
+         << DEFAULT_SHARD_TIMEOUT_MS << "); late" << endl;
+    cout << "                     shards are left out and the reply is marked partial" << endl;
+    cout << "  --host <address> : IPv4 address to bind (default 127.0.0.1)" << endl;
+    cout << "  --port <n>       : TCP port (default 8765)" << endl;
+    cout << "  --threads <n>    : Queries executing at once (default: hardware threads, max 8)" << endl;
+    cout << "  --queue <n>      : Queries waiting for a slot (default "
+         << DEFAULT_QUEUE_CAPACITY << "); when full, the" << endl;
+    cout << "                     lowest class is shed with 503" << endl;
+    cout << "  --client <name>=<class> : Fixed class for a client (repeatable); classes" << endl;
+    cout << "                     are interactive, normal and batch" << endl;
+    cout << "  --deadline <class>=<ms> : Default deadline of a class (0 = none; default" << endl;
+    cout << "                     interactive " << DEFAULT_INTERACTIVE_DEADLINE_MS
+         << ", others none)" << endl;
+    cout << "  --cache-mb <n>   : Query feature / result cache per collection (default "
+         << DEFAULT_CACHE_MB << ", 0 = off)" << endl;
+    cout << "  --backend <name> : Exhaustive scans on cpu (default), gpu or auto (OpenCL," << endl;
+    cout << "                     ssd and cosine; one device copy per collection), or" << endl;
+    cout << "                     numa (node-local partitions, one set per collection)" << endl;
+    cout << endl;
+    cout << "Endpoints:" << endl;
+    cout << "  GET  /health, /collections, /stats, /metrics (Prometheus)" << endl;
+    cout << "  POST /query  {\"collection\":\"histogram\",\"image\":\"pic.0164.jpg\",\"top\":5}" << endl;
+    cout << "               (\"images\":[...] or \"features\":[[...]] for a batch," << endl;
+    cout << "               \"priority\":\"interactive\", \"timeoutMs\":500 optional)" << endl;
+    cout << endl;
+    cout << "Examples:" << endl;
+    cout << "  " << programName << " --collection histogram histogram_features.csv histogram" << endl;
+    cout << "  " << programName << " --port 9000 --threads 4 --collection dnn dnn_features.fdb cosine" << endl;
+    cout << "  " << programName << " --client eval=batch --deadline normal=5000 --collection dnn dnn_features.fdb cosine" << endl;
+    cout << endl;
+}
+
+/**
+ * Main function - Load collections and serve until terminated
+ *
+ * @param argc Argument count
+ * @param argv Argument values
+ * @return 0 on clean shutdown, 1 on error
+ */
+int main(int argc, char* argv[]) {
+    string host = "127.0.0.1";
+    int port = 8765;
+    int threads = static_cast<int>(min(8u, max(1u, thread::hardware_concurrency())));
+    struct CollectionArgs {
+        string featureType;
+        string databasePath;
+        string metricType;
+    };
+    vector<CollectionArgs> collectionArgs;
+    struct ShardedArgs {
+        string featureType;
+        string metricType;
+        string shardList;
+    };
+    vector<ShardedArgs> shardedArgs;
+    int shardTimeoutMs = DEFAULT_SHARD_TIMEOUT_MS;
+    int cacheMb = DEFAULT_CACHE_MB;
+    ScanBackend backend = ScanBackend::Cpu;
+    SchedulingConfig scheduling;
+
+    // "<name>=<class>" / "<class>=<ms>" option values
+    auto splitAssignment = [](const string& text, string& key, string& value) {
+        const size_t equals = text.find('=');
+        if (equals == string::npos || equals == 0) {
+            return false;
+        }
+        key = Utils::trim(text.substr(0, equals));
+        value = Utils::trim(text.substr(equals + 1));
+        return !value.empty();
+    };
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--collection" && i + 3 < argc) {
+            collectionArgs.push_back({argv[i + 1], argv[i + 2], argv[i + 3]});
+            i += 3;
+        } else if (option == "--sharded" && i + 3 < argc) {
+            shardedArgs.push_back({argv[i + 1], argv[i + 2], argv[i + 3]});
+            i += 3;
+        } else if (option == "--shard-timeout" && i + 1 < argc) {
+            shardTimeoutMs = max(1, stoi(argv[++i]));
+        } else if (option == "--host" && i + 1 < argc) {
+            host = argv[++i];
+        } else if (option == "--port" && i + 1 < argc) {
+            port = stoi(argv[++i]);
+        } else if (option == "--threads" && i + 1 < argc) {
+            threads = max(1, stoi(argv[++i]));
+        } else if (option == "--queue" && i + 1 < argc) {
+            scheduling.queueCapacity = static_cast<size_t>(max(0, stoi(argv[++i])));
+        } else if (option == "--client" && i + 1 < argc) {
+            string client, className;
+            QueryPriority priority;
+            if (!splitAssignment(argv[++i], client, className) ||
+                !parseQueryPriority(className, priority)) {
+                cerr << "Error: Invalid --client '" << argv[i]
+                     << "' (use <name>=interactive|normal|batch)" << endl;
+                return 1;
+            }
+            scheduling.clients[Utils::toLower(client)] = priority;
+        } else if (option == "--deadline" && i + 1 < argc) {
+            string className, value;
+            QueryPriority priority;
+            if (!splitAssignment(argv[++i], className, value) ||
+                !parseQueryPriority(className, priority)) {
+                cerr << "Error: Invalid --deadline '" << argv[i]
+                     << "' (use interactive|normal|batch=<ms>)" << endl;
+                return 1;
+            }
+            scheduling.deadlineMs[static_cast<int>(priority)] = max(0, stoi(value));
+        } else if (option == "--cache-mb" && i + 1 < argc) {
+            cacheMb = max(0, stoi(argv[++i]));
+        } else if (option == "--backend" && i + 1 < argc) {
+            if (!parseScanBackend(argv[++i], backend)) {
+                cerr << "Error: Unknown backend '" << argv[i] << "' (use cpu, gpu, auto or numa)" << endl;
+                return 1;
+            }
+        } else {
+            cerr << "Error: Unknown option '" << option << "'" << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (collectionArgs.empty() && shardedArgs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    cout << "========================================" << endl;
+    cout << "CBIR Query Server" << endl;
+    cout << "========================================" << endl;
+
+    QueryService service(threads, static_cast<size_t>(cacheMb) << 20, backend, scheduling);
+    for (const auto& args : collectionArgs) {
+        if (!Utils::fileExists(args.databasePath)) {
+            cerr << "Error: Feature database does not exist: " << args.databasePath << endl;
+            return 1;
+        }
+        if (!service.addCollection(args.featureType, args.databasePath, args.metricType)) {
+            return 1;
+        }
+    }
+    for (const auto& args : shardedArgs) {
+        vector<HttpEndpoint> endpoints;
+        for (const string& text : Utils::split(args.shardList, ',')) {
+            HttpEndpoint endpoint;
+            if (!HttpEndpoint::parse(Utils::trim(text), endpoint)) {
+                cerr << "Error: Invalid shard address '" << text << "' (use host:port)" << endl;
+                return 1;
+            }
+            endpoints.push_back(endpoint);
+        }
+        unique_ptr<ShardCoordinator> coordinator(
+            new ShardCoordinator(args.featureType, endpoints, shardTimeoutMs));
+        if (endpoints.empty() ||
+            !service.addCollection(args.featureType, "", args.metricType, move(coordinator))) {
+            return 1;
+        }
+    }
+
+    HttpServer server;
+    server.setHandler([&service](const HttpRequest& request) {
+        return service.handle(request);
+    });
+    // Queries hold an HTTP worker while they wait for a slot, so there is
+    // one per slot and queue entry, plus spares to answer everything else
+    const int httpWorkers =
+        threads + static_cast<int>(scheduling.queueCapacity) + SPARE_HTTP_WORKERS;
+    if (!server.start(host, port, httpWorkers)) {
+        return 1;
+    }
+
+    cout << "========================================" << endl;
+    cout << "Listening on http://" << host << ":" << server.getPort()
+         << " (" << threads << " query slots, queue " << scheduling.queueCapacity
+         << ", " << httpWorkers << " HTTP workers)" << endl;
+    cout << "========================================" << endl;
+
+    // /metrics is always served; CVCORE_STATSD adds a push to StatsD
+    cvcore::startMetricsFromEnvironment("cbirServer");
+
+    server.wait();
+    return 0;
+}
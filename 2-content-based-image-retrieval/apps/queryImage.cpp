@@ -5,8 +5,10 @@
 //              Loads pre-computed features and returns the top N most similar
 //              images from the database based on specified distance metric.
 //
-// Usage: queryImage <target_image> <feature_csv> <feature_type> <metric> <topN>
+// Usage: queryImage <target_image> <feature_csv> <feature_type> <metric> <topN> [options]
 // Example: queryImage data/images/pic.0164.jpg histogram_features.csv histogram histogram 3
+//          queryImage pic.0164.jpg dnn_features.fdb dnn cosine 10 --ann hnsw --recall
+//          queryImage pic.0164.jpg face.fdb faceaware faceaware 5 --prefilter histogram hist.fdb histogram
 //
 // Workflow:
 //   1. Load pre-computed features from CSV into memory
@@ -18,28 +20,22 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "ImageRetrieval.h"
-#include "BaselineFeature.h"
-#include "SSDMetric.h"
-#include "HistogramFeature.h"
-#include "HistogramIntersection.h"
-#include "MultiHistogramFeature.h"
-#include "MultiRegionHistogramIntersection.h"
-#include "TextureColorFeature.h"
-#include "WeightedHistogramIntersection.h"
-#include "GaborTextureColorFeature.h"
-#include "DNNFeature.h"
-#include "CosineDistance.h"
-#include "ProductMatcherFeature.h"
-#include "ProductMatcherDistance.h"
+#include "FeatureFactory.h"
 #include "FaceAwareFeature.h"
-#include "FaceAwareDistance.h"
+#include "AnnIndex.h"
+#include "HnswIndex.h"
+#include "IvfPqIndex.h"
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <memory>
 
 using namespace std;
 using namespace cbir;
 
+/// Candidates reranked by default in two-stage queries
+const int DEFAULT_CANDIDATES = 200;
+
 /**
  * Print usage information and examples
  */
@@ -48,172 +44,57 @@ void printUsage(const char* programName) {
     cout << "CBIR Image Query System" << endl;
     cout << "========================================" << endl;
     cout << endl;
-    cout << "Usage: " << programName << " <target_image> <feature_csv> <feature_type> <metric> <topN>" << endl;
+    cout << "Usage: " << programName << " <target_image> <feature_csv> <feature_type> <metric> <topN> [options]" << endl;
     cout << endl;
     cout << "Arguments:" << endl;
     cout << "  target_image : Path to query image" << endl;
-    cout << "  feature_csv  : CSV file with pre-computed features" << endl;
+    cout << "  feature_csv  : CSV or binary (.fdb) file with pre-computed features" << endl;
     cout << "  feature_type : Type of features (must match CSV)" << endl;
     cout << "                 Options: baseline, histogram, chromaticity," << endl;
-    cout << "                          multihistogram, texturecolor, gabor," << endl;
+    cout << "                          multihistogram, pyramid, texturecolor, gabor," << endl;
     cout << "                          dnn, productmatcher" << endl;
     cout << "  metric       : Distance metric to use" << endl;
-    cout << "                 Options: ssd, histogram, multiregion," << endl;
+    cout << "                 Options: ssd, histogram, multiregion, pyramid," << endl;
     cout << "                          weighted, gabor, cosine, productmatcher" << endl;
     cout << "  topN         : Number of top matches to return" << endl;
     cout << endl;
+    cout << "Options (indexed search):" << endl;
+    cout << "  --ann <type>      : Use an index: hnsw, ivfpq, pq or opq (ssd, cosine)," << endl;
+    cout << "                      or inverted (histogram; exact, for sparse histograms)" << endl;
+    cout << "                      (built on first use, saved as <feature_csv>.<type>)" << endl;
+    cout << "  --rebuild-index   : Rebuild the ANN index even if a saved one exists" << endl;
+    cout << "  --ef <n>          : HNSW search beam width (default 64)" << endl;
+    cout << "  --nprobe <n>      : IVF-PQ lists visited per query (default 16)" << endl;
+    cout << "  --recall [n]      : Report recall@topN against exact search on n" << endl;
+    cout << "                      database rows (default 100)" << endl;
+    cout << endl;
+    cout << "Options (exhaustive search):" << endl;
+    cout << "  --backend <name>  : cpu (default), gpu, auto or numa. gpu scans ssd and cosine" << endl;
+    cout << "                      queries on the OpenCL device; auto only for databases of" << endl;
+    cout << "                      " << ImageRetrieval::AUTO_GPU_MIN_ROWS
+         << "+ images. Falls back to the CPU otherwise." << endl;
+    cout << "                      numa scans per-node copies with node-pinned threads." << endl;
+    cout << endl;
+    cout << "Options (two-stage retrieval for expensive metrics):" << endl;
+    cout << "  --prefilter <feature_type> <feature_db> <metric>" << endl;
+    cout << "                    : Select candidates with a cheap feature database first" << endl;
+    cout << "                      (e.g. baseline or histogram), then rerank them with" << endl;
+    cout << "                      <metric>. With --prefilter, --ann indexes the" << endl;
+    cout << "                      prefilter database." << endl;
+    cout << "  --candidates <n>  : Candidates reranked (default " << DEFAULT_CANDIDATES << ")" << endl;
+    cout << endl;
     cout << "Examples:" << endl;
     cout << "  " << programName << " pic.1016.jpg baseline_features.csv baseline ssd 3" << endl;
     cout << "  " << programName << " pic.0164.jpg histogram_features.csv histogram histogram 3" << endl;
     cout << "  " << programName << " pic.0274.jpg multi_features.csv multihistogram multiregion 3" << endl;
     cout << "  " << programName << " pic.1072.jpg product_features.csv productmatcher productmatcher 5" << endl;
+    cout << "  " << programName << " pic.1072.jpg dnn_features.fdb dnn cosine 10 --ann hnsw --recall" << endl;
+    cout << "  " << programName << " pic.0164.jpg histogram_features.fdb histogram histogram 10 --ann inverted" << endl;
+    cout << "  " << programName << " pic.1072.jpg product_features.fdb productmatcher productmatcher 5 \\" << endl;
+    cout << "      --prefilter dnn dnn_features.fdb cosine --ann hnsw --candidates 100" << endl;
     cout << endl;
 }
 
-/**
- * Factory function to create appropriate feature extractor based on type
- * 
- * Must match the feature type used when building the database!
- * 
- * Supports:
- *   - "baseline": 7x7 center square feature
- *   - "histogram" or "rgb": RGB histogram (8 bins per channel)
- *   - "chromaticity" or "rg": RG chromaticity histogram (16 bins per channel)
- * 
- * @param featureType Type of feature extractor to create
- * @return Pointer to created feature extractor, nullptr if type unknown
- */
-cbir::FeatureExtractor* createFeatureExtractor(const string& featureType) {
-    string type = cbir::Utils::toLower(featureType);
-    
-    if (type == "baseline") {
-        return new cbir::BaselineFeature();
-    } else if (type == "histogram" || type == "rgb") {
-        return new cbir::HistogramFeature(
-            cbir::HistogramFeature::HistogramType::RGB, 
-            8, true
-        );
-    } else if (type == "chromaticity" || type == "rg") {
-        return new cbir::HistogramFeature(
-            cbir::HistogramFeature::HistogramType::RG_CHROMATICITY, 
-            16, true
-        );
-    } else if (type == "multihistogram" || type == "multi") {
-        // Task 3: MUST match buildFeatureDB parameters!
-        // GRID split, 4 regions (2×2 quadrants)
-        // Total: 4 × 512 = 2048 values
-        return new cbir::MultiHistogramFeature(
-            cbir::MultiHistogramFeature::SplitType::GRID,
-            4,
-            cbir::HistogramFeature::HistogramType::RGB,
-            8,
-            true
-        );
-    } else if (type == "texturecolor" || type == "texture") {
-        // Texture + Color: Sobel gradient histogram + RGB histogram
-        // Texture: 16 bins (gradient magnitudes 0-255)
-        // Color: 8 bins per channel (8×8×8 = 512 bins)
-        // Total: 16 + 512 = 528 values
-        return new cbir::TextureColorFeature(
-            16,   // texture bins
-            8,    // color bins per channel
-            true  // normalize
-        );
-    } else if (type == "gabor" || type == "gaborcolor") {
-        // Task 4 Extension: Gabor texture + Color
-        // 4 orientations × 2 scales × 8 bins = 64 texture bins
-        // 8×8×8 = 512 color bins
-        // Total: 576 values
-        return new cbir::GaborTextureColorFeature(
-            4,    // orientations
-            2,    // scales
-            8,    // bins per Gabor histogram
-            8,    // color bins per channel
-            true  // normalize
-        );
-    } else if (type == "dnn" || type == "resnet") {
-        // Task 5: DNN features (pre-computed ResNet18 embeddings)
-        // Features are loaded from CSV, not computed from images
-        return new cbir::DNNFeature("../data/features/ResNet18_olym.csv");
-    } else if (type == "productmatcher" || type == "product") {
-        return new cbir::ProductMatcherFeature(
-            "../data/features/ResNet18_olym.csv", 0.3, 8
-        );
-    }  else if (type == "faceaware" || type == "adaptive") {
-        return new cbir::FaceAwareFeature(
-            "../data/features/ResNet18_olym.csv",
-            "haarcascade_frontalface_alt2.xml"
-        );
-    }
-    
-    cerr << "Error: Unknown feature type '" << featureType << "'" << endl;
-    cerr << "Available: baseline, histogram, chromaticity, multihorizontal, texturecolor, gabor, dnn, productmatcher, faceaware" << endl;
-    return nullptr;
-}
-
-/**
- * Factory function to create appropriate distance metric based on type
- * 
- * Supports:
- *   - "ssd": Sum of Squared Differences (for baseline features)
- *   - "histogram" or "intersection": Histogram Intersection (for histogram features)
- * 
- * @param metricType Type of distance metric to create
- * @return Pointer to created distance metric, nullptr if type unknown
- */
-cbir::DistanceMetric* createDistanceMetric(const string& metricType) {
-    string type = cbir::Utils::toLower(metricType);
-    
-    if (type == "ssd") {
-
-        return new cbir::SSDMetric();
-
-    } else if (type == "histogram" || type == "intersection") {
-
-        return new cbir::HistogramIntersection();
-
-    } else if (type == "multiregion") {
-
-        // Task 3: Custom multi-region histogram intersection
-        // Computes intersection per region, combines with equal weights
-        // For 2×2 grid: 4 regions, 512 bins each
-        std::vector<double> equalWeights = {0.25, 0.25, 0.25, 0.25};
-        return new cbir::MultiRegionHistogramIntersection(
-            4,              // 4 regions
-            512,            // 512 bins per region
-            equalWeights    // Equal weights for all regions
-        );
-        
-    } else if (type == "weighted" || type == "texturecolor") {
-
-        // Weighted intersection: 50% texture, 50% color
-        return new cbir::WeightedHistogramIntersection(
-            16,   // texture dimension
-            512,  // color dimension
-            0.5,  // 50% weight for texture
-            0.5   // 50% weight for color
-        );
-
-    } else if (type == "gabor" || type == "gaborweighted") {
-
-        // Gabor texture + color: 64 + 512
-        return new cbir::WeightedHistogramIntersection(64, 512, 0.5, 0.5);
-
-    } else if (type == "cosine") {
-        // Task 5: Cosine distance
-        // Measures angle between vectors (scale-invariant)
-        return new cbir::CosineDistance();
-    } else if (type == "productmatcher" || type == "product") {
-        return new cbir::ProductMatcherDistance(0.6, 0.4);
-    } else if (type == "faceaware" || type == "adaptive") {
-        return new cbir::FaceAwareDistance();
-    }
-    
-    cerr << "Error: Unknown metric type '" << metricType << "'" << endl;
-    cerr << "Available: ssd, histogram, multiregion, weighted, gabor, cosine, productmatcher, faceaware" << endl;
-    return nullptr;
-}
-
 /**
  * Display query results in formatted table
  * 
@@ -254,7 +135,7 @@ void displayResults(const string& queryImage, const vector<ImageMatch>& results)
  *   3. Create feature extractor and distance metric
  *   4. Load pre-computed features from CSV
  *   5. Extract features from query image
- *   6. Compare query to all database images
+ *   6. Compare query to all database images (or search the ANN index)
  *   7. Sort by distance and return top N matches
  * 
  * @param argc Argument count
@@ -263,7 +144,7 @@ void displayResults(const string& queryImage, const vector<ImageMatch>& results)
  */
 int main(int argc, char* argv[]) {
     // Validate command line arguments
-    if (argc != 6) {
+    if (argc < 6) {
         printUsage(argv[0]);
         return 1;
     }
@@ -275,6 +156,50 @@ int main(int argc, char* argv[]) {
     string metricType = argv[4];
     int topN = stoi(argv[5]);
     
+    // Parse optional ANN arguments
+    string annType;
+    bool rebuildIndex = false;
+    int efSearch = 0;
+    int probeCount = 0;
+    int recallSamples = 0;
+    string prefilterType;
+    string prefilterDatabase;
+    string prefilterMetric;
+    int candidates = DEFAULT_CANDIDATES;
+    ScanBackend backend = ScanBackend::Cpu;
+    for (int i = 6; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--prefilter" && i + 3 < argc) {
+            prefilterType = argv[++i];
+            prefilterDatabase = argv[++i];
+            prefilterMetric = argv[++i];
+        } else if (option == "--candidates" && i + 1 < argc) {
+            candidates = stoi(argv[++i]);
+        } else if (option == "--ann" && i + 1 < argc) {
+            annType = argv[++i];
+        } else if (option == "--backend" && i + 1 < argc) {
+            if (!parseScanBackend(argv[++i], backend)) {
+                cerr << "Error: Unknown backend '" << argv[i] << "' (use cpu, gpu, auto or numa)" << endl;
+                return 1;
+            }
+        } else if (option == "--rebuild-index") {
+            rebuildIndex = true;
+        } else if (option == "--ef" && i + 1 < argc) {
+            efSearch = stoi(argv[++i]);
+        } else if (option == "--nprobe" && i + 1 < argc) {
+            probeCount = stoi(argv[++i]);
+        } else if (option == "--recall") {
+            recallSamples = 100;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                recallSamples = stoi(argv[++i]);
+            }
+        } else {
+            cerr << "Error: Unknown option '" << option << "'" << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
     // Display configuration
     cout << "========================================" << endl;
     cout << "CBIR Query System" << endl;
@@ -284,6 +209,16 @@ int main(int argc, char* argv[]) {
     cout << "Feature type    : " << featureType << endl;
     cout << "Distance metric : " << metricType << endl;
     cout << "Top N matches   : " << topN << endl;
+    if (!prefilterType.empty()) {
+        cout << "Prefilter       : " << prefilterType << " / " << prefilterMetric
+             << " (" << candidates << " candidates)" << endl;
+    }
+    if (!annType.empty()) {
+        cout << "ANN index       : " << annType << endl;
+    }
+    if (backend != ScanBackend::Cpu) {
+        cout << "Scan backend    : " << scanBackendName(backend) << endl;
+    }
     cout << "========================================" << endl;
     cout << endl;
     
@@ -298,22 +233,14 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // Load target image
-    cout << "Loading target image..." << endl;
-    cv::Mat queryImage = Utils::loadImage(targetImage);
-    if (queryImage.empty()) {
-        cerr << "Error: Failed to load target image" << endl;
-        return 1;
-    }
-    
     // Create feature extractor
-    FeatureExtractor* extractor = createFeatureExtractor(featureType);
+    FeatureExtractor* extractor = FeatureFactory::createExtractor(featureType);
     if (extractor == nullptr) {
         return 1;
     }
     
     // Create distance metric
-    DistanceMetric* metric = createDistanceMetric(metricType);
+    DistanceMetric* metric = FeatureFactory::createMetric(metricType);
     if (metric == nullptr) {
         delete extractor;
         return 1;
@@ -322,73 +249,137 @@ int main(int argc, char* argv[]) {
     // Load feature database
     cout << "Loading feature database..." << endl;
     FeatureDatabase database;
-    if (!database.loadFromCSV(featureCSV)) {
+    if (!database.load(featureCSV)) {
         cerr << "Error: Failed to load feature database" << endl;
         delete extractor;
         delete metric;
         return 1;
     }
     
+    // Load target image, decoded the way the database images were
+    const DecodePolicy& decodePolicy = database.getDecodePolicy();
+    cout << "Loading target image";
+    if (!decodePolicy.isFullResolution()) {
+        cout << " (" << decodePolicy.describe() << ", as recorded in the database)";
+    }
+    cout << "..." << endl;
+    cv::Mat queryImage = decodePolicy.load(targetImage);
+    if (queryImage.empty()) {
+        cerr << "Error: Failed to load target image" << endl;
+        delete extractor;
+        delete metric;
+        return 1;
+    }
+    
     // Setup retrieval system
     cout << "Setting up retrieval system..." << endl;
     ImageRetrieval retrieval;
     retrieval.setFeatureDatabase(&database);
     retrieval.setFeatureExtractor(extractor);
     retrieval.setDistanceMetric(metric);
+    retrieval.setBackend(backend);
+    
+    // Optional cheap first stage; owns its extractor and metric
+    FeatureDatabase prefilterDb;
+    ImageRetrieval prefilter;
+    FeatureExtractor* prefilterExtractor = nullptr;
+    if (!prefilterType.empty()) {
+        prefilterExtractor = FeatureFactory::createExtractor(prefilterType);
+        DistanceMetric* prefilterDistance = FeatureFactory::createMetric(prefilterMetric);
+        if (prefilterExtractor == nullptr || prefilterDistance == nullptr) {
+            delete prefilterExtractor;
+            delete prefilterDistance;
+            return 1;
+        }
+        prefilter.setFeatureExtractor(prefilterExtractor);
+        prefilter.setDistanceMetric(prefilterDistance);
+        
+        cout << "Loading prefilter database..." << endl;
+        if (!prefilterDb.load(prefilterDatabase)) {
+            cerr << "Error: Failed to load prefilter database" << endl;
+            return 1;
+        }
+        prefilter.setFeatureDatabase(&prefilterDb);
+        retrieval.setPrefilter(&prefilter, candidates);
+    }
+    
+    // Optional approximate index (must index the same metric); with a
+    // prefilter it accelerates the first stage
+    ImageRetrieval& annRetrieval = prefilterType.empty() ? retrieval : prefilter;
+    const FeatureDatabase& annDatabase = prefilterType.empty() ? database : prefilterDb;
+    const string& annMetricName = prefilterType.empty() ? metricType : prefilterMetric;
+    const string& annDatabasePath = prefilterType.empty() ? featureCSV : prefilterDatabase;
+    unique_ptr<AnnIndex> annIndex;
+    if (!annType.empty()) {
+        AnnMetric annMetric;
+        if (!AnnIndex::metricFromName(annMetricName, annMetric)) {
+            cerr << "Error: --ann supports the ssd, cosine and histogram metrics only" << endl;
+            delete extractor;
+            delete metric;
+            return 1;
+        }
+        
+        annIndex = AnnIndex::open(annType, annMetric, annDatabase, annDatabasePath, rebuildIndex);
+        if (!annIndex) {
+            delete extractor;
+            delete metric;
+            return 1;
+        }
+        
+        if (HnswIndex* hnsw = dynamic_cast<HnswIndex*>(annIndex.get())) {
+            if (efSearch > 0) {
+                hnsw->setEfSearch(efSearch);
+            }
+        } else if (IvfPqIndex* ivfpq = dynamic_cast<IvfPqIndex*>(annIndex.get())) {
+            if (probeCount > 0) {
+                ivfpq->setProbeCount(probeCount);
+            }
+        }
+        annRetrieval.setAnnIndex(annIndex.get());
+    }
     
     // Perform query
     cout << endl;
     cout << "Querying database..." << endl;
     cout << "-------------------------------------------" << endl;
     
-    // ⭐ SINGLE results variable declaration
-    vector<ImageMatch> results;
+    // Filename-keyed features (DNN, ProductMatcher, FaceAware) are looked up
+    // by the query's filename; all others are computed from the pixels
+    cv::Mat queryFeatures = FeatureFactory::extractQueryFeatures(extractor, queryImage, targetImage);
+    if (queryFeatures.empty()) {
+        return 1;
+    }
     
-    // Check for special feature types that need filename-based extraction
-    ProductMatcherFeature* productMatcher = dynamic_cast<ProductMatcherFeature*>(extractor);
-    FaceAwareFeature* faceAware = dynamic_cast<FaceAwareFeature*>(extractor);
-    DNNFeature* dnnExtractor = dynamic_cast<DNNFeature*>(extractor);
+    if (FaceAwareFeature* faceAware = dynamic_cast<FaceAwareFeature*>(extractor)) {
+        cout << "Face detection: " << (faceAware->lastImageHadFaces() ? "YES" : "NO") 
+            << " (" << faceAware->getLastFaceCount() << " faces, "
+            << faceAware->getDetectorName() << ")" << endl;
+    }
     
-    if (productMatcher) {
-        // ProductMatcher: Needs filename for DNN lookup
-        string queryFilename = Utils::getFilename(targetImage);
-        cv::Mat queryFeatures = productMatcher->extractFeaturesWithFilename(queryImage, queryFilename);
-        
-        if (queryFeatures.empty()) {
-            cerr << "Error: Failed to extract ProductMatcher features" << endl;
-            return 1;
-        }
-        
+    vector<ImageMatch> results;
+    if (prefilterType.empty()) {
         results = retrieval.queryWithFeatures(queryFeatures, topN);
-        
-    } else if (dnnExtractor) {
-        // Pure DNN: Needs filename for feature lookup
-        string queryFilename = Utils::getFilename(targetImage);
-        cv::Mat queryFeatures = dnnExtractor->getFeaturesByFilename(queryFilename);
-        
-        if (queryFeatures.empty()) {
-            cerr << "Error: No DNN features found for " << queryFilename << endl;
+    } else {
+        // The prefilter features may be filename-keyed too (e.g. dnn); its
+        // database may have been built with another decode policy
+        const DecodePolicy& prefilterPolicy = prefilterDb.getDecodePolicy();
+        cv::Mat prefilterImage =
+            prefilterPolicy == decodePolicy ? queryImage : prefilterPolicy.load(targetImage);
+        if (prefilterImage.empty()) {
             return 1;
         }
-        
-        results = retrieval.queryWithFeatures(queryFeatures, topN);
-        
-    } else if (faceAware) {
-        string queryFilename = Utils::getFilename(targetImage);
-        cv::Mat queryFeatures = faceAware->extractFeaturesWithFilename(queryImage, queryFilename);
-        
-        if (queryFeatures.empty()) {
-            cerr << "Error: Failed to extract FaceAware features" << endl;
+        cv::Mat prefilterFeatures =
+            FeatureFactory::extractQueryFeatures(prefilterExtractor, prefilterImage, targetImage);
+        if (prefilterFeatures.empty()) {
             return 1;
         }
         
-        cout << "Face detection: " << (faceAware->lastImageHadFaces() ? "YES" : "NO") 
-            << " (" << faceAware->getLastFaceCount() << " faces)" << endl;
-        
-        results = retrieval.queryWithFeatures(queryFeatures, topN);
-    } else {
-        // Normal query: Extract features from image
-        results = retrieval.query(queryImage, topN);
+        CascadeTiming timing;
+        results = retrieval.queryCascade(prefilterFeatures, queryFeatures, topN, &timing);
+        cout << "Prefilter stage : " << fixed << setprecision(3) << timing.prefilterMs
+             << " ms" << endl;
+        cout << "Rerank stage    : " << timing.rerankMs << " ms (" << timing.candidates
+             << " candidates)" << endl;
     }
     
     // Check if query succeeded
@@ -400,5 +391,22 @@ int main(int argc, char* argv[]) {
     // Display results
     displayResults(targetImage, results);
     
+    // Optional recall report for the ANN index
+    if (annIndex && recallSamples > 0) {
+        cout << "Measuring recall@" << topN << " on " << recallSamples
+             << " database queries..." << endl;
+        double annMs = 0.0;
+        double exactMs = 0.0;
+        double recall = annRetrieval.measureRecall(topN, recallSamples, &annMs, &exactMs);
+        if (recall < 0.0) {
+            cerr << "Error: Recall measurement failed" << endl;
+            return 1;
+        }
+        cout << "Recall@" << topN << "      : " << fixed << setprecision(4) << recall << endl;
+        cout << "ANN query time : " << setprecision(3) << annMs << " ms" << endl;
+        cout << "Exact query    : " << setprecision(3) << exactMs << " ms" << endl;
+        cout << endl;
+    }
+    
     return 0;
 }
@@ -15,6 +15,8 @@
 #   bin/data/features/    - Feature CSV files (created by GUI)
 #
 # Requirements: Python 3.7+, tkinter, Pillow
+#               (numpy and the cbir module built with pybind11 for in-process
+#               queries; without them queries go to cbirServer / queryImage)
 #
 # Date: February 2026
 ################################################################################
@@ -25,8 +27,93 @@ from PIL import Image, ImageTk
 import subprocess
 import os
 import sys
+import io
+import json
+import struct
+import urllib.request
+import urllib.error
+from collections import OrderedDict
+from contextlib import contextmanager
 from pathlib import Path
 
+
+@contextmanager
+def working_directory(path):
+    """Temporarily change the working directory"""
+    previous = os.getcwd()
+    os.chdir(path)
+    try:
+        yield
+    finally:
+        os.chdir(previous)
+
+
+def import_cbir_module(exe_dir):
+    """
+    Import the in-process retrieval module built next to the executables
+    
+    Returns None when it was not built (pybind11 missing at configure time).
+    """
+    exe_dir = os.path.abspath(exe_dir)
+    if exe_dir not in sys.path:
+        sys.path.insert(0, exe_dir)
+    if hasattr(os, 'add_dll_directory') and os.path.isdir(exe_dir):
+        os.add_dll_directory(exe_dir)   # OpenCV DLLs beside the executables
+    try:
+        import cbir
+        return cbir
+    except ImportError:
+        return None
+
+
+class ThumbnailAtlas:
+    """
+    Reader for the packed thumbnail atlas written by buildFeatureDB --thumbnails
+    
+    Layout (see ThumbnailAtlas.h): a 64-byte header (magic "CBIRTHMB",
+    version, max side, count, index offset, format), the encoded thumbnails
+    back to back, then the index of (offset, size, name) entries. Only the
+    index is read on open; each thumbnail is one seek and one small read.
+    """
+    
+    MAGIC = b'CBIRTHMB'
+    
+    def __init__(self, path):
+        self.path = path
+        self.index = {}
+        self.file = open(path, 'rb')
+        header = self.file.read(64)
+        if len(header) < 64 or header[:8] != self.MAGIC:
+            self.file.close()
+            raise ValueError(f"{path} is not a thumbnail atlas")
+        version, self.max_side, count, index_offset = struct.unpack_from('<IIQQ', header, 8)
+        if version != 1:
+            self.file.close()
+            raise ValueError(f"{path} has unsupported version {version}")
+        self.file.seek(index_offset)
+        data = self.file.read()
+        cursor = 0
+        for _ in range(count):
+            offset, size, name_length = struct.unpack_from('<QII', data, cursor)
+            cursor += 16
+            name = data[cursor:cursor + name_length].decode('utf-8')
+            cursor += name_length
+            self.index[name] = (offset, size)
+        self.mtime = os.path.getmtime(path)
+    
+    def read(self, filename, offset=None, size=None):
+        """Encoded thumbnail bytes, using the server's offset when given"""
+        if offset is None or size is None:
+            entry = self.index.get(os.path.basename(filename))
+            if entry is None:
+                return None
+            offset, size = entry
+        self.file.seek(offset)
+        return self.file.read(size)
+    
+    def close(self):
+        self.file.close()
+
 class CBIRGui:
     """
     Content-Based Image Retrieval GUI Application
@@ -50,6 +137,14 @@ class CBIRGui:
         self.image_dir = "../bin/data/images"
         self.features_dir = "../bin/data/features"
         
+        # Queries run in-process when the cbir module is available: one warm
+        # engine per feature, reloaded when its database file changes. Next
+        # come a warm query server (cbirServer), then one queryImage process
+        # per query.
+        self.cbir = import_cbir_module(self.exe_dir)
+        self.engines = {}
+        self.server_url = "http://127.0.0.1:8765"
+        
         # Ensure features directory exists
         os.makedirs(self.features_dir, exist_ok=True)
         
@@ -75,6 +170,11 @@ class CBIRGui:
                 'metric': 'multiregion',
                 'description': 'Multi-Region Histogram (2×2 Grid)'
             },
+            'pyramid': {
+                'csv': os.path.join(self.features_dir, 'pyramid_features.csv'),
+                'metric': 'pyramid',
+                'description': 'Spatial Pyramid Histogram (1×1 + 2×2)'
+            },
             'texturecolor': {
                 'csv': os.path.join(self.features_dir, 'texture_features.csv'),
                 'metric': 'weighted',
@@ -107,6 +207,13 @@ class CBIRGui:
         self.query_results = []
         self.result_images = []
         
+        # Result image hierarchy: decoded thumbnails in memory, then the
+        # packed atlas beside the database, then the full-resolution file
+        self.thumbnail_side = 256
+        self.thumbnail_cache = OrderedDict()
+        self.thumbnail_cache_limit = 512
+        self.atlases = {}
+        
         # Verify executables exist
         self.verify_setup()
         
@@ -145,6 +252,7 @@ class CBIRGui:
         print(f"  Executables: {self.exe_dir}")
         print(f"  Images: {self.image_dir}")
         print(f"  Features: {self.features_dir}")
+        print(f"  Queries: {'in-process (cbir module)' if self.cbir else 'cbirServer / queryImage'}")
         
     def create_ui(self):
         """Create the main user interface"""
@@ -387,6 +495,14 @@ class CBIRGui:
         Returns:
             bool: True if successful
         """
+        # The build replaces the atlas and database files, which must not be
+        # held open (the engine maps binary databases)
+        for atlas in self.atlases.values():
+            atlas.close()
+        self.atlases.clear()
+        self.thumbnail_cache.clear()
+        self.engines.pop(feature_type, None)
+        
         try:
             # Get just the CSV filename (exe expects path relative to its location)
             csv_filename = os.path.relpath(csv_path, self.exe_dir)
@@ -396,7 +512,8 @@ class CBIRGui:
                 os.path.join(self.exe_dir, 'buildFeatureDB.exe'),
                 os.path.relpath(self.image_dir, self.exe_dir),  # Relative to exe
                 feature_type,
-                csv_filename
+                csv_filename,
+                '--thumbnails', str(self.thumbnail_side)
             ]
             
             print(f"Executing: {' '.join(cmd)}")
@@ -457,6 +574,34 @@ class CBIRGui:
         )
         self.root.update()
         
+        # Prefer the in-process engine, then the query server: neither loads
+        # the database per query
+        local_results = self.query_in_process(feature, top_n)
+        if local_results is not None:
+            if local_results:
+                self.query_status_label.config(
+                    text=f"Found {len(local_results)} matches using {feature}",
+                    foreground="green"
+                )
+                self.display_results(local_results, feature, metric)
+            else:
+                self.query_status_label.config(text="No results found", foreground="red")
+                messagebox.showwarning("No Results", "No matching images found!")
+            return
+        
+        server_results = self.query_server(feature, top_n)
+        if server_results is not None:
+            if server_results:
+                self.query_status_label.config(
+                    text=f"Found {len(server_results)} matches using {feature} (server)",
+                    foreground="green"
+                )
+                self.display_results(server_results, feature, metric)
+            else:
+                self.query_status_label.config(text="No results found", foreground="red")
+                messagebox.showwarning("No Results", "No matching images found!")
+            return
+        
         # Execute query
         try:
             # Get paths relative to exe directory
@@ -504,6 +649,153 @@ class CBIRGui:
             self.query_status_label.config(text="Query error!", foreground="red")
             messagebox.showerror("Error", f"Query error: {e}")
     
+    def get_engine(self, feature):
+        """Warm engine for a feature, (re)created when the database changed"""
+        config = self.features_config[feature]
+        path = os.path.abspath(config['csv'])
+        stamp = os.path.getmtime(path)
+        cached = self.engines.get(feature)
+        if cached is not None and cached[0] == stamp:
+            return cached[1]
+        
+        # Extractors open their models relative to the executables
+        with working_directory(self.exe_dir):
+            database = self.cbir.FeatureDatabase(path)
+            engine = self.cbir.ImageRetrieval(database, feature, config['metric'])
+        self.engines[feature] = (stamp, engine)
+        return engine
+    
+    def query_in_process(self, feature, top_n):
+        """
+        Query with the in-process engine
+        
+        Returns the list of results (possibly empty), or None when the cbir
+        module is not available or the engine cannot be set up, in which
+        case the caller falls back to the server or queryImage.
+        """
+        if self.cbir is None:
+            return None
+        try:
+            engine = self.get_engine(feature)
+        except (RuntimeError, ValueError, OSError) as e:
+            print(f"In-process engine unavailable for {feature}: {e}")
+            return None
+        
+        try:
+            matches = engine.query(os.path.abspath(self.selected_image_path), top_n)
+        except (RuntimeError, ValueError) as e:
+            print(f"In-process query error: {e}")
+            return []
+        return [
+            {'rank': rank, 'filename': filename, 'distance': distance}
+            for rank, (filename, distance) in enumerate(matches, start=1)
+        ]
+    
+    def query_server(self, feature, top_n):
+        """
+        Query a running cbirServer
+        
+        Returns the list of results (possibly empty), or None when no server
+        is reachable or it has no collection for this feature, in which case
+        the caller falls back to queryImage.
+        """
+        self.server_atlas_path = None
+        request_body = json.dumps({
+            'collection': feature,
+            'image': os.path.abspath(self.selected_image_path),
+            'top': top_n,
+            'priority': 'interactive'
+        }).encode('utf-8')
+        request = urllib.request.Request(
+            self.server_url + '/query',
+            data=request_body,
+            headers={'Content-Type': 'application/json'},
+            method='POST'
+        )
+        
+        try:
+            with urllib.request.urlopen(request, timeout=60) as response:
+                reply = json.loads(response.read().decode('utf-8'))
+        except (urllib.error.URLError, OSError, ValueError):
+            return None
+        
+        answer = reply['results'][0]
+        if 'error' in answer:
+            print(f"Server query error: {answer['error']}")
+            return []
+        
+        print(f"Server timing (ms): {reply.get('timing')}")
+        self.server_atlas_path = reply.get('thumbnails')
+        return [
+            {'rank': rank, 'filename': match['filename'], 'distance': match['distance'],
+             'thumbnail': match.get('thumbnail')}
+            for rank, match in enumerate(answer.get('matches', []), start=1)
+        ]
+    
+    def open_atlas(self, path):
+        """Open (or reuse) an atlas; reopened when the file was rebuilt"""
+        if not path or not os.path.exists(path):
+            return None
+        atlas = self.atlases.get(path)
+        if atlas is not None and atlas.mtime == os.path.getmtime(path):
+            return atlas
+        if atlas is not None:
+            atlas.close()
+            self.thumbnail_cache.clear()
+        try:
+            atlas = ThumbnailAtlas(path)
+        except (OSError, ValueError, struct.error) as e:
+            print(f"Cannot read thumbnail atlas {path}: {e}")
+            self.atlases.pop(path, None)
+            return None
+        self.atlases[path] = atlas
+        return atlas
+    
+    def find_atlas(self, feature, from_server):
+        """Atlas named by the server, else the one beside the database, else any"""
+        if from_server and getattr(self, 'server_atlas_path', None):
+            atlas = self.open_atlas(self.server_atlas_path)
+            if atlas is not None:
+                return atlas
+        atlas = self.open_atlas(self.features_config[feature]['csv'] + '.thumbs')
+        if atlas is not None:
+            return atlas
+        for name in sorted(os.listdir(self.features_dir)):
+            if name.endswith('.thumbs'):
+                atlas = self.open_atlas(os.path.join(self.features_dir, name))
+                if atlas is not None:
+                    return atlas
+        return None
+    
+    def load_result_image(self, result, atlas, img_size):
+        """
+        Thumbnail for a result: memory cache, then atlas, then full image
+        
+        Returns a PIL image no larger than img_size.
+        """
+        filename = result['filename']
+        key = (filename, img_size)
+        img = self.thumbnail_cache.get(key)
+        if img is not None:
+            self.thumbnail_cache.move_to_end(key)
+            return img
+        
+        data = None
+        if atlas is not None:
+            location = result.get('thumbnail') or {}
+            data = atlas.read(filename, location.get('offset'), location.get('size'))
+        if data:
+            img = Image.open(io.BytesIO(data))
+        else:
+            img = Image.open(os.path.join(self.image_dir, filename))
+        img.thumbnail(img_size, Image.Resampling.LANCZOS)
+        img.load()
+        
+        self.thumbnail_cache[key] = img
+        if len(self.thumbnail_cache) > self.thumbnail_cache_limit:
+            self.thumbnail_cache.popitem(last=False)
+        return img
+    
     def parse_and_display_results(self, output, feature, metric):
         """
         Parse query output and display results
@@ -586,6 +878,8 @@ class CBIRGui:
         # Display results in grid (3 columns)
         cols = 3
         img_size = (220, 220)
+        from_server = any('thumbnail' in result for result in results)
+        atlas = self.find_atlas(feature, from_server)
         
         for idx, result in enumerate(results):
             row = (idx // cols) + 1
@@ -599,9 +893,8 @@ class CBIRGui:
             img_path = os.path.join(self.image_dir, result['filename'])
             
             try:
-                # Load image
-                img = Image.open(img_path)
-                img.thumbnail(img_size, Image.Resampling.LANCZOS)
+                # Load image (cached thumbnail, atlas, or full file)
+                img = self.load_result_image(result, atlas, img_size)
                 photo = ImageTk.PhotoImage(img)
                 
                 # Image label
@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+// AnnIndex.h
+// Author: Krushna Sanjay Sharma
+// Description: Abstract base class for approximate nearest-neighbour indexes
+//              over a FeatureDatabase (HNSW, IVF-PQ, PQ / OPQ, inverted
+//              file). Indexes are built from
+//              the packed feature matrix, saved next to the database file and
+//              re-attached to it on load.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ANN_INDEX_H
+#define ANN_INDEX_H
+
+#include "FeatureDatabase.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @enum AnnMetric
+ * @brief Distance an index is built for
+ *
+ * Values match the brute-force metrics so results are interchangeable:
+ * L2 returns SSDMetric distances, Cosine returns CosineDistance distances,
+ * Intersection returns HistogramIntersection distances.
+ */
+enum class AnnMetric {
+    L2 = 0,           ///< Squared Euclidean distance (SSDMetric)
+    Cosine = 1,       ///< 1 - cos(angle) (CosineDistance)
+    Intersection = 2  ///< 1 - Σ min (HistogramIntersection); inverted index only
+};
+
+/// (distance, database row) search result
+using AnnResult = std::pair<double, int>;
+
+/**
+ * @class AnnIndex
+ * @brief Approximate nearest-neighbour search over a FeatureDatabase
+ *
+ * An index stores only its search structure and refers to database rows by
+ * index. After load() it must be attach()ed to the database it was built
+ * from; a signature over the image names, count and dimension rejects a
+ * stale index (the database was rebuilt or changed since).
+ *
+ * Usage example:
+ * @code
+ *   FeatureDatabase db;
+ *   db.load("dnn_features.fdb");
+ *
+ *   std::unique_ptr<AnnIndex> index = AnnIndex::create("hnsw", AnnMetric::Cosine);
+ *   if (!index->load("dnn_features.fdb.hnsw") || !index->attach(db)) {
+ *       index->build(db);
+ *       index->save("dnn_features.fdb.hnsw");
+ *   }
+ *
+ *   std::vector<AnnResult> results;
+ *   index->search(queryFeatures, 10, results);
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class AnnIndex {
+public:
+    /**
+     * @brief Virtual destructor for proper cleanup of derived classes
+     */
+    virtual ~AnnIndex() = default;
+
+    AnnIndex(const AnnIndex&) = delete;
+    AnnIndex& operator=(const AnnIndex&) = delete;
+
+    /**
+     * @brief Build the index over every row of a database
+     *
+     * The index stays attached to the database (it keeps a pointer to it).
+     *
+     * @param database Database to index; must outlive the index
+     * @return bool True if successful, false on error
+     */
+    virtual bool build(const FeatureDatabase& database) = 0;
+
+    /**
+     * @brief Attach a loaded index to the database it was built from
+     *
+     * @param database Database to search; must outlive the index
+     * @return bool True if the database matches the index signature
+     */
+    virtual bool attach(const FeatureDatabase& database) = 0;
+
+    /**
+     * @brief Find the approximate k nearest database rows
+     *
+     * Safe to call from several threads at once.
+     *
+     * @param query Query feature vector (any shape, converted to float32)
+     * @param k Number of results
+     * @param results Output (distance, row) pairs, ascending distance
+     * @return bool True if successful, false if the index is not ready
+     */
+    virtual bool search(const cv::Mat& query, int k,
+                        std::vector<AnnResult>& results) const = 0;
+
+    /**
+     * @brief Save the index structure (not the vectors) to a file
+     *
+     * @param filename Output file path
+     * @return bool True if successful, false on error
+     */
+    virtual bool save(const std::string& filename) const = 0;
+
+    /**
+     * @brief Load an index saved by save(); call attach() afterwards
+     *
+     * @param filename Input file path
+     * @return bool True if successful, false on error or version mismatch
+     */
+    virtual bool load(const std::string& filename) = 0;
+
+    /**
+     * @brief Get the name of this index type
+     *
+     * @return std::string Descriptive name (e.g., "HNSW", "IVF-PQ")
+     */
+    virtual std::string getIndexName() const = 0;
+
+    /**
+     * @brief Memory used by the index itself, excluding the database
+     *
+     * @return size_t Bytes
+     */
+    virtual size_t memoryBytes() const = 0;
+
+    /**
+     * @brief Distance the index was built for
+     */
+    AnnMetric metric() const { return metric_; }
+
+    /**
+     * @brief Number of indexed rows
+     */
+    size_t size() const { return count_; }
+
+    /**
+     * @brief Check if the index is attached to a database and searchable
+     */
+    bool isReady() const { return database_ != nullptr && count_ > 0; }
+
+    /**
+     * @brief Create an empty index of the given type
+     *
+     * @param type "hnsw", "ivfpq", "pq", "opq" or "inverted" (case-insensitive)
+     * @param metric Distance to index for
+     * @return std::unique_ptr<AnnIndex> New index, nullptr if type unknown
+     *         or the type does not support metric
+     */
+    static std::unique_ptr<AnnIndex> create(const std::string& type, AnnMetric metric);
+
+    /**
+     * @brief Map a queryImage metric name to an index metric
+     *
+     * @param metricName "ssd", "cosine" or "histogram" / "intersection"
+     *                   (case-insensitive)
+     * @param metric Output metric
+     * @return bool False if the metric has no index support
+     */
+    static bool metricFromName(const std::string& metricName, AnnMetric& metric);
+
+    /**
+     * @brief Conventional index path next to a database file
+     *
+     * @param databasePath Feature database file (CSV or .fdb)
+     * @param type Index type ("hnsw", "ivfpq", "pq", "opq" or "inverted")
+     * @return std::string e.g. "dnn_features.fdb.hnsw"
+     */
+    static std::string defaultPath(const std::string& databasePath, const std::string& type);
+
+    /**
+     * @brief Load the index saved next to a database, or build and save it
+     *
+     * A saved index that fails to load, belongs to another database or was
+     * built for another metric is rebuilt. Progress goes to std::cout.
+     *
+     * @param type Index type ("hnsw", "ivfpq", "pq", "opq" or "inverted")
+     * @param metric Distance to index for
+     * @param database Loaded database; must outlive the index
+     * @param databasePath Path the database was loaded from (see defaultPath())
+     * @param rebuild Ignore any saved index
+     * @return std::unique_ptr<AnnIndex> Attached index, nullptr on error
+     */
+    static std::unique_ptr<AnnIndex> open(const std::string& type, AnnMetric metric,
+                                          const FeatureDatabase& database,
+                                          const std::string& databasePath, bool rebuild);
+
+protected:
+    /**
+     * @brief Protected constructor - only derived classes can instantiate
+     */
+    explicit AnnIndex(AnnMetric metric);
+
+    AnnMetric metric_;                      ///< Indexed distance
+    const FeatureDatabase* database_;       ///< Attached database (not owned)
+    size_t count_;                          ///< Indexed rows
+    int dimension_;                         ///< Vector length
+    uint64_t signature_;                    ///< databaseSignature() at build time
+
+    /**
+     * @brief Fingerprint of a database: FNV-1a over count, dimension, names
+     */
+    static uint64_t databaseSignature(const FeatureDatabase& database);
+
+    /**
+     * @brief Flatten a query to float32 and check its length
+     *
+     * @param query Query feature vector
+     * @param out Output contiguous copy
+     * @return bool True if query has dimension_ elements
+     */
+    bool prepareQuery(const cv::Mat& query, std::vector<float>& out) const;
+
+    /**
+     * @brief Exact distance between two vectors with known L2 norms
+     *
+     * Norms are only used for AnnMetric::Cosine; zero vectors give 1.0,
+     * matching CosineDistance.
+     */
+    double exactDistance(const float* a, double normA,
+                         const float* b, double normB) const;
+
+    /**
+     * @brief L2 norm of a vector
+     */
+    static double vectorNorm(const float* values, int length);
+
+    /**
+     * @brief Index of the nearest of count centroids (each length values long)
+     */
+    static int nearestCentroid(const float* vector, const float* centroids,
+                               int count, int length);
+
+    /**
+     * @brief k-means on the rows of samples (CV_32F) into centers (k x cols CV_32F)
+     */
+    static bool trainCentroids(const cv::Mat& samples, int k, cv::Mat& centers);
+};
+
+} // namespace cbir
+
+#endif // ANN_INDEX_H
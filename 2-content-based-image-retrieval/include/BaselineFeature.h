@@ -71,6 +71,21 @@ public:
      */
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
 
+    /**
+     * @brief Extract the center square of a (possibly cropped) context image
+     * 
+     * The square is centred in the whole image (context.fullSize()), so the
+     * features match extractFeatures() on the full decode.
+     */
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
+
+    /**
+     * @brief Only the center square (plus margin) needs decoding
+     */
+    virtual DecodeRegion getDecodeRegion() const override {
+        return DecodeRegion::centred(0.0, squareSize_);
+    }
+
     /**
      * @brief Get the name of this feature extractor
      * 
@@ -85,6 +100,11 @@ public:
      */
     virtual int getFeatureDimension() const override;
 
+    /**
+     * @brief Extraction reads only the configuration, so batches run in parallel
+     */
+    virtual bool isThreadSafe() const override { return true; }
+
     /**
      * @brief Set the size of the square region
      * 
@@ -102,13 +122,27 @@ public:
 private:
     int squareSize_;  ///< Size of the square region to extract (default: 7)
 
+    /**
+     * @brief Features of the square at the centre of the whole image
+     * 
+     * @param image Whole image, or a crop of it containing the square
+     * @param fullSize Size of the whole image
+     * @param offset Position of image within the whole image
+     * @return cv::Mat Feature vector, empty on error
+     */
+    cv::Mat extractFromRegion(const cv::Mat& image, const cv::Size& fullSize,
+                              const cv::Point& offset) const;
+
     /**
      * @brief Extract square region from center of image
      * 
-     * @param image Input image
+     * @param image Input image (the whole image or a crop of it)
+     * @param fullSize Size of the whole image
+     * @param offset Position of image within the whole image
      * @return cv::Mat Extracted square region
      */
-    cv::Mat extractCenterSquare(const cv::Mat& image) const;
+    cv::Mat extractCenterSquare(const cv::Mat& image, const cv::Size& fullSize,
+                                const cv::Point& offset) const;
 };
 
 } // namespace cbir
@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+// BatchReader.h
+// Author: Krushna Sanjay Sharma
+// Description: Reads many image files into memory with a fixed number of
+//              reads in flight, through io_uring on Linux (liburing) or a
+//              pool of reader threads elsewhere, and prefetches object
+//              storage URLs (ObjectStore). Database builds decode the
+//              returned bytes with cv::imdecode, so decoder threads never
+//              block on the disk or the network.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BATCH_READER_H
+#define BATCH_READER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cbir {
+
+class ObjectStore;
+
+/**
+ * @struct FileData
+ * @brief Contents of one file returned by BatchReader::next()
+ */
+struct FileData {
+    size_t index = 0;                    ///< Position in the reader's file list
+    std::vector<unsigned char> bytes;    ///< File contents (empty if unreadable)
+    bool ok = false;                     ///< False if the file could not be read
+};
+
+/**
+ * @class BatchReader
+ * @brief Whole-file reads of a file list with queueDepth reads in flight
+ *
+ * With liburing (CBIR_HAVE_LIBURING) one thread keeps up to queueDepth
+ * reads submitted to an io_uring and collects their completions, so an
+ * NVMe drive sees a deep queue from a single thread. Without it, or when
+ * the kernel refuses the ring, queueDepth threads (at most 32) read files
+ * with blocking calls.
+ *
+ * Object storage URLs (ObjectStore::isUrl, e.g. "s3://bucket/a.jpg") are
+ * fetched by queueDepth threads (at most 64), each with one HTTP request
+ * in flight; the list must then consist of URLs only.
+ *
+ * Files are returned in completion order (FileData::index gives their
+ * position). Buffers handed back with recycle() are reused for later
+ * reads, so a long build stops allocating after its first files. At most
+ * 2 * queueDepth finished files, and with a memory budget at most that
+ * many bytes of them, wait in memory; reading pauses until the consumers
+ * catch up.
+ *
+ * Usage example:
+ * @code
+ *   BatchReader reader(paths, 32);
+ *   FileData file;
+ *   while (reader.next(file)) {        // from any number of threads
+ *       cv::Mat image = cv::imdecode(file.bytes, cv::IMREAD_COLOR);
+ *       reader.recycle(std::move(file.bytes));
+ *   }
+ *   std::cout << reader.megabytesPerSecond() << " MB/s" << std::endl;
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class BatchReader {
+public:
+    /**
+     * @brief Start reading the files in the background
+     *
+     * @param files File paths or object URLs (the list is copied)
+     * @param queueDepth Reads in flight (1 to 4096)
+     * @param memoryBudget Bytes of finished files kept waiting (0 = no limit;
+     *                     a single larger file is still let through)
+     */
+    BatchReader(const std::vector<std::string>& files, int queueDepth = 32,
+                size_t memoryBudget = 0);
+
+    /**
+     * @brief Destructor - stops reading and waits for in-flight reads
+     */
+    ~BatchReader();
+
+    BatchReader(const BatchReader&) = delete;
+    BatchReader& operator=(const BatchReader&) = delete;
+
+    /**
+     * @brief Next finished file, waiting for one if needed
+     *
+     * @param file Output: file index and contents
+     * @return bool False once every file was returned or stop() was called
+     */
+    bool next(FileData& file);
+
+    /**
+     * @brief Give a buffer back for reuse by later reads
+     */
+    void recycle(std::vector<unsigned char>&& buffer);
+
+    /**
+     * @brief Stop reading; next() returns false from now on
+     */
+    void stop();
+
+    const char* backend() const { return backend_; }          ///< "io_uring", "threads" or "http"
+    int getQueueDepth() const { return queueDepth_; }          ///< Reads in flight
+    uint64_t getBytesRead() const { return bytesRead_.load(); }   ///< Bytes read so far
+
+    /**
+     * @brief Read throughput from the start to the latest completion (MB/s)
+     */
+    double megabytesPerSecond() const;
+
+private:
+    std::vector<std::string> files_;   ///< Files to read
+    int queueDepth_;                   ///< Reads in flight
+    size_t memoryBudget_;              ///< Limit on queuedBytes_ (0 = none)
+    const char* backend_;              ///< Backend actually used
+    std::unique_ptr<ObjectStore> store_;  ///< Client for URL lists, else null
+
+    std::atomic<size_t> nextFile_;     ///< Next file for a reader thread
+    std::atomic<bool> stopped_;        ///< Set by stop()
+    std::atomic<uint64_t> bytesRead_;  ///< Bytes read
+    std::atomic<int64_t> lastReadNs_;  ///< Latest completion since start_ (ns)
+    std::chrono::steady_clock::time_point start_;
+
+    std::mutex mutex_;                 ///< Guards the queue and the buffer pool
+    std::condition_variable ready_;    ///< A file finished or reading ended
+    std::condition_variable space_;    ///< The queue has room
+    std::deque<FileData> finished_;    ///< Files waiting for next()
+    size_t queuedBytes_;               ///< Bytes of the files in finished_
+    std::vector<std::vector<unsigned char>> buffers_;  ///< Recycled buffers
+    int producers_;                    ///< Reader threads still running
+
+    std::vector<std::thread> threads_;
+
+    /**
+     * @brief Run the io_uring loop; false if no ring could be created
+     */
+    bool runRing();
+
+    /**
+     * @brief Reader thread of the fallback and object storage backends
+     */
+    void runThread();
+
+    /**
+     * @brief Buffer of at least size bytes, recycled if possible
+     */
+    std::vector<unsigned char> takeBuffer(size_t size);
+
+    /**
+     * @brief Queue a finished file, waiting while the queue is full
+     */
+    void deliver(FileData&& file);
+
+    /**
+     * @brief Mark one reader thread as done
+     */
+    void finishProducer();
+};
+
+} // namespace cbir
+
+#endif // BATCH_READER_H
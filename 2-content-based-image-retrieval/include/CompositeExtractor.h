@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// CompositeExtractor.h
+// Author: Krushna Sanjay Sharma
+// Description: Runs several feature extractors on one decoded image, sharing
+//              colour conversions, gradients and face boxes through an
+//              ImageContext, and returns one feature vector per extractor.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMPOSITE_EXTRACTOR_H
+#define COMPOSITE_EXTRACTOR_H
+
+#include "FeatureExtractor.h"
+#include "ImageContext.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @class CompositeExtractor
+ * @brief Single-pass extraction of several feature types
+ *
+ * Building databases for several feature types one after another decodes
+ * and preprocesses every image once per type. A CompositeExtractor builds
+ * one ImageContext per image and hands it to each member extractor, so the
+ * image is decoded once and grayscale, HSV, Sobel magnitude and face boxes
+ * are computed at most once. DatabaseBuilder uses it to fill one database
+ * per member in a single pass.
+ *
+ * Usage example:
+ * @code
+ *   HistogramFeature histogram;
+ *   TextureColorFeature textureColor;
+ *   CompositeExtractor composite({&histogram, &textureColor});
+ *   std::vector<cv::Mat> features;
+ *   composite.extract(image, "pic.0001.jpg", features);  // features[0], features[1]
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class CompositeExtractor {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param extractors Member extractors (not owned); output order follows
+     *                   this list
+     */
+    explicit CompositeExtractor(const std::vector<FeatureExtractor*>& extractors);
+
+    /**
+     * @brief Extract every member's features from one image
+     *
+     * @param image Decoded image
+     * @param filename Image filename without directory
+     * @param features Output, one vector per member (empty where it failed)
+     * @return bool True if every member produced features
+     */
+    bool extract(const cv::Mat& image, const std::string& filename,
+                 std::vector<cv::Mat>& features);
+
+    /**
+     * @brief Extract every member's features from an existing context
+     */
+    bool extract(ImageContext& context, std::vector<cv::Mat>& features);
+
+    /**
+     * @brief Extract every member's features from several contexts
+     *
+     * Members whose getPreferredBatchSize() is above 1 get all the images in
+     * one extractBatch() call; the others run extractFromContext() per
+     * context as in extract().
+     *
+     * @param contexts Contexts of the decoded images
+     * @param features Output, features[c][m] for context c and member m
+     *                 (empty where it failed)
+     * @return int Number of contexts for which every member produced features
+     */
+    int extractBatch(const std::vector<ImageContext*>& contexts,
+                     std::vector<std::vector<cv::Mat>>& features);
+
+    /**
+     * @brief Largest preferred batch size of the members (1 if none batches)
+     */
+    int getPreferredBatchSize() const;
+
+    /**
+     * @brief Largest decode reduction every member allows
+     */
+    int getMaxDecodeReduction() const;
+
+    /**
+     * @brief Largest minimum image side of the members (0 if any forbids resizing)
+     */
+    int getMinImageSide() const;
+
+    /**
+     * @brief Union of the members' decode regions
+     */
+    DecodeRegion getDecodeRegion() const;
+
+    size_t size() const { return extractors_.size(); }   ///< Number of members
+
+    /**
+     * @brief Member extractor
+     */
+    FeatureExtractor* getExtractor(size_t index) const { return extractors_[index]; }
+
+private:
+    std::vector<FeatureExtractor*> extractors_;   ///< Members (not owned)
+};
+
+} // namespace cbir
+
+#endif // COMPOSITE_EXTRACTOR_H
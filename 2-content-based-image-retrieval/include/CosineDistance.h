@@ -57,6 +57,43 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
     
+    /**
+     * Cosine distance from a query to every row of a feature matrix
+     * 
+     * The query norm is computed once; each row needs a single fused
+     * dot-product / squared-norm pass.
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
+    /**
+     * Cosine distance from a block of queries to every row of a matrix
+     * 
+     * All dot products come from one matrix product (cv::gemm); row norms
+     * are computed once per call and shared by all queries.
+     */
+    virtual bool computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
+    /**
+     * Row norms come from FeatureDatabase::rowNorms(), computed once per
+     * database version rather than once per comparison
+     */
+    virtual bool usesRowNorms() const override { return true; }
+    
+    /**
+     * Cosine distance to every row given the row norms: one dot product
+     * per row
+     */
+    virtual bool computeBatchNormed(const cv::Mat& query, const cv::Mat& matrix,
+                                    const cv::Mat& rowNorms, cv::Mat& out) override;
+    
+    /**
+     * Block cosine distance given the row norms: the matrix product only
+     */
+    virtual bool computeBlockNormed(const cv::Mat& queries, const cv::Mat& matrix,
+                                    const cv::Mat& rowNorms, cv::Mat& out) override;
+    
     virtual std::string getMetricName() const override;
 
 private:
@@ -12,9 +12,16 @@
 //   - Captures high-level semantic image content
 //
 // Key Difference from Other Features:
-//   - Does NOT compute features from images
+//   - By default does NOT compute features from images
 //   - Loads pre-computed features from CSV file
 //   - extractFeatures() looks up features by filename
+//   - With an ONNX model (loadModel(), needs ONNX Runtime) it computes the
+//     embedding natively instead, through the shared cvcore
+//     InferenceService: every extractor on the same model shares one
+//     session pool, and concurrent workers are batched together
+//   - Embeddings live in a shared EmbeddingStore (memory-mapped binary
+//     cache converted once from the CSV), so extractors opened on the
+//     same file share one copy
 //
 // CSV Format:
 //   filename,feature1,feature2,...,feature512
@@ -26,10 +33,15 @@
 #ifndef DNN_FEATURE_H
 #define DNN_FEATURE_H
 
+#include "EmbeddingStore.h"
 #include "FeatureExtractor.h"
-#include <map>
+#include <memory>
 #include <string>
 
+namespace cvcore {
+class InferenceService;
+}
+
 namespace cbir {
 
 /**
@@ -67,31 +79,84 @@ public:
     /**
      * Extract features from image
      * 
-     * NOTE: For DNN features, this attempts to find features by
-     * extracting filename from image path. Not recommended.
-     * Use getFeaturesByFilename() instead.
+     * With a model loaded, runs the network on the image: 224x224 RGB
+     * input with ImageNet mean / std normalisation, the model output
+     * flattened into one row. Without a model, features are pre-computed
+     * and this returns an empty Mat; use getFeaturesByFilename() instead.
      * 
-     * @param image Not used (features are pre-computed)
-     * @return Empty Mat (use getFeaturesByFilename instead)
+     * @param image BGR image
+     * @return 1 x D CV_32F embedding, or empty Mat without a model
      */
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
     
+    /**
+     * Compute embeddings natively with an ONNX model
+     * 
+     * The model takes a N x 3 x 224 x 224 ImageNet input and outputs the
+     * embedding (e.g. ResNet18 exported up to the global average pool).
+     * Extractors loading the same path share one InferenceService.
+     * 
+     * @param onnxPath Path to the ONNX model
+     * @param maxBatch Images per forward pass when several threads extract
+     * @return False without ONNX Runtime or when the model cannot be loaded
+     */
+    bool loadModel(const std::string& onnxPath, int maxBatch = 8);
+    
+    /**
+     * Run the model once at batch 1 and maxBatch so provider setup happens
+     * before extraction starts; call before the first extractFeatures()
+     * 
+     * @return False without a model or when a warm-up run failed
+     */
+    bool warmup();
+    
+    /**
+     * Check if features are computed by a model instead of looked up
+     */
+    bool hasModel() const { return service_ != nullptr; }
+    
     /**
      * Get features by filename (recommended for DNN features)
      * 
      * @param filename Image filename (e.g., "pic.0001.jpg")
-     * @return 512-dimensional feature vector
+     * @return 512-dimensional feature vector; a read-only view into the
+     *         shared store (clone() before modifying)
      */
     cv::Mat getFeaturesByFilename(const std::string& filename) const;
     
     virtual std::string getFeatureName() const override;
     virtual int getFeatureDimension() const override;
     
+    /**
+     * Extract a batch of images through the model
+     * 
+     * Every image is submitted to the inference service before the first
+     * result is awaited, so the batch fills whole forward passes instead
+     * of depending on other workers arriving within the batching window.
+     * Without a model every row stays zero and invalid.
+     */
+    virtual int extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                             std::vector<uchar>* valid = nullptr) override;
+    
+    /**
+     * The inference service is thread-safe; the CSV lookup path does not
+     * extract from images at all
+     */
+    virtual bool isThreadSafe() const override { return service_ != nullptr; }
+    
+    /**
+     * The model's maxBatch with a model loaded, otherwise 1
+     */
+    virtual int getPreferredBatchSize() const override { return service_ ? maxBatch_ : 1; }
+    
     /**
      * Load DNN features from CSV file
      * 
      * CSV format: filename,f1,f2,...,f512
      * 
+     * Opens the shared EmbeddingStore for the file; the first call
+     * converts the CSV to "<csv>.fdb", later calls map that cache.
+     * 
      * @param csvPath Path to CSV file
      * @return True if successful
      */
@@ -100,21 +165,18 @@ public:
     /**
      * Check if features are loaded
      */
-    bool isFeaturesLoaded() const { return !features_.empty(); }
+    bool isFeaturesLoaded() const { return store_ && store_->size() > 0; }
     
     /**
      * Get number of loaded features
      */
-    size_t getNumFeatures() const { return features_.size(); }
+    size_t getNumFeatures() const { return store_ ? store_->size() : 0; }
 
 private:
-    std::string csvPath_;                        ///< Path to DNN features CSV
-    std::map<std::string, cv::Mat> features_;    ///< Map: filename → features
-    
-    /**
-     * Normalize filename for consistent lookup
-     */
-    std::string normalizeFilename(const std::string& filename) const;
+    std::string csvPath_;                                ///< Path to DNN features CSV
+    std::shared_ptr<const EmbeddingStore> store_;        ///< Shared filename → features
+    std::shared_ptr<cvcore::InferenceService> service_;  ///< Native model, shared
+    int maxBatch_ = 1;                                   ///< Batch size given to loadModel()
 };
 
 } // namespace cbir
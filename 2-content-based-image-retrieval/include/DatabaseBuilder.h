@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+// DatabaseBuilder.h
+// Author: Krushna Sanjay Sharma
+// Description: Pipelined, resumable feature extraction for large image
+//              collections. Decoder threads, per-worker feature extractors and
+//              a single writer that checkpoints finished rows to disk. Several
+//              feature databases can be filled from one decode pass.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATABASE_BUILDER_H
+#define DATABASE_BUILDER_H
+
+#include "CompositeExtractor.h"
+#include "FeatureExtractor.h"
+#include "FeatureDatabase.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+class ThumbnailAtlasWriter;
+
+/**
+ * @struct BuildOptions
+ * @brief Tuning and checkpoint settings for DatabaseBuilder
+ */
+struct BuildOptions {
+    int decoderThreads = 2;          ///< Threads decoding images
+    int readQueueDepth = 32;         ///< File reads in flight (BatchReader);
+                                     ///< 0 = decoders read files with cv::imread
+                                     ///< (object storage URLs always use the reader)
+    size_t prefetchBytes = size_t(256) << 20;  ///< Read-ahead files kept in memory
+    int decodeReduction = 1;         ///< Requested decode reduction (1, 2, 4, 8)
+    int maxImageSide = 0;            ///< Requested longest decoded side (0 = full size)
+    bool regionDecode = true;        ///< Decode only the centred region every
+                                     ///< extractor reads (JPEG only)
+    int queueDepth = 64;             ///< Decoded images buffered per extractor
+    std::string checkpointPath;      ///< Append-only checkpoint ("" = none)
+    std::vector<std::string> checkpointPaths; ///< Per-database checkpoints for
+                                              ///< multi-database builds
+    int checkpointInterval = 1000;   ///< Rows between checkpoint flushes
+    int progressInterval = 1000;     ///< Rows between progress lines
+    ThumbnailAtlasWriter* thumbnails = nullptr;  ///< Also encode a thumbnail of every
+                                                 ///< decoded image (not owned)
+};
+
+/**
+ * @class DatabaseBuilder
+ * @brief Builds a FeatureDatabase with a decode / extract / write pipeline
+ *
+ * Stages:
+ *   0. a BatchReader keeps readQueueDepth file reads in flight (io_uring
+ *      where available, HTTP fetches for object storage URLs) and hands
+ *      whole files to the decoders, at most prefetchBytes of them ahead
+ *   1. decoderThreads threads decode images, at reduced resolution or capped
+ *      size when both the options and every extractor allow it; the policy
+ *      used is stored in each database (FeatureDatabase::getDecodePolicy).
+ *      When every extractor reads only a centred region
+ *      (FeatureExtractor::getDecodeRegion), JPEGs are decoded only there
+ *   2. one thread per extractor computes features; each worker owns its
+ *      extractor, so extractors need not be thread-safe
+ *   3. the calling thread adds rows to the database in input order and
+ *      appends them to the checkpoint file
+ *
+ * With BuildOptions::thumbnails set, the workers also shrink and encode
+ * each decoded image into the thumbnail atlas, so the images are read
+ * only once for both.
+ *
+ * The checkpoint is a CSV of finished rows ("filename,v1,v2,...") behind a
+ * "#checkpoint,<feature name>" line. If it exists when build() starts, its
+ * rows are loaded and those images are skipped, so an interrupted run
+ * continues where it stopped. A torn last line is cut off on resume.
+ *
+ * With CompositeExtractor workers, each image is decoded once and every
+ * member's features go to their own database (and own checkpoint); an image
+ * is re-extracted on resume only if some database is missing it.
+ *
+ * Usage example:
+ * @code
+ *   std::vector<std::unique_ptr<FeatureExtractor>> owned;  // one per worker
+ *   std::vector<FeatureExtractor*> workers;                // raw pointers
+ *   BuildOptions options;
+ *   options.checkpointPath = "features.fdb.partial";
+ *   DatabaseBuilder builder(options);
+ *   FeatureDatabase db;
+ *   builder.build(Utils::getImageFiles("images/"), workers, db);
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class DatabaseBuilder {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param options Pipeline and checkpoint settings
+     */
+    explicit DatabaseBuilder(const BuildOptions& options = BuildOptions());
+
+    /**
+     * @brief Extract features for every image into the database
+     *
+     * @param imageFiles Image paths; database order follows this list
+     * @param extractors One extractor per worker thread (not owned, all of
+     *                   the same configuration)
+     * @param database Database to fill (cleared first)
+     * @return bool True if at least one image was stored
+     */
+    bool build(const std::vector<std::string>& imageFiles,
+               const std::vector<FeatureExtractor*>& extractors,
+               FeatureDatabase& database);
+
+    /**
+     * @brief Fill one database per composite member from a single decode pass
+     *
+     * @param imageFiles Image paths; database order follows this list
+     * @param workers One composite per worker thread (not owned, all with the
+     *                same members in the same order)
+     * @param databases One database per member, in member order (cleared)
+     * @return bool True if every database received at least one image
+     */
+    bool build(const std::vector<std::string>& imageFiles,
+               const std::vector<CompositeExtractor*>& workers,
+               const std::vector<FeatureDatabase*>& databases);
+
+    /**
+     * @brief Extract features, passing the filename to extractors that need it
+     *
+     * ProductMatcherFeature and FaceAwareFeature look up pre-computed DNN
+     * embeddings by filename (FeatureExtractor::extractFromContext); every
+     * other extractor uses the image only.
+     *
+     * @param extractor Feature extractor
+     * @param image Decoded image
+     * @param filename Image filename (no directory)
+     * @return cv::Mat Feature vector, empty on failure
+     */
+    static cv::Mat extractFeatures(FeatureExtractor* extractor, const cv::Mat& image,
+                                   const std::string& filename);
+
+    /**
+     * @brief Delete the checkpoint file(s) (call once the databases are saved)
+     */
+    void removeCheckpoint() const;
+
+    /**
+     * @brief Decode policy for a set of workers
+     *
+     * The requested reduction is lowered to what every extractor allows; the
+     * requested side limit is raised to the largest extractor minimum, or
+     * dropped if some extractor must see the full-size image.
+     */
+    static DecodePolicy negotiatePolicy(const BuildOptions& options,
+                                        const std::vector<CompositeExtractor*>& workers);
+
+    /**
+     * @brief Region every worker's extractors are computed from
+     *
+     * The whole image when region decoding is off, when thumbnails are
+     * written (they need the whole image) or when some extractor reads it all.
+     */
+    static DecodeRegion negotiateRegion(const BuildOptions& options,
+                                        const std::vector<CompositeExtractor*>& workers);
+
+    int getSuccessCount() const { return successCount_; }    ///< Rows extracted this run
+    int getFailCount() const { return failCount_; }          ///< Images that failed
+    int getResumedCount() const { return resumedCount_; }    ///< Rows read from checkpoint
+    double getImagesPerSecond() const { return imagesPerSecond_; } ///< Throughput this run
+    double getReadMegabytesPerSecond() const { return readMegabytesPerSecond_; } ///< File reads this run
+
+private:
+    BuildOptions options_;       ///< Settings
+    int successCount_;           ///< Rows extracted this run
+    int failCount_;              ///< Failed images
+    int resumedCount_;           ///< Rows restored from checkpoint
+    double imagesPerSecond_;     ///< Throughput of the last build()
+    double readMegabytesPerSecond_;  ///< Read throughput of the last build() (0 without reader)
+
+    /**
+     * @brief Load rows from an existing checkpoint and truncate a torn tail
+     *
+     * @param path Checkpoint file
+     * @param featureName Expected extractor name
+     * @param database Database receiving the rows
+     * @return bool False if the checkpoint belongs to another feature type
+     */
+    bool resumeCheckpoint(const std::string& path, const std::string& featureName,
+                          FeatureDatabase& database);
+
+    /**
+     * @brief Shared pipeline behind both build() overloads
+     *
+     * @param checkpoints One checkpoint path per database, or empty for none
+     */
+    bool run(const std::vector<std::string>& imageFiles,
+             const std::vector<CompositeExtractor*>& workers,
+             const std::vector<FeatureDatabase*>& databases,
+             const std::vector<std::string>& checkpoints);
+};
+
+} // namespace cbir
+
+#endif // DATABASE_BUILDER_H
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+// DecodePolicy.h
+// Author: Krushna Sanjay Sharma
+// Description: How an image is decoded before feature extraction: JPEG
+//              decode reduction (1/2, 1/4, 1/8) and an optional cap on the
+//              longest side. The policy a database was built with is stored
+//              in its header so query images are decoded the same way.
+//              Batch builds whose extractors only read a centred region
+//              decode just that region of JPEG files (DecodeRegion).
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DECODE_POLICY_H
+#define DECODE_POLICY_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct DecodeRegion
+ * @brief Centred part of an image a feature extractor reads
+ *
+ * Returned by FeatureExtractor::getDecodeRegion(). The region is centred in
+ * the decoded image; its side is fraction times the image side, but at
+ * least minSide pixels, plus a two-pixel margin so that extractors rounding
+ * their own centre differently still fall inside it. The default (fraction
+ * 1) is the whole image.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+struct DecodeRegion {
+    double fraction = 1.0;   ///< Region side / image side (1 = whole image)
+    int minSide = 0;         ///< Region side is never below this (pixels)
+
+    /**
+     * @brief Region of the side fraction only, e.g. the centre 50 %
+     */
+    static DecodeRegion centred(double fraction, int minSide = 0);
+
+    /**
+     * @brief True if the whole image is needed
+     */
+    bool isWholeImage() const { return fraction >= 1.0; }
+
+    /**
+     * @brief Rectangle of the region (with margin) in an image of the given size
+     */
+    cv::Rect in(const cv::Size& size) const;
+
+    /**
+     * @brief Smallest region containing both
+     */
+    DecodeRegion merge(const DecodeRegion& other) const;
+};
+
+/**
+ * @struct DecodePolicy
+ * @brief Decode reduction plus longest-side limit
+ *
+ * load() decodes with cv::IMREAD_REDUCED_COLOR_<reduction> (the JPEG
+ * decoder skips the discarded DCT coefficients; other formats are resized
+ * after decoding) and then shrinks the image with INTER_AREA until its
+ * longest side is at most maxSide. The default policy decodes at full size.
+ *
+ * Usage example:
+ * @code
+ *   DecodePolicy policy = database.getDecodePolicy();
+ *   cv::Mat image = policy.load("query.jpg");
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+struct DecodePolicy {
+    int reduction = 1;   ///< Decode reduction (1, 2, 4, 8)
+    int maxSide = 0;     ///< Longest side after decoding (0 = no limit)
+
+    /**
+     * @brief Policy with the reduction rounded down to 1, 2, 4 or 8
+     *
+     * @param reduction Requested reduction
+     * @param maxSide Requested longest side (negative treated as 0)
+     */
+    static DecodePolicy make(int reduction, int maxSide);
+
+    /**
+     * @brief True if images are decoded unchanged
+     */
+    bool isFullResolution() const { return reduction <= 1 && maxSide <= 0; }
+
+    /**
+     * @brief Imread flags for the reduction
+     */
+    int imreadFlags() const;
+
+    /**
+     * @brief Decode a file and apply the side limit
+     *
+     * @param filepath Image file
+     * @return cv::Mat BGR image, empty (with an error message) if unreadable
+     */
+    cv::Mat load(const std::string& filepath) const;
+
+    /**
+     * @brief Decode only the part of a file inside a region
+     *
+     * JPEG files are decoded with libjpeg-turbo's partial decode: rows above
+     * the region are skipped without colour conversion or upsampling, rows
+     * below it are never decoded, and columns are cropped to the region
+     * (widened to whole iMCUs). The pixels are those of load() at the same
+     * positions. Other formats, EXIF-rotated JPEGs, images the side limit
+     * would shrink and builds without libjpeg-turbo decode the whole image
+     * through load().
+     *
+     * @param filepath Image file
+     * @param region Region the extractors read
+     * @param fullSize Output: size load() would return
+     * @param offset Output: position of the returned image within it
+     * @return cv::Mat BGR image covering the region, empty if unreadable
+     */
+    cv::Mat loadRegion(const std::string& filepath, const DecodeRegion& region,
+                       cv::Size& fullSize, cv::Point& offset) const;
+
+    /**
+     * @brief Decode an image file already read into memory
+     *
+     * Same pixels as load() on the file (cv::imdecode with imreadFlags()).
+     *
+     * @param bytes Encoded file contents
+     * @return cv::Mat BGR image, empty if the bytes do not decode
+     */
+    cv::Mat decode(const std::vector<unsigned char>& bytes) const;
+
+    /**
+     * @brief loadRegion() on a file already read into memory
+     *
+     * @param bytes Encoded file contents
+     * @param region Region the extractors read
+     * @param fullSize Output: size decode() would return
+     * @param offset Output: position of the returned image within it
+     * @return cv::Mat BGR image covering the region, empty if undecodable
+     */
+    cv::Mat decodeRegion(const std::vector<unsigned char>& bytes, const DecodeRegion& region,
+                         cv::Size& fullSize, cv::Point& offset) const;
+
+    /**
+     * @brief Apply the side limit to an already decoded image
+     */
+    cv::Mat limitSide(const cv::Mat& image) const;
+
+    /**
+     * @brief Short description, e.g. "1/4 decode, max side 512"
+     */
+    std::string describe() const;
+
+    bool operator==(const DecodePolicy& other) const {
+        return reduction == other.reduction && maxSide == other.maxSide;
+    }
+    bool operator!=(const DecodePolicy& other) const { return !(*this == other); }
+};
+
+} // namespace cbir
+
+#endif // DECODE_POLICY_H
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+// DeltaLog.h
+// Author: Krushna Sanjay Sharma
+// Description: Append-only change log kept next to a feature database file.
+//              Records added, replaced and removed images (with file stamps)
+//              so a database can be updated without rewriting its base file.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DELTA_LOG_H
+#define DELTA_LOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct FileStamp
+ * @brief Identity of an image file version: modification time + content hash
+ *
+ * A zero hash means "not computed"; the modification time alone is then
+ * used to detect changes.
+ */
+struct FileStamp {
+    int64_t modified = 0;   ///< Last write time (filesystem clock ticks)
+    uint64_t hash = 0;      ///< FNV-1a of the file contents, 0 = unknown
+
+    /**
+     * @brief Stamp a file
+     *
+     * @param path File to stamp
+     * @param withHash Also hash the file contents (reads the whole file)
+     * @return FileStamp Stamp, all zero if the file cannot be read
+     */
+    static FileStamp of(const std::string& path, bool withHash);
+
+    /**
+     * @brief FNV-1a hash of a file's contents
+     *
+     * @param path File to hash
+     * @return uint64_t Hash, 0 if the file cannot be read
+     */
+    static uint64_t hashFile(const std::string& path);
+};
+
+/**
+ * @struct DeltaRecord
+ * @brief One entry of a DeltaLog
+ */
+struct DeltaRecord {
+    enum class Type {
+        Put,      ///< Add or replace an image's features
+        Remove,   ///< Remove an image
+        Stamp     ///< Record a file stamp only (features unchanged)
+    };
+
+    Type type = Type::Put;
+    std::string name;             ///< Image filename
+    FileStamp stamp;              ///< Put / Stamp only
+    std::vector<float> values;    ///< Put only
+};
+
+/**
+ * @class DeltaLog
+ * @brief Text log of DeltaRecords, one per line, appended and flushed per change
+ *
+ * Format, after a "#cbir-delta,1" line:
+ *   +,name,modified,hash,v1,v2,...   add or replace
+ *   -,name                           remove
+ *   =,name,modified,hash             stamp only
+ *
+ * Replaying the log is idempotent (a put overwrites, removing an absent name
+ * does nothing), so a crash between replacing the base file and rewriting
+ * the log during compaction loses nothing. A torn last line left by a crash
+ * is dropped and truncated by read().
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class DeltaLog {
+public:
+    /**
+     * @brief Log file used for a database file ("<basePath>.log")
+     */
+    static std::string pathFor(const std::string& basePath);
+
+    /**
+     * @brief Read every complete record, truncating a torn tail
+     *
+     * @param path Log file
+     * @param records Output records in log order
+     * @return bool False if the file exists but is not a delta log
+     */
+    static bool read(const std::string& path, std::vector<DeltaRecord>& records);
+
+    /**
+     * @brief Open a log for appending, creating it if needed
+     *
+     * @param path Log file
+     * @param reset Discard any existing records
+     * @return bool True if the log is writable
+     */
+    bool open(const std::string& path, bool reset);
+
+    /**
+     * @brief Append one record (buffered until flush())
+     */
+    bool append(const DeltaRecord& record);
+
+    /**
+     * @brief Push appended records to the operating system
+     */
+    bool flush();
+
+    /**
+     * @brief Current log length in bytes
+     */
+    uint64_t size();
+
+    /**
+     * @brief Replace the log with head followed by the bytes from tailOffset
+     *
+     * Used by compaction: head holds the stamps of the new base snapshot,
+     * the tail the records appended after the snapshot was taken. The new
+     * file is written beside the log and renamed over it.
+     *
+     * @param head Records written first
+     * @param tailOffset Byte offset in the current log where the tail starts
+     * @return bool True on success (the log stays open for appending)
+     */
+    bool rewrite(const std::vector<DeltaRecord>& head, uint64_t tailOffset);
+
+    /**
+     * @brief Log file path ("" while closed)
+     */
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;       ///< Log file
+    std::ofstream file_;     ///< Append stream
+
+    /// Write one record as a line
+    static void writeRecord(std::ostream& out, const DeltaRecord& record);
+};
+
+} // namespace cbir
+
+#endif // DELTA_LOG_H
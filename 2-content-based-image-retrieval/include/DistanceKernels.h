@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+// DistanceKernels.h
+// Author: Krushna Sanjay Sharma
+// Description: Vectorised inner loops shared by the distance metrics (squared
+//              difference, dot product, histogram intersection), for float
+//              rows and for uint8 scalar-quantised rows. AVX2 or NEON is
+//              selected at runtime, with a scalar fallback.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DISTANCE_KERNELS_H
+#define DISTANCE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cbir {
+
+/**
+ * @namespace DistanceKernels
+ * @brief Raw float-array kernels used by DistanceMetric::computeBatch()
+ *
+ * All functions take contiguous float arrays of length n and accumulate in
+ * float with several independent accumulators, so results may differ from
+ * the double-precision scalar compute() paths in the last few bits.
+ *
+ * The *Quantized variants read a database row in the uint8 layout of
+ * FeatureStorage::UInt8 instead: n codes, padding to a multiple of four
+ * bytes, then a float32 scale, with value[i] = codes[i] × scale. Codes are
+ * widened in registers, so a scan reads a quarter of the float32 bytes.
+ */
+namespace DistanceKernels {
+
+    /// Elements between two cutoff checks of the *Bounded kernels
+    const int CUTOFF_CHECK_FLOATS = 64;
+
+    /**
+     * @brief Bytes per quantised row of length n (codes, padding, scale)
+     */
+    inline size_t quantizedRowBytes(int n) {
+        return (static_cast<size_t>(n) + 3) / 4 * 4 + sizeof(float);
+    }
+
+    /**
+     * @brief Scale stored after the codes of a quantised row
+     */
+    inline float quantizedScale(const uint8_t* row, int n) {
+        float scale;
+        std::memcpy(&scale, row + quantizedRowBytes(n) - sizeof(float), sizeof(float));
+        return scale;
+    }
+
+    /**
+     * @brief Quantise n non-negative values into one row
+     *
+     * scale = max / 255 and codes[i] = round(values[i] / scale), so the
+     * error per element is at most scale / 2.
+     *
+     * @param row Output, quantizedRowBytes(n) bytes
+     * @return bool False (row untouched) if a value is negative or not finite
+     */
+    bool quantize(const float* values, int n, uint8_t* row);
+
+    /**
+     * @brief Expand a quantised row to n floats
+     */
+    void dequantize(const uint8_t* row, int n, float* values);
+
+    /**
+     * @brief Σ (a[i] - b[i])²
+     */
+    float squaredDifference(const float* a, const float* b, int n);
+
+    /**
+     * @brief Dot product a · b together with Σ b[i]² in one pass
+     *
+     * @param dot Output: a · b
+     * @param squaresB Output: Σ b[i]²
+     */
+    void dotAndSquares(const float* a, const float* b, int n,
+                       float* dot, float* squaresB);
+
+    /**
+     * @brief Dot product a · b
+     *
+     * Accumulates exactly like the dot product of dotAndSquares(), so the
+     * two give the same value.
+     */
+    float dot(const float* a, const float* b, int n);
+
+    /**
+     * @brief Σ min(a[i], scale × b[i]), optionally with Σ b[i]
+     *
+     * @param scale Factor applied to b (1 / Σ b to normalize on the fly)
+     * @param sumB Output: Σ b[i] (may be nullptr)
+     * @return float Histogram intersection
+     */
+    float intersection(const float* a, const float* b, int n,
+                       float scale, float* sumB);
+
+    /**
+     * @brief Histogram intersection of four queries with one row
+     *
+     * Each element of b is loaded once and compared with all four queries,
+     * so a block of rows is read once per four queries instead of once per
+     * query. Repeat a pointer to score fewer than four queries.
+     *
+     * @param a Four query arrays
+     * @param scale Factor applied to b
+     * @param results Output: Σ min(a[k][i], scale × b[i]) for k = 0..3
+     * @param sumB Output: Σ b[i] (may be nullptr)
+     */
+    void intersection4(const float* const a[4], const float* b, int n,
+                       float scale, float results[4], float* sumB);
+
+    /**
+     * @brief Σ weights[i] × min(a[i], b[i])
+     *
+     * Region-weighted histogram intersection in one pass over the whole
+     * vector: with every bin of region r weighted w_r, the result is
+     * Σ_r w_r × intersection_r.
+     */
+    float weightedIntersection(const float* a, const float* b, const float* weights, int n);
+
+    /**
+     * @brief Σ a[i]
+     */
+    float sum(const float* a, int n);
+
+    /**
+     * @brief Σ (a[i] - b[i])², abandoned once it exceeds a cutoff
+     *
+     * The running sum is checked every CUTOFF_CHECK_FLOATS elements. The
+     * accumulation order is that of squaredDifference(), so a completed
+     * call returns exactly the same value.
+     *
+     * @param cutoff Largest sum of interest
+     * @return float The full sum if it is at most cutoff, otherwise a
+     *         partial sum greater than cutoff
+     */
+    float squaredDifferenceBounded(const float* a, const float* b, int n, float cutoff);
+
+    /**
+     * @brief Histogram intersection, abandoned once 1 - Σ min(a[i], b[i])
+     *        provably exceeds a limit
+     *
+     * For non-negative a and b, the bins not yet visited add at most
+     * Σ a over them; a row later normalized by 1 / Σ b (see
+     * HistogramIntersection::computeBatch()) raises the visited part by
+     * at most 1 / (Σ b so far). The resulting lower bound on the distance
+     * is tested every CUTOFF_CHECK_FLOATS elements. A completed call
+     * matches intersection() with scale 1.
+     *
+     * @param sumA Σ a over all n elements
+     * @param maxDistance Largest distance of interest
+     * @param result Output: Σ min(a[i], b[i]) (completed calls only)
+     * @param sumB Output: Σ b[i] (completed calls only)
+     * @return bool False if abandoned
+     */
+    bool intersectionBounded(const float* a, const float* b, int n, float sumA,
+                             float maxDistance, float* result, float* sumB);
+
+    /**
+     * @brief Σ (a[i] - scale × codes[i])²
+     */
+    float squaredDifferenceQuantized(const float* a, const uint8_t* codes, int n, float scale);
+
+    /**
+     * @brief Dot product and squared norm against scale × codes
+     *
+     * @param dot Output: Σ a[i] × scale × codes[i]
+     * @param squaresB Output: Σ (scale × codes[i])²
+     */
+    void dotAndSquaresQuantized(const float* a, const uint8_t* codes, int n, float scale,
+                                float* dot, float* squaresB);
+
+    /**
+     * @brief Σ a[i] × scale × codes[i], as computed by dotAndSquaresQuantized()
+     */
+    float dotQuantized(const float* a, const uint8_t* codes, int n, float scale);
+
+    /**
+     * @brief Σ min(a[i], scale × codes[i]), optionally with Σ codes[i]
+     *
+     * @param scale Row scale, times 1 / Σ b to normalize on the fly
+     * @param sumCodes Output: Σ codes[i], unscaled (may be nullptr)
+     */
+    float intersectionQuantized(const float* a, const uint8_t* codes, int n,
+                                float scale, float* sumCodes);
+
+    /**
+     * @brief Name of the instruction set the kernels dispatch to
+     *
+     * @return const char* "AVX2", "NEON" or "scalar"
+     */
+    const char* instructionSet();
+
+} // namespace DistanceKernels
+
+} // namespace cbir
+
+#endif // DISTANCE_KERNELS_H
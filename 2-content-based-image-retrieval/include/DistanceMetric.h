@@ -12,8 +12,11 @@
 
 
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <type_traits>
 
 namespace cbir {
 
@@ -28,6 +31,17 @@ namespace cbir {
  * Derived classes must implement:
  * - compute(): Calculate distance between two feature vectors.
  * - getMetricName(): Return the name of the metric.
+ *
+ * Derived classes may override computeBatch() to score a query against a
+ * whole feature matrix with a vectorised kernel; the default implementation
+ * calls compute() once per row. The built-in metrics implement it through
+ * runBatch(), whose row loop is instantiated per metric with the kernel
+ * inlined, so a scan makes one virtual call per block of rows rather than
+ * one per row; custom metrics only need compute(). computeBlock() scores a block of queries
+ * against a block of rows; its default calls computeBatch() per query.
+ * Metrics whose partial sums bound the final distance override
+ * computeWithCutoff() and supportsCutoff(), so a top-K scan can stop
+ * scoring a row once it cannot enter the result.
  * 
  * Common distance metrics include:
  * - Sum of Squared Differences (SSD / L2 distance).
@@ -62,6 +76,96 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) = 0;
 
+    /**
+     * @brief Compute distances from one query to every row of a matrix.
+     * 
+     * The matrix is typically (a row range of) FeatureDatabase::matrix().
+     * ImageRetrieval calls this concurrently on disjoint row ranges, so
+     * implementations must not modify shared state.
+     * 
+     * @param query Query feature vector (CV_32F, matrix.cols elements).
+     * @param matrix Feature matrix, one vector per row (CV_32F, CV_16F, or
+     *               CV_8U quantised rows, see DistanceKernels).
+     * @param out Output matrix.rows x 1 CV_64F distances. A preallocated
+     *            header of that size (e.g. a rowRange) is filled in place.
+     * @return bool True if successful, false if query and matrix do not match.
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out);
+
+    /**
+     * @brief Compute distances from a block of queries to every row of a matrix.
+     * 
+     * Metrics that can reuse each matrix row across queries (a matrix
+     * product, or a kernel comparing one row with several queries) override
+     * this, so a block of rows is read from memory once per query block
+     * rather than once per query. The same concurrency rules as
+     * computeBatch() apply.
+     * 
+     * @param queries Query feature vectors, one per row (CV_32F, matrix.cols
+     *                columns).
+     * @param matrix Feature matrix as for computeBatch().
+     * @param out Output queries.rows x matrix.rows CV_64F distances.
+     * @return bool True if successful, false if queries and matrix do not match.
+     */
+    virtual bool computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                              cv::Mat& out);
+
+    /**
+     * @brief True if the metric can use pre-computed row norms.
+     * 
+     * Scans then pass FeatureDatabase::rowNorms() to computeBatchNormed()
+     * and computeBlockNormed() instead of calling the plain versions.
+     */
+    virtual bool usesRowNorms() const { return false; }
+
+    /**
+     * @brief computeBatch() with the L2 norm of every matrix row supplied.
+     * 
+     * @param query Query feature vector as for computeBatch().
+     * @param matrix Feature matrix as for computeBatch().
+     * @param rowNorms matrix.rows x 1 CV_64F norms (rows of
+     *                 FeatureDatabase::rowNorms() matching matrix).
+     * @param out Output matrix.rows x 1 CV_64F distances.
+     * @return bool True if successful. The default ignores rowNorms.
+     */
+    virtual bool computeBatchNormed(const cv::Mat& query, const cv::Mat& matrix,
+                                    const cv::Mat& rowNorms, cv::Mat& out);
+
+    /**
+     * @brief computeBlock() with the L2 norm of every matrix row supplied.
+     * 
+     * @return bool True if successful. The default ignores rowNorms.
+     */
+    virtual bool computeBlockNormed(const cv::Mat& queries, const cv::Mat& matrix,
+                                    const cv::Mat& rowNorms, cv::Mat& out);
+
+    /**
+     * @brief Compute a distance, stopping early once it exceeds a cutoff.
+     * 
+     * Used by top-K scans with the current K-th best distance as cutoff:
+     * a row that cannot beat it need not be scored completely. The result
+     * is exact whenever it is at most cutoff; otherwise any value greater
+     * than cutoff may be returned. Errors are reported as for compute().
+     * The default ignores the cutoff and calls compute().
+     * 
+     * @param features1 Query feature vector.
+     * @param features2 Database feature vector.
+     * @param cutoff Largest distance of interest.
+     * @return double Distance, or a value greater than cutoff.
+     */
+    virtual double computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                     double cutoff);
+
+    /**
+     * @brief True if computeWithCutoff() actually abandons early.
+     * 
+     * Scans only switch from computeBatch() to per-row computeWithCutoff()
+     * calls for metrics that return true. Overrides score CV_32F rows with
+     * the same kernels as computeBatch(), so rankings do not change.
+     */
+    virtual bool supportsCutoff() const { return false; }
+
     /**
      * @brief Get the name of this distance metric.
      * 
@@ -104,8 +208,137 @@ protected:
      * @brief Protected constructor - only derived classes can instantiate.
      */
     DistanceMetric() = default;
+
+    /// Placeholder for runBatch() callers without a quantised-row kernel
+    struct NoQuantizedKernel {};
+
+    /**
+     * @brief Shared driver for computeBatch() implementations.
+     * 
+     * Validates the inputs, allocates out, converts float16 rows to float32
+     * in small blocks and calls kernel once per row. Quantised CV_8U rows go
+     * to quantizedKernel when given, and are otherwise expanded to float32
+     * in blocks like float16 rows.
+     * 
+     * The kernels are template parameters (usually lambdas), so each metric
+     * gets its own copy of the row loop with the kernel inlined: no
+     * indirect call, Mat header or compatibility check per row.
+     * 
+     * @param query Query feature vector (CV_32F).
+     * @param matrix Feature matrix (CV_32F, CV_16F or quantised CV_8U).
+     * @param out Output distances, matrix.rows x 1 CV_64F.
+     * @param kernel double(const float* query, const float* row, int length).
+     * @param quantizedKernel double(const float* query, const uint8_t* codes,
+     *                        float scale, int length) (optional).
+     * @return bool True if successful, false on invalid input.
+     */
+    template <typename Kernel, typename QuantizedKernel = NoQuantizedKernel>
+    bool runBatch(const cv::Mat& query, const cv::Mat& matrix, cv::Mat& out,
+                  Kernel kernel, QuantizedKernel quantizedKernel = QuantizedKernel()) const;
+
+    /**
+     * @brief Check a computeBatch() query against a feature matrix.
+     * 
+     * @return bool True if query is CV_32F with matrix.cols elements and
+     *         matrix has a supported storage type (errors are reported).
+     */
+    bool checkBatch(const cv::Mat& query, const cv::Mat& matrix) const;
+
+    /**
+     * @brief Widen rows [start, end) of a float16 or quantised matrix.
+     * 
+     * @param staging Output (end - start) x matrix.cols CV_32F rows.
+     */
+    static void widenRows(const cv::Mat& matrix, int start, int end, cv::Mat& staging);
+
+    /**
+     * @brief Scale stored after the codes of a quantised row.
+     */
+    static float quantizedRowScale(const uint8_t* codes, int length);
+
+    /// Float16 / quantised rows widened per runBatch() step
+    static const int STAGING_ROWS = 256;
+
+    /**
+     * @brief Check a computeBlock() query block against a feature matrix.
+     * 
+     * @return bool True if queries are CV_32F with matrix.cols columns and
+     *         matrix has a supported storage type (errors are reported).
+     */
+    bool checkBlock(const cv::Mat& queries, const cv::Mat& matrix) const;
+
+    /**
+     * @brief Float32 view of a feature matrix.
+     * 
+     * CV_32F matrices are returned as-is; float16 and quantised rows are
+     * widened into staging, once per call rather than once per query.
+     * 
+     * @param matrix Feature matrix (CV_32F, CV_16F or quantised CV_8U).
+     * @param staging Scratch buffer for widened rows.
+     * @return cv::Mat matrix.rows x matrix.cols CV_32F rows.
+     */
+    static cv::Mat floatRows(const cv::Mat& matrix, cv::Mat& staging);
+
+    /**
+     * @brief Check that two vectors can go straight to a float kernel.
+     * 
+     * @return bool True if both are continuous, non-empty CV_32F with the
+     *         same number of elements.
+     */
+    static bool areFloatArrays(const cv::Mat& features1, const cv::Mat& features2);
 };
 
+/**
+ * @brief Row loop of computeBatch(), instantiated per kernel
+ *
+ * @author Krushna Sanjay Sharma
+ */
+template <typename Kernel, typename QuantizedKernel>
+bool DistanceMetric::runBatch(const cv::Mat& query, const cv::Mat& matrix, cv::Mat& out,
+                              Kernel kernel, QuantizedKernel quantizedKernel) const {
+    if (!checkBatch(query, matrix)) {
+        return false;
+    }
+
+    cv::Mat queryData = query.isContinuous() ? query : query.clone();
+    const float* queryPtr = queryData.ptr<float>();
+    const int length = matrix.cols;
+
+    out.create(matrix.rows, 1, CV_64F);
+
+    if (matrix.type() == CV_32F) {
+        for (int row = 0; row < matrix.rows; row++) {
+            *out.ptr<double>(row) = kernel(queryPtr, matrix.ptr<float>(row), length);
+        }
+        return true;
+    }
+
+    // Quantised storage read in place: codes, then the row's scale
+    if constexpr (!std::is_same<QuantizedKernel, NoQuantizedKernel>::value) {
+        if (matrix.type() == CV_8U) {
+            for (int row = 0; row < matrix.rows; row++) {
+                const uint8_t* codes = matrix.ptr<uint8_t>(row);
+                *out.ptr<double>(row) =
+                    quantizedKernel(queryPtr, codes, quantizedRowScale(codes, length), length);
+            }
+            return true;
+        }
+    } else {
+        (void)quantizedKernel;
+    }
+
+    // Float16 or quantised storage: widen a block of rows at a time
+    cv::Mat staging;
+    for (int start = 0; start < matrix.rows; start += STAGING_ROWS) {
+        const int end = std::min(matrix.rows, start + STAGING_ROWS);
+        widenRows(matrix, start, end, staging);
+        for (int row = start; row < end; row++) {
+            *out.ptr<double>(row) = kernel(queryPtr, staging.ptr<float>(row - start), length);
+        }
+    }
+    return true;
+}
+
 // Type alias for smart pointer to DistanceMetric
 using DistanceMetricPtr = std::shared_ptr<DistanceMetric>;
 
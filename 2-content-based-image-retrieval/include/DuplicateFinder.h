@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// DuplicateFinder.h
+// Author: Krushna Sanjay Sharma
+// Description: Near-duplicate detection over a whole FeatureDatabase.
+//              Random-hyperplane (SimHash) signatures bucket the rows, only
+//              rows sharing a bucket are compared with the exact metric,
+//              and confirmed pairs are joined into duplicate clusters.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DUPLICATE_FINDER_H
+#define DUPLICATE_FINDER_H
+
+#include "FeatureDatabase.h"
+#include "DistanceMetric.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct DuplicateOptions
+ * @brief Parameters of a DuplicateFinder run
+ */
+struct DuplicateOptions {
+    double threshold = 0.05;      ///< Largest metric distance counted as a duplicate
+    int bands = 8;                ///< Signature bands; rows sharing any band are candidates
+    int bandBits = 16;            ///< Hyperplanes per band (1..32)
+    size_t maxBucket = 2000;      ///< Larger buckets are skipped (degenerate features)
+    uint64_t seed = 20260201;     ///< Hyperplane seed (same seed, same buckets)
+};
+
+/**
+ * @struct DuplicateStats
+ * @brief Work done by the last DuplicateFinder::find()
+ */
+struct DuplicateStats {
+    size_t candidatePairs = 0;    ///< Pairs compared with the metric
+    size_t duplicatePairs = 0;    ///< Pairs within the threshold
+    size_t skippedBuckets = 0;    ///< Buckets over maxBucket
+    double signatureMs = 0.0;     ///< Hashing time
+    double verifyMs = 0.0;        ///< Bucketing and verification time
+};
+
+/**
+ * @class DuplicateFinder
+ * @brief All-pairs near-duplicate search without comparing all pairs
+ *
+ * Every row is L2-normalised, centred on the mean normalised row and
+ * projected onto bands x bandBits random Gaussian hyperplanes; the signs
+ * form one bandBits-bit key per band. Two rows at angle θ agree on a
+ * hyperplane with probability 1 - θ/π, so near-duplicates share at least
+ * one band key with high probability while unrelated rows rarely share
+ * any. Centring spreads non-negative features (histograms) over the sign
+ * patterns instead of one corner of the space.
+ *
+ * Bands are bucketed one at a time by sorting (key, row) pairs, and a pair
+ * is only verified in the first band it collides in, so no set of seen
+ * pairs is kept. Candidate pairs are verified in parallel batches with
+ * DistanceMetric::computeBatch() (row norms included for cosine), and
+ * pairs already in the same cluster are not verified again. Memory is
+ * bands x 4 bytes of keys plus 8 bytes of sort buffer per row, plus one
+ * batch of pairs, regardless of the storage type or whether the database
+ * is memory-mapped.
+ *
+ * Clusters are the connected components of the confirmed pairs, so two
+ * members of a cluster may be further apart than the threshold through a
+ * chain of duplicates.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class DuplicateFinder {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param options Threshold and LSH parameters
+     */
+    explicit DuplicateFinder(const DuplicateOptions& options = DuplicateOptions());
+
+    /**
+     * @brief Find the duplicate clusters of a database
+     *
+     * @param database Database to scan (unchanged while this runs)
+     * @param metric Exact distance (only computeBatch variants are called,
+     *               concurrently)
+     * @param clusters Output row lists of two or more rows each, largest
+     *                 cluster first, rows ascending within a cluster
+     * @return bool False on invalid options or a metric error
+     */
+    bool find(const FeatureDatabase& database, DistanceMetric& metric,
+              std::vector<std::vector<int>>& clusters);
+
+    /**
+     * @brief Counters and timings of the last find()
+     */
+    const DuplicateStats& stats() const { return stats_; }
+
+private:
+    DuplicateOptions options_;
+    DuplicateStats stats_;
+    std::vector<uint32_t> keys_;   ///< Row-major rows x bands band keys
+
+    /// Compute keys_ for every row of the matrix
+    void computeSignatures(const cv::Mat& matrix);
+
+    /// True if rows a and b share a band key before the given band
+    bool collidedEarlier(int a, int b, int band) const;
+};
+
+} // namespace cbir
+
+#endif // DUPLICATE_FINDER_H
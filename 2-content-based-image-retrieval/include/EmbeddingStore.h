@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+// EmbeddingStore.h
+// Author: Krushna Sanjay Sharma
+// Description: Shared, read-only store of pre-computed DNN embeddings. The
+//              CSV is converted once to a binary feature database beside it,
+//              which is then memory-mapped; every extractor opening the same
+//              file shares one store and looks rows up by filename hash.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EMBEDDING_STORE_H
+#define EMBEDDING_STORE_H
+
+#include "FeatureDatabase.h"
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+
+namespace cbir {
+
+/**
+ * @class EmbeddingStore
+ * @brief Reference-counted, memory-mapped embedding lookup table
+ *
+ * open() keeps a process-wide registry of live stores keyed by path, so
+ * DNNFeature, ProductMatcherFeature and FaceAwareFeature instances (and
+ * every cbirServer worker) built from the same CSV share one mapping. The
+ * store is released when the last holder drops its pointer.
+ *
+ * The first open of "emb.csv" writes "emb.csv.fdb"; later opens map that
+ * cache directly unless the CSV is newer. If the cache cannot be written
+ * the CSV rows are kept in memory instead. A path that is already a binary
+ * feature database is mapped as-is.
+ *
+ * Usage example:
+ * @code
+ *   auto store = EmbeddingStore::open("ResNet18_olym.csv");
+ *   if (store) {
+ *       cv::Mat row = store->lookup("pic.0001.jpg");   // no copy
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class EmbeddingStore {
+public:
+    /**
+     * @brief Open (or share) the store for an embeddings file
+     *
+     * @param path Embeddings CSV or binary feature database
+     * @return std::shared_ptr<const EmbeddingStore> Null if loading failed
+     */
+    static std::shared_ptr<const EmbeddingStore> open(const std::string& path);
+
+    /**
+     * @brief Binary cache path used for a CSV ("<csv>.fdb")
+     */
+    static std::string cachePath(const std::string& csvPath);
+
+    /**
+     * @brief Embedding for an image
+     *
+     * @param filename Image filename or path (directory is ignored)
+     * @return cv::Mat 1 x dimension() CV_32F row, empty if not found. For
+     *         Float32 files this is a header into the store, valid while
+     *         the store is alive; clone() it to keep it longer or modify it.
+     */
+    cv::Mat lookup(const std::string& filename) const;
+
+    size_t size() const { return database_.size(); }            ///< Embeddings stored
+    int dimension() const { return database_.dimension(); }     ///< Values per embedding
+    bool isMapped() const { return database_.isMapped(); }      ///< Served from the cache file
+    const std::string& getPath() const { return path_; }        ///< Path passed to open()
+
+    EmbeddingStore(const EmbeddingStore&) = delete;
+    EmbeddingStore& operator=(const EmbeddingStore&) = delete;
+
+private:
+    EmbeddingStore() = default;
+
+    std::string path_;            ///< Source path
+    FeatureDatabase database_;    ///< Float32 rows plus name hash
+
+    /// Map the cache (converting the CSV first if needed) or load the CSV
+    bool load(const std::string& path);
+};
+
+} // namespace cbir
+
+#endif // EMBEDDING_STORE_H
@@ -21,6 +21,7 @@
 #define FACE_AWARE_DISTANCE_H
 
 #include "DistanceMetric.h"
+#include "LateFusion.h"
 
 namespace cbir {
 
@@ -32,6 +33,10 @@ namespace cbir {
  *   - Face features (1029D)
  *   - Non-face features (1024D)
  * 
+ * Scans use one LateFusion engine per layout: count, layout and colour
+ * segments are scored first, the DNN segment only for rows that can still
+ * enter the top K.
+ * 
  * @author Krushna Sanjay Sharma
  */
 class FaceAwareDistance : public DistanceMetric {
@@ -42,9 +47,35 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
     
+    /**
+     * @brief Weighted distance from a query to every row, one fused
+     *        vectorised pass per row
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
+    /**
+     * @brief Weighted distance, skipping segments once the ones scored
+     *        so far rule the row out
+     * 
+     * Non-CV_32F input falls back to compute().
+     */
+    virtual double computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                     double cutoff) override;
+    
+    virtual bool supportsCutoff() const override { return true; }
+    
     virtual std::string getMetricName() const override;
 
 private:
+    LateFusion faceFusion_;     ///< [dnn(512), count(1), color(512), spatial(4)]
+    LateFusion nonFaceFusion_;  ///< [dnn(512), color(512)]
+    
+    /**
+     * Engine for a feature dimension, nullptr if it is not a known layout
+     */
+    const LateFusion* fusionFor(int dimension) const;
+    
     /**
      * Compute distance for face features (1029D)
      */
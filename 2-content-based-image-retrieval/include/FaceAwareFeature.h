@@ -10,7 +10,7 @@
 //   - Product/object photos → ProductMatcher features
 //
 // Algorithm:
-//   1. Detect faces using Haar cascade
+//   1. Detect faces with YuNet (DNN), or the Haar cascade as fallback
 //   2. If faces found:
 //      - Extract face-specific features (count, positions, colors)
 //      - Combine with DNN embeddings
@@ -38,7 +38,10 @@
 #include "FeatureExtractor.h"
 #include "DNNFeature.h"
 #include "ProductMatcherFeature.h"
+#include "FaceBoxCache.h"
+#include "cvcore/faceDetector.hpp"
 #include <opencv2/objdetect.hpp>
+#include <memory>
 
 namespace cbir {
 
@@ -70,11 +73,18 @@ public:
     /**
      * Constructor
      * 
+     * YuNet is used when its model loads; the Haar cascade is the fallback
+     * and is only loaded then. Every instance with the same YuNet model
+     * shares one pooled detector service, so parallel build workers detect
+     * through the same pool.
+     * 
      * @param dnnCsvPath Path to pre-computed DNN features
      * @param cascadePath Path to Haar cascade XML file for face detection
+     * @param yunetPath Path to the YuNet ONNX model ("" = Haar cascade only)
      */
     FaceAwareFeature(const std::string& dnnCsvPath,
-                    const std::string& cascadePath = "haarcascade_frontalface_default.xml");
+                    const std::string& cascadePath = "haarcascade_frontalface_default.xml",
+                    const std::string& yunetPath = "face_detection_yunet_2023mar.onnx");
     
     virtual ~FaceAwareFeature() = default;
     
@@ -83,6 +93,14 @@ public:
      */
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
     
+    /**
+     * Extract adaptive features from a shared context
+     * 
+     * Face boxes come from the context, so they are detected once per image
+     * however many extractors need them.
+     */
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
+    
     /**
      * Extract adaptive features with filename
      * 
@@ -105,11 +123,18 @@ public:
      * Get number of faces detected in last image
      */
     int getLastFaceCount() const { return lastFaceCount_; }
+    
+    /**
+     * Name of the face detector in use ("YuNet", "Haar" or "none")
+     */
+    std::string getDetectorName() const;
 
 private:
     DNNFeature dnnExtractor_;              ///< DNN feature loader
     ProductMatcherFeature productMatcher_; ///< Fallback for non-face images
-    cv::CascadeClassifier faceCascade_;   ///< Haar cascade face detector
+    cv::CascadeClassifier faceCascade_;   ///< Haar cascade face detector (fallback)
+    std::shared_ptr<cvcore::FaceDetectorService> yunet_; ///< Shared YuNet detector, if loaded
+    std::shared_ptr<FaceBoxCache> faceCache_; ///< Boxes by detector input, "<dnn csv>.faces"
     
     bool lastHadFaces_;   ///< Flag: did last image have faces
     int lastFaceCount_;   ///< Number of faces in last image
@@ -122,6 +147,28 @@ private:
      */
     std::vector<cv::Rect> detectFaces(const cv::Mat& image);
     
+    /**
+     * Run the active detector on its input image
+     * 
+     * The input is the BGR image for YuNet and the equalized grayscale
+     * image for the cascade. Runs on a copy shrunk to at most 640 pixels
+     * and consults the face cache first; boxes are returned in the input's
+     * coordinates.
+     */
+    std::vector<cv::Rect> detectInDetectorInput(const cv::Mat& input);
+    
+    /**
+     * Choose face-based or ProductMatcher features for detected faces
+     * 
+     * @param image Input image
+     * @param faces Detected face bounding boxes (may be empty)
+     * @param filename Filename for DNN lookup
+     * @return Feature vector
+     */
+    cv::Mat extractAdaptive(const cv::Mat& image,
+                            const std::vector<cv::Rect>& faces,
+                            const std::string& filename);
+    
     /**
      * Extract face-based features when faces are present
      * 
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// FaceBoxCache.h
+// Author: Krushna Sanjay Sharma
+// Description: Persistent cache of face boxes (YuNet or Haar cascade).
+//              Boxes are keyed by a hash of the detector input, kept in an
+//              append-only sidecar file and shared by every FaceAwareFeature
+//              instance that opens the same file, so builds, rebuilds and
+//              queries run the detector once per image.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FACE_BOX_CACHE_H
+#define FACE_BOX_CACHE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @class FaceBoxCache
+ * @brief Detector-input hash to face boxes, persisted beside the embeddings
+ *
+ * File format (text, one entry per line, appended as boxes are found):
+ *   #faces,<detector tag>
+ *   <hash hex>,<count>,x,y,w,h,...
+ *
+ * The tag describes the detector and its parameters; a file written with a
+ * different tag is discarded on open. A torn last line (interrupted build)
+ * is ignored. open() shares one cache per path, and find() / insert() are
+ * thread-safe, so all DatabaseBuilder workers fill the same cache.
+ *
+ * Usage example:
+ * @code
+ *   auto cache = FaceBoxCache::open(FaceBoxCache::pathFor("emb.csv"), tag);
+ *   uint64_t key = FaceBoxCache::hashImage(detectorInput);
+ *   std::vector<cv::Rect> faces;
+ *   if (!cache->find(key, faces)) {
+ *       faces = detect(detectorInput);
+ *       cache->insert(key, faces);
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class FaceBoxCache {
+public:
+    /**
+     * @brief Open (or share) the cache stored at a path
+     *
+     * @param path Sidecar file (created on the first insert)
+     * @param tag Detector description; entries from another tag are dropped
+     * @return std::shared_ptr<FaceBoxCache> Never null; if the file cannot
+     *         be written the cache still works in memory
+     */
+    static std::shared_ptr<FaceBoxCache> open(const std::string& path, const std::string& tag);
+
+    /**
+     * @brief Sidecar path for an embeddings file ("<csv>.faces")
+     */
+    static std::string pathFor(const std::string& embeddingsPath);
+
+    /**
+     * @brief FNV-1a over an image's size, type and pixels
+     */
+    static uint64_t hashImage(const cv::Mat& image);
+
+    /**
+     * @brief Cached boxes for a key
+     *
+     * @param key hashImage() of the detector input
+     * @param faces Receives the boxes (in detector-input coordinates)
+     * @return bool False if the image has not been seen
+     */
+    bool find(uint64_t key, std::vector<cv::Rect>& faces) const;
+
+    /**
+     * @brief Store boxes and append them to the sidecar
+     */
+    void insert(uint64_t key, const std::vector<cv::Rect>& faces);
+
+    size_t size() const;                                       ///< Cached images
+    const std::string& getPath() const { return path_; }     ///< Sidecar file
+
+    /**
+     * @brief Destructor (flushes pending entries)
+     */
+    ~FaceBoxCache();
+
+    FaceBoxCache(const FaceBoxCache&) = delete;
+    FaceBoxCache& operator=(const FaceBoxCache&) = delete;
+
+private:
+    FaceBoxCache() = default;
+
+    std::string path_;
+    std::string tag_;
+    std::unordered_map<uint64_t, std::vector<cv::Rect>> entries_;
+    std::ofstream file_;           ///< Append stream, opened on the first insert
+    bool writable_ = true;         ///< False once opening the file failed
+    size_t unflushed_ = 0;         ///< Lines written since the last flush
+    mutable std::mutex mutex_;
+
+    /// Read the sidecar; false if it is missing or has another tag
+    bool load();
+};
+
+} // namespace cbir
+
+#endif // FACE_BOX_CACHE_H
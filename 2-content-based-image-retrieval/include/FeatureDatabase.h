@@ -3,7 +3,8 @@
 // Author: Krushna Sanjay Sharma
 // Description: Manages pre-computed feature vectors for image database. Handles
 //              building, saving, and loading feature databases to/from CSV files
-//              for efficient CBIR queries.
+//              and a packed binary format for efficient CBIR queries, plus
+//              incremental updates through an append-only change log.
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -11,41 +12,109 @@
 #define FEATURE_DATABASE_H
 
 #include "FeatureExtractor.h"
+#include "MappedFile.h"
+#include "DeltaLog.h"
 #include "Utils.h"
-#include <map>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace cbir {
 
+/**
+ * @enum FeatureStorage
+ * @brief Element type of the packed feature matrix
+ */
+enum class FeatureStorage {
+    Float32 = 0,   ///< CV_32F, exact
+    Float16 = 1,   ///< CV_16F, half the size; converted to CV_32F on access
+    UInt8 = 2      ///< Quantised CV_8U rows, a quarter of the size (non-negative
+                   ///< features such as histograms; see DistanceKernels)
+};
+
+/**
+ * @enum FeatureCompression
+ * @brief Block compression of the feature matrix in binary files
+ */
+enum class FeatureCompression {
+    None = 0,     ///< Rows stored as they are, mapped and used in place
+    Zstd = 1      ///< Fixed-size row blocks compressed with zstd (format version 2)
+};
+
+/**
+ * @enum FileChange
+ * @brief State of an image file relative to the database (see checkFile())
+ */
+enum class FileChange {
+    Unchanged,   ///< Same modification time as recorded
+    Touched,     ///< New modification time, same contents
+    Modified,    ///< Contents changed, or no stamp was recorded
+    Added        ///< Not in the database
+};
+
 /**
  * @class FeatureDatabase
  * @brief Manages feature vectors for an image database
- * 
+ *
  * This class handles the creation, storage, and retrieval of feature vectors
  * for a collection of images. Features can be pre-computed and saved to CSV
  * files for fast querying without recomputing features each time.
- * 
+ *
+ * All vectors have the same dimension and are packed into one contiguous
+ * row-major matrix (row i = image i), with a parallel array of names and an
+ * open-addressing hash index from name to row. The binary format (.fdb)
+ * stores exactly these three arrays, so loadFromBinary() maps the file and
+ * uses it in place: opening costs the same for 1K or 1M images.
+ *
+ * Binary layout (little-endian, version 1):
+ *   FileHeader (72 bytes, including the DecodePolicy used at build time)
+ *   features    count rows of float32/float16 values, or of uint8 codes,
+ *               padding to 4 bytes and a float32 scale; 64-byte aligned
+ *   nameOffsets count + 1 uint64, start of each name in nameChars
+ *   hashTable   hashEntries uint32, row + 1 (0 = empty), linear probing
+ *   nameChars   names back to back, no terminators
+ *
+ * Block-compressed files (version 2, FeatureCompression::Zstd) replace the
+ * features section with a directory (codec, rows per block, block count,
+ * blockCount + 1 uint64 offsets) followed by the compressed blocks. A
+ * block holds blockRows() rows, about 256 KB uncompressed, so it fits in
+ * the L2 cache once decompressed. Scans read such databases block by block
+ * through readRows() instead of matrix(); only the compressed bytes are
+ * read from disk and kept in the page cache.
+ *
+ * Incremental updates: load() attaches the change log "<file>.log" and
+ * replays it over the base file, so queries see base + delta. After that,
+ * putFeatures() and removeFeatures() update memory and append to the log;
+ * compact() writes a new base snapshot (optionally on a background thread)
+ * and shrinks the log to the file stamps.
+ *
  * Workflow:
  * 1. Build database: extract features from all images in a directory
- * 2. Save to CSV: persist features for future use
- * 3. Load from CSV: quickly load pre-computed features
+ * 2. Save to CSV or binary: persist features for future use
+ * 3. Load from CSV or binary: quickly load pre-computed features
  * 4. Query: retrieve features for specific images
- * 
+ * 5. Update: put / remove changed images, compact when the log grows
+ *
  * Usage example:
  * @code
  *   // Build and save
  *   FeatureDatabase db;
  *   BaselineFeature extractor;
  *   db.buildDatabase("images/", &extractor);
- *   db.saveToCSV("baseline_features.csv");
- *   
+ *   db.saveToBinary("baseline_features.fdb");
+ *
  *   // Later: load and query
  *   FeatureDatabase db2;
- *   db2.loadFromCSV("baseline_features.csv");
+ *   db2.load("baseline_features.fdb");   // or a .csv file
  *   cv::Mat features = db2.getFeatures("pic.0123.jpg");
  * @endcode
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 class FeatureDatabase {
@@ -56,16 +125,19 @@ public:
     FeatureDatabase();
 
     /**
-     * @brief Destructor
+     * @brief Destructor (waits for a background compaction)
      */
-    ~FeatureDatabase() = default;
+    ~FeatureDatabase();
+
+    FeatureDatabase(const FeatureDatabase&) = delete;
+    FeatureDatabase& operator=(const FeatureDatabase&) = delete;
 
     /**
      * @brief Build feature database from image directory
-     * 
+     *
      * Scans the directory for image files, extracts features using the
      * provided extractor, and stores them in memory.
-     * 
+     *
      * @param imageDirectory Path to directory containing images
      * @param extractor Feature extractor to use
      * @param recursive Search subdirectories if true
@@ -77,9 +149,9 @@ public:
 
     /**
      * @brief Save feature database to CSV file
-     * 
+     *
      * Format: filename,feature1,feature2,...,featureN
-     * 
+     *
      * @param filename Output CSV file path
      * @return bool True if successful, false on error
      */
@@ -87,48 +159,384 @@ public:
 
     /**
      * @brief Load feature database from CSV file
-     * 
+     *
      * @param filename Input CSV file path
      * @return bool True if successful, false on error
      */
     bool loadFromCSV(const std::string& filename);
 
+    /**
+     * @brief Replace the contents with already parsed CSV rows
+     *
+     * Used for the chunks of a streamed load (LiveDatabase::loadAsync()).
+     * Rows are sorted by name like loadFromCSV(); the arrays are taken
+     * over, so rows is left empty.
+     *
+     * @param rows Packed rows (Utils::parseFeaturesCSV())
+     * @return bool False if there are no rows
+     */
+    bool loadFromRows(Utils::PackedFeatureRows& rows);
+
+    /**
+     * @brief Save feature database in the packed binary format
+     *
+     * @param filename Output file path (conventionally .fdb)
+     * @param storage Element type written for the feature matrix; UInt8
+     *                fails if any feature is negative
+     * @param compression Block compression of the feature matrix; fails if
+     *                    the build has no support for it
+     * @return bool True if successful, false on error
+     */
+    bool saveToBinary(const std::string& filename,
+                      FeatureStorage storage = FeatureStorage::Float32,
+                      FeatureCompression compression = FeatureCompression::None) const;
+
+    /**
+     * @brief Open a binary feature database
+     *
+     * With useMmap the file is mapped and used in place (no parsing, no
+     * copy); otherwise it is read into memory. A mapped database becomes an
+     * in-memory copy on the first addFeatures().
+     *
+     * @param filename Input file path
+     * @param useMmap Map the file instead of reading it
+     * @return bool True if successful, false on error or version mismatch
+     */
+    bool loadFromBinary(const std::string& filename, bool useMmap = true);
+
+    /**
+     * @brief Load a database, binary or CSV, detected from the file contents
+     *
+     * Also attaches and replays the file's change log (see attachLog()).
+     *
+     * @param filename Input file path
+     * @return bool True if successful, false on error
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Save as binary for .fdb / .bin file names, as CSV otherwise
+     *
+     * Does not touch any change log: after overwriting a base file with a
+     * fresh build, call attachLog(filename, true) to drop its stale log.
+     *
+     * @param filename Output file path
+     * @param storage Element type for binary files (ignored for CSV)
+     * @param compression Block compression for binary files (ignored for CSV)
+     * @return bool True if successful, false on error
+     */
+    bool save(const std::string& filename,
+              FeatureStorage storage = FeatureStorage::Float32,
+              FeatureCompression compression = FeatureCompression::None) const;
+
+    /**
+     * @brief Split the rows into shardCount files by image name hash
+     *
+     * Shard k holds the images with shardOf(name, shardCount) == k and is
+     * written to shardPath(filename, k, shardCount) in the format save()
+     * picks for filename. Every shard keeps the decode policy. Shards may
+     * be empty for tiny databases; those files are not written.
+     *
+     * @param filename Unsharded output path (e.g. "hist.fdb")
+     * @param shardCount Number of shards (at least 1)
+     * @param storage Element type for binary files (ignored for CSV)
+     * @param compression Block compression for binary files (ignored for CSV)
+     * @return bool True if every non-empty shard was saved
+     */
+    bool saveShards(const std::string& filename, int shardCount,
+                    FeatureStorage storage = FeatureStorage::Float32,
+                    FeatureCompression compression = FeatureCompression::None) const;
+
+    /**
+     * @brief Shard an image belongs to (stable across builds and platforms)
+     *
+     * @param imageName Image filename or path (directory is ignored)
+     * @param shardCount Number of shards
+     * @return int Shard index in [0, shardCount)
+     */
+    static int shardOf(const std::string& imageName, int shardCount);
+
+    /**
+     * @brief File name of one shard: "hist.fdb" -> "hist.shard2of8.fdb"
+     */
+    static std::string shardPath(const std::string& filename, int shard, int shardCount);
+
+    /**
+     * @brief Associate the database with a base file and its change log
+     *
+     * Later putFeatures() / removeFeatures() / stampFiles() calls are
+     * appended to "<basePath>.log" (created on the first change).
+     *
+     * @param basePath Base database file the in-memory rows came from
+     * @param reset Delete the existing log instead of replaying it
+     * @return bool False if the log exists but cannot be read
+     */
+    bool attachLog(const std::string& basePath, bool reset);
+
+    /**
+     * @brief Add or replace an image and record it in the change log
+     *
+     * @param imagePath Image path or filename
+     * @param features Feature vector
+     * @param stamp File stamp of the image version the features came from
+     * @return bool False if the features were rejected or not logged
+     */
+    bool putFeatures(const std::string& imagePath, const cv::Mat& features,
+                     const FileStamp& stamp);
+
+    /**
+     * @brief Remove an image and record it in the change log
+     *
+     * Rewrites the packed arrays, O(size()); batch removals where possible.
+     *
+     * @param imageName Image path or filename
+     * @return bool False if the image is not in the database
+     */
+    bool removeFeatures(const std::string& imageName);
+
+    /**
+     * @brief Remove several images with a single rewrite of the arrays
+     *
+     * @param imageNames Image paths or filenames
+     * @return size_t Number of images removed
+     */
+    size_t removeFeatures(const std::vector<std::string>& imageNames);
+
+    /**
+     * @brief Record file stamps for stored images without changing features
+     *
+     * Used after a full build (modification times only) so the next
+     * incremental update can skip unchanged files, and for files whose
+     * modification time changed but whose contents did not.
+     *
+     * @param stamps (image path, stamp) pairs; images not stored are ignored
+     * @return bool False if the stamps could not be logged
+     */
+    bool stampFiles(const std::vector<std::pair<std::string, FileStamp>>& stamps);
+
+    /**
+     * @brief Compare an image file with the stamp recorded for it
+     *
+     * The file is hashed only if its modification time changed (or it is
+     * new). Rows without a stamp, e.g. from databases built before change
+     * logging existed, report Modified.
+     *
+     * @param imagePath Image file
+     * @param current Output: stamp of the file as it is now
+     * @return FileChange State of the file
+     */
+    FileChange checkFile(const std::string& imagePath, FileStamp& current) const;
+
+    /**
+     * @brief Puts and removes logged since the last compaction
+     */
+    size_t pendingChanges() const { return pendingChanges_.load(); }
+
+    /**
+     * @brief Fold the change log into a new base snapshot
+     *
+     * The current rows are copied, then written to "<base>.compact" and
+     * renamed over the base file; the log is rewritten to the surviving
+     * stamps plus any records appended meanwhile. The in-memory database
+     * stays usable throughout.
+     *
+     * @param background Run on a worker thread (see waitForCompaction())
+     * @return bool True if compaction started (background) or succeeded
+     */
+    bool compact(bool background = true);
+
+    /**
+     * @brief Wait for a background compaction
+     *
+     * @return bool Result of the last compaction (true if none ran)
+     */
+    bool waitForCompaction();
+
+    /**
+     * @brief Check if a background compaction is running
+     */
+    bool isCompacting() const { return compacting_.load(); }
+
+    /**
+     * @brief Check if a file starts with the binary database signature
+     *
+     * @param filename File to inspect
+     * @return bool True if the file is a binary feature database
+     */
+    static bool isBinaryFile(const std::string& filename);
+
+    /**
+     * @brief Check if save() writes a path in the binary format (.fdb/.bin)
+     */
+    static bool isBinaryPath(const std::string& filename);
+
     /**
      * @brief Get feature vector for a specific image
-     * 
+     *
      * @param imageName Name of image file (can be full path or just filename)
-     * @return cv::Mat Feature vector, empty if not found
+     * @return cv::Mat 1 x dimension CV_32F feature vector (a view into the
+     *         packed matrix for Float32 storage), empty if not found
      */
     cv::Mat getFeatures(const std::string& imageName) const;
 
+    /**
+     * @brief Get feature vector by row index
+     *
+     * @param index Row in [0, size())
+     * @return cv::Mat 1 x dimension CV_32F feature vector
+     */
+    cv::Mat getFeaturesAt(size_t index) const;
+
     /**
      * @brief Check if database contains features for an image
-     * 
+     *
      * @param imageName Name of image file
      * @return bool True if features exist for this image
      */
     bool hasFeatures(const std::string& imageName) const;
 
+    /**
+     * @brief Row index of an image
+     *
+     * @param imageName Name of image file (can be full path or just filename)
+     * @return int Row index, -1 if not found
+     */
+    int indexOf(const std::string& imageName) const;
+
+    /**
+     * @brief Name of the image stored in a row
+     *
+     * @param index Row in [0, size())
+     * @return std::string Image filename
+     */
+    std::string getName(size_t index) const;
+
     /**
      * @brief Get all image names in the database
-     * 
-     * @return std::vector<std::string> List of all image filenames
+     *
+     * @return std::vector<std::string> List of all image filenames, in row order
      */
     std::vector<std::string> getImageNames() const;
 
+    /**
+     * @brief Packed feature matrix: size() x dimension(), one row per image
+     *
+     * CV_32F, CV_16F or CV_8U depending on storage(). CV_8U rows hold the
+     * codes, and the row step also covers each row's trailing scale, so
+     * row ranges keep the layout but clone() does not. The header
+     * references the database's memory and is invalidated by addFeatures(),
+     * putFeatures(), removeFeatures() and clear().
+     *
+     * A compressed database is decompressed in full on the first call and
+     * kept in memory until it is modified or cleared; scans use readRows()
+     * to avoid that.
+     *
+     * @return cv::Mat Matrix view, empty if the database is empty
+     */
+    cv::Mat matrix() const;
+
+    /**
+     * @brief L2 norm of every row of the packed matrix
+     *
+     * Lets cosine scans score a row with a single dot product (see
+     * DistanceMetric::usesRowNorms()). Computed in parallel on the first
+     * call after the rows change and reused until the next mutation; not
+     * stored in the binary format, so opening a mapped database stays
+     * O(1). Thread-safe.
+     *
+     * @return cv::Mat size() x 1 CV_64F norms (same lifetime as matrix()),
+     *         empty if the database is empty
+     */
+    cv::Mat rowNorms() const;
+
+    /**
+     * @brief Rows [start, end) of the packed matrix
+     *
+     * Same rows as matrix().rowRange(start, end), without materialising a
+     * compressed matrix: the blocks covering the range are decompressed
+     * into scratch and the result points into it. Ranges aligned to
+     * blockRows() decompress each block once. For uncompressed databases
+     * this is a view and scratch is untouched. Thread-safe with one
+     * scratch buffer per thread.
+     *
+     * @param start First row
+     * @param end One past the last row (start < end <= size())
+     * @param scratch Caller's buffer for decompressed blocks
+     * @return cv::Mat Rows with matrix()'s type and row layout, empty if a
+     *         block is corrupt
+     */
+    cv::Mat readRows(int start, int end, std::vector<uint8_t>& scratch) const;
+
+    /**
+     * @brief Element type of the packed matrix
+     */
+    FeatureStorage storage() const { return storage_; }
+
+    /**
+     * @brief Block compression of the opened file (None once modified)
+     */
+    FeatureCompression compression() const { return compression_; }
+
+    /**
+     * @brief True if rows are decompressed on access (see readRows())
+     */
+    bool isCompressed() const { return compression_ != FeatureCompression::None; }
+
+    /**
+     * @brief Rows per compressed block, 0 if the matrix is not compressed
+     */
+    int blockRows() const { return blockRows_; }
+
+    /**
+     * @brief True if this build can read and write a compression codec
+     */
+    static bool compressionAvailable(FeatureCompression compression);
+
+    /**
+     * @brief How the images were decoded when the features were extracted
+     *
+     * Set by DatabaseBuilder and stored in the binary header; query images
+     * should be decoded with the same policy (DecodePolicy::load). CSV files
+     * do not record it and load as full resolution.
+     */
+    const DecodePolicy& getDecodePolicy() const { return decodePolicy_; }
+
+    /**
+     * @brief Record the decode policy (kept until clear())
+     */
+    void setDecodePolicy(const DecodePolicy& policy) { decodePolicy_ = policy; }
+
+    /**
+     * @brief Length of every feature vector (0 while empty)
+     */
+    int dimension() const { return dimension_; }
+
     /**
      * @brief Get number of images in database
-     * 
+     *
      * @return size_t Number of stored feature vectors
      */
-    size_t size() const { return features_.size(); }
+    size_t size() const { return count_; }
 
     /**
      * @brief Check if database is empty
-     * 
+     *
      * @return bool True if no features are stored
      */
-    bool empty() const { return features_.empty(); }
+    bool empty() const { return count_ == 0; }
+
+    /**
+     * @brief Check if the database is served from a mapped file
+     */
+    bool isMapped() const { return mapped_ != nullptr; }
+
+    /**
+     * @brief Mutation counter
+     *
+     * Changes whenever rows are loaded, added, updated or removed, so
+     * caches of query results can tell that their entries are stale.
+     */
+    uint64_t version() const { return version_.load(); }
 
     /**
      * @brief Clear all stored features
@@ -137,32 +545,139 @@ public:
 
     /**
      * @brief Add or update features for a single image
-     * 
+     *
      * @param imageName Image filename
-     * @param features Feature vector
+     * @param features Feature vector (any shape, converted to float32)
+     * @return bool True if stored, false if the dimension does not match
      */
-    void addFeatures(const std::string& imageName, const cv::Mat& features);
-
-    /**
-     * @brief Get all features as a map
-     * 
-     * @return const std::map<std::string, cv::Mat>& Reference to features map
-     */
-    const std::map<std::string, cv::Mat>& getAllFeatures() const {
-        return features_;
-    }
+    bool addFeatures(const std::string& imageName, const cv::Mat& features);
 
 private:
-    /// Map: image filename -> feature vector
-    std::map<std::string, cv::Mat> features_;
+    /// On-disk header of the binary format
+    struct FileHeader {
+        char magic[8];               ///< "CBIRFDB" + NUL
+        uint32_t version;            ///< FORMAT_VERSION
+        uint32_t storage;            ///< FeatureStorage
+        uint64_t count;              ///< Number of rows
+        uint32_t dimension;          ///< Columns per row
+        uint16_t decodeReduction;    ///< DecodePolicy::reduction (0 in older files = 1)
+        uint16_t decodeMaxSide;      ///< DecodePolicy::maxSide (0 = no limit)
+        uint64_t featuresOffset;     ///< Byte offset of the feature matrix
+        uint64_t nameOffsetsOffset;  ///< Byte offset of the name offsets
+        uint64_t hashOffset;         ///< Byte offset of the hash table
+        uint64_t hashEntries;        ///< Slots in the hash table (power of two)
+        uint64_t nameCharsOffset;    ///< Byte offset of the name characters
+    };
+
+    /// Directory at the start of a compressed features section
+    struct BlockDirectory {
+        uint32_t codec;              ///< FeatureCompression
+        uint32_t blockRows;          ///< Rows per block (the last may be shorter)
+        uint64_t blockCount;         ///< Number of blocks
+    };
+
+    static const uint32_t FORMAT_VERSION = 1;
+    static const uint32_t COMPRESSED_FORMAT_VERSION = 2;
+
+    // Owned storage (in-memory databases)
+    std::vector<float> ownedFeatures_;
+    std::vector<uint64_t> ownedNameOffsets_;
+    std::vector<char> ownedNameChars_;
+    std::vector<uint32_t> ownedHash_;
+
+    // Mapped storage (binary databases opened with mmap)
+    std::unique_ptr<MappedFile> mapped_;
+    std::vector<char> fileBuffer_;   ///< Binary database read without mmap
+
+    // Views used by every accessor; point into owned or file storage
+    const void* features_;
+    const uint64_t* nameOffsets_;
+    const char* nameChars_;
+    const uint32_t* hash_;
+    size_t hashEntries_;
+
+    size_t count_;
+    int dimension_;
+    FeatureStorage storage_;
+    DecodePolicy decodePolicy_;     ///< Decode policy of the extracted images
+
+    // Compressed feature blocks (views into the file image, see readRows())
+    FeatureCompression compression_;
+    int blockRows_;
+    size_t blockCount_;
+    const uint64_t* blockOffsets_;  ///< blockCount_ + 1 offsets into blockData_
+    const char* blockData_;
+    mutable std::vector<uint8_t> inflated_;   ///< Whole matrix, once matrix() is called
+    mutable std::atomic<bool> inflatedReady_;
+    mutable std::mutex inflateMutex_;         ///< Guards inflated_
+
+    // Change log state
+    std::string basePath_;                          ///< Base file ("" = not logged)
+    bool baseBinary_;                               ///< Base file is binary
+    FeatureStorage baseStorage_;                    ///< Storage written by compaction
+    FeatureCompression baseCompression_;            ///< Compression written by compaction
+    std::unique_ptr<DeltaLog> log_;                 ///< Opened on the first change
+    std::unordered_map<std::string, FileStamp> stamps_;  ///< Stamp per image name
+    std::atomic<size_t> pendingChanges_;            ///< Logged puts / removes
+    std::mutex logMutex_;                           ///< Guards log_ against compaction
+    std::thread compactionThread_;                  ///< Background compaction
+    std::atomic<bool> compacting_;                  ///< Compaction running
+    bool compactionResult_;                         ///< Result of the last compaction
+    std::atomic<uint64_t> version_;                 ///< Bumped by every mutation
+
+    // Row norms for cosine scans (see rowNorms())
+    mutable std::vector<double> rowNorms_;          ///< One per row
+    mutable uint64_t normsVersion_;                 ///< version() they were computed at
+    mutable std::mutex normsMutex_;                 ///< Guards the two above
 
     /**
      * @brief Normalize image name (extract filename from full path)
-     * 
+     *
      * @param imagePath Full or partial image path
      * @return std::string Just the filename
      */
     std::string normalizeImageName(const std::string& imagePath) const;
+
+    /// Row index of a normalized name, -1 if absent
+    int findRow(const std::string& name) const;
+
+    /// Set up views over a binary image of the file (mapped or read)
+    bool attachBinary(const char* data, size_t size, const std::string& filename);
+
+    /// Decompress one block into out (blockRows_ rows of room)
+    bool inflateBlock(size_t block, uint8_t* out) const;
+
+    /// Drop the compressed views and the decompressed copy
+    void resetCompression();
+
+    /// Copy file-backed storage into owned vectors before a modification
+    void detach();
+
+    /// Point the views at the owned vectors
+    void refreshViews();
+
+    /// Rebuild the owned hash table with at least minEntries slots
+    void rebuildHash(size_t minEntries);
+
+    /// Drop rows (ascending indices) and rebuild the arrays once
+    void removeRows(const std::vector<size_t>& rows);
+
+    /// Take over rows read from a CSV (name order, last duplicate wins)
+    void adoptRows(Utils::PackedFeatureRows& rows);
+
+    /// Replace this database's rows with a float32 copy of another's
+    void copyFrom(const FeatureDatabase& other);
+
+    /// Apply log records; removals are batched into one removeRows()
+    size_t replay(const std::vector<DeltaRecord>& records);
+
+    /// Append records to the change log (no-op without a base file)
+    bool logChanges(const std::vector<DeltaRecord>& records);
+
+    /// Write snapshot to the base file and rewrite the log (compaction body)
+    bool writeCompaction(const std::shared_ptr<FeatureDatabase>& snapshot,
+                         const std::vector<DeltaRecord>& stamps,
+                         uint64_t tailOffset, size_t foldedChanges);
 };
 
 } // namespace cbir
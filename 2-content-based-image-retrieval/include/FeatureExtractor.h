@@ -10,12 +10,16 @@
 #ifndef FEATURE_EXTRACTOR_H
 #define FEATURE_EXTRACTOR_H
 
+#include "DecodePolicy.h"
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace cbir {
 
+class ImageContext;
+
 /**
  * @class FeatureExtractor
  * @brief Abstract base class for feature extraction methods
@@ -53,6 +57,59 @@ public:
      */
     virtual cv::Mat extractFeatures(const cv::Mat& image) = 0;
 
+    /**
+     * @brief Extract features from a shared per-image context
+     * 
+     * Used when several extractors run on the same image (CompositeExtractor,
+     * DatabaseBuilder). Overrides take colour conversions, gradients and face
+     * boxes from the context so they are computed once per image, and may
+     * use the context's filename for pre-computed lookups. The default calls
+     * extractFeatures() on the decoded image.
+     * 
+     * @param context Decoded image and cached intermediates
+     * @return cv::Mat Feature vector, identical to extractFeatures(image)
+     */
+    virtual cv::Mat extractFromContext(ImageContext& context);
+
+    /**
+     * @brief Extract features from many images into the rows of one matrix
+     * 
+     * Row i of out receives the features of images[i], flattened to CV_32F.
+     * Images that fail (invalid image, empty result or a size other than
+     * getFeatureDimension()) leave a zero row and a 0 in valid. The default
+     * runs extractFeatures() over the images with cv::parallel_for_ when
+     * isThreadSafe(), one after another otherwise. Overrides amortise
+     * per-call setup over the batch (DNNFeature submits the whole batch to
+     * its inference service before waiting).
+     * 
+     * @param images Decoded images
+     * @param out images.size() x getFeatureDimension() CV_32F; reused when
+     *            it already has that shape and type
+     * @param valid Optional per-image flags, 1 where extraction succeeded
+     * @return int Number of images extracted
+     */
+    virtual int extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                             std::vector<uchar>* valid = nullptr);
+
+    /**
+     * @brief True if extractFeatures() may run on several threads at once
+     * 
+     * Extractors that keep per-image state (face counts, caches filled
+     * during extraction) must keep the default, false.
+     */
+    virtual bool isThreadSafe() const { return false; }
+
+    /**
+     * @brief Images per extractBatch() call that pay off
+     * 
+     * DatabaseBuilder hands up to this many decoded images at once to an
+     * extractor that returns more than 1; with 1 (the default) batching
+     * gains nothing over extractFromContext() and images go one by one.
+     * 
+     * @return int Preferred batch size, at least 1
+     */
+    virtual int getPreferredBatchSize() const { return 1; }
+
     /**
      * @brief Get the name/type of this feature extractor
      * 
@@ -80,6 +137,40 @@ public:
         return !image.empty() && (image.channels() == 1 || image.channels() == 3);
     }
 
+    /**
+     * @brief Largest JPEG decode reduction that leaves the features usable
+     * 
+     * Batch builders may decode at 1/2, 1/4 or 1/8 resolution (see
+     * cv::IMREAD_REDUCED_COLOR_2) up to this factor. Features that depend on
+     * absolute pixel positions or gradient scale must keep the default.
+     * 
+     * @return int 1 (full resolution only), 2, 4 or 8
+     */
+    virtual int getMaxDecodeReduction() const { return 1; }
+
+    /**
+     * @brief Smallest longest-side an image may be shrunk to before extraction
+     * 
+     * Lets builders cap decoded images at a maximum side length (see
+     * DecodePolicy). The cap is never set below this. Features that depend
+     * on absolute sizes or fine detail must keep the default.
+     * 
+     * @return int Minimum longest side in pixels, 0 if images must not be resized
+     */
+    virtual int getMinImageSide() const { return 0; }
+
+    /**
+     * @brief Centred region of the image the features are computed from
+     * 
+     * Batch builders decode only the union of their extractors' regions
+     * (DecodePolicy::loadRegion) and pass its placement in the ImageContext.
+     * An extractor that returns a region must locate it through
+     * ImageContext::fullSize() and offset() in extractFromContext().
+     * 
+     * @return DecodeRegion Whole image by default
+     */
+    virtual DecodeRegion getDecodeRegion() const { return DecodeRegion(); }
+
 protected:
     /**
      * @brief Protected constructor - only derived classes can instantiate
@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+// FeatureFactory.h
+// Author: Krushna Sanjay Sharma
+// Description: Query-side factories shared by the query applications. They map
+//              feature and metric names to configured extractors and metrics
+//              matching the parameters buildFeatureDB uses.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FEATURE_FACTORY_H
+#define FEATURE_FACTORY_H
+
+#include "FeatureExtractor.h"
+#include "DistanceMetric.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+
+namespace cbir {
+
+/**
+ * @namespace FeatureFactory
+ * @brief Name-based construction of query extractors and metrics
+ */
+namespace FeatureFactory {
+
+    /**
+     * @brief Create the feature extractor for a feature type
+     *
+     * Must match the feature type used when building the database!
+     *
+     * @param featureType Feature name (baseline, histogram, chromaticity,
+     *                    multihistogram, pyramid, texturecolor, gabor, dnn,
+     *                    productmatcher, faceaware)
+     * @return FeatureExtractor* New extractor (caller owns), nullptr if unknown
+     */
+    FeatureExtractor* createExtractor(const std::string& featureType);
+
+    /**
+     * @brief Create a distance metric by name
+     *
+     * @param metricType Metric name (ssd, histogram, multiregion, pyramid,
+     *                   weighted, gabor, cosine, productmatcher, faceaware)
+     * @return DistanceMetric* New metric (caller owns), nullptr if unknown
+     */
+    DistanceMetric* createMetric(const std::string& metricType);
+
+    /**
+     * @brief Extract query features, looking up filename-keyed embeddings
+     *
+     * DNN, ProductMatcher and FaceAware features depend on pre-computed
+     * embeddings indexed by image filename; every other extractor computes
+     * features from the pixels alone.
+     *
+     * @param extractor Extractor from createExtractor()
+     * @param image Loaded query image (unused by pure DNN lookups)
+     * @param imagePath Path of the query image
+     * @return cv::Mat Query features, empty on failure
+     */
+    cv::Mat extractQueryFeatures(FeatureExtractor* extractor, const cv::Mat& image,
+                                 const std::string& imagePath);
+
+} // namespace FeatureFactory
+
+} // namespace cbir
+
+#endif // FEATURE_FACTORY_H
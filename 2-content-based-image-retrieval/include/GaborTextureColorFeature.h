@@ -23,6 +23,14 @@
 //   - Gabor: Multiple orientations and scales (64 bins)
 //   - Gabor provides richer texture discrimination
 //
+// Performance:
+//   - Filtering is cvcore::GaborBank: kernels are built once per extractor,
+//     all of them are evaluated in one parallel pass, and each response is
+//     binned straight into its slice of the texture histogram
+//   - FFT path (default): the image is transformed once and multiplied by
+//     each kernel's cached spectrum; without it, axis-aligned kernels run
+//     as separable row/column passes
+//
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -30,6 +38,7 @@
 #define GABOR_TEXTURE_COLOR_FEATURE_H
 
 #include "FeatureExtractor.h"
+#include <cvcore/gabor.hpp>
 #include <vector>
 
 namespace cbir {
@@ -91,6 +100,7 @@ public:
     virtual ~GaborTextureColorFeature() = default;
     
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
     virtual std::string getFeatureName() const override;
     virtual int getFeatureDimension() const override;
     
@@ -107,6 +117,15 @@ public:
     int getColorDimension() const { 
         return colorBinsPerChannel_ * colorBinsPerChannel_ * colorBinsPerChannel_; 
     }
+    
+    /**
+     * Filter in the frequency domain (default) or with spatial convolution
+     * 
+     * Both give the same responses up to float rounding (separable kernels
+     * within the bank's 1e-4 truncation error).
+     */
+    void setUseFFT(bool useFFT) { bank_.setUseFFT(useFFT); }
+    bool getUseFFT() const { return bank_.getUseFFT(); }
 
 private:
     int numOrientations_;      ///< Number of Gabor orientations (default: 4)
@@ -115,35 +134,40 @@ private:
     int colorBinsPerChannel_;  ///< Color bins per channel (default: 8)
     bool normalize_;           ///< Normalize flag
     
+    cvcore::GaborBank bank_;   ///< Gabor bank, scale-major
+    
     /**
-     * Create Gabor filter kernel
+     * Kernel parameters for the configured orientations and scales
+     */
+    static std::vector<cvcore::GaborParams> bankParameters(int numOrientations, int numScales);
+    
+    /**
+     * Bin |response| into one Gabor histogram
      * 
-     * @param ksize Kernel size (should be odd)
-     * @param sigma Standard deviation of Gaussian envelope
-     * @param theta Orientation in radians
-     * @param lambda Wavelength (controls frequency/scale)
-     * @param gamma Spatial aspect ratio
-     * @param psi Phase offset
-     * @return Gabor kernel
+     * @param response Filter response (CV_32F)
+     * @param counts binsPerGabor_ counters to update
      */
-    cv::Mat createGaborKernel(int ksize, double sigma, double theta, 
-                             double lambda, double gamma, double psi) const;
+    void accumulateResponse(const cv::Mat& response, double* counts) const;
     
     /**
-     * Apply Gabor filter bank to image
+     * Compute and concatenate Gabor and color histograms
      * 
-     * @param image Grayscale image
-     * @return Vector of filtered images (one per Gabor filter)
+     * @param colorImage BGR image
+     * @param gray Its 8-bit grayscale
+     * @return Combined feature vector [gabor_hists, color_hist]
      */
-    std::vector<cv::Mat> applyGaborFilters(const cv::Mat& image) const;
+    cv::Mat combineFeatures(const cv::Mat& colorImage, const cv::Mat& gray) const;
     
     /**
-     * Compute histogram of Gabor filter responses
+     * Filter with every kernel and histogram the responses
+     * 
+     * Kernels run in parallel and each response is binned as soon as it
+     * is computed, so one response image per thread is alive at a time.
      * 
-     * @param gaborResponses Vector of Gabor-filtered images
+     * @param gray 8-bit grayscale image
      * @return Concatenated histograms from all Gabor responses
      */
-    cv::Mat computeGaborHistogram(const std::vector<cv::Mat>& gaborResponses) const;
+    cv::Mat computeGaborHistogram(const cv::Mat& gray) const;
     
     /**
      * Compute RGB color histogram (same as TextureColorFeature)
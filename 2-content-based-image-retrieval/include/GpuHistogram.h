@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// GpuHistogram.h
+// Author: Krushna Sanjay Sharma
+// Description: Optional OpenCL backend for batched histogram extraction.
+//              A batch of decoded images is uploaded at once; one kernel
+//              converts to grayscale, takes Sobel magnitudes and counts
+//              texture and colour bins in work-group local memory, and only
+//              the per-image counts are read back.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GPU_HISTOGRAM_H
+#define GPU_HISTOGRAM_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace cbir {
+
+class FeatureExtractor;
+
+/**
+ * @namespace GpuHistogram
+ * @brief Device-side counting for HistogramFeature, MultiHistogramFeature
+ *        and TextureColorFeature
+ *
+ * Each image of a batch gets one row of raw counts laid out as
+ * [texture bins, region 0 colour bins, region 1 colour bins, ...], the
+ * layouts of the CPU extractors before normalisation. The bin expressions
+ * are the CPU ones: colour bins come from the same value -> bin table,
+ * chromaticity and texture bins use the same float divisions (built with
+ * correctly rounded division and square root), and grayscale is OpenCV's
+ * fixed-point BGR2GRAY. Counts are integers, so the extractors normalise
+ * them with their CPU code and the features are identical.
+ *
+ * Layouts with chromaticity or texture bins need a device that supports
+ * correctly rounded single precision division; on other devices, or when
+ * OpenCL is missing or fails, count() returns false and the caller uses
+ * the CPU. Calls from several threads are allowed (OpenCV keeps one
+ * command queue per thread).
+ */
+namespace GpuHistogram {
+
+    /// Images per extractBatch() call that keep the device busy
+    const int PREFERRED_BATCH = 16;
+
+    /**
+     * @brief What is counted per image
+     */
+    struct Layout {
+        int textureBins = 0;        ///< Sobel magnitude bins over [0, 255] (0 = none)
+        int colorBins = 8;          ///< Colour bins per channel
+        bool chromaticity = false;  ///< RG chromaticity instead of RGB colour bins
+    };
+
+    /**
+     * @brief Check if an OpenCL device is usable
+     */
+    bool isAvailable();
+
+    /**
+     * @brief Check if the device can count a layout with CPU-identical bins
+     *
+     * False without a device, and for texture or chromaticity layouts on a
+     * device without correctly rounded division.
+     */
+    bool supports(const Layout& layout);
+
+    /**
+     * @brief Counts per image: textureBins + regions × colour bins
+     */
+    int dimension(const Layout& layout, int regionCount);
+
+    /**
+     * @brief Raw counts of a batch
+     *
+     * @param images BGR images (CV_8UC3)
+     * @param layout Bins to count
+     * @param regions Colour regions of each image (all images the same
+     *                number); empty counts each whole image
+     * @param counts Output, images.size() x dimension() CV_32F counts
+     * @return bool False if the batch could not run on the device
+     */
+    bool count(const std::vector<cv::Mat>& images, const Layout& layout,
+               const std::vector<std::vector<cv::Rect>>& regions, cv::Mat& counts);
+
+    /**
+     * @brief BGR versions of the images an extractor accepts
+     *
+     * Grayscale images are converted like the extractors' own
+     * extractFeatures(); rejected images are skipped.
+     *
+     * @param extractor Extractor whose isValidImage() filters the batch
+     * @param images Decoded batch
+     * @param colorImages Output, BGR images
+     * @param positions Output, index in images of each colour image
+     */
+    void collectColorImages(const FeatureExtractor& extractor,
+                            const std::vector<cv::Mat>& images,
+                            std::vector<cv::Mat>& colorImages,
+                            std::vector<int>& positions);
+
+} // namespace GpuHistogram
+
+} // namespace cbir
+
+#endif // GPU_HISTOGRAM_H
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+// GpuScanner.h
+// Author: Krushna Sanjay Sharma
+// Description: Optional OpenCL backend for exhaustive SSD / cosine queries.
+//              The packed feature matrix is kept resident on the device, an
+//              OpenCL kernel scores and selects the best rows of each chunk,
+//              and only (row, distance) candidates are read back.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GPU_SCANNER_H
+#define GPU_SCANNER_H
+
+#include "FeatureDatabase.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/ocl.hpp>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @enum ScanBackend
+ * @brief Where exhaustive queries are scored
+ */
+enum class ScanBackend {
+    Cpu,    ///< Always on the CPU (default)
+    Gpu,    ///< On the OpenCL device whenever the query allows it
+    Auto,   ///< On the device for large databases only
+    Numa    ///< On per-node partitions with pinned threads (NumaScanner)
+};
+
+/**
+ * @brief Parse "cpu", "gpu", "auto" or "numa" (case-insensitive)
+ *
+ * @return bool False for any other name
+ */
+bool parseScanBackend(const std::string& name, ScanBackend& backend);
+
+/**
+ * @brief Lower-case name of a backend
+ */
+std::string scanBackendName(ScanBackend backend);
+
+/**
+ * @class GpuScanner
+ * @brief Device-resident copy of a FeatureDatabase with top-K scans
+ *
+ * The matrix is uploaded on the first search and again whenever the
+ * database's version() changes. Each work item of the kernel scores one
+ * chunk of rows against one query and keeps its k best in private memory,
+ * so the host reads back chunks x k candidates per query instead of a
+ * distance per row; their distances are single precision, so callers
+ * rescore the final k on the CPU.
+ *
+ * Only SSD and cosine distance over float32 or float16 storage are
+ * supported; search() returns false for anything else, on a missing
+ * device or on a device error, and the caller falls back to the CPU. One
+ * instance may be shared by several ImageRetrieval engines over the same
+ * database; searches are serialised.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class GpuScanner {
+public:
+    /// Largest k kept on the device (per-work-item buffer size)
+    static const int MAX_K = 64;
+
+    /**
+     * @enum Metric
+     * @brief Distances the kernel implements
+     */
+    enum class Metric {
+        SSD,      ///< Sum of squared differences (SSDMetric)
+        Cosine    ///< 1 - cos(angle) (CosineDistance)
+    };
+
+    /**
+     * @brief Check if an OpenCL device is usable
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Kernel metric for a DistanceMetric::getMetricName()
+     *
+     * @return bool False if the metric has no device implementation
+     */
+    static bool metricFor(const std::string& metricName, Metric& metric);
+
+    GpuScanner() = default;
+    GpuScanner(const GpuScanner&) = delete;
+    GpuScanner& operator=(const GpuScanner&) = delete;
+
+    /**
+     * @brief Best k rows of the database for each query row
+     *
+     * @param database Database to scan (uploaded if not resident)
+     * @param queries Q x dimension CV_32F queries
+     * @param metric Distance to compute
+     * @param k Rows to keep per query, 1..MAX_K
+     * @param best Output per query: (distance, row) ascending, at most k
+     * @return bool False if the scan could not run on the device
+     */
+    bool search(const FeatureDatabase& database, const cv::Mat& queries, Metric metric, int k,
+                std::vector<std::vector<std::pair<float, int>>>& best);
+
+    /**
+     * @brief Bytes of feature data held on the device
+     */
+    size_t deviceBytes() const;
+
+private:
+    const FeatureDatabase* source_ = nullptr;   ///< Database uploaded (not owned)
+    uint64_t sourceVersion_ = 0;                ///< Its version() at upload
+    cv::UMat rows_;                             ///< N x D float32 features
+    cv::UMat rowNorms_;                         ///< 1 x N row norms
+    bool kernelFailed_ = false;                 ///< Kernel did not build; never retried
+    mutable std::mutex mutex_;
+
+    /// Upload the database unless it is already resident (lock held)
+    bool upload(const FeatureDatabase& database);
+};
+
+} // namespace cbir
+
+#endif // GPU_SCANNER_H
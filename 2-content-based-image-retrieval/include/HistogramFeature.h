@@ -10,6 +10,8 @@
 #define HISTOGRAM_FEATURE_H
 
 #include "FeatureExtractor.h"
+#include "GpuHistogram.h"
+#include <vector>
 
 namespace cbir {
 
@@ -56,8 +58,38 @@ public:
     virtual ~HistogramFeature() = default;
     
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
     virtual std::string getFeatureName() const override;
     virtual int getFeatureDimension() const override;
+    virtual int getMaxDecodeReduction() const override;
+    virtual int getMinImageSide() const override;
+    virtual bool isThreadSafe() const override { return true; }
+    
+    /**
+     * @brief Extract a batch, counted on the OpenCL device with setUseGpu()
+     * 
+     * Falls back to the CPU extraction of the base class when the device
+     * path is off or the batch fails on the device.
+     */
+    virtual int extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                             std::vector<uchar>* valid = nullptr) override;
+    
+    /**
+     * @brief GpuHistogram::PREFERRED_BATCH with the device path on, otherwise 1
+     */
+    virtual int getPreferredBatchSize() const override {
+        return useGpu_ ? GpuHistogram::PREFERRED_BATCH : 1;
+    }
+    
+    /**
+     * @brief Count batches on the OpenCL device (GpuHistogram)
+     * 
+     * @param enabled Request the device path
+     * @return bool True if the device supports this histogram type and
+     *         batches will be counted there
+     */
+    bool setUseGpu(bool enabled);
+    bool usesGpu() const { return useGpu_; }
     
     void setHistogramType(HistogramType type);
     void setBinsPerChannel(int bins);
@@ -66,10 +98,28 @@ public:
     HistogramType getHistogramType() const { return type_; }
     int getBinsPerChannel() const { return binsPerChannel_; }
     
+    /**
+     * @brief Flattened histogram bin of every pixel
+     * 
+     * Uses the same binning and bin order as extractFeatures(), so counting
+     * the indices of any set of pixels gives that set's raw histogram.
+     * Used by MultiHistogramFeature to build an IntegralHistogram.
+     * 
+     * @param colorImage BGR image (CV_8UC3)
+     * @param indices Output, rows × cols bin indices in row-major order
+     */
+    void computeBinIndices(const cv::Mat& colorImage, std::vector<int>& indices) const;
+    
 private:
     HistogramType type_;
     int binsPerChannel_;
     bool normalize_;
+    bool useGpu_;
+    
+    /**
+     * @brief Device counting layout of this histogram
+     */
+    GpuHistogram::Layout gpuLayout() const;
     
     /**
      * @brief Compute RGB histogram
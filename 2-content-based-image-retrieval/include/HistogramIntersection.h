@@ -42,6 +42,40 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
     
+    /**
+     * @brief Intersection distance from a query to every row of a matrix
+     * 
+     * The query is normalized once; rows are normalized on the fly only
+     * when their sum is off by more than compute()'s tolerance.
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
+    /**
+     * @brief Intersection distance from a block of queries to every row
+     * 
+     * Cache-blocked min-sum: queries are taken four at a time and each row
+     * is compared with all four while it is in registers, and the matrix
+     * (one scan tile) stays in cache across query groups.
+     */
+    virtual bool computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
+    /**
+     * @brief Intersection distance with lower-bound pruning
+     * 
+     * Since 1 - Σ min(q, h) = Σ (q - min(q, h)) for a normalized query, the
+     * bins seen so far bound the distance from below; the row is abandoned
+     * once that bound exceeds cutoff (see
+     * DistanceKernels::intersectionBounded()). Completed rows give the same
+     * value as computeBatch(), including its query normalization.
+     * Non-CV_32F input falls back to compute().
+     */
+    virtual double computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                     double cutoff) override;
+    
+    virtual bool supportsCutoff() const override { return true; }
+    
     virtual std::string getMetricName() const override;
     
 private:
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// HistogramKernels.h
+// Author: Krushna Sanjay Sharma
+// Description: Colour histogram counting specialised at compile time for the
+//              bin counts in use (8, 16 and 32 per channel). RGB bins are a
+//              shift instead of a division, rows are binned in a separate
+//              pass the compiler can vectorise, and counts go to interleaved
+//              sub-histograms per thread that are merged at the end.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HISTOGRAM_KERNELS_H
+#define HISTOGRAM_KERNELS_H
+
+#include <opencv2/opencv.hpp>
+
+namespace cbir {
+
+/**
+ * @namespace HistogramKernels
+ * @brief Fast paths for HistogramFeature
+ *
+ * Every function returns false when it has no specialisation for the
+ * requested bin count (or the image is not CV_8UC3), and the caller keeps
+ * its generic loop. Otherwise the results are bit-identical to the generic
+ * code: RGB uses v >> (8 - log2 bins), which equals the generic
+ * v / (256 / bins) for power-of-two bins, and chromaticity keeps the same
+ * float expression with the bin count as a constant. Counts are integers,
+ * so splitting the image into stripes does not change them.
+ *
+ * Bin order matches HistogramFeature::flattenHistogram():
+ *   RGB:           (binR × bins + binG) × bins + binB
+ *   Chromaticity:  binR × bins + binG
+ */
+namespace HistogramKernels {
+
+    /**
+     * @brief True if bins has a specialised kernel (8, 16 or 32)
+     */
+    bool isSpecialized(int bins);
+
+    /**
+     * @brief Raw RGB histogram, bins³ counts
+     *
+     * Large images are split into row stripes counted in parallel.
+     *
+     * @param image BGR image (CV_8UC3)
+     * @param bins Bins per channel
+     * @param counts Output, 1 × bins³ CV_32F pixel counts
+     * @return bool False if there is no specialisation (counts untouched)
+     */
+    bool countRGB(const cv::Mat& image, int bins, cv::Mat& counts);
+
+    /**
+     * @brief Raw RG chromaticity histogram, bins² counts
+     *
+     * @param image BGR image (CV_8UC3)
+     * @param bins Bins per channel
+     * @param counts Output, 1 × bins² CV_32F pixel counts
+     * @return bool False if there is no specialisation (counts untouched)
+     */
+    bool countChromaticity(const cv::Mat& image, int bins, cv::Mat& counts);
+
+    /**
+     * @brief Flattened bin index of every pixel, row-major
+     *
+     * @param image BGR image (CV_8UC3)
+     * @param bins Bins per channel
+     * @param chromaticity RG chromaticity bins instead of RGB
+     * @param indices Output, rows × cols entries
+     * @return bool False if there is no specialisation (indices untouched)
+     */
+    bool binIndices(const cv::Mat& image, int bins, bool chromaticity, int* indices);
+
+} // namespace HistogramKernels
+
+} // namespace cbir
+
+#endif // HISTOGRAM_KERNELS_H
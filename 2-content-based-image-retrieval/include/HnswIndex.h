@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+// HnswIndex.h
+// Author: Krushna Sanjay Sharma
+// Description: Hierarchical Navigable Small World graph index for L2 and
+//              cosine search over a float32 FeatureDatabase. Vectors are read
+//              in place from the database matrix; the index stores only the
+//              graph.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HNSW_INDEX_H
+#define HNSW_INDEX_H
+
+#include "AnnIndex.h"
+#include <algorithm>
+
+namespace cbir {
+
+/**
+ * @class HnswIndex
+ * @brief HNSW graph (Malkov & Yashunin) over the rows of a FeatureDatabase
+ *
+ * Every row is a node on layer 0 with up to 2M neighbours; an exponentially
+ * shrinking subset of nodes also lives on upper layers with up to M
+ * neighbours each. A search descends greedily from the top layer and runs a
+ * best-first beam search of width efSearch on layer 0. Neighbour lists are
+ * chosen with the paper's diversity heuristic.
+ *
+ * Construction inserts nodes in parallel (cv::parallel_for_) with striped
+ * locks on the neighbour lists, as in hnswlib. Memory is roughly
+ * N x (2M + 1) x 4 bytes for layer 0 plus N x 4 bytes of norms for cosine.
+ *
+ * The database must use FeatureStorage::Float32, since the index reads
+ * vectors directly from FeatureDatabase::matrix().
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class HnswIndex : public AnnIndex {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param metric Distance to index for
+     * @param m Neighbours per node on upper layers (2m on layer 0)
+     * @param efConstruction Beam width used while inserting
+     * @param efSearch Default beam width used by search()
+     */
+    explicit HnswIndex(AnnMetric metric = AnnMetric::Cosine, int m = 16,
+                       int efConstruction = 200, int efSearch = 64);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~HnswIndex() = default;
+
+    virtual bool build(const FeatureDatabase& database) override;
+    virtual bool attach(const FeatureDatabase& database) override;
+    virtual bool search(const cv::Mat& query, int k,
+                        std::vector<AnnResult>& results) const override;
+    virtual bool save(const std::string& filename) const override;
+    virtual bool load(const std::string& filename) override;
+    virtual std::string getIndexName() const override;
+    virtual size_t memoryBytes() const override;
+
+    /**
+     * @brief Set the search beam width (higher = better recall, slower)
+     *
+     * @param efSearch Beam width; search() uses max(efSearch, k)
+     */
+    void setEfSearch(int efSearch) { efSearch_ = std::max(1, efSearch); }
+
+private:
+    /// (distance, node) pair used inside graph searches
+    using Candidate = std::pair<float, uint32_t>;
+
+    /// Locks used while building; nullptr during queries
+    struct BuildLocks;
+
+    int m_;                             ///< Max neighbours on layers >= 1
+    int maxM0_;                         ///< Max neighbours on layer 0
+    int efConstruction_;                ///< Insertion beam width
+    int efSearch_;                      ///< Query beam width
+    int maxLevel_;                      ///< Top layer
+    uint32_t entryPoint_;               ///< Node on the top layer
+
+    std::vector<uint8_t> levels_;       ///< Top layer of each node
+    std::vector<uint32_t> level0_;      ///< count_ x (maxM0_ + 1): [n, ids...]
+    std::vector<uint64_t> upperOffsets_;///< Start of each node's upper lists
+    std::vector<uint32_t> upperLinks_;  ///< Per node, levels x (m_ + 1)
+    std::vector<float> norms_;          ///< Row norms (cosine only)
+    const float* vectors_;              ///< Database matrix (not owned)
+
+    /// Neighbour list of a node on a layer: [count, id0, id1, ...]
+    uint32_t* links(uint32_t node, int level);
+    const uint32_t* links(uint32_t node, int level) const;
+
+    /// Copy a neighbour list (under its stripe lock while building)
+    void copyLinks(uint32_t node, int level, std::vector<uint32_t>& out,
+                   BuildLocks* locks) const;
+
+    /// Distance from a query (with norm) to a node
+    float distanceTo(const float* query, double queryNorm, uint32_t node) const;
+
+    /// Distance between two nodes
+    float nodeDistance(uint32_t a, uint32_t b) const;
+
+    /// Greedy walk on one layer towards the query
+    void greedyStep(const float* query, double queryNorm, int level,
+                    uint32_t& node, float& distance, BuildLocks* locks) const;
+
+    /// Best-first beam search on one layer; result ascending by distance
+    std::vector<Candidate> searchLayer(const float* query, double queryNorm,
+                                       uint32_t entry, float entryDistance,
+                                       int ef, int level, BuildLocks* locks) const;
+
+    /// Diversity heuristic: keep candidates closer to the base than to any kept one
+    std::vector<Candidate> selectNeighbors(const std::vector<Candidate>& ascending,
+                                           int maxCount) const;
+
+    /// Insert one node (its level is already assigned)
+    void insert(uint32_t node, BuildLocks& locks);
+
+    /// Add a back-link, pruning the neighbour's list if it is full
+    void connect(uint32_t node, uint32_t neighbor, float distance, int level,
+                 BuildLocks& locks);
+
+    /// Allocate link storage from levels_
+    void allocateLinks();
+
+    /// Set vectors_ / norms_ from a database
+    bool bindDatabase(const FeatureDatabase& database);
+};
+
+} // namespace cbir
+
+#endif // HNSW_INDEX_H
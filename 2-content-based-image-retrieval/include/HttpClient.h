@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// HttpClient.h
+// Author: Krushna Sanjay Sharma
+// Description: Minimal blocking HTTP/1.1 client with a hard deadline, used
+//              by the shard coordinator to call other cbirServer instances
+//              and by ObjectStore to read object storage. Uses Winsock on
+//              Windows and BSD sockets elsewhere.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include "HttpServer.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cbir {
+
+/// Request header fields, in the order they are sent
+using HttpHeaders = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @struct HttpEndpoint
+ * @brief Host (IPv4 address or name) and port of a server
+ */
+struct HttpEndpoint {
+    std::string host = "127.0.0.1";
+    int port = 0;
+
+    /**
+     * @brief Parse "host:port" (or ":port" / "port" for 127.0.0.1)
+     *
+     * @return bool False if the port is missing or out of range
+     */
+    static bool parse(const std::string& text, HttpEndpoint& endpoint);
+
+    std::string toString() const { return host + ":" + std::to_string(port); }
+};
+
+/**
+ * @class HttpClient
+ * @brief One request per connection, bounded by a deadline
+ *
+ * connect(), send() and every recv() wait at most until the deadline, so a
+ * stalled server costs the caller timeoutMs and nothing more. Responses are
+ * read until the server closes the connection (cbirServer always sends
+ * "Connection: close") or Content-Length bytes have arrived.
+ *
+ * Usage example:
+ * @code
+ *   HttpEndpoint shard;
+ *   HttpEndpoint::parse("10.0.0.7:8765", shard);
+ *   HttpResponse response;
+ *   std::string error;
+ *   if (HttpClient::request(shard, "POST", "/query", body, 500, response, &error)) {
+ *       // response.status, response.body
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class HttpClient {
+public:
+    /**
+     * @brief Send one request and read the response
+     *
+     * @param endpoint Server address
+     * @param method "GET" or "POST"
+     * @param path Request target, e.g. "/query"
+     * @param body Request body (sent as application/json when non-empty)
+     * @param timeoutMs Deadline for the whole exchange
+     * @param response Receives the status and body
+     * @param error Optional reason on failure ("timeout", "connection refused", ...)
+     * @return bool True if a complete response was received
+     */
+    static bool request(const HttpEndpoint& endpoint, const std::string& method,
+                        const std::string& path, const std::string& body, int timeoutMs,
+                        HttpResponse& response, std::string* error = nullptr);
+
+    /**
+     * @brief Send one request with caller-supplied header fields
+     *
+     * A "Host" field in headers replaces the default one (host:port). Host
+     * names are resolved before the deadline starts counting.
+     *
+     * @param headers Extra header fields (Content-Length and Connection
+     *                are always added)
+     * @param responseHeaders Optional: the response header block, lower-cased
+     *                        ("content-range: bytes 0-99/1234\r\n...")
+     */
+    static bool request(const HttpEndpoint& endpoint, const std::string& method,
+                        const std::string& path, const HttpHeaders& headers,
+                        const std::string& body, int timeoutMs, HttpResponse& response,
+                        std::string* error = nullptr, std::string* responseHeaders = nullptr);
+};
+
+} // namespace cbir
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+// HttpServer.h
+// Author: Krushna Sanjay Sharma
+// Description: Small blocking HTTP/1.1 server for local clients. An accept
+//              thread queues connections for a fixed pool of worker threads,
+//              each of which reads one request, calls the handler and closes
+//              the connection.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct HttpRequest
+ * @brief Parsed request line, headers and body
+ */
+struct HttpRequest {
+    std::string method;                          ///< GET, POST, ...
+    std::string path;                            ///< Path without query string
+    std::string query;                           ///< Text after '?', if any
+    std::map<std::string, std::string> headers;  ///< Lower-cased header names
+    std::string body;                            ///< Content-Length bytes
+    int64 acceptedTicks = 0;                     ///< cv::getTickCount() at accept
+    int worker = 0;                              ///< Index of the serving worker
+};
+
+/**
+ * @struct HttpResponse
+ * @brief Status, content type and body sent back to the client
+ */
+struct HttpResponse {
+    int status = 200;                            ///< HTTP status code
+    std::string contentType = "application/json";
+    std::string body;
+};
+
+/**
+ * @class HttpServer
+ * @brief Thread-pooled HTTP server calling one request handler
+ *
+ * The handler runs concurrently on up to getThreadCount() workers and must
+ * be thread-safe. Each connection carries a single request (the response
+ * is sent with "Connection: close"). Connections are refused with 503 when
+ * more than MAX_PENDING are waiting for a worker.
+ *
+ * Usage example:
+ * @code
+ *   HttpServer server;
+ *   server.setHandler([](const HttpRequest& request) {
+ *       HttpResponse response;
+ *       response.body = "{\"path\":\"" + request.path + "\"}";
+ *       return response;
+ *   });
+ *   if (server.start("127.0.0.1", 8765, 4)) {
+ *       server.wait();
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class HttpServer {
+public:
+    /// Request callback; invoked on a worker thread
+    using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+    HttpServer();
+
+    /**
+     * @brief Destructor (stops the server)
+     */
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    /**
+     * @brief Set the request handler (before start())
+     */
+    void setHandler(Handler handler);
+
+    /**
+     * @brief Bind, listen and start the accept thread and workers
+     *
+     * @param host IPv4 address to bind (e.g. "127.0.0.1")
+     * @param port TCP port (0 picks a free port, see getPort())
+     * @param threads Worker threads (at least 1)
+     * @return bool False if the socket could not be bound
+     */
+    bool start(const std::string& host, int port, int threads);
+
+    /**
+     * @brief Block until stop() is called from another thread
+     */
+    void wait();
+
+    /**
+     * @brief Stop accepting, finish queued requests and join all threads
+     */
+    void stop();
+
+    int getPort() const { return port_; }                 ///< Bound port
+    int getThreadCount() const { return static_cast<int>(workers_.size()); }
+
+    /// Largest accepted request body (feature vectors included)
+    static const size_t MAX_BODY_BYTES = size_t(16) << 20;
+
+    /// Connections waiting for a worker before new ones get 503
+    static const size_t MAX_PENDING = 256;
+
+private:
+    /// Accepted connection waiting for a worker
+    struct Connection {
+        std::intptr_t socket;
+        int64 acceptedTicks;
+    };
+
+    Handler handler_;
+    std::intptr_t listenSocket_;
+    int port_;
+    std::atomic<bool> running_;
+
+    std::thread acceptThread_;
+    std::vector<std::thread> workers_;
+    std::deque<Connection> pending_;
+    std::mutex mutex_;
+    std::condition_variable pendingReady_;
+    std::condition_variable stopped_;
+
+    void acceptLoop();
+    void workerLoop(int worker);
+
+    /**
+     * @brief Read one request from a connection
+     *
+     * @return int 0 on success, otherwise the HTTP status to reply with
+     *         (400, 413), or -1 if the client went away
+     */
+    int readRequest(std::intptr_t socket, HttpRequest& request) const;
+
+    void sendResponse(std::intptr_t socket, const HttpResponse& response) const;
+};
+
+/**
+ * @brief Reason phrase for a status code ("OK", "Not Found", ...)
+ */
+const char* httpStatusText(int status);
+
+} // namespace cbir
+
+#endif // HTTP_SERVER_H
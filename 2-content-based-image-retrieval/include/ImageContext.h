@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+// ImageContext.h
+// Author: Krushna Sanjay Sharma
+// Description: Per-image cache of decoded pixels and derived images shared by
+//              several feature extractors. Each intermediate (BGR, grayscale,
+//              HSV, Sobel magnitude, face boxes) is computed on first use and
+//              reused by every later extractor that asks for it.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef IMAGE_CONTEXT_H
+#define IMAGE_CONTEXT_H
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @class ImageContext
+ * @brief Lazily computed intermediates of one image
+ *
+ * Extractors read what they need through FeatureExtractor::extractFromContext()
+ * instead of converting the image themselves, so extracting several feature
+ * types from one image converts colour spaces and computes gradients once.
+ *
+ * The returned references stay valid for the lifetime of the context. A
+ * context is used by one thread at a time.
+ *
+ * When every extractor of a batch build reads only a centred region
+ * (FeatureExtractor::getDecodeRegion), the builder decodes just that region
+ * and image() is a crop: fullSize() is the size of the whole decoded image
+ * and offset() the crop's position in it. Extractors declaring a region
+ * place it with these; all others always see the whole image.
+ *
+ * Usage example:
+ * @code
+ *   ImageContext context(cv::imread(path), "pic.0001.jpg");
+ *   cv::Mat texture = textureColor.extractFromContext(context);  // computes gray
+ *   cv::Mat gabor = gaborColor.extractFromContext(context);      // reuses gray
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class ImageContext {
+public:
+    /// Face detector run on the equalized grayscale image
+    using FaceDetector = std::function<std::vector<cv::Rect>(const cv::Mat& equalizedGray)>;
+
+    /**
+     * @brief Constructor
+     *
+     * @param image Decoded image (grayscale or BGR)
+     * @param filename Image filename without directory (for DNN lookups)
+     * @param fullSize Size of the whole image if image is a crop of it
+     *                 (empty = image is the whole image)
+     * @param offset Position of the crop in the whole image
+     */
+    ImageContext(const cv::Mat& image, const std::string& filename,
+                 const cv::Size& fullSize = cv::Size(), const cv::Point& offset = cv::Point());
+
+    const cv::Mat& image() const { return image_; }            ///< Image as decoded
+    const std::string& filename() const { return filename_; }  ///< Filename without directory
+    const cv::Size& fullSize() const { return fullSize_; }     ///< Size of the whole image
+    const cv::Point& offset() const { return offset_; }        ///< Position of image() in it
+
+    /**
+     * @brief 3-channel BGR image (the decoded image itself when already colour)
+     */
+    const cv::Mat& color();
+
+    /**
+     * @brief 8-bit grayscale image
+     */
+    const cv::Mat& gray();
+
+    /**
+     * @brief Grayscale image as CV_32F
+     */
+    const cv::Mat& grayFloat();
+
+    /**
+     * @brief Histogram-equalized grayscale image (face detection input)
+     */
+    const cv::Mat& equalizedGray();
+
+    /**
+     * @brief 8-bit HSV image
+     */
+    const cv::Mat& hsv();
+
+    /**
+     * @brief Sobel gradient magnitude of grayFloat() (3x3 kernels, CV_32F)
+     */
+    const cv::Mat& gradientMagnitude();
+
+    /**
+     * @brief Face boxes, detected by the first caller only
+     *
+     * All users of one context must configure their detectors alike; the
+     * boxes from the first call are returned to every later caller.
+     *
+     * @param detector Detector run on equalizedGray() if no boxes are cached
+     * @return const std::vector<cv::Rect>& Detected faces
+     */
+    const std::vector<cv::Rect>& faces(const FaceDetector& detector);
+
+private:
+    cv::Mat image_;                  ///< Decoded image
+    std::string filename_;           ///< Filename without directory
+    cv::Size fullSize_;              ///< Whole image size (image_ may be a crop)
+    cv::Point offset_;               ///< Position of image_ in the whole image
+    cv::Mat color_;                  ///< BGR image
+    cv::Mat gray_;                   ///< 8-bit grayscale
+    cv::Mat grayFloat_;              ///< CV_32F grayscale
+    cv::Mat equalizedGray_;          ///< Equalized grayscale
+    cv::Mat hsv_;                    ///< HSV image
+    cv::Mat gradientMagnitude_;      ///< Sobel magnitude
+    std::vector<cv::Rect> faces_;    ///< Detected faces
+    bool facesDetected_;             ///< faces_ is valid
+};
+
+} // namespace cbir
+
+#endif // IMAGE_CONTEXT_H
@@ -14,12 +14,29 @@
 #include "FeatureExtractor.h"
 #include "DistanceMetric.h"
 #include "FeatureDatabase.h"
+#include "LiveDatabase.h"
+#include "AnnIndex.h"
+#include "GpuScanner.h"
+#include "NumaScanner.h"
+#include "QueryCache.h"
 #include "Utils.h"
+#include <memory>
 #include <vector>
 #include <string>
+#include <utility>
 
 namespace cbir {
 
+/**
+ * @struct CascadeTiming
+ * @brief Per-stage cost of a two-stage (prefilter + rerank) query.
+ */
+struct CascadeTiming {
+    double prefilterMs = 0.0;   ///< Stage 1: candidate selection in the prefilter database.
+    double rerankMs = 0.0;      ///< Stage 2: configured metric on the candidates.
+    int candidates = 0;         ///< Candidates reranked (found in both databases).
+};
+
 /**
  * @class ImageRetrieval
  * @brief Main content-based image retrieval engine.
@@ -48,6 +65,20 @@ namespace cbir {
  *   }
  * @endcode
  * 
+ * For expensive metrics, a second ImageRetrieval over a cheap feature
+ * database (baseline, a coarse histogram, or an ANN index on embeddings)
+ * can be set as prefilter; queries then rerank only its top candidates:
+ * @code
+ *   ImageRetrieval coarse;   // histogram database + HistogramIntersection
+ *   retrieval.setPrefilter(&coarse, 200);
+ *   CascadeTiming timing;
+ *   results = retrieval.queryCascade(coarseFeatures, features, 5, &timing);
+ * @endcode
+ * 
+ * Browse-style workloads that query the same images again can attach a
+ * QueryCache (see setQueryCache()); query() then skips extraction for
+ * known images and the scan for repeated (image, topN) pairs.
+ * 
  * @author Krushna Sanjay Sharma
  */
 class ImageRetrieval {
@@ -66,7 +97,8 @@ public:
      * @brief Query database with an image.
      * 
      * Extracts features from the query image, compares against all images
-     * in the database, and returns the top N most similar matches.
+     * in the database, and returns the top N most similar matches. With a
+     * query cache, repeated queries are answered from it.
      * 
      * @param queryImage Query image.
      * @param topN Number of top matches to return.
@@ -78,6 +110,7 @@ public:
      * @brief Query database with pre-computed features.
      * 
      * Useful when features are already extracted or loaded from file.
+     * Uses the ANN index if one is set (see setAnnIndex()).
      * 
      * @param queryFeatures Pre-computed feature vector.
      * @param topN Number of top matches to return.
@@ -86,6 +119,98 @@ public:
     std::vector<ImageMatch> queryWithFeatures(const cv::Mat& queryFeatures, 
                                               int topN);
 
+    /**
+     * @brief Query database exhaustively, ignoring any ANN index.
+     * 
+     * @param queryFeatures Pre-computed feature vector.
+     * @param topN Number of top matches to return.
+     * @return std::vector<ImageMatch> Exact top N matches (ascending distance).
+     */
+    std::vector<ImageMatch> queryExact(const cv::Mat& queryFeatures, int topN);
+
+    /**
+     * @brief Query database with many feature vectors in one pass.
+     * 
+     * Each block of database rows is scored against every query while it
+     * is still in cache, so the database is streamed from memory once per
+     * batch instead of once per query. Metrics with a block kernel (SSD,
+     * cosine, histogram intersection) score a group of queries against
+     * the block at once. Always exhaustive.
+     * 
+     * @param queries One query feature vector per row (any depth).
+     * @param topN Number of top matches to return per query.
+     * @return Top N matches per query row (ascending distance); all lists
+     *         are empty on error.
+     */
+    std::vector<std::vector<ImageMatch>> queryBatch(const cv::Mat& queries, int topN);
+
+    /**
+     * @brief Merge top-N lists from disjoint database shards.
+     * 
+     * Used by the shard coordinator (ShardCoordinator) to combine the
+     * answers of shard servers; the result equals a top-N query over the
+     * union of the shards.
+     * 
+     * @param lists Top matches of each shard (any order).
+     * @param topN Number of matches to keep.
+     * @return std::vector<ImageMatch> Best topN matches (ascending distance).
+     */
+    static std::vector<ImageMatch> mergeMatches(
+        const std::vector<std::vector<ImageMatch>>& lists, int topN);
+
+    /**
+     * @brief Query one snapshot of a LiveDatabase.
+     * 
+     * Scans every segment of the snapshot exhaustively (superseded rows are
+     * skipped) and merges the per-segment top N. The database set with
+     * setFeatureDatabase() and any ANN index are not used, so only a
+     * distance metric is required. The caller keeps the snapshot alive, so
+     * concurrent publishes do not affect a running query. While
+     * LiveDatabase::loadAsync() is streaming, only the chunks loaded so far
+     * are searched and the result is flagged as partial.
+     * 
+     * @param snapshot Snapshot from LiveDatabase::snapshot().
+     * @param queryFeatures Pre-computed feature vector.
+     * @param topN Number of top matches to return.
+     * @param partial Output: true if the snapshot was incomplete (may be nullptr).
+     * @return std::vector<ImageMatch> Top N matches (ascending distance).
+     */
+    std::vector<ImageMatch> querySnapshot(const DatabaseSnapshot& snapshot,
+                                          const cv::Mat& queryFeatures, int topN,
+                                          bool* partial = nullptr);
+
+    /**
+     * @brief Two-stage query: prefilter candidates, rerank with this metric.
+     * 
+     * Stage 1 asks the prefilter (see setPrefilter()) for its best
+     * candidates, using its own metric and ANN index if any. Stage 2 maps
+     * them to rows of this database by image name and scores only those
+     * rows with the configured metric. Images missing from this database
+     * are skipped. Results are exact for the candidate set; images the
+     * prefilter ranks below the cut are never seen.
+     * 
+     * @param prefilterFeatures Query features for the prefilter database.
+     * @param queryFeatures Query features for this database.
+     * @param topN Number of top matches to return.
+     * @param timing Output per-stage timing (optional).
+     * @return std::vector<ImageMatch> Top N reranked matches (ascending distance).
+     */
+    std::vector<ImageMatch> queryCascade(const cv::Mat& prefilterFeatures,
+                                         const cv::Mat& queryFeatures, int topN,
+                                         CascadeTiming* timing = nullptr);
+
+    /**
+     * @brief Measure recall@k of the ANN index against exhaustive search.
+     * 
+     * @param k Neighbours compared per query.
+     * @param samples Database rows used as queries.
+     * @param annMs Output mean index search time in ms (optional).
+     * @param exactMs Output mean exhaustive search time in ms (optional).
+     * @return double Mean recall@k in [0, 1], negative on error.
+     */
+    double measureRecall(int k, int samples, double* annMs = nullptr,
+                         double* exactMs = nullptr);
+
     /**
      * @brief Set the feature database to query against.
      * 
@@ -93,6 +218,82 @@ public:
      */
     void setFeatureDatabase(FeatureDatabase* database);
 
+    /**
+     * @brief Set an approximate nearest-neighbour index for queries.
+     * 
+     * The index must be built for the configured metric and attached to
+     * the same database.
+     * 
+     * @param index Pointer to index (not owned), nullptr for exhaustive search.
+     */
+    void setAnnIndex(AnnIndex* index);
+
+    /**
+     * @brief Enable two-stage retrieval through a cheaper first stage.
+     * 
+     * query() then extracts features for both stages and calls
+     * queryCascade(); queryWithFeatures() and queryExact() are unchanged.
+     * 
+     * @param prefilter Configured retrieval over a cheap feature database
+     *                  with the same image names (not owned), nullptr to disable.
+     * @param candidates Candidates passed to the rerank stage (at least topN are used).
+     */
+    void setPrefilter(ImageRetrieval* prefilter, int candidates);
+
+    /**
+     * @brief Cache results and features of query images.
+     * 
+     * Results are keyed by image content, extractor, metric, index,
+     * prefilter, topN and the database version, so database mutations
+     * are never served stale. Changing the extractor drops cached
+     * features; changing anything else only changes the result keys.
+     * The cache may be shared by engines over the same database.
+     * 
+     * @param cache Cache to use, nullptr to disable.
+     */
+    void setQueryCache(std::shared_ptr<QueryCache> cache);
+
+    /**
+     * @brief Choose where exhaustive queries are scored.
+     * 
+     * With Gpu or Auto, queryExact() and queryBatch() run SSD and cosine
+     * scans on the OpenCL device (Auto only for databases of at least
+     * AUTO_GPU_MIN_ROWS images) and rescore the winners on the CPU, so
+     * distances match a CPU scan. Other metrics, top N above
+     * GpuScanner::MAX_K, a missing device or a device error fall back to
+     * the CPU.
+     * 
+     * With Numa, both run on a NumaScanner: node-local partitions of the
+     * matrix scanned by threads pinned to each node, for every metric.
+     * 
+     * @param backend Cpu, Gpu, Auto or Numa.
+     * @param scanner Device copy to use, shared by the engines of one
+     *                database (a new one is created if nullptr).
+     */
+    void setBackend(ScanBackend backend, std::shared_ptr<GpuScanner> scanner = nullptr);
+
+    /**
+     * @brief Scan on NUMA partitions shared by the engines of one database.
+     * 
+     * @param backend Must be ScanBackend::Numa.
+     * @param scanner Partitions and thread pool to use (a new one is
+     *                created if nullptr).
+     */
+    void setBackend(ScanBackend backend, std::shared_ptr<NumaScanner> scanner);
+
+    /**
+     * @brief The configured scan backend.
+     */
+    ScanBackend getBackend() const { return backend_; }
+
+    /// Database size from which ScanBackend::Auto scans on the device.
+    static const size_t AUTO_GPU_MIN_ROWS = 100000;
+
+    /**
+     * @brief The attached query cache (nullptr if none).
+     */
+    const std::shared_ptr<QueryCache>& getQueryCache() const { return queryCache_; }
+
     /**
      * @brief Set the feature extractor to use.
      * 
@@ -123,8 +324,15 @@ public:
 
 private:
     FeatureDatabase* database_;              ///< Pointer to feature database.
+    AnnIndex* annIndex_;                     ///< Optional ANN index (not owned).
+    ImageRetrieval* prefilter_;              ///< Optional first stage (not owned).
+    int prefilterCandidates_;                ///< Candidates kept by the first stage.
     FeatureExtractorPtr featureExtractor_;   ///< Feature extraction method.
     DistanceMetricPtr distanceMetric_;       ///< Distance computation method.
+    std::shared_ptr<QueryCache> queryCache_; ///< Optional result / feature cache.
+    ScanBackend backend_;                    ///< Where exhaustive scans run.
+    std::shared_ptr<GpuScanner> gpuScanner_; ///< Device copy (null for Cpu).
+    std::shared_ptr<NumaScanner> numaScanner_; ///< Node partitions (Numa only).
 
     /**
      * @brief Validate that all required components are set.
@@ -133,6 +341,20 @@ private:
      */
     bool isReady() const;
 
+    /**
+     * @brief Extract query features, through the feature cache if any.
+     * 
+     * @param queryImage Query image.
+     * @param imageHash QueryCache::hashImage() of the image (unused without cache).
+     * @return cv::Mat Features, empty on failure.
+     */
+    cv::Mat extractQueryFeatures(const cv::Mat& queryImage, uint64_t imageHash);
+
+    /**
+     * @brief Result cache key of an image query with the current configuration.
+     */
+    ResultKey resultKey(uint64_t imageHash, int topN) const;
+
     /**
      * @brief Compute distances from query features to all database images.
      * 
@@ -140,6 +362,112 @@ private:
      * @return std::vector<ImageMatch> All matches with computed distances.
      */
     std::vector<ImageMatch> computeAllDistances(const cv::Mat& queryFeatures);
+
+    /**
+     * @brief Score the query against every database row in parallel.
+     * 
+     * @param queryFeatures Query feature vector.
+     * @param distances Output size() x 1 CV_64F distances, in row order.
+     * @return bool True if successful, false on error.
+     */
+    bool computeDistanceColumn(const cv::Mat& queryFeatures, cv::Mat& distances);
+
+    /// (distance, database row) pair used during top-N selection.
+    using RankedRow = std::pair<double, int>;
+
+    /**
+     * @brief Find the k rows of a database closest to the query.
+     * 
+     * @param rows Database (or LiveDatabase segment) to scan, read through
+     *             FeatureDatabase::readRows().
+     * @param rowNorms Its row norms if the metric uses them (see scanNorms()).
+     * @param queryFeatures Query feature vector.
+     * @param k Number of rows to keep (> 0).
+     * @param best Output rows sorted by ascending distance (at most k).
+     * @param skip Optional per-row flags; flagged rows are never returned.
+     * @return bool True if successful, false on error.
+     */
+    bool computeTopRows(const FeatureDatabase& rows, const cv::Mat& rowNorms,
+                        const cv::Mat& queryFeatures, int k,
+                        std::vector<RankedRow>& best,
+                        const std::vector<uint8_t>* skip = nullptr);
+
+    /**
+     * @brief Find the k database rows closest to each query row on the device.
+     * 
+     * @param queries Q x matrix.cols CV_32F queries.
+     * @param k Number of rows to keep per query (> 0).
+     * @param best Output rows per query, rescored on the CPU.
+     * @return bool False if the scan must run on the CPU instead.
+     */
+    bool gpuTopRows(const cv::Mat& queries, int k, std::vector<std::vector<RankedRow>>& best);
+
+    /**
+     * @brief Find the k database rows closest to each query row on NUMA partitions.
+     * 
+     * @param queries Q x dimension CV_32F queries.
+     * @param k Number of rows to keep per query (> 0).
+     * @param best Output rows per query (ascending distance).
+     * @return bool False if the backend is not Numa or the scan failed.
+     */
+    bool numaTopRows(const cv::Mat& queries, int k, std::vector<std::vector<RankedRow>>& best);
+
+    /**
+     * @brief Find the k database rows closest to each query row.
+     * 
+     * @param queries Q x matrix.cols CV_32F queries.
+     * @param k Number of rows to keep per query (> 0).
+     * @param best Output Q lists sorted by ascending distance (at most k each).
+     * @return bool True if successful, false on error.
+     */
+    bool computeTopRowsBatch(const cv::Mat& queries, int k,
+                             std::vector<std::vector<RankedRow>>& best);
+
+    /**
+     * @brief Find the k best of the given database rows.
+     * 
+     * The rows are gathered into one contiguous matrix (keeping the
+     * storage layout) and scored with computeBatch() in parallel chunks.
+     * 
+     * @param queryFeatures Query feature vector.
+     * @param rows Candidate database rows.
+     * @param k Number of rows to keep (> 0).
+     * @param best Output rows sorted by ascending distance (at most k).
+     * @return bool True if successful, false on error.
+     */
+    bool rerankRows(const cv::Mat& queryFeatures, const std::vector<int>& rows, int k,
+                    std::vector<RankedRow>& best);
+
+    /**
+     * @brief Row norms of a database for the configured metric.
+     * 
+     * @return cv::Mat FeatureDatabase::rowNorms() if the metric uses them
+     *         (DistanceMetric::usesRowNorms()), empty otherwise.
+     */
+    cv::Mat scanNorms(const FeatureDatabase& database) const;
+
+    /**
+     * @brief Flatten the query to a float32 row matching the database.
+     * 
+     * @param queryFeatures Query feature vector (any shape).
+     * @param dimension Database dimension.
+     * @param query Output 1 x dimension CV_32F query.
+     * @return bool True if the dimensions match.
+     */
+    bool prepareQuery(const cv::Mat& queryFeatures, int dimension, cv::Mat& query) const;
+
+    /// Database rows per computeBatch() call / parallel work item
+    /// (compressed databases use their block size instead).
+    static const int SCAN_BLOCK_ROWS = 4096;
+
+    /// Database rows scored against every query of a batch before moving on.
+    static const int BATCH_TILE_ROWS = 256;
+
+    /// Queries per DistanceMetric::computeBlock() call within a tile.
+    static const int BATCH_QUERY_ROWS = 64;
+
+    /// Candidate rows per computeBatch() call / parallel work item when reranking.
+    static const int RERANK_CHUNK_ROWS = 32;
 };
 
 } // namespace cbir
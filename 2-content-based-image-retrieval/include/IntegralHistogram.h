@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+// IntegralHistogram.h
+// Author: Krushna Sanjay Sharma
+// Description: Integral histogram over a grid of pixel cells. After one pass
+//              over an image, the histogram of any axis-aligned rectangle is
+//              read in O(bins) plus a scan of its partial border cells.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INTEGRAL_HISTOGRAM_H
+#define INTEGRAL_HISTOGRAM_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @class IntegralHistogram
+ * @brief Cumulative per-bin counts for fast rectangular region histograms
+ *
+ * The image is divided into cellSize × cellSize cells. For every cell corner
+ * the table holds the histogram of all full cells above and to the left, so
+ * the histogram of a cell-aligned rectangle is four table lookups per bin.
+ * Pixels of a query rectangle that lie outside its largest cell-aligned
+ * interior are counted directly from the stored bin indices, so results are
+ * exact for any rectangle.
+ *
+ * Cost: O(pixels + cells × bins) to build, where cells = pixels / cellSize².
+ * By default the cell size is chosen so cells × bins does not exceed the
+ * pixel count, keeping the build linear in the image size.
+ *
+ * Usage example:
+ * @code
+ *   std::vector<int> bins;
+ *   histogramFeature.computeBinIndices(image, bins);
+ *   IntegralHistogram integral;
+ *   integral.build(std::move(bins), image.rows, image.cols, 512);
+ *   std::vector<float> counts(512, 0.0f);
+ *   integral.accumulate(cv::Rect(0, 0, image.cols / 2, image.rows), counts.data());
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class IntegralHistogram {
+public:
+    /**
+     * @brief Constructor (empty table)
+     */
+    IntegralHistogram();
+
+    /**
+     * @brief Build the table from per-pixel bin indices
+     *
+     * @param binIndices rows × cols bin indices in row-major order, each in
+     *                   [0, numBins); kept for border scans
+     * @param rows Image height
+     * @param cols Image width
+     * @param numBins Number of histogram bins
+     * @param cellSize Cell edge in pixels (0 = chooseCellSize())
+     * @return bool False if the sizes do not match
+     */
+    bool build(std::vector<int> binIndices, int rows, int cols, int numBins,
+               int cellSize = 0);
+
+    /**
+     * @brief Add the raw bin counts of a rectangle
+     *
+     * @param region Rectangle (clipped to the image)
+     * @param counts numBins counters to add to
+     */
+    void accumulate(const cv::Rect& region, float* counts) const;
+
+    /**
+     * @brief Smallest cell size (power of two, at least 8) whose table is no
+     *        larger than the image
+     */
+    static int chooseCellSize(int rows, int cols, int numBins);
+
+    int getNumBins() const { return numBins_; }     ///< Histogram bins
+    int getCellSize() const { return cellSize_; }   ///< Cell edge in pixels
+
+private:
+    std::vector<int> binIndices_;   ///< Per-pixel bins, row-major
+    std::vector<uint32_t> table_;   ///< (cellRows_+1) × (cellCols_+1) × numBins_
+    int rows_;                      ///< Image height
+    int cols_;                      ///< Image width
+    int numBins_;                   ///< Histogram bins
+    int cellSize_;                  ///< Cell edge in pixels
+    int cellRows_;                  ///< Full cells per column
+    int cellCols_;                  ///< Full cells per row
+
+    /// Cumulative histogram at cell corner (cellRow, cellCol)
+    const uint32_t* corner(int cellRow, int cellCol) const {
+        return &table_[(static_cast<size_t>(cellRow) * (cellCols_ + 1) + cellCol) * numBins_];
+    }
+
+    /// Count pixels [rowBegin, rowEnd) × [colBegin, colEnd) directly
+    void addPixels(int rowBegin, int rowEnd, int colBegin, int colEnd, float* counts) const;
+};
+
+} // namespace cbir
+
+#endif // INTEGRAL_HISTOGRAM_H
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// IvfPqIndex.h
+// Author: Krushna Sanjay Sharma
+// Description: Inverted-file index with product-quantised residuals (IVF-PQ)
+//              for memory-constrained search. Each vector is stored as a list
+//              id plus one byte per subquantizer.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef IVF_PQ_INDEX_H
+#define IVF_PQ_INDEX_H
+
+#include "AnnIndex.h"
+#include <algorithm>
+
+namespace cbir {
+
+/**
+ * @class IvfPqIndex
+ * @brief IVF-PQ (Jégou et al.) over the rows of a FeatureDatabase
+ *
+ * A coarse k-means quantizer splits the database into listCount inverted
+ * lists. The residual of each vector from its list centroid is split into
+ * m sub-vectors, each replaced by the index of the closest of 256 centroids
+ * learned for that subspace, so a 512-d float vector (2 KB) becomes m bytes.
+ *
+ * A query visits the probeCount closest lists and scores their codes with
+ * per-list lookup tables (m additions per vector). When the index is
+ * attached to its database, the best k x refine candidates are re-ranked
+ * with exact distances; otherwise the PQ estimates are returned.
+ *
+ * For cosine, vectors are L2-normalised before quantisation, so squared L2
+ * distance / 2 equals 1 - cos.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class IvfPqIndex : public AnnIndex {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param metric Distance to index for
+     * @param listCount Inverted lists (0 = about 4 x sqrt(N))
+     * @param subquantizers Bytes per code (0 = largest divisor of the
+     *                      dimension not above dimension / 8, at most 64)
+     * @param probeCount Lists visited per query
+     * @param refine Exact re-ranking factor (1 = no re-ranking)
+     */
+    explicit IvfPqIndex(AnnMetric metric = AnnMetric::Cosine, int listCount = 0,
+                        int subquantizers = 0, int probeCount = 16, int refine = 4);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~IvfPqIndex() = default;
+
+    virtual bool build(const FeatureDatabase& database) override;
+    virtual bool attach(const FeatureDatabase& database) override;
+    virtual bool search(const cv::Mat& query, int k,
+                        std::vector<AnnResult>& results) const override;
+    virtual bool save(const std::string& filename) const override;
+    virtual bool load(const std::string& filename) override;
+    virtual std::string getIndexName() const override;
+    virtual size_t memoryBytes() const override;
+
+    /**
+     * @brief Set the number of lists visited per query
+     */
+    void setProbeCount(int probeCount) { probeCount_ = std::max(1, probeCount); }
+
+    /**
+     * @brief Set the exact re-ranking factor (1 disables re-ranking)
+     */
+    void setRefine(int refine) { refine_ = std::max(1, refine); }
+
+private:
+    int requestedLists_;                 ///< Constructor listCount (0 = auto)
+    int requestedSubquantizers_;         ///< Constructor subquantizers (0 = auto)
+    int listCount_;                      ///< Inverted lists
+    int subquantizers_;                  ///< Code bytes per vector
+    int subDimension_;                   ///< dimension_ / subquantizers_
+    int codebookSize_;                   ///< Centroids per subspace (<= 256)
+    int probeCount_;                     ///< Lists visited per query
+    int refine_;                         ///< Re-ranking factor
+
+    std::vector<float> centroids_;       ///< listCount_ x dimension_
+    std::vector<float> codebooks_;       ///< subquantizers_ x codebookSize_ x subDimension_
+    std::vector<uint64_t> listOffsets_;  ///< listCount_ + 1 offsets into listIds_
+    std::vector<uint32_t> listIds_;      ///< Database row of each coded vector
+    std::vector<uint8_t> codes_;         ///< listIds_.size() x subquantizers_
+
+    /// Row of the database as float32, normalised for cosine
+    void loadVector(const FeatureDatabase& database, size_t row, float* out) const;
+};
+
+} // namespace cbir
+
+#endif // IVF_PQ_INDEX_H
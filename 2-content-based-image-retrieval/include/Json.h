@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+// Json.h
+// Author: Krushna Sanjay Sharma
+// Description: Minimal JSON value with a parser and serialiser, used by the
+//              query server protocol. Objects keep insertion order.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @class JsonValue
+ * @brief Null, boolean, number, string, array or object
+ *
+ * Accessors never throw: reading a missing key or the wrong type returns
+ * a null value or the supplied fallback, so request handlers can validate
+ * fields with plain checks.
+ *
+ * Usage example:
+ * @code
+ *   JsonValue request;
+ *   if (JsonValue::parse("{\"top\": 5}", request)) {
+ *       int top = static_cast<int>(request.get("top").asNumber(10));
+ *   }
+ *   JsonValue reply = JsonValue::object();
+ *   reply.set("status", "ok");
+ *   std::string text = reply.dump();   // {"status":"ok"}
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class JsonValue {
+public:
+    /**
+     * @enum Type
+     * @brief JSON value kinds
+     */
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue();                              ///< null
+    JsonValue(bool value);                    ///< true / false
+    JsonValue(double value);                  ///< Number
+    JsonValue(int value);                     ///< Number
+    JsonValue(long long value);               ///< Number
+    JsonValue(const char* value);             ///< String
+    JsonValue(const std::string& value);      ///< String
+
+    static JsonValue array();                 ///< Empty array
+    static JsonValue object();                ///< Empty object
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray() const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+
+    bool asBool(bool fallback = false) const;
+    double asNumber(double fallback = 0.0) const;
+    std::string asString(const std::string& fallback = "") const;
+
+    /**
+     * @brief Elements of an array or members of an object (0 otherwise)
+     */
+    size_t size() const;
+
+    /**
+     * @brief Array element, null value if out of range or not an array
+     */
+    const JsonValue& at(size_t index) const;
+
+    /**
+     * @brief Object member, null value if missing or not an object
+     */
+    const JsonValue& get(const std::string& key) const;
+
+    /**
+     * @brief True if this is an object with the given member
+     */
+    bool has(const std::string& key) const;
+
+    /**
+     * @brief Append to an array (a null value becomes an array)
+     */
+    void push(JsonValue value);
+
+    /**
+     * @brief Set an object member (a null value becomes an object)
+     */
+    void set(const std::string& key, JsonValue value);
+
+    /**
+     * @brief Compact serialisation; non-finite numbers are written as null
+     */
+    std::string dump() const;
+
+    /**
+     * @brief Parse a complete JSON document
+     *
+     * @param text Input text
+     * @param out Parsed value
+     * @param error Optional message with the byte offset of the failure
+     * @return bool False on malformed input or nesting deeper than 64
+     */
+    static bool parse(const std::string& text, JsonValue& out, std::string* error = nullptr);
+
+private:
+    Type type_;
+    bool bool_;
+    double number_;
+    std::string string_;
+    std::vector<JsonValue> items_;
+    std::vector<std::pair<std::string, JsonValue>> members_;
+
+    void dumpTo(std::string& out) const;
+};
+
+} // namespace cbir
+
+#endif // JSON_H
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+// LateFusion.h
+// Author: Krushna Sanjay Sharma
+// Description: Scan engine for late-fusion metrics: a feature vector made of
+//              column segments (DNN embedding, colour histogram, face count,
+//              layout), each compared with its own vectorised kernel and
+//              combined with a weight. Segments are scored cheapest first,
+//              so a top-K scan can stop before the expensive ones for rows
+//              that can no longer enter the result.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LATE_FUSION_H
+#define LATE_FUSION_H
+
+#include <cstddef>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @class LateFusion
+ * @brief Weighted sum of per-segment distances over one packed row
+ *
+ * Segment distances:
+ *   - Cosine:       1 - cos(q, r), 1.0 if either segment is all zeros
+ *   - Intersection: 1 - Σ min(q[i], r[i])
+ *   - Euclidean:    ||q - r||
+ *
+ * The kernels are those of DistanceKernels, so each segment gets its own
+ * AVX2 / NEON loop. The total is accumulated in double per row, in the
+ * order of increasing segment cost (Euclidean, Intersection, Cosine, then
+ * length).
+ *
+ * scoreWithCutoff() checks the running total plus a lower bound of the
+ * remaining segments against the cutoff before each segment: Cosine and
+ * Euclidean are at least 0, Intersection at least 1 - Σ q over the segment.
+ * A row that cannot win is therefore abandoned before its DNN block.
+ *
+ * An engine is immutable after construction; score() and scoreWithCutoff()
+ * may be called concurrently.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class LateFusion {
+public:
+    enum SegmentKind {
+        SEGMENT_COSINE,
+        SEGMENT_INTERSECTION,
+        SEGMENT_EUCLIDEAN
+    };
+
+    /**
+     * @brief One column range of the feature vector
+     */
+    struct Segment {
+        SegmentKind kind;
+        int start;       ///< First column
+        int length;      ///< Number of columns
+        double weight;   ///< Factor of the segment distance in the total
+    };
+
+    /**
+     * @brief Query-side constants, computed once per query
+     */
+    struct Query {
+        const float* data = nullptr;
+        std::vector<double> norms;       ///< L2 norm per segment (Cosine segments)
+        std::vector<double> lowerBounds; ///< Σ weight × bound of segments i..end
+    };
+
+    LateFusion() = default;
+
+    /**
+     * @param segments Segments of the layout, in any order, with
+     *                 non-negative weights (the bounds rely on it)
+     */
+    explicit LateFusion(const std::vector<Segment>& segments);
+
+    /** @brief Columns covered by the segments (end of the last one) */
+    int dimension() const { return dimension_; }
+
+    /**
+     * @brief Norms and bounds of a query (kept by pointer, not copied)
+     *
+     * @param query dimension() contiguous floats
+     */
+    void prepare(const float* query, Query& prepared) const;
+
+    /**
+     * @brief Weighted distance of one row
+     */
+    double score(const Query& query, const float* row) const;
+
+    /**
+     * @brief score(), abandoned once the distance provably exceeds cutoff
+     *
+     * @return double The distance if it is at most cutoff (identical to
+     *         score()), otherwise a value greater than cutoff
+     */
+    double scoreWithCutoff(const Query& query, const float* row, double cutoff) const;
+
+private:
+    double segmentDistance(const Query& query, std::size_t index, const float* row) const;
+
+    std::vector<Segment> segments_;   ///< In scoring order, cheapest first
+    int dimension_ = 0;
+};
+
+} // namespace cbir
+
+#endif // LATE_FUSION_H
@@ -0,0 +1,263 @@
+////////////////////////////////////////////////////////////////////////////////
+// LiveDatabase.h
+// Author: Krushna Sanjay Sharma
+// Description: Feature database that accepts updates while it is being
+//              queried. Writers publish immutable snapshots (a list of
+//              read-only segments plus per-segment dead-row masks); queries
+//              scan the snapshot they acquired without taking any lock.
+//              CSV files can also be streamed in chunk by chunk, so queries
+//              can start before the whole file is parsed.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LIVE_DATABASE_H
+#define LIVE_DATABASE_H
+
+#include "FeatureDatabase.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct DatabaseSegment
+ * @brief One immutable block of rows inside a snapshot
+ *
+ * Rows replaced or removed by a later segment are flagged in dead; the
+ * mask is shared between snapshots and copied only when a publish marks
+ * another row of this segment.
+ */
+struct DatabaseSegment {
+    std::shared_ptr<const FeatureDatabase> rows;        ///< Never modified once published
+    std::shared_ptr<const std::vector<uint8_t>> dead;   ///< 1 per superseded row (nullptr = none)
+    size_t deadCount = 0;                               ///< Number of flagged rows
+
+    size_t live() const { return rows->size() - deadCount; }   ///< Rows still visible
+
+    /// Check if a row is superseded
+    bool isDead(size_t row) const { return dead != nullptr && (*dead)[row] != 0; }
+};
+
+/**
+ * @struct DatabaseSnapshot
+ * @brief Immutable view of a LiveDatabase at one version
+ *
+ * Every live image name appears in exactly one segment, so results of the
+ * segments can be merged without duplicates.
+ */
+struct DatabaseSnapshot {
+    std::vector<DatabaseSegment> segments;   ///< Oldest first
+    uint64_t version = 0;                    ///< Increases with every publish
+    int dimension = 0;                       ///< Feature length (0 while empty)
+    double readiness = 1.0;                  ///< Fraction of an async load visible
+
+    /**
+     * @brief Number of live images
+     */
+    size_t size() const;
+
+    /**
+     * @brief False while LiveDatabase::loadAsync() is still streaming rows
+     *        in (results over this snapshot are then partial)
+     */
+    bool complete() const { return readiness >= 1.0; }
+
+    /**
+     * @brief Features of a live image
+     *
+     * @param imageName Image path or filename
+     * @return cv::Mat 1 x dimension CV_32F view (kept alive by the snapshot),
+     *         empty if absent
+     */
+    cv::Mat getFeatures(const std::string& imageName) const;
+};
+
+/**
+ * @struct AsyncLoadOptions
+ * @brief Chunking of LiveDatabase::loadAsync()
+ */
+struct AsyncLoadOptions {
+    size_t chunkBytes = size_t(16) << 20;   ///< Bytes read (and published) per chunk
+    size_t readAhead = 4;                   ///< Chunks read ahead of the parser
+};
+
+/**
+ * @class LiveDatabase
+ * @brief Copy-on-write (RCU-style) database for concurrent queries and updates
+ *
+ * Readers call snapshot() once per query and keep the returned pointer for
+ * the whole scan; acquiring it is a single atomic load, so queries never
+ * wait for writers or for each other. Writers stage puts and removals and
+ * publish() them as a new segment: older segments are not touched, only
+ * their dead masks are copied and extended, and the new snapshot is
+ * swapped in atomically. A snapshot's memory is reclaimed when the last
+ * query holding it finishes, so at most one old version per in-flight
+ * query is kept alive.
+ *
+ * Once more than maxSegments segments accumulate, publish() merges the
+ * live rows into a single segment; running queries keep their old
+ * segments until they finish.
+ *
+ * loadAsync() streams a CSV file in on background threads: one reads
+ * line-aligned chunks ahead with plain sequential reads (which network
+ * file systems prefetch well), another parses each chunk and publishes it
+ * as a segment. Queries see every chunk published so far; the snapshot's
+ * readiness tells how much of the file that is, and complete() turns true
+ * with the last chunk. publish() and compact() wait for the load, so
+ * rows loaded later never override published updates.
+ *
+ * Usage example:
+ * @code
+ *   LiveDatabase live;
+ *   live.load("hist.fdb");
+ *
+ *   // Writer thread
+ *   live.put("new.jpg", features);
+ *   live.remove("old.jpg");
+ *   live.publish();
+ *
+ *   // Query threads
+ *   auto snapshot = live.snapshot();
+ *   auto matches = retrieval.querySnapshot(*snapshot, queryFeatures, 10);
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class LiveDatabase {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param maxSegments Segments allowed before publish() compacts
+     */
+    explicit LiveDatabase(size_t maxSegments = 8);
+
+    /**
+     * @brief Destructor (stops a running async load)
+     */
+    ~LiveDatabase();
+
+    LiveDatabase(const LiveDatabase&) = delete;
+    LiveDatabase& operator=(const LiveDatabase&) = delete;
+
+    /**
+     * @brief Replace the contents with a database file (CSV or binary)
+     *
+     * Staged changes are discarded. The file becomes the single base
+     * segment; a binary file stays memory-mapped.
+     *
+     * @param filename Database file
+     * @return bool False if the file cannot be loaded
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Replace the contents with a CSV file streamed in the background
+     *
+     * Returns as soon as the file is open, after publishing an empty
+     * snapshot with readiness 0; each parsed chunk is then published as
+     * a segment. Names repeated across chunks are resolved by compact().
+     * Binary files need no parsing and are loaded with load() instead.
+     * A load already running is stopped first.
+     *
+     * @param filename Database file
+     * @param options Chunk size and read-ahead depth
+     * @return bool False if the file cannot be opened
+     */
+    bool loadAsync(const std::string& filename,
+                   const AsyncLoadOptions& options = AsyncLoadOptions());
+
+    /**
+     * @brief Fraction of the file visible to queries (1 when not loading)
+     */
+    double readiness() const { return snapshot()->readiness; }
+
+    /**
+     * @brief True while loadAsync() is streaming
+     */
+    bool isLoading() const;
+
+    /**
+     * @brief Block until an async load finishes
+     *
+     * @return bool False if the last load failed part way (read error)
+     */
+    bool waitForLoad();
+
+    /**
+     * @brief Current snapshot (wait-free for readers)
+     *
+     * @return std::shared_ptr<const DatabaseSnapshot> Never nullptr
+     */
+    std::shared_ptr<const DatabaseSnapshot> snapshot() const;
+
+    /**
+     * @brief Stage an addition or replacement
+     *
+     * @param imageName Image path or filename
+     * @param features Feature vector (any shape, converted to float32)
+     * @return bool False if the features are empty or the dimension differs
+     */
+    bool put(const std::string& imageName, const cv::Mat& features);
+
+    /**
+     * @brief Stage a removal (removing an absent name does nothing)
+     */
+    void remove(const std::string& imageName);
+
+    /**
+     * @brief Make staged changes visible to new snapshots
+     *
+     * @return uint64_t Version of the published snapshot (unchanged if
+     *         nothing was staged)
+     */
+    uint64_t publish();
+
+    /**
+     * @brief Merge all segments into one and publish the result
+     */
+    void compact();
+
+    size_t pending() const;                             ///< Staged changes
+    size_t getMaxSegments() const { return maxSegments_; }
+
+private:
+    class ChunkReader;
+
+    size_t maxSegments_;
+    std::shared_ptr<const DatabaseSnapshot> current_;   ///< Accessed with std::atomic_load/store
+
+    mutable std::mutex writerMutex_;                    ///< Serialises writers only
+    std::map<std::string, cv::Mat> staged_;             ///< Name -> row, empty Mat = removal
+
+    std::thread loader_;                                ///< Async load thread
+    std::atomic<bool> cancelLoad_;                      ///< Asks the loader to stop
+    mutable std::mutex loadMutex_;                      ///< Guards the two fields below
+    std::condition_variable loadDone_;
+    bool loading_ = false;
+    bool loadSucceeded_ = true;
+
+    /// Parse and publish the chunks of a reader (loader thread)
+    void streamChunks(ChunkReader& reader);
+
+    /// Stop and join a running async load
+    void cancelLoad();
+
+    /// Publish a snapshot to readers
+    void store(std::shared_ptr<const DatabaseSnapshot> snapshot);
+
+    /// Merge the live rows of a snapshot into one segment (writer lock held)
+    static std::shared_ptr<DatabaseSnapshot> merge(const DatabaseSnapshot& snapshot);
+};
+
+} // namespace cbir
+
+#endif // LIVE_DATABASE_H
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// MappedFile.h
+// Author: Krushna Sanjay Sharma
+// Description: Read-only memory mapping of a whole file (mmap on POSIX,
+//              MapViewOfFile on Windows). Used to open binary feature
+//              databases without reading or parsing them.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace cbir {
+
+/**
+ * @class MappedFile
+ * @brief Maps a file into memory for the lifetime of the object
+ *
+ * Pages are mapped copy-on-write, so code that writes into a view (for
+ * example through a cv::Mat header) modifies private pages and never the
+ * file. Pages are loaded by the OS on first access, so opening a file of
+ * any size costs a few system calls.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Destructor - unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file
+     *
+     * @param filename Path to the file
+     * @return bool True if the file was mapped, false on error
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Unmap the file (no-op if nothing is mapped)
+     */
+    void close();
+
+    /**
+     * @brief Start of the mapping, nullptr if not open
+     */
+    const char* data() const { return data_; }
+
+    /**
+     * @brief Size of the mapping in bytes
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Check if a file is mapped
+     */
+    bool isOpen() const { return data_ != nullptr; }
+
+private:
+    char* data_ = nullptr;   ///< Mapped view
+    size_t size_ = 0;        ///< View size in bytes
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;     ///< HANDLE of the file
+    void* mappingHandle_ = nullptr;  ///< HANDLE of the file mapping
+#endif
+};
+
+} // namespace cbir
+
+#endif // MAPPED_FILE_H
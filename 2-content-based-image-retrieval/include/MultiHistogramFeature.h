@@ -37,7 +37,11 @@ namespace cbir {
  *   - Horizontal splits (top/bottom)
  *   - Vertical splits (left/right)
  *   - Grid (2×2, 3×3, etc.)
- *   - Custom regions
+ *   - Spatial pyramid (whole image, 2×2, 4×4, ... levels)
+ * 
+ * Pixels are binned once and region histograms are read from an
+ * IntegralHistogram, so extraction cost barely depends on the number of
+ * regions.
  * 
  * Default: Top and bottom halves (2 regions)
  * 
@@ -56,7 +60,8 @@ public:
     enum class SplitType {
         HORIZONTAL,  ///< Split horizontally (top/bottom)
         VERTICAL,    ///< Split vertically (left/right)
-        GRID         ///< Split into grid (2×2, 3×3, etc.)
+        GRID,        ///< Split into grid (2×2, 3×3, etc.)
+        PYRAMID      ///< Spatial pyramid; numRegions = levels (1×1, 2×2, 4×4, ...)
     };
     
     /**
@@ -70,7 +75,7 @@ public:
      * Constructor with custom configuration
      * 
      * @param splitType How to divide the image
-     * @param numRegions Number of regions to create
+     * @param numRegions Number of regions to create (levels for PYRAMID)
      * @param histType RGB or RG_CHROMATICITY
      * @param binsPerChannel Bins per color channel
      * @param normalize Normalize histograms
@@ -84,8 +89,36 @@ public:
     virtual ~MultiHistogramFeature() = default;
     
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
     virtual std::string getFeatureName() const override;
     virtual int getFeatureDimension() const override;
+    virtual int getMaxDecodeReduction() const override;
+    virtual int getMinImageSide() const override;
+    virtual bool isThreadSafe() const override { return true; }
+    
+    /**
+     * Extract a batch; with setUseGpu() every region histogram of the
+     * batch is counted on the OpenCL device, otherwise (or when the device
+     * fails) the images are extracted on the CPU
+     */
+    virtual int extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                             std::vector<uchar>* valid = nullptr) override;
+    
+    /**
+     * GpuHistogram::PREFERRED_BATCH with the device path on, otherwise 1
+     */
+    virtual int getPreferredBatchSize() const override {
+        return useGpu_ ? GpuHistogram::PREFERRED_BATCH : 1;
+    }
+    
+    /**
+     * Count batches on the OpenCL device (GpuHistogram)
+     * 
+     * @param enabled Request the device path
+     * @return True if batches will be counted on the device
+     */
+    bool setUseGpu(bool enabled);
+    bool usesGpu() const { return useGpu_; }
     
     /**
      * Set split type
@@ -93,10 +126,18 @@ public:
     void setSplitType(SplitType type);
     
     /**
-     * Set number of regions
+     * Set number of regions (levels for PYRAMID)
      */
     void setNumRegions(int num);
     
+    /**
+     * Number of region histograms in the feature vector
+     * 
+     * Equals numRegions except for GRID (rounded up to a square) and
+     * PYRAMID (1 + 4 + 16 + ... over the levels).
+     */
+    int getRegionCount() const;
+    
     /**
      * Get weights for combining distances from each region
      * Can be used by distance metric for weighted averaging
@@ -107,7 +148,8 @@ public:
     
     /**
      * Set custom weights for regions (must sum to 1.0)
-     * Default: equal weights for all regions
+     * Default: equal weights for all regions; PYRAMID uses the spatial
+     * pyramid match weights (finer levels count more)
      * 
      * @param weights Vector of weights
      */
@@ -115,39 +157,65 @@ public:
 
 private:
     SplitType splitType_;                        ///< How to split image
-    int numRegions_;                             ///< Number of regions
+    int numRegions_;                             ///< Number of regions (PYRAMID: levels)
     HistogramFeature::HistogramType histType_;   ///< Histogram type
     int binsPerChannel_;                         ///< Bins per channel
     bool normalize_;                             ///< Normalize flag
     std::vector<double> regionWeights_;          ///< Weights for each region
+    bool useGpu_;                                ///< Count batches on the device
     
     /**
-     * Split image into regions based on split type
+     * Region rectangles based on split type
      * 
-     * @param image Input image
-     * @return Vector of image regions
+     * @param size Image size
+     * @return Region rectangles, in feature vector order
      */
-    std::vector<cv::Mat> splitImage(const cv::Mat& image) const;
+    std::vector<cv::Rect> splitImage(const cv::Size& size) const;
     
     /**
      * Split horizontally (e.g., top half, bottom half)
      */
-    std::vector<cv::Mat> splitHorizontal(const cv::Mat& image) const;
+    std::vector<cv::Rect> splitHorizontal(const cv::Size& size) const;
     
     /**
      * Split vertically (e.g., left half, right half)
      */
-    std::vector<cv::Mat> splitVertical(const cv::Mat& image) const;
+    std::vector<cv::Rect> splitVertical(const cv::Size& size) const;
     
     /**
      * Split into grid (e.g., 2×2 quadrants)
      */
-    std::vector<cv::Mat> splitGrid(const cv::Mat& image) const;
+    std::vector<cv::Rect> splitGrid(const cv::Size& size) const;
     
     /**
-     * Initialize default region weights (equal weights)
+     * Split into pyramid levels (1×1, then 2×2, then 4×4, ...)
+     */
+    std::vector<cv::Rect> splitPyramid(const cv::Size& size) const;
+    
+    /**
+     * Append the cells of a gridSize × gridSize grid
+     */
+    static void appendGrid(const cv::Size& size, int gridSize, std::vector<cv::Rect>& regions);
+    
+    /**
+     * Side of the square grid used for GRID
+     */
+    int gridSize() const;
+    
+    /**
+     * Initialize default region weights (equal, or pyramid match weights)
      */
     void initializeWeights();
+    
+    /**
+     * Normalize each region histogram of a feature vector in place
+     */
+    void normalizeRegions(float* values, size_t regionCount, int histDim) const;
+    
+    /**
+     * Device counting layout: colour bins only, one set per region
+     */
+    GpuHistogram::Layout gpuLayout() const;
 };
 
 } // namespace cbir
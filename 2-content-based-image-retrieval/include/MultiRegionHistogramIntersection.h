@@ -82,6 +82,13 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
     
+    /**
+     * Multi-region distance from a query to every row of a feature matrix,
+     * without per-row Mat wrapping or virtual compute() calls
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
     virtual std::string getMetricName() const override;
     
     /**
@@ -100,20 +107,18 @@ private:
     int numRegions_;              ///< Number of spatial regions
     int binsPerRegion_;           ///< Histogram dimension per region
     std::vector<double> weights_; ///< Weight for each region (sum = 1.0)
+    std::vector<float> binWeights_; ///< Weight of each bin's region, per bin
+    double weightTotal_ = 0.0;    ///< Σ weights_
     
     /**
-     * Compute histogram intersection for a single region
-     * 
-     * @param hist1 First feature vector
-     * @param hist2 Second feature vector
-     * @param startIdx Start index of region (inclusive)
-     * @param endIdx End index of region (exclusive)
-     * @return Intersection value for this region
+     * Combined distance between two contiguous multi-region arrays
+     */
+    double regionDistance(const float* hist1, const float* hist2) const;
+    
+    /**
+     * Expand weights_ into binWeights_ (after every weight change)
      */
-    double computeRegionIntersection(const cv::Mat& hist1, 
-                                    const cv::Mat& hist2,
-                                    int startIdx, 
-                                    int endIdx) const;
+    void buildBinWeights();
     
     /**
      * Initialize equal weights for all regions
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+// NumaScanner.h
+// Author: Krushna Sanjay Sharma
+// Description: NUMA-aware exhaustive scans for multi-socket servers. The
+//              packed feature matrix is split into one partition per node,
+//              each copied into memory local to its node, and scanned by a
+//              thread pool whose workers are pinned to that node's CPUs.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NUMA_SCANNER_H
+#define NUMA_SCANNER_H
+
+#include "FeatureDatabase.h"
+#include "DistanceMetric.h"
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct NumaNode
+ * @brief One memory node and the CPUs attached to it
+ */
+struct NumaNode {
+    int id = 0;               ///< Node number as reported by the OS
+    std::vector<int> cpus;    ///< Logical CPUs of the node
+};
+
+/**
+ * @brief Memory nodes of this machine
+ *
+ * Read from /sys/devices/system/node on Linux. Elsewhere, or if the
+ * topology cannot be read, a single node holding every hardware thread.
+ */
+std::vector<NumaNode> detectNumaTopology();
+
+/**
+ * @class NumaThreadPool
+ * @brief Worker threads pinned to the CPUs of each NUMA node
+ *
+ * One worker per CPU, pinned to its node's CPU set (not to a single CPU,
+ * so the OS can still balance within the node). run() hands the same task
+ * to every worker and waits; the task learns its node and worker index
+ * and picks its share of the work. Calls to run() are serialised.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class NumaThreadPool {
+public:
+    /// Task run once by every worker: (node index, worker index within node)
+    using Task = std::function<void(int node, int worker)>;
+
+    /**
+     * @brief Start the workers
+     *
+     * @param nodes Topology (detectNumaTopology()); workers are only
+     *              pinned when there is more than one node
+     */
+    explicit NumaThreadPool(const std::vector<NumaNode>& nodes);
+
+    /**
+     * @brief Stop and join the workers
+     */
+    ~NumaThreadPool();
+
+    NumaThreadPool(const NumaThreadPool&) = delete;
+    NumaThreadPool& operator=(const NumaThreadPool&) = delete;
+
+    /**
+     * @brief Run a task on every worker and wait for all of them
+     */
+    void run(const Task& task);
+
+    /**
+     * @brief Number of nodes
+     */
+    int nodeCount() const { return static_cast<int>(nodes_.size()); }
+
+    /**
+     * @brief Workers pinned to a node
+     */
+    int workerCount(int node) const { return static_cast<int>(nodes_[node].cpus.size()); }
+
+private:
+    std::vector<NumaNode> nodes_;
+    std::vector<std::thread> threads_;
+    std::mutex runMutex_;                 ///< Serialises run()
+    std::mutex mutex_;                    ///< Guards the fields below
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const Task* task_ = nullptr;
+    uint64_t generation_ = 0;             ///< Bumped by every run()
+    int pending_ = 0;                     ///< Workers still running the task
+    bool stopping_ = false;
+
+    void workerLoop(int node, int worker);
+};
+
+/**
+ * @class NumaScanner
+ * @brief Node-local partitions of a FeatureDatabase with top-K scans
+ *
+ * Rows are split into one contiguous partition per node, sized by the
+ * node's CPU count. Each partition (and its row norms, for metrics that
+ * use them) is allocated and filled by workers of its own node, so under
+ * the kernel's first-touch policy its pages live in that node's memory;
+ * the scan then only reads local memory. Partitions are rebuilt when the
+ * database's version() changes, like GpuScanner's device copy.
+ *
+ * A search scores every query against every partition row with the
+ * metric's computeBatchNormed() / computeBlockNormed(), in the same block
+ * and tile sizes as ImageRetrieval's CPU scan. Each worker keeps one
+ * bounded heap per query; heaps are merged per node, then the node lists
+ * are merged into the final top K, with ties broken by row as on the CPU
+ * path. Single queries and batches use the same pool.
+ *
+ * The partitions are a copy of the matrix (in its storage type), so a
+ * mapped database costs its size again in memory. One instance may be
+ * shared by several ImageRetrieval engines; searches are serialised.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class NumaScanner {
+public:
+    /**
+     * @brief True if the machine has more than one NUMA node
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Constructor (detects the topology and starts the pool)
+     */
+    NumaScanner();
+
+    NumaScanner(const NumaScanner&) = delete;
+    NumaScanner& operator=(const NumaScanner&) = delete;
+
+    /**
+     * @brief Best k rows of the database for each query row
+     *
+     * @param database Database to scan (partitioned if not resident)
+     * @param queries Q x dimension CV_32F queries
+     * @param metric Distance to compute (called concurrently)
+     * @param k Rows to keep per query (> 0)
+     * @param best Output per query: (distance, row) ascending, at most k
+     * @return bool False on dimension mismatch or metric error
+     */
+    bool search(const FeatureDatabase& database, const cv::Mat& queries, DistanceMetric& metric,
+                int k, std::vector<std::vector<std::pair<double, int>>>& best);
+
+    /**
+     * @brief Number of NUMA nodes used
+     */
+    int nodeCount() const { return pool_.nodeCount(); }
+
+    /**
+     * @brief Bytes held by the partitions
+     */
+    size_t residentBytes() const;
+
+private:
+    /// Rows [start, start + rows.rows) of the database, in node-local memory
+    struct Partition {
+        int start = 0;
+        cv::Mat storage;   ///< Owns the row bytes
+        cv::Mat rows;      ///< Header over storage with the database's row layout
+        cv::Mat norms;     ///< rows.rows x 1 CV_64F, empty unless uploaded with norms
+    };
+
+    NumaThreadPool pool_;
+    std::vector<Partition> partitions_;       ///< One per node
+    const FeatureDatabase* source_ = nullptr; ///< Database partitioned (not owned)
+    uint64_t sourceVersion_ = 0;              ///< Its version() at partitioning
+    bool withNorms_ = false;                  ///< Partitions hold row norms
+    mutable std::mutex mutex_;
+
+    /// Partition the database unless it is already resident (lock held)
+    void upload(const FeatureDatabase& database, bool withNorms);
+};
+
+} // namespace cbir
+
+#endif // NUMA_SCANNER_H
@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+// ObjectStore.h
+// Author: Krushna Sanjay Sharma
+// Description: Read access to S3-compatible object storage, so feature
+//              databases can be built straight from a bucket: list the
+//              images under a prefix and fetch them with ranged GETs,
+//              signed with AWS Signature V4 when credentials are set.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef OBJECT_STORE_H
+#define OBJECT_STORE_H
+
+#include "HttpClient.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct ObjectInfo
+ * @brief One object found by ObjectStore::list()
+ */
+struct ObjectInfo {
+    std::string url;      ///< Object URL in the form list() was given
+    uint64_t size = 0;    ///< Object size in bytes
+};
+
+/**
+ * @class ObjectStore
+ * @brief Lists and fetches objects of an S3-compatible store over HTTP
+ *
+ * Object URLs take two forms:
+ *   - s3://bucket/key — AWS S3, virtual-hosted at
+ *     bucket.s3.<region>.amazonaws.com, or path-style at CBIR_S3_ENDPOINT
+ *     (host[:port], e.g. a MinIO server or a gateway) when that is set
+ *   - http://host[:port]/bucket/key — any S3-compatible server, path-style
+ *
+ * Requests are signed with AWS Signature V4 when AWS_ACCESS_KEY_ID and
+ * AWS_SECRET_ACCESS_KEY are set (AWS_SESSION_TOKEN is sent if present;
+ * the region comes from AWS_REGION or AWS_DEFAULT_REGION, default
+ * us-east-1); without them requests are anonymous (public buckets).
+ *
+ * The client speaks plain HTTP only. Buckets whose policy requires TLS
+ * need an endpoint that terminates it (CBIR_S3_ENDPOINT pointing at a
+ * local gateway or VPC endpoint proxy).
+ *
+ * fetch() asks for the first RANGE_BYTES of an object; if the object is
+ * larger, the remaining ranges are fetched concurrently. Failed requests
+ * and 5xx responses (S3's SlowDown) are retried with back-off. Every
+ * method is thread-safe; BatchReader calls fetch() from many threads.
+ *
+ * Usage example:
+ * @code
+ *   ObjectStore store;
+ *   std::vector<ObjectInfo> objects;
+ *   if (store.list("s3://catalogue/images/", objects)) {
+ *       std::vector<unsigned char> bytes;
+ *       store.fetch(objects.front().url, bytes);
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class ObjectStore {
+public:
+    static constexpr size_t RANGE_BYTES = size_t(8) << 20;  ///< Bytes per ranged GET
+    static constexpr int ATTEMPTS = 4;                      ///< Tries per request
+
+    /**
+     * @brief Client configured from the environment (see class comment)
+     */
+    ObjectStore();
+
+    /**
+     * @brief True for s3:// and http:// paths
+     */
+    static bool isUrl(const std::string& path);
+
+    /**
+     * @brief List the image objects (by extension) under a URL prefix
+     *
+     * "s3://bucket/images/" lists every key starting with "images/",
+     * including those in deeper "directories". Results are sorted by URL.
+     *
+     * @param prefixUrl Bucket URL with optional key prefix
+     * @param objects Output objects
+     * @param error Optional reason on failure
+     * @return bool True if the listing completed
+     */
+    bool list(const std::string& prefixUrl, std::vector<ObjectInfo>& objects,
+              std::string* error = nullptr) const;
+
+    /**
+     * @brief Fetch a whole object
+     *
+     * @param url Object URL
+     * @param bytes Output contents (its capacity is reused)
+     * @param error Optional reason on failure
+     * @return bool True if every byte arrived
+     */
+    bool fetch(const std::string& url, std::vector<unsigned char>& bytes,
+               std::string* error = nullptr) const;
+
+    /**
+     * @brief True if requests are signed
+     */
+    bool isSigned() const { return !accessKey_.empty(); }
+
+    /**
+     * @brief Request timeout in ms (default 30000)
+     */
+    void setTimeout(int timeoutMs) { timeoutMs_ = timeoutMs; }
+
+private:
+    /// Where a URL's bucket lives and how its objects are addressed
+    struct Location {
+        HttpEndpoint endpoint;
+        std::string host;         ///< Host header value
+        std::string bucketPath;   ///< "/bucket" (path-style) or "" (virtual-hosted)
+        std::string urlPrefix;    ///< URL up to and including the bucket, plus '/'
+        std::string key;          ///< Object key or key prefix
+    };
+
+    std::string accessKey_;       ///< AWS_ACCESS_KEY_ID ("" = anonymous)
+    std::string secretKey_;       ///< AWS_SECRET_ACCESS_KEY
+    std::string sessionToken_;    ///< AWS_SESSION_TOKEN
+    std::string region_;          ///< Signing region
+    std::string endpoint_;        ///< CBIR_S3_ENDPOINT ("" = AWS)
+    int timeoutMs_;               ///< Per-request deadline
+
+    /**
+     * @brief Split a URL into endpoint, bucket and key
+     */
+    bool locate(const std::string& url, Location& location, std::string* error) const;
+
+    /**
+     * @brief Signed GET with retries
+     *
+     * @param query Canonical query string (sorted, encoded) or ""
+     * @param range Range header value or ""
+     */
+    bool get(const Location& location, const std::string& path, const std::string& query,
+             const std::string& range, HttpResponse& response, std::string* headers,
+             std::string* error) const;
+
+    /**
+     * @brief Header fields of a request, with the V4 signature if signing
+     */
+    HttpHeaders sign(const Location& location, const std::string& path,
+                     const std::string& query) const;
+};
+
+} // namespace cbir
+
+#endif // OBJECT_STORE_H
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// PqIndex.h
+// Author: Krushna Sanjay Sharma
+// Description: Flat product-quantisation index (PQ / OPQ) for long feature
+//              vectors such as multi-region and Gabor histograms. Every row
+//              is kept in memory as a few hundred bytes of codes; the
+//              full-precision rows stay in the (memory-mapped) database
+//              file and are read only to rerank the best candidates.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PQ_INDEX_H
+#define PQ_INDEX_H
+
+#include "AnnIndex.h"
+#include <algorithm>
+
+namespace cbir {
+
+/**
+ * @class PqIndex
+ * @brief Exhaustive asymmetric-distance search over PQ codes
+ *
+ * The (transformed) vector is split into m contiguous subspaces of about
+ * dimension / m values each. Subspaces may differ in width, so any
+ * dimension works. Each sub-vector is replaced by the index of the nearest
+ * of 256 centroids learned for that subspace. A query builds one lookup
+ * table per subspace, holding the squared distance from its sub-vector to
+ * every centroid. The estimated SSD to a row is then the sum of m table
+ * entries. All codes are scanned, so there is no coarse quantizer whose
+ * lists could miss a neighbour; this suits databases that fit in memory
+ * only once compressed.
+ *
+ * With rotate (OPQ), dimensions are first permuted so that every subspace
+ * receives a similar share of the variance. Histogram bins vary wildly in
+ * variance, and plain PQ would waste codes on empty bins. For dimensions
+ * up to MAX_ROTATION_DIMENSION, an orthogonal rotation is then learned by
+ * alternating codebook training and Procrustes updates (Ge et al.). Both
+ * transforms preserve distances, so the estimates still approximate SSD.
+ *
+ * When refine > 1, the best k x refine estimates are reranked with exact
+ * distances read from the attached database. A binary database opens
+ * memory-mapped, so only those rows are paged in.
+ *
+ * For cosine, vectors are L2-normalised before quantisation, as in
+ * IvfPqIndex.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class PqIndex : public AnnIndex {
+public:
+    /// Largest dimension for which OPQ learns a full rotation
+    static const int MAX_ROTATION_DIMENSION = 1024;
+
+    /**
+     * @brief Constructor
+     *
+     * @param metric Distance to index for
+     * @param rotate Learn an OPQ permutation / rotation before quantising
+     * @param subquantizers Bytes per code (0 = dimension / 8, at most 256)
+     * @param refine Exact reranking factor (1 = no reranking)
+     */
+    explicit PqIndex(AnnMetric metric = AnnMetric::L2, bool rotate = false,
+                     int subquantizers = 0, int refine = 4);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~PqIndex() = default;
+
+    virtual bool build(const FeatureDatabase& database) override;
+    virtual bool attach(const FeatureDatabase& database) override;
+    virtual bool search(const cv::Mat& query, int k,
+                        std::vector<AnnResult>& results) const override;
+    virtual bool save(const std::string& filename) const override;
+    virtual bool load(const std::string& filename) override;
+    virtual std::string getIndexName() const override;
+    virtual size_t memoryBytes() const override;
+
+    /**
+     * @brief Set the exact reranking factor (1 disables reranking)
+     */
+    void setRefine(int refine) { refine_ = std::max(1, refine); }
+
+    /**
+     * @brief Code bytes per vector
+     */
+    int codeBytes() const { return subquantizers_; }
+
+private:
+    bool rotate_;                        ///< OPQ transform learned at build time
+    int requestedSubquantizers_;         ///< Constructor subquantizers (0 = auto)
+    int subquantizers_;                  ///< Code bytes per vector
+    int codebookSize_;                   ///< Centroids per subspace (<= 256)
+    int refine_;                         ///< Reranking factor
+
+    std::vector<int> permutation_;       ///< Source dimension of each transformed one (empty = identity)
+    std::vector<float> rotation_;        ///< dimension_ x dimension_ after permuting (empty = none)
+    std::vector<int> subOffsets_;        ///< subquantizers_ + 1 subspace boundaries
+    std::vector<float> codebooks_;       ///< Subspace j at codebookSize_ x subOffsets_[j]
+    std::vector<uint8_t> codes_;         ///< count_ x subquantizers_
+
+    /// Database row as float32, normalised for cosine
+    void loadVector(const FeatureDatabase& database, size_t row, float* out) const;
+
+    /// Apply the permutation and rotation (out must not alias in)
+    void transform(const float* in, float* out) const;
+
+    /// Code of a transformed vector
+    void encode(const float* transformed, uint8_t* code) const;
+
+    /// Train one codebook per subspace on transformed samples
+    bool trainCodebooks(const cv::Mat& samples);
+
+    /// Variance-balanced assignment of dimensions to subspaces
+    void balancePermutation(const cv::Mat& samples);
+
+    /// Alternate codebook training and Procrustes rotation updates
+    bool learnRotation(const cv::Mat& permuted);
+};
+
+} // namespace cbir
+
+#endif // PQ_INDEX_H
@@ -27,6 +27,7 @@
 #define PRODUCT_MATCHER_DISTANCE_H
 
 #include "DistanceMetric.h"
+#include "LateFusion.h"
 
 namespace cbir {
 
@@ -40,6 +41,9 @@ namespace cbir {
  * 
  * Weight ratio 60:40 prioritizes semantic correctness over color matching.
  * 
+ * Scans score both segments with the LateFusion engine: the colour block
+ * first, and the DNN block only for rows that can still enter the top K.
+ * 
  * @author Krushna Sanjay Sharma
  */
 class ProductMatcherDistance : public DistanceMetric {
@@ -64,6 +68,24 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
     
+    /**
+     * @brief Weighted distance from a query to every row, one fused
+     *        vectorised pass per row
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
+    /**
+     * @brief Weighted distance, skipping the DNN block once the colour
+     *        distance alone rules the row out
+     * 
+     * Non-CV_32F input falls back to compute().
+     */
+    virtual double computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                     double cutoff) override;
+    
+    virtual bool supportsCutoff() const override { return true; }
+    
     virtual std::string getMetricName() const override;
 
 private:
@@ -73,6 +95,7 @@ private:
     
     double dnnWeight_;    ///< Weight for DNN distance
     double colorWeight_;  ///< Weight for color distance
+    LateFusion fusion_;   ///< Segment scan with the weights above
     
     /**
      * Compute cosine distance for DNN component (bins 0-511)
@@ -89,6 +112,11 @@ private:
      */
     void normalizeWeights();
     
+    /**
+     * Build fusion_ from the current weights
+     */
+    void buildFusion();
+    
     /**
      * Compute L2 norm for cosine distance
      */
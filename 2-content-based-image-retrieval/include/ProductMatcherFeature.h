@@ -71,6 +71,19 @@ public:
      */
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
     
+    /**
+     * Extract features using the context's filename for the DNN lookup
+     * (the context image may be a crop holding just the center region)
+     */
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
+    
+    /**
+     * Only the center region is read from the pixels
+     */
+    virtual DecodeRegion getDecodeRegion() const override {
+        return DecodeRegion::centred(centerRatio_);
+    }
+    
     /**
      * Extract combined DNN + center-color features
      * 
@@ -106,16 +119,30 @@ private:
     double centerRatio_;        ///< Center region size (0.5 = 50%)
     int colorBins_;            ///< Bins per color channel
     
+    /**
+     * Combined features with the center region taken from the whole image
+     * 
+     * @param image Whole image, or a crop of it containing the center region
+     * @param fullSize Size of the whole image
+     * @param offset Position of image within the whole image
+     * @param filename Image filename for DNN lookup
+     */
+    cv::Mat extractFromRegion(const cv::Mat& image, const cv::Size& fullSize,
+                              const cv::Point& offset, const std::string& filename);
+    
     /**
      * Extract center region from image
      * 
-     * For centerRatio=0.5, extracts center 50% of image
+     * For centerRatio=0.5, extracts center 50% of the whole image
      * (25% margin on each side)
      * 
-     * @param image Input image
+     * @param image Input image (the whole image or a crop of it)
+     * @param fullSize Size of the whole image
+     * @param offset Position of image within the whole image
      * @return Center region as cv::Mat
      */
-    cv::Mat extractCenterRegion(const cv::Mat& image) const;
+    cv::Mat extractCenterRegion(const cv::Mat& image, const cv::Size& fullSize,
+                                const cv::Point& offset) const;
     
     /**
      * Compute RGB color histogram from image region
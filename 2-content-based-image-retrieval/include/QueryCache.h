@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+// QueryCache.h
+// Author: Krushna Sanjay Sharma
+// Description: Memory-bounded LRU caches for repeated queries. A result
+//              cache maps (query image, extractor, metric, top N, database
+//              version) to ranked matches; a feature cache maps (query
+//              image, extractor) to extracted features so a known image
+//              is never re-extracted.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include "Utils.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct QueryCacheStats
+ * @brief Counters of one cache (results or features).
+ */
+struct QueryCacheStats {
+    size_t hits = 0;            ///< Lookups answered from the cache.
+    size_t misses = 0;          ///< Lookups that were not.
+    size_t evictions = 0;       ///< Entries dropped to stay within capacity.
+    size_t entries = 0;         ///< Entries currently cached.
+    size_t bytes = 0;           ///< Estimated memory held by the entries.
+    size_t capacityBytes = 0;   ///< Memory bound (0 = disabled).
+
+    /// hits / (hits + misses), 0 before the first lookup
+    double hitRate() const {
+        const size_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+/**
+ * @struct ResultKey
+ * @brief Everything a ranked result list depends on.
+ *
+ * The scope string names the extractor and metric plus anything else
+ * that changes the ranking (ANN index, prefilter); versions are
+ * FeatureDatabase::version() of the databases searched, so any mutation
+ * makes old entries unreachable.
+ */
+struct ResultKey {
+    uint64_t imageHash = 0;          ///< QueryCache::hashImage() of the query image.
+    std::string scope;               ///< Extractor, metric, index, prefilter.
+    int topN = 0;                    ///< Matches requested.
+    uint64_t databaseVersion = 0;    ///< Version of the searched database.
+    uint64_t prefilterVersion = 0;   ///< Version of the prefilter database (0 if none).
+};
+
+/**
+ * @class QueryCache
+ * @brief Thread-safe LRU result and feature caches with byte budgets.
+ *
+ * Both caches evict least recently used entries once their estimated
+ * size exceeds the budget; a budget of 0 disables that cache. One
+ * instance may be shared by several ImageRetrieval engines over the same
+ * database (e.g. the workers of a server collection).
+ *
+ * Usage example:
+ * @code
+ *   auto cache = std::make_shared<QueryCache>(64 << 20, 256 << 20);
+ *   retrieval.setQueryCache(cache);
+ *   retrieval.query(image, 10);   // extracts and scans
+ *   retrieval.query(image, 10);   // served from the result cache
+ *   std::cout << cache->resultStats().hitRate() << std::endl;
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class QueryCache {
+public:
+    /**
+     * @brief Create the caches.
+     *
+     * @param resultBytes Budget of the result cache (0 disables it).
+     * @param featureBytes Budget of the feature cache (0 disables it).
+     */
+    QueryCache(size_t resultBytes, size_t featureBytes);
+
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    /**
+     * @brief Content hash of a query image (size, type and pixels).
+     */
+    static uint64_t hashImage(const cv::Mat& image);
+
+    /**
+     * @brief Look up ranked matches.
+     *
+     * @param key Query and configuration.
+     * @param matches Receives the cached matches on a hit.
+     * @return bool True on a hit.
+     */
+    bool findResults(const ResultKey& key, std::vector<ImageMatch>& matches);
+
+    /**
+     * @brief Store ranked matches (loaded images are not kept).
+     */
+    void insertResults(const ResultKey& key, const std::vector<ImageMatch>& matches);
+
+    /**
+     * @brief Look up the features of a query image.
+     *
+     * @param imageHash hashImage() of the query image.
+     * @param extractor Name of the extractor that produced them.
+     * @param features Receives the cached features on a hit (shared, do not modify).
+     * @return bool True on a hit.
+     */
+    bool findFeatures(uint64_t imageHash, const std::string& extractor, cv::Mat& features);
+
+    /**
+     * @brief Store the features of a query image.
+     */
+    void insertFeatures(uint64_t imageHash, const std::string& extractor,
+                        const cv::Mat& features);
+
+    void clearResults();    ///< Drop all results (counters are kept)
+    void clearFeatures();   ///< Drop all features (counters are kept)
+
+    QueryCacheStats resultStats() const;    ///< Result cache counters
+    QueryCacheStats featureStats() const;   ///< Feature cache counters
+
+private:
+    /// One cached value; results and features share the LRU machinery
+    struct Entry {
+        std::string key;
+        std::vector<ImageMatch> matches;
+        cv::Mat features;
+        size_t bytes = 0;
+    };
+
+    /// Most recently used entry first, plus a key index into the list
+    struct Lru {
+        std::list<Entry> order;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        QueryCacheStats stats;
+    };
+
+    Lru results_;
+    Lru features_;
+    mutable std::mutex mutex_;
+
+    /// Find and promote an entry; nullptr (and a miss) if absent or disabled
+    static Entry* lookup(Lru& lru, const std::string& key);
+
+    /// Insert or replace an entry, then evict down to capacity
+    static void store(Lru& lru, Entry entry);
+
+    static void clear(Lru& lru);
+
+    static std::string encode(const ResultKey& key);
+    static std::string encode(uint64_t imageHash, const std::string& extractor);
+};
+
+} // namespace cbir
+
+#endif // QUERY_CACHE_H
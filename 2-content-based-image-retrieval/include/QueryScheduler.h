@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////////
+// QueryScheduler.h
+// Author: Krushna Sanjay Sharma
+// Description: Admission control and batching in front of the retrieval
+//              engines of cbirServer. Queries wait for one of a fixed number
+//              of execution slots in a bounded queue ordered by priority
+//              class, the lowest class is shed when the queue is full, and
+//              small concurrent queries of a collection share one scan.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUERY_SCHEDULER_H
+#define QUERY_SCHEDULER_H
+
+#include "Utils.h"
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @enum QueryPriority
+ * @brief Scheduling class of a query; lower values are served first
+ */
+enum class QueryPriority {
+    Interactive = 0,    ///< A user waiting on the reply (GUI)
+    Normal = 1,         ///< Default
+    Batch = 2           ///< Evaluation runs and other bulk clients
+};
+
+/// Number of QueryPriority classes
+const int QUERY_PRIORITY_COUNT = 3;
+
+/**
+ * @brief Class name ("interactive", "normal", "batch")
+ */
+const char* queryPriorityName(QueryPriority priority);
+
+/**
+ * @brief Parse a class name (case-insensitive)
+ *
+ * @return bool False if the name is not a class
+ */
+bool parseQueryPriority(const std::string& name, QueryPriority& priority);
+
+/**
+ * @struct QueryTicket
+ * @brief Outcome of QueryScheduler::acquire()
+ */
+struct QueryTicket {
+    bool admitted = false;    ///< True if a slot was granted
+    int slot = -1;            ///< Execution slot (0..slots-1) when admitted
+    int status = 200;         ///< 503 (shed) or 504 (deadline passed) otherwise
+    std::string reason;       ///< Why the query was not admitted
+    double waitMs = 0.0;      ///< Time spent in the admission queue
+};
+
+/**
+ * @struct SchedulerClassStats
+ * @brief Admission counters of one priority class
+ */
+struct SchedulerClassStats {
+    uint64_t admitted = 0;    ///< Queries granted a slot
+    uint64_t shed = 0;        ///< Rejected or evicted because the queue was full
+    uint64_t expired = 0;     ///< Deadline passed while queued
+    size_t queued = 0;        ///< Currently waiting
+};
+
+/**
+ * @class QueryScheduler
+ * @brief Execution slots handed out by priority class, with a bounded queue
+ *
+ * acquire() returns at once while a slot is free. Otherwise the query
+ * waits in a queue of at most queueCapacity entries; a released slot goes
+ * to the oldest query of the highest waiting class. When the queue is
+ * full, a new query evicts the newest query of a lower class, or is shed
+ * itself if there is none, so a burst of batch queries can never keep
+ * interactive ones out. A query whose deadline passes in the queue leaves
+ * it without running. Every method is thread-safe.
+ *
+ * Usage example:
+ * @code
+ *   QueryScheduler scheduler(4, 64);
+ *   QueryTicket ticket = scheduler.acquire(QueryPriority::Interactive, 2000);
+ *   if (ticket.admitted) {
+ *       runQuery(engines[ticket.slot]);
+ *       scheduler.release(ticket);
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class QueryScheduler {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param slots Queries executing at once (at least 1)
+     * @param queueCapacity Queries waiting at most (0 = shed whenever busy)
+     */
+    QueryScheduler(int slots, size_t queueCapacity);
+
+    QueryScheduler(const QueryScheduler&) = delete;
+    QueryScheduler& operator=(const QueryScheduler&) = delete;
+
+    /**
+     * @brief Wait for an execution slot
+     *
+     * @param priority Class of the query
+     * @param timeoutMs Longest wait (the query's remaining deadline); < 0 = no limit
+     * @return QueryTicket Slot, or the reason the query was not admitted
+     */
+    QueryTicket acquire(QueryPriority priority, double timeoutMs);
+
+    /**
+     * @brief Give an admitted ticket's slot back
+     */
+    void release(const QueryTicket& ticket);
+
+    /**
+     * @brief Counters of one class
+     */
+    SchedulerClassStats stats(QueryPriority priority) const;
+
+    int getSlots() const { return slots_; }                           ///< Execution slots
+    size_t getQueueCapacity() const { return queueCapacity_; }        ///< Queue bound
+    int running() const;                                               ///< Slots in use
+
+private:
+    /// A query waiting in acquire()
+    struct Waiter {
+        QueryPriority priority;
+        int slot = -1;                     ///< Set when granted
+        int status = 0;                    ///< 0 waiting, 200 granted, 503 evicted
+        std::condition_variable wake;
+    };
+
+    int slots_;
+    size_t queueCapacity_;
+
+    mutable std::mutex mutex_;
+    std::vector<int> freeSlots_;
+    std::list<Waiter*> queue_;             ///< Arrival order
+    SchedulerClassStats stats_[QUERY_PRIORITY_COUNT];
+
+    /// Queue entry to serve next (highest class, oldest), or end()
+    std::list<Waiter*>::iterator nextWaiter();
+
+    /// Queue entry to evict for a query of the given class, or end()
+    std::list<Waiter*>::iterator evictionCandidate(QueryPriority priority);
+};
+
+/**
+ * @class QueryCoalescer
+ * @brief Runs concurrent small batch searches of one collection as one scan
+ *
+ * One scan of a collection runs at a time; it already uses every core.
+ * Queries that arrive meanwhile with the same top N and at most
+ * MAX_REQUEST_ROWS rows are appended to one pending group, up to
+ * MAX_GROUP_ROWS rows, which is scanned as a single batch once the running
+ * scan finishes. An idle collection scans a query straight away, so
+ * batching adds no latency; under load, each scan of the database serves
+ * many queries. Larger requests form groups of their own. Pending groups
+ * start in priority order (the highest class of their members).
+ *
+ * The scan must return one list per row, independent of the other rows
+ * (ImageRetrieval::queryBatch). search() is thread-safe.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class QueryCoalescer {
+public:
+    /// Batch search over rows with top N (one result list per row)
+    using Search = std::function<std::vector<std::vector<ImageMatch>>(const cv::Mat&, int)>;
+
+    static const int MAX_REQUEST_ROWS = 8;     ///< Largest request that is coalesced
+    static const int MAX_GROUP_ROWS = 256;     ///< Rows per coalesced scan
+
+    QueryCoalescer();
+
+    QueryCoalescer(const QueryCoalescer&) = delete;
+    QueryCoalescer& operator=(const QueryCoalescer&) = delete;
+
+    /**
+     * @brief Top N matches of each row, possibly from a shared scan
+     *
+     * @param rows One CV_32F query per row
+     * @param topN Matches per row
+     * @param priority Class of the request
+     * @param scan Runs the scan if this call leads its group
+     * @param scanRows Optional output: rows of the scan that served the request
+     * @return One list per row of rows
+     */
+    std::vector<std::vector<ImageMatch>> search(const cv::Mat& rows, int topN,
+                                                QueryPriority priority, const Search& scan,
+                                                int* scanRows = nullptr);
+
+    uint64_t getScans() const;      ///< Scans run
+    uint64_t getRequests() const;   ///< Requests served by them
+
+private:
+    /// Requests scanned together
+    struct Group {
+        int topN = 0;
+        QueryPriority priority = QueryPriority::Batch;
+        uint64_t sequence = 0;
+        bool open = true;           ///< Still accepts small requests
+        bool done = false;
+        cv::Mat rows;
+        std::vector<std::vector<ImageMatch>> results;
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::list<std::shared_ptr<Group>> pending_;
+    bool scanning_;
+    uint64_t nextSequence_;
+    uint64_t scans_;
+    uint64_t requests_;
+
+    /// Pending group that may scan next
+    std::shared_ptr<Group> nextGroup() const;
+};
+
+} // namespace cbir
+
+#endif // QUERY_SCHEDULER_H
@@ -70,6 +70,53 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
 
+    /**
+     * @brief SSD from a query to every row of a feature matrix
+     * 
+     * Same formula as compute(), evaluated with the AVX2/NEON kernel.
+     * 
+     * @param query Query feature vector (CV_32F)
+     * @param matrix Feature matrix, one vector per row
+     * @param out Output distances, matrix.rows x 1 CV_64F
+     * @return bool True if successful
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+
+    /**
+     * @brief SSD from a block of queries to every row of a feature matrix
+     * 
+     * Expands SSD as ||q||² + ||x||² - 2 q·x, so all cross terms are one
+     * matrix product (cv::gemm). Differences from computeBatch() are float
+     * rounding in the cancellation, largest for near-identical vectors;
+     * results are clamped at zero.
+     * 
+     * @param queries Query feature vectors, one per row (CV_32F)
+     * @param matrix Feature matrix, one vector per row
+     * @param out Output distances, queries.rows x matrix.rows CV_64F
+     * @return bool True if successful
+     */
+    virtual bool computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+
+    /**
+     * @brief SSD that stops once the running sum exceeds a cutoff
+     * 
+     * The partial sum only grows, so it is checked every
+     * DistanceKernels::CUTOFF_CHECK_FLOATS elements; completed rows give
+     * the same value as computeBatch(). Non-CV_32F input falls back to
+     * compute().
+     * 
+     * @param features1 Query feature vector
+     * @param features2 Database feature vector
+     * @param cutoff Largest distance of interest
+     * @return double SSD, or a partial sum greater than cutoff
+     */
+    virtual double computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                     double cutoff) override;
+
+    virtual bool supportsCutoff() const override { return true; }
+
     /**
      * @brief Get the name of this distance metric
      * 
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// ShardCoordinator.h
+// Author: Krushna Sanjay Sharma
+// Description: Scatter-gather over sharded feature databases. Each shard is
+//              served by a cbirServer; the coordinator sends every query
+//              batch to all shards in parallel, waits at most a deadline and
+//              merges the per-shard top-K lists. Shards that fail or time
+//              out are reported and the answer is marked partial.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SHARD_COORDINATOR_H
+#define SHARD_COORDINATOR_H
+
+#include "DecodePolicy.h"
+#include "HttpClient.h"
+#include "Utils.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct ShardStatus
+ * @brief Outcome of one shard for one request
+ */
+struct ShardStatus {
+    std::string endpoint;     ///< "host:port"
+    bool answered = false;    ///< Reply received and parsed before the deadline
+    double ms = 0.0;          ///< Round-trip time (or time until failure)
+    std::string error;        ///< Reason when !answered ("timeout", ...)
+};
+
+/**
+ * @struct ShardReport
+ * @brief Per-shard outcomes of a scatter-gather query
+ */
+struct ShardReport {
+    std::vector<ShardStatus> shards;   ///< One entry per shard, in shard order
+    int answered = 0;                  ///< Shards that answered in time
+    double elapsedMs = 0.0;            ///< Wall time of the whole fan-out
+
+    bool partial() const { return answered < static_cast<int>(shards.size()); }
+};
+
+/**
+ * @class ShardCoordinator
+ * @brief Fans feature queries out to shard servers and merges their top-K
+ *
+ * A database built with buildFeatureDB --shards N is split by image name
+ * hash into N disjoint files (FeatureDatabase::saveShards). Each is served
+ * as the same collection by its own cbirServer. Because the shards are
+ * disjoint, merging their exact top-K lists gives the exact global top-K
+ * (ImageRetrieval::mergeMatches) whenever every shard answers.
+ *
+ * Each shard request is bounded by the timeout (HttpClient); slow or dead
+ * shards only remove their images from the answer, they never delay it
+ * past the deadline. query() is thread-safe.
+ *
+ * Usage example:
+ * @code
+ *   std::vector<HttpEndpoint> shards(2);
+ *   HttpEndpoint::parse("10.0.0.1:8765", shards[0]);
+ *   HttpEndpoint::parse("10.0.0.2:8765", shards[1]);
+ *   ShardCoordinator coordinator("histogram", shards, 500);
+ *   if (coordinator.connect()) {
+ *       ShardReport report;
+ *       auto matches = coordinator.query(queryRows, 10, &report);
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class ShardCoordinator {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param collection Collection name on the shard servers
+     * @param shards Shard server addresses
+     * @param timeoutMs Default deadline per query request
+     */
+    ShardCoordinator(const std::string& collection, const std::vector<HttpEndpoint>& shards,
+                     int timeoutMs);
+
+    /**
+     * @brief Ask every shard for its collection details
+     *
+     * Learns the feature dimension, image count and decode policy; all
+     * reachable shards must agree on the dimension and policy. Unreachable
+     * shards are reported but tolerated.
+     *
+     * @return bool False if no shard has the collection or they disagree
+     */
+    bool connect();
+
+    /**
+     * @brief Top-N matches for each query row across all shards
+     *
+     * @param queries One CV_32F query per row (dimension() columns)
+     * @param topN Matches per query
+     * @param report Optional per-shard outcomes
+     * @param timeoutMs Deadline override (0 = constructor value)
+     * @param priority Scheduling class passed on to the shard servers
+     *                 ("" = their default)
+     * @return Merged top-N per query row; empty lists if no shard answered
+     */
+    std::vector<std::vector<ImageMatch>> query(const cv::Mat& queries, int topN,
+                                               ShardReport* report = nullptr,
+                                               int timeoutMs = 0,
+                                               const std::string& priority = "") const;
+
+    int dimension() const { return dimension_; }                   ///< From connect()
+    size_t size() const { return images_; }                         ///< Images on reachable shards
+    size_t shardCount() const { return shards_.size(); }            ///< Configured shards
+    int getTimeoutMs() const { return timeoutMs_; }                 ///< Default deadline
+    const DecodePolicy& getDecodePolicy() const { return decodePolicy_; } ///< From connect()
+
+private:
+    std::string collection_;
+    std::vector<HttpEndpoint> shards_;
+    int timeoutMs_;
+    int dimension_;
+    size_t images_;
+    DecodePolicy decodePolicy_;
+
+    /// Parse one shard's /query reply into per-query lists
+    static bool parseReply(const std::string& body, size_t queryCount,
+                           std::vector<std::vector<ImageMatch>>& lists, std::string& error);
+};
+
+} // namespace cbir
+
+#endif // SHARD_COORDINATOR_H
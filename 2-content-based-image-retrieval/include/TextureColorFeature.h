@@ -18,6 +18,8 @@
 //      - Represents color composition
 //
 // Combined feature vector = [texture_histogram, color_histogram]
+// Both histograms are counted in one sweep over the image; the gradient
+// magnitude is computed on a rolling 3-row window and never stored.
 // Distance metric should weight both components equally (50/50).
 //
 // Date: February 2026
@@ -27,6 +29,7 @@
 #define TEXTURE_COLOR_FEATURE_H
 
 #include "FeatureExtractor.h"
+#include "GpuHistogram.h"
 
 namespace cbir {
 
@@ -78,8 +81,34 @@ public:
     virtual ~TextureColorFeature() = default;
     
     virtual cv::Mat extractFeatures(const cv::Mat& image) override;
+    virtual cv::Mat extractFromContext(ImageContext& context) override;
     virtual std::string getFeatureName() const override;
     virtual int getFeatureDimension() const override;
+    virtual bool isThreadSafe() const override { return true; }
+    
+    /**
+     * Extract a batch; with setUseGpu() the Sobel and colour counts of the
+     * whole batch come from the OpenCL device, otherwise (or when the
+     * device fails) the images are swept on the CPU
+     */
+    virtual int extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                             std::vector<uchar>* valid = nullptr) override;
+    
+    /**
+     * GpuHistogram::PREFERRED_BATCH with the device path on, otherwise 1
+     */
+    virtual int getPreferredBatchSize() const override {
+        return useGpu_ ? GpuHistogram::PREFERRED_BATCH : 1;
+    }
+    
+    /**
+     * Count batches on the OpenCL device (GpuHistogram)
+     * 
+     * @param enabled Request the device path
+     * @return True if batches will be counted on the device
+     */
+    bool setUseGpu(bool enabled);
+    bool usesGpu() const { return useGpu_; }
     
     /**
      * Get dimension of texture component
@@ -105,40 +134,27 @@ private:
     int textureBins_;         ///< Number of bins for texture histogram
     int colorBinsPerChannel_; ///< Number of bins per color channel
     bool normalize_;          ///< Normalize histograms flag
+    bool useGpu_;             ///< Count batches on the device
     
     /**
-     * Compute Sobel gradient magnitude for entire image
+     * Compute and concatenate texture and color histograms
      * 
-     * Uses Sobel operators in X and Y directions:
-     *   Gx = Sobel_X(image)
-     *   Gy = Sobel_Y(image)
-     *   magnitude = sqrt(Gx² + Gy²)
-     * 
-     * @param image Input image (grayscale or color)
-     * @return Gradient magnitude image (CV_32F)
+     * @param colorImage BGR image
+     * @param gray Its 8-bit grayscale, or empty to convert row by row
+     * @return Combined feature vector [texture_hist, color_hist]
      */
-    cv::Mat computeGradientMagnitude(const cv::Mat& image) const;
+    cv::Mat combineFeatures(const cv::Mat& colorImage, const cv::Mat& gray) const;
     
     /**
-     * Compute histogram of gradient magnitudes (texture feature)
-     * 
-     * Bins gradient magnitudes into histogram representing texture.
-     * Higher gradients = edges, lower gradients = smooth regions.
-     * 
-     * @param gradientMagnitude Gradient magnitude image
-     * @return 1D texture histogram (normalized if configured)
+     * Normalize the texture and colour parts of [texture_hist, color_hist]
+     * separately, in place, when configured
      */
-    cv::Mat computeTextureHistogram(const cv::Mat& gradientMagnitude) const;
+    void normalizeParts(cv::Mat& combinedFeatures) const;
     
     /**
-     * Compute RGB color histogram (color feature)
-     * 
-     * Same as HistogramFeature, but integrated here.
-     * 
-     * @param image Color image
-     * @return 1D color histogram (normalized if configured)
+     * Device counting layout: texture bins, then one RGB histogram
      */
-    cv::Mat computeColorHistogram(const cv::Mat& image) const;
+    GpuHistogram::Layout gpuLayout() const;
     
     /**
      * Normalize histogram to sum=1.0
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+// ThumbnailAtlas.h
+// Author: Krushna Sanjay Sharma
+// Description: Packed thumbnail file written beside a feature database.
+//              Small JPEG or WebP thumbnails of every image are stored back
+//              to back in one file with a name index, so result displays
+//              read a few contiguous bytes per match instead of decoding
+//              full-resolution images from (possibly network) storage.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef THUMBNAIL_ATLAS_H
+#define THUMBNAIL_ATLAS_H
+
+#include "MappedFile.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cbir {
+
+/**
+ * @struct ThumbnailEntry
+ * @brief Location of one encoded thumbnail inside the atlas file
+ */
+struct ThumbnailEntry {
+    uint64_t offset = 0;   ///< Byte offset of the blob from the start of the file
+    uint32_t size = 0;     ///< Blob length in bytes
+};
+
+/**
+ * @class ThumbnailAtlas
+ * @brief Read-only view of a thumbnail atlas ("<database>.thumbs")
+ *
+ * File layout (little-endian, version 1):
+ *   header (64 bytes):  magic "CBIRTHMB", uint32 version, uint32 maxSide,
+ *                       uint64 count, uint64 indexOffset, char format[8]
+ *                       ("jpg" or "webp", zero padded), reserved
+ *   blobs:              encoded thumbnails, back to back
+ *   index:              count entries sorted by name, each
+ *                       uint64 offset, uint32 size, uint32 nameLength, name
+ *
+ * Names are image filenames without directory, as in FeatureDatabase. The
+ * file is memory-mapped and only the index is parsed on open.
+ *
+ * Usage example:
+ * @code
+ *   ThumbnailAtlas atlas;
+ *   if (atlas.open(ThumbnailAtlas::pathFor("hist.fdb"))) {
+ *       cv::Mat thumb = atlas.decode("pic.0164.jpg");
+ *   }
+ * @endcode
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class ThumbnailAtlas {
+public:
+    /**
+     * @brief Atlas path for a database file ("<database>.thumbs")
+     */
+    static std::string pathFor(const std::string& databasePath);
+
+    /**
+     * @brief Map an atlas and read its index
+     *
+     * @param path Atlas file
+     * @return bool False if the file is missing, truncated or not an atlas
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Location of an image's thumbnail
+     *
+     * @param imageName Image filename (a directory part is ignored)
+     * @param entry Receives offset and size
+     * @return bool False if the image has no thumbnail
+     */
+    bool find(const std::string& imageName, ThumbnailEntry& entry) const;
+
+    /**
+     * @brief Decode an image's thumbnail
+     *
+     * @return cv::Mat BGR thumbnail, empty if absent
+     */
+    cv::Mat decode(const std::string& imageName) const;
+
+    bool isOpen() const { return file_.isOpen(); }                 ///< Atlas mapped
+    size_t size() const { return index_.size(); }                  ///< Thumbnails
+    int getMaxSide() const { return maxSide_; }                    ///< Longest thumbnail side
+    const std::string& getFormat() const { return format_; }       ///< "jpg" or "webp"
+    const std::string& getPath() const { return path_; }           ///< Atlas file
+
+private:
+    MappedFile file_;
+    std::string path_;
+    std::string format_;
+    int maxSide_ = 0;
+    std::unordered_map<std::string, ThumbnailEntry> index_;
+};
+
+/**
+ * @class ThumbnailAtlasWriter
+ * @brief Builds an atlas from decoded images
+ *
+ * add() is thread-safe, so every extractor worker of a DatabaseBuilder can
+ * encode its own images. The atlas is written to "<path>.tmp" and renamed
+ * over path by finish(), so readers never see a partial file.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+class ThumbnailAtlasWriter {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param maxSide Longest thumbnail side in pixels
+     * @param format "jpg" or "webp"
+     * @param quality Encoder quality (1-100)
+     */
+    explicit ThumbnailAtlasWriter(int maxSide = 256, const std::string& format = "jpg",
+                                  int quality = 85);
+
+    /**
+     * @brief Destructor (discards an unfinished atlas)
+     */
+    ~ThumbnailAtlasWriter();
+
+    ThumbnailAtlasWriter(const ThumbnailAtlasWriter&) = delete;
+    ThumbnailAtlasWriter& operator=(const ThumbnailAtlasWriter&) = delete;
+
+    /**
+     * @brief Start a new atlas
+     *
+     * @param path Final atlas file
+     * @return bool False if the temporary file cannot be created
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Shrink, encode and append one image
+     *
+     * Images already in the atlas are skipped.
+     *
+     * @param imageName Image filename (a directory part is ignored)
+     * @param image Decoded image (any size)
+     * @return bool False if encoding or writing failed
+     */
+    bool add(const std::string& imageName, const cv::Mat& image);
+
+    /**
+     * @brief Check if an image has been added
+     */
+    bool contains(const std::string& imageName) const;
+
+    /**
+     * @brief Write the index and header and publish the atlas
+     *
+     * @return bool False on a write error (the temporary file is removed)
+     */
+    bool finish();
+
+    size_t size() const;                              ///< Thumbnails added
+    int getMaxSide() const { return maxSide_; }       ///< Longest thumbnail side
+
+private:
+    int maxSide_;
+    std::string format_;
+    int quality_;
+    std::string path_;
+    std::ofstream file_;
+    uint64_t offset_ = 0;                                  ///< Next blob offset
+    std::vector<std::pair<std::string, ThumbnailEntry>> entries_;
+    std::unordered_map<std::string, size_t> added_;        ///< Name -> entries_ slot
+    bool failed_ = false;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cbir
+
+#endif // THUMBNAIL_ATLAS_H
@@ -11,6 +11,7 @@
 #define UTILS_H
 
 #include <opencv2/opencv.hpp>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -50,6 +51,58 @@ namespace Utils {
     // File I/O Operations
     //==========================================================================
 
+    /**
+     * @struct PackedFeatureRows
+     * @brief Feature CSV rows in FeatureDatabase's packed layout
+     *
+     * Names are stored back to back in nameChars; row i's name is
+     * [nameOffsets[i], nameOffsets[i + 1]) and nameOffsets has size() + 1
+     * entries starting at 0. Rows keep their order in the file.
+     */
+    struct PackedFeatureRows {
+        int dimension = 0;                  ///< Values per row
+        std::vector<float> values;          ///< size() × dimension, row-major
+        std::vector<char> nameChars;        ///< Concatenated names
+        std::vector<uint64_t> nameOffsets;  ///< Name boundaries (size() + 1)
+
+        size_t size() const { return nameOffsets.empty() ? 0 : nameOffsets.size() - 1; }
+    };
+
+    /**
+     * @brief Read a feature CSV straight into packed arrays
+     *
+     * The file is memory-mapped and split into line-aligned chunks that are
+     * parsed in parallel with std::from_chars into their final rows, with
+     * no per-field strings. The dimension is taken from the first data
+     * line; rows with another field count or an unparsable value are
+     * skipped with a warning.
+     *
+     * @param filename Path to CSV file (filename,feature1,...,featureN)
+     * @param rows Output rows in file order
+     * @param hasHeader If true, skip first row as header
+     * @return bool True if at least one row was read
+     */
+    bool readFeaturesCSV(const std::string& filename, PackedFeatureRows& rows,
+                         bool hasHeader = true);
+
+    /**
+     * @brief Parse a buffer of whole feature CSV lines into packed arrays
+     *
+     * The parser behind readFeaturesCSV(), for callers that read the file
+     * themselves (e.g. in chunks). Lines are parsed in parallel; blank
+     * lines are ignored and invalid ones skipped with a warning.
+     *
+     * @param begin First byte of the first line (no header)
+     * @param end One past the last line
+     * @param firstLine File line number of the first line, for warnings
+     * @param rows Output rows in buffer order. rows.dimension is the
+     *             expected field count, or 0 to take it from the first line
+     * @param lineCount Output: lines in the buffer (may be nullptr)
+     * @return bool False if no dimension was given and no data line found
+     */
+    bool parseFeaturesCSV(const char* begin, const char* end, size_t firstLine,
+                          PackedFeatureRows& rows, size_t* lineCount = nullptr);
+
     /**
      * @brief Read CSV file containing feature vectors
      * 
@@ -192,7 +245,7 @@ namespace Utils {
      * @brief Parse feature vector from CSV string
      * 
      * @param str Comma-separated feature values
-     * @return cv::Mat Feature vector as cv::Mat
+     * @return cv::Mat Feature vector as cv::Mat, empty if a value is invalid
      */
     cv::Mat stringToFeatures(const std::string& str);
 
@@ -19,6 +19,7 @@
 #define WEIGHTED_HISTOGRAM_INTERSECTION_H
 
 #include "DistanceMetric.h"
+#include <vector>
 
 namespace cbir {
 
@@ -55,6 +56,13 @@ public:
     virtual double compute(const cv::Mat& features1, 
                           const cv::Mat& features2) override;
     
+    /**
+     * Weighted distance from a query to every row of a feature matrix,
+     * without per-row Mat wrapping or virtual compute() calls
+     */
+    virtual bool computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                              cv::Mat& out) override;
+    
     virtual std::string getMetricName() const override;
 
 private:
@@ -62,12 +70,12 @@ private:
     int colorDim_;        ///< Dimension of color component
     double textureWeight_; ///< Weight for texture distance
     double colorWeight_;   ///< Weight for color distance
+    std::vector<float> binWeights_; ///< textureWeight_ then colorWeight_, per bin
     
     /**
-     * Compute histogram intersection for a subrange of features
+     * Weighted distance between two contiguous [texture, color] arrays
      */
-    double computeIntersection(const cv::Mat& hist1, const cv::Mat& hist2,
-                              int startIdx, int endIdx) const;
+    double weightedDistance(const float* hist1, const float* hist2) const;
     
     /**
      * Check if histogram component is normalized
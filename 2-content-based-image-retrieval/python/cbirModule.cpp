@@ -0,0 +1,465 @@
+////////////////////////////////////////////////////////////////////////////////
+// cbirModule.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Python bindings (pybind11) for in-process retrieval. The GUI
+//              keeps one warm engine per feature type instead of starting
+//              queryImage, loading the database and constructing the
+//              extractor for every query. Feature matrices are exposed to
+//              NumPy without copying, and scans run without the GIL. The
+//              shared cvcore Gabor bank is exposed as cbir.GaborBank.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "FeatureDatabase.h"
+#include "FeatureFactory.h"
+#include "ImageRetrieval.h"
+#include "Utils.h"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <cvcore/gabor.hpp>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace py = pybind11;
+using namespace cbir;
+
+namespace {
+
+using MatchList = std::vector<std::pair<std::string, double>>;
+
+/**
+ * @brief (filename, distance) pairs, the shape the GUI displays
+ */
+MatchList toPairs(const std::vector<ImageMatch>& matches) {
+    MatchList pairs;
+    pairs.reserve(matches.size());
+    for (const ImageMatch& match : matches) {
+        pairs.emplace_back(match.filename, match.distance);
+    }
+    return pairs;
+}
+
+/**
+ * @brief Header over a NumPy image (no copy); HxW grey or HxWx3 BGR uint8
+ */
+cv::Mat wrapImage(const py::array_t<uint8_t, py::array::c_style>& image) {
+    if (image.ndim() == 2) {
+        return cv::Mat(static_cast<int>(image.shape(0)), static_cast<int>(image.shape(1)), CV_8UC1,
+                       const_cast<uint8_t*>(image.data()));
+    }
+    if (image.ndim() == 3 && image.shape(2) == 3) {
+        return cv::Mat(static_cast<int>(image.shape(0)), static_cast<int>(image.shape(1)), CV_8UC3,
+                       const_cast<uint8_t*>(image.data()));
+    }
+    throw std::invalid_argument("image must be an HxW or HxWx3 uint8 array (BGR)");
+}
+
+/**
+ * @brief Header over a NumPy float32 array (no copy), one vector per row
+ */
+cv::Mat wrapFeatures(const py::array_t<float, py::array::c_style | py::array::forcecast>& features) {
+    if (features.ndim() == 1) {
+        return cv::Mat(1, static_cast<int>(features.shape(0)), CV_32F,
+                       const_cast<float*>(features.data()));
+    }
+    if (features.ndim() == 2) {
+        return cv::Mat(static_cast<int>(features.shape(0)), static_cast<int>(features.shape(1)),
+                       CV_32F, const_cast<float*>(features.data()));
+    }
+    throw std::invalid_argument("features must be a 1-D vector or a 2-D array of row vectors");
+}
+
+py::array_t<float> toArray(const cv::Mat& features) {
+    cv::Mat row = features.reshape(1, 1);
+    if (row.depth() != CV_32F) {
+        row.convertTo(row, CV_32F);
+    }
+    py::array_t<float> out(row.cols);
+    std::memcpy(out.mutable_data(), row.ptr<float>(), row.cols * sizeof(float));
+    return out;
+}
+
+/**
+ * @class Engine
+ * @brief Warm retrieval engine: database, extractor and metric for one feature
+ *
+ * Wraps ImageRetrieval the way queryImage sets it up. The extractor and
+ * metric are created by FeatureFactory and owned by the ImageRetrieval; the
+ * database is shared with Python and kept alive by the engine. Calls on one
+ * engine are serialized (extractors keep per-call state); the GIL is
+ * released while they run, so other engines and the GUI thread proceed.
+ */
+class Engine {
+public:
+    Engine(std::shared_ptr<FeatureDatabase> database, const std::string& featureType,
+           const std::string& metricType)
+        : database_(std::move(database)), featureType_(featureType), metricType_(metricType) {
+        if (!database_ || database_->empty()) {
+            throw std::invalid_argument("database is empty");
+        }
+        extractor_ = FeatureFactory::createExtractor(featureType);
+        if (extractor_ == nullptr) {
+            throw std::invalid_argument("unknown feature type: " + featureType);
+        }
+        retrieval_.setFeatureExtractor(extractor_);
+        DistanceMetric* metric = FeatureFactory::createMetric(metricType);
+        if (metric == nullptr) {
+            throw std::invalid_argument("unknown metric: " + metricType);
+        }
+        retrieval_.setDistanceMetric(metric);
+        retrieval_.setFeatureDatabase(database_.get());
+    }
+
+    /**
+     * @brief Query with an image file, decoded the way the database was built
+     */
+    MatchList query(const std::string& imagePath, int topN) {
+        std::vector<ImageMatch> matches;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv::Mat image = database_->getDecodePolicy().load(imagePath);
+            if (image.empty()) {
+                throw std::runtime_error("cannot load image " + imagePath);
+            }
+            matches = queryImageLocked(image, imagePath, topN);
+        }
+        return toPairs(matches);
+    }
+
+    /**
+     * @brief Query with a decoded BGR image; filename for filename-keyed features
+     */
+    MatchList queryArray(const py::array_t<uint8_t, py::array::c_style>& array,
+                         const std::string& filename, int topN) {
+        cv::Mat image = wrapImage(array);
+        std::vector<ImageMatch> matches;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            matches = queryImageLocked(image, filename, topN);
+        }
+        return toPairs(matches);
+    }
+
+    /**
+     * @brief Query with features already extracted (1-D vector)
+     */
+    MatchList queryFeatures(const py::array_t<float, py::array::c_style | py::array::forcecast>& array,
+                            int topN) {
+        cv::Mat features = wrapFeatures(array);
+        std::vector<ImageMatch> matches;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            matches = retrieval_.queryWithFeatures(features, topN);
+        }
+        return toPairs(matches);
+    }
+
+    /**
+     * @brief One exhaustive pass for many feature vectors (one per row)
+     */
+    std::vector<MatchList> queryBatch(
+        const py::array_t<float, py::array::c_style | py::array::forcecast>& array, int topN) {
+        cv::Mat queries = wrapFeatures(array);
+        std::vector<std::vector<ImageMatch>> lists;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            lists = retrieval_.queryBatch(queries, topN);
+        }
+        std::vector<MatchList> out;
+        out.reserve(lists.size());
+        for (const auto& matches : lists) {
+            out.push_back(toPairs(matches));
+        }
+        return out;
+    }
+
+    /**
+     * @brief Query features of an image file without scanning
+     */
+    py::array_t<float> extract(const std::string& imagePath) {
+        cv::Mat features;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv::Mat image = database_->getDecodePolicy().load(imagePath);
+            if (!image.empty()) {
+                features = FeatureFactory::extractQueryFeatures(extractor_, image, imagePath);
+            }
+        }
+        if (features.empty()) {
+            throw std::runtime_error("cannot extract features from " + imagePath);
+        }
+        return toArray(features);
+    }
+
+    const std::shared_ptr<FeatureDatabase>& database() const { return database_; }
+    const std::string& featureType() const { return featureType_; }
+    const std::string& metricType() const { return metricType_; }
+
+private:
+    // Extract and scan; caller holds mutex_
+    std::vector<ImageMatch> queryImageLocked(const cv::Mat& image, const std::string& imagePath,
+                                             int topN) {
+        cv::Mat features = FeatureFactory::extractQueryFeatures(extractor_, image, imagePath);
+        if (features.empty()) {
+            throw std::runtime_error("cannot extract " + featureType_ + " features");
+        }
+        return retrieval_.queryWithFeatures(features, topN);
+    }
+
+    std::shared_ptr<FeatureDatabase> database_;   ///< Kept alive for retrieval_
+    std::string featureType_;
+    std::string metricType_;
+    FeatureExtractor* extractor_ = nullptr;       ///< Owned by retrieval_
+    ImageRetrieval retrieval_;
+    std::mutex mutex_;                            ///< One call at a time
+};
+
+/**
+ * @brief Owning handle for a factory-created extractor
+ */
+struct Extractor {
+    std::unique_ptr<FeatureExtractor> extractor;
+    std::mutex mutex;
+};
+
+/**
+ * @brief Owning handle for a factory-created metric
+ */
+struct Metric {
+    std::unique_ptr<DistanceMetric> metric;
+};
+
+/**
+ * @brief cvcore::GaborBank with the lock its spectrum cache needs
+ */
+struct GaborBankHandle {
+    explicit GaborBankHandle(int ksize, const std::vector<cvcore::GaborParams>& params,
+                             double separableError, int fftMinKsize)
+        : bank(ksize, params, separableError, fftMinKsize) {}
+
+    cvcore::GaborBank bank;
+    std::mutex mutex;
+};
+
+/**
+ * @brief (sigma, theta, lambda, gamma, psi) tuples, cv2.getGaborKernel order
+ */
+std::vector<cvcore::GaborParams> toGaborParams(
+    const std::vector<std::tuple<double, double, double, double, double>>& tuples) {
+    std::vector<cvcore::GaborParams> params;
+    params.reserve(tuples.size());
+    for (const auto& t : tuples) {
+        params.push_back({std::get<0>(t), std::get<1>(t), std::get<2>(t), std::get<3>(t),
+                          std::get<4>(t)});
+    }
+    return params;
+}
+
+} // namespace
+
+PYBIND11_MODULE(cbir, m) {
+    m.doc() = "In-process content-based image retrieval (FeatureDatabase, ImageRetrieval)";
+
+    py::class_<FeatureDatabase, std::shared_ptr<FeatureDatabase>>(m, "FeatureDatabase",
+                                                                  py::buffer_protocol())
+        .def(py::init([](const std::string& path) {
+                 auto database = std::make_shared<FeatureDatabase>();
+                 bool loaded;
+                 {
+                     py::gil_scoped_release release;
+                     loaded = database->load(path);
+                 }
+                 if (!loaded) {
+                     throw std::runtime_error("cannot load feature database " + path);
+                 }
+                 return database;
+             }),
+             py::arg("path"), "Load a binary (.fdb) or CSV feature database")
+        .def("__len__", &FeatureDatabase::size)
+        .def_property_readonly("dimension", &FeatureDatabase::dimension)
+        .def_property_readonly("names", &FeatureDatabase::getImageNames)
+        .def_property_readonly("decode_policy",
+                               [](const FeatureDatabase& db) { return db.getDecodePolicy().describe(); })
+        .def_property_readonly("is_mapped", &FeatureDatabase::isMapped)
+        .def("name", &FeatureDatabase::getName, py::arg("row"))
+        .def("index_of", &FeatureDatabase::indexOf, py::arg("name"))
+        .def("features",
+             [](const FeatureDatabase& db, const std::string& name) {
+                 cv::Mat features = db.getFeatures(name);
+                 if (features.empty()) {
+                     throw py::key_error(name);
+                 }
+                 return toArray(features);
+             },
+             py::arg("name"), "Feature vector of one image (float32 copy)")
+        // numpy.asarray(database): the packed matrix itself, read-only. The
+        // array keeps the database alive; rows are float32, float16 or uint8
+        // codes depending on the storage the database was saved with.
+        .def_buffer([](FeatureDatabase& db) -> py::buffer_info {
+            const cv::Mat matrix = db.matrix();
+            const int depth = db.storage() == FeatureStorage::Float16 ? CV_16F
+                            : db.storage() == FeatureStorage::UInt8 ? CV_8U : CV_32F;
+            const std::string format = depth == CV_16F ? "e"
+                                     : depth == CV_8U ? py::format_descriptor<uint8_t>::format()
+                                                      : py::format_descriptor<float>::format();
+            const py::ssize_t itemSize = static_cast<py::ssize_t>(CV_ELEM_SIZE1(depth));
+            const py::ssize_t rowStep = matrix.empty() ? itemSize * db.dimension()
+                                                       : static_cast<py::ssize_t>(matrix.step[0]);
+            return py::buffer_info(matrix.data, itemSize, format, 2,
+                                   {static_cast<py::ssize_t>(db.size()),
+                                    static_cast<py::ssize_t>(db.dimension())},
+                                   {rowStep, itemSize}, true);
+        });
+
+    py::class_<Engine>(m, "ImageRetrieval")
+        .def(py::init<std::shared_ptr<FeatureDatabase>, const std::string&, const std::string&>(),
+             py::arg("database"), py::arg("feature"), py::arg("metric"),
+             "Engine over a database with the named extractor and metric (as in queryImage)")
+        .def("query", &Engine::query, py::arg("image_path"), py::arg("top") = 5,
+             "Top matches of an image file as (filename, distance) pairs")
+        .def("query_image", &Engine::queryArray, py::arg("image"), py::arg("filename") = "",
+             py::arg("top") = 5, "Top matches of a BGR uint8 array")
+        .def("query_features", &Engine::queryFeatures, py::arg("features"), py::arg("top") = 5,
+             "Top matches of a feature vector")
+        .def("query_batch", &Engine::queryBatch, py::arg("features"), py::arg("top") = 5,
+             "Top matches of every row of a feature matrix in one pass")
+        .def("extract", &Engine::extract, py::arg("image_path"),
+             "Query features of an image file")
+        .def_property_readonly("database", &Engine::database)
+        .def_property_readonly("feature", &Engine::featureType)
+        .def_property_readonly("metric", &Engine::metricType);
+
+    py::class_<Extractor>(m, "FeatureExtractor")
+        .def_property_readonly("name", [](const Extractor& e) { return e.extractor->getFeatureName(); })
+        .def_property_readonly("dimension",
+                               [](const Extractor& e) { return e.extractor->getFeatureDimension(); })
+        .def("extract",
+             [](Extractor& e, const py::array_t<uint8_t, py::array::c_style>& array,
+                const std::string& filename) {
+                 cv::Mat image = wrapImage(array);
+                 cv::Mat features;
+                 {
+                     py::gil_scoped_release release;
+                     std::lock_guard<std::mutex> lock(e.mutex);
+                     features = FeatureFactory::extractQueryFeatures(e.extractor.get(), image, filename);
+                 }
+                 if (features.empty()) {
+                     throw std::runtime_error("feature extraction failed");
+                 }
+                 return toArray(features);
+             },
+             py::arg("image"), py::arg("filename") = "",
+             "Features of a BGR uint8 array (filename for filename-keyed features)");
+
+    py::class_<Metric>(m, "DistanceMetric")
+        .def_property_readonly("name", [](const Metric& d) { return d.metric->getMetricName(); })
+        .def("distance",
+             [](Metric& d, const py::array_t<float, py::array::c_style | py::array::forcecast>& a,
+                const py::array_t<float, py::array::c_style | py::array::forcecast>& b) {
+                 return d.metric->compute(wrapFeatures(a), wrapFeatures(b));
+             },
+             py::arg("a"), py::arg("b"));
+
+    py::class_<GaborBankHandle>(m, "GaborBank")
+        .def(py::init([](int ksize,
+                         const std::vector<std::tuple<double, double, double, double, double>>& params,
+                         double separableError, int fftMinKsize) {
+                 if (ksize <= 0 || ksize % 2 == 0) {
+                     throw std::invalid_argument("ksize must be odd and positive");
+                 }
+                 return std::unique_ptr<GaborBankHandle>(
+                     new GaborBankHandle(ksize, toGaborParams(params), separableError, fftMinKsize));
+             }),
+             py::arg("ksize"), py::arg("params"), py::arg("separable_error") = 1e-4,
+             py::arg("fft_min_ksize") = 21,
+             "Bank of ksize x ksize kernels, one per (sigma, theta, lambda, gamma, psi) tuple")
+        .def("__len__", [](const GaborBankHandle& g) { return g.bank.size(); })
+        .def_property_readonly("ksize", [](const GaborBankHandle& g) { return g.bank.ksize(); })
+        .def_property_readonly("ranks",
+                               [](const GaborBankHandle& g) {
+                                   std::vector<int> ranks;
+                                   for (int k = 0; k < g.bank.size(); k++) {
+                                       ranks.push_back(g.bank.rank(k));
+                                   }
+                                   return ranks;
+                               },
+                               "Separable rank per kernel (0: dense or FFT only)")
+        .def_property("use_fft",
+                      [](const GaborBankHandle& g) { return g.bank.getUseFFT(); },
+                      [](GaborBankHandle& g, bool useFFT) { g.bank.setUseFFT(useFFT); })
+        .def("kernels",
+             [](const GaborBankHandle& g) {
+                 const py::ssize_t n = g.bank.size(), k = g.bank.ksize();
+                 py::array_t<float> out({n, k, k});
+                 float* dst = out.mutable_data();
+                 for (int i = 0; i < g.bank.size(); i++, dst += k * k) {
+                     const cv::Mat& kernel = g.bank.kernel(i);
+                     for (int y = 0; y < kernel.rows; y++) {
+                         std::memcpy(dst + y * k, kernel.ptr<float>(y), k * sizeof(float));
+                     }
+                 }
+                 return out;
+             },
+             "Kernels as an (n, ksize, ksize) float32 array (cv2.getGaborKernel values)")
+        .def("filter",
+             [](GaborBankHandle& g, const py::array_t<float, py::array::c_style | py::array::forcecast>& array) {
+                 if (array.ndim() != 2) {
+                     throw std::invalid_argument("image must be a 2-D array");
+                 }
+                 const int rows = static_cast<int>(array.shape(0));
+                 const int cols = static_cast<int>(array.shape(1));
+                 cv::Mat image(rows, cols, CV_32F, const_cast<float*>(array.data()));
+                 py::array_t<float> out({static_cast<py::ssize_t>(g.bank.size()),
+                                         static_cast<py::ssize_t>(rows),
+                                         static_cast<py::ssize_t>(cols)});
+                 float* dst = out.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     std::lock_guard<std::mutex> lock(g.mutex);
+                     g.bank.forEachResponse(image, [&](int k, const cv::Mat& response) {
+                         float* plane = dst + static_cast<size_t>(k) * rows * cols;
+                         for (int y = 0; y < rows; y++) {
+                             std::memcpy(plane + static_cast<size_t>(y) * cols,
+                                         response.ptr<float>(y), cols * sizeof(float));
+                         }
+                     });
+                 }
+                 return out;
+             },
+             py::arg("image"),
+             "Responses to every kernel as an (n, H, W) float32 array (cv2.filter2D values)");
+
+    m.def("create_extractor",
+          [](const std::string& featureType) {
+              std::unique_ptr<Extractor> handle(new Extractor());
+              handle->extractor.reset(FeatureFactory::createExtractor(featureType));
+              if (!handle->extractor) {
+                  throw std::invalid_argument("unknown feature type: " + featureType);
+              }
+              return handle;
+          },
+          py::arg("feature"), "Extractor for a feature type (FeatureFactory)");
+
+    m.def("create_metric",
+          [](const std::string& metricType) {
+              std::unique_ptr<Metric> handle(new Metric());
+              handle->metric.reset(FeatureFactory::createMetric(metricType));
+              if (!handle->metric) {
+                  throw std::invalid_argument("unknown metric: " + metricType);
+              }
+              return handle;
+          },
+          py::arg("metric"), "Distance metric by name (FeatureFactory)");
+}
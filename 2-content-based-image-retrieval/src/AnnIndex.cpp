@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////
+// AnnIndex.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the AnnIndex base class: factory, load-or-build,
+//              database signature and the exact distance shared by the indexes.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "AnnIndex.h"
+#include "HnswIndex.h"
+#include "IvfPqIndex.h"
+#include "PqIndex.h"
+#include "InvertedIndex.h"
+#include "DistanceKernels.h"
+#include "Utils.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+namespace cbir {
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+AnnIndex::AnnIndex(AnnMetric metric)
+    : metric_(metric), database_(nullptr), count_(0), dimension_(0), signature_(0) {
+}
+
+/**
+ * @brief Create an index by type name
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::unique_ptr<AnnIndex> AnnIndex::create(const std::string& type, AnnMetric metric) {
+    std::string name = Utils::toLower(type);
+
+    // The inverted file is the only index over histogram intersection
+    if ((name == "inverted") != (metric == AnnMetric::Intersection)) {
+        std::cerr << "Error: Index type '" << type << "' does not support this metric "
+                  << "(inverted: histogram; hnsw, ivfpq, pq, opq: ssd, cosine)" << std::endl;
+        return nullptr;
+    }
+
+    if (name == "inverted") {
+        return std::unique_ptr<AnnIndex>(new InvertedIndex(metric));
+    } else if (name == "hnsw") {
+        return std::unique_ptr<AnnIndex>(new HnswIndex(metric));
+    } else if (name == "ivfpq" || name == "ivf-pq") {
+        return std::unique_ptr<AnnIndex>(new IvfPqIndex(metric));
+    } else if (name == "pq") {
+        return std::unique_ptr<AnnIndex>(new PqIndex(metric, false));
+    } else if (name == "opq") {
+        return std::unique_ptr<AnnIndex>(new PqIndex(metric, true));
+    }
+
+    std::cerr << "Error: Unknown index type '" << type << "'" << std::endl;
+    std::cerr << "Available: hnsw, ivfpq, pq, opq, inverted" << std::endl;
+    return nullptr;
+}
+
+/**
+ * @brief Map a metric name to an index metric
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool AnnIndex::metricFromName(const std::string& metricName, AnnMetric& metric) {
+    std::string name = Utils::toLower(metricName);
+
+    if (name == "ssd") {
+        metric = AnnMetric::L2;
+        return true;
+    } else if (name == "cosine") {
+        metric = AnnMetric::Cosine;
+        return true;
+    } else if (name == "histogram" || name == "intersection") {
+        metric = AnnMetric::Intersection;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Index file next to the database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string AnnIndex::defaultPath(const std::string& databasePath, const std::string& type) {
+    std::string name = Utils::toLower(type);
+    if (name == "ivf-pq") {
+        name = "ivfpq";
+    }
+    return databasePath + "." + name;
+}
+
+/**
+ * @brief Saved index if usable, otherwise a fresh build (saved for next time)
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::unique_ptr<AnnIndex> AnnIndex::open(const std::string& type, AnnMetric metric,
+                                         const FeatureDatabase& database,
+                                         const std::string& databasePath, bool rebuild) {
+    std::unique_ptr<AnnIndex> index = create(type, metric);
+    if (!index) {
+        return nullptr;
+    }
+
+    const std::string indexPath = defaultPath(databasePath, type);
+    if (!rebuild && Utils::fileExists(indexPath)) {
+        std::cout << "Loading " << index->getIndexName() << " index: " << indexPath << std::endl;
+        if (index->load(indexPath) && index->attach(database) && index->metric() == metric) {
+            return index;
+        }
+        std::cout << "Saved index is unusable, rebuilding..." << std::endl;
+        index = create(type, metric);
+    }
+
+    std::cout << "Building " << index->getIndexName() << " index over "
+              << database.size() << " images..." << std::endl;
+    const int64 start = cv::getTickCount();
+    if (!index->build(database)) {
+        std::cerr << "Error: Failed to build ANN index" << std::endl;
+        return nullptr;
+    }
+    const double seconds = (cv::getTickCount() - start) / cv::getTickFrequency();
+    std::cout << "Index built in " << std::fixed << std::setprecision(2) << seconds << " s ("
+              << index->memoryBytes() / (1024 * 1024) << " MB)" << std::endl;
+
+    if (!index->save(indexPath)) {
+        std::cerr << "Warning: Could not save index to " << indexPath << std::endl;
+    }
+    return index;
+}
+
+/**
+ * @brief FNV-1a over count, dimension and every image name
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint64_t AnnIndex::databaseSignature(const FeatureDatabase& database) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t length) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    uint64_t count = database.size();
+    uint64_t dimension = static_cast<uint64_t>(database.dimension());
+    mix(&count, sizeof(count));
+    mix(&dimension, sizeof(dimension));
+    for (size_t row = 0; row < database.size(); row++) {
+        std::string name = database.getName(row);
+        mix(name.data(), name.size());
+        mix("\n", 1);
+    }
+    return hash;
+}
+
+/**
+ * @brief Flatten and validate a query
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool AnnIndex::prepareQuery(const cv::Mat& query, std::vector<float>& out) const {
+    if (query.empty() || static_cast<int>(query.total() * query.channels()) != dimension_) {
+        std::cerr << "Error: Query has " << query.total() * query.channels()
+                  << " features, index has " << dimension_ << std::endl;
+        return false;
+    }
+
+    cv::Mat continuous = query.isContinuous() ? query : query.clone();
+    cv::Mat row;
+    continuous.reshape(1, 1).convertTo(row, CV_32F);
+    out.assign(row.ptr<float>(), row.ptr<float>() + dimension_);
+    return true;
+}
+
+/**
+ * @brief Exact L2 / cosine distance
+ *
+ * @author Krushna Sanjay Sharma
+ */
+double AnnIndex::exactDistance(const float* a, double normA,
+                               const float* b, double normB) const {
+    if (metric_ == AnnMetric::L2) {
+        return DistanceKernels::squaredDifference(a, b, dimension_);
+    }
+
+    if (normA < 1e-10 || normB < 1e-10) {
+        return 1.0;
+    }
+    float dot = 0.0f;
+    float squares = 0.0f;
+    DistanceKernels::dotAndSquares(a, b, dimension_, &dot, &squares);
+    double cosine = dot / (normA * normB);
+    cosine = std::max(-1.0, std::min(1.0, cosine));
+    return 1.0 - cosine;
+}
+
+/**
+ * @brief L2 norm
+ *
+ * @author Krushna Sanjay Sharma
+ */
+double AnnIndex::vectorNorm(const float* values, int length) {
+    float dot = 0.0f;
+    float squares = 0.0f;
+    DistanceKernels::dotAndSquares(values, values, length, &dot, &squares);
+    return std::sqrt(static_cast<double>(squares));
+}
+
+/**
+ * @brief Nearest centroid by squared L2 distance
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int AnnIndex::nearestCentroid(const float* vector, const float* centroids,
+                              int count, int length) {
+    int best = 0;
+    float bestDistance = DistanceKernels::squaredDifference(vector, centroids, length);
+    for (int c = 1; c < count; c++) {
+        float distance = DistanceKernels::squaredDifference(
+            vector, centroids + static_cast<size_t>(c) * length, length);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = c;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief k-means centroids with cv::kmeans
+ *
+ * k-means++ seeding is used while its O(samples x k) cost is small, random
+ * seeding beyond that.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool AnnIndex::trainCentroids(const cv::Mat& samples, int k, cv::Mat& centers) {
+    if (samples.rows < k || k <= 0) {
+        std::cerr << "Error: " << samples.rows << " samples cannot train " << k
+                  << " centroids" << std::endl;
+        return false;
+    }
+
+    int flags = static_cast<double>(samples.rows) * k <= 5e7 ? cv::KMEANS_PP_CENTERS
+                                                             : cv::KMEANS_RANDOM_CENTERS;
+    cv::Mat labels;
+    cv::kmeans(samples, k, labels,
+               cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 1e-4),
+               1, flags, centers);
+
+    if (centers.rows != k || centers.type() != CV_32F) {
+        std::cerr << "Error: k-means training failed" << std::endl;
+        return false;
+    }
+    if (!centers.isContinuous()) {
+        centers = centers.clone();
+    }
+    return true;
+}
+
+} // namespace cbir
@@ -7,6 +7,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "BaselineFeature.h"
+#include "ImageContext.h"
 #include <iostream>
 
 namespace cbir {
@@ -45,6 +46,27 @@ BaselineFeature::BaselineFeature(int squareSize) : squareSize_(squareSize) {
  * @author Krushna Sanjay Sharma
  */
 cv::Mat BaselineFeature::extractFeatures(const cv::Mat& image) {
+    return extractFromRegion(image, image.size(), cv::Point());
+}
+
+/**
+ * @brief Extract the center square from a context
+ * 
+ * The builder may have decoded only the square's neighbourhood.
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat BaselineFeature::extractFromContext(ImageContext& context) {
+    return extractFromRegion(context.image(), context.fullSize(), context.offset());
+}
+
+/**
+ * @brief Flatten the center square of the whole image
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat BaselineFeature::extractFromRegion(const cv::Mat& image, const cv::Size& fullSize,
+                                           const cv::Point& offset) const {
     // Validate input image
     if (!isValidImage(image)) {
         std::cerr << "Error: Invalid image for feature extraction" << std::endl;
@@ -52,14 +74,14 @@ cv::Mat BaselineFeature::extractFeatures(const cv::Mat& image) {
     }
     
     // Check if image is large enough
-    if (image.rows < squareSize_ || image.cols < squareSize_) {
+    if (fullSize.height < squareSize_ || fullSize.width < squareSize_) {
         std::cerr << "Error: Image too small. Need at least " << squareSize_ 
                   << "x" << squareSize_ << " pixels" << std::endl;
         return cv::Mat();
     }
     
     // Extract center square
-    cv::Mat centerSquare = extractCenterSquare(image);
+    cv::Mat centerSquare = extractCenterSquare(image, fullSize, offset);
     
     if (centerSquare.empty()) {
         return cv::Mat();
@@ -128,23 +150,29 @@ void BaselineFeature::setSquareSize(int size) {
 /**
  * @brief Extract center square from image
  * 
- * Calculates the center position and extracts a square region of size
- * squareSize_ x squareSize_ from the image center.
+ * Calculates the center position of the whole image and extracts a
+ * square region of size squareSize_ x squareSize_ from there, shifted into
+ * the coordinates of the (possibly cropped) image.
  * 
  * @author Krushna Sanjay Sharma
  */
-cv::Mat BaselineFeature::extractCenterSquare(const cv::Mat& image) const {
+cv::Mat BaselineFeature::extractCenterSquare(const cv::Mat& image, const cv::Size& fullSize,
+                                             const cv::Point& offset) const {
     // Calculate center position
-    int centerRow = image.rows / 2;
-    int centerCol = image.cols / 2;
+    int centerRow = fullSize.height / 2;
+    int centerCol = fullSize.width / 2;
     
     // Calculate top-left corner of the square
     int halfSize = squareSize_ / 2;
-    int startRow = centerRow - halfSize;
-    int startCol = centerCol - halfSize;
+    int startRow = centerRow - halfSize - offset.y;
+    int startCol = centerCol - halfSize - offset.x;
     
     // Define region of interest (ROI)
     cv::Rect roi(startCol, startRow, squareSize_, squareSize_);
+    if ((roi & cv::Rect(0, 0, image.cols, image.rows)) != roi) {
+        std::cerr << "Error: Decoded region does not contain the center square" << std::endl;
+        return cv::Mat();
+    }
     
     // Extract and return the square region
     cv::Mat square = image(roi).clone();
@@ -0,0 +1,378 @@
+////////////////////////////////////////////////////////////////////////////////
+// BatchReader.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of batched whole-file reads (io_uring or
+//              reader threads).
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "BatchReader.h"
+#include "ObjectStore.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#ifdef CBIR_HAVE_LIBURING
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <liburing.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cbir {
+
+namespace {
+
+/// Reader threads of the fallback backend never exceed this
+const int MAX_READER_THREADS = 32;
+
+/// Fetch threads for object storage never exceed this
+const int MAX_FETCH_THREADS = 64;
+
+/**
+ * @brief Read a whole file with blocking calls
+ */
+bool readWholeFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::streamoff size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    bytes.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), size);
+    return static_cast<std::streamoff>(file.gcount()) == size;
+}
+
+#ifdef CBIR_HAVE_LIBURING
+/**
+ * @brief True if the kernel lets this process create an io_uring
+ *
+ * Checked once; containers and older kernels often refuse io_uring_setup.
+ */
+bool ringAvailable() {
+    static const bool available = [] {
+        struct io_uring ring;
+        if (io_uring_queue_init(2, &ring, 0) < 0) {
+            return false;
+        }
+        io_uring_queue_exit(&ring);
+        return true;
+    }();
+    return available;
+}
+
+/// One read in flight
+struct ReadSlot {
+    int fd = -1;
+    size_t done = 0;          ///< Bytes read so far
+    FileData file;
+};
+#endif
+
+} // namespace
+
+/**
+ * @brief Constructor - starts the ring thread or the reader threads
+ *
+ * @author Krushna Sanjay Sharma
+ */
+BatchReader::BatchReader(const std::vector<std::string>& files, int queueDepth,
+                         size_t memoryBudget)
+    : files_(files), queueDepth_(std::min(std::max(1, queueDepth), 4096)),
+      memoryBudget_(memoryBudget), backend_("threads"), nextFile_(0), stopped_(false),
+      bytesRead_(0), lastReadNs_(0), start_(std::chrono::steady_clock::now()),
+      queuedBytes_(0), producers_(0) {
+    if (files_.empty()) {
+        return;
+    }
+    if (ObjectStore::isUrl(files_.front())) {
+        backend_ = "http";
+        store_.reset(new ObjectStore());
+        producers_ = std::min({queueDepth_, MAX_FETCH_THREADS, static_cast<int>(files_.size())});
+        for (int t = 0; t < producers_; t++) {
+            threads_.emplace_back([this]() {
+                runThread();
+                finishProducer();
+            });
+        }
+        return;
+    }
+#ifdef CBIR_HAVE_LIBURING
+    if (ringAvailable()) {
+        backend_ = "io_uring";
+        producers_ = 1;
+        threads_.emplace_back([this]() {
+            if (!runRing()) {
+                runThread();    // ring refused after the probe: read serially
+            }
+            finishProducer();
+        });
+        return;
+    }
+#endif
+    producers_ = std::min({queueDepth_, MAX_READER_THREADS, static_cast<int>(files_.size())});
+    for (int t = 0; t < producers_; t++) {
+        threads_.emplace_back([this]() {
+            runThread();
+            finishProducer();
+        });
+    }
+}
+
+BatchReader::~BatchReader() {
+    stop();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Take the oldest finished file
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool BatchReader::next(FileData& file) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return !finished_.empty() || producers_ == 0 || stopped_; });
+    if (finished_.empty() || stopped_) {
+        return false;
+    }
+    file = std::move(finished_.front());
+    finished_.pop_front();
+    queuedBytes_ -= file.bytes.size();
+    space_.notify_all();
+    return true;
+}
+
+void BatchReader::recycle(std::vector<unsigned char>&& buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffer.capacity() > 0 && buffers_.size() < static_cast<size_t>(4 * queueDepth_)) {
+        buffers_.push_back(std::move(buffer));
+    }
+}
+
+void BatchReader::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    ready_.notify_all();
+    space_.notify_all();
+}
+
+double BatchReader::megabytesPerSecond() const {
+    const double seconds = lastReadNs_.load() / 1e9;
+    return seconds > 0.0 ? bytesRead_.load() / 1e6 / seconds : 0.0;
+}
+
+std::vector<unsigned char> BatchReader::takeBuffer(size_t size) {
+    std::vector<unsigned char> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!buffers_.empty()) {
+            buffer = std::move(buffers_.back());
+            buffers_.pop_back();
+        }
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+/**
+ * @brief Count the bytes and queue the file for next()
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void BatchReader::deliver(FileData&& file) {
+    bytesRead_ += file.bytes.size();
+    lastReadNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start_).count();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_.wait(lock, [&] {
+        const bool withinBudget = memoryBudget_ == 0 || finished_.empty() ||
+                                  queuedBytes_ + file.bytes.size() <= memoryBudget_;
+        return (finished_.size() < static_cast<size_t>(2 * queueDepth_) && withinBudget) ||
+               stopped_;
+    });
+    if (stopped_) {
+        return;
+    }
+    queuedBytes_ += file.bytes.size();
+    finished_.push_back(std::move(file));
+    ready_.notify_one();
+}
+
+void BatchReader::finishProducer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--producers_ == 0) {
+        ready_.notify_all();
+    }
+}
+
+/**
+ * @brief Blocking reads (or fetches) of the next unclaimed file until the
+ *        list is done
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void BatchReader::runThread() {
+    size_t index;
+    while (!stopped_ && (index = nextFile_++) < files_.size()) {
+        FileData file;
+        file.index = index;
+        file.bytes = takeBuffer(0);
+        if (store_) {
+            std::string error;
+            file.ok = store_->fetch(files_[index], file.bytes, &error);
+            if (!file.ok) {
+                std::cerr << "Error: Cannot fetch " << files_[index] << " (" << error << ")"
+                          << std::endl;
+            }
+        } else {
+            file.ok = readWholeFile(files_[index], file.bytes);
+        }
+        if (!file.ok) {
+            file.bytes.clear();
+        }
+        deliver(std::move(file));
+    }
+}
+
+/**
+ * @brief Keep queueDepth reads submitted and deliver each finished file
+ *
+ * Files are opened and sized here (cheap next to the read on a cold
+ * cache); only the reads go through the ring. Short reads are resubmitted
+ * for the remainder. After stop(), reads already submitted are still
+ * waited for, since the kernel writes into their buffers.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool BatchReader::runRing() {
+#ifdef CBIR_HAVE_LIBURING
+    struct io_uring ring;
+    if (io_uring_queue_init(static_cast<unsigned>(queueDepth_), &ring, 0) < 0) {
+        return false;
+    }
+
+    std::vector<ReadSlot> slots(queueDepth_);
+    std::vector<ReadSlot*> idle;
+    for (auto& slot : slots) {
+        idle.push_back(&slot);
+    }
+
+    auto submitRead = [&ring](ReadSlot* slot) {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        const size_t remaining = slot->file.bytes.size() - slot->done;
+        io_uring_prep_read(sqe, slot->fd, slot->file.bytes.data() + slot->done,
+                           static_cast<unsigned>(std::min<size_t>(remaining, INT_MAX)),
+                           slot->done);
+        io_uring_sqe_set_data(sqe, slot);
+    };
+    auto finish = [&](ReadSlot* slot, bool ok) {
+        close(slot->fd);
+        slot->fd = -1;
+        slot->file.ok = ok;
+        if (!ok) {
+            slot->file.bytes.clear();
+        }
+        deliver(std::move(slot->file));
+        slot->file = FileData();
+        idle.push_back(slot);
+    };
+
+    size_t inFlight = 0;
+    while (true) {
+        // Fill idle slots with new files
+        size_t index;
+        bool submitted = false;
+        while (!stopped_ && !idle.empty() && (index = nextFile_++) < files_.size()) {
+            FileData file;
+            file.index = index;
+            const int fd = open(files_[index].c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat info;
+            if (fd < 0 || fstat(fd, &info) != 0 || info.st_size <= 0) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+                deliver(std::move(file));
+                continue;
+            }
+
+            ReadSlot* slot = idle.back();
+            idle.pop_back();
+            slot->fd = fd;
+            slot->done = 0;
+            slot->file = std::move(file);
+            slot->file.bytes = takeBuffer(static_cast<size_t>(info.st_size));
+            submitRead(slot);
+            inFlight++;
+            submitted = true;
+        }
+        if (submitted) {
+            io_uring_submit(&ring);
+        }
+        if (inFlight == 0) {
+            break;
+        }
+
+        // Wait for one completion, then take all that are ready
+        struct io_uring_cqe* cqe;
+        int waited = io_uring_wait_cqe(&ring, &cqe);
+        if (waited == -EINTR) {
+            continue;
+        }
+        if (waited < 0) {
+            break;
+        }
+        bool resubmitted = false;
+        unsigned head;
+        unsigned seen = 0;
+        std::vector<std::pair<ReadSlot*, int>> completed;
+        io_uring_for_each_cqe(&ring, head, cqe) {
+            completed.emplace_back(static_cast<ReadSlot*>(io_uring_cqe_get_data(cqe)), cqe->res);
+            seen++;
+        }
+        io_uring_cq_advance(&ring, seen);
+
+        for (const auto& done : completed) {
+            ReadSlot* slot = done.first;
+            const int result = done.second;
+            if (result == -EINTR || result == -EAGAIN) {
+                submitRead(slot);
+                resubmitted = true;
+                continue;
+            }
+            if (result < 0) {
+                inFlight--;
+                finish(slot, false);
+                continue;
+            }
+            slot->done += static_cast<size_t>(result);
+            if (result > 0 && slot->done < slot->file.bytes.size()) {
+                submitRead(slot);        // short read: ask for the rest
+                resubmitted = true;
+                continue;
+            }
+            slot->file.bytes.resize(slot->done);    // file shrank since fstat
+            inFlight--;
+            finish(slot, slot->done > 0);
+        }
+        if (resubmitted) {
+            io_uring_submit(&ring);
+        }
+    }
+
+    io_uring_queue_exit(&ring);
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace cbir
@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////
+// CompositeExtractor.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of single-pass multi-feature extraction.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompositeExtractor.h"
+#include <algorithm>
+#include <iostream>
+
+namespace cbir {
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+CompositeExtractor::CompositeExtractor(const std::vector<FeatureExtractor*>& extractors)
+    : extractors_(extractors) {
+    extractors_.erase(std::remove(extractors_.begin(), extractors_.end(), nullptr),
+                      extractors_.end());
+    if (extractors_.size() != extractors.size()) {
+        std::cerr << "Warning: Ignoring null extractors in CompositeExtractor" << std::endl;
+    }
+}
+
+/**
+ * @brief Extract every member's features from one image
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool CompositeExtractor::extract(const cv::Mat& image, const std::string& filename,
+                                 std::vector<cv::Mat>& features) {
+    ImageContext context(image, filename);
+    return extract(context, features);
+}
+
+/**
+ * @brief Extract every member's features from a context
+ *
+ * A member that throws only loses its own vector; the others still run.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool CompositeExtractor::extract(ImageContext& context, std::vector<cv::Mat>& features) {
+    features.assign(extractors_.size(), cv::Mat());
+    bool complete = true;
+    for (size_t i = 0; i < extractors_.size(); i++) {
+        try {
+            features[i] = extractors_[i]->extractFromContext(context);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << context.filename() << " ("
+                      << extractors_[i]->getFeatureName() << "): " << e.what() << std::endl;
+            features[i] = cv::Mat();
+        }
+        complete = complete && !features[i].empty();
+    }
+    return complete;
+}
+
+/**
+ * @brief Extract every member's features from several contexts
+ *
+ * Batched members write into one matrix whose rows are then handed out per
+ * context; the rows stay views of it, as features from extract() may be
+ * views of context data.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int CompositeExtractor::extractBatch(const std::vector<ImageContext*>& contexts,
+                                     std::vector<std::vector<cv::Mat>>& features) {
+    features.assign(contexts.size(), std::vector<cv::Mat>(extractors_.size()));
+    
+    for (size_t m = 0; m < extractors_.size(); m++) {
+        FeatureExtractor* extractor = extractors_[m];
+        if (extractor->getPreferredBatchSize() > 1 && contexts.size() > 1) {
+            std::vector<cv::Mat> images;
+            images.reserve(contexts.size());
+            for (ImageContext* context : contexts) {
+                images.push_back(context->image());
+            }
+            cv::Mat rows;
+            std::vector<uchar> valid;
+            try {
+                extractor->extractBatch(images, rows, &valid);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: batch of " << contexts.size() << " ("
+                          << extractor->getFeatureName() << "): " << e.what() << std::endl;
+                continue;
+            }
+            for (size_t c = 0; c < contexts.size(); c++) {
+                if (valid[c]) {
+                    features[c][m] = rows.row(static_cast<int>(c));
+                }
+            }
+            continue;
+        }
+        
+        for (size_t c = 0; c < contexts.size(); c++) {
+            try {
+                features[c][m] = extractor->extractFromContext(*contexts[c]);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: " << contexts[c]->filename() << " ("
+                          << extractor->getFeatureName() << "): " << e.what() << std::endl;
+                features[c][m] = cv::Mat();
+            }
+        }
+    }
+    
+    int complete = 0;
+    for (const std::vector<cv::Mat>& perContext : features) {
+        bool all = true;
+        for (const cv::Mat& f : perContext) {
+            all = all && !f.empty();
+        }
+        complete += all ? 1 : 0;
+    }
+    return complete;
+}
+
+/**
+ * @brief Largest of the members' preferred batch sizes
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int CompositeExtractor::getPreferredBatchSize() const {
+    int batch = 1;
+    for (FeatureExtractor* extractor : extractors_) {
+        batch = std::max(batch, extractor->getPreferredBatchSize());
+    }
+    return batch;
+}
+
+/**
+ * @brief Smallest of the members' decode reductions
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int CompositeExtractor::getMaxDecodeReduction() const {
+    int reduction = 8;
+    for (FeatureExtractor* extractor : extractors_) {
+        reduction = std::min(reduction, extractor->getMaxDecodeReduction());
+    }
+    return extractors_.empty() ? 1 : reduction;
+}
+
+/**
+ * @brief Side limit every member tolerates
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int CompositeExtractor::getMinImageSide() const {
+    int side = 0;
+    for (FeatureExtractor* extractor : extractors_) {
+        const int minimum = extractor->getMinImageSide();
+        if (minimum <= 0) {
+            return 0;
+        }
+        side = std::max(side, minimum);
+    }
+    return side;
+}
+
+/**
+ * @brief Region covering every member's region
+ *
+ * @author Krushna Sanjay Sharma
+ */
+DecodeRegion CompositeExtractor::getDecodeRegion() const {
+    if (extractors_.empty()) {
+        return DecodeRegion();
+    }
+    DecodeRegion region = DecodeRegion::centred(0.0);
+    for (FeatureExtractor* extractor : extractors_) {
+        region = region.merge(extractor->getDecodeRegion());
+    }
+    return region;
+}
+
+} // namespace cbir
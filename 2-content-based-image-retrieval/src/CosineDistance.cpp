@@ -22,11 +22,47 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CosineDistance.h"
+#include "DistanceKernels.h"
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace cbir {
 
+namespace {
+
+/**
+ * Cosine distance from a dot product and both norms; zero vectors are
+ * treated as maximally dissimilar
+ */
+double distanceFromNorms(float dot, double queryNorm, double rowNorm) {
+    if (queryNorm < 1e-10 || rowNorm < 1e-10) {
+        return 1.0;
+    }
+    double cosine = dot / (queryNorm * rowNorm);
+    cosine = std::max(-1.0, std::min(1.0, cosine));
+    return 1.0 - cosine;
+}
+
+/**
+ * Cosine distance from a dot product, the query norm and the row's squared
+ * norm
+ */
+double distanceFromDot(float dot, double queryNorm, float rowSquares) {
+    return distanceFromNorms(dot, queryNorm, std::sqrt(static_cast<double>(rowSquares)));
+}
+
+/**
+ * Check that rowNorms holds one CV_64F norm per matrix row
+ */
+bool normsMatch(const cv::Mat& rowNorms, const cv::Mat& matrix) {
+    return rowNorms.type() == CV_64F && rowNorms.total() == static_cast<size_t>(matrix.rows) &&
+           rowNorms.isContinuous();
+}
+
+} // namespace
+
 /**
  * Compute cosine distance between two feature vectors
  * 
@@ -85,6 +121,172 @@ double CosineDistance::compute(const cv::Mat& features1,
     return distance;
 }
 
+/**
+ * Cosine distance from a query to every row of a feature matrix
+ * 
+ * Matches compute(): zero vectors give 1.0 (without the per-row warning)
+ * and the cosine is clamped to [-1, 1].
+ * 
+ * @param query Query feature vector
+ * @param matrix Feature matrix, one vector per row
+ * @param out Output distances, matrix.rows x 1 CV_64F
+ * @return True if successful
+ */
+bool CosineDistance::computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                                  cv::Mat& out) {
+    if (query.empty()) {
+        std::cerr << "Error: Empty query for cosine distance" << std::endl;
+        return false;
+    }
+    const double queryNorm = computeL2Norm(query);
+
+    auto cosineDistance = [queryNorm](float dot, float rowSquares) {
+        return distanceFromDot(dot, queryNorm, rowSquares);
+    };
+
+    return runBatch(query, matrix, out,
+                    [&cosineDistance](const float* queryData, const float* rowData, int length) {
+        float dot = 0.0f;
+        float rowSquares = 0.0f;
+        DistanceKernels::dotAndSquares(queryData, rowData, length, &dot, &rowSquares);
+        return cosineDistance(dot, rowSquares);
+    },
+                    [&cosineDistance](const float* queryData, const uint8_t* codes, float scale,
+                                      int length) {
+        float dot = 0.0f;
+        float rowSquares = 0.0f;
+        DistanceKernels::dotAndSquaresQuantized(queryData, codes, length, scale,
+                                                &dot, &rowSquares);
+        return cosineDistance(dot, rowSquares);
+    });
+}
+
+/**
+ * Cosine distance with pre-computed row norms
+ * 
+ * Each row costs a single dot product; the results equal computeBatch()'s
+ * because FeatureDatabase::rowNorms() uses the same squared-norm kernels.
+ * Falls back to computeBatch() if rowNorms does not match the matrix.
+ * 
+ * @param query Query feature vector
+ * @param matrix Feature matrix, one vector per row
+ * @param rowNorms matrix.rows x 1 CV_64F row norms
+ * @param out Output distances, matrix.rows x 1 CV_64F
+ * @return True if successful
+ */
+bool CosineDistance::computeBatchNormed(const cv::Mat& query, const cv::Mat& matrix,
+                                        const cv::Mat& rowNorms, cv::Mat& out) {
+    if (!normsMatch(rowNorms, matrix)) {
+        return computeBatch(query, matrix, out);
+    }
+    if (!checkBatch(query, matrix)) {
+        return false;
+    }
+
+    cv::Mat queryData = query.isContinuous() ? query : query.clone();
+    const float* queryPtr = queryData.ptr<float>();
+    const double queryNorm = computeL2Norm(queryData);
+    const double* norms = rowNorms.ptr<double>();
+    const int length = matrix.cols;
+
+    out.create(matrix.rows, 1, CV_64F);
+    double* distances = out.ptr<double>();
+
+    if (matrix.type() == CV_32F) {
+        for (int row = 0; row < matrix.rows; row++) {
+            const float dot = DistanceKernels::dot(queryPtr, matrix.ptr<float>(row), length);
+            distances[row] = distanceFromNorms(dot, queryNorm, norms[row]);
+        }
+        return true;
+    }
+
+    if (matrix.type() == CV_8U) {
+        for (int row = 0; row < matrix.rows; row++) {
+            const uint8_t* codes = matrix.ptr<uint8_t>(row);
+            const float dot = DistanceKernels::dotQuantized(
+                queryPtr, codes, length, quantizedRowScale(codes, length));
+            distances[row] = distanceFromNorms(dot, queryNorm, norms[row]);
+        }
+        return true;
+    }
+
+    cv::Mat staging;
+    for (int start = 0; start < matrix.rows; start += STAGING_ROWS) {
+        const int end = std::min(matrix.rows, start + STAGING_ROWS);
+        widenRows(matrix, start, end, staging);
+        for (int row = start; row < end; row++) {
+            const float dot = DistanceKernels::dot(queryPtr, staging.ptr<float>(row - start),
+                                                   length);
+            distances[row] = distanceFromNorms(dot, queryNorm, norms[row]);
+        }
+    }
+    return true;
+}
+
+/**
+ * Block cosine distance through one matrix product
+ * 
+ * @param queries Query feature vectors, one per row (CV_32F)
+ * @param matrix Feature matrix, one vector per row
+ * @param out Output distances, queries.rows x matrix.rows CV_64F
+ * @return True if successful
+ */
+bool CosineDistance::computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                                  cv::Mat& out) {
+    return computeBlockNormed(queries, matrix, cv::Mat(), out);
+}
+
+/**
+ * Block cosine distance with pre-computed row norms
+ * 
+ * Row norms are computed here only when rowNorms does not match matrix.
+ * 
+ * @param queries Query feature vectors, one per row (CV_32F)
+ * @param matrix Feature matrix, one vector per row
+ * @param rowNorms matrix.rows x 1 CV_64F row norms, or empty
+ * @param out Output distances, queries.rows x matrix.rows CV_64F
+ * @return True if successful
+ */
+bool CosineDistance::computeBlockNormed(const cv::Mat& queries, const cv::Mat& matrix,
+                                        const cv::Mat& rowNorms, cv::Mat& out) {
+    if (!checkBlock(queries, matrix)) {
+        return false;
+    }
+
+    cv::Mat staging;
+    const cv::Mat rows = floatRows(matrix, staging);
+
+    cv::Mat dots;
+    cv::gemm(queries, rows, 1.0, cv::noArray(), 0.0, dots, cv::GEMM_2_T);
+
+    std::vector<double> computedNorms;
+    const double* norms = nullptr;
+    if (normsMatch(rowNorms, matrix)) {
+        norms = rowNorms.ptr<double>();
+    } else {
+        computedNorms.resize(rows.rows);
+        for (int row = 0; row < rows.rows; row++) {
+            float dot = 0.0f;
+            float rowSquares = 0.0f;
+            DistanceKernels::dotAndSquares(rows.ptr<float>(row), rows.ptr<float>(row), rows.cols,
+                                           &dot, &rowSquares);
+            computedNorms[row] = std::sqrt(static_cast<double>(rowSquares));
+        }
+        norms = computedNorms.data();
+    }
+
+    out.create(queries.rows, rows.rows, CV_64F);
+    for (int q = 0; q < queries.rows; q++) {
+        const double queryNorm = computeL2Norm(queries.row(q));
+        const float* queryDots = dots.ptr<float>(q);
+        double* distances = out.ptr<double>(q);
+        for (int row = 0; row < rows.rows; row++) {
+            distances[row] = distanceFromNorms(queryDots[row], queryNorm, norms[row]);
+        }
+    }
+    return true;
+}
+
 std::string CosineDistance::getMetricName() const {
     return "CosineDistance";
 }
@@ -6,20 +6,60 @@
 //
 // This is different from other feature extractors because:
 //   - Features are pre-computed (no image processing needed)
-//   - Features are loaded from CSV file at initialization
+//   - Features are loaded from CSV file at initialization (via the shared,
+//     memory-mapped EmbeddingStore)
 //   - extractFeatures() performs lookup, not computation
 //
+// Unless an ONNX model is loaded: then extractFeatures() runs it through
+// the shared cvcore InferenceService (ONNX Runtime builds only).
+//
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "DNNFeature.h"
-#include "Utils.h"
+#include <algorithm>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#ifdef USE_ONNXRUNTIME
+#include <cvcore/inference.hpp>
+#endif
 
 namespace cbir {
 
+#ifdef USE_ONNXRUNTIME
+namespace {
+
+/// Network input side and ImageNet normalisation
+const int INPUT_SIZE = 224;
+const float MEAN[3] = {0.485f, 0.456f, 0.406f};   ///< R, G, B
+const float STD[3] = {0.229f, 0.224f, 0.225f};
+
+/// Resize and normalise a BGR image into a planar RGB input
+std::vector<float> toInput(const cv::Mat& image) {
+    cv::Mat color = image;
+    if (image.channels() == 1) {
+        cv::cvtColor(image, color, cv::COLOR_GRAY2BGR);
+    }
+    cv::Mat resized;
+    cv::resize(color, resized, cv::Size(INPUT_SIZE, INPUT_SIZE), 0, 0, cv::INTER_LINEAR);
+    
+    const size_t plane = static_cast<size_t>(INPUT_SIZE) * INPUT_SIZE;
+    std::vector<float> input(3 * plane);
+    for (int y = 0; y < INPUT_SIZE; y++) {
+        const uchar* px = resized.ptr<uchar>(y);
+        for (int x = 0; x < INPUT_SIZE; x++, px += 3) {
+            const size_t i = static_cast<size_t>(y) * INPUT_SIZE + x;
+            for (int c = 0; c < 3; c++) {
+                // Planes are R, G, B; the pixel is B, G, R
+                input[c * plane + i] = (px[2 - c] / 255.0f - MEAN[c]) / STD[c];
+            }
+        }
+    }
+    return input;
+}
+
+} // namespace
+#endif
+
 /**
  * Constructor
  * 
@@ -37,15 +77,82 @@ DNNFeature::DNNFeature(const std::string& csvPath)
 /**
  * Extract features from image
  * 
- * For DNN features, we don't compute from image.
- * This returns empty Mat. Use getFeaturesByFilename() instead.
+ * With a model, the image is queued on the shared service and joins the
+ * next batch; the call blocks until its embedding is back. Without one,
+ * features are pre-computed: this returns an empty Mat, use
+ * getFeaturesByFilename() instead.
  */
 cv::Mat DNNFeature::extractFeatures(const cv::Mat& image) {
+#ifdef USE_ONNXRUNTIME
+    if (service_ && isValidImage(image)) {
+        try {
+            std::vector<float> embedding = service_->infer(toInput(image));
+            return cv::Mat(1, static_cast<int>(embedding.size()), CV_32F,
+                           embedding.data()).clone();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: DNN inference failed: " << e.what() << std::endl;
+            return cv::Mat();
+        }
+    }
+#endif
     std::cerr << "Warning: DNNFeature::extractFeatures() not supported." << std::endl;
     std::cerr << "DNN features are pre-computed. Use getFeaturesByFilename() instead." << std::endl;
     return cv::Mat();
 }
 
+/**
+ * Extract a batch of images through the model
+ * 
+ * Submits all samples first, then collects the futures: the service sees
+ * the whole batch at once and runs it in ceil(n / maxBatch) passes.
+ */
+int DNNFeature::extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                             std::vector<uchar>* valid) {
+    const int dimension = getFeatureDimension();
+    out.create(static_cast<int>(images.size()), dimension, CV_32F);
+    out.setTo(cv::Scalar::all(0));
+    if (valid != nullptr) {
+        valid->assign(images.size(), 0);
+    }
+    
+#ifdef USE_ONNXRUNTIME
+    if (service_) {
+        std::vector<std::future<std::vector<float>>> pending(images.size());
+        for (size_t i = 0; i < images.size(); i++) {
+            if (isValidImage(images[i])) {
+                pending[i] = service_->submit(toInput(images[i]));
+            }
+        }
+        
+        int extracted = 0;
+        for (size_t i = 0; i < images.size(); i++) {
+            if (!pending[i].valid()) {
+                continue;
+            }
+            try {
+                std::vector<float> embedding = pending[i].get();
+                if (static_cast<int>(embedding.size()) != dimension) {
+                    continue;
+                }
+                cv::Mat(1, dimension, CV_32F, embedding.data()).copyTo(out.row(static_cast<int>(i)));
+            } catch (const std::exception& e) {
+                std::cerr << "Error: DNN inference failed: " << e.what() << std::endl;
+                continue;
+            }
+            if (valid != nullptr) {
+                (*valid)[i] = 1;
+            }
+            extracted++;
+        }
+        return extracted;
+    }
+#endif
+    if (!images.empty()) {
+        std::cerr << "Warning: DNNFeature::extractBatch() needs a model (loadModel())." << std::endl;
+    }
+    return 0;
+}
+
 /**
  * Get pre-computed features by filename
  * 
@@ -53,14 +160,11 @@ cv::Mat DNNFeature::extractFeatures(const cv::Mat& image) {
  * @return 512-dimensional DNN feature vector, empty if not found
  */
 cv::Mat DNNFeature::getFeaturesByFilename(const std::string& filename) const {
-    // Normalize filename for lookup
-    std::string normalizedName = normalizeFilename(filename);
-    
-    // Search in loaded features
-    auto it = features_.find(normalizedName);
+    // Hash lookup in the shared store (the directory part is ignored)
+    cv::Mat features = store_ ? store_->lookup(filename) : cv::Mat();
     
-    if (it != features_.end()) {
-        return it->second;
+    if (!features.empty()) {
+        return features;
     }
     
     // Not found
@@ -68,6 +172,37 @@ cv::Mat DNNFeature::getFeaturesByFilename(const std::string& filename) const {
     return cv::Mat();
 }
 
+/**
+ * Load an ONNX model for native extraction
+ * 
+ * One pooled session is shared by all extractors on the model; requests
+ * from up to maxBatch threads that arrive within a few milliseconds run
+ * as one batch.
+ */
+bool DNNFeature::loadModel(const std::string& onnxPath, int maxBatch) {
+#ifdef USE_ONNXRUNTIME
+    cvcore::InferenceOptions options;
+    options.maxBatch = std::max(1, maxBatch);
+    service_ = cvcore::InferenceService::shared(onnxPath, {3, INPUT_SIZE, INPUT_SIZE}, options);
+    maxBatch_ = options.maxBatch;
+    return service_ != nullptr;
+#else
+    std::cerr << "Error: Built without ONNX Runtime, cannot load " << onnxPath << std::endl;
+    return false;
+#endif
+}
+
+/**
+ * Warm up the model's sessions (provider setup, first-run autotuning)
+ */
+bool DNNFeature::warmup() {
+#ifdef USE_ONNXRUNTIME
+    return service_ && service_->warmup();
+#else
+    return false;
+#endif
+}
+
 std::string DNNFeature::getFeatureName() const {
     return "DNNEmbedding_ResNet18";
 }
@@ -83,84 +218,30 @@ int DNNFeature::getFeatureDimension() const {
  *   filename,feature1,feature2,...,feature512
  *   pic.0001.jpg,0.123,0.456,...,0.789
  * 
+ * The rows are served by the shared EmbeddingStore: extractors opened on
+ * the same CSV reuse one memory-mapped copy instead of each parsing it.
+ * 
  * @param csvPath Path to CSV file
  * @return True if successful
  */
 bool DNNFeature::loadFeaturesFromCSV(const std::string& csvPath) {
     std::cout << "Loading DNN features from: " << csvPath << std::endl;
     
-    // Clear existing features
-    features_.clear();
     csvPath_ = csvPath;
-    
-    // Open CSV file
-    std::ifstream file(csvPath);
-    if (!file.is_open()) {
+    store_ = EmbeddingStore::open(csvPath);
+    if (!store_) {
         std::cerr << "Error: Cannot open DNN features CSV: " << csvPath << std::endl;
         return false;
     }
     
-    std::string line;
-    int lineNum = 0;
-    
-    // Read file line by line
-    while (std::getline(file, line)) {
-        lineNum++;
-        
-        // Skip header (first line)
-        if (lineNum == 1) {
-            continue;
-        }
-        
-        // Skip empty lines
-        if (line.empty() || Utils::trim(line).empty()) {
-            continue;
-        }
-        
-        // Parse line
-        std::vector<std::string> tokens = Utils::split(line, ',');
-        
-        // Expect: filename + 512 feature values = 513 tokens
-        if (tokens.size() < 513) {
-            std::cerr << "Warning: Line " << lineNum << " has only " 
-                      << tokens.size() << " tokens (expected 513)" << std::endl;
-            continue;
-        }
-        
-        // First token is filename
-        std::string filename = Utils::trim(tokens[0]);
-        
-        // Remaining 512 tokens are feature values
-        cv::Mat featureVec(1, 512, CV_32F);
-        
-        for (int i = 0; i < 512; i++) {
-            try {
-                featureVec.at<float>(0, i) = std::stof(Utils::trim(tokens[i + 1]));
-            } catch (const std::exception& e) {
-                std::cerr << "Warning: Invalid feature value at line " << lineNum 
-                          << ", column " << (i + 1) << std::endl;
-                continue;
-            }
-        }
-        
-        // Store in map
-        features_[normalizeFilename(filename)] = featureVec;
+    if (store_->dimension() != getFeatureDimension()) {
+        std::cerr << "Warning: DNN features are " << store_->dimension()
+                  << "-dimensional (expected " << getFeatureDimension() << ")" << std::endl;
     }
     
-    file.close();
+    std::cout << "Loaded " << store_->size() << " DNN feature vectors" << std::endl;
     
-    std::cout << "Loaded " << features_.size() << " DNN feature vectors" << std::endl;
-    
-    return !features_.empty();
-}
-
-/**
- * Normalize filename for consistent lookup
- * 
- * Extracts just the filename from full path
- */
-std::string DNNFeature::normalizeFilename(const std::string& filename) const {
-    return Utils::getFilename(filename);
+    return store_->size() > 0;
 }
 
 } // namespace cbir
@@ -0,0 +1,627 @@
+////////////////////////////////////////////////////////////////////////////////
+// DatabaseBuilder.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the pipelined, checkpointed database builder.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DatabaseBuilder.h"
+#include "BatchReader.h"
+#include "ImageContext.h"
+#include "ObjectStore.h"
+#include "ThumbnailAtlas.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace cbir {
+
+namespace {
+
+/// First line of every checkpoint file
+const char* const CHECKPOINT_TAG = "#checkpoint,";
+
+/**
+ * @brief Blocking FIFO with a capacity, closed by the last producer
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(1, capacity)) {}
+
+    /// Block while full; false if the queue was closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    /// Block while empty; false once closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    /// Take the front item without waiting; false if there is none
+    bool tryPop(T& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_ = false;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+/// One image moving through the pipeline
+struct WorkItem {
+    size_t order = 0;        ///< Position in the pending list
+    std::string filename;    ///< Filename without directory
+    cv::Mat image;           ///< Decoded image (empty on load failure)
+    cv::Size fullSize;       ///< Whole image size (image may be a centred crop)
+    cv::Point offset;        ///< Position of image within the whole image
+    std::vector<cv::Mat> features;  ///< One vector per database (empty on failure)
+};
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+DatabaseBuilder::DatabaseBuilder(const BuildOptions& options)
+    : options_(options), successCount_(0), failCount_(0), resumedCount_(0),
+      imagesPerSecond_(0.0), readMegabytesPerSecond_(0.0) {
+    options_.decoderThreads = std::max(1, options_.decoderThreads);
+    options_.readQueueDepth = std::max(0, options_.readQueueDepth);
+    options_.queueDepth = std::max(1, options_.queueDepth);
+    options_.checkpointInterval = std::max(1, options_.checkpointInterval);
+    options_.progressInterval = std::max(1, options_.progressInterval);
+}
+
+/**
+ * @brief Extract features, passing the filename where required
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DatabaseBuilder::extractFeatures(FeatureExtractor* extractor, const cv::Mat& image,
+                                         const std::string& filename) {
+    ImageContext context(image, filename);
+    return extractor->extractFromContext(context);
+}
+
+/**
+ * @brief Decode as small as every extractor allows
+ *
+ * @author Krushna Sanjay Sharma
+ */
+DecodePolicy DatabaseBuilder::negotiatePolicy(const BuildOptions& options,
+                                              const std::vector<CompositeExtractor*>& workers) {
+    int reduction = std::max(1, options.decodeReduction);
+    int maxSide = std::max(0, options.maxImageSide);
+    for (CompositeExtractor* worker : workers) {
+        reduction = std::min(reduction, worker->getMaxDecodeReduction());
+        const int minimum = worker->getMinImageSide();
+        maxSide = minimum <= 0 ? 0 : maxSide > 0 ? std::max(maxSide, minimum) : 0;
+    }
+    return DecodePolicy::make(reduction, maxSide);
+}
+
+/**
+ * @brief Union of the workers' regions
+ *
+ * @author Krushna Sanjay Sharma
+ */
+DecodeRegion DatabaseBuilder::negotiateRegion(const BuildOptions& options,
+                                              const std::vector<CompositeExtractor*>& workers) {
+    if (!options.regionDecode || options.thumbnails != nullptr || workers.empty()) {
+        return DecodeRegion();
+    }
+    DecodeRegion region = DecodeRegion::centred(0.0);
+    for (CompositeExtractor* worker : workers) {
+        region = region.merge(worker->getDecodeRegion());
+    }
+    return region;
+}
+
+/**
+ * @brief Restore rows from the checkpoint file
+ *
+ * Reads complete lines only. A line without a trailing newline, or with the
+ * wrong number of values, marks where the previous run was interrupted; the
+ * file is truncated there so new rows append cleanly.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DatabaseBuilder::resumeCheckpoint(const std::string& path, const std::string& featureName,
+                                       FeatureDatabase& database) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || file.eof()) {
+        // Header never completed: nothing to resume
+        file.close();
+        std::remove(path.c_str());
+        return true;
+    }
+    if (line != CHECKPOINT_TAG + featureName) {
+        std::cerr << "Error: Checkpoint " << path
+                  << " was written by a different feature type ("
+                  << line.substr(std::min(line.size(), std::string(CHECKPOINT_TAG).size()))
+                  << ")" << std::endl;
+        std::cerr << "Delete it to start over" << std::endl;
+        return false;
+    }
+
+    std::streamoff validEnd = file.tellg();
+    std::vector<float> values;
+    int dimension = 0;
+    int resumed = 0;
+    while (std::getline(file, line)) {
+        if (file.eof()) {
+            break;  // torn last line
+        }
+
+        size_t comma = line.find(',');
+        if (comma == std::string::npos || comma == 0) {
+            break;
+        }
+        values.clear();
+        const char* cursor = line.c_str() + comma;
+        while (*cursor == ',') {
+            char* end = nullptr;
+            values.push_back(std::strtof(cursor + 1, &end));
+            if (end == cursor + 1) {
+                values.clear();
+                break;
+            }
+            cursor = end;
+        }
+        if (values.empty() || *cursor != '\0' ||
+            (dimension > 0 && static_cast<int>(values.size()) != dimension)) {
+            break;
+        }
+        dimension = static_cast<int>(values.size());
+
+        cv::Mat row(1, dimension, CV_32F, values.data());
+        if (!database.addFeatures(line.substr(0, comma), row)) {
+            break;
+        }
+        resumed++;
+        validEnd = file.tellg();
+    }
+    file.close();
+
+    std::error_code error;
+    std::filesystem::resize_file(path, static_cast<uintmax_t>(validEnd), error);
+    if (error) {
+        std::cerr << "Error: Cannot truncate checkpoint " << path
+                  << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    if (resumed > 0) {
+        std::cout << "Resuming from checkpoint " << path << ": " << resumed
+                  << " images already extracted" << std::endl;
+    }
+    return true;
+}
+
+/**
+ * @brief Build one database with one extractor per worker
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DatabaseBuilder::build(const std::vector<std::string>& imageFiles,
+                            const std::vector<FeatureExtractor*>& extractors,
+                            FeatureDatabase& database) {
+    if (extractors.empty() ||
+        std::find(extractors.begin(), extractors.end(), nullptr) != extractors.end()) {
+        std::cerr << "Error: Feature extractor is null" << std::endl;
+        return false;
+    }
+
+    std::vector<CompositeExtractor> composites;
+    composites.reserve(extractors.size());
+    std::vector<CompositeExtractor*> workers;
+    for (FeatureExtractor* extractor : extractors) {
+        composites.emplace_back(std::vector<FeatureExtractor*>{extractor});
+        workers.push_back(&composites.back());
+    }
+
+    std::vector<std::string> checkpoints;
+    if (!options_.checkpointPath.empty()) {
+        checkpoints.push_back(options_.checkpointPath);
+    }
+    return run(imageFiles, workers, {&database}, checkpoints);
+}
+
+/**
+ * @brief Build one database per composite member
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DatabaseBuilder::build(const std::vector<std::string>& imageFiles,
+                            const std::vector<CompositeExtractor*>& workers,
+                            const std::vector<FeatureDatabase*>& databases) {
+    if (!options_.checkpointPaths.empty() &&
+        options_.checkpointPaths.size() != databases.size()) {
+        std::cerr << "Error: Need one checkpoint path per database" << std::endl;
+        return false;
+    }
+    return run(imageFiles, workers, databases, options_.checkpointPaths);
+}
+
+/**
+ * @brief Run the decode / extract / write pipeline
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DatabaseBuilder::run(const std::vector<std::string>& imageFiles,
+                          const std::vector<CompositeExtractor*>& workers,
+                          const std::vector<FeatureDatabase*>& databases,
+                          const std::vector<std::string>& checkpoints) {
+    successCount_ = 0;
+    failCount_ = 0;
+    resumedCount_ = 0;
+    imagesPerSecond_ = 0.0;
+    readMegabytesPerSecond_ = 0.0;
+
+    if (workers.empty() || databases.empty() ||
+        std::find(workers.begin(), workers.end(), nullptr) != workers.end() ||
+        std::find(databases.begin(), databases.end(), nullptr) != databases.end()) {
+        std::cerr << "Error: Feature extractor or database is null" << std::endl;
+        return false;
+    }
+    for (CompositeExtractor* worker : workers) {
+        if (worker->size() != databases.size()) {
+            std::cerr << "Error: Every worker needs one extractor per database ("
+                      << databases.size() << ")" << std::endl;
+            return false;
+        }
+    }
+
+    const size_t databaseCount = databases.size();
+    const bool checkpointing = !checkpoints.empty();
+    std::vector<std::string> featureNames;
+    for (size_t k = 0; k < databaseCount; k++) {
+        featureNames.push_back(workers.front()->getExtractor(k)->getFeatureName());
+        databases[k]->clear();
+        if (checkpointing && !resumeCheckpoint(checkpoints[k], featureNames[k], *databases[k])) {
+            return false;
+        }
+    }
+
+    // Images still missing from some database, in input order
+    std::vector<std::string> pending;
+    pending.reserve(imageFiles.size());
+    for (const auto& imagePath : imageFiles) {
+        bool done = true;
+        for (FeatureDatabase* database : databases) {
+            done = done && database->indexOf(imagePath) >= 0;
+        }
+        if (!done) {
+            pending.push_back(imagePath);
+        }
+    }
+    resumedCount_ = static_cast<int>(imageFiles.size() - pending.size());
+
+    const DecodePolicy policy = negotiatePolicy(options_, workers);
+    const DecodeRegion region = negotiateRegion(options_, workers);
+    for (FeatureDatabase* database : databases) {
+        database->setDecodePolicy(policy);
+    }
+
+    std::cout << "Extracting " << pending.size() << " images with "
+              << options_.decoderThreads << " decoder(s), " << workers.size()
+              << " extractor(s)";
+    if (options_.readQueueDepth > 0) {
+        std::cout << ", " << options_.readQueueDepth << " reads in flight";
+    }
+    if (databaseCount > 1) {
+        std::cout << ", " << databaseCount << " feature types per image";
+    }
+    if (!policy.isFullResolution()) {
+        std::cout << ", " << policy.describe();
+    }
+    if (!region.isWholeImage()) {
+        std::cout << ", centre-region decode";
+    }
+    std::cout << "..." << std::endl;
+
+    std::vector<std::ofstream> checkpointFiles(checkpointing ? databaseCount : 0);
+    for (size_t k = 0; k < checkpointFiles.size(); k++) {
+        bool fresh = !Utils::fileExists(checkpoints[k]);
+        checkpointFiles[k].open(checkpoints[k], std::ios::binary | std::ios::app);
+        if (!checkpointFiles[k].is_open()) {
+            std::cerr << "Error: Cannot write checkpoint " << checkpoints[k] << std::endl;
+            return false;
+        }
+        if (fresh) {
+            checkpointFiles[k] << CHECKPOINT_TAG << featureNames[k] << "\n";
+        }
+        checkpointFiles[k] << std::setprecision(9);
+    }
+
+    const size_t queueDepth = static_cast<size_t>(options_.queueDepth) * workers.size();
+    BoundedQueue<WorkItem> decoded(queueDepth);
+    BoundedQueue<WorkItem> extracted(queueDepth);
+
+    // Stage 0: batched file reads; stage 1: decoders
+    std::unique_ptr<BatchReader> reader;
+    if (!pending.empty() && ObjectStore::isUrl(pending.front())) {
+        reader.reset(new BatchReader(pending, std::max(1, options_.readQueueDepth),
+                                     options_.prefetchBytes));
+    } else if (!pending.empty() && options_.readQueueDepth > 0) {
+        reader.reset(new BatchReader(pending, options_.readQueueDepth, options_.prefetchBytes));
+    }
+    std::atomic<size_t> nextImage(0);
+    std::atomic<int> decodersLeft(options_.decoderThreads);
+    std::vector<std::thread> threads;
+    for (int d = 0; d < options_.decoderThreads; d++) {
+        threads.emplace_back([&]() {
+            if (reader) {
+                FileData file;
+                while (reader->next(file)) {
+                    WorkItem item;
+                    item.order = file.index;
+                    item.filename = Utils::getFilename(pending[file.index]);
+                    item.image = policy.decodeRegion(file.bytes, region, item.fullSize,
+                                                     item.offset);
+                    reader->recycle(std::move(file.bytes));
+                    if (item.image.empty()) {
+                        std::cerr << "Error: Cannot load image " << pending[file.index]
+                                  << std::endl;
+                    }
+                    if (!decoded.push(std::move(item))) {
+                        reader->stop();
+                        break;
+                    }
+                }
+            } else {
+                size_t order;
+                while ((order = nextImage++) < pending.size()) {
+                    WorkItem item;
+                    item.order = order;
+                    item.filename = Utils::getFilename(pending[order]);
+                    item.image = policy.loadRegion(pending[order], region, item.fullSize,
+                                                   item.offset);
+                    if (!decoded.push(std::move(item))) {
+                        break;
+                    }
+                }
+            }
+            if (--decodersLeft == 0) {
+                decoded.close();
+            }
+        });
+    }
+
+    // Stage 2: one composite per worker, one shared context per image.
+    // Workers whose extractors batch take whatever else is already decoded
+    // (up to the preferred batch size) and extract it in one call
+    std::atomic<int> workersLeft(static_cast<int>(workers.size()));
+    for (CompositeExtractor* worker : workers) {
+        threads.emplace_back([&, worker]() {
+            const size_t batchSize = static_cast<size_t>(worker->getPreferredBatchSize());
+            std::vector<WorkItem> batch;
+            WorkItem item;
+            while (decoded.pop(item)) {
+                batch.clear();
+                batch.push_back(std::move(item));
+                while (batch.size() < batchSize && decoded.tryPop(item)) {
+                    batch.push_back(std::move(item));
+                }
+                
+                if (batch.size() == 1) {
+                    WorkItem& single = batch.front();
+                    if (single.image.empty()) {
+                        single.features.assign(databaseCount, cv::Mat());
+                    } else {
+                        ImageContext context(single.image, single.filename, single.fullSize,
+                                             single.offset);
+                        worker->extract(context, single.features);
+                    }
+                } else {
+                    std::deque<ImageContext> contexts;
+                    std::vector<ImageContext*> contextPtrs;
+                    std::vector<WorkItem*> decodedItems;
+                    for (WorkItem& member : batch) {
+                        if (member.image.empty()) {
+                            member.features.assign(databaseCount, cv::Mat());
+                            continue;
+                        }
+                        contexts.emplace_back(member.image, member.filename, member.fullSize,
+                                              member.offset);
+                        contextPtrs.push_back(&contexts.back());
+                        decodedItems.push_back(&member);
+                    }
+                    std::vector<std::vector<cv::Mat>> features;
+                    worker->extractBatch(contextPtrs, features);
+                    for (size_t b = 0; b < decodedItems.size(); b++) {
+                        decodedItems[b]->features = std::move(features[b]);
+                    }
+                }
+                
+                bool closed = false;
+                for (WorkItem& member : batch) {
+                    if (options_.thumbnails != nullptr && !member.image.empty()) {
+                        options_.thumbnails->add(member.filename, member.image);
+                    }
+                    member.image.release();
+                    if (!extracted.push(std::move(member))) {
+                        closed = true;
+                        break;
+                    }
+                }
+                if (closed) {
+                    break;
+                }
+            }
+            if (--workersLeft == 0) {
+                extracted.close();
+            }
+        });
+    }
+
+    // Stage 3: this thread writes rows back in input order
+    int64 startTicks = cv::getTickCount();
+    std::map<size_t, std::vector<cv::Mat>> waiting;
+    size_t nextOrder = 0;
+    WorkItem item;
+    while (extracted.pop(item)) {
+        waiting.emplace(item.order, std::move(item.features));
+
+        for (auto ready = waiting.find(nextOrder); ready != waiting.end();
+             ready = waiting.find(nextOrder)) {
+            std::vector<cv::Mat> features = std::move(ready->second);
+            const std::string& imagePath = pending[nextOrder];
+            waiting.erase(ready);
+            nextOrder++;
+
+            bool stored = true;
+            for (size_t k = 0; k < databaseCount; k++) {
+                FeatureDatabase& database = *databases[k];
+                if (database.indexOf(imagePath) >= 0) {
+                    continue;  // restored from this database's checkpoint
+                }
+                if (features[k].empty()) {
+                    std::cerr << "Warning: Failed to extract " << featureNames[k]
+                              << " features from " << imagePath << std::endl;
+                    stored = false;
+                    continue;
+                }
+                if (!database.addFeatures(imagePath, features[k])) {
+                    stored = false;
+                    continue;
+                }
+                if (checkpointing) {
+                    cv::Mat row = database.getFeaturesAt(
+                        static_cast<size_t>(database.indexOf(imagePath)));
+                    const float* values = row.ptr<float>();
+                    std::ofstream& checkpoint = checkpointFiles[k];
+                    checkpoint << Utils::getFilename(imagePath);
+                    for (int j = 0; j < row.cols; j++) {
+                        checkpoint << "," << values[j];
+                    }
+                    checkpoint << "\n";
+                }
+            }
+
+            if (stored) {
+                successCount_++;
+                if (checkpointing && successCount_ % options_.checkpointInterval == 0) {
+                    for (auto& checkpoint : checkpointFiles) {
+                        checkpoint.flush();
+                    }
+                }
+            } else {
+                failCount_++;
+            }
+
+            if (nextOrder % options_.progressInterval == 0) {
+                double seconds = (cv::getTickCount() - startTicks) / cv::getTickFrequency();
+                std::cout << "  Processed " << (resumedCount_ + nextOrder) << "/"
+                          << (resumedCount_ + pending.size()) << " images ("
+                          << static_cast<int>(seconds > 0.0 ? nextOrder / seconds : 0.0)
+                          << " images/sec)" << std::endl;
+            }
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& checkpoint : checkpointFiles) {
+        checkpoint.flush();
+    }
+
+    double seconds = (cv::getTickCount() - startTicks) / cv::getTickFrequency();
+    imagesPerSecond_ = seconds > 0.0 ? nextOrder / seconds : 0.0;
+
+    std::cout << "Feature extraction complete!" << std::endl;
+    std::cout << "  Success: " << successCount_;
+    if (resumedCount_ > 0) {
+        std::cout << " (+" << resumedCount_ << " from checkpoint)";
+    }
+    std::cout << std::endl;
+    std::cout << "  Failed:  " << failCount_ << std::endl;
+    std::cout << "  Speed:   " << static_cast<int>(imagesPerSecond_) << " images/sec" << std::endl;
+    if (reader) {
+        readMegabytesPerSecond_ = reader->megabytesPerSecond();
+        std::cout << "  Read:    " << reader->getBytesRead() / 1000000 << " MB at "
+                  << static_cast<int>(readMegabytesPerSecond_) << " MB/s ("
+                  << reader->backend() << ", depth " << reader->getQueueDepth() << ")"
+                  << std::endl;
+    }
+
+    for (FeatureDatabase* database : databases) {
+        if (database->size() == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Delete the checkpoints once the databases are saved
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void DatabaseBuilder::removeCheckpoint() const {
+    if (!options_.checkpointPath.empty()) {
+        std::remove(options_.checkpointPath.c_str());
+    }
+    for (const auto& path : options_.checkpointPaths) {
+        if (!path.empty()) {
+            std::remove(path.c_str());
+        }
+    }
+}
+
+} // namespace cbir
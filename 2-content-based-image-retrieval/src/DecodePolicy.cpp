@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////
+// DecodePolicy.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of reduced-resolution decoding, the
+//              longest-side limit applied before feature extraction and
+//              partial JPEG decoding of centred regions.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DecodePolicy.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#ifdef CBIR_HAVE_LIBJPEG_TURBO
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace cbir {
+
+namespace {
+
+/// Pixels added around every region so rounding differences stay inside
+const int REGION_MARGIN = 2;
+
+#ifdef CBIR_HAVE_LIBJPEG_TURBO
+
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+void onJpegError(j_common_ptr cinfo) {
+    std::longjmp(reinterpret_cast<JpegErrorManager*>(cinfo->err)->jump, 1);
+}
+
+void onJpegMessage(j_common_ptr) {
+    // Corrupt files fall back to the full decoder, which reports them
+}
+
+/**
+ * @brief EXIF orientation tag of IFD0, 1 if there is none
+ */
+int exifOrientation(jpeg_saved_marker_ptr marker) {
+    for (; marker != nullptr; marker = marker->next) {
+        if (marker->marker != JPEG_APP0 + 1 || marker->data_length < 14 ||
+            std::memcmp(marker->data, "Exif\0\0", 6) != 0) {
+            continue;
+        }
+        const unsigned char* tiff = marker->data + 6;
+        const size_t size = marker->data_length - 6;
+        const bool little = tiff[0] == 'I';
+        auto u16 = [&](size_t at) -> unsigned {
+            return little ? tiff[at] | (tiff[at + 1] << 8) : (tiff[at] << 8) | tiff[at + 1];
+        };
+        const size_t ifd = little ? (u16(4) | (static_cast<size_t>(u16(6)) << 16))
+                                  : ((static_cast<size_t>(u16(4)) << 16) | u16(6));
+        if (ifd + 2 > size) {
+            return 1;
+        }
+        const unsigned count = u16(ifd);
+        for (unsigned i = 0; i < count && ifd + 2 + 12 * (i + 1) <= size; i++) {
+            const size_t entry = ifd + 2 + 12 * i;
+            if (u16(entry) == 0x0112) {
+                return static_cast<int>(u16(entry + 8));
+            }
+        }
+        return 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Decode the rows and iMCU columns of a JPEG that cover a region
+ *
+ * Uses the decoder settings of cv::imread (BGR output, default DCT and
+ * upsampling, scale 1/reduction). Returns false without output for anything
+ * the caller must decode in full.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool decodeJpegRegion(const std::vector<unsigned char>& bytes, int reduction, int maxSide,
+                      const DecodeRegion& region, cv::Mat& crop, cv::Size& fullSize,
+                      cv::Point& offset) {
+    jpeg_decompress_struct cinfo;
+    JpegErrorManager error;
+    cinfo.err = jpeg_std_error(&error.base);
+    error.base.error_exit = onJpegError;
+    error.base.output_message = onJpegMessage;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(bytes.data()),
+                 static_cast<unsigned long>(bytes.size()));
+    jpeg_save_markers(&cinfo, JPEG_APP0 + 1, 0xFFFF);
+    jpeg_read_header(&cinfo, TRUE);
+
+    // imread rotates by EXIF orientation and converts CMYK itself
+    const bool supported = (cinfo.num_components == 1 || cinfo.num_components == 3) &&
+                           exifOrientation(cinfo.marker_list) == 1;
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = static_cast<unsigned int>(reduction);
+    cinfo.out_color_space = JCS_EXT_BGR;
+    jpeg_calc_output_dimensions(&cinfo);
+    fullSize = cv::Size(static_cast<int>(cinfo.output_width),
+                        static_cast<int>(cinfo.output_height));
+    if (!supported || (maxSide > 0 && std::max(fullSize.width, fullSize.height) > maxSide)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    const cv::Rect wanted = region.in(fullSize);
+    jpeg_start_decompress(&cinfo);
+    JDIMENSION x = static_cast<JDIMENSION>(wanted.x);
+    JDIMENSION width = static_cast<JDIMENSION>(wanted.width);
+    jpeg_crop_scanline(&cinfo, &x, &width);
+    if (wanted.y > 0) {
+        jpeg_skip_scanlines(&cinfo, static_cast<JDIMENSION>(wanted.y));
+    }
+
+    crop.create(wanted.height, static_cast<int>(width), CV_8UC3);
+    for (int row = 0; row < wanted.height; row++) {
+        JSAMPROW line = crop.ptr<JSAMPLE>(row);
+        jpeg_read_scanlines(&cinfo, &line, 1);
+    }
+    offset = cv::Point(static_cast<int>(x), wanted.y);
+
+    // The rows below the region are never decoded
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+#endif // CBIR_HAVE_LIBJPEG_TURBO
+
+} // namespace
+
+DecodeRegion DecodeRegion::centred(double fraction, int minSide) {
+    DecodeRegion region;
+    region.fraction = std::max(0.0, std::min(1.0, fraction));
+    region.minSide = std::max(0, minSide);
+    return region;
+}
+
+/**
+ * @brief Centred rectangle, clipped to the image
+ *
+ * Both sides are centred the way (size - side) / 2 centres them, so a
+ * larger region always contains a smaller one.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Rect DecodeRegion::in(const cv::Size& size) const {
+    if (isWholeImage()) {
+        return cv::Rect(0, 0, size.width, size.height);
+    }
+    const int width = std::min(size.width, std::max(minSide, static_cast<int>(size.width * fraction)) +
+                                               2 * REGION_MARGIN);
+    const int height = std::min(size.height, std::max(minSide, static_cast<int>(size.height * fraction)) +
+                                                 2 * REGION_MARGIN);
+    return cv::Rect((size.width - width) / 2, (size.height - height) / 2, width, height);
+}
+
+DecodeRegion DecodeRegion::merge(const DecodeRegion& other) const {
+    return centred(std::max(fraction, other.fraction), std::max(minSide, other.minSide));
+}
+
+DecodePolicy DecodePolicy::make(int reduction, int maxSide) {
+    DecodePolicy policy;
+    policy.reduction = reduction >= 8 ? 8 : reduction >= 4 ? 4 : reduction >= 2 ? 2 : 1;
+    policy.maxSide = std::max(0, maxSide);
+    return policy;
+}
+
+int DecodePolicy::imreadFlags() const {
+    if (reduction >= 8) {
+        return cv::IMREAD_REDUCED_COLOR_8;
+    } else if (reduction >= 4) {
+        return cv::IMREAD_REDUCED_COLOR_4;
+    } else if (reduction >= 2) {
+        return cv::IMREAD_REDUCED_COLOR_2;
+    }
+    return cv::IMREAD_COLOR;
+}
+
+/**
+ * @brief Decode at the reduction, then cap the longest side
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DecodePolicy::load(const std::string& filepath) const {
+    cv::Mat image = Utils::loadImage(filepath, imreadFlags());
+    return image.empty() ? image : limitSide(image);
+}
+
+/**
+ * @brief Decode the region of a JPEG, or the whole file otherwise
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DecodePolicy::loadRegion(const std::string& filepath, const DecodeRegion& region,
+                                 cv::Size& fullSize, cv::Point& offset) const {
+#ifdef CBIR_HAVE_LIBJPEG_TURBO
+    if (!region.isWholeImage()) {
+        std::ifstream file(filepath, std::ios::binary);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)),
+                                         std::istreambuf_iterator<char>());
+        cv::Mat crop;
+        if (bytes.size() > 2 && bytes[0] == 0xFF && bytes[1] == 0xD8 &&
+            decodeJpegRegion(bytes, reduction, maxSide, region, crop, fullSize, offset)) {
+            return crop;
+        }
+    }
+#endif
+    cv::Mat image = load(filepath);
+    fullSize = image.size();
+    offset = cv::Point();
+    return image;
+}
+
+/**
+ * @brief Decode in-memory file contents with the reduction and side limit
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DecodePolicy::decode(const std::vector<unsigned char>& bytes) const {
+    if (bytes.empty()) {
+        return cv::Mat();
+    }
+    cv::Mat image = cv::imdecode(bytes, imreadFlags());
+    return image.empty() ? image : limitSide(image);
+}
+
+/**
+ * @brief Decode the region of in-memory JPEG contents, or the whole image
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DecodePolicy::decodeRegion(const std::vector<unsigned char>& bytes,
+                                   const DecodeRegion& region,
+                                   cv::Size& fullSize, cv::Point& offset) const {
+#ifdef CBIR_HAVE_LIBJPEG_TURBO
+    cv::Mat crop;
+    if (!region.isWholeImage() && bytes.size() > 2 && bytes[0] == 0xFF && bytes[1] == 0xD8 &&
+        decodeJpegRegion(bytes, reduction, maxSide, region, crop, fullSize, offset)) {
+        return crop;
+    }
+#else
+    (void)region;
+#endif
+    cv::Mat image = decode(bytes);
+    fullSize = image.size();
+    offset = cv::Point();
+    return image;
+}
+
+/**
+ * @brief Shrink with area averaging so the longest side fits maxSide
+ *
+ * Images already within the limit are returned as-is; they are never
+ * enlarged.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DecodePolicy::limitSide(const cv::Mat& image) const {
+    const int longest = std::max(image.rows, image.cols);
+    if (maxSide <= 0 || longest <= maxSide) {
+        return image;
+    }
+
+    const double scale = static_cast<double>(maxSide) / longest;
+    cv::Size size(std::max(1, static_cast<int>(image.cols * scale + 0.5)),
+                  std::max(1, static_cast<int>(image.rows * scale + 0.5)));
+    cv::Mat resized;
+    cv::resize(image, resized, size, 0, 0, cv::INTER_AREA);
+    return resized;
+}
+
+std::string DecodePolicy::describe() const {
+    if (isFullResolution()) {
+        return "full resolution";
+    }
+    std::string text = reduction > 1 ? "1/" + std::to_string(reduction) + " decode"
+                                     : "full decode";
+    if (maxSide > 0) {
+        text += ", max side " + std::to_string(maxSide);
+    }
+    return text;
+}
+
+} // namespace cbir
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////
+// DeltaLog.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the append-only database change log.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DeltaLog.h"
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace cbir {
+
+namespace {
+
+/// First line of every delta log
+const char* const LOG_HEADER = "#cbir-delta,1";
+
+/// Read buffer used when hashing files and copying log tails
+const size_t COPY_BUFFER_BYTES = 1 << 16;
+
+/**
+ * Parse "name,modified,hash" from cursor; advances cursor past the hash
+ */
+bool parseStamp(const char*& cursor, std::string& name, FileStamp& stamp) {
+    const char* comma = std::strchr(cursor, ',');
+    if (comma == nullptr || comma == cursor) {
+        return false;
+    }
+    name.assign(cursor, comma);
+
+    char* end = nullptr;
+    stamp.modified = std::strtoll(comma + 1, &end, 10);
+    if (end == comma + 1 || *end != ',') {
+        return false;
+    }
+    const char* hashStart = end + 1;
+    stamp.hash = std::strtoull(hashStart, &end, 16);
+    if (end == hashStart) {
+        return false;
+    }
+    cursor = end;
+    return true;
+}
+
+/**
+ * Parse one log line; false if it is malformed
+ */
+bool parseRecord(const std::string& line, DeltaRecord& record) {
+    if (line.size() < 3 || line[1] != ',') {
+        return false;
+    }
+    const char* cursor = line.c_str() + 2;
+    record.values.clear();
+    record.stamp = FileStamp();
+
+    switch (line[0]) {
+    case '-':
+        record.type = DeltaRecord::Type::Remove;
+        record.name.assign(cursor);
+        return !record.name.empty() && record.name.find(',') == std::string::npos;
+    case '=':
+        record.type = DeltaRecord::Type::Stamp;
+        return parseStamp(cursor, record.name, record.stamp) && *cursor == '\0';
+    case '+':
+        record.type = DeltaRecord::Type::Put;
+        if (!parseStamp(cursor, record.name, record.stamp)) {
+            return false;
+        }
+        while (*cursor == ',') {
+            char* end = nullptr;
+            record.values.push_back(std::strtof(cursor + 1, &end));
+            if (end == cursor + 1) {
+                return false;
+            }
+            cursor = end;
+        }
+        return *cursor == '\0' && !record.values.empty();
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Stamp a file
+ *
+ * @author Krushna Sanjay Sharma
+ */
+FileStamp FileStamp::of(const std::string& path, bool withHash) {
+    FileStamp stamp;
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return stamp;
+    }
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    stamp.hash = withHash ? hashFile(path) : 0;
+    return stamp;
+}
+
+/**
+ * @brief FNV-1a over the file contents
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint64_t FileStamp::hashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    uint64_t hash = 1469598103934665603ULL;
+    std::vector<char> buffer(COPY_BUFFER_BYTES);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize count = file.gcount();
+        for (std::streamsize i = 0; i < count; i++) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
+    // Keep 0 free for "unknown"
+    return hash == 0 ? 1 : hash;
+}
+
+/**
+ * @brief Log file next to a database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string DeltaLog::pathFor(const std::string& basePath) {
+    return basePath + ".log";
+}
+
+/**
+ * @brief Read complete records and truncate a torn tail
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DeltaLog::read(const std::string& path, std::vector<DeltaRecord>& records) {
+    records.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        return true;
+    }
+    if (line != LOG_HEADER) {
+        if (file.eof() && std::string(LOG_HEADER).compare(0, line.size(), line) == 0) {
+            // Header itself was torn: treat as an empty log
+            file.close();
+            std::error_code error;
+            std::filesystem::resize_file(path, 0, error);
+            return true;
+        }
+        std::cerr << "Error: " << path << " is not a feature database log" << std::endl;
+        return false;
+    }
+
+    std::streamoff validEnd = file.tellg();
+    DeltaRecord record;
+    while (std::getline(file, line)) {
+        if (file.eof() || !parseRecord(line, record)) {
+            break;
+        }
+        records.push_back(record);
+        validEnd = file.tellg();
+    }
+    file.close();
+
+    std::error_code error;
+    if (static_cast<uintmax_t>(validEnd) < std::filesystem::file_size(path, error) && !error) {
+        std::cerr << "Warning: Dropping incomplete record at the end of " << path << std::endl;
+        std::filesystem::resize_file(path, static_cast<uintmax_t>(validEnd), error);
+    }
+    return true;
+}
+
+/**
+ * @brief Open for appending
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DeltaLog::open(const std::string& path, bool reset) {
+    file_.close();
+    path_.clear();
+
+    std::error_code error;
+    bool exists = std::filesystem::exists(path, error) &&
+                  std::filesystem::file_size(path, error) > 0;
+    if (reset || !exists) {
+        std::ofstream create(path, std::ios::binary | std::ios::trunc);
+        create << LOG_HEADER << "\n";
+        if (!create.good()) {
+            std::cerr << "Error: Cannot create log " << path << std::endl;
+            return false;
+        }
+    }
+
+    file_.open(path, std::ios::binary | std::ios::app);
+    if (!file_.is_open()) {
+        std::cerr << "Error: Cannot open log " << path << std::endl;
+        return false;
+    }
+    file_ << std::setprecision(9);
+    path_ = path;
+    return true;
+}
+
+/**
+ * @brief Append a record
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DeltaLog::append(const DeltaRecord& record) {
+    if (!file_.is_open()) {
+        return false;
+    }
+    writeRecord(file_, record);
+    return file_.good();
+}
+
+/**
+ * @brief Flush appended records
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DeltaLog::flush() {
+    if (!file_.is_open()) {
+        return false;
+    }
+    file_.flush();
+    return file_.good();
+}
+
+/**
+ * @brief Log length in bytes
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint64_t DeltaLog::size() {
+    flush();
+    std::error_code error;
+    uintmax_t bytes = std::filesystem::file_size(path_, error);
+    return error ? 0 : static_cast<uint64_t>(bytes);
+}
+
+/**
+ * @brief Replace the log with head + tail
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DeltaLog::rewrite(const std::vector<DeltaRecord>& head, uint64_t tailOffset) {
+    if (!file_.is_open()) {
+        return false;
+    }
+    flush();
+
+    const std::string temporary = path_ + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out << std::setprecision(9) << LOG_HEADER << "\n";
+        for (const auto& record : head) {
+            writeRecord(out, record);
+        }
+
+        std::ifstream in(path_, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(tailOffset));
+        std::vector<char> buffer(COPY_BUFFER_BYTES);
+        while (in) {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.write(buffer.data(), in.gcount());
+        }
+        if (!out.good()) {
+            std::cerr << "Error: Failed writing " << temporary << std::endl;
+            return false;
+        }
+    }
+
+    file_.close();
+    std::error_code error;
+    std::filesystem::rename(temporary, path_, error);
+    if (error) {
+        std::cerr << "Error: Cannot replace " << path_ << ": " << error.message() << std::endl;
+    }
+    file_.open(path_, std::ios::binary | std::ios::app);
+    file_ << std::setprecision(9);
+    return !error && file_.is_open();
+}
+
+/**
+ * @brief Format one record
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void DeltaLog::writeRecord(std::ostream& out, const DeltaRecord& record) {
+    switch (record.type) {
+    case DeltaRecord::Type::Remove:
+        out << "-," << record.name << "\n";
+        return;
+    case DeltaRecord::Type::Stamp:
+        out << "=," << record.name << "," << record.stamp.modified << ","
+            << std::hex << record.stamp.hash << std::dec << "\n";
+        return;
+    case DeltaRecord::Type::Put:
+        out << "+," << record.name << "," << record.stamp.modified << ","
+            << std::hex << record.stamp.hash << std::dec;
+        for (float value : record.values) {
+            out << "," << value;
+        }
+        out << "\n";
+        return;
+    }
+}
+
+} // namespace cbir
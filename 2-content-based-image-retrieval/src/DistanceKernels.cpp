@@ -0,0 +1,1249 @@
+////////////////////////////////////////////////////////////////////////////////
+// DistanceKernels.cpp
+// Author: Krushna Sanjay Sharma
+// Description: AVX2 / NEON / scalar implementations of the distance kernels.
+//              On x86 the AVX2 code is compiled with a function-level target
+//              attribute and only used when the CPU reports AVX2 and FMA, so
+//              the library still runs on older processors.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DistanceKernels.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CBIR_KERNELS_AVX2 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define CBIR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define CBIR_TARGET_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CBIR_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace cbir {
+namespace DistanceKernels {
+
+namespace {
+
+/// Margin for float rounding in the intersection lower bound
+const float CUTOFF_SLACK = 1e-5f;
+
+/**
+ * True if 1 - intersection must exceed maxDistance, given partial sums over
+ * the bins visited so far (see intersectionBounded())
+ */
+inline bool intersectionBoundExceeds(float inter, float prefixB, float prefixA,
+                                     float sumA, float maxDistance) {
+    // Rows summing to less than 0.99 are later scaled by 1 / Σ b <= 1 / prefixB;
+    // 0.995 leaves room for rounding between the prefix and the final sum
+    float visited = prefixA;
+    if (prefixB >= 0.995f) {
+        visited = std::min(prefixA, inter);
+    } else if (prefixB > 0.0f) {
+        visited = std::min(prefixA, inter / prefixB);
+    }
+    const float lowerBound = 1.0f - visited - (sumA - prefixA);
+    return lowerBound > maxDistance + CUTOFF_SLACK;
+}
+
+#if !defined(CBIR_KERNELS_NEON)
+
+//==============================================================================
+// Scalar reference versions
+//==============================================================================
+
+float squaredDifferenceScalar(const float* a, const float* b, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return static_cast<float>(sum);
+}
+
+void dotAndSquaresScalar(const float* a, const float* b, int n,
+                         float* dot, float* squaresB) {
+    double d = 0.0;
+    double s = 0.0;
+    for (int i = 0; i < n; i++) {
+        d += a[i] * b[i];
+        s += b[i] * b[i];
+    }
+    *dot = static_cast<float>(d);
+    *squaresB = static_cast<float>(s);
+}
+
+float dotScalar(const float* a, const float* b, int n) {
+    double d = 0.0;
+    for (int i = 0; i < n; i++) {
+        d += a[i] * b[i];
+    }
+    return static_cast<float>(d);
+}
+
+float intersectionScalar(const float* a, const float* b, int n,
+                         float scale, float* sumB) {
+    double inter = 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        inter += std::min(a[i], scale * b[i]);
+        sum += b[i];
+    }
+    if (sumB != nullptr) {
+        *sumB = static_cast<float>(sum);
+    }
+    return static_cast<float>(inter);
+}
+
+void intersection4Scalar(const float* const a[4], const float* b, int n,
+                         float scale, float results[4], float* sumB) {
+    float inter[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) {
+        const float value = scale * b[i];
+        inter[0] += std::min(a[0][i], value);
+        inter[1] += std::min(a[1][i], value);
+        inter[2] += std::min(a[2][i], value);
+        inter[3] += std::min(a[3][i], value);
+        sum += b[i];
+    }
+    std::copy(inter, inter + 4, results);
+    if (sumB != nullptr) {
+        *sumB = sum;
+    }
+}
+
+float weightedIntersectionScalar(const float* a, const float* b, const float* weights,
+                                 int n) {
+    double inter = 0.0;
+    for (int i = 0; i < n; i++) {
+        inter += weights[i] * std::min(a[i], b[i]);
+    }
+    return static_cast<float>(inter);
+}
+
+float sumScalar(const float* a, int n) {
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        total += a[i];
+    }
+    return static_cast<float>(total);
+}
+
+float squaredDifferenceBoundedScalar(const float* a, const float* b, int n, float cutoff) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+        if ((i + 1) % CUTOFF_CHECK_FLOATS == 0 && static_cast<float>(sum) > cutoff) {
+            break;
+        }
+    }
+    return static_cast<float>(sum);
+}
+
+bool intersectionBoundedScalar(const float* a, const float* b, int n, float sumA,
+                               float maxDistance, float* result, float* sumB) {
+    double inter = 0.0;
+    double sum = 0.0;
+    double prefix = 0.0;
+    for (int i = 0; i < n; i++) {
+        inter += std::min(a[i], b[i]);
+        sum += b[i];
+        prefix += a[i];
+        if ((i + 1) % CUTOFF_CHECK_FLOATS == 0 &&
+            intersectionBoundExceeds(static_cast<float>(inter), static_cast<float>(sum),
+                                     static_cast<float>(prefix), sumA, maxDistance)) {
+            return false;
+        }
+    }
+    *result = static_cast<float>(inter);
+    *sumB = static_cast<float>(sum);
+    return true;
+}
+
+float squaredDifferenceQuantizedScalar(const float* a, const uint8_t* codes, int n,
+                                       float scale) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        float diff = a[i] - scale * codes[i];
+        sum += diff * diff;
+    }
+    return static_cast<float>(sum);
+}
+
+void dotAndSquaresQuantizedScalar(const float* a, const uint8_t* codes, int n, float scale,
+                                  float* dot, float* squaresB) {
+    double d = 0.0;
+    uint64_t s = 0;
+    for (int i = 0; i < n; i++) {
+        d += a[i] * codes[i];
+        s += static_cast<uint32_t>(codes[i]) * codes[i];
+    }
+    *dot = static_cast<float>(d * scale);
+    *squaresB = static_cast<float>(static_cast<double>(s) * scale * scale);
+}
+
+float dotQuantizedScalar(const float* a, const uint8_t* codes, int n, float scale) {
+    double d = 0.0;
+    for (int i = 0; i < n; i++) {
+        d += a[i] * codes[i];
+    }
+    return static_cast<float>(d * scale);
+}
+
+float intersectionQuantizedScalar(const float* a, const uint8_t* codes, int n,
+                                  float scale, float* sumCodes) {
+    double inter = 0.0;
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        inter += std::min(a[i], scale * codes[i]);
+        sum += codes[i];
+    }
+    if (sumCodes != nullptr) {
+        *sumCodes = static_cast<float>(sum);
+    }
+    return static_cast<float>(inter);
+}
+
+#endif
+
+#if defined(CBIR_KERNELS_AVX2)
+
+//==============================================================================
+// AVX2 + FMA: 16 floats per iteration in two accumulators
+//==============================================================================
+
+CBIR_TARGET_AVX2 inline float horizontalSum(__m256 v) {
+    __m128 low = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    __m128 shuffled = _mm_movehdup_ps(low);
+    __m128 sums = _mm_add_ps(low, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+CBIR_TARGET_AVX2 float squaredDifferenceAVX2(const float* a, const float* b, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+CBIR_TARGET_AVX2 float sumAVX2(const float* a, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(a + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(a + i + 8));
+    }
+    float total = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        total += a[i];
+    }
+    return total;
+}
+
+/// squaredDifferenceAVX2() with a check of the running sum every CUTOFF_CHECK_FLOATS
+CBIR_TARGET_AVX2 float squaredDifferenceBoundedAVX2(const float* a, const float* b, int n,
+                                                    float cutoff) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+        if ((i + 16) % CUTOFF_CHECK_FLOATS == 0) {
+            // Lanes only grow, so the final sum is at least this partial one
+            float partial = horizontalSum(_mm256_add_ps(acc0, acc1));
+            if (partial > cutoff) {
+                return partial;
+            }
+        }
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+/// Same accumulation order as the dot product of dotAndSquaresAVX2()
+CBIR_TARGET_AVX2 float dotAVX2(const float* a, const float* b, int n) {
+    __m256 dot0 = _mm256_setzero_ps();
+    __m256 dot1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), dot0);
+        dot1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), dot1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), dot0);
+    }
+    float d = horizontalSum(_mm256_add_ps(dot0, dot1));
+    for (; i < n; i++) {
+        d += a[i] * b[i];
+    }
+    return d;
+}
+
+CBIR_TARGET_AVX2 void dotAndSquaresAVX2(const float* a, const float* b, int n,
+                                        float* dot, float* squaresB) {
+    __m256 dot0 = _mm256_setzero_ps();
+    __m256 dot1 = _mm256_setzero_ps();
+    __m256 sq0 = _mm256_setzero_ps();
+    __m256 sq1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 b0 = _mm256_loadu_ps(b + i);
+        __m256 b1 = _mm256_loadu_ps(b + i + 8);
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), b0, dot0);
+        dot1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), b1, dot1);
+        sq0 = _mm256_fmadd_ps(b0, b0, sq0);
+        sq1 = _mm256_fmadd_ps(b1, b1, sq1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 b0 = _mm256_loadu_ps(b + i);
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), b0, dot0);
+        sq0 = _mm256_fmadd_ps(b0, b0, sq0);
+    }
+    float d = horizontalSum(_mm256_add_ps(dot0, dot1));
+    float s = horizontalSum(_mm256_add_ps(sq0, sq1));
+    for (; i < n; i++) {
+        d += a[i] * b[i];
+        s += b[i] * b[i];
+    }
+    *dot = d;
+    *squaresB = s;
+}
+
+CBIR_TARGET_AVX2 float intersectionAVX2(const float* a, const float* b, int n,
+                                        float scale, float* sumB) {
+    const __m256 scaleV = _mm256_set1_ps(scale);
+    __m256 inter0 = _mm256_setzero_ps();
+    __m256 inter1 = _mm256_setzero_ps();
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 b0 = _mm256_loadu_ps(b + i);
+        __m256 b1 = _mm256_loadu_ps(b + i + 8);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(_mm256_loadu_ps(a + i),
+                                                     _mm256_mul_ps(b0, scaleV)));
+        inter1 = _mm256_add_ps(inter1, _mm256_min_ps(_mm256_loadu_ps(a + i + 8),
+                                                     _mm256_mul_ps(b1, scaleV)));
+        sum0 = _mm256_add_ps(sum0, b0);
+        sum1 = _mm256_add_ps(sum1, b1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 b0 = _mm256_loadu_ps(b + i);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(_mm256_loadu_ps(a + i),
+                                                     _mm256_mul_ps(b0, scaleV)));
+        sum0 = _mm256_add_ps(sum0, b0);
+    }
+    float inter = horizontalSum(_mm256_add_ps(inter0, inter1));
+    float sum = horizontalSum(_mm256_add_ps(sum0, sum1));
+    for (; i < n; i++) {
+        inter += std::min(a[i], scale * b[i]);
+        sum += b[i];
+    }
+    if (sumB != nullptr) {
+        *sumB = sum;
+    }
+    return inter;
+}
+
+CBIR_TARGET_AVX2 float weightedIntersectionAVX2(const float* a, const float* b,
+                                                const float* weights, int n) {
+    __m256 inter0 = _mm256_setzero_ps();
+    __m256 inter1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        inter0 = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i),
+                                 _mm256_min_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)),
+                                 inter0);
+        inter1 = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i + 8),
+                                 _mm256_min_ps(_mm256_loadu_ps(a + i + 8),
+                                               _mm256_loadu_ps(b + i + 8)),
+                                 inter1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        inter0 = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i),
+                                 _mm256_min_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)),
+                                 inter0);
+    }
+    float inter = horizontalSum(_mm256_add_ps(inter0, inter1));
+    for (; i < n; i++) {
+        inter += weights[i] * std::min(a[i], b[i]);
+    }
+    return inter;
+}
+
+/// intersectionAVX2() at scale 1, plus Σ a for the bound checks
+CBIR_TARGET_AVX2 bool intersectionBoundedAVX2(const float* a, const float* b, int n, float sumA,
+                                              float maxDistance, float* result, float* sumB) {
+    __m256 inter0 = _mm256_setzero_ps();
+    __m256 inter1 = _mm256_setzero_ps();
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 prefix0 = _mm256_setzero_ps();
+    __m256 prefix1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_loadu_ps(a + i);
+        __m256 a1 = _mm256_loadu_ps(a + i + 8);
+        __m256 b0 = _mm256_loadu_ps(b + i);
+        __m256 b1 = _mm256_loadu_ps(b + i + 8);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(a0, b0));
+        inter1 = _mm256_add_ps(inter1, _mm256_min_ps(a1, b1));
+        sum0 = _mm256_add_ps(sum0, b0);
+        sum1 = _mm256_add_ps(sum1, b1);
+        prefix0 = _mm256_add_ps(prefix0, a0);
+        prefix1 = _mm256_add_ps(prefix1, a1);
+        if ((i + 16) % CUTOFF_CHECK_FLOATS == 0 &&
+            intersectionBoundExceeds(horizontalSum(_mm256_add_ps(inter0, inter1)),
+                                     horizontalSum(_mm256_add_ps(sum0, sum1)),
+                                     horizontalSum(_mm256_add_ps(prefix0, prefix1)),
+                                     sumA, maxDistance)) {
+            return false;
+        }
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 b0 = _mm256_loadu_ps(b + i);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(_mm256_loadu_ps(a + i), b0));
+        sum0 = _mm256_add_ps(sum0, b0);
+    }
+    float inter = horizontalSum(_mm256_add_ps(inter0, inter1));
+    float sum = horizontalSum(_mm256_add_ps(sum0, sum1));
+    for (; i < n; i++) {
+        inter += std::min(a[i], b[i]);
+        sum += b[i];
+    }
+    *result = inter;
+    *sumB = sum;
+    return true;
+}
+
+CBIR_TARGET_AVX2 void intersection4AVX2(const float* const a[4], const float* b, int n,
+                                        float scale, float results[4], float* sumB) {
+    const __m256 scaleV = _mm256_set1_ps(scale);
+    __m256 inter0 = _mm256_setzero_ps();
+    __m256 inter1 = _mm256_setzero_ps();
+    __m256 inter2 = _mm256_setzero_ps();
+    __m256 inter3 = _mm256_setzero_ps();
+    __m256 sum = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 raw = _mm256_loadu_ps(b + i);
+        __m256 value = _mm256_mul_ps(raw, scaleV);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(_mm256_loadu_ps(a[0] + i), value));
+        inter1 = _mm256_add_ps(inter1, _mm256_min_ps(_mm256_loadu_ps(a[1] + i), value));
+        inter2 = _mm256_add_ps(inter2, _mm256_min_ps(_mm256_loadu_ps(a[2] + i), value));
+        inter3 = _mm256_add_ps(inter3, _mm256_min_ps(_mm256_loadu_ps(a[3] + i), value));
+        sum = _mm256_add_ps(sum, raw);
+    }
+    results[0] = horizontalSum(inter0);
+    results[1] = horizontalSum(inter1);
+    results[2] = horizontalSum(inter2);
+    results[3] = horizontalSum(inter3);
+    float total = horizontalSum(sum);
+    for (; i < n; i++) {
+        const float value = scale * b[i];
+        for (int k = 0; k < 4; k++) {
+            results[k] += std::min(a[k][i], value);
+        }
+        total += b[i];
+    }
+    if (sumB != nullptr) {
+        *sumB = total;
+    }
+}
+
+/// Eight codes widened to floats
+CBIR_TARGET_AVX2 inline __m256 loadCodes(const uint8_t* codes) {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(codes));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+}
+
+CBIR_TARGET_AVX2 float squaredDifferenceQuantizedAVX2(const float* a, const uint8_t* codes,
+                                                      int n, float scale) {
+    const __m256 scaleV = _mm256_set1_ps(scale);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_fnmadd_ps(loadCodes(codes + i), scaleV, _mm256_loadu_ps(a + i));
+        __m256 d1 = _mm256_fnmadd_ps(loadCodes(codes + i + 8), scaleV, _mm256_loadu_ps(a + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 d0 = _mm256_fnmadd_ps(loadCodes(codes + i), scaleV, _mm256_loadu_ps(a + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        float diff = a[i] - scale * codes[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+CBIR_TARGET_AVX2 void dotAndSquaresQuantizedAVX2(const float* a, const uint8_t* codes, int n,
+                                                 float scale, float* dot, float* squaresB) {
+    __m256 dot0 = _mm256_setzero_ps();
+    __m256 dot1 = _mm256_setzero_ps();
+    __m256 sq0 = _mm256_setzero_ps();
+    __m256 sq1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 c0 = loadCodes(codes + i);
+        __m256 c1 = loadCodes(codes + i + 8);
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), c0, dot0);
+        dot1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), c1, dot1);
+        sq0 = _mm256_fmadd_ps(c0, c0, sq0);
+        sq1 = _mm256_fmadd_ps(c1, c1, sq1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 c0 = loadCodes(codes + i);
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), c0, dot0);
+        sq0 = _mm256_fmadd_ps(c0, c0, sq0);
+    }
+    float d = horizontalSum(_mm256_add_ps(dot0, dot1));
+    float s = horizontalSum(_mm256_add_ps(sq0, sq1));
+    for (; i < n; i++) {
+        d += a[i] * codes[i];
+        s += static_cast<float>(codes[i]) * codes[i];
+    }
+    *dot = d * scale;
+    *squaresB = s * scale * scale;
+}
+
+CBIR_TARGET_AVX2 float dotQuantizedAVX2(const float* a, const uint8_t* codes, int n,
+                                        float scale) {
+    __m256 dot0 = _mm256_setzero_ps();
+    __m256 dot1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), loadCodes(codes + i), dot0);
+        dot1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), loadCodes(codes + i + 8), dot1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        dot0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), loadCodes(codes + i), dot0);
+    }
+    float d = horizontalSum(_mm256_add_ps(dot0, dot1));
+    for (; i < n; i++) {
+        d += a[i] * codes[i];
+    }
+    return d * scale;
+}
+
+CBIR_TARGET_AVX2 float intersectionQuantizedAVX2(const float* a, const uint8_t* codes, int n,
+                                                 float scale, float* sumCodes) {
+    const __m256 scaleV = _mm256_set1_ps(scale);
+    __m256 inter0 = _mm256_setzero_ps();
+    __m256 inter1 = _mm256_setzero_ps();
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 c0 = loadCodes(codes + i);
+        __m256 c1 = loadCodes(codes + i + 8);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(_mm256_loadu_ps(a + i),
+                                                     _mm256_mul_ps(c0, scaleV)));
+        inter1 = _mm256_add_ps(inter1, _mm256_min_ps(_mm256_loadu_ps(a + i + 8),
+                                                     _mm256_mul_ps(c1, scaleV)));
+        sum0 = _mm256_add_ps(sum0, c0);
+        sum1 = _mm256_add_ps(sum1, c1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 c0 = loadCodes(codes + i);
+        inter0 = _mm256_add_ps(inter0, _mm256_min_ps(_mm256_loadu_ps(a + i),
+                                                     _mm256_mul_ps(c0, scaleV)));
+        sum0 = _mm256_add_ps(sum0, c0);
+    }
+    float inter = horizontalSum(_mm256_add_ps(inter0, inter1));
+    float sum = horizontalSum(_mm256_add_ps(sum0, sum1));
+    for (; i < n; i++) {
+        inter += std::min(a[i], scale * codes[i]);
+        sum += codes[i];
+    }
+    if (sumCodes != nullptr) {
+        *sumCodes = sum;
+    }
+    return inter;
+}
+
+/// AVX2 and FMA are both required; checked once
+bool useAVX2() {
+    static const bool supported = cv::checkHardwareSupport(CV_CPU_AVX2) &&
+                                  cv::checkHardwareSupport(CV_CPU_FMA3);
+    return supported;
+}
+
+#elif defined(CBIR_KERNELS_NEON)
+
+//==============================================================================
+// NEON: 8 floats per iteration in two accumulators
+//==============================================================================
+
+inline float32x4_t multiplyAdd(float32x4_t acc, float32x4_t x, float32x4_t y) {
+#if defined(__aarch64__)
+    return vfmaq_f32(acc, x, y);
+#else
+    return vmlaq_f32(acc, x, y);
+#endif
+}
+
+inline float horizontalSum(float32x4_t v) {
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+}
+
+float squaredDifferenceNEON(const float* a, const float* b, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc0 = multiplyAdd(acc0, d0, d0);
+        acc1 = multiplyAdd(acc1, d1, d1);
+    }
+    float sum = horizontalSum(vaddq_f32(acc0, acc1));
+    for (; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+float sumNEON(const float* a, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vaddq_f32(acc0, vld1q_f32(a + i));
+        acc1 = vaddq_f32(acc1, vld1q_f32(a + i + 4));
+    }
+    float total = horizontalSum(vaddq_f32(acc0, acc1));
+    for (; i < n; i++) {
+        total += a[i];
+    }
+    return total;
+}
+
+/// squaredDifferenceNEON() with a check of the running sum every CUTOFF_CHECK_FLOATS
+float squaredDifferenceBoundedNEON(const float* a, const float* b, int n, float cutoff) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc0 = multiplyAdd(acc0, d0, d0);
+        acc1 = multiplyAdd(acc1, d1, d1);
+        if ((i + 8) % CUTOFF_CHECK_FLOATS == 0) {
+            float partial = horizontalSum(vaddq_f32(acc0, acc1));
+            if (partial > cutoff) {
+                return partial;
+            }
+        }
+    }
+    float sum = horizontalSum(vaddq_f32(acc0, acc1));
+    for (; i < n; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+void dotAndSquaresNEON(const float* a, const float* b, int n,
+                       float* dot, float* squaresB) {
+    float32x4_t dot0 = vdupq_n_f32(0.0f);
+    float32x4_t dot1 = vdupq_n_f32(0.0f);
+    float32x4_t sq0 = vdupq_n_f32(0.0f);
+    float32x4_t sq1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t b0 = vld1q_f32(b + i);
+        float32x4_t b1 = vld1q_f32(b + i + 4);
+        dot0 = multiplyAdd(dot0, vld1q_f32(a + i), b0);
+        dot1 = multiplyAdd(dot1, vld1q_f32(a + i + 4), b1);
+        sq0 = multiplyAdd(sq0, b0, b0);
+        sq1 = multiplyAdd(sq1, b1, b1);
+    }
+    float d = horizontalSum(vaddq_f32(dot0, dot1));
+    float s = horizontalSum(vaddq_f32(sq0, sq1));
+    for (; i < n; i++) {
+        d += a[i] * b[i];
+        s += b[i] * b[i];
+    }
+    *dot = d;
+    *squaresB = s;
+}
+
+float dotNEON(const float* a, const float* b, int n) {
+    float32x4_t dot0 = vdupq_n_f32(0.0f);
+    float32x4_t dot1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        dot0 = multiplyAdd(dot0, vld1q_f32(a + i), vld1q_f32(b + i));
+        dot1 = multiplyAdd(dot1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float d = horizontalSum(vaddq_f32(dot0, dot1));
+    for (; i < n; i++) {
+        d += a[i] * b[i];
+    }
+    return d;
+}
+
+float intersectionNEON(const float* a, const float* b, int n,
+                       float scale, float* sumB) {
+    float32x4_t inter0 = vdupq_n_f32(0.0f);
+    float32x4_t inter1 = vdupq_n_f32(0.0f);
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t b0 = vld1q_f32(b + i);
+        float32x4_t b1 = vld1q_f32(b + i + 4);
+        inter0 = vaddq_f32(inter0, vminq_f32(vld1q_f32(a + i), vmulq_n_f32(b0, scale)));
+        inter1 = vaddq_f32(inter1, vminq_f32(vld1q_f32(a + i + 4), vmulq_n_f32(b1, scale)));
+        sum0 = vaddq_f32(sum0, b0);
+        sum1 = vaddq_f32(sum1, b1);
+    }
+    float inter = horizontalSum(vaddq_f32(inter0, inter1));
+    float sum = horizontalSum(vaddq_f32(sum0, sum1));
+    for (; i < n; i++) {
+        inter += std::min(a[i], scale * b[i]);
+        sum += b[i];
+    }
+    if (sumB != nullptr) {
+        *sumB = sum;
+    }
+    return inter;
+}
+
+float weightedIntersectionNEON(const float* a, const float* b, const float* weights, int n) {
+    float32x4_t inter0 = vdupq_n_f32(0.0f);
+    float32x4_t inter1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        inter0 = multiplyAdd(inter0, vld1q_f32(weights + i),
+                             vminq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        inter1 = multiplyAdd(inter1, vld1q_f32(weights + i + 4),
+                             vminq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+    }
+    float inter = horizontalSum(vaddq_f32(inter0, inter1));
+    for (; i < n; i++) {
+        inter += weights[i] * std::min(a[i], b[i]);
+    }
+    return inter;
+}
+
+/// intersectionNEON() at scale 1, plus Σ a for the bound checks
+bool intersectionBoundedNEON(const float* a, const float* b, int n, float sumA,
+                             float maxDistance, float* result, float* sumB) {
+    float32x4_t inter0 = vdupq_n_f32(0.0f);
+    float32x4_t inter1 = vdupq_n_f32(0.0f);
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    float32x4_t prefix0 = vdupq_n_f32(0.0f);
+    float32x4_t prefix1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a0 = vld1q_f32(a + i);
+        float32x4_t a1 = vld1q_f32(a + i + 4);
+        float32x4_t b0 = vld1q_f32(b + i);
+        float32x4_t b1 = vld1q_f32(b + i + 4);
+        inter0 = vaddq_f32(inter0, vminq_f32(a0, b0));
+        inter1 = vaddq_f32(inter1, vminq_f32(a1, b1));
+        sum0 = vaddq_f32(sum0, b0);
+        sum1 = vaddq_f32(sum1, b1);
+        prefix0 = vaddq_f32(prefix0, a0);
+        prefix1 = vaddq_f32(prefix1, a1);
+        if ((i + 8) % CUTOFF_CHECK_FLOATS == 0 &&
+            intersectionBoundExceeds(horizontalSum(vaddq_f32(inter0, inter1)),
+                                     horizontalSum(vaddq_f32(sum0, sum1)),
+                                     horizontalSum(vaddq_f32(prefix0, prefix1)),
+                                     sumA, maxDistance)) {
+            return false;
+        }
+    }
+    float inter = horizontalSum(vaddq_f32(inter0, inter1));
+    float sum = horizontalSum(vaddq_f32(sum0, sum1));
+    for (; i < n; i++) {
+        inter += std::min(a[i], b[i]);
+        sum += b[i];
+    }
+    *result = inter;
+    *sumB = sum;
+    return true;
+}
+
+void intersection4NEON(const float* const a[4], const float* b, int n,
+                       float scale, float results[4], float* sumB) {
+    float32x4_t inter0 = vdupq_n_f32(0.0f);
+    float32x4_t inter1 = vdupq_n_f32(0.0f);
+    float32x4_t inter2 = vdupq_n_f32(0.0f);
+    float32x4_t inter3 = vdupq_n_f32(0.0f);
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t raw = vld1q_f32(b + i);
+        float32x4_t value = vmulq_n_f32(raw, scale);
+        inter0 = vaddq_f32(inter0, vminq_f32(vld1q_f32(a[0] + i), value));
+        inter1 = vaddq_f32(inter1, vminq_f32(vld1q_f32(a[1] + i), value));
+        inter2 = vaddq_f32(inter2, vminq_f32(vld1q_f32(a[2] + i), value));
+        inter3 = vaddq_f32(inter3, vminq_f32(vld1q_f32(a[3] + i), value));
+        sum = vaddq_f32(sum, raw);
+    }
+    results[0] = horizontalSum(inter0);
+    results[1] = horizontalSum(inter1);
+    results[2] = horizontalSum(inter2);
+    results[3] = horizontalSum(inter3);
+    float total = horizontalSum(sum);
+    for (; i < n; i++) {
+        const float value = scale * b[i];
+        for (int k = 0; k < 4; k++) {
+            results[k] += std::min(a[k][i], value);
+        }
+        total += b[i];
+    }
+    if (sumB != nullptr) {
+        *sumB = total;
+    }
+}
+
+/// Eight codes widened to two float vectors
+inline void loadCodes(const uint8_t* codes, float32x4_t* low, float32x4_t* high) {
+    uint16x8_t wide = vmovl_u8(vld1_u8(codes));
+    *low = vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+    *high = vcvtq_f32_u32(vmovl_u16(vget_high_u16(wide)));
+}
+
+float squaredDifferenceQuantizedNEON(const float* a, const uint8_t* codes, int n, float scale) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t c0, c1;
+        loadCodes(codes + i, &c0, &c1);
+        float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vmulq_n_f32(c0, scale));
+        float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vmulq_n_f32(c1, scale));
+        acc0 = multiplyAdd(acc0, d0, d0);
+        acc1 = multiplyAdd(acc1, d1, d1);
+    }
+    float sum = horizontalSum(vaddq_f32(acc0, acc1));
+    for (; i < n; i++) {
+        float diff = a[i] - scale * codes[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+void dotAndSquaresQuantizedNEON(const float* a, const uint8_t* codes, int n, float scale,
+                                float* dot, float* squaresB) {
+    float32x4_t dot0 = vdupq_n_f32(0.0f);
+    float32x4_t dot1 = vdupq_n_f32(0.0f);
+    float32x4_t sq0 = vdupq_n_f32(0.0f);
+    float32x4_t sq1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t c0, c1;
+        loadCodes(codes + i, &c0, &c1);
+        dot0 = multiplyAdd(dot0, vld1q_f32(a + i), c0);
+        dot1 = multiplyAdd(dot1, vld1q_f32(a + i + 4), c1);
+        sq0 = multiplyAdd(sq0, c0, c0);
+        sq1 = multiplyAdd(sq1, c1, c1);
+    }
+    float d = horizontalSum(vaddq_f32(dot0, dot1));
+    float s = horizontalSum(vaddq_f32(sq0, sq1));
+    for (; i < n; i++) {
+        d += a[i] * codes[i];
+        s += static_cast<float>(codes[i]) * codes[i];
+    }
+    *dot = d * scale;
+    *squaresB = s * scale * scale;
+}
+
+float dotQuantizedNEON(const float* a, const uint8_t* codes, int n, float scale) {
+    float32x4_t dot0 = vdupq_n_f32(0.0f);
+    float32x4_t dot1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t c0, c1;
+        loadCodes(codes + i, &c0, &c1);
+        dot0 = multiplyAdd(dot0, vld1q_f32(a + i), c0);
+        dot1 = multiplyAdd(dot1, vld1q_f32(a + i + 4), c1);
+    }
+    float d = horizontalSum(vaddq_f32(dot0, dot1));
+    for (; i < n; i++) {
+        d += a[i] * codes[i];
+    }
+    return d * scale;
+}
+
+float intersectionQuantizedNEON(const float* a, const uint8_t* codes, int n,
+                                float scale, float* sumCodes) {
+    float32x4_t inter0 = vdupq_n_f32(0.0f);
+    float32x4_t inter1 = vdupq_n_f32(0.0f);
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t c0, c1;
+        loadCodes(codes + i, &c0, &c1);
+        inter0 = vaddq_f32(inter0, vminq_f32(vld1q_f32(a + i), vmulq_n_f32(c0, scale)));
+        inter1 = vaddq_f32(inter1, vminq_f32(vld1q_f32(a + i + 4), vmulq_n_f32(c1, scale)));
+        sum0 = vaddq_f32(sum0, c0);
+        sum1 = vaddq_f32(sum1, c1);
+    }
+    float inter = horizontalSum(vaddq_f32(inter0, inter1));
+    float sum = horizontalSum(vaddq_f32(sum0, sum1));
+    for (; i < n; i++) {
+        inter += std::min(a[i], scale * codes[i]);
+        sum += codes[i];
+    }
+    if (sumCodes != nullptr) {
+        *sumCodes = sum;
+    }
+    return inter;
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Quantise one row
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool quantize(const float* values, int n, uint8_t* row) {
+    float maxValue = 0.0f;
+    for (int i = 0; i < n; i++) {
+        if (!(values[i] >= 0.0f) || !std::isfinite(values[i])) {
+            return false;
+        }
+        maxValue = std::max(maxValue, values[i]);
+    }
+
+    const float scale = maxValue / 255.0f;
+    const float inverse = maxValue > 0.0f ? 255.0f / maxValue : 0.0f;
+    for (int i = 0; i < n; i++) {
+        int code = static_cast<int>(values[i] * inverse + 0.5f);
+        row[i] = static_cast<uint8_t>(std::min(code, 255));
+    }
+
+    const size_t scaleOffset = quantizedRowBytes(n) - sizeof(float);
+    std::memset(row + n, 0, scaleOffset - n);
+    std::memcpy(row + scaleOffset, &scale, sizeof(float));
+    return true;
+}
+
+/**
+ * @brief Expand one quantised row
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void dequantize(const uint8_t* row, int n, float* values) {
+    const float scale = quantizedScale(row, n);
+    for (int i = 0; i < n; i++) {
+        values[i] = scale * row[i];
+    }
+}
+
+/**
+ * @brief Squared difference with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float squaredDifference(const float* a, const float* b, int n) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return squaredDifferenceAVX2(a, b, n);
+    }
+    return squaredDifferenceScalar(a, b, n);
+#elif defined(CBIR_KERNELS_NEON)
+    return squaredDifferenceNEON(a, b, n);
+#else
+    return squaredDifferenceScalar(a, b, n);
+#endif
+}
+
+/**
+ * @brief Dot product and squared norm with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void dotAndSquares(const float* a, const float* b, int n,
+                   float* dot, float* squaresB) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        dotAndSquaresAVX2(a, b, n, dot, squaresB);
+    } else {
+        dotAndSquaresScalar(a, b, n, dot, squaresB);
+    }
+#elif defined(CBIR_KERNELS_NEON)
+    dotAndSquaresNEON(a, b, n, dot, squaresB);
+#else
+    dotAndSquaresScalar(a, b, n, dot, squaresB);
+#endif
+}
+
+/**
+ * @brief Dot product with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float dot(const float* a, const float* b, int n) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return dotAVX2(a, b, n);
+    }
+    return dotScalar(a, b, n);
+#elif defined(CBIR_KERNELS_NEON)
+    return dotNEON(a, b, n);
+#else
+    return dotScalar(a, b, n);
+#endif
+}
+
+/**
+ * @brief Histogram intersection with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float intersection(const float* a, const float* b, int n,
+                   float scale, float* sumB) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return intersectionAVX2(a, b, n, scale, sumB);
+    }
+    return intersectionScalar(a, b, n, scale, sumB);
+#elif defined(CBIR_KERNELS_NEON)
+    return intersectionNEON(a, b, n, scale, sumB);
+#else
+    return intersectionScalar(a, b, n, scale, sumB);
+#endif
+}
+
+/**
+ * @brief Four-query histogram intersection with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void intersection4(const float* const a[4], const float* b, int n,
+                   float scale, float results[4], float* sumB) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        intersection4AVX2(a, b, n, scale, results, sumB);
+    } else {
+        intersection4Scalar(a, b, n, scale, results, sumB);
+    }
+#elif defined(CBIR_KERNELS_NEON)
+    intersection4NEON(a, b, n, scale, results, sumB);
+#else
+    intersection4Scalar(a, b, n, scale, results, sumB);
+#endif
+}
+
+/**
+ * @brief Weighted histogram intersection with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float weightedIntersection(const float* a, const float* b, const float* weights, int n) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return weightedIntersectionAVX2(a, b, weights, n);
+    }
+    return weightedIntersectionScalar(a, b, weights, n);
+#elif defined(CBIR_KERNELS_NEON)
+    return weightedIntersectionNEON(a, b, weights, n);
+#else
+    return weightedIntersectionScalar(a, b, weights, n);
+#endif
+}
+
+/**
+ * @brief Sum with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float sum(const float* a, int n) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return sumAVX2(a, n);
+    }
+    return sumScalar(a, n);
+#elif defined(CBIR_KERNELS_NEON)
+    return sumNEON(a, n);
+#else
+    return sumScalar(a, n);
+#endif
+}
+
+/**
+ * @brief Early-abandoning squared difference with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float squaredDifferenceBounded(const float* a, const float* b, int n, float cutoff) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return squaredDifferenceBoundedAVX2(a, b, n, cutoff);
+    }
+    return squaredDifferenceBoundedScalar(a, b, n, cutoff);
+#elif defined(CBIR_KERNELS_NEON)
+    return squaredDifferenceBoundedNEON(a, b, n, cutoff);
+#else
+    return squaredDifferenceBoundedScalar(a, b, n, cutoff);
+#endif
+}
+
+/**
+ * @brief Early-abandoning histogram intersection with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool intersectionBounded(const float* a, const float* b, int n, float sumA,
+                         float maxDistance, float* result, float* sumB) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return intersectionBoundedAVX2(a, b, n, sumA, maxDistance, result, sumB);
+    }
+    return intersectionBoundedScalar(a, b, n, sumA, maxDistance, result, sumB);
+#elif defined(CBIR_KERNELS_NEON)
+    return intersectionBoundedNEON(a, b, n, sumA, maxDistance, result, sumB);
+#else
+    return intersectionBoundedScalar(a, b, n, sumA, maxDistance, result, sumB);
+#endif
+}
+
+/**
+ * @brief Quantised squared difference with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float squaredDifferenceQuantized(const float* a, const uint8_t* codes, int n, float scale) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return squaredDifferenceQuantizedAVX2(a, codes, n, scale);
+    }
+    return squaredDifferenceQuantizedScalar(a, codes, n, scale);
+#elif defined(CBIR_KERNELS_NEON)
+    return squaredDifferenceQuantizedNEON(a, codes, n, scale);
+#else
+    return squaredDifferenceQuantizedScalar(a, codes, n, scale);
+#endif
+}
+
+/**
+ * @brief Quantised dot product and squared norm with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void dotAndSquaresQuantized(const float* a, const uint8_t* codes, int n, float scale,
+                            float* dot, float* squaresB) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        dotAndSquaresQuantizedAVX2(a, codes, n, scale, dot, squaresB);
+    } else {
+        dotAndSquaresQuantizedScalar(a, codes, n, scale, dot, squaresB);
+    }
+#elif defined(CBIR_KERNELS_NEON)
+    dotAndSquaresQuantizedNEON(a, codes, n, scale, dot, squaresB);
+#else
+    dotAndSquaresQuantizedScalar(a, codes, n, scale, dot, squaresB);
+#endif
+}
+
+/**
+ * @brief Quantised dot product with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float dotQuantized(const float* a, const uint8_t* codes, int n, float scale) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return dotQuantizedAVX2(a, codes, n, scale);
+    }
+    return dotQuantizedScalar(a, codes, n, scale);
+#elif defined(CBIR_KERNELS_NEON)
+    return dotQuantizedNEON(a, codes, n, scale);
+#else
+    return dotQuantizedScalar(a, codes, n, scale);
+#endif
+}
+
+/**
+ * @brief Quantised histogram intersection with runtime dispatch
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float intersectionQuantized(const float* a, const uint8_t* codes, int n,
+                            float scale, float* sumCodes) {
+#if defined(CBIR_KERNELS_AVX2)
+    if (useAVX2()) {
+        return intersectionQuantizedAVX2(a, codes, n, scale, sumCodes);
+    }
+    return intersectionQuantizedScalar(a, codes, n, scale, sumCodes);
+#elif defined(CBIR_KERNELS_NEON)
+    return intersectionQuantizedNEON(a, codes, n, scale, sumCodes);
+#else
+    return intersectionQuantizedScalar(a, codes, n, scale, sumCodes);
+#endif
+}
+
+/**
+ * @brief Active instruction set
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const char* instructionSet() {
+#if defined(CBIR_KERNELS_AVX2)
+    return useAVX2() ? "AVX2" : "scalar";
+#elif defined(CBIR_KERNELS_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace DistanceKernels
+} // namespace cbir
@@ -1,19 +1,178 @@
 ////////////////////////////////////////////////////////////////////////////////
 // DistanceMetric.cpp
 // Author: Krushna Sanjay Sharma
-// Description: Implementation of the DistanceMetric base class. Currently
-//              contains only the base functionality as all methods are either
-//              pure virtual or implemented inline in the header.
+// Description: Implementation of the DistanceMetric base class: the default
+//              row-by-row computeBatch() and the batch driver shared by the
+//              vectorised metrics.
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "DistanceMetric.h"
+#include "DistanceKernels.h"
+#include <iostream>
+#include <algorithm>
 
 namespace cbir {
 
-// Base class implementation
-// All methods are currently pure virtual or implemented in the header file.
-// This file serves as a placeholder for any future common functionality
-// that may be needed across all distance metrics.
+/**
+ * @brief Default batch implementation: compute() for every row
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DistanceMetric::computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                                  cv::Mat& out) {
+    return runBatch(query, matrix, out,
+                    [this](const float* queryData, const float* rowData, int length) {
+        // Wrap both arrays as 1 x length vectors so compute() sees the same
+        // shapes as it does for vectors loaded one at a time
+        cv::Mat queryRow(1, length, CV_32F, const_cast<float*>(queryData));
+        cv::Mat dbRow(1, length, CV_32F, const_cast<float*>(rowData));
+        return compute(queryRow, dbRow);
+    });
+}
 
-} // namespace cbir
\ No newline at end of file
+/**
+ * @brief Default block implementation: computeBatch() for every query
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DistanceMetric::computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                                  cv::Mat& out) {
+    if (!checkBlock(queries, matrix)) {
+        return false;
+    }
+
+    out.create(queries.rows, matrix.rows, CV_64F);
+    cv::Mat column;
+    for (int q = 0; q < queries.rows; q++) {
+        if (!computeBatch(queries.row(q), matrix, column)) {
+            return false;
+        }
+        double* distances = out.ptr<double>(q);
+        for (int row = 0; row < matrix.rows; row++) {
+            distances[row] = column.at<double>(row);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Default normed batch: row norms are not needed
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DistanceMetric::computeBatchNormed(const cv::Mat& query, const cv::Mat& matrix,
+                                        const cv::Mat& rowNorms, cv::Mat& out) {
+    (void)rowNorms;
+    return computeBatch(query, matrix, out);
+}
+
+/**
+ * @brief Default normed block: row norms are not needed
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DistanceMetric::computeBlockNormed(const cv::Mat& queries, const cv::Mat& matrix,
+                                        const cv::Mat& rowNorms, cv::Mat& out) {
+    (void)rowNorms;
+    return computeBlock(queries, matrix, out);
+}
+
+/**
+ * @brief Default cutoff implementation: the full compute()
+ *
+ * @author Krushna Sanjay Sharma
+ */
+double DistanceMetric::computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                         double cutoff) {
+    (void)cutoff;
+    return compute(features1, features2);
+}
+
+/**
+ * @brief Validate a query for computeBatch()
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DistanceMetric::checkBatch(const cv::Mat& query, const cv::Mat& matrix) const {
+    const bool quantized = matrix.type() == CV_8U;
+    if (query.empty() || matrix.empty() || query.type() != CV_32F ||
+        static_cast<int>(query.total()) != matrix.cols ||
+        (matrix.type() != CV_32F && matrix.type() != CV_16F && !quantized) ||
+        (quantized && matrix.rows > 1 &&
+         matrix.step[0] < DistanceKernels::quantizedRowBytes(matrix.cols))) {
+        std::cerr << "Error: Query and feature matrix are not compatible for "
+                  << getMetricName() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Widen a block of float16 / quantised rows to float32
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void DistanceMetric::widenRows(const cv::Mat& matrix, int start, int end, cv::Mat& staging) {
+    if (matrix.type() == CV_8U) {
+        staging.create(end - start, matrix.cols, CV_32F);
+        for (int row = start; row < end; row++) {
+            DistanceKernels::dequantize(matrix.ptr<uint8_t>(row), matrix.cols,
+                                        staging.ptr<float>(row - start));
+        }
+    } else {
+        matrix.rowRange(start, end).convertTo(staging, CV_32F);
+    }
+}
+
+float DistanceMetric::quantizedRowScale(const uint8_t* codes, int length) {
+    return DistanceKernels::quantizedScale(codes, length);
+}
+
+/**
+ * @brief Validate a query block for computeBlock()
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DistanceMetric::checkBlock(const cv::Mat& queries, const cv::Mat& matrix) const {
+    const bool quantized = matrix.type() == CV_8U;
+    if (queries.empty() || matrix.empty() || queries.type() != CV_32F ||
+        queries.cols != matrix.cols ||
+        (matrix.type() != CV_32F && matrix.type() != CV_16F && !quantized) ||
+        (quantized && matrix.rows > 1 &&
+         matrix.step[0] < DistanceKernels::quantizedRowBytes(matrix.cols))) {
+        std::cerr << "Error: Query block and feature matrix are not compatible for "
+                  << getMetricName() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Widen float16 / quantised rows once for a whole query block
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat DistanceMetric::floatRows(const cv::Mat& matrix, cv::Mat& staging) {
+    if (matrix.type() == CV_32F) {
+        return matrix;
+    }
+    if (matrix.type() == CV_8U) {
+        staging.create(matrix.rows, matrix.cols, CV_32F);
+        for (int row = 0; row < matrix.rows; row++) {
+            DistanceKernels::dequantize(matrix.ptr<uint8_t>(row), matrix.cols,
+                                        staging.ptr<float>(row));
+        }
+    } else {
+        matrix.convertTo(staging, CV_32F);
+    }
+    return staging;
+}
+
+bool DistanceMetric::areFloatArrays(const cv::Mat& features1, const cv::Mat& features2) {
+    return !features1.empty() && features1.type() == CV_32F && features1.isContinuous() &&
+           !features2.empty() && features2.type() == CV_32F && features2.isContinuous() &&
+           features1.total() == features2.total();
+}
+
+} // namespace cbir
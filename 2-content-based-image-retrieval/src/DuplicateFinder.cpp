@@ -0,0 +1,342 @@
+////////////////////////////////////////////////////////////////////////////////
+// DuplicateFinder.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of near-duplicate detection: blocked
+//              hyperplane signatures, per-band bucketing by sorting,
+//              parallel verification of candidate pairs and union-find
+//              clustering.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DuplicateFinder.h"
+#include "DistanceKernels.h"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+namespace cbir {
+
+namespace {
+
+/// Rows hashed per block (one matrix product per block)
+const int SIGNATURE_BLOCK_ROWS = 4096;
+
+/// Candidate pairs verified per parallel batch
+const size_t VERIFY_BATCH_PAIRS = 1 << 20;
+
+double elapsedMs(int64 start) {
+    return 1000.0 * (cv::getTickCount() - start) / cv::getTickFrequency();
+}
+
+/// Rows [start, end) of the packed matrix as float32
+void widenRows(const cv::Mat& matrix, int start, int end, cv::Mat& staging) {
+    if (matrix.type() == CV_8U) {
+        staging.create(end - start, matrix.cols, CV_32F);
+        for (int row = start; row < end; row++) {
+            DistanceKernels::dequantize(matrix.ptr<uint8_t>(row), matrix.cols,
+                                        staging.ptr<float>(row - start));
+        }
+    } else {
+        matrix.rowRange(start, end).convertTo(staging, CV_32F);
+    }
+}
+
+/// Scale every row to unit L2 norm (zero rows are left as they are)
+void normalizeRows(cv::Mat& rows) {
+    for (int row = 0; row < rows.rows; row++) {
+        float* values = rows.ptr<float>(row);
+        double squares = 0.0;
+        for (int i = 0; i < rows.cols; i++) {
+            squares += static_cast<double>(values[i]) * values[i];
+        }
+        if (squares > 1e-20) {
+            const float inverse = static_cast<float>(1.0 / std::sqrt(squares));
+            for (int i = 0; i < rows.cols; i++) {
+                values[i] *= inverse;
+            }
+        }
+    }
+}
+
+/// Union-find with path halving and union by size
+class DisjointSets {
+public:
+    explicit DisjointSets(size_t count) : parent_(count), size_(count, 1) {
+        std::iota(parent_.begin(), parent_.end(), 0u);
+    }
+
+    uint32_t find(uint32_t item) {
+        while (parent_[item] != item) {
+            parent_[item] = parent_[parent_[item]];
+            item = parent_[item];
+        }
+        return item;
+    }
+
+    void join(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (size_[a] < size_[b]) {
+            std::swap(a, b);
+        }
+        parent_[b] = a;
+        size_[a] += size_[b];
+    }
+
+private:
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> size_;
+};
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+DuplicateFinder::DuplicateFinder(const DuplicateOptions& options) : options_(options) {
+}
+
+/**
+ * @brief Find the duplicate clusters of a database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool DuplicateFinder::find(const FeatureDatabase& database, DistanceMetric& metric,
+                           std::vector<std::vector<int>>& clusters) {
+    clusters.clear();
+    stats_ = DuplicateStats();
+    if (options_.bands < 1 || options_.bandBits < 1 || options_.bandBits > 32) {
+        std::cerr << "Error: Duplicate search needs at least one band of 1-32 bits" << std::endl;
+        return false;
+    }
+    if (database.size() > UINT32_MAX) {
+        std::cerr << "Error: Database too large for duplicate search" << std::endl;
+        return false;
+    }
+    if (database.size() < 2) {
+        return true;
+    }
+
+    const cv::Mat matrix = database.matrix();
+    const cv::Mat rowNorms = metric.usesRowNorms() ? database.rowNorms() : cv::Mat();
+    const int rows = matrix.rows;
+    const int bands = options_.bands;
+
+    int64 start = cv::getTickCount();
+    computeSignatures(matrix);
+    stats_.signatureMs = elapsedMs(start);
+
+    start = cv::getTickCount();
+    DisjointSets sets(rows);
+    std::vector<uint64_t> entries(rows);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::vector<uint8_t> matched;
+    pairs.reserve(std::min(VERIFY_BATCH_PAIRS, static_cast<size_t>(rows) * 4));
+
+    // Verify the pending pairs in parallel, then join the matches
+    auto verify = [&]() -> bool {
+        if (pairs.empty()) {
+            return true;
+        }
+        matched.assign(pairs.size(), 0);
+        std::atomic<bool> failed(false);
+        const int chunks = static_cast<int>((pairs.size() + 4095) / 4096);
+        cv::parallel_for_(cv::Range(0, chunks), [&](const cv::Range& range) {
+            cv::Mat staging;
+            cv::Mat query;
+            cv::Mat distance(1, 1, CV_64F);
+            int64_t widened = -1;
+            for (int chunk = range.start; chunk < range.end && !failed; chunk++) {
+                const size_t end = std::min(pairs.size(), static_cast<size_t>(chunk + 1) * 4096);
+                for (size_t p = static_cast<size_t>(chunk) * 4096; p < end; p++) {
+                    const int a = static_cast<int>(pairs[p].first);
+                    const int b = static_cast<int>(pairs[p].second);
+                    if (widened != a) {
+                        if (matrix.type() == CV_32F) {
+                            query = matrix.row(a);
+                        } else {
+                            widenRows(matrix, a, a + 1, staging);
+                            query = staging;
+                        }
+                        widened = a;
+                    }
+                    const cv::Mat norms = rowNorms.empty() ? cv::Mat() : rowNorms.rowRange(b, b + 1);
+                    if (!metric.computeBatchNormed(query, matrix.rowRange(b, b + 1), norms,
+                                                   distance)) {
+                        failed = true;
+                        break;
+                    }
+                    matched[p] = distance.at<double>(0) <= options_.threshold;
+                }
+            }
+        });
+        if (failed) {
+            std::cerr << "Error: Metric " << metric.getMetricName()
+                      << " cannot compare the database rows" << std::endl;
+            return false;
+        }
+        stats_.candidatePairs += pairs.size();
+        for (size_t p = 0; p < pairs.size(); p++) {
+            if (matched[p]) {
+                sets.join(pairs[p].first, pairs[p].second);
+                stats_.duplicatePairs++;
+            }
+        }
+        pairs.clear();
+        return true;
+    };
+
+    for (int band = 0; band < bands; band++) {
+        for (int row = 0; row < rows; row++) {
+            entries[row] = (static_cast<uint64_t>(keys_[static_cast<size_t>(row) * bands + band])
+                            << 32) | static_cast<uint32_t>(row);
+        }
+        std::sort(entries.begin(), entries.end());
+
+        size_t first = 0;
+        while (first < entries.size()) {
+            size_t last = first + 1;
+            while (last < entries.size() && (entries[last] >> 32) == (entries[first] >> 32)) {
+                last++;
+            }
+            const size_t bucket = last - first;
+            if (bucket > options_.maxBucket) {
+                stats_.skippedBuckets++;
+            } else {
+                for (size_t i = first; i + 1 < last; i++) {
+                    const uint32_t a = static_cast<uint32_t>(entries[i]);
+                    for (size_t j = i + 1; j < last; j++) {
+                        const uint32_t b = static_cast<uint32_t>(entries[j]);
+                        // Checked in an earlier band, or already linked
+                        if (collidedEarlier(a, b, band) || sets.find(a) == sets.find(b)) {
+                            continue;
+                        }
+                        pairs.emplace_back(a, b);
+                        if (pairs.size() >= VERIFY_BATCH_PAIRS && !verify()) {
+                            return false;
+                        }
+                    }
+                }
+            }
+            first = last;
+        }
+        if (!verify()) {
+            return false;
+        }
+    }
+
+    // Connected components of two or more rows
+    std::vector<int> clusterOf(rows, -1);
+    std::vector<uint32_t> members(rows, 0);
+    for (int row = 0; row < rows; row++) {
+        members[sets.find(row)]++;
+    }
+    for (int row = 0; row < rows; row++) {
+        const uint32_t root = sets.find(row);
+        if (members[root] < 2) {
+            continue;
+        }
+        if (clusterOf[root] < 0) {
+            clusterOf[root] = static_cast<int>(clusters.size());
+            clusters.emplace_back();
+            clusters.back().reserve(members[root]);
+        }
+        clusters[clusterOf[root]].push_back(row);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const std::vector<int>& a, const std::vector<int>& b) {
+                         return a.size() > b.size();
+                     });
+    stats_.verifyMs = elapsedMs(start);
+    return true;
+}
+
+/**
+ * @brief Compute the band keys of every row
+ *
+ * A first pass accumulates the mean normalised row; the second projects
+ * blocks of centred rows onto the hyperplanes with one matrix product per
+ * block. Both passes stream the matrix in blocks, so a mapped database is
+ * read twice and never widened as a whole.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void DuplicateFinder::computeSignatures(const cv::Mat& matrix) {
+    const int rows = matrix.rows;
+    const int dimension = matrix.cols;
+    const int bands = options_.bands;
+    const int bits = bands * options_.bandBits;
+    const int blockCount = (rows + SIGNATURE_BLOCK_ROWS - 1) / SIGNATURE_BLOCK_ROWS;
+
+    cv::Mat mean = cv::Mat::zeros(1, dimension, CV_64F);
+    cv::Mutex meanMutex;
+    cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+        cv::Mat staging;
+        cv::Mat sum = cv::Mat::zeros(1, dimension, CV_64F);
+        for (int block = range.start; block < range.end; block++) {
+            const int start = block * SIGNATURE_BLOCK_ROWS;
+            const int end = std::min(rows, start + SIGNATURE_BLOCK_ROWS);
+            widenRows(matrix, start, end, staging);
+            normalizeRows(staging);
+            cv::Mat blockSum;
+            cv::reduce(staging, blockSum, 0, cv::REDUCE_SUM, CV_64F);
+            sum += blockSum;
+        }
+        cv::AutoLock lock(meanMutex);
+        mean += sum;
+    });
+    mean /= rows;
+    cv::Mat meanRow;
+    mean.convertTo(meanRow, CV_32F);
+
+    cv::Mat planes(dimension, bits, CV_32F);
+    cv::RNG rng(options_.seed);
+    rng.fill(planes, cv::RNG::NORMAL, 0.0, 1.0);
+
+    keys_.assign(static_cast<size_t>(rows) * bands, 0);
+    cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+        cv::Mat staging;
+        cv::Mat projections;
+        for (int block = range.start; block < range.end; block++) {
+            const int start = block * SIGNATURE_BLOCK_ROWS;
+            const int end = std::min(rows, start + SIGNATURE_BLOCK_ROWS);
+            widenRows(matrix, start, end, staging);
+            normalizeRows(staging);
+            for (int row = 0; row < staging.rows; row++) {
+                staging.row(row) -= meanRow;
+            }
+            cv::gemm(staging, planes, 1.0, cv::noArray(), 0.0, projections);
+            for (int row = 0; row < projections.rows; row++) {
+                const float* values = projections.ptr<float>(row);
+                uint32_t* keys = &keys_[static_cast<size_t>(start + row) * bands];
+                for (int band = 0; band < bands; band++) {
+                    uint32_t key = 0;
+                    for (int bit = 0; bit < options_.bandBits; bit++) {
+                        key = (key << 1) | (values[band * options_.bandBits + bit] > 0.0f);
+                    }
+                    keys[band] = key;
+                }
+            }
+        }
+    });
+}
+
+bool DuplicateFinder::collidedEarlier(int a, int b, int band) const {
+    const uint32_t* keysA = &keys_[static_cast<size_t>(a) * options_.bands];
+    const uint32_t* keysB = &keys_[static_cast<size_t>(b) * options_.bands];
+    for (int earlier = 0; earlier < band; earlier++) {
+        if (keysA[earlier] == keysB[earlier]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace cbir
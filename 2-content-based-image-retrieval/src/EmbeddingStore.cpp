@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// EmbeddingStore.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the shared embedding store: one-time CSV to
+//              binary conversion, memory-mapped loading and the process-wide
+//              registry of open stores.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "EmbeddingStore.h"
+#include "DeltaLog.h"
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace cbir {
+
+namespace {
+
+/// Live stores by absolute path; entries expire with their last holder
+std::mutex registryMutex;
+std::map<std::string, std::weak_ptr<const EmbeddingStore>> registry;
+
+std::string registryKey(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    return error ? path : absolute.lexically_normal().string();
+}
+
+/// True if the cache exists and is at least as new as the CSV
+bool cacheIsCurrent(const std::string& csvPath, const std::string& cache) {
+    const FileStamp cacheStamp = FileStamp::of(cache, false);
+    if (cacheStamp.modified == 0) {
+        return false;
+    }
+    const FileStamp csvStamp = FileStamp::of(csvPath, false);
+    return csvStamp.modified == 0 || cacheStamp.modified >= csvStamp.modified;
+}
+
+} // namespace
+
+/**
+ * @brief Return the live store for a path or load a new one
+ *
+ * Loading happens under the registry lock so concurrent opens of the same
+ * file convert and map it only once.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::shared_ptr<const EmbeddingStore> EmbeddingStore::open(const std::string& path) {
+    const std::string key = registryKey(path);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = registry.find(key);
+    if (it != registry.end()) {
+        if (auto store = it->second.lock()) {
+            return store;
+        }
+    }
+
+    std::shared_ptr<EmbeddingStore> store(new EmbeddingStore());
+    store->path_ = path;
+    if (!store->load(path)) {
+        registry.erase(key);
+        return nullptr;
+    }
+
+    registry[key] = store;
+    return store;
+}
+
+std::string EmbeddingStore::cachePath(const std::string& csvPath) {
+    return csvPath + ".fdb";
+}
+
+cv::Mat EmbeddingStore::lookup(const std::string& filename) const {
+    return database_.getFeatures(filename);
+}
+
+/**
+ * @brief Map the binary cache, converting the CSV first when needed
+ *
+ * The cache is written to a temporary file and renamed into place, so a
+ * second process opening the same CSV never maps a partial file.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool EmbeddingStore::load(const std::string& path) {
+    if (FeatureDatabase::isBinaryFile(path)) {
+        return database_.loadFromBinary(path, true);
+    }
+
+    const std::string cache = cachePath(path);
+    if (cacheIsCurrent(path, cache) && database_.loadFromBinary(cache, true)) {
+        std::cout << "Mapped " << database_.size() << " embeddings from " << cache << std::endl;
+        return true;
+    }
+
+    if (!database_.loadFromCSV(path)) {
+        std::cerr << "Error: Cannot load embeddings from " << path << std::endl;
+        return false;
+    }
+
+    const std::string temporary = cache + ".tmp";
+    std::error_code error;
+    if (database_.saveToBinary(temporary, FeatureStorage::Float32)) {
+        std::filesystem::rename(temporary, cache, error);
+        if (!error && database_.loadFromBinary(cache, true)) {
+            return true;
+        }
+        std::filesystem::remove(temporary, error);
+        // A failed reload cleared the rows; fall back to the CSV once more
+        if (database_.empty() && !database_.loadFromCSV(path)) {
+            return false;
+        }
+    }
+
+    std::cerr << "Warning: Could not write embedding cache " << cache
+              << "; keeping " << database_.size() << " rows in memory" << std::endl;
+    return true;
+}
+
+} // namespace cbir
@@ -9,7 +9,27 @@
 
 namespace cbir {
 
-FaceAwareDistance::FaceAwareDistance() {
+FaceAwareDistance::FaceAwareDistance()
+    : faceFusion_({
+          {LateFusion::SEGMENT_COSINE, 0, 512, 0.5},
+          {LateFusion::SEGMENT_EUCLIDEAN, 512, 1, 0.1},
+          {LateFusion::SEGMENT_INTERSECTION, 513, 512, 0.3},
+          {LateFusion::SEGMENT_EUCLIDEAN, 1025, 4, 0.1}
+      }),
+      nonFaceFusion_({
+          {LateFusion::SEGMENT_COSINE, 0, 512, 0.85},
+          {LateFusion::SEGMENT_INTERSECTION, 512, 512, 0.15}
+      }) {
+}
+
+const LateFusion* FaceAwareDistance::fusionFor(int dimension) const {
+    if (dimension == faceFusion_.dimension()) {
+        return &faceFusion_;
+    }
+    if (dimension == nonFaceFusion_.dimension()) {
+        return &nonFaceFusion_;
+    }
+    return nullptr;
 }
 
 double FaceAwareDistance::compute(const cv::Mat& features1, 
@@ -32,6 +52,39 @@ double FaceAwareDistance::compute(const cv::Mat& features1,
     }
 }
 
+bool FaceAwareDistance::computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                                     cv::Mat& out) {
+    if (!checkBatch(query, matrix)) {
+        return false;
+    }
+    const LateFusion* fusion = fusionFor(matrix.cols);
+    if (fusion == nullptr) {
+        std::cerr << "Error: Unknown feature dimension: " << matrix.cols << std::endl;
+        return false;
+    }
+    
+    cv::Mat queryData = query.isContinuous() ? query : query.clone();
+    LateFusion::Query prepared;
+    fusion->prepare(queryData.ptr<float>(), prepared);
+    
+    return runBatch(queryData, matrix, out,
+                    [fusion, &prepared](const float*, const float* rowData, int) {
+        return fusion->score(prepared, rowData);
+    });
+}
+
+double FaceAwareDistance::computeWithCutoff(const cv::Mat& features1,
+                                            const cv::Mat& features2, double cutoff) {
+    const LateFusion* fusion = fusionFor(static_cast<int>(features1.total()));
+    if (!areFloatArrays(features1, features2) || fusion == nullptr) {
+        return compute(features1, features2);
+    }
+    
+    LateFusion::Query prepared;
+    fusion->prepare(features1.ptr<float>(), prepared);
+    return fusion->scoreWithCutoff(prepared, features2.ptr<float>(), cutoff);
+}
+
 std::string FaceAwareDistance::getMetricName() const {
     return "FaceAwareDistance";
 }
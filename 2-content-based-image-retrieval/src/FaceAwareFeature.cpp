@@ -6,7 +6,8 @@
 //              features depending on image content.
 //
 // Face Detection:
-//   Uses OpenCV Haar Cascade classifier (same as your previous project)
+//   YuNet (cv::FaceDetectorYN through cvcore::FaceDetectorService) when its
+//   model is available, otherwise the OpenCV Haar Cascade classifier
 //
 // Feature Extraction Strategy:
 //   WITH faces: [DNN, face_count, face_colors, spatial_layout]
@@ -19,34 +20,76 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "FaceAwareFeature.h"
+#include "ImageContext.h"
 #include "Utils.h"
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 namespace cbir {
 
+namespace {
+
+/// Longest side of the image the detector runs on; larger images are shrunk
+const int DETECTION_MAX_SIDE = 640;
+
+/// Cascade parameters (minimum face size is in full-size pixels)
+const double DETECTION_SCALE_FACTOR = 1.1;
+const int DETECTION_MIN_NEIGHBORS = 3;
+const int DETECTION_MIN_FACE = 30;
+
+/// Smallest window the frontal-face cascades can evaluate
+const int CASCADE_WINDOW = 24;
+
+} // namespace
+
 /**
  * Constructor
  */
 FaceAwareFeature::FaceAwareFeature(const std::string& dnnCsvPath,
-                                 const std::string& cascadePath)
+                                 const std::string& cascadePath,
+                                 const std::string& yunetPath)
     : dnnExtractor_(dnnCsvPath),
       productMatcher_(dnnCsvPath, 0.5, 8),
       lastHadFaces_(false),
       lastFaceCount_(0) {
     
-    // Load Haar cascade for face detection
+    // YuNet first: faster per image and far fewer false positives
+    if (!yunetPath.empty() && std::ifstream(yunetPath).good()) {
+        yunet_ = cvcore::FaceDetectorService::shared(yunetPath);
+    }
+    if (yunet_) {
+        std::cout << "YuNet face detector loaded successfully" << std::endl;
+        std::ostringstream tag;
+        tag << yunet_->tag() << ",side=" << DETECTION_MAX_SIDE;
+        faceCache_ = FaceBoxCache::open(FaceBoxCache::pathFor(dnnCsvPath), tag.str());
+        return;
+    }
+    
+    // Fallback: Haar cascade
+    std::string loadedCascade = cascadePath;
     if (!faceCascade_.load(cascadePath)) {
         std::cerr << "Warning: Failed to load Haar cascade: " << cascadePath << std::endl;
         std::cerr << "Trying default location..." << std::endl;
         
         // Try common locations
-        if (!faceCascade_.load("haarcascade_frontalface_alt2.xml")) {
+        loadedCascade = "haarcascade_frontalface_alt2.xml";
+        if (!faceCascade_.load(loadedCascade)) {
             std::cerr << "Error: Could not load face detector!" << std::endl;
             std::cerr << "Face detection will be disabled." << std::endl;
+            return;
         }
     } else {
         std::cout << "Face detector loaded successfully" << std::endl;
     }
+    
+    // Boxes depend only on the detector input, so they are cached beside the
+    // embeddings for every build and query that uses the same detector
+    std::ostringstream tag;
+    tag << Utils::getFilename(loadedCascade) << ",scale=" << DETECTION_SCALE_FACTOR
+        << ",neighbors=" << DETECTION_MIN_NEIGHBORS << ",min=" << DETECTION_MIN_FACE
+        << ",side=" << DETECTION_MAX_SIDE;
+    faceCache_ = FaceBoxCache::open(FaceBoxCache::pathFor(dnnCsvPath), tag.str());
 }
 
 /**
@@ -76,7 +119,32 @@ cv::Mat FaceAwareFeature::extractFeaturesWithFilename(const cv::Mat& image,
     
     // Detect faces in image
     std::vector<cv::Rect> faces = detectFaces(image);
+    return extractAdaptive(image, faces, filename);
+}
+
+/**
+ * Extract adaptive features from a shared context
+ */
+cv::Mat FaceAwareFeature::extractFromContext(ImageContext& context) {
+    if (!isValidImage(context.image())) {
+        std::cerr << "Error: Invalid image for FaceAware extraction" << std::endl;
+        return cv::Mat();
+    }
     
+    // YuNet runs on colour, the cascade on the context's equalized gray
+    const std::vector<cv::Rect>& faces = context.faces(
+        [this, &context](const cv::Mat& equalizedGray) {
+            return detectInDetectorInput(yunet_ ? context.color() : equalizedGray);
+        });
+    return extractAdaptive(context.image(), faces, context.filename());
+}
+
+/**
+ * Use face-based features when faces were found, ProductMatcher otherwise
+ */
+cv::Mat FaceAwareFeature::extractAdaptive(const cv::Mat& image,
+                                          const std::vector<cv::Rect>& faces,
+                                          const std::string& filename) {
     // Update state
     lastFaceCount_ = static_cast<int>(faces.size());
     lastHadFaces_ = (lastFaceCount_ > 0);
@@ -98,19 +166,30 @@ std::string FaceAwareFeature::getFeatureName() const {
     return "FaceAware_Adaptive";
 }
 
+std::string FaceAwareFeature::getDetectorName() const {
+    if (yunet_) {
+        return "YuNet";
+    }
+    return faceCascade_.empty() ? "none" : "Haar";
+}
+
 int FaceAwareFeature::getFeatureDimension() const {
     // Maximum dimension (face mode)
     return 512 + 1 + 512 + 4;  // DNN + count + color + spatial = 1029
 }
 
 /**
- * Detect faces using Haar cascade
+ * Detect faces with YuNet, or the Haar cascade
  * 
- * Uses OpenCV's cascade classifier (same approach as your video project)
+ * YuNet takes the image as is; the cascade gets equalized grayscale
  */
 std::vector<cv::Rect> FaceAwareFeature::detectFaces(const cv::Mat& image) {
     std::vector<cv::Rect> faces;
     
+    if (yunet_) {
+        return detectInDetectorInput(image);
+    }
+    
     // Check if cascade is loaded
     if (faceCascade_.empty()) {
         return faces;  // Return empty if detector not loaded
@@ -127,15 +206,65 @@ std::vector<cv::Rect> FaceAwareFeature::detectFaces(const cv::Mat& image) {
     // Equalize histogram for better detection
     cv::equalizeHist(gray, gray);
     
-    // Detect faces
-    faceCascade_.detectMultiScale(
-        gray,
-        faces,
-        1.1,        // Scale factor
-        3,          // Min neighbors
-        0,          // Flags
-        cv::Size(30, 30)  // Min size
-    );
+    return detectInDetectorInput(gray);
+}
+
+/**
+ * Run YuNet or the Haar cascade on the detector input
+ * 
+ * Images larger than DETECTION_MAX_SIDE are shrunk first, which keeps the
+ * detector's cost independent of the decode size; boxes are scaled back to
+ * the input. Results come from the face cache when this detector input
+ * has been seen before.
+ */
+std::vector<cv::Rect> FaceAwareFeature::detectInDetectorInput(const cv::Mat& detectorInput) {
+    std::vector<cv::Rect> faces;
+    if ((!yunet_ && faceCascade_.empty()) || detectorInput.empty()) {
+        return faces;
+    }
+    
+    const int longest = std::max(detectorInput.rows, detectorInput.cols);
+    const double scale = longest > DETECTION_MAX_SIDE
+                             ? static_cast<double>(DETECTION_MAX_SIDE) / longest : 1.0;
+    cv::Mat input = detectorInput;
+    if (scale < 1.0) {
+        cv::resize(detectorInput, input,
+                   cv::Size(std::max(1, static_cast<int>(detectorInput.cols * scale + 0.5)),
+                            std::max(1, static_cast<int>(detectorInput.rows * scale + 0.5))),
+                   0, 0, cv::INTER_AREA);
+    }
+    
+    const uint64_t key = faceCache_ ? FaceBoxCache::hashImage(input) : 0;
+    if (!faceCache_ || !faceCache_->find(key, faces)) {
+        if (yunet_) {
+            // Shared pool: concurrent build workers detect in parallel
+            faces = yunet_->detect(input);
+        } else {
+            const int minFace = std::max(CASCADE_WINDOW,
+                                         static_cast<int>(DETECTION_MIN_FACE * scale + 0.5));
+            faceCascade_.detectMultiScale(
+                input,
+                faces,
+                DETECTION_SCALE_FACTOR,
+                DETECTION_MIN_NEIGHBORS,
+                0,                          // Flags
+                cv::Size(minFace, minFace)
+            );
+        }
+        if (faceCache_) {
+            faceCache_->insert(key, faces);
+        }
+    }
+    
+    // Back to input coordinates
+    if (scale < 1.0) {
+        const cv::Rect bounds(0, 0, detectorInput.cols, detectorInput.rows);
+        for (cv::Rect& face : faces) {
+            face = cv::Rect(static_cast<int>(face.x / scale), static_cast<int>(face.y / scale),
+                            static_cast<int>(face.width / scale),
+                            static_cast<int>(face.height / scale)) & bounds;
+        }
+    }
     
     return faces;
 }
@@ -0,0 +1,241 @@
+////////////////////////////////////////////////////////////////////////////////
+// FaceBoxCache.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the persistent face box cache: sidecar
+//              parsing, append-only writes and the registry of open caches.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "FaceBoxCache.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace cbir {
+
+namespace {
+
+/// First characters of the sidecar's header line
+const char* const FACES_TAG = "#faces,";
+
+/// Entries appended between flushes
+const size_t FLUSH_INTERVAL = 64;
+
+/// Live caches by absolute path; entries expire with their last holder
+std::mutex registryMutex;
+std::map<std::string, std::weak_ptr<FaceBoxCache>> registry;
+
+std::string registryKey(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    return error ? path : absolute.lexically_normal().string();
+}
+
+/// Parse "<hash hex>,<count>,x,y,w,h,..."; false if malformed
+bool parseEntry(const std::string& line, uint64_t& key, std::vector<cv::Rect>& faces) {
+    const char* position = line.c_str();
+    char* end = nullptr;
+    key = std::strtoull(position, &end, 16);
+    if (end == position || *end != ',') {
+        return false;
+    }
+    position = end + 1;
+    const long count = std::strtol(position, &end, 10);
+    if (end == position || count < 0) {
+        return false;
+    }
+
+    faces.clear();
+    for (long i = 0; i < count; i++) {
+        int values[4];
+        for (int& value : values) {
+            if (*end != ',') {
+                return false;
+            }
+            position = end + 1;
+            value = static_cast<int>(std::strtol(position, &end, 10));
+            if (end == position) {
+                return false;
+            }
+        }
+        faces.emplace_back(values[0], values[1], values[2], values[3]);
+    }
+    return *end == '\0';
+}
+
+} // namespace
+
+/**
+ * @brief Return the live cache for a path or load a new one
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::shared_ptr<FaceBoxCache> FaceBoxCache::open(const std::string& path, const std::string& tag) {
+    const std::string key = registryKey(path);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = registry.find(key);
+    if (it != registry.end()) {
+        if (auto cache = it->second.lock()) {
+            if (cache->tag_ != tag) {
+                std::cerr << "Warning: " << path << " is open for another face detector"
+                          << "; using an in-memory cache" << std::endl;
+                std::shared_ptr<FaceBoxCache> memory(new FaceBoxCache());
+                memory->tag_ = tag;
+                memory->writable_ = false;
+                return memory;
+            }
+            return cache;
+        }
+    }
+
+    std::shared_ptr<FaceBoxCache> cache(new FaceBoxCache());
+    cache->path_ = path;
+    cache->tag_ = tag;
+    if (cache->load()) {
+        std::cout << "Loaded " << cache->entries_.size() << " cached face results from "
+                  << path << std::endl;
+    }
+    registry[key] = cache;
+    return cache;
+}
+
+std::string FaceBoxCache::pathFor(const std::string& embeddingsPath) {
+    return embeddingsPath + ".faces";
+}
+
+/**
+ * @brief FNV-1a over the image header and pixel rows
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint64_t FaceBoxCache::hashImage(const cv::Mat& image) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const unsigned char* bytes, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    const int header[3] = {image.rows, image.cols, image.type()};
+    mix(reinterpret_cast<const unsigned char*>(header), sizeof(header));
+    const size_t rowBytes = image.cols * image.elemSize();
+    for (int row = 0; row < image.rows; row++) {
+        mix(image.ptr<unsigned char>(row), rowBytes);
+    }
+    return hash;
+}
+
+bool FaceBoxCache::find(uint64_t key, std::vector<cv::Rect>& faces) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    faces = it->second;
+    return true;
+}
+
+/**
+ * @brief Remember boxes and append them to the sidecar
+ *
+ * If load() accepted the file, lines are appended to it; otherwise the file
+ * is (re)created with the header line on the first insert.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FaceBoxCache::insert(uint64_t key, const std::vector<cv::Rect>& faces) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!entries_.emplace(key, faces).second || !writable_) {
+        return;
+    }
+
+    if (!file_.is_open()) {
+        // No accepted file: start a new one
+        file_.open(path_, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) {
+            std::cerr << "Warning: Cannot write face cache " << path_
+                      << "; keeping results in memory" << std::endl;
+            writable_ = false;
+            return;
+        }
+        file_ << FACES_TAG << tag_ << "\n";
+    }
+
+    file_ << std::hex << key << std::dec << "," << faces.size();
+    for (const cv::Rect& face : faces) {
+        file_ << "," << face.x << "," << face.y << "," << face.width << "," << face.height;
+    }
+    file_ << "\n";
+    if (++unflushed_ >= FLUSH_INTERVAL) {
+        file_.flush();
+        unflushed_ = 0;
+    }
+}
+
+size_t FaceBoxCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+/**
+ * @brief Destructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+FaceBoxCache::~FaceBoxCache() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+/**
+ * @brief Read complete entries; cut a torn last line off the file
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FaceBoxCache::load() {
+    std::ifstream file(path_, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || file.eof() || line != FACES_TAG + tag_) {
+        if (!line.empty()) {
+            std::cout << "Face cache " << path_ << " was written by another detector;"
+                      << " it will be rebuilt" << std::endl;
+        }
+        return false;
+    }
+
+    std::streamoff validEnd = file.tellg();
+    uint64_t key = 0;
+    std::vector<cv::Rect> faces;
+    while (std::getline(file, line)) {
+        if (file.eof() || !parseEntry(line, key, faces)) {
+            break;  // torn or damaged tail
+        }
+        entries_[key] = faces;
+        validEnd = file.tellg();
+    }
+    file.close();
+
+    std::error_code error;
+    if (static_cast<uintmax_t>(validEnd) != std::filesystem::file_size(path_, error) && !error) {
+        std::filesystem::resize_file(path_, static_cast<uintmax_t>(validEnd), error);
+    }
+    if (error) {
+        writable_ = false;
+    }
+
+    // Keep appending to the accepted file
+    file_.open(path_, std::ios::binary | std::ios::app);
+    writable_ = writable_ && file_.is_open();
+    return true;
+}
+
+} // namespace cbir
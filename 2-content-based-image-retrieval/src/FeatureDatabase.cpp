@@ -3,29 +3,165 @@
 // Author: Krushna Sanjay Sharma
 // Description: Implementation of feature database management for storing and
 //              retrieving pre-computed image features for efficient CBIR queries.
+//              Features are packed into one contiguous matrix with a name
+//              array and hash index, persisted as CSV or a mappable binary file.
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "FeatureDatabase.h"
+#include "DatabaseBuilder.h"
+#include "DistanceKernels.h"
 #include <iostream>
+#include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <unordered_set>
+
+#ifdef CBIR_HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 namespace cbir {
 
+namespace {
+
+/// File signature, including the terminating NUL
+const char FDB_MAGIC[8] = {'C', 'B', 'I', 'R', 'F', 'D', 'B', '\0'};
+
+/// Alignment of the feature matrix inside the file (cache line / SIMD)
+const uint64_t FEATURE_ALIGNMENT = 64;
+
+/// Rows converted per chunk when writing float16 / uint8
+const int WRITE_CHUNK_ROWS = 4096;
+
+/// Uncompressed size of a compressed block (fits a per-core L2 cache)
+const size_t COMPRESSED_BLOCK_BYTES = 256 * 1024;
+
+/// zstd level for feature blocks (fast to write, decompression speed is level-independent)
+const int ZSTD_LEVEL = 3;
+
+/// Largest rows per block accepted from a file
+const uint32_t MAX_BLOCK_ROWS = 1u << 20;
+
+/// Rows per norm-computation work item of an uncompressed matrix
+const int NORM_BLOCK_ROWS = 4096;
+
+/**
+ * FNV-1a hash of an image name, used by the on-disk and in-memory index
+ */
+uint64_t hashName(const char* name, size_t length) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/// Bytes per packed row; uint8 rows carry their scale
+size_t rowBytes(FeatureStorage storage, int dimension) {
+    switch (storage) {
+        case FeatureStorage::Float16: return static_cast<size_t>(dimension) * 2;
+        case FeatureStorage::UInt8:   return DistanceKernels::quantizedRowBytes(dimension);
+        default:                      return static_cast<size_t>(dimension) * 4;
+    }
+}
+
+int matType(FeatureStorage storage) {
+    switch (storage) {
+        case FeatureStorage::Float16: return CV_16F;
+        case FeatureStorage::UInt8:   return CV_8U;
+        default:                      return CV_32F;
+    }
+}
+
+const char* storageName(FeatureStorage storage) {
+    switch (storage) {
+        case FeatureStorage::Float16: return "float16";
+        case FeatureStorage::UInt8:   return "uint8";
+        default:                      return "float32";
+    }
+}
+
+/// Rows per compressed block for rows of the given size
+int compressedBlockRows(size_t packedRowBytes) {
+    return static_cast<int>(std::max<size_t>(16, COMPRESSED_BLOCK_BYTES / packedRowBytes));
+}
+
+#ifdef CBIR_HAVE_ZSTD
+/// Per-thread zstd contexts (creating one per block costs more than small blocks)
+struct ZstdContexts {
+    ZSTD_CCtx* compress = nullptr;
+    ZSTD_DCtx* decompress = nullptr;
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(compress);
+        ZSTD_freeDCtx(decompress);
+    }
+};
+
+ZstdContexts& zstdContexts() {
+    thread_local ZstdContexts contexts;
+    return contexts;
+}
+#endif
+
+/**
+ * Rows of a packed matrix as float32, dequantising uint8 rows
+ *
+ * out may be a preallocated header of the right size, which is filled in place.
+ */
+void expandRows(const cv::Mat& packed, cv::Mat& out) {
+    if (packed.type() != CV_8U) {
+        packed.convertTo(out, CV_32F);
+        return;
+    }
+    out.create(packed.rows, packed.cols, CV_32F);
+    for (int row = 0; row < packed.rows; row++) {
+        DistanceKernels::dequantize(packed.ptr<uint8_t>(row), packed.cols, out.ptr<float>(row));
+    }
+}
+
+} // namespace
+
 /**
  * @brief Constructor
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
-FeatureDatabase::FeatureDatabase() {
+FeatureDatabase::FeatureDatabase()
+    : features_(nullptr), nameOffsets_(nullptr), nameChars_(nullptr), hash_(nullptr),
+      hashEntries_(0), count_(0), dimension_(0), storage_(FeatureStorage::Float32),
+      compression_(FeatureCompression::None), blockRows_(0), blockCount_(0),
+      blockOffsets_(nullptr), blockData_(nullptr), inflatedReady_(false),
+      baseBinary_(false), baseStorage_(FeatureStorage::Float32),
+      baseCompression_(FeatureCompression::None), pendingChanges_(0),
+      compacting_(false), compactionResult_(true), version_(0), normsVersion_(0) {
     // Initialize empty database
+    clear();
+}
+
+/**
+ * @brief Destructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+FeatureDatabase::~FeatureDatabase() {
+    waitForCompaction();
 }
 
 /**
  * @brief Build feature database from image directory
- * 
+ *
  * Scans directory for images, extracts features, and stores in memory.
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 bool FeatureDatabase::buildDatabase(const std::string& imageDirectory,
@@ -35,189 +171,1519 @@ bool FeatureDatabase::buildDatabase(const std::string& imageDirectory,
         std::cerr << "Error: Feature extractor is null" << std::endl;
         return false;
     }
-    
+
     // Clear existing features
     clear();
-    
+
     std::cout << "Building feature database from: " << imageDirectory << std::endl;
     std::cout << "Using feature extractor: " << extractor->getFeatureName() << std::endl;
-    
+
     // Get list of image files
     std::vector<std::string> imageFiles = Utils::getImageFiles(imageDirectory, recursive);
-    
+
     if (imageFiles.empty()) {
         std::cerr << "Error: No image files found in " << imageDirectory << std::endl;
         return false;
     }
-    
+
     std::cout << "Processing " << imageFiles.size() << " images..." << std::endl;
-    
-    // Extract features for each image
-    int successCount = 0;
-    int failCount = 0;
-    
-    for (const auto& imagePath : imageFiles) {
-        // Load image
-        cv::Mat image = Utils::loadImage(imagePath);
-        
-        if (image.empty()) {
-            std::cerr << "Warning: Failed to load " << imagePath << std::endl;
-            failCount++;
-            continue;
-        }
-        
-        // Extract features
-        cv::Mat features = extractor->extractFeatures(image);
-        
-        if (features.empty()) {
-            std::cerr << "Warning: Failed to extract features from " 
-                      << imagePath << std::endl;
-            failCount++;
-            continue;
-        }
-        
-        // Store features with normalized filename
-        std::string filename = normalizeImageName(imagePath);
-        features_[filename] = features;
-        successCount++;
-        
-        // Progress indicator
-        if ((successCount + failCount) % 100 == 0) {
-            std::cout << "  Processed " << (successCount + failCount) 
-                      << "/" << imageFiles.size() << " images..." << std::endl;
-        }
-    }
-    
-    std::cout << "Feature extraction complete!" << std::endl;
-    std::cout << "  Success: " << successCount << std::endl;
-    std::cout << "  Failed:  " << failCount << std::endl;
-    
-    return successCount > 0;
+
+    // Decode in the background; the single extractor runs on one worker
+    BuildOptions options;
+    options.progressInterval = 100;
+    DatabaseBuilder builder(options);
+    return builder.build(imageFiles, {extractor}, *this);
 }
 
 /**
  * @brief Save features to CSV file
- * 
+ *
+ * Rows are written in database order with the same "filename" header and
+ * value formatting as Utils::writeFeaturesCSV.
+ *
  * @author Krushna Sanjay Sharma
  */
 bool FeatureDatabase::saveToCSV(const std::string& filename) const {
-    if (features_.empty()) {
+    if (empty()) {
         std::cerr << "Error: No features to save" << std::endl;
         return false;
     }
-    
+
     std::cout << "Saving feature database to: " << filename << std::endl;
-    
-    // Create header (optional - can be empty for this project)
-    std::string header = "filename";
-    
-    // Use Utils function to write CSV
-    bool success = Utils::writeFeaturesCSV(filename, features_, header);
-    
-    if (success) {
-        std::cout << "Successfully saved " << features_.size() 
-                  << " feature vectors" << std::endl;
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << filename << std::endl;
+        return false;
+    }
+
+    file << "filename" << std::endl;
+    for (size_t i = 0; i < count_; i++) {
+        cv::Mat row = getFeaturesAt(i);
+        file << getName(i);
+        for (int j = 0; j < dimension_; j++) {
+            file << "," << row.at<float>(0, j);
+        }
+        file << "\n";
     }
-    
-    return success;
+    file.close();
+
+    std::cout << "Successfully saved " << count_ << " feature vectors" << std::endl;
+    return true;
 }
 
 /**
  * @brief Load features from CSV file
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 bool FeatureDatabase::loadFromCSV(const std::string& filename) {
     std::cout << "Loading feature database from: " << filename << std::endl;
-    
+
     // Clear existing features
     clear();
-    
-    // Use Utils function to read CSV
-    bool success = Utils::readFeaturesCSV(filename, features_, true);
-    
+
+    // Parse straight into packed rows, then take the arrays over
+    Utils::PackedFeatureRows rows;
+    bool success = Utils::readFeaturesCSV(filename, rows, true);
+
     if (success) {
-        std::cout << "Successfully loaded " << features_.size() 
+        adoptRows(rows);
+        std::cout << "Successfully loaded " << count_
                   << " feature vectors" << std::endl;
     } else {
         std::cerr << "Error: Failed to load features from " << filename << std::endl;
     }
-    
-    return success;
+
+    return success && count_ > 0;
+}
+
+/**
+ * @brief Take over rows parsed by the caller
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::loadFromRows(Utils::PackedFeatureRows& rows) {
+    clear();
+    if (rows.size() == 0) {
+        return false;
+    }
+    adoptRows(rows);
+    rows = Utils::PackedFeatureRows();
+    return count_ > 0;
+}
+
+/**
+ * @brief Take over packed CSV rows
+ *
+ * Rows end up sorted by normalized name with the last of duplicate names
+ * kept, as the map-based loader produced them. A file written by save()
+ * is already in that order, so its arrays are moved in without a copy.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::adoptRows(Utils::PackedFeatureRows& rows) {
+    const size_t count = rows.size();
+    const int dimension = rows.dimension;
+
+    // Normalized names as views; only names with a directory part are copied
+    std::vector<std::string> stripped;
+    std::vector<std::pair<const char*, size_t>> names(count);
+    std::vector<size_t> strippedRow;
+    for (size_t i = 0; i < count; i++) {
+        const char* name = rows.nameChars.data() + rows.nameOffsets[i];
+        const size_t length = static_cast<size_t>(rows.nameOffsets[i + 1] - rows.nameOffsets[i]);
+        names[i] = std::make_pair(name, length);
+        if (std::find_if(name, name + length, [](char c) { return c == '/' || c == '\\'; }) !=
+            name + length) {
+            stripped.push_back(normalizeImageName(std::string(name, length)));
+            strippedRow.push_back(i);
+        }
+    }
+    for (size_t k = 0; k < stripped.size(); k++) {
+        names[strippedRow[k]] = std::make_pair(stripped[k].data(), stripped[k].size());
+    }
+
+    auto less = [&names](size_t a, size_t b) {
+        const int order = std::memcmp(names[a].first, names[b].first,
+                                      std::min(names[a].second, names[b].second));
+        return order != 0 ? order < 0 : names[a].second < names[b].second;
+    };
+    bool sorted = stripped.empty();
+    for (size_t i = 1; sorted && i < count; i++) {
+        sorted = less(i - 1, i);
+    }
+
+    if (sorted) {
+        ownedFeatures_.swap(rows.values);
+        ownedNameChars_.swap(rows.nameChars);
+        ownedNameOffsets_.swap(rows.nameOffsets);
+    } else {
+        // Stable sort, then keep the last row of each run of equal names
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), less);
+
+        ownedFeatures_.clear();
+        ownedNameChars_.clear();
+        ownedNameOffsets_.assign(1, 0);
+        for (size_t k = 0; k < count; k++) {
+            if (k + 1 < count && !less(order[k], order[k + 1])) {
+                continue;   // a later row has the same name
+            }
+            const float* values = rows.values.data() + order[k] * dimension;
+            ownedFeatures_.insert(ownedFeatures_.end(), values, values + dimension);
+            const auto& name = names[order[k]];
+            ownedNameChars_.insert(ownedNameChars_.end(), name.first, name.first + name.second);
+            ownedNameOffsets_.push_back(ownedNameChars_.size());
+        }
+    }
+
+    count_ = ownedNameOffsets_.size() - 1;
+    dimension_ = dimension;
+    rebuildHash(count_ * 2);
+    refreshViews();
+}
+
+/**
+ * @brief Save the packed arrays in the versioned binary format
+ *
+ * Rows are written in chunks (converted when the storage type changes);
+ * with compression every chunk is one block, and the header and block
+ * directory are filled in once the compressed sizes are known.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::saveToBinary(const std::string& filename, FeatureStorage storage,
+                                   FeatureCompression compression) const {
+    if (empty()) {
+        std::cerr << "Error: No features to save" << std::endl;
+        return false;
+    }
+    const bool compressed = compression != FeatureCompression::None;
+    if (compressed && !compressionAvailable(compression)) {
+        std::cerr << "Error: This build cannot write compressed databases (zstd not found)"
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "Saving binary feature database to: " << filename << std::endl;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << filename << std::endl;
+        return false;
+    }
+
+    const size_t packedRowBytes = rowBytes(storage, dimension_);
+    const int chunkRows = compressed ? compressedBlockRows(packedRowBytes) : WRITE_CHUNK_ROWS;
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, FDB_MAGIC, sizeof(FDB_MAGIC));
+    header.version = compressed ? COMPRESSED_FORMAT_VERSION : FORMAT_VERSION;
+    header.storage = static_cast<uint32_t>(storage);
+    header.count = count_;
+    header.dimension = static_cast<uint32_t>(dimension_);
+    header.decodeReduction = static_cast<uint16_t>(decodePolicy_.reduction);
+    header.decodeMaxSide = static_cast<uint16_t>(std::min(decodePolicy_.maxSide, 0xFFFF));
+    header.featuresOffset = alignUp(sizeof(FileHeader), FEATURE_ALIGNMENT);
+    header.hashEntries = hashEntries_;
+
+    const char zeros[FEATURE_ALIGNMENT] = {0};
+    auto padTo = [&](uint64_t offset) {
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        if (offset > position) {
+            file.write(zeros, static_cast<std::streamsize>(offset - position));
+        }
+    };
+
+    // Header placeholder: the section offsets follow the feature bytes
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    padTo(header.featuresOffset);
+
+    BlockDirectory directory;
+    std::memset(&directory, 0, sizeof(directory));
+    std::vector<uint64_t> blockOffsets;
+    if (compressed) {
+        directory.codec = static_cast<uint32_t>(compression);
+        directory.blockRows = static_cast<uint32_t>(chunkRows);
+        directory.blockCount = (count_ + chunkRows - 1) / chunkRows;
+        blockOffsets.assign(directory.blockCount + 1, 0);
+        file.write(reinterpret_cast<const char*>(&directory), sizeof(directory));
+        file.write(reinterpret_cast<const char*>(blockOffsets.data()),
+                   static_cast<std::streamsize>(blockOffsets.size() * sizeof(uint64_t)));
+    }
+
+    // One chunk of packed rows, compressed into a block if requested
+    std::vector<char> block;
+    size_t blockIndex = 0;
+    auto emit = [&](const void* bytes, size_t length) -> bool {
+        if (!compressed) {
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(length));
+            return true;
+        }
+#ifdef CBIR_HAVE_ZSTD
+        ZstdContexts& contexts = zstdContexts();
+        if (contexts.compress == nullptr) {
+            contexts.compress = ZSTD_createCCtx();
+        }
+        block.resize(ZSTD_compressBound(length));
+        size_t written = ZSTD_compressCCtx(contexts.compress, block.data(), block.size(),
+                                           bytes, length, ZSTD_LEVEL);
+        if (ZSTD_isError(written)) {
+            std::cerr << "Error: Compression failed: " << ZSTD_getErrorName(written) << std::endl;
+            return false;
+        }
+        file.write(block.data(), static_cast<std::streamsize>(written));
+        blockOffsets[blockIndex + 1] = blockOffsets[blockIndex] + written;
+        blockIndex++;
+        return true;
+#else
+        (void)bytes;
+        (void)length;
+        return false;
+#endif
+    };
+
+    // Feature rows in the requested storage type
+    std::vector<uint8_t> scratch;
+    cv::Mat values;
+    cv::Mat chunk;
+    std::vector<uint8_t> quantized;
+    const int rows = static_cast<int>(count_);
+    for (int start = 0; start < rows; start += chunkRows) {
+        int end = std::min(rows, start + chunkRows);
+        cv::Mat packed = readRows(start, end, scratch);
+        if (packed.empty()) {
+            file.close();
+            std::remove(filename.c_str());
+            return false;
+        }
+
+        bool emitted;
+        if (storage == storage_) {
+            emitted = emit(packed.data, (end - start) * packedRowBytes);
+        } else {
+            expandRows(packed, values);
+            if (storage != FeatureStorage::UInt8) {
+                values.convertTo(chunk, matType(storage));
+                emitted = emit(chunk.data, chunk.total() * chunk.elemSize());
+            } else {
+                quantized.resize((end - start) * packedRowBytes);
+                for (int row = 0; row < end - start; row++) {
+                    if (!DistanceKernels::quantize(values.ptr<float>(row), dimension_,
+                                                   quantized.data() + row * packedRowBytes)) {
+                        std::cerr << "Error: uint8 storage needs non-negative features, "
+                                  << getName(static_cast<size_t>(start + row))
+                                  << " has negative values; use float16" << std::endl;
+                        file.close();
+                        std::remove(filename.c_str());
+                        return false;
+                    }
+                }
+                emitted = emit(quantized.data(), quantized.size());
+            }
+        }
+        if (!emitted) {
+            file.close();
+            std::remove(filename.c_str());
+            return false;
+        }
+    }
+
+    // Section layout, now that the feature bytes are known
+    const uint64_t featuresEnd = static_cast<uint64_t>(file.tellp());
+    header.nameOffsetsOffset = alignUp(featuresEnd, 8);
+    header.hashOffset = header.nameOffsetsOffset + (count_ + 1) * sizeof(uint64_t);
+    header.nameCharsOffset = header.hashOffset + hashEntries_ * sizeof(uint32_t);
+    padTo(header.nameOffsetsOffset);
+
+    file.write(reinterpret_cast<const char*>(nameOffsets_),
+               static_cast<std::streamsize>((count_ + 1) * sizeof(uint64_t)));
+    file.write(reinterpret_cast<const char*>(hash_),
+               static_cast<std::streamsize>(hashEntries_ * sizeof(uint32_t)));
+    file.write(nameChars_, static_cast<std::streamsize>(nameOffsets_[count_]));
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (compressed) {
+        file.seekp(static_cast<std::streamoff>(header.featuresOffset + sizeof(directory)));
+        file.write(reinterpret_cast<const char*>(blockOffsets.data()),
+                   static_cast<std::streamsize>(blockOffsets.size() * sizeof(uint64_t)));
+    }
+
+    if (!file.good()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Successfully saved " << count_ << " feature vectors ("
+              << storageName(storage);
+    if (compressed) {
+        const double raw = static_cast<double>(count_) * packedRowBytes;
+        std::cout << ", zstd blocks of " << chunkRows << " rows, "
+                  << raw / std::max<uint64_t>(1, blockOffsets.back()) << "x smaller";
+    }
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Open a binary database, mapped or read into memory
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::loadFromBinary(const std::string& filename, bool useMmap) {
+    std::cout << "Loading binary feature database from: " << filename << std::endl;
+
+    clear();
+
+    const char* data = nullptr;
+    size_t size = 0;
+
+    if (useMmap) {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        if (!file->open(filename)) {
+            return false;
+        }
+        data = file->data();
+        size = file->size();
+        mapped_ = std::move(file);
+    } else {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cerr << "Error: Cannot open file " << filename << std::endl;
+            return false;
+        }
+        fileBuffer_.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(fileBuffer_.data(), static_cast<std::streamsize>(fileBuffer_.size()));
+        if (!file.good()) {
+            std::cerr << "Error: Failed reading " << filename << std::endl;
+            clear();
+            return false;
+        }
+        data = fileBuffer_.data();
+        size = fileBuffer_.size();
+    }
+
+    if (!attachBinary(data, size, filename)) {
+        clear();
+        return false;
+    }
+
+    std::cout << "Successfully loaded " << count_ << " feature vectors ("
+              << dimension_ << "-d, " << (useMmap ? "mapped" : "in memory")
+              << (isCompressed() ? ", compressed" : "") << ")" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Validate the header and point the views into the file image
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::attachBinary(const char* data, size_t size, const std::string& filename) {
+    FileHeader header;
+    if (size < sizeof(header)) {
+        std::cerr << "Error: " << filename << " is too small for a feature database" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, FDB_MAGIC, sizeof(FDB_MAGIC)) != 0) {
+        std::cerr << "Error: " << filename << " is not a binary feature database" << std::endl;
+        return false;
+    }
+    if (header.version != FORMAT_VERSION && header.version != COMPRESSED_FORMAT_VERSION) {
+        std::cerr << "Error: " << filename << " has format version " << header.version
+                  << ", expected " << FORMAT_VERSION << " or " << COMPRESSED_FORMAT_VERSION
+                  << std::endl;
+        return false;
+    }
+    const bool compressed = header.version == COMPRESSED_FORMAT_VERSION;
+    if (header.storage > static_cast<uint32_t>(FeatureStorage::UInt8) ||
+        header.count > 0xFFFFFFFEULL || header.count > size ||
+        header.dimension == 0 || header.dimension > size) {
+        std::cerr << "Error: " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    // Every section must lie inside the file
+    FeatureStorage storage = static_cast<FeatureStorage>(header.storage);
+    uint64_t featureBytes = header.count * rowBytes(storage, static_cast<int>(header.dimension));
+    if (compressed) {
+        // Directory and offsets here; the blocks are checked below
+        featureBytes = sizeof(BlockDirectory);
+    }
+    uint64_t offsetBytes = (header.count + 1) * sizeof(uint64_t);
+    uint64_t hashBytes = header.hashEntries * sizeof(uint32_t);
+    bool hashValid = header.hashEntries > header.count &&
+                     (header.hashEntries & (header.hashEntries - 1)) == 0;
+    if (!hashValid || header.featuresOffset % FEATURE_ALIGNMENT != 0 ||
+        header.nameOffsetsOffset % 8 != 0 ||
+        header.featuresOffset + featureBytes > size ||
+        header.nameOffsetsOffset + offsetBytes > size ||
+        header.hashOffset + hashBytes > size ||
+        header.nameCharsOffset > size) {
+        std::cerr << "Error: " << filename << " is truncated or corrupt" << std::endl;
+        return false;
+    }
+
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(data + header.nameOffsetsOffset);
+    if (offsets[0] != 0 || offsets[header.count] > size - header.nameCharsOffset) {
+        std::cerr << "Error: " << filename << " has a corrupt name table" << std::endl;
+        return false;
+    }
+
+    BlockDirectory directory;
+    const uint64_t* blockOffsets = nullptr;
+    const char* blockData = nullptr;
+    if (compressed) {
+        std::memcpy(&directory, data + header.featuresOffset, sizeof(directory));
+        const uint64_t sectionEnd = header.nameOffsetsOffset;
+        const uint64_t tableOffset = header.featuresOffset + sizeof(directory);
+        const uint64_t tableBytes = (directory.blockCount + 1) * sizeof(uint64_t);
+        if (directory.blockRows == 0 || directory.blockRows > MAX_BLOCK_ROWS ||
+            directory.blockCount != (header.count + directory.blockRows - 1) / directory.blockRows ||
+            directory.blockCount > sectionEnd || tableOffset + tableBytes > sectionEnd) {
+            std::cerr << "Error: " << filename << " has a corrupt block directory" << std::endl;
+            return false;
+        }
+        if (!compressionAvailable(static_cast<FeatureCompression>(directory.codec))) {
+            std::cerr << "Error: " << filename << " uses compression codec " << directory.codec
+                      << ", which this build cannot read (zstd not found)" << std::endl;
+            return false;
+        }
+        blockOffsets = reinterpret_cast<const uint64_t*>(data + tableOffset);
+        blockData = data + tableOffset + tableBytes;
+        for (uint64_t block = 0; block < directory.blockCount; block++) {
+            if (blockOffsets[block + 1] < blockOffsets[block]) {
+                std::cerr << "Error: " << filename << " has a corrupt block directory" << std::endl;
+                return false;
+            }
+        }
+        if (blockOffsets[0] != 0 ||
+            blockOffsets[directory.blockCount] > sectionEnd - tableOffset - tableBytes) {
+            std::cerr << "Error: " << filename << " is truncated or corrupt" << std::endl;
+            return false;
+        }
+    }
+
+    features_ = compressed ? nullptr : data + header.featuresOffset;
+    if (compressed) {
+        compression_ = static_cast<FeatureCompression>(directory.codec);
+        blockRows_ = static_cast<int>(directory.blockRows);
+        blockCount_ = static_cast<size_t>(directory.blockCount);
+        blockOffsets_ = blockOffsets;
+        blockData_ = blockData;
+    }
+    nameOffsets_ = offsets;
+    hash_ = reinterpret_cast<const uint32_t*>(data + header.hashOffset);
+    hashEntries_ = static_cast<size_t>(header.hashEntries);
+    nameChars_ = data + header.nameCharsOffset;
+    count_ = static_cast<size_t>(header.count);
+    dimension_ = static_cast<int>(header.dimension);
+    storage_ = storage;
+    decodePolicy_ = DecodePolicy::make(header.decodeReduction, header.decodeMaxSide);
+    version_++;
+    return true;
+}
+
+/**
+ * @brief Load binary or CSV based on the file signature
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::load(const std::string& filename) {
+    waitForCompaction();
+    bool loaded = isBinaryFile(filename) ? loadFromBinary(filename, true)
+                                         : loadFromCSV(filename);
+    if (!loaded) {
+        return false;
+    }
+    return attachLog(filename, false);
+}
+
+/**
+ * @brief Save binary or CSV based on the file extension
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::save(const std::string& filename, FeatureStorage storage,
+                           FeatureCompression compression) const {
+    if (isBinaryPath(filename)) {
+        return saveToBinary(filename, storage, compression);
+    }
+    return saveToCSV(filename);
+}
+
+/**
+ * @brief Write one database per shard
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::saveShards(const std::string& filename, int shardCount,
+                                 FeatureStorage storage, FeatureCompression compression) const {
+    if (shardCount < 1) {
+        std::cerr << "Error: Shard count must be at least 1" << std::endl;
+        return false;
+    }
+    if (empty()) {
+        std::cerr << "Error: No features to save" << std::endl;
+        return false;
+    }
+
+    std::vector<FeatureDatabase> shards(static_cast<size_t>(shardCount));
+    for (size_t row = 0; row < count_; row++) {
+        const std::string name = getName(row);
+        if (!shards[shardOf(name, shardCount)].addFeatures(name, getFeaturesAt(row))) {
+            return false;
+        }
+    }
+
+    for (int shard = 0; shard < shardCount; shard++) {
+        FeatureDatabase& database = shards[shard];
+        if (database.empty()) {
+            std::cout << "Shard " << shard << " of " << shardCount << " is empty; skipped"
+                      << std::endl;
+            continue;
+        }
+        database.setDecodePolicy(decodePolicy_);
+        if (!database.save(shardPath(filename, shard, shardCount), storage, compression)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Name hash bits above those used for hash table slots
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int FeatureDatabase::shardOf(const std::string& imageName, int shardCount) {
+    if (shardCount <= 1) {
+        return 0;
+    }
+    const std::string name = Utils::getFilename(imageName);
+    const uint64_t hash = hashName(name.data(), name.size());
+    return static_cast<int>((hash >> 32) % static_cast<uint64_t>(shardCount));
+}
+
+std::string FeatureDatabase::shardPath(const std::string& filename, int shard, int shardCount) {
+    const std::string tag = ".shard" + std::to_string(shard) + "of" + std::to_string(shardCount);
+    const size_t slash = filename.find_last_of("/\\");
+    const size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return filename + tag;
+    }
+    return filename.substr(0, dot) + tag + filename.substr(dot);
+}
+
+bool FeatureDatabase::isBinaryPath(const std::string& filename) {
+    std::string lower = Utils::toLower(filename);
+    auto endsWith = [&lower](const std::string& suffix) {
+        return lower.size() >= suffix.size() &&
+               lower.compare(lower.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    return endsWith(".fdb") || endsWith(".bin");
+}
+
+/**
+ * @brief Check the file signature
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::isBinaryFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(FDB_MAGIC)] = {0};
+    file.read(magic, sizeof(magic));
+    return file.gcount() == static_cast<std::streamsize>(sizeof(magic)) &&
+           std::memcmp(magic, FDB_MAGIC, sizeof(FDB_MAGIC)) == 0;
 }
 
 /**
  * @brief Get features for a specific image
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 cv::Mat FeatureDatabase::getFeatures(const std::string& imageName) const {
-    // Normalize the image name
-    std::string normalizedName = normalizeImageName(imageName);
-    
-    // Search in database
-    auto it = features_.find(normalizedName);
-    
-    if (it != features_.end()) {
-        return it->second;
-    }
-    
+    // Normalize the image name and look it up in the hash index
+    int row = findRow(normalizeImageName(imageName));
+
+    if (row >= 0) {
+        return getFeaturesAt(static_cast<size_t>(row));
+    }
+
     // Not found - return empty Mat
     return cv::Mat();
 }
 
+/**
+ * @brief Get features by row
+ *
+ * Float32 rows are returned as views into the packed matrix; Float16 and
+ * UInt8 rows are converted into a new CV_32F vector. Compressed rows are
+ * read by decompressing their block.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat FeatureDatabase::getFeaturesAt(size_t index) const {
+    if (index >= count_) {
+        return cv::Mat();
+    }
+    if (isCompressed()) {
+        std::vector<uint8_t> scratch;
+        const int row = static_cast<int>(index);
+        cv::Mat packed = readRows(row, row + 1, scratch);
+        cv::Mat converted;
+        if (!packed.empty()) {
+            expandRows(packed, converted);
+        }
+        return converted;
+    }
+
+    const char* rowData = static_cast<const char*>(features_) +
+                          index * rowBytes(storage_, dimension_);
+    cv::Mat row(1, dimension_, matType(storage_), const_cast<char*>(rowData));
+
+    if (storage_ == FeatureStorage::Float32) {
+        return row;
+    }
+    cv::Mat converted;
+    expandRows(row, converted);
+    return converted;
+}
+
 /**
  * @brief Check if database has features for an image
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 bool FeatureDatabase::hasFeatures(const std::string& imageName) const {
-    std::string normalizedName = normalizeImageName(imageName);
-    return features_.find(normalizedName) != features_.end();
+    return findRow(normalizeImageName(imageName)) >= 0;
+}
+
+/**
+ * @brief Row index of an image
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int FeatureDatabase::indexOf(const std::string& imageName) const {
+    return findRow(normalizeImageName(imageName));
+}
+
+/**
+ * @brief Name stored in a row
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string FeatureDatabase::getName(size_t index) const {
+    if (index >= count_) {
+        return std::string();
+    }
+    return std::string(nameChars_ + nameOffsets_[index],
+                       static_cast<size_t>(nameOffsets_[index + 1] - nameOffsets_[index]));
 }
 
 /**
  * @brief Get all image names in database
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 std::vector<std::string> FeatureDatabase::getImageNames() const {
     std::vector<std::string> names;
-    names.reserve(features_.size());
-    
-    for (const auto& pair : features_) {
-        names.push_back(pair.first);
+    names.reserve(count_);
+
+    for (size_t i = 0; i < count_; i++) {
+        names.push_back(getName(i));
     }
-    
+
     return names;
 }
 
+/**
+ * @brief Packed matrix view (decompressed once for compressed files)
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat FeatureDatabase::matrix() const {
+    if (empty()) {
+        return cv::Mat();
+    }
+    if (isCompressed()) {
+        std::lock_guard<std::mutex> lock(inflateMutex_);
+        const size_t packedRowBytes = rowBytes(storage_, dimension_);
+        if (!inflatedReady_) {
+            inflated_.resize(count_ * packedRowBytes);
+            std::atomic<bool> failed(false);
+            cv::parallel_for_(cv::Range(0, static_cast<int>(blockCount_)),
+                              [&](const cv::Range& range) {
+                for (int block = range.start; block < range.end; block++) {
+                    uint8_t* out = inflated_.data() +
+                                   static_cast<size_t>(block) * blockRows_ * packedRowBytes;
+                    if (!inflateBlock(static_cast<size_t>(block), out)) {
+                        failed = true;
+                    }
+                }
+            });
+            if (failed) {
+                inflated_.clear();
+                return cv::Mat();
+            }
+            inflatedReady_ = true;
+        }
+        return cv::Mat(static_cast<int>(count_), dimension_, matType(storage_),
+                       inflated_.data(), packedRowBytes);
+    }
+    return cv::Mat(static_cast<int>(count_), dimension_, matType(storage_),
+                   const_cast<void*>(features_), rowBytes(storage_, dimension_));
+}
+
+/**
+ * @brief Row norms, recomputed when version() has moved on
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat FeatureDatabase::rowNorms() const {
+    if (empty()) {
+        return cv::Mat();
+    }
+
+    std::lock_guard<std::mutex> lock(normsMutex_);
+    const uint64_t current = version_.load();
+    if (rowNorms_.size() != count_ || normsVersion_ != current) {
+        rowNorms_.resize(count_);
+        double* norms = rowNorms_.data();
+        const int rows = static_cast<int>(count_);
+        const int blockSize = isCompressed() ? blockRows_ : NORM_BLOCK_ROWS;
+        const int blockCount = (rows + blockSize - 1) / blockSize;
+
+        // Same squared-norm kernels as CosineDistance::computeBatch(), so
+        // distances do not depend on whether the norms were supplied
+        cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+            std::vector<float> widened(dimension_, 0.0f);
+            std::vector<uint8_t> scratch;
+            for (int block = range.start; block < range.end; block++) {
+                const int start = block * blockSize;
+                const int end = std::min(rows, start + blockSize);
+                const cv::Mat packed = readRows(start, end, scratch);
+                if (packed.empty()) {
+                    std::fill(norms + start, norms + end, 0.0);
+                    continue;
+                }
+                for (int row = 0; row < packed.rows; row++) {
+                    float dot = 0.0f;
+                    float squares = 0.0f;
+                    if (packed.type() == CV_8U) {
+                        const uint8_t* codes = packed.ptr<uint8_t>(row);
+                        DistanceKernels::dotAndSquaresQuantized(
+                            widened.data(), codes, packed.cols,
+                            DistanceKernels::quantizedScale(codes, packed.cols), &dot, &squares);
+                    } else {
+                        const float* values = widened.data();
+                        if (packed.type() == CV_32F) {
+                            values = packed.ptr<float>(row);
+                        } else {
+                            cv::Mat out(1, packed.cols, CV_32F, widened.data());
+                            packed.row(row).convertTo(out, CV_32F);
+                        }
+                        DistanceKernels::dotAndSquares(values, values, packed.cols, &dot, &squares);
+                    }
+                    norms[start + row] = std::sqrt(static_cast<double>(squares));
+                }
+            }
+        });
+        normsVersion_ = current;
+    }
+    return cv::Mat(static_cast<int>(count_), 1, CV_64F, rowNorms_.data());
+}
+
+/**
+ * @brief Rows of the packed matrix, decompressing their blocks if needed
+ *
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat FeatureDatabase::readRows(int start, int end, std::vector<uint8_t>& scratch) const {
+    if (!isCompressed() || inflatedReady_) {
+        return matrix().rowRange(start, end);
+    }
+
+    const size_t packedRowBytes = rowBytes(storage_, dimension_);
+    const size_t firstBlock = static_cast<size_t>(start / blockRows_);
+    const size_t lastBlock = static_cast<size_t>((end - 1) / blockRows_);
+    const size_t blockBytes = static_cast<size_t>(blockRows_) * packedRowBytes;
+    scratch.resize((lastBlock - firstBlock + 1) * blockBytes);
+    for (size_t block = firstBlock; block <= lastBlock; block++) {
+        if (!inflateBlock(block, scratch.data() + (block - firstBlock) * blockBytes)) {
+            return cv::Mat();
+        }
+    }
+    uint8_t* first = scratch.data() + (start - firstBlock * blockRows_) * packedRowBytes;
+    return cv::Mat(end - start, dimension_, matType(storage_), first, packedRowBytes);
+}
+
+/**
+ * @brief Codecs compiled into this build
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::compressionAvailable(FeatureCompression compression) {
+    switch (compression) {
+        case FeatureCompression::None:
+            return true;
+        case FeatureCompression::Zstd:
+#ifdef CBIR_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+/**
+ * @brief Decompress one block of rows
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::inflateBlock(size_t block, uint8_t* out) const {
+    const size_t first = block * static_cast<size_t>(blockRows_);
+    const size_t rows = std::min(count_ - first, static_cast<size_t>(blockRows_));
+    const size_t expected = rows * rowBytes(storage_, dimension_);
+    const char* source = blockData_ + blockOffsets_[block];
+    const size_t sourceBytes = static_cast<size_t>(blockOffsets_[block + 1] - blockOffsets_[block]);
+
+#ifdef CBIR_HAVE_ZSTD
+    ZstdContexts& contexts = zstdContexts();
+    if (contexts.decompress == nullptr) {
+        contexts.decompress = ZSTD_createDCtx();
+    }
+    size_t written = ZSTD_decompressDCtx(contexts.decompress, out, expected, source, sourceBytes);
+    if (!ZSTD_isError(written) && written == expected) {
+        return true;
+    }
+#else
+    (void)out;
+    (void)expected;
+    (void)source;
+    (void)sourceBytes;
+#endif
+    std::cerr << "Error: Compressed feature block " << block << " is corrupt" << std::endl;
+    return false;
+}
+
+/**
+ * @brief Forget the compressed views
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::resetCompression() {
+    std::lock_guard<std::mutex> lock(inflateMutex_);
+    compression_ = FeatureCompression::None;
+    blockRows_ = 0;
+    blockCount_ = 0;
+    blockOffsets_ = nullptr;
+    blockData_ = nullptr;
+    inflated_.clear();
+    inflated_.shrink_to_fit();
+    inflatedReady_ = false;
+}
+
 /**
  * @brief Clear all features
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 void FeatureDatabase::clear() {
-    features_.clear();
+    ownedFeatures_.clear();
+    ownedNameOffsets_.assign(1, 0);
+    ownedNameChars_.clear();
+    ownedHash_.clear();
+    mapped_.reset();
+    fileBuffer_.clear();
+    resetCompression();
+
+    count_ = 0;
+    dimension_ = 0;
+    storage_ = FeatureStorage::Float32;
+    decodePolicy_ = DecodePolicy();
+    stamps_.clear();
+    rebuildHash(16);
+    refreshViews();
 }
 
 /**
  * @brief Add or update features for an image
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
-void FeatureDatabase::addFeatures(const std::string& imageName, 
+bool FeatureDatabase::addFeatures(const std::string& imageName,
                                   const cv::Mat& features) {
+    if (features.empty()) {
+        std::cerr << "Error: Empty feature vector for " << imageName << std::endl;
+        return false;
+    }
+
+    // Flatten to one float32 row
+    cv::Mat continuous = features.isContinuous() ? features : features.clone();
+    cv::Mat row;
+    continuous.reshape(1, 1).convertTo(row, CV_32F);
+
+    const int length = static_cast<int>(row.total());
+    if (count_ > 0 && length != dimension_) {
+        std::cerr << "Error: Feature dimension " << length << " for " << imageName
+                  << " does not match database dimension " << dimension_ << std::endl;
+        return false;
+    }
+
+    detach();
+    dimension_ = length;
+    const float* values = row.ptr<float>(0);
+
     std::string normalizedName = normalizeImageName(imageName);
-    features_[normalizedName] = features;
+    int existing = findRow(normalizedName);
+    if (existing >= 0) {
+        // Update in place
+        std::copy(values, values + length, ownedFeatures_.begin() +
+                  static_cast<size_t>(existing) * length);
+        version_++;
+        return true;
+    }
+
+    // Append a row, its name and its index entry
+    ownedFeatures_.insert(ownedFeatures_.end(), values, values + length);
+    ownedNameChars_.insert(ownedNameChars_.end(), normalizedName.begin(), normalizedName.end());
+    ownedNameOffsets_.push_back(ownedNameChars_.size());
+    count_++;
+    refreshViews();
+
+    // Keep the load factor at or below 1/2
+    if (count_ * 2 > ownedHash_.size()) {
+        rebuildHash(count_ * 2);
+    } else {
+        size_t mask = ownedHash_.size() - 1;
+        size_t slot = hashName(normalizedName.data(), normalizedName.size()) & mask;
+        while (ownedHash_[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        ownedHash_[slot] = static_cast<uint32_t>(count_);
+    }
+    refreshViews();
+    return true;
+}
+
+/**
+ * @brief Attach the change log of a base file
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::attachLog(const std::string& basePath, bool reset) {
+    waitForCompaction();
+
+    std::lock_guard<std::mutex> lock(logMutex_);
+    log_.reset();
+    basePath_ = basePath;
+    baseBinary_ = isBinaryFile(basePath);
+    baseStorage_ = baseBinary_ ? storage_ : FeatureStorage::Float32;
+    baseCompression_ = baseBinary_ ? compression_ : FeatureCompression::None;
+    pendingChanges_ = 0;
+
+    const std::string logPath = DeltaLog::pathFor(basePath);
+    if (reset) {
+        std::remove(logPath.c_str());
+        return true;
+    }
+
+    std::vector<DeltaRecord> records;
+    if (!DeltaLog::read(logPath, records)) {
+        basePath_.clear();
+        return false;
+    }
+    size_t changes = replay(records);
+    pendingChanges_ = changes;
+    if (changes > 0) {
+        std::cout << "Applied " << changes << " changes from " << logPath
+                  << " (" << count_ << " images)" << std::endl;
+    }
+    return true;
+}
+
+/**
+ * @brief Add or replace an image and log it
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::putFeatures(const std::string& imagePath, const cv::Mat& features,
+                                  const FileStamp& stamp) {
+    if (!addFeatures(imagePath, features)) {
+        return false;
+    }
+
+    std::string name = normalizeImageName(imagePath);
+    stamps_[name] = stamp;
+
+    DeltaRecord record;
+    record.type = DeltaRecord::Type::Put;
+    record.name = name;
+    record.stamp = stamp;
+    cv::Mat row = getFeaturesAt(static_cast<size_t>(findRow(name)));
+    record.values.assign(row.ptr<float>(), row.ptr<float>() + dimension_);
+    pendingChanges_++;
+    return logChanges({record});
+}
+
+/**
+ * @brief Remove an image and log it
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::removeFeatures(const std::string& imageName) {
+    return removeFeatures(std::vector<std::string>{imageName}) == 1;
+}
+
+/**
+ * @brief Remove several images and log them
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t FeatureDatabase::removeFeatures(const std::vector<std::string>& imageNames) {
+    std::vector<size_t> rows;
+    std::vector<DeltaRecord> records;
+    for (const auto& imageName : imageNames) {
+        std::string name = normalizeImageName(imageName);
+        int row = findRow(name);
+        if (row < 0) {
+            continue;
+        }
+        rows.push_back(static_cast<size_t>(row));
+        stamps_.erase(name);
+
+        DeltaRecord record;
+        record.type = DeltaRecord::Type::Remove;
+        record.name = name;
+        records.push_back(std::move(record));
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    removeRows(rows);
+    pendingChanges_ += rows.size();
+    logChanges(records);
+    return rows.size();
+}
+
+/**
+ * @brief Log file stamps for stored images
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::stampFiles(const std::vector<std::pair<std::string, FileStamp>>& stamps) {
+    std::vector<DeltaRecord> records;
+    records.reserve(stamps.size());
+    for (const auto& entry : stamps) {
+        std::string name = normalizeImageName(entry.first);
+        if (findRow(name) < 0) {
+            continue;
+        }
+        DeltaRecord record;
+        record.type = DeltaRecord::Type::Stamp;
+        record.name = name;
+        record.stamp = entry.second;
+        stamps_[name] = entry.second;
+        records.push_back(std::move(record));
+    }
+    return logChanges(records);
+}
+
+/**
+ * @brief Compare a file with its recorded stamp
+ *
+ * @author Krushna Sanjay Sharma
+ */
+FileChange FeatureDatabase::checkFile(const std::string& imagePath, FileStamp& current) const {
+    std::string name = normalizeImageName(imagePath);
+    current = FileStamp::of(imagePath, false);
+
+    if (findRow(name) < 0) {
+        current.hash = FileStamp::hashFile(imagePath);
+        return FileChange::Added;
+    }
+
+    auto stamp = stamps_.find(name);
+    if (stamp != stamps_.end() && current.modified != 0 &&
+        stamp->second.modified == current.modified) {
+        current.hash = stamp->second.hash;
+        return FileChange::Unchanged;
+    }
+
+    current.hash = FileStamp::hashFile(imagePath);
+    if (stamp != stamps_.end() && stamp->second.hash != 0 &&
+        stamp->second.hash == current.hash) {
+        return FileChange::Touched;
+    }
+    return FileChange::Modified;
+}
+
+/**
+ * @brief Start or run a compaction
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::compact(bool background) {
+    waitForCompaction();
+
+    if (basePath_.empty()) {
+        std::cerr << "Error: Database has no base file to compact into" << std::endl;
+        return false;
+    }
+    if (empty()) {
+        std::cerr << "Error: No features to save" << std::endl;
+        return false;
+    }
+
+    // Snapshot rows and stamps; the database keeps serving while it is written
+    std::shared_ptr<FeatureDatabase> snapshot = std::make_shared<FeatureDatabase>();
+    snapshot->copyFrom(*this);
+
+    std::vector<DeltaRecord> stamps;
+    stamps.reserve(stamps_.size());
+    for (size_t row = 0; row < count_; row++) {
+        std::string name = getName(row);
+        auto stamp = stamps_.find(name);
+        if (stamp != stamps_.end()) {
+            DeltaRecord record;
+            record.type = DeltaRecord::Type::Stamp;
+            record.name = name;
+            record.stamp = stamp->second;
+            stamps.push_back(std::move(record));
+        }
+    }
+
+    // Records appended from here on survive the rewrite
+    uint64_t tailOffset = 0;
+    {
+        std::lock_guard<std::mutex> lock(logMutex_);
+        if (!log_) {
+            log_.reset(new DeltaLog());
+            if (!log_->open(DeltaLog::pathFor(basePath_), false)) {
+                log_.reset();
+                return false;
+            }
+        }
+        tailOffset = log_->size();
+    }
+    const size_t folded = pendingChanges_.load();
+
+    compacting_ = true;
+    if (background) {
+        compactionThread_ = std::thread([this, snapshot, stamps, tailOffset, folded]() {
+            compactionResult_ = writeCompaction(snapshot, stamps, tailOffset, folded);
+            compacting_ = false;
+        });
+        return true;
+    }
+
+    compactionResult_ = writeCompaction(snapshot, stamps, tailOffset, folded);
+    compacting_ = false;
+    return compactionResult_;
+}
+
+/**
+ * @brief Join a background compaction
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::waitForCompaction() {
+    if (compactionThread_.joinable()) {
+        compactionThread_.join();
+    }
+    return compactionResult_;
+}
+
+/**
+ * @brief Write the snapshot over the base file, then shrink the log
+ *
+ * The base is replaced first: if the process dies before the log is
+ * rewritten, replaying the old log over the new base is harmless.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::writeCompaction(const std::shared_ptr<FeatureDatabase>& snapshot,
+                                      const std::vector<DeltaRecord>& stamps,
+                                      uint64_t tailOffset, size_t foldedChanges) {
+    const std::string temporary = basePath_ + ".compact";
+    bool saved = baseBinary_ ? snapshot->saveToBinary(temporary, baseStorage_, baseCompression_)
+                             : snapshot->saveToCSV(temporary);
+    if (!saved) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, basePath_, error);
+    if (error) {
+        std::cerr << "Error: Cannot replace " << basePath_ << ": " << error.message() << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(logMutex_);
+    if (!log_ || !log_->rewrite(stamps, tailOffset)) {
+        return false;
+    }
+    pendingChanges_ -= std::min(foldedChanges, pendingChanges_.load());
+
+    std::cout << "Compacted " << snapshot->size() << " images into " << basePath_ << std::endl;
+    return true;
+}
+
+/**
+ * @brief Append records to the change log
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool FeatureDatabase::logChanges(const std::vector<DeltaRecord>& records) {
+    if (basePath_.empty() || records.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(logMutex_);
+    if (!log_) {
+        log_.reset(new DeltaLog());
+        if (!log_->open(DeltaLog::pathFor(basePath_), false)) {
+            log_.reset();
+            return false;
+        }
+    }
+
+    bool written = true;
+    for (const auto& record : records) {
+        written = log_->append(record) && written;
+    }
+    written = log_->flush() && written;
+    if (!written) {
+        std::cerr << "Error: Failed to record changes in " << log_->path() << std::endl;
+    }
+    return written;
+}
+
+/**
+ * @brief Apply log records in order
+ *
+ * A put of an existing name updates its row in place, so only removals
+ * change the layout; they are collected and applied in one pass.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t FeatureDatabase::replay(const std::vector<DeltaRecord>& records) {
+    std::unordered_set<std::string> removed;
+    size_t changes = 0;
+
+    for (const auto& record : records) {
+        switch (record.type) {
+        case DeltaRecord::Type::Put: {
+            cv::Mat row(1, static_cast<int>(record.values.size()), CV_32F,
+                        const_cast<float*>(record.values.data()));
+            if (addFeatures(record.name, row)) {
+                removed.erase(record.name);
+                stamps_[record.name] = record.stamp;
+                changes++;
+            }
+            break;
+        }
+        case DeltaRecord::Type::Remove:
+            removed.insert(record.name);
+            stamps_.erase(record.name);
+            changes++;
+            break;
+        case DeltaRecord::Type::Stamp:
+            stamps_[record.name] = record.stamp;
+            break;
+        }
+    }
+
+    std::vector<size_t> rows;
+    for (const auto& name : removed) {
+        int row = findRow(name);
+        if (row >= 0) {
+            rows.push_back(static_cast<size_t>(row));
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    removeRows(rows);
+    return changes;
+}
+
+/**
+ * @brief Drop rows and rebuild the packed arrays
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::removeRows(const std::vector<size_t>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    detach();
+
+    std::vector<float> features;
+    std::vector<uint64_t> nameOffsets(1, 0);
+    std::vector<char> nameChars;
+    features.reserve((count_ - rows.size()) * dimension_);
+    nameOffsets.reserve(count_ - rows.size() + 1);
+    nameChars.reserve(ownedNameChars_.size());
+
+    size_t next = 0;
+    for (size_t row = 0; row < count_; row++) {
+        if (next < rows.size() && rows[next] == row) {
+            next++;
+            continue;
+        }
+        const float* values = ownedFeatures_.data() + row * dimension_;
+        features.insert(features.end(), values, values + dimension_);
+        nameChars.insert(nameChars.end(), ownedNameChars_.begin() + ownedNameOffsets_[row],
+                         ownedNameChars_.begin() + ownedNameOffsets_[row + 1]);
+        nameOffsets.push_back(nameChars.size());
+    }
+
+    ownedFeatures_.swap(features);
+    ownedNameOffsets_.swap(nameOffsets);
+    ownedNameChars_.swap(nameChars);
+    count_ = ownedNameOffsets_.size() - 1;
+    if (count_ == 0) {
+        dimension_ = 0;
+    }
+    rebuildHash(count_ * 2);
+    refreshViews();
+}
+
+/**
+ * @brief Copy another database's rows as owned float32 storage
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::copyFrom(const FeatureDatabase& other) {
+    clear();
+    count_ = other.count_;
+    dimension_ = other.dimension_;
+    decodePolicy_ = other.decodePolicy_;
+
+    ownedFeatures_.resize(count_ * dimension_);
+    if (count_ > 0) {
+        cv::Mat owned(static_cast<int>(count_), dimension_, CV_32F, ownedFeatures_.data());
+        expandRows(other.matrix(), owned);
+    }
+    ownedNameOffsets_.assign(other.nameOffsets_, other.nameOffsets_ + count_ + 1);
+    ownedNameChars_.assign(other.nameChars_, other.nameChars_ + other.nameOffsets_[count_]);
+    ownedHash_.assign(other.hash_, other.hash_ + other.hashEntries_);
+    refreshViews();
+}
+
+/**
+ * @brief Hash index lookup with linear probing
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int FeatureDatabase::findRow(const std::string& name) const {
+    if (count_ == 0 || hashEntries_ == 0) {
+        return -1;
+    }
+
+    const size_t mask = hashEntries_ - 1;
+    for (size_t slot = hashName(name.data(), name.size()) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = hash_[slot];
+        if (entry == 0) {
+            return -1;
+        }
+        size_t row = entry - 1;
+        size_t length = static_cast<size_t>(nameOffsets_[row + 1] - nameOffsets_[row]);
+        if (length == name.size() &&
+            std::memcmp(nameChars_ + nameOffsets_[row], name.data(), length) == 0) {
+            return static_cast<int>(row);
+        }
+    }
+}
+
+/**
+ * @brief Copy file-backed arrays into owned storage
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::detach() {
+    if (!mapped_ && fileBuffer_.empty()) {
+        return;
+    }
+
+    cv::Mat packed = matrix();
+    ownedFeatures_.resize(count_ * dimension_);
+    if (!packed.empty()) {
+        cv::Mat owned(static_cast<int>(count_), dimension_, CV_32F, ownedFeatures_.data());
+        expandRows(packed, owned);
+    }
+    ownedNameOffsets_.assign(nameOffsets_, nameOffsets_ + count_ + 1);
+    ownedNameChars_.assign(nameChars_, nameChars_ + nameOffsets_[count_]);
+    ownedHash_.assign(hash_, hash_ + hashEntries_);
+
+    resetCompression();
+    mapped_.reset();
+    fileBuffer_.clear();
+    fileBuffer_.shrink_to_fit();
+    storage_ = FeatureStorage::Float32;
+    refreshViews();
+}
+
+/**
+ * @brief Point the views at owned storage
+ *
+ * Every change to the owned arrays ends here, so this also bumps version().
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::refreshViews() {
+    features_ = ownedFeatures_.data();
+    nameOffsets_ = ownedNameOffsets_.data();
+    nameChars_ = ownedNameChars_.data();
+    hash_ = ownedHash_.data();
+    hashEntries_ = ownedHash_.size();
+    version_++;
+}
+
+/**
+ * @brief Rebuild the owned hash table
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void FeatureDatabase::rebuildHash(size_t minEntries) {
+    size_t entries = 16;
+    while (entries < minEntries) {
+        entries *= 2;
+    }
+    ownedHash_.assign(entries, 0);
+
+    const size_t mask = entries - 1;
+    for (size_t row = 0; row < count_; row++) {
+        const char* name = ownedNameChars_.data() + ownedNameOffsets_[row];
+        size_t length = static_cast<size_t>(ownedNameOffsets_[row + 1] - ownedNameOffsets_[row]);
+        size_t slot = hashName(name, length) & mask;
+        while (ownedHash_[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        ownedHash_[slot] = static_cast<uint32_t>(row + 1);
+    }
+    hash_ = ownedHash_.data();
+    hashEntries_ = ownedHash_.size();
 }
 
 /**
  * @brief Normalize image name (extract filename from path)
- * 
+ *
  * Ensures consistent naming regardless of whether full paths or just
  * filenames are provided.
- * 
+ *
  * @author Krushna Sanjay Sharma
  */
 std::string FeatureDatabase::normalizeImageName(const std::string& imagePath) const {
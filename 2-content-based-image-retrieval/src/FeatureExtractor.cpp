@@ -7,10 +7,90 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "FeatureExtractor.h"
+#include "ImageContext.h"
+#include <atomic>
 #include <iostream>
 
 namespace cbir {
 
+/**
+ * @brief Extract features from a per-image context
+ * 
+ * Extractors without shared intermediates just use the decoded image.
+ * 
+ * @param context Decoded image and cached intermediates
+ * @return cv::Mat Feature vector
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+cv::Mat FeatureExtractor::extractFromContext(ImageContext& context) {
+    return extractFeatures(context.image());
+}
+
+/**
+ * @brief Extract features from many images into the rows of one matrix
+ * 
+ * Each image writes only its own row, so thread-safe extractors run across
+ * the OpenCV thread pool without locking.
+ * 
+ * @param images Decoded images
+ * @param out Output rows, images.size() x getFeatureDimension() CV_32F
+ * @param valid Optional per-image success flags
+ * @return int Number of images extracted
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+int FeatureExtractor::extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                                   std::vector<uchar>* valid) {
+    const int dimension = getFeatureDimension();
+    out.create(static_cast<int>(images.size()), dimension, CV_32F);
+    out.setTo(cv::Scalar::all(0));
+    if (valid != nullptr) {
+        valid->assign(images.size(), 0);
+    }
+    
+    std::atomic<int> extracted(0);
+    auto extractRange = [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; i++) {
+            const cv::Mat& image = images[i];
+            if (!isValidImage(image)) {
+                continue;
+            }
+            cv::Mat features;
+            try {
+                features = extractFeatures(image);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: " << getFeatureName() << " batch image " << i << ": "
+                          << e.what() << std::endl;
+                continue;
+            }
+            if (features.empty()) {
+                continue;
+            }
+            // Flatten to one float32 row, as FeatureDatabase::addFeatures()
+            cv::Mat continuous = features.isContinuous() ? features : features.clone();
+            cv::Mat row;
+            continuous.reshape(1, 1).convertTo(row, CV_32F);
+            if (row.cols != dimension) {
+                continue;
+            }
+            row.copyTo(out.row(i));
+            if (valid != nullptr) {
+                (*valid)[i] = 1;
+            }
+            extracted++;
+        }
+    };
+    
+    const cv::Range all(0, static_cast<int>(images.size()));
+    if (isThreadSafe()) {
+        cv::parallel_for_(all, extractRange);
+    } else {
+        extractRange(all);
+    }
+    return extracted.load();
+}
+
 /**
  * @brief Normalize feature vector to [0, 1] range
  * 
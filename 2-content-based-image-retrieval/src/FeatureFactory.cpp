@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////////////////////////////////
+// FeatureFactory.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Query-side extractor and metric factories. Parameters MUST
+//              match the ones buildFeatureDB uses for the same feature type.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "FeatureFactory.h"
+#include "BaselineFeature.h"
+#include "SSDMetric.h"
+#include "HistogramFeature.h"
+#include "HistogramIntersection.h"
+#include "MultiHistogramFeature.h"
+#include "MultiRegionHistogramIntersection.h"
+#include "TextureColorFeature.h"
+#include "WeightedHistogramIntersection.h"
+#include "GaborTextureColorFeature.h"
+#include "DNNFeature.h"
+#include "CosineDistance.h"
+#include "ProductMatcherFeature.h"
+#include "ProductMatcherDistance.h"
+#include "FaceAwareFeature.h"
+#include "FaceAwareDistance.h"
+#include "Utils.h"
+#include <iostream>
+
+namespace cbir {
+
+namespace FeatureFactory {
+
+/**
+ * Factory function to create appropriate feature extractor based on type
+ * 
+ * Must match the feature type used when building the database!
+ * 
+ * Supports:
+ *   - "baseline": 7x7 center square feature
+ *   - "histogram" or "rgb": RGB histogram (8 bins per channel)
+ *   - "chromaticity" or "rg": RG chromaticity histogram (16 bins per channel)
+ * 
+ * @param featureType Type of feature extractor to create
+ * @return Pointer to created feature extractor, nullptr if type unknown
+ */
+FeatureExtractor* createExtractor(const std::string& featureType) {
+    std::string type = Utils::toLower(featureType);
+    
+    if (type == "baseline") {
+        return new BaselineFeature();
+    } else if (type == "histogram" || type == "rgb") {
+        return new HistogramFeature(
+            HistogramFeature::HistogramType::RGB, 
+            8, true
+        );
+    } else if (type == "chromaticity" || type == "rg") {
+        return new HistogramFeature(
+            HistogramFeature::HistogramType::RG_CHROMATICITY, 
+            16, true
+        );
+    } else if (type == "multihistogram" || type == "multi") {
+        // Task 3: MUST match buildFeatureDB parameters!
+        // GRID split, 4 regions (2×2 quadrants)
+        // Total: 4 × 512 = 2048 values
+        return new MultiHistogramFeature(
+            MultiHistogramFeature::SplitType::GRID,
+            4,
+            HistogramFeature::HistogramType::RGB,
+            8,
+            true
+        );
+    } else if (type == "pyramid" || type == "spatialpyramid") {
+        // MUST match buildFeatureDB parameters!
+        // PYRAMID split, 2 levels (whole image + 2×2 quadrants)
+        // Total: 5 × 512 = 2560 values
+        return new MultiHistogramFeature(
+            MultiHistogramFeature::SplitType::PYRAMID,
+            2,
+            HistogramFeature::HistogramType::RGB,
+            8,
+            true
+        );
+    } else if (type == "texturecolor" || type == "texture") {
+        // Texture + Color: Sobel gradient histogram + RGB histogram
+        // Texture: 16 bins (gradient magnitudes 0-255)
+        // Color: 8 bins per channel (8×8×8 = 512 bins)
+        // Total: 16 + 512 = 528 values
+        return new TextureColorFeature(
+            16,   // texture bins
+            8,    // color bins per channel
+            true  // normalize
+        );
+    } else if (type == "gabor" || type == "gaborcolor") {
+        // Task 4 Extension: Gabor texture + Color
+        // 4 orientations × 2 scales × 8 bins = 64 texture bins
+        // 8×8×8 = 512 color bins
+        // Total: 576 values
+        return new GaborTextureColorFeature(
+            4,    // orientations
+            2,    // scales
+            8,    // bins per Gabor histogram
+            8,    // color bins per channel
+            true  // normalize
+        );
+    } else if (type == "dnn" || type == "resnet") {
+        // Task 5: DNN features (pre-computed ResNet18 embeddings)
+        // Features are loaded from CSV, not computed from images
+        return new DNNFeature("../data/features/ResNet18_olym.csv");
+    } else if (type == "productmatcher" || type == "product") {
+        return new ProductMatcherFeature(
+            "../data/features/ResNet18_olym.csv", 0.3, 8
+        );
+    }  else if (type == "faceaware" || type == "adaptive") {
+        return new FaceAwareFeature(
+            "../data/features/ResNet18_olym.csv",
+            "haarcascade_frontalface_alt2.xml"
+        );
+    }
+    
+    std::cerr << "Error: Unknown feature type '" << featureType << "'" << std::endl;
+    std::cerr << "Available: baseline, histogram, chromaticity, multihorizontal, texturecolor, gabor, dnn, productmatcher, faceaware" << std::endl;
+    return nullptr;
+}
+
+/**
+ * Factory function to create appropriate distance metric based on type
+ * 
+ * Supports:
+ *   - "ssd": Sum of Squared Differences (for baseline features)
+ *   - "histogram" or "intersection": Histogram Intersection (for histogram features)
+ * 
+ * @param metricType Type of distance metric to create
+ * @return Pointer to created distance metric, nullptr if type unknown
+ */
+DistanceMetric* createMetric(const std::string& metricType) {
+    std::string type = Utils::toLower(metricType);
+    
+    if (type == "ssd") {
+
+        return new SSDMetric();
+
+    } else if (type == "histogram" || type == "intersection") {
+
+        return new HistogramIntersection();
+
+    } else if (type == "multiregion") {
+
+        // Task 3: Custom multi-region histogram intersection
+        // Computes intersection per region, combines with equal weights
+        // For 2×2 grid: 4 regions, 512 bins each
+        std::vector<double> equalWeights = {0.25, 0.25, 0.25, 0.25};
+        return new MultiRegionHistogramIntersection(
+            4,              // 4 regions
+            512,            // 512 bins per region
+            equalWeights    // Equal weights for all regions
+        );
+        
+    } else if (type == "pyramid" || type == "spatialpyramid") {
+
+        // Spatial pyramid match: 5 regions of 512 bins, weighted per level
+        // (whole image 1/2, each quadrant 1/8)
+        MultiHistogramFeature pyramid(
+            MultiHistogramFeature::SplitType::PYRAMID, 2,
+            HistogramFeature::HistogramType::RGB, 8, true);
+        return new MultiRegionHistogramIntersection(5, 512, pyramid.getRegionWeights());
+        
+    } else if (type == "weighted" || type == "texturecolor") {
+
+        // Weighted intersection: 50% texture, 50% color
+        return new WeightedHistogramIntersection(
+            16,   // texture dimension
+            512,  // color dimension
+            0.5,  // 50% weight for texture
+            0.5   // 50% weight for color
+        );
+
+    } else if (type == "gabor" || type == "gaborweighted") {
+
+        // Gabor texture + color: 64 + 512
+        return new WeightedHistogramIntersection(64, 512, 0.5, 0.5);
+
+    } else if (type == "cosine") {
+        // Task 5: Cosine distance
+        // Measures angle between vectors (scale-invariant)
+        return new CosineDistance();
+    } else if (type == "productmatcher" || type == "product") {
+        return new ProductMatcherDistance(0.6, 0.4);
+    } else if (type == "faceaware" || type == "adaptive") {
+        return new FaceAwareDistance();
+    }
+    
+    std::cerr << "Error: Unknown metric type '" << metricType << "'" << std::endl;
+    std::cerr << "Available: ssd, histogram, multiregion, pyramid, weighted, gabor, cosine, productmatcher, faceaware" << std::endl;
+    return nullptr;
+}
+
+/**
+ * Extract query features, dispatching on the extractor type
+ * 
+ * ProductMatcher and FaceAware combine an image feature with the DNN
+ * embedding of the same filename; pure DNN features are a lookup only.
+ * 
+ * @param extractor Extractor from createExtractor()
+ * @param image Loaded query image
+ * @param imagePath Path of the query image
+ * @return Query features, empty on failure
+ */
+cv::Mat extractQueryFeatures(FeatureExtractor* extractor, const cv::Mat& image,
+                             const std::string& imagePath) {
+    if (extractor == nullptr) {
+        return cv::Mat();
+    }
+    
+    const std::string queryFilename = Utils::getFilename(imagePath);
+    cv::Mat queryFeatures;
+    
+    if (ProductMatcherFeature* productMatcher = dynamic_cast<ProductMatcherFeature*>(extractor)) {
+        // ProductMatcher: Needs filename for DNN lookup
+        queryFeatures = productMatcher->extractFeaturesWithFilename(image, queryFilename);
+        if (queryFeatures.empty()) {
+            std::cerr << "Error: Failed to extract ProductMatcher features" << std::endl;
+        }
+    } else if (DNNFeature* dnnExtractor = dynamic_cast<DNNFeature*>(extractor)) {
+        // Pure DNN: Needs filename for feature lookup
+        // Clone: the lookup is a read-only view into the shared store
+        queryFeatures = dnnExtractor->getFeaturesByFilename(queryFilename).clone();
+        if (queryFeatures.empty()) {
+            std::cerr << "Error: No DNN features found for " << queryFilename << std::endl;
+        }
+    } else if (FaceAwareFeature* faceAware = dynamic_cast<FaceAwareFeature*>(extractor)) {
+        queryFeatures = faceAware->extractFeaturesWithFilename(image, queryFilename);
+        if (queryFeatures.empty()) {
+            std::cerr << "Error: Failed to extract FaceAware features" << std::endl;
+        }
+    } else {
+        // Normal query: Extract features from image
+        queryFeatures = extractor->extractFeatures(image);
+        if (queryFeatures.empty()) {
+            std::cerr << "Error: Failed to extract features from query image" << std::endl;
+        }
+    }
+    
+    return queryFeatures;
+}
+
+} // namespace FeatureFactory
+
+} // namespace cbir
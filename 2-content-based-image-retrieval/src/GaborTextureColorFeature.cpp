@@ -20,10 +20,17 @@
 //   - Multiple scales capture fine and coarse textures
 //   - Better for natural textures (wood, fabric, water, grass)
 //
+// Filtering:
+//   - Kernel bank built once in the constructor
+//   - FFT: one forward transform per image, one spectrum product and
+//     inverse transform per kernel (kernel spectra cached per image size)
+//   - Responses binned directly into the combined texture histogram
+//
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "GaborTextureColorFeature.h"
+#include "ImageContext.h"
 #include <iostream>
 #include <cmath>
 
@@ -33,6 +40,16 @@
 
 namespace cbir {
 
+namespace {
+
+// Gabor filter parameters (shared by every kernel in the bank)
+const int GABOR_KSIZE = 31;          ///< Kernel size
+const double GABOR_SIGMA = 5.0;      ///< Gaussian envelope std dev
+const double GABOR_GAMMA = 0.5;      ///< Spatial aspect ratio
+const double GABOR_PSI = 0.0;        ///< Phase offset
+
+} // namespace
+
 /**
  * Default constructor
  * 
@@ -48,7 +65,8 @@ GaborTextureColorFeature::GaborTextureColorFeature()
       numScales_(2),
       binsPerGabor_(8),
       colorBinsPerChannel_(8),
-      normalize_(true) {
+      normalize_(true),
+      bank_(GABOR_KSIZE, bankParameters(numOrientations_, numScales_)) {
 }
 
 /**
@@ -63,7 +81,8 @@ GaborTextureColorFeature::GaborTextureColorFeature(int numOrientations,
       numScales_(numScales),
       binsPerGabor_(binsPerGabor),
       colorBinsPerChannel_(colorBinsPerChannel),
-      normalize_(normalize) {
+      normalize_(normalize),
+      bank_(GABOR_KSIZE, bankParameters(numOrientations_, numScales_)) {
 }
 
 /**
@@ -72,7 +91,7 @@ GaborTextureColorFeature::GaborTextureColorFeature(int numOrientations,
  * Process:
  *   1. Convert to grayscale for texture analysis
  *   2. Apply Gabor filter bank (multiple orientations and scales)
- *   3. Compute histogram for each Gabor response
+ *   3. Bin each Gabor response into its histogram
  *   4. Compute RGB color histogram
  *   5. Concatenate all histograms
  */
@@ -92,11 +111,29 @@ cv::Mat GaborTextureColorFeature::extractFeatures(const cv::Mat& image) {
     cv::Mat gray;
     cv::cvtColor(colorImage, gray, cv::COLOR_BGR2GRAY);
     
-    // Apply Gabor filter bank
-    std::vector<cv::Mat> gaborResponses = applyGaborFilters(gray);
-    
-    // Compute texture features from Gabor responses
-    cv::Mat textureHist = computeGaborHistogram(gaborResponses);
+    return combineFeatures(colorImage, gray);
+}
+
+/**
+ * Extract Gabor texture + color features from a shared context
+ * 
+ * Takes the BGR and grayscale images from the context instead of converting.
+ */
+cv::Mat GaborTextureColorFeature::extractFromContext(ImageContext& context) {
+    if (!isValidImage(context.image())) {
+        std::cerr << "Error: Invalid image for Gabor texture extraction" << std::endl;
+        return cv::Mat();
+    }
+    return combineFeatures(context.color(), context.gray());
+}
+
+/**
+ * Build [gabor_hists, color_hist] from a BGR image and its grayscale
+ */
+cv::Mat GaborTextureColorFeature::combineFeatures(const cv::Mat& colorImage,
+                                                  const cv::Mat& gray) const {
+    // Apply Gabor filter bank and histogram the responses
+    cv::Mat textureHist = computeGaborHistogram(gray);
     
     if (textureHist.empty()) {
         std::cerr << "Error: Failed to compute Gabor histogram" << std::endl;
@@ -136,167 +173,94 @@ int GaborTextureColorFeature::getFeatureDimension() const {
 }
 
 /**
- * Create Gabor filter kernel using OpenCV's built-in function
+ * Gabor bank parameters
  * 
- * OpenCV's getGaborKernel implements:
- *   G(x,y) = exp(-(x'²+γ²y'²)/(2σ²)) × cos(2π(x'/λ) + ψ)
- * 
- * @param ksize Kernel size (odd number)
- * @param sigma Gaussian envelope standard deviation
- * @param theta Orientation in radians
- * @param lambda Wavelength (controls scale/frequency)
- * @param gamma Spatial aspect ratio
- * @param psi Phase offset
- * @return Gabor kernel (using OpenCV's implementation)
- */
-cv::Mat GaborTextureColorFeature::createGaborKernel(int ksize, double sigma, 
-                                                    double theta, double lambda, 
-                                                    double gamma, double psi) const {
-    // Use OpenCV's built-in Gabor kernel generator
-    // This is allowed per project specifications for Task 4
-    return cv::getGaborKernel(
-        cv::Size(ksize, ksize),  // Kernel size
-        sigma,                    // Standard deviation of Gaussian
-        theta,                    // Orientation (radians)
-        lambda,                   // Wavelength
-        gamma,                    // Spatial aspect ratio
-        psi,                      // Phase offset
-        CV_32F                    // Kernel type
-    );
-}
-
-/**
- * Apply Gabor filter bank to image
- * 
- * Creates and applies multiple Gabor filters with different orientations
- * and scales to capture comprehensive texture information.
+ * One kernel per combination of orientation and scale, in the order the
+ * histograms are concatenated (scale-major).
  * 
  * Default configuration:
  *   - Orientations: 0°, 45°, 90°, 135° (4 orientations)
  *   - Scales: λ=5 (fine), λ=10 (coarse) (2 scales)
  *   - Total: 4 × 2 = 8 Gabor filters
- * 
- * @param image Grayscale image
- * @return Vector of 8 filtered images
  */
-std::vector<cv::Mat> GaborTextureColorFeature::applyGaborFilters(const cv::Mat& image) const {
-    std::vector<cv::Mat> responses;
-    
-    // Convert to float for filtering
-    cv::Mat imageFloat;
-    image.convertTo(imageFloat, CV_32F);
-    
-    // Gabor filter parameters
-    int ksize = 31;        // Kernel size
-    double sigma = 5.0;    // Gaussian envelope std dev
-    double gamma = 0.5;    // Spatial aspect ratio
-    double psi = 0.0;      // Phase offset
-    
+std::vector<cvcore::GaborParams> GaborTextureColorFeature::bankParameters(int numOrientations,
+                                                                          int numScales) {
     // Wavelengths for different scales
     std::vector<double> wavelengths = {5.0, 10.0};  // Fine and coarse
     
-    // Orientations (in radians)
-    std::vector<double> orientations;
-    for (int i = 0; i < numOrientations_; i++) {
-        double theta = (M_PI * i) / numOrientations_;  // 0°, 45°, 90°, 135° for 4 orientations
-        orientations.push_back(theta);
-    }
-    
-    // Apply each combination of orientation and scale
-    for (int s = 0; s < numScales_; s++) {
+    std::vector<cvcore::GaborParams> params;
+    for (int s = 0; s < numScales; s++) {
         double lambda = wavelengths[std::min(s, static_cast<int>(wavelengths.size()) - 1)];
         
-        for (int o = 0; o < numOrientations_; o++) {
-            double theta = orientations[o];
-            
-            // Create Gabor kernel
-            cv::Mat kernel = createGaborKernel(ksize, sigma, theta, lambda, gamma, psi);
-            
-            // Apply filter using convolution
-            cv::Mat filtered;
-            cv::filter2D(imageFloat, filtered, CV_32F, kernel);
+        for (int o = 0; o < numOrientations; o++) {
+            double theta = (M_PI * o) / numOrientations;  // 0°, 45°, 90°, 135° for 4 orientations
+            params.push_back({GABOR_SIGMA, theta, lambda, GABOR_GAMMA, GABOR_PSI});
+        }
+    }
+    return params;
+}
+
+/**
+ * Bin the absolute filter response into one Gabor histogram
+ * 
+ * Fixed range [0, 100] for consistency across images; larger responses
+ * fall in the last bin.
+ */
+void GaborTextureColorFeature::accumulateResponse(const cv::Mat& response, double* counts) const {
+    const float maxRange = 100.0f;
+    const float binSize = maxRange / binsPerGabor_;
+    
+    for (int row = 0; row < response.rows; row++) {
+        const float* values = response.ptr<float>(row);
+        for (int col = 0; col < response.cols; col++) {
+            float value = std::min(std::fabs(values[col]), maxRange);
             
-            // Take absolute value of response
-            cv::Mat absFiltered = cv::abs(filtered);
+            int bin = static_cast<int>(value / binSize);
+            bin = std::min(bin, binsPerGabor_ - 1);
             
-            responses.push_back(absFiltered);
+            counts[bin] += 1.0;
         }
     }
-    
-    return responses;
 }
 
 /**
  * Compute histogram from Gabor filter responses
  * 
- * For each Gabor-filtered image:
- *   1. Create histogram of response magnitudes
- *   2. Normalize histogram
- *   3. Concatenate all histograms
+ * cvcore::GaborBank filters with every kernel in one parallel pass (FFT of
+ * the image once, then one spectrum product per kernel, by default). Each
+ * response is binned directly into its own slice of the combined
+ * histogram, so workers never share counters. Then the concatenated
+ * histogram is normalized once.
  * 
  * Result: [hist_gabor0, hist_gabor1, ..., hist_gabor7]
  * 
- * @param gaborResponses Vector of Gabor-filtered images
+ * @param gray Grayscale image
  * @return Concatenated Gabor texture histogram
  */
-cv::Mat GaborTextureColorFeature::computeGaborHistogram(
-    const std::vector<cv::Mat>& gaborResponses) const {
+cv::Mat GaborTextureColorFeature::computeGaborHistogram(const cv::Mat& gray) const {
+    std::vector<double> counts(bank_.size() * binsPerGabor_, 0.0);
     
-    std::vector<cv::Mat> histograms;
-    
-    // Compute histogram for each Gabor response
-    for (const auto& response : gaborResponses) {
-        cv::Mat histogram = cv::Mat::zeros(1, binsPerGabor_, CV_32F);
-        
-        // Use fixed range for consistency
-        float maxRange = 100.0f;
-        float binSize = maxRange / binsPerGabor_;
-        
-        // Compute histogram (RAW counts, don't normalize yet)
-        for (int row = 0; row < response.rows; row++) {
-            for (int col = 0; col < response.cols; col++) {
-                float value = response.at<float>(row, col);
-                value = std::min(value, maxRange);
-                
-                int bin = static_cast<int>(value / binSize);
-                bin = std::min(bin, binsPerGabor_ - 1);
-                bin = std::max(bin, 0);
-                
-                histogram.at<float>(0, bin) += 1.0f;
-            }
-        }
-        
-        // ⭐ DON'T normalize individual histograms here!
-        histograms.push_back(histogram);
-    }
+    bank_.forEachResponse(gray, [&](int k, const cv::Mat& response) {
+        accumulateResponse(response, &counts[k * binsPerGabor_]);
+    });
     
     // Verify correct number of histograms
     int expectedHistograms = numOrientations_ * numScales_;
-    if (static_cast<int>(histograms.size()) != expectedHistograms) {
+    if (bank_.size() != expectedHistograms) {
         std::cerr << "ERROR: Expected " << expectedHistograms << " histograms, got " 
-                  << histograms.size() << std::endl;
+                  << bank_.size() << std::endl;
         return cv::Mat();
     }
     
-    // Concatenate all Gabor histograms
-    int totalTextureBins = binsPerGabor_ * static_cast<int>(histograms.size());
-    cv::Mat combinedTexture(1, totalTextureBins, CV_32F);
-    
-    int offset = 0;
-    for (const auto& hist : histograms) {
-        for (int i = 0; i < hist.cols; i++) {
-            combinedTexture.at<float>(0, offset + i) = hist.at<float>(0, i);
-        }
-        offset += hist.cols;
+    cv::Mat combinedTexture(1, static_cast<int>(counts.size()), CV_32F);
+    double sum = 0.0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        combinedTexture.at<float>(0, static_cast<int>(i)) = static_cast<float>(counts[i]);
+        sum += counts[i];
     }
     
-    // ⭐ NOW normalize the CONCATENATED histogram (so sum = 1.0)
+    // Normalize the CONCATENATED histogram (so sum = 1.0)
     if (normalize_) {
-        double sum = 0.0;
-        for (int i = 0; i < combinedTexture.cols; i++) {
-            sum += combinedTexture.at<float>(0, i);
-        }
-        
         if (sum > 1e-10) {
             combinedTexture /= sum;
         } else {
@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////////////////////////
+// GpuHistogram.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the OpenCL histogram backend: the counting
+//              kernel, packing of a batch into one device buffer and the
+//              read-back of the counts.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "GpuHistogram.h"
+#include "FeatureExtractor.h"
+#include <opencv2/core/ocl.hpp>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace cbir {
+
+namespace {
+
+/// Work items per group (capped by the device)
+const size_t GROUP_SIZE = 256;
+
+/// Pixels each work item counts at least; more items only add merges
+const int PIXELS_PER_ITEM = 64;
+
+/// Work groups per image at most
+const int MAX_GROUPS_PER_IMAGE = 64;
+
+/// Local memory left to the implementation when sizing the histogram
+const size_t LOCAL_MEMORY_RESERVE = 1024;
+
+/// Set once a kernel fails to build; the CPU is used from then on
+std::atomic<bool> kernelFailed(false);
+
+/**
+ * Work dimension 0 strides over the pixels of an image, dimension 1 picks
+ * the image. Each group counts into local memory (LOCAL_HISTOGRAM) and
+ * adds its non-zero bins to the image's global counts at the end; layouts
+ * too large for local memory count into global memory directly.
+ *
+ * images holds (byte offset, rows, cols, step) per image, regions
+ * (x, y, width, height) per image and region. Colour mode 1 is RGB through
+ * the value -> bin table, mode 2 RG chromaticity.
+ */
+const char* HISTOGRAM_KERNEL_SOURCE = R"CL(
+inline int reflect101(int index, int length)
+{
+    if (length == 1) {
+        return 0;
+    }
+    if (index < 0) {
+        return -index;
+    }
+    return index >= length ? 2 * length - 2 - index : index;
+}
+
+inline int grayAt(__global const uchar* image, int step, int x, int y)
+{
+    __global const uchar* pixel = image + (size_t)y * step + 3 * x;
+    return (pixel[0] * 1868 + pixel[1] * 9617 + pixel[2] * 4899 + (1 << 13)) >> 14;
+}
+
+#if LOCAL_HISTOGRAM
+#define COUNT(bin) atomic_inc(&localCounts[bin])
+#else
+#define COUNT(bin) atomic_inc(&imageCounts[bin])
+#endif
+
+__kernel void countHistograms(__global const uchar* pixels, __global const int* images,
+                              __global const int* regions, int regionCount,
+                              __global const int* colorBinOf, int colorMode, int colorBins,
+                              int textureBins, float textureBinSize, int total,
+                              __local uint* localCounts, __global uint* counts)
+{
+    const int image = get_global_id(1);
+    __global const int* info = images + 4 * image;
+    __global const uchar* base = pixels + info[0];
+    const int rows = info[1];
+    const int cols = info[2];
+    const int step = info[3];
+    __global uint* imageCounts = counts + (size_t)image * total;
+    __global const int* rects = regions + (size_t)image * regionCount * 4;
+    const int colorDim = colorMode == 1 ? colorBins * colorBins * colorBins
+                                        : colorBins * colorBins;
+
+#if LOCAL_HISTOGRAM
+    for (int i = get_local_id(0); i < total; i += get_local_size(0)) {
+        localCounts[i] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+#endif
+
+    const int pixelCount = rows * cols;
+    for (int p = get_global_id(0); p < pixelCount; p += get_global_size(0)) {
+        const int y = p / cols;
+        const int x = p - y * cols;
+
+        if (textureBins > 0) {
+            const int y0 = reflect101(y - 1, rows);
+            const int y2 = reflect101(y + 1, rows);
+            const int x0 = reflect101(x - 1, cols);
+            const int x2 = reflect101(x + 1, cols);
+            const int a = grayAt(base, step, x0, y0);
+            const int b = grayAt(base, step, x, y0);
+            const int c = grayAt(base, step, x2, y0);
+            const int d = grayAt(base, step, x0, y);
+            const int f = grayAt(base, step, x2, y);
+            const int g = grayAt(base, step, x0, y2);
+            const int h = grayAt(base, step, x, y2);
+            const int k = grayAt(base, step, x2, y2);
+            const int dx = (c - a) + 2 * (f - d) + (k - g);
+            const int dy = (g - a) + 2 * (h - b) + (k - c);
+            float magnitude = sqrt((float)(dx * dx + dy * dy));
+            magnitude = min(max(magnitude, 0.0f), 255.0f);
+            COUNT(min((int)(magnitude / textureBinSize), textureBins - 1));
+        }
+
+        __global const uchar* pixel = base + (size_t)y * step + 3 * x;
+        int bin;
+        if (colorMode == 1) {
+            bin = (colorBinOf[pixel[2]] * colorBins + colorBinOf[pixel[1]]) * colorBins
+                + colorBinOf[pixel[0]];
+        } else {
+            const float b = (float)pixel[0];
+            const float g = (float)pixel[1];
+            const float r = (float)pixel[2];
+            const float sum = max(r + g + b, 1.0f);
+            const int binR = min((int)((r / sum) * colorBins), colorBins - 1);
+            const int binG = min((int)((g / sum) * colorBins), colorBins - 1);
+            bin = binR * colorBins + binG;
+        }
+        for (int region = 0; region < regionCount; region++) {
+            __global const int* rect = rects + 4 * region;
+            if (x >= rect[0] && x < rect[0] + rect[2] &&
+                y >= rect[1] && y < rect[1] + rect[3]) {
+                COUNT(textureBins + region * colorDim + bin);
+            }
+        }
+    }
+
+#if LOCAL_HISTOGRAM
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int i = get_local_id(0); i < total; i += get_local_size(0)) {
+        const uint value = localCounts[i];
+        if (value != 0) {
+            atomic_add(&imageCounts[i], value);
+        }
+    }
+#endif
+}
+)CL";
+
+const cv::ocl::ProgramSource& histogramProgram() {
+    static const cv::ocl::ProgramSource source(HISTOGRAM_KERNEL_SOURCE);
+    return source;
+}
+
+/// Texture and chromaticity bins divide floats like the CPU code
+bool divides(const GpuHistogram::Layout& layout) {
+    return layout.textureBins > 0 || layout.chromaticity;
+}
+
+bool hasCorrectlyRoundedDivision() {
+    return (cv::ocl::Device::getDefault().singleFPConfig() &
+            cv::ocl::Device::FP_CORRECTLY_ROUNDED_DIVIDE_SQRT) != 0;
+}
+
+} // namespace
+
+namespace GpuHistogram {
+
+bool isAvailable() {
+    if (!cv::ocl::haveOpenCL()) {
+        return false;
+    }
+    cv::ocl::setUseOpenCL(true);
+    return cv::ocl::useOpenCL() && cv::ocl::Device::getDefault().available();
+}
+
+bool supports(const Layout& layout) {
+    return isAvailable() && (!divides(layout) || hasCorrectlyRoundedDivision());
+}
+
+int dimension(const Layout& layout, int regionCount) {
+    const int bins = layout.colorBins;
+    const int colorDim = layout.chromaticity ? bins * bins : bins * bins * bins;
+    return layout.textureBins + regionCount * colorDim;
+}
+
+/**
+ * @brief Pack the batch, run the kernel and read back the counts
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool count(const std::vector<cv::Mat>& images, const Layout& layout,
+           const std::vector<std::vector<cv::Rect>>& regions, cv::Mat& counts) {
+    counts.release();
+    if (kernelFailed || images.empty() || layout.colorBins <= 0 || layout.textureBins < 0 ||
+        (!regions.empty() && regions.size() != images.size()) || !supports(layout)) {
+        return false;
+    }
+
+    const int imageCount = static_cast<int>(images.size());
+    const int regionCount = regions.empty() ? 1 : static_cast<int>(regions.front().size());
+    const int total = dimension(layout, regionCount);
+
+    // Image table and packed pixels; offsets must fit the kernel's int
+    cv::Mat info(imageCount, 4, CV_32S);
+    cv::Mat rects(imageCount, regionCount * 4, CV_32S);
+    size_t bytes = 0;
+    int largest = 0;
+    for (int i = 0; i < imageCount; i++) {
+        const cv::Mat& image = images[i];
+        if (image.type() != CV_8UC3 || image.empty() ||
+            (!regions.empty() && static_cast<int>(regions[i].size()) != regionCount)) {
+            return false;
+        }
+        int* row = info.ptr<int>(i);
+        row[0] = static_cast<int>(std::min<size_t>(bytes, INT_MAX));
+        row[1] = image.rows;
+        row[2] = image.cols;
+        row[3] = image.cols * 3;
+        bytes += image.total() * image.elemSize();
+        largest = std::max(largest, image.rows * image.cols);
+
+        int* rect = rects.ptr<int>(i);
+        for (int r = 0; r < regionCount; r++) {
+            const cv::Rect region = regions.empty() ? cv::Rect(0, 0, image.cols, image.rows)
+                                                    : regions[i][r];
+            rect[4 * r] = region.x;
+            rect[4 * r + 1] = region.y;
+            rect[4 * r + 2] = region.width;
+            rect[4 * r + 3] = region.height;
+        }
+    }
+    const cv::ocl::Device& device = cv::ocl::Device::getDefault();
+    if (bytes > static_cast<size_t>(INT_MAX) || bytes > device.maxMemAllocSize()) {
+        return false;
+    }
+
+    cv::Mat packed(1, static_cast<int>(bytes), CV_8U);
+    uchar* dst = packed.ptr<uchar>(0);
+    for (const cv::Mat& image : images) {
+        const size_t rowBytes = static_cast<size_t>(image.cols) * 3;
+        for (int row = 0; row < image.rows; row++) {
+            std::memcpy(dst, image.ptr<uchar>(row), rowBytes);
+            dst += rowBytes;
+        }
+    }
+
+    cv::Mat binOf(1, 256, CV_32S);
+    const float binSize = 256.0f / layout.colorBins;
+    for (int value = 0; value < 256; value++) {
+        binOf.at<int>(value) = std::min(static_cast<int>(value / binSize), layout.colorBins - 1);
+    }
+
+    try {
+        const size_t histogramBytes = static_cast<size_t>(total) * sizeof(unsigned int);
+        const bool useLocal = histogramBytes + LOCAL_MEMORY_RESERVE <= device.localMemSize();
+        std::string options = std::string("-D LOCAL_HISTOGRAM=") + (useLocal ? "1" : "0");
+        if (divides(layout)) {
+            options += " -cl-fp32-correctly-rounded-divide-sqrt";
+        }
+        cv::ocl::Kernel kernel("countHistograms", histogramProgram(), options);
+        if (kernel.empty()) {
+            std::cerr << "Warning: OpenCL histogram kernel failed to build, using the CPU"
+                      << std::endl;
+            kernelFailed = true;
+            return false;
+        }
+
+        cv::UMat devicePixels;
+        cv::UMat deviceInfo;
+        cv::UMat deviceRects;
+        cv::UMat deviceBinOf;
+        packed.copyTo(devicePixels);
+        info.copyTo(deviceInfo);
+        rects.copyTo(deviceRects);
+        binOf.copyTo(deviceBinOf);
+        cv::UMat deviceCounts(imageCount, total, CV_32S);
+        deviceCounts.setTo(cv::Scalar::all(0));
+
+        const size_t groupSize = std::min(GROUP_SIZE, device.maxWorkGroupSize());
+        const int groups = std::max(1, std::min(MAX_GROUPS_PER_IMAGE,
+            static_cast<int>(largest / (static_cast<int64_t>(groupSize) * PIXELS_PER_ITEM))));
+        const int colorMode = layout.chromaticity ? 2 : 1;
+        const float textureBinSize = layout.textureBins > 0 ? 255.0f / layout.textureBins : 1.0f;
+
+        kernel.args(cv::ocl::KernelArg::PtrReadOnly(devicePixels),
+                    cv::ocl::KernelArg::PtrReadOnly(deviceInfo),
+                    cv::ocl::KernelArg::PtrReadOnly(deviceRects), regionCount,
+                    cv::ocl::KernelArg::PtrReadOnly(deviceBinOf), colorMode, layout.colorBins,
+                    layout.textureBins, textureBinSize, total,
+                    cv::ocl::KernelArg::Local(useLocal ? histogramBytes : sizeof(unsigned int)),
+                    cv::ocl::KernelArg::PtrReadWrite(deviceCounts));
+        size_t globalSize[2] = {groups * groupSize, static_cast<size_t>(imageCount)};
+        size_t localSize[2] = {groupSize, 1};
+        if (!kernel.run(2, globalSize, localSize, true)) {
+            std::cerr << "Warning: OpenCL histogram batch failed, using the CPU" << std::endl;
+            return false;
+        }
+
+        cv::Mat rawCounts;
+        deviceCounts.copyTo(rawCounts);
+        rawCounts.convertTo(counts, CV_32F);
+    } catch (const cv::Exception& error) {
+        std::cerr << "Warning: OpenCL histogram batch failed (" << error.what()
+                  << "), using the CPU" << std::endl;
+        counts.release();
+        return false;
+    }
+    return true;
+}
+
+void collectColorImages(const FeatureExtractor& extractor, const std::vector<cv::Mat>& images,
+                        std::vector<cv::Mat>& colorImages, std::vector<int>& positions) {
+    colorImages.clear();
+    positions.clear();
+    for (size_t i = 0; i < images.size(); i++) {
+        const cv::Mat& image = images[i];
+        if (!extractor.isValidImage(image)) {
+            continue;
+        }
+        cv::Mat colorImage = image;
+        if (image.channels() == 1) {
+            cv::cvtColor(image, colorImage, cv::COLOR_GRAY2BGR);
+        }
+        colorImages.push_back(colorImage);
+        positions.push_back(static_cast<int>(i));
+    }
+}
+
+} // namespace GpuHistogram
+
+} // namespace cbir
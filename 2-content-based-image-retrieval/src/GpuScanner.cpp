@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////////////////////////
+// GpuScanner.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the OpenCL scan backend: the top-K kernel,
+//              device upload of the feature matrix and the host-side merge
+//              of per-chunk candidates.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "GpuScanner.h"
+#include "Utils.h"
+#include <algorithm>
+#include <iostream>
+
+namespace cbir {
+
+namespace {
+
+/// Fewest rows per work item; smaller chunks only add candidates to merge
+const int MIN_CHUNK_ROWS = 256;
+
+/// Chunks per query at most, bounding the candidates read back
+const int MAX_CHUNKS = 4096;
+
+/**
+ * One work item per (chunk, query): score the chunk's rows and keep the
+ * k best in a sorted private buffer. Strict comparisons keep the lower
+ * row first on ties, matching the CPU ranking.
+ */
+const char* SCAN_KERNEL_SOURCE = R"CL(
+__kernel void scanTopK(__global const float* rows, __global const float* rowNorms,
+                       int rowCount, int dimension, int chunkRows, int chunkCount,
+                       __global const float* queries, __global const float* queryNorms,
+                       int metric, int k,
+                       __global float* outDistances, __global int* outRows)
+{
+    const int chunk = get_global_id(0);
+    const int q = get_global_id(1);
+    float bestDistance[MAX_K];
+    int bestRow[MAX_K];
+    int filled = 0;
+
+    const __global float* query = queries + (size_t)q * dimension;
+    const int start = chunk * chunkRows;
+    const int end = min(rowCount, start + chunkRows);
+    for (int row = start; row < end; row++) {
+        const __global float* values = rows + (size_t)row * dimension;
+        float distance;
+        if (metric == 0) {
+            float sum = 0.0f;
+            for (int j = 0; j < dimension; j++) {
+                const float d = query[j] - values[j];
+                sum = fma(d, d, sum);
+            }
+            distance = sum;
+        } else {
+            float dot = 0.0f;
+            for (int j = 0; j < dimension; j++) {
+                dot = fma(query[j], values[j], dot);
+            }
+            const float denominator = queryNorms[q] * rowNorms[row];
+            distance = denominator < 1e-10f
+                ? 1.0f : 1.0f - clamp(dot / denominator, -1.0f, 1.0f);
+        }
+
+        if (filled == k && distance >= bestDistance[k - 1]) {
+            continue;
+        }
+        int slot = filled < k ? filled++ : k - 1;
+        while (slot > 0 && bestDistance[slot - 1] > distance) {
+            bestDistance[slot] = bestDistance[slot - 1];
+            bestRow[slot] = bestRow[slot - 1];
+            slot--;
+        }
+        bestDistance[slot] = distance;
+        bestRow[slot] = row;
+    }
+
+    const size_t base = ((size_t)q * chunkCount + chunk) * k;
+    for (int i = 0; i < k; i++) {
+        outDistances[base + i] = i < filled ? bestDistance[i] : INFINITY;
+        outRows[base + i] = i < filled ? bestRow[i] : -1;
+    }
+}
+)CL";
+
+const cv::ocl::ProgramSource& scanProgram() {
+    static const cv::ocl::ProgramSource source(SCAN_KERNEL_SOURCE);
+    return source;
+}
+
+} // namespace
+
+bool parseScanBackend(const std::string& name, ScanBackend& backend) {
+    const std::string lower = Utils::toLower(name);
+    if (lower == "cpu") {
+        backend = ScanBackend::Cpu;
+    } else if (lower == "gpu") {
+        backend = ScanBackend::Gpu;
+    } else if (lower == "auto") {
+        backend = ScanBackend::Auto;
+    } else if (lower == "numa") {
+        backend = ScanBackend::Numa;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string scanBackendName(ScanBackend backend) {
+    switch (backend) {
+        case ScanBackend::Gpu:
+            return "gpu";
+        case ScanBackend::Auto:
+            return "auto";
+        case ScanBackend::Numa:
+            return "numa";
+        default:
+            return "cpu";
+    }
+}
+
+bool GpuScanner::isAvailable() {
+    if (!cv::ocl::haveOpenCL()) {
+        return false;
+    }
+    cv::ocl::setUseOpenCL(true);
+    return cv::ocl::useOpenCL() && cv::ocl::Device::getDefault().available();
+}
+
+bool GpuScanner::metricFor(const std::string& metricName, Metric& metric) {
+    if (metricName == "SSD") {
+        metric = Metric::SSD;
+    } else if (metricName == "CosineDistance") {
+        metric = Metric::Cosine;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Run the kernel over every (chunk, query) pair and merge the chunks
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool GpuScanner::search(const FeatureDatabase& database, const cv::Mat& queries, Metric metric,
+                        int k, std::vector<std::vector<std::pair<float, int>>>& best) {
+    best.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (kernelFailed_ || k <= 0 || k > MAX_K || queries.empty() ||
+        queries.type() != CV_32F || !isAvailable()) {
+        return false;
+    }
+
+    try {
+        if (!upload(database) || queries.cols != rows_.cols) {
+            return false;
+        }
+
+        cv::ocl::Kernel kernel("scanTopK", scanProgram(), "-D MAX_K=" + std::to_string(MAX_K));
+        if (kernel.empty()) {
+            std::cerr << "Warning: OpenCL scan kernel failed to build, using the CPU" << std::endl;
+            kernelFailed_ = true;
+            return false;
+        }
+
+        const int rowCount = rows_.rows;
+        const int chunkRows = std::max(MIN_CHUNK_ROWS, (rowCount + MAX_CHUNKS - 1) / MAX_CHUNKS);
+        const int chunkCount = (rowCount + chunkRows - 1) / chunkRows;
+
+        cv::Mat norms(1, queries.rows, CV_32F);
+        for (int q = 0; q < queries.rows; q++) {
+            norms.at<float>(q) = static_cast<float>(cv::norm(queries.row(q), cv::NORM_L2));
+        }
+        cv::UMat deviceQueries;
+        cv::UMat deviceNorms;
+        queries.copyTo(deviceQueries);
+        norms.copyTo(deviceNorms);
+
+        const int candidates = chunkCount * k;
+        cv::UMat deviceDistances(queries.rows, candidates, CV_32F);
+        cv::UMat deviceRows(queries.rows, candidates, CV_32S);
+        kernel.args(cv::ocl::KernelArg::PtrReadOnly(rows_),
+                    cv::ocl::KernelArg::PtrReadOnly(rowNorms_),
+                    rowCount, rows_.cols, chunkRows, chunkCount,
+                    cv::ocl::KernelArg::PtrReadOnly(deviceQueries),
+                    cv::ocl::KernelArg::PtrReadOnly(deviceNorms),
+                    metric == Metric::SSD ? 0 : 1, k,
+                    cv::ocl::KernelArg::PtrWriteOnly(deviceDistances),
+                    cv::ocl::KernelArg::PtrWriteOnly(deviceRows));
+        size_t globalSize[2] = {static_cast<size_t>(chunkCount), static_cast<size_t>(queries.rows)};
+        if (!kernel.run(2, globalSize, nullptr, true)) {
+            std::cerr << "Warning: OpenCL scan failed, using the CPU" << std::endl;
+            return false;
+        }
+
+        cv::Mat distances;
+        cv::Mat rows;
+        deviceDistances.copyTo(distances);
+        deviceRows.copyTo(rows);
+
+        // Each chunk's list is sorted; a partial sort of the union suffices
+        best.resize(queries.rows);
+        for (int q = 0; q < queries.rows; q++) {
+            const float* distance = distances.ptr<float>(q);
+            const int* row = rows.ptr<int>(q);
+            std::vector<std::pair<float, int>>& ranked = best[q];
+            ranked.reserve(candidates);
+            for (int i = 0; i < candidates; i++) {
+                if (row[i] >= 0) {
+                    ranked.emplace_back(distance[i], row[i]);
+                }
+            }
+            const size_t keep = std::min(ranked.size(), static_cast<size_t>(k));
+            std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end());
+            ranked.resize(keep);
+        }
+    } catch (const cv::Exception& error) {
+        std::cerr << "Warning: OpenCL scan failed (" << error.what() << "), using the CPU"
+                  << std::endl;
+        best.clear();
+        return false;
+    }
+    return true;
+}
+
+size_t GpuScanner::deviceBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rows_.total() * rows_.elemSize() + rowNorms_.total() * rowNorms_.elemSize();
+}
+
+/**
+ * @brief Copy the matrix and its row norms to the device
+ *
+ * The norms are the database's own (FeatureDatabase::rowNorms()), shared
+ * with CPU cosine scans and computed once per database version.
+ *
+ * Quantised (uint8) storage is not uploaded: its rows are codes with a
+ * trailing scale, and decoding them would double the host memory.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool GpuScanner::upload(const FeatureDatabase& database) {
+    if (source_ == &database && sourceVersion_ == database.version() && !rows_.empty()) {
+        return true;
+    }
+    source_ = nullptr;
+    rows_.release();
+    rowNorms_.release();
+
+    const cv::Mat matrix = database.matrix();
+    if (matrix.empty()) {
+        return false;
+    }
+    cv::Mat floats;
+    if (matrix.type() == CV_32F) {
+        floats = matrix;
+    } else if (matrix.type() == CV_16F) {
+        matrix.convertTo(floats, CV_32F);
+    } else {
+        return false;
+    }
+
+    const size_t bytes = floats.total() * floats.elemSize();
+    if (bytes > cv::ocl::Device::getDefault().maxMemAllocSize()) {
+        std::cerr << "Warning: Feature matrix (" << (bytes >> 20)
+                  << " MB) exceeds the device allocation limit, using the CPU" << std::endl;
+        return false;
+    }
+
+    cv::Mat norms;
+    database.rowNorms().reshape(1, 1).convertTo(norms, CV_32F);
+    floats.copyTo(rows_);
+    norms.copyTo(rowNorms_);
+
+    source_ = &database;
+    sourceVersion_ = database.version();
+    std::cout << "Uploaded " << floats.rows << " x " << floats.cols
+              << " feature matrix to " << cv::ocl::Device::getDefault().name() << std::endl;
+    return true;
+}
+
+} // namespace cbir
@@ -17,11 +17,16 @@
 //      - More robust to lighting variations
 //
 // Features are normalized (sum=1.0) and flattened to 1D vectors for comparison.
+// 8, 16 and 32 bins per channel are counted by the specialised kernels in
+// HistogramKernels; other bin counts use the generic loops below.
 //
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "HistogramFeature.h"
+#include "ImageContext.h"
+#include "HistogramKernels.h"
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -35,7 +40,7 @@ namespace cbir {
  * @param normalize If true, normalize histogram to sum=1.0
  */
 HistogramFeature::HistogramFeature(HistogramType type, int binsPerChannel, bool normalize)
-    : type_(type), binsPerChannel_(binsPerChannel), normalize_(normalize) {
+    : type_(type), binsPerChannel_(binsPerChannel), normalize_(normalize), useGpu_(false) {
     
     // Validate bins per channel
     if (binsPerChannel_ <= 0) {
@@ -69,12 +74,18 @@ cv::Mat HistogramFeature::extractFeatures(const cv::Mat& image) {
         cv::cvtColor(image, colorImage, cv::COLOR_GRAY2BGR);
     }
     
-    // Compute histogram based on configured type
+    // Compute histogram based on configured type; 8, 16 and 32 bins have
+    // specialised kernels that produce the flattened counts directly
     cv::Mat histogram;
-    if (type_ == HistogramType::RGB) {
-        histogram = computeRGBHistogram(colorImage);
-    } else {
-        histogram = computeRGChromaticityHistogram(colorImage);
+    bool flat = (type_ == HistogramType::RGB)
+        ? HistogramKernels::countRGB(colorImage, binsPerChannel_, histogram)
+        : HistogramKernels::countChromaticity(colorImage, binsPerChannel_, histogram);
+    if (!flat) {
+        if (type_ == HistogramType::RGB) {
+            histogram = computeRGBHistogram(colorImage);
+        } else {
+            histogram = computeRGChromaticityHistogram(colorImage);
+        }
     }
     
     if (histogram.empty()) {
@@ -87,7 +98,78 @@ cv::Mat HistogramFeature::extractFeatures(const cv::Mat& image) {
     }
     
     // Flatten multi-dimensional histogram to 1D vector for distance computation
-    return flattenHistogram(histogram);
+    return flat ? histogram : flattenHistogram(histogram);
+}
+
+/**
+ * Extract histogram features from a shared context
+ * 
+ * Uses the context's BGR image, so a grayscale input is converted once for
+ * every extractor sharing the context.
+ */
+cv::Mat HistogramFeature::extractFromContext(ImageContext& context) {
+    return extractFeatures(context.color());
+}
+
+/**
+ * Extract a batch of images
+ * 
+ * With the device path on, the raw counts of the whole batch come from
+ * GpuHistogram and are normalized here exactly as in extractFeatures().
+ * 
+ * @param images Decoded images
+ * @param out Output rows, images.size() × getFeatureDimension() CV_32F
+ * @param valid Optional per-image success flags
+ * @return int Number of images extracted
+ */
+int HistogramFeature::extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                                   std::vector<uchar>* valid) {
+    if (!useGpu_) {
+        return FeatureExtractor::extractBatch(images, out, valid);
+    }
+    
+    std::vector<cv::Mat> colorImages;
+    std::vector<int> positions;
+    GpuHistogram::collectColorImages(*this, images, colorImages, positions);
+    cv::Mat counts;
+    if (colorImages.empty() || !GpuHistogram::count(colorImages, gpuLayout(), {}, counts)) {
+        return FeatureExtractor::extractBatch(images, out, valid);
+    }
+    
+    out.create(static_cast<int>(images.size()), getFeatureDimension(), CV_32F);
+    out.setTo(cv::Scalar::all(0));
+    if (valid != nullptr) {
+        valid->assign(images.size(), 0);
+    }
+    for (size_t k = 0; k < positions.size(); k++) {
+        cv::Mat histogram = counts.row(static_cast<int>(k)).clone();
+        if (normalize_) {
+            histogram = normalizeHistogram(histogram);
+        }
+        histogram.copyTo(out.row(positions[k]));
+        if (valid != nullptr) {
+            (*valid)[positions[k]] = 1;
+        }
+    }
+    return static_cast<int>(positions.size());
+}
+
+/**
+ * Enable or disable device counting
+ */
+bool HistogramFeature::setUseGpu(bool enabled) {
+    useGpu_ = enabled && GpuHistogram::supports(gpuLayout());
+    return useGpu_;
+}
+
+/**
+ * Device counting layout: no texture bins, one region
+ */
+GpuHistogram::Layout HistogramFeature::gpuLayout() const {
+    GpuHistogram::Layout layout;
+    layout.colorBins = binsPerChannel_;
+    layout.chromaticity = (type_ == HistogramType::RG_CHROMATICITY);
+    return layout;
 }
 
 /**
@@ -114,6 +196,27 @@ int HistogramFeature::getFeatureDimension() const {
     }
 }
 
+/**
+ * Largest decode reduction allowed
+ * 
+ * Normalized histograms are distributions over colour, so decoding at
+ * 1/4 resolution changes them only slightly. Raw counts scale with the
+ * pixel count and need the full image.
+ */
+int HistogramFeature::getMaxDecodeReduction() const {
+    return normalize_ ? 4 : 1;
+}
+
+/**
+ * Smallest longest side allowed
+ * 
+ * At 128 pixels a normalized histogram still averages over more than ten
+ * thousand pixels; raw counts must keep the original size.
+ */
+int HistogramFeature::getMinImageSide() const {
+    return normalize_ ? 128 : 0;
+}
+
 /**
  * Set histogram type
  */
@@ -266,6 +369,52 @@ cv::Mat HistogramFeature::computeRGChromaticityHistogram(const cv::Mat& image) {
     return histogram;
 }
 
+/**
+ * Flattened bin index of every pixel
+ * 
+ * RGB:           index = binR × bins² + binG × bins + binB
+ * Chromaticity:  index = binR × bins + binG
+ * 
+ * Same arithmetic as computeRGBHistogram() / computeRGChromaticityHistogram()
+ * followed by flattenHistogram(); 8, 16 and 32 bins use HistogramKernels.
+ * 
+ * @param colorImage Color image (BGR format)
+ * @param indices Output bin indices, row-major
+ */
+void HistogramFeature::computeBinIndices(const cv::Mat& colorImage,
+                                         std::vector<int>& indices) const {
+    indices.resize(static_cast<size_t>(colorImage.rows) * colorImage.cols);
+    if (HistogramKernels::binIndices(colorImage, binsPerChannel_,
+                                     type_ == HistogramType::RG_CHROMATICITY, indices.data())) {
+        return;
+    }
+    
+    const int bins = binsPerChannel_;
+    const float binSize = 256.0f / bins;
+    
+    size_t idx = 0;
+    for (int row = 0; row < colorImage.rows; row++) {
+        const cv::Vec3b* pixels = colorImage.ptr<cv::Vec3b>(row);
+        for (int col = 0; col < colorImage.cols; col++) {
+            const cv::Vec3b& pixel = pixels[col];
+            if (type_ == HistogramType::RGB) {
+                int binB = std::min(static_cast<int>(pixel[0] / binSize), bins - 1);
+                int binG = std::min(static_cast<int>(pixel[1] / binSize), bins - 1);
+                int binR = std::min(static_cast<int>(pixel[2] / binSize), bins - 1);
+                indices[idx++] = (binR * bins + binG) * bins + binB;
+            } else {
+                float b = static_cast<float>(pixel[0]);
+                float g = static_cast<float>(pixel[1]);
+                float r = static_cast<float>(pixel[2]);
+                float sum = std::max(r + g + b, 1.0f);
+                int binR = std::min(static_cast<int>((r / sum) * bins), bins - 1);
+                int binG = std::min(static_cast<int>((g / sum) * bins), bins - 1);
+                indices[idx++] = binR * bins + binG;
+            }
+        }
+    }
+}
+
 /**
  * Flatten multi-dimensional histogram to 1D vector
  * 
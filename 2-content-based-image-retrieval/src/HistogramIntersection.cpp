@@ -20,8 +20,11 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "HistogramIntersection.h"
+#include "DistanceKernels.h"
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace cbir {
 
@@ -86,6 +89,147 @@ double HistogramIntersection::compute(const cv::Mat& features1,
     return distance;
 }
 
+/**
+ * Batched histogram intersection distance
+ * 
+ * One vectorised pass per row yields both Σ min(Q[i], H[i]) and Σ H[i].
+ * Rows that turn out not to be normalized get a second pass with H scaled
+ * by 1 / Σ H, which is exactly what compute() does via normalizeIfNeeded().
+ * Quantised rows follow the same rule with H = scale × codes, so rounding
+ * that moves Σ H by 1% or more is normalized away as well.
+ * 
+ * @param query Query histogram
+ * @param matrix Database histograms, one per row
+ * @param out Output distances, matrix.rows x 1 CV_64F
+ * @return True if successful
+ */
+bool HistogramIntersection::computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                                         cv::Mat& out) {
+    if (query.empty()) {
+        std::cerr << "Error: Empty query histogram" << std::endl;
+        return false;
+    }
+    cv::Mat queryHist = normalizeIfNeeded(query);
+
+    return runBatch(queryHist, matrix, out,
+                    [](const float* queryData, const float* rowData, int length) {
+        float rowSum = 0.0f;
+        float intersection = DistanceKernels::intersection(queryData, rowData, length,
+                                                           1.0f, &rowSum);
+        if (std::abs(rowSum - 1.0f) >= 0.01f && rowSum >= 1e-10f) {
+            intersection = DistanceKernels::intersection(queryData, rowData, length,
+                                                         1.0f / rowSum, nullptr);
+        }
+        return 1.0 - intersection;
+    },
+                    [](const float* queryData, const uint8_t* codes, float scale, int length) {
+        float codeSum = 0.0f;
+        float intersection = DistanceKernels::intersectionQuantized(queryData, codes, length,
+                                                                    scale, &codeSum);
+        float rowSum = scale * codeSum;
+        if (std::abs(rowSum - 1.0f) >= 0.01f && rowSum >= 1e-10f) {
+            intersection = DistanceKernels::intersectionQuantized(queryData, codes, length,
+                                                                  1.0f / codeSum, nullptr);
+        }
+        return 1.0 - intersection;
+    });
+}
+
+/**
+ * Block intersection distance with the four-query min-sum kernel
+ * 
+ * Rows whose sum is off by more than compute()'s tolerance are scored
+ * again with scale 1 / Σ row, as in computeBatch().
+ * 
+ * @param queries Query histograms, one per row (CV_32F)
+ * @param matrix Feature matrix, one histogram per row
+ * @param out Output distances, queries.rows x matrix.rows CV_64F
+ * @return True if successful
+ */
+bool HistogramIntersection::computeBlock(const cv::Mat& queries, const cv::Mat& matrix,
+                                         cv::Mat& out) {
+    if (!checkBlock(queries, matrix)) {
+        return false;
+    }
+
+    cv::Mat normalized(queries.rows, queries.cols, CV_32F);
+    for (int q = 0; q < queries.rows; q++) {
+        cv::Mat target = normalized.row(q);
+        normalizeIfNeeded(queries.row(q)).copyTo(target);
+    }
+
+    cv::Mat staging;
+    const cv::Mat rows = floatRows(matrix, staging);
+    const int length = rows.cols;
+    out.create(queries.rows, rows.rows, CV_64F);
+
+    for (int first = 0; first < queries.rows; first += 4) {
+        const int count = std::min(4, queries.rows - first);
+        const float* group[4];
+        for (int k = 0; k < 4; k++) {
+            group[k] = normalized.ptr<float>(first + std::min(k, count - 1));
+        }
+
+        for (int row = 0; row < rows.rows; row++) {
+            const float* rowData = rows.ptr<float>(row);
+            float intersections[4];
+            float rowSum = 0.0f;
+            DistanceKernels::intersection4(group, rowData, length, 1.0f, intersections, &rowSum);
+            if (std::abs(rowSum - 1.0f) >= 0.01f && rowSum >= 1e-10f) {
+                DistanceKernels::intersection4(group, rowData, length, 1.0f / rowSum,
+                                               intersections, nullptr);
+            }
+            for (int k = 0; k < count; k++) {
+                out.at<double>(first + k, row) = 1.0 - intersections[k];
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Intersection distance with early abandoning for top-K scans
+ * 
+ * The query sum is one short vectorised pass over data already in cache;
+ * it decides whether the query can be used as-is and feeds the bound.
+ * An all-zero query stays unnormalized, as in computeBatch().
+ * 
+ * @param features1 Query histogram
+ * @param features2 Database histogram
+ * @param cutoff Largest distance of interest
+ * @return Distance, or infinity once it provably exceeds cutoff
+ */
+double HistogramIntersection::computeWithCutoff(const cv::Mat& features1,
+                                                const cv::Mat& features2, double cutoff) {
+    if (!areFloatArrays(features1, features2)) {
+        return compute(features1, features2);
+    }
+
+    const float* query = features1.ptr<float>();
+    const float* row = features2.ptr<float>();
+    const int length = static_cast<int>(features1.total());
+    float querySum = DistanceKernels::sum(query, length);
+    cv::Mat normalized;
+    if (std::abs(querySum - 1.0f) >= 0.01f) {
+        // Same query normalization as computeBatch(); rare, so not cached
+        normalized = normalizeIfNeeded(features1);
+        query = normalized.ptr<float>();
+        querySum = DistanceKernels::sum(query, length);
+    }
+
+    float intersection = 0.0f;
+    float rowSum = 0.0f;
+    const float limit = static_cast<float>(std::min(cutoff, 2.0));
+    if (!DistanceKernels::intersectionBounded(query, row, length, querySum, limit,
+                                              &intersection, &rowSum)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (std::abs(rowSum - 1.0f) >= 0.01f && rowSum >= 1e-10f) {
+        intersection = DistanceKernels::intersection(query, row, length, 1.0f / rowSum, nullptr);
+    }
+    return 1.0 - intersection;
+}
+
 /**
  * Get metric name
  * 
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////
+// HistogramKernels.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the specialised histogram kernels. Each
+//              bin count is a template parameter, so the binning of a row
+//              compiles to shifts (RGB) or constant multiplies (chromaticity)
+//              with no clamps or loop-carried state; the scatter into the
+//              histogram is a separate, unrolled pass.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "HistogramKernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace cbir {
+
+namespace {
+
+/// Images below this many pixels per stripe are counted on one thread
+const int64_t MIN_STRIPE_PIXELS = 1 << 18;
+
+/// Interleaved sub-histograms per stripe; consecutive pixels of one colour
+/// then increment different counters instead of waiting on each other
+constexpr int INTERLEAVE = 4;
+
+/// Larger histograms keep a single copy per stripe so it stays in cache
+constexpr int MAX_INTERLEAVED_BINS = 4096;
+
+constexpr int log2Of(int value) {
+    return value <= 1 ? 0 : 1 + log2Of(value / 2);
+}
+
+/**
+ * RGB binning: v >> SHIFT equals the generic v / (256 / BINS) for
+ * power-of-two BINS and never exceeds BINS - 1, so no clamp is needed
+ */
+template <int BINS>
+struct RgbBinner {
+    static constexpr int SHIFT = 8 - log2Of(BINS);
+    static constexpr int TOTAL = BINS * BINS * BINS;
+
+    static void row(const uchar* pixels, int count, int* out) {
+        for (int i = 0; i < count; i++) {
+            const int b = pixels[3 * i] >> SHIFT;
+            const int g = pixels[3 * i + 1] >> SHIFT;
+            const int r = pixels[3 * i + 2] >> SHIFT;
+            out[i] = (r * BINS + g) * BINS + b;
+        }
+    }
+};
+
+/**
+ * RG chromaticity binning: the generic float expression with BINS constant
+ */
+template <int BINS>
+struct ChromaticityBinner {
+    static constexpr int TOTAL = BINS * BINS;
+
+    static void row(const uchar* pixels, int count, int* out) {
+        for (int i = 0; i < count; i++) {
+            const float b = static_cast<float>(pixels[3 * i]);
+            const float g = static_cast<float>(pixels[3 * i + 1]);
+            const float r = static_cast<float>(pixels[3 * i + 2]);
+            const float sum = std::max(r + g + b, 1.0f);
+            const int binR = std::min(static_cast<int>((r / sum) * BINS), BINS - 1);
+            const int binG = std::min(static_cast<int>((g / sum) * BINS), BINS - 1);
+            out[i] = binR * BINS + binG;
+        }
+    }
+};
+
+/**
+ * Add the counts of rows [rowBegin, rowEnd) to counts (Binner::TOTAL entries)
+ */
+template <class Binner>
+void countRows(const cv::Mat& image, int rowBegin, int rowEnd, uint32_t* counts) {
+    constexpr int TOTAL = Binner::TOTAL;
+    constexpr int COPIES = TOTAL <= MAX_INTERLEAVED_BINS ? INTERLEAVE : 1;
+
+    std::vector<uint32_t> interleaved(COPIES > 1 ? COPIES * TOTAL : 0, 0);
+    uint32_t* sub = COPIES > 1 ? interleaved.data() : counts;
+    std::vector<int> indices(image.cols);
+
+    for (int row = rowBegin; row < rowEnd; row++) {
+        Binner::row(image.ptr<uchar>(row), image.cols, indices.data());
+        int i = 0;
+        for (; i + COPIES <= image.cols; i += COPIES) {
+            for (int k = 0; k < COPIES; k++) {
+                sub[k * TOTAL + indices[i + k]]++;
+            }
+        }
+        for (; i < image.cols; i++) {
+            sub[indices[i]]++;
+        }
+    }
+
+    if (COPIES > 1) {
+        for (int bin = 0; bin < TOTAL; bin++) {
+            uint32_t total = 0;
+            for (int k = 0; k < COPIES; k++) {
+                total += sub[k * TOTAL + bin];
+            }
+            counts[bin] += total;
+        }
+    }
+}
+
+/**
+ * Count the whole image, in parallel stripes when it is large enough
+ *
+ * Counts are exact integers; the generic float accumulation agrees with
+ * them as long as no bin exceeds 2^24 pixels.
+ */
+template <class Binner>
+void countImage(const cv::Mat& image, cv::Mat& counts) {
+    constexpr int TOTAL = Binner::TOTAL;
+    const int64_t pixels = static_cast<int64_t>(image.rows) * image.cols;
+    const int stripes = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>({pixels / MIN_STRIPE_PIXELS, cv::getNumThreads(), image.rows})));
+
+    std::vector<uint32_t> stripeCounts(static_cast<size_t>(stripes) * TOTAL, 0);
+    if (stripes == 1) {
+        countRows<Binner>(image, 0, image.rows, stripeCounts.data());
+    } else {
+        cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+            for (int s = range.start; s < range.end; s++) {
+                countRows<Binner>(image, s * image.rows / stripes, (s + 1) * image.rows / stripes,
+                                  &stripeCounts[static_cast<size_t>(s) * TOTAL]);
+            }
+        });
+    }
+
+    counts.create(1, TOTAL, CV_32F);
+    float* out = counts.ptr<float>(0);
+    for (int bin = 0; bin < TOTAL; bin++) {
+        uint32_t total = 0;
+        for (int s = 0; s < stripes; s++) {
+            total += stripeCounts[static_cast<size_t>(s) * TOTAL + bin];
+        }
+        out[bin] = static_cast<float>(total);
+    }
+}
+
+template <class Binner>
+void indexImage(const cv::Mat& image, int* indices) {
+    for (int row = 0; row < image.rows; row++) {
+        Binner::row(image.ptr<uchar>(row), image.cols,
+                    indices + static_cast<size_t>(row) * image.cols);
+    }
+}
+
+} // namespace
+
+namespace HistogramKernels {
+
+bool isSpecialized(int bins) {
+    return bins == 8 || bins == 16 || bins == 32;
+}
+
+bool countRGB(const cv::Mat& image, int bins, cv::Mat& counts) {
+    if (image.type() != CV_8UC3) {
+        return false;
+    }
+    switch (bins) {
+        case 8:  countImage<RgbBinner<8>>(image, counts);  return true;
+        case 16: countImage<RgbBinner<16>>(image, counts); return true;
+        case 32: countImage<RgbBinner<32>>(image, counts); return true;
+        default: return false;
+    }
+}
+
+bool countChromaticity(const cv::Mat& image, int bins, cv::Mat& counts) {
+    if (image.type() != CV_8UC3) {
+        return false;
+    }
+    switch (bins) {
+        case 8:  countImage<ChromaticityBinner<8>>(image, counts);  return true;
+        case 16: countImage<ChromaticityBinner<16>>(image, counts); return true;
+        case 32: countImage<ChromaticityBinner<32>>(image, counts); return true;
+        default: return false;
+    }
+}
+
+bool binIndices(const cv::Mat& image, int bins, bool chromaticity, int* indices) {
+    if (image.type() != CV_8UC3 || !isSpecialized(bins)) {
+        return false;
+    }
+    if (chromaticity) {
+        switch (bins) {
+            case 8:  indexImage<ChromaticityBinner<8>>(image, indices);  break;
+            case 16: indexImage<ChromaticityBinner<16>>(image, indices); break;
+            default: indexImage<ChromaticityBinner<32>>(image, indices); break;
+        }
+    } else {
+        switch (bins) {
+            case 8:  indexImage<RgbBinner<8>>(image, indices);  break;
+            case 16: indexImage<RgbBinner<16>>(image, indices); break;
+            default: indexImage<RgbBinner<32>>(image, indices); break;
+        }
+    }
+    return true;
+}
+
+} // namespace HistogramKernels
+
+} // namespace cbir
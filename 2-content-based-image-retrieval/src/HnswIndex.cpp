@@ -0,0 +1,688 @@
+////////////////////////////////////////////////////////////////////////////////
+// HnswIndex.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the HNSW graph index: parallel construction
+//              with striped locks, layered greedy / beam search and a compact
+//              binary file format for the graph.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "HnswIndex.h"
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+
+namespace cbir {
+
+namespace {
+
+const char HNSW_MAGIC[8] = {'C', 'B', 'I', 'R', 'H', 'N', 'S', 'W'};
+const uint32_t HNSW_VERSION = 1;
+
+/// Highest layer a node can be assigned
+const int MAX_LEVEL = 16;
+
+/// Neighbour-list lock stripes used during construction
+const size_t LOCK_STRIPES = 4096;
+
+/// Fixed seed: the same database always produces the same graph levels
+const unsigned LEVEL_SEED = 100;
+
+/// On-disk header of a saved graph
+struct HnswHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metric;
+    uint64_t count;
+    uint32_t dimension;
+    uint32_t m;
+    uint32_t maxM0;
+    uint32_t efConstruction;
+    uint32_t efSearch;
+    int32_t maxLevel;
+    uint32_t entryPoint;
+    uint32_t reserved;
+    uint64_t signature;
+    uint64_t upperLinks;
+};
+
+/**
+ * Per-thread visited marks; a generation tag avoids clearing between searches
+ */
+struct VisitedSet {
+    std::vector<uint32_t> marks;
+    uint32_t tag = 0;
+
+    void reset(size_t count) {
+        if (marks.size() < count) {
+            marks.assign(count, 0);
+            tag = 0;
+        }
+        if (++tag == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            tag = 1;
+        }
+    }
+
+    /// True the first time a node is seen since reset()
+    bool visit(uint32_t node) {
+        if (marks[node] == tag) {
+            return false;
+        }
+        marks[node] = tag;
+        return true;
+    }
+};
+
+VisitedSet& visitedSet() {
+    static thread_local VisitedSet set;
+    return set;
+}
+
+} // namespace
+
+/**
+ * Locks used while building: one global lock for the entry point and
+ * striped locks for the neighbour lists
+ */
+struct HnswIndex::BuildLocks {
+    std::mutex global;
+    std::vector<std::mutex> stripes;
+
+    BuildLocks() : stripes(LOCK_STRIPES) {}
+
+    std::mutex& forNode(uint32_t node) { return stripes[node % LOCK_STRIPES]; }
+};
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+HnswIndex::HnswIndex(AnnMetric metric, int m, int efConstruction, int efSearch)
+    : AnnIndex(metric), m_(std::max(2, m)), maxM0_(2 * std::max(2, m)),
+      efConstruction_(std::max(efConstruction, m)), efSearch_(std::max(1, efSearch)),
+      maxLevel_(0), entryPoint_(0), vectors_(nullptr) {
+}
+
+/**
+ * @brief Build the graph over every database row
+ *
+ * Levels are drawn up front from a seeded generator so link storage can be
+ * allocated once; the first node is the initial entry point and all other
+ * nodes are inserted in parallel.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HnswIndex::build(const FeatureDatabase& database) {
+    if (database.empty()) {
+        std::cerr << "Error: Cannot build HNSW index over an empty database" << std::endl;
+        return false;
+    }
+    if (database.size() >= 0xFFFFFFFFULL) {
+        std::cerr << "Error: HNSW index supports at most 2^32 - 1 rows" << std::endl;
+        return false;
+    }
+
+    count_ = database.size();
+    dimension_ = database.dimension();
+    if (!bindDatabase(database)) {
+        count_ = 0;
+        return false;
+    }
+    signature_ = databaseSignature(database);
+
+    std::cout << "Building HNSW index (M=" << m_ << ", efConstruction="
+              << efConstruction_ << ") over " << count_ << " vectors..." << std::endl;
+    int64 startTicks = cv::getTickCount();
+
+    // Level i is taken with probability e^(-i / mult)
+    std::mt19937 generator(LEVEL_SEED);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double levelMult = 1.0 / std::log(static_cast<double>(m_));
+    levels_.resize(count_);
+    for (size_t i = 0; i < count_; i++) {
+        double level = -std::log(1.0 - uniform(generator)) * levelMult;
+        levels_[i] = static_cast<uint8_t>(std::min(MAX_LEVEL, static_cast<int>(level)));
+    }
+    allocateLinks();
+
+    entryPoint_ = 0;
+    maxLevel_ = levels_[0];
+
+    BuildLocks locks;
+    std::atomic<size_t> inserted(1);
+    const size_t reportEvery = std::max<size_t>(count_ / 10, 10000);
+
+    cv::parallel_for_(cv::Range(1, static_cast<int>(count_)), [&](const cv::Range& range) {
+        for (int node = range.start; node < range.end; node++) {
+            insert(static_cast<uint32_t>(node), locks);
+            size_t done = ++inserted;
+            if (done % reportEvery == 0) {
+                std::cout << "  Indexed " << done << "/" << count_ << " vectors..." << std::endl;
+            }
+        }
+    });
+
+    double seconds = (cv::getTickCount() - startTicks) / cv::getTickFrequency();
+    std::cout << "HNSW index built in " << seconds << " s (" << maxLevel_ + 1
+              << " layers, " << memoryBytes() / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Attach a loaded graph to its database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HnswIndex::attach(const FeatureDatabase& database) {
+    if (levels_.empty()) {
+        std::cerr << "Error: HNSW index is not loaded" << std::endl;
+        return false;
+    }
+    if (database.size() != count_ || database.dimension() != dimension_ ||
+        databaseSignature(database) != signature_) {
+        std::cerr << "Error: HNSW index does not match the feature database (stale index)"
+                  << std::endl;
+        return false;
+    }
+    return bindDatabase(database);
+}
+
+/**
+ * @brief k approximate nearest rows
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HnswIndex::search(const cv::Mat& query, int k, std::vector<AnnResult>& results) const {
+    results.clear();
+    if (!isReady()) {
+        std::cerr << "Error: HNSW index is not attached to a database" << std::endl;
+        return false;
+    }
+    if (k <= 0) {
+        return true;
+    }
+
+    std::vector<float> queryData;
+    if (!prepareQuery(query, queryData)) {
+        return false;
+    }
+    const float* q = queryData.data();
+    const double queryNorm = metric_ == AnnMetric::Cosine ? vectorNorm(q, dimension_) : 0.0;
+
+    // Greedy descent through the upper layers
+    uint32_t entry = entryPoint_;
+    float entryDistance = distanceTo(q, queryNorm, entry);
+    for (int level = maxLevel_; level > 0; level--) {
+        greedyStep(q, queryNorm, level, entry, entryDistance, nullptr);
+    }
+
+    // Beam search on the bottom layer
+    std::vector<Candidate> nearest = searchLayer(q, queryNorm, entry, entryDistance,
+                                                 std::max(efSearch_, k), 0, nullptr);
+
+    size_t keep = std::min(nearest.size(), static_cast<size_t>(k));
+    results.reserve(keep);
+    for (size_t i = 0; i < keep; i++) {
+        results.emplace_back(static_cast<double>(nearest[i].first),
+                             static_cast<int>(nearest[i].second));
+    }
+    return true;
+}
+
+/**
+ * @brief Save the graph
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HnswIndex::save(const std::string& filename) const {
+    if (levels_.empty()) {
+        std::cerr << "Error: No HNSW index to save" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << filename << std::endl;
+        return false;
+    }
+
+    HnswHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, HNSW_MAGIC, sizeof(HNSW_MAGIC));
+    header.version = HNSW_VERSION;
+    header.metric = static_cast<uint32_t>(metric_);
+    header.count = count_;
+    header.dimension = static_cast<uint32_t>(dimension_);
+    header.m = static_cast<uint32_t>(m_);
+    header.maxM0 = static_cast<uint32_t>(maxM0_);
+    header.efConstruction = static_cast<uint32_t>(efConstruction_);
+    header.efSearch = static_cast<uint32_t>(efSearch_);
+    header.maxLevel = maxLevel_;
+    header.entryPoint = entryPoint_;
+    header.signature = signature_;
+    header.upperLinks = upperLinks_.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levels_.data()),
+               static_cast<std::streamsize>(levels_.size()));
+    file.write(reinterpret_cast<const char*>(level0_.data()),
+               static_cast<std::streamsize>(level0_.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(upperLinks_.data()),
+               static_cast<std::streamsize>(upperLinks_.size() * sizeof(uint32_t)));
+
+    if (!file.good()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Saved HNSW index to: " << filename << std::endl;
+    return true;
+}
+
+/**
+ * @brief Load a saved graph and validate every link
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HnswIndex::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    HnswHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() || std::memcmp(header.magic, HNSW_MAGIC, sizeof(HNSW_MAGIC)) != 0 ||
+        header.version != HNSW_VERSION) {
+        std::cerr << "Error: " << filename << " is not a version " << HNSW_VERSION
+                  << " HNSW index" << std::endl;
+        return false;
+    }
+    if (header.metric != static_cast<uint32_t>(metric_)) {
+        std::cerr << "Error: " << filename << " was built for a different metric" << std::endl;
+        return false;
+    }
+    if (header.count == 0 || header.count >= 0xFFFFFFFFULL || header.m < 2 ||
+        header.maxM0 < header.m || header.entryPoint >= header.count ||
+        header.maxLevel < 0 || header.maxLevel > MAX_LEVEL) {
+        std::cerr << "Error: " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    count_ = static_cast<size_t>(header.count);
+    dimension_ = static_cast<int>(header.dimension);
+    m_ = static_cast<int>(header.m);
+    maxM0_ = static_cast<int>(header.maxM0);
+    efConstruction_ = static_cast<int>(header.efConstruction);
+    efSearch_ = std::max(1, static_cast<int>(header.efSearch));
+    maxLevel_ = header.maxLevel;
+    entryPoint_ = header.entryPoint;
+    signature_ = header.signature;
+    database_ = nullptr;
+    vectors_ = nullptr;
+    norms_.clear();
+
+    levels_.resize(count_);
+    file.read(reinterpret_cast<char*>(levels_.data()), static_cast<std::streamsize>(count_));
+    bool valid = file.good();
+    for (size_t i = 0; valid && i < count_; i++) {
+        valid = levels_[i] <= maxLevel_;
+    }
+    if (valid) {
+        allocateLinks();
+        valid = upperLinks_.size() == header.upperLinks;
+    }
+    if (valid) {
+        file.read(reinterpret_cast<char*>(level0_.data()),
+                  static_cast<std::streamsize>(level0_.size() * sizeof(uint32_t)));
+        file.read(reinterpret_cast<char*>(upperLinks_.data()),
+                  static_cast<std::streamsize>(upperLinks_.size() * sizeof(uint32_t)));
+        valid = file.good();
+    }
+
+    // Every list must fit its layer and reference existing nodes on that layer
+    for (size_t node = 0; valid && node < count_; node++) {
+        for (int level = 0; valid && level <= levels_[node]; level++) {
+            const uint32_t* list = links(static_cast<uint32_t>(node), level);
+            uint32_t maxCount = static_cast<uint32_t>(level == 0 ? maxM0_ : m_);
+            valid = list[0] <= maxCount;
+            for (uint32_t i = 1; valid && i <= list[0]; i++) {
+                valid = list[i] < count_ && levels_[list[i]] >= level;
+            }
+        }
+    }
+
+    if (!valid) {
+        std::cerr << "Error: " << filename << " is truncated or corrupt" << std::endl;
+        count_ = 0;
+        levels_.clear();
+        level0_.clear();
+        upperOffsets_.clear();
+        upperLinks_.clear();
+        return false;
+    }
+
+    std::cout << "Loaded HNSW index from: " << filename << " (" << count_
+              << " vectors)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Index name
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string HnswIndex::getIndexName() const {
+    return "HNSW";
+}
+
+/**
+ * @brief Graph memory
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t HnswIndex::memoryBytes() const {
+    return levels_.size() + level0_.size() * sizeof(uint32_t) +
+           upperOffsets_.size() * sizeof(uint64_t) + upperLinks_.size() * sizeof(uint32_t) +
+           norms_.size() * sizeof(float);
+}
+
+/**
+ * @brief Neighbour list storage
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint32_t* HnswIndex::links(uint32_t node, int level) {
+    if (level == 0) {
+        return &level0_[static_cast<size_t>(node) * (maxM0_ + 1)];
+    }
+    return &upperLinks_[upperOffsets_[node] + static_cast<size_t>(level - 1) * (m_ + 1)];
+}
+
+const uint32_t* HnswIndex::links(uint32_t node, int level) const {
+    return const_cast<HnswIndex*>(this)->links(node, level);
+}
+
+/**
+ * @brief Snapshot of a neighbour list
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HnswIndex::copyLinks(uint32_t node, int level, std::vector<uint32_t>& out,
+                          BuildLocks* locks) const {
+    std::unique_lock<std::mutex> lock;
+    if (locks != nullptr) {
+        lock = std::unique_lock<std::mutex>(locks->forNode(node));
+    }
+    const uint32_t* list = links(node, level);
+    out.assign(list + 1, list + 1 + list[0]);
+}
+
+/**
+ * @brief Query-to-node distance
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float HnswIndex::distanceTo(const float* query, double queryNorm, uint32_t node) const {
+    const float* vector = vectors_ + static_cast<size_t>(node) * dimension_;
+    double norm = norms_.empty() ? 0.0 : norms_[node];
+    return static_cast<float>(exactDistance(query, queryNorm, vector, norm));
+}
+
+/**
+ * @brief Node-to-node distance
+ *
+ * @author Krushna Sanjay Sharma
+ */
+float HnswIndex::nodeDistance(uint32_t a, uint32_t b) const {
+    double normA = norms_.empty() ? 0.0 : norms_[a];
+    return distanceTo(vectors_ + static_cast<size_t>(a) * dimension_, normA, b);
+}
+
+/**
+ * @brief Move to the closest neighbour until no neighbour is closer
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HnswIndex::greedyStep(const float* query, double queryNorm, int level,
+                           uint32_t& node, float& distance, BuildLocks* locks) const {
+    std::vector<uint32_t> neighbors;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        copyLinks(node, level, neighbors, locks);
+        for (uint32_t neighbor : neighbors) {
+            float d = distanceTo(query, queryNorm, neighbor);
+            if (d < distance) {
+                distance = d;
+                node = neighbor;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Beam search of width ef on one layer
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::vector<HnswIndex::Candidate> HnswIndex::searchLayer(const float* query, double queryNorm,
+                                                         uint32_t entry, float entryDistance,
+                                                         int ef, int level,
+                                                         BuildLocks* locks) const {
+    VisitedSet& visited = visitedSet();
+    visited.reset(count_);
+
+    const size_t width = static_cast<size_t>(std::max(1, ef));
+    std::priority_queue<Candidate> best;   // worst of the current best on top
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier;
+
+    visited.visit(entry);
+    best.emplace(entryDistance, entry);
+    frontier.emplace(entryDistance, entry);
+
+    std::vector<uint32_t> neighbors;
+    while (!frontier.empty()) {
+        Candidate current = frontier.top();
+        if (current.first > best.top().first && best.size() >= width) {
+            break;
+        }
+        frontier.pop();
+
+        copyLinks(current.second, level, neighbors, locks);
+        for (uint32_t neighbor : neighbors) {
+            if (!visited.visit(neighbor)) {
+                continue;
+            }
+            float d = distanceTo(query, queryNorm, neighbor);
+            if (best.size() < width || d < best.top().first) {
+                frontier.emplace(d, neighbor);
+                best.emplace(d, neighbor);
+                if (best.size() > width) {
+                    best.pop();
+                }
+            }
+        }
+    }
+
+    std::vector<Candidate> ascending(best.size());
+    for (size_t i = ascending.size(); i > 0; i--) {
+        ascending[i - 1] = best.top();
+        best.pop();
+    }
+    return ascending;
+}
+
+/**
+ * @brief Neighbour selection heuristic (HNSW paper, algorithm 4)
+ *
+ * A candidate is kept only if it is closer to the base node than to every
+ * neighbour kept so far, which spreads links over different directions.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::vector<HnswIndex::Candidate> HnswIndex::selectNeighbors(
+        const std::vector<Candidate>& ascending, int maxCount) const {
+    if (ascending.size() <= static_cast<size_t>(maxCount)) {
+        return ascending;
+    }
+
+    std::vector<Candidate> selected;
+    selected.reserve(maxCount);
+    for (const Candidate& candidate : ascending) {
+        if (selected.size() >= static_cast<size_t>(maxCount)) {
+            break;
+        }
+        bool diverse = true;
+        for (const Candidate& kept : selected) {
+            if (nodeDistance(candidate.second, kept.second) < candidate.first) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) {
+            selected.push_back(candidate);
+        }
+    }
+    return selected;
+}
+
+/**
+ * @brief Insert one node into every layer up to its level
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HnswIndex::insert(uint32_t node, BuildLocks& locks) {
+    const int level = levels_[node];
+    const float* query = vectors_ + static_cast<size_t>(node) * dimension_;
+    const double queryNorm = norms_.empty() ? 0.0 : norms_[node];
+
+    // A node that raises the top layer holds the global lock until it is
+    // the new entry point
+    std::unique_lock<std::mutex> globalLock(locks.global);
+    const int topLevel = maxLevel_;
+    uint32_t entry = entryPoint_;
+    if (level <= topLevel) {
+        globalLock.unlock();
+    }
+
+    float entryDistance = distanceTo(query, queryNorm, entry);
+    for (int l = topLevel; l > level; l--) {
+        greedyStep(query, queryNorm, l, entry, entryDistance, &locks);
+    }
+
+    for (int l = std::min(level, topLevel); l >= 0; l--) {
+        std::vector<Candidate> nearest = searchLayer(query, queryNorm, entry, entryDistance,
+                                                     efConstruction_, l, &locks);
+        std::vector<Candidate> selected = selectNeighbors(nearest, m_);
+
+        {
+            std::lock_guard<std::mutex> lock(locks.forNode(node));
+            uint32_t* list = links(node, l);
+            list[0] = static_cast<uint32_t>(selected.size());
+            for (size_t i = 0; i < selected.size(); i++) {
+                list[i + 1] = selected[i].second;
+            }
+        }
+        for (const Candidate& neighbor : selected) {
+            connect(neighbor.second, node, neighbor.first, l, locks);
+        }
+
+        entry = nearest.front().second;
+        entryDistance = nearest.front().first;
+    }
+
+    if (level > topLevel) {
+        entryPoint_ = node;
+        maxLevel_ = level;
+    }
+}
+
+/**
+ * @brief Link neighbor into node's list on a layer
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HnswIndex::connect(uint32_t node, uint32_t neighbor, float distance, int level,
+                        BuildLocks& locks) {
+    const uint32_t maxCount = static_cast<uint32_t>(level == 0 ? maxM0_ : m_);
+
+    std::lock_guard<std::mutex> lock(locks.forNode(node));
+    uint32_t* list = links(node, level);
+    const uint32_t count = list[0];
+    if (count < maxCount) {
+        list[count + 1] = neighbor;
+        list[0] = count + 1;
+        return;
+    }
+
+    // Full: re-select among the old neighbours plus the new one
+    std::vector<Candidate> candidates;
+    candidates.reserve(count + 1);
+    candidates.emplace_back(distance, neighbor);
+    for (uint32_t i = 1; i <= count; i++) {
+        candidates.emplace_back(nodeDistance(node, list[i]), list[i]);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<Candidate> kept = selectNeighbors(candidates, static_cast<int>(maxCount));
+    list[0] = static_cast<uint32_t>(kept.size());
+    for (size_t i = 0; i < kept.size(); i++) {
+        list[i + 1] = kept[i].second;
+    }
+}
+
+/**
+ * @brief Allocate zeroed neighbour lists for levels_
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HnswIndex::allocateLinks() {
+    level0_.assign(count_ * (maxM0_ + 1), 0);
+    upperOffsets_.resize(count_);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < count_; i++) {
+        upperOffsets_[i] = total;
+        total += static_cast<uint64_t>(levels_[i]) * (m_ + 1);
+    }
+    upperLinks_.assign(static_cast<size_t>(total), 0);
+}
+
+/**
+ * @brief Point at the database matrix and precompute norms
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HnswIndex::bindDatabase(const FeatureDatabase& database) {
+    if (database.storage() != FeatureStorage::Float32) {
+        std::cerr << "Error: HNSW index needs a float32 feature database" << std::endl;
+        return false;
+    }
+
+    cv::Mat matrix = database.matrix();
+    vectors_ = matrix.ptr<float>();
+    database_ = &database;
+
+    norms_.clear();
+    if (metric_ == AnnMetric::Cosine) {
+        norms_.resize(count_);
+        cv::parallel_for_(cv::Range(0, static_cast<int>(count_)), [&](const cv::Range& range) {
+            for (int row = range.start; row < range.end; row++) {
+                norms_[row] = static_cast<float>(
+                    vectorNorm(vectors_ + static_cast<size_t>(row) * dimension_, dimension_));
+            }
+        });
+    }
+    return true;
+}
+
+} // namespace cbir
@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+// HttpClient.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the deadline-bounded HTTP client. The
+//              socket is non-blocking and every wait goes through select()
+//              with the time left until the deadline.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "HttpClient.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <mutex>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace cbir {
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const SocketHandle NO_SOCKET = INVALID_SOCKET;
+void closeSocket(SocketHandle socket) { closesocket(socket); }
+bool setNonBlocking(SocketHandle socket) {
+    u_long enabled = 1;
+    return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+}
+bool connectPending() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+void startSockets() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+    });
+}
+#else
+using SocketHandle = int;
+const SocketHandle NO_SOCKET = -1;
+void closeSocket(SocketHandle socket) { close(socket); }
+bool setNonBlocking(SocketHandle socket) {
+    const int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+bool connectPending() { return errno == EINPROGRESS; }
+bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+void startSockets() {}
+#endif
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;   // EPIPE instead of SIGPIPE on Linux
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+/// Largest response accepted (top-K lists for a full batch fit easily)
+const size_t MAX_RESPONSE_BYTES = size_t(64) << 20;
+
+/// Closes the socket on every return path
+struct SocketGuard {
+    SocketHandle socket;
+    ~SocketGuard() {
+        if (socket != NO_SOCKET) {
+            closeSocket(socket);
+        }
+    }
+};
+
+/**
+ * Wait until the socket is readable or writable, or the deadline passes
+ *
+ * @return int 1 ready, 0 timed out, -1 error
+ */
+int waitFor(SocketHandle socket, bool forWrite, int64 deadline) {
+    while (true) {
+        const double leftMs = 1000.0 * (deadline - cv::getTickCount()) / cv::getTickFrequency();
+        if (leftMs <= 0.0) {
+            return 0;
+        }
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(socket, &set);
+        timeval timeout;
+        timeout.tv_sec = static_cast<long>(leftMs / 1000.0);
+        timeout.tv_usec = static_cast<long>(std::fmod(leftMs, 1000.0) * 1000.0);
+        const int ready = select(static_cast<int>(socket) + 1, forWrite ? nullptr : &set,
+                                 forWrite ? &set : nullptr, nullptr, &timeout);
+        if (ready > 0) {
+            return 1;
+        }
+        if (ready < 0 && !wouldBlock()) {
+            return -1;
+        }
+    }
+}
+
+bool fail(std::string* error, const std::string& reason) {
+    if (error != nullptr) {
+        *error = reason;
+    }
+    return false;
+}
+
+/**
+ * IPv4 address of a dotted address or host name (first A record)
+ */
+bool resolve(const std::string& host, in_addr& address) {
+    if (inet_pton(AF_INET, host.c_str(), &address) == 1) {
+        return true;
+    }
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || found == nullptr) {
+        return false;
+    }
+    address = reinterpret_cast<sockaddr_in*>(found->ai_addr)->sin_addr;
+    freeaddrinfo(found);
+    return true;
+}
+
+} // namespace
+
+bool HttpEndpoint::parse(const std::string& text, HttpEndpoint& endpoint) {
+    const size_t colon = text.rfind(':');
+    const std::string portText = colon == std::string::npos ? text : text.substr(colon + 1);
+    char* end = nullptr;
+    const long port = std::strtol(portText.c_str(), &end, 10);
+    if (portText.empty() || *end != '\0' || port <= 0 || port > 65535) {
+        return false;
+    }
+    endpoint.host = colon == std::string::npos || colon == 0 ? "127.0.0.1"
+                                                             : text.substr(0, colon);
+    endpoint.port = static_cast<int>(port);
+    return true;
+}
+
+/**
+ * @brief Connect, send the request and read the response before the deadline
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HttpClient::request(const HttpEndpoint& endpoint, const std::string& method,
+                         const std::string& path, const std::string& body, int timeoutMs,
+                         HttpResponse& response, std::string* error) {
+    HttpHeaders headers;
+    if (!body.empty()) {
+        headers.emplace_back("Content-Type", "application/json");
+    }
+    return request(endpoint, method, path, headers, body, timeoutMs, response, error);
+}
+
+/**
+ * @brief Same exchange with the caller's header fields
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HttpClient::request(const HttpEndpoint& endpoint, const std::string& method,
+                         const std::string& path, const HttpHeaders& headers,
+                         const std::string& body, int timeoutMs, HttpResponse& response,
+                         std::string* error, std::string* responseHeaders) {
+    startSockets();
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(endpoint.port));
+    if (!resolve(endpoint.host, address.sin_addr)) {
+        return fail(error, "cannot resolve " + endpoint.host);
+    }
+
+    const int64 deadline = cv::getTickCount() +
+        static_cast<int64>(std::max(1, timeoutMs) * cv::getTickFrequency() / 1000.0);
+
+    SocketGuard guard{socket(AF_INET, SOCK_STREAM, 0)};
+    if (guard.socket == NO_SOCKET || !setNonBlocking(guard.socket)) {
+        return fail(error, "cannot create socket");
+    }
+
+    // Connect
+    if (connect(guard.socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        if (!connectPending()) {
+            return fail(error, "connection refused");
+        }
+        const int ready = waitFor(guard.socket, true, deadline);
+        if (ready == 0) {
+            return fail(error, "timeout");
+        }
+        int socketError = 0;
+        socklen_t length = sizeof(socketError);
+        getsockopt(guard.socket, SOL_SOCKET, SO_ERROR,
+                   reinterpret_cast<char*>(&socketError), &length);
+        if (ready < 0 || socketError != 0) {
+            return fail(error, "connection refused");
+        }
+    }
+
+    // Send
+    std::string data = method + " " + path + " HTTP/1.1\r\n";
+    bool hostGiven = false;
+    for (const auto& field : headers) {
+        hostGiven = hostGiven || Utils::toLower(field.first) == "host";
+        data += field.first + ": " + field.second + "\r\n";
+    }
+    if (!hostGiven) {
+        data += "Host: " + endpoint.toString() + "\r\n";
+    }
+    data += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    data += "Connection: close\r\n\r\n";
+    data += body;
+
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const int written = send(guard.socket, data.data() + sent,
+                                 static_cast<int>(data.size() - sent), SEND_FLAGS);
+        if (written > 0) {
+            sent += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && wouldBlock()) {
+            const int ready = waitFor(guard.socket, true, deadline);
+            if (ready <= 0) {
+                return fail(error, ready == 0 ? "timeout" : "send failed");
+            }
+            continue;
+        }
+        return fail(error, "send failed");
+    }
+
+    // Receive until close or Content-Length
+    std::string received;
+    char buffer[16384];
+    size_t headerEnd = std::string::npos;
+    size_t expected = std::string::npos;
+    while (expected == std::string::npos || received.size() < expected) {
+        const int count = recv(guard.socket, buffer, sizeof(buffer), 0);
+        if (count > 0) {
+            received.append(buffer, static_cast<size_t>(count));
+            if (received.size() > MAX_RESPONSE_BYTES) {
+                return fail(error, "response too large");
+            }
+            if (headerEnd == std::string::npos) {
+                headerEnd = received.find("\r\n\r\n");
+                if (headerEnd != std::string::npos) {
+                    const std::string headers = Utils::toLower(received.substr(0, headerEnd));
+                    const size_t field = headers.find("\r\ncontent-length:");
+                    if (field != std::string::npos) {
+                        expected = headerEnd + 4 +
+                            std::strtoull(headers.c_str() + field + 17, nullptr, 10);
+                    }
+                }
+            }
+            continue;
+        }
+        if (count == 0) {
+            break;   // server closed the connection
+        }
+        if (!wouldBlock()) {
+            return fail(error, "receive failed");
+        }
+        const int ready = waitFor(guard.socket, false, deadline);
+        if (ready <= 0) {
+            return fail(error, ready == 0 ? "timeout" : "receive failed");
+        }
+    }
+
+    // Status line: HTTP/1.1 SP STATUS SP REASON
+    if (headerEnd == std::string::npos || received.compare(0, 5, "HTTP/") != 0) {
+        return fail(error, "malformed response");
+    }
+    const size_t space = received.find(' ');
+    response.status = std::atoi(received.c_str() + space + 1);
+    response.body = received.substr(headerEnd + 4);
+    if (responseHeaders != nullptr) {
+        *responseHeaders = Utils::toLower(received.substr(0, headerEnd + 2));
+    }
+    if (expected != std::string::npos) {
+        if (received.size() < expected) {
+            return fail(error, "truncated response");
+        }
+        response.body.resize(expected - headerEnd - 4);
+    }
+    return true;
+}
+
+} // namespace cbir
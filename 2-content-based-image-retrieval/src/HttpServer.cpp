@@ -0,0 +1,403 @@
+////////////////////////////////////////////////////////////////////////////////
+// HttpServer.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the thread-pooled HTTP server. Uses Winsock
+//              on Windows and BSD sockets elsewhere.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "HttpServer.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace cbir {
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const std::intptr_t NO_SOCKET = static_cast<std::intptr_t>(INVALID_SOCKET);
+void closeSocket(std::intptr_t socket) { closesocket(static_cast<SOCKET>(socket)); }
+#else
+using SocketHandle = int;
+const std::intptr_t NO_SOCKET = -1;
+void closeSocket(std::intptr_t socket) { close(static_cast<int>(socket)); }
+#endif
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;   // EPIPE instead of SIGPIPE on Linux
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+/// Largest request line plus headers
+const size_t MAX_HEADER_BYTES = 64 * 1024;
+
+/// Accept loop wake-up interval for checking the stop flag
+const int ACCEPT_POLL_MS = 200;
+
+/// Seconds a client may stall before its connection is dropped
+const int RECEIVE_TIMEOUT_SECONDS = 30;
+
+SocketHandle handle(std::intptr_t socket) {
+    return static_cast<SocketHandle>(socket);
+}
+
+void setReceiveTimeout(std::intptr_t socket) {
+#ifdef _WIN32
+    DWORD timeout = RECEIVE_TIMEOUT_SECONDS * 1000;
+#else
+    timeval timeout;
+    timeout.tv_sec = RECEIVE_TIMEOUT_SECONDS;
+    timeout.tv_usec = 0;
+#endif
+    setsockopt(handle(socket), SOL_SOCKET, SO_RCVTIMEO,
+               reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+} // namespace
+
+const char* httpStatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default:  return "Unknown";
+    }
+}
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+HttpServer::HttpServer() : listenSocket_(NO_SOCKET), port_(0), running_(false) {
+}
+
+/**
+ * @brief Destructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::setHandler(Handler handler) {
+    handler_ = std::move(handler);
+}
+
+/**
+ * @brief Bind the listening socket and start all threads
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool HttpServer::start(const std::string& host, int port, int threads) {
+    if (running_) {
+        std::cerr << "Error: Server already running" << std::endl;
+        return false;
+    }
+    if (!handler_) {
+        std::cerr << "Error: No request handler set" << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "Error: WSAStartup failed" << std::endl;
+        return false;
+    }
+#endif
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Error: Invalid IPv4 address: " << host << std::endl;
+        return false;
+    }
+
+    listenSocket_ = static_cast<std::intptr_t>(socket(AF_INET, SOCK_STREAM, 0));
+    if (listenSocket_ == NO_SOCKET) {
+        std::cerr << "Error: Could not create socket" << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(handle(listenSocket_), SOL_SOCKET, SO_REUSEADDR,
+               reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    if (bind(handle(listenSocket_), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(handle(listenSocket_), SOMAXCONN) != 0) {
+        std::cerr << "Error: Could not listen on " << host << ":" << port << std::endl;
+        closeSocket(listenSocket_);
+        listenSocket_ = NO_SOCKET;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(handle(listenSocket_), reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    running_ = true;
+    const int workerCount = std::max(1, threads);
+    for (int i = 0; i < workerCount; i++) {
+        workers_.emplace_back(&HttpServer::workerLoop, this, i);
+    }
+    acceptThread_ = std::thread(&HttpServer::acceptLoop, this);
+    return true;
+}
+
+void HttpServer::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopped_.wait(lock, [this] { return !running_; });
+}
+
+/**
+ * @brief Stop the server
+ *
+ * Queued connections are still served; workers exit once the queue is empty.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HttpServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    pendingReady_.notify_all();
+    stopped_.notify_all();
+
+    if (acceptThread_.joinable()) {
+        acceptThread_.join();
+    }
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+
+    if (listenSocket_ != NO_SOCKET) {
+        closeSocket(listenSocket_);
+        listenSocket_ = NO_SOCKET;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
+
+/**
+ * @brief Accept connections and hand them to the workers
+ *
+ * select() with a short timeout lets the loop notice stop() without
+ * relying on platform-specific ways of interrupting accept().
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HttpServer::acceptLoop() {
+    while (running_) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(handle(listenSocket_), &readable);
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = ACCEPT_POLL_MS * 1000;
+
+        const int ready = select(static_cast<int>(listenSocket_) + 1, &readable,
+                                 nullptr, nullptr, &timeout);
+        if (ready <= 0) {
+            continue;
+        }
+
+        const std::intptr_t client =
+            static_cast<std::intptr_t>(accept(handle(listenSocket_), nullptr, nullptr));
+        if (client == NO_SOCKET) {
+            continue;
+        }
+        setReceiveTimeout(client);
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.size() < MAX_PENDING) {
+                pending_.push_back(Connection{client, cv::getTickCount()});
+                queued = true;
+            }
+        }
+
+        if (queued) {
+            pendingReady_.notify_one();
+        } else {
+            HttpResponse busy;
+            busy.status = 503;
+            busy.body = "{\"error\":\"Server busy\"}";
+            sendResponse(client, busy);
+            closeSocket(client);
+        }
+    }
+}
+
+/**
+ * @brief Serve queued connections until stopped and drained
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void HttpServer::workerLoop(int worker) {
+    while (true) {
+        Connection connection;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pendingReady_.wait(lock, [this] { return !pending_.empty() || !running_; });
+            if (pending_.empty()) {
+                return;
+            }
+            connection = pending_.front();
+            pending_.pop_front();
+        }
+
+        HttpRequest request;
+        request.acceptedTicks = connection.acceptedTicks;
+        request.worker = worker;
+
+        const int status = readRequest(connection.socket, request);
+        if (status == 0) {
+            HttpResponse response;
+            try {
+                response = handler_(request);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Request handler failed: " << e.what() << std::endl;
+                response.status = 500;
+                response.body = "{\"error\":\"Internal error\"}";
+            }
+            sendResponse(connection.socket, response);
+        } else if (status > 0) {
+            HttpResponse error;
+            error.status = status;
+            error.body = std::string("{\"error\":\"") + httpStatusText(status) + "\"}";
+            sendResponse(connection.socket, error);
+        }
+        closeSocket(connection.socket);
+    }
+}
+
+/**
+ * @brief Read the request line, headers and Content-Length body
+ *
+ * @author Krushna Sanjay Sharma
+ */
+int HttpServer::readRequest(std::intptr_t socket, HttpRequest& request) const {
+    std::string data;
+    char buffer[16384];
+    size_t headerEnd = std::string::npos;
+
+    while (headerEnd == std::string::npos) {
+        const int received = recv(handle(socket), buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return -1;
+        }
+        data.append(buffer, received);
+        headerEnd = data.find("\r\n\r\n");
+        if (headerEnd == std::string::npos && data.size() > MAX_HEADER_BYTES) {
+            return 413;
+        }
+    }
+
+    // Request line: METHOD SP TARGET SP VERSION
+    const size_t lineEnd = data.find("\r\n");
+    const std::string requestLine = data.substr(0, lineEnd);
+    const size_t firstSpace = requestLine.find(' ');
+    const size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == std::string::npos || secondSpace == std::string::npos) {
+        return 400;
+    }
+    request.method = requestLine.substr(0, firstSpace);
+    const std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    const size_t queryStart = target.find('?');
+    request.path = target.substr(0, queryStart);
+    if (queryStart != std::string::npos) {
+        request.query = target.substr(queryStart + 1);
+    }
+
+    // Headers
+    size_t position = lineEnd + 2;
+    while (position < headerEnd) {
+        size_t end = data.find("\r\n", position);
+        const std::string line = data.substr(position, end - position);
+        position = end + 2;
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        request.headers[Utils::toLower(line.substr(0, colon))] = value;
+    }
+
+    // Body
+    size_t contentLength = 0;
+    auto lengthHeader = request.headers.find("content-length");
+    if (lengthHeader != request.headers.end()) {
+        char* end = nullptr;
+        const unsigned long long length = std::strtoull(lengthHeader->second.c_str(), &end, 10);
+        if (end == lengthHeader->second.c_str()) {
+            return 400;
+        }
+        if (length > MAX_BODY_BYTES) {
+            return 413;
+        }
+        contentLength = static_cast<size_t>(length);
+    }
+
+    request.body = data.substr(headerEnd + 4);
+    while (request.body.size() < contentLength) {
+        const int received = recv(handle(socket), buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return -1;
+        }
+        request.body.append(buffer, received);
+    }
+    request.body.resize(contentLength);
+    return 0;
+}
+
+void HttpServer::sendResponse(std::intptr_t socket, const HttpResponse& response) const {
+    std::string data = "HTTP/1.1 " + std::to_string(response.status) + " " +
+                       httpStatusText(response.status) + "\r\n";
+    data += "Content-Type: " + response.contentType + "\r\n";
+    data += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+    data += "Connection: close\r\n\r\n";
+    data += response.body;
+
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const int written = send(handle(socket), data.data() + sent,
+                                 static_cast<int>(data.size() - sent), SEND_FLAGS);
+        if (written <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
+
+} // namespace cbir
@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+// ImageContext.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the per-image intermediate cache.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ImageContext.h"
+
+namespace cbir {
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+ImageContext::ImageContext(const cv::Mat& image, const std::string& filename,
+                           const cv::Size& fullSize, const cv::Point& offset)
+    : image_(image), filename_(filename),
+      fullSize_(fullSize.empty() ? image.size() : fullSize),
+      offset_(fullSize.empty() ? cv::Point() : offset),
+      facesDetected_(false) {
+}
+
+/**
+ * @brief BGR image
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const cv::Mat& ImageContext::color() {
+    if (color_.empty() && !image_.empty()) {
+        if (image_.channels() == 1) {
+            cv::cvtColor(image_, color_, cv::COLOR_GRAY2BGR);
+        } else {
+            color_ = image_;
+        }
+    }
+    return color_;
+}
+
+/**
+ * @brief 8-bit grayscale
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const cv::Mat& ImageContext::gray() {
+    if (gray_.empty() && !image_.empty()) {
+        if (image_.channels() == 3) {
+            cv::cvtColor(image_, gray_, cv::COLOR_BGR2GRAY);
+        } else {
+            gray_ = image_;
+        }
+    }
+    return gray_;
+}
+
+/**
+ * @brief CV_32F grayscale
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const cv::Mat& ImageContext::grayFloat() {
+    if (grayFloat_.empty() && !gray().empty()) {
+        gray_.convertTo(grayFloat_, CV_32F);
+    }
+    return grayFloat_;
+}
+
+/**
+ * @brief Equalized grayscale
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const cv::Mat& ImageContext::equalizedGray() {
+    if (equalizedGray_.empty() && !gray().empty()) {
+        cv::equalizeHist(gray_, equalizedGray_);
+    }
+    return equalizedGray_;
+}
+
+/**
+ * @brief HSV image
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const cv::Mat& ImageContext::hsv() {
+    if (hsv_.empty() && !color().empty()) {
+        cv::cvtColor(color_, hsv_, cv::COLOR_BGR2HSV);
+    }
+    return hsv_;
+}
+
+/**
+ * @brief Sobel gradient magnitude
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const cv::Mat& ImageContext::gradientMagnitude() {
+    if (gradientMagnitude_.empty() && !grayFloat().empty()) {
+        cv::Mat gradX, gradY;
+        cv::Sobel(grayFloat_, gradX, CV_32F, 1, 0, 3);
+        cv::Sobel(grayFloat_, gradY, CV_32F, 0, 1, 3);
+        cv::magnitude(gradX, gradY, gradientMagnitude_);
+    }
+    return gradientMagnitude_;
+}
+
+/**
+ * @brief Face boxes, detected once
+ *
+ * @author Krushna Sanjay Sharma
+ */
+const std::vector<cv::Rect>& ImageContext::faces(const FaceDetector& detector) {
+    if (!facesDetected_) {
+        if (!equalizedGray().empty()) {
+            faces_ = detector(equalizedGray_);
+        }
+        facesDetected_ = true;
+    }
+    return faces_;
+}
+
+} // namespace cbir
@@ -21,15 +21,71 @@
 #include "ImageRetrieval.h"
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <unordered_set>
 
 namespace cbir {
 
+namespace {
+
+/// (distance, database row); compares lexicographically so ties go to the lower row
+using Candidate = std::pair<double, int>;
+
+/**
+ * Offer a candidate to a bounded max-heap of the best `keep` rows
+ * 
+ * front() of the heap is the current worst survivor, so a candidate that
+ * does not beat it costs one comparison.
+ */
+inline void keepBest(std::vector<Candidate>& heap, size_t keep, const Candidate& candidate) {
+    if (heap.size() < keep) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (candidate < heap.front()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+/**
+ * Reduce merged per-worker survivors to the sorted best `keep`
+ */
+void finishTopRows(std::vector<Candidate>& best, size_t keep) {
+    if (best.size() > keep) {
+        std::nth_element(best.begin(), best.begin() + keep, best.end());
+        best.resize(keep);
+    }
+    std::sort(best.begin(), best.end());
+}
+
+/**
+ * Rows per scan work item: whole compressed blocks, so that each block is
+ * decompressed once per scan
+ */
+inline int scanBlockRows(const FeatureDatabase& database, int uncompressedRows) {
+    return database.isCompressed() ? database.blockRows() : uncompressedRows;
+}
+
+/**
+ * Rows [start, end) of a row-norm column, empty if there are no norms
+ */
+inline cv::Mat normRange(const cv::Mat& rowNorms, int start, int end) {
+    return rowNorms.empty() ? cv::Mat() : rowNorms.rowRange(start, end);
+}
+
+} // namespace
+
 /**
  * Constructor - Initialize with null pointers
  * Components must be set using setter methods before querying
  */
 ImageRetrieval::ImageRetrieval() 
-    : database_(nullptr), featureExtractor_(nullptr), distanceMetric_(nullptr) {
+    : database_(nullptr), annIndex_(nullptr), prefilter_(nullptr), prefilterCandidates_(0),
+      featureExtractor_(nullptr), distanceMetric_(nullptr), backend_(ScanBackend::Cpu) {
     // Initialize all components to null
     // User must call setters before performing queries
 }
@@ -42,8 +98,10 @@ ImageRetrieval::ImageRetrieval()
  * 
  * Process:
  *   1. Validate system is ready (all components set)
- *   2. Extract features from query image
- *   3. Delegate to queryWithFeatures() for comparison
+ *   2. With a query cache, return cached matches for a repeated query
+ *   3. Extract features from query image (or reuse cached features)
+ *   4. Delegate to queryWithFeatures() for comparison
+ *   5. Remember the matches for the next identical query
  * 
  * @param queryImage Input image to search for
  * @param topN Number of top matches to return
@@ -56,66 +114,424 @@ std::vector<ImageMatch> ImageRetrieval::query(const cv::Mat& queryImage, int top
         return std::vector<ImageMatch>();
     }
     
+    // Repeated query: no extraction, no scan
+    const uint64_t imageHash = queryCache_ ? QueryCache::hashImage(queryImage) : 0;
+    const ResultKey key = queryCache_ ? resultKey(imageHash, topN) : ResultKey();
+    std::vector<ImageMatch> matches;
+    if (queryCache_ && queryCache_->findResults(key, matches)) {
+        std::cout << "Found top " << matches.size() << " matches (cached)" << std::endl;
+        return matches;
+    }
+    
     // Extract features from query image using configured extractor
     std::cout << "Extracting features from query image..." << std::endl;
-    cv::Mat queryFeatures = featureExtractor_->extractFeatures(queryImage);
+    cv::Mat queryFeatures = extractQueryFeatures(queryImage, imageHash);
     
     if (queryFeatures.empty()) {
         std::cerr << "Error: Failed to extract features from query image" << std::endl;
         return std::vector<ImageMatch>();
     }
     
-    // Delegate to feature-based query method
-    return queryWithFeatures(queryFeatures, topN);
+    if (prefilter_ != nullptr && prefilter_->featureExtractor_) {
+        // Two-stage query: the prefilter needs its own (cheap) features
+        cv::Mat prefilterFeatures = prefilter_->extractQueryFeatures(queryImage, imageHash);
+        if (prefilterFeatures.empty()) {
+            std::cerr << "Error: Failed to extract prefilter features" << std::endl;
+            return std::vector<ImageMatch>();
+        }
+        
+        CascadeTiming timing;
+        matches = queryCascade(prefilterFeatures, queryFeatures, topN, &timing);
+        std::cout << "Prefilter: " << timing.prefilterMs << " ms, rerank of "
+                  << timing.candidates << " candidates: " << timing.rerankMs << " ms" << std::endl;
+    } else {
+        // Delegate to feature-based query method
+        matches = queryWithFeatures(queryFeatures, topN);
+    }
+    
+    if (queryCache_ && !matches.empty()) {
+        queryCache_->insertResults(key, matches);
+    }
+    return matches;
 }
 
 /**
  * Query database with pre-computed features
  * 
  * Useful when features are already extracted or loaded from file.
- * Performs the actual comparison against database.
+ * Uses the approximate index when one is set, exhaustive search otherwise.
+ * 
+ * @param queryFeatures Pre-computed feature vector
+ * @param topN Number of top matches to return
+ * @return Vector of top N matches sorted by distance (ascending)
+ */
+std::vector<ImageMatch> ImageRetrieval::queryWithFeatures(const cv::Mat& queryFeatures, 
+                                                          int topN) {
+    if (annIndex_ == nullptr) {
+        return queryExact(queryFeatures, topN);
+    }
+    
+    // Validate system is properly configured
+    if (!isReady()) {
+        std::cerr << "Error: ImageRetrieval system not properly configured" << std::endl;
+        return std::vector<ImageMatch>();
+    }
+    if (topN <= 0) {
+        return std::vector<ImageMatch>();
+    }
+    
+    std::cout << "Searching " << annIndex_->getIndexName() << " index..." << std::endl;
+    
+    std::vector<AnnResult> best;
+    if (!annIndex_->search(queryFeatures, topN, best) || best.empty()) {
+        std::cerr << "Error: No matches found" << std::endl;
+        return std::vector<ImageMatch>();
+    }
+    
+    std::vector<ImageMatch> topMatches;
+    topMatches.reserve(best.size());
+    for (const auto& ranked : best) {
+        topMatches.emplace_back(database_->getName(ranked.second), ranked.first);
+    }
+    
+    std::cout << "Found top " << topMatches.size() << " matches" << std::endl;
+    
+    return topMatches;
+}
+
+/**
+ * Query database with pre-computed features, always exhaustively
  * 
  * Process:
  *   1. Validate system is ready
- *   2. Compute distance from query to all database images
- *   3. Sort by distance (ascending - lower is more similar)
- *   4. Return top N matches
+ *   2. Score every database image, keeping only the best topN
+ *      (index, distance) pairs per worker
+ *   3. Merge and sort the survivors (ascending - lower is more similar)
+ *   4. Look up filenames for the top N matches only
  * 
  * @param queryFeatures Pre-computed feature vector
  * @param topN Number of top matches to return
  * @return Vector of top N matches sorted by distance (ascending)
  */
-std::vector<ImageMatch> ImageRetrieval::queryWithFeatures(const cv::Mat& queryFeatures, 
-                                                          int topN) {
+std::vector<ImageMatch> ImageRetrieval::queryExact(const cv::Mat& queryFeatures, int topN) {
     // Validate system is properly configured
     if (!isReady()) {
         std::cerr << "Error: ImageRetrieval system not properly configured" << std::endl;
         return std::vector<ImageMatch>();
     }
     
-    std::cout << "Computing distances to all database images..." << std::endl;
+    if (topN <= 0) {
+        return std::vector<ImageMatch>();
+    }
+    
+    std::cout << "Comparing against " << database_->size() << " database images ("
+              << cv::getNumThreads() << " threads)..." << std::endl;
+    
+    // Streaming top-N selection over the whole database, on the device if enabled
+    std::vector<RankedRow> best;
+    std::vector<std::vector<RankedRow>> deviceBest;
+    cv::Mat query;
+    const bool onDevice = backend_ != ScanBackend::Cpu &&
+                          prepareQuery(queryFeatures, database_->dimension(), query) &&
+                          (gpuTopRows(query, topN, deviceBest) ||
+                           numaTopRows(query, topN, deviceBest));
+    if (onDevice) {
+        best.swap(deviceBest[0]);
+    }
+    if ((!onDevice && !computeTopRows(*database_, scanNorms(*database_), queryFeatures,
+                                      topN, best)) ||
+        best.empty()) {
+        std::cerr << "Error: No matches found" << std::endl;
+        return std::vector<ImageMatch>();
+    }
+    
+    // Filenames are only materialised for the winners
+    std::vector<ImageMatch> topMatches;
+    topMatches.reserve(best.size());
+    for (const auto& ranked : best) {
+        topMatches.emplace_back(database_->getName(ranked.second), ranked.first);
+    }
+    
+    std::cout << "Found top " << topMatches.size() << " matches" << std::endl;
+    
+    return topMatches;
+}
+
+/**
+ * Query database with a batch of feature vectors, exhaustively
+ * 
+ * Process:
+ *   1. Validate system is ready and every query matches the database
+ *   2. Score all queries against each cached database tile
+ *      (see computeTopRowsBatch)
+ *   3. Look up filenames for each query's top N matches only
+ * 
+ * @param queries One query feature vector per row
+ * @param topN Number of top matches to return per query
+ * @return Top N matches per query (ascending distance), all empty on error
+ */
+std::vector<std::vector<ImageMatch>> ImageRetrieval::queryBatch(const cv::Mat& queries,
+                                                                int topN) {
+    std::vector<std::vector<ImageMatch>> results(queries.rows);
+    if (!isReady() || topN <= 0 || queries.empty()) {
+        return results;
+    }
+    
+    cv::Mat continuous = queries.isContinuous() ? queries : queries.clone();
+    cv::Mat batch;
+    continuous.reshape(1, queries.rows).convertTo(batch, CV_32F);
+    if (batch.cols != database_->dimension()) {
+        std::cerr << "Error: Queries have " << batch.cols << " features, database has "
+                  << database_->dimension() << std::endl;
+        return results;
+    }
+    
+    std::cout << "Comparing " << batch.rows << " queries against " << database_->size()
+              << " database images (" << cv::getNumThreads() << " threads)..." << std::endl;
+    
+    std::vector<std::vector<RankedRow>> best;
+    if (!gpuTopRows(batch, topN, best) && !numaTopRows(batch, topN, best) &&
+        !computeTopRowsBatch(batch, topN, best)) {
+        std::cerr << "Error: Batch query failed" << std::endl;
+        return results;
+    }
+    
+    for (int q = 0; q < batch.rows; q++) {
+        results[q].reserve(best[q].size());
+        for (const auto& ranked : best[q]) {
+            results[q].emplace_back(database_->getName(ranked.second), ranked.first);
+        }
+    }
+    return results;
+}
+
+/**
+ * Merge per-shard top-N lists into one top-N list
+ * 
+ * Shards hold disjoint images, so each list is already the shard's exact
+ * best; the union's best topN is therefore the global exact top N. If an
+ * image appears twice its smaller distance wins. Ties are broken by name
+ * so the result does not depend on shard answer order.
+ * 
+ * @param lists Top-N matches from each shard
+ * @param topN Number of matches to keep
+ * @return Merged matches sorted by distance (ascending)
+ */
+std::vector<ImageMatch> ImageRetrieval::mergeMatches(
+    const std::vector<std::vector<ImageMatch>>& lists, int topN) {
+    std::vector<ImageMatch> merged;
+    for (const auto& list : lists) {
+        merged.insert(merged.end(), list.begin(), list.end());
+    }
+
+    auto better = [](const ImageMatch& a, const ImageMatch& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.filename < b.filename);
+    };
+    std::sort(merged.begin(), merged.end(), better);
+
+    std::vector<ImageMatch> results;
+    results.reserve(std::min(merged.size(), static_cast<size_t>(std::max(0, topN))));
+    std::unordered_set<std::string> seen;
+    for (const ImageMatch& match : merged) {
+        if (static_cast<int>(results.size()) >= topN) {
+            break;
+        }
+        if (seen.insert(match.filename).second) {
+            results.push_back(match);
+        }
+    }
+    return results;
+}
+
+/**
+ * Query a LiveDatabase snapshot
+ * 
+ * Each segment is scanned like queryExact() with its dead rows skipped.
+ * A live name is stored in exactly one segment, so merging the
+ * per-segment lists with mergeMatches() gives the top N of the snapshot.
+ * 
+ * @param snapshot Snapshot to scan (kept alive by the caller)
+ * @param queryFeatures Pre-computed feature vector
+ * @param topN Number of top matches to return
+ * @param partial Output: true if an async load had not finished
+ * @return Vector of top N matches sorted by distance (ascending)
+ */
+std::vector<ImageMatch> ImageRetrieval::querySnapshot(const DatabaseSnapshot& snapshot,
+                                                      const cv::Mat& queryFeatures, int topN,
+                                                      bool* partial) {
+    if (partial != nullptr) {
+        *partial = !snapshot.complete();
+    }
+    if (distanceMetric_ == nullptr) {
+        std::cerr << "Error: Distance metric not set" << std::endl;
+        return std::vector<ImageMatch>();
+    }
+    if (topN <= 0) {
+        return std::vector<ImageMatch>();
+    }
+    
+    std::vector<std::vector<ImageMatch>> lists;
+    lists.reserve(snapshot.segments.size());
+    for (const DatabaseSegment& segment : snapshot.segments) {
+        if (segment.live() == 0) {
+            continue;
+        }
+        std::vector<RankedRow> best;
+        if (!computeTopRows(*segment.rows, scanNorms(*segment.rows), queryFeatures,
+                            topN, best, segment.dead.get())) {
+            return std::vector<ImageMatch>();
+        }
+        std::vector<ImageMatch> matches;
+        matches.reserve(best.size());
+        for (const auto& ranked : best) {
+            matches.emplace_back(segment.rows->getName(ranked.second), ranked.first);
+        }
+        lists.push_back(std::move(matches));
+    }
+    return mergeMatches(lists, topN);
+}
+
+/**
+ * Two-stage query: cheap prefilter, then rerank with the configured metric
+ * 
+ * Process:
+ *   1. The prefilter returns its best max(topN, candidates) images
+ *      (exhaustive or through its ANN index)
+ *   2. Their names are mapped to rows of this database (hash lookups)
+ *   3. Only those rows are scored with the configured metric
+ *   4. The best topN are returned
+ * 
+ * @param prefilterFeatures Query features for the prefilter database
+ * @param queryFeatures Query features for this database
+ * @param topN Number of top matches to return
+ * @param timing Output: per-stage timing (optional)
+ * @return Vector of top N matches sorted by distance (ascending)
+ */
+std::vector<ImageMatch> ImageRetrieval::queryCascade(const cv::Mat& prefilterFeatures,
+                                                     const cv::Mat& queryFeatures, int topN,
+                                                     CascadeTiming* timing) {
+    if (!isReady() || prefilter_ == nullptr) {
+        std::cerr << "Error: Cascade query needs a configured system and a prefilter" << std::endl;
+        return std::vector<ImageMatch>();
+    }
+    if (topN <= 0) {
+        return std::vector<ImageMatch>();
+    }
+    
+    // Stage 1: candidate selection in the cheap feature space
+    const int64 start = cv::getTickCount();
+    const int candidateCount = std::max(topN, prefilterCandidates_);
+    std::vector<ImageMatch> coarse = prefilter_->queryWithFeatures(prefilterFeatures,
+                                                                   candidateCount);
+    const int64 middle = cv::getTickCount();
     
-    // Compute distance to every image in database
-    std::vector<ImageMatch> allMatches = computeAllDistances(queryFeatures);
+    std::vector<int> rows;
+    rows.reserve(coarse.size());
+    for (const auto& match : coarse) {
+        int row = database_->indexOf(match.filename);
+        if (row >= 0) {
+            rows.push_back(row);
+        }
+    }
+    if (rows.size() < coarse.size()) {
+        std::cerr << "Warning: " << (coarse.size() - rows.size())
+                  << " prefilter candidates are not in the database" << std::endl;
+    }
     
-    if (allMatches.empty()) {
+    // Stage 2: expensive metric on the candidates only
+    std::cout << "Reranking " << rows.size() << " candidates with "
+              << getDistanceMetricName() << "..." << std::endl;
+    std::vector<RankedRow> best;
+    if (rows.empty() || !rerankRows(queryFeatures, rows, topN, best) || best.empty()) {
         std::cerr << "Error: No matches found" << std::endl;
         return std::vector<ImageMatch>();
     }
+    const int64 end = cv::getTickCount();
     
-    // Sort matches by distance (ascending: 0.0 = identical, higher = less similar)
-    std::sort(allMatches.begin(), allMatches.end());
+    if (timing != nullptr) {
+        timing->prefilterMs = (middle - start) * 1000.0 / cv::getTickFrequency();
+        timing->rerankMs = (end - middle) * 1000.0 / cv::getTickFrequency();
+        timing->candidates = static_cast<int>(rows.size());
+    }
     
-    // Extract top N matches
-    int numToReturn = std::min(topN, static_cast<int>(allMatches.size()));
-    std::vector<ImageMatch> topMatches(allMatches.begin(), 
-                                       allMatches.begin() + numToReturn);
+    std::vector<ImageMatch> topMatches;
+    topMatches.reserve(best.size());
+    for (const auto& ranked : best) {
+        topMatches.emplace_back(database_->getName(ranked.second), ranked.first);
+    }
     
-    std::cout << "Found top " << numToReturn << " matches" << std::endl;
+    std::cout << "Found top " << topMatches.size() << " matches" << std::endl;
     
     return topMatches;
 }
 
+/**
+ * Measure recall@k of the approximate index against exhaustive search
+ * 
+ * Uses evenly spaced database rows as queries. For each, recall is the
+ * fraction of the exact top k rows that the index also returns.
+ * 
+ * @param k Neighbours compared per query
+ * @param samples Number of query rows
+ * @param annMs Output: mean index search time in ms (optional)
+ * @param exactMs Output: mean exhaustive search time in ms (optional)
+ * @return Mean recall@k in [0, 1], negative on error
+ */
+double ImageRetrieval::measureRecall(int k, int samples, double* annMs, double* exactMs) {
+    if (annIndex_ == nullptr || !isReady() || k <= 0 || samples <= 0) {
+        std::cerr << "Error: Recall needs a configured system and an ANN index" << std::endl;
+        return -1.0;
+    }
+    
+    const size_t count = database_->size();
+    samples = static_cast<int>(std::min<size_t>(static_cast<size_t>(samples), count));
+    
+    double recallSum = 0.0;
+    double annSeconds = 0.0;
+    double exactSeconds = 0.0;
+    for (int i = 0; i < samples; i++) {
+        size_t row = static_cast<size_t>(i) * count / samples;
+        cv::Mat query = database_->getFeaturesAt(row).clone();
+        
+        int64 start = cv::getTickCount();
+        std::vector<RankedRow> exact;
+        if (!computeTopRows(*database_, scanNorms(*database_), query, k, exact)) {
+            return -1.0;
+        }
+        int64 middle = cv::getTickCount();
+        std::vector<AnnResult> approximate;
+        if (!annIndex_->search(query, k, approximate)) {
+            return -1.0;
+        }
+        int64 end = cv::getTickCount();
+        exactSeconds += (middle - start) / cv::getTickFrequency();
+        annSeconds += (end - middle) / cv::getTickFrequency();
+        
+        if (exact.empty()) {
+            continue;
+        }
+        std::vector<int> found;
+        found.reserve(approximate.size());
+        for (const auto& result : approximate) {
+            found.push_back(result.second);
+        }
+        std::sort(found.begin(), found.end());
+        int hits = 0;
+        for (const auto& truth : exact) {
+            hits += std::binary_search(found.begin(), found.end(), truth.second) ? 1 : 0;
+        }
+        recallSum += static_cast<double>(hits) / exact.size();
+    }
+    
+    if (annMs != nullptr) {
+        *annMs = 1000.0 * annSeconds / samples;
+    }
+    if (exactMs != nullptr) {
+        *exactMs = 1000.0 * exactSeconds / samples;
+    }
+    return recallSum / samples;
+}
+
 /**
  * Set the feature database to query against
  * 
@@ -125,6 +541,83 @@ void ImageRetrieval::setFeatureDatabase(FeatureDatabase* database) {
     database_ = database;
 }
 
+/**
+ * Set the approximate nearest-neighbour index used by queryWithFeatures()
+ * 
+ * The index is not owned and must be attached to the same database.
+ * 
+ * @param index Pointer to index, nullptr for exhaustive search
+ */
+void ImageRetrieval::setAnnIndex(AnnIndex* index) {
+    annIndex_ = index;
+}
+
+/**
+ * Set the first stage used by query() and queryCascade()
+ * 
+ * @param prefilter Retrieval over a cheap feature database (not owned),
+ *                  nullptr to disable
+ * @param candidates Candidates passed on to the rerank stage
+ */
+void ImageRetrieval::setPrefilter(ImageRetrieval* prefilter, int candidates) {
+    prefilter_ = prefilter;
+    prefilterCandidates_ = candidates;
+}
+
+/**
+ * Attach a result / feature cache used by query()
+ * 
+ * @param cache Cache (may be shared), nullptr to disable
+ */
+void ImageRetrieval::setQueryCache(std::shared_ptr<QueryCache> cache) {
+    queryCache_ = std::move(cache);
+}
+
+/**
+ * Choose the scan backend
+ * 
+ * A missing OpenCL device is reported once here; queries then simply
+ * stay on the CPU.
+ * 
+ * @param backend Cpu, Gpu or Auto
+ * @param scanner Shared device copy, or nullptr for a private one
+ */
+void ImageRetrieval::setBackend(ScanBackend backend, std::shared_ptr<GpuScanner> scanner) {
+    if (backend == ScanBackend::Numa) {
+        setBackend(backend, std::shared_ptr<NumaScanner>());
+        return;
+    }
+    backend_ = backend;
+    numaScanner_.reset();
+    if (backend_ == ScanBackend::Cpu) {
+        gpuScanner_.reset();
+        return;
+    }
+    if (!GpuScanner::isAvailable()) {
+        std::cerr << "Warning: No OpenCL device available, scanning on the CPU" << std::endl;
+    }
+    gpuScanner_ = scanner ? std::move(scanner) : std::make_shared<GpuScanner>();
+}
+
+/**
+ * Scan on NUMA partitions shared by the engines of one database
+ * 
+ * @param backend Numa (anything else is handled by the GpuScanner overload)
+ * @param scanner Shared partitions, or nullptr for private ones
+ */
+void ImageRetrieval::setBackend(ScanBackend backend, std::shared_ptr<NumaScanner> scanner) {
+    if (backend != ScanBackend::Numa) {
+        setBackend(backend, std::shared_ptr<GpuScanner>());
+        return;
+    }
+    backend_ = backend;
+    gpuScanner_.reset();
+    if (!NumaScanner::isAvailable()) {
+        std::cerr << "Warning: Single NUMA node, partitioned scans run unpinned" << std::endl;
+    }
+    numaScanner_ = scanner ? std::move(scanner) : std::make_shared<NumaScanner>();
+}
+
 /**
  * Set the feature extractor to use for query images
  * 
@@ -134,6 +627,11 @@ void ImageRetrieval::setFeatureDatabase(FeatureDatabase* database) {
  */
 void ImageRetrieval::setFeatureExtractor(FeatureExtractor* extractor) {
     featureExtractor_ = FeatureExtractorPtr(extractor);
+    
+    // A new instance may have other parameters under the same name
+    if (queryCache_) {
+        queryCache_->clearFeatures();
+    }
 }
 
 /**
@@ -205,18 +703,67 @@ bool ImageRetrieval::isReady() const {
     return true;
 }
 
+/**
+ * Extract query features, reusing cached features of a known image
+ * 
+ * @param queryImage Query image
+ * @param imageHash Content hash of the image (only used with a cache)
+ * @return Feature vector, empty on failure
+ */
+cv::Mat ImageRetrieval::extractQueryFeatures(const cv::Mat& queryImage, uint64_t imageHash) {
+    if (!queryCache_) {
+        return featureExtractor_->extractFeatures(queryImage);
+    }
+    
+    const std::string extractor = getFeatureExtractorName();
+    cv::Mat features;
+    if (queryCache_->findFeatures(imageHash, extractor, features)) {
+        return features;
+    }
+    features = featureExtractor_->extractFeatures(queryImage);
+    queryCache_->insertFeatures(imageHash, extractor, features);
+    return features;
+}
+
+/**
+ * Build the result cache key for the current configuration
+ * 
+ * The scope names every component that changes the ranking; the
+ * database versions make entries from before a mutation unreachable.
+ * 
+ * @param imageHash Content hash of the query image
+ * @param topN Number of matches requested
+ * @return Result cache key
+ */
+ResultKey ImageRetrieval::resultKey(uint64_t imageHash, int topN) const {
+    ResultKey key;
+    key.imageHash = imageHash;
+    key.topN = topN;
+    key.databaseVersion = database_->version();
+    key.scope = getFeatureExtractorName() + "|" + getDistanceMetricName() + "|" +
+                (annIndex_ != nullptr ? annIndex_->getIndexName() : "exact");
+    if (prefilter_ != nullptr && prefilter_->database_ != nullptr) {
+        key.scope += "|" + prefilter_->getFeatureExtractorName() + "|" +
+                     prefilter_->getDistanceMetricName() + "|" +
+                     (prefilter_->annIndex_ != nullptr ? prefilter_->annIndex_->getIndexName()
+                                                       : "exact") +
+                     "|" + std::to_string(prefilterCandidates_);
+        key.prefilterVersion = prefilter_->database_->version();
+    }
+    return key;
+}
+
 /**
  * Compute distances from query features to all database images
  * 
- * Iterates through entire database, computing distance between
- * query features and each database image's features.
+ * Scores the whole packed database matrix with the metric's batched
+ * kernel, then pairs each distance with its image name.
  * 
  * Process:
- *   1. Get list of all image names in database
+ *   1. Score every row of the database matrix (see computeDistanceColumn)
  *   2. For each image:
- *      - Retrieve its pre-computed features
- *      - Compute distance to query features
- *      - Store in results vector
+ *      - Skip rows the metric rejected (negative distance)
+ *      - Store name and distance in results vector
  *   3. Return unsorted results
  * 
  * @param queryFeatures Query feature vector
@@ -225,38 +772,489 @@ bool ImageRetrieval::isReady() const {
 std::vector<ImageMatch> ImageRetrieval::computeAllDistances(const cv::Mat& queryFeatures) {
     std::vector<ImageMatch> matches;
     
-    // Get all image names from database
-    std::vector<std::string> imageNames = database_->getImageNames();
-    
-    std::cout << "Comparing against " << imageNames.size() << " database images..." 
-              << std::endl;
+    cv::Mat distances;
+    if (!computeDistanceColumn(queryFeatures, distances)) {
+        return matches;
+    }
     
-    // Compute distance to each database image
-    for (const auto& imageName : imageNames) {
-        // Retrieve pre-computed features for this database image
-        cv::Mat dbFeatures = database_->getFeatures(imageName);
-        
-        if (dbFeatures.empty()) {
-            std::cerr << "Warning: No features found for " << imageName << std::endl;
-            continue;
-        }
-        
-        // Compute distance using configured metric
-        // Lower distance = more similar
-        double distance = distanceMetric_->compute(queryFeatures, dbFeatures);
+    matches.reserve(distances.rows);
+    for (int row = 0; row < distances.rows; row++) {
+        double distance = distances.at<double>(row);
         
         if (distance < 0) {
             // Negative distance indicates error in metric computation
-            std::cerr << "Warning: Invalid distance for " << imageName << std::endl;
+            std::cerr << "Warning: Invalid distance for " << database_->getName(row) << std::endl;
             continue;
         }
         
         // Create match record and add to results
-        ImageMatch match(imageName, distance);
-        matches.push_back(match);
+        matches.emplace_back(database_->getName(row), distance);
     }
     
     return matches;
 }
 
+/**
+ * Score the query against every row of the database matrix
+ * 
+ * The matrix is split into fixed blocks of rows which cv::parallel_for_
+ * distributes over OpenCV's thread pool; each block is one
+ * DistanceMetric::computeBatch() call writing its own slice of the output.
+ * Compressed databases are split at their block boundaries and each block
+ * is decompressed into the worker's buffer just before it is scored.
+ * 
+ * @param queryFeatures Query feature vector (any shape, converted to float32)
+ * @param distances Output database.size() x 1 CV_64F distances, in row order
+ * @return True if successful, false on dimension mismatch or metric error
+ */
+bool ImageRetrieval::computeDistanceColumn(const cv::Mat& queryFeatures, cv::Mat& distances) {
+    cv::Mat query;
+    if (!prepareQuery(queryFeatures, database_->dimension(), query)) {
+        return false;
+    }
+    
+    const int rows = static_cast<int>(database_->size());
+    std::cout << "Comparing against " << rows << " database images ("
+              << cv::getNumThreads() << " threads)..." << std::endl;
+    
+    distances.create(rows, 1, CV_64F);
+    
+    const int blockRows = scanBlockRows(*database_, SCAN_BLOCK_ROWS);
+    const int blockCount = (rows + blockRows - 1) / blockRows;
+    std::atomic<bool> failed(false);
+    DistanceMetric* metric = distanceMetric_.get();
+    const cv::Mat rowNorms = scanNorms(*database_);
+    
+    cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+        std::vector<uint8_t> scratch;
+        for (int block = range.start; block < range.end && !failed; block++) {
+            int start = block * blockRows;
+            int end = std::min(rows, start + blockRows);
+            cv::Mat slice = distances.rowRange(start, end);
+            if (!metric->computeBatchNormed(query, database_->readRows(start, end, scratch),
+                                            normRange(rowNorms, start, end), slice)) {
+                failed = true;
+            }
+        }
+    });
+    
+    return !failed;
+}
+
+/**
+ * Best k database rows for a query, without scoring into an N-sized buffer
+ * 
+ * Each cv::parallel_for_ work item scores its blocks into a small reusable
+ * distance column and keeps a bounded max-heap of its k best
+ * (distance, row) pairs, so a row costs one comparison against the heap
+ * top and at most O(log k) work. Heaps are merged under a mutex and the
+ * at most (workers x k) survivors are sorted. Ties are broken by row
+ * index, making the ranking deterministic regardless of thread count.
+ * 
+ * For metrics that support it (DistanceMetric::supportsCutoff()) on
+ * float32 rows, each row is instead scored with computeWithCutoff() and
+ * the worker's current K-th best distance, so most rows stop after a
+ * fraction of their elements once the heap is full.
+ * 
+ * Rows flagged in skip (superseded rows of a LiveDatabase segment) are
+ * scored with the rest of their block but never enter a heap. Compressed
+ * databases are scanned one compressed block per work item (see
+ * FeatureDatabase::readRows()).
+ * 
+ * @param rows Database to scan
+ * @param rowNorms Row norms of rows for metrics that use them, or empty
+ * @param queryFeatures Query feature vector
+ * @param k Number of rows to keep (> 0)
+ * @param best Output best rows sorted by ascending distance (size <= k)
+ * @param skip Optional per-row flags, nonzero rows are ignored
+ * @return True if successful, false on dimension mismatch or metric error
+ */
+bool ImageRetrieval::computeTopRows(const FeatureDatabase& rows, const cv::Mat& rowNorms,
+                                    const cv::Mat& queryFeatures, int k,
+                                    std::vector<RankedRow>& best,
+                                    const std::vector<uint8_t>* skip) {
+    best.clear();
+    
+    cv::Mat query;
+    if (!prepareQuery(queryFeatures, rows.dimension(), query)) {
+        return false;
+    }
+    
+    const int rowCount = static_cast<int>(rows.size());
+    const int blockRows = scanBlockRows(rows, SCAN_BLOCK_ROWS);
+    const int blockCount = (rowCount + blockRows - 1) / blockRows;
+    const size_t keep = static_cast<size_t>(k);
+    std::atomic<bool> failed(false);
+    std::atomic<int> invalidCount(0);
+    std::mutex mergeMutex;
+    DistanceMetric* metric = distanceMetric_.get();
+    const bool useCutoff = metric->supportsCutoff() && rows.storage() == FeatureStorage::Float32;
+    
+    cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+        // (distance, row) pairs compare lexicographically: front() of the
+        // max-heap is the current worst survivor
+        std::vector<RankedRow> heap;
+        heap.reserve(keep + 1);
+        cv::Mat blockDistances;
+        std::vector<uint8_t> scratch;
+        int invalid = 0;
+        
+        for (int block = range.start; block < range.end && !failed; block++) {
+            int start = block * blockRows;
+            int end = std::min(rowCount, start + blockRows);
+            const cv::Mat matrix = rows.readRows(start, end, scratch);
+            if (matrix.empty()) {
+                failed = true;
+                break;
+            }
+            
+            if (useCutoff) {
+                // Row by row against the current K-th best: rows that cannot
+                // enter the heap are abandoned part-way through
+                for (int row = start; row < end; row++) {
+                    if (skip != nullptr && (*skip)[row] != 0) {
+                        continue;
+                    }
+                    const double cutoff = heap.size() < keep
+                        ? std::numeric_limits<double>::infinity() : heap.front().first;
+                    RankedRow candidate(
+                        metric->computeWithCutoff(query, matrix.row(row - start), cutoff), row);
+                    if (candidate.first < 0) {
+                        invalid++;
+                        continue;
+                    }
+                    if (candidate.first <= cutoff) {
+                        keepBest(heap, keep, candidate);
+                    }
+                }
+                continue;
+            }
+            
+            if (!metric->computeBatchNormed(query, matrix, normRange(rowNorms, start, end),
+                                            blockDistances)) {
+                failed = true;
+                break;
+            }
+            
+            for (int i = 0; i < end - start; i++) {
+                if (skip != nullptr && (*skip)[start + i] != 0) {
+                    continue;
+                }
+                RankedRow candidate(blockDistances.at<double>(i), start + i);
+                if (candidate.first < 0) {
+                    // Negative distance indicates error in metric computation
+                    invalid++;
+                    continue;
+                }
+                keepBest(heap, keep, candidate);
+            }
+        }
+        
+        invalidCount += invalid;
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        best.insert(best.end(), heap.begin(), heap.end());
+    });
+    
+    if (failed) {
+        best.clear();
+        return false;
+    }
+    if (invalidCount > 0) {
+        std::cerr << "Warning: Invalid distance for " << invalidCount.load()
+                  << " database images" << std::endl;
+    }
+    
+    // Merge: only the per-worker survivors are sorted
+    finishTopRows(best, keep);
+    return true;
+}
+
+/**
+ * Best k database rows for every query, scanned on the OpenCL device
+ * 
+ * The device returns each query's k best rows by single-precision
+ * distance; those rows are rescored with the configured metric through
+ * rerankRows(), so reported distances are the CPU's. Returns false
+ * (and leaves best empty) whenever the CPU should scan instead.
+ * 
+ * @param queries Q x matrix.cols CV_32F queries
+ * @param k Number of rows to keep per query (> 0)
+ * @param best Output best rows per query (ascending distance)
+ * @return True if the device scan succeeded
+ */
+bool ImageRetrieval::gpuTopRows(const cv::Mat& queries, int k,
+                                std::vector<std::vector<RankedRow>>& best) {
+    best.clear();
+    if (backend_ == ScanBackend::Cpu || gpuScanner_ == nullptr || k > GpuScanner::MAX_K ||
+        (backend_ == ScanBackend::Auto && database_->size() < AUTO_GPU_MIN_ROWS)) {
+        return false;
+    }
+    GpuScanner::Metric metric;
+    if (!GpuScanner::metricFor(distanceMetric_->getMetricName(), metric)) {
+        return false;
+    }
+    
+    std::vector<std::vector<std::pair<float, int>>> candidates;
+    if (!gpuScanner_->search(*database_, queries, metric, k, candidates)) {
+        return false;
+    }
+    
+    best.resize(candidates.size());
+    for (size_t q = 0; q < candidates.size(); q++) {
+        std::vector<int> rows;
+        rows.reserve(candidates[q].size());
+        for (const auto& candidate : candidates[q]) {
+            rows.push_back(candidate.second);
+        }
+        if (!rows.empty() &&
+            !rerankRows(queries.row(static_cast<int>(q)), rows, k, best[q])) {
+            best.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Best k database rows for every query, scanned on NUMA partitions
+ * 
+ * The partitions hold a copy of the database rows and are scored with
+ * the configured metric itself, so no rerank is needed. Returns false
+ * (and leaves best empty) whenever the shared CPU scan should run instead.
+ * 
+ * @param queries Q x matrix.cols CV_32F queries
+ * @param k Number of rows to keep per query (> 0)
+ * @param best Output best rows per query (ascending distance)
+ * @return True if the partitioned scan succeeded
+ */
+bool ImageRetrieval::numaTopRows(const cv::Mat& queries, int k,
+                                 std::vector<std::vector<RankedRow>>& best) {
+    best.clear();
+    if (backend_ != ScanBackend::Numa || numaScanner_ == nullptr) {
+        return false;
+    }
+    if (!numaScanner_->search(*database_, queries, *distanceMetric_, k, best)) {
+        best.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Best k database rows for every query of a batch, in one database pass
+ * 
+ * Work items are the same blocks as computeTopRows(). A
+ * block is walked in BATCH_TILE_ROWS tiles small enough to stay in the L2
+ * cache, and every query is scored against a tile before the next tile is
+ * touched, so each database row is read from memory once per batch rather
+ * than once per query. Queries go to DistanceMetric::computeBlock() in
+ * groups of BATCH_QUERY_ROWS (a matrix product for SSD / cosine, a
+ * multi-query min-sum for histogram intersection). Each worker keeps one
+ * bounded heap per query.
+ * 
+ * @param queries Q x matrix.cols CV_32F queries
+ * @param k Number of rows to keep per query (> 0)
+ * @param best Output Q lists sorted by ascending distance (size <= k each)
+ * @return True if successful, false on metric error
+ */
+bool ImageRetrieval::computeTopRowsBatch(const cv::Mat& queries, int k,
+                                         std::vector<std::vector<RankedRow>>& best) {
+    best.assign(queries.rows, std::vector<RankedRow>());
+    
+    const int rows = static_cast<int>(database_->size());
+    const cv::Mat rowNorms = scanNorms(*database_);
+    const int blockRows = scanBlockRows(*database_, SCAN_BLOCK_ROWS);
+    const int blockCount = (rows + blockRows - 1) / blockRows;
+    const size_t keep = static_cast<size_t>(k);
+    std::atomic<bool> failed(false);
+    std::atomic<int> invalidCount(0);
+    std::mutex mergeMutex;
+    DistanceMetric* metric = distanceMetric_.get();
+    
+    cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+        std::vector<std::vector<RankedRow>> heaps(queries.rows);
+        for (auto& heap : heaps) {
+            heap.reserve(keep + 1);
+        }
+        cv::Mat tileDistances;
+        std::vector<uint8_t> scratch;
+        int invalid = 0;
+        
+        for (int block = range.start; block < range.end && !failed; block++) {
+            const int blockStart = block * blockRows;
+            const int blockEnd = std::min(rows, blockStart + blockRows);
+            const cv::Mat matrix = database_->readRows(blockStart, blockEnd, scratch);
+            if (matrix.empty()) {
+                failed = true;
+                break;
+            }
+            
+            for (int start = blockStart; start < blockEnd && !failed; start += BATCH_TILE_ROWS) {
+                const int end = std::min(blockEnd, start + BATCH_TILE_ROWS);
+                const cv::Mat tile = matrix.rowRange(start - blockStart, end - blockStart);
+                const cv::Mat tileNorms = normRange(rowNorms, start, end);
+                
+                for (int first = 0; first < queries.rows; first += BATCH_QUERY_ROWS) {
+                    const int last = std::min(queries.rows, first + BATCH_QUERY_ROWS);
+                    if (!metric->computeBlockNormed(queries.rowRange(first, last), tile, tileNorms,
+                                                    tileDistances)) {
+                        failed = true;
+                        break;
+                    }
+                    for (int q = first; q < last; q++) {
+                        const double* distances = tileDistances.ptr<double>(q - first);
+                        for (int i = 0; i < end - start; i++) {
+                            RankedRow candidate(distances[i], start + i);
+                            if (candidate.first < 0) {
+                                invalid++;
+                                continue;
+                            }
+                            keepBest(heaps[q], keep, candidate);
+                        }
+                    }
+                }
+            }
+        }
+        
+        invalidCount += invalid;
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        for (int q = 0; q < queries.rows; q++) {
+            best[q].insert(best[q].end(), heaps[q].begin(), heaps[q].end());
+        }
+    });
+    
+    if (failed) {
+        best.assign(queries.rows, std::vector<RankedRow>());
+        return false;
+    }
+    if (invalidCount > 0) {
+        std::cerr << "Warning: " << invalidCount.load()
+                  << " invalid distances in batch query" << std::endl;
+    }
+    
+    for (auto& rows : best) {
+        finishTopRows(rows, keep);
+    }
+    return true;
+}
+
+/**
+ * Best k of a candidate set of database rows
+ * 
+ * Candidate rows are copied with their full stride (quantised rows keep
+ * their scale) into one small matrix, which is scored in parallel chunks
+ * through computeBatch() so vectorised metrics stay vectorised.
+ * 
+ * @param queryFeatures Query feature vector
+ * @param rows Candidate database rows
+ * @param k Number of rows to keep (> 0)
+ * @param best Output best rows sorted by ascending distance (size <= k)
+ * @return True if successful, false on dimension mismatch or metric error
+ */
+bool ImageRetrieval::rerankRows(const cv::Mat& queryFeatures, const std::vector<int>& rows,
+                                int k, std::vector<RankedRow>& best) {
+    best.clear();
+    
+    cv::Mat query;
+    if (!prepareQuery(queryFeatures, database_->dimension(), query)) {
+        return false;
+    }
+    cv::Mat matrix = database_->matrix();
+    if (matrix.empty()) {
+        return false;
+    }
+    
+    const size_t rowStride = matrix.step[0];
+    std::vector<uchar> buffer(rows.size() * rowStride);
+    for (size_t i = 0; i < rows.size(); i++) {
+        std::memcpy(buffer.data() + i * rowStride, matrix.ptr<uchar>(rows[i]), rowStride);
+    }
+    cv::Mat gathered(static_cast<int>(rows.size()), matrix.cols, matrix.type(),
+                     buffer.data(), rowStride);
+    
+    const cv::Mat databaseNorms = scanNorms(*database_);
+    cv::Mat gatheredNorms;
+    if (!databaseNorms.empty()) {
+        gatheredNorms.create(gathered.rows, 1, CV_64F);
+        for (size_t i = 0; i < rows.size(); i++) {
+            gatheredNorms.at<double>(static_cast<int>(i)) = databaseNorms.at<double>(rows[i]);
+        }
+    }
+    
+    cv::Mat distances(gathered.rows, 1, CV_64F);
+    const int chunkCount = (gathered.rows + RERANK_CHUNK_ROWS - 1) / RERANK_CHUNK_ROWS;
+    std::atomic<bool> failed(false);
+    DistanceMetric* metric = distanceMetric_.get();
+    
+    cv::parallel_for_(cv::Range(0, chunkCount), [&](const cv::Range& range) {
+        for (int chunk = range.start; chunk < range.end && !failed; chunk++) {
+            int start = chunk * RERANK_CHUNK_ROWS;
+            int end = std::min(gathered.rows, start + RERANK_CHUNK_ROWS);
+            cv::Mat chunkDistances = distances.rowRange(start, end);
+            if (!metric->computeBatchNormed(query, gathered.rowRange(start, end),
+                                            normRange(gatheredNorms, start, end),
+                                            chunkDistances)) {
+                failed = true;
+            }
+        }
+    });
+    if (failed) {
+        return false;
+    }
+    
+    int invalid = 0;
+    best.reserve(rows.size());
+    for (int i = 0; i < gathered.rows; i++) {
+        double distance = distances.at<double>(i);
+        if (distance < 0) {
+            invalid++;
+            continue;
+        }
+        best.emplace_back(distance, rows[i]);
+    }
+    if (invalid > 0) {
+        std::cerr << "Warning: Invalid distance for " << invalid << " candidates" << std::endl;
+    }
+    
+    finishTopRows(best, static_cast<size_t>(k));
+    return true;
+}
+
+/**
+ * Row norms for the configured metric
+ * 
+ * Computed by the database once per version, so repeated cosine queries
+ * only pay for the dot products.
+ * 
+ * @param database Database about to be scanned
+ * @return FeatureDatabase::rowNorms() or an empty Mat
+ */
+cv::Mat ImageRetrieval::scanNorms(const FeatureDatabase& database) const {
+    if (distanceMetric_ == nullptr || !distanceMetric_->usesRowNorms()) {
+        return cv::Mat();
+    }
+    return database.rowNorms();
+}
+
+/**
+ * Flatten the query into one contiguous float32 row and check its length
+ * 
+ * @param queryFeatures Query feature vector (any shape)
+ * @param dimension Columns of the database the query will be scored against
+ * @param query Output 1 x dimension CV_32F query
+ * @return True if the query matches the database dimension
+ */
+bool ImageRetrieval::prepareQuery(const cv::Mat& queryFeatures, int dimension,
+                                  cv::Mat& query) const {
+    cv::Mat continuous = queryFeatures.isContinuous() ? queryFeatures : queryFeatures.clone();
+    continuous.reshape(1, 1).convertTo(query, CV_32F);
+    
+    if (query.cols != dimension) {
+        std::cerr << "Error: Query has " << query.cols << " features, database has "
+                  << dimension << std::endl;
+        return false;
+    }
+    return true;
+}
+
 } // namespace cbir
@@ -0,0 +1,432 @@
+////////////////////////////////////////////////////////////////////////////////
+// InvertedIndex.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the inverted-file histogram-intersection
+//              index: postings construction, score accumulation over the
+//              query's non-zero bins with bound-based pruning, exact
+//              rescoring of the winners, and persistence.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "InvertedIndex.h"
+#include "DistanceKernels.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace cbir {
+
+namespace {
+
+const char INVERTED_MAGIC[8] = {'C', 'B', 'I', 'R', 'I', 'N', 'V', 'X'};
+const uint32_t INVERTED_VERSION = 1;
+
+/// On-disk header of a saved index
+struct InvertedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metric;
+    uint64_t count;
+    uint32_t dimension;
+    uint32_t reserved;
+    uint64_t postings;
+    uint64_t signature;
+};
+
+/// Divide by the sum unless the histogram already sums to about 1
+/// (HistogramIntersection::normalizeIfNeeded)
+void normalizeIfNeeded(float* values, int length) {
+    double sum = 0.0;
+    for (int i = 0; i < length; i++) {
+        sum += values[i];
+    }
+    if (std::abs(sum - 1.0) < 0.01 || sum < 1e-10) {
+        return;
+    }
+    for (int i = 0; i < length; i++) {
+        values[i] = static_cast<float>(values[i] / sum);
+    }
+}
+
+/// Per-thread score accumulator, all zero between searches
+std::vector<float>& scoreBuffer(size_t count) {
+    thread_local std::vector<float> scores;
+    if (scores.size() < count) {
+        scores.resize(count, 0.0f);
+    }
+    return scores;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+InvertedIndex::InvertedIndex(AnnMetric metric) : AnnIndex(metric) {
+}
+
+/**
+ * @brief Build the postings lists in two passes over the rows
+ *
+ * The first pass counts the non-zero bins per bin, the second fills the
+ * lists in row order, so every list is sorted by row.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool InvertedIndex::build(const FeatureDatabase& database) {
+    if (metric_ != AnnMetric::Intersection) {
+        std::cerr << "Error: Inverted index supports histogram intersection only" << std::endl;
+        return false;
+    }
+    if (database.empty()) {
+        std::cerr << "Error: Cannot build inverted index over an empty database" << std::endl;
+        return false;
+    }
+    if (database.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        std::cerr << "Error: Inverted index supports at most 2^31 - 1 rows" << std::endl;
+        return false;
+    }
+
+    count_ = database.size();
+    dimension_ = database.dimension();
+    std::vector<float> histogram(dimension_);
+
+    binOffsets_.assign(dimension_ + 1, 0);
+    maxWeights_.assign(dimension_, 0.0f);
+    for (size_t row = 0; row < count_; row++) {
+        loadHistogram(database, row, histogram.data());
+        for (int b = 0; b < dimension_; b++) {
+            if (histogram[b] < 0.0f) {
+                std::cerr << "Error: Inverted index needs non-negative histograms (row "
+                          << row << ")" << std::endl;
+                count_ = 0;
+                binOffsets_.clear();
+                maxWeights_.clear();
+                return false;
+            }
+            if (histogram[b] > 0.0f) {
+                binOffsets_[b + 1]++;
+                maxWeights_[b] = std::max(maxWeights_[b], histogram[b]);
+            }
+        }
+    }
+    std::partial_sum(binOffsets_.begin(), binOffsets_.end(), binOffsets_.begin());
+
+    postingRows_.resize(binOffsets_.back());
+    postingWeights_.resize(binOffsets_.back());
+    std::vector<uint64_t> fill(binOffsets_.begin(), binOffsets_.end() - 1);
+    for (size_t row = 0; row < count_; row++) {
+        loadHistogram(database, row, histogram.data());
+        for (int b = 0; b < dimension_; b++) {
+            if (histogram[b] > 0.0f) {
+                postingRows_[fill[b]] = static_cast<uint32_t>(row);
+                postingWeights_[fill[b]] = histogram[b];
+                fill[b]++;
+            }
+        }
+    }
+
+    signature_ = databaseSignature(database);
+    database_ = &database;
+
+    const double density = static_cast<double>(postingRows_.size()) /
+                           (static_cast<double>(count_) * dimension_);
+    std::cout << "Inverted index: " << postingRows_.size() << " postings ("
+              << density * 100.0 << "% of bins non-zero)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Attach a loaded index to its database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool InvertedIndex::attach(const FeatureDatabase& database) {
+    if (binOffsets_.empty()) {
+        std::cerr << "Error: Inverted index is not loaded" << std::endl;
+        return false;
+    }
+    if (database.size() != count_ || database.dimension() != dimension_ ||
+        databaseSignature(database) != signature_) {
+        std::cerr << "Error: Inverted index does not match the feature database (stale index)"
+                  << std::endl;
+        return false;
+    }
+    database_ = &database;
+    return true;
+}
+
+/**
+ * @brief Accumulate intersections over the query's non-zero bins
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool InvertedIndex::search(const cv::Mat& query, int k, std::vector<AnnResult>& results) const {
+    results.clear();
+    if (!isReady()) {
+        std::cerr << "Error: Inverted index is not attached to a database" << std::endl;
+        return false;
+    }
+    std::vector<float> q;
+    if (!prepareQuery(query, q)) {
+        return false;
+    }
+    if (k <= 0) {
+        return true;
+    }
+    normalizeIfNeeded(q.data(), dimension_);
+    const size_t keep = std::min(static_cast<size_t>(k), count_);
+
+    // Non-empty lists of the query's bins, largest possible contribution first
+    std::vector<std::pair<float, int>> lists;
+    for (int b = 0; b < dimension_; b++) {
+        if (q[b] > 0.0f && binOffsets_[b + 1] > binOffsets_[b]) {
+            lists.emplace_back(std::min(q[b], maxWeights_[b]), b);
+        }
+    }
+    std::sort(lists.begin(), lists.end(), std::greater<std::pair<float, int>>());
+
+    std::vector<double> remaining(lists.size() + 1, 0.0);
+    for (size_t i = lists.size(); i > 0; i--) {
+        remaining[i - 1] = remaining[i] + lists[i - 1].first;
+    }
+
+    // Contributions are strictly positive, so score > 0 marks a touched row
+    std::vector<float>& scores = scoreBuffer(count_);
+    std::vector<uint32_t> touched;
+    std::vector<float> top;
+    bool newRowsAllowed = true;
+    double lastCheckedBound = std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (newRowsAllowed && touched.size() >= keep && remaining[i] <= 0.5 * lastCheckedBound) {
+            // An unseen row can gain at most remaining[i]; the k-th best
+            // score only grows, so once it is higher no new row qualifies
+            lastCheckedBound = remaining[i];
+            top.resize(touched.size());
+            for (size_t t = 0; t < touched.size(); t++) {
+                top[t] = scores[touched[t]];
+            }
+            std::nth_element(top.begin(), top.begin() + (keep - 1), top.end(),
+                             std::greater<float>());
+            newRowsAllowed = top[keep - 1] <= remaining[i];
+        }
+
+        const int b = lists[i].second;
+        const float value = q[b];
+        for (uint64_t p = binOffsets_[b]; p < binOffsets_[b + 1]; p++) {
+            const uint32_t row = postingRows_[p];
+            if (scores[row] == 0.0f) {
+                if (!newRowsAllowed) {
+                    continue;
+                }
+                touched.push_back(row);
+            }
+            scores[row] += std::min(value, postingWeights_[p]);
+        }
+    }
+
+    // Best accumulated rows; rows never touched share the worst score
+    std::vector<std::pair<float, uint32_t>> candidates;
+    candidates.reserve(touched.size());
+    for (uint32_t row : touched) {
+        candidates.emplace_back(-scores[row], row);
+        scores[row] = 0.0f;
+    }
+    if (candidates.size() > keep) {
+        std::nth_element(candidates.begin(), candidates.begin() + keep, candidates.end());
+        candidates.resize(keep);
+    }
+
+    results.reserve(keep);
+    for (const auto& candidate : candidates) {
+        results.emplace_back(rescore(q.data(), candidate.second), static_cast<int>(candidate.second));
+    }
+    if (results.size() < keep) {
+        // Fewer rows than k share a bin with the query: pad with the lowest
+        // untouched rows, whose intersection is zero
+        std::vector<uint8_t> used(count_, 0);
+        for (const auto& result : results) {
+            used[result.second] = 1;
+        }
+        for (size_t row = 0; row < count_ && results.size() < keep; row++) {
+            if (!used[row]) {
+                results.emplace_back(rescore(q.data(), row), static_cast<int>(row));
+            }
+        }
+    }
+    std::sort(results.begin(), results.end());
+    return true;
+}
+
+/**
+ * @brief Save the postings lists
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool InvertedIndex::save(const std::string& filename) const {
+    if (binOffsets_.empty()) {
+        std::cerr << "Error: No inverted index to save" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << filename << std::endl;
+        return false;
+    }
+
+    InvertedHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INVERTED_MAGIC, sizeof(INVERTED_MAGIC));
+    header.version = INVERTED_VERSION;
+    header.metric = static_cast<uint32_t>(metric_);
+    header.count = count_;
+    header.dimension = static_cast<uint32_t>(dimension_);
+    header.postings = postingRows_.size();
+    header.signature = signature_;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(binOffsets_.data()),
+               static_cast<std::streamsize>(binOffsets_.size() * sizeof(uint64_t)));
+    file.write(reinterpret_cast<const char*>(maxWeights_.data()),
+               static_cast<std::streamsize>(maxWeights_.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(postingRows_.data()),
+               static_cast<std::streamsize>(postingRows_.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(postingWeights_.data()),
+               static_cast<std::streamsize>(postingWeights_.size() * sizeof(float)));
+
+    if (!file.good()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Saved " << getIndexName() << " index to: " << filename << std::endl;
+    return true;
+}
+
+/**
+ * @brief Load saved postings and validate the offsets and rows
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool InvertedIndex::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    InvertedHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() || std::memcmp(header.magic, INVERTED_MAGIC, sizeof(INVERTED_MAGIC)) != 0 ||
+        header.version != INVERTED_VERSION) {
+        std::cerr << "Error: " << filename << " is not a version " << INVERTED_VERSION
+                  << " inverted index" << std::endl;
+        return false;
+    }
+    if (header.metric != static_cast<uint32_t>(metric_)) {
+        std::cerr << "Error: " << filename << " was built for a different metric" << std::endl;
+        return false;
+    }
+    if (header.count == 0 || header.count > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+        header.dimension == 0 || header.postings > header.count * header.dimension) {
+        std::cerr << "Error: " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    count_ = static_cast<size_t>(header.count);
+    dimension_ = static_cast<int>(header.dimension);
+    signature_ = header.signature;
+    database_ = nullptr;
+
+    binOffsets_.resize(dimension_ + 1);
+    maxWeights_.resize(dimension_);
+    postingRows_.resize(static_cast<size_t>(header.postings));
+    postingWeights_.resize(static_cast<size_t>(header.postings));
+
+    file.read(reinterpret_cast<char*>(binOffsets_.data()),
+              static_cast<std::streamsize>(binOffsets_.size() * sizeof(uint64_t)));
+    file.read(reinterpret_cast<char*>(maxWeights_.data()),
+              static_cast<std::streamsize>(maxWeights_.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(postingRows_.data()),
+              static_cast<std::streamsize>(postingRows_.size() * sizeof(uint32_t)));
+    file.read(reinterpret_cast<char*>(postingWeights_.data()),
+              static_cast<std::streamsize>(postingWeights_.size() * sizeof(float)));
+
+    bool valid = file.good() && binOffsets_.front() == 0 &&
+                 binOffsets_.back() == postingRows_.size();
+    for (int b = 0; valid && b < dimension_; b++) {
+        valid = binOffsets_[b] <= binOffsets_[b + 1];
+    }
+    for (size_t p = 0; valid && p < postingRows_.size(); p++) {
+        valid = postingRows_[p] < count_ && postingWeights_[p] > 0.0f;
+    }
+
+    if (!valid) {
+        std::cerr << "Error: " << filename << " is truncated or corrupt" << std::endl;
+        count_ = 0;
+        binOffsets_.clear();
+        return false;
+    }
+
+    std::cout << "Loaded " << getIndexName() << " index from: " << filename << " (" << count_
+              << " histograms, " << postingRows_.size() << " postings)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Index name
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string InvertedIndex::getIndexName() const {
+    return "Inverted";
+}
+
+/**
+ * @brief Offsets, bounds and postings memory
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t InvertedIndex::memoryBytes() const {
+    return binOffsets_.size() * sizeof(uint64_t) + maxWeights_.size() * sizeof(float) +
+           postingRows_.size() * sizeof(uint32_t) + postingWeights_.size() * sizeof(float);
+}
+
+/**
+ * @brief Database row as a normalised float32 histogram
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void InvertedIndex::loadHistogram(const FeatureDatabase& database, size_t row, float* out) const {
+    cv::Mat features = database.getFeaturesAt(row);
+    const float* values = features.ptr<float>();
+    std::copy(values, values + dimension_, out);
+    normalizeIfNeeded(out, dimension_);
+}
+
+/**
+ * @brief Dense intersection of one row, as HistogramIntersection::computeBatch()
+ *
+ * @author Krushna Sanjay Sharma
+ */
+double InvertedIndex::rescore(const float* query, size_t row) const {
+    cv::Mat features = database_->getFeaturesAt(row);
+    const float* values = features.ptr<float>();
+
+    float rowSum = 0.0f;
+    float intersection = DistanceKernels::intersection(query, values, dimension_, 1.0f, &rowSum);
+    if (std::abs(rowSum - 1.0f) >= 0.01f && rowSum >= 1e-10f) {
+        intersection = DistanceKernels::intersection(query, values, dimension_, 1.0f / rowSum,
+                                                     nullptr);
+    }
+    return 1.0 - intersection;
+}
+
+} // namespace cbir
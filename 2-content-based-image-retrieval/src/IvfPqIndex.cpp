@@ -0,0 +1,506 @@
+////////////////////////////////////////////////////////////////////////////////
+// IvfPqIndex.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the IVF-PQ index: coarse and product
+//              quantizer training with cv::kmeans, parallel encoding, lookup
+//              table search with optional exact re-ranking, and persistence.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "IvfPqIndex.h"
+#include "DistanceKernels.h"
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <queue>
+
+namespace cbir {
+
+namespace {
+
+const char IVFPQ_MAGIC[8] = {'C', 'B', 'I', 'R', 'I', 'V', 'P', 'Q'};
+const uint32_t IVFPQ_VERSION = 1;
+
+/// Training sample bounds: enough points per centroid, bounded k-means cost
+const int MIN_TRAIN_SAMPLES = 32768;
+const int MAX_TRAIN_SAMPLES = 262144;
+const int SAMPLES_PER_LIST = 32;
+
+/// Largest automatic list count
+const int MAX_AUTO_LISTS = 65536;
+
+/// On-disk header of a saved index
+struct IvfPqHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metric;
+    uint64_t count;
+    uint32_t dimension;
+    uint32_t listCount;
+    uint32_t subquantizers;
+    uint32_t codebookSize;
+    uint32_t probeCount;
+    uint32_t refine;
+    uint64_t signature;
+};
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+IvfPqIndex::IvfPqIndex(AnnMetric metric, int listCount, int subquantizers,
+                       int probeCount, int refine)
+    : AnnIndex(metric), requestedLists_(std::max(0, listCount)),
+      requestedSubquantizers_(std::max(0, subquantizers)), listCount_(0),
+      subquantizers_(0), subDimension_(0), codebookSize_(0),
+      probeCount_(std::max(1, probeCount)), refine_(std::max(1, refine)) {
+}
+
+/**
+ * @brief Train both quantizers and encode every database row
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool IvfPqIndex::build(const FeatureDatabase& database) {
+    if (database.empty()) {
+        std::cerr << "Error: Cannot build IVF-PQ index over an empty database" << std::endl;
+        return false;
+    }
+    if (database.size() >= 0xFFFFFFFFULL) {
+        std::cerr << "Error: IVF-PQ index supports at most 2^32 - 1 rows" << std::endl;
+        return false;
+    }
+
+    const size_t count = database.size();
+    const int dimension = database.dimension();
+
+    // Parameters
+    int lists = requestedLists_;
+    if (lists == 0) {
+        lists = static_cast<int>(std::lround(4.0 * std::sqrt(static_cast<double>(count))));
+        lists = std::min(std::max(lists, 1), MAX_AUTO_LISTS);
+    }
+    lists = static_cast<int>(std::min<size_t>(static_cast<size_t>(lists), count));
+
+    int subquantizers = requestedSubquantizers_;
+    if (subquantizers == 0) {
+        subquantizers = std::min(64, std::max(1, dimension / 8));
+        while (dimension % subquantizers != 0) {
+            subquantizers--;
+        }
+    } else if (dimension % subquantizers != 0) {
+        std::cerr << "Error: " << subquantizers << " subquantizers do not divide dimension "
+                  << dimension << std::endl;
+        return false;
+    }
+
+    count_ = count;
+    dimension_ = dimension;
+    listCount_ = lists;
+    subquantizers_ = subquantizers;
+    subDimension_ = dimension / subquantizers;
+
+    std::cout << "Building IVF-PQ index (" << listCount_ << " lists, " << subquantizers_
+              << " bytes/vector) over " << count_ << " vectors..." << std::endl;
+    int64 startTicks = cv::getTickCount();
+
+    // Evenly strided training sample
+    int sampleCount = static_cast<int>(std::min<size_t>(
+        count, static_cast<size_t>(std::min(MAX_TRAIN_SAMPLES,
+                                            std::max(MIN_TRAIN_SAMPLES, listCount_ * SAMPLES_PER_LIST)))));
+    std::vector<size_t> sampleRows(sampleCount);
+    cv::Mat samples(sampleCount, dimension_, CV_32F);
+    for (int i = 0; i < sampleCount; i++) {
+        sampleRows[i] = static_cast<size_t>(i) * count / sampleCount;
+        loadVector(database, sampleRows[i], samples.ptr<float>(i));
+    }
+
+    // Coarse quantizer
+    std::cout << "  Training coarse quantizer on " << sampleCount << " samples..." << std::endl;
+    cv::Mat coarse;
+    if (!trainCentroids(samples, listCount_, coarse)) {
+        return false;
+    }
+    centroids_.assign(coarse.ptr<float>(), coarse.ptr<float>() + coarse.total());
+
+    // Assign every row to its nearest list
+    std::vector<int> labels(count_);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(count_)), [&](const cv::Range& range) {
+        std::vector<float> vector(dimension_);
+        for (int row = range.start; row < range.end; row++) {
+            loadVector(database, row, vector.data());
+            labels[row] = nearestCentroid(vector.data(), centroids_.data(), listCount_, dimension_);
+        }
+    });
+
+    // Product quantizer trained on sample residuals
+    std::cout << "  Training product quantizer..." << std::endl;
+    cv::Mat residuals(sampleCount, dimension_, CV_32F);
+    for (int i = 0; i < sampleCount; i++) {
+        const float* centroid = &centroids_[static_cast<size_t>(labels[sampleRows[i]]) * dimension_];
+        const float* source = samples.ptr<float>(i);
+        float* residual = residuals.ptr<float>(i);
+        for (int d = 0; d < dimension_; d++) {
+            residual[d] = source[d] - centroid[d];
+        }
+    }
+
+    codebookSize_ = std::min(256, sampleCount);
+    codebooks_.assign(static_cast<size_t>(subquantizers_) * codebookSize_ * subDimension_, 0.0f);
+    for (int j = 0; j < subquantizers_; j++) {
+        cv::Mat subspace = residuals.colRange(j * subDimension_, (j + 1) * subDimension_).clone();
+        cv::Mat centers;
+        if (!trainCentroids(subspace, codebookSize_, centers)) {
+            return false;
+        }
+        std::copy(centers.ptr<float>(), centers.ptr<float>() + centers.total(),
+                  codebooks_.begin() + static_cast<size_t>(j) * codebookSize_ * subDimension_);
+    }
+
+    // Encode residuals of every row
+    std::vector<uint8_t> rowCodes(count_ * subquantizers_);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(count_)), [&](const cv::Range& range) {
+        std::vector<float> residual(dimension_);
+        for (int row = range.start; row < range.end; row++) {
+            loadVector(database, row, residual.data());
+            const float* centroid = &centroids_[static_cast<size_t>(labels[row]) * dimension_];
+            for (int d = 0; d < dimension_; d++) {
+                residual[d] -= centroid[d];
+            }
+            for (int j = 0; j < subquantizers_; j++) {
+                const float* codebook = &codebooks_[static_cast<size_t>(j) * codebookSize_ * subDimension_];
+                rowCodes[static_cast<size_t>(row) * subquantizers_ + j] = static_cast<uint8_t>(
+                    nearestCentroid(&residual[j * subDimension_], codebook, codebookSize_, subDimension_));
+            }
+        }
+    });
+
+    // Group rows by list (counting sort keeps row order within a list)
+    listOffsets_.assign(listCount_ + 1, 0);
+    for (size_t row = 0; row < count_; row++) {
+        listOffsets_[labels[row] + 1]++;
+    }
+    for (int list = 0; list < listCount_; list++) {
+        listOffsets_[list + 1] += listOffsets_[list];
+    }
+    listIds_.resize(count_);
+    codes_.resize(count_ * subquantizers_);
+    std::vector<uint64_t> fill(listOffsets_.begin(), listOffsets_.end() - 1);
+    for (size_t row = 0; row < count_; row++) {
+        uint64_t slot = fill[labels[row]]++;
+        listIds_[slot] = static_cast<uint32_t>(row);
+        std::memcpy(&codes_[slot * subquantizers_], &rowCodes[row * subquantizers_], subquantizers_);
+    }
+
+    signature_ = databaseSignature(database);
+    database_ = &database;
+
+    double seconds = (cv::getTickCount() - startTicks) / cv::getTickFrequency();
+    std::cout << "IVF-PQ index built in " << seconds << " s ("
+              << memoryBytes() / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Attach a loaded index to its database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool IvfPqIndex::attach(const FeatureDatabase& database) {
+    if (listCount_ == 0) {
+        std::cerr << "Error: IVF-PQ index is not loaded" << std::endl;
+        return false;
+    }
+    if (database.size() != count_ || database.dimension() != dimension_ ||
+        databaseSignature(database) != signature_) {
+        std::cerr << "Error: IVF-PQ index does not match the feature database (stale index)"
+                  << std::endl;
+        return false;
+    }
+    database_ = &database;
+    return true;
+}
+
+/**
+ * @brief Probe the nearest lists, score codes with lookup tables, re-rank
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool IvfPqIndex::search(const cv::Mat& query, int k, std::vector<AnnResult>& results) const {
+    results.clear();
+    if (!isReady()) {
+        std::cerr << "Error: IVF-PQ index is not attached to a database" << std::endl;
+        return false;
+    }
+    if (k <= 0) {
+        return true;
+    }
+
+    std::vector<float> rawQuery;
+    if (!prepareQuery(query, rawQuery)) {
+        return false;
+    }
+    const double rawNorm = vectorNorm(rawQuery.data(), dimension_);
+    std::vector<float> q(rawQuery);
+    if (metric_ == AnnMetric::Cosine && rawNorm >= 1e-10) {
+        for (float& value : q) {
+            value = static_cast<float>(value / rawNorm);
+        }
+    }
+
+    // Nearest lists
+    std::vector<std::pair<float, int>> coarse(listCount_);
+    for (int list = 0; list < listCount_; list++) {
+        coarse[list] = std::make_pair(
+            DistanceKernels::squaredDifference(q.data(), &centroids_[static_cast<size_t>(list) * dimension_],
+                                               dimension_), list);
+    }
+    const int probes = std::min(probeCount_, listCount_);
+    std::partial_sort(coarse.begin(), coarse.begin() + probes, coarse.end());
+
+    // Bounded max-heap of PQ estimates
+    const bool rerank = refine_ > 1;
+    const size_t shortlist = static_cast<size_t>(k) * (rerank ? refine_ : 1);
+    std::priority_queue<std::pair<float, uint32_t>> best;
+
+    std::vector<float> residual(dimension_);
+    std::vector<float> table(static_cast<size_t>(subquantizers_) * codebookSize_);
+    for (int p = 0; p < probes; p++) {
+        const int list = coarse[p].second;
+        if (listOffsets_[list] == listOffsets_[list + 1]) {
+            continue;
+        }
+
+        // table[j][c] = || residual_j - codebook_j[c] ||²
+        const float* centroid = &centroids_[static_cast<size_t>(list) * dimension_];
+        for (int d = 0; d < dimension_; d++) {
+            residual[d] = q[d] - centroid[d];
+        }
+        for (int j = 0; j < subquantizers_; j++) {
+            const float* codebook = &codebooks_[static_cast<size_t>(j) * codebookSize_ * subDimension_];
+            for (int c = 0; c < codebookSize_; c++) {
+                table[static_cast<size_t>(j) * codebookSize_ + c] = DistanceKernels::squaredDifference(
+                    &residual[j * subDimension_], codebook + static_cast<size_t>(c) * subDimension_,
+                    subDimension_);
+            }
+        }
+
+        for (uint64_t entry = listOffsets_[list]; entry < listOffsets_[list + 1]; entry++) {
+            const uint8_t* code = &codes_[entry * subquantizers_];
+            float distance = 0.0f;
+            for (int j = 0; j < subquantizers_; j++) {
+                distance += table[static_cast<size_t>(j) * codebookSize_ + code[j]];
+            }
+            if (best.size() < shortlist) {
+                best.emplace(distance, listIds_[entry]);
+            } else if (distance < best.top().first) {
+                best.pop();
+                best.emplace(distance, listIds_[entry]);
+            }
+        }
+    }
+
+    std::vector<AnnResult> candidates;
+    candidates.reserve(best.size());
+    while (!best.empty()) {
+        std::pair<float, uint32_t> top = best.top();
+        best.pop();
+
+        double distance = top.first;
+        if (rerank) {
+            cv::Mat row = database_->getFeaturesAt(top.second);
+            const float* values = row.ptr<float>();
+            distance = exactDistance(rawQuery.data(), rawNorm, values, vectorNorm(values, dimension_));
+        } else if (metric_ == AnnMetric::Cosine) {
+            // Unit vectors: ||a - b||² = 2 - 2 cos
+            distance *= 0.5;
+        }
+        candidates.emplace_back(distance, static_cast<int>(top.second));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    if (candidates.size() > static_cast<size_t>(k)) {
+        candidates.resize(k);
+    }
+    results.swap(candidates);
+    return true;
+}
+
+/**
+ * @brief Save quantizers, lists and codes
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool IvfPqIndex::save(const std::string& filename) const {
+    if (listCount_ == 0) {
+        std::cerr << "Error: No IVF-PQ index to save" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << filename << std::endl;
+        return false;
+    }
+
+    IvfPqHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, IVFPQ_MAGIC, sizeof(IVFPQ_MAGIC));
+    header.version = IVFPQ_VERSION;
+    header.metric = static_cast<uint32_t>(metric_);
+    header.count = count_;
+    header.dimension = static_cast<uint32_t>(dimension_);
+    header.listCount = static_cast<uint32_t>(listCount_);
+    header.subquantizers = static_cast<uint32_t>(subquantizers_);
+    header.codebookSize = static_cast<uint32_t>(codebookSize_);
+    header.probeCount = static_cast<uint32_t>(probeCount_);
+    header.refine = static_cast<uint32_t>(refine_);
+    header.signature = signature_;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(centroids_.data()),
+               static_cast<std::streamsize>(centroids_.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(codebooks_.data()),
+               static_cast<std::streamsize>(codebooks_.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(listOffsets_.data()),
+               static_cast<std::streamsize>(listOffsets_.size() * sizeof(uint64_t)));
+    file.write(reinterpret_cast<const char*>(listIds_.data()),
+               static_cast<std::streamsize>(listIds_.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(codes_.data()),
+               static_cast<std::streamsize>(codes_.size()));
+
+    if (!file.good()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Saved IVF-PQ index to: " << filename << std::endl;
+    return true;
+}
+
+/**
+ * @brief Load a saved index and validate its lists
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool IvfPqIndex::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IvfPqHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() || std::memcmp(header.magic, IVFPQ_MAGIC, sizeof(IVFPQ_MAGIC)) != 0 ||
+        header.version != IVFPQ_VERSION) {
+        std::cerr << "Error: " << filename << " is not a version " << IVFPQ_VERSION
+                  << " IVF-PQ index" << std::endl;
+        return false;
+    }
+    if (header.metric != static_cast<uint32_t>(metric_)) {
+        std::cerr << "Error: " << filename << " was built for a different metric" << std::endl;
+        return false;
+    }
+    if (header.count == 0 || header.count >= 0xFFFFFFFFULL || header.dimension == 0 ||
+        header.listCount == 0 || header.listCount > header.count ||
+        header.subquantizers == 0 || header.dimension % header.subquantizers != 0 ||
+        header.codebookSize == 0 || header.codebookSize > 256) {
+        std::cerr << "Error: " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    count_ = static_cast<size_t>(header.count);
+    dimension_ = static_cast<int>(header.dimension);
+    listCount_ = static_cast<int>(header.listCount);
+    subquantizers_ = static_cast<int>(header.subquantizers);
+    subDimension_ = dimension_ / subquantizers_;
+    codebookSize_ = static_cast<int>(header.codebookSize);
+    probeCount_ = std::max(1, static_cast<int>(header.probeCount));
+    refine_ = std::max(1, static_cast<int>(header.refine));
+    signature_ = header.signature;
+    database_ = nullptr;
+
+    centroids_.resize(static_cast<size_t>(listCount_) * dimension_);
+    codebooks_.resize(static_cast<size_t>(subquantizers_) * codebookSize_ * subDimension_);
+    listOffsets_.resize(listCount_ + 1);
+    listIds_.resize(count_);
+    codes_.resize(count_ * subquantizers_);
+
+    file.read(reinterpret_cast<char*>(centroids_.data()),
+              static_cast<std::streamsize>(centroids_.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(codebooks_.data()),
+              static_cast<std::streamsize>(codebooks_.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(listOffsets_.data()),
+              static_cast<std::streamsize>(listOffsets_.size() * sizeof(uint64_t)));
+    file.read(reinterpret_cast<char*>(listIds_.data()),
+              static_cast<std::streamsize>(listIds_.size() * sizeof(uint32_t)));
+    file.read(reinterpret_cast<char*>(codes_.data()),
+              static_cast<std::streamsize>(codes_.size()));
+
+    bool valid = file.good() && listOffsets_.front() == 0 && listOffsets_.back() == count_;
+    for (int list = 0; valid && list < listCount_; list++) {
+        valid = listOffsets_[list] <= listOffsets_[list + 1];
+    }
+    for (size_t i = 0; valid && i < count_; i++) {
+        valid = listIds_[i] < count_;
+    }
+    for (size_t i = 0; valid && i < codes_.size(); i++) {
+        valid = codes_[i] < codebookSize_;
+    }
+
+    if (!valid) {
+        std::cerr << "Error: " << filename << " is truncated or corrupt" << std::endl;
+        count_ = 0;
+        listCount_ = 0;
+        return false;
+    }
+
+    std::cout << "Loaded IVF-PQ index from: " << filename << " (" << count_
+              << " vectors)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Index name
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string IvfPqIndex::getIndexName() const {
+    return "IVF-PQ";
+}
+
+/**
+ * @brief Quantizer, list and code memory
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t IvfPqIndex::memoryBytes() const {
+    return (centroids_.size() + codebooks_.size()) * sizeof(float) +
+           listOffsets_.size() * sizeof(uint64_t) + listIds_.size() * sizeof(uint32_t) +
+           codes_.size();
+}
+
+/**
+ * @brief Database row as float32, unit length for cosine
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void IvfPqIndex::loadVector(const FeatureDatabase& database, size_t row, float* out) const {
+    cv::Mat features = database.getFeaturesAt(row);
+    const float* values = features.ptr<float>();
+    std::copy(values, values + dimension_, out);
+
+    if (metric_ == AnnMetric::Cosine) {
+        double norm = vectorNorm(out, dimension_);
+        if (norm >= 1e-10) {
+            for (int d = 0; d < dimension_; d++) {
+                out[d] = static_cast<float>(out[d] / norm);
+            }
+        }
+    }
+}
+
+} // namespace cbir
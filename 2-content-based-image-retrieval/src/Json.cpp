@@ -0,0 +1,491 @@
+////////////////////////////////////////////////////////////////////////////////
+// Json.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the minimal JSON value, recursive-descent
+//              parser and compact serialiser.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Json.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace cbir {
+
+namespace {
+
+/// Deepest array/object nesting accepted from a client
+const int MAX_DEPTH = 64;
+
+/// Shared value returned by failed lookups
+const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+
+void appendUtf8(std::string& out, unsigned codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+void appendQuoted(std::string& out, const std::string& text) {
+    out += '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * Recursive-descent parser over the input text
+ */
+class Parser {
+public:
+    explicit Parser(const std::string& text) : text_(text), pos_(0) {}
+
+    bool parseDocument(JsonValue& out, std::string* error) {
+        bool ok = parseValue(out, 0);
+        skipWhitespace();
+        if (ok && pos_ != text_.size()) {
+            ok = fail("Trailing characters");
+        }
+        if (!ok && error != nullptr) {
+            *error = message_ + " at offset " + std::to_string(pos_);
+        }
+        return ok;
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_;
+    std::string message_;
+
+    bool fail(const char* message) {
+        if (message_.empty()) {
+            message_ = message;
+        }
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t length = 0;
+        while (literal[length] != '\0') {
+            length++;
+        }
+        if (text_.compare(pos_, length, literal) != 0) {
+            return false;
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out, int depth) {
+        skipWhitespace();
+        if (pos_ >= text_.size()) {
+            return fail("Unexpected end of input");
+        }
+
+        const char c = text_[pos_];
+        if (c == '{' || c == '[') {
+            if (depth >= MAX_DEPTH) {
+                return fail("Nesting too deep");
+            }
+            return c == '{' ? parseObject(out, depth + 1) : parseArray(out, depth + 1);
+        }
+        if (c == '"') {
+            std::string text;
+            if (!parseString(text)) {
+                return false;
+            }
+            out = JsonValue(text);
+            return true;
+        }
+        if (consume("true")) {
+            out = JsonValue(true);
+            return true;
+        }
+        if (consume("false")) {
+            out = JsonValue(false);
+            return true;
+        }
+        if (consume("null")) {
+            out = JsonValue();
+            return true;
+        }
+        return parseNumber(out);
+    }
+
+    bool parseObject(JsonValue& out, int depth) {
+        out = JsonValue::object();
+        pos_++;  // '{'
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            pos_++;
+            return true;
+        }
+
+        while (true) {
+            skipWhitespace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                return fail("Expected member name");
+            }
+            std::string key;
+            if (!parseString(key)) {
+                return false;
+            }
+            skipWhitespace();
+            if (pos_ >= text_.size() || text_[pos_] != ':') {
+                return fail("Expected ':'");
+            }
+            pos_++;
+
+            JsonValue member;
+            if (!parseValue(member, depth)) {
+                return false;
+            }
+            out.set(key, std::move(member));
+
+            skipWhitespace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                pos_++;
+            } else if (pos_ < text_.size() && text_[pos_] == '}') {
+                pos_++;
+                return true;
+            } else {
+                return fail("Expected ',' or '}'");
+            }
+        }
+    }
+
+    bool parseArray(JsonValue& out, int depth) {
+        out = JsonValue::array();
+        pos_++;  // '['
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            pos_++;
+            return true;
+        }
+
+        while (true) {
+            JsonValue item;
+            if (!parseValue(item, depth)) {
+                return false;
+            }
+            out.push(std::move(item));
+
+            skipWhitespace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                pos_++;
+            } else if (pos_ < text_.size() && text_[pos_] == ']') {
+                pos_++;
+                return true;
+            } else {
+                return fail("Expected ',' or ']'");
+            }
+        }
+    }
+
+    bool parseHex4(unsigned& value) {
+        if (pos_ + 4 > text_.size()) {
+            return fail("Truncated \\u escape");
+        }
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            const char c = text_[pos_++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                return fail("Invalid \\u escape");
+            }
+        }
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        pos_++;  // opening quote
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail("Control character in string");
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if (pos_ >= text_.size()) {
+                break;
+            }
+            const char escape = text_[pos_++];
+            switch (escape) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned codePoint;
+                    if (!parseHex4(codePoint)) {
+                        return false;
+                    }
+                    // Surrogate pair for characters outside the BMP
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && consume("\\u")) {
+                        unsigned low;
+                        if (!parseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                            return fail("Invalid surrogate pair");
+                        }
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default:
+                    return fail("Invalid escape");
+            }
+        }
+        return fail("Unterminated string");
+    }
+
+    bool parseNumber(JsonValue& out) {
+        const size_t start = pos_;
+        if (pos_ < text_.size() && text_[pos_] == '-') {
+            pos_++;
+        }
+        while (pos_ < text_.size() &&
+               ((text_[pos_] >= '0' && text_[pos_] <= '9') || text_[pos_] == '.' ||
+                text_[pos_] == 'e' || text_[pos_] == 'E' ||
+                text_[pos_] == '+' || text_[pos_] == '-')) {
+            pos_++;
+        }
+        if (pos_ == start) {
+            return fail("Unexpected character");
+        }
+
+        const std::string token = text_.substr(start, pos_ - start);
+        char* end = nullptr;
+        const double value = std::strtod(token.c_str(), &end);
+        if (end != token.c_str() + token.size()) {
+            pos_ = start;
+            return fail("Invalid number");
+        }
+        out = JsonValue(value);
+        return true;
+    }
+};
+
+} // namespace
+
+JsonValue::JsonValue() : type_(Type::Null), bool_(false), number_(0.0) {}
+
+JsonValue::JsonValue(bool value) : type_(Type::Bool), bool_(value), number_(0.0) {}
+
+JsonValue::JsonValue(double value) : type_(Type::Number), bool_(false), number_(value) {}
+
+JsonValue::JsonValue(int value)
+    : type_(Type::Number), bool_(false), number_(static_cast<double>(value)) {}
+
+JsonValue::JsonValue(long long value)
+    : type_(Type::Number), bool_(false), number_(static_cast<double>(value)) {}
+
+JsonValue::JsonValue(const char* value)
+    : type_(Type::String), bool_(false), number_(0.0), string_(value) {}
+
+JsonValue::JsonValue(const std::string& value)
+    : type_(Type::String), bool_(false), number_(0.0), string_(value) {}
+
+JsonValue JsonValue::array() {
+    JsonValue value;
+    value.type_ = Type::Array;
+    return value;
+}
+
+JsonValue JsonValue::object() {
+    JsonValue value;
+    value.type_ = Type::Object;
+    return value;
+}
+
+bool JsonValue::asBool(bool fallback) const {
+    return type_ == Type::Bool ? bool_ : fallback;
+}
+
+double JsonValue::asNumber(double fallback) const {
+    return type_ == Type::Number ? number_ : fallback;
+}
+
+std::string JsonValue::asString(const std::string& fallback) const {
+    return type_ == Type::String ? string_ : fallback;
+}
+
+size_t JsonValue::size() const {
+    if (type_ == Type::Array) {
+        return items_.size();
+    }
+    return type_ == Type::Object ? members_.size() : 0;
+}
+
+const JsonValue& JsonValue::at(size_t index) const {
+    if (type_ != Type::Array || index >= items_.size()) {
+        return nullValue();
+    }
+    return items_[index];
+}
+
+const JsonValue& JsonValue::get(const std::string& key) const {
+    if (type_ == Type::Object) {
+        for (const auto& member : members_) {
+            if (member.first == key) {
+                return member.second;
+            }
+        }
+    }
+    return nullValue();
+}
+
+bool JsonValue::has(const std::string& key) const {
+    if (type_ == Type::Object) {
+        for (const auto& member : members_) {
+            if (member.first == key) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void JsonValue::push(JsonValue value) {
+    if (type_ == Type::Null) {
+        type_ = Type::Array;
+    }
+    if (type_ == Type::Array) {
+        items_.push_back(std::move(value));
+    }
+}
+
+void JsonValue::set(const std::string& key, JsonValue value) {
+    if (type_ == Type::Null) {
+        type_ = Type::Object;
+    }
+    if (type_ != Type::Object) {
+        return;
+    }
+    for (auto& member : members_) {
+        if (member.first == key) {
+            member.second = std::move(value);
+            return;
+        }
+    }
+    members_.emplace_back(key, std::move(value));
+}
+
+std::string JsonValue::dump() const {
+    std::string out;
+    dumpTo(out);
+    return out;
+}
+
+void JsonValue::dumpTo(std::string& out) const {
+    switch (type_) {
+        case Type::Null:
+            out += "null";
+            break;
+        case Type::Bool:
+            out += bool_ ? "true" : "false";
+            break;
+        case Type::Number:
+            if (std::isfinite(number_)) {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%.10g", number_);
+                out += buffer;
+            } else {
+                out += "null";
+            }
+            break;
+        case Type::String:
+            appendQuoted(out, string_);
+            break;
+        case Type::Array:
+            out += '[';
+            for (size_t i = 0; i < items_.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                items_[i].dumpTo(out);
+            }
+            out += ']';
+            break;
+        case Type::Object:
+            out += '{';
+            for (size_t i = 0; i < members_.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                appendQuoted(out, members_[i].first);
+                out += ':';
+                members_[i].second.dumpTo(out);
+            }
+            out += '}';
+            break;
+    }
+}
+
+bool JsonValue::parse(const std::string& text, JsonValue& out, std::string* error) {
+    Parser parser(text);
+    JsonValue value;
+    if (!parser.parseDocument(value, error)) {
+        return false;
+    }
+    out = std::move(value);
+    return true;
+}
+
+} // namespace cbir
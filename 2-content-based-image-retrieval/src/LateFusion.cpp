@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// LateFusion.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the late-fusion segment scan.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LateFusion.h"
+#include "DistanceKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cbir {
+
+namespace {
+
+/// Float kernels may put Σ min(q, r) slightly above the float Σ q
+const double INTERSECTION_BOUND_SLACK = 1e-4;
+
+/**
+ * Relative cost per element: Euclidean and Intersection make one pass with
+ * one accumulator, Cosine accumulates a dot product and a squared norm
+ */
+int segmentCost(const LateFusion::Segment& segment) {
+    return segment.length * (segment.kind == LateFusion::SEGMENT_COSINE ? 2 : 1);
+}
+
+} // namespace
+
+LateFusion::LateFusion(const std::vector<Segment>& segments)
+    : segments_(segments) {
+    std::stable_sort(segments_.begin(), segments_.end(),
+                     [](const Segment& a, const Segment& b) {
+        return segmentCost(a) < segmentCost(b);
+    });
+    for (const Segment& segment : segments_) {
+        dimension_ = std::max(dimension_, segment.start + segment.length);
+    }
+}
+
+void LateFusion::prepare(const float* query, Query& prepared) const {
+    const size_t count = segments_.size();
+    prepared.data = query;
+    prepared.norms.assign(count, 0.0);
+    prepared.lowerBounds.assign(count + 1, 0.0);
+
+    std::vector<double> bounds(count, 0.0);
+    for (size_t i = 0; i < count; i++) {
+        const Segment& segment = segments_[i];
+        const float* data = query + segment.start;
+        if (segment.kind == SEGMENT_COSINE) {
+            float dot = 0.0f;
+            float squares = 0.0f;
+            DistanceKernels::dotAndSquares(data, data, segment.length, &dot, &squares);
+            prepared.norms[i] = std::sqrt(static_cast<double>(squares));
+        } else if (segment.kind == SEGMENT_INTERSECTION) {
+            // min(q, r) <= q, whatever the row
+            bounds[i] = 1.0 - DistanceKernels::sum(data, segment.length) - INTERSECTION_BOUND_SLACK;
+        }
+    }
+
+    // Suffix sums: what the segments not scored yet add at least
+    for (size_t i = count; i-- > 0;) {
+        prepared.lowerBounds[i] = prepared.lowerBounds[i + 1] + segments_[i].weight * bounds[i];
+    }
+}
+
+double LateFusion::segmentDistance(const Query& query, size_t index, const float* row) const {
+    const Segment& segment = segments_[index];
+    const float* a = query.data + segment.start;
+    const float* b = row + segment.start;
+
+    switch (segment.kind) {
+        case SEGMENT_COSINE: {
+            float dot = 0.0f;
+            float rowSquares = 0.0f;
+            DistanceKernels::dotAndSquares(a, b, segment.length, &dot, &rowSquares);
+            const double queryNorm = query.norms[index];
+            const double rowNorm = std::sqrt(static_cast<double>(rowSquares));
+            if (queryNorm < 1e-10 || rowNorm < 1e-10) {
+                return 1.0;
+            }
+            double cosine = dot / (queryNorm * rowNorm);
+            cosine = std::max(-1.0, std::min(1.0, cosine));
+            return 1.0 - cosine;
+        }
+        case SEGMENT_INTERSECTION:
+            return 1.0 - DistanceKernels::intersection(a, b, segment.length, 1.0f, nullptr);
+        case SEGMENT_EUCLIDEAN:
+            return std::sqrt(static_cast<double>(
+                DistanceKernels::squaredDifference(a, b, segment.length)));
+    }
+    return 0.0;
+}
+
+double LateFusion::score(const Query& query, const float* row) const {
+    double total = 0.0;
+    for (size_t i = 0; i < segments_.size(); i++) {
+        total += segments_[i].weight * segmentDistance(query, i, row);
+    }
+    return total;
+}
+
+double LateFusion::scoreWithCutoff(const Query& query, const float* row, double cutoff) const {
+    double total = 0.0;
+    for (size_t i = 0; i < segments_.size(); i++) {
+        if (total + query.lowerBounds[i] > cutoff) {
+            return std::numeric_limits<double>::infinity();
+        }
+        total += segments_[i].weight * segmentDistance(query, i, row);
+    }
+    return total;
+}
+
+} // namespace cbir
@@ -0,0 +1,472 @@
+////////////////////////////////////////////////////////////////////////////////
+// LiveDatabase.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the copy-on-write live database: staging,
+//              publishing segments with dead-row masks, snapshot swaps,
+//              compaction and chunked background loading of CSV files.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LiveDatabase.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <iostream>
+
+namespace cbir {
+
+size_t DatabaseSnapshot::size() const {
+    size_t count = 0;
+    for (const DatabaseSegment& segment : segments) {
+        count += segment.live();
+    }
+    return count;
+}
+
+cv::Mat DatabaseSnapshot::getFeatures(const std::string& imageName) const {
+    for (auto segment = segments.rbegin(); segment != segments.rend(); ++segment) {
+        const int row = segment->rows->indexOf(imageName);
+        if (row >= 0 && !segment->isDead(static_cast<size_t>(row))) {
+            return segment->rows->getFeaturesAt(static_cast<size_t>(row));
+        }
+    }
+    return cv::Mat();
+}
+
+/**
+ * @class LiveDatabase::ChunkReader
+ * @brief Reads a CSV body in line-aligned chunks ahead of the parser
+ *
+ * A thread reads chunkBytes at a time with sequential reads and queues up
+ * to readAhead chunks; a partial last line is carried into the next chunk,
+ * so every chunk holds whole lines.
+ */
+class LiveDatabase::ChunkReader {
+public:
+    explicit ChunkReader(const AsyncLoadOptions& options)
+        : chunkBytes_(std::max<size_t>(options.chunkBytes, 4096)),
+          readAhead_(std::max<size_t>(options.readAhead, 1)) {
+    }
+
+    ~ChunkReader() { stop(); }
+
+    /// Open the file, skip the header line and start reading
+    bool open(const std::string& filename) {
+        file_.open(filename, std::ios::binary);
+        if (!file_.is_open()) {
+            return false;
+        }
+        file_.seekg(0, std::ios::end);
+        const std::streamoff size = file_.tellg();
+        file_.seekg(0, std::ios::beg);
+        std::string header;
+        std::getline(file_, header);
+        bodyBytes_ = file_ ? static_cast<uint64_t>(size - file_.tellg()) : 0;
+        thread_ = std::thread(&ChunkReader::readLoop, this);
+        return true;
+    }
+
+    /// Next chunk in file order; false once the file is exhausted
+    bool next(std::vector<char>& chunk) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this]() { return !chunks_.empty() || finished_; });
+        if (chunks_.empty()) {
+            return false;
+        }
+        chunk.swap(chunks_.front());
+        chunks_.pop_front();
+        space_.notify_one();
+        return true;
+    }
+
+    /// Stop reading and join the thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        space_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool failed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_;
+    }
+
+    uint64_t bodyBytes() const { return bodyBytes_; }
+
+private:
+    const size_t chunkBytes_;
+    const size_t readAhead_;
+    std::ifstream file_;
+    uint64_t bodyBytes_ = 0;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<std::vector<char>> chunks_;
+    bool finished_ = false;
+    bool stopping_ = false;
+    bool failed_ = false;
+
+    void readLoop() {
+        std::vector<char> carry;
+        bool more = true;
+        while (more) {
+            std::vector<char> buffer;
+            buffer.reserve(carry.size() + chunkBytes_);
+            buffer.assign(carry.begin(), carry.end());
+            carry.clear();
+            const size_t kept = buffer.size();
+            buffer.resize(kept + chunkBytes_);
+            file_.read(buffer.data() + kept, static_cast<std::streamsize>(chunkBytes_));
+            buffer.resize(kept + static_cast<size_t>(file_.gcount()));
+            if (file_.bad()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                failed_ = true;
+                break;
+            }
+            more = !file_.eof();
+            if (more) {
+                // Whole lines only; the partial last line starts the next chunk
+                auto newline = std::find(buffer.rbegin(), buffer.rend(), '\n');
+                const size_t cut = static_cast<size_t>(buffer.rend() - newline);
+                carry.assign(buffer.begin() + cut, buffer.end());
+                buffer.resize(cut);
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_.wait(lock, [this]() { return chunks_.size() < readAhead_ || stopping_; });
+            if (stopping_) {
+                break;
+            }
+            if (!buffer.empty()) {
+                chunks_.push_back(std::move(buffer));
+                ready_.notify_one();
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        ready_.notify_all();
+    }
+};
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+LiveDatabase::LiveDatabase(size_t maxSegments)
+    : maxSegments_(std::max<size_t>(1, maxSegments)),
+      current_(std::make_shared<DatabaseSnapshot>()),
+      cancelLoad_(false) {
+}
+
+LiveDatabase::~LiveDatabase() {
+    cancelLoad();
+}
+
+/**
+ * @brief Load a file as the only segment
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool LiveDatabase::load(const std::string& filename) {
+    cancelLoad();
+    auto base = std::make_shared<FeatureDatabase>();
+    if (!base->load(filename)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    staged_.clear();
+    auto next = std::make_shared<DatabaseSnapshot>();
+    next->version = snapshot()->version + 1;
+    next->dimension = base->dimension();
+    if (!base->empty()) {
+        DatabaseSegment segment;
+        segment.rows = base;
+        next->segments.push_back(segment);
+    }
+    store(next);
+    return true;
+}
+
+/**
+ * @brief Start streaming a CSV file in as segments
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool LiveDatabase::loadAsync(const std::string& filename, const AsyncLoadOptions& options) {
+    if (FeatureDatabase::isBinaryFile(filename)) {
+        return load(filename);
+    }
+    cancelLoad();
+    auto reader = std::make_shared<ChunkReader>(options);
+    if (!reader->open(filename)) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        staged_.clear();
+        auto next = std::make_shared<DatabaseSnapshot>();
+        next->version = snapshot()->version + 1;
+        next->readiness = 0.0;
+        store(next);
+    }
+    {
+        std::lock_guard<std::mutex> lock(loadMutex_);
+        loading_ = true;
+        loadSucceeded_ = true;
+    }
+    cancelLoad_ = false;
+    loader_ = std::thread([this, reader]() { streamChunks(*reader); });
+    return true;
+}
+
+/**
+ * @brief Parse every chunk and publish it as a segment
+ *
+ * Chunks are parsed with Utils::parseFeaturesCSV() (itself parallel) in
+ * file order while the reader fetches the next ones. Each published
+ * snapshot adds one segment and raises readiness to the fraction of the
+ * body consumed; the last one is complete.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void LiveDatabase::streamChunks(ChunkReader& reader) {
+    const double total = static_cast<double>(std::max<uint64_t>(1, reader.bodyBytes()));
+    uint64_t consumed = 0;
+    size_t nextLine = 2;   // line 1 is the header
+    int dimension = 0;
+    std::vector<char> chunk;
+    while (!cancelLoad_ && reader.next(chunk)) {
+        Utils::PackedFeatureRows rows;
+        rows.dimension = dimension;
+        size_t lines = 0;
+        Utils::parseFeaturesCSV(chunk.data(), chunk.data() + chunk.size(), nextLine, rows,
+                                &lines);
+        nextLine += lines;
+        consumed += chunk.size();
+        dimension = rows.dimension;
+        auto rowsDatabase = std::make_shared<FeatureDatabase>();
+        const bool hasRows = rowsDatabase->loadFromRows(rows);
+
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        auto next = std::make_shared<DatabaseSnapshot>(*snapshot());
+        next->version++;
+        next->readiness = std::min(1.0, consumed / total);
+        if (hasRows) {
+            DatabaseSegment segment;
+            segment.rows = rowsDatabase;
+            next->segments.push_back(segment);
+            next->dimension = dimension;
+        }
+        store(next);
+    }
+    reader.stop();
+
+    const bool succeeded = !cancelLoad_ && !reader.failed();
+    if (reader.failed()) {
+        std::cerr << "Error: Read error while streaming a feature database, "
+                  << "only part of it is loaded" << std::endl;
+    }
+    if (succeeded && !snapshot()->complete()) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        auto next = std::make_shared<DatabaseSnapshot>(*snapshot());
+        next->version++;
+        next->readiness = 1.0;
+        store(next);
+    }
+    {
+        std::lock_guard<std::mutex> lock(loadMutex_);
+        loading_ = false;
+        loadSucceeded_ = succeeded;
+    }
+    loadDone_.notify_all();
+}
+
+bool LiveDatabase::isLoading() const {
+    std::lock_guard<std::mutex> lock(loadMutex_);
+    return loading_;
+}
+
+bool LiveDatabase::waitForLoad() {
+    std::unique_lock<std::mutex> lock(loadMutex_);
+    loadDone_.wait(lock, [this]() { return !loading_; });
+    return loadSucceeded_;
+}
+
+void LiveDatabase::cancelLoad() {
+    cancelLoad_ = true;
+    if (loader_.joinable()) {
+        loader_.join();
+    }
+    cancelLoad_ = false;
+}
+
+std::shared_ptr<const DatabaseSnapshot> LiveDatabase::snapshot() const {
+    return std::atomic_load(&current_);
+}
+
+bool LiveDatabase::put(const std::string& imageName, const cv::Mat& features) {
+    if (features.empty()) {
+        std::cerr << "Error: Empty feature vector for " << imageName << std::endl;
+        return false;
+    }
+    cv::Mat continuous = features.isContinuous() ? features : features.clone();
+    cv::Mat row;
+    continuous.reshape(1, 1).convertTo(row, CV_32F);
+
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    int dimension = snapshot()->dimension;
+    for (const auto& staged : staged_) {
+        if (dimension > 0) {
+            break;
+        }
+        dimension = staged.second.cols;
+    }
+    if (dimension > 0 && row.cols != dimension) {
+        std::cerr << "Error: Feature dimension " << row.cols << " for " << imageName
+                  << " does not match database dimension " << dimension << std::endl;
+        return false;
+    }
+    staged_[Utils::getFilename(imageName)] = row;
+    return true;
+}
+
+void LiveDatabase::remove(const std::string& imageName) {
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    staged_[Utils::getFilename(imageName)] = cv::Mat();
+}
+
+size_t LiveDatabase::pending() const {
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    return staged_.size();
+}
+
+/**
+ * @brief Build the next snapshot from the current one plus staged changes
+ *
+ * Older segments are shared with the current snapshot; a dead mask is
+ * copied at most once per publish, the first time one of its rows is
+ * superseded. Segments left without live rows are dropped.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint64_t LiveDatabase::publish() {
+    waitForLoad();
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    std::shared_ptr<const DatabaseSnapshot> current = snapshot();
+    if (staged_.empty()) {
+        return current->version;
+    }
+
+    auto next = std::make_shared<DatabaseSnapshot>(*current);
+    next->version = current->version + 1;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> copied(next->segments.size());
+    auto added = std::make_shared<FeatureDatabase>();
+
+    for (const auto& staged : staged_) {
+        // At most one segment holds a live row for the name
+        for (size_t s = 0; s < next->segments.size(); s++) {
+            DatabaseSegment& segment = next->segments[s];
+            const int row = segment.rows->indexOf(staged.first);
+            if (row < 0 || segment.isDead(static_cast<size_t>(row))) {
+                continue;
+            }
+            if (copied[s] == nullptr) {
+                copied[s] = segment.dead != nullptr
+                    ? std::make_shared<std::vector<uint8_t>>(*segment.dead)
+                    : std::make_shared<std::vector<uint8_t>>(segment.rows->size(), 0);
+                segment.dead = copied[s];
+            }
+            (*copied[s])[static_cast<size_t>(row)] = 1;
+            segment.deadCount++;
+            break;
+        }
+        if (!staged.second.empty()) {
+            added->addFeatures(staged.first, staged.second);
+        }
+    }
+    staged_.clear();
+
+    std::vector<DatabaseSegment> kept;
+    kept.reserve(next->segments.size() + 1);
+    for (const DatabaseSegment& segment : next->segments) {
+        if (segment.live() > 0) {
+            kept.push_back(segment);
+        }
+    }
+    if (!added->empty()) {
+        DatabaseSegment segment;
+        segment.rows = added;
+        kept.push_back(segment);
+        next->dimension = added->dimension();
+    }
+    next->segments.swap(kept);
+
+    if (next->segments.size() > maxSegments_) {
+        std::shared_ptr<DatabaseSnapshot> merged = merge(*next);
+        merged->version = next->version;
+        next = merged;
+    }
+    store(next);
+    return next->version;
+}
+
+/**
+ * @brief Merge and publish under the writer lock
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void LiveDatabase::compact() {
+    waitForLoad();
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    std::shared_ptr<const DatabaseSnapshot> current = snapshot();
+    if (current->segments.size() <= 1 &&
+        (current->segments.empty() || current->segments.front().deadCount == 0)) {
+        return;
+    }
+    std::shared_ptr<DatabaseSnapshot> merged = merge(*current);
+    merged->version = current->version + 1;
+    store(merged);
+}
+
+void LiveDatabase::store(std::shared_ptr<const DatabaseSnapshot> snapshot) {
+    std::atomic_store(&current_, std::move(snapshot));
+}
+
+/**
+ * @brief Copy every live row into one new in-memory segment
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::shared_ptr<DatabaseSnapshot> LiveDatabase::merge(const DatabaseSnapshot& snapshot) {
+    auto rows = std::make_shared<FeatureDatabase>();
+    for (const DatabaseSegment& segment : snapshot.segments) {
+        for (size_t row = 0; row < segment.rows->size(); row++) {
+            if (!segment.isDead(row)) {
+                rows->addFeatures(segment.rows->getName(row), segment.rows->getFeaturesAt(row));
+            }
+        }
+    }
+
+    auto merged = std::make_shared<DatabaseSnapshot>();
+    merged->dimension = snapshot.dimension;
+    if (!rows->empty()) {
+        DatabaseSegment segment;
+        segment.rows = rows;
+        merged->segments.push_back(segment);
+    }
+    return merged;
+}
+
+} // namespace cbir
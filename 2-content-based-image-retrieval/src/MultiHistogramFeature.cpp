@@ -6,10 +6,10 @@
 //              and concatenates them into a single feature vector.
 //
 // Process:
-//   1. Split image into regions (top/bottom, left/right, or grid)
-//   2. Compute histogram for each region using HistogramFeature
-//   3. Concatenate all region histograms into single feature vector
-//   4. Return combined feature vector
+//   1. Split image into regions (top/bottom, left/right, grid, or pyramid)
+//   2. Bin every pixel once and build an integral histogram
+//   3. Read each region's histogram from the integral histogram
+//   4. Return the concatenated feature vector
 //
 // Example with 2 horizontal regions (top/bottom):
 //   - Top half histogram:    512 values
@@ -22,10 +22,21 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "MultiHistogramFeature.h"
+#include "ImageContext.h"
+#include "IntegralHistogram.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace cbir {
 
+namespace {
+
+/// Deepest pyramid (1 + 4 + 16 + 64 = 85 regions)
+const int MAX_PYRAMID_LEVELS = 4;
+
+} // namespace
+
 /**
  * Default constructor
  * Creates 2 horizontal regions (top/bottom) with RGB histograms
@@ -35,7 +46,8 @@ MultiHistogramFeature::MultiHistogramFeature()
       numRegions_(2),
       histType_(HistogramFeature::HistogramType::RGB),
       binsPerChannel_(8),
-      normalize_(true) {
+      normalize_(true),
+      useGpu_(false) {
     
     // Initialize equal weights for all regions
     initializeWeights();
@@ -53,7 +65,8 @@ MultiHistogramFeature::MultiHistogramFeature(SplitType splitType,
       numRegions_(numRegions),
       histType_(histType),
       binsPerChannel_(binsPerChannel),
-      normalize_(normalize) {
+      normalize_(normalize),
+      useGpu_(false) {
     
     // Validate number of regions
     if (numRegions_ < 1) {
@@ -69,10 +82,10 @@ MultiHistogramFeature::MultiHistogramFeature(SplitType splitType,
  * Extract multi-region histogram features
  * 
  * Process:
- *   1. Split image into regions based on configuration
- *   2. Create histogram extractor for region histograms
- *   3. Extract histogram from each region
- *   4. Concatenate all histograms into single feature vector
+ *   1. Bin every pixel once (same bins as HistogramFeature)
+ *   2. Build an integral histogram over the bin indices
+ *   3. Read each region's counts from the integral histogram
+ *   4. Normalize and write them into the combined feature vector
  * 
  * @param image Input image
  * @return Concatenated feature vector from all regions
@@ -84,49 +97,150 @@ cv::Mat MultiHistogramFeature::extractFeatures(const cv::Mat& image) {
         return cv::Mat();
     }
     
-    // Split image into regions
-    std::vector<cv::Mat> regions = splitImage(image);
+    // Histograms need color
+    cv::Mat colorImage = image;
+    if (image.channels() == 1) {
+        cv::cvtColor(image, colorImage, cv::COLOR_GRAY2BGR);
+    }
+    
+    // Region rectangles, in feature vector order
+    std::vector<cv::Rect> regions = splitImage(colorImage.size());
     
     if (regions.empty()) {
         std::cerr << "Error: Failed to split image into regions" << std::endl;
         return cv::Mat();
     }
     
-    // Create histogram extractor for computing region histograms
+    // One binning pass and one integral histogram serve every region
     HistogramFeature histExtractor(histType_, binsPerChannel_, normalize_);
+    const int histDim = histExtractor.getFeatureDimension();
+    std::vector<int> binIndices;
+    histExtractor.computeBinIndices(colorImage, binIndices);
     
-    // Extract histogram from each region
-    std::vector<cv::Mat> regionHistograms;
-    for (size_t i = 0; i < regions.size(); i++) {
-        cv::Mat regionHist = histExtractor.extractFeatures(regions[i]);
-        
-        if (regionHist.empty()) {
-            std::cerr << "Error: Failed to extract histogram from region " << i << std::endl;
-            return cv::Mat();
-        }
-        
-        regionHistograms.push_back(regionHist);
+    IntegralHistogram integral;
+    if (!integral.build(std::move(binIndices), colorImage.rows, colorImage.cols, histDim)) {
+        return cv::Mat();
     }
     
-    // Concatenate all region histograms into single feature vector
     // Result: [hist1, hist2, hist3, ...]
-    int totalDimension = 0;
-    for (const auto& hist : regionHistograms) {
-        totalDimension += hist.cols;
+    cv::Mat combinedFeatures = cv::Mat::zeros(1, histDim * static_cast<int>(regions.size()), CV_32F);
+    float* values = combinedFeatures.ptr<float>(0);
+    
+    for (size_t i = 0; i < regions.size(); i++) {
+        integral.accumulate(regions[i], values + i * histDim);
+    }
+    normalizeRegions(values, regions.size(), histDim);
+    
+    return combinedFeatures;
+}
+
+/**
+ * Extract a batch of images
+ * 
+ * With the device path on, GpuHistogram counts every region of every
+ * image in one kernel run; the counts equal those of the integral
+ * histogram and are normalized by the same code.
+ * 
+ * @param images Decoded images
+ * @param out Output rows, images.size() × getFeatureDimension() CV_32F
+ * @param valid Optional per-image success flags
+ * @return int Number of images extracted
+ */
+int MultiHistogramFeature::extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                                        std::vector<uchar>* valid) {
+    if (!useGpu_) {
+        return FeatureExtractor::extractBatch(images, out, valid);
     }
     
-    cv::Mat combinedFeatures(1, totalDimension, CV_32F);
+    std::vector<cv::Mat> colorImages;
+    std::vector<int> positions;
+    GpuHistogram::collectColorImages(*this, images, colorImages, positions);
+    std::vector<std::vector<cv::Rect>> regions;
+    regions.reserve(colorImages.size());
+    for (const cv::Mat& colorImage : colorImages) {
+        regions.push_back(splitImage(colorImage.size()));
+    }
     
-    int offset = 0;
-    for (const auto& hist : regionHistograms) {
-        // Copy this region's histogram into combined feature vector
-        for (int j = 0; j < hist.cols; j++) {
-            combinedFeatures.at<float>(0, offset + j) = hist.at<float>(0, j);
-        }
-        offset += hist.cols;
+    cv::Mat counts;
+    if (colorImages.empty() || !GpuHistogram::count(colorImages, gpuLayout(), regions, counts) ||
+        counts.cols != getFeatureDimension()) {
+        return FeatureExtractor::extractBatch(images, out, valid);
     }
     
-    return combinedFeatures;
+    const int histDim = getFeatureDimension() / getRegionCount();
+    out.create(static_cast<int>(images.size()), getFeatureDimension(), CV_32F);
+    out.setTo(cv::Scalar::all(0));
+    if (valid != nullptr) {
+        valid->assign(images.size(), 0);
+    }
+    for (size_t k = 0; k < positions.size(); k++) {
+        float* values = out.ptr<float>(positions[k]);
+        const float* imageCounts = counts.ptr<float>(static_cast<int>(k));
+        std::copy(imageCounts, imageCounts + counts.cols, values);
+        normalizeRegions(values, regions[k].size(), histDim);
+        if (valid != nullptr) {
+            (*valid)[positions[k]] = 1;
+        }
+    }
+    return static_cast<int>(positions.size());
+}
+
+/**
+ * Enable or disable device counting
+ */
+bool MultiHistogramFeature::setUseGpu(bool enabled) {
+    useGpu_ = enabled && GpuHistogram::supports(gpuLayout());
+    return useGpu_;
+}
+
+/**
+ * Device counting layout
+ */
+GpuHistogram::Layout MultiHistogramFeature::gpuLayout() const {
+    GpuHistogram::Layout layout;
+    layout.colorBins = binsPerChannel_;
+    layout.chromaticity = (histType_ == HistogramFeature::HistogramType::RG_CHROMATICITY);
+    return layout;
+}
+
+/**
+ * Normalize each region histogram to sum = 1.0 when configured
+ * 
+ * @param values Feature vector, regionCount × histDim raw counts
+ * @param regionCount Number of region histograms
+ * @param histDim Bins per region histogram
+ */
+void MultiHistogramFeature::normalizeRegions(float* values, size_t regionCount,
+                                             int histDim) const {
+    if (!normalize_) {
+        return;
+    }
+    for (size_t i = 0; i < regionCount; i++) {
+        float* regionHist = values + i * histDim;
+        double sum = 0.0;
+        for (int j = 0; j < histDim; j++) {
+            sum += regionHist[j];
+        }
+        
+        if (sum < 1e-10) {
+            std::cerr << "Warning: Histogram sum is zero or near-zero" << std::endl;
+            continue;
+        }
+        
+        for (int j = 0; j < histDim; j++) {
+            regionHist[j] = static_cast<float>(regionHist[j] / sum);
+        }
+    }
+}
+
+/**
+ * Extract multi-region histogram features from a shared context
+ * 
+ * Splits the context's BGR image, so region histograms skip the grayscale
+ * conversion.
+ */
+cv::Mat MultiHistogramFeature::extractFromContext(ImageContext& context) {
+    return extractFeatures(context.color());
 }
 
 /**
@@ -138,13 +252,16 @@ std::string MultiHistogramFeature::getFeatureName() const {
         case SplitType::HORIZONTAL: splitName = "Horizontal"; break;
         case SplitType::VERTICAL:   splitName = "Vertical"; break;
         case SplitType::GRID:       splitName = "Grid"; break;
+        case SplitType::PYRAMID:    splitName = "Pyramid"; break;
     }
     
     std::string histName = (histType_ == HistogramFeature::HistogramType::RGB) 
                           ? "RGB" : "RGChromaticity";
     
+    std::string regionName = (splitType_ == SplitType::PYRAMID) ? "levels_" : "regions_";
+    
     return "Multi" + histName + "Histogram_" + splitName + "_" 
-           + std::to_string(numRegions_) + "regions_" 
+           + std::to_string(numRegions_) + regionName 
            + std::to_string(binsPerChannel_) + "bins";
 }
 
@@ -162,7 +279,46 @@ int MultiHistogramFeature::getFeatureDimension() const {
         histDim = binsPerChannel_ * binsPerChannel_;
     }
     
-    return histDim * numRegions_;
+    return histDim * getRegionCount();
+}
+
+/**
+ * Number of region histograms
+ */
+int MultiHistogramFeature::getRegionCount() const {
+    switch (splitType_) {
+        case SplitType::GRID:
+            return gridSize() * gridSize();
+        case SplitType::PYRAMID: {
+            int count = 0;
+            for (int level = 0; level < numRegions_; level++) {
+                count += (1 << level) * (1 << level);
+            }
+            return count;
+        }
+        default:
+            return numRegions_;
+    }
+}
+
+/**
+ * Largest decode reduction allowed
+ * 
+ * Region boundaries are relative, so normalized region histograms tolerate
+ * 1/4 resolution decoding just like HistogramFeature.
+ */
+int MultiHistogramFeature::getMaxDecodeReduction() const {
+    return normalize_ ? 4 : 1;
+}
+
+/**
+ * Smallest longest side allowed
+ * 
+ * Each region covers only part of the image, so the limit is twice that
+ * of HistogramFeature to keep enough pixels per region.
+ */
+int MultiHistogramFeature::getMinImageSide() const {
+    return normalize_ ? 256 : 0;
 }
 
 /**
@@ -170,6 +326,7 @@ int MultiHistogramFeature::getFeatureDimension() const {
  */
 void MultiHistogramFeature::setSplitType(SplitType type) {
     splitType_ = type;
+    initializeWeights();  // Region count depends on the split type
 }
 
 /**
@@ -193,7 +350,7 @@ std::vector<double> MultiHistogramFeature::getRegionWeights() const {
  * Set custom region weights
  */
 void MultiHistogramFeature::setRegionWeights(const std::vector<double>& weights) {
-    if (weights.size() != static_cast<size_t>(numRegions_)) {
+    if (weights.size() != static_cast<size_t>(getRegionCount())) {
         std::cerr << "Warning: Number of weights must match number of regions" << std::endl;
         return;
     }
@@ -214,16 +371,18 @@ void MultiHistogramFeature::setRegionWeights(const std::vector<double>& weights)
 /**
  * Split image into regions based on split type
  */
-std::vector<cv::Mat> MultiHistogramFeature::splitImage(const cv::Mat& image) const {
+std::vector<cv::Rect> MultiHistogramFeature::splitImage(const cv::Size& size) const {
     switch (splitType_) {
         case SplitType::HORIZONTAL:
-            return splitHorizontal(image);
+            return splitHorizontal(size);
         case SplitType::VERTICAL:
-            return splitVertical(image);
+            return splitVertical(size);
         case SplitType::GRID:
-            return splitGrid(image);
+            return splitGrid(size);
+        case SplitType::PYRAMID:
+            return splitPyramid(size);
         default:
-            return splitHorizontal(image);
+            return splitHorizontal(size);
     }
 }
 
@@ -246,18 +405,17 @@ std::vector<cv::Mat> MultiHistogramFeature::splitImage(const cv::Mat& image) con
  *   │   Region 2  │  ← Bottom third
  *   └─────────────┘
  */
-std::vector<cv::Mat> MultiHistogramFeature::splitHorizontal(const cv::Mat& image) const {
-    std::vector<cv::Mat> regions;
+std::vector<cv::Rect> MultiHistogramFeature::splitHorizontal(const cv::Size& size) const {
+    std::vector<cv::Rect> regions;
     
-    int regionHeight = image.rows / numRegions_;
+    int regionHeight = size.height / numRegions_;
     
     for (int i = 0; i < numRegions_; i++) {
         int startRow = i * regionHeight;
-        int endRow = (i == numRegions_ - 1) ? image.rows : (i + 1) * regionHeight;
+        int endRow = (i == numRegions_ - 1) ? size.height : (i + 1) * regionHeight;
         
-        // Extract region using ROI (Region of Interest)
-        cv::Rect roi(0, startRow, image.cols, endRow - startRow);
-        regions.push_back(image(roi).clone());
+        // Region of Interest (ROI) covering full rows
+        regions.push_back(cv::Rect(0, startRow, size.width, endRow - startRow));
     }
     
     return regions;
@@ -274,17 +432,16 @@ std::vector<cv::Mat> MultiHistogramFeature::splitHorizontal(const cv::Mat& image
  *   └──────┴──────┘
  *   Left    Right
  */
-std::vector<cv::Mat> MultiHistogramFeature::splitVertical(const cv::Mat& image) const {
-    std::vector<cv::Mat> regions;
+std::vector<cv::Rect> MultiHistogramFeature::splitVertical(const cv::Size& size) const {
+    std::vector<cv::Rect> regions;
     
-    int regionWidth = image.cols / numRegions_;
+    int regionWidth = size.width / numRegions_;
     
     for (int i = 0; i < numRegions_; i++) {
         int startCol = i * regionWidth;
-        int endCol = (i == numRegions_ - 1) ? image.cols : (i + 1) * regionWidth;
+        int endCol = (i == numRegions_ - 1) ? size.width : (i + 1) * regionWidth;
         
-        cv::Rect roi(startCol, 0, endCol - startCol, image.rows);
-        regions.push_back(image(roi).clone());
+        regions.push_back(cv::Rect(startCol, 0, endCol - startCol, size.height));
     }
     
     return regions;
@@ -302,48 +459,110 @@ std::vector<cv::Mat> MultiHistogramFeature::splitVertical(const cv::Mat& image)
  * 
  * numRegions must be a perfect square (4, 9, 16, etc.)
  */
-std::vector<cv::Mat> MultiHistogramFeature::splitGrid(const cv::Mat& image) const {
-    std::vector<cv::Mat> regions;
-    
-    // Calculate grid dimensions (assume square grid)
-    int gridSize = static_cast<int>(std::sqrt(numRegions_));
-    
-    // If not perfect square, adjust to nearest square
-    if (gridSize * gridSize != numRegions_) {
-        gridSize = static_cast<int>(std::sqrt(numRegions_)) + 1;
-        std::cerr << "Warning: Grid size adjusted to " << gridSize << "×" << gridSize 
-                  << " = " << (gridSize * gridSize) << " regions" << std::endl;
+std::vector<cv::Rect> MultiHistogramFeature::splitGrid(const cv::Size& size) const {
+    std::vector<cv::Rect> regions;
+    appendGrid(size, gridSize(), regions);
+    return regions;
+}
+
+/**
+ * Split into spatial pyramid levels
+ * 
+ * Level l is a 2^l × 2^l grid. Example with 2 levels (5 regions):
+ *   ┌─────────────┐   ┌──────┬──────┐
+ *   │             │   │Reg 1 │Reg 2 │
+ *   │    Reg 0    │ + ├──────┼──────┤
+ *   │             │   │Reg 3 │Reg 4 │
+ *   └─────────────┘   └──────┴──────┘
+ *       Level 0           Level 1
+ * 
+ * All levels are read from the same integral histogram, so each extra level
+ * costs O(regions × bins) rather than another pass over the pixels.
+ */
+std::vector<cv::Rect> MultiHistogramFeature::splitPyramid(const cv::Size& size) const {
+    std::vector<cv::Rect> regions;
+    for (int level = 0; level < numRegions_; level++) {
+        appendGrid(size, 1 << level, regions);
     }
+    return regions;
+}
+
+/**
+ * Append the cells of a square grid, row by row
+ * 
+ * The last row and column absorb the remainder pixels.
+ */
+void MultiHistogramFeature::appendGrid(const cv::Size& size, int gridSize,
+                                       std::vector<cv::Rect>& regions) {
+    int regionHeight = size.height / gridSize;
+    int regionWidth = size.width / gridSize;
     
-    int regionHeight = image.rows / gridSize;
-    int regionWidth = image.cols / gridSize;
-    
-    // Extract each grid cell as a region
     for (int row = 0; row < gridSize; row++) {
         for (int col = 0; col < gridSize; col++) {
             int startRow = row * regionHeight;
             int startCol = col * regionWidth;
             
-            int endRow = (row == gridSize - 1) ? image.rows : (row + 1) * regionHeight;
-            int endCol = (col == gridSize - 1) ? image.cols : (col + 1) * regionWidth;
+            int endRow = (row == gridSize - 1) ? size.height : (row + 1) * regionHeight;
+            int endCol = (col == gridSize - 1) ? size.width : (col + 1) * regionWidth;
             
-            cv::Rect roi(startCol, startRow, endCol - startCol, endRow - startRow);
-            regions.push_back(image(roi).clone());
+            regions.push_back(cv::Rect(startCol, startRow, endCol - startCol, endRow - startRow));
         }
     }
-    
-    return regions;
 }
 
 /**
- * Initialize equal weights for all regions
- * Each region gets weight = 1.0 / numRegions
+ * Grid side for GRID splits
+ * 
+ * numRegions should be a perfect square; otherwise the next larger square
+ * grid is used.
+ */
+int MultiHistogramFeature::gridSize() const {
+    int size = static_cast<int>(std::sqrt(numRegions_));
+    if (size * size != numRegions_) {
+        size++;
+    }
+    return size;
+}
+
+/**
+ * Initialize default region weights
+ * 
+ * Horizontal, vertical and grid splits: weight = 1.0 / regions.
+ * 
+ * Pyramid with L+1 levels (spatial pyramid matching): level 0 gets 1/2^L,
+ * level l >= 1 gets 1/2^(L-l+1), shared equally by that level's regions.
+ * The level weights sum to 1.0, and finer levels count more.
  */
 void MultiHistogramFeature::initializeWeights() {
     regionWeights_.clear();
-    double weight = 1.0 / numRegions_;
     
-    for (int i = 0; i < numRegions_; i++) {
+    if (splitType_ == SplitType::GRID && gridSize() * gridSize() != numRegions_) {
+        std::cerr << "Warning: Grid size adjusted to " << gridSize() << "×" << gridSize() 
+                  << " = " << getRegionCount() << " regions" << std::endl;
+    }
+    
+    if (splitType_ == SplitType::PYRAMID) {
+        if (numRegions_ > MAX_PYRAMID_LEVELS) {
+            std::cerr << "Warning: Pyramid limited to " << MAX_PYRAMID_LEVELS
+                      << " levels" << std::endl;
+            numRegions_ = MAX_PYRAMID_LEVELS;
+        }
+        
+        const int top = numRegions_ - 1;
+        for (int level = 0; level <= top; level++) {
+            double levelWeight = (level == 0) ? 1.0 / (1 << top) : 1.0 / (1 << (top - level + 1));
+            int cells = (1 << level) * (1 << level);
+            for (int i = 0; i < cells; i++) {
+                regionWeights_.push_back(levelWeight / cells);
+            }
+        }
+        return;
+    }
+    
+    const int regions = getRegionCount();
+    double weight = 1.0 / regions;
+    
+    for (int i = 0; i < regions; i++) {
         regionWeights_.push_back(weight);
     }
 }
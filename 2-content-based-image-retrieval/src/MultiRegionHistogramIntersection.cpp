@@ -26,9 +26,11 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "MultiRegionHistogramIntersection.h"
+#include "DistanceKernels.h"
 #include <iostream>
 #include <cmath>
 #include <numeric>
+#include <algorithm>
 
 namespace cbir {
 
@@ -43,6 +45,7 @@ MultiRegionHistogramIntersection::MultiRegionHistogramIntersection(
     
     // Initialize equal weights
     initializeEqualWeights();
+    buildBinWeights();
 }
 
 /**
@@ -59,9 +62,15 @@ MultiRegionHistogramIntersection::MultiRegionHistogramIntersection(
     // Validate and normalize weights
     if (weights_.empty()) {
         initializeEqualWeights();
+    } else if (weights_.size() != static_cast<size_t>(numRegions_)) {
+        std::cerr << "Error: Number of weights (" << weights_.size()
+                  << ") must match number of regions (" << numRegions_
+                  << "), using equal weights" << std::endl;
+        initializeEqualWeights();
     } else {
         normalizeWeights();
     }
+    buildBinWeights();
 }
 
 /**
@@ -71,12 +80,8 @@ MultiRegionHistogramIntersection::MultiRegionHistogramIntersection(
  * 
  * Process:
  *   1. Validate feature dimensions match expected (numRegions × binsPerRegion)
- *   2. For each region:
- *      - Extract region bounds (startIdx, endIdx)
- *      - Compute histogram intersection for that region
- *      - Convert to distance: d_region = 1 - intersection_region
- *      - Apply region weight
- *   3. Sum weighted region distances
+ *   2. Score both vectors with regionDistance(), which evaluates every
+ *      region's weighted intersection in one pass over the flat arrays
  * 
  * @param features1 First multi-region histogram feature
  * @param features2 Second multi-region histogram feature
@@ -101,27 +106,61 @@ double MultiRegionHistogramIntersection::compute(const cv::Mat& features1,
         return -1.0;
     }
     
-    // Compute distance for each region separately
-    double combinedDistance = 0.0;
+    if (features1.type() != CV_32F) {
+        std::cerr << "Error: Multi-region features must be CV_32F" << std::endl;
+        return -1.0;
+    }
     
-    for (int region = 0; region < numRegions_; region++) {
-        // Define region bounds in feature vector
-        int startIdx = region * binsPerRegion_;
-        int endIdx = (region + 1) * binsPerRegion_;
-        
-        // Compute histogram intersection for this region
-        double regionIntersection = computeRegionIntersection(
-            features1, features2, startIdx, endIdx
-        );
-        
-        // Convert intersection to distance
-        double regionDistance = 1.0 - regionIntersection;
-        
-        // Add weighted contribution to combined distance
-        combinedDistance += weights_[region] * regionDistance;
+    return regionDistance(features1.ptr<float>(0), features2.ptr<float>(0));
+}
+
+/**
+ * Batch version of compute()
+ * 
+ * The multi-region layout is checked once for the whole matrix; each row
+ * then goes through the same fused kernel as compute(), so distances are
+ * identical.
+ * 
+ * @param query Query multi-region histogram feature
+ * @param matrix Database features, one vector per row
+ * @param out Output distances (matrix.rows x 1, CV_64F)
+ * @return True on success, false on invalid input
+ */
+bool MultiRegionHistogramIntersection::computeBatch(const cv::Mat& query,
+                                                    const cv::Mat& matrix,
+                                                    cv::Mat& out) {
+    int expectedDim = numRegions_ * binsPerRegion_;
+    if (matrix.cols != expectedDim) {
+        std::cerr << "Error: Feature dimension mismatch!" << std::endl;
+        std::cerr << "  Expected: " << expectedDim 
+                  << " (" << numRegions_ << " regions × " 
+                  << binsPerRegion_ << " bins per region)" << std::endl;
+        std::cerr << "  Got: " << matrix.cols << std::endl;
+        return false;
     }
     
-    return combinedDistance;
+    return runBatch(query, matrix, out,
+                    [this](const float* queryData, const float* rowData, int) {
+        return regionDistance(queryData, rowData);
+    });
+}
+
+/**
+ * Combined distance between two contiguous feature arrays
+ * 
+ * Σ_r w_r × (1 - I_r) is rewritten as Σ_r w_r - Σ_i w(i) × min(a_i, b_i),
+ * where w(i) is the weight of bin i's region (binWeights_). The second
+ * term is one SIMD pass over the flat vectors, so small regions cost no
+ * per-region loop setup or Mat headers.
+ * 
+ * @param hist1 First feature vector (numRegions × binsPerRegion floats)
+ * @param hist2 Second feature vector
+ * @return Combined weighted distance [0, 1]
+ */
+double MultiRegionHistogramIntersection::regionDistance(const float* hist1,
+                                                        const float* hist2) const {
+    return weightTotal_ - DistanceKernels::weightedIntersection(
+        hist1, hist2, binWeights_.data(), static_cast<int>(binWeights_.size()));
 }
 
 /**
@@ -146,38 +185,24 @@ void MultiRegionHistogramIntersection::setWeights(const std::vector<double>& wei
     
     weights_ = weights;
     normalizeWeights();
+    buildBinWeights();
 }
 
 /**
- * Compute histogram intersection for a single region
- * 
- * Computes: intersection = Σ min(hist1[i], hist2[i]) for i in [startIdx, endIdx)
+ * Expand the region weights into one weight per bin
  * 
- * This is the same formula as regular histogram intersection,
- * but applied only to a specific region of the concatenated feature vector.
- * 
- * @param hist1 First feature vector (contains all regions)
- * @param hist2 Second feature vector (contains all regions)
- * @param startIdx Start index of this region
- * @param endIdx End index of this region (exclusive)
- * @return Intersection value for this region [0, 1]
+ * Bins [r × binsPerRegion, (r + 1) × binsPerRegion) all get weights_[r].
+ * Recomputed whenever the weights change, never per comparison.
  */
-double MultiRegionHistogramIntersection::computeRegionIntersection(
-    const cv::Mat& hist1, 
-    const cv::Mat& hist2,
-    int startIdx, 
-    int endIdx) const {
-    
-    double intersection = 0.0;
-    
-    // Sum minimum values for this region's bins only
-    for (int i = startIdx; i < endIdx; i++) {
-        float val1 = hist1.at<float>(0, i);
-        float val2 = hist2.at<float>(0, i);
-        intersection += std::min(val1, val2);
+void MultiRegionHistogramIntersection::buildBinWeights() {
+    binWeights_.assign(static_cast<size_t>(std::max(0, numRegions_ * binsPerRegion_)), 0.0f);
+    weightTotal_ = 0.0;
+    for (int region = 0; region < numRegions_; region++) {
+        std::fill(binWeights_.begin() + static_cast<size_t>(region) * binsPerRegion_,
+                  binWeights_.begin() + static_cast<size_t>(region + 1) * binsPerRegion_,
+                  static_cast<float>(weights_[region]));
+        weightTotal_ += weights_[region];
     }
-    
-    return intersection;
 }
 
 /**
@@ -0,0 +1,460 @@
+////////////////////////////////////////////////////////////////////////////////
+// NumaScanner.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the NUMA scan backend: topology detection
+//              from sysfs, the pinned per-node thread pool, first-touch
+//              partitioning of the feature matrix and the per-node top-K
+//              scan and merge.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NumaScanner.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cbir {
+
+namespace {
+
+/// Partition rows per work item (ImageRetrieval::SCAN_BLOCK_ROWS)
+const int SCAN_BLOCK_ROWS = 4096;
+
+/// Rows scored against every query of a batch before moving on
+/// (ImageRetrieval::BATCH_TILE_ROWS)
+const int BATCH_TILE_ROWS = 256;
+
+/// Queries per computeBlockNormed() call (ImageRetrieval::BATCH_QUERY_ROWS)
+const int BATCH_QUERY_ROWS = 64;
+
+/// Rows copied per work item while partitioning
+const int COPY_BLOCK_ROWS = 4096;
+
+/// Node numbers probed in sysfs
+const int MAX_NODES = 1024;
+
+using Candidate = std::pair<double, int>;
+
+/// Offer a candidate to a bounded max-heap (front() is the worst survivor)
+inline void keepBest(std::vector<Candidate>& heap, size_t keep, const Candidate& candidate) {
+    if (heap.size() < keep) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (candidate < heap.front()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+/// Reduce merged survivors to the sorted best `keep`
+void finishTopRows(std::vector<Candidate>& best, size_t keep) {
+    if (best.size() > keep) {
+        std::nth_element(best.begin(), best.begin() + keep, best.end());
+        best.resize(keep);
+    }
+    std::sort(best.begin(), best.end());
+}
+
+/**
+ * Parse a sysfs CPU list such as "0-15,32-47"
+ */
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    for (const std::string& item : Utils::split(Utils::trim(text), ',')) {
+        std::string range = Utils::trim(item);
+        if (range.empty()) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return std::vector<int>();
+        }
+    }
+    return cpus;
+}
+
+/**
+ * Restrict the calling thread to a set of CPUs (no-op where unsupported)
+ */
+void pinCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "Warning: Could not pin scan thread to its NUMA node" << std::endl;
+    }
+#else
+    (void)cpus;
+#endif
+}
+
+} // namespace
+
+/**
+ * @brief Memory nodes from sysfs, or one node with every hardware thread
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::vector<NumaNode> detectNumaTopology() {
+    std::vector<NumaNode> nodes;
+#ifdef __linux__
+    const std::string root = "/sys/devices/system/node/";
+    // Node numbers may have gaps (offline or memory-only nodes)
+    for (int id = 0; id < MAX_NODES && Utils::directoryExists(root); id++) {
+        std::ifstream file(root + "node" + std::to_string(id) + "/cpulist");
+        if (!file.is_open()) {
+            continue;
+        }
+        std::string text;
+        std::getline(file, text);
+        NumaNode node;
+        node.id = id;
+        node.cpus = parseCpuList(text);
+        if (!node.cpus.empty()) {
+            nodes.push_back(node);
+        }
+    }
+#endif
+    if (nodes.empty()) {
+        NumaNode node;
+        const int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < threads; cpu++) {
+            node.cpus.push_back(cpu);
+        }
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+/**
+ * @brief Start one pinned worker per CPU
+ *
+ * @author Krushna Sanjay Sharma
+ */
+NumaThreadPool::NumaThreadPool(const std::vector<NumaNode>& nodes) : nodes_(nodes) {
+    for (int node = 0; node < nodeCount(); node++) {
+        for (int worker = 0; worker < workerCount(node); worker++) {
+            threads_.emplace_back(&NumaThreadPool::workerLoop, this, node, worker);
+        }
+    }
+}
+
+/**
+ * @brief Stop and join the workers
+ *
+ * @author Krushna Sanjay Sharma
+ */
+NumaThreadPool::~NumaThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Run a task on every worker and wait
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void NumaThreadPool::run(const Task& task) {
+    std::lock_guard<std::mutex> serial(runMutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    pending_ = static_cast<int>(threads_.size());
+    generation_++;
+    wake_.notify_all();
+    done_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+}
+
+void NumaThreadPool::workerLoop(int node, int worker) {
+    if (nodeCount() > 1) {
+        pinCurrentThread(nodes_[node].cpus);
+    }
+    uint64_t seen = 0;
+    for (;;) {
+        const Task* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            task = task_;
+        }
+        (*task)(node, worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+}
+
+bool NumaScanner::isAvailable() {
+    return detectNumaTopology().size() > 1;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+NumaScanner::NumaScanner() : pool_(detectNumaTopology()) {
+}
+
+/**
+ * @brief Best k rows per query over the node-local partitions
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool NumaScanner::search(const FeatureDatabase& database, const cv::Mat& queries,
+                         DistanceMetric& metric, int k,
+                         std::vector<std::vector<std::pair<double, int>>>& best) {
+    best.assign(queries.rows, std::vector<Candidate>());
+    if (database.empty() || queries.empty() || queries.type() != CV_32F ||
+        queries.cols != database.dimension() || k <= 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    upload(database, metric.usesRowNorms());
+    if (partitions_.empty()) {
+        return false;
+    }
+
+    const size_t keep = static_cast<size_t>(k);
+    const int queryCount = queries.rows;
+    std::vector<std::unique_ptr<std::atomic<int>>> nextBlock;
+    std::vector<std::vector<std::vector<Candidate>>> nodeBest(pool_.nodeCount());
+    std::vector<std::unique_ptr<std::mutex>> nodeMutex;
+    for (int node = 0; node < pool_.nodeCount(); node++) {
+        nextBlock.emplace_back(new std::atomic<int>(0));
+        nodeMutex.emplace_back(new std::mutex());
+        nodeBest[node].resize(queryCount);
+    }
+    std::atomic<bool> failed(false);
+    std::atomic<int> invalidCount(0);
+
+    pool_.run([&](int node, int) {
+        const Partition& partition = partitions_[node];
+        const int rows = partition.rows.rows;
+        const int blockCount = (rows + SCAN_BLOCK_ROWS - 1) / SCAN_BLOCK_ROWS;
+        std::vector<std::vector<Candidate>> heaps(queryCount);
+        for (auto& heap : heaps) {
+            heap.reserve(keep + 1);
+        }
+        cv::Mat distances;
+        int invalid = 0;
+
+        // Blocks of the local partition, claimed until none are left
+        for (int block = (*nextBlock[node])++; block < blockCount && !failed;
+             block = (*nextBlock[node])++) {
+            const int blockStart = block * SCAN_BLOCK_ROWS;
+            const int blockEnd = std::min(rows, blockStart + SCAN_BLOCK_ROWS);
+            const int tileRows = queryCount == 1 ? SCAN_BLOCK_ROWS : BATCH_TILE_ROWS;
+
+            for (int start = blockStart; start < blockEnd && !failed; start += tileRows) {
+                const int end = std::min(blockEnd, start + tileRows);
+                const cv::Mat tile = partition.rows.rowRange(start, end);
+                const cv::Mat tileNorms = partition.norms.empty()
+                    ? cv::Mat() : partition.norms.rowRange(start, end);
+
+                for (int first = 0; first < queryCount; first += BATCH_QUERY_ROWS) {
+                    const int last = std::min(queryCount, first + BATCH_QUERY_ROWS);
+                    bool scored = queryCount == 1
+                        ? metric.computeBatchNormed(queries, tile, tileNorms, distances)
+                        : metric.computeBlockNormed(queries.rowRange(first, last), tile,
+                                                    tileNorms, distances);
+                    if (!scored) {
+                        failed = true;
+                        break;
+                    }
+                    for (int q = first; q < last; q++) {
+                        for (int i = 0; i < end - start; i++) {
+                            // computeBatch writes a column, computeBlock a row per query
+                            const double distance = queryCount == 1
+                                ? distances.at<double>(i)
+                                : distances.at<double>(q - first, i);
+                            if (distance < 0) {
+                                invalid++;
+                                continue;
+                            }
+                            keepBest(heaps[q], keep,
+                                     Candidate(distance, partition.start + start + i));
+                        }
+                    }
+                }
+            }
+        }
+
+        invalidCount += invalid;
+        std::lock_guard<std::mutex> merge(*nodeMutex[node]);
+        for (int q = 0; q < queryCount; q++) {
+            nodeBest[node][q].insert(nodeBest[node][q].end(), heaps[q].begin(), heaps[q].end());
+        }
+    });
+
+    if (failed) {
+        best.assign(queryCount, std::vector<Candidate>());
+        return false;
+    }
+    if (invalidCount > 0) {
+        std::cerr << "Warning: Invalid distance for " << invalidCount.load()
+                  << " database images" << std::endl;
+    }
+
+    // Per-node top K first, then across nodes
+    for (int q = 0; q < queryCount; q++) {
+        for (int node = 0; node < pool_.nodeCount(); node++) {
+            std::vector<Candidate>& local = nodeBest[node][q];
+            finishTopRows(local, keep);
+            best[q].insert(best[q].end(), local.begin(), local.end());
+        }
+        finishTopRows(best[q], keep);
+    }
+    return true;
+}
+
+/**
+ * @brief Bytes of the partitions and their norms
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t NumaScanner::residentBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const Partition& partition : partitions_) {
+        bytes += partition.storage.total() * partition.storage.elemSize() +
+                 partition.norms.total() * partition.norms.elemSize();
+    }
+    return bytes;
+}
+
+/**
+ * @brief Split the rows by node and copy them on the node's own workers
+ *
+ * The first run allocates each partition on its node's first worker; the
+ * second copies it block by block on all of the node's workers. Pages are
+ * only backed when first written, so both the allocation and the copy
+ * must happen on the node for the memory to end up local.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void NumaScanner::upload(const FeatureDatabase& database, bool withNorms) {
+    if (source_ == &database && sourceVersion_ == database.version() &&
+        (withNorms_ || !withNorms) && !partitions_.empty()) {
+        return;
+    }
+    source_ = nullptr;
+    partitions_.clear();
+
+    const int rows = static_cast<int>(database.size());
+    std::vector<uint8_t> probe;
+    const cv::Mat layout = database.readRows(0, 1, probe);
+    if (layout.empty()) {
+        return;
+    }
+    const size_t rowStride = layout.step[0];
+    const int type = layout.type();
+    const cv::Mat databaseNorms = withNorms ? database.rowNorms() : cv::Mat();
+
+    // Contiguous row ranges in proportion to each node's CPU count
+    int totalWorkers = 0;
+    for (int node = 0; node < pool_.nodeCount(); node++) {
+        totalWorkers += pool_.workerCount(node);
+    }
+    partitions_.resize(pool_.nodeCount());
+    std::vector<int> counts(pool_.nodeCount());
+    int start = 0;
+    int workersBefore = 0;
+    for (int node = 0; node < pool_.nodeCount(); node++) {
+        workersBefore += pool_.workerCount(node);
+        const int end = static_cast<int>(static_cast<int64_t>(rows) * workersBefore / totalWorkers);
+        partitions_[node].start = start;
+        counts[node] = end - start;
+        start = end;
+    }
+
+    pool_.run([&](int node, int worker) {
+        Partition& partition = partitions_[node];
+        const int count = counts[node];
+        if (worker != 0 || count == 0) {
+            return;
+        }
+        partition.storage.create(count, static_cast<int>(rowStride), CV_8U);
+        partition.rows = cv::Mat(count, layout.cols, type, partition.storage.data, rowStride);
+        if (!databaseNorms.empty()) {
+            partition.norms.create(count, 1, CV_64F);
+        }
+    });
+
+    std::vector<std::unique_ptr<std::atomic<int>>> nextBlock;
+    for (int node = 0; node < pool_.nodeCount(); node++) {
+        nextBlock.emplace_back(new std::atomic<int>(0));
+    }
+    std::atomic<bool> failed(false);
+    pool_.run([&](int node, int) {
+        Partition& partition = partitions_[node];
+        const int count = partition.rows.rows;
+        const int blockCount = (count + COPY_BLOCK_ROWS - 1) / COPY_BLOCK_ROWS;
+        std::vector<uint8_t> scratch;
+        for (int block = (*nextBlock[node])++; block < blockCount && !failed;
+             block = (*nextBlock[node])++) {
+            const int first = block * COPY_BLOCK_ROWS;
+            const int last = std::min(count, first + COPY_BLOCK_ROWS);
+            const int globalFirst = partition.start + first;
+            const cv::Mat source = database.readRows(globalFirst, partition.start + last,
+                                                     scratch);
+            if (source.empty()) {
+                failed = true;
+                break;
+            }
+            for (int row = 0; row < last - first; row++) {
+                std::memcpy(partition.rows.ptr(first + row), source.ptr(row), rowStride);
+            }
+            if (!databaseNorms.empty()) {
+                databaseNorms.rowRange(globalFirst, partition.start + last)
+                    .copyTo(partition.norms.rowRange(first, last));
+            }
+        }
+    });
+    if (failed) {
+        partitions_.clear();
+        return;
+    }
+
+    source_ = &database;
+    sourceVersion_ = database.version();
+    withNorms_ = withNorms;
+}
+
+} // namespace cbir
@@ -0,0 +1,470 @@
+////////////////////////////////////////////////////////////////////////////////
+// ObjectStore.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of S3-compatible listing (ListObjectsV2),
+//              ranged object fetches and AWS Signature V4 request signing.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ObjectStore.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+namespace cbir {
+
+namespace {
+
+/// Image extensions list() keeps (those of Utils::getImageFiles)
+const char* const IMAGE_EXTENSIONS[] = {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff"};
+
+/// SHA-256 of the empty payload of a GET
+const char* const EMPTY_PAYLOAD_HASH =
+    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+
+std::string getEnv(const char* name) {
+    const char* value = std::getenv(name);
+    return value != nullptr ? value : "";
+}
+
+/**
+ * SHA-256 (FIPS 180-4), enough for request signing
+ */
+std::string sha256(const std::string& data) {
+    static const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+        0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+        0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+        0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+        0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+        0xc67178f2};
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+    std::string message = data;
+    const uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) {
+        message += static_cast<char>(0);
+    }
+    for (int i = 7; i >= 0; i--) {
+        message += static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            const unsigned char* p =
+                reinterpret_cast<const unsigned char*>(message.data() + block + 4 * i);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 64; i++) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+        for (int i = 0; i < 64; i++) {
+            const uint32_t t1 = k + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+                                ((e & f) ^ (~e & g)) + K[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) +
+                                ((a & b) ^ (a & c) ^ (b & c));
+            k = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+        h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+    }
+
+    std::string digest;
+    for (uint32_t word : h) {
+        for (int i = 3; i >= 0; i--) {
+            digest += static_cast<char>((word >> (8 * i)) & 0xff);
+        }
+    }
+    return digest;
+}
+
+std::string hmacSha256(const std::string& key, const std::string& data) {
+    std::string block = key.size() > 64 ? sha256(key) : key;
+    block.resize(64, '\0');
+    std::string inner(64, '\0'), outer(64, '\0');
+    for (int i = 0; i < 64; i++) {
+        inner[i] = static_cast<char>(block[i] ^ 0x36);
+        outer[i] = static_cast<char>(block[i] ^ 0x5c);
+    }
+    return sha256(outer + sha256(inner + data));
+}
+
+std::string toHex(const std::string& bytes) {
+    static const char* digits = "0123456789abcdef";
+    std::string hex;
+    for (unsigned char byte : bytes) {
+        hex += digits[byte >> 4];
+        hex += digits[byte & 15];
+    }
+    return hex;
+}
+
+/**
+ * URI-encode as SigV4 requires; '/' is kept in paths and encoded in queries
+ */
+std::string uriEncode(const std::string& text, bool keepSlash) {
+    static const char* digits = "0123456789ABCDEF";
+    std::string encoded;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' ||
+            (keepSlash && c == '/')) {
+            encoded += static_cast<char>(c);
+        } else {
+            encoded += '%';
+            encoded += digits[c >> 4];
+            encoded += digits[c & 15];
+        }
+    }
+    return encoded;
+}
+
+/**
+ * Text of the first <tag>...</tag> at or after from (entities decoded)
+ */
+std::string xmlValue(const std::string& xml, const std::string& tag, size_t from = 0,
+                     size_t to = std::string::npos) {
+    const std::string open = "<" + tag + ">";
+    const size_t start = xml.find(open, from);
+    if (start == std::string::npos || start >= to) {
+        return "";
+    }
+    const size_t end = xml.find("</" + tag + ">", start);
+    if (end == std::string::npos) {
+        return "";
+    }
+    std::string value = xml.substr(start + open.size(), end - start - open.size());
+    static const std::pair<const char*, char> entities[] = {
+        {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}, {"&amp;", '&'}};
+    for (const auto& entity : entities) {
+        size_t at;
+        while ((at = value.find(entity.first)) != std::string::npos) {
+            value.replace(at, std::strlen(entity.first), 1, entity.second);
+        }
+    }
+    return value;
+}
+
+bool isImageKey(const std::string& key) {
+    const size_t dot = key.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    const std::string extension = Utils::toLower(key.substr(dot));
+    return std::find(std::begin(IMAGE_EXTENSIONS), std::end(IMAGE_EXTENSIONS), extension) !=
+           std::end(IMAGE_EXTENSIONS);
+}
+
+bool fail(std::string* error, const std::string& reason) {
+    if (error != nullptr) {
+        *error = reason;
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Read credentials, region and endpoint from the environment
+ *
+ * @author Krushna Sanjay Sharma
+ */
+ObjectStore::ObjectStore()
+    : accessKey_(getEnv("AWS_ACCESS_KEY_ID")), secretKey_(getEnv("AWS_SECRET_ACCESS_KEY")),
+      sessionToken_(getEnv("AWS_SESSION_TOKEN")), region_(getEnv("AWS_REGION")),
+      endpoint_(getEnv("CBIR_S3_ENDPOINT")), timeoutMs_(30000) {
+    if (region_.empty()) {
+        region_ = getEnv("AWS_DEFAULT_REGION");
+    }
+    if (region_.empty()) {
+        region_ = "us-east-1";
+    }
+    if (secretKey_.empty()) {
+        accessKey_.clear();
+    }
+}
+
+bool ObjectStore::isUrl(const std::string& path) {
+    return path.compare(0, 5, "s3://") == 0 || path.compare(0, 7, "http://") == 0;
+}
+
+bool ObjectStore::locate(const std::string& url, Location& location, std::string* error) const {
+    const bool s3 = url.compare(0, 5, "s3://") == 0;
+    if (!s3 && url.compare(0, 7, "http://") != 0) {
+        return fail(error, "not an object URL: " + url);
+    }
+    const std::string rest = url.substr(s3 ? 5 : 7);
+
+    // s3://bucket/key or http://host[:port]/bucket/key
+    std::string authority, bucket;
+    size_t bucketStart = 0;
+    if (!s3) {
+        bucketStart = rest.find('/');
+        if (bucketStart == std::string::npos) {
+            return fail(error, "missing bucket in " + url);
+        }
+        authority = rest.substr(0, bucketStart);
+        bucketStart++;
+    }
+    const size_t keyStart = rest.find('/', bucketStart);
+    bucket = rest.substr(bucketStart, keyStart == std::string::npos ? std::string::npos
+                                                                    : keyStart - bucketStart);
+    if (bucket.empty()) {
+        return fail(error, "missing bucket in " + url);
+    }
+    location.key = keyStart == std::string::npos ? "" : rest.substr(keyStart + 1);
+    location.urlPrefix = url.substr(0, url.size() - location.key.size());
+    if (location.urlPrefix.back() != '/') {
+        location.urlPrefix += '/';
+    }
+
+    if (s3 && endpoint_.empty()) {
+        location.endpoint.host = bucket + ".s3." + region_ + ".amazonaws.com";
+        location.endpoint.port = 80;
+        location.bucketPath.clear();
+    } else {
+        const std::string hostPort = s3 ? endpoint_ : authority;
+        if (hostPort.find(':') == std::string::npos) {
+            location.endpoint.host = hostPort;
+            location.endpoint.port = 80;
+        } else if (!HttpEndpoint::parse(hostPort, location.endpoint)) {
+            return fail(error, "invalid endpoint " + hostPort);
+        }
+        location.bucketPath = "/" + bucket;
+    }
+    location.host = location.endpoint.port == 80
+        ? location.endpoint.host : location.endpoint.toString();
+    return true;
+}
+
+/**
+ * @brief Host, date, payload hash and, with credentials, the V4 signature
+ *
+ * @author Krushna Sanjay Sharma
+ */
+HttpHeaders ObjectStore::sign(const Location& location, const std::string& path,
+                              const std::string& query) const {
+    HttpHeaders headers;
+    headers.emplace_back("Host", location.host);
+    if (!isSigned()) {
+        return headers;
+    }
+
+    const std::time_t now = std::time(nullptr);
+    std::tm utc;
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &utc);
+    const std::string amzDate = stamp;
+    const std::string date = amzDate.substr(0, 8);
+    const std::string scope = date + "/" + region_ + "/s3/aws4_request";
+
+    // Canonical headers must be sorted by name
+    std::string canonicalHeaders = "host:" + location.host + "\n" +
+                                   "x-amz-content-sha256:" + EMPTY_PAYLOAD_HASH + "\n" +
+                                   "x-amz-date:" + amzDate + "\n";
+    std::string signedHeaders = "host;x-amz-content-sha256;x-amz-date";
+    if (!sessionToken_.empty()) {
+        canonicalHeaders += "x-amz-security-token:" + sessionToken_ + "\n";
+        signedHeaders += ";x-amz-security-token";
+    }
+    const std::string canonicalRequest = "GET\n" + path + "\n" + query + "\n" +
+                                         canonicalHeaders + "\n" + signedHeaders + "\n" +
+                                         EMPTY_PAYLOAD_HASH;
+    const std::string stringToSign = "AWS4-HMAC-SHA256\n" + amzDate + "\n" + scope + "\n" +
+                                     toHex(sha256(canonicalRequest));
+
+    std::string key = hmacSha256("AWS4" + secretKey_, date);
+    key = hmacSha256(key, region_);
+    key = hmacSha256(key, "s3");
+    key = hmacSha256(key, "aws4_request");
+    const std::string signature = toHex(hmacSha256(key, stringToSign));
+
+    headers.emplace_back("x-amz-content-sha256", EMPTY_PAYLOAD_HASH);
+    headers.emplace_back("x-amz-date", amzDate);
+    if (!sessionToken_.empty()) {
+        headers.emplace_back("x-amz-security-token", sessionToken_);
+    }
+    headers.emplace_back("Authorization", "AWS4-HMAC-SHA256 Credential=" + accessKey_ + "/" +
+                                              scope + ", SignedHeaders=" + signedHeaders +
+                                              ", Signature=" + signature);
+    return headers;
+}
+
+/**
+ * @brief GET with exponential back-off on network errors and 5xx responses
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ObjectStore::get(const Location& location, const std::string& path,
+                      const std::string& query, const std::string& range,
+                      HttpResponse& response, std::string* headers, std::string* error) const {
+    std::string reason;
+    for (int attempt = 0; attempt < ATTEMPTS; attempt++) {
+        if (attempt > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 << attempt));
+        }
+        HttpHeaders fields = sign(location, path, query);   // fresh date per attempt
+        if (!range.empty()) {
+            fields.emplace_back("Range", range);
+        }
+        const std::string target = query.empty() ? path : path + "?" + query;
+        if (!HttpClient::request(location.endpoint, "GET", target, fields, "", timeoutMs_,
+                                 response, &reason, headers)) {
+            continue;
+        }
+        if (response.status >= 500) {
+            reason = "HTTP " + std::to_string(response.status);
+            continue;
+        }
+        if (response.status >= 300) {
+            const std::string code = xmlValue(response.body, "Code");
+            return fail(error, "HTTP " + std::to_string(response.status) +
+                                   (code.empty() ? "" : " " + code));
+        }
+        return true;
+    }
+    return fail(error, reason.empty() ? "request failed" : reason);
+}
+
+/**
+ * @brief Page through ListObjectsV2 and keep image keys
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ObjectStore::list(const std::string& prefixUrl, std::vector<ObjectInfo>& objects,
+                       std::string* error) const {
+    objects.clear();
+    Location location;
+    if (!locate(prefixUrl, location, error)) {
+        return false;
+    }
+
+    const std::string path = location.bucketPath.empty() ? "/" : location.bucketPath;
+    std::string token;
+    do {
+        // Query parameters in SigV4 canonical (sorted) order
+        std::string query;
+        if (!token.empty()) {
+            query += "continuation-token=" + uriEncode(token, false) + "&";
+        }
+        query += "list-type=2&prefix=" + uriEncode(location.key, false);
+
+        HttpResponse response;
+        if (!get(location, path, query, "", response, nullptr, error)) {
+            return false;
+        }
+        const std::string& xml = response.body;
+        size_t at = 0;
+        while ((at = xml.find("<Contents>", at)) != std::string::npos) {
+            const size_t end = xml.find("</Contents>", at);
+            const std::string key = xmlValue(xml, "Key", at, end);
+            if (isImageKey(key)) {
+                ObjectInfo object;
+                object.url = location.urlPrefix + key;
+                object.size = std::strtoull(xmlValue(xml, "Size", at, end).c_str(), nullptr, 10);
+                objects.push_back(object);
+            }
+            at = end == std::string::npos ? xml.size() : end;
+        }
+        token = xmlValue(xml, "IsTruncated") == "true" ? xmlValue(xml, "NextContinuationToken")
+                                                        : "";
+    } while (!token.empty());
+
+    std::sort(objects.begin(), objects.end(),
+              [](const ObjectInfo& a, const ObjectInfo& b) { return a.url < b.url; });
+    return true;
+}
+
+/**
+ * @brief First range, then the rest of a large object in parallel
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ObjectStore::fetch(const std::string& url, std::vector<unsigned char>& bytes,
+                        std::string* error) const {
+    bytes.clear();
+    Location location;
+    if (!locate(url, location, error)) {
+        return false;
+    }
+    const std::string path = location.bucketPath + "/" + uriEncode(location.key, true);
+
+    HttpResponse first;
+    std::string headers;
+    if (!get(location, path, "", "bytes=0-" + std::to_string(RANGE_BYTES - 1), first,
+             &headers, error)) {
+        return false;
+    }
+
+    // 206 with "content-range: bytes 0-N/TOTAL"; 200 means the whole object
+    uint64_t total = first.body.size();
+    const size_t field = headers.find("\r\ncontent-range:");
+    if (first.status == 206 && field != std::string::npos) {
+        const size_t slash = headers.find('/', field);
+        if (slash != std::string::npos) {
+            total = std::strtoull(headers.c_str() + slash + 1, nullptr, 10);
+        }
+    }
+    if (total < first.body.size()) {
+        return fail(error, "inconsistent Content-Range");
+    }
+    bytes.resize(static_cast<size_t>(total));
+    std::memcpy(bytes.data(), first.body.data(), first.body.size());
+
+    // Remaining ranges, one thread each
+    std::vector<std::thread> threads;
+    std::vector<std::string> errors;
+    const size_t parts = (bytes.size() - first.body.size() + RANGE_BYTES - 1) / RANGE_BYTES;
+    errors.resize(parts);
+    for (size_t p = 0; p < parts; p++) {
+        threads.emplace_back([&, p]() {
+            const size_t begin = first.body.size() + p * RANGE_BYTES;
+            const size_t end = std::min(bytes.size(), begin + RANGE_BYTES);
+            HttpResponse part;
+            const std::string range = "bytes=" + std::to_string(begin) + "-" +
+                                      std::to_string(end - 1);
+            if (!get(location, path, "", range, part, nullptr, &errors[p])) {
+                return;
+            }
+            if (part.status != 206 || part.body.size() != end - begin) {
+                errors[p] = "short range response";
+                return;
+            }
+            std::memcpy(bytes.data() + begin, part.body.data(), part.body.size());
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& reason : errors) {
+        if (!reason.empty()) {
+            bytes.clear();
+            return fail(error, reason);
+        }
+    }
+    return true;
+}
+
+} // namespace cbir
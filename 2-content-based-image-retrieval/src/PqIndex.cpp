@@ -0,0 +1,618 @@
+////////////////////////////////////////////////////////////////////////////////
+// PqIndex.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the flat PQ / OPQ index: variance-balanced
+//              subspace allocation, rotation learning, codebook training,
+//              parallel encoding, lookup-table scans with exact reranking,
+//              and persistence.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "PqIndex.h"
+#include "DistanceKernels.h"
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <numeric>
+
+namespace cbir {
+
+namespace {
+
+const char PQ_MAGIC[8] = {'C', 'B', 'I', 'R', 'P', 'Q', 'I', 'X'};
+const uint32_t PQ_VERSION = 1;
+
+/// Training sample bound for the codebooks
+const int MAX_TRAIN_SAMPLES = 65536;
+
+/// Samples used for each rotation update (a strided subset)
+const int ROTATION_TRAIN_SAMPLES = 16384;
+
+/// Alternations of codebook training and rotation updates
+const int OPQ_ITERATIONS = 4;
+
+/// Largest automatic code size in bytes
+const int MAX_AUTO_SUBQUANTIZERS = 256;
+
+/// Codes scored per parallel work item
+const int SCAN_BLOCK_CODES = 16384;
+
+/// On-disk header of a saved index
+struct PqHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metric;
+    uint64_t count;
+    uint32_t dimension;
+    uint32_t subquantizers;
+    uint32_t codebookSize;
+    uint32_t refine;
+    uint32_t permuted;      ///< 1 if a permutation follows
+    uint32_t rotated;       ///< 1 if a rotation follows
+    uint64_t signature;
+};
+
+/// Rows i * rows / count of a matrix (all rows if it has no more than count)
+cv::Mat stridedRows(const cv::Mat& samples, int count) {
+    if (samples.rows <= count) {
+        return samples;
+    }
+    cv::Mat subset(count, samples.cols, samples.type());
+    for (int i = 0; i < count; i++) {
+        samples.row(static_cast<int>(static_cast<int64_t>(i) * samples.rows / count))
+            .copyTo(subset.row(i));
+    }
+    return subset;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+PqIndex::PqIndex(AnnMetric metric, bool rotate, int subquantizers, int refine)
+    : AnnIndex(metric), rotate_(rotate), requestedSubquantizers_(std::max(0, subquantizers)),
+      subquantizers_(0), codebookSize_(0), refine_(std::max(1, refine)) {
+}
+
+/**
+ * @brief Learn the transform and codebooks, then encode every row
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::build(const FeatureDatabase& database) {
+    if (database.empty()) {
+        std::cerr << "Error: Cannot build PQ index over an empty database" << std::endl;
+        return false;
+    }
+    if (database.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        std::cerr << "Error: PQ index supports at most 2^31 - 1 rows" << std::endl;
+        return false;
+    }
+
+    count_ = database.size();
+    dimension_ = database.dimension();
+    subquantizers_ = requestedSubquantizers_ > 0
+        ? requestedSubquantizers_
+        : std::min(MAX_AUTO_SUBQUANTIZERS, std::max(1, dimension_ / 8));
+    subquantizers_ = std::min(subquantizers_, dimension_);
+    subOffsets_.resize(subquantizers_ + 1);
+    for (int j = 0; j <= subquantizers_; j++) {
+        subOffsets_[j] = static_cast<int>(static_cast<int64_t>(j) * dimension_ / subquantizers_);
+    }
+
+    std::cout << "Building " << getIndexName() << " index (" << subquantizers_
+              << " bytes/vector instead of " << dimension_ * sizeof(float) << ") over "
+              << count_ << " vectors..." << std::endl;
+    int64 startTicks = cv::getTickCount();
+
+    // Evenly strided training sample
+    const int sampleCount = static_cast<int>(std::min<size_t>(count_, MAX_TRAIN_SAMPLES));
+    cv::Mat samples(sampleCount, dimension_, CV_32F);
+    for (int i = 0; i < sampleCount; i++) {
+        loadVector(database, static_cast<size_t>(i) * count_ / sampleCount, samples.ptr<float>(i));
+    }
+    codebookSize_ = std::min(256, sampleCount);
+
+    permutation_.clear();
+    rotation_.clear();
+    if (rotate_) {
+        std::cout << "  Balancing subspace variance..." << std::endl;
+        balancePermutation(samples);
+        if (dimension_ <= MAX_ROTATION_DIMENSION) {
+            cv::Mat permuted(sampleCount, dimension_, CV_32F);
+            for (int i = 0; i < sampleCount; i++) {
+                transform(samples.ptr<float>(i), permuted.ptr<float>(i));
+            }
+            if (!learnRotation(permuted)) {
+                return false;
+            }
+        }
+    }
+
+    // Final codebooks on the fully transformed sample
+    std::cout << "  Training " << subquantizers_ << " codebooks on " << sampleCount
+              << " samples..." << std::endl;
+    cv::Mat transformed(sampleCount, dimension_, CV_32F);
+    for (int i = 0; i < sampleCount; i++) {
+        transform(samples.ptr<float>(i), transformed.ptr<float>(i));
+    }
+    if (!trainCodebooks(transformed)) {
+        return false;
+    }
+
+    // Encode every row
+    codes_.assign(count_ * subquantizers_, 0);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(count_)), [&](const cv::Range& range) {
+        std::vector<float> vector(dimension_);
+        std::vector<float> rotated(dimension_);
+        for (int row = range.start; row < range.end; row++) {
+            loadVector(database, row, vector.data());
+            transform(vector.data(), rotated.data());
+            encode(rotated.data(), &codes_[static_cast<size_t>(row) * subquantizers_]);
+        }
+    });
+
+    signature_ = databaseSignature(database);
+    database_ = &database;
+
+    double seconds = (cv::getTickCount() - startTicks) / cv::getTickFrequency();
+    std::cout << getIndexName() << " index built in " << seconds << " s ("
+              << memoryBytes() / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Attach a loaded index to its database
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::attach(const FeatureDatabase& database) {
+    if (subquantizers_ == 0) {
+        std::cerr << "Error: PQ index is not loaded" << std::endl;
+        return false;
+    }
+    if (database.size() != count_ || database.dimension() != dimension_ ||
+        databaseSignature(database) != signature_) {
+        std::cerr << "Error: PQ index does not match the feature database (stale index)"
+                  << std::endl;
+        return false;
+    }
+    database_ = &database;
+    return true;
+}
+
+/**
+ * @brief Score every code with per-subspace lookup tables, then rerank
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::search(const cv::Mat& query, int k, std::vector<AnnResult>& results) const {
+    results.clear();
+    if (!isReady()) {
+        std::cerr << "Error: PQ index is not attached to a database" << std::endl;
+        return false;
+    }
+    if (k <= 0) {
+        return true;
+    }
+
+    std::vector<float> rawQuery;
+    if (!prepareQuery(query, rawQuery)) {
+        return false;
+    }
+    const double rawNorm = vectorNorm(rawQuery.data(), dimension_);
+    std::vector<float> q(rawQuery);
+    if (metric_ == AnnMetric::Cosine && rawNorm >= 1e-10) {
+        for (float& value : q) {
+            value = static_cast<float>(value / rawNorm);
+        }
+    }
+    std::vector<float> t(dimension_);
+    transform(q.data(), t.data());
+
+    // table[j][c] = || t_j - codebook_j[c] ||²
+    std::vector<float> table(static_cast<size_t>(subquantizers_) * codebookSize_);
+    for (int j = 0; j < subquantizers_; j++) {
+        const int width = subOffsets_[j + 1] - subOffsets_[j];
+        const float* codebook = &codebooks_[static_cast<size_t>(codebookSize_) * subOffsets_[j]];
+        for (int c = 0; c < codebookSize_; c++) {
+            table[static_cast<size_t>(j) * codebookSize_ + c] = DistanceKernels::squaredDifference(
+                &t[subOffsets_[j]], codebook + static_cast<size_t>(c) * width, width);
+        }
+    }
+
+    // Per-worker bounded max-heaps of estimates, merged under a mutex
+    const bool rerank = refine_ > 1;
+    const size_t shortlist = std::min(count_, static_cast<size_t>(k) * (rerank ? refine_ : 1));
+    const int blockCount = static_cast<int>((count_ + SCAN_BLOCK_CODES - 1) / SCAN_BLOCK_CODES);
+    std::vector<std::pair<float, int>> survivors;
+    std::mutex mergeMutex;
+    cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+        std::vector<std::pair<float, int>> heap;
+        heap.reserve(shortlist + 1);
+        for (int block = range.start; block < range.end; block++) {
+            const size_t start = static_cast<size_t>(block) * SCAN_BLOCK_CODES;
+            const size_t end = std::min(count_, start + SCAN_BLOCK_CODES);
+            for (size_t row = start; row < end; row++) {
+                const uint8_t* code = &codes_[row * subquantizers_];
+                float distance = 0.0f;
+                for (int j = 0; j < subquantizers_; j++) {
+                    distance += table[static_cast<size_t>(j) * codebookSize_ + code[j]];
+                }
+                if (heap.size() == shortlist && distance >= heap.front().first) {
+                    continue;
+                }
+                heap.emplace_back(distance, static_cast<int>(row));
+                std::push_heap(heap.begin(), heap.end());
+                if (heap.size() > shortlist) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        survivors.insert(survivors.end(), heap.begin(), heap.end());
+    });
+
+    const size_t keep = std::min(survivors.size(), shortlist);
+    std::partial_sort(survivors.begin(), survivors.begin() + keep, survivors.end());
+    survivors.resize(keep);
+
+    std::vector<AnnResult> candidates;
+    candidates.reserve(survivors.size());
+    for (const auto& survivor : survivors) {
+        double distance = survivor.first;
+        if (rerank) {
+            // Full-precision row from the (mapped) database file
+            cv::Mat row = database_->getFeaturesAt(static_cast<size_t>(survivor.second));
+            const float* values = row.ptr<float>();
+            distance = exactDistance(rawQuery.data(), rawNorm, values, vectorNorm(values, dimension_));
+        } else if (metric_ == AnnMetric::Cosine) {
+            // Unit vectors: ||a - b||² = 2 - 2 cos
+            distance *= 0.5;
+        }
+        candidates.emplace_back(distance, survivor.second);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    if (candidates.size() > static_cast<size_t>(k)) {
+        candidates.resize(k);
+    }
+    results.swap(candidates);
+    return true;
+}
+
+/**
+ * @brief Save the transform, codebooks and codes
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::save(const std::string& filename) const {
+    if (subquantizers_ == 0) {
+        std::cerr << "Error: No PQ index to save" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << filename << std::endl;
+        return false;
+    }
+
+    PqHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PQ_MAGIC, sizeof(PQ_MAGIC));
+    header.version = PQ_VERSION;
+    header.metric = static_cast<uint32_t>(metric_);
+    header.count = count_;
+    header.dimension = static_cast<uint32_t>(dimension_);
+    header.subquantizers = static_cast<uint32_t>(subquantizers_);
+    header.codebookSize = static_cast<uint32_t>(codebookSize_);
+    header.refine = static_cast<uint32_t>(refine_);
+    header.permuted = permutation_.empty() ? 0 : 1;
+    header.rotated = rotation_.empty() ? 0 : 1;
+    header.signature = signature_;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(permutation_.data()),
+               static_cast<std::streamsize>(permutation_.size() * sizeof(int)));
+    file.write(reinterpret_cast<const char*>(rotation_.data()),
+               static_cast<std::streamsize>(rotation_.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(subOffsets_.data()),
+               static_cast<std::streamsize>(subOffsets_.size() * sizeof(int)));
+    file.write(reinterpret_cast<const char*>(codebooks_.data()),
+               static_cast<std::streamsize>(codebooks_.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(codes_.data()),
+               static_cast<std::streamsize>(codes_.size()));
+
+    if (!file.good()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Saved " << getIndexName() << " index to: " << filename << std::endl;
+    return true;
+}
+
+/**
+ * @brief Load a saved index and validate its transform and codes
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    PqHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() || std::memcmp(header.magic, PQ_MAGIC, sizeof(PQ_MAGIC)) != 0 ||
+        header.version != PQ_VERSION) {
+        std::cerr << "Error: " << filename << " is not a version " << PQ_VERSION
+                  << " PQ index" << std::endl;
+        return false;
+    }
+    if (header.metric != static_cast<uint32_t>(metric_)) {
+        std::cerr << "Error: " << filename << " was built for a different metric" << std::endl;
+        return false;
+    }
+    if (header.count == 0 || header.count > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+        header.dimension == 0 || header.subquantizers == 0 ||
+        header.subquantizers > header.dimension || header.codebookSize == 0 ||
+        header.codebookSize > 256) {
+        std::cerr << "Error: " << filename << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    count_ = static_cast<size_t>(header.count);
+    dimension_ = static_cast<int>(header.dimension);
+    subquantizers_ = static_cast<int>(header.subquantizers);
+    codebookSize_ = static_cast<int>(header.codebookSize);
+    refine_ = std::max(1, static_cast<int>(header.refine));
+    rotate_ = header.permuted != 0 || header.rotated != 0;
+    signature_ = header.signature;
+    database_ = nullptr;
+
+    permutation_.resize(header.permuted != 0 ? dimension_ : 0);
+    rotation_.resize(header.rotated != 0 ? static_cast<size_t>(dimension_) * dimension_ : 0);
+    subOffsets_.resize(subquantizers_ + 1);
+    codebooks_.resize(static_cast<size_t>(codebookSize_) * dimension_);
+    codes_.resize(count_ * subquantizers_);
+
+    file.read(reinterpret_cast<char*>(permutation_.data()),
+              static_cast<std::streamsize>(permutation_.size() * sizeof(int)));
+    file.read(reinterpret_cast<char*>(rotation_.data()),
+              static_cast<std::streamsize>(rotation_.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(subOffsets_.data()),
+              static_cast<std::streamsize>(subOffsets_.size() * sizeof(int)));
+    file.read(reinterpret_cast<char*>(codebooks_.data()),
+              static_cast<std::streamsize>(codebooks_.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(codes_.data()),
+              static_cast<std::streamsize>(codes_.size()));
+
+    bool valid = file.good() && subOffsets_.front() == 0 && subOffsets_.back() == dimension_;
+    for (int j = 0; valid && j < subquantizers_; j++) {
+        valid = subOffsets_[j] < subOffsets_[j + 1];
+    }
+    std::vector<uint8_t> seen(dimension_, 0);
+    for (size_t i = 0; valid && i < permutation_.size(); i++) {
+        valid = permutation_[i] >= 0 && permutation_[i] < dimension_ && !seen[permutation_[i]];
+        if (valid) {
+            seen[permutation_[i]] = 1;
+        }
+    }
+    for (size_t i = 0; valid && i < codes_.size(); i++) {
+        valid = codes_[i] < codebookSize_;
+    }
+
+    if (!valid) {
+        std::cerr << "Error: " << filename << " is truncated or corrupt" << std::endl;
+        count_ = 0;
+        subquantizers_ = 0;
+        return false;
+    }
+
+    std::cout << "Loaded " << getIndexName() << " index from: " << filename << " (" << count_
+              << " vectors)" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Index name
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::string PqIndex::getIndexName() const {
+    return rotate_ ? "OPQ" : "PQ";
+}
+
+/**
+ * @brief Transform, codebook and code memory
+ *
+ * @author Krushna Sanjay Sharma
+ */
+size_t PqIndex::memoryBytes() const {
+    return (rotation_.size() + codebooks_.size()) * sizeof(float) +
+           (permutation_.size() + subOffsets_.size()) * sizeof(int) + codes_.size();
+}
+
+/**
+ * @brief Database row as float32, unit length for cosine
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void PqIndex::loadVector(const FeatureDatabase& database, size_t row, float* out) const {
+    cv::Mat features = database.getFeaturesAt(row);
+    const float* values = features.ptr<float>();
+    std::copy(values, values + dimension_, out);
+
+    if (metric_ == AnnMetric::Cosine) {
+        double norm = vectorNorm(out, dimension_);
+        if (norm >= 1e-10) {
+            for (int d = 0; d < dimension_; d++) {
+                out[d] = static_cast<float>(out[d] / norm);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Permute, then rotate
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void PqIndex::transform(const float* in, float* out) const {
+    if (permutation_.empty()) {
+        std::copy(in, in + dimension_, out);
+    } else {
+        for (int d = 0; d < dimension_; d++) {
+            out[d] = in[permutation_[d]];
+        }
+    }
+    if (rotation_.empty()) {
+        return;
+    }
+
+    const std::vector<float> permuted(out, out + dimension_);
+    for (int i = 0; i < dimension_; i++) {
+        const float* axis = &rotation_[static_cast<size_t>(i) * dimension_];
+        float dot = 0.0f;
+        float squares = 0.0f;
+        DistanceKernels::dotAndSquares(axis, permuted.data(), dimension_, &dot, &squares);
+        out[i] = dot;
+    }
+}
+
+/**
+ * @brief Nearest centroid of each subspace
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void PqIndex::encode(const float* transformed, uint8_t* code) const {
+    for (int j = 0; j < subquantizers_; j++) {
+        const int width = subOffsets_[j + 1] - subOffsets_[j];
+        const float* codebook = &codebooks_[static_cast<size_t>(codebookSize_) * subOffsets_[j]];
+        code[j] = static_cast<uint8_t>(
+            nearestCentroid(transformed + subOffsets_[j], codebook, codebookSize_, width));
+    }
+}
+
+/**
+ * @brief k-means per subspace
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::trainCodebooks(const cv::Mat& samples) {
+    codebooks_.assign(static_cast<size_t>(codebookSize_) * dimension_, 0.0f);
+    for (int j = 0; j < subquantizers_; j++) {
+        cv::Mat subspace = samples.colRange(subOffsets_[j], subOffsets_[j + 1]).clone();
+        cv::Mat centers;
+        if (!trainCentroids(subspace, codebookSize_, centers)) {
+            return false;
+        }
+        std::copy(centers.ptr<float>(), centers.ptr<float>() + centers.total(),
+                  codebooks_.begin() + static_cast<size_t>(codebookSize_) * subOffsets_[j]);
+    }
+    return true;
+}
+
+/**
+ * @brief Eigenvalue allocation (Ge et al.) on per-dimension variances
+ *
+ * Dimensions are taken in order of decreasing variance and each goes to
+ * the subspace with free width whose variance product (sum of logs) is
+ * smallest, so no subspace is left with only near-empty bins.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void PqIndex::balancePermutation(const cv::Mat& samples) {
+    cv::Mat mean;
+    cv::Mat variance;
+    cv::reduce(samples, mean, 0, cv::REDUCE_AVG, CV_64F);
+    cv::Mat squares = samples.mul(samples);
+    cv::reduce(squares, variance, 0, cv::REDUCE_AVG, CV_64F);
+    variance -= mean.mul(mean);
+
+    std::vector<int> order(dimension_);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&variance](int a, int b) {
+        return variance.at<double>(a) > variance.at<double>(b);
+    });
+
+    std::vector<double> logProduct(subquantizers_, 0.0);
+    std::vector<std::vector<int>> members(subquantizers_);
+    for (int dimension : order) {
+        int target = -1;
+        for (int j = 0; j < subquantizers_; j++) {
+            const size_t width = static_cast<size_t>(subOffsets_[j + 1] - subOffsets_[j]);
+            if (members[j].size() < width &&
+                (target < 0 || logProduct[j] < logProduct[target])) {
+                target = j;
+            }
+        }
+        members[target].push_back(dimension);
+        logProduct[target] += std::log(std::max(variance.at<double>(dimension), 1e-12));
+    }
+
+    permutation_.clear();
+    permutation_.reserve(dimension_);
+    for (const std::vector<int>& subspace : members) {
+        permutation_.insert(permutation_.end(), subspace.begin(), subspace.end());
+    }
+}
+
+/**
+ * @brief Non-parametric OPQ: alternate codebooks and orthogonal Procrustes
+ *
+ * With Y = X R^T and reconstructions Yq from the current codebooks, the
+ * rotation minimising ||X R^T - Yq|| is R^T = U V^T for X^T Yq = U S V^T.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool PqIndex::learnRotation(const cv::Mat& permuted) {
+    std::cout << "  Learning OPQ rotation (" << OPQ_ITERATIONS << " iterations)..." << std::endl;
+    const cv::Mat x = stridedRows(permuted, ROTATION_TRAIN_SAMPLES);
+    cv::Mat rotation = cv::Mat::eye(dimension_, dimension_, CV_32F);
+    const int savedCodebookSize = codebookSize_;
+    codebookSize_ = std::min(codebookSize_, x.rows);
+
+    std::vector<uint8_t> code(subquantizers_);
+    for (int iteration = 0; iteration < OPQ_ITERATIONS; iteration++) {
+        cv::Mat y;
+        cv::gemm(x, rotation, 1.0, cv::noArray(), 0.0, y, cv::GEMM_2_T);
+        if (!trainCodebooks(y)) {
+            return false;
+        }
+
+        cv::Mat reconstructed(y.rows, dimension_, CV_32F);
+        for (int i = 0; i < y.rows; i++) {
+            encode(y.ptr<float>(i), code.data());
+            float* out = reconstructed.ptr<float>(i);
+            for (int j = 0; j < subquantizers_; j++) {
+                const int width = subOffsets_[j + 1] - subOffsets_[j];
+                const float* centroid = &codebooks_[static_cast<size_t>(codebookSize_) * subOffsets_[j] +
+                                                    static_cast<size_t>(code[j]) * width];
+                std::copy(centroid, centroid + width, out + subOffsets_[j]);
+            }
+        }
+
+        cv::Mat correlation;
+        cv::gemm(x, reconstructed, 1.0, cv::noArray(), 0.0, correlation, cv::GEMM_1_T);
+        cv::Mat w, u, vt;
+        cv::SVD::compute(correlation, w, u, vt);
+        rotation = (u * vt).t();
+    }
+
+    codebookSize_ = savedCodebookSize;
+    cv::Mat continuous = rotation.isContinuous() ? rotation : rotation.clone();
+    rotation_.assign(continuous.ptr<float>(), continuous.ptr<float>() + continuous.total());
+    return true;
+}
+
+} // namespace cbir
@@ -11,11 +11,20 @@ namespace cbir {
 
 ProductMatcherDistance::ProductMatcherDistance()
     : dnnWeight_(0.85), colorWeight_(0.15) {
+    buildFusion();
 }
 
 ProductMatcherDistance::ProductMatcherDistance(double dnnWeight, double colorWeight)
     : dnnWeight_(dnnWeight), colorWeight_(colorWeight) {
     normalizeWeights();
+    buildFusion();
+}
+
+void ProductMatcherDistance::buildFusion() {
+    fusion_ = LateFusion({
+        {LateFusion::SEGMENT_COSINE, 0, DNN_DIM, dnnWeight_},
+        {LateFusion::SEGMENT_INTERSECTION, DNN_DIM, COLOR_DIM, colorWeight_}
+    });
 }
 
 double ProductMatcherDistance::compute(const cv::Mat& features1, 
@@ -43,6 +52,39 @@ double ProductMatcherDistance::compute(const cv::Mat& features1,
     return combinedDist;
 }
 
+bool ProductMatcherDistance::computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                                          cv::Mat& out) {
+    if (!checkBatch(query, matrix)) {
+        return false;
+    }
+    if (matrix.cols != TOTAL_DIM) {
+        std::cerr << "Error: Expected " << TOTAL_DIM << "D features, got "
+                  << matrix.cols << std::endl;
+        return false;
+    }
+    
+    cv::Mat queryData = query.isContinuous() ? query : query.clone();
+    LateFusion::Query prepared;
+    fusion_.prepare(queryData.ptr<float>(), prepared);
+    
+    return runBatch(queryData, matrix, out,
+                    [this, &prepared](const float*, const float* rowData, int) {
+        return fusion_.score(prepared, rowData);
+    });
+}
+
+double ProductMatcherDistance::computeWithCutoff(const cv::Mat& features1,
+                                                 const cv::Mat& features2, double cutoff) {
+    if (!areFloatArrays(features1, features2) ||
+        features1.total() != static_cast<size_t>(TOTAL_DIM)) {
+        return compute(features1, features2);
+    }
+    
+    LateFusion::Query prepared;
+    fusion_.prepare(features1.ptr<float>(), prepared);
+    return fusion_.scoreWithCutoff(prepared, features2.ptr<float>(), cutoff);
+}
+
 std::string ProductMatcherDistance::getMetricName() const {
     return "ProductMatcherDistance";
 }
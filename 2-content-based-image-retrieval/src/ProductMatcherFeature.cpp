@@ -22,6 +22,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "ProductMatcherFeature.h"
+#include "ImageContext.h"
 #include <iostream>
 
 namespace cbir {
@@ -60,6 +61,14 @@ cv::Mat ProductMatcherFeature::extractFeatures(const cv::Mat& image) {
     return cv::Mat();
 }
 
+/**
+ * Extract features from a shared context (filename taken from the context)
+ */
+cv::Mat ProductMatcherFeature::extractFromContext(ImageContext& context) {
+    return extractFromRegion(context.image(), context.fullSize(), context.offset(),
+                             context.filename());
+}
+
 /**
  * Extract combined DNN + center-color features
  * 
@@ -67,6 +76,16 @@ cv::Mat ProductMatcherFeature::extractFeatures(const cv::Mat& image) {
  */
 cv::Mat ProductMatcherFeature::extractFeaturesWithFilename(const cv::Mat& image, 
                                                           const std::string& filename) {
+    return extractFromRegion(image, image.size(), cv::Point(), filename);
+}
+
+/**
+ * Combined features; image may be a crop of the whole image (batch builds
+ * decode only the center region)
+ */
+cv::Mat ProductMatcherFeature::extractFromRegion(const cv::Mat& image, const cv::Size& fullSize,
+                                                 const cv::Point& offset,
+                                                 const std::string& filename) {
     // Validate image
     if (!isValidImage(image)) {
         std::cerr << "Error: Invalid image for ProductMatcher" << std::endl;
@@ -89,7 +108,7 @@ cv::Mat ProductMatcherFeature::extractFeaturesWithFilename(const cv::Mat& image,
     }
     
     // Step 2: Extract center region (focus on subject, ignore background)
-    cv::Mat centerRegion = extractCenterRegion(image);
+    cv::Mat centerRegion = extractCenterRegion(image, fullSize, offset);
     
     if (centerRegion.empty()) {
         std::cerr << "Error: Failed to extract center region" << std::endl;
@@ -156,17 +175,22 @@ void ProductMatcherFeature::setCenterRatio(double ratio) {
  *   │    Background      │ ← Excluded (bottom margin)
  *   └────────────────────┘
  */
-cv::Mat ProductMatcherFeature::extractCenterRegion(const cv::Mat& image) const {
+cv::Mat ProductMatcherFeature::extractCenterRegion(const cv::Mat& image, const cv::Size& fullSize,
+                                                   const cv::Point& offset) const {
     // Calculate center region dimensions
-    int centerWidth = static_cast<int>(image.cols * centerRatio_);
-    int centerHeight = static_cast<int>(image.rows * centerRatio_);
+    int centerWidth = static_cast<int>(fullSize.width * centerRatio_);
+    int centerHeight = static_cast<int>(fullSize.height * centerRatio_);
     
-    // Calculate starting position (to center the region)
-    int startX = (image.cols - centerWidth) / 2;
-    int startY = (image.rows - centerHeight) / 2;
+    // Calculate starting position (to center the region), relative to the
+    // decoded part of the image
+    int startX = (fullSize.width - centerWidth) / 2 - offset.x;
+    int startY = (fullSize.height - centerHeight) / 2 - offset.y;
     
     // Define ROI (Region of Interest)
     cv::Rect centerROI(startX, startY, centerWidth, centerHeight);
+    if ((centerROI & cv::Rect(0, 0, image.cols, image.rows)) != centerROI) {
+        return cv::Mat();
+    }
     
     // Extract and clone the region
     cv::Mat centerRegion = image(centerROI).clone();
@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+// QueryCache.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the query result and feature LRU caches:
+//              key encoding, byte accounting and eviction.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "QueryCache.h"
+#include "FaceBoxCache.h"
+
+namespace cbir {
+
+namespace {
+
+/// Bookkeeping per entry: list node, index node and key copies
+const size_t ENTRY_OVERHEAD = 128;
+
+size_t matchesBytes(const std::vector<ImageMatch>& matches) {
+    size_t bytes = matches.size() * sizeof(ImageMatch);
+    for (const ImageMatch& match : matches) {
+        bytes += match.filename.capacity();
+    }
+    return bytes;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+QueryCache::QueryCache(size_t resultBytes, size_t featureBytes) {
+    results_.stats.capacityBytes = resultBytes;
+    features_.stats.capacityBytes = featureBytes;
+}
+
+/**
+ * @brief Same content hash as the face box cache
+ *
+ * @author Krushna Sanjay Sharma
+ */
+uint64_t QueryCache::hashImage(const cv::Mat& image) {
+    return FaceBoxCache::hashImage(image);
+}
+
+bool QueryCache::findResults(const ResultKey& key, std::vector<ImageMatch>& matches) {
+    const std::string encoded = encode(key);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = lookup(results_, encoded);
+    if (entry == nullptr) {
+        return false;
+    }
+    matches = entry->matches;
+    return true;
+}
+
+void QueryCache::insertResults(const ResultKey& key, const std::vector<ImageMatch>& matches) {
+    Entry entry;
+    entry.key = encode(key);
+    entry.matches.reserve(matches.size());
+    for (const ImageMatch& match : matches) {
+        entry.matches.emplace_back(match.filename, match.distance);
+    }
+    entry.bytes = ENTRY_OVERHEAD + 2 * entry.key.size() + matchesBytes(entry.matches);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    store(results_, std::move(entry));
+}
+
+bool QueryCache::findFeatures(uint64_t imageHash, const std::string& extractor,
+                              cv::Mat& features) {
+    const std::string encoded = encode(imageHash, extractor);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = lookup(features_, encoded);
+    if (entry == nullptr) {
+        return false;
+    }
+    features = entry->features;
+    return true;
+}
+
+void QueryCache::insertFeatures(uint64_t imageHash, const std::string& extractor,
+                                const cv::Mat& features) {
+    if (features.empty()) {
+        return;
+    }
+    Entry entry;
+    entry.key = encode(imageHash, extractor);
+    entry.features = features.clone();
+    entry.bytes = ENTRY_OVERHEAD + 2 * entry.key.size() +
+                  entry.features.total() * entry.features.elemSize();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    store(features_, std::move(entry));
+}
+
+void QueryCache::clearResults() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clear(results_);
+}
+
+void QueryCache::clearFeatures() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clear(features_);
+}
+
+QueryCacheStats QueryCache::resultStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_.stats;
+}
+
+QueryCacheStats QueryCache::featureStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return features_.stats;
+}
+
+/**
+ * @brief Find an entry and move it to the front of the LRU list
+ *
+ * @author Krushna Sanjay Sharma
+ */
+QueryCache::Entry* QueryCache::lookup(Lru& lru, const std::string& key) {
+    if (lru.stats.capacityBytes == 0) {
+        return nullptr;
+    }
+    auto found = lru.index.find(key);
+    if (found == lru.index.end()) {
+        lru.stats.misses++;
+        return nullptr;
+    }
+    lru.order.splice(lru.order.begin(), lru.order, found->second);
+    lru.stats.hits++;
+    return &*found->second;
+}
+
+/**
+ * @brief Insert at the front, replacing an older value, then evict from the back
+ *
+ * An entry larger than the whole budget is not cached at all.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void QueryCache::store(Lru& lru, Entry entry) {
+    if (entry.bytes > lru.stats.capacityBytes) {
+        return;
+    }
+
+    auto existing = lru.index.find(entry.key);
+    if (existing != lru.index.end()) {
+        lru.stats.bytes -= existing->second->bytes;
+        lru.order.erase(existing->second);
+        lru.index.erase(existing);
+    }
+
+    lru.stats.bytes += entry.bytes;
+    lru.order.push_front(std::move(entry));
+    lru.index[lru.order.front().key] = lru.order.begin();
+
+    while (lru.stats.bytes > lru.stats.capacityBytes) {
+        const Entry& oldest = lru.order.back();
+        lru.stats.bytes -= oldest.bytes;
+        lru.index.erase(oldest.key);
+        lru.order.pop_back();
+        lru.stats.evictions++;
+    }
+    lru.stats.entries = lru.order.size();
+}
+
+void QueryCache::clear(Lru& lru) {
+    lru.order.clear();
+    lru.index.clear();
+    lru.stats.bytes = 0;
+    lru.stats.entries = 0;
+}
+
+std::string QueryCache::encode(const ResultKey& key) {
+    return std::to_string(key.imageHash) + '|' + std::to_string(key.topN) + '|' +
+           std::to_string(key.databaseVersion) + '|' + std::to_string(key.prefilterVersion) +
+           '|' + key.scope;
+}
+
+std::string QueryCache::encode(uint64_t imageHash, const std::string& extractor) {
+    return std::to_string(imageHash) + '|' + extractor;
+}
+
+} // namespace cbir
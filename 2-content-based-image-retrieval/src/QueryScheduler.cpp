@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////
+// QueryScheduler.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the priority admission queue and of scan
+//              coalescing for the query server.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "QueryScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace cbir {
+
+const char* queryPriorityName(QueryPriority priority) {
+    switch (priority) {
+        case QueryPriority::Interactive: return "interactive";
+        case QueryPriority::Normal:      return "normal";
+        case QueryPriority::Batch:       return "batch";
+    }
+    return "normal";
+}
+
+bool parseQueryPriority(const std::string& name, QueryPriority& priority) {
+    const std::string lower = Utils::toLower(name);
+    for (int p = 0; p < QUERY_PRIORITY_COUNT; p++) {
+        if (lower == queryPriorityName(static_cast<QueryPriority>(p))) {
+            priority = static_cast<QueryPriority>(p);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Constructor - every slot starts free
+ *
+ * @author Krushna Sanjay Sharma
+ */
+QueryScheduler::QueryScheduler(int slots, size_t queueCapacity)
+    : slots_(std::max(1, slots)), queueCapacity_(queueCapacity) {
+    for (int s = slots_ - 1; s >= 0; s--) {
+        freeSlots_.push_back(s);
+    }
+}
+
+/**
+ * @brief Take a free slot, or queue (evicting a lower class if full) and
+ *        wait until one is handed over, the query is evicted or the
+ *        deadline passes
+ *
+ * @author Krushna Sanjay Sharma
+ */
+QueryTicket QueryScheduler::acquire(QueryPriority priority, double timeoutMs) {
+    const auto start = std::chrono::steady_clock::now();
+    const int cls = static_cast<int>(priority);
+    QueryTicket ticket;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!freeSlots_.empty()) {
+        ticket.admitted = true;
+        ticket.slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        stats_[cls].admitted++;
+        return ticket;
+    }
+    if (timeoutMs >= 0.0 && timeoutMs < 1.0) {      // not worth queueing
+        stats_[cls].expired++;
+        ticket.status = 504;
+        ticket.reason = "Deadline passed before the query could run";
+        return ticket;
+    }
+
+    if (queue_.size() >= queueCapacity_) {
+        auto victim = evictionCandidate(priority);
+        if (victim == queue_.end()) {
+            stats_[cls].shed++;
+            ticket.status = 503;
+            ticket.reason = "Server busy: admission queue full";
+            return ticket;
+        }
+        Waiter* evicted = *victim;
+        queue_.erase(victim);
+        stats_[static_cast<int>(evicted->priority)].queued--;
+        stats_[static_cast<int>(evicted->priority)].shed++;
+        evicted->status = 503;
+        evicted->wake.notify_one();
+    }
+
+    Waiter waiter;
+    waiter.priority = priority;
+    queue_.push_back(&waiter);
+    stats_[cls].queued++;
+
+    const auto deadline = start + std::chrono::microseconds(
+        static_cast<int64_t>(std::max(0.0, timeoutMs) * 1000.0));
+    while (waiter.status == 0) {
+        if (timeoutMs < 0.0) {
+            waiter.wake.wait(lock);
+        } else if (waiter.wake.wait_until(lock, deadline) == std::cv_status::timeout &&
+                   waiter.status == 0) {
+            queue_.remove(&waiter);
+            stats_[cls].queued--;
+            stats_[cls].expired++;
+            waiter.status = 504;
+        }
+    }
+    lock.unlock();
+
+    ticket.waitMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    if (waiter.status == 200) {
+        ticket.admitted = true;
+        ticket.slot = waiter.slot;
+    } else if (waiter.status == 503) {
+        ticket.status = 503;
+        ticket.reason = "Server busy: shed for a higher-priority query";
+    } else {
+        ticket.status = 504;
+        ticket.reason = "Deadline passed while queued";
+    }
+    return ticket;
+}
+
+/**
+ * @brief Hand the slot to the next waiter, or free it
+ *
+ * @author Krushna Sanjay Sharma
+ */
+void QueryScheduler::release(const QueryTicket& ticket) {
+    if (!ticket.admitted) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto next = nextWaiter();
+    if (next == queue_.end()) {
+        freeSlots_.push_back(ticket.slot);
+        return;
+    }
+    Waiter* waiter = *next;
+    queue_.erase(next);
+    const int cls = static_cast<int>(waiter->priority);
+    stats_[cls].queued--;
+    stats_[cls].admitted++;
+    waiter->slot = ticket.slot;
+    waiter->status = 200;
+    waiter->wake.notify_one();
+}
+
+SchedulerClassStats QueryScheduler::stats(QueryPriority priority) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_[static_cast<int>(priority)];
+}
+
+int QueryScheduler::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_ - static_cast<int>(freeSlots_.size());
+}
+
+std::list<QueryScheduler::Waiter*>::iterator QueryScheduler::nextWaiter() {
+    // queue_ is in arrival order, so the first of the best class is oldest
+    auto best = queue_.end();
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+        if (best == queue_.end() || (*it)->priority < (*best)->priority) {
+            best = it;
+        }
+    }
+    return best;
+}
+
+std::list<QueryScheduler::Waiter*>::iterator QueryScheduler::evictionCandidate(
+        QueryPriority priority) {
+    // Newest query of the lowest class below the newcomer's
+    auto victim = queue_.end();
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+        if ((*it)->priority > priority &&
+            (victim == queue_.end() || (*it)->priority >= (*victim)->priority)) {
+            victim = it;
+        }
+    }
+    return victim;
+}
+
+// -----------------------------------------------------------------------------
+// QueryCoalescer
+// -----------------------------------------------------------------------------
+
+QueryCoalescer::QueryCoalescer()
+    : scanning_(false), nextSequence_(0), scans_(0), requests_(0) {}
+
+/**
+ * @brief Join an open group of the same top N or start one, then either
+ *        wait for the group's scan or, as its first member, run it when
+ *        the collection is free and no group of a higher class is waiting
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::vector<std::vector<ImageMatch>> QueryCoalescer::search(const cv::Mat& rows, int topN,
+                                                            QueryPriority priority,
+                                                            const Search& scan,
+                                                            int* scanRows) {
+    const bool small = rows.rows <= MAX_REQUEST_ROWS;
+    std::shared_ptr<Group> group;
+    bool leader = false;
+    int offset = 0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (small) {
+        for (const auto& candidate : pending_) {
+            if (candidate->open && candidate->topN == topN &&
+                candidate->rows.rows + rows.rows <= MAX_GROUP_ROWS) {
+                group = candidate;
+                break;
+            }
+        }
+    }
+    if (group) {
+        offset = group->rows.rows;
+        group->rows.push_back(rows);
+        group->priority = std::min(group->priority, priority);
+    } else {
+        leader = true;
+        group = std::make_shared<Group>();
+        group->topN = topN;
+        group->priority = priority;
+        group->sequence = nextSequence_++;
+        group->open = small;
+        group->rows = rows.clone();
+        pending_.push_back(group);
+    }
+    requests_++;
+
+    if (leader) {
+        changed_.wait(lock, [&] { return !scanning_ && nextGroup() == group; });
+        scanning_ = true;
+        group->open = false;
+        pending_.remove(group);
+        scans_++;
+        lock.unlock();
+
+        std::vector<std::vector<ImageMatch>> results = scan(group->rows, topN);
+        results.resize(group->rows.rows);
+
+        lock.lock();
+        group->results = std::move(results);
+        group->done = true;
+        scanning_ = false;
+        changed_.notify_all();
+    } else {
+        changed_.wait(lock, [&] { return group->done; });
+    }
+
+    if (scanRows != nullptr) {
+        *scanRows = group->rows.rows;
+    }
+    return std::vector<std::vector<ImageMatch>>(group->results.begin() + offset,
+                                                group->results.begin() + offset + rows.rows);
+}
+
+uint64_t QueryCoalescer::getScans() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scans_;
+}
+
+uint64_t QueryCoalescer::getRequests() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requests_;
+}
+
+std::shared_ptr<QueryCoalescer::Group> QueryCoalescer::nextGroup() const {
+    std::shared_ptr<Group> best;
+    for (const auto& group : pending_) {
+        if (!best || group->priority < best->priority ||
+            (group->priority == best->priority && group->sequence < best->sequence)) {
+            best = group;
+        }
+    }
+    return best;
+}
+
+} // namespace cbir
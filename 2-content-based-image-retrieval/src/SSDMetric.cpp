@@ -8,8 +8,12 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "SSDMetric.h"
+#include "DistanceKernels.h"
 #include <iostream>
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
+#include <vector>
 
 namespace cbir {
 
@@ -58,6 +62,42 @@ double SSDMetric::compute(const cv::Mat& features1, const cv::Mat& features2) {
     return ssd;
 }
 
+/**
+ * @brief Batched SSD over a feature matrix
+ * 
+ * The per-row loop is the vectorised squared-difference kernel (or its
+ * quantised variant for uint8 storage); the scalar compute() above stays
+ * the reference implementation.
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+bool SSDMetric::computeBatch(const cv::Mat& query, const cv::Mat& matrix, cv::Mat& out) {
+    return runBatch(query, matrix, out,
+                    [](const float* queryData, const float* rowData, int length) {
+        return static_cast<double>(
+            DistanceKernels::squaredDifference(queryData, rowData, length));
+    },
+                    [](const float* queryData, const uint8_t* codes, float scale, int length) {
+        return static_cast<double>(
+            DistanceKernels::squaredDifferenceQuantized(queryData, codes, length, scale));
+    });
+}
+
+/**
+ * @brief Early-abandoning SSD for top-K scans
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+double SSDMetric::computeWithCutoff(const cv::Mat& features1, const cv::Mat& features2,
+                                    double cutoff) {
+    if (!areFloatArrays(features1, features2)) {
+        return compute(features1, features2);
+    }
+    return static_cast<double>(DistanceKernels::squaredDifferenceBounded(
+        features1.ptr<float>(), features2.ptr<float>(), static_cast<int>(features1.total()),
+        static_cast<float>(std::min(cutoff, static_cast<double>(FLT_MAX)))));
+}
+
 /**
  * @brief Get metric name
  * 
@@ -67,4 +107,48 @@ std::string SSDMetric::getMetricName() const {
     return "SSD";
 }
 
+/**
+ * @brief Block SSD through one matrix product
+ * 
+ * The row norms are computed once per call and shared by all queries.
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+bool SSDMetric::computeBlock(const cv::Mat& queries, const cv::Mat& matrix, cv::Mat& out) {
+    if (!checkBlock(queries, matrix)) {
+        return false;
+    }
+
+    cv::Mat staging;
+    const cv::Mat rows = floatRows(matrix, staging);
+    const int length = rows.cols;
+
+    cv::Mat dots;
+    cv::gemm(queries, rows, 1.0, cv::noArray(), 0.0, dots, cv::GEMM_2_T);
+
+    std::vector<float> rowSquares(rows.rows);
+    for (int row = 0; row < rows.rows; row++) {
+        float dot = 0.0f;
+        DistanceKernels::dotAndSquares(rows.ptr<float>(row), rows.ptr<float>(row), length,
+                                       &dot, &rowSquares[row]);
+    }
+
+    out.create(queries.rows, rows.rows, CV_64F);
+    for (int q = 0; q < queries.rows; q++) {
+        const float* query = queries.ptr<float>(q);
+        float dot = 0.0f;
+        float querySquares = 0.0f;
+        DistanceKernels::dotAndSquares(query, query, length, &dot, &querySquares);
+
+        const float* queryDots = dots.ptr<float>(q);
+        double* distances = out.ptr<double>(q);
+        for (int row = 0; row < rows.rows; row++) {
+            double ssd = static_cast<double>(querySquares) + rowSquares[row] -
+                         2.0 * queryDots[row];
+            distances[row] = std::max(0.0, ssd);
+        }
+    }
+    return true;
+}
+
 } // namespace cbir
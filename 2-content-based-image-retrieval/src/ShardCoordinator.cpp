@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+// ShardCoordinator.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of scatter-gather retrieval over shard
+//              servers: parallel fan-out with a deadline, reply parsing and
+//              top-K merging.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ShardCoordinator.h"
+#include "ImageRetrieval.h"
+#include "Json.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace cbir {
+
+namespace {
+
+/// Lower bound on the deadline used by connect()
+const int CONNECT_TIMEOUT_MS = 2000;
+
+double elapsedMs(int64 start, int64 end) {
+    return 1000.0 * (end - start) / cv::getTickFrequency();
+}
+
+} // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+ShardCoordinator::ShardCoordinator(const std::string& collection,
+                                   const std::vector<HttpEndpoint>& shards, int timeoutMs)
+    : collection_(Utils::toLower(collection)), shards_(shards),
+      timeoutMs_(std::max(1, timeoutMs)), dimension_(0), images_(0) {
+}
+
+/**
+ * @brief Read each shard's /collections entry
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ShardCoordinator::connect() {
+    dimension_ = 0;
+    images_ = 0;
+    bool first = true;
+    int reachable = 0;
+
+    for (const HttpEndpoint& shard : shards_) {
+        HttpResponse response;
+        std::string failure;
+        JsonValue list;
+        if (!HttpClient::request(shard, "GET", "/collections", "",
+                                 std::max(timeoutMs_, CONNECT_TIMEOUT_MS), response, &failure) ||
+            response.status != 200 || !JsonValue::parse(response.body, list) || !list.isArray()) {
+            std::cerr << "Warning: Shard " << shard.toString() << " unavailable"
+                      << (failure.empty() ? "" : " (" + failure + ")") << std::endl;
+            continue;
+        }
+
+        const JsonValue* entry = nullptr;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list.at(i).get("name").asString() == collection_) {
+                entry = &list.at(i);
+            }
+        }
+        if (entry == nullptr) {
+            std::cerr << "Error: Shard " << shard.toString() << " does not serve collection '"
+                      << collection_ << "'" << std::endl;
+            return false;
+        }
+
+        const int dimension = static_cast<int>(entry->get("dimension").asNumber());
+        const DecodePolicy policy =
+            DecodePolicy::make(static_cast<int>(entry->get("decodeReduction").asNumber(1)),
+                               static_cast<int>(entry->get("decodeMaxSide").asNumber(0)));
+        if (first) {
+            dimension_ = dimension;
+            decodePolicy_ = policy;
+            first = false;
+        } else if (dimension != dimension_ || policy != decodePolicy_) {
+            std::cerr << "Error: Shard " << shard.toString() << " has " << dimension
+                      << " features (" << policy.describe() << "), other shards " << dimension_
+                      << " (" << decodePolicy_.describe() << ")" << std::endl;
+            return false;
+        }
+        images_ += static_cast<size_t>(entry->get("images").asNumber());
+        reachable++;
+    }
+
+    if (reachable == 0) {
+        std::cerr << "Error: No shard of '" << collection_ << "' is reachable" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Send the batch to every shard in parallel and merge the answers
+ *
+ * One thread per shard; each request is bounded by the deadline, so the
+ * join below waits at most timeoutMs. The deadline and priority class go
+ * along in the request, so shard servers queue the query in its class and
+ * drop it rather than answer after the coordinator stopped waiting.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+std::vector<std::vector<ImageMatch>> ShardCoordinator::query(const cv::Mat& queries, int topN,
+                                                             ShardReport* report,
+                                                             int timeoutMs,
+                                                             const std::string& priority) const {
+    const size_t queryCount = static_cast<size_t>(queries.rows);
+    const int deadlineMs = timeoutMs > 0 ? timeoutMs : timeoutMs_;
+    const int64 start = cv::getTickCount();
+
+    // One request body for every shard
+    JsonValue rows = JsonValue::array();
+    for (int q = 0; q < queries.rows; q++) {
+        JsonValue row = JsonValue::array();
+        const float* values = queries.ptr<float>(q);
+        for (int j = 0; j < queries.cols; j++) {
+            row.push(static_cast<double>(values[j]));
+        }
+        rows.push(std::move(row));
+    }
+    JsonValue request = JsonValue::object();
+    request.set("collection", collection_);
+    request.set("top", topN);
+    request.set("features", std::move(rows));
+    request.set("timeoutMs", deadlineMs);
+    if (!priority.empty()) {
+        request.set("priority", priority);
+    }
+    const std::string body = request.dump();
+
+    std::vector<std::vector<std::vector<ImageMatch>>> answers(shards_.size());
+    std::vector<ShardStatus> statuses(shards_.size());
+    std::vector<std::thread> threads;
+    threads.reserve(shards_.size());
+    for (size_t s = 0; s < shards_.size(); s++) {
+        threads.emplace_back([&, s]() {
+            ShardStatus& status = statuses[s];
+            status.endpoint = shards_[s].toString();
+            const int64 sent = cv::getTickCount();
+            HttpResponse response;
+            if (HttpClient::request(shards_[s], "POST", "/query", body, deadlineMs,
+                                    response, &status.error)) {
+                if (response.status != 200) {
+                    status.error = "HTTP " + std::to_string(response.status);
+                } else {
+                    status.answered =
+                        parseReply(response.body, queryCount, answers[s], status.error);
+                }
+            }
+            status.ms = elapsedMs(sent, cv::getTickCount());
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Merge query by query over the shards that answered
+    std::vector<std::vector<ImageMatch>> results(queryCount);
+    int answered = 0;
+    for (const ShardStatus& status : statuses) {
+        answered += status.answered ? 1 : 0;
+    }
+    for (size_t q = 0; q < queryCount; q++) {
+        std::vector<std::vector<ImageMatch>> lists;
+        lists.reserve(shards_.size());
+        for (size_t s = 0; s < shards_.size(); s++) {
+            if (statuses[s].answered) {
+                lists.push_back(std::move(answers[s][q]));
+            }
+        }
+        results[q] = ImageRetrieval::mergeMatches(lists, topN);
+    }
+
+    if (report != nullptr) {
+        report->shards = std::move(statuses);
+        report->answered = answered;
+        report->elapsedMs = elapsedMs(start, cv::getTickCount());
+    }
+    return results;
+}
+
+/**
+ * @brief Per-query match lists from a /query reply
+ *
+ * A query the shard could not answer (e.g. wrong dimension) yields an
+ * empty list; the shard still counts as answered.
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ShardCoordinator::parseReply(const std::string& body, size_t queryCount,
+                                  std::vector<std::vector<ImageMatch>>& lists,
+                                  std::string& error) {
+    JsonValue reply;
+    if (!JsonValue::parse(body, reply, &error) || !reply.get("results").isArray()) {
+        error = "invalid reply";
+        return false;
+    }
+    const JsonValue& results = reply.get("results");
+    if (results.size() != queryCount) {
+        error = "expected " + std::to_string(queryCount) + " results, got " +
+                std::to_string(results.size());
+        return false;
+    }
+
+    lists.assign(queryCount, std::vector<ImageMatch>());
+    for (size_t q = 0; q < queryCount; q++) {
+        const JsonValue& matches = results.at(q).get("matches");
+        for (size_t i = 0; i < matches.size(); i++) {
+            const JsonValue& match = matches.at(i);
+            lists[q].emplace_back(match.get("filename").asString(),
+                                  match.get("distance").asNumber());
+        }
+    }
+    return true;
+}
+
+} // namespace cbir
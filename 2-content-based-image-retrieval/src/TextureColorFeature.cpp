@@ -17,15 +17,140 @@
 //
 // Combined: [texture_hist(16), color_hist(512)] = 528 total values
 //
+// Both histograms are counted in one sweep: each stripe of rows keeps a
+// rolling window of three grayscale rows, computes the Sobel magnitude of
+// the middle row and bins it, and bins the colours of the same row. No
+// gradient images are allocated.
+//
 // Date: February 2026
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "TextureColorFeature.h"
+#include "ImageContext.h"
+#include <cvcore/filter.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <cmath>
+#include <vector>
 
 namespace cbir {
 
+namespace {
+
+/// Images below this many pixels per stripe are swept on one thread
+const int64_t MIN_STRIPE_PIXELS = 1 << 18;
+
+using cvcore::reflect101;
+
+/**
+ * Texture and colour bin lookups shared by all stripes
+ * 
+ * The bin expressions are the ones of the former separate passes, so the
+ * counts are unchanged.
+ */
+struct FusedBins {
+    int textureBins;
+    int colorBins;
+    float textureBinSize;             ///< 255 / textureBins
+    std::vector<int> colorBinOf;      ///< Channel value -> colour bin
+    
+    FusedBins(int texture, int color)
+        : textureBins(texture), colorBins(color),
+          textureBinSize(255.0f / texture), colorBinOf(256) {
+        const float binSize = 256.0f / color;
+        for (int value = 0; value < 256; value++) {
+            colorBinOf[value] = std::min(static_cast<int>(value / binSize), color - 1);
+        }
+    }
+    
+    int textureBin(float magnitude) const {
+        magnitude = std::min(std::max(magnitude, 0.0f), 255.0f);
+        return std::min(static_cast<int>(magnitude / textureBinSize), textureBins - 1);
+    }
+};
+
+/**
+ * Rolling window of three grayscale rows with one reflected pixel of
+ * padding on each side, filled from the grayscale image when there is one
+ * and converted from the BGR row otherwise
+ */
+class GrayWindow {
+public:
+    GrayWindow(const cv::Mat& colorImage, const cv::Mat& gray)
+        : color_(colorImage), gray_(gray), cols_(colorImage.cols),
+          rows_(3 * static_cast<size_t>(colorImage.cols + 2)) {
+        loaded_[0] = loaded_[1] = loaded_[2] = -1;
+    }
+    
+    /// Padded row (element 0 is column -1); row must be in [0, rows)
+    const uchar* row(int index) {
+        const int slot = index % 3;
+        uchar* padded = &rows_[slot * static_cast<size_t>(cols_ + 2)];
+        if (loaded_[slot] != index) {
+            if (!gray_.empty()) {
+                std::copy(gray_.ptr<uchar>(index), gray_.ptr<uchar>(index) + cols_, padded + 1);
+            } else {
+                cv::Mat target(1, cols_, CV_8UC1, padded + 1);
+                cv::cvtColor(color_.row(index), target, cv::COLOR_BGR2GRAY);
+            }
+            padded[0] = padded[1 + reflect101(-1, cols_)];
+            padded[cols_ + 1] = padded[1 + reflect101(cols_, cols_)];
+            loaded_[slot] = index;
+        }
+        return padded;
+    }
+    
+private:
+    const cv::Mat& color_;
+    const cv::Mat& gray_;
+    int cols_;
+    std::vector<uchar> rows_;
+    int loaded_[3];
+};
+
+/**
+ * Count texture and colour bins of rows [begin, end)
+ * 
+ * The Sobel sums come from cvcore::sobel3x3Row; they are exact integers,
+ * the same values cv::Sobel produces on the float image, so magnitudes and
+ * bins match the full-frame path.
+ */
+void sweepRows(const cv::Mat& colorImage, const cv::Mat& gray, const FusedBins& bins,
+               int begin, int end, uint32_t* textureCounts, uint32_t* colorCounts) {
+    const int rows = colorImage.rows;
+    const int cols = colorImage.cols;
+    const int* binOf = bins.colorBinOf.data();
+    const int colorBins = bins.colorBins;
+    GrayWindow window(colorImage, gray);
+    std::vector<short> gx(cols), gy(cols);
+    
+    for (int row = begin; row < end; row++) {
+        // Reflected neighbours; rows row - 1 .. row + 1 use distinct slots
+        const uchar* up = window.row(reflect101(row - 1, rows));
+        const uchar* mid = window.row(row);
+        const uchar* down = window.row(reflect101(row + 1, rows));
+        cvcore::sobel3x3Row(up, mid, down, cols, gx.data(), gy.data());
+        
+        for (int col = 0; col < cols; col++) {
+            const int dx = gx[col];
+            const int dy = gy[col];
+            const float magnitude = std::sqrt(static_cast<float>(dx * dx + dy * dy));
+            textureCounts[bins.textureBin(magnitude)]++;
+        }
+        
+        const uchar* pixels = colorImage.ptr<uchar>(row);
+        for (int col = 0; col < cols; col++) {
+            const int b = binOf[pixels[3 * col]];
+            const int g = binOf[pixels[3 * col + 1]];
+            const int r = binOf[pixels[3 * col + 2]];
+            colorCounts[(r * colorBins + g) * colorBins + b]++;
+        }
+    }
+}
+
+} // namespace
+
 /**
  * Default constructor
  * 
@@ -37,7 +162,8 @@ namespace cbir {
 TextureColorFeature::TextureColorFeature()
     : textureBins_(16),
       colorBinsPerChannel_(8),
-      normalize_(true) {
+      normalize_(true),
+      useGpu_(false) {
 }
 
 /**
@@ -48,7 +174,8 @@ TextureColorFeature::TextureColorFeature(int textureBins,
                                        bool normalize)
     : textureBins_(textureBins),
       colorBinsPerChannel_(colorBinsPerChannel),
-      normalize_(normalize) {
+      normalize_(normalize),
+      useGpu_(false) {
     
     if (textureBins_ <= 0) {
         std::cerr << "Warning: Texture bins must be positive. Using 16." << std::endl;
@@ -65,12 +192,10 @@ TextureColorFeature::TextureColorFeature(int textureBins,
  * Extract combined texture and color features
  * 
  * Process:
- *   1. Compute texture features:
- *      - Calculate Sobel gradient magnitude
- *      - Create histogram of magnitudes
- *   2. Compute color features:
- *      - Create RGB color histogram
- *   3. Concatenate both histograms into single feature vector
+ *   1. Convert grayscale input to BGR
+ *   2. Sweep the rows once, binning each pixel's Sobel gradient
+ *      magnitude (texture) and its colour
+ *   3. Normalize both histograms and concatenate them
  * 
  * @param image Input image
  * @return Combined feature vector [texture_hist, color_hist]
@@ -87,38 +212,180 @@ cv::Mat TextureColorFeature::extractFeatures(const cv::Mat& image) {
         cv::cvtColor(image, colorImage, cv::COLOR_GRAY2BGR);
     }
     
-    // Compute texture features
-    cv::Mat gradientMag = computeGradientMagnitude(colorImage);
-    cv::Mat textureHist = computeTextureHistogram(gradientMag);
-    
-    if (textureHist.empty()) {
-        std::cerr << "Error: Failed to compute texture histogram" << std::endl;
+    // Grayscale rows are converted inside the sweep
+    return combineFeatures(colorImage, cv::Mat());
+}
+
+/**
+ * Extract combined features from a shared context
+ * 
+ * Takes the BGR and grayscale images from the context, so other
+ * extractors on the same image (e.g. Gabor) reuse the grayscale conversion.
+ */
+cv::Mat TextureColorFeature::extractFromContext(ImageContext& context) {
+    if (!isValidImage(context.image())) {
+        std::cerr << "Error: Invalid image for texture-color extraction" << std::endl;
+        return cv::Mat();
+    }
+    return combineFeatures(context.color(), context.gray());
+}
+
+/**
+ * Build [texture_hist, color_hist] in one sweep over the image
+ * 
+ * Texture: Sobel magnitude sqrt(Gx² + Gy²) of the grayscale image
+ * (3x3 kernels, reflected borders), binned over the fixed range [0, 255].
+ * Low magnitudes are smooth regions, high magnitudes strong edges.
+ * 
+ * Sobel kernels:
+ *   Sobel_X:        Sobel_Y:
+ *   [-1  0  1]      [-1 -2 -1]
+ *   [-2  0  2]      [ 0  0  0]
+ *   [-1  0  1]      [ 1  2  1]
+ * 
+ * Color: RGB histogram, flattened as (binR × bins + binG) × bins + binB
+ * like HistogramFeature.
+ * 
+ * Large images are split into row stripes swept in parallel; each stripe
+ * reads the grayscale rows around it, so the counts do not depend on the
+ * split.
+ */
+cv::Mat TextureColorFeature::combineFeatures(const cv::Mat& colorImage,
+                                             const cv::Mat& gray) const {
+    if (colorImage.empty() || colorImage.type() != CV_8UC3) {
+        std::cerr << "Error: Texture-color extraction needs an 8-bit BGR image" << std::endl;
         return cv::Mat();
     }
     
-    // Compute color features
-    cv::Mat colorHist = computeColorHistogram(colorImage);
+    const FusedBins bins(textureBins_, colorBinsPerChannel_);
+    const int colorTotal = getColorDimension();
+    const size_t stripeTotal = static_cast<size_t>(textureBins_) + colorTotal;
     
-    if (colorHist.empty()) {
-        std::cerr << "Error: Failed to compute color histogram" << std::endl;
-        return cv::Mat();
+    const int64_t pixels = static_cast<int64_t>(colorImage.rows) * colorImage.cols;
+    const int stripes = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>({pixels / MIN_STRIPE_PIXELS, cv::getNumThreads(),
+                              colorImage.rows})));
+    std::vector<uint32_t> counts(stripes * stripeTotal, 0);
+    auto sweepStripe = [&](int s) {
+        uint32_t* stripeCounts = &counts[s * stripeTotal];
+        sweepRows(colorImage, gray, bins, s * colorImage.rows / stripes,
+                  (s + 1) * colorImage.rows / stripes, stripeCounts,
+                  stripeCounts + textureBins_);
+    };
+    if (stripes == 1) {
+        sweepStripe(0);
+    } else {
+        cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+            for (int s = range.start; s < range.end; s++) {
+                sweepStripe(s);
+            }
+        });
     }
     
-    // Concatenate texture and color features
-    int totalDim = textureHist.cols + colorHist.cols;
-    cv::Mat combinedFeatures(1, totalDim, CV_32F);
+    // Merge stripes into [texture_hist, color_hist]
+    cv::Mat combinedFeatures(1, getFeatureDimension(), CV_32F);
+    float* out = combinedFeatures.ptr<float>(0);
+    for (size_t bin = 0; bin < stripeTotal; bin++) {
+        uint32_t total = 0;
+        for (int s = 0; s < stripes; s++) {
+            total += counts[s * stripeTotal + bin];
+        }
+        out[bin] = static_cast<float>(total);
+    }
     
-    // Copy texture histogram (first part)
+    normalizeParts(combinedFeatures);
+    
+    return combinedFeatures;
+}
+
+/**
+ * Normalize the texture and colour histograms to sum = 1.0 each
+ */
+void TextureColorFeature::normalizeParts(cv::Mat& combinedFeatures) const {
+    if (!normalize_) {
+        return;
+    }
+    
+    cv::Mat textureHist = combinedFeatures.colRange(0, textureBins_);
+    cv::Mat colorHist = combinedFeatures.colRange(textureBins_, combinedFeatures.cols);
+    
+    double textureSum = 0.0;
     for (int i = 0; i < textureHist.cols; i++) {
-        combinedFeatures.at<float>(0, i) = textureHist.at<float>(0, i);
+        textureSum += textureHist.at<float>(0, i);
+    }
+    if (textureSum > 1e-10) {
+        textureHist /= textureSum;
     }
     
-    // Copy color histogram (second part)
+    double colorSum = 0.0;
     for (int i = 0; i < colorHist.cols; i++) {
-        combinedFeatures.at<float>(0, textureHist.cols + i) = colorHist.at<float>(0, i);
+        colorSum += colorHist.at<float>(0, i);
+    }
+    if (colorSum > 1e-10) {
+        colorHist /= colorSum;
+    } else {
+        std::cerr << "Warning: Color histogram sum is zero for an image" << std::endl;
+    }
+}
+
+/**
+ * Extract a batch of images
+ * 
+ * With the device path on, GpuHistogram returns the raw
+ * [texture_hist, color_hist] counts of every image (same grayscale,
+ * Sobel and bins as the sweep), normalized here like combineFeatures().
+ * 
+ * @param images Decoded images
+ * @param out Output rows, images.size() × getFeatureDimension() CV_32F
+ * @param valid Optional per-image success flags
+ * @return int Number of images extracted
+ */
+int TextureColorFeature::extractBatch(const std::vector<cv::Mat>& images, cv::Mat& out,
+                                      std::vector<uchar>* valid) {
+    if (!useGpu_) {
+        return FeatureExtractor::extractBatch(images, out, valid);
     }
     
-    return combinedFeatures;
+    std::vector<cv::Mat> colorImages;
+    std::vector<int> positions;
+    GpuHistogram::collectColorImages(*this, images, colorImages, positions);
+    cv::Mat counts;
+    if (colorImages.empty() || !GpuHistogram::count(colorImages, gpuLayout(), {}, counts)) {
+        return FeatureExtractor::extractBatch(images, out, valid);
+    }
+    
+    out.create(static_cast<int>(images.size()), getFeatureDimension(), CV_32F);
+    out.setTo(cv::Scalar::all(0));
+    if (valid != nullptr) {
+        valid->assign(images.size(), 0);
+    }
+    for (size_t k = 0; k < positions.size(); k++) {
+        cv::Mat combinedFeatures = out.row(positions[k]);
+        counts.row(static_cast<int>(k)).copyTo(combinedFeatures);
+        normalizeParts(combinedFeatures);
+        if (valid != nullptr) {
+            (*valid)[positions[k]] = 1;
+        }
+    }
+    return static_cast<int>(positions.size());
+}
+
+/**
+ * Enable or disable device counting
+ */
+bool TextureColorFeature::setUseGpu(bool enabled) {
+    useGpu_ = enabled && GpuHistogram::supports(gpuLayout());
+    return useGpu_;
+}
+
+/**
+ * Device counting layout: texture bins, then one RGB histogram
+ */
+GpuHistogram::Layout TextureColorFeature::gpuLayout() const {
+    GpuHistogram::Layout layout;
+    layout.textureBins = textureBins_;
+    layout.colorBins = colorBinsPerChannel_;
+    return layout;
 }
 
 /**
@@ -154,174 +421,6 @@ void TextureColorFeature::setColorBinsPerChannel(int bins) {
     }
 }
 
-/**
- * Compute Sobel gradient magnitude
- * 
- * Algorithm:
- *   1. Convert to grayscale (if color)
- *   2. Apply Sobel filter in X direction → Gx
- *   3. Apply Sobel filter in Y direction → Gy
- *   4. Compute magnitude = sqrt(Gx² + Gy²)
- * 
- * Sobel kernels:
- *   Sobel_X:        Sobel_Y:
- *   [-1  0  1]      [-1 -2 -1]
- *   [-2  0  2]      [ 0  0  0]
- *   [-1  0  1]      [ 1  2  1]
- * 
- * @param image Input image
- * @return Gradient magnitude image (CV_32F, range ~0-255)
- */
-cv::Mat TextureColorFeature::computeGradientMagnitude(const cv::Mat& image) const {
-    // Convert to grayscale for gradient computation
-    cv::Mat gray;
-    if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image.clone();
-    }
-    
-    // Convert to float for Sobel
-    cv::Mat grayFloat;
-    gray.convertTo(grayFloat, CV_32F);
-    
-    // Apply Sobel filters
-    cv::Mat gradX, gradY;
-    cv::Sobel(grayFloat, gradX, CV_32F, 1, 0, 3);
-    cv::Sobel(grayFloat, gradY, CV_32F, 0, 1, 3);
-    
-    // Compute magnitude
-    cv::Mat magnitude;
-    cv::magnitude(gradX, gradY, magnitude);
-    
-    return magnitude;
-}
-
-/**
- * Compute texture histogram from gradient magnitudes
- * 
- * Creates histogram of gradient magnitudes where:
- *   - Low magnitudes (0-50): Smooth regions, uniform areas
- *   - Medium magnitudes (50-150): Texture, patterns
- *   - High magnitudes (150-255): Strong edges, boundaries
- * 
- * Algorithm:
- *   1. Create empty histogram with specified number of bins
- *   2. For each pixel, get gradient magnitude value
- *   3. Compute bin index based on magnitude
- *   4. Increment corresponding bin
- *   5. Normalize if configured
- * 
- * @param gradientMagnitude Gradient magnitude image (CV_32F)
- * @return 1D texture histogram
- */
-cv::Mat TextureColorFeature::computeTextureHistogram(const cv::Mat& gradientMagnitude) const {
-    // Create 1D histogram for texture
-    cv::Mat histogram = cv::Mat::zeros(1, textureBins_, CV_32F);
-    
-    // Use fixed range [0, 255] for consistency
-    float binSize = 255.0f / textureBins_;
-    
-    // Count gradient magnitudes into bins
-    for (int row = 0; row < gradientMagnitude.rows; row++) {
-        for (int col = 0; col < gradientMagnitude.cols; col++) {
-            float magnitude = gradientMagnitude.at<float>(row, col);
-            
-            // Clamp to [0, 255]
-            magnitude = std::min(std::max(magnitude, 0.0f), 255.0f);
-            
-            // Compute bin
-            int bin = static_cast<int>(magnitude / binSize);
-            bin = std::min(bin, textureBins_ - 1);
-            
-            // Increment
-            histogram.at<float>(0, bin) += 1.0f;
-        }
-    }
-    
-    // Normalize if configured
-    if (normalize_) {
-        double sum = 0.0;
-        for (int i = 0; i < histogram.cols; i++) {
-            sum += histogram.at<float>(0, i);
-        }
-        
-        if (sum > 1e-10) {
-            histogram /= sum;
-        }
-    }
-    
-    return histogram;
-}
-
-/**
- * Compute RGB color histogram
- * 
- * Same algorithm as HistogramFeature::computeRGBHistogram()
- * 
- * @param image Color image (BGR format)
- * @return 1D color histogram (flattened from 3D)
- */
-cv::Mat TextureColorFeature::computeColorHistogram(const cv::Mat& image) const {
-    // Create 3D histogram for RGB
-    int dims[3] = {colorBinsPerChannel_, colorBinsPerChannel_, colorBinsPerChannel_};
-    cv::Mat histogram = cv::Mat::zeros(3, dims, CV_32F);
-    
-    // Compute bin size
-    float binSize = 256.0f / colorBinsPerChannel_;
-    
-    // Count pixels into bins
-    for (int row = 0; row < image.rows; row++) {
-        for (int col = 0; col < image.cols; col++) {
-            cv::Vec3b pixel = image.at<cv::Vec3b>(row, col);
-            
-            int b = pixel[0];
-            int g = pixel[1];
-            int r = pixel[2];
-            
-            int binB = static_cast<int>(b / binSize);
-            int binG = static_cast<int>(g / binSize);
-            int binR = static_cast<int>(r / binSize);
-            
-            binB = std::min(binB, colorBinsPerChannel_ - 1);
-            binG = std::min(binG, colorBinsPerChannel_ - 1);
-            binR = std::min(binR, colorBinsPerChannel_ - 1);
-            
-            histogram.at<float>(binR, binG, binB) += 1.0f;
-        }
-    }
-    
-    // Flatten 3D histogram to 1D FIRST (before normalization)
-    int totalBins = colorBinsPerChannel_ * colorBinsPerChannel_ * colorBinsPerChannel_;
-    cv::Mat flattened(1, totalBins, CV_32F);
-    
-    int idx = 0;
-    const int* sizes = histogram.size.p;
-    for (int i = 0; i < sizes[0]; i++) {
-        for (int j = 0; j < sizes[1]; j++) {
-            for (int k = 0; k < sizes[2]; k++) {
-                flattened.at<float>(0, idx++) = histogram.at<float>(i, j, k);
-            }
-        }
-    }
-    
-    // THEN normalize the flattened 1D histogram
-    if (normalize_) {
-        double sum = 0.0;
-        for (int i = 0; i < flattened.cols; i++) {
-            sum += flattened.at<float>(0, i);
-        }
-        
-        if (sum > 1e-10) {
-            flattened /= sum;
-        } else {
-            std::cerr << "Warning: Color histogram sum is zero for an image" << std::endl;
-        }
-    }
-    
-    return flattened;
-}
-
 /**
  * Normalize histogram to sum=1.0
  * 
@@ -0,0 +1,301 @@
+////////////////////////////////////////////////////////////////////////////////
+// ThumbnailAtlas.cpp
+// Author: Krushna Sanjay Sharma
+// Description: Implementation of the packed thumbnail atlas: encoding and
+//              appending thumbnails, writing the sorted name index, and
+//              mapping an atlas for lookups.
+// Date: February 2026
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ThumbnailAtlas.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace cbir {
+
+namespace {
+
+/// Magic bytes at the start of every atlas
+const char ATLAS_MAGIC[8] = {'C', 'B', 'I', 'R', 'T', 'H', 'M', 'B'};
+
+/// Bumped whenever the layout changes
+const uint32_t ATLAS_VERSION = 1;
+
+/// Header size; blobs start right after it
+const size_t HEADER_BYTES = 64;
+
+/// Bytes of an index entry before its name
+const size_t ENTRY_BYTES = 16;
+
+/// Field offsets inside the header
+const size_t VERSION_AT = 8;
+const size_t MAX_SIDE_AT = 12;
+const size_t COUNT_AT = 16;
+const size_t INDEX_AT = 24;
+const size_t FORMAT_AT = 32;
+const size_t FORMAT_BYTES = 8;
+
+template <typename T>
+T readAt(const char* data, size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeAt(char* data, size_t offset, T value) {
+    std::memcpy(data + offset, &value, sizeof(T));
+}
+
+} // namespace
+
+std::string ThumbnailAtlas::pathFor(const std::string& databasePath) {
+    return databasePath + ".thumbs";
+}
+
+/**
+ * @brief Map the file and parse the index
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ThumbnailAtlas::open(const std::string& path) {
+    index_.clear();
+    file_.close();
+    if (!Utils::fileExists(path) || !file_.open(path)) {
+        return false;
+    }
+
+    const char* data = file_.data();
+    const size_t size = file_.size();
+    if (size < HEADER_BYTES || std::memcmp(data, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0 ||
+        readAt<uint32_t>(data, VERSION_AT) != ATLAS_VERSION) {
+        std::cerr << "Error: " << path << " is not a thumbnail atlas" << std::endl;
+        file_.close();
+        return false;
+    }
+
+    const uint64_t count = readAt<uint64_t>(data, COUNT_AT);
+    const uint64_t indexOffset = readAt<uint64_t>(data, INDEX_AT);
+    if (indexOffset < HEADER_BYTES || indexOffset > size || count > size) {
+        std::cerr << "Error: " << path << " has a corrupt header" << std::endl;
+        file_.close();
+        return false;
+    }
+
+    index_.reserve(static_cast<size_t>(count));
+    size_t cursor = static_cast<size_t>(indexOffset);
+    for (uint64_t i = 0; i < count; i++) {
+        if (cursor + ENTRY_BYTES > size) {
+            break;
+        }
+        ThumbnailEntry entry;
+        entry.offset = readAt<uint64_t>(data, cursor);
+        entry.size = readAt<uint32_t>(data, cursor + 8);
+        const uint32_t nameLength = readAt<uint32_t>(data, cursor + 12);
+        cursor += ENTRY_BYTES;
+        if (cursor + nameLength > size || entry.offset < HEADER_BYTES ||
+            entry.offset + entry.size > indexOffset) {
+            break;
+        }
+        index_.emplace(std::string(data + cursor, nameLength), entry);
+        cursor += nameLength;
+    }
+    if (index_.size() != count) {
+        std::cerr << "Error: " << path << " has a truncated index" << std::endl;
+        index_.clear();
+        file_.close();
+        return false;
+    }
+
+    char format[FORMAT_BYTES + 1] = {};
+    std::memcpy(format, data + FORMAT_AT, FORMAT_BYTES);
+    format_ = format;
+    maxSide_ = static_cast<int>(readAt<uint32_t>(data, MAX_SIDE_AT));
+    path_ = path;
+    return true;
+}
+
+bool ThumbnailAtlas::find(const std::string& imageName, ThumbnailEntry& entry) const {
+    auto found = index_.find(Utils::getFilename(imageName));
+    if (found == index_.end()) {
+        return false;
+    }
+    entry = found->second;
+    return true;
+}
+
+cv::Mat ThumbnailAtlas::decode(const std::string& imageName) const {
+    ThumbnailEntry entry;
+    if (!find(imageName, entry)) {
+        return cv::Mat();
+    }
+    cv::Mat blob(1, static_cast<int>(entry.size), CV_8UC1,
+                 const_cast<char*>(file_.data() + entry.offset));
+    return cv::imdecode(blob, cv::IMREAD_COLOR);
+}
+
+/**
+ * @brief Constructor
+ *
+ * @author Krushna Sanjay Sharma
+ */
+ThumbnailAtlasWriter::ThumbnailAtlasWriter(int maxSide, const std::string& format, int quality)
+    : maxSide_(std::max(16, maxSide)), format_(Utils::toLower(format)),
+      quality_(std::min(100, std::max(1, quality))) {
+    if (format_ != "jpg" && format_ != "webp") {
+        std::cerr << "Warning: Unknown thumbnail format '" << format << "', using jpg" << std::endl;
+        format_ = "jpg";
+    }
+}
+
+ThumbnailAtlasWriter::~ThumbnailAtlasWriter() {
+    if (file_.is_open()) {
+        file_.close();
+        std::remove((path_ + ".tmp").c_str());
+    }
+}
+
+/**
+ * @brief Create the temporary file with a placeholder header
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ThumbnailAtlasWriter::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    entries_.clear();
+    added_.clear();
+    failed_ = false;
+
+    file_.open(path_ + ".tmp", std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Error: Cannot write thumbnail atlas " << path_ << ".tmp" << std::endl;
+        return false;
+    }
+    const char header[HEADER_BYTES] = {};
+    file_.write(header, HEADER_BYTES);
+    offset_ = HEADER_BYTES;
+    return static_cast<bool>(file_);
+}
+
+/**
+ * @brief Encode outside the lock, append under it
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ThumbnailAtlasWriter::add(const std::string& imageName, const cv::Mat& image) {
+    const std::string name = Utils::getFilename(imageName);
+    if (image.empty() || contains(name)) {
+        return !image.empty();
+    }
+
+    cv::Mat thumbnail = image;
+    const int longest = std::max(image.cols, image.rows);
+    if (longest > maxSide_) {
+        const double scale = static_cast<double>(maxSide_) / longest;
+        cv::resize(image, thumbnail, cv::Size(), scale, scale, cv::INTER_AREA);
+    }
+
+    std::vector<uchar> blob;
+    const std::vector<int> parameters = format_ == "webp"
+        ? std::vector<int>{cv::IMWRITE_WEBP_QUALITY, quality_}
+        : std::vector<int>{cv::IMWRITE_JPEG_QUALITY, quality_};
+    bool encoded = false;
+    try {
+        encoded = cv::imencode("." + format_, thumbnail, blob, parameters);
+    } catch (const cv::Exception&) {
+        encoded = false;   // codec not built into this OpenCV
+    }
+    if (!encoded || blob.empty()) {
+        std::cerr << "Warning: Cannot encode thumbnail of " << name << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || failed_) {
+        return false;
+    }
+    if (added_.count(name) > 0) {
+        return true;
+    }
+    file_.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    if (!file_) {
+        failed_ = true;
+        return false;
+    }
+    ThumbnailEntry entry;
+    entry.offset = offset_;
+    entry.size = static_cast<uint32_t>(blob.size());
+    offset_ += blob.size();
+    added_[name] = entries_.size();
+    entries_.emplace_back(name, entry);
+    return true;
+}
+
+bool ThumbnailAtlasWriter::contains(const std::string& imageName) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return added_.count(Utils::getFilename(imageName)) > 0;
+}
+
+size_t ThumbnailAtlasWriter::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+/**
+ * @brief Append the sorted index, fill in the header, rename into place
+ *
+ * @author Krushna Sanjay Sharma
+ */
+bool ThumbnailAtlasWriter::finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return false;
+    }
+    const std::string temporary = path_ + ".tmp";
+
+    std::sort(entries_.begin(), entries_.end(),
+              [](const std::pair<std::string, ThumbnailEntry>& a,
+                 const std::pair<std::string, ThumbnailEntry>& b) { return a.first < b.first; });
+    const uint64_t indexOffset = offset_;
+    for (const auto& named : entries_) {
+        char fixed[ENTRY_BYTES];
+        writeAt<uint64_t>(fixed, 0, named.second.offset);
+        writeAt<uint32_t>(fixed, 8, named.second.size);
+        writeAt<uint32_t>(fixed, 12, static_cast<uint32_t>(named.first.size()));
+        file_.write(fixed, ENTRY_BYTES);
+        file_.write(named.first.data(), static_cast<std::streamsize>(named.first.size()));
+    }
+
+    char header[HEADER_BYTES] = {};
+    std::memcpy(header, ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+    writeAt<uint32_t>(header, VERSION_AT, ATLAS_VERSION);
+    writeAt<uint32_t>(header, MAX_SIDE_AT, static_cast<uint32_t>(maxSide_));
+    writeAt<uint64_t>(header, COUNT_AT, static_cast<uint64_t>(entries_.size()));
+    writeAt<uint64_t>(header, INDEX_AT, indexOffset);
+    std::memcpy(header + FORMAT_AT, format_.data(), std::min(format_.size(), FORMAT_BYTES));
+    file_.seekp(0);
+    file_.write(header, HEADER_BYTES);
+    file_.close();
+
+    if (failed_ || !file_) {
+        std::cerr << "Error: Failed to write thumbnail atlas " << temporary << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path_, error);
+    if (error) {
+        std::cerr << "Error: Cannot replace " << path_ << ": " << error.message() << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace cbir
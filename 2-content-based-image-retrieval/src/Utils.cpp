@@ -7,9 +7,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Utils.h"
+#include "MappedFile.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <filesystem>
 
@@ -22,81 +26,309 @@ namespace Utils {
 // CSV File I/O Operations
 //==============================================================================
 
+namespace {
+
+/// Below this many bytes per chunk a CSV is parsed on one thread
+const size_t MIN_CSV_CHUNK_BYTES = size_t(1) << 20;
+
+/// Invalid lines reported individually per file; the rest are counted
+const size_t MAX_CSV_WARNINGS = 5;
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
 /**
- * @brief Read feature vectors from CSV file
+ * Parse one float from [p, end), skipping blanks around it and a leading '+'
+ * (accepted by std::stof); p ends after the trailing blanks
+ */
+bool parseFloat(const char*& p, const char* end, float& value) {
+    while (p < end && isBlank(*p)) {
+        p++;
+    }
+    if (p < end && *p == '+') {
+        p++;
+    }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec == std::errc::result_out_of_range) {
+        // Beyond float range: round through double (to 0 or infinity)
+        double wide = 0.0;
+        result = std::from_chars(p, end, wide);
+        value = static_cast<float>(wide);
+    }
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    p = result.ptr;
+#else
+    // Toolchains without floating-point from_chars: strtof on a bounded copy
+    char buffer[64];
+    size_t length = 0;
+    while (p + length < end && length + 1 < sizeof(buffer) && p[length] != ',' &&
+           p[length] != '\n') {
+        buffer[length] = p[length];
+        length++;
+    }
+    buffer[length] = '\0';
+    char* stop = nullptr;
+    value = std::strtof(buffer, &stop);
+    if (stop == buffer) {
+        return false;
+    }
+    p += stop - buffer;
+#endif
+    while (p < end && isBlank(*p)) {
+        p++;
+    }
+    return true;
+}
+
+/// Outcome of one line of the CSV body
+enum class LineState : uint8_t { Blank, Valid, Invalid };
+
+/// Trimmed name of a parsed line, as an offset into the mapped file
+struct LineName {
+    uint64_t offset = 0;
+    uint32_t length = 0;
+    LineState state = LineState::Blank;
+};
+
+/**
+ * Parse "name,v1,...,vN" into values (N = dimension), trimming the name
+ */
+LineState parseLine(const char* line, const char* end, int dimension,
+                    const char* base, LineName& name, float* values) {
+    const char* start = line;
+    while (start < end && isBlank(*start)) {
+        start++;
+    }
+    if (start == end) {
+        return LineState::Blank;
+    }
+    const char* comma = static_cast<const char*>(std::memchr(start, ',', end - start));
+    if (comma == nullptr) {
+        return LineState::Invalid;
+    }
+    const char* nameEnd = comma;
+    while (nameEnd > start && isBlank(nameEnd[-1])) {
+        nameEnd--;
+    }
+    name.offset = static_cast<uint64_t>(start - base);
+    name.length = static_cast<uint32_t>(nameEnd - start);
+
+    const char* p = comma + 1;
+    for (int j = 0; j < dimension; j++) {
+        if (!parseFloat(p, end, values[j])) {
+            return LineState::Invalid;
+        }
+        if (j + 1 < dimension) {
+            if (p >= end || *p != ',') {
+                return LineState::Invalid;
+            }
+            p++;
+        }
+    }
+    // Tolerate a single trailing comma
+    if (p < end && *p == ',') {
+        p++;
+        while (p < end && isBlank(*p)) {
+            p++;
+        }
+    }
+    return p == end ? LineState::Valid : LineState::Invalid;
+}
+
+/**
+ * Values per row: fields of the first non-blank line after the name
+ */
+int detectDimension(const char* p, const char* end) {
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline != nullptr ? newline : end;
+        while (lineEnd > p && isBlank(lineEnd[-1])) {
+            lineEnd--;
+        }
+        if (lineEnd > p) {
+            if (lineEnd[-1] == ',') {
+                lineEnd--;
+            }
+            return static_cast<int>(std::count(p, lineEnd, ','));
+        }
+        p = newline != nullptr ? newline + 1 : end;
+    }
+    return 0;
+}
+
+} // namespace
+
+/**
+ * @brief Parse whole CSV lines into packed arrays
  * 
- * File format: filename,feature1,feature2,...,featureN
+ * Process:
+ *   1. Find the dimension from the first data line unless it is given
+ *   2. Cut the buffer into line-aligned chunks and count their lines, which
+ *      gives each chunk the index of its first row
+ *   3. Parse the chunks in parallel, each line straight into its row
+ *   4. Close the gaps left by blank and invalid lines and gather the names
  * 
  * @author Krushna Sanjay Sharma
  */
-bool readFeaturesCSV(const std::string& filename,
-                    std::map<std::string, cv::Mat>& features,
-                    bool hasHeader) {
-    // Open file
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file " << filename << std::endl;
+bool parseFeaturesCSV(const char* begin, const char* end, size_t firstLine,
+                      PackedFeatureRows& rows, size_t* lineCountOut) {
+    const int dimension = rows.dimension > 0 ? rows.dimension : detectDimension(begin, end);
+    rows.values.clear();
+    rows.nameChars.clear();
+    rows.nameOffsets.assign(1, 0);
+    if (lineCountOut != nullptr) {
+        *lineCountOut = 0;
+    }
+    if (dimension <= 0) {
         return false;
     }
-    
-    // Clear output map
-    features.clear();
-    
-    std::string line;
-    int lineNum = 0;
-    
-    // Read file line by line
-    while (std::getline(file, line)) {
-        lineNum++;
-        
-        // Skip header if present
-        if (lineNum == 1 && hasHeader) {
-            continue;
+    rows.dimension = dimension;
+
+    // Line-aligned chunks
+    const size_t bytes = static_cast<size_t>(end - begin);
+    const int chunkCount = static_cast<int>(std::max<size_t>(1, std::min<size_t>(
+        bytes / MIN_CSV_CHUNK_BYTES, static_cast<size_t>(cv::getNumThreads()) * 4)));
+    std::vector<const char*> bounds(chunkCount + 1, end);
+    bounds[0] = begin;
+    for (int c = 1; c < chunkCount; c++) {
+        const char* guess = std::max(begin + bytes * c / chunkCount, bounds[c - 1]);
+        const char* newline = static_cast<const char*>(std::memchr(guess, '\n', end - guess));
+        bounds[c] = newline != nullptr ? newline + 1 : end;
+    }
+
+    // Lines per chunk; their prefix sums are the chunks' first rows
+    std::vector<size_t> firstRow(chunkCount + 1, 0);
+    cv::parallel_for_(cv::Range(0, chunkCount), [&](const cv::Range& range) {
+        for (int c = range.start; c < range.end; c++) {
+            const char* chunkBegin = bounds[c];
+            const char* stop = bounds[c + 1];
+            size_t lines = static_cast<size_t>(std::count(chunkBegin, stop, '\n'));
+            if (stop > chunkBegin && stop[-1] != '\n') {
+                lines++;
+            }
+            firstRow[c + 1] = lines;
         }
-        
-        // Skip empty lines
-        if (line.empty() || trim(line).empty()) {
-            continue;
+    });
+    for (int c = 0; c < chunkCount; c++) {
+        firstRow[c + 1] += firstRow[c];
+    }
+    const size_t lineCount = firstRow[chunkCount];
+    if (lineCountOut != nullptr) {
+        *lineCountOut = lineCount;
+    }
+
+    // Parse every line into its row
+    rows.values.resize(lineCount * dimension);
+    std::vector<LineName> names(lineCount);
+    cv::parallel_for_(cv::Range(0, chunkCount), [&](const cv::Range& range) {
+        for (int c = range.start; c < range.end; c++) {
+            const char* p = bounds[c];
+            const char* stop = bounds[c + 1];
+            for (size_t row = firstRow[c]; p < stop; row++) {
+                const char* newline = static_cast<const char*>(std::memchr(p, '\n', stop - p));
+                const char* lineEnd = newline != nullptr ? newline : stop;
+                names[row].state = parseLine(p, lineEnd, dimension, begin, names[row],
+                                             rows.values.data() + row * dimension);
+                p = newline != nullptr ? newline + 1 : stop;
+            }
         }
-        
-        // Parse line
-        std::vector<std::string> tokens = split(line, ',');
-        
-        if (tokens.size() < 2) {
-            std::cerr << "Warning: Line " << lineNum << " has insufficient data" << std::endl;
+    });
+
+    // Compact in file order
+    size_t kept = 0;
+    size_t invalid = 0;
+    for (size_t row = 0; row < lineCount; row++) {
+        if (names[row].state == LineState::Invalid) {
+            if (++invalid <= MAX_CSV_WARNINGS) {
+                std::cerr << "Warning: Line " << firstLine + row
+                          << " is not a name and " << dimension << " feature values, skipped"
+                          << std::endl;
+            }
             continue;
         }
-        
-        // First token is filename
-        std::string imageName = trim(tokens[0]);
-        
-        // Remaining tokens are feature values
-        std::vector<float> featureValues;
-        for (size_t i = 1; i < tokens.size(); i++) {
-            try {
-                float value = std::stof(trim(tokens[i]));
-                featureValues.push_back(value);
-            } catch (const std::exception& e) {
-                std::cerr << "Warning: Invalid feature value at line " << lineNum 
-                          << ", column " << i << std::endl;
-                continue;
-            }
+        if (names[row].state == LineState::Blank) {
+            continue;
         }
-        
-        // Create cv::Mat from feature values (1 row, N columns)
-        cv::Mat featureMat(1, static_cast<int>(featureValues.size()), CV_32F);
-        for (size_t i = 0; i < featureValues.size(); i++) {
-            featureMat.at<float>(0, i) = featureValues[i];
+        if (kept != row) {
+            std::memmove(rows.values.data() + kept * dimension,
+                         rows.values.data() + row * dimension, dimension * sizeof(float));
         }
-        
-        // Store in map
-        features[imageName] = featureMat;
+        const char* name = begin + names[row].offset;
+        rows.nameChars.insert(rows.nameChars.end(), name, name + names[row].length);
+        rows.nameOffsets.push_back(rows.nameChars.size());
+        kept++;
     }
+    if (invalid > MAX_CSV_WARNINGS) {
+        std::cerr << "Warning: " << invalid - MAX_CSV_WARNINGS << " more invalid lines skipped"
+                  << std::endl;
+    }
+    rows.values.resize(kept * dimension);
+    return true;
+}
+
+/**
+ * @brief Read a feature CSV into packed arrays
+ * 
+ * Maps the file, skips the header and parses the body with
+ * parseFeaturesCSV().
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+bool readFeaturesCSV(const std::string& filename, PackedFeatureRows& rows, bool hasHeader) {
+    rows = PackedFeatureRows();
+    rows.nameOffsets.assign(1, 0);
+
+    MappedFile file;
+    if (!fileExists(filename) || !file.open(filename)) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+    const char* data = file.data();
+    const char* end = data + file.size();
+    const char* body = data;
+    if (hasHeader) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        body = newline != nullptr ? newline + 1 : end;
+    }
+
+    if (!parseFeaturesCSV(body, end, hasHeader ? 2 : 1, rows)) {
+        std::cerr << "Error: No feature rows in " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Read " << rows.size() << " feature vectors from " << filename << std::endl;
+    return rows.size() > 0;
+}
+
+/**
+ * @brief Read feature vectors from CSV file
+ * 
+ * File format: filename,feature1,feature2,...,featureN
+ * 
+ * Parsed by the packed reader; a name that appears twice keeps its last row.
+ * 
+ * @author Krushna Sanjay Sharma
+ */
+bool readFeaturesCSV(const std::string& filename,
+                    std::map<std::string, cv::Mat>& features,
+                    bool hasHeader) {
+    features.clear();
     
-    file.close();
+    PackedFeatureRows rows;
+    if (!readFeaturesCSV(filename, rows, hasHeader)) {
+        return false;
+    }
     
-    std::cout << "Read " << features.size() << " feature vectors from " 
-              << filename << std::endl;
+    for (size_t i = 0; i < rows.size(); i++) {
+        std::string name(rows.nameChars.data() + rows.nameOffsets[i],
+                         rows.nameChars.data() + rows.nameOffsets[i + 1]);
+        cv::Mat row(1, rows.dimension, CV_32F, rows.values.data() + i * rows.dimension);
+        features[name] = row.clone();
+    }
     
     return !features.empty();
 }
@@ -342,11 +574,22 @@ std::string featuresToString(const cv::Mat& features) {
  * @author Krushna Sanjay Sharma
  */
 cv::Mat stringToFeatures(const std::string& str) {
-    std::vector<std::string> tokens = split(str, ',');
-    cv::Mat features(1, static_cast<int>(tokens.size()), CV_32F);
-    
-    for (size_t i = 0; i < tokens.size(); i++) {
-        features.at<float>(0, i) = std::stof(trim(tokens[i]));
+    const char* p = str.data();
+    const char* end = p + str.size();
+    const int count = static_cast<int>(std::count(p, end, ',')) + 1;
+    cv::Mat features(1, count, CV_32F);
+    float* values = features.ptr<float>(0);
+    
+    for (int i = 0; i < count; i++) {
+        // Each value must be followed by a comma, the last by the end
+        if (!parseFloat(p, end, values[i]) ||
+            (i + 1 < count ? (p == end || *p != ',') : p != end)) {
+            std::cerr << "Error: Invalid feature value in column " << i << std::endl;
+            return cv::Mat();
+        }
+        if (i + 1 < count) {
+            p++;
+        }
     }
     
     return features;
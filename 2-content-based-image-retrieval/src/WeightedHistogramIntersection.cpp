@@ -16,8 +16,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "WeightedHistogramIntersection.h"
+#include "DistanceKernels.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 namespace cbir {
 
@@ -46,6 +48,12 @@ WeightedHistogramIntersection::WeightedHistogramIntersection(int textureDim,
         textureWeight_ /= sum;
         colorWeight_ /= sum;
     }
+    
+    // Per-bin weights for the fused kernel in weightedDistance()
+    binWeights_.assign(static_cast<size_t>(std::max(0, textureDim_)),
+                       static_cast<float>(textureWeight_));
+    binWeights_.insert(binWeights_.end(), static_cast<size_t>(std::max(0, colorDim_)),
+                       static_cast<float>(colorWeight_));
 }
 
 /**
@@ -54,11 +62,9 @@ WeightedHistogramIntersection::WeightedHistogramIntersection(int textureDim,
  * Feature structure: [texture(16), color(512)]
  * 
  * Process:
- *   1. Extract texture components (first 16 values)
- *   2. Extract color components (next 512 values)
- *   3. Compute intersection for each component separately
- *   4. Convert to distances: d = 1 - intersection
- *   5. Combine with weights: final = 0.5×d_texture + 0.5×d_color
+ *   1. Validate the dimension (texture + color bins)
+ *   2. Score both vectors with weightedDistance(): both components'
+ *      weighted intersections in one pass over the flat arrays
  * 
  * @param features1 First feature vector [texture, color]
  * @param features2 Second feature vector [texture, color]
@@ -80,53 +86,63 @@ double WeightedHistogramIntersection::compute(const cv::Mat& features1,
         return -1.0;
     }
     
-    // Compute intersection for texture component (bins 0 to textureDim-1)
-    double textureIntersection = computeIntersection(features1, features2, 0, textureDim_);
-    double textureDistance = 1.0 - textureIntersection;
-    
-    // Compute intersection for color component (bins textureDim to end)
-    double colorIntersection = computeIntersection(features1, features2, 
-                                                   textureDim_, expectedDim);
-    double colorDistance = 1.0 - colorIntersection;
-    
-    // Combine with equal weights (50% texture, 50% color)
-    double combinedDistance = textureWeight_ * textureDistance + colorWeight_ * colorDistance;
+    if (features1.type() != CV_32F) {
+        std::cerr << "Error: Weighted histogram features must be CV_32F" << std::endl;
+        return -1.0;
+    }
     
-    return combinedDistance;
+    return weightedDistance(features1.ptr<float>(0), features2.ptr<float>(0));
 }
 
 /**
- * Get metric name
+ * Batch version of compute()
+ * 
+ * The dimension is checked once for the whole matrix; each row then goes
+ * through the same fused kernel as compute(), so distances are identical.
+ * 
+ * @param query Query feature vector [texture, color]
+ * @param matrix Database features, one vector per row
+ * @param out Output distances (matrix.rows x 1, CV_64F)
+ * @return True on success, false on invalid input
  */
-std::string WeightedHistogramIntersection::getMetricName() const {
-    return "WeightedHistogramIntersection";
+bool WeightedHistogramIntersection::computeBatch(const cv::Mat& query, const cv::Mat& matrix,
+                                                 cv::Mat& out) {
+    int expectedDim = textureDim_ + colorDim_;
+    if (matrix.cols != expectedDim) {
+        std::cerr << "Error: Feature dimension mismatch. Expected " << expectedDim
+                  << ", got " << matrix.cols << std::endl;
+        return false;
+    }
+    
+    return runBatch(query, matrix, out,
+                    [this](const float* queryData, const float* rowData, int) {
+        return weightedDistance(queryData, rowData);
+    });
 }
 
 /**
- * Compute histogram intersection for a subrange
+ * Weighted distance between two contiguous feature arrays
  * 
- * Computes: Σ min(hist1[i], hist2[i]) for i in [startIdx, endIdx)
+ * w_t × (1 - I_t) + w_c × (1 - I_c) is evaluated as
+ * w_t + w_c - Σ_i w(i) × min(a_i, b_i) with the per-bin weights built in
+ * the constructor, so the 16-bin texture part does not need a loop (and
+ * a mostly scalar tail) of its own.
  * 
- * @param hist1 First histogram
- * @param hist2 Second histogram
- * @param startIdx Start index (inclusive)
- * @param endIdx End index (exclusive)
- * @return Intersection value
+ * @param hist1 First feature vector (textureDim + colorDim floats)
+ * @param hist2 Second feature vector
+ * @return Weighted combined distance
  */
-double WeightedHistogramIntersection::computeIntersection(const cv::Mat& hist1, 
-                                                         const cv::Mat& hist2,
-                                                         int startIdx, 
-                                                         int endIdx) const {
-    double intersection = 0.0;
-    
-    // Sum of minimums for specified range
-    for (int i = startIdx; i < endIdx; i++) {
-        float val1 = hist1.at<float>(0, i);
-        float val2 = hist2.at<float>(0, i);
-        intersection += std::min(val1, val2);
-    }
-    
-    return intersection;
+double WeightedHistogramIntersection::weightedDistance(const float* hist1,
+                                                      const float* hist2) const {
+    return textureWeight_ + colorWeight_ - DistanceKernels::weightedIntersection(
+        hist1, hist2, binWeights_.data(), static_cast<int>(binWeights_.size()));
+}
+
+/**
+ * Get metric name
+ */
+std::string WeightedHistogramIntersection::getMetricName() const {
+    return "WeightedHistogramIntersection";
 }
 
 /**
@@ -0,0 +1,42 @@
+/**
+ * @file    AllocCounter.h
+ * @brief   Per-thread heap allocation counter.
+ *
+ *          cvcore's allocation tracking (CVCORE_ALLOC_TRACKING, switched
+ *          on by this project's CMakeLists) replaces the global operator
+ *          new, so every allocation made through new, the standard
+ *          containers and std::string is counted on the thread that made
+ *          it.  AllocScope adds the allocations made while it is alive to a
+ *          caller's counter; the processing thread uses it to show how many
+ *          allocations building the region list took
+ *          (AppState::regionAllocs — zero once the buffers have grown).
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <cvcore/allocTracking.hpp>
+
+/** Heap allocations made by the calling thread so far. */
+inline long long threadAllocations()
+{
+    return static_cast<long long>(cvcore::threadAllocCounts().heapCount);
+}
+
+// =============================================================================
+// AllocScope — counts the enclosing scope's allocations into a total
+// =============================================================================
+class AllocScope {
+public:
+    explicit AllocScope(int& total) : total_(total), begin_(threadAllocations()) {}
+    ~AllocScope() { total_ += static_cast<int>(threadAllocations() - begin_); }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    int&      total_;
+    long long begin_;
+};
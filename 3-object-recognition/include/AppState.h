@@ -16,11 +16,20 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <array>
 #include <string>
 #include <vector>
 
+/** 7 Hu moment invariants, stored inline. */
+using HuMoments = std::array<double, 7>;
+
 // =============================================================================
 // RegionInfo — computed per detected object region each frame
+//
+// AppState::regions is reused from frame to frame as a fixed-capacity arena
+// (maxRegions slots): slots are reset in place and keep their label and
+// embedding buffers, so a steady frame builds its region list without heap
+// allocation.
 // =============================================================================
 struct RegionInfo {
     int             id          = 0;
@@ -38,15 +47,20 @@ struct RegionInfo {
     float           minE2       = 0.f;  ///< Min projection along secondary axis
     float           maxE2       = 0.f;  ///< Max projection along secondary axis
 
-    std::vector<double> huMoments;      ///< 7 Hu moment invariants (log-scaled)
+    HuMoments       huMoments   = {};   ///< Hu moment invariants (log-scaled)
+    bool            hasShape    = false; ///< huMoments, fillRatio and bboxRatio computed
 
     // Classifier output
     std::string     label           = "unknown";
     float           confidence      = 0.f;
     int             unknownFrames   = 0;    ///< Consecutive frames classified as unknown
+    int             trackId         = -1;   ///< Persistent id across frames (-1 = untracked)
+    bool            needsClassify   = true; ///< Set by RegionTracker; false = label carried over
+    bool            shapeLabel      = false;///< CNN cascade: shape label accepted, CNN skipped
 
     // CNN embedding vector (512-dimensional ResNet18 output)
     std::vector<float> embedding;
+    cv::Mat            embedCrop;           ///< Aligned ROI the embedding was computed from
 
     // Display
     cv::Scalar      displayColor = {200, 200, 200};
@@ -57,11 +71,19 @@ struct RegionInfo {
 // =============================================================================
 struct PipelineParams {
 
+    // --- Capture -------------------------------------------------------------
+    bool    dropFrames          = true; ///< Process only the newest decoded frame when behind
+
     // --- Task 1: Threshold ---------------------------------------------------
     int     thresholdValue      = 127;  ///< Global threshold [0..255]
     int     blurKernelSize      = 21;   ///< Pre-blur kernel size (must be odd)
+    int     blurMode            = 0;    ///< 0=Gaussian, 1=box (running sums), 2=stack blur
+    int     downscaleLevel      = 0;    ///< Tasks 1-3 at 0=full, 1=half, 2=quarter resolution
+    bool    useOpenCL           = false;///< Tasks 1-2 on the OpenCL device (UMat); only the mask is downloaded
+    cv::Rect processRoi;                ///< Tasks 1-4 only inside this area (empty = whole frame)
     bool    useAdaptive         = false;///< Adaptive vs global threshold
     bool    useKMeans           = false;///< ISODATA dynamic threshold
+    int     dynamicThresh       = 0;    ///< Dynamic method when useKMeans: 0=ISODATA, 1=Otsu
     bool    useSatIntensity     = false;///< Custom sat+intensity threshold (bonus)
 
     // --- Task 2: Morphology --------------------------------------------------
@@ -70,10 +92,19 @@ struct PipelineParams {
     int     morphMode           = 0;    ///< 0=open, 1=close, 2=erode, 3=dilate
 
     // --- Task 3: Connected Components ----------------------------------------
+    int     labelMode           = 0;    ///< 0=parallel 4-conn, 1=2x2 block 8-conn, 2=sequential
+    bool    streamPipeline      = false;///< Tasks 1-3 in row bands (no full-frame intermediates)
+    bool    sparseTiles         = true; ///< Tasks 2-3 skip empty 32x32 mask tiles (same output)
     int     minRegionArea       = 500;  ///< Ignore regions smaller than this
     int     maxRegions          = 5;    ///< Keep top N largest regions
 
+    // --- Tracking ------------------------------------------------------------
+    bool    trackRegions        = true; ///< Reuse labels of tracked regions between classifications
+    int     trackReclassify     = 15;   ///< Reclassify a tracked region every N frames
+    float   trackDrift          = 0.5f; ///< Mean log-Hu change that forces reclassification
+
     // --- Task 4: Features ----------------------------------------------------
+    int     momentMode          = 0;    ///< 0=region runs, 1=contour (Green's theorem)
     bool    showAxes            = true;
     bool    showOrientedBBox    = true;
     bool    showFeatureText     = true;
@@ -82,10 +113,23 @@ struct PipelineParams {
     int     kNeighbors          = 1;
     float   confidenceThresh    = 0.60f;
     int     distanceMetric      = 0;    ///< 0=scaled Euclidean, 1=cosine
+    bool    nearestCentroid     = false;///< Match per-label centroids instead of k-NN
 
     // --- CNN Embedding -------------------------------------------------------
     int     embeddingMode       = 0;    ///< 0=hand-crafted features, 1=CNN ResNet18
     int     roiSize             = 224;  ///< ROI resize dimension before embedding (pixels)
+    int     dnnBackend          = 0;    ///< 0=OpenCV CPU, 1=OpenCL, 2=OpenCL FP16, 3=CUDA, 4=CUDA FP16, 5=OpenVINO
+    bool    asyncEmbedding      = true; ///< Run ResNet18 on a worker thread (labels lag a few frames)
+    int     prototypesPerLabel  = 8;    ///< k-means prototypes per label for live CNN matching (0 = all samples)
+    bool    embeddingIndex      = true; ///< HNSW graph for CNN nearest-neighbour search on large DBs
+    bool    cnnCascade          = false;///< CNN mode: shape classifier first, CNN only for unsure regions
+    float   cascadeConfidence   = 0.7f; ///< Shape confidence a region needs to skip the CNN
+    float   cascadeMargin       = 0.8f; ///< Best / runner-up label distance above this is ambiguous
+
+    // --- Motion gate ---------------------------------------------------------
+    bool    motionGate          = false;///< Skip Tasks 1-4 and classification on unchanged frames
+    float   motionThreshold     = 0.5f; ///< % of sampled pixels that must change (half to settle)
+    int     motionRefresh       = 60;   ///< Full run at least every N frames when still (0 = never)
 };
 
 // =============================================================================
@@ -126,10 +170,23 @@ struct AppState {
     float       fps             = 0.f;
     bool        running         = true;
     bool        embeddingMode_  = false; ///< Task 9: use CNN embedding classifier
+    bool        modelLoading    = false; ///< Embedding model still loading in the background
     bool        showOverlay     = true;  ///< Show config overlay text on main window
+    int         embedQueueDepth = 0;     ///< Async embedding jobs pending + in flight
+    float       embedLatencyMs  = 0.f;   ///< Async ResNet18 forward-pass latency
+    std::string sourceName;              ///< Capture source and backend (empty for a still image)
+    long long   framesDecoded   = 0;     ///< Frames read by the decode thread
+    long long   framesDropped   = 0;     ///< Decoded frames skipped by the pipeline
+    float       decodeFps       = 0.f;   ///< Decode thread rate
+    bool        hwDecode        = false; ///< Hardware video decoding active
+    float       motionSkipRatio = 0.f;   ///< Recent fraction of frames skipped by the motion gate
+    int         prototypeCount  = 0;     ///< Condensed CNN prototypes in use (0 = full embedding DB)
+    float       cnnInvocationRate = 0.f; ///< CNN cascade: recent fraction of classified regions sent to the CNN
+    int         regionAllocs    = 0;     ///< Heap allocations building the last region list
     bool        showPlot        = false; ///< Show embedding PCA scatter plot window
 
     // --- Auto-learn ----------------------------------------------------------
     bool        autoLearnPending = false; ///< True when an unknown region has persisted long enough to prompt the user
     RegionInfo  autoLearnRegion;          ///< Copy of the region that triggered the auto-learn prompt
+    int         autoLearnSeq     = 0;     ///< Prompts raised by the processing thread so far
 };
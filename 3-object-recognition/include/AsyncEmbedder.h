@@ -0,0 +1,137 @@
+/**
+ * @file    AsyncEmbedder.h
+ * @brief   Background ResNet18 embedding worker for CNN mode.
+ *
+ *          The render loop submits the current frame with its regions and
+ *          their track ids; a worker thread runs the batched forward pass
+ *          and posts one result per region to a completion queue.  The loop
+ *          drains the queue with poll() and keeps drawing the last known
+ *          label per track, so the camera and GUI run at frame rate rather
+ *          than inference rate.
+ *
+ *          The classifier serialises its own network use, so training
+ *          captures on the main thread may run while the worker is busy.
+ *
+ *          Only the newest frames are kept: when the pending queue is full
+ *          the oldest job is dropped.  Tracks that disappear are cancelled —
+ *          removed from pending jobs and their results discarded.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AppState.h"
+#include "Embedding.h"
+
+class AsyncEmbedder {
+public:
+    /** One region's embedding, keyed by its track id. */
+    struct Result {
+        int                trackId = -1;
+        std::vector<float> embedding;
+        cv::Mat            crop;          ///< 224x224 display crop
+    };
+
+    /**
+     * @brief Start the worker thread.
+     * @param classifier  Loaded classifier whose network the worker runs.
+     * @param maxPending  Jobs waiting behind the one in flight (oldest dropped).
+     */
+    explicit AsyncEmbedder(EmbeddingClassifier& classifier, int maxPending = 1);
+
+    /** Stop the worker; an in-flight forward pass finishes first. */
+    ~AsyncEmbedder();
+
+    AsyncEmbedder(const AsyncEmbedder&) = delete;
+    AsyncEmbedder& operator=(const AsyncEmbedder&) = delete;
+
+    /**
+     * @brief Queue the frame's regions for embedding (frame is copied).
+     *
+     *        Regions without a track id (< 0), with needsClassify unset or
+     *        with a cascade shape label are skipped.
+     */
+    void submit(const cv::Mat& frame, const std::vector<RegionInfo>& regions);
+
+    /**
+     * @brief Cancel every track not in liveTrackIds.
+     *
+     *        Pending work for other tracks is removed and their results,
+     *        including those of the pass in flight, are discarded.
+     */
+    void retain(const std::vector<int>& liveTrackIds);
+
+    /**
+     * @brief Asynchronous counterpart of EmbeddingClassifier::classifyAll.
+     *
+     *        Cancels vanished tracks, classifies finished embeddings against
+     *        db, submits the frame when the queue has room and writes each
+     *        track's latest label, confidence, embedding and crop into
+     *        state.regions.  Tracks still waiting for their first result get
+     *        an empty label, which the auto-learn prompt ignores.  Regions
+     *        labelled by the cascade's shape stage are left alone.
+     *
+     * @param frame   Original BGR frame.
+     * @param state   AppState — reads regions, writes labels and crops.
+     * @param db      Embedding DB.
+     * @param thresh  Distance threshold for unknown detection.
+     * @param metric  0 = sum-squared difference, 1 = cosine distance.
+     */
+    void classifyAll(const cv::Mat& frame, AppState& state,
+                     const EmbeddingDB& db, float thresh, int metric = 0);
+
+    /** Drain the completion queue. */
+    std::vector<Result> poll();
+
+    /** Jobs pending plus the one in flight. */
+    int   queueDepth() const;
+
+    /** True when a new submit() would not drop a pending job. */
+    bool  hasRoom() const;
+
+    /** Forward-pass latency in ms (moving average), 0 before the first pass. */
+    float latencyMs() const;
+
+private:
+    struct Job {
+        cv::Mat                 frame;
+        std::vector<RegionInfo> regions;
+    };
+
+    /** Last classification of a track (render thread only). */
+    struct TrackLabel {
+        std::string        label;
+        float              confidence = 0.f;
+        std::vector<float> embedding;
+        cv::Mat            crop;
+    };
+
+    EmbeddingClassifier&    classifier_;
+    std::map<int, TrackLabel> tracks_;
+    const int               maxPending_;
+
+    mutable std::mutex      mutex_;       ///< Guards everything below
+    std::condition_variable wake_;
+    std::deque<Job>         pending_;
+    std::deque<Result>      completed_;
+    std::set<int>           live_;        ///< Tracks alive at the last retain()
+    bool                    liveKnown_ = false;
+    bool                    busy_      = false;
+    bool                    stop_      = false;
+    float                   latencyMs_ = 0.f;
+
+    std::thread             worker_;
+
+    void run();
+};
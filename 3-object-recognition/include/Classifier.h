@@ -14,6 +14,16 @@
  *            - Cosine distance (extension — for comparison)
  *            - Unknown object detection via confidence threshold
  *              If best distance > threshold → label = "unknown"
+ *            - Nearest class centroid (extension — one distance per label)
+ *
+ *          refit() pre-scales the DB into a KD-tree (one per metric; cosine
+ *          searches unit-length vectors, where 1 - cos = |a - b|^2 / 2), so
+ *          a k-NN query visits only a few leaves instead of every entry.
+ *
+ *          Samples added while running go through learn(): the feature
+ *          statistics are updated incrementally (Welford) and the trees are
+ *          rebuilt on a background thread, then published with one atomic
+ *          pointer swap that queries pick up on their next call.
  *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
@@ -21,9 +31,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include "AppState.h"
+#include "KdTree.h"
 #include "ObjectDB.h"
 
 // =============================================================================
@@ -34,6 +50,7 @@ struct ClassifyResult {
     float       distance    = 1e9f;     ///< Best match distance (lower = better)
     float       confidence  = 0.f;      ///< 1 / (1 + distance), [0..1]
     bool        isUnknown   = true;
+    float       runnerUp    = 1e9f;     ///< Best distance of any other label (if requested)
 };
 
 // =============================================================================
@@ -51,43 +68,146 @@ public:
      */
     explicit Classifier(const ObjectDB& db, const PipelineParams& params);
 
+    /** Stops the background index builder. */
+    ~Classifier();
+
+    Classifier(const Classifier&) = delete;
+    Classifier& operator=(const Classifier&) = delete;
+
     /**
-     * @brief Recompute per-feature standard deviations from current DB.
-     *        Must be called after DB entries are added or removed.
+     * @brief Recompute per-feature standard deviations, search trees and
+     *        class centroids from current DB (synchronously).
+     *        Must be called after DB entries are removed.
      */
     void refit(const ObjectDB& db);
 
+    /**
+     * @brief Take in the DB rows appended since the last refit() / learn().
+     *
+     *        The running mean and variance of each feature are updated with
+     *        Welford's method, O(1) per new row; the search trees and
+     *        centroids are rebuilt on a background thread and swapped in
+     *        atomically, so classification keeps using the previous index
+     *        until then.  Falls back to refit() if the DB shrank.
+     */
+    void learn(const ObjectDB& db);
+
+    /** Incremented each time a new index is published. */
+    int generation() const { return generation_; }
+
     /**
      * @brief Classify a single feature vector.
      *
-     * @param fv      Feature vector (fillRatio, bboxRatio, hu0..hu6).
-     * @param params  Runtime params (k, threshold, metric).
-     * @return        ClassifyResult with label, distance, confidence.
+     * @param fv         Feature vector (fillRatio, bboxRatio, hu0..hu6).
+     * @param params     Runtime params (k, threshold, metric).
+     * @param runnerUp   Also find the closest other label (kNN looks at a
+     *                   few more neighbours than it votes with).
+     * @return           ClassifyResult with label, distance, confidence.
      */
     ClassifyResult classify(const std::vector<double>& fv,
-                            const PipelineParams& params) const;
+                            const PipelineParams& params,
+                            bool runnerUp = false) const;
 
     /**
      * @brief Classify all regions in AppState in place.
-     *        Writes label and confidence into each RegionInfo.
+     *        Writes label and confidence into each RegionInfo; regions
+     *        whose needsClassify is false keep their tracked label.
      *
      * @param state   AppState — reads and writes state.regions.
      * @param params  Pipeline params.
      */
     void classifyAll(AppState& state, const PipelineParams& params) const;
 
+    /** Regions counted by one cascadeAll() pass. */
+    struct CascadeCounts {
+        int classified = 0;   ///< Regions that needed a label this frame
+        int deferred   = 0;   ///< Of those, regions left to the CNN
+    };
+
+    /**
+     * @brief First stage of the CNN cascade.
+     *        Labels every region that needs classifying with the shape
+     *        classifier and marks it shapeLabel when the answer is sure:
+     *        known, confidence >= cascadeConfidence, and best distance at
+     *        most cascadeMargin × the runner-up label's distance. The CNN
+     *        then only runs on the other regions, whose shape label is
+     *        replaced by its answer.
+     *
+     * @param state   AppState — reads and writes state.regions.
+     * @param params  Pipeline params.
+     * @return        How many regions were classified and deferred.
+     */
+    CascadeCounts cascadeAll(AppState& state, const PipelineParams& params) const;
+
 private:
-    const ObjectDB*     db_;
-    std::vector<double> stdevs_;    ///< Per-feature standard deviations
-    std::vector<double> means_;     ///< Per-feature means (for reference)
+    static constexpr int kFeatureDim = kShapeFeatureDim; // fillRatio, bboxRatio, hu0..hu6
+    static constexpr int kRunnerUpNeighbors = 8;          // kNN depth searched for a runner-up
+
+    /** Same layout as DBEntry::toFeatureVector. */
+    static void fillFeatures(const RegionInfo& reg, std::vector<double>& fv);
+
+    /** Welford running mean / variance per feature. */
+    struct RunningStats {
+        long long n = 0;
+        double    mean[kFeatureDim] = {};
+        double    m2[kFeatureDim]   = {};   ///< Sum of squared deviations
+
+        void   add(const double* fv);
+        double stdev(int d) const;          ///< Population stdev (1 if ~0)
+    };
+
+    /** Everything a query reads — immutable once published. */
+    struct Index {
+        std::vector<double>      stdevs;       ///< Per-feature standard deviations
+        std::vector<double>      means;        ///< Per-feature means (for reference)
+        std::vector<std::string> labels;       ///< Distinct DB labels
+        std::vector<int>         rowLabel;     ///< labels index of each DB row
+        KdTree                   euclidTree;   ///< Rows divided by stdevs
+        KdTree                   cosineTree;   ///< Nonzero rows at unit length
+        std::vector<int>         cosineRows;   ///< DB row of each cosineTree point
+        std::vector<int>         zeroRows;     ///< Zero rows (cosine distance 1)
+        std::vector<std::vector<double>> euclidCentroids; ///< Per-label mean
+        std::vector<std::vector<double>> cosineCentroids; ///< Per-label mean direction
+    };
+
+    /** Training rows as last seen in the DB, and their statistics. */
+    struct TrainingData {
+        std::vector<double>      rows;         ///< N x kFeatureDim
+        std::vector<int>         rowName;      ///< names index of each row
+        std::vector<std::string> names;        ///< DB label dictionary
+        RunningStats             stats;
+        long long                version = 0;  ///< Bumped on every change
+    };
+
+    const ObjectDB*              db_;
+    std::shared_ptr<const Index> index_;       ///< atomic_load / atomic_store
+    std::atomic<int>             generation_{0};
+
+    std::mutex                   dataMutex_;   ///< Guards data_, pending_, stop_, published_
+    TrainingData                 data_;
+    long long                    published_ = -1; ///< data_.version of index_
+    bool                         pending_   = false;
+    bool                         stop_      = false;
+    std::condition_variable      wake_;
+    std::thread                  worker_;      ///< Started by the first learn()
+
+    /** Build the index of a snapshot of the training data. */
+    static std::shared_ptr<const Index> buildIndex(const TrainingData& data);
+
+    /** Swap in an index unless a newer one is already published. */
+    void publish(std::shared_ptr<const Index> index, long long version);
+
+    void rebuildLoop();
 
-    static constexpr int kFeatureDim = 9; // fillRatio, bboxRatio, hu0..hu6
+    /** k nearest DB rows as (distance, row), ascending. */
+    static void nearest(const Index& index, const std::vector<double>& fv, int k,
+                        int metric, std::vector<std::pair<float, int>>& out);
 
     /** Scaled Euclidean distance between two feature vectors. */
-    float scaledEuclidean(const std::vector<double>& a,
-                          const std::vector<double>& b) const;
+    static float scaledEuclidean(const Index& index, const std::vector<double>& a,
+                                 const std::vector<double>& b);
 
     /** Cosine distance between two feature vectors. */
-    float cosineDistance(const std::vector<double>& a,
-                         const std::vector<double>& b) const;
+    static float cosineDistance(const std::vector<double>& a,
+                                const std::vector<double>& b);
 };
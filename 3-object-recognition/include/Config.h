@@ -0,0 +1,59 @@
+/**
+ * @file    Config.h
+ * @brief   Persistent settings that survive restarts (data/config.yml).
+ *
+ *          Stored with cv::FileStorage.  Only settings tied to the physical
+ *          setup are kept here — currently the processing ROI (the tray
+ *          area).  Tuning parameters still start from PipelineParams
+ *          defaults.
+ *
+ *          writeParams() / readParams() store every PipelineParams field,
+ *          for recorded sessions (SessionRecorder).
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include "AppState.h"
+
+/**
+ * @brief Read persisted settings into params (missing keys are left as is).
+ *
+ * @param path    Config file path.
+ * @param params  Pipeline parameters to update.
+ * @return        True if the file was read.
+ */
+bool loadConfig(const std::string& path, PipelineParams& params);
+
+/**
+ * @brief Write persisted settings from params.
+ *
+ * @param path    Config file path (parent directory created if needed).
+ * @param params  Pipeline parameters.
+ * @return        True on success.
+ */
+bool saveConfig(const std::string& path, const PipelineParams& params);
+
+/**
+ * @brief Write every PipelineParams field as a FileStorage map.
+ *
+ * @param fs      Storage open for writing.
+ * @param name    Key of the map.
+ * @param params  Pipeline parameters.
+ */
+void writeParams(cv::FileStorage& fs, const std::string& name, const PipelineParams& params);
+
+/**
+ * @brief Read a map written by writeParams() (missing keys are left as is).
+ *
+ * @param node    The map.
+ * @param params  Pipeline parameters to update.
+ */
+void readParams(const cv::FileNode& node, PipelineParams& params);
+
+/** True if every field stored by writeParams() is equal. */
+bool sameParams(const PipelineParams& a, const PipelineParams& b);
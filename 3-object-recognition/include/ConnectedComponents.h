@@ -10,10 +10,34 @@
  *            Satisfies the solo-developer requirement alongside Morphology.cpp.
  *
  *          Algorithm overview:
- *            Pass 1 — scan left-to-right, top-to-bottom; assign provisional
- *                     labels and record equivalences when regions merge.
- *            Pass 2 — replace every provisional label with its canonical
- *                     (root) label from the union-find structure.
+ *            Pass 1 — split the image into horizontal row bands and scan
+ *                     each band concurrently (left-to-right, top-to-bottom);
+ *                     assign provisional labels from a band-private label
+ *                     range and record equivalences when regions merge.
+ *            Merge  — unite labels across the first row of every band and
+ *                     the last row of the band above it.
+ *            Pass 2 — map every provisional label to a compact id
+ *                     (numbered in raster order of first appearance).
+ *
+ *          Output is run-length encoded: as pass 1 finishes a row it emits
+ *          that row's foreground runs, and pass 2 only relabels the runs.
+ *          Horizontally adjacent pixels are always connected, so each run
+ *          belongs to one component.  The dense provisional label map is
+ *          internal scratch; region stats, features and the region display
+ *          are computed from the runs — O(runs) instead of O(pixels), and a
+ *          scene with a few large blobs has a few runs per row.
+ *
+ *          Label modes (PipelineParams::labelMode):
+ *            0 — parallel pixel scan, 4-connected (default)
+ *            1 — parallel 2x2 block scan, 8-connected (Grana et al. BBDT
+ *                style: one provisional label per block, so a quarter of
+ *                the union-find traffic)
+ *            2 — single band, 4-connected (sequential reference)
+ *
+ *          Given the mask's tile occupancy (one bit per 32x32 tile), runs
+ *          are read from occupied tiles only and united directly — run
+ *          against overlapping run of the row above — with no label map.
+ *          Labels come out the same as from the dense scan.
  *
  *          After labeling, regions are filtered by minimum area and ranked
  *          by size.  Each surviving region is assigned a display color from
@@ -26,6 +50,9 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <cvcore/tileOccupancy.hpp>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include "AppState.h"
 
@@ -34,28 +61,73 @@
 // =============================================================================
 
 /**
- * @brief Simple union-find structure for label equivalence tracking.
+ * @brief Union-find with union by rank and iterative path halving.
+ *
+ *        The parallel labeller allocates one slot per possible provisional
+ *        label but only initialises slots as bands create labels (makeSet),
+ *        so each band touches only its own label range.
  */
 struct UnionFind {
-    std::vector<int> parent; ///< parent[i] = parent label of label i
+    std::vector<int>     parent; ///< parent[i] = parent label of label i
+    std::vector<uint8_t> rank;   ///< Upper bound on tree height per root
+
+    UnionFind() = default;
 
-    explicit UnionFind(int n) : parent(n) {
+    explicit UnionFind(int n) : parent(n), rank(n, 0) {
         for (int i = 0; i < n; i++) parent[i] = i;
     }
 
-    /** Find root label with path compression. */
+    /** Size for n labels without initialising them (see makeSet). */
+    void allocate(int n) {
+        if (static_cast<int>(parent.size()) < n) { parent.resize(n); rank.resize(n); }
+    }
+
+    /** Make x a singleton set and return it. */
+    int makeSet(int x) {
+        parent[x] = x;
+        rank[x]   = 0;
+        return x;
+    }
+
+    /** Find root label, halving the path on the way up. */
     int find(int x) {
-        if (parent[x] != x) parent[x] = find(parent[x]);
-        return parent[x];
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
     }
 
-    /** Union two labels — smaller root becomes child. */
-    void unite(int a, int b) {
+    /** Union two labels — lower-rank root becomes child; returns new root. */
+    int unite(int a, int b) {
         a = find(a); b = find(b);
-        if (a != b) parent[b] = a;
+        if (a == b) return a;
+        if (rank[a] < rank[b]) std::swap(a, b);
+        parent[b] = a;
+        if (rank[a] == rank[b]) rank[a]++;
+        return a;
     }
 };
 
+// =============================================================================
+// Run-length label image
+// =============================================================================
+
+/** Foreground pixels [colBegin, colEnd) of one row, all of one component. */
+struct LabelRun {
+    int row;
+    int colBegin;
+    int colEnd;     ///< One past the last pixel
+    int label;      ///< Component id (1..numLabels)
+};
+
+/** Labeller output: every foreground run of the image, in raster order. */
+struct RegionRuns {
+    cv::Size              size;          ///< Size of the labelled image
+    int                   numLabels = 0; ///< Components (labels 1..numLabels)
+    std::vector<LabelRun> runs;
+};
+
 // =============================================================================
 // Public API
 // =============================================================================
@@ -63,47 +135,117 @@ struct UnionFind {
 /**
  * @brief Run two-pass connected components on a binary image from scratch.
  *
+ *        Labels are numbered in raster order of each component's first
+ *        pixel (first 2x2 block in block mode), so the output does not
+ *        depend on the number of bands.
+ *
  * @param binary     Input binary image (CV_8UC1, 0=background, 255=foreground).
- * @param labelMap   Output label map (CV_32SC1); 0=background, 1..N=regions.
+ * @param runs       Output: labelled foreground runs.
+ * @param labelMode  0=parallel 4-connected, 1=parallel 2x2 block 8-connected,
+ *                   2=sequential 4-connected.
  * @return           Number of foreground labels found (before size filtering).
  */
-int twoPassLabel(const cv::Mat& binary, cv::Mat& labelMap);
+int twoPassLabel(const cv::Mat& binary, RegionRuns& runs, int labelMode = 0);
+
+/**
+ * @brief twoPassLabel reading only the occupied tiles of binary.
+ *
+ *        Foreground runs of occupied tiles are united with the runs they
+ *        touch in the row above (overlapping for 4-connected modes, also
+ *        diagonally for block mode), then numbered like the dense scan.
+ *        Falls back to it when most tiles are occupied.
+ *
+ * @param binary     Input binary image (CV_8UC1).
+ * @param runs       Output: labelled foreground runs.
+ * @param labelMode  As for twoPassLabel (same connectivity and numbering).
+ * @param tiles      Occupancy of binary; clear tiles must be empty.
+ * @return           Number of foreground labels found.
+ */
+int twoPassLabel(const cv::Mat& binary, RegionRuns& runs, int labelMode,
+                 const cvcore::TileOccupancy& tiles);
+
+/**
+ * @brief Two-pass labeller fed one band of binary rows at a time.
+ *
+ *        Pass 1 runs as each band arrives (top to bottom), so the binary
+ *        mask never has to exist as a full frame; finish() runs pass 2.
+ *        Labels match twoPassLabel for the same labelMode.
+ */
+class StreamLabeler {
+public:
+    /** Start a frame; runs are written to out by finish(). */
+    void begin(cv::Size size, int labelMode, RegionRuns& out);
+
+    /**
+     * @brief Pass 1 over the next band.
+     *
+     * @param rows      Binary rows (CV_8UC1) for image rows rowBegin onward.
+     * @param rowBegin  First image row; bands arrive in order without gaps
+     *                  and start on even rows in block mode.
+     */
+    void addRows(const cv::Mat& rows, int rowBegin);
+
+    /** Pass 2 — returns the number of foreground labels. */
+    int finish();
+
+private:
+    RegionRuns* out_       = nullptr;
+    cv::Mat     labelMap_;              ///< Provisional labels (scratch)
+    UnionFind   uf_;
+    bool        blocks_    = false;
+    int         nextLabel_ = 1;
+};
 
 /**
- * @brief Compute per-region stats (area, centroid, bounding box) from labelMap.
+ * @brief Compute per-region stats (area, centroid, bounding box) from runs.
  *
- * @param labelMap   Label map from twoPassLabel (CV_32SC1).
- * @param numLabels  Total number of labels including background (label 0).
+ * @param runs       Labeller output.
  * @param areas      Output: pixel area per label index.
  * @param centroids  Output: centroid (cx,cy) per label index.
  * @param bboxes     Output: axis-aligned bounding box per label index.
  */
-void computeRegionStats(const cv::Mat& labelMap, int numLabels,
+void computeRegionStats(const RegionRuns& runs,
                         std::vector<int>&         areas,
                         std::vector<cv::Point2f>& centroids,
                         std::vector<cv::Rect>&    bboxes);
 
 /**
- * @brief Build color-coded region display image from label map.
+ * @brief Build color-coded region display image from the runs.
  *
  *        Each surviving region is drawn in a unique color from a fixed
  *        palette.  Background is black.
  *
- * @param labelMap      Label map (CV_32SC1).
+ * @param runs          Labeller output.
  * @param regions       Filtered region list (provides ids and display colors).
- * @param dst           Output BGR color image (same size as labelMap).
+ * @param dst           Output BGR color image (runs.size).
  */
-void buildRegionDisplay(const cv::Mat& labelMap,
+void buildRegionDisplay(const RegionRuns& runs,
                         const std::vector<RegionInfo>& regions,
                         cv::Mat& dst);
 
+/**
+ * @brief Filter labelled regions by area, keep the largest, fill state.regions.
+ *
+ * @param runs          Labeller output.
+ * @param state         AppState — regions (and frameRegions) written here.
+ * @param params        Pipeline parameters (minRegionArea, maxRegions).
+ * @param buildDisplay  Also render state.frameRegions; otherwise it is released.
+ */
+void collectRegions(const RegionRuns& runs, AppState& state,
+                    const PipelineParams& params, bool buildDisplay = true);
+
 /**
  * @brief Full connected components pipeline stage.
  *
  * @param cleaned    Binary image after morphology (CV_8UC1).
  * @param state      AppState — regions and frameRegions written here.
- * @param params     Pipeline parameters (minRegionArea, maxRegions).
- * @param labelMap   Output label map (CV_32SC1) — needed by Task 4 features.
+ * @param params     Pipeline parameters (labelMode, minRegionArea, maxRegions).
+ * @param runs       Output: labelled runs — needed by Task 4 features.
  */
 void findRegions(const cv::Mat& cleaned, AppState& state,
-                 const PipelineParams& params, cv::Mat& labelMap);
\ No newline at end of file
+                 const PipelineParams& params, RegionRuns& runs);
+
+/** findRegions labelling only the occupied tiles of cleaned. */
+void findRegions(const cv::Mat& cleaned, AppState& state,
+                 const PipelineParams& params, RegionRuns& runs,
+                 const cvcore::TileOccupancy& tiles);
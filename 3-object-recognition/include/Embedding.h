@@ -9,7 +9,8 @@
  *            4. Classify by nearest embedding in training set
  *
  *          Training DB stored separately from hand-feature DB:
- *            data/db/embeddings.csv  — label + 512 float values
+ *            data/db/embeddings.bin  — binary label + 512 float records
+ *          An existing embeddings.csv beside it is imported on first load.
  *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
@@ -19,9 +20,13 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "AppState.h"
+#include "HnswIndex.h"
 
 // =============================================================================
 // EmbeddingEntry — one labeled embedding vector
@@ -33,77 +38,259 @@ struct EmbeddingEntry {
 
 // =============================================================================
 // EmbeddingDB — stores labeled embeddings for one-shot classification
+//
+// Vectors live in one packed N x dim CV_32F matrix of L2-normalised rows
+// plus a norm per row, so cosine distance is a single dot product and SSD
+// is |q|^2 + n^2 - 2 n (q . u).  Labels are interned as indices.
+//
+// File format (little-endian): "EMB1", int32 dim, then one record per
+// entry: uint16 label length, label bytes, dim float32 values (unnormalised).
+// Records are self-contained, so append() never rewrites the file.
+//
+// With setIndexed(), nearest() searches an HNSW graph over the unit rows
+// once the DB has 2048 entries and re-ranks its candidates by the
+// exact metric.  The graph grows with every append() and is kept in
+// <stem>.hnsw beside the database; rows the saved graph lacks (appended by
+// another process, or after a crash) are inserted when it is loaded.
 // =============================================================================
 class EmbeddingDB {
 public:
     /**
      * @brief Construct and optionally auto-load the embedding database.
-     * @param filepath  Path to the CSV file (created on first save if absent).
+     * @param filepath  Path to the binary file (created on first save if
+     *                  absent).  A .csv path is read as the legacy format.
      */
     explicit EmbeddingDB(const std::string& filepath =
-                         "data/db/embeddings.csv");
+                         "data/db/embeddings.bin");
+
+    /** Writes the graph if setIndexed() added nodes since it was saved. */
+    ~EmbeddingDB();
 
     /**
-     * @brief Load all entries from the CSV file, replacing in-memory state.
-     * @return True on success, false if the file could not be opened.
+     * @brief Load all entries, replacing in-memory state.
+     *
+     *        If the binary file is missing but a legacy CSV with the same
+     *        stem exists, the CSV is imported and written out as binary.
+     *
+     * @return True on success, false if no file could be opened.
      */
     bool load();
 
     /**
-     * @brief Write all in-memory entries to the CSV file.
+     * @brief Write all in-memory entries to the database file.
      * @return True on success, false if the file could not be written.
      */
     bool save() const;
 
     /**
-     * @brief Append a single entry to the CSV file and to the in-memory list.
+     * @brief Append a single entry to the file and to the in-memory matrix.
      * @param entry  Labeled embedding to store.
      * @return       True on success.
      */
     bool append(const EmbeddingEntry& entry);
 
-    /** Clear all in-memory entries (does not modify the CSV file). */
-    void clear();
+    /**
+     * @brief Add an entry in memory only (the file is not touched), e.g. to
+     *        build a derived set such as PrototypeCondenser's prototypes.
+     */
+    void insert(const EmbeddingEntry& entry);
 
-    /** Return a read-only reference to all stored entries. */
-    const std::vector<EmbeddingEntry>& entries() const { return entries_; }
+    /** Clear all in-memory entries (does not modify the file). */
+    void clear();
 
     /** Return true if the database contains no entries. */
-    bool  empty() const { return entries_.empty(); }
+    bool  empty() const { return labelIdx_.empty(); }
 
     /** Return the total number of stored entries. */
-    int   size()  const { return static_cast<int>(entries_.size()); }
+    int   size()  const { return static_cast<int>(labelIdx_.size()); }
+
+    /**
+     * @brief Switch to another database file and load it (e.g. the DB of
+     *        another embedding model).  An absent file gives an empty DB.
+     */
+    bool open(const std::string& filepath);
+
+    /** Database file path. */
+    const std::string& path() const { return filepath_; }
+
+    /** Embedding dimension (0 while empty). */
+    int   dim()   const { return unit_.cols; }
+
+    /** Label of entry i. */
+    const std::string& label(int i) const { return labels_[labelIdx_[i]]; }
+
+    /** Entry i with its original (unnormalised) embedding. */
+    EmbeddingEntry entry(int i) const;
+
+    /** All embeddings as an N x dim CV_32F matrix (unnormalised). */
+    cv::Mat matrix() const;
+
+    /** Packed L2-normalised rows (N x dim CV_32F); row i times norm(i) is entry i. */
+    const cv::Mat& unitRows() const { return unit_; }
+
+    /** L2 norm of entry i's original embedding. */
+    float norm(int i) const { return norms_[i]; }
+
+    /**
+     * @brief Incremented by clear() (and so by load()).  While it is
+     *        unchanged, rows only ever get appended — existing rows keep
+     *        their index and value.
+     */
+    int   generation() const { return generation_; }
+
+    /** Return map of label → sample count. */
+    std::map<std::string, int> labelCounts() const;
+
+    /**
+     * @brief Nearest entry to a query embedding.
+     *
+     * @param query    dim floats.
+     * @param metric   0 = sum-squared difference, 1 = cosine distance.
+     * @param outDist  Output: distance to the nearest entry (1e9 if none).
+     * @return         Index of the nearest entry, -1 if empty or the
+     *                 dimension differs.
+     */
+    int nearest(const std::vector<float>& query, int metric, float& outDist) const;
+
+    /**
+     * @brief Search an HNSW graph instead of every row (see the class
+     *        comment).  Enabling loads <stem>.hnsw, or builds the graph from
+     *        the loaded rows and writes it; disabling writes and drops it.
+     */
+    void setIndexed(bool on);
+
+    /** True while nearest() may use the HNSW graph. */
+    bool indexed() const { return indexed_; }
 
 private:
-    std::string                filepath_;
-    std::vector<EmbeddingEntry> entries_;
+    std::string              filepath_;
+    cv::Mat                  unit_;      ///< N x dim CV_32F, L2-normalised rows
+    std::vector<float>       norms_;     ///< L2 norm of each original row
+    std::vector<int>         labelIdx_;  ///< labels_ index per row
+    std::vector<std::string> labels_;    ///< Distinct labels
+    int                      generation_ = 0;
+    HnswIndex                index_;              ///< Graph over unit_ (setIndexed)
+    bool                     indexed_    = false;
+    mutable bool             indexDirty_ = false; ///< index_ has nodes not yet on disk
+
+    void addRow(const EmbeddingEntry& entry);
+    void indexNewRows();
+    void syncIndex();
+    void flushIndex() const;
+    std::string indexPath() const;
+    bool loadBinary(const std::string& path);
+    bool loadCsv(const std::string& path);
+};
+
+// =============================================================================
+// EmbedRequest — one region of one frame, for batches spanning several frames
+// =============================================================================
+struct EmbedRequest {
+    const cv::Mat*    frame;
+    const RegionInfo* region;
+};
+
+// =============================================================================
+// LoadedModel — an embedding network read and probed, not yet in use
+// =============================================================================
+struct LoadedModel {
+    cv::dnn::Net net;
+    std::string  path;
+    std::string  layer;         ///< Output used as the embedding (see embeddingLayer())
+    int          dim     = 0;   ///< Embedding dimension
+    int          backend = 0;   ///< PipelineParams::dnnBackend it was configured for
 };
 
 // =============================================================================
 // EmbeddingClassifier — loads ResNet18 and classifies via embedding distance
+//
+// Embedding calls, backend changes and model swaps are serialised
+// internally, so one instance may be shared by the render loop, an
+// AsyncEmbedder worker and a background model loader.
 // =============================================================================
 class EmbeddingClassifier {
 public:
     /**
-     * @brief Load ResNet18 ONNX model.
-     * @param modelPath  Path to resnet18-v2-7.onnx
-     * @return           True if model loaded successfully.
+     * @brief Load an ONNX embedding model (prepareModel() + swapModel()).
+     * @param modelPath   Path to resnet18-v2-7.onnx (or another backbone).
+     * @param dnnBackend  Backend/target (see PipelineParams::dnnBackend).
+     * @return            True if model loaded successfully.
      */
     bool loadModel(const std::string& modelPath =
-                   "data/models/resnet18-v2-7.onnx");
+                   "data/models/resnet18-v2-7.onnx",
+                   int dnnBackend = 0);
+
+    /**
+     * @brief Read an ONNX model and probe its embedding dimension with one
+     *        forward pass.  Touches no classifier state, so it can run on a
+     *        background thread while the current model keeps serving.
+     *
+     * @param modelPath   ONNX file taking a 1 x 3 x 224 x 224 ImageNet input.
+     * @param dnnBackend  Backend/target (see PipelineParams::dnnBackend).
+     * @param out         Output: the ready network.
+     * @return            True if the model loaded and produced an embedding.
+     */
+    static bool prepareModel(const std::string& modelPath, int dnnBackend,
+                             LoadedModel& out);
+
+    /**
+     * @brief Swap a prepared model in between two forward passes.
+     *        Increments modelGeneration().
+     */
+    void swapModel(LoadedModel&& model);
+
+    /**
+     * @brief Mean forward-pass time per crop of a prepared model.
+     *
+     *        Runs one warm-up pass, then runs passes over a synthetic batch.
+     *
+     * @return Milliseconds per crop, or -1 if the forward pass failed.
+     */
+    static float benchmark(LoadedModel& model, int batch = 8, int runs = 5);
+
+    /** Path of the model in use. */
+    std::string modelPath() const;
+
+    /** Embedding dimension of the model in use (0 before loading). */
+    int  embeddingDim() const { return dim_; }
+
+    /** Incremented by every model swap — embeddings before it are stale. */
+    int  modelGeneration() const { return generation_; }
+
+    /**
+     * @brief Select the DNN backend/target for subsequent forward passes.
+     *
+     *        0=OpenCV CPU, 1=OpenCL, 2=OpenCL FP16, 3=CUDA, 4=CUDA FP16,
+     *        5=OpenVINO.  If OpenCV was built without the backend, it falls
+     *        back to the CPU on the next forward pass (with a warning).
+     */
+    void setBackend(int dnnBackend);
+
+    /** Return the selected backend (PipelineParams::dnnBackend value). */
+    int  backend() const { return backend_; }
 
     /** Return true if model is loaded and ready. */
     bool isReady() const { return modelLoaded_; }
 
+    /**
+     * @brief Keep 224x224 display crops in computeEmbeddings() / classifyAll().
+     *        Off when no crop window is open: the batch is then built without
+     *        any per-region allocation.
+     */
+    void setKeepCrops(bool keep) { keepCrops_ = keep; }
+
     /**
      * @brief Compute embedding for a region in the frame.
      *
-     *        Uses prepEmbeddingImage() then getEmbedding() internally.
+     *        Same fused crop as computeEmbeddings(); with debug, the
+     *        step-by-step prepEmbeddingImage() / getEmbedding() path runs
+     *        instead and shows its intermediate windows.
      *
      * @param frame   Original BGR frame.
      * @param reg     RegionInfo with centroid, angle, axis extents.
      * @param emb     Output embedding vector (512 floats).
      * @param debug   Show intermediate images if true.
+     * @param cropOut Optional output: 224x224 display crop (always filled).
      * @return        True on success.
      */
     bool computeEmbedding(cv::Mat& frame, const RegionInfo& reg,
@@ -111,36 +298,99 @@ public:
                           cv::Mat* cropOut = nullptr);
 
     /**
-     * @brief Classify a region using sum-squared distance to DB entries.
+     * @brief Compute embeddings for several regions with one forward pass.
+     *
+     *        Each region's rotate + crop + resize is one affine transform,
+     *        applied by a single warpAffine into a reused 224x224 tile; the
+     *        tile is written to the region's slot of a preallocated NCHW
+     *        float batch with the channel swap and mean / std normalisation
+     *        fused in.  No full-frame copy or rotated canvas is made.
+     *
+     * @param frame    Original BGR frame.
+     * @param regions  Regions to embed.
+     * @param embs     Output: one 512-float vector per region (empty if the
+     *                 region's crop failed).
+     * @param crops    Optional output: 224x224 display crop per region
+     *                 (empty Mat if the crop failed).
+     * @return         Number of regions embedded.
+     */
+    int computeEmbeddings(cv::Mat& frame, const std::vector<RegionInfo>& regions,
+                          std::vector<std::vector<float>>& embs,
+                          std::vector<cv::Mat>* crops = nullptr);
+
+    /**
+     * @brief Embed regions of different frames (e.g. several camera
+     *        streams) in one forward pass.  No display crops.
+     *
+     * @param requests  Frame and region of each slot (must stay alive).
+     * @param embs      Output: one vector per request (empty if its crop failed).
+     * @return          Number of regions embedded.
+     */
+    int computeEmbeddings(const std::vector<EmbedRequest>& requests,
+                          std::vector<std::vector<float>>& embs);
+
+    /**
+     * @brief Classify a region by its nearest DB entry.
      *
      * @param emb           Query embedding.
      * @param db            Embedding database.
-     * @param threshold     Max SSD distance to accept as known (0 = no limit).
+     * @param threshold     Max distance to accept as known (0 = no limit).
      * @param outLabel      Output: best matching label or "unknown".
      * @param outDist       Output: best matching distance.
+     * @param metric        0 = sum-squared difference, 1 = cosine distance.
      */
     void classify(const std::vector<float>& emb,
                   const EmbeddingDB& db,
                   float threshold,
                   std::string& outLabel,
-                  float& outDist) const;
+                  float& outDist,
+                  int metric = 0) const;
+
+    /** Unknown threshold for a metric from PipelineParams::confidenceThresh. */
+    static float threshold(const PipelineParams& params);
+
+    /** Confidence in [0..1] from a classify() distance. */
+    static float confidence(float dist, int metric);
 
     /**
      * @brief Classify all regions in AppState using embeddings.
      *
+     *        All regions with needsClassify set are embedded in one
+     *        batched forward pass; the others keep their tracked label,
+     *        embedding and crop.
+     *
      * @param frame   Original BGR frame.
      * @param state   AppState — reads regions, writes embedding labels.
      * @param db      Embedding DB.
      * @param thresh  Distance threshold for unknown detection.
+     * @param metric  0 = sum-squared difference, 1 = cosine distance.
      */
     void classifyAll(cv::Mat& frame, AppState& state,
-                     const EmbeddingDB& db, float thresh);
+                     const EmbeddingDB& db, float thresh, int metric = 0);
 
 private:
     cv::dnn::Net net_;
-    bool         modelLoaded_ = false;
+    std::string  modelPath_;         ///< (pathMutex_)
+    mutable std::mutex pathMutex_;   ///< Readable while a forward pass runs
+    std::string  layer_;             ///< Embedding output of net_ (netMutex_)
+    std::atomic<bool> modelLoaded_{false};
+    std::atomic<int>  dim_{0};
+    std::atomic<int>  generation_{0};
+    int          backend_     = 0;
+    std::mutex   netMutex_;          ///< One forward pass / backend change / swap at a time
+    cv::Mat      batch_;             ///< N x 3 x 224 x 224 input, grown as needed (netMutex_)
+    std::atomic<bool> keepCrops_{true};
+
+    /** computeEmbeddings() with crops filled whenever requested. */
+    int embedBatch(const std::vector<EmbedRequest>& requests,
+                   std::vector<std::vector<float>>& embs,
+                   std::vector<cv::Mat>* crops);
+
+    /** setBackend() with netMutex_ held. */
+    void applyBackend(int dnnBackend);
+
+    /** Masked, axis-aligned ROI of a region, step by step (debug path). */
+    bool prepareCrop(cv::Mat& frame, const RegionInfo& reg,
+                     cv::Mat& embImage, bool debug, cv::Mat* cropOut);
 
-    /** Sum-squared distance between two embedding vectors. */
-    float ssdDistance(const std::vector<float>& a,
-                      const std::vector<float>& b) const;
 };
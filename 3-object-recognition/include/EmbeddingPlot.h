@@ -9,7 +9,12 @@
  *          Each label gets a unique color. Well-separated clusters indicate
  *          the CNN embedding space distinguishes objects effectively.
  *
- *          PCA is computed from scratch using cv::PCACompute.
+ *          The PCA is streaming: the running sum and scatter matrix absorb
+ *          only the rows appended since the last sync(), and the two axes
+ *          are refined by power iteration warm-started from the previous
+ *          ones.  DB points are projected and drawn into a cached
+ *          background once per DB change; each frame only projects the
+ *          live regions on top of it.
  *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
@@ -21,15 +26,53 @@
 #include <vector>
 #include <string>
 #include <map>
+#include "AppState.h"
 #include "Embedding.h"
 
-/**
- * @brief Compute 2D PCA projection of all embeddings and render scatter plot.
- *
- * @param db        Embedding DB containing labeled 512-dim vectors.
- * @param plotSize  Output image size in pixels (square).
- * @param dst       Output BGR scatter plot image.
- */
-void renderEmbeddingPlot(const EmbeddingDB& db,
-                          int plotSize,
-                          cv::Mat& dst);
\ No newline at end of file
+// =============================================================================
+// EmbeddingPlot — incremental PCA scatter plot of an EmbeddingDB
+// =============================================================================
+class EmbeddingPlot {
+public:
+    /** @param plotSize  Output image size in pixels (square). */
+    explicit EmbeddingPlot(int plotSize = 500);
+
+    /**
+     * @brief Fold DB rows appended since the last call into the PCA.
+     *
+     *        Cheap when nothing changed.  After clear()/load() (a new
+     *        EmbeddingDB::generation()) the statistics are rebuilt from
+     *        scratch.  Redraws the cached background when the DB changed.
+     */
+    void sync(const EmbeddingDB& db);
+
+    /**
+     * @brief Cached background plus the live regions' embeddings.
+     *
+     * @param regions  Current frame regions; those with an embedding of
+     *                 the DB's dimension are projected and marked.
+     * @param dst      Output BGR scatter plot image.
+     */
+    void render(const std::vector<RegionInfo>& regions, cv::Mat& dst) const;
+
+private:
+    int     plotSize_;
+    int     generation_ = -1;   ///< EmbeddingDB::generation() last synced
+    int     rows_       = 0;    ///< DB rows folded into the statistics
+    int     dim_        = 0;
+
+    cv::Mat sum_;       ///< 1 x dim CV_64F, sum of rows
+    cv::Mat scatter_;   ///< dim x dim CV_64F, sum of x^T x
+    cv::Mat axes_;      ///< 2 x dim CV_64F, unit PC1 / PC2 (empty until fitted)
+    double  offset_[2] = {0.0, 0.0};  ///< mean . axis, subtracted on projection
+
+    std::vector<cv::Point2f>          projected_;   ///< Per DB row
+    std::map<std::string, cv::Scalar> colorMap_;    ///< Label → color, first-appearance order
+    float   minX_ = 0.f, minY_ = 0.f, rangeX_ = 1.f, rangeY_ = 1.f;
+    cv::Mat background_;
+
+    void reset(int dim);
+    void fitAxes();
+    void drawBackground(const EmbeddingDB& db);
+    cv::Point toPixel(const cv::Point2f& p) const;
+};
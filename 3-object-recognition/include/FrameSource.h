@@ -0,0 +1,117 @@
+/**
+ * @file    FrameSource.h
+ * @brief   Capture on a dedicated decode thread with a latest-frame ring.
+ *
+ *          Reads through cvcore::FrameSource, so it opens whatever that
+ *          opens: a camera index (V4L2 mmap buffers on Linux), a video file,
+ *          a network stream (rtsp://, http://, ...), a GStreamer pipeline
+ *          (any spec containing " ! ") or an image sequence.  Files and
+ *          streams are hardware-decoded where the backend supports it.
+ *
+ *          The decode thread fills a small ring of frame slots that keep
+ *          their buffers.  With frame dropping on, next() hands the newest
+ *          decoded frame to the pipeline and skips older ones, and the
+ *          decoder overwrites the oldest waiting frame instead of blocking,
+ *          so a slow pipeline always sees the live picture; files are then
+ *          paced to their frame rate.  With it off every frame is processed
+ *          and the decoder waits for free slots.
+ *
+ *          Network streams reopen after a read failure; cameras and files
+ *          end the stream.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <cvcore/capture.hpp>
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class FrameSource {
+public:
+    /** Decode counters, safe to read from any thread. */
+    struct Stats {
+        long long decoded    = 0;     ///< Frames read from the source
+        long long dropped    = 0;     ///< Frames skipped before processing
+        int       reconnects = 0;     ///< Network stream reopens
+        float     decodeFps  = 0.f;   ///< Decode rate (moving average)
+        bool      hwDecode   = false; ///< Backend reports hardware decoding
+    };
+
+    FrameSource() = default;
+
+    /** Stop the decode thread. */
+    ~FrameSource();
+
+    FrameSource(const FrameSource&) = delete;
+    FrameSource& operator=(const FrameSource&) = delete;
+
+    /**
+     * @brief Open a source and start decoding.
+     *
+     * @param spec        Any cvcore::FrameSource spec; empty selects camera.
+     * @param camera      Camera index used when spec is empty.
+     * @param dropFrames  Initial frame dropping (see setDropFrames()).
+     * @return            True if the source opened.
+     */
+    bool open(const std::string& spec, int camera = 0, bool dropFrames = true);
+
+    /** Stop decoding and release the source. */
+    void close();
+
+    /** Skip frames when the pipeline falls behind (may change any time). */
+    void setDropFrames(bool drop) { dropFrames_ = drop; }
+
+    /**
+     * @brief Wait for the next frame to process.
+     *
+     * @param frame  Output: shares the slot's buffer, valid until the next
+     *               call (the slot is not refilled before then).
+     * @return       False once the source has ended or close() was called.
+     */
+    bool next(cv::Mat& frame);
+
+    /** next() with the frame's sequence number and capture timestamp. */
+    bool next(cvcore::Frame& frame);
+
+    /** Current counters. */
+    Stats stats() const;
+
+    /** Human-readable source and backend, e.g. "rtsp://... (FFMPEG, HW)". */
+    const std::string& description() const { return description_; }
+
+private:
+    using Kind = cvcore::FrameSource::Kind;
+
+    static constexpr int kSlots = 4;  ///< One being processed, one decoding, two waiting
+
+    std::unique_ptr<cvcore::FrameSource> capture_;
+    std::string       spec_;
+    std::string       description_;
+    double            fileFps_ = 0.0;  ///< Pacing rate of a file when dropping
+
+    std::atomic<bool> dropFrames_{true};
+
+    mutable std::mutex      mutex_;     ///< Guards everything below
+    std::condition_variable wake_;      ///< Frame ready / slot freed / stop
+    std::array<cvcore::Frame, kSlots> slots_;
+    std::deque<int>         ready_;     ///< Decoded, oldest first
+    int                     reading_ = -1;  ///< Slot held by next()'s caller
+    bool                    ended_   = false;
+    bool                    stop_    = false;
+    Stats                   stats_;
+
+    std::thread             decoder_;
+
+    int  acquireSlot(std::unique_lock<std::mutex>& lock);
+    void run();
+};
@@ -2,15 +2,22 @@
  * @file    GUI.h
  * @brief   Dear ImGui GUI manager for the Object Recognition system.
  *
- *          Renders four dockable panels in a GLFW/OpenGL3 window:
+ *          Renders dockable panels in a GLFW/OpenGL3 window:
  *            1. Pipeline Controls  — threshold, blur, morph sliders
  *            2. Training Panel     — label input, capture buttons
  *            3. DB Manager         — label list, delete, sample counts
  *            4. Confusion Matrix   — color-coded evaluation table
+ *            5. Profiler           — per-stage timings, p95, trace export
+ *            6. Models             — embedding model hot-swap and benchmark
  *
  *          All panels read/write PipelineParams and AppState directly.
  *          OpenCV windows remain unchanged alongside the ImGui window.
  *
+ *          Panels are only rebuilt when something changed (needsFrame()):
+ *          new pipeline results, input, or a settings change made outside
+ *          the window.  An idle window sleeps in waitEvents() and repaints
+ *          its last draw lists when the window system asks for it.
+ *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
  */
@@ -23,6 +30,7 @@
 #include "Classifier.h"
 #include "Evaluator.h"
 #include "Embedding.h"
+#include "ModelManager.h"
 
 // Forward declarations
 struct GLFWwindow;
@@ -43,8 +51,8 @@ public:
               const std::string& title = "ObjectRecognition — Controls");
 
     /**
-     * @brief Render one frame of ImGui panels.
-     *        Call once per main loop iteration after the pipeline runs.
+     * @brief Build one frame of ImGui panels (widgets act immediately).
+     *        Call once per main loop iteration, then present() to draw it.
      *
      * @param params      Pipeline parameters — sliders write here directly.
      * @param state       App state — training status and regions are read here.
@@ -52,6 +60,7 @@ public:
      * @param classifier  K-NN classifier — refitted when the DB changes.
      * @param evaluator   Evaluator — confusion matrix data read for display.
      * @param embDB       CNN embedding DB — sample counts shown in DB panel.
+     * @param models      Embedding model loader — driven by the Models panel.
      * @param showThresh  Toggle for the Threshold debug window.
      * @param showCleaned Toggle for the post-morphology Cleaned debug window.
      * @param showRegions Toggle for the color-coded Regions debug window.
@@ -61,13 +70,43 @@ public:
     void render(PipelineParams& params, AppState& state,
                 ObjectDB& db, Classifier& classifier,
                 Evaluator& evaluator, EmbeddingDB& embDB,
+                ModelManager& models,
                 bool& showThresh, bool& showCleaned,
                 bool& showRegions, bool& showMatrix,
                 bool& showCrop);
 
+    /**
+     * @brief Draw the frame built by render() and swap buffers.
+     *        Kept separate so the vsync wait runs outside any lock the
+     *        panels needed while editing the databases.
+     */
+    void present();
+
+    /**
+     * @brief Whether render() has to build a new frame this iteration.
+     *        True when changed is set, for a few frames after input or a
+     *        resize (so hover and popup state settle), while a text field
+     *        has focus (caret blink), and every kMaxIdleSec regardless.
+     *
+     * @param changed  New pipeline results or settings changed elsewhere.
+     */
+    bool needsFrame(bool changed);
+
+    /** Redraw the last frame's draw lists if the window was exposed. */
+    void repaint();
+
     /** Poll GLFW events. Call every frame. */
     void pollEvents();
 
+    /**
+     * @brief Sleep until a GLFW event, wake() or the timeout.
+     * @param timeoutSec  Longest wait in seconds.
+     */
+    void waitEvents(double timeoutSec);
+
+    /** End a waitEvents() early.  Callable from any thread while open. */
+    static void wake();
+
     /** Return true while GLFW window is open. */
     bool isOpen() const;
 
@@ -75,10 +114,22 @@ public:
     void shutdown();
 
 private:
+    static constexpr int    kSettleFrames = 3;    ///< Frames built after each input
+    static constexpr double kMaxIdleSec   = 0.5;  ///< Longest gap between built frames
+
     GLFWwindow* window_    = nullptr;
     bool        initDone_  = false;
+    bool        inputSeen_     = false;  ///< Input or resize since the last check
+    bool        exposed_       = false;  ///< Window contents need repainting
+    int         settleFrames_  = 0;      ///< Frames still to build after input
+    double      lastFrameTime_ = -1e9;   ///< glfwGetTime() of the last built frame
     char        labelBuf_[128]     = {};
     char        autoLearnBuf_[128] = {};
+    int         modelIdx_          = 0;
+
+    /** GLFW callback targets, chained in front of ImGui's own. */
+    static void markInput(GLFWwindow* window);
+    static void markExposed(GLFWwindow* window);
 
     /** Render threshold, morphology, region, and classifier controls. */
     void renderPipelinePanel(PipelineParams& params,
@@ -97,4 +148,11 @@ private:
 
     /** Render the collapsible inline confusion matrix table. */
     void renderConfusionMatrix(Evaluator& evaluator);
+
+    /** Render the collapsible stage profiler (stacked bar, history, p95). */
+    void renderProfilerPanel();
+
+    /** Render the collapsible embedding model selector and benchmark table. */
+    void renderModelPanel(ModelManager& models, const PipelineParams& params,
+                          const EmbeddingDB& embDB);
 };
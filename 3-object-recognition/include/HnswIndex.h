@@ -0,0 +1,117 @@
+/**
+ * @file    HnswIndex.h
+ * @brief   Incremental HNSW graph for approximate nearest-neighbour search
+ *          over the embedding database.
+ *
+ *          Hierarchical Navigable Small World graph (Malkov & Yashunin):
+ *          every row is a node on layer 0 with up to 2M neighbours, and an
+ *          exponentially shrinking subset of nodes also lives on upper layers
+ *          with up to M neighbours.  A search descends greedily from the top
+ *          layer and runs a best-first beam search on layer 0; neighbour
+ *          lists are chosen with the paper's diversity heuristic.
+ *
+ *          The graph holds no vectors.  It indexes the L2-normalised rows of
+ *          EmbeddingDB (cosine distance 1 - u . v) and reads them from the
+ *          caller's matrix, which may reallocate as rows are appended.
+ *          Nodes are added one at a time, in row order, so the index grows
+ *          with every EmbeddingDB::append() instead of being rebuilt.
+ *
+ *          search() is const and keeps its visited marks per thread, so
+ *          several threads may search concurrently; add() must not run
+ *          alongside them.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Dot product of two float vectors (SIMD; shared with EmbeddingDB). */
+float dotProduct(const float* a, const float* b, int n);
+
+class HnswIndex {
+public:
+    /** (cosine distance, row) */
+    using Neighbour = std::pair<float, uint32_t>;
+
+    /**
+     * @param m               Neighbours per node on upper layers (2m on layer 0).
+     * @param efConstruction  Beam width used while inserting.
+     */
+    explicit HnswIndex(int m = 16, int efConstruction = 100);
+
+    /** Drop every node. */
+    void clear();
+
+    /**
+     * @brief Insert the next row (row size()) of a matrix of unit rows.
+     * @param unit  N x dim CV_32F, N > size().
+     */
+    void add(const cv::Mat& unit);
+
+    /**
+     * @brief Approximate nearest rows to a query.
+     *
+     * @param unit   Matrix the nodes were added from (at least size() rows).
+     * @param query  dim floats, L2-normalised.
+     * @param ef     Beam width; also the number of neighbours returned.
+     * @param out    Output: up to ef neighbours by ascending distance.
+     */
+    void search(const cv::Mat& unit, const float* query, int ef,
+                std::vector<Neighbour>& out) const;
+
+    /** Write the graph (not the vectors) to a file. */
+    bool save(const std::string& path, int dim) const;
+
+    /**
+     * @brief Read a graph written by save().
+     * @param maxRows  Rows available; a graph with more nodes (or another
+     *                 dimension) belongs to another database and is rejected.
+     */
+    bool load(const std::string& path, int dim, int maxRows);
+
+    int  size()  const { return static_cast<int>(levels_.size()); }
+    bool empty() const { return levels_.empty(); }
+
+private:
+    int      m_;
+    int      maxM0_;
+    int      efConstruction_;
+    double   levelMult_;                  ///< 1 / ln(m)
+    int      maxLevel_   = -1;            ///< Top layer (-1 while empty)
+    uint32_t entryPoint_ = 0;             ///< Node on the top layer
+    std::mt19937 rng_{0x4E5Cu};
+
+    std::vector<uint8_t>               levels_;  ///< Top layer of each node
+    std::vector<uint32_t>              level0_;  ///< size() x (maxM0_ + 1): [n, ids...]
+    std::vector<std::vector<uint32_t>> upper_;   ///< Per node, levels x (m_ + 1)
+
+    /** Neighbour list of a node on a layer: [count, id0, id1, ...] */
+    uint32_t*       links(uint32_t node, int level);
+    const uint32_t* links(uint32_t node, int level) const;
+
+    /** Greedy walk on one layer towards the query. */
+    void greedyStep(const cv::Mat& unit, const float* query, int level,
+                    uint32_t& node, float& dist) const;
+
+    /** Best-first beam search on one layer; result ascending by distance. */
+    std::vector<Neighbour> searchLayer(const cv::Mat& unit, const float* query,
+                                       uint32_t entry, float entryDist,
+                                       int ef, int level) const;
+
+    /** Diversity heuristic: keep candidates closer to the base than to any kept one. */
+    std::vector<Neighbour> selectNeighbours(const cv::Mat& unit,
+                                            const std::vector<Neighbour>& ascending,
+                                            int maxCount) const;
+
+    /** Add a back-link, pruning the neighbour's list if it is full. */
+    void connect(const cv::Mat& unit, uint32_t node, uint32_t neighbour,
+                 float dist, int level);
+};
@@ -0,0 +1,88 @@
+/**
+ * @file    InferenceBatcher.h
+ * @brief   One ResNet18 shared by several stream workers, batched across them.
+ *
+ *          Each stream worker calls embed() with the regions of its frame
+ *          and blocks.  A single inference thread collects the requests
+ *          that arrive within a short window (or until the batch is full),
+ *          runs them as one forward pass through the shared
+ *          EmbeddingClassifier and wakes every caller with its embeddings.
+ *          With N streams in flight the network sees batches of up to N
+ *          frames' regions instead of N single-frame passes, and the model
+ *          is loaded once.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AppState.h"
+#include "Embedding.h"
+
+class InferenceBatcher {
+public:
+    /** Throughput counters. */
+    struct Stats {
+        long long batches   = 0;
+        long long regions   = 0;      ///< Regions embedded so far
+        float     meanBatch = 0.f;    ///< Regions per forward pass
+        float     latencyMs = 0.f;    ///< Forward-pass latency (moving average)
+    };
+
+    /**
+     * @brief Start the inference thread.
+     * @param classifier  Loaded classifier whose network is shared.
+     * @param maxBatch    Regions per forward pass before it runs at once.
+     * @param maxWaitMs   How long the first request waits for others.
+     */
+    InferenceBatcher(EmbeddingClassifier& classifier, int maxBatch = 32, int maxWaitMs = 4);
+
+    /** Stop the inference thread; waiting callers get empty embeddings. */
+    ~InferenceBatcher();
+
+    InferenceBatcher(const InferenceBatcher&) = delete;
+    InferenceBatcher& operator=(const InferenceBatcher&) = delete;
+
+    /**
+     * @brief Embed regions of one frame in the next shared batch (blocks).
+     *
+     * @param frame    Original BGR frame (not copied — caller waits).
+     * @param regions  Regions to embed.
+     * @param embs     Output: one vector per region (empty if its crop failed).
+     */
+    void embed(const cv::Mat& frame, const std::vector<RegionInfo>& regions,
+               std::vector<std::vector<float>>& embs);
+
+    Stats stats() const;
+
+private:
+    /** One embed() call waiting for its batch. */
+    struct Request {
+        const cv::Mat*                   frame;
+        const std::vector<RegionInfo>*   regions;
+        std::vector<std::vector<float>>* embs;
+        bool                             done = false;
+    };
+
+    EmbeddingClassifier&    classifier_;
+    const int               maxBatch_;
+    const int               maxWaitMs_;
+
+    mutable std::mutex      mutex_;       ///< Guards everything below
+    std::condition_variable wake_;        ///< New request or stop
+    std::condition_variable done_;        ///< A batch finished
+    std::deque<Request*>    pending_;
+    bool                    stop_ = false;
+    Stats                   stats_;
+
+    std::thread             worker_;
+
+    void run();
+};
@@ -0,0 +1,69 @@
+/**
+ * @file    KdTree.h
+ * @brief   Static KD-tree for exact k-nearest-neighbour search.
+ *
+ *          Built once over a flat row-major point array (N x dim) and
+ *          queried with a bounded max-heap of the k best squared Euclidean
+ *          distances.  Nodes split at the median of their widest dimension;
+ *          leaves hold up to kLeafSize points and are scanned linearly.
+ *          A subtree is skipped when the query's distance to its splitting
+ *          plane already exceeds the current k-th best.
+ *
+ *          Intended for the low-dimensional shape feature vectors (9-d),
+ *          where pruning removes most of the database from each query.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+class KdTree {
+public:
+    /** (squared distance, point index) */
+    using Neighbour = std::pair<double, int>;
+
+    /**
+     * @brief Build the tree.
+     *
+     * @param points  Row-major N x dim coordinates (copied).
+     * @param dim     Dimensions per point.
+     */
+    void build(const std::vector<double>& points, int dim);
+
+    /**
+     * @brief Find the k nearest points to a query.
+     *
+     * @param query  dim coordinates.
+     * @param k      Neighbours wanted (fewer if the tree is smaller).
+     * @param out    Output: neighbours sorted by ascending squared distance.
+     */
+    void knn(const double* query, int k, std::vector<Neighbour>& out) const;
+
+    int  size()  const { return static_cast<int>(index_.size()); }
+    bool empty() const { return index_.empty(); }
+
+private:
+    struct Node {
+        int    begin = 0;       ///< Range into index_
+        int    end   = 0;
+        int    dim   = -1;      ///< Split dimension (-1 = leaf)
+        double split = 0.0;     ///< Split value (left <= split <= right)
+        int    left  = -1;
+        int    right = -1;
+    };
+
+    static constexpr int kLeafSize = 8;
+
+    int                 dim_ = 0;
+    std::vector<double> points_;
+    std::vector<int>    index_;  ///< Point order after partitioning
+    std::vector<Node>   nodes_;
+
+    int  buildNode(int begin, int end);
+    void search(int node, const double* query, int k,
+                std::vector<Neighbour>& heap) const;
+};
@@ -0,0 +1,46 @@
+/**
+ * @file    MappedFile.h
+ * @brief   Read-only memory mapping of a whole file (POSIX mmap / Win32).
+ *
+ *          Pages are faulted in on first touch, so opening a large file
+ *          costs one system call regardless of its size.  The file must not
+ *          be written while it is mapped — close() first, write, reopen.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, replacing any current mapping.
+     * @return True on success (an empty file maps with size() == 0).
+     */
+    bool open(const std::string& path);
+
+    /** Unmap (safe when nothing is mapped). */
+    void close();
+
+    bool        isOpen() const { return open_; }
+    const char* data()   const { return data_; }
+    size_t      size()   const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+    bool        open_ = false;
+#ifdef _WIN32
+    void*       mapping_ = nullptr;   ///< HANDLE of the file mapping object
+#endif
+};
@@ -0,0 +1,110 @@
+/**
+ * @file    ModelManager.h
+ * @brief   Background loading, hot-swap and benchmarking of embedding models.
+ *
+ *          Lists the ONNX models in data/models.  swapTo() reads and probes
+ *          the chosen model on a worker thread while the current one keeps
+ *          serving, then swaps it into the EmbeddingClassifier between two
+ *          forward passes.
+ *
+ *          Stored embeddings only match the network that produced them.
+ *          The database keeps its vectors, not the crops, so it cannot be
+ *          re-embedded.  When the new model's dimension differs from that of
+ *          a non-empty database, the manager switches to that model's own
+ *          file instead (data/db/embeddings_<model>.bin; the default
+ *          ResNet18 keeps embeddings.bin).  A model with the same dimension,
+ *          such as an INT8 ResNet18, keeps the current database.
+ *
+ *          benchmark() loads every listed model in turn and reports its
+ *          load time and forward-pass latency per crop.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Embedding.h"
+
+class ModelManager {
+public:
+    /** Benchmark result of one model. */
+    struct BenchResult {
+        std::string name;
+        int         dim       = 0;
+        float       loadMs    = 0.f;
+        float       msPerCrop = -1.f;
+        bool        ok        = false;
+    };
+
+    /**
+     * @param classifier  Classifier whose model is swapped.
+     * @param db          Embedding database matched to the model.
+     * @param modelMutex  Guards db against the processing thread.
+     */
+    ModelManager(EmbeddingClassifier& classifier, EmbeddingDB& db,
+                 std::mutex& modelMutex);
+
+    /** Waits for a running load or benchmark. */
+    ~ModelManager();
+
+    ModelManager(const ModelManager&) = delete;
+    ModelManager& operator=(const ModelManager&) = delete;
+
+    /** List the .onnx files in dir (sorted). */
+    void scan(const std::string& dir = "data/models");
+
+    /** Model paths found by scan(). */
+    const std::vector<std::string>& models() const { return models_; }
+
+    /** Classifier whose model is managed. */
+    const EmbeddingClassifier& classifier() const { return classifier_; }
+
+    /** A load or benchmark is running. */
+    bool busy() const { return busy_; }
+
+    /**
+     * @brief Load a model in the background and swap it in.
+     * @return False if another load or benchmark is still running.
+     */
+    bool swapTo(const std::string& path, int dnnBackend);
+
+    /**
+     * @brief Benchmark every listed model in the background.
+     * @return False if another load or benchmark is still running.
+     */
+    bool benchmark(int dnnBackend);
+
+    /** Last status message. */
+    std::string status() const;
+
+    /** Results of the last benchmark. */
+    std::vector<BenchResult> results() const;
+
+    /** Database file used with a model (see the file comment). */
+    static std::string dbPathFor(const std::string& modelPath);
+
+private:
+    EmbeddingClassifier&     classifier_;
+    EmbeddingDB&             db_;
+    std::mutex&              modelMutex_;
+
+    std::vector<std::string> models_;
+    std::atomic<bool>        busy_{false};
+    std::thread              worker_;
+
+    mutable std::mutex       mutex_;      ///< Guards status_ and results_
+    std::string              status_;
+    std::vector<BenchResult> results_;
+
+    bool launch(std::function<void()> job);
+    void runSwap(const std::string& path, int dnnBackend);
+    void runBenchmark(const std::vector<std::string>& paths, int dnnBackend);
+    void setStatus(const std::string& msg);
+};
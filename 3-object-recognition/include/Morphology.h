@@ -16,7 +16,20 @@
  *            Open   — erode then dilate; removes noise, preserves shape
  *            Close  — dilate then erode; fills holes, preserves shape
  *
- *          Input/output: CV_8UC1 binary images (0 = background, 255 = object).
+ *          Input/output: CV_8UC1 binary images (0 = background, 255 = object;
+ *          any nonzero input pixel counts as object).
+ *
+ *          The rectangular element is separable and iterations compose into
+ *          one larger square, so cost barely grows with kSize or iters.
+ *
+ *          cv::UMat overloads run the same separable passes as OpenCL
+ *          kernels (one work-item per pixel), so a mask thresholded on the
+ *          device is cleaned there too.  Without an OpenCL device they fall
+ *          back to the host implementation.
+ *
+ *          Overloads taking a cvcore::TileOccupancy (one bit per 32x32
+ *          tile, set by applyThreshold) only process occupied tiles and
+ *          the tiles the element reaches from them; the output is the same.
  *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
@@ -25,6 +38,7 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <cvcore/tileOccupancy.hpp>
 #include "AppState.h"
 
 /**
@@ -55,6 +69,27 @@ void erodeCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters = 1);
  */
 void dilateCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters = 1);
 
+/**
+ * @brief erodeCustom over the occupied tiles of src only.
+ *
+ * @param tiles    Occupancy of src.
+ * @param dstTiles Optional output occupancy of dst.
+ */
+void erodeCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters,
+                 const cvcore::TileOccupancy& tiles,
+                 cvcore::TileOccupancy* dstTiles = nullptr);
+
+/** dilateCustom over the occupied tiles of src and their neighbours only. */
+void dilateCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters,
+                  const cvcore::TileOccupancy& tiles,
+                  cvcore::TileOccupancy* dstTiles = nullptr);
+
+/** erodeCustom on device memory (OpenCL kernels). */
+void erodeCustom(const cv::UMat& src, cv::UMat& dst, int kSize, int iters = 1);
+
+/** dilateCustom on device memory (OpenCL kernels). */
+void dilateCustom(const cv::UMat& src, cv::UMat& dst, int kSize, int iters = 1);
+
 /**
  * @brief Apply morphological filtering to a binary image.
  *
@@ -69,3 +104,32 @@ void dilateCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters = 1);
  * @param params   Pipeline parameters (morphMode, morphKernelSize, morphIterations).
  */
 void applyMorphology(const cv::Mat& src, cv::Mat& dst, const PipelineParams& params);
+
+/**
+ * @brief applyMorphology that skips empty 32x32 tiles.
+ *
+ *        Same output as the dense version; falls back to it when most
+ *        tiles are occupied.
+ *
+ * @param src      Input binary image  (CV_8UC1).
+ * @param dst      Output binary image (CV_8UC1).
+ * @param params   Pipeline parameters (morphMode, morphKernelSize, morphIterations).
+ * @param tiles    Occupancy of src (from applyThreshold).
+ * @param dstTiles Output occupancy of dst (for findRegions).
+ */
+void applyMorphology(const cv::Mat& src, cv::Mat& dst, const PipelineParams& params,
+                     const cvcore::TileOccupancy& tiles, cvcore::TileOccupancy& dstTiles);
+
+/** applyMorphology on device memory (OpenCL kernels). */
+void applyMorphology(const cv::UMat& src, cv::UMat& dst, const PipelineParams& params);
+
+/**
+ * @brief Rows of context applyMorphology needs above and below a row.
+ *
+ *        Running applyMorphology on a band extended by this many rows (or
+ *        up to the image edge) gives exact results for the band's rows.
+ *
+ * @param params   Pipeline parameters (morphMode, morphKernelSize, morphIterations).
+ * @return         Vertical reach in rows.
+ */
+int morphologyReach(const PipelineParams& params);
@@ -0,0 +1,69 @@
+/**
+ * @file    MotionGate.h
+ * @brief   Cheap frame-change detector that lets a static scene skip
+ *          segmentation.
+ *
+ *          Each frame is reduced to a kGridW x kGridH grid of 2x2 pixel
+ *          luminance samples (a few thousand reads, no resize, no
+ *          allocation) and compared with the samples of the last frame the
+ *          pipeline processed.  The fraction of samples that moved by more
+ *          than kPixelDelta grey levels decides whether the frame changed,
+ *          with hysteresis: a still scene must exceed motionThreshold to
+ *          count as moving, a moving one must fall below half of it to
+ *          settle.  Counting changed samples (rather than averaging the
+ *          difference) keeps sensor noise out and still notices a small
+ *          object placed on the table.
+ *
+ *          While moving every frame is processed; once settled, frames are
+ *          skipped until something changes or motionRefresh frames have
+ *          passed since the last full run.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+#include "AppState.h"
+
+class MotionGate {
+public:
+    /**
+     * @brief Decide whether this frame needs the full pipeline.
+     *
+     * @param frame   Frame (BGR or grey) — only the area given by roi is sampled.
+     * @param roi     Processing area (empty = whole frame).
+     * @param params  motionGate, motionThreshold and motionRefresh.
+     * @param force   Process regardless (settings changed, results pending).
+     * @return        True to process the frame, false to carry the previous
+     *                results forward.
+     */
+    bool update(const cv::Mat& frame, const cv::Rect& roi,
+                const PipelineParams& params, bool force);
+
+    /** Recent fraction of frames skipped (exponential average, 0..1). */
+    float skipRatio() const { return skipRatio_; }
+
+    /** Fraction of samples that changed in the last update (0..1). */
+    float changedFraction() const { return changed_; }
+
+    /** Forget the reference frame; the next update processes. */
+    void reset() { reference_.clear(); moving_ = true; }
+
+private:
+    static constexpr int   kGridW      = 80;    ///< Sample columns
+    static constexpr int   kGridH      = 60;    ///< Sample rows
+    static constexpr int   kPixelDelta = 24;    ///< Grey-level change that marks a sample changed
+    static constexpr float kAverage    = 0.05f; ///< Weight of a frame in skipRatio_
+
+    std::vector<uint16_t> samples_;     ///< This frame's grid (4 x mean grey per block)
+    std::vector<uint16_t> reference_;   ///< Grid of the last processed frame
+    cv::Size              size_;        ///< Sampled area the reference was taken from
+    bool                  moving_       = true;
+    int                   sinceRefresh_ = 0;
+    float                 changed_      = 0.f;
+    float                 skipRatio_    = 0.f;
+};
@@ -2,17 +2,23 @@
  * @file    ObjectDB.h
  * @brief   Object database for storing and querying feature vectors.
  *
- *          Manages a CSV-based database of labeled feature vectors collected
+ *          Manages a binary database of labeled feature vectors collected
  *          during training mode. Each entry stores:
  *            label, fillRatio, bboxRatio, hu[0..6]  (9 values total)
  *
- *          CSV format (data/db/objects.csv):
- *            label,fillRatio,bboxRatio,hu0,hu1,hu2,hu3,hu4,hu5,hu6
- *            scissors,0.823,3.241,-1.452,-4.123,-6.234,-7.891,...
+ *          File format (data/db/objects.bin, little-endian):
+ *            "OBJ1", uint32 label slots, uint32 label count, uint32 0,
+ *            label slots x 32 bytes (NUL-padded names, at most 31 bytes),
+ *            then fixed 80-byte DBRecords to the end of the file.
+ *
+ *          The file is memory-mapped and the records are used in place, so
+ *          loading costs the same for ten entries or a million.  append()
+ *          writes one record (plus one label slot for a new label); only
+ *          running out of label slots or deleting a label rewrites the file.
+ *          A legacy objects.csv next to the .bin is imported on first run.
  *
  *          Supports:
- *            - Load from / save to CSV file
- *            - Append single entry
+ *            - Load / save / append
  *            - Query all entries for a given label
  *            - List all unique labels and sample counts
  *            - Delete all entries for a label
@@ -23,10 +29,15 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
 #include "AppState.h"
+#include "MappedFile.h"
+
+/// fillRatio, bboxRatio, hu0..hu6
+constexpr int kShapeFeatureDim = 9;
 
 // =============================================================================
 // DBEntry — one labeled feature vector
@@ -41,6 +52,16 @@ struct DBEntry {
     std::vector<double> toFeatureVector() const;
 };
 
+// =============================================================================
+// DBRecord — one entry as stored on disk and used in place from the mapping
+// =============================================================================
+struct DBRecord {
+    int32_t label;                       ///< Index into ObjectDB::labelNames()
+    int32_t reserved;                    ///< Zero; keeps features 8-byte aligned
+    double  features[kShapeFeatureDim];  ///< fillRatio, bboxRatio, hu0..hu6
+};
+static_assert(sizeof(DBRecord) == 80, "DBRecord is a fixed 80-byte file record");
+
 // =============================================================================
 // ObjectDB
 // =============================================================================
@@ -48,26 +69,31 @@ class ObjectDB {
 public:
     /**
      * @brief Construct and optionally load existing DB from file.
-     * @param filepath  Path to CSV file (created on first save if missing).
+     * @param filepath  Path to the binary file (created on first append if
+     *                  missing).  A .csv path selects the .bin beside it and
+     *                  imports the CSV if that does not exist yet.
      */
-    explicit ObjectDB(const std::string& filepath = "data/db/objects.csv");
+    explicit ObjectDB(const std::string& filepath = "data/db/objects.bin");
+
+    ObjectDB(const ObjectDB&) = delete;
+    ObjectDB& operator=(const ObjectDB&) = delete;
 
     // --- Persistence ---------------------------------------------------------
 
-    /** Load all entries from CSV. Returns true on success. */
+    /** Map the file (or import the legacy CSV). Returns true on success. */
     bool load();
 
-    /** Save all entries to CSV. Returns true on success. */
-    bool save() const;
+    /**
+     * @brief Rewrite the file from the current entries and map it again.
+     * @return False if the file could not be written (entries stay in memory).
+     */
+    bool save();
 
-    /** Append a single entry to CSV without rewriting the whole file. */
+    /** Append a single entry to the file without rewriting it. */
     bool append(const DBEntry& entry);
 
     // --- Data management -----------------------------------------------------
 
-    /** Add entry to in-memory DB (does not save to disk). */
-    void addEntry(const DBEntry& entry);
-
     /** Build a DBEntry from a RegionInfo and a label string. */
     static DBEntry entryFromRegion(const RegionInfo& reg,
                                    const std::string& label);
@@ -80,8 +106,17 @@ public:
 
     // --- Queries -------------------------------------------------------------
 
-    /** Return all entries. */
-    const std::vector<DBEntry>& entries() const { return entries_; }
+    /** All records, size() of them, packed (usually straight from the mapping). */
+    const DBRecord* records() const { return records_; }
+
+    /** Label dictionary; DBRecord::label indexes it. */
+    const std::vector<std::string>& labelNames() const { return labels_; }
+
+    /** Label of entry i. */
+    const std::string& label(int i) const { return labels_[records_[i].label]; }
+
+    /** Entry i as a DBEntry. */
+    DBEntry entry(int i) const;
 
     /** Return entries for a specific label. */
     std::vector<DBEntry> entriesForLabel(const std::string& label) const;
@@ -93,18 +128,27 @@ public:
     std::vector<std::string> labels() const;
 
     /** Return true if DB has at least one entry. */
-    bool empty() const { return entries_.empty(); }
+    bool empty() const { return count_ == 0; }
 
     /** Return total number of entries. */
-    int size() const { return static_cast<int>(entries_.size()); }
+    int size() const { return count_; }
 
     /** Return file path. */
     const std::string& filepath() const { return filepath_; }
 
 private:
-    std::string         filepath_;
-    std::vector<DBEntry> entries_;
-
-    static constexpr const char* kHeader =
-        "label,fillRatio,bboxRatio,hu0,hu1,hu2,hu3,hu4,hu5,hu6";
+    std::string              filepath_;
+    MappedFile               map_;
+    std::vector<DBRecord>    owned_;         ///< Records while not file-backed
+    const DBRecord*          records_ = nullptr;  ///< map_ or owned_
+    int                      count_   = 0;
+    std::vector<std::string> labels_;
+    int                      labelSlots_ = 0;    ///< Label capacity of the file
+
+    bool mapFile();
+    bool writeFile() const;
+    bool loadCsv(const std::string& path);
+    void detach();
+    int  internLabel(const std::string& label);
+    void pushOwned(const DBRecord& rec);
 };
@@ -0,0 +1,155 @@
+/**
+ * @file    Profiler.h
+ * @brief   Per-stage pipeline timings with rolling history and trace export.
+ *
+ *          A ProfileScope placed at the top of a stage function records its
+ *          wall time when it leaves scope.  Each stage keeps the last
+ *          kHistory durations in a fixed-size ring (for the GUI's plots and
+ *          p95), and every call is also appended to a fixed-size event ring
+ *          that exportChromeTrace() writes as Chrome trace JSON
+ *          (chrome://tracing or ui.perfetto.dev), one row per thread.
+ *
+ *          Stages run on the processing, embedding and GUI threads, so
+ *          record() takes a short lock — a handful of calls per frame.
+ *          Every call also feeds the objrec_stage_seconds histogram of the
+ *          cvcore metrics registry (lock-free, exported on request), and a
+ *          ProfileScope attributes the heap and cv::Mat allocations of its
+ *          thread to the stage's cvcore::AllocStage (CVCORE_ALLOC_TRACKING).
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <cvcore/allocTracking.hpp>
+#include <cvcore/metrics.hpp>
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// ProfileStage — instrumented pipeline stages
+// =============================================================================
+enum class ProfileStage {
+    Threshold,     ///< applyThreshold
+    Morphology,    ///< applyMorphology
+    Labeling,      ///< twoPassLabel
+    Streamed,      ///< runStreamedPipeline (threshold + morph + label in bands)
+    Features,      ///< computeAllFeatures
+    Classify,      ///< classifyAll (includes inference in synchronous CNN mode)
+    Embedding,     ///< ResNet18 crop + forward pass
+    GuiRender,     ///< ImGui build + draw
+    Count
+};
+
+// =============================================================================
+// Profiler — process-wide stage timing store
+// =============================================================================
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Durations kept per stage for plots and percentiles
+    static constexpr int kHistory     = 240;
+    /// Calls kept for trace export
+    static constexpr int kTraceEvents = 16384;
+
+    /** Timing summary of one stage over its history. */
+    struct StageStats {
+        float meanMs = 0.f;
+        float p95Ms  = 0.f;
+        float lastMs = 0.f;
+        int   count  = 0;                     ///< Samples in the history
+        std::array<float, kHistory> history{}; ///< Oldest first, count valid
+    };
+
+    /** Every call of one stage since the last clear(). */
+    struct StageTotals {
+        long long calls   = 0;
+        double    totalMs = 0.0;
+        float     maxMs   = 0.f;
+    };
+
+    /** The process-wide profiler. */
+    static Profiler& instance();
+
+    /** Display name of a stage. */
+    static const char* stageName(ProfileStage stage);
+
+    /** Record one call of a stage (thread-safe). */
+    void record(ProfileStage stage, Clock::time_point begin, Clock::time_point end);
+
+    /** Summary of a stage's recent calls (thread-safe copy). */
+    StageStats stats(ProfileStage stage) const;
+
+    /** Totals of a stage over the whole run (e.g. a replayed session). */
+    StageTotals totals(ProfileStage stage) const;
+
+    /** Allocation totals of a stage (counts stay 0 without CVCORE_ALLOC_TRACKING). */
+    cvcore::AllocStage& allocStage(ProfileStage stage) const
+    {
+        return *allocStages_[static_cast<size_t>(stage)];
+    }
+
+    /** Forget all history and trace events. */
+    void clear();
+
+    /**
+     * @brief Write the event ring as Chrome trace JSON.
+     * @param filepath  Output path (parent folders are created).
+     * @return          Number of events written, -1 if the file failed.
+     */
+    int exportChromeTrace(const std::string& filepath) const;
+
+private:
+    struct Ring {
+        std::array<float, kHistory> ms{};
+        int head  = 0;   ///< Next write position
+        int count = 0;
+    };
+
+    struct TraceEvent {
+        ProfileStage stage;
+        int          tid;
+        long long    beginUs;   ///< Since epoch_
+        long long    durUs;
+    };
+
+    Profiler();
+
+    mutable std::mutex                  mutex_;
+    Clock::time_point                   epoch_;
+    std::array<Ring, static_cast<size_t>(ProfileStage::Count)> rings_;
+    std::array<StageTotals, static_cast<size_t>(ProfileStage::Count)> totals_;
+    std::vector<TraceEvent>             events_;       ///< kTraceEvents ring
+    size_t                              eventHead_ = 0;
+    size_t                              eventCount_ = 0;
+    std::map<std::thread::id, int>      threadIds_;    ///< Small ids for the trace
+    std::array<cvcore::Histogram*, static_cast<size_t>(ProfileStage::Count)> metrics_;
+    std::array<cvcore::AllocStage*, static_cast<size_t>(ProfileStage::Count)> allocStages_;
+};
+
+// =============================================================================
+// ProfileScope — records the enclosing scope as one call of a stage
+// =============================================================================
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage)
+        : stage_(stage), allocs_(Profiler::instance().allocStage(stage)),
+          begin_(Profiler::Clock::now()) {}
+    ~ProfileScope() { Profiler::instance().record(stage_, begin_, Profiler::Clock::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileStage                stage_;
+    cvcore::AllocStageScope     allocs_;
+    Profiler::Clock::time_point begin_;
+};
@@ -0,0 +1,99 @@
+/**
+ * @file    PrototypeCondenser.h
+ * @brief   Background condensation of the embedding DB into per-label
+ *          prototypes for live classification.
+ *
+ *          Auto-learn and Embed mode only ever append samples, so a
+ *          nearest-neighbour scan over the raw EmbeddingDB grows without
+ *          bound.  The condenser keeps a second, in-memory EmbeddingDB with
+ *          at most prototypesPerLabel vectors per label: the k-means
+ *          centres (k-means++ seeding) of that label's samples, or the
+ *          samples themselves while a label has no more than the budget.
+ *
+ *          update() snapshots the samples of labels whose count changed and
+ *          clusters them on a worker thread; labels with an unchanged count
+ *          reuse their previous prototypes (rows are only ever appended
+ *          while EmbeddingDB::generation() holds).  Until the first result
+ *          is ready, live() returns the full database.  The file on disk
+ *          keeps every sample, so a new budget simply re-condenses it.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Embedding.h"
+
+class PrototypeCondenser {
+public:
+    PrototypeCondenser() = default;
+
+    /** Waits for a running condensation. */
+    ~PrototypeCondenser();
+
+    PrototypeCondenser(const PrototypeCondenser&) = delete;
+    PrototypeCondenser& operator=(const PrototypeCondenser&) = delete;
+
+    /**
+     * @brief Start a condensation if the database or budget changed since
+     *        the last one and none is running.  Call with the database
+     *        locked; the samples are copied before returning.
+     *
+     * @param db        Full embedding database.
+     * @param perLabel  Prototypes kept per label (0 = off, drops the set).
+     */
+    void update(const EmbeddingDB& db, int perLabel);
+
+    /**
+     * @brief Database to classify against: the prototypes once they match
+     *        db's labels, the full database otherwise.
+     */
+    const EmbeddingDB& live(const EmbeddingDB& db);
+
+    /** Incremented whenever a new prototype set is adopted. */
+    int  version() const { return version_; }
+
+    /** A condensation is running. */
+    bool busy() const { return busy_; }
+
+    /** Prototypes in the set in use (0 while none). */
+    int  size() const { return size_; }
+
+private:
+    /** Samples of one label and the prototypes computed from them. */
+    struct LabelSet {
+        int     samples = 0;      ///< Sample count the prototypes were built from
+        cv::Mat prototypes;       ///< k x dim CV_32F (unnormalised)
+    };
+    using LabelMap = std::map<std::string, LabelSet>;
+
+    std::thread                  worker_;
+    std::atomic<bool>            busy_{false};
+    std::mutex                   mutex_;            ///< Guards ready_ and readyGeneration_
+    std::shared_ptr<EmbeddingDB> ready_;            ///< Finished by the worker, not yet adopted
+    int                          readyGeneration_ = -1;
+    std::shared_ptr<EmbeddingDB> current_;          ///< Set returned by live()
+    int                          currentGeneration_ = -1; ///< EmbeddingDB::generation() of current_
+    LabelMap                     labels_;           ///< Per-label prototypes of the last run
+    int                          generation_ = -1;  ///< Database generation last condensed
+    int                          samples_    = -1;  ///< Database size last condensed
+    int                          dim_        = 0;   ///< Database dimension last condensed
+    int                          budget_     = 0;   ///< prototypesPerLabel last condensed
+    std::atomic<int>             version_{0};
+    std::atomic<int>             size_{0};
+
+    /** Worker: re-condense the changed labels and publish a new set. */
+    void run(std::map<std::string, cv::Mat> changed,
+             std::map<std::string, int> counts, int perLabel, bool reset,
+             int generation);
+
+    /** k-means centres of samples (k rows), or the samples if k >= rows. */
+    static cv::Mat condense(const cv::Mat& samples, int k);
+};
@@ -16,7 +16,11 @@
  *            - Oriented bounding box (rotates with object)
  *            - Feature values as text overlay
  *
- *          Uses cv::moments() for raw moment calculation.
+ *          Raw moments are accumulated from the labeller's runs (one pass
+ *          for all regions, O(runs) rather than O(pixels)) and turned into
+ *          cv::Moments.  Alternatively (momentMode = 1) they are integrated
+ *          over each region's traced contour with Green's theorem, and the
+ *          oriented box is the contour's minimum-area rectangle.
  *          Hu moments are computed via cv::HuMoments().
  *          Axis angle and oriented bbox derived from central moments mu20, mu02, mu11.
  *
@@ -29,27 +33,59 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include "AppState.h"
+#include "ConnectedComponents.h"
 
 /**
  * @brief Compute features for a single region.
  *
- *        Extracts a binary mask for the given region from the label map,
- *        computes cv::moments on the mask, derives axis angle, oriented
- *        bounding box, fill ratio, bbox ratio, and Hu moments.
- *        Results are written directly into the RegionInfo struct.
+ *        Accumulates the moments of the region's runs (or its contour),
+ *        derives axis angle, oriented bounding box, fill ratio, bbox ratio,
+ *        and Hu moments.  Results are written directly into the RegionInfo
+ *        struct.
  *
- * @param labelMap   Label map from connected components (CV_32SC1).
- * @param reg        RegionInfo to update — reads id, writes all features.
+ * @param runs     Labelled runs from connected components.
+ * @param reg      RegionInfo to update — reads id (and boundingBox in
+ *                 contour mode), writes all features.
+ * @param contour  Moments from the traced contour (Green's theorem).
  */
-void computeRegionFeatures(const cv::Mat& labelMap, RegionInfo& reg);
+void computeRegionFeatures(const RegionRuns& runs, RegionInfo& reg, bool contour = false);
 
 /**
  * @brief Compute features for all regions in AppState.
  *
- * @param labelMap   Label map (CV_32SC1).
- * @param state      AppState — iterates state.regions and updates each.
+ *        Walks the runs once for the raw moments of every region and once
+ *        for their oriented-box extents, then derives each region's features.
+ *        In contour mode each region's boundary is traced instead.
+ *
+ * @param runs    Labelled runs from connected components.
+ * @param state   AppState — iterates state.regions and updates each.
+ * @param params  Pipeline params (momentMode).
+ */
+void computeAllFeatures(const RegionRuns& runs, AppState& state,
+                        const PipelineParams& params);
+
+/**
+ * @brief Map region geometry from a downscaled frame to full resolution.
+ *
+ *        Scales bounding box, centroid, oriented box and axis extents by
+ *        scale; angle, area (normalised), fill ratio, bbox ratio and Hu
+ *        moments are scale invariant and left unchanged.
+ *
+ * @param regions   Regions with features computed at reduced resolution.
+ * @param scale     Full-resolution pixels per reduced pixel (2, 4, ...).
+ * @param fullSize  Full-resolution frame size (boxes are clipped to it).
+ */
+void scaleRegionGeometry(std::vector<RegionInfo>& regions, int scale,
+                         const cv::Size& fullSize);
+
+/**
+ * @brief Shift region geometry from a sub-image to frame coordinates.
+ *
+ * @param regions  Regions found in a ROI view of the frame.
+ * @param offset   Top-left corner of the ROI in the frame.
  */
-void computeAllFeatures(const cv::Mat& labelMap, AppState& state);
+void translateRegionGeometry(std::vector<RegionInfo>& regions,
+                             const cv::Point& offset);
 
 /**
  * @brief Draw feature visualisations on the display frame.
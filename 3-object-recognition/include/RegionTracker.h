@@ -0,0 +1,95 @@
+/**
+ * @file    RegionTracker.h
+ * @brief   Frame-to-frame region tracking with persistent track ids.
+ *
+ *          Regions are associated with the tracks of previous frames by a
+ *          combined cost of centroid distance, bounding-box IoU and Hu-moment
+ *          distance (greedy, lowest cost first).  A matched region inherits
+ *          its track's id, label, confidence, embedding and unknownFrames
+ *          counter, so the auto-learn prompt counts per object.
+ *
+ *          A region is flagged for classification (needsClassify) only when
+ *          its track is new, has no label yet, has drifted from the features
+ *          it was last classified with, or was classified trackReclassify
+ *          frames ago.  Static scenes are then classified a few times a
+ *          second instead of every frame.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "AppState.h"
+
+class RegionTracker {
+public:
+    /**
+     * @brief Associate this frame's regions with existing tracks.
+     *
+     *        Sets trackId and needsClassify on every region and copies the
+     *        carried-over classification into matched regions.  Tracks not
+     *        seen for kMaxMissed frames are dropped.
+     *
+     * @param regions  Regions of the current frame (features computed).
+     * @param params   Tracking parameters (trackReclassify, trackDrift).
+     */
+    void update(std::vector<RegionInfo>& regions, const PipelineParams& params);
+
+    /**
+     * @brief Store the classification results of this frame in the tracks.
+     *
+     *        Call after classification and auto-learn; regions that were
+     *        classified become the new drift reference of their track.
+     */
+    void store(const std::vector<RegionInfo>& regions);
+
+    /** Force every track to be reclassified (DB or classifier changed). */
+    void invalidate();
+
+    /** Drop all tracks. */
+    void reset() { tracks_.clear(); }
+
+private:
+    struct Track {
+        int         id            = -1;
+        cv::Rect    boundingBox;
+        cv::Point2f centroid;
+        HuMoments   huMoments     = {};
+        bool        hasHu         = false;
+        int         missed        = 0;    ///< Consecutive frames without a match
+
+        // Carried-over classification
+        std::string label;
+        float       confidence    = 0.f;
+        int         unknownFrames = 0;
+        std::vector<float> embedding;
+        cv::Mat     embedCrop;
+        bool        shapeLabel    = false; ///< Label came from the CNN cascade's shape stage
+
+        // Features at the last classification (drift reference)
+        HuMoments   refHu         = {};
+        bool        hasRefHu      = false;
+        double      refArea       = 0.0;
+        int         sinceClassify = 0;    ///< Frames since last classification
+        bool        classified    = false;
+    };
+
+    static constexpr int   kMaxMissed = 5;      ///< Frames a lost track survives
+    static constexpr float kMaxStep   = 150.f;  ///< Max centroid move per frame (px)
+    static constexpr float kMaxGrowth = 0.25f;  ///< Relative area change counted as drift
+
+    /** Candidate region-track association. */
+    struct Pair { float cost; int track; int region; };
+
+    std::vector<Track> tracks_;
+    int                nextId_ = 0;
+
+    // Per-frame scratch, kept so a steady frame does not allocate
+    std::vector<Pair> pairs_;
+    std::vector<int>  trackOf_;
+    std::vector<char> taken_;
+};
@@ -0,0 +1,64 @@
+/**
+ * @file    ResultServer.h
+ * @brief   Broadcasts newline-delimited JSON results to TCP clients.
+ *
+ *          Listens on a port; every connected client receives every line
+ *          passed to publish().  Clients only read — anything they send is
+ *          ignored.  A client whose socket buffer stays full for longer than
+ *          the send timeout is disconnected rather than slowing the
+ *          streams down.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ResultServer {
+public:
+    ResultServer() = default;
+
+    /** Stop accepting and close all clients. */
+    ~ResultServer();
+
+    ResultServer(const ResultServer&) = delete;
+    ResultServer& operator=(const ResultServer&) = delete;
+
+    /**
+     * @brief Listen on a TCP port (all interfaces) and accept clients.
+     * @return True if the port could be bound.
+     */
+    bool start(int port);
+
+    /** Stop accepting and close all clients. */
+    void stop();
+
+    /** Send one line (a newline is appended) to every client (thread-safe). */
+    void publish(const std::string& line);
+
+    /** Connected clients. */
+    int clientCount() const;
+
+private:
+#ifdef _WIN32
+    using Socket = uintptr_t;
+#else
+    using Socket = int;
+#endif
+
+    Socket              listen_{};
+    bool                listening_ = false;
+    std::atomic<bool>   stop_{false};
+    mutable std::mutex  mutex_;       ///< Guards clients_
+    std::vector<Socket> clients_;
+    std::thread         acceptor_;
+
+    void acceptLoop();
+};
@@ -0,0 +1,76 @@
+/**
+ * @file    ScaledPipeline.h
+ * @brief   Threshold → morphology → labeling on a downsampled frame.
+ *
+ *          The pre-blur and the binary mask do not need full resolution:
+ *          the frame is reduced 2x or 4x (area averaging, which also does
+ *          part of the blur's work), Tasks 1-3 run on the small frame with
+ *          blur / morphology kernels and the minimum area scaled to match,
+ *          and features are computed on the small frame's runs.  Region
+ *          geometry is then mapped back to full resolution, so drawing and
+ *          the CNN crop work on the original frame.  Scale-invariant
+ *          features (Hu moments, fill and bbox ratio) are unaffected.
+ *
+ *          With PipelineParams::useOpenCL, the frame is uploaded once and
+ *          the downscale, blur, threshold and morphology run on the OpenCL
+ *          device (T-API); only the cleaned mask (and the thresholded mask
+ *          when its window is open) is downloaded for labelling.  This path
+ *          replaces the streamed one, whose row bands are a CPU cache
+ *          optimisation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "AppState.h"
+#include "StreamPipeline.h"
+
+/** Downscale factor for PipelineParams::downscaleLevel (1, 2 or 4). */
+int downscaleFactor(const PipelineParams& params);
+
+/**
+ * @brief Run Tasks 1–4 at reduced resolution.
+ *
+ *        Uses the streamed or full-frame path as params selects.  Requested
+ *        intermediates are upscaled (nearest) to the frame size for display.
+ *
+ * @param frame   Input colour frame (BGR).
+ * @param state   AppState — regions (full-resolution geometry) and views.
+ * @param params  Pipeline parameters (downscaleLevel > 0).
+ * @param views   Which intermediates to materialise.
+ */
+void runDownscaledPipeline(const cv::Mat& frame, AppState& state,
+                           const PipelineParams& params,
+                           const PipelineViews& views);
+
+/**
+ * @brief Tasks 1-2 on the OpenCL device (see the file comment).
+ *
+ * @param frame   Input colour frame (BGR).
+ * @param scale   Downscale factor (1, 2 or 4) applied on the device.
+ * @param state   Output: frameCleaned, and frameThresholded if requested.
+ * @param params  Pipeline parameters, kernels already scaled to match.
+ * @param views   Which intermediates to materialise.
+ */
+void runDeviceThresholdMorphology(const cv::Mat& frame, int scale, AppState& state,
+                                  const PipelineParams& params,
+                                  const PipelineViews& views);
+
+/** OpenCL is requested and a device is available. */
+bool deviceSegmentationEnabled(const PipelineParams& params);
+
+/**
+ * @brief Tasks 1-4 on a frame (or ROI view): full, streamed or downscaled
+ *        or on the OpenCL device as params selects.  Shared by the live app and the batch runner.
+ *
+ * @param frame   Input colour frame or sub-Mat view (not copied).
+ * @param state   App state — regions and intermediates written here.
+ * @param params  Pipeline parameters.
+ * @param views   Intermediates the caller needs.
+ */
+void runSegmentation(const cv::Mat& frame, AppState& state,
+                     const PipelineParams& params,
+                     const PipelineViews& views);
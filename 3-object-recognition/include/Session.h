@@ -0,0 +1,126 @@
+/**
+ * @file    Session.h
+ * @brief   Record-and-replay of pipeline input for repeatable timing runs.
+ *
+ *          SessionRecorder stores the frames the processing thread ran on as
+ *          lossless PNGs and logs each frame's time and every change of
+ *          PipelineParams or classifier mode.  SessionReplay reads the log
+ *          back so the same frames can be run through the pipeline again
+ *          with the same settings at the same frame indices, either as fast
+ *          as possible or at the recorded pace.
+ *
+ *          Session folder:
+ *            frames/000000.png ...   one file per processed frame
+ *            session.yml             frame times and settings changes
+ *
+ *          PNG encoding runs on a writer thread behind a bounded queue.  A
+ *          recording must not lose frames, so when the writer falls behind
+ *          record() waits for it (the live frame rate drops while
+ *          recording, the recorded input does not).  session.yml is written
+ *          by stop().
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AppState.h"
+
+// =============================================================================
+// SessionChange — settings in force from one frame on
+// =============================================================================
+struct SessionChange {
+    long long      frame  = 0;       ///< First frame the settings apply to
+    double         timeMs = 0.0;     ///< Since the first frame
+    PipelineParams params;
+    bool           cnn    = false;   ///< CNN embedding classifier (vs shape features)
+};
+
+// =============================================================================
+// SessionRecorder
+// =============================================================================
+class SessionRecorder {
+public:
+    SessionRecorder() = default;
+
+    /** Stops a running recording (writes session.yml). */
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    /**
+     * @brief Start recording into a folder (created; the frames of an
+     *        earlier session in it are deleted).
+     * @return False if the folder cannot be created.
+     */
+    bool start(const std::string& dir);
+
+    /**
+     * @brief Record one processed frame with the settings it ran with.
+     *        The frame is copied; waits while the writer queue is full.
+     */
+    void record(const cv::Mat& frame, const PipelineParams& params, bool cnn);
+
+    /** Flush the queue, write session.yml and stop.  Safe when idle. */
+    bool stop();
+
+    bool      recording() const { return !dir_.empty(); }
+    long long frames()    const { return frames_; }
+
+private:
+    static constexpr int kQueue = 16;   ///< Frames waiting for the PNG writer
+
+    std::string                dir_;
+    long long                  frames_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<double>        times_;      ///< ms since start_, per frame
+    std::vector<SessionChange> changes_;
+
+    std::thread                writer_;
+    std::mutex                 mutex_;      ///< Guards queue_ and stop_
+    std::condition_variable    wake_;       ///< Frame queued / stop
+    std::condition_variable    space_;      ///< Frame written
+    std::deque<std::pair<long long, cv::Mat>> queue_;
+    bool                       stop_   = false;
+    int                        failed_ = 0; ///< PNG writes that failed (writer)
+
+    void writeLoop();
+};
+
+// =============================================================================
+// SessionReplay
+// =============================================================================
+class SessionReplay {
+public:
+    /**
+     * @brief Read a session folder written by SessionRecorder.
+     * @return False if session.yml is missing or has no frames.
+     */
+    bool open(const std::string& dir);
+
+    /** FrameSource spec of the recorded frames (image sequence). */
+    std::string frameSpec() const;
+
+    long long frameCount() const { return static_cast<long long>(times_.size()); }
+
+    /** Recorded time of a frame, ms since the first (0 past the end). */
+    double timeMs(long long frame) const;
+
+    /** Settings in force at a frame. */
+    const SessionChange& settingsAt(long long frame) const;
+
+private:
+    std::string                dir_;
+    std::vector<double>        times_;
+    std::vector<SessionChange> changes_;   ///< Ascending by frame, first at 0
+};
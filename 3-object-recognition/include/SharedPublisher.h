@@ -0,0 +1,133 @@
+/**
+ * @file    SharedPublisher.h
+ * @brief   Publishes frames and region results to other processes through a
+ *          named shared-memory ring (POSIX shm_open / Win32 file mapping).
+ *
+ *          The segment is created on the first publish(), sized for that
+ *          frame, and holds a header followed by kSlots slots.  Each slot is
+ *          a ShmSlotHeader, maxRegions fixed-size ShmRegion records and the
+ *          frame's pixels (rows packed, no padding).  Frames go to the slots
+ *          round-robin, so a reader has kSlots - 1 frame periods to use a
+ *          slot in place before it is reused.
+ *
+ *          Readers need no lock.  Each slot carries a sequence counter
+ *          (seqlock): the writer makes it odd before touching the slot and
+ *          sets it to the next even value when done.  A reader takes
+ *          ShmHeader::latest, reads the slot's sequence (retry if odd),
+ *          uses the records and pixels directly from the mapping, and keeps
+ *          the result only if the sequence is unchanged afterwards.
+ *
+ *          Every field is little-endian with the layout below, so a reader
+ *          needs only the struct offsets (e.g. numpy.frombuffer on mmap in
+ *          Python).  Frames larger than the first one are not published.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AppState.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory counters need lock-free 64-bit atomics");
+
+/** Segment header (256 bytes, at offset 0). */
+struct ShmHeader {
+    char                  magic[4];      ///< "ORSH"
+    uint32_t              version;       ///< Layout version (1)
+    uint32_t              slotCount;
+    uint32_t              maxRegions;    ///< Region records per slot
+    uint64_t              slotOffset;    ///< Byte offset of slot 0
+    uint64_t              slotBytes;     ///< Stride between slots
+    uint64_t              regionOffset;  ///< Region records, from the slot start
+    uint64_t              pixelOffset;   ///< Pixels, from the slot start
+    uint64_t              pixelBytes;    ///< Pixel capacity per slot
+    std::atomic<uint64_t> latest;        ///< Frames published (0 = none); slot (latest - 1) % slotCount
+    uint8_t               reserved[256 - 64];
+};
+
+/** Per-slot header (64 bytes, at the slot start). */
+struct ShmSlotHeader {
+    std::atomic<uint64_t> sequence;      ///< Odd while being written
+    int64_t               frame;         ///< Caller's frame number
+    int64_t               timeMs;        ///< Publication time, ms since the Unix epoch
+    int32_t               width;
+    int32_t               height;
+    int32_t               type;          ///< OpenCV type (CV_8UC3 = 16 for BGR)
+    int32_t               step;          ///< Bytes per pixel row
+    int32_t               regionCount;   ///< Valid records (<= maxRegions)
+    uint8_t               reserved[64 - 44];
+};
+
+/** One region (96 bytes). */
+struct ShmRegion {
+    int32_t trackId;                     ///< -1 = untracked
+    int32_t x, y, w, h;                  ///< Bounding box (frame pixels)
+    float   cx, cy;                      ///< Centroid
+    float   angle;                       ///< Primary axis (radians)
+    float   confidence;
+    float   area;                        ///< Normalised by the image area
+    float   fillRatio;
+    float   bboxRatio;
+    char    label[48];                   ///< NUL-terminated, truncated
+};
+
+static_assert(sizeof(ShmHeader) == 256, "ShmHeader layout");
+static_assert(sizeof(ShmSlotHeader) == 64, "ShmSlotHeader layout");
+static_assert(sizeof(ShmRegion) == 96, "ShmRegion layout");
+
+class SharedPublisher {
+public:
+    static constexpr int kSlots      = 4;
+    static constexpr int kMaxRegions = 64;
+
+    SharedPublisher() = default;
+    ~SharedPublisher() { close(); }
+
+    SharedPublisher(const SharedPublisher&) = delete;
+    SharedPublisher& operator=(const SharedPublisher&) = delete;
+
+    /**
+     * @brief Name the segment; it is created on the first publish().
+     * @param name  Segment name without prefix ("objrec" → /objrec on
+     *              POSIX, Local\\objrec on Windows).
+     */
+    void setName(const std::string& name) { close(); name_ = name; failed_ = false; }
+
+    /** A segment name was set. */
+    bool enabled() const { return !name_.empty(); }
+
+    /**
+     * @brief Copy a frame and its regions into the next slot.
+     *
+     * @param frame    Frame (any 8-bit type); rows are packed in the slot.
+     * @param regions  Results; records beyond kMaxRegions are dropped.
+     * @param frameNo  Number stored with the slot.
+     * @return         False if the segment could not be created or the
+     *                 frame does not fit.
+     */
+    bool publish(const cv::Mat& frame, const std::vector<RegionInfo>& regions,
+                 long long frameNo);
+
+    /** Unmap and remove the segment (readers keep their mapping). */
+    void close();
+
+private:
+    std::string name_;
+    uint8_t*    base_  = nullptr;
+    size_t      size_  = 0;
+    bool        failed_ = false;   ///< Creation failed; do not retry every frame
+    bool        warned_ = false;   ///< Oversized frame reported
+#ifdef _WIN32
+    void*       mapping_ = nullptr; ///< HANDLE of the file mapping object
+#endif
+
+    bool create(size_t pixelBytes);
+};
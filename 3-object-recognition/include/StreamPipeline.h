@@ -0,0 +1,53 @@
+/**
+ * @file    StreamPipeline.h
+ * @brief   Band-streamed threshold → morphology → labeling stage.
+ *
+ *          Instead of three full-frame passes with a full-size intermediate
+ *          each, the frame is processed in bands of rows:
+ *            1. threshold the rows the next band needs into a small rolling
+ *               window (rows shared with the previous band are kept);
+ *            2. run morphology on the window — it extends morphologyReach()
+ *               rows past the band, so the band's rows come out exact;
+ *            3. feed the cleaned band to a StreamLabeler (first pass).
+ *          After the last band, pass 2 and region collection run on the
+ *          labelled runs as in findRegions().  Results are identical to the
+ *          full-frame pipeline.
+ *
+ *          The thresholded and cleaned frames (and the color-coded region
+ *          image) are only assembled when a debug view asks for them.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "AppState.h"
+#include "ConnectedComponents.h"
+
+/**
+ * @brief Intermediate frames the caller will display this frame.
+ */
+struct PipelineViews {
+    bool thresholded = false; ///< Fill state.frameThresholded
+    bool cleaned     = false; ///< Fill state.frameCleaned
+    bool regions     = false; ///< Fill state.frameRegions
+};
+
+/**
+ * @brief Run Tasks 1–3 in row bands on one frame.
+ *
+ *        Intermediates not requested in views are released from state.
+ *        With ISODATA / Otsu thresholding the frame-wide threshold is computed
+ *        up front, which needs one full blurred grayscale frame.
+ *
+ * @param frame     Input colour frame (BGR).
+ * @param state     AppState — regions and the requested intermediates written here.
+ * @param params    Pipeline parameters.
+ * @param views     Which intermediates to materialise.
+ * @param runs      Output: labelled runs — needed by Task 4 features.
+ */
+void runStreamedPipeline(const cv::Mat& frame, AppState& state,
+                         const PipelineParams& params,
+                         const PipelineViews& views, RegionRuns& runs);
@@ -0,0 +1,183 @@
+/**
+ * @file    TaskScheduler.h
+ * @brief   Process-wide work-stealing task pool shared by every pipeline
+ *          stage.
+ *
+ *          One set of worker threads (hardware threads - 1; the thread that
+ *          waits on a parallelFor() runs chunks too) replaces per-stage
+ *          threads and OpenCV's own pool: useForOpenCV() installs the
+ *          scheduler as OpenCV's parallel_for_ backend, so the stages'
+ *          cv::parallel_for_ loops, OpenCV's internal kernels and cv::dnn all
+ *          share it with the tasks submitted here.
+ *
+ *          Each worker owns one deque per priority (a ring that only grows,
+ *          so a warmed-up pool queues tasks without allocating).  A thread
+ *          pushes and pops its own deque at the back (newest first, cache-warm) and steals
+ *          from the front of the others' when its own is empty.  Priorities
+ *          are strict but not preemptive: every High task queued anywhere is
+ *          taken before any Normal one, Normal before Low.  A thread runs
+ *          its tasks at its own priority (setThreadPriority), and tasks run
+ *          nested parallel loops at theirs, so the processing thread's frame
+ *          work (High) overtakes background re-clustering or model loads
+ *          (Low) between chunks.  A thread waiting on a loop only helps with
+ *          tasks at least as urgent as its own.
+ *
+ *          Without start() (objrecEval, objrecServer) nothing is threaded:
+ *          parallelFor() and submit() run on the calling thread.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// TaskPriority — most urgent first
+// =============================================================================
+enum class TaskPriority {
+    High,      ///< Work the displayed frame waits for
+    Normal,    ///< Default
+    Low,       ///< Background (re-clustering, index rebuilds, model loads)
+    Count
+};
+
+// =============================================================================
+// TaskScheduler
+// =============================================================================
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    /** One worker over the last stats window. */
+    struct WorkerStats {
+        float     utilisation = 0.f;   ///< Busy fraction, 0..1
+        long long tasks       = 0;     ///< Tasks run since start()
+        long long steals      = 0;     ///< Of which taken from another worker
+    };
+
+    /** Snapshot for the GUI. */
+    struct Stats {
+        std::vector<WorkerStats> workers;
+        std::array<int, static_cast<size_t>(TaskPriority::Count)> queued{};
+    };
+
+    /** The process-wide scheduler. */
+    static TaskScheduler& instance();
+
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Start the workers (once; later calls are ignored).
+     * @param workers  Worker threads; <= 0 = hardware threads - 1.
+     */
+    void start(int workers = 0);
+
+    /**
+     * @brief Run the queued tasks and join the workers.  Called at exit,
+     *        after the threads that use the pool have been joined.
+     */
+    void stop();
+
+    /**
+     * @brief Route cv::parallel_for_ (and so OpenCV's internal threading)
+     *        through this scheduler.  Needs start() first and OpenCV 4.5.5+;
+     *        otherwise OpenCV keeps its own pool.
+     * @return True if installed.
+     */
+    bool useForOpenCV();
+
+    /** Worker threads (0 before start()). */
+    int workerCount() const { return static_cast<int>(workers_.size()); }
+
+    /** Threads a parallelFor() can use: workers + the caller. */
+    int concurrency() const { return workerCount() + 1; }
+
+    /**
+     * @brief Queue a task (fire and forget).  Exceptions are reported and
+     *        dropped.  Runs inline when not started.
+     */
+    void submit(Task task, TaskPriority priority);
+    void submit(Task task) { submit(std::move(task), threadPriority()); }
+
+    /**
+     * @brief Run body over [begin, end) in chunks of at least grain items,
+     *        at the calling thread's priority, and wait for all of them.
+     *        The caller runs chunks while it waits, so nested loops cannot
+     *        deadlock.  The first exception thrown by a chunk is rethrown.
+     */
+    void parallelFor(int begin, int end, const std::function<void(int, int)>& body,
+                     int grain = 1);
+
+    /** Priority of the calling thread's work (Normal unless set). */
+    static TaskPriority threadPriority();
+
+    /** Set the calling thread's priority (e.g. High on the processing thread). */
+    static void setThreadPriority(TaskPriority priority);
+
+    /** Index of the calling worker, -1 on any other thread. */
+    static int workerIndex();
+
+    /** Utilisation over the last ~0.5 s window, plus counters. */
+    Stats stats();
+
+private:
+    static constexpr int kChunksPerThread = 4;   ///< parallelFor split (load balance)
+    static constexpr int kPriorities      = static_cast<int>(TaskPriority::Count);
+
+    /** Double-ended task queue on a power-of-two ring; grows, never shrinks. */
+    struct TaskRing {
+        std::vector<Task> slots;
+        size_t            head  = 0;
+        size_t            count = 0;
+
+        bool empty() const { return count == 0; }
+        void pushBack(Task&& task);
+        Task popBack();
+        Task popFront();
+    };
+
+    struct Worker {
+        std::mutex                           mutex;   ///< Guards queues
+        std::array<TaskRing, kPriorities>    queues;
+        std::thread                          thread;
+        std::atomic<long long>               busyNs{0};
+        std::atomic<long long>               tasks{0};
+        std::atomic<long long>               steals{0};
+    };
+
+    TaskScheduler() = default;
+
+    void workerLoop(int index);
+
+    /** Push tasks to the caller's deque (worker) or spread them round-robin. */
+    void push(std::vector<Task>& tasks, TaskPriority priority);
+
+    /** Run one queued task of priority <= maxPriority; false if none. */
+    bool runOne(int self, TaskPriority maxPriority);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<int>                     pending_{0};   ///< Queued, not yet taken
+    std::array<std::atomic<int>, kPriorities> queued_{};
+    std::atomic<unsigned>                next_{0};      ///< Round-robin target
+    std::mutex                           sleepMutex_;
+    std::condition_variable              wake_;
+    bool                                 stop_ = false;
+
+    std::mutex                           statsMutex_;
+    std::chrono::steady_clock::time_point statsTime_;
+    std::vector<long long>               statsBusy_;    ///< busyNs at statsTime_
+    std::vector<float>                   statsUtil_;
+};
@@ -5,7 +5,15 @@
  *          Supports three modes controlled by PipelineParams:
  *            1. Global fixed threshold
  *            2. Adaptive (local) threshold
- *            3. ISODATA / k-means dynamic threshold (k=2)
+ *            3. ISODATA / k-means dynamic threshold (k=2), or Otsu
+ *            4. Saturation + intensity score (fused single pass)
+ *
+ *          Dynamic thresholds are computed from one 256-bin histogram of
+ *          the frame, built in parallel stripes.
+ *
+ *          A cv::UMat overload of applyThreshold runs the same modes through
+ *          OpenCV's T-API, so the blur, colour conversion and threshold stay
+ *          on the OpenCL device when one is available.
  *
  *          Objects are assumed darker than a light background.
  *          Output is always a binary image (0 = background, 255 = object).
@@ -17,16 +25,20 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <cvcore/tileOccupancy.hpp>
 #include "AppState.h"
 
 /**
  * @brief Apply pre-processing blur to reduce noise before thresholding.
  *
+ *        Gaussian by default; box (cv::blur) and stack blur cost the same
+ *        per pixel for any kernel size.
+ *
  * @param src    Input colour frame.
  * @param dst    Output blurred frame (same type as src).
- * @param params Pipeline parameters (blurKernelSize used).
+ * @param params Pipeline parameters (blurKernelSize, blurMode used).
  */
-void applyBlur(const cv::Mat& src, cv::Mat& dst, const PipelineParams& params);
+void applyBlur(cv::InputArray src, cv::OutputArray dst, const PipelineParams& params);
 
 /**
  * @brief Convert frame to grayscale.
@@ -36,18 +48,41 @@ void applyBlur(const cv::Mat& src, cv::Mat& dst, const PipelineParams& params);
  */
 void toGrayscale(const cv::Mat& src, cv::Mat& dst);
 
+/**
+ * @brief 256-bin histogram of a grayscale image (one parallel pass).
+ *
+ * @param gray   Single-channel 8-bit image.
+ * @param hist   Output: pixel count per grey level.
+ */
+void computeHistogram(const cv::Mat& gray, int hist[256]);
+
 /**
  * @brief Compute a dynamic threshold value using ISODATA (k-means, k=2).
  *
- *        Samples 1/16 of pixels at random, runs two-cluster k-means,
- *        and returns the midpoint between the two cluster means.
- *        Useful when lighting changes between sessions.
+ *        Runs two-cluster k-means over the histogram bins (all pixels,
+ *        weighted by count) and returns the midpoint between the two
+ *        cluster means.  Useful when lighting changes between sessions.
  *
  * @param gray   Single-channel grayscale image.
  * @return       Suggested threshold value [0..255].
  */
 int computeISODATAThreshold(const cv::Mat& gray);
 
+/** ISODATA threshold of a precomputed histogram. */
+int computeISODATAThreshold(const int hist[256]);
+
+/**
+ * @brief Otsu threshold: maximises the between-class variance of
+ *        [0..t] and [t+1..255].
+ *
+ * @param gray   Single-channel grayscale image.
+ * @return       Threshold value [0..255]; pixels <= t are foreground.
+ */
+int computeOtsuThreshold(const cv::Mat& gray);
+
+/** Otsu threshold of a precomputed histogram. */
+int computeOtsuThreshold(const int hist[256]);
+
 /**
  * @brief Custom threshold using saturation and intensity channels (HSV).
  *
@@ -59,6 +94,10 @@ int computeISODATAThreshold(const cv::Mat& gray);
  *        Dark/coloured object → high S or low V → low score → foreground.
  *        Pixels with score below threshold → foreground (255).
  *
+ *        Since V = max(B,G,R) and S = (max - min) / max, the score equals
+ *        min(B,G,R) / 255; it is computed directly from BGR in one SIMD
+ *        pass, without an HSV conversion.
+ *
  * @param src      Input colour frame (BGR).
  * @param dst      Output binary mask (CV_8UC1).
  * @param params   Pipeline parameters (thresholdValue used as threshold).
@@ -71,7 +110,7 @@ void applyCustomSatIntensityThreshold(const cv::Mat& src, cv::Mat& dst,
  *
  *        Mode selected via params:
  *          - useSatIntensity=true → custom saturation+intensity threshold
- *          - useKMeans=true       → ISODATA dynamic threshold
+ *          - useKMeans=true       → ISODATA or Otsu dynamic threshold
  *          - useAdaptive=true     → cv::adaptiveThreshold
  *          - default              → global cv::threshold
  *
@@ -82,4 +121,61 @@ void applyCustomSatIntensityThreshold(const cv::Mat& src, cv::Mat& dst,
  * @param params Pipeline parameters.
  */
 void applyThreshold(const cv::Mat& src, cv::Mat& dst,
-                    const PipelineParams& params);
\ No newline at end of file
+                    const PipelineParams& params);
+
+/**
+ * @brief applyThreshold that also marks the mask's occupied 32x32 tiles.
+ *
+ *        The tiles are found while the mask is still in cache, for the
+ *        sparse overloads of applyMorphology and findRegions.
+ *
+ * @param src    Input colour frame (BGR).
+ * @param dst    Output binary mask (CV_8UC1).
+ * @param params Pipeline parameters.
+ * @param tiles  Output occupancy of dst.
+ */
+void applyThreshold(const cv::Mat& src, cv::Mat& dst,
+                    const PipelineParams& params, cvcore::TileOccupancy& tiles);
+
+/**
+ * @brief applyThreshold on device memory (T-API).
+ *
+ *        Same modes and output as the cv::Mat version; only the 256-bin
+ *        histogram of the dynamic modes is read back to the host.
+ *
+ * @param src    Input colour frame (BGR) as a UMat.
+ * @param dst    Output binary mask (CV_8UC1), left on the device.
+ * @param params Pipeline parameters.
+ */
+void applyThreshold(const cv::UMat& src, cv::UMat& dst,
+                    const PipelineParams& params);
+
+/**
+ * @brief ISODATA or Otsu threshold of a whole frame, as applyThreshold
+ *        computes it.
+ *
+ * @param src    Input colour frame (BGR).
+ * @param params Pipeline parameters (blurKernelSize, dynamicThresh).
+ * @return       Threshold value in [0..255].
+ */
+int computeFrameDynamicThreshold(const cv::Mat& src, const PipelineParams& params);
+
+/**
+ * @brief Threshold only rows [rowBegin, rowEnd) of a frame.
+ *
+ *        Produces the same rows as applyThreshold on the full frame: the
+ *        blur reads the surrounding rows of src through the ROI border, and
+ *        adaptive mode thresholds a few halo rows for its local means.
+ *        ISODATA / Otsu need a frame-wide value, passed in as isoThreshold.
+ *
+ * @param src           Input colour frame (BGR).
+ * @param rowBegin      First row to threshold.
+ * @param rowEnd        One past the last row.
+ * @param dst           Output mask rows (CV_8UC1); written in place when it
+ *                      already has the band's size and type.
+ * @param params        Pipeline parameters.
+ * @param isoThreshold  Frame ISODATA / Otsu threshold (used when useKMeans).
+ */
+void applyThresholdRows(const cv::Mat& src, int rowBegin, int rowEnd,
+                        cv::Mat& dst, const PipelineParams& params,
+                        int isoThreshold = -1);
@@ -0,0 +1,65 @@
+/**
+ * @file    TripleBuffer.h
+ * @brief   Lock-free single-producer / single-consumer triple buffer.
+ *
+ *          Three slots: the producer owns one (write), the consumer owns one
+ *          (read) and the third sits in the middle.  publish() swaps the
+ *          write slot with the middle one and marks it fresh; update() swaps
+ *          the read slot with a fresh middle one.  Both are a single atomic
+ *          exchange, so neither side ever waits — the producer overwrites
+ *          an unread middle slot and the consumer always sees the newest
+ *          complete value.
+ *
+ *          A slot is reused in place once it comes back round, so values
+ *          keep their allocations (cv::Mat buffers, vectors).  The consumer
+ *          must not keep references into read() past its next update().
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /** Producer: slot to fill before publish(). */
+    T& writeBuffer() { return slots_[write_]; }
+
+    /** Producer: hand the write slot to the consumer. */
+    void publish()
+    {
+        write_ = middle_.exchange(static_cast<uint8_t>(write_ | kFresh),
+                                  std::memory_order_acq_rel) & kIndex;
+    }
+
+    /**
+     * @brief Consumer: take the newest published slot, if any.
+     * @return True if read() now holds a value not seen before.
+     */
+    bool update()
+    {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+        read_ = middle_.exchange(read_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+
+    /** Consumer: the slot taken by the last successful update(). */
+    const T& read() const { return slots_[read_]; }
+
+private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kFresh = 0x4;  ///< Middle slot not yet taken
+
+    T                    slots_[3];
+    uint8_t              write_  = 0;   ///< Producer-only
+    uint8_t              read_   = 1;   ///< Consumer-only
+    std::atomic<uint8_t> middle_ {2};   ///< Index | kFresh
+};
@@ -18,6 +18,14 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include <string>
+#include <vector>
+
+/// ResNet18 input side and normalisation, shared by every embedding path:
+/// input = (pixel - mean) * scale, planes in R, G, B order
+static const int    kORNetSize    = 224;
+static const double kORNetScale   = (1.0 / 255.0) * (1.0 / 0.226);
+static const double kORNetMean[3] = {124.0, 116.0, 104.0};
 
 /**
  * @brief Rotate frame and extract aligned ROI for embedding.
@@ -61,4 +69,37 @@ void prepEmbeddingImage(cv::Mat& frame, cv::Mat& embimage,
  */
 int getEmbedding(cv::Mat& src, cv::Mat& embedding,
                  cv::dnn::Net& net, int debug = 0);
-                 
\ No newline at end of file
+                 
+
+/**
+ * @brief Compute embeddings for several images with one batched forward pass.
+ *
+ *        Same preprocessing as getEmbedding(), but all images go into one
+ *        NCHW blob (cv::dnn::blobFromImages), so the network runs once.
+ *
+ * @param srcs       Input BGR images (any size — resized internally).
+ * @param embeddings Output N x 512 cv::Mat (CV_32F), row i for srcs[i].
+ * @param net        Loaded ResNet18 DNN network.
+ * @return           0 on success, -1 if srcs is empty.
+ */
+int getEmbeddings(const std::vector<cv::Mat>& srcs, cv::Mat& embeddings,
+                  cv::dnn::Net& net);
+
+/**
+ * @brief Output taken as the embedding: ResNet18's penultimate flatten
+ *        layer if the network has it, otherwise "" (the network's final
+ *        output, e.g. a MobileNet feature head).
+ */
+std::string embeddingLayer(const cv::dnn::Net& net);
+
+/**
+ * @brief Run the network on an already normalised N x 3 x 224 x 224 blob.
+ *
+ * @param blob       Network input (CV_32F, planes R, G, B).
+ * @param embeddings Output N x dim cv::Mat (CV_32F), the output flattened per image.
+ * @param net        Loaded DNN network.
+ * @param layer      Output layer (see embeddingLayer()).
+ * @return           0 on success, -1 if blob is empty.
+ */
+int forwardEmbeddings(const cv::Mat& blob, cv::Mat& embeddings,
+                      cv::dnn::Net& net, const std::string& layer);
@@ -0,0 +1,194 @@
+/**
+ * @file    AsyncEmbedder.cpp
+ * @brief   Background ResNet18 embedding worker implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "AsyncEmbedder.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+// -----------------------------------------------------------------------------
+AsyncEmbedder::AsyncEmbedder(EmbeddingClassifier& classifier, int maxPending)
+    : classifier_(classifier),
+      maxPending_(std::max(1, maxPending))
+{
+    worker_ = std::thread(&AsyncEmbedder::run, this);
+}
+
+// -----------------------------------------------------------------------------
+AsyncEmbedder::~AsyncEmbedder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+// -----------------------------------------------------------------------------
+void AsyncEmbedder::submit(const cv::Mat& frame,
+                           const std::vector<RegionInfo>& regions)
+{
+    Job job;
+    for (const auto& reg : regions)
+        if (reg.trackId >= 0 && reg.needsClassify && !reg.shapeLabel)
+            job.regions.push_back(reg);
+    if (job.regions.empty() || frame.empty()) return;
+    job.frame = frame.clone();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (static_cast<int>(pending_.size()) >= maxPending_)
+            pending_.pop_front(); // newest frame wins
+        pending_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+void AsyncEmbedder::retain(const std::vector<int>& liveTrackIds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_      = std::set<int>(liveTrackIds.begin(), liveTrackIds.end());
+    liveKnown_ = true;
+
+    for (auto& job : pending_) {
+        auto dead = [&](const RegionInfo& r) { return live_.count(r.trackId) == 0; };
+        job.regions.erase(std::remove_if(job.regions.begin(), job.regions.end(), dead),
+                          job.regions.end());
+    }
+    pending_.erase(std::remove_if(pending_.begin(), pending_.end(),
+                                  [](const Job& j) { return j.regions.empty(); }),
+                   pending_.end());
+    completed_.erase(std::remove_if(completed_.begin(), completed_.end(),
+                                    [&](const Result& r) { return live_.count(r.trackId) == 0; }),
+                     completed_.end());
+}
+
+// -----------------------------------------------------------------------------
+void AsyncEmbedder::classifyAll(const cv::Mat& frame, AppState& state,
+                                const EmbeddingDB& db, float thresh,
+                                int metric)
+{
+    ProfileScope profile(ProfileStage::Classify);
+
+    // --- Forget tracks that left the scene ------------------------------------
+    std::vector<int> live;
+    for (const auto& reg : state.regions)
+        if (reg.trackId >= 0) live.push_back(reg.trackId);
+    retain(live);
+    for (auto it = tracks_.begin(); it != tracks_.end(); ) {
+        if (std::find(live.begin(), live.end(), it->first) == live.end())
+            it = tracks_.erase(it);
+        else
+            ++it;
+    }
+
+    // --- Classify finished embeddings -----------------------------------------
+    for (auto& r : poll()) {
+        TrackLabel& t = tracks_[r.trackId];
+        float dist;
+        classifier_.classify(r.embedding, db, thresh, t.label, dist, metric);
+        t.confidence = EmbeddingClassifier::confidence(dist, metric);
+        t.embedding  = std::move(r.embedding);
+        t.crop       = r.crop;
+    }
+
+    if (hasRoom()) submit(frame, state.regions);
+
+    // --- Latest known result per region ---------------------------------------
+    state.lastCroppedROI = cv::Mat();
+    state.croppedROIs.clear();
+    for (auto& reg : state.regions) {
+        if (reg.shapeLabel) continue; // answered by the shape cascade
+        auto it = tracks_.find(reg.trackId);
+        if (it == tracks_.end()) {
+            reg.label      = "";
+            reg.confidence = 0.f;
+            continue;
+        }
+        const TrackLabel& t = it->second;
+        reg.label      = t.label;
+        reg.confidence = t.confidence;
+        reg.embedding  = t.embedding;
+        reg.embedCrop  = t.crop;
+        state.croppedROIs.push_back(t.crop);
+        if (state.lastCroppedROI.empty()) state.lastCroppedROI = t.crop;
+    }
+}
+
+// -----------------------------------------------------------------------------
+std::vector<AsyncEmbedder::Result> AsyncEmbedder::poll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Result> out(std::make_move_iterator(completed_.begin()),
+                            std::make_move_iterator(completed_.end()));
+    completed_.clear();
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+int AsyncEmbedder::queueDepth() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(pending_.size()) + (busy_ ? 1 : 0);
+}
+
+// -----------------------------------------------------------------------------
+bool AsyncEmbedder::hasRoom() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(pending_.size()) < maxPending_;
+}
+
+// -----------------------------------------------------------------------------
+float AsyncEmbedder::latencyMs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latencyMs_;
+}
+
+// -----------------------------------------------------------------------------
+void AsyncEmbedder::run()
+{
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || !pending_.empty(); });
+            if (stop_) return;
+            job = std::move(pending_.front());
+            pending_.pop_front();
+            busy_ = true;
+        }
+
+        // --- Batched forward pass (outside the queue lock) -------------------
+        std::vector<std::vector<float>> embs;
+        std::vector<cv::Mat>            crops;
+        auto t0 = std::chrono::steady_clock::now();
+        classifier_.computeEmbeddings(job.frame, job.regions, embs, &crops);
+        float ms = std::chrono::duration<float, std::milli>(
+                       std::chrono::steady_clock::now() - t0).count();
+
+        // --- Post results for tracks that are still alive --------------------
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_      = false;
+            latencyMs_ = (latencyMs_ == 0.f) ? ms : 0.8f * latencyMs_ + 0.2f * ms;
+            for (size_t i = 0; i < job.regions.size(); i++) {
+                const int id = job.regions[i].trackId;
+                if (embs[i].empty() || (liveKnown_ && live_.count(id) == 0)) continue;
+                Result r;
+                r.trackId   = id;
+                r.embedding = std::move(embs[i]);
+                r.crop      = crops[i];
+                completed_.push_back(std::move(r));
+            }
+        }
+    }
+}
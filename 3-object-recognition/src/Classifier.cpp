@@ -7,9 +7,11 @@
  */
 
 #include "Classifier.h"
+#include "Profiler.h"
+#include "TaskScheduler.h"
+#include "AllocCounter.h"
 #include <cmath>
 #include <algorithm>
-#include <map>
 #include <numeric>
 #include <iostream>
 
@@ -21,53 +23,189 @@ Classifier::Classifier(const ObjectDB& db, const PipelineParams& params)
     (void)params;
 }
 
+// -----------------------------------------------------------------------------
+Classifier::~Classifier()
+{
+    {
+        std::lock_guard<std::mutex> lock(dataMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+// -----------------------------------------------------------------------------
+void Classifier::RunningStats::add(const double* fv)
+{
+    n++;
+    for (int d = 0; d < kFeatureDim; d++) {
+        const double delta = fv[d] - mean[d];
+        mean[d] += delta / static_cast<double>(n);
+        m2[d]   += delta * (fv[d] - mean[d]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+double Classifier::RunningStats::stdev(int d) const
+{
+    const double var = n > 0 ? m2[d] / static_cast<double>(n) : 0.0;
+    // Guard: if stdev ~ 0 all entries have same value → no scaling needed
+    return (var > 1e-10) ? std::sqrt(var) : 1.0;
+}
+
 // -----------------------------------------------------------------------------
 void Classifier::refit(const ObjectDB& db)
 {
+    std::unique_lock<std::mutex> lock(dataMutex_);
     db_ = &db;
-    const auto& entries = db.entries();
+    // Records are read in place — straight from the mapped DB file
+    const DBRecord* records = db.records();
+    const int       n       = db.size();
+
+    data_.rows.clear();
+    data_.rowName.clear();
+    data_.names = db.labelNames();
+    data_.stats = RunningStats{};
+    data_.rows.reserve(static_cast<size_t>(n) * kFeatureDim);
+    for (int row = 0; row < n; row++) {
+        const double* fv = records[row].features;
+        data_.rows.insert(data_.rows.end(), fv, fv + kFeatureDim);
+        data_.rowName.push_back(records[row].label);
+        data_.stats.add(fv);
+    }
+    const long long version = ++data_.version;
+    pending_ = false;
+
+    std::shared_ptr<const Index> index = buildIndex(data_);
+    lock.unlock();
+    publish(std::move(index), version);
+}
 
-    if (entries.empty()) {
-        stdevs_.assign(kFeatureDim, 1.0);
-        means_ .assign(kFeatureDim, 0.0);
+// -----------------------------------------------------------------------------
+void Classifier::learn(const ObjectDB& db)
+{
+    std::unique_lock<std::mutex> lock(dataMutex_);
+    const int known = static_cast<int>(data_.rowName.size());
+    if (&db != db_ || db.size() < known) {
+        lock.unlock();
+        refit(db);
         return;
     }
+    if (db.size() == known) return;
 
-    // Accumulate sum and sum-of-squares per feature dimension
-    std::vector<double> sum(kFeatureDim, 0.0);
-    std::vector<double> sumSq(kFeatureDim, 0.0);
-    int n = 0;
+    // O(1) per new row: append it and update the running statistics
+    const DBRecord* records = db.records();
+    for (int row = known; row < db.size(); row++) {
+        const double* fv = records[row].features;
+        data_.rows.insert(data_.rows.end(), fv, fv + kFeatureDim);
+        data_.rowName.push_back(records[row].label);
+        data_.stats.add(fv);
+    }
+    if (data_.names.size() != db.labelNames().size()) data_.names = db.labelNames();
+    data_.version++;
+
+    pending_ = true;
+    if (!worker_.joinable()) worker_ = std::thread(&Classifier::rebuildLoop, this);
+    lock.unlock();
+    wake_.notify_one();
+}
 
-    for (const auto& e : entries) {
-        auto fv = e.toFeatureVector();
-        for (int d = 0; d < kFeatureDim && d < static_cast<int>(fv.size()); d++) {
-            sum[d]   += fv[d];
-            sumSq[d] += fv[d] * fv[d];
+// -----------------------------------------------------------------------------
+void Classifier::rebuildLoop()
+{
+    TaskScheduler::setThreadPriority(TaskPriority::Low);
+    TrainingData snapshot;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(dataMutex_);
+            wake_.wait(lock, [&] { return stop_ || pending_; });
+            if (stop_) return;
+            snapshot = data_;       // samples added meanwhile queue another pass
+            pending_ = false;
         }
-        n++;
+        publish(buildIndex(snapshot), snapshot.version);
     }
+}
+
+// -----------------------------------------------------------------------------
+void Classifier::publish(std::shared_ptr<const Index> index, long long version)
+{
+    std::lock_guard<std::mutex> lock(dataMutex_);
+    if (version <= published_) return;   // a refit() overtook this build
+    published_ = version;
+    std::atomic_store(&index_, std::move(index));
+    generation_++;
+}
 
-    means_ .resize(kFeatureDim);
-    stdevs_.resize(kFeatureDim);
+// -----------------------------------------------------------------------------
+std::shared_ptr<const Classifier::Index> Classifier::buildIndex(const TrainingData& data)
+{
+    auto index = std::make_shared<Index>();
+    const int n = static_cast<int>(data.rowName.size());
 
+    index->means .resize(kFeatureDim);
+    index->stdevs.resize(kFeatureDim);
     for (int d = 0; d < kFeatureDim; d++) {
-        means_[d] = sum[d] / n;
-        double var = (sumSq[d] / n) - (means_[d] * means_[d]);
-        // Guard: if stdev ~ 0 all entries have same value → no scaling needed
-        stdevs_[d] = (var > 1e-10) ? std::sqrt(var) : 1.0;
+        index->means[d]  = data.stats.mean[d];
+        index->stdevs[d] = data.stats.stdev(d);
+    }
+
+    // --- Search trees and class centroids ------------------------------------
+    // DB dictionary index → labels index, in order of first appearance
+    std::vector<int>    labelIndex(data.names.size(), -1);
+    std::vector<double> scaled, unit;
+    std::vector<int>    labelCount;
+    scaled.reserve(static_cast<size_t>(n) * kFeatureDim);
+
+    for (int row = 0; row < n; row++) {
+        const double* fv = &data.rows[static_cast<size_t>(row) * kFeatureDim];
+
+        int& li = labelIndex[data.rowName[row]];
+        if (li < 0) {
+            li = static_cast<int>(index->labels.size());
+            index->labels.push_back(data.names[data.rowName[row]]);
+            labelCount.push_back(0);
+            index->euclidCentroids.emplace_back(kFeatureDim, 0.0);
+            index->cosineCentroids.emplace_back(kFeatureDim, 0.0);
+        }
+        index->rowLabel.push_back(li);
+        labelCount[li]++;
+
+        double norm = 0.0;
+        for (int d = 0; d < kFeatureDim; d++) {
+            scaled.push_back(fv[d] / index->stdevs[d]);
+            index->euclidCentroids[li][d] += fv[d];
+            norm += fv[d] * fv[d];
+        }
+        if (norm < 1e-10) { index->zeroRows.push_back(row); continue; }
+        norm = std::sqrt(norm);
+        index->cosineRows.push_back(row);
+        for (int d = 0; d < kFeatureDim; d++) {
+            unit.push_back(fv[d] / norm);
+            index->cosineCentroids[li][d] += fv[d] / norm;
+        }
     }
+
+    // Cosine ignores scale, so the summed unit vectors need no division
+    for (size_t li = 0; li < index->labels.size(); li++)
+        for (int d = 0; d < kFeatureDim; d++)
+            index->euclidCentroids[li][d] /= labelCount[li];
+
+    index->euclidTree.build(scaled, kFeatureDim);
+    index->cosineTree.build(unit,   kFeatureDim);
+    return index;
 }
 
 // -----------------------------------------------------------------------------
-float Classifier::scaledEuclidean(const std::vector<double>& a,
-                                   const std::vector<double>& b) const
+float Classifier::scaledEuclidean(const Index& index, const std::vector<double>& a,
+                                  const std::vector<double>& b)
 {
     double sum = 0.0;
     int dim = std::min({static_cast<int>(a.size()),
                         static_cast<int>(b.size()),
                         kFeatureDim});
     for (int d = 0; d < dim; d++) {
-        double diff = (a[d] - b[d]) / stdevs_[d];
+        double diff = (a[d] - b[d]) / index.stdevs[d];
         sum += diff * diff;
     }
     return static_cast<float>(std::sqrt(sum));
@@ -75,7 +213,7 @@ float Classifier::scaledEuclidean(const std::vector<double>& a,
 
 // -----------------------------------------------------------------------------
 float Classifier::cosineDistance(const std::vector<double>& a,
-                                  const std::vector<double>& b) const
+                                 const std::vector<double>& b)
 {
     double dot = 0.0, normA = 0.0, normB = 0.0;
     int dim = std::min({static_cast<int>(a.size()),
@@ -91,56 +229,119 @@ float Classifier::cosineDistance(const std::vector<double>& a,
     return static_cast<float>(1.0 - dot / (std::sqrt(normA) * std::sqrt(normB)));
 }
 
+// -----------------------------------------------------------------------------
+void Classifier::nearest(const Index& index, const std::vector<double>& fv, int k,
+                         int metric, std::vector<std::pair<float, int>>& out)
+{
+    out.clear();
+    static thread_local std::vector<KdTree::Neighbour> hits;   // reused across queries
+    double q[kFeatureDim];
+
+    if (metric != 1) {
+        for (int d = 0; d < kFeatureDim; d++) q[d] = fv[d] / index.stdevs[d];
+        index.euclidTree.knn(q, k, hits);
+        for (const auto& h : hits)
+            out.push_back({static_cast<float>(std::sqrt(h.first)), h.second});
+        return;
+    }
+
+    // Cosine: 1 - cos(a, b) = |a - b|^2 / 2 for unit vectors
+    double norm = 0.0;
+    for (int d = 0; d < kFeatureDim; d++) norm += fv[d] * fv[d];
+    if (norm < 1e-10) {
+        // Zero query: distance 1 to everything
+        for (int row = 0; row < k && row < static_cast<int>(index.rowLabel.size()); row++)
+            out.push_back({1.f, row});
+        return;
+    }
+    norm = std::sqrt(norm);
+    for (int d = 0; d < kFeatureDim; d++) q[d] = fv[d] / norm;
+    index.cosineTree.knn(q, k, hits);
+    for (const auto& h : hits)
+        out.push_back({static_cast<float>(h.first * 0.5), index.cosineRows[h.second]});
+
+    // Zero DB rows sit at distance 1
+    for (int row : index.zeroRows) out.push_back({1.f, row});
+    std::stable_sort(out.begin(), out.end(),
+                     [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+                         return a.first < b.first;
+                     });
+    if (static_cast<int>(out.size()) > k) out.resize(k);
+}
+
 // -----------------------------------------------------------------------------
 ClassifyResult Classifier::classify(const std::vector<double>& fv,
-                                     const PipelineParams& params) const
+                                     const PipelineParams& params,
+                                     bool runnerUp) const
 {
     ClassifyResult result;
-    const auto& entries = db_->entries();
 
-    if (entries.empty()) {
+    // One published index for the whole query
+    const std::shared_ptr<const Index> indexPtr = std::atomic_load(&index_);
+    const Index& index = *indexPtr;
+
+    if (index.labels.empty() || static_cast<int>(fv.size()) < kFeatureDim) {
         result.label     = "no DB";
         result.isUnknown = true;
         return result;
     }
 
-    // --- Compute distance to every DB entry ----------------------------------
-    struct Match {
-        std::string label;
-        float       dist;
-    };
-    std::vector<Match> matches;
-    matches.reserve(entries.size());
-
-    for (const auto& e : entries) {
-        auto dbFv = e.toFeatureVector();
-        float dist = (params.distanceMetric == 1)
-                     ? cosineDistance(fv, dbFv)
-                     : scaledEuclidean(fv, dbFv);
-        matches.push_back({e.label, dist});
-    }
-
-    // Sort by distance ascending
-    std::sort(matches.begin(), matches.end(),
-              [](const Match& a, const Match& b){ return a.dist < b.dist; });
-
-    // --- K-NN majority vote --------------------------------------------------
-    int k = std::min(params.kNeighbors, static_cast<int>(matches.size()));
-    std::map<std::string, int> votes;
-    for (int i = 0; i < k; i++)
-        votes[matches[i].label]++;
-
-    // Find label with most votes (tie → closest distance wins)
-    std::string bestLabel = matches[0].label;
-    int bestVotes = 0;
-    for (const auto& kv : votes) {
-        if (kv.second > bestVotes) {
-            bestVotes = kv.second;
-            bestLabel = kv.first;
+    // Labels are handled as index.labels ids; the string is copied once
+    int   bestLabel  = 0;
+    float bestDist   = 1e9f;
+    float secondDist = 1e9f;
+
+    if (params.nearestCentroid) {
+        // --- Nearest class centroid ------------------------------------------
+        for (size_t li = 0; li < index.labels.size(); li++) {
+            float dist = (params.distanceMetric == 1)
+                         ? cosineDistance(fv, index.cosineCentroids[li])
+                         : scaledEuclidean(index, fv, index.euclidCentroids[li]);
+            if (dist < bestDist) {
+                secondDist = bestDist;
+                bestDist   = dist;
+                bestLabel  = static_cast<int>(li);
+            } else if (dist < secondDist) {
+                secondDist = dist;
+            }
         }
-    }
+    } else {
+        // --- K nearest entries from the search tree --------------------------
+        // A runner-up search looks a little deeper; only the first k vote
+        const int k = std::max(1, params.kNeighbors);
+        static thread_local std::vector<std::pair<float, int>> matches;
+        nearest(index, fv, runnerUp ? std::max(k, kRunnerUpNeighbors) : k,
+                params.distanceMetric, matches);
+        const size_t voters = std::min(matches.size(), static_cast<size_t>(k));
 
-    float bestDist = matches[0].dist;
+        // --- K-NN majority vote ----------------------------------------------
+        static thread_local std::vector<int> votes;
+        votes.assign(index.labels.size(), 0);
+        for (size_t i = 0; i < voters; i++)
+            votes[index.rowLabel[matches[i].second]]++;
+
+        // Most votes; ties go to the first label in name order (as a map did)
+        bestLabel = index.rowLabel[matches[0].second];
+        int bestVotes = 0;
+        for (size_t li = 0; li < votes.size(); li++) {
+            if (votes[li] > bestVotes ||
+                (votes[li] == bestVotes && votes[li] > 0 &&
+                 index.labels[li] < index.labels[bestLabel])) {
+                bestVotes = votes[li];
+                bestLabel = static_cast<int>(li);
+            }
+        }
+
+        bestDist = matches[0].first;
+
+        // Closest entry of another label (matches are sorted by distance)
+        for (const auto& m : matches) {
+            if (index.rowLabel[m.second] != bestLabel) {
+                secondDist = m.first;
+                break;
+            }
+        }
+    }
 
     // --- Confidence = 1 / (1 + distance) ------------------------------------
     float confidence = 1.f / (1.f + bestDist);
@@ -149,10 +350,11 @@ ClassifyResult Classifier::classify(const std::vector<double>& fv,
     // If best distance exceeds threshold → object not in DB
     bool isUnknown = (bestDist > params.confidenceThresh);
 
-    result.label      = isUnknown ? "unknown" : bestLabel;
+    result.label      = isUnknown ? "unknown" : index.labels[bestLabel];
     result.distance   = bestDist;
     result.confidence = confidence;
     result.isUnknown  = isUnknown;
+    result.runnerUp   = runnerUp ? secondDist : 1e9f;
 
     return result;
 }
@@ -161,14 +363,62 @@ ClassifyResult Classifier::classify(const std::vector<double>& fv,
 void Classifier::classifyAll(AppState& state,
                               const PipelineParams& params) const
 {
+    ProfileScope profile(ProfileStage::Classify);
+    AllocScope   allocs(state.regionAllocs);
+
+    static thread_local std::vector<double> fv(kFeatureDim);
+    for (auto& reg : state.regions) {
+        if (!reg.hasShape || !reg.needsClassify) continue;
+
+        fillFeatures(reg, fv);
+        const ClassifyResult result = classify(fv, params);
+
+        reg.label      = result.label;
+        reg.confidence = result.confidence;
+    }
+}
+
+// -----------------------------------------------------------------------------
+Classifier::CascadeCounts Classifier::cascadeAll(AppState& state,
+                                                 const PipelineParams& params) const
+{
+    AllocScope allocs(state.regionAllocs);
+
+    CascadeCounts counts;
+    static thread_local std::vector<double> fv(kFeatureDim);
     for (auto& reg : state.regions) {
-        if (reg.huMoments.empty()) continue;
+        if (!reg.needsClassify) continue;
+        counts.classified++;
+        reg.shapeLabel = false;
+
+        if (!reg.hasShape) {
+            counts.deferred++;
+            continue;
+        }
 
-        DBEntry tmp     = ObjectDB::entryFromRegion(reg, "");
-        auto fv         = tmp.toFeatureVector();
-        auto result     = classify(fv, params);
+        fillFeatures(reg, fv);
+        const ClassifyResult result = classify(fv, params, true);
 
+        // The shape answer is shown until the CNN replaces it
         reg.label      = result.label;
         reg.confidence = result.confidence;
+
+        const bool ambiguous = result.distance > params.cascadeMargin * result.runnerUp;
+        if (!result.isUnknown && !ambiguous &&
+            result.confidence >= params.cascadeConfidence)
+            reg.shapeLabel = true;
+        else
+            counts.deferred++;
     }
+    return counts;
+}
+
+// -----------------------------------------------------------------------------
+void Classifier::fillFeatures(const RegionInfo& reg, std::vector<double>& fv)
+{
+    // Same layout as DBEntry::toFeatureVector: [fillRatio, bboxRatio, hu0..hu6]
+    fv.resize(kFeatureDim);
+    fv[0] = reg.fillRatio;
+    fv[1] = reg.bboxRatio;
+    std::copy(reg.huMoments.begin(), reg.huMoments.end(), fv.begin() + 2);
 }
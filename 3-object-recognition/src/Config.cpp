@@ -0,0 +1,134 @@
+/**
+ * @file    Config.cpp
+ * @brief   Persistent settings implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "Config.h"
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+bool loadConfig(const std::string& path, PipelineParams& params)
+{
+    if (!std::filesystem::exists(path)) return false;
+
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) return false;
+
+        cv::FileNode roi = fs["processRoi"];
+        if (!roi.empty()) roi >> params.processRoi;
+    } catch (const cv::Exception& e) {
+        std::cerr << "[Config] Cannot read " << path << ": " << e.what() << "\n";
+        return false;
+    }
+
+    std::cout << "[Config] Loaded " << path << "\n";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool saveConfig(const std::string& path, const PipelineParams& params)
+{
+    std::filesystem::path p(path);
+    if (p.has_parent_path())
+        std::filesystem::create_directories(p.parent_path());
+
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) return false;
+
+    fs << "processRoi" << params.processRoi;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/**
+ * Call visit(key, field) for every scalar PipelineParams field, in
+ * declaration order (processRoi is handled by the callers).
+ */
+template <typename Params, typename Visit>
+static void forEachParam(Params& p, Visit&& visit)
+{
+    visit("dropFrames",         p.dropFrames);
+    visit("thresholdValue",     p.thresholdValue);
+    visit("blurKernelSize",     p.blurKernelSize);
+    visit("blurMode",           p.blurMode);
+    visit("downscaleLevel",     p.downscaleLevel);
+    visit("useOpenCL",          p.useOpenCL);
+    visit("useAdaptive",        p.useAdaptive);
+    visit("useKMeans",          p.useKMeans);
+    visit("dynamicThresh",      p.dynamicThresh);
+    visit("useSatIntensity",    p.useSatIntensity);
+    visit("morphKernelSize",    p.morphKernelSize);
+    visit("morphIterations",    p.morphIterations);
+    visit("morphMode",          p.morphMode);
+    visit("labelMode",          p.labelMode);
+    visit("streamPipeline",     p.streamPipeline);
+    visit("sparseTiles",        p.sparseTiles);
+    visit("minRegionArea",      p.minRegionArea);
+    visit("maxRegions",         p.maxRegions);
+    visit("trackRegions",       p.trackRegions);
+    visit("trackReclassify",    p.trackReclassify);
+    visit("trackDrift",         p.trackDrift);
+    visit("momentMode",         p.momentMode);
+    visit("showAxes",           p.showAxes);
+    visit("showOrientedBBox",   p.showOrientedBBox);
+    visit("showFeatureText",    p.showFeatureText);
+    visit("kNeighbors",         p.kNeighbors);
+    visit("confidenceThresh",   p.confidenceThresh);
+    visit("distanceMetric",     p.distanceMetric);
+    visit("nearestCentroid",    p.nearestCentroid);
+    visit("embeddingMode",      p.embeddingMode);
+    visit("roiSize",            p.roiSize);
+    visit("dnnBackend",         p.dnnBackend);
+    visit("asyncEmbedding",     p.asyncEmbedding);
+    visit("prototypesPerLabel", p.prototypesPerLabel);
+    visit("embeddingIndex",     p.embeddingIndex);
+    visit("cnnCascade",         p.cnnCascade);
+    visit("cascadeConfidence",  p.cascadeConfidence);
+    visit("cascadeMargin",      p.cascadeMargin);
+    visit("motionGate",         p.motionGate);
+    visit("motionThreshold",    p.motionThreshold);
+    visit("motionRefresh",      p.motionRefresh);
+}
+
+/** FileStorage has no bool: stored as int. */
+static int   storable(bool v)  { return v ? 1 : 0; }
+static int   storable(int v)   { return v; }
+static float storable(float v) { return v; }
+
+static void loadValue(const cv::FileNode& n, bool& v)  { int i = v; n >> i; v = i != 0; }
+static void loadValue(const cv::FileNode& n, int& v)   { n >> v; }
+static void loadValue(const cv::FileNode& n, float& v) { n >> v; }
+
+// -----------------------------------------------------------------------------
+void writeParams(cv::FileStorage& fs, const std::string& name, const PipelineParams& params)
+{
+    fs << name << "{";
+    forEachParam(params, [&](const char* key, const auto& v) { fs << key << storable(v); });
+    fs << "processRoi" << params.processRoi;
+    fs << "}";
+}
+
+// -----------------------------------------------------------------------------
+void readParams(const cv::FileNode& node, PipelineParams& params)
+{
+    if (node.empty() || !node.isMap()) return;
+    forEachParam(params, [&](const char* key, auto& v) {
+        if (!node[key].empty()) loadValue(node[key], v);
+    });
+    if (!node["processRoi"].empty()) node["processRoi"] >> params.processRoi;
+}
+
+// -----------------------------------------------------------------------------
+bool sameParams(const PipelineParams& a, const PipelineParams& b)
+{
+    std::vector<double> va, vb;
+    forEachParam(a, [&](const char*, const auto& v) { va.push_back(static_cast<double>(v)); });
+    forEachParam(b, [&](const char*, const auto& v) { vb.push_back(static_cast<double>(v)); });
+    return va == vb && a.processRoi == b.processRoi;
+}
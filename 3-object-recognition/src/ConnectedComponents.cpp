@@ -2,12 +2,23 @@
  * @file    ConnectedComponents.cpp
  * @brief   From-scratch two-pass connected components implementation.
  *
+ *          Pass 1 runs per row band under cv::parallel_for_; bands own
+ *          disjoint label ranges of one shared UnionFind, so no locking
+ *          is needed until the sequential border merge.  Each band also
+ *          collects its rows' runs; pass 2 relabels runs, not pixels.
+ *
+ *          The sparse variant extracts runs from occupied tiles only and
+ *          unites runs directly, one union-find slot per run.
+ *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
  */
 
 #include "ConnectedComponents.h"
+#include "Profiler.h"
+#include "AllocCounter.h"
 #include <algorithm>
+#include <functional>
 #include <numeric>
 
 // -----------------------------------------------------------------------------
@@ -22,104 +33,504 @@ static const cv::Scalar kPalette[] = {
 static constexpr int kPaletteSize = 16;
 
 // -----------------------------------------------------------------------------
-int twoPassLabel(const cv::Mat& binary, cv::Mat& labelMap)
-{
-    CV_Assert(binary.type() == CV_8UC1);
+// Parallel labeller internals
+// -----------------------------------------------------------------------------
 
-    labelMap = cv::Mat::zeros(binary.size(), CV_32SC1);
+// Fewest rows per band — thinner bands add border merges for no gain
+static constexpr int kMinBandRows = 32;
 
-    // Union-Find — pre-allocate for worst case (half of all pixels)
-    int maxLabels = (binary.rows * binary.cols) / 2 + 2;
-    UnionFind uf(maxLabels);
+/** A horizontal strip labelled independently from its own label range. */
+struct LabelBand {
+    int rowBegin;   ///< First image row
+    int rowEnd;     ///< One past the last image row
+    int firstLabel; ///< First provisional label the band may create
+    int nextLabel;  ///< One past the last provisional label created
+    std::vector<LabelRun> runs; ///< Runs with provisional labels, raster order
+};
 
-    int nextLabel = 1; // 0 is background
+/**
+ * @brief Append the foreground runs of one labelled row.
+ *
+ *        Every pixel of a run is connected to its neighbour, so the
+ *        provisional label of its first pixel stands for the whole run.
+ */
+static void appendRowRuns(const int* lblRow, int cols, int r, std::vector<LabelRun>& runs)
+{
+    for (int c = 0; c < cols;) {
+        if (lblRow[c] == 0) { c++; continue; }
+        const int begin = c;
+        while (c < cols && lblRow[c] != 0) c++;
+        runs.push_back({r, begin, c, lblRow[begin]});
+    }
+}
 
-    // -------------------------------------------------------------------------
-    // Pass 1 — assign provisional labels, record equivalences
-    // -------------------------------------------------------------------------
-    for (int r = 0; r < binary.rows; r++) {
-        const uchar*  binRow = binary.ptr<uchar>(r);
-        int*          lblRow = labelMap.ptr<int>(r);
+/**
+ * @brief Pass 1 over rows [rowBegin, rowEnd) — 4-connected pixel scan.
+ *
+ *        binary holds image row r at r - binaryRow0.  Rows above bandTop
+ *        are not looked at; those equivalences are restored by the border
+ *        merge (or the rows belong to an earlier StreamLabeler band).
+ */
+static void labelRowsPixels(const cv::Mat& binary, int binaryRow0, cv::Mat& labelMap,
+                            UnionFind& uf, int rowBegin, int rowEnd, int bandTop,
+                            int& next, std::vector<LabelRun>& runs)
+{
+    for (int r = rowBegin; r < rowEnd; r++) {
+        const uchar* binRow = binary.ptr<uchar>(r - binaryRow0);
+        int*         lblRow = labelMap.ptr<int>(r);
+        const int*   upRow  = (r > bandTop) ? labelMap.ptr<int>(r-1) : nullptr;
 
-        for (int c = 0; c < binary.cols; c++) {
-            if (binRow[c] == 0) continue; // background pixel — skip
+        for (int c = 0; c < labelMap.cols; c++) {
+            if (binRow[c] == 0) { lblRow[c] = 0; continue; }
 
-            // Collect labels from already-visited 4-connected neighbours
-            // (left and top only — we scan left-to-right, top-to-bottom)
-            int left = (c > 0)             ? labelMap.at<int>(r,   c-1) : 0;
-            int top  = (r > 0)             ? labelMap.at<int>(r-1, c  ) : 0;
+            int left = (c > 0) ? lblRow[c-1] : 0;
+            int top  = upRow   ? upRow[c]    : 0;
 
             if (left == 0 && top == 0) {
-                // No labelled neighbours — assign new label
-                lblRow[c] = nextLabel++;
-            } else if (left != 0 && top == 0) {
+                lblRow[c] = uf.makeSet(next++);
+            } else if (top == 0) {
                 lblRow[c] = left;
-            } else if (left == 0 && top != 0) {
-                lblRow[c] = top;
             } else {
-                // Both neighbours labelled — use smaller root, record equivalence
-                int rootL = uf.find(left);
-                int rootT = uf.find(top);
-                lblRow[c] = std::min(rootL, rootT);
-                if (rootL != rootT) uf.unite(rootL, rootT);
+                // Inside a run left == top after the first pixel — skip find()
+                lblRow[c] = top;
+                if (left != 0 && left != top) uf.unite(left, top);
             }
         }
+        appendRowRuns(lblRow, labelMap.cols, r, runs);
     }
+}
+
+/**
+ * @brief Unite the label of 2x2 block (r, c) with the blocks above it.
+ *
+ *        With 8-connectivity only image row r-1 decides the links: the top
+ *        block Q touches X through its bottom pixels, the top-left block P
+ *        only through its corner pixel, the top-right block R likewise.  P
+ *        and R are skipped when their corner pixel is adjacent to a Q pixel
+ *        that already linked — the decision-tree shortcut of Grana et al.
+ *        Foreground pixels of row r-1 carry their block's label.
+ *
+ * @return  Label of X after the unions (label unchanged when no link).
+ */
+static int joinBlockAbove(const cv::Mat& labelMap, UnionFind& uf,
+                          int r, int c, bool x00, bool x01, int label)
+{
+    const int* up  = labelMap.ptr<int>(r-1);
+    const bool q10 = up[c] > 0;
+    const bool q11 = c + 1 < labelMap.cols && up[c+1] > 0;
+
+    auto join = [&](int other) {
+        if (label == 0)           label = other;
+        else if (label != other)  label = uf.unite(label, other);
+    };
+
+    const bool qLink = (x00 || x01) && (q10 || q11);
+    if (qLink) join(q10 ? up[c] : up[c+1]);
+    if (x00 && c > 0 && up[c-1] > 0 && !(qLink && q10))
+        join(up[c-1]);
+    if (x01 && c + 2 < labelMap.cols && up[c+2] > 0 && !(qLink && q11))
+        join(up[c+2]);
+    return label;
+}
+
+/**
+ * @brief Pass 1 over rows [rowBegin, rowEnd) — 8-connected 2x2 block scan.
+ *
+ *        One provisional label per block, written to the block's foreground
+ *        pixels (background stays 0), so pass 2 is the same as for pixels.
+ *        rowBegin and bandTop must be even so blocks never straddle bands.
+ */
+static void labelRowsBlocks(const cv::Mat& binary, int binaryRow0, cv::Mat& labelMap,
+                            UnionFind& uf, int rowBegin, int rowEnd, int bandTop,
+                            int& next, std::vector<LabelRun>& runs)
+{
+    const int cols = labelMap.cols;
+    for (int r = rowBegin; r < rowEnd; r += 2) {
+        const bool   pair = r + 1 < rowEnd;
+        const uchar* row0 = binary.ptr<uchar>(r - binaryRow0);
+        const uchar* row1 = pair ? binary.ptr<uchar>(r + 1 - binaryRow0) : nullptr;
+        int*         lbl0 = labelMap.ptr<int>(r);
+        int*         lbl1 = pair ? labelMap.ptr<int>(r+1) : nullptr;
+
+        for (int c = 0; c < cols; c += 2) {
+            const bool hasC1 = c + 1 < cols;
+            const bool x00 = row0[c] != 0;
+            const bool x01 = hasC1 && row0[c+1] != 0;
+            const bool x10 = row1 && row1[c] != 0;
+            const bool x11 = row1 && hasC1 && row1[c+1] != 0;
+
+            int label = 0;
+            if (x00 || x01 || x10 || x11) {
+                if (r > bandTop)
+                    label = joinBlockAbove(labelMap, uf, r, c, x00, x01, label);
+
+                // Left block S touches X through its right column
+                if (c > 0 && (x00 || x10) && (row0[c-1] || (row1 && row1[c-1]))) {
+                    int left = row0[c-1] ? lbl0[c-1] : lbl1[c-1];
+                    if (label == 0)          label = left;
+                    else if (label != left)  label = uf.unite(label, left);
+                }
+                if (label == 0) label = uf.makeSet(next++);
+            }
 
+            lbl0[c] = x00 ? label : 0;
+            if (hasC1) lbl0[c+1] = x01 ? label : 0;
+            if (row1) {
+                lbl1[c] = x10 ? label : 0;
+                if (hasC1) lbl1[c+1] = x11 ? label : 0;
+            }
+        }
+        appendRowRuns(lbl0, cols, r, runs);
+        if (lbl1) appendRowRuns(lbl1, cols, r + 1, runs);
+    }
+}
+
+/** Record equivalences between image row r and the row above it. */
+static void mergeBorder(cv::Mat& labelMap, UnionFind& uf, int r, bool blocks)
+{
+    const int* lblRow = labelMap.ptr<int>(r);
+    if (blocks) {
+        for (int c = 0; c < labelMap.cols; c += 2) {
+            const bool x00 = lblRow[c] > 0;
+            const bool x01 = c + 1 < labelMap.cols && lblRow[c+1] > 0;
+            if (x00 || x01)
+                joinBlockAbove(labelMap, uf, r, c, x00, x01, x00 ? lblRow[c] : lblRow[c+1]);
+        }
+    } else {
+        const int* upRow = labelMap.ptr<int>(r-1);
+        for (int c = 0; c < labelMap.cols; c++) {
+            if (lblRow[c] != 0 && upRow[c] != 0 && lblRow[c] != upRow[c])
+                uf.unite(lblRow[c], upRow[c]);
+        }
+    }
+}
+
+/**
+ * @brief Map each provisional label in [first, next) to a compact id.
+ *
+ *        Ranges must be visited in raster order; ascending provisional
+ *        labels then reach components in raster order of first pixel.
+ */
+static void compactRange(UnionFind& uf, int first, int next,
+                         std::vector<int>& labelRemap, int& compactId)
+{
+    for (int lbl = first; lbl < next; lbl++) {
+        int root = uf.find(lbl);
+        if (labelRemap[root] == 0) labelRemap[root] = ++compactId;
+        labelRemap[lbl] = labelRemap[root];
+    }
+}
+
+/** Pass 2 — append runs to out with provisional labels replaced by compact ids. */
+static void relabelRuns(const std::vector<LabelRun>& runs,
+                        const std::vector<int>& labelRemap, std::vector<LabelRun>& out)
+{
+    for (const LabelRun& run : runs)
+        out.push_back({run.row, run.colBegin, run.colEnd, labelRemap[run.label]});
+}
+
+/** Default a reused region slot, keeping its label and embedding buffers. */
+static void resetRegion(RegionInfo& reg)
+{
+    std::vector<float> embedding;
+    std::string        label;
+    embedding.swap(reg.embedding);
+    label.swap(reg.label);
+    reg = RegionInfo();
+    embedding.clear();
+    label = reg.label;            // "unknown" into the old buffer
+    reg.embedding.swap(embedding);
+    reg.label.swap(label);
+}
+
+/** Worst-case provisional labels for h x w (checkerboard, or one per block). */
+static int labelCapacity(int h, int w, bool blocks)
+{
+    return blocks ? ((h + 1) / 2) * ((w + 1) / 2) : (h * w + 1) / 2;
+}
+
+// -----------------------------------------------------------------------------
+int twoPassLabel(const cv::Mat& binary, RegionRuns& runs, int labelMode)
+{
+    ProfileScope profile(ProfileStage::Labeling);
+    CV_Assert(binary.type() == CV_8UC1);
+
+    runs.size      = binary.size();
+    runs.numLabels = 0;
+    runs.runs.clear();
+    if (binary.empty()) return 0;
+
+    const bool blocks = (labelMode == 1);
+
+    // -------------------------------------------------------------------------
+    // Partition into bands, each with a label range sized for its worst case
     // -------------------------------------------------------------------------
-    // Pass 2 — replace every label with its canonical root
+    int bandCount = (labelMode == 2) ? 1
+        : std::max(1, std::min(cv::getNumThreads(), binary.rows / kMinBandRows));
+    int bandRows = (binary.rows + bandCount - 1) / bandCount;
+    if (blocks) bandRows += bandRows % 2;
+    bandCount = (binary.rows + bandRows - 1) / bandRows;
+
+    // Bands keep their run buffers from frame to frame
+    static thread_local std::vector<LabelBand> bandCache;
+    std::vector<LabelBand>& bands = bandCache;
+    bands.resize(bandCount);
+    int capacity = 1; // 0 is background
+    for (int b = 0; b < bandCount; b++) {
+        LabelBand& band = bands[b];
+        band.runs.clear();
+        band.rowBegin   = b * bandRows;
+        band.rowEnd     = std::min(binary.rows, band.rowBegin + bandRows);
+        band.firstLabel = band.nextLabel = capacity;
+        capacity += labelCapacity(band.rowEnd - band.rowBegin, binary.cols, blocks);
+    }
+
+    // Reused across frames; slots are initialised lazily by makeSet, and
+    // every label map pixel is written by pass 1.  Bound to references so
+    // worker threads see this thread's instances.
+    static thread_local UnionFind cache;
+    static thread_local cv::Mat   scratch;
+    UnionFind& uf       = cache;
+    cv::Mat&   labelMap = scratch;
+    uf.allocate(capacity);
+    labelMap.create(binary.size(), CV_32SC1);
+
     // -------------------------------------------------------------------------
-    // Build compact re-numbering: root → sequential id
-    std::vector<int> labelRemap(nextLabel, 0);
+    // Pass 1 — label bands concurrently, each in its own label range
+    // -------------------------------------------------------------------------
+    const auto pass1 = [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; b++) {
+            LabelBand& band = bands[b];
+            if (blocks)
+                labelRowsBlocks(binary, 0, labelMap, uf, band.rowBegin, band.rowEnd,
+                                band.rowBegin, band.nextLabel, band.runs);
+            else
+                labelRowsPixels(binary, 0, labelMap, uf, band.rowBegin, band.rowEnd,
+                                band.rowBegin, band.nextLabel, band.runs);
+        }
+    };
+    cv::parallel_for_(cv::Range(0, bandCount), std::cref(pass1));   // by reference: no heap copy
+
+    // -------------------------------------------------------------------------
+    // Merge — record equivalences across each band's top border
+    // -------------------------------------------------------------------------
+    for (int b = 1; b < bandCount; b++)
+        mergeBorder(labelMap, uf, bands[b].rowBegin, blocks);
+
+    // -------------------------------------------------------------------------
+    // Pass 2 — compact ids in order of first appearance, applied to the runs
+    // -------------------------------------------------------------------------
+    static thread_local std::vector<int> remapCache;
+    std::vector<int>& labelRemap = remapCache;
+    labelRemap.assign(capacity, 0);
     int compactId = 0;
-    for (int lbl = 1; lbl < nextLabel; lbl++) {
-        if (uf.find(lbl) == lbl) labelRemap[lbl] = ++compactId;
+    size_t runCount = 0;
+    for (const LabelBand& band : bands) {
+        compactRange(uf, band.firstLabel, band.nextLabel, labelRemap, compactId);
+        runCount += band.runs.size();
     }
-    // Propagate remap through non-root labels
-    for (int lbl = 1; lbl < nextLabel; lbl++) {
-        labelRemap[lbl] = labelRemap[uf.find(lbl)];
+    runs.runs.reserve(runCount);
+    for (const LabelBand& band : bands)
+        relabelRuns(band.runs, labelRemap, runs.runs);
+
+    runs.numLabels = compactId;
+    return compactId; // number of foreground components
+}
+
+// -----------------------------------------------------------------------------
+// Sparse labelling over occupied tiles
+// -----------------------------------------------------------------------------
+
+// Above this share of occupied tiles the dense scan is as cheap
+static constexpr double kSparseMaxTileFraction = 0.5;
+
+/**
+ * @brief Append the foreground runs of row r inside the given tile spans.
+ *
+ *        Spans are maximal and separated by empty tiles, so a run never
+ *        crosses a span boundary.  Labels are set to the run's index.
+ */
+static void appendTileRuns(const uchar* row, int r, int cols,
+                           const std::vector<cv::Range>& spans, std::vector<LabelRun>& runs)
+{
+    const int shift = cvcore::TileOccupancy::kTileShift;
+    for (const cv::Range& span : spans) {
+        const int end = std::min(span.end << shift, cols);
+        for (int c = span.start << shift; c < end;) {
+            if (row[c] == 0) { c++; continue; }
+            const int begin = c;
+            while (c < end && row[c] != 0) c++;
+            runs.push_back({r, begin, c, static_cast<int>(runs.size())});
+        }
     }
+}
 
-    // Apply remap to labelMap
-    for (int r = 0; r < labelMap.rows; r++) {
-        int* row = labelMap.ptr<int>(r);
-        for (int c = 0; c < labelMap.cols; c++) {
-            if (row[c] > 0) row[c] = labelRemap[row[c]];
+/**
+ * @brief Order key of a run's first pixel, or its first 2x2 block.
+ *
+ *        The dense scan numbers components by the smallest of these over
+ *        their runs (provisional labels grow in scan order).
+ */
+static uint64_t runOrderKey(const LabelRun& run, bool blocks)
+{
+    const int shift = blocks ? 1 : 0;
+    return (uint64_t(run.row >> shift) << 32) | uint32_t(run.colBegin >> shift);
+}
+
+// -----------------------------------------------------------------------------
+int twoPassLabel(const cv::Mat& binary, RegionRuns& runs, int labelMode,
+                 const cvcore::TileOccupancy& tiles)
+{
+    CV_Assert(binary.type() == CV_8UC1);
+    if (tiles.size() != binary.size() || tiles.fraction() > kSparseMaxTileFraction)
+        return twoPassLabel(binary, runs, labelMode);
+
+    ProfileScope profile(ProfileStage::Labeling);
+    runs.size      = binary.size();
+    runs.numLabels = 0;
+    runs.runs.clear();
+    if (binary.empty()) return 0;
+
+    const bool blocks = (labelMode == 1);
+    const int  touch  = blocks ? 1 : 0;   // 8-connected runs also meet at corners
+
+    // Runs of the occupied tiles, in raster order; label = run index for now
+    static thread_local std::vector<cv::Range> spanCache;
+    std::vector<cv::Range>& spans = spanCache;
+    std::vector<LabelRun>&  out   = runs.runs;
+    for (int ty = 0; ty < tiles.tileRows(); ty++) {
+        tiles.spans(ty, spans);
+        if (spans.empty()) continue;
+        const cv::Rect band = tiles.pixelRect(ty, 0, tiles.tileCols());
+        for (int r = band.y; r < band.y + band.height; r++)
+            appendTileRuns(binary.ptr<uchar>(r), r, binary.cols, spans, out);
+    }
+
+    // Unite each run with the runs of the row above that it touches
+    static thread_local UnionFind ufCache;
+    UnionFind& uf = ufCache;
+    const int  n  = static_cast<int>(out.size());
+    uf.allocate(n);
+    for (int i = 0; i < n; i++) uf.makeSet(i);
+
+    int prevBegin = 0, prevEnd = 0;
+    for (int i = 0; i < n;) {
+        const int r = out[i].row;
+        int rowEnd = i;
+        while (rowEnd < n && out[rowEnd].row == r) rowEnd++;
+        if (i == 0 || out[i - 1].row != r - 1) prevBegin = prevEnd = i;
+
+        int j = prevBegin;
+        for (int k = i; k < rowEnd; k++) {
+            while (j < prevEnd && out[j].colEnd + touch <= out[k].colBegin) j++;
+            for (int m = j; m < prevEnd && out[m].colBegin < out[k].colEnd + touch; m++)
+                uf.unite(k, m);
         }
+        prevBegin = i;
+        prevEnd   = rowEnd;
+        i         = rowEnd;
     }
 
-    return compactId; // number of foreground components
+    // Number components by first pixel (block), as the dense scan does
+    static thread_local std::vector<uint64_t> keyCache;
+    static thread_local std::vector<int>      rootCache, remapCache;
+    std::vector<uint64_t>& firstKey = keyCache;
+    std::vector<int>&      roots    = rootCache;
+    std::vector<int>&      remap    = remapCache;
+    firstKey.assign(n, UINT64_MAX);
+    roots.clear();
+    for (int i = 0; i < n; i++) {
+        const int root = uf.find(i);
+        if (root == i) roots.push_back(i);
+        firstKey[root] = std::min(firstKey[root], runOrderKey(out[i], blocks));
+    }
+    std::sort(roots.begin(), roots.end(),
+              [&](int a, int b) { return firstKey[a] < firstKey[b]; });
+    remap.assign(n, 0);
+    for (size_t id = 0; id < roots.size(); id++) remap[roots[id]] = static_cast<int>(id) + 1;
+    for (LabelRun& run : out) run.label = remap[uf.find(run.label)];
+
+    runs.numLabels = static_cast<int>(roots.size());
+    return runs.numLabels;
+}
+
+// -----------------------------------------------------------------------------
+void StreamLabeler::begin(cv::Size size, int labelMode, RegionRuns& out)
+{
+    out.size      = size;
+    out.numLabels = 0;
+    out.runs.clear();
+    out_       = &out;
+    labelMap_.create(size, CV_32SC1);
+    blocks_    = (labelMode == 1);
+    nextLabel_ = 1;
+    uf_.allocate(1 + labelCapacity(size.height, size.width, blocks_));
+}
+
+// -----------------------------------------------------------------------------
+void StreamLabeler::addRows(const cv::Mat& rows, int rowBegin)
+{
+    CV_Assert(out_ && rows.type() == CV_8UC1 && rows.cols == labelMap_.cols);
+    CV_Assert(!blocks_ || rowBegin % 2 == 0);
+
+    // One band spanning the whole frame: rows above rowBegin are already
+    // labelled.  Runs collect in out_ with provisional labels until finish().
+    const int rowEnd = std::min(labelMap_.rows, rowBegin + rows.rows);
+    if (blocks_)
+        labelRowsBlocks(rows, rowBegin, labelMap_, uf_, rowBegin, rowEnd, 0, nextLabel_,
+                        out_->runs);
+    else
+        labelRowsPixels(rows, rowBegin, labelMap_, uf_, rowBegin, rowEnd, 0, nextLabel_,
+                        out_->runs);
+}
+
+// -----------------------------------------------------------------------------
+int StreamLabeler::finish()
+{
+    CV_Assert(out_);
+    std::vector<int> labelRemap(nextLabel_, 0);
+    int compactId = 0;
+    compactRange(uf_, 1, nextLabel_, labelRemap, compactId);
+    for (LabelRun& run : out_->runs) run.label = labelRemap[run.label];
+
+    out_->numLabels = compactId;
+    out_ = nullptr;
+    return compactId;
 }
 
 // -----------------------------------------------------------------------------
-void computeRegionStats(const cv::Mat& labelMap, int numLabels,
+void computeRegionStats(const RegionRuns& runs,
                         std::vector<int>&         areas,
                         std::vector<cv::Point2f>& centroids,
                         std::vector<cv::Rect>&    bboxes)
 {
     // Index 0 = background, indices 1..numLabels = regions
+    const int numLabels = runs.numLabels;
     areas    .assign(numLabels + 1, 0);
     centroids.assign(numLabels + 1, {0.f, 0.f});
     bboxes   .assign(numLabels + 1, {0, 0, 0, 0});
 
     // Accumulate sum of coordinates for centroid, track bbox extents
-    std::vector<int> minR(numLabels+1, INT_MAX), maxR(numLabels+1, INT_MIN);
-    std::vector<int> minC(numLabels+1, INT_MAX), maxC(numLabels+1, INT_MIN);
-    std::vector<double> sumR(numLabels+1, 0.0), sumC(numLabels+1, 0.0);
+    // (scratch reused across frames)
+    static thread_local std::vector<int>    minR, maxR, minC, maxC;
+    static thread_local std::vector<double> sumR, sumC;
+    minR.assign(numLabels + 1, INT_MAX);
+    maxR.assign(numLabels + 1, INT_MIN);
+    minC.assign(numLabels + 1, INT_MAX);
+    maxC.assign(numLabels + 1, INT_MIN);
+    sumR.assign(numLabels + 1, 0.0);
+    sumC.assign(numLabels + 1, 0.0);
 
-    for (int r = 0; r < labelMap.rows; r++) {
-        const int* row = labelMap.ptr<int>(r);
-        for (int c = 0; c < labelMap.cols; c++) {
-            int lbl = row[c];
-            if (lbl == 0) continue;
-            areas[lbl]++;
-            sumR[lbl] += r;
-            sumC[lbl] += c;
-            minR[lbl] = std::min(minR[lbl], r);
-            maxR[lbl] = std::max(maxR[lbl], r);
-            minC[lbl] = std::min(minC[lbl], c);
-            maxC[lbl] = std::max(maxC[lbl], c);
-        }
+    for (const LabelRun& run : runs.runs) {
+        const int lbl = run.label;
+        const int n   = run.colEnd - run.colBegin;
+        areas[lbl] += n;
+        sumR[lbl]  += static_cast<double>(run.row) * n;
+        sumC[lbl]  += (run.colBegin + run.colEnd - 1) * 0.5 * n;
+        minR[lbl] = std::min(minR[lbl], run.row);
+        maxR[lbl] = std::max(maxR[lbl], run.row);
+        minC[lbl] = std::min(minC[lbl], run.colBegin);
+        maxC[lbl] = std::max(maxC[lbl], run.colEnd - 1);
     }
 
     for (int lbl = 1; lbl <= numLabels; lbl++) {
@@ -133,57 +544,58 @@ void computeRegionStats(const cv::Mat& labelMap, int numLabels,
 }
 
 // -----------------------------------------------------------------------------
-void buildRegionDisplay(const cv::Mat& labelMap,
+void buildRegionDisplay(const RegionRuns& runs,
                         const std::vector<RegionInfo>& regions,
                         cv::Mat& dst)
 {
-    dst = cv::Mat::zeros(labelMap.size(), CV_8UC3);
+    dst = cv::Mat::zeros(runs.size, CV_8UC3);
 
-    // Build a fast id→color lookup
-    // Max label id won't exceed labelMap pixel max
-    double maxVal;
-    cv::minMaxLoc(labelMap, nullptr, &maxVal);
-    int maxLbl = static_cast<int>(maxVal);
-    std::vector<cv::Scalar> colorMap(maxLbl + 1, cv::Scalar(0,0,0));
-
-    for (const auto& reg : regions)
-        if (reg.id <= maxLbl) colorMap[reg.id] = reg.displayColor;
+    // Fast id→color lookup; labels of filtered-out regions stay black
+    static thread_local std::vector<cv::Vec3b> colorMap;
+    static thread_local std::vector<bool>      shown;
+    colorMap.assign(runs.numLabels + 1, cv::Vec3b(0, 0, 0));
+    shown.assign(runs.numLabels + 1, false);
+    for (const auto& reg : regions) {
+        if (reg.id <= 0 || reg.id > runs.numLabels) continue;
+        const cv::Scalar& col = reg.displayColor;
+        colorMap[reg.id] = { static_cast<uchar>(col[0]),
+                             static_cast<uchar>(col[1]),
+                             static_cast<uchar>(col[2]) };
+        shown[reg.id] = true;
+    }
 
-    for (int r = 0; r < labelMap.rows; r++) {
-        const int* lblRow = labelMap.ptr<int>(r);
-        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(r);
-        for (int c = 0; c < labelMap.cols; c++) {
-            int lbl = lblRow[c];
-            if (lbl == 0 || lbl > maxLbl) continue;
-            const cv::Scalar& col = colorMap[lbl];
-            dstRow[c] = { static_cast<uchar>(col[0]),
-                          static_cast<uchar>(col[1]),
-                          static_cast<uchar>(col[2]) };
-        }
+    // One fill per run
+    for (const LabelRun& run : runs.runs) {
+        if (!shown[run.label]) continue;
+        cv::Vec3b* dstRow = dst.ptr<cv::Vec3b>(run.row);
+        std::fill(dstRow + run.colBegin, dstRow + run.colEnd, colorMap[run.label]);
     }
 }
 
 // -----------------------------------------------------------------------------
-void findRegions(const cv::Mat& cleaned, AppState& state,
-                 const PipelineParams& params, cv::Mat& labelMap)
+void collectRegions(const RegionRuns& runs, AppState& state,
+                    const PipelineParams& params, bool buildDisplay)
 {
-    state.regions.clear();
+    AllocScope allocs(state.regionAllocs);
 
-    // --- Two-pass labeling ---------------------------------------------------
-    int numLabels = twoPassLabel(cleaned, labelMap);
+    // Fixed-capacity arena: slots are reset in place below
+    state.regions.reserve(std::max(1, params.maxRegions));
+    const int numLabels = runs.numLabels;
     if (numLabels == 0) {
-        state.frameRegions = cv::Mat::zeros(cleaned.size(), CV_8UC3);
+        state.regions.clear();
+        if (buildDisplay) state.frameRegions = cv::Mat::zeros(runs.size, CV_8UC3);
+        else              state.frameRegions.release();
         return;
     }
 
-    // --- Compute stats -------------------------------------------------------
-    std::vector<int>         areas;
-    std::vector<cv::Point2f> centroids;
-    std::vector<cv::Rect>    bboxes;
-    computeRegionStats(labelMap, numLabels, areas, centroids, bboxes);
-
+    // --- Compute stats (scratch reused across frames) ------------------------
+    static thread_local std::vector<int>         areas;
+    static thread_local std::vector<cv::Point2f> centroids;
+    static thread_local std::vector<cv::Rect>    bboxes;
+    static thread_local std::vector<int>         validIds;
+    computeRegionStats(runs, areas, centroids, bboxes);
     // --- Filter by min area, sort by area descending -------------------------
-    std::vector<int> validIds;
+    validIds.clear();
     for (int lbl = 1; lbl <= numLabels; lbl++) {
         if (areas[lbl] >= params.minRegionArea)
             validIds.push_back(lbl);
@@ -195,17 +607,37 @@ void findRegions(const cv::Mat& cleaned, AppState& state,
     int keep = std::min(static_cast<int>(validIds.size()), params.maxRegions);
 
     // --- Populate RegionInfo -------------------------------------------------
+    state.regions.resize(keep);
     for (int i = 0; i < keep; i++) {
         int lbl = validIds[i];
-        RegionInfo reg;
+        RegionInfo& reg = state.regions[i];
+        resetRegion(reg);
         reg.id           = lbl;
         reg.boundingBox  = bboxes[lbl];
         reg.centroid     = centroids[lbl];
         reg.area         = static_cast<double>(areas[lbl]);
         reg.displayColor = kPalette[i % kPaletteSize];
-        state.regions.push_back(reg);
     }
 
     // --- Build color display image -------------------------------------------
-    buildRegionDisplay(labelMap, state.regions, state.frameRegions);
-}
\ No newline at end of file
+    if (buildDisplay) buildRegionDisplay(runs, state.regions, state.frameRegions);
+    else              state.frameRegions.release();
+}
+
+// -----------------------------------------------------------------------------
+void findRegions(const cv::Mat& cleaned, AppState& state,
+                 const PipelineParams& params, RegionRuns& runs)
+{
+    // --- Two-pass labeling ---------------------------------------------------
+    twoPassLabel(cleaned, runs, params.labelMode);
+    collectRegions(runs, state, params);
+}
+
+// -----------------------------------------------------------------------------
+void findRegions(const cv::Mat& cleaned, AppState& state,
+                 const PipelineParams& params, RegionRuns& runs,
+                 const cvcore::TileOccupancy& tiles)
+{
+    twoPassLabel(cleaned, runs, params.labelMode, tiles);
+    collectRegions(runs, state, params);
+}
@@ -8,12 +8,29 @@
 
 #include "Embedding.h"
 #include "utilities.h"
+#include "Profiler.h"
+#include "TaskScheduler.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <numeric>
 #include <filesystem>
+#include <cmath>
+#include <cstdint>
+
+static const char kBinaryMagic[4] = {'E', 'M', 'B', '1'};
+
+/// Below this many rows a linear scan beats the graph
+static const int kIndexMinRows = 2048;
+/// Graph candidates re-ranked by the exact metric
+static const int kIndexEf      = 64;
+
+/** Sibling of a path with another extension (e.g. .bin → .csv). */
+static std::string withExtension(const std::string& path, const char* ext)
+{
+    return std::filesystem::path(path).replace_extension(ext).string();
+}
 
 // =============================================================================
 // EmbeddingDB
@@ -22,18 +39,111 @@ EmbeddingDB::EmbeddingDB(const std::string& filepath)
     : filepath_(filepath)
 {
     std::ifstream f(filepath_);
-    if (f.good()) load();
+    std::ifstream legacy(withExtension(filepath_, ".csv"));
+    if (f.good() || legacy.good()) load();
+}
+
+// -----------------------------------------------------------------------------
+EmbeddingDB::~EmbeddingDB()
+{
+    flushIndex();
+}
+
+// -----------------------------------------------------------------------------
+bool EmbeddingDB::open(const std::string& filepath)
+{
+    flushIndex();
+    filepath_ = filepath;
+    std::ifstream f(filepath_);
+    std::ifstream legacy(withExtension(filepath_, ".csv"));
+    if (f.good() || legacy.good()) return load();
+    clear();
+    std::cout << "[EmbeddingDB] New database " << filepath_ << "\n";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::addRow(const EmbeddingEntry& entry)
+{
+    const int n = static_cast<int>(entry.embedding.size());
+    if (n == 0 || (!unit_.empty() && n != unit_.cols)) return;
+
+    cv::Mat row(1, n, CV_32F);
+    float norm = std::sqrt(dotProduct(entry.embedding.data(),
+                                      entry.embedding.data(), n));
+    const float inv = norm > 0.f ? 1.f / norm : 0.f;
+    for (int d = 0; d < n; d++) row.at<float>(0, d) = entry.embedding[d] * inv;
+    unit_.push_back(row);
+    norms_.push_back(norm);
+
+    auto it = std::find(labels_.begin(), labels_.end(), entry.label);
+    if (it == labels_.end()) it = labels_.insert(labels_.end(), entry.label);
+    labelIdx_.push_back(static_cast<int>(it - labels_.begin()));
 }
 
 // -----------------------------------------------------------------------------
 bool EmbeddingDB::load()
 {
-    std::ifstream file(filepath_);
+    flushIndex();
+    clear();
+
+    bool ok;
+    if (std::filesystem::path(filepath_).extension() == ".csv") {
+        ok = loadCsv(filepath_);
+    } else if (std::ifstream(filepath_).good()) {
+        ok = loadBinary(filepath_);
+    } else {
+        // One-time import of the legacy CSV database
+        const std::string csv = withExtension(filepath_, ".csv");
+        ok = loadCsv(csv);
+        if (ok && !empty() && save())
+            std::cout << "[EmbeddingDB] Converted " << csv << " to "
+                      << filepath_ << "\n";
+    }
+    if (!ok) return false;
+
+    std::cout << "[EmbeddingDB] Loaded " << size()
+              << " entries from " << filepath_ << "\n";
+    if (indexed_) syncIndex();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool EmbeddingDB::loadBinary(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
     if (!file.is_open()) return false;
 
-    entries_.clear();
-    std::string line;
+    char    magic[4];
+    int32_t dim = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&dim), sizeof(dim));
+    if (!file || !std::equal(magic, magic + 4, kBinaryMagic) || dim <= 0) {
+        std::cerr << "[EmbeddingDB] Not an embedding DB: " << path << "\n";
+        return false;
+    }
+
+    EmbeddingEntry e;
+    e.embedding.resize(dim);
+    uint16_t len = 0;
+    while (file.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+        e.label.resize(len);
+        file.read(&e.label[0], len);
+        file.read(reinterpret_cast<char*>(e.embedding.data()),
+                  static_cast<std::streamsize>(dim) * sizeof(float));
+        if (!file) break; // truncated trailing record
+        addRow(e);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool EmbeddingDB::loadCsv(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
 
+    std::string line;
     while (std::getline(file, line)) {
         if (line.empty() || line.find("label") == 0) continue;
 
@@ -49,15 +159,30 @@ bool EmbeddingDB::load()
             catch (...) {}
         }
 
-        if (!e.embedding.empty())
-            entries_.push_back(e);
+        addRow(e);
     }
-
-    std::cout << "[EmbeddingDB] Loaded " << entries_.size()
-              << " entries from " << filepath_ << "\n";
     return true;
 }
 
+// -----------------------------------------------------------------------------
+/** Write one binary record. */
+static void writeRecord(std::ofstream& file, const EmbeddingEntry& e)
+{
+    const uint16_t len = static_cast<uint16_t>(std::min<size_t>(e.label.size(), 0xFFFF));
+    file.write(reinterpret_cast<const char*>(&len), sizeof(len));
+    file.write(e.label.data(), len);
+    file.write(reinterpret_cast<const char*>(e.embedding.data()),
+               static_cast<std::streamsize>(e.embedding.size() * sizeof(float)));
+}
+
+/** Write the file header. */
+static void writeHeader(std::ofstream& file, int dim)
+{
+    const int32_t d = dim;
+    file.write(kBinaryMagic, 4);
+    file.write(reinterpret_cast<const char*>(&d), sizeof(d));
+}
+
 // -----------------------------------------------------------------------------
 bool EmbeddingDB::save() const
 {
@@ -65,27 +190,26 @@ bool EmbeddingDB::save() const
     if (p.has_parent_path())
         std::filesystem::create_directories(p.parent_path());
 
-    std::ofstream file(filepath_);
+    std::ofstream file(filepath_, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) return false;
 
-    file << "label";
-    if (!entries_.empty())
-        for (size_t i = 0; i < entries_[0].embedding.size(); i++)
-            file << ",e" << i;
-    file << "\n";
-
-    for (const auto& e : entries_) {
-        file << e.label;
-        for (float v : e.embedding)
-            file << "," << v;
-        file << "\n";
-    }
-    return true;
+    writeHeader(file, dim());
+    for (int i = 0; i < size(); i++)
+        writeRecord(file, entry(i));
+    flushIndex();
+    return static_cast<bool>(file);
 }
 
 // -----------------------------------------------------------------------------
 bool EmbeddingDB::append(const EmbeddingEntry& entry)
 {
+    if (entry.embedding.empty()) return false;
+    if (!empty() && static_cast<int>(entry.embedding.size()) != dim()) {
+        std::cerr << "[EmbeddingDB] Dimension mismatch: "
+                  << entry.embedding.size() << " vs " << dim() << "\n";
+        return false;
+    }
+
     std::filesystem::path p(filepath_);
     if (p.has_parent_path())
         std::filesystem::create_directories(p.parent_path());
@@ -93,43 +217,313 @@ bool EmbeddingDB::append(const EmbeddingEntry& entry)
     bool needsHeader = true;
     { std::ifstream f(filepath_); needsHeader = !f.good(); }
 
-    std::ofstream file(filepath_, std::ios::app);
+    std::ofstream file(filepath_, std::ios::binary | std::ios::app);
     if (!file.is_open()) return false;
 
-    if (needsHeader) {
-        file << "label";
-        for (size_t i = 0; i < entry.embedding.size(); i++)
-            file << ",e" << i;
-        file << "\n";
+    if (needsHeader) writeHeader(file, static_cast<int>(entry.embedding.size()));
+    writeRecord(file, entry);
+
+    addRow(entry);
+    indexNewRows();
+    return static_cast<bool>(file);
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::insert(const EmbeddingEntry& entry)
+{
+    addRow(entry);
+    indexNewRows();
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::clear()
+{
+    unit_.release();
+    norms_.clear();
+    labelIdx_.clear();
+    labels_.clear();
+    index_.clear();
+    indexDirty_ = false;
+    generation_++;
+}
+
+// -----------------------------------------------------------------------------
+EmbeddingEntry EmbeddingDB::entry(int i) const
+{
+    EmbeddingEntry e;
+    e.label = label(i);
+    const float* u = unit_.ptr<float>(i);
+    e.embedding.resize(unit_.cols);
+    for (int d = 0; d < unit_.cols; d++) e.embedding[d] = u[d] * norms_[i];
+    return e;
+}
+
+// -----------------------------------------------------------------------------
+cv::Mat EmbeddingDB::matrix() const
+{
+    cv::Mat m = unit_.clone();
+    for (int i = 0; i < m.rows; i++) {
+        cv::Mat row = m.row(i);
+        row *= norms_[i];
     }
+    return m;
+}
 
-    file << entry.label;
-    for (float v : entry.embedding)
-        file << "," << v;
-    file << "\n";
+// -----------------------------------------------------------------------------
+std::map<std::string, int> EmbeddingDB::labelCounts() const
+{
+    std::map<std::string, int> counts;
+    for (int idx : labelIdx_) counts[labels_[idx]]++;
+    return counts;
+}
 
-    entries_.push_back(entry);
-    return true;
+// -----------------------------------------------------------------------------
+int EmbeddingDB::nearest(const std::vector<float>& query, int metric,
+                         float& outDist) const
+{
+    outDist = 1e9f;
+    if (empty() || static_cast<int>(query.size()) != dim()) return -1;
+
+    const int    n      = dim();
+    const float* q      = query.data();
+    const float  qNorm2 = dotProduct(q, q, n);
+    const float  qInv   = qNorm2 > 0.f ? 1.f / std::sqrt(qNorm2) : 0.f;
+
+    int  best  = -1;
+    auto score = [&](int i) {
+        const float dot = dotProduct(q, unit_.ptr<float>(i), n);
+        // SSD = |q|^2 + |x|^2 - 2 |x| (q . x/|x|);  cosine = 1 - q/|q| . x/|x|
+        const float d = (metric == 1)
+                        ? 1.f - dot * qInv
+                        : std::max(0.f, qNorm2 + norms_[i] * (norms_[i] - 2.f * dot));
+        if (d < outDist) {
+            outDist = d;
+            best    = i;
+        }
+    };
+
+    // Graph candidates by cosine, re-ranked by the exact metric
+    if (indexed_ && size() >= kIndexMinRows && index_.size() == size() && qInv > 0.f) {
+        std::vector<float> unitQuery(query);
+        for (float& v : unitQuery) v *= qInv;
+        std::vector<HnswIndex::Neighbour> candidates;
+        index_.search(unit_, unitQuery.data(), kIndexEf, candidates);
+        for (const auto& c : candidates) score(static_cast<int>(c.second));
+        if (best >= 0) return best;
+    }
+
+    for (int i = 0; i < unit_.rows; i++) score(i);
+    return best;
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::setIndexed(bool on)
+{
+    if (on == indexed_) return;
+    if (on) {
+        indexed_ = true;
+        syncIndex();
+    } else {
+        flushIndex();
+        index_.clear();
+        indexed_ = false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+std::string EmbeddingDB::indexPath() const
+{
+    return withExtension(filepath_, ".hnsw");
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::indexNewRows()
+{
+    if (!indexed_) return;
+    while (index_.size() < size()) {
+        index_.add(unit_);
+        indexDirty_ = true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::syncIndex()
+{
+    index_.clear();
+    indexDirty_ = false;
+    if (empty()) return;
+
+    if (!filepath_.empty()) index_.load(indexPath(), dim(), size());
+    const int saved = index_.size();
+    if (saved == size()) return;
+
+    std::cout << "[EmbeddingDB] Indexing " << size() - saved << " of " << size()
+              << " entries...\n";
+    indexNewRows();
+    flushIndex();
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingDB::flushIndex() const
+{
+    if (!indexed_ || !indexDirty_ || filepath_.empty() || index_.empty()) return;
+    if (index_.save(indexPath(), dim()))
+        indexDirty_ = false;
+    else
+        std::cerr << "[EmbeddingDB] Cannot write " << indexPath() << "\n";
+}
+
+// =============================================================================
+// Internal — fused aligned crop (rotate + crop + resize as one warpAffine)
+// =============================================================================
+/** Context kept around the bounding box; everything else reads as black. */
+static const int kCropPad = 20;
+
+/** Bounding box grown by kCropPad, clipped to the frame. */
+static cv::Rect contextBox(const RegionInfo& reg, cv::Size frameSize)
+{
+    cv::Rect box(reg.boundingBox.x - kCropPad, reg.boundingBox.y - kCropPad,
+                 reg.boundingBox.width + 2 * kCropPad,
+                 reg.boundingBox.height + 2 * kCropPad);
+    return box & cv::Rect(cv::Point(0, 0), frameSize);
+}
+
+/**
+ * @brief Map from a network tile pixel to the context box (dst → src).
+ *
+ *        Composes prepEmbeddingImage()'s rotation about the centroid, its
+ *        clamped crop and the bilinear resize to kORNetSize, so one
+ *        resampling replaces the rotated canvas, the crop copy and the
+ *        resize.  Degenerate extents fall back to the whole frame, as there.
+ */
+static cv::Matx23d alignedCropTransform(const RegionInfo& reg, cv::Size frameSize,
+                                        cv::Point boxOrigin)
+{
+    const int cx = static_cast<int>(reg.centroid.x);
+    const int cy = static_cast<int>(reg.centroid.y);
+
+    const int canvas = static_cast<int>(1.414 * std::max(frameSize.width, frameSize.height));
+    int left   = cx + static_cast<int>(reg.minE1);
+    int top    = cy - static_cast<int>(reg.maxE2);
+    int width  = static_cast<int>(reg.maxE1) - static_cast<int>(reg.minE1);
+    int height = static_cast<int>(reg.maxE2) - static_cast<int>(reg.minE2);
+    if (left < 0)                { width  += left; left = 0; }
+    if (top  < 0)                { height += top;  top  = 0; }
+    if (left + width  >= canvas) width  = canvas - 1 - left;
+    if (top  + height >= canvas) height = canvas - 1 - top;
+
+    cv::Matx23d toFrame(1, 0, 0,
+                        0, 1, 0);    // crop plane → frame
+    if (width <= 0 || height <= 0) {
+        left = top = 0;
+        width  = frameSize.width;
+        height = frameSize.height;
+    } else {
+        cv::Mat rot = cv::getRotationMatrix2D(cv::Point2f(static_cast<float>(cx),
+                                                          static_cast<float>(cy)),
+                                              -reg.angle * 180.0 / CV_PI, 1.0);
+        cv::Mat inv;
+        cv::invertAffineTransform(rot, inv);
+        toFrame = inv;
+    }
+
+    // Tile (u, v) → crop plane (sx u + ox, sy v + oy), pixel-centre aligned
+    const double sx = static_cast<double>(width)  / kORNetSize;
+    const double sy = static_cast<double>(height) / kORNetSize;
+    const double ox = left + 0.5 * sx - 0.5;
+    const double oy = top  + 0.5 * sy - 0.5;
+
+    cv::Matx23d m;
+    for (int r = 0; r < 2; r++) {
+        m(r, 0) = toFrame(r, 0) * sx;
+        m(r, 1) = toFrame(r, 1) * sy;
+        m(r, 2) = toFrame(r, 0) * ox + toFrame(r, 1) * oy + toFrame(r, 2);
+    }
+    m(0, 2) -= boxOrigin.x;
+    m(1, 2) -= boxOrigin.y;
+    return m;
+}
+
+/** BGR tile → R, G, B float planes of (pixel - mean) * scale. */
+static void tileToPlanes(const cv::Mat& tile, float* dst)
+{
+    const int   area  = tile.rows * tile.cols;
+    const float scale = static_cast<float>(kORNetScale);
+    const float offR  = static_cast<float>(kORNetMean[0] * kORNetScale);
+    const float offG  = static_cast<float>(kORNetMean[1] * kORNetScale);
+    const float offB  = static_cast<float>(kORNetMean[2] * kORNetScale);
+    float* r = dst;
+    float* g = dst + area;
+    float* b = dst + 2 * area;
+
+    for (int y = 0; y < tile.rows; y++) {
+        const uchar* px = tile.ptr<uchar>(y);
+        const int    o  = y * tile.cols;
+        for (int x = 0; x < tile.cols; x++, px += 3) {
+            b[o + x] = px[0] * scale - offB;
+            g[o + x] = px[1] * scale - offG;
+            r[o + x] = px[2] * scale - offR;
+        }
+    }
 }
 
 // -----------------------------------------------------------------------------
-void EmbeddingDB::clear() { entries_.clear(); }
+// Preferable backend / target of a network (see PipelineParams::dnnBackend).
+// Returns the backend index actually applied.
+// -----------------------------------------------------------------------------
+static int configureBackend(cv::dnn::Net& net, int dnnBackend)
+{
+    int backend = cv::dnn::DNN_BACKEND_OPENCV;
+    int target  = cv::dnn::DNN_TARGET_CPU;
+    switch (dnnBackend) {
+        case 1: target = cv::dnn::DNN_TARGET_OPENCL;                 break;
+        case 2: target = cv::dnn::DNN_TARGET_OPENCL_FP16;            break;
+        case 3: backend = cv::dnn::DNN_BACKEND_CUDA;
+                target  = cv::dnn::DNN_TARGET_CUDA;                  break;
+        case 4: backend = cv::dnn::DNN_BACKEND_CUDA;
+                target  = cv::dnn::DNN_TARGET_CUDA_FP16;             break;
+        case 5: backend = cv::dnn::DNN_BACKEND_INFERENCE_ENGINE;     break;
+        default: dnnBackend = 0;                                     break;
+    }
+    net.setPreferableBackend(backend);
+    net.setPreferableTarget(target);
+    return dnnBackend;
+}
 
 // =============================================================================
 // EmbeddingClassifier
 // =============================================================================
-bool EmbeddingClassifier::loadModel(const std::string& modelPath)
+bool EmbeddingClassifier::loadModel(const std::string& modelPath, int dnnBackend)
+{
+    LoadedModel model;
+    if (!prepareModel(modelPath, dnnBackend, model)) return false;
+    swapModel(std::move(model));
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool EmbeddingClassifier::prepareModel(const std::string& modelPath, int dnnBackend,
+                                       LoadedModel& out)
 {
     try {
-        net_ = cv::dnn::readNetFromONNX(modelPath);
-        if (net_.empty()) {
+        out.net = cv::dnn::readNetFromONNX(modelPath);
+        if (out.net.empty()) {
             std::cerr << "[Embedding] Failed to load model: " << modelPath << "\n";
             return false;
         }
-        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-        modelLoaded_ = true;
-        std::cout << "[Embedding] ResNet18 loaded from " << modelPath << "\n";
+        out.path    = modelPath;
+        out.backend = configureBackend(out.net, dnnBackend);
+        out.layer   = embeddingLayer(out.net);
+
+        // Probe the embedding size (also compiles the net for its backend)
+        const int shape[] = {1, 3, kORNetSize, kORNetSize};
+        cv::Mat probe(4, shape, CV_32F, cv::Scalar(0));
+        cv::Mat emb;
+        out.dim = forwardEmbeddings(probe, emb, out.net, out.layer) > 0 ? emb.cols : 0;
+        if (out.dim == 0) {
+            std::cerr << "[Embedding] Model produced no embedding: " << modelPath << "\n";
+            return false;
+        }
         return true;
     } catch (const cv::Exception& e) {
         std::cerr << "[Embedding] OpenCV error: " << e.what() << "\n";
@@ -138,27 +532,81 @@ bool EmbeddingClassifier::loadModel(const std::string& modelPath)
 }
 
 // -----------------------------------------------------------------------------
-bool EmbeddingClassifier::computeEmbedding(cv::Mat& frame,
-                                            const RegionInfo& reg,
-                                            std::vector<float>& emb,
-                                            bool debug,
-                                            cv::Mat* cropOut)
+void EmbeddingClassifier::swapModel(LoadedModel&& model)
 {
-    if (!modelLoaded_) return false;
+    std::lock_guard<std::mutex> lock(netMutex_);
+    std::cout << "[Embedding] Model " << model.path << " (" << model.dim << "-d)\n";
+    {
+        std::lock_guard<std::mutex> pathLock(pathMutex_);
+        modelPath_ = std::move(model.path);
+    }
+    net_         = std::move(model.net);
+    layer_       = std::move(model.layer);
+    dim_         = model.dim;
+    backend_     = model.backend;
+    modelLoaded_ = true;
+    generation_++;
+}
+
+// -----------------------------------------------------------------------------
+float EmbeddingClassifier::benchmark(LoadedModel& model, int batch, int runs)
+{
+    batch = std::max(1, batch);
+    runs  = std::max(1, runs);
+    const int shape[] = {batch, 3, kORNetSize, kORNetSize};
+    cv::Mat blob(4, shape, CV_32F);
+    cv::randn(blob, 0.0, 1.0);
+
+    try {
+        cv::Mat emb;
+        if (forwardEmbeddings(blob, emb, model.net, model.layer) == 0) return -1.f;
+
+        const int64 t0 = cv::getTickCount();
+        for (int r = 0; r < runs; r++)
+            forwardEmbeddings(blob, emb, model.net, model.layer);
+        const double ms = (cv::getTickCount() - t0) * 1000.0 / cv::getTickFrequency();
+        return static_cast<float>(ms / (static_cast<double>(runs) * batch));
+    } catch (const cv::Exception& e) {
+        std::cerr << "[Embedding] Benchmark failed: " << e.what() << "\n";
+        return -1.f;
+    }
+}
 
+// -----------------------------------------------------------------------------
+std::string EmbeddingClassifier::modelPath() const
+{
+    std::lock_guard<std::mutex> lock(pathMutex_);
+    return modelPath_;
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingClassifier::setBackend(int dnnBackend)
+{
+    std::lock_guard<std::mutex> lock(netMutex_);
+    applyBackend(dnnBackend);
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingClassifier::applyBackend(int dnnBackend)
+{
+    backend_ = dnnBackend;
+    if (!modelLoaded_) return;
+    backend_ = configureBackend(net_, dnnBackend);
+    std::cout << "[Embedding] DNN backend " << backend_ << "\n";
+}
+
+// -----------------------------------------------------------------------------
+bool EmbeddingClassifier::prepareCrop(cv::Mat& frame, const RegionInfo& reg,
+                                      cv::Mat& embImage, bool debug,
+                                      cv::Mat* cropOut)
+{
     // Mask out everything except this region's bounding box
     cv::Mat masked = cv::Mat::zeros(frame.size(), frame.type());
-    int pad = 20;
-    int x = std::max(0, reg.boundingBox.x - pad);
-    int y = std::max(0, reg.boundingBox.y - pad);
-    int w = std::min(frame.cols - x, reg.boundingBox.width  + 2 * pad);
-    int h = std::min(frame.rows - y, reg.boundingBox.height + 2 * pad);
-    if (w <= 0 || h <= 0) return false;
-    cv::Rect expandedBox(x, y, w, h);
+    cv::Rect expandedBox = contextBox(reg, frame.size());
+    if (expandedBox.empty()) return false;
     frame(expandedBox).copyTo(masked(expandedBox));
 
     // Extract aligned ROI
-    cv::Mat embImage;
     prepEmbeddingImage(masked, embImage,
                        static_cast<int>(reg.centroid.x),
                        static_cast<int>(reg.centroid.y),
@@ -175,9 +623,36 @@ bool EmbeddingClassifier::computeEmbedding(cv::Mat& frame,
         cv::resize(embImage, display, cv::Size(224, 224));
         *cropOut = display.clone();
     }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool EmbeddingClassifier::computeEmbedding(cv::Mat& frame,
+                                            const RegionInfo& reg,
+                                            std::vector<float>& emb,
+                                            bool debug,
+                                            cv::Mat* cropOut)
+{
+    if (!modelLoaded_) return false;
+
+    if (!debug) {
+        std::vector<std::vector<float>> embs;
+        std::vector<cv::Mat>            crops;
+        if (embedBatch({{&frame, &reg}}, embs, cropOut ? &crops : nullptr) == 0)
+            return false;
+        emb = std::move(embs[0]);
+        if (cropOut) *cropOut = crops[0];
+        return true;
+    }
+
+    cv::Mat embImage;
+    if (!prepareCrop(frame, reg, embImage, debug, cropOut)) return false;
 
     cv::Mat embMat;
-    getEmbedding(embImage, embMat, net_, debug ? 1 : 0);
+    {
+        std::lock_guard<std::mutex> lock(netMutex_);
+        getEmbedding(embImage, embMat, net_, debug ? 1 : 0);
+    }
 
     emb.assign(embMat.ptr<float>(0),
                embMat.ptr<float>(0) + static_cast<int>(embMat.total()));
@@ -185,16 +660,86 @@ bool EmbeddingClassifier::computeEmbedding(cv::Mat& frame,
 }
 
 // -----------------------------------------------------------------------------
-float EmbeddingClassifier::ssdDistance(const std::vector<float>& a,
-                                        const std::vector<float>& b) const
+int EmbeddingClassifier::computeEmbeddings(cv::Mat& frame,
+                                           const std::vector<RegionInfo>& regions,
+                                           std::vector<std::vector<float>>& embs,
+                                           std::vector<cv::Mat>* crops)
+{
+    std::vector<EmbedRequest> requests;
+    requests.reserve(regions.size());
+    for (const auto& reg : regions) requests.push_back({&frame, &reg});
+
+    const int n = embedBatch(requests, embs, keepCrops_ ? crops : nullptr);
+    if (crops && !keepCrops_) crops->assign(regions.size(), cv::Mat());
+    return n;
+}
+
+// -----------------------------------------------------------------------------
+int EmbeddingClassifier::computeEmbeddings(const std::vector<EmbedRequest>& requests,
+                                           std::vector<std::vector<float>>& embs)
+{
+    return embedBatch(requests, embs, nullptr);
+}
+
+// -----------------------------------------------------------------------------
+int EmbeddingClassifier::embedBatch(const std::vector<EmbedRequest>& requests,
+                                    std::vector<std::vector<float>>& embs,
+                                    std::vector<cv::Mat>* crops)
 {
-    float ssd = 0.f;
-    int   dim = std::min(a.size(), b.size());
-    for (int i = 0; i < dim; i++) {
-        float d = a[i] - b[i];
-        ssd += d * d;
+    embs.assign(requests.size(), {});
+    if (crops) crops->assign(requests.size(), cv::Mat());
+    if (!modelLoaded_ || requests.empty()) return 0;
+
+    const size_t   slot = 3 * static_cast<size_t>(kORNetSize) * kORNetSize;
+    const cv::Size tileSize(kORNetSize, kORNetSize);
+
+    std::lock_guard<std::mutex> lock(netMutex_);
+    ProfileScope profile(ProfileStage::Embedding);
+    const int n = static_cast<int>(requests.size());
+    if (batch_.empty() || batch_.size[0] < n) {
+        const int shape[] = {n, 3, kORNetSize, kORNetSize};
+        batch_.create(4, shape, CV_32F);
+    }
+
+    // Slots go to the regions with a usable box, in order
+    std::vector<size_t>   owners;
+    std::vector<cv::Rect> boxes;
+    for (size_t i = 0; i < requests.size(); i++) {
+        const cv::Rect box = contextBox(*requests[i].region, requests[i].frame->size());
+        if (box.empty()) continue;
+        owners.push_back(i);
+        boxes.push_back(box);
+    }
+    if (owners.empty()) return 0;
+
+    // One task per region: warp into a per-thread tile, normalise into its slot
+    float* slots = batch_.ptr<float>();
+    TaskScheduler::instance().parallelFor(0, static_cast<int>(owners.size()),
+                                          [&](int begin, int end) {
+        thread_local cv::Mat tile;
+        for (int j = begin; j < end; j++) {
+            const cv::Mat&    frame = *requests[owners[j]].frame;
+            const RegionInfo& reg   = *requests[owners[j]].region;
+            cv::warpAffine(frame(boxes[j]), tile,
+                           alignedCropTransform(reg, frame.size(), boxes[j].tl()),
+                           tileSize, cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                           cv::BORDER_CONSTANT, cv::Scalar::all(0));
+            tileToPlanes(tile, slots + j * slot);
+            if (crops) (*crops)[owners[j]] = tile.clone();
+        }
+    });
+
+    // One forward pass over the filled slots
+    const int shape[] = {static_cast<int>(owners.size()), 3, kORNetSize, kORNetSize};
+    cv::Mat blob(4, shape, CV_32F, batch_.ptr<float>());
+    cv::Mat embMat;
+    forwardEmbeddings(blob, embMat, net_, layer_);
+
+    for (size_t j = 0; j < owners.size(); j++) {
+        const float* row = embMat.ptr<float>(static_cast<int>(j));
+        embs[owners[j]].assign(row, row + embMat.cols);
     }
-    return ssd;
+    return static_cast<int>(owners.size());
 }
 
 // -----------------------------------------------------------------------------
@@ -202,18 +747,13 @@ void EmbeddingClassifier::classify(const std::vector<float>& emb,
                                     const EmbeddingDB& db,
                                     float threshold,
                                     std::string& outLabel,
-                                    float& outDist) const
+                                    float& outDist,
+                                    int metric) const
 {
     outLabel = "unknown";
-    outDist  = 1e9f;
 
-    for (const auto& e : db.entries()) {
-        float d = ssdDistance(emb, e.embedding);
-        if (d < outDist) {
-            outDist  = d;
-            outLabel = e.label;
-        }
-    }
+    int best = db.nearest(emb, metric, outDist);
+    if (best >= 0) outLabel = db.label(best);
 
     // Unknown detection — if best distance exceeds threshold
     if (threshold > 0.f && outDist > threshold)
@@ -221,29 +761,59 @@ void EmbeddingClassifier::classify(const std::vector<float>& emb,
 }
 
 // -----------------------------------------------------------------------------
-void EmbeddingClassifier::classifyAll(cv::Mat& frame, AppState& state,
-                                       const EmbeddingDB& db, float thresh)
+float EmbeddingClassifier::threshold(const PipelineParams& params)
 {
-    state.lastCroppedROI = cv::Mat();
-    state.croppedROIs.clear();
+    // SSD of raw 512-d embeddings is in the thousands; cosine is in [0..2]
+    return params.distanceMetric == 1 ? params.confidenceThresh
+                                      : params.confidenceThresh * 10000.f;
+}
 
-    for (auto& reg : state.regions) {
-        std::vector<float> emb;
-        cv::Mat            crop;
+// -----------------------------------------------------------------------------
+float EmbeddingClassifier::confidence(float dist, int metric)
+{
+    float normDist = (metric == 1) ? dist : dist / 512.f;
+    return 1.f / (1.f + normDist);
+}
 
-        if (!computeEmbedding(frame, reg, emb, false, &crop)) continue;
+// -----------------------------------------------------------------------------
+void EmbeddingClassifier::classifyAll(cv::Mat& frame, AppState& state,
+                                       const EmbeddingDB& db, float thresh,
+                                       int metric)
+{
+    ProfileScope profile(ProfileStage::Classify);
+
+    // Only regions the tracker flagged (and the cascade left) go through the network
+    std::vector<RegionInfo> batch;
+    std::vector<size_t>     index;
+    for (size_t i = 0; i < state.regions.size(); i++) {
+        if (!state.regions[i].needsClassify || state.regions[i].shapeLabel) continue;
+        batch.push_back(state.regions[i]);
+        index.push_back(i);
+    }
+
+    std::vector<std::vector<float>> embs;
+    std::vector<cv::Mat>            crops;
+    computeEmbeddings(frame, batch, embs, &crops);
 
-        state.croppedROIs.push_back(crop);
-        if (state.lastCroppedROI.empty()) state.lastCroppedROI = crop;
+    for (size_t j = 0; j < batch.size(); j++) {
+        if (embs[j].empty()) continue;
+        RegionInfo& reg = state.regions[index[j]];
 
         std::string label;
         float       dist;
-        classify(emb, db, thresh, label, dist);
+        classify(embs[j], db, thresh, label, dist, metric);
 
         reg.label      = label;
-        reg.embedding  = emb;
+        reg.embedding  = std::move(embs[j]);
+        reg.embedCrop  = crops[j];
+        reg.confidence = confidence(dist, metric);
+    }
 
-        float normDist = dist / 512.f;
-        reg.confidence = 1.f / (1.f + normDist);
+    state.lastCroppedROI = cv::Mat();
+    state.croppedROIs.clear();
+    for (const auto& reg : state.regions) {
+        if (reg.embedCrop.empty()) continue;
+        state.croppedROIs.push_back(reg.embedCrop);
+        if (state.lastCroppedROI.empty()) state.lastCroppedROI = reg.embedCrop;
     }
 }
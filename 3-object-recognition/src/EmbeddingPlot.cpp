@@ -20,107 +20,251 @@ static const cv::Scalar kColors[] = {
 };
 static constexpr int kNumColors = 10;
 
+static constexpr int kMargin = 40;
+
+// Power iteration: stop once successive estimates agree to this cosine
+static constexpr int    kMaxIterations = 200;
+static constexpr double kConverged     = 1.0 - 1e-10;
+
+// =============================================================================
+// Static helpers
+// =============================================================================
+
+/**
+ * @brief Dominant eigenvector of a symmetric PSD matrix, restricted to the
+ *        complement of `exclude` (empty = whole space).
+ * @param start  Warm start (dim x 1); replaced with the result.
+ */
+static void powerIterate(const cv::Mat& cov, const cv::Mat& exclude, cv::Mat& start)
+{
+    cv::Mat v = start;
+    for (int it = 0; it < kMaxIterations; it++) {
+        cv::Mat w = cov * v;
+        if (!exclude.empty()) w -= exclude * exclude.dot(w);
+        const double n = cv::norm(w);
+        if (n < 1e-12) break;   // no variance left in this subspace
+        w /= n;
+        const bool done = std::abs(w.dot(v)) > kConverged;
+        v = w;
+        if (done) break;
+    }
+    start = v;
+}
+
 // -----------------------------------------------------------------------------
-void renderEmbeddingPlot(const EmbeddingDB& db, int plotSize, cv::Mat& dst)
+/** Column of cov with the largest diagonal entry, outside `exclude`. */
+static cv::Mat coldStart(const cv::Mat& cov, const cv::Mat& exclude)
 {
-    const auto& entries = db.entries();
+    cv::Mat v = cov.col(0).clone();
+    double best = -1.0;
+    for (int d = 0; d < cov.cols; d++) {
+        cv::Mat c = cov.col(d).clone();
+        if (!exclude.empty()) c -= exclude * exclude.dot(c);
+        const double n = cv::norm(c);
+        if (n > best) { best = n; v = c; }
+    }
+    if (best < 1e-12) {
+        v = cv::Mat::zeros(cov.rows, 1, CV_64F);
+        v.at<double>(exclude.empty() ? 0 : std::min(1, cov.rows - 1)) = 1.0;
+    }
+    return v / std::max(cv::norm(v), 1e-12);
+}
 
-    if (entries.size() < 2) {
-        dst = cv::Mat(plotSize, plotSize, CV_8UC3, cv::Scalar(30,30,30));
-        cv::putText(dst, "Need >= 2 embedding samples",
-                    {20, plotSize/2}, cv::FONT_HERSHEY_SIMPLEX,
-                    0.5, {180,180,180}, 1);
-        return;
+// =============================================================================
+// EmbeddingPlot
+// =============================================================================
+
+EmbeddingPlot::EmbeddingPlot(int plotSize)
+    : plotSize_(plotSize)
+{
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingPlot::reset(int dim)
+{
+    dim_  = dim;
+    rows_ = 0;
+    sum_     = cv::Mat::zeros(1, dim, CV_64F);
+    scatter_ = cv::Mat::zeros(dim, dim, CV_64F);
+    axes_.release();
+    projected_.clear();
+    colorMap_.clear();
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingPlot::sync(const EmbeddingDB& db)
+{
+    const int n = db.size();
+    if (db.generation() != generation_ || n < rows_ || (n > 0 && db.dim() != dim_)) {
+        generation_ = db.generation();
+        reset(db.dim());
+        background_.release();
+    }
+    if (n == rows_ && !background_.empty()) return;
+
+    // --- Fold in the appended rows: sum += x, scatter += x^T x ---------------
+    if (n > rows_) {
+        cv::Mat x;
+        db.unitRows().rowRange(rows_, n).convertTo(x, CV_64F);
+        for (int i = rows_; i < n; i++) {
+            x.row(i - rows_) *= db.norm(i);
+            const std::string& label = db.label(i);
+            if (colorMap_.find(label) == colorMap_.end())
+                colorMap_[label] = kColors[colorMap_.size() % kNumColors];
+        }
+        cv::Mat rowSum;
+        cv::reduce(x, rowSum, 0, cv::REDUCE_SUM, CV_64F);
+        sum_     += rowSum;
+        scatter_ += x.t() * x;
+        rows_ = n;
+    }
+
+    if (rows_ >= 2) {
+        fitAxes();
+
+        // Project the whole DB once per change: (norm_i u_i) . axis - offset
+        cv::Mat axesF, proj;
+        axes_.convertTo(axesF, CV_32F);
+        cv::gemm(db.unitRows(), axesF, 1.0, cv::noArray(), 0.0, proj, cv::GEMM_2_T);
+        projected_.resize(rows_);
+        for (int i = 0; i < rows_; i++) {
+            const float* p = proj.ptr<float>(i);
+            projected_[i] = {static_cast<float>(p[0] * db.norm(i) - offset_[0]),
+                             static_cast<float>(p[1] * db.norm(i) - offset_[1])};
+        }
     }
+    drawBackground(db);
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingPlot::fitAxes()
+{
+    // Covariance = scatter / n - mean^T mean
+    const cv::Mat mean = sum_ / rows_;
+    cv::Mat cov = scatter_ / rows_;
+    cov -= mean.t() * mean;
+
+    cv::Mat prev = axes_;
+    cv::Mat pc1 = prev.empty() ? coldStart(cov, cv::Mat()) : cv::Mat(prev.row(0).t());
+    powerIterate(cov, cv::Mat(), pc1);
 
-    int n   = static_cast<int>(entries.size());
-    int dim = static_cast<int>(entries[0].embedding.size());
+    cv::Mat pc2 = prev.empty() ? coldStart(cov, pc1) : cv::Mat(prev.row(1).t());
+    pc2 -= pc1 * pc1.dot(pc2);
+    if (cv::norm(pc2) < 1e-6) pc2 = coldStart(cov, pc1);
+    pc2 /= cv::norm(pc2);
+    powerIterate(cov, pc1, pc2);
 
-    // --- Build data matrix (n x dim) ----------------------------------------
-    cv::Mat data(n, dim, CV_32F);
-    for (int i = 0; i < n; i++) {
-        const auto& emb = entries[i].embedding;
-        for (int d = 0; d < dim && d < static_cast<int>(emb.size()); d++)
-            data.at<float>(i, d) = emb[d];
+    // Keep orientation between updates so the plot does not mirror
+    if (!prev.empty()) {
+        if (pc1.dot(prev.row(0).t()) < 0) pc1 *= -1.0;
+        if (pc2.dot(prev.row(1).t()) < 0) pc2 *= -1.0;
     }
 
-    // --- PCA — project onto top 2 eigenvectors via cv::PCACompute ------------
-    cv::Mat mean, eigenvectors;
-    cv::PCACompute(data, mean, eigenvectors, 2);
+    axes_.create(2, dim_, CV_64F);
+    cv::Mat(pc1.t()).copyTo(axes_.row(0));
+    cv::Mat(pc2.t()).copyTo(axes_.row(1));
+    offset_[0] = mean.dot(axes_.row(0));
+    offset_[1] = mean.dot(axes_.row(1));
+}
 
-    // Project all points: projected = (data - mean) * eigenvectors^T
-    cv::Mat projected;
-    cv::PCAProject(data, mean, eigenvectors, projected);
-    // projected is (n x 2)
+// -----------------------------------------------------------------------------
+cv::Point EmbeddingPlot::toPixel(const cv::Point2f& p) const
+{
+    const int   inner = plotSize_ - 2 * kMargin;
+    const float nx = std::clamp((p.x - minX_) / rangeX_, 0.f, 1.f);
+    const float ny = std::clamp((p.y - minY_) / rangeY_, 0.f, 1.f);
+    return {kMargin + static_cast<int>(nx * inner),
+            kMargin + static_cast<int>((1.f - ny) * inner)};  // flip Y
+}
+
+// -----------------------------------------------------------------------------
+void EmbeddingPlot::drawBackground(const EmbeddingDB& db)
+{
+    if (rows_ < 2) {
+        background_ = cv::Mat(plotSize_, plotSize_, CV_8UC3, cv::Scalar(30,30,30));
+        cv::putText(background_, "Need >= 2 embedding samples",
+                    {20, plotSize_/2}, cv::FONT_HERSHEY_SIMPLEX,
+                    0.5, {180,180,180}, 1);
+        return;
+    }
 
     // --- Find range for normalisation ----------------------------------------
     float minX =  1e9f, maxX = -1e9f;
     float minY =  1e9f, maxY = -1e9f;
-    for (int i = 0; i < n; i++) {
-        float x = projected.at<float>(i, 0);
-        float y = projected.at<float>(i, 1);
-        minX = std::min(minX, x); maxX = std::max(maxX, x);
-        minY = std::min(minY, y); maxY = std::max(maxY, y);
-    }
-    float rangeX = (maxX - minX) < 1e-6f ? 1.f : maxX - minX;
-    float rangeY = (maxY - minY) < 1e-6f ? 1.f : maxY - minY;
-
-    // --- Build label → color map ---------------------------------------------
-    std::map<std::string, cv::Scalar> colorMap;
-    std::map<std::string, int>        labelIdx;
-    int idx = 0;
-    for (const auto& e : entries) {
-        if (colorMap.find(e.label) == colorMap.end()) {
-            colorMap[e.label] = kColors[idx % kNumColors];
-            labelIdx[e.label] = idx;
-            idx++;
-        }
+    for (const auto& p : projected_) {
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
     }
+    rangeX_ = (maxX - minX) < 1e-6f ? 1.f : maxX - minX;
+    rangeY_ = (maxY - minY) < 1e-6f ? 1.f : maxY - minY;
+    minX_ = minX;
+    minY_ = minY;
 
     // --- Draw plot -----------------------------------------------------------
-    int margin = 40;
-    int inner  = plotSize - 2 * margin;
-
-    dst = cv::Mat(plotSize, plotSize, CV_8UC3, cv::Scalar(25, 25, 25));
+    const int inner = plotSize_ - 2 * kMargin;
+    background_ = cv::Mat(plotSize_, plotSize_, CV_8UC3, cv::Scalar(25, 25, 25));
 
     // Grid lines
     for (int g = 0; g <= 4; g++) {
-        int gx = margin + g * inner / 4;
-        int gy = margin + g * inner / 4;
-        cv::line(dst, {gx, margin}, {gx, plotSize-margin}, {50,50,50}, 1);
-        cv::line(dst, {margin, gy}, {plotSize-margin, gy}, {50,50,50}, 1);
+        int gx = kMargin + g * inner / 4;
+        int gy = kMargin + g * inner / 4;
+        cv::line(background_, {gx, kMargin}, {gx, plotSize_-kMargin}, {50,50,50}, 1);
+        cv::line(background_, {kMargin, gy}, {plotSize_-kMargin, gy}, {50,50,50}, 1);
     }
 
     // Axes labels
-    cv::putText(dst, "PC1", {plotSize/2 - 10, plotSize - 8},
+    cv::putText(background_, "PC1", {plotSize_/2 - 10, plotSize_ - 8},
                 cv::FONT_HERSHEY_SIMPLEX, 0.4, {120,120,120}, 1);
-    cv::putText(dst, "PC2", {4, plotSize/2},
+    cv::putText(background_, "PC2", {4, plotSize_/2},
                 cv::FONT_HERSHEY_SIMPLEX, 0.4, {120,120,120}, 1);
 
     // Plot points
-    for (int i = 0; i < n; i++) {
-        float nx = (projected.at<float>(i, 0) - minX) / rangeX;
-        float ny = (projected.at<float>(i, 1) - minY) / rangeY;
-
-        int px = margin + static_cast<int>(nx * inner);
-        int py = margin + static_cast<int>((1.f - ny) * inner); // flip Y
-
-        const cv::Scalar& col = colorMap[entries[i].label];
-        cv::circle(dst, {px, py}, 6, col, -1);
-        cv::circle(dst, {px, py}, 6, {255,255,255}, 1); // white outline
+    for (int i = 0; i < rows_; i++) {
+        const cv::Point p = toPixel(projected_[i]);
+        cv::circle(background_, p, 6, colorMap_[db.label(i)], -1);
+        cv::circle(background_, p, 6, {255,255,255}, 1); // white outline
     }
 
     // Legend — bottom left
-    int ly = plotSize - margin - static_cast<int>(colorMap.size()) * 18;
-    for (const auto& kv : colorMap) {
-        cv::circle(dst, {margin + 6, ly}, 5, kv.second, -1);
-        cv::putText(dst, kv.first, {margin + 16, ly + 4},
+    int ly = plotSize_ - kMargin - static_cast<int>(colorMap_.size()) * 18;
+    for (const auto& kv : colorMap_) {
+        cv::circle(background_, {kMargin + 6, ly}, 5, kv.second, -1);
+        cv::putText(background_, kv.first, {kMargin + 16, ly + 4},
                     cv::FONT_HERSHEY_SIMPLEX, 0.4, kv.second, 1);
         ly += 18;
     }
 
     // Title
-    cv::putText(dst, "Embedding Space (PCA 2D)",
-                {margin, 18}, cv::FONT_HERSHEY_SIMPLEX,
+    cv::putText(background_, "Embedding Space (PCA 2D)",
+                {kMargin, 18}, cv::FONT_HERSHEY_SIMPLEX,
                 0.45, {200,200,200}, 1);
 }
+
+// -----------------------------------------------------------------------------
+void EmbeddingPlot::render(const std::vector<RegionInfo>& regions, cv::Mat& dst) const
+{
+    if (background_.empty()) {
+        dst = cv::Mat(plotSize_, plotSize_, CV_8UC3, cv::Scalar(30,30,30));
+        return;
+    }
+    background_.copyTo(dst);
+    if (axes_.empty()) return;
+
+    // Live regions — two dot products each, drawn as crosses over the DB
+    for (const auto& reg : regions) {
+        if (static_cast<int>(reg.embedding.size()) != dim_) continue;
+        cv::Mat xd;
+        cv::Mat(reg.embedding).convertTo(xd, CV_64F);
+        xd = xd.reshape(1, 1);
+        const cv::Point2f q(static_cast<float>(xd.dot(axes_.row(0)) - offset_[0]),
+                            static_cast<float>(xd.dot(axes_.row(1)) - offset_[1]));
+
+        const auto it = colorMap_.find(reg.label);
+        const cv::Scalar col = it != colorMap_.end() ? it->second : cv::Scalar(255,255,255);
+        const cv::Point p = toPixel(q);
+        cv::drawMarker(dst, p, {0,0,0}, cv::MARKER_TILTED_CROSS, 16, 4);
+        cv::drawMarker(dst, p, col, cv::MARKER_TILTED_CROSS, 16, 2);
+        cv::putText(dst, reg.label, {p.x + 10, p.y - 8},
+                    cv::FONT_HERSHEY_SIMPLEX, 0.4, col, 1);
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * @file    FrameSource.cpp
+ * @brief   Decode thread and latest-frame ring implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "FrameSource.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kReconnectDelayMs = 1000;
+
+// -----------------------------------------------------------------------------
+FrameSource::~FrameSource()
+{
+    close();
+}
+
+// -----------------------------------------------------------------------------
+bool FrameSource::open(const std::string& spec, int camera, bool dropFrames)
+{
+    close();
+
+    spec_ = spec;
+    dropFrames_ = dropFrames;
+
+    capture_ = cvcore::FrameSource::open(spec, camera);
+    if (!capture_) return false;
+    fileFps_ = capture_->kind() == Kind::File ? capture_->fps() : 0.0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.clear();
+        reading_ = -1;
+        ended_   = false;
+        stop_    = false;
+        stats_   = Stats{};
+        stats_.hwDecode = capture_->hardwareDecode();
+    }
+
+    description_ = capture_->description();
+    decoder_ = std::thread(&FrameSource::run, this);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void FrameSource::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (decoder_.joinable()) decoder_.join();
+    capture_.reset();
+}
+
+// -----------------------------------------------------------------------------
+bool FrameSource::next(cv::Mat& frame)
+{
+    cvcore::Frame f;
+    if (!next(f)) return false;
+    frame = f.image;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool FrameSource::next(cvcore::Frame& frame)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // The caller is done with its previous slot
+    reading_ = -1;
+    wake_.notify_all();
+
+    wake_.wait(lock, [&] { return stop_ || ended_ || !ready_.empty(); });
+    if (stop_ || ready_.empty()) return false;
+
+    // Behind the source: skip straight to the newest frame
+    if (dropFrames_) {
+        while (ready_.size() > 1) {
+            ready_.pop_front();
+            stats_.dropped++;
+        }
+    }
+    reading_ = ready_.front();
+    ready_.pop_front();
+    frame = slots_[reading_];
+    frame.raw.release();    // the decoder has moved on to other driver buffers
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+FrameSource::Stats FrameSource::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// -----------------------------------------------------------------------------
+int FrameSource::acquireSlot(std::unique_lock<std::mutex>& lock)
+{
+    for (;;) {
+        if (stop_) return -1;
+        for (int s = 0; s < kSlots; s++)
+            if (s != reading_ && std::find(ready_.begin(), ready_.end(), s) == ready_.end())
+                return s;
+
+        // Every other slot is waiting: overwrite the oldest, or wait for one
+        if (dropFrames_) {
+            const int s = ready_.front();
+            ready_.pop_front();
+            stats_.dropped++;
+            return s;
+        }
+        wake_.wait(lock);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void FrameSource::run()
+{
+    auto tPrev   = Clock::now();
+    auto nextDue = tPrev;
+
+    for (;;) {
+        int slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            slot = acquireSlot(lock);
+            if (slot < 0) break;
+        }
+
+        // Decode outside the lock; the slot keeps its buffer between frames
+        const bool ok = capture_->read(slots_[slot]);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!ok) {
+            if (capture_->kind() != Kind::Network || stop_) break;
+
+            // Dropped network stream: wait, then reopen
+            std::cerr << "[FrameSource] Stream lost, reconnecting: " << spec_ << "\n";
+            if (wake_.wait_for(lock, std::chrono::milliseconds(kReconnectDelayMs),
+                               [&] { return stop_; }))
+                break;
+            lock.unlock();
+            const bool reopened = capture_->reopen();
+            lock.lock();
+            if (reopened) stats_.reconnects++;
+            continue;
+        }
+
+        ready_.push_back(slot);
+        stats_.decoded++;
+        const auto  tNow = Clock::now();
+        const float dt   = std::chrono::duration<float>(tNow - tPrev).count();
+        tPrev = tNow;
+        if (dt > 0.f)
+            stats_.decodeFps = stats_.decodeFps > 0.f
+                             ? 0.9f * stats_.decodeFps + 0.1f / dt : 1.f / dt;
+        wake_.notify_all();
+
+        // A file decodes faster than real time; when dropping, play it at
+        // its own frame rate like a live source instead of skipping most of it
+        if (capture_->kind() == Kind::File && dropFrames_ && fileFps_ > 0.0) {
+            nextDue = std::max(nextDue + std::chrono::duration_cast<Clock::duration>(
+                                   std::chrono::duration<double>(1.0 / fileFps_)),
+                               tNow - std::chrono::milliseconds(100));
+            if (wake_.wait_until(lock, nextDue, [&] { return stop_; })) break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ended_ = true;
+    }
+    wake_.notify_all();
+}
@@ -7,13 +7,17 @@
  */
 
 #include "GUI.h"
+#include "Profiler.h"
+#include "TaskScheduler.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "imgui_stdlib.h"
 #include <GLFW/glfw3.h>
+#include <opencv2/core/ocl.hpp>
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
 #include <numeric>
 #include <map>
 #include <cstring>
@@ -38,6 +42,19 @@ bool GUI::init(int width, int height, const std::string& title)
     glfwMakeContextCurrent(window_);
     glfwSwapInterval(1);
 
+    // Input marks the panels for rebuilding; installed before the ImGui
+    // backend, which chains to them from its own callbacks
+    glfwSetWindowUserPointer(window_, this);
+    glfwSetCursorPosCallback(window_,   [](GLFWwindow* w, double, double) { markInput(w); });
+    glfwSetMouseButtonCallback(window_, [](GLFWwindow* w, int, int, int) { markInput(w); });
+    glfwSetScrollCallback(window_,      [](GLFWwindow* w, double, double) { markInput(w); });
+    glfwSetKeyCallback(window_,         [](GLFWwindow* w, int, int, int, int) { markInput(w); });
+    glfwSetCharCallback(window_,        [](GLFWwindow* w, unsigned int) { markInput(w); });
+    glfwSetCursorEnterCallback(window_, [](GLFWwindow* w, int) { markInput(w); });
+    glfwSetWindowFocusCallback(window_, [](GLFWwindow* w, int) { markInput(w); });
+    glfwSetWindowSizeCallback(window_,  [](GLFWwindow* w, int, int) { markInput(w); });
+    glfwSetWindowRefreshCallback(window_, markExposed);
+
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGui::StyleColorsDark();
@@ -59,8 +76,48 @@ bool GUI::init(int width, int height, const std::string& title)
 }
 
 void GUI::pollEvents() { glfwPollEvents(); }
+void GUI::waitEvents(double timeoutSec) { glfwWaitEventsTimeout(timeoutSec); }
+void GUI::wake() { glfwPostEmptyEvent(); }
 bool GUI::isOpen() const { return window_ && !glfwWindowShouldClose(window_); }
 
+void GUI::markInput(GLFWwindow* window)
+{
+    static_cast<GUI*>(glfwGetWindowUserPointer(window))->inputSeen_ = true;
+}
+
+void GUI::markExposed(GLFWwindow* window)
+{
+    static_cast<GUI*>(glfwGetWindowUserPointer(window))->exposed_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Redraw scheduling
+// -----------------------------------------------------------------------------
+bool GUI::needsFrame(bool changed)
+{
+    if (!initDone_) return false;
+
+    if (inputSeen_) {
+        inputSeen_    = false;
+        settleFrames_ = kSettleFrames;
+    }
+    const double now = glfwGetTime();
+    const bool   due = changed || settleFrames_ > 0 ||
+                       ImGui::GetIO().WantTextInput ||
+                       now - lastFrameTime_ >= kMaxIdleSec;
+    if (!due) return false;
+
+    if (settleFrames_ > 0) settleFrames_--;
+    lastFrameTime_ = now;
+    return true;
+}
+
+void GUI::repaint()
+{
+    // The draw data of the last ImGui::Render() stays valid until NewFrame()
+    if (initDone_ && exposed_ && ImGui::GetDrawData()) present();
+}
+
 void GUI::shutdown()
 {
     if (!initDone_) return;
@@ -78,6 +135,7 @@ void GUI::shutdown()
 void GUI::render(PipelineParams& params, AppState& state,
                   ObjectDB& db, Classifier& classifier,
                   Evaluator& evaluator, EmbeddingDB& embDB,
+                  ModelManager& models,
                   bool& showThresh, bool& showCleaned,
                   bool& showRegions, bool& showMatrix,
                   bool& showCrop)
@@ -109,6 +167,29 @@ void GUI::render(PipelineParams& params, AppState& state,
         ImGui::TextColored({0.f,1.f,0.8f,1.f}, "  [CNN Mode]");
     else
         ImGui::TextColored({0.8f,0.8f,0.f,1.f}, "  [Shape Feature Mode]");
+    ImGui::SameLine();
+    ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "  allocs: %d", state.regionAllocs);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Heap allocations made building the last region list\n"
+                          "(labels to regions, features, tracking, shape\n"
+                          "classification).  0 once the buffers have grown.");
+    if (state.embeddingMode_ && params.asyncEmbedding)
+        ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "Embed queue: %d  latency: %.0f ms",
+                           state.embedQueueDepth, state.embedLatencyMs);
+    if (state.embeddingMode_ && params.cnnCascade)
+        ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "CNN rate: %d%% of regions",
+                           static_cast<int>(state.cnnInvocationRate * 100.f + 0.5f));
+    if (!state.sourceName.empty()) {
+        ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "Decode: %d fps%s  dropped %lld / %lld",
+                           (int)state.decodeFps, state.hwDecode ? " (HW)" : "",
+                           state.framesDropped, state.framesDecoded);
+        ImGui::SameLine();
+        ImGui::Checkbox("Skip stale", &params.dropFrames);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("%s\nProcess only the newest frame when the pipeline\n"
+                              "falls behind (off: process every frame)",
+                              state.sourceName.c_str());
+    }
 
     ImGui::Spacing();
 
@@ -119,6 +200,10 @@ void GUI::render(PipelineParams& params, AppState& state,
     renderDBPanel(db, embDB, classifier);
     ImGui::Spacing();
     renderConfusionMatrix(evaluator);
+    ImGui::Spacing();
+    renderProfilerPanel();
+    ImGui::Spacing();
+    renderModelPanel(models, params, embDB);
 
     // -----------------------------------------------------------------
     // Auto-learn notification -- inline, no child window
@@ -139,10 +224,10 @@ void GUI::render(PipelineParams& params, AppState& state,
 
         if (confirm && strlen(autoLearnBuf_) > 0) {
             std::string lbl(autoLearnBuf_);
-            if (!state.autoLearnRegion.huMoments.empty()) {
+            if (state.autoLearnRegion.hasShape) {
                 DBEntry e = ObjectDB::entryFromRegion(state.autoLearnRegion, lbl);
                 db.append(e);
-                classifier.refit(db);
+                classifier.learn(db);
             }
             state.currentTrainLabel = lbl;
             state.captureRequested  = true;
@@ -157,9 +242,14 @@ void GUI::render(PipelineParams& params, AppState& state,
     }
 
     ImGui::End();
-
-    // Draw
     ImGui::Render();
+}
+
+// -----------------------------------------------------------------------------
+void GUI::present()
+{
+    if (!initDone_) return;
+
     int dw, dh;
     glfwGetFramebufferSize(window_, &dw, &dh);
     glViewport(0, 0, dw, dh);
@@ -167,6 +257,7 @@ void GUI::render(PipelineParams& params, AppState& state,
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     glfwSwapBuffers(window_);
+    exposed_ = false;
 }
 
 // =============================================================================
@@ -189,6 +280,14 @@ void GUI::renderPipelinePanel(PipelineParams& params,
     if (ImGui::SliderInt("##blur", &params.blurKernelSize, 1, 21))
         if (params.blurKernelSize % 2 == 0) params.blurKernelSize++;
 
+    const char* blurModes[] = {"Gaussian","Box","Stack"};
+    ImGui::Text("Blur Mode"); ImGui::SameLine(110);
+    ImGui::Combo("##blurmode", &params.blurMode, blurModes, 3);
+
+    const char* scales[] = {"Full","1/2","1/4"};
+    ImGui::Text("Resolution"); ImGui::SameLine(110);
+    ImGui::Combo("##downscale", &params.downscaleLevel, scales, 3);
+
     ImGui::Text("Thresh Mode");
     ImGui::SameLine();
     if (ImGui::RadioButton("Global##t",
@@ -201,6 +300,12 @@ void GUI::renderPipelinePanel(PipelineParams& params,
     if (ImGui::RadioButton("S+I##t", params.useSatIntensity))
     { params.useSatIntensity = true; params.useAdaptive = params.useKMeans = false; }
 
+    if (params.useKMeans) {
+        const char* dynModes[] = {"ISODATA","Otsu"};
+        ImGui::Text("Dynamic"); ImGui::SameLine(110);
+        ImGui::Combo("##dynthresh", &params.dynamicThresh, dynModes, 2);
+    }
+
     ImGui::Separator();
 
     const char* morphModes[] = {"Open","Close","Erode","Dilate"};
@@ -216,12 +321,71 @@ void GUI::renderPipelinePanel(PipelineParams& params,
 
     ImGui::Separator();
 
+    const char* labelModes[] = {"Parallel","Block 2x2","Sequential"};
+    ImGui::Text("Labeling"); ImGui::SameLine(110);
+    ImGui::Combo("##labelmode", &params.labelMode, labelModes, 3);
+
+    ImGui::Checkbox("Streamed pipeline", &params.streamPipeline);
+    ImGui::Checkbox("Skip empty tiles", &params.sparseTiles);
+
+    ImGui::BeginDisabled(!cv::ocl::haveOpenCL());
+    ImGui::Checkbox("OpenCL segmentation", &params.useOpenCL);
+    ImGui::EndDisabled();
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+        ImGui::SetTooltip(cv::ocl::haveOpenCL()
+                          ? "Blur, threshold and morphology on the OpenCL\n"
+                            "device; only the cleaned mask is downloaded.\n"
+                            "Replaces the streamed pipeline while on."
+                          : "No OpenCL device available");
+
+    ImGui::Checkbox("Motion gate", &params.motionGate);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Skip segmentation and classification while the\n"
+                          "scene is unchanged; the last regions are kept.");
+    if (params.motionGate) {
+        ImGui::SameLine();
+        ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "skipped %d%%",
+                           (int)(state.motionSkipRatio * 100.f + 0.5f));
+        ImGui::Text("Change"); ImGui::SameLine(110);
+        ImGui::SliderFloat("##motion", &params.motionThreshold, 0.05f, 10.f, "%.2f %%");
+        ImGui::Text("Refresh"); ImGui::SameLine(110);
+        ImGui::SliderInt("##motionrefresh", &params.motionRefresh, 0, 300, "every %d frames");
+    }
+
+    if (params.processRoi.area() > 0) {
+        ImGui::Text("ROI: %d,%d  %dx%d", params.processRoi.x, params.processRoi.y,
+                    params.processRoi.width, params.processRoi.height);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Clear##roi")) params.processRoi = cv::Rect();
+    } else {
+        ImGui::TextDisabled("ROI: full frame (drag in main window)");
+    }
+
     ImGui::Text("Min Area"); ImGui::SameLine(110);
     ImGui::SliderInt("##minarea", &params.minRegionArea, 100, 20000);
 
     ImGui::Text("Max Regions"); ImGui::SameLine(110);
     ImGui::SliderInt("##maxrgn", &params.maxRegions, 1, 5);
 
+    const char* momentModes[] = {"Runs","Contour"};
+    ImGui::Text("Moments"); ImGui::SameLine(110);
+    ImGui::Combo("##momentmode", &params.momentMode, momentModes, 2);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Runs: exact pixel moments from the labeller.\n"
+                          "Contour: Green's theorem on the traced boundary,\n"
+                          "oriented box from minAreaRect.  Retrain the shape\n"
+                          "DB after switching — values differ slightly.");
+
+    ImGui::Separator();
+
+    ImGui::Checkbox("Track regions", &params.trackRegions);
+
+    ImGui::Text("Reclassify"); ImGui::SameLine(110);
+    ImGui::SliderInt("##reclass", &params.trackReclassify, 1, 60, "every %d frames");
+
+    ImGui::Text("Drift"); ImGui::SameLine(110);
+    ImGui::SliderFloat("##drift", &params.trackDrift, 0.05f, 2.0f);
+
     ImGui::Separator();
 
     ImGui::Text("Confidence"); ImGui::SameLine(110);
@@ -233,6 +397,50 @@ void GUI::renderPipelinePanel(PipelineParams& params,
     const char* metrics[] = {"Euclidean","Cosine"};
     ImGui::Text("Metric"); ImGui::SameLine(110);
     ImGui::Combo("##metric", &params.distanceMetric, metrics, 2);
+    ImGui::Checkbox("Nearest class centroid", &params.nearestCentroid);
+
+    const char* dnnBackends[] = {"CPU","OpenCL","OpenCL FP16","CUDA","CUDA FP16","OpenVINO"};
+    ImGui::Text("DNN Backend"); ImGui::SameLine(110);
+    ImGui::Combo("##dnnbackend", &params.dnnBackend, dnnBackends, 6);
+    ImGui::Checkbox("Async CNN", &params.asyncEmbedding);
+    ImGui::Checkbox("Shape cascade", &params.cnnCascade);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("CNN mode classifies every region by shape first
+"
+                          "and only runs the network on unsure ones:
+"
+                          "unknown, below Cascade conf, or with a runner-up
+"
+                          "label closer than Margin x the best distance.");
+    if (params.cnnCascade) {
+        ImGui::Text("Cascade conf"); ImGui::SameLine(110);
+        ImGui::SliderFloat("##cascadeconf", &params.cascadeConfidence, 0.f, 1.f, "%.2f");
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Shape confidence, 1 / (1 + distance), a region
+"
+                              "needs to keep its shape label.");
+        ImGui::Text("Margin"); ImGui::SameLine(110);
+        ImGui::SliderFloat("##cascademargin", &params.cascadeMargin, 0.1f, 1.f, "%.2f");
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Best / runner-up label distance above which
+"
+                              "the shape answer counts as ambiguous.");
+    }
+    ImGui::Text("Prototypes"); ImGui::SameLine(110);
+    ImGui::SliderInt("##protos", &params.prototypesPerLabel, 0, 64,
+                     params.prototypesPerLabel > 0 ? "%d per label" : "all samples");
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Live CNN matching uses k-means prototypes per label,\n"
+                          "condensed in the background; the DB file keeps\n"
+                          "every sample.  0 matches all samples.");
+    if (state.prototypeCount > 0)
+        ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "Matching %d prototypes",
+                           state.prototypeCount);
+    ImGui::Checkbox("HNSW index", &params.embeddingIndex);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Approximate nearest-neighbour graph over the\n"
+                          "embedding DB, used from 2048 entries and saved\n"
+                          "beside it as embeddings.hnsw.");
 
     ImGui::PopItemWidth();
     ImGui::Separator();
@@ -303,12 +511,12 @@ void GUI::renderTrainingPanel(AppState& state,
     float btnW = (ImGui::GetContentRegionAvail().x - 8) * 0.5f;
 
     if (ImGui::Button("+ Shape Sample##train", {btnW, 28})) {
-        if (canCapture && !state.regions[0].huMoments.empty()) {
+        if (canCapture && state.regions[0].hasShape) {
             DBEntry e = ObjectDB::entryFromRegion(state.regions[0],
                                                    state.currentTrainLabel);
             db.append(e);
             state.samplesThisLabel++;
-            classifier.refit(db);
+            classifier.learn(db);
         }
     }
     ImGui::SameLine();
@@ -371,8 +579,7 @@ void GUI::renderDBPanel(ObjectDB& db, EmbeddingDB& embDB, Classifier& classifier
         if (embDB.empty()) {
             ImGui::TextDisabled("Empty -- capture embedding samples first.");
         } else {
-            std::map<std::string,int> embCounts;
-            for (const auto& e : embDB.entries()) embCounts[e.label]++;
+            auto embCounts = embDB.labelCounts();
             ImGui::Text("Total: %d entries", embDB.size());
             if (ImGui::BeginTable("embTable", 2,
                                    ImGuiTableFlags_Borders |
@@ -455,3 +662,183 @@ void GUI::renderConfusionMatrix(Evaluator& evaluator)
         ImGui::EndTable();
     }
 }
+
+// =============================================================================
+// Profiler
+// =============================================================================
+void GUI::renderProfilerPanel()
+{
+    if (!ImGui::CollapsingHeader("Profiler"))
+        return;
+
+    static const ImU32 colors[] = {
+        IM_COL32( 80, 160, 255, 255), IM_COL32(255, 160,  60, 255),
+        IM_COL32(120, 220, 120, 255), IM_COL32( 60, 200, 200, 255),
+        IM_COL32(230, 110, 110, 255), IM_COL32(200, 130, 255, 255),
+        IM_COL32(255, 220,  80, 255), IM_COL32(160, 160, 160, 255)};
+
+    const int n = static_cast<int>(ProfileStage::Count);
+    std::vector<Profiler::StageStats> stats(n);
+    float total = 0.f;
+    for (int i = 0; i < n; i++) {
+        stats[i] = Profiler::instance().stats(static_cast<ProfileStage>(i));
+        total   += stats[i].meanMs;
+    }
+
+    // Stacked bar: mean time per stage, full width = sum of stage means
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    const ImVec2 p0   = ImGui::GetCursorScreenPos();
+    const float  barW = ImGui::GetContentRegionAvail().x;
+    const float  barH = 18.f;
+    float x = p0.x;
+    for (int i = 0; i < n && total > 0.f; i++) {
+        const float w = barW * stats[i].meanMs / total;
+        if (w <= 0.f) continue;
+        draw->AddRectFilled({x, p0.y}, {x + w, p0.y + barH}, colors[i]);
+        x += w;
+    }
+    draw->AddRect(p0, {p0.x + barW, p0.y + barH}, IM_COL32(90, 90, 90, 255));
+    ImGui::Dummy({barW, barH});
+    ImGui::Text("Sum of stage means: %.2f ms", total);
+
+    // Per stage: history plot with mean / p95
+    // Allocations of the last call per stage, with CVCORE_ALLOC_TRACKING
+    const bool allocs = cvcore::allocTrackingEnabled();
+    if (ImGui::BeginTable("profTable", allocs ? 4 : 3, ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Stage", ImGuiTableColumnFlags_WidthFixed, 80.f);
+        ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("mean / p95 ms", ImGuiTableColumnFlags_WidthFixed, 100.f);
+        if (allocs)
+            ImGui::TableSetupColumn("new / Mat", ImGuiTableColumnFlags_WidthFixed, 70.f);
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < n; i++) {
+            const Profiler::StageStats& s = stats[i];
+            if (s.count == 0) continue;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(colors[i]), "%s",
+                               Profiler::stageName(static_cast<ProfileStage>(i)));
+            ImGui::TableSetColumnIndex(1);
+            ImGui::PushID(i);
+            ImGui::PushStyleColor(ImGuiCol_PlotLines, colors[i]);
+            ImGui::SetNextItemWidth(-1);
+            ImGui::PlotLines("##hist", s.history.data(), s.count, 0, nullptr,
+                             0.f, s.p95Ms * 1.5f + 0.01f, {0, 24});
+            ImGui::PopStyleColor();
+            ImGui::PopID();
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f / %.2f", s.meanMs, s.p95Ms);
+            if (allocs) {
+                const cvcore::AllocCounts last =
+                    Profiler::instance().allocStage(static_cast<ProfileStage>(i)).last();
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%llu / %llu", static_cast<unsigned long long>(last.heapCount),
+                            static_cast<unsigned long long>(last.matCount));
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Heap (operator new) and cv::Mat buffer allocations\n"
+                                      "of the stage's last call: %.1f KB / %.1f KB",
+                                      last.heapBytes / 1024.0, last.matBytes / 1024.0);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    // Shared worker pool: busy fraction per worker over the last ~0.5 s
+    const TaskScheduler::Stats sched = TaskScheduler::instance().stats();
+    if (!sched.workers.empty()) {
+        ImGui::Separator();
+        ImGui::Text("Task workers: %d   queued H/N/L: %d / %d / %d",
+                    static_cast<int>(sched.workers.size()),
+                    sched.queued[0], sched.queued[1], sched.queued[2]);
+        for (size_t i = 0; i < sched.workers.size(); i++) {
+            const TaskScheduler::WorkerStats& w = sched.workers[i];
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%.0f%%  %lld tasks, %lld stolen",
+                          w.utilisation * 100.f, w.tasks, w.steals);
+            ImGui::Text("W%-2d", static_cast<int>(i));
+            ImGui::SameLine(40);
+            ImGui::ProgressBar(w.utilisation, {-1, 0}, overlay);
+        }
+    }
+
+    if (ImGui::Button("Export trace##prof"))
+        Profiler::instance().exportChromeTrace("data/trace.json");
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##prof"))
+        Profiler::instance().clear();
+    ImGui::SameLine();
+    ImGui::TextDisabled("data/trace.json");
+}
+
+// =============================================================================
+// Models
+// =============================================================================
+void GUI::renderModelPanel(ModelManager& models, const PipelineParams& params,
+                           const EmbeddingDB& embDB)
+{
+    if (!ImGui::CollapsingHeader("Models"))
+        return;
+
+    const auto& list = models.models();
+    if (list.empty()) {
+        ImGui::TextDisabled("No .onnx models in data/models.");
+    } else {
+        modelIdx_ = std::clamp(modelIdx_, 0, static_cast<int>(list.size()) - 1);
+        ImGui::SetNextItemWidth(-1);
+        if (ImGui::BeginCombo("##model", list[modelIdx_].c_str())) {
+            for (int i = 0; i < static_cast<int>(list.size()); i++)
+                if (ImGui::Selectable(list[i].c_str(), i == modelIdx_)) modelIdx_ = i;
+            ImGui::EndCombo();
+        }
+
+        ImGui::BeginDisabled(models.busy());
+        if (ImGui::Button("Load##model"))
+            models.swapTo(list[modelIdx_], params.dnnBackend);
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+            ImGui::SetTooltip("Load in the background and swap in between frames.\n"
+                              "A model with another embedding size switches to\n"
+                              "its own database file.");
+        ImGui::SameLine();
+        if (ImGui::Button("Benchmark all##model"))
+            models.benchmark(params.dnnBackend);
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+            ImGui::SetTooltip("Load each model and time a batch of 8 crops\n"
+                              "on the selected DNN backend");
+        ImGui::EndDisabled();
+    }
+
+    const EmbeddingClassifier& classifier = models.classifier();
+    ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "In use: %s (%d-d)",
+                       classifier.modelPath().c_str(), classifier.embeddingDim());
+    ImGui::TextColored({0.5f,0.5f,0.5f,1.f}, "Database: %s (%d entries)",
+                       embDB.path().c_str(), embDB.size());
+    const std::string status = models.status();
+    if (!status.empty()) ImGui::TextWrapped("%s", status.c_str());
+
+    const auto results = models.results();
+    if (!results.empty() &&
+        ImGui::BeginTable("modelBench", 4,
+                          ImGuiTableFlags_Borders |
+                          ImGuiTableFlags_RowBg   |
+                          ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Model",    ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Dim",      ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableSetupColumn("Load ms",  ImGuiTableColumnFlags_WidthFixed, 60.f);
+        ImGui::TableSetupColumn("ms/crop",  ImGuiTableColumnFlags_WidthFixed, 60.f);
+        ImGui::TableHeadersRow();
+        for (const auto& r : results) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%s", r.name.c_str());
+            if (!r.ok) {
+                ImGui::TableSetColumnIndex(1);
+                ImGui::TextColored({1.f,0.4f,0.4f,1.f}, "failed");
+                continue;
+            }
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%d", r.dim);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.0f", r.loadMs);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.2f", r.msPerCrop);
+        }
+        ImGui::EndTable();
+    }
+}
@@ -0,0 +1,338 @@
+/**
+ * @file    HnswIndex.cpp
+ * @brief   Incremental HNSW graph implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "HnswIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <opencv2/core/hal/intrin.hpp>
+
+static const char kGraphMagic[4] = {'H', 'N', 'W', '1'};
+static const int  kMaxLevel      = 16;   ///< Cap on a node's top layer
+
+// =============================================================================
+// Internal — vector kernel (OpenCV universal intrinsics: AVX2 / NEON / ...)
+// =============================================================================
+float dotProduct(const float* a, const float* b, int n)
+{
+    int   i   = 0;
+    float sum = 0.f;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int step = cv::VTraits<cv::v_float32>::vlanes();
+    cv::v_float32 acc0 = cv::vx_setzero_f32();
+    cv::v_float32 acc1 = cv::vx_setzero_f32();
+    for (; i + 2 * step <= n; i += 2 * step) {
+        acc0 = cv::v_fma(cv::vx_load(a + i),        cv::vx_load(b + i),        acc0);
+        acc1 = cv::v_fma(cv::vx_load(a + i + step), cv::vx_load(b + i + step), acc1);
+    }
+    sum = cv::v_reduce_sum(cv::v_add(acc0, acc1));
+#endif
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+/** Cosine distance between a unit query and a unit row. */
+static inline float rowDistance(const cv::Mat& unit, const float* query, uint32_t row)
+{
+    return 1.f - dotProduct(query, unit.ptr<float>(static_cast<int>(row)), unit.cols);
+}
+
+/**
+ * Per-thread visited marks: a node is visited when its mark equals the
+ * current tag, so nothing is cleared between searches.
+ */
+struct VisitedMarks {
+    std::vector<uint32_t> marks;
+    uint32_t              tag = 0;
+
+    void begin(size_t n)
+    {
+        if (marks.size() < n) marks.resize(n, 0);
+        if (++tag == 0) {                       // wrapped: reset once
+            std::fill(marks.begin(), marks.end(), 0);
+            tag = 1;
+        }
+    }
+    bool visit(uint32_t node)
+    {
+        if (marks[node] == tag) return false;
+        marks[node] = tag;
+        return true;
+    }
+};
+
+// -----------------------------------------------------------------------------
+HnswIndex::HnswIndex(int m, int efConstruction)
+    : m_(std::max(2, m)), maxM0_(2 * std::max(2, m)),
+      efConstruction_(std::max(efConstruction, m)),
+      levelMult_(1.0 / std::log(static_cast<double>(std::max(2, m))))
+{
+}
+
+// -----------------------------------------------------------------------------
+void HnswIndex::clear()
+{
+    levels_.clear();
+    level0_.clear();
+    upper_.clear();
+    maxLevel_   = -1;
+    entryPoint_ = 0;
+    rng_.seed(0x4E5Cu);
+}
+
+// -----------------------------------------------------------------------------
+uint32_t* HnswIndex::links(uint32_t node, int level)
+{
+    if (level == 0) return &level0_[static_cast<size_t>(node) * (maxM0_ + 1)];
+    return &upper_[node][static_cast<size_t>(level - 1) * (m_ + 1)];
+}
+
+const uint32_t* HnswIndex::links(uint32_t node, int level) const
+{
+    if (level == 0) return &level0_[static_cast<size_t>(node) * (maxM0_ + 1)];
+    return &upper_[node][static_cast<size_t>(level - 1) * (m_ + 1)];
+}
+
+// -----------------------------------------------------------------------------
+void HnswIndex::greedyStep(const cv::Mat& unit, const float* query, int level,
+                           uint32_t& node, float& dist) const
+{
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        const uint32_t* list = links(node, level);
+        for (uint32_t j = 1; j <= list[0]; j++) {
+            const float d = rowDistance(unit, query, list[j]);
+            if (d < dist) {
+                dist     = d;
+                node     = list[j];
+                improved = true;
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+std::vector<HnswIndex::Neighbour> HnswIndex::searchLayer(const cv::Mat& unit,
+                                                         const float* query,
+                                                         uint32_t entry, float entryDist,
+                                                         int ef, int level) const
+{
+    thread_local VisitedMarks visited;
+    visited.begin(levels_.size());
+    visited.visit(entry);
+
+    // candidates: closest first; best: farthest first, at most ef
+    std::priority_queue<Neighbour, std::vector<Neighbour>, std::greater<Neighbour>> candidates;
+    std::priority_queue<Neighbour> best;
+    candidates.push({entryDist, entry});
+    best.push({entryDist, entry});
+
+    while (!candidates.empty()) {
+        const Neighbour c = candidates.top();
+        if (c.first > best.top().first && static_cast<int>(best.size()) >= ef) break;
+        candidates.pop();
+
+        const uint32_t* list = links(c.second, level);
+        for (uint32_t j = 1; j <= list[0]; j++) {
+            const uint32_t n = list[j];
+            if (!visited.visit(n)) continue;
+            const float d = rowDistance(unit, query, n);
+            if (static_cast<int>(best.size()) < ef || d < best.top().first) {
+                candidates.push({d, n});
+                best.push({d, n});
+                if (static_cast<int>(best.size()) > ef) best.pop();
+            }
+        }
+    }
+
+    std::vector<Neighbour> out(best.size());
+    for (size_t i = out.size(); i-- > 0; best.pop()) out[i] = best.top();
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<HnswIndex::Neighbour> HnswIndex::selectNeighbours(
+    const cv::Mat& unit, const std::vector<Neighbour>& ascending, int maxCount) const
+{
+    std::vector<Neighbour> kept;
+    for (const Neighbour& c : ascending) {
+        if (static_cast<int>(kept.size()) >= maxCount) break;
+        const float* v = unit.ptr<float>(static_cast<int>(c.second));
+        bool diverse = true;
+        for (const Neighbour& k : kept) {
+            if (rowDistance(unit, v, k.second) < c.first) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) kept.push_back(c);
+    }
+    return kept;
+}
+
+// -----------------------------------------------------------------------------
+void HnswIndex::connect(const cv::Mat& unit, uint32_t node, uint32_t neighbour,
+                        float dist, int level)
+{
+    uint32_t* list     = links(neighbour, level);
+    const int maxCount = level == 0 ? maxM0_ : m_;
+    if (static_cast<int>(list[0]) < maxCount) {
+        list[++list[0]] = node;
+        return;
+    }
+
+    // Full: keep the most diverse of the old list plus the new node
+    const float* v = unit.ptr<float>(static_cast<int>(neighbour));
+    std::vector<Neighbour> pool{{dist, node}};
+    for (uint32_t j = 1; j <= list[0]; j++)
+        pool.push_back({rowDistance(unit, v, list[j]), list[j]});
+    std::sort(pool.begin(), pool.end());
+
+    const std::vector<Neighbour> kept = selectNeighbours(unit, pool, maxCount);
+    list[0] = static_cast<uint32_t>(kept.size());
+    for (size_t j = 0; j < kept.size(); j++) list[j + 1] = kept[j].second;
+}
+
+// -----------------------------------------------------------------------------
+void HnswIndex::add(const cv::Mat& unit)
+{
+    const uint32_t node = static_cast<uint32_t>(levels_.size());
+    if (unit.type() != CV_32F || static_cast<int>(node) >= unit.rows) return;
+
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double u     = std::max(uniform(rng_), 1e-12);
+    const int    level = std::min(kMaxLevel, static_cast<int>(-std::log(u) * levelMult_));
+
+    levels_.push_back(static_cast<uint8_t>(level));
+    level0_.resize(level0_.size() + maxM0_ + 1, 0);
+    upper_.emplace_back(static_cast<size_t>(level) * (m_ + 1), 0);
+
+    if (maxLevel_ < 0) {
+        maxLevel_   = level;
+        entryPoint_ = node;
+        return;
+    }
+
+    const float* query = unit.ptr<float>(static_cast<int>(node));
+    uint32_t     entry = entryPoint_;
+    float        dist  = rowDistance(unit, query, entry);
+
+    for (int l = maxLevel_; l > level; l--)
+        greedyStep(unit, query, l, entry, dist);
+
+    for (int l = std::min(level, maxLevel_); l >= 0; l--) {
+        std::vector<Neighbour> found = searchLayer(unit, query, entry, dist,
+                                                   efConstruction_, l);
+        const std::vector<Neighbour> kept =
+            selectNeighbours(unit, found, l == 0 ? maxM0_ : m_);
+
+        uint32_t* list = links(node, l);
+        list[0] = static_cast<uint32_t>(kept.size());
+        for (size_t j = 0; j < kept.size(); j++) list[j + 1] = kept[j].second;
+        for (const Neighbour& n : kept) connect(unit, node, n.second, n.first, l);
+
+        entry = found.front().second;
+        dist  = found.front().first;
+    }
+
+    if (level > maxLevel_) {
+        maxLevel_   = level;
+        entryPoint_ = node;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void HnswIndex::search(const cv::Mat& unit, const float* query, int ef,
+                       std::vector<Neighbour>& out) const
+{
+    out.clear();
+    if (empty() || unit.rows < size()) return;
+
+    uint32_t entry = entryPoint_;
+    float    dist  = rowDistance(unit, query, entry);
+    for (int l = maxLevel_; l > 0; l--)
+        greedyStep(unit, query, l, entry, dist);
+    out = searchLayer(unit, query, entry, dist, std::max(1, ef), 0);
+}
+
+// -----------------------------------------------------------------------------
+bool HnswIndex::save(const std::string& path, int dim) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    const int32_t header[] = {dim, m_, size(), maxLevel_,
+                              static_cast<int32_t>(entryPoint_)};
+    file.write(kGraphMagic, 4);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levels_.data()),
+               static_cast<std::streamsize>(levels_.size()));
+    file.write(reinterpret_cast<const char*>(level0_.data()),
+               static_cast<std::streamsize>(level0_.size() * sizeof(uint32_t)));
+    for (const auto& up : upper_)
+        file.write(reinterpret_cast<const char*>(up.data()),
+                   static_cast<std::streamsize>(up.size() * sizeof(uint32_t)));
+    return static_cast<bool>(file);
+}
+
+// -----------------------------------------------------------------------------
+bool HnswIndex::load(const std::string& path, int dim, int maxRows)
+{
+    clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char    magic[4];
+    int32_t header[5] = {};
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    const int count = header[2];
+    if (!file || !std::equal(magic, magic + 4, kGraphMagic) || header[0] != dim ||
+        header[1] != m_ || count <= 0 || count > maxRows ||
+        header[3] < 0 || header[3] > kMaxLevel ||
+        header[4] < 0 || header[4] >= count)
+        return false;
+
+    levels_.resize(count);
+    level0_.resize(static_cast<size_t>(count) * (maxM0_ + 1));
+    file.read(reinterpret_cast<char*>(levels_.data()), count);
+    file.read(reinterpret_cast<char*>(level0_.data()),
+              static_cast<std::streamsize>(level0_.size() * sizeof(uint32_t)));
+    upper_.resize(count);
+    for (int i = 0; i < count && file; i++) {
+        if (levels_[i] > header[3]) { file.setstate(std::ios::failbit); break; }
+        upper_[i].resize(static_cast<size_t>(levels_[i]) * (m_ + 1));
+        file.read(reinterpret_cast<char*>(upper_[i].data()),
+                  static_cast<std::streamsize>(upper_[i].size() * sizeof(uint32_t)));
+    }
+    if (!file) {
+        clear();
+        return false;
+    }
+
+    // Every list must fit its layer and point at existing nodes
+    for (int i = 0; i < count; i++) {
+        for (int l = 0; l <= levels_[i]; l++) {
+            const uint32_t* list = links(static_cast<uint32_t>(i), l);
+            bool ok = list[0] <= static_cast<uint32_t>(l == 0 ? maxM0_ : m_);
+            for (uint32_t j = 1; ok && j <= list[0]; j++) ok = list[j] < static_cast<uint32_t>(count);
+            if (!ok) {
+                clear();
+                return false;
+            }
+        }
+    }
+
+    maxLevel_   = header[3];
+    entryPoint_ = static_cast<uint32_t>(header[4]);
+    // Continue the level sequence rather than replaying the first draws
+    rng_.discard(static_cast<unsigned long long>(count));
+    return true;
+}
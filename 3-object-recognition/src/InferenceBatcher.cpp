@@ -0,0 +1,118 @@
+/**
+ * @file    InferenceBatcher.cpp
+ * @brief   Cross-stream batched embedding implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "InferenceBatcher.h"
+#include <algorithm>
+#include <chrono>
+
+// -----------------------------------------------------------------------------
+InferenceBatcher::InferenceBatcher(EmbeddingClassifier& classifier, int maxBatch,
+                                   int maxWaitMs)
+    : classifier_(classifier),
+      maxBatch_(std::max(1, maxBatch)),
+      maxWaitMs_(std::max(0, maxWaitMs))
+{
+    worker_ = std::thread(&InferenceBatcher::run, this);
+}
+
+// -----------------------------------------------------------------------------
+InferenceBatcher::~InferenceBatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+// -----------------------------------------------------------------------------
+void InferenceBatcher::embed(const cv::Mat& frame, const std::vector<RegionInfo>& regions,
+                             std::vector<std::vector<float>>& embs)
+{
+    embs.assign(regions.size(), {});
+    if (regions.empty() || frame.empty()) return;
+
+    Request req{&frame, &regions, &embs};
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stop_) return;
+    pending_.push_back(&req);
+    wake_.notify_one();
+    done_.wait(lock, [&] { return req.done; });
+}
+
+// -----------------------------------------------------------------------------
+InferenceBatcher::Stats InferenceBatcher::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// -----------------------------------------------------------------------------
+void InferenceBatcher::run()
+{
+    std::vector<Request*>                  batch;
+    std::vector<EmbedRequest>              slots;
+    std::vector<std::vector<float>>        embs;
+
+    for (;;) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || !pending_.empty(); });
+            if (stop_) break;
+
+            // Give the other streams a moment to join this pass
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::milliseconds(maxWaitMs_);
+            size_t regions = 0;
+            for (;;) {
+                while (!pending_.empty() &&
+                       (batch.empty() ||
+                        regions + pending_.front()->regions->size() <= static_cast<size_t>(maxBatch_))) {
+                    regions += pending_.front()->regions->size();
+                    batch.push_back(pending_.front());
+                    pending_.pop_front();
+                }
+                if (regions >= static_cast<size_t>(maxBatch_) || !pending_.empty() || stop_)
+                    break;
+                if (!wake_.wait_until(lock, deadline,
+                                      [&] { return stop_ || !pending_.empty(); }))
+                    break;
+            }
+        }
+
+        // One forward pass over every waiting stream's regions
+        slots.clear();
+        for (Request* r : batch)
+            for (const auto& reg : *r->regions) slots.push_back({r->frame, &reg});
+
+        const auto t0 = std::chrono::steady_clock::now();
+        classifier_.computeEmbeddings(slots, embs);
+        const float ms = std::chrono::duration<float, std::milli>(
+                             std::chrono::steady_clock::now() - t0).count();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t k = 0;
+        for (Request* r : batch) {
+            for (auto& e : *r->embs) e = std::move(embs[k++]);
+            r->done = true;
+        }
+        stats_.batches++;
+        stats_.regions  += static_cast<long long>(slots.size());
+        stats_.meanBatch = static_cast<float>(stats_.regions) / stats_.batches;
+        stats_.latencyMs = stats_.latencyMs > 0.f ? 0.9f * stats_.latencyMs + 0.1f * ms : ms;
+        done_.notify_all();
+    }
+
+    // Release anyone still waiting
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Request* r : pending_) r->done = true;
+    pending_.clear();
+    done_.notify_all();
+}
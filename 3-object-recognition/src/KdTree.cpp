@@ -0,0 +1,107 @@
+/**
+ * @file    KdTree.cpp
+ * @brief   Static KD-tree implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "KdTree.h"
+#include <algorithm>
+#include <numeric>
+
+// -----------------------------------------------------------------------------
+void KdTree::build(const std::vector<double>& points, int dim)
+{
+    dim_    = dim;
+    points_ = points;
+    nodes_.clear();
+    index_.resize(dim > 0 ? points.size() / dim : 0);
+    std::iota(index_.begin(), index_.end(), 0);
+    if (!index_.empty()) buildNode(0, static_cast<int>(index_.size()));
+}
+
+// -----------------------------------------------------------------------------
+int KdTree::buildNode(int begin, int end)
+{
+    const int id = static_cast<int>(nodes_.size());
+    nodes_.push_back({});
+    nodes_[id].begin = begin;
+    nodes_[id].end   = end;
+    if (end - begin <= kLeafSize) return id;
+
+    // Split the widest dimension at its median
+    int    bestDim    = 0;
+    double bestSpread = -1.0;
+    for (int d = 0; d < dim_; d++) {
+        double lo = points_[static_cast<size_t>(index_[begin]) * dim_ + d], hi = lo;
+        for (int i = begin + 1; i < end; i++) {
+            const double v = points_[static_cast<size_t>(index_[i]) * dim_ + d];
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        if (hi - lo > bestSpread) { bestSpread = hi - lo; bestDim = d; }
+    }
+    if (bestSpread <= 0.0) return id; // all points identical — keep as a leaf
+
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(index_.begin() + begin, index_.begin() + mid, index_.begin() + end,
+                     [&](int a, int b) {
+                         return points_[static_cast<size_t>(a) * dim_ + bestDim] <
+                                points_[static_cast<size_t>(b) * dim_ + bestDim];
+                     });
+
+    const double split = points_[static_cast<size_t>(index_[mid]) * dim_ + bestDim];
+    const int left  = buildNode(begin, mid);
+    const int right = buildNode(mid, end);
+    nodes_[id].dim   = bestDim;
+    nodes_[id].split = split;
+    nodes_[id].left  = left;
+    nodes_[id].right = right;
+    return id;
+}
+
+// -----------------------------------------------------------------------------
+void KdTree::knn(const double* query, int k, std::vector<Neighbour>& out) const
+{
+    out.clear();
+    if (index_.empty() || k <= 0) return;
+    out.reserve(k);
+    search(0, query, k, out);            // max-heap on distance
+    std::sort_heap(out.begin(), out.end());
+}
+
+// -----------------------------------------------------------------------------
+void KdTree::search(int nodeId, const double* query, int k,
+                    std::vector<Neighbour>& heap) const
+{
+    const Node& node = nodes_[nodeId];
+
+    if (node.dim < 0) {
+        for (int i = node.begin; i < node.end; i++) {
+            const double* p = &points_[static_cast<size_t>(index_[i]) * dim_];
+            double d2 = 0.0;
+            for (int d = 0; d < dim_; d++) {
+                const double diff = query[d] - p[d];
+                d2 += diff * diff;
+            }
+            if (static_cast<int>(heap.size()) < k) {
+                heap.push_back({d2, index_[i]});
+                std::push_heap(heap.begin(), heap.end());
+            } else if (d2 < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = {d2, index_[i]};
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    // Nearer side first, then the far side only if the plane is close enough
+    const double diff = query[node.dim] - node.split;
+    const int    near = diff <= 0.0 ? node.left  : node.right;
+    const int    far  = diff <= 0.0 ? node.right : node.left;
+    search(near, query, k, heap);
+    if (static_cast<int>(heap.size()) < k || diff * diff < heap.front().first)
+        search(far, query, k, heap);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file    ModelManager.cpp
+ * @brief   Background embedding-model hot-swap and benchmark implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "ModelManager.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+static const char* kDefaultModelStem = "resnet18-v2-7";
+
+// -----------------------------------------------------------------------------
+ModelManager::ModelManager(EmbeddingClassifier& classifier, EmbeddingDB& db,
+                           std::mutex& modelMutex)
+    : classifier_(classifier), db_(db), modelMutex_(modelMutex)
+{
+}
+
+// -----------------------------------------------------------------------------
+ModelManager::~ModelManager()
+{
+    if (worker_.joinable()) worker_.join();
+}
+
+// -----------------------------------------------------------------------------
+void ModelManager::scan(const std::string& dir)
+{
+    models_.clear();
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".onnx")
+            models_.push_back(entry.path().generic_string());
+    std::sort(models_.begin(), models_.end());
+}
+
+// -----------------------------------------------------------------------------
+std::string ModelManager::dbPathFor(const std::string& modelPath)
+{
+    const std::string stem = std::filesystem::path(modelPath).stem().string();
+    if (stem == kDefaultModelStem) return "data/db/embeddings.bin";
+    return "data/db/embeddings_" + stem + ".bin";
+}
+
+// -----------------------------------------------------------------------------
+bool ModelManager::swapTo(const std::string& path, int dnnBackend)
+{
+    return launch([this, path, dnnBackend] { runSwap(path, dnnBackend); });
+}
+
+// -----------------------------------------------------------------------------
+bool ModelManager::benchmark(int dnnBackend)
+{
+    const std::vector<std::string> paths = models_;
+    return launch([this, paths, dnnBackend] { runBenchmark(paths, dnnBackend); });
+}
+
+// -----------------------------------------------------------------------------
+std::string ModelManager::status() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<ModelManager::BenchResult> ModelManager::results() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_;
+}
+
+// -----------------------------------------------------------------------------
+bool ModelManager::launch(std::function<void()> job)
+{
+    bool expected = false;
+    if (!busy_.compare_exchange_strong(expected, true)) return false;
+    if (worker_.joinable()) worker_.join();   // previous job has finished
+    worker_ = std::thread([this, job] {
+        TaskScheduler::setThreadPriority(TaskPriority::Low);   // re-embedding yields to frames
+        job();
+        busy_ = false;
+    });
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void ModelManager::setStatus(const std::string& msg)
+{
+    std::cout << "[ModelManager] " << msg << "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_ = msg;
+}
+
+// -----------------------------------------------------------------------------
+void ModelManager::runSwap(const std::string& path, int dnnBackend)
+{
+    const std::string name = std::filesystem::path(path).filename().string();
+    setStatus("Loading " + name + "...");
+
+    // Read and probe while the current model keeps serving
+    LoadedModel model;
+    if (!EmbeddingClassifier::prepareModel(path, dnnBackend, model)) {
+        setStatus("Failed to load " + name);
+        return;
+    }
+    const int dim = model.dim;
+
+    std::ostringstream msg;
+    msg << "Using " << name << " (" << dim << "-d)";
+    {
+        std::lock_guard<std::mutex> lock(modelMutex_);
+        classifier_.swapModel(std::move(model));
+
+        // Stored vectors from another embedding space are meaningless here
+        if (!db_.empty() && db_.dim() != dim) {
+            db_.open(dbPathFor(path));
+            msg << ", database " << db_.path() << " (" << db_.size() << " entries)";
+        }
+    }
+    setStatus(msg.str());
+}
+
+// -----------------------------------------------------------------------------
+void ModelManager::runBenchmark(const std::vector<std::string>& paths, int dnnBackend)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.clear();
+    }
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        BenchResult r;
+        r.name = std::filesystem::path(paths[i]).filename().string();
+        setStatus("Benchmarking " + r.name + " (" + std::to_string(i + 1) + "/" +
+                  std::to_string(paths.size()) + ")...");
+
+        const auto t0 = std::chrono::steady_clock::now();
+        LoadedModel model;
+        if (EmbeddingClassifier::prepareModel(paths[i], dnnBackend, model)) {
+            r.loadMs = std::chrono::duration<float, std::milli>(
+                           std::chrono::steady_clock::now() - t0).count();
+            r.dim       = model.dim;
+            r.msPerCrop = EmbeddingClassifier::benchmark(model);
+            r.ok        = r.msPerCrop >= 0.f;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.push_back(r);
+    }
+    setStatus("Benchmarked " + std::to_string(paths.size()) + " models");
+}
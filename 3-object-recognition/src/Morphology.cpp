@@ -6,125 +6,232 @@
  *          cv::erode, cv::dilate, or cv::morphologyEx.  Only basic
  *          cv::Mat pixel access is used.
  *
+ *          The host path is the shared bit-packed implementation in
+ *          cvcore/morphology.hpp.  The mask is bit-packed (64 pixels per
+ *          word, bit i of word w = column 64w+i) and the square structuring
+ *          element is applied as two separable 1-D passes:
+ *            Rows    — AND/OR of shifted copies of the row, with window
+ *                      doubling: O(log k) word operations per 64 pixels.
+ *            Columns — van Herk / Gil-Werman block prefix and suffix
+ *                      AND/OR: three word operations per 64 pixels,
+ *                      independent of k.
+ *          Repeated passes are fused: n iterations of a k x k element equal
+ *          one pass of n*(k-1)+1 (e.g. 3 x k=5 -> k=13), because outside the
+ *          image counts as foreground for erosion and background for
+ *          dilation — the identity of AND and OR respectively.
+ *
+ *          With a tile occupancy the same kernel runs only on strips of
+ *          occupied 32x32 tiles padded by the window half (grown by it for
+ *          dilation); empty tiles of the output are zeroed.
+ *
+ *          The device (cv::UMat) versions apply the same fused square as a
+ *          row and a column OpenCL kernel, one work-item per pixel scanning
+ *          its 2*half+1 window; pixels outside the image are skipped, which
+ *          gives the same border behaviour.
+ *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
  */
 
 #include "Morphology.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cvcore/morphology.hpp>
+#include <opencv2/core/ocl.hpp>
 
 // -----------------------------------------------------------------------------
-// Internal helper — single-pass erosion
+// Internal
 // -----------------------------------------------------------------------------
-static void erodeOnce(const cv::Mat& src, cv::Mat& dst, int kSize)
+
+/** Clamp and enforce odd kernel size. */
+static int oddKernel(int kSize)
 {
-    CV_Assert(src.type() == CV_8UC1);
+    if (kSize < 1) kSize = 1;
+    if (kSize % 2 == 0) kSize++;
+    return kSize;
+}
 
-    int half = kSize / 2;
-
-    // Pad with 255 (foreground) so border pixels are not incorrectly eroded
-    cv::Mat padded;
-    cv::copyMakeBorder(src, padded, half, half, half, half,
-                       cv::BORDER_CONSTANT, cv::Scalar(255));
-
-    dst = cv::Mat::zeros(src.size(), CV_8UC1);
-
-    for (int r = 0; r < src.rows; r++) {
-        for (int c = 0; c < src.cols; c++) {
-            bool allFg = true;
-            for (int dr = 0; dr < kSize && allFg; dr++) {
-                const uchar* row = padded.ptr<uchar>(r + dr);
-                for (int dc = 0; dc < kSize && allFg; dc++) {
-                    if (row[c + dc] == 0) allFg = false;
-                }
-            }
-            dst.at<uchar>(r, c) = allFg ? 255 : 0;
-        }
-    }
+/** Half window of iters fused passes of a kSize square. */
+static int fusedHalf(int kSize, int iters)
+{
+    return std::max(0, iters) * (oddKernel(kSize) / 2);
+}
+
+// -----------------------------------------------------------------------------
+void erodeCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters)
+{
+    cvcore::erodeBinary(src, dst, fusedHalf(kSize, iters));
+}
+
+// -----------------------------------------------------------------------------
+void dilateCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters)
+{
+    cvcore::dilateBinary(src, dst, fusedHalf(kSize, iters));
+}
+
+// -----------------------------------------------------------------------------
+void erodeCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters,
+                 const cvcore::TileOccupancy& tiles, cvcore::TileOccupancy* dstTiles)
+{
+    cvcore::erodeBinary(src, dst, fusedHalf(kSize, iters), tiles, dstTiles);
+}
+
+// -----------------------------------------------------------------------------
+void dilateCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters,
+                  const cvcore::TileOccupancy& tiles, cvcore::TileOccupancy* dstTiles)
+{
+    cvcore::dilateBinary(src, dst, fusedHalf(kSize, iters), tiles, dstTiles);
 }
 
 // -----------------------------------------------------------------------------
-// Internal helper — single-pass dilation
+// Internal — OpenCL kernels for the device path
 // -----------------------------------------------------------------------------
-static void dilateOnce(const cv::Mat& src, cv::Mat& dst, int kSize)
+static const char* kMorphKernels = R"CLC(
+__kernel void morphRow(__global const uchar* src, int srcStep, int srcOffset,
+                       __global uchar* dst, int dstStep, int dstOffset,
+                       int rows, int cols, int half, int erode)
+{
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if (x >= cols || y >= rows) return;
+
+    __global const uchar* s = src + srcOffset + y * srcStep;
+    const int lo = max(x - half, 0);
+    const int hi = min(x + half, cols - 1);
+    uchar acc = erode ? 255 : 0;
+    for (int i = lo; i <= hi; i++) {
+        const uchar v = s[i] ? 255 : 0;
+        acc = erode ? min(acc, v) : max(acc, v);
+    }
+    dst[dstOffset + y * dstStep + x] = acc;
+}
+
+__kernel void morphCol(__global const uchar* src, int srcStep, int srcOffset,
+                       __global uchar* dst, int dstStep, int dstOffset,
+                       int rows, int cols, int half, int erode)
+{
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if (x >= cols || y >= rows) return;
+
+    __global const uchar* s = src + srcOffset + x;
+    const int lo = max(y - half, 0);
+    const int hi = min(y + half, rows - 1);
+    uchar acc = erode ? 255 : 0;
+    for (int i = lo; i <= hi; i++) {
+        const uchar v = s[i * srcStep] ? 255 : 0;
+        acc = erode ? min(acc, v) : max(acc, v);
+    }
+    dst[dstOffset + y * dstStep + x] = acc;
+}
+)CLC";
+
+/** One separable pass (row or column) on the device; false without OpenCL. */
+static bool morphPassDevice(const cv::UMat& src, cv::UMat& dst, int half,
+                            bool erode, bool rows)
+{
+    static const cv::ocl::ProgramSource source(kMorphKernels);
+    cv::ocl::Kernel kernel(rows ? "morphRow" : "morphCol", source);
+    if (kernel.empty()) return false;
+
+    dst.create(src.size(), CV_8UC1);
+    kernel.args(cv::ocl::KernelArg::ReadOnlyNoSize(src),
+                cv::ocl::KernelArg::WriteOnly(dst),
+                half, erode ? 1 : 0);
+    size_t global[2] = {static_cast<size_t>(src.cols), static_cast<size_t>(src.rows)};
+    return kernel.run(2, global, nullptr, false);
+}
+
+/** Fused erosion / dilation on the device: iters passes of kSize. */
+static bool morphDevice(const cv::UMat& src, cv::UMat& dst, int kSize, int iters,
+                        bool erode)
 {
     CV_Assert(src.type() == CV_8UC1);
+    if (!cv::ocl::useOpenCL()) return false;
+
+    // Even with no window the output is normalised to 0 / 255
+    const int half = fusedHalf(kSize, iters);
+    cv::UMat tmp;
+    return morphPassDevice(src, tmp, half, erode, true) &&
+           morphPassDevice(tmp, dst, half, erode, false);
+}
 
-    int half = kSize / 2;
-
-    // Pad with 0 (background) so border pixels are not incorrectly dilated
-    cv::Mat padded;
-    cv::copyMakeBorder(src, padded, half, half, half, half,
-                       cv::BORDER_CONSTANT, cv::Scalar(0));
-
-    dst = cv::Mat::zeros(src.size(), CV_8UC1);
-
-    for (int r = 0; r < src.rows; r++) {
-        for (int c = 0; c < src.cols; c++) {
-            bool anyFg = false;
-            for (int dr = 0; dr < kSize && !anyFg; dr++) {
-                const uchar* row = padded.ptr<uchar>(r + dr);
-                for (int dc = 0; dc < kSize && !anyFg; dc++) {
-                    if (row[c + dc] == 255) anyFg = true;
-                }
-            }
-            dst.at<uchar>(r, c) = anyFg ? 255 : 0;
-        }
+/** Host fallback for a device-memory mask. */
+static void morphHost(const cv::UMat& src, cv::UMat& dst, int kSize, int iters,
+                      bool erode)
+{
+    cv::Mat out;
+    {
+        const cv::Mat in = src.getMat(cv::ACCESS_READ);
+        if (erode) erodeCustom(in, out, kSize, iters);
+        else       dilateCustom(in, out, kSize, iters);
     }
+    out.copyTo(dst);
 }
 
 // -----------------------------------------------------------------------------
-void erodeCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters)
+void erodeCustom(const cv::UMat& src, cv::UMat& dst, int kSize, int iters)
 {
-    // Clamp and enforce odd kernel size
-    if (kSize < 1) kSize = 1;
-    if (kSize % 2 == 0) kSize++;
+    if (!morphDevice(src, dst, kSize, iters, true))
+        morphHost(src, dst, kSize, iters, true);
+}
 
-    cv::Mat cur = src.clone();
-    cv::Mat tmp;
-    for (int i = 0; i < iters; i++) {
-        erodeOnce(cur, tmp, kSize);
-        cur = tmp;
-    }
-    dst = cur;
+// -----------------------------------------------------------------------------
+void dilateCustom(const cv::UMat& src, cv::UMat& dst, int kSize, int iters)
+{
+    if (!morphDevice(src, dst, kSize, iters, false))
+        morphHost(src, dst, kSize, iters, false);
 }
 
 // -----------------------------------------------------------------------------
-void dilateCustom(const cv::Mat& src, cv::Mat& dst, int kSize, int iters)
+void applyMorphology(const cv::UMat& src, cv::UMat& dst,
+                     const PipelineParams& params)
 {
-    if (kSize < 1) kSize = 1;
-    if (kSize % 2 == 0) kSize++;
+    ProfileScope profile(ProfileStage::Morphology);
+
+    const int k    = oddKernel(params.morphKernelSize);
+    const int iter = params.morphIterations;
+
+    cv::UMat mid;
+    switch (params.morphMode) {
+        case 0: // Open: erode → dilate
+            erodeCustom(src, mid, k, iter);
+            dilateCustom(mid, dst, k, iter);
+            break;
 
-    cv::Mat cur = src.clone();
-    cv::Mat tmp;
-    for (int i = 0; i < iters; i++) {
-        dilateOnce(cur, tmp, kSize);
-        cur = tmp;
+        case 1: // Close: dilate → erode
+            dilateCustom(src, mid, k, iter);
+            erodeCustom(mid, dst, k, iter);
+            break;
+
+        case 2: erodeCustom(src, dst, k, iter);  break;
+        case 3: dilateCustom(src, dst, k, iter); break;
+
+        default:
+            src.copyTo(dst);
+            break;
     }
-    dst = cur;
 }
 
 // -----------------------------------------------------------------------------
 void applyMorphology(const cv::Mat& src, cv::Mat& dst,
                      const PipelineParams& params)
 {
-    int k    = params.morphKernelSize;
+    ProfileScope profile(ProfileStage::Morphology);
+
+    int k    = oddKernel(params.morphKernelSize);
     int iter = params.morphIterations;
 
+    // Open / close stay packed between the two halves
     switch (params.morphMode) {
         case 0: // Open: erode → dilate (removes noise)
-        {
-            cv::Mat eroded;
-            erodeCustom(src, eroded, k, iter);
-            dilateCustom(eroded, dst, k, iter);
+            cvcore::openBinary(src, dst, fusedHalf(k, iter));
             break;
-        }
+
         case 1: // Close: dilate → erode (fills holes)
-        {
-            cv::Mat dilated;
-            dilateCustom(src, dilated, k, iter);
-            erodeCustom(dilated, dst, k, iter);
+            cvcore::closeBinary(src, dst, fusedHalf(k, iter));
             break;
-        }
+
         case 2: // Erode only
             erodeCustom(src, dst, k, iter);
             break;
@@ -138,3 +245,38 @@ void applyMorphology(const cv::Mat& src, cv::Mat& dst,
             break;
     }
 }
+
+// -----------------------------------------------------------------------------
+void applyMorphology(const cv::Mat& src, cv::Mat& dst, const PipelineParams& params,
+                     const cvcore::TileOccupancy& tiles, cvcore::TileOccupancy& dstTiles)
+{
+    ProfileScope profile(ProfileStage::Morphology);
+
+    int k    = oddKernel(params.morphKernelSize);
+    int iter = params.morphIterations;
+
+    switch (params.morphMode) {
+        case 0: cvcore::openBinary(src, dst, fusedHalf(k, iter), tiles, &dstTiles);  break;
+        case 1: cvcore::closeBinary(src, dst, fusedHalf(k, iter), tiles, &dstTiles); break;
+        case 2: erodeCustom(src, dst, k, iter, tiles, &dstTiles);                   break;
+        case 3: dilateCustom(src, dst, k, iter, tiles, &dstTiles);                  break;
+
+        default:
+            dst = src.clone();
+            dstTiles = tiles;
+            break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+int morphologyReach(const PipelineParams& params)
+{
+    int half = fusedHalf(params.morphKernelSize, params.morphIterations);
+    switch (params.morphMode) {
+        case 0:
+        case 1:  return 2 * half; // both halves spread errors from a cut edge
+        case 2:
+        case 3:  return half;
+        default: return 0;
+    }
+}
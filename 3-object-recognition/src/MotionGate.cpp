@@ -0,0 +1,88 @@
+/**
+ * @file    MotionGate.cpp
+ * @brief   Frame-change detector implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "MotionGate.h"
+#include <algorithm>
+#include <cstdlib>
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+/**
+ * Sum of the luminance of a 2x2 block ((B + 2G + R) / 4 per pixel, so the
+ * sum is four times the mean grey level).
+ */
+static inline int blockLuma(const cv::Mat& img, int x, int y)
+{
+    if (img.channels() == 1) {
+        const uint8_t* r0 = img.ptr<uint8_t>(y);
+        const uint8_t* r1 = img.ptr<uint8_t>(y + 1);
+        return r0[x] + r0[x + 1] + r1[x] + r1[x + 1];
+    }
+    const int      cn = img.channels();
+    const uint8_t* r0 = img.ptr<uint8_t>(y)     + x * cn;
+    const uint8_t* r1 = img.ptr<uint8_t>(y + 1) + x * cn;
+    const int sum = r0[0] + 2 * r0[1] + r0[2] + r0[cn] + 2 * r0[cn + 1] + r0[cn + 2]
+                  + r1[0] + 2 * r1[1] + r1[2] + r1[cn] + 2 * r1[cn + 1] + r1[cn + 2];
+    return sum >> 2;
+}
+
+// -----------------------------------------------------------------------------
+bool MotionGate::update(const cv::Mat& frame, const cv::Rect& roi,
+                        const PipelineParams& params, bool force)
+{
+    if (!params.motionGate || frame.empty() || frame.depth() != CV_8U) {
+        reset();
+        skipRatio_ = 0.f;
+        return true;
+    }
+
+    const cv::Rect area = roi.area() > 0
+                        ? roi & cv::Rect(0, 0, frame.cols, frame.rows)
+                        : cv::Rect(0, 0, frame.cols, frame.rows);
+    if (area.width < 2 || area.height < 2) return true;
+    const cv::Mat view = frame(area);
+
+    // --- Sample the grid (cell centres, 2x2 blocks) ---------------------------
+    samples_.resize(kGridW * kGridH);
+    for (int gy = 0; gy < kGridH; gy++) {
+        const int y = std::min(area.height - 2, (2 * gy + 1) * area.height / (2 * kGridH));
+        for (int gx = 0; gx < kGridW; gx++) {
+            const int x = std::min(area.width - 2, (2 * gx + 1) * area.width / (2 * kGridW));
+            samples_[gy * kGridW + gx] = static_cast<uint16_t>(blockLuma(view, x, y));
+        }
+    }
+
+    // --- Changed fraction against the last processed frame --------------------
+    bool process = force || reference_.empty() || area.size() != size_;
+    if (!process) {
+        int changed = 0;
+        for (size_t i = 0; i < samples_.size(); i++)
+            changed += std::abs(samples_[i] - reference_[i]) > 4 * kPixelDelta;
+        changed_ = static_cast<float>(changed) / samples_.size();
+
+        // Hysteresis: settle below half the threshold that starts motion
+        const float high = params.motionThreshold / 100.f;
+        const bool  wasMoving = moving_;
+        moving_ = changed_ > (moving_ ? 0.5f * high : high);
+
+        process = wasMoving || moving_ ||
+                  (params.motionRefresh > 0 && sinceRefresh_ + 1 >= params.motionRefresh);
+    }
+
+    if (process) {
+        reference_.swap(samples_);
+        size_         = area.size();
+        sinceRefresh_ = 0;
+    } else {
+        sinceRefresh_++;
+    }
+    skipRatio_ += kAverage * ((process ? 0.f : 1.f) - skipRatio_);
+    return process;
+}
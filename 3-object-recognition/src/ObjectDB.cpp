@@ -1,6 +1,6 @@
 /**
  * @file    ObjectDB.cpp
- * @brief   Object database implementation — CSV-based feature vector store.
+ * @brief   Object database implementation — memory-mapped binary feature store.
  *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
@@ -11,8 +11,25 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 
+static const char kBinaryMagic[4] = {'O', 'B', 'J', '1'};
+static constexpr size_t kLabelBytes   = 32;   ///< Per label slot, NUL-padded
+static constexpr int    kMinLabelSlots = 64;
+
+/** Sibling of a path with another extension (e.g. .bin → .csv). */
+static std::string withExtension(const std::string& path, const char* ext)
+{
+    return std::filesystem::path(path).replace_extension(ext).string();
+}
+
+/** Bytes before the first record. */
+static size_t headerBytes(int labelSlots)
+{
+    return 16 + static_cast<size_t>(labelSlots) * kLabelBytes;
+}
+
 // -----------------------------------------------------------------------------
 // DBEntry
 // -----------------------------------------------------------------------------
@@ -34,28 +51,136 @@ std::vector<double> DBEntry::toFeatureVector() const
 // ObjectDB
 // -----------------------------------------------------------------------------
 ObjectDB::ObjectDB(const std::string& filepath)
-    : filepath_(filepath)
+    : filepath_(withExtension(filepath, ".bin"))
 {
-    // Auto-load if file exists
+    // Auto-load if the file or a legacy CSV exists
     std::ifstream f(filepath_);
-    if (f.good()) load();
+    std::ifstream legacy(withExtension(filepath_, ".csv"));
+    if (f.good() || legacy.good()) load();
 }
 
 // -----------------------------------------------------------------------------
 bool ObjectDB::load()
 {
-    std::ifstream file(filepath_);
-    if (!file.is_open()) {
-        std::cerr << "[ObjectDB] Cannot open: " << filepath_ << "\n";
+    clear();
+
+    if (!std::ifstream(filepath_).good()) {
+        // One-time import of the legacy CSV database
+        const std::string csv = withExtension(filepath_, ".csv");
+        if (!loadCsv(csv)) {
+            std::cerr << "[ObjectDB] Cannot open: " << filepath_ << "\n";
+            return false;
+        }
+        if (!empty() && save())
+            std::cout << "[ObjectDB] Converted " << csv << " to "
+                      << filepath_ << "\n";
+    } else if (!mapFile()) {
+        std::cerr << "[ObjectDB] Not an object DB: " << filepath_ << "\n";
         return false;
     }
 
-    entries_.clear();
-    std::string line;
-    int lineNum = 0;
+    std::cout << "[ObjectDB] Loaded " << size()
+              << " entries from " << filepath_ << "\n";
+    return true;
+}
 
+// -----------------------------------------------------------------------------
+bool ObjectDB::mapFile()
+{
+    if (!map_.open(filepath_)) return false;
+
+    uint32_t hdr[4] = {0, 0, 0, 0};
+    if (map_.size() >= sizeof(hdr)) std::memcpy(hdr, map_.data(), sizeof(hdr));
+    const int slots = static_cast<int>(hdr[1]);
+    const int count = static_cast<int>(hdr[2]);
+    if (map_.size() < sizeof(hdr) || std::memcmp(map_.data(), kBinaryMagic, 4) != 0 ||
+        slots <= 0 || count < 0 || count > slots ||
+        map_.size() < headerBytes(slots)) {
+        map_.close();
+        return false;
+    }
+
+    labels_.clear();
+    for (int i = 0; i < count; i++) {
+        const char* name = map_.data() + 16 + i * kLabelBytes;
+        labels_.emplace_back(name, std::find(name, name + kLabelBytes, '\0'));
+    }
+    labelSlots_ = slots;
+
+    // Records are used in place; a torn trailing record is ignored
+    records_ = reinterpret_cast<const DBRecord*>(map_.data() + headerBytes(slots));
+    count_   = static_cast<int>((map_.size() - headerBytes(slots)) / sizeof(DBRecord));
+    for (int i = 0; i < count_; i++) {
+        if (records_[i].label < 0 || records_[i].label >= count) {
+            std::cerr << "[ObjectDB] Bad record " << i << ", ignoring the rest of "
+                      << filepath_ << "\n";
+            count_ = i;
+            break;
+        }
+    }
+    owned_.clear();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void ObjectDB::detach()
+{
+    // Copy the records out so the file can be written
+    if (map_.isOpen()) {
+        owned_.assign(records_, records_ + count_);
+        map_.close();
+        records_ = owned_.data();
+    }
+}
+
+// -----------------------------------------------------------------------------
+bool ObjectDB::writeFile() const
+{
+    std::filesystem::path p(filepath_);
+    if (p.has_parent_path())
+        std::filesystem::create_directories(p.parent_path());
+
+    std::ofstream file(filepath_, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    // Spare slots so new labels can be appended in place
+    const int slots = std::max(kMinLabelSlots, 2 * static_cast<int>(labels_.size()));
+    const uint32_t hdr[3] = {static_cast<uint32_t>(slots),
+                             static_cast<uint32_t>(labels_.size()), 0};
+    file.write(kBinaryMagic, 4);
+    file.write(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+
+    std::vector<char> names(static_cast<size_t>(slots) * kLabelBytes, 0);
+    for (size_t i = 0; i < labels_.size(); i++)
+        labels_[i].copy(&names[i * kLabelBytes], kLabelBytes - 1);
+    file.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    file.write(reinterpret_cast<const char*>(records_),
+               static_cast<std::streamsize>(count_ * sizeof(DBRecord)));
+    return static_cast<bool>(file);
+}
+
+// -----------------------------------------------------------------------------
+bool ObjectDB::save()
+{
+    detach();
+    if (!writeFile()) {
+        std::cerr << "[ObjectDB] Cannot write: " << filepath_ << "\n";
+        return false;
+    }
+    std::cout << "[ObjectDB] Saved " << count_
+              << " entries to " << filepath_ << "\n";
+    return mapFile();
+}
+
+// -----------------------------------------------------------------------------
+bool ObjectDB::loadCsv(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
     while (std::getline(file, line)) {
-        lineNum++;
         if (line.empty()) continue;
         // Skip header row
         if (line.find("label") == 0) continue;
@@ -84,95 +209,77 @@ bool ObjectDB::load()
             catch (...) { entry.huMoments.push_back(0.0); }
         }
 
-        entries_.push_back(entry);
+        DBRecord rec{};
+        rec.label = internLabel(entry.label);
+        const auto fv = entry.toFeatureVector();
+        std::copy(fv.begin(), fv.end(), rec.features);
+        pushOwned(rec);
     }
-
-    std::cout << "[ObjectDB] Loaded " << entries_.size()
-              << " entries from " << filepath_ << "\n";
     return true;
 }
 
 // -----------------------------------------------------------------------------
-bool ObjectDB::save() const
+int ObjectDB::internLabel(const std::string& label)
 {
-    // Ensure directory exists
-    std::filesystem::path p(filepath_);
-    if (p.has_parent_path())
-        std::filesystem::create_directories(p.parent_path());
-
-    std::ofstream file(filepath_);
-    if (!file.is_open()) {
-        std::cerr << "[ObjectDB] Cannot write: " << filepath_ << "\n";
-        return false;
-    }
-
-    // Write header
-    file << kHeader << "\n";
-
-    // Write entries
-    for (const auto& e : entries_) {
-        file << e.label << ","
-             << e.fillRatio << ","
-             << e.bboxRatio;
-        for (int i = 0; i < 7; i++) {
-            file << ",";
-            if (i < static_cast<int>(e.huMoments.size()))
-                file << e.huMoments[i];
-            else
-                file << "0.0";
-        }
-        file << "\n";
-    }
+    // Slots hold at most kLabelBytes - 1 bytes
+    const std::string name = label.substr(0, kLabelBytes - 1);
+    auto it = std::find(labels_.begin(), labels_.end(), name);
+    if (it == labels_.end()) it = labels_.insert(labels_.end(), name);
+    return static_cast<int>(it - labels_.begin());
+}
 
-    std::cout << "[ObjectDB] Saved " << entries_.size()
-              << " entries to " << filepath_ << "\n";
-    return true;
+// -----------------------------------------------------------------------------
+void ObjectDB::pushOwned(const DBRecord& rec)
+{
+    detach();
+    owned_.resize(count_);
+    owned_.push_back(rec);
+    records_ = owned_.data();
+    count_   = static_cast<int>(owned_.size());
 }
 
 // -----------------------------------------------------------------------------
 bool ObjectDB::append(const DBEntry& entry)
 {
-    // Ensure directory exists
-    std::filesystem::path p(filepath_);
-    if (p.has_parent_path())
-        std::filesystem::create_directories(p.parent_path());
-
-    // Check if file needs a header
-    bool needsHeader = true;
-    {
-        std::ifstream f(filepath_);
-        needsHeader = !f.good();
-    }
+    const size_t before = labels_.size();
+    DBRecord rec{};
+    rec.label = internLabel(entry.label);
+    const auto fv = entry.toFeatureVector();
+    std::copy(fv.begin(), fv.end(), rec.features);
+    const bool newLabel = labels_.size() > before;
 
-    std::ofstream file(filepath_, std::ios::app);
-    if (!file.is_open()) {
-        std::cerr << "[ObjectDB] Cannot append to: " << filepath_ << "\n";
-        return false;
+    // No file yet, or the label slots are full: write everything
+    if (!map_.isOpen() || static_cast<int>(labels_.size()) > labelSlots_) {
+        pushOwned(rec);
+        return save();
     }
 
-    if (needsHeader) file << kHeader << "\n";
-
-    file << entry.label << ","
-         << entry.fillRatio << ","
-         << entry.bboxRatio;
-    for (int i = 0; i < 7; i++) {
-        file << ",";
-        if (i < static_cast<int>(entry.huMoments.size()))
-            file << entry.huMoments[i];
-        else
-            file << "0.0";
+    // In place: label slot + count for a new label, then one record
+    const size_t slots = static_cast<size_t>(labelSlots_);
+    const int    count = count_;
+    map_.close();
+    records_ = nullptr;
+    count_   = 0;
+    {
+        std::fstream file(filepath_, std::ios::binary | std::ios::in | std::ios::out);
+        if (file.is_open()) {
+            if (newLabel) {
+                char name[kLabelBytes] = {};
+                labels_.back().copy(name, kLabelBytes - 1);
+                file.seekp(static_cast<std::streamoff>(16 + rec.label * kLabelBytes));
+                file.write(name, kLabelBytes);
+                const uint32_t n = static_cast<uint32_t>(labels_.size());
+                file.seekp(8);
+                file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+            }
+            // After the last whole record, overwriting any torn tail
+            file.seekp(static_cast<std::streamoff>(headerBytes(static_cast<int>(slots)) +
+                                                   count * sizeof(DBRecord)));
+            file.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+        }
+        if (!file) std::cerr << "[ObjectDB] Cannot append to: " << filepath_ << "\n";
     }
-    file << "\n";
-
-    // Also keep in memory
-    entries_.push_back(entry);
-    return true;
-}
-
-// -----------------------------------------------------------------------------
-void ObjectDB::addEntry(const DBEntry& entry)
-{
-    entries_.push_back(entry);
+    return mapFile() && count_ == count + 1;
 }
 
 // -----------------------------------------------------------------------------
@@ -183,41 +290,76 @@ DBEntry ObjectDB::entryFromRegion(const RegionInfo& reg,
     e.label      = label;
     e.fillRatio  = reg.fillRatio;
     e.bboxRatio  = reg.bboxRatio;
-    e.huMoments  = reg.huMoments;
+    e.huMoments.assign(reg.huMoments.begin(), reg.huMoments.end());
     return e;
 }
 
 // -----------------------------------------------------------------------------
 void ObjectDB::deleteLabel(const std::string& label)
 {
-    entries_.erase(
-        std::remove_if(entries_.begin(), entries_.end(),
-                       [&](const DBEntry& e){ return e.label == label; }),
-        entries_.end());
+    auto it = std::find(labels_.begin(), labels_.end(), label);
+    if (it == labels_.end()) return;
+    const int removed = static_cast<int>(it - labels_.begin());
+
+    // Drop the rows and the dictionary slot, shifting later label indices
+    std::vector<DBRecord> kept;
+    kept.reserve(count_);
+    for (int i = 0; i < count_; i++) {
+        DBRecord rec = records_[i];
+        if (rec.label == removed) continue;
+        if (rec.label > removed) rec.label--;
+        kept.push_back(rec);
+    }
+    map_.close();
+    owned_   = std::move(kept);
+    records_ = owned_.data();
+    count_   = static_cast<int>(owned_.size());
+    labels_.erase(labels_.begin() + removed);
     save(); // persist deletion
 }
 
 // -----------------------------------------------------------------------------
 void ObjectDB::clear()
 {
-    entries_.clear();
+    map_.close();
+    owned_.clear();
+    records_    = nullptr;
+    count_      = 0;
+    labels_.clear();
+    labelSlots_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+DBEntry ObjectDB::entry(int i) const
+{
+    const DBRecord& rec = records_[i];
+    DBEntry e;
+    e.label     = labels_[rec.label];
+    e.fillRatio = rec.features[0];
+    e.bboxRatio = rec.features[1];
+    e.huMoments.assign(rec.features + 2, rec.features + kShapeFeatureDim);
+    return e;
 }
 
 // -----------------------------------------------------------------------------
 std::vector<DBEntry> ObjectDB::entriesForLabel(const std::string& label) const
 {
     std::vector<DBEntry> result;
-    for (const auto& e : entries_)
-        if (e.label == label) result.push_back(e);
+    for (int i = 0; i < count_; i++)
+        if (labels_[records_[i].label] == label) result.push_back(entry(i));
     return result;
 }
 
 // -----------------------------------------------------------------------------
 std::map<std::string, int> ObjectDB::labelCounts() const
 {
+    std::vector<int> perLabel(labels_.size(), 0);
+    for (int i = 0; i < count_; i++)
+        perLabel[records_[i].label]++;
+
     std::map<std::string, int> counts;
-    for (const auto& e : entries_)
-        counts[e.label]++;
+    for (size_t li = 0; li < labels_.size(); li++)
+        if (perLabel[li] > 0) counts[labels_[li]] = perLabel[li];
     return counts;
 }
 
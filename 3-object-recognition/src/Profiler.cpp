@@ -0,0 +1,161 @@
+/**
+ * @file    Profiler.cpp
+ * @brief   Stage timing store and Chrome trace export implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "Profiler.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// -----------------------------------------------------------------------------
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+// -----------------------------------------------------------------------------
+Profiler::Profiler()
+    : epoch_(Clock::now()), events_(kTraceEvents)
+{
+    for (size_t i = 0; i < metrics_.size(); i++) {
+        const std::string name = stageName(static_cast<ProfileStage>(i));
+        metrics_[i] = &cvcore::MetricsRegistry::global().histogram(
+            "objrec_stage_seconds", "Pipeline stage latency", "stage=\"" + name + "\"");
+        allocStages_[i] = &cvcore::AllocStage::get(name);
+    }
+}
+
+// -----------------------------------------------------------------------------
+const char* Profiler::stageName(ProfileStage stage)
+{
+    static const char* names[] = {"Threshold", "Morphology", "Labeling", "Streamed",
+                                  "Features",  "Classify",   "Embedding", "GUI"};
+    const int i = static_cast<int>(stage);
+    return (i >= 0 && i < static_cast<int>(ProfileStage::Count)) ? names[i] : "?";
+}
+
+// -----------------------------------------------------------------------------
+void Profiler::record(ProfileStage stage, Clock::time_point begin, Clock::time_point end)
+{
+    // A scope may open before the first call constructs the profiler
+    const long long beginUs = std::max<long long>(0,
+        std::chrono::duration_cast<std::chrono::microseconds>(begin - epoch_).count());
+    const long long durUs   = std::chrono::duration_cast<std::chrono::microseconds>(
+                                  end - begin).count();
+    metrics_[static_cast<size_t>(stage)]->observeMs(durUs / 1000.0);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Ring& ring = rings_[static_cast<size_t>(stage)];
+    ring.ms[ring.head] = durUs / 1000.f;
+    ring.head  = (ring.head + 1) % kHistory;
+    ring.count = std::min(ring.count + 1, kHistory);
+
+    StageTotals& total = totals_[static_cast<size_t>(stage)];
+    total.calls++;
+    total.totalMs += durUs / 1000.0;
+    total.maxMs    = std::max(total.maxMs, durUs / 1000.f);
+
+    auto it = threadIds_.find(std::this_thread::get_id());
+    if (it == threadIds_.end())
+        it = threadIds_.emplace(std::this_thread::get_id(),
+                                static_cast<int>(threadIds_.size()) + 1).first;
+
+    events_[eventHead_] = {stage, it->second, beginUs, durUs};
+    eventHead_  = (eventHead_ + 1) % events_.size();
+    eventCount_ = std::min(eventCount_ + 1, events_.size());
+}
+
+// -----------------------------------------------------------------------------
+Profiler::StageStats Profiler::stats(ProfileStage stage) const
+{
+    StageStats s;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Ring& ring = rings_[static_cast<size_t>(stage)];
+        s.count = ring.count;
+        const int first = (ring.head - ring.count + kHistory) % kHistory;
+        for (int i = 0; i < ring.count; i++)
+            s.history[i] = ring.ms[(first + i) % kHistory];
+    }
+    if (s.count == 0) return s;
+
+    s.lastMs = s.history[s.count - 1];
+    float sum = 0.f;
+    for (int i = 0; i < s.count; i++) sum += s.history[i];
+    s.meanMs = sum / s.count;
+
+    std::array<float, kHistory> sorted = s.history;
+    const int k = std::min(s.count - 1, static_cast<int>(0.95f * (s.count - 1) + 0.5f));
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.begin() + s.count);
+    s.p95Ms = sorted[k];
+    return s;
+}
+
+// -----------------------------------------------------------------------------
+Profiler::StageTotals Profiler::totals(ProfileStage stage) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totals_[static_cast<size_t>(stage)];
+}
+
+// -----------------------------------------------------------------------------
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& ring : rings_) ring = Ring{};
+    totals_.fill(StageTotals{});
+    eventHead_  = 0;
+    eventCount_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+int Profiler::exportChromeTrace(const std::string& filepath) const
+{
+    std::vector<TraceEvent> events;
+    std::map<std::thread::id, int> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t first = (eventHead_ + events_.size() - eventCount_) % events_.size();
+        for (size_t i = 0; i < eventCount_; i++)
+            events.push_back(events_[(first + i) % events_.size()]);
+        threads = threadIds_;
+    }
+
+    std::filesystem::path p(filepath);
+    if (p.has_parent_path())
+        std::filesystem::create_directories(p.parent_path());
+
+    std::ofstream f(filepath);
+    if (!f.is_open()) {
+        std::cerr << "[Profiler] Cannot write: " << filepath << "\n";
+        return -1;
+    }
+
+    // Complete ("X") events, microsecond timestamps
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool firstLine = true;
+    for (const auto& kv : threads) {
+        f << (firstLine ? "" : ",\n")
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << kv.second
+          << ",\"args\":{\"name\":\"thread " << kv.second << "\"}}";
+        firstLine = false;
+    }
+    for (const auto& e : events) {
+        f << (firstLine ? "" : ",\n")
+          << "{\"name\":\"" << stageName(e.stage) << "\",\"cat\":\"pipeline\","
+          << "\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid
+          << ",\"ts\":" << e.beginUs << ",\"dur\":" << e.durUs << "}";
+        firstLine = false;
+    }
+    f << "\n]}\n";
+
+    std::cout << "[Profiler] " << events.size() << " events written to "
+              << filepath << "\n";
+    return static_cast<int>(events.size());
+}
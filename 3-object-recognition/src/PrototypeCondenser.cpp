@@ -0,0 +1,137 @@
+/**
+ * @file    PrototypeCondenser.cpp
+ * @brief   Per-label k-means prototype condensation implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "PrototypeCondenser.h"
+#include "TaskScheduler.h"
+#include <cstdint>
+#include <iostream>
+
+static const int      kKmeansIters = 20;      ///< Lloyd iterations per run
+static const uint64_t kKmeansSeed  = 0x5EED;  ///< Same prototypes for the same samples
+
+// -----------------------------------------------------------------------------
+PrototypeCondenser::~PrototypeCondenser()
+{
+    if (worker_.joinable()) worker_.join();
+}
+
+// -----------------------------------------------------------------------------
+void PrototypeCondenser::update(const EmbeddingDB& db, int perLabel)
+{
+    if (perLabel <= 0) {
+        if (budget_ > 0) {
+            budget_ = 0;
+            current_.reset();
+            size_ = 0;
+            version_++;
+        }
+        return;
+    }
+    if (busy_ || db.empty()) return;
+    if (db.generation() == generation_ && db.size() == samples_ &&
+        db.dim() == dim_ && perLabel == budget_)
+        return;
+    if (worker_.joinable()) worker_.join();   // previous run has finished
+
+    // A reload or another budget invalidates every label's prototypes
+    const bool reset = db.generation() != generation_ || db.dim() != dim_ ||
+                       perLabel != budget_;
+    generation_ = db.generation();
+    samples_    = db.size();
+    dim_        = db.dim();
+    budget_     = perLabel;
+
+    // Copy the samples of labels whose count changed since the last run
+    const std::map<std::string, int> counts = db.labelCounts();
+    std::map<std::string, cv::Mat>   changed;
+    for (const auto& kv : counts) {
+        auto it = labels_.find(kv.first);
+        if (reset || it == labels_.end() || it->second.samples != kv.second)
+            changed[kv.first];
+    }
+    for (int i = 0; i < db.size(); i++) {
+        auto it = changed.find(db.label(i));
+        if (it == changed.end()) continue;
+        cv::Mat row = db.unitRows().row(i) * db.norm(i);
+        it->second.push_back(row);
+    }
+
+    busy_   = true;
+    worker_ = std::thread([this, changed = std::move(changed), counts, perLabel,
+                           reset, generation = generation_]() mutable {
+        TaskScheduler::setThreadPriority(TaskPriority::Low);   // k-means loops yield to frames
+        run(std::move(changed), std::move(counts), perLabel, reset, generation);
+        busy_ = false;
+    });
+}
+
+// -----------------------------------------------------------------------------
+const EmbeddingDB& PrototypeCondenser::live(const EmbeddingDB& db)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ready_) {
+            if (budget_ > 0) {
+                current_           = std::move(ready_);
+                currentGeneration_ = readyGeneration_;
+                size_              = current_->size();
+                version_++;
+            }
+            ready_.reset();
+        }
+    }
+
+    // Prototypes of a reloaded or re-embedded database are meaningless
+    if (current_ && currentGeneration_ == db.generation() && current_->dim() == db.dim())
+        return *current_;
+    return db;
+}
+
+// -----------------------------------------------------------------------------
+void PrototypeCondenser::run(std::map<std::string, cv::Mat> changed,
+                             std::map<std::string, int> counts, int perLabel,
+                             bool reset, int generation)
+{
+    if (reset) labels_.clear();
+    cv::theRNG().state = kKmeansSeed;
+    for (auto& kv : changed) {
+        LabelSet& set  = labels_[kv.first];
+        set.samples    = counts[kv.first];
+        set.prototypes = condense(kv.second, perLabel);
+    }
+
+    auto protos = std::make_shared<EmbeddingDB>(std::string());
+    EmbeddingEntry e;
+    for (const auto& kv : labels_) {
+        e.label = kv.first;
+        for (int r = 0; r < kv.second.prototypes.rows; r++) {
+            const float* p = kv.second.prototypes.ptr<float>(r);
+            e.embedding.assign(p, p + kv.second.prototypes.cols);
+            protos->insert(e);
+        }
+    }
+    std::cout << "[Prototypes] " << counts.size() << " labels -> " << protos->size()
+              << " prototypes (" << changed.size() << " re-condensed)\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_           = std::move(protos);
+    readyGeneration_ = generation;
+}
+
+// -----------------------------------------------------------------------------
+cv::Mat PrototypeCondenser::condense(const cv::Mat& samples, int k)
+{
+    if (samples.rows <= k) return samples;
+
+    cv::Mat assignment, centres;
+    cv::kmeans(samples, k, assignment,
+               cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS,
+                                kKmeansIters, 1e-4),
+               1, cv::KMEANS_PP_CENTERS, centres);
+    return centres;
+}
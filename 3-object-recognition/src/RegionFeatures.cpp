@@ -3,8 +3,8 @@
  * @brief   Region-based feature extraction implementation.
  *
  *          Moments explanation:
- *            cv::moments() computes spatial moments m00, m10, m01 and
- *            central moments mu20, mu02, mu11, mu30 etc. from a binary mask.
+ *            Spatial moments m00, m10, m01 ... and central moments mu20,
+ *            mu02, mu11, mu30 etc. describe the region's pixel distribution.
  *
  *            We use:
  *              m00          — region area (zero-order moment)
@@ -16,6 +16,20 @@
  *              theta = 0.5 * atan2(2 * mu11, mu20 - mu02)
  *              This is the axis of LEAST central moment (minimum inertia).
  *
+ *            All regions' raw moments (m00..m03) are accumulated in one
+ *            pass over the labeller's runs, and cv::Moments derives the
+ *            central and normalised moments from them.  The oriented-box
+ *            extents take a second pass over the runs: a projection is
+ *            linear along a run, so only its two end pixels matter.
+ *
+ *            Contour mode (PipelineParams::momentMode = 1) instead traces
+ *            each region's boundary in its bounding box and integrates the
+ *            polygon with Green's theorem (cv::moments on the contour);
+ *            the oriented box is cv::minAreaRect of the same contour.
+ *            Both agree to within the half-pixel boundary band: the
+ *            polygon runs through boundary pixel centres, so its area is
+ *            smaller by about half the perimeter.
+ *
  *            Hu moments (cv::HuMoments):
  *              7 invariants derived from normalised central moments.
  *              Invariant to translation, scale, and rotation.
@@ -26,25 +40,107 @@
  */
 
 #include "RegionFeatures.h"
+#include "Profiler.h"
+#include "AllocCounter.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 
 // -----------------------------------------------------------------------------
 // Internal helpers
 // -----------------------------------------------------------------------------
 
-/** Extract binary mask for a single region label from the label map. */
-static cv::Mat extractRegionMask(const cv::Mat& labelMap, int regionId)
+/** Raw spatial moments m00..m03 of one region (cv::Moments order). */
+struct RawMoments {
+    double m00 = 0, m10 = 0, m01 = 0;
+    double m20 = 0, m11 = 0, m02 = 0;
+    double m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+
+    void add(const RawMoments& o) {
+        m00 += o.m00; m10 += o.m10; m01 += o.m01;
+        m20 += o.m20; m11 += o.m11; m02 += o.m02;
+        m30 += o.m30; m21 += o.m21; m12 += o.m12; m03 += o.m03;
+    }
+
+    /** Add (sign = 1) or remove (sign = -1) the raw moments of a polygon. */
+    void add(const cv::Moments& o, double sign) {
+        m00 += sign * o.m00; m10 += sign * o.m10; m01 += sign * o.m01;
+        m20 += sign * o.m20; m11 += sign * o.m11; m02 += sign * o.m02;
+        m30 += sign * o.m30; m21 += sign * o.m21; m12 += sign * o.m12; m03 += sign * o.m03;
+    }
+
+    /**
+     * Add the run of pixels x in [a, b] on row y.
+     * Power sums over the run are closed-form, so a run costs the same as
+     * one pixel; all terms are integers, exact in double for any frame size
+     * in use, so the result does not depend on summation order.
+     */
+    void addRun(int a, int b, int y) {
+        auto powerSums = [](double n, double& s0, double& s1, double& s2, double& s3) {
+            // Sums of x^k for x = 0..n
+            s0 = n + 1;
+            s1 = n * (n + 1) / 2;
+            s2 = n * (n + 1) * (2 * n + 1) / 6;
+            s3 = s1 * s1;
+        };
+        double hi0, hi1, hi2, hi3, lo0 = 0, lo1 = 0, lo2 = 0, lo3 = 0;
+        powerSums(b, hi0, hi1, hi2, hi3);
+        if (a > 0) powerSums(a - 1, lo0, lo1, lo2, lo3);
+        const double x0 = hi0 - lo0, x1 = hi1 - lo1, x2 = hi2 - lo2, x3 = hi3 - lo3;
+        const double y1 = y, y2 = y1 * y1, y3 = y2 * y1;
+
+        m00 += x0;      m10 += x1;      m01 += x0 * y1;
+        m20 += x2;      m11 += x1 * y1; m02 += x0 * y2;
+        m30 += x3;      m21 += x2 * y1; m12 += x1 * y2; m03 += x0 * y3;
+    }
+
+    cv::Moments toMoments() const {
+        return cv::Moments(m00, m10, m01, m20, m11, m02, m30, m21, m12, m03);
+    }
+};
+
+// Fewest runs per parallel chunk of the moment pass
+static constexpr size_t kRunsPerChunk = 4096;
+
+/**
+ * Accumulate moments of every label with slotOf[label] >= 0 over
+ * runs [begin, end).
+ */
+static void accumulateMoments(const std::vector<LabelRun>& runs, size_t begin, size_t end,
+                              const std::vector<int>& slotOf,
+                              std::vector<RawMoments>& acc)
 {
-    cv::Mat mask = cv::Mat::zeros(labelMap.size(), CV_8UC1);
-    for (int r = 0; r < labelMap.rows; r++) {
-        const int* row = labelMap.ptr<int>(r);
-        uchar*    mRow = mask.ptr<uchar>(r);
-        for (int c = 0; c < labelMap.cols; c++)
-            if (row[c] == regionId) mRow[c] = 255;
-    }
-    return mask;
+    const int maxId = static_cast<int>(slotOf.size()) - 1;
+    for (size_t i = begin; i < end; i++) {
+        const LabelRun& run = runs[i];
+        if (run.label <= maxId && slotOf[run.label] >= 0)
+            acc[slotOf[run.label]].addRun(run.colBegin, run.colEnd - 1, run.row);
+    }
 }
 
+/** Extent of one region along its primary (1) and secondary (2) axes. */
+struct AxisExtent {
+    double cx = 0, cy = 0, cosA = 1, sinA = 0;
+    double min1 =  1e9, max1 = -1e9;
+    double min2 =  1e9, max2 = -1e9;
+
+    void addPixel(int c, int r) {
+        const double dx = c - cx;
+        const double dy = r - cy;
+        const double p1 =  dx * cosA + dy * sinA;
+        const double p2 = -dx * sinA + dy * cosA;
+        min1 = std::min(min1, p1);  max1 = std::max(max1, p1);
+        min2 = std::min(min2, p2);  max2 = std::max(max2, p2);
+    }
+
+    /** Projections are linear along the run — its end pixels bound them. */
+    void addRun(const LabelRun& run) {
+        addPixel(run.colBegin, run.row);
+        addPixel(run.colEnd - 1, run.row);
+    }
+};
+
 /** Log-scale a Hu moment for numerical stability.
  *  Takes absolute value first to handle sign inconsistency across orientations.
  */
@@ -55,19 +151,9 @@ static double logScale(double h)
     return std::log10(std::abs(h));
 }
 
-// -----------------------------------------------------------------------------
-void computeRegionFeatures(const cv::Mat& labelMap, RegionInfo& reg)
+/** Centroid and primary axis angle of a region from its moments. */
+static void axisFromMoments(const cv::Moments& m, RegionInfo& reg)
 {
-    // --- Extract binary mask for this region ---------------------------------
-    cv::Mat mask = extractRegionMask(labelMap, reg.id);
-
-    // --- Compute moments on the region mask ----------------------------------
-    // cv::moments computes spatial and central moments from a binary image.
-    // We use central moments (mu**) which are translation invariant.
-    cv::Moments m = cv::moments(mask, true); // true = treat as binary
-
-    if (m.m00 < 1.0) return; // empty region guard
-
     // --- Centroid (verify / update from moments) -----------------------------
     reg.centroid = {
         static_cast<float>(m.m10 / m.m00),
@@ -78,40 +164,21 @@ void computeRegionFeatures(const cv::Mat& labelMap, RegionInfo& reg)
     // Derived from second-order central moments mu20, mu02, mu11.
     // theta = 0.5 * atan2(2*mu11, mu20-mu02)
     reg.angle = 0.5 * std::atan2(2.0 * m.mu11, m.mu20 - m.mu02);
+}
 
-    // --- Oriented bounding box -----------------------------------------------
-    // Find extent along primary axis and perpendicular axis.
-    // Project all region pixels onto the two axes to find min/max extent.
-    double cosA = std::cos(reg.angle);
-    double sinA = std::sin(reg.angle);
-
-    double minProj1 =  1e9, maxProj1 = -1e9; // along primary axis
-    double minProj2 =  1e9, maxProj2 = -1e9; // along secondary axis
-
-    for (int r = 0; r < mask.rows; r++) {
-        const uchar* row = mask.ptr<uchar>(r);
-        for (int c = 0; c < mask.cols; c++) {
-            if (row[c] == 0) continue;
-            double dx = c - reg.centroid.x;
-            double dy = r - reg.centroid.y;
-            double p1 =  dx * cosA + dy * sinA;
-            double p2 = -dx * sinA + dy * cosA;
-            minProj1 = std::min(minProj1, p1);
-            maxProj1 = std::max(maxProj1, p1);
-            minProj2 = std::min(minProj2, p2);
-            maxProj2 = std::max(maxProj2, p2);
-        }
-    }
-
-    float w = static_cast<float>(maxProj1 - minProj1); // width along primary
-    float h = static_cast<float>(maxProj2 - minProj2); // height along secondary
-
-    reg.orientedBox = cv::RotatedRect(reg.centroid,
-                                      cv::Size2f(w, h),
-                                      static_cast<float>(reg.angle * 180.0 / CV_PI));
+/**
+ * Derive the remaining features of a region from its moments and its
+ * oriented box (axis extents or minimum-area rectangle).
+ */
+static void featuresFromMoments(const cv::Moments& m, const cv::RotatedRect& box,
+                                const cv::Size& imageSize, RegionInfo& reg)
+{
+    reg.orientedBox = box;
+    const float w = box.size.width;
+    const float h = box.size.height;
 
     // --- Feature: area (normalised by image area for scale invariance) -------
-    double imageArea = static_cast<double>(labelMap.rows * labelMap.cols);
+    double imageArea = static_cast<double>(imageSize.area());
     reg.area = m.m00 / imageArea;
 
     // --- Feature: fill ratio = region pixels / oriented bbox area ------------
@@ -132,16 +199,219 @@ void computeRegionFeatures(const cv::Mat& labelMap, RegionInfo& reg)
     double hu[7];
     cv::HuMoments(m, hu);
 
-    reg.huMoments.resize(7);
     for (int i = 0; i < 7; i++)
         reg.huMoments[i] = logScale(hu[i]); // log scale for usable range
+    reg.hasShape = true;
+}
+
+/**
+ * Moments and minimum-area rectangle of each region from its boundary.
+ *
+ * The region's runs are painted into a mask of its bounding box (one pixel
+ * of padding), cv::findContours traces the outer boundaries and holes and
+ * cv::moments integrates each polygon with Green's theorem; hole moments
+ * are subtracted.  Polygons pass through pixel centres, so the area is
+ * about half a perimeter smaller than the pixel count.
+ *
+ * @return  Per region, false if the boundary encloses no area (a region
+ *          one pixel thin) — those fall back to the run moments.
+ */
+static std::vector<bool> contourMoments(const RegionRuns& runs, const RegionInfo* regions,
+                                        size_t count, const std::vector<int>& slotOf,
+                                        std::vector<cv::Moments>& moments,
+                                        std::vector<cv::RotatedRect>& boxes)
+{
+    const int maxId = static_cast<int>(slotOf.size()) - 1;
+
+    // --- Paint every region's runs into its padded bounding-box mask --------
+    std::vector<cv::Mat>   masks(count);
+    std::vector<cv::Point> origin(count);
+    for (size_t i = 0; i < count; i++) {
+        const cv::Rect& b = regions[i].boundingBox;
+        if (b.area() == 0) continue;
+        origin[i] = b.tl() - cv::Point(1, 1);
+        masks[i]  = cv::Mat::zeros(b.height + 2, b.width + 2, CV_8UC1);
+    }
+    for (const LabelRun& run : runs.runs) {
+        if (run.label > maxId || slotOf[run.label] < 0) continue;
+        const int i = slotOf[run.label];
+        if (masks[i].empty()) continue;
+        uchar* row = masks[i].ptr<uchar>(run.row - origin[i].y);
+        std::fill(row + run.colBegin - origin[i].x, row + run.colEnd - origin[i].x, 255);
+    }
+
+    // --- Trace and integrate each region's boundary --------------------------
+    std::vector<bool> ok(count, false);
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i>              hierarchy;
+    std::vector<cv::Point>              hull;
+    for (size_t i = 0; i < count; i++) {
+        if (masks[i].empty()) continue;
+        cv::findContours(masks[i], contours, hierarchy, cv::RETR_CCOMP,
+                         cv::CHAIN_APPROX_SIMPLE, origin[i]);
+
+        RawMoments acc;
+        hull.clear();
+        for (size_t k = 0; k < contours.size(); k++) {
+            const bool hole = hierarchy[k][3] >= 0;
+            acc.add(cv::moments(contours[k]), hole ? -1.0 : 1.0);
+            if (!hole) hull.insert(hull.end(), contours[k].begin(), contours[k].end());
+        }
+        if (acc.m00 < 1.0 || hull.empty()) continue;
+
+        moments[i] = acc.toMoments();
+        boxes[i]   = cv::minAreaRect(hull);
+        ok[i]      = true;
+    }
+    return ok;
+}
+
+/**
+ * Features of regions[0..count).  Run mode takes two passes over the runs:
+ * moments (chunk-parallel for many runs), then axis extents.  Contour mode
+ * uses contourMoments() and falls back to run mode per region.
+ */
+static void computeFeatures(const RegionRuns& runs, RegionInfo* regions, size_t count,
+                            bool contour)
+{
+    // --- Label id → region slot ----------------------------------------------
+    // Scratch is reused across frames; references so workers see this thread's
+    static thread_local std::vector<int>                     slotCache;
+    static thread_local std::vector<cv::Moments>             momentCache;
+    static thread_local std::vector<cv::RotatedRect>         boxCache;
+    static thread_local std::vector<bool>                    doneCache;
+    static thread_local std::vector<std::vector<RawMoments>> partialCache;
+    static thread_local std::vector<AxisExtent>              extentCache;
+    std::vector<int>&             slotOf  = slotCache;
+    std::vector<cv::Moments>&     moments = momentCache;
+    std::vector<cv::RotatedRect>& boxes   = boxCache;
+    std::vector<bool>&            done    = doneCache;
+
+    int maxId = 0;
+    for (size_t i = 0; i < count; i++) maxId = std::max(maxId, regions[i].id);
+    slotOf.assign(maxId + 1, -1);
+    for (size_t i = 0; i < count; i++)
+        if (regions[i].id > 0) slotOf[regions[i].id] = static_cast<int>(i);
+
+    moments.assign(count, cv::Moments());
+    boxes.assign(count, cv::RotatedRect());
+    done.assign(count, false);
+
+    // --- Contour mode: boundary moments and minimum-area rectangle -----------
+    if (contour) {
+        done = contourMoments(runs, regions, count, slotOf, moments, boxes);
+        for (size_t i = 0; i < count; i++) {
+            if (!done[i]) continue;
+            axisFromMoments(moments[i], regions[i]);
+            featuresFromMoments(moments[i], boxes[i], runs.size, regions[i]);
+            slotOf[regions[i].id] = -1;    // leave it out of the run passes
+        }
+        if (std::all_of(done.begin(), done.end(), [](bool d) { return d; })) return;
+    }
+
+    // --- Pass 1: moments.  Chunks accumulate privately; integer-valued sums
+    // make the merge order irrelevant.
+    const size_t nRuns  = runs.runs.size();
+    const int    chunks = static_cast<int>(std::max<size_t>(1,
+        std::min<size_t>(cv::getNumThreads(), nRuns / kRunsPerChunk)));
+    std::vector<std::vector<RawMoments>>& partial = partialCache;
+    partial.resize(chunks);
+    for (auto& chunk : partial) chunk.assign(count, RawMoments());
+    const auto pass1 = [&](const cv::Range& range) {
+        for (int k = range.start; k < range.end; k++)
+            accumulateMoments(runs.runs, nRuns * k / chunks, nRuns * (k + 1) / chunks,
+                              slotOf, partial[k]);
+    };
+    cv::parallel_for_(cv::Range(0, chunks), std::cref(pass1));   // by reference: no heap copy
+
+    std::vector<AxisExtent>& extents = extentCache;
+    extents.assign(count, AxisExtent());
+    for (size_t i = 0; i < count; i++) {
+        if (done[i]) continue;
+        RawMoments total;
+        for (const auto& chunk : partial) total.add(chunk[i]);
+        moments[i] = total.toMoments();
+        if (moments[i].m00 < 1.0) continue; // empty region guard
+
+        axisFromMoments(moments[i], regions[i]);
+        AxisExtent& ext = extents[i];
+        ext.cx   = regions[i].centroid.x;
+        ext.cy   = regions[i].centroid.y;
+        ext.cosA = std::cos(regions[i].angle);
+        ext.sinA = std::sin(regions[i].angle);
+    }
+
+    // --- Pass 2: extents along each region's axes ----------------------------
+    for (const LabelRun& run : runs.runs)
+        if (run.label <= maxId && slotOf[run.label] >= 0)
+            extents[slotOf[run.label]].addRun(run);
+
+    for (size_t i = 0; i < count; i++) {
+        if (done[i] || moments[i].m00 < 1.0) continue;
+
+        // Oriented bounding box: extent along the primary and perpendicular axes
+        const AxisExtent& ext = extents[i];
+        const cv::RotatedRect box(regions[i].centroid,
+                                  cv::Size2f(static_cast<float>(ext.max1 - ext.min1),
+                                             static_cast<float>(ext.max2 - ext.min2)),
+                                  static_cast<float>(regions[i].angle * 180.0 / CV_PI));
+        featuresFromMoments(moments[i], box, runs.size, regions[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void computeRegionFeatures(const RegionRuns& runs, RegionInfo& reg, bool contour)
+{
+    if (reg.id <= 0) return;
+    computeFeatures(runs, &reg, 1, contour);
+}
+
+// -----------------------------------------------------------------------------
+void computeAllFeatures(const RegionRuns& runs, AppState& state,
+                        const PipelineParams& params)
+{
+    ProfileScope profile(ProfileStage::Features);
+    AllocScope   allocs(state.regionAllocs);
+    if (state.regions.empty()) return;
+    computeFeatures(runs, state.regions.data(), state.regions.size(),
+                    params.momentMode == 1);
+}
+
+// -----------------------------------------------------------------------------
+void scaleRegionGeometry(std::vector<RegionInfo>& regions, int scale,
+                         const cv::Size& fullSize)
+{
+    const float s = static_cast<float>(scale);
+    // Centre of reduced pixel x covers full pixels [x*s, x*s + s)
+    auto toFull = [&](const cv::Point2f& p) {
+        return cv::Point2f((p.x + 0.5f) * s - 0.5f, (p.y + 0.5f) * s - 0.5f);
+    };
+
+    for (auto& reg : regions) {
+        const cv::Rect& b = reg.boundingBox;
+        reg.boundingBox = cv::Rect(b.x * scale, b.y * scale,
+                                   b.width * scale, b.height * scale)
+                        & cv::Rect(0, 0, fullSize.width, fullSize.height);
+        reg.centroid    = toFull(reg.centroid);
+        reg.orientedBox = cv::RotatedRect(toFull(reg.orientedBox.center),
+                                          reg.orientedBox.size * s,
+                                          reg.orientedBox.angle);
+        reg.minE1 *= s;  reg.maxE1 *= s;
+        reg.minE2 *= s;  reg.maxE2 *= s;
+    }
 }
 
 // -----------------------------------------------------------------------------
-void computeAllFeatures(const cv::Mat& labelMap, AppState& state)
+void translateRegionGeometry(std::vector<RegionInfo>& regions,
+                             const cv::Point& offset)
 {
-    for (auto& reg : state.regions)
-        computeRegionFeatures(labelMap, reg);
+    const cv::Point2f d(static_cast<float>(offset.x), static_cast<float>(offset.y));
+    for (auto& reg : regions) {
+        reg.boundingBox        += offset;
+        reg.centroid           += d;
+        reg.orientedBox.center += d;
+        // Axis extents are relative to the centroid — unchanged
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -179,7 +449,7 @@ void drawFeatures(cv::Mat& frame, const AppState& state,
         }
 
         // --- Feature text overlay --------------------------------------------
-        if (params.showFeatureText && !reg.huMoments.empty()) {
+        if (params.showFeatureText && reg.hasShape) {
             int tx = reg.boundingBox.x;
             int ty = reg.boundingBox.y - 10;
             if (ty < 15) ty = reg.boundingBox.y + reg.boundingBox.height + 20;
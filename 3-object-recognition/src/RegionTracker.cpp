@@ -0,0 +1,147 @@
+/**
+ * @file    RegionTracker.cpp
+ * @brief   Frame-to-frame region tracking implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "RegionTracker.h"
+#include <algorithm>
+#include <cmath>
+
+// -----------------------------------------------------------------------------
+// Internal helpers
+// -----------------------------------------------------------------------------
+
+/** Intersection over union of two axis-aligned boxes. */
+static float boxIoU(const cv::Rect& a, const cv::Rect& b)
+{
+    const int inter = (a & b).area();
+    const int uni   = a.area() + b.area() - inter;
+    return uni > 0 ? static_cast<float>(inter) / uni : 0.f;
+}
+
+/** Mean absolute difference of log-scaled Hu moments (0 if either is missing). */
+static float huDistance(const HuMoments& a, bool hasA, const HuMoments& b, bool hasB)
+{
+    if (!hasA || !hasB) return 0.f;
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); i++) sum += std::abs(a[i] - b[i]);
+    return static_cast<float>(sum / a.size());
+}
+
+// -----------------------------------------------------------------------------
+void RegionTracker::update(std::vector<RegionInfo>& regions,
+                           const PipelineParams& params)
+{
+    // --- Candidate pairs within the motion gate -------------------------------
+    std::vector<Pair>& pairs = pairs_;
+    pairs.clear();
+    for (int t = 0; t < static_cast<int>(tracks_.size()); t++) {
+        const Track& tr = tracks_[t];
+        for (int r = 0; r < static_cast<int>(regions.size()); r++) {
+            const RegionInfo& reg = regions[r];
+            const float dx   = reg.centroid.x - tr.centroid.x;
+            const float dy   = reg.centroid.y - tr.centroid.y;
+            const float dist = std::sqrt(dx*dx + dy*dy);
+            if (dist >= kMaxStep) continue;
+
+            const float cost = dist / kMaxStep
+                             + (1.f - boxIoU(reg.boundingBox, tr.boundingBox))
+                             + huDistance(reg.huMoments, reg.hasShape,
+                                          tr.huMoments, tr.hasHu);
+            pairs.push_back({cost, t, r});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(),
+              [](const Pair& a, const Pair& b) { return a.cost < b.cost; });
+
+    // --- Greedy assignment, cheapest pair first -------------------------------
+    std::vector<int>&  trackOf = trackOf_;
+    std::vector<char>& taken   = taken_;
+    trackOf.assign(regions.size(), -1);
+    taken.assign(tracks_.size(), false);
+    for (const auto& p : pairs) {
+        if (taken[p.track] || trackOf[p.region] >= 0) continue;
+        taken[p.track]    = true;
+        trackOf[p.region] = p.track;
+    }
+
+    for (size_t r = 0; r < regions.size(); r++) {
+        RegionInfo& reg = regions[r];
+
+        if (trackOf[r] < 0) {
+            Track tr;
+            tr.id = nextId_++;
+            trackOf[r] = static_cast<int>(tracks_.size());
+            tracks_.push_back(std::move(tr));
+            taken.push_back(true);
+        }
+
+        Track& tr = tracks_[trackOf[r]];
+        tr.boundingBox = reg.boundingBox;
+        tr.centroid    = reg.centroid;
+        tr.huMoments   = reg.huMoments;
+        tr.hasHu       = reg.hasShape;
+        tr.missed      = 0;
+        tr.sinceClassify++;
+
+        reg.trackId = tr.id;
+        if (tr.classified) {
+            reg.label         = tr.label;
+            reg.confidence    = tr.confidence;
+            reg.embedding     = tr.embedding;
+            reg.embedCrop     = tr.embedCrop;
+            reg.shapeLabel    = tr.shapeLabel;
+        }
+        reg.unknownFrames = tr.unknownFrames;
+
+        // --- Reclassify when new, due, or drifted -----------------------------
+        const bool drifted =
+            huDistance(reg.huMoments, reg.hasShape, tr.refHu, tr.hasRefHu) >
+                params.trackDrift ||
+            (tr.refArea > 0.0 &&
+             std::abs(reg.area / tr.refArea - 1.0) > kMaxGrowth);
+        reg.needsClassify = !params.trackRegions || !tr.classified || drifted ||
+                            tr.sinceClassify >= params.trackReclassify;
+    }
+
+    // --- Age out tracks that were not matched ---------------------------------
+    for (size_t t = 0; t < tracks_.size(); t++)
+        if (!taken[t]) tracks_[t].missed++;
+    tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                                 [](const Track& tr) { return tr.missed > kMaxMissed; }),
+                  tracks_.end());
+}
+
+// -----------------------------------------------------------------------------
+void RegionTracker::store(const std::vector<RegionInfo>& regions)
+{
+    for (const auto& reg : regions) {
+        auto it = std::find_if(tracks_.begin(), tracks_.end(),
+                               [&](const Track& tr) { return tr.id == reg.trackId; });
+        if (it == tracks_.end()) continue;
+
+        it->unknownFrames = reg.unknownFrames;
+
+        // An empty label means the result is still pending (async CNN)
+        if (!reg.needsClassify || reg.label.empty()) continue;
+        it->label         = reg.label;
+        it->confidence    = reg.confidence;
+        it->embedding     = reg.embedding;
+        it->embedCrop     = reg.embedCrop;
+        it->shapeLabel    = reg.shapeLabel;
+        it->refHu         = reg.huMoments;
+        it->hasRefHu      = reg.hasShape;
+        it->refArea       = reg.area;
+        it->sinceClassify = 0;
+        it->classified    = true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void RegionTracker::invalidate()
+{
+    for (auto& tr : tracks_) tr.classified = false;
+}
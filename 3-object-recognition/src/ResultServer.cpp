@@ -0,0 +1,159 @@
+/**
+ * @file    ResultServer.cpp
+ * @brief   TCP broadcast of JSON result lines (Winsock / BSD sockets).
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "ResultServer.h"
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+static constexpr int kSendTimeoutMs = 200;
+
+#ifdef _WIN32
+static void closeSocket(uintptr_t s) { closesocket(static_cast<SOCKET>(s)); }
+static constexpr int kSendFlags = 0;
+#else
+static void closeSocket(int s) { ::close(s); }
+static constexpr int kSendFlags = MSG_NOSIGNAL;   // a closed client is not fatal
+#endif
+
+// -----------------------------------------------------------------------------
+ResultServer::~ResultServer()
+{
+    stop();
+}
+
+// -----------------------------------------------------------------------------
+bool ResultServer::start(int port)
+{
+    stop();
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+    const SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET) return false;
+#else
+    const int s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s < 0) return false;
+#endif
+
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse),
+               sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(static_cast<uint16_t>(port));
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(s, 8) != 0) {
+        std::cerr << "[ResultServer] Cannot listen on port " << port << "\n";
+        closeSocket(s);
+        return false;
+    }
+
+    listen_    = static_cast<Socket>(s);
+    listening_ = true;
+    stop_      = false;
+    acceptor_  = std::thread(&ResultServer::acceptLoop, this);
+    std::cout << "[ResultServer] Listening on port " << port << "\n";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void ResultServer::stop()
+{
+    if (!listening_) return;
+    stop_ = true;
+    if (acceptor_.joinable()) acceptor_.join();
+    closeSocket(listen_);
+    listening_ = false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Socket c : clients_) closeSocket(c);
+    clients_.clear();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void ResultServer::acceptLoop()
+{
+    while (!stop_) {
+        // Poll so stop() is noticed without closing the socket under accept()
+#ifdef _WIN32
+        WSAPOLLFD pfd{static_cast<SOCKET>(listen_), POLLRDNORM, 0};
+        if (WSAPoll(&pfd, 1, 200) <= 0) continue;
+        const SOCKET c = accept(static_cast<SOCKET>(listen_), nullptr, nullptr);
+        if (c == INVALID_SOCKET) continue;
+        const DWORD timeout = kSendTimeoutMs;
+#else
+        pollfd pfd{listen_, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        const int c = accept(listen_, nullptr, nullptr);
+        if (c < 0) continue;
+        const timeval timeout{0, kSendTimeoutMs * 1000};
+#endif
+        setsockopt(c, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout),
+                   sizeof(timeout));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.push_back(static_cast<Socket>(c));
+        std::cout << "[ResultServer] Client connected (" << clients_.size() << ")\n";
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ResultServer::publish(const std::string& line)
+{
+    const std::string msg = line + "\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < clients_.size();) {
+        size_t sent = 0;
+        while (sent < msg.size()) {
+#ifdef _WIN32
+            const int n = send(static_cast<SOCKET>(clients_[i]), msg.data() + sent,
+                               static_cast<int>(msg.size() - sent), kSendFlags);
+#else
+            const ssize_t n = send(clients_[i], msg.data() + sent,
+                                   msg.size() - sent, kSendFlags);
+#endif
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        if (sent < msg.size()) {
+            // Gone or stalled past the send timeout
+            closeSocket(clients_[i]);
+            clients_.erase(clients_.begin() + i);
+            std::cout << "[ResultServer] Client dropped (" << clients_.size() << ")\n";
+        } else {
+            i++;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+int ResultServer::clientCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(clients_.size());
+}
@@ -0,0 +1,152 @@
+/**
+ * @file    ScaledPipeline.cpp
+ * @brief   Downsampled Tasks 1-3 implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "ScaledPipeline.h"
+#include "Threshold.h"
+#include "Morphology.h"
+#include "ConnectedComponents.h"
+#include "RegionFeatures.h"
+#include <algorithm>
+#include <opencv2/core/ocl.hpp>
+
+// -----------------------------------------------------------------------------
+// Internal helper — odd kernel covering the same extent at 1/scale
+// -----------------------------------------------------------------------------
+static int scaledKernel(int k, int scale)
+{
+    k = std::max(1, k / scale);
+    return (k % 2 == 0) ? k + 1 : k;
+}
+
+/** Nearest-neighbour upscale of a debug view to the frame size. */
+static void upscaleView(cv::Mat& view, const cv::Size& size)
+{
+    if (view.empty() || view.size() == size) return;
+    cv::Mat full;
+    cv::resize(view, full, size, 0, 0, cv::INTER_NEAREST);
+    view = full;
+}
+
+/** Task 4 on the small frame's runs, then geometry and views at full size. */
+static void finishDownscaled(const RegionRuns& runs, const cv::Mat& frame, int scale,
+                             AppState& state, const PipelineParams& p,
+                             const PipelineViews& views)
+{
+    computeAllFeatures(runs, state, p);
+    scaleRegionGeometry(state.regions, scale, frame.size());
+
+    // Debug windows keep the frame size
+    if (views.thresholded) upscaleView(state.frameThresholded, frame.size());
+    if (views.cleaned)     upscaleView(state.frameCleaned,     frame.size());
+    if (views.regions)     upscaleView(state.frameRegions,     frame.size());
+}
+
+/** Tasks 1-3 as full-frame passes, skipping empty mask tiles if enabled. */
+static void runHostSegmentation(const cv::Mat& frame, AppState& state,
+                                const PipelineParams& p, RegionRuns& runs)
+{
+    if (!p.sparseTiles) {
+        applyThreshold(frame,                   state.frameThresholded, p);
+        applyMorphology(state.frameThresholded, state.frameCleaned,     p);
+        findRegions(state.frameCleaned, state, p, runs);
+        return;
+    }
+    static thread_local cvcore::TileOccupancy maskTiles, cleanedTiles;
+    applyThreshold(frame, state.frameThresholded, p, maskTiles);
+    applyMorphology(state.frameThresholded, state.frameCleaned, p, maskTiles, cleanedTiles);
+    findRegions(state.frameCleaned, state, p, runs, cleanedTiles);
+}
+
+// -----------------------------------------------------------------------------
+int downscaleFactor(const PipelineParams& params)
+{
+    return 1 << std::clamp(params.downscaleLevel, 0, 2);
+}
+
+// -----------------------------------------------------------------------------
+bool deviceSegmentationEnabled(const PipelineParams& params)
+{
+    return params.useOpenCL && cv::ocl::useOpenCL();
+}
+
+// -----------------------------------------------------------------------------
+void runDeviceThresholdMorphology(const cv::Mat& frame, int scale, AppState& state,
+                                  const PipelineParams& params,
+                                  const PipelineViews& views)
+{
+    // One upload; everything up to the cleaned mask stays on the device
+    cv::UMat src, thresholded, cleaned;
+    frame.copyTo(src);
+    if (scale > 1) {
+        cv::UMat small;
+        cv::resize(src, small, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+        src = small;
+    }
+    applyThreshold(src, thresholded, params);
+    applyMorphology(thresholded, cleaned, params);
+
+    cleaned.copyTo(state.frameCleaned);
+    if (views.thresholded) thresholded.copyTo(state.frameThresholded);
+    else                   state.frameThresholded.release();
+}
+
+// -----------------------------------------------------------------------------
+void runDownscaledPipeline(const cv::Mat& frame, AppState& state,
+                           const PipelineParams& params,
+                           const PipelineViews& views)
+{
+    const int scale = downscaleFactor(params);
+
+    // Same physical extents at the reduced resolution
+    PipelineParams p   = params;
+    p.blurKernelSize   = scaledKernel(params.blurKernelSize,  scale);
+    p.morphKernelSize  = scaledKernel(params.morphKernelSize, scale);
+    p.minRegionArea    = std::max(1, params.minRegionArea / (scale * scale));
+
+    static thread_local RegionRuns cache;   // run buffer reused across frames
+    RegionRuns& runs = cache;
+    if (deviceSegmentationEnabled(p)) {
+        runDeviceThresholdMorphology(frame, scale, state, p, views);
+        findRegions(state.frameCleaned, state, p, runs);
+        finishDownscaled(runs, frame, scale, state, p, views);
+        return;
+    }
+
+    cv::Mat small;
+    cv::resize(frame, small, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+
+    if (p.streamPipeline) {
+        runStreamedPipeline(small, state, p, views, runs);
+    } else {
+        runHostSegmentation(small, state, p, runs);
+    }
+    finishDownscaled(runs, frame, scale, state, p, views);
+}
+
+// -----------------------------------------------------------------------------
+void runSegmentation(const cv::Mat& frame, AppState& state,
+                     const PipelineParams& params,
+                     const PipelineViews& views)
+{
+    if (params.downscaleLevel > 0) {
+        runDownscaledPipeline(frame, state, params, views);
+        return;
+    }
+
+    static thread_local RegionRuns cache;   // run buffer reused across frames
+    RegionRuns& runs = cache;
+    if (deviceSegmentationEnabled(params)) {
+        runDeviceThresholdMorphology(frame, 1, state, params, views);
+        findRegions(state.frameCleaned, state, params, runs);
+    } else if (params.streamPipeline) {
+        runStreamedPipeline(frame, state, params, views, runs);
+    } else {
+        runHostSegmentation(frame, state, params, runs);
+    }
+    computeAllFeatures(runs, state, params);
+}
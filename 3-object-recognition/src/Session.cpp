@@ -0,0 +1,217 @@
+/**
+ * @file    Session.cpp
+ * @brief   Session record-and-replay implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "Session.h"
+#include "Config.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+static const char* kFramePattern = "%06d.png";
+static const int   kPngLevel     = 1;   ///< Fastest zlib level; still lossless
+
+/** Path of frame i in a session folder. */
+static std::string framePath(const std::string& dir, long long i)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), kFramePattern, static_cast<int>(i));
+    return (std::filesystem::path(dir) / "frames" / name).string();
+}
+
+// =============================================================================
+// SessionRecorder
+// =============================================================================
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+// -----------------------------------------------------------------------------
+bool SessionRecorder::start(const std::string& dir)
+{
+    stop();
+
+    std::error_code ec;
+    const std::filesystem::path frames = std::filesystem::path(dir) / "frames";
+    std::filesystem::remove_all(frames, ec);
+    std::filesystem::create_directories(frames, ec);
+    if (ec) {
+        std::cerr << "[Session] Cannot create " << frames.string() << "\n";
+        return false;
+    }
+
+    dir_    = dir;
+    frames_ = 0;
+    failed_ = 0;
+    stop_   = false;
+    times_.clear();
+    changes_.clear();
+    writer_ = std::thread(&SessionRecorder::writeLoop, this);
+    std::cout << "[Session] Recording to " << dir_ << "\n";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void SessionRecorder::record(const cv::Mat& frame, const PipelineParams& params, bool cnn)
+{
+    if (!recording() || frame.empty()) return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (frames_ == 0) start_ = now;
+    const double t = std::chrono::duration<double, std::milli>(now - start_).count();
+    times_.push_back(t);
+
+    if (changes_.empty() || changes_.back().cnn != cnn ||
+        !sameParams(changes_.back().params, params))
+        changes_.push_back({frames_, t, params, cnn});
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_.wait(lock, [&] { return static_cast<int>(queue_.size()) < kQueue; });
+    queue_.emplace_back(frames_, frame.clone());
+    lock.unlock();
+    wake_.notify_one();
+    frames_++;
+}
+
+// -----------------------------------------------------------------------------
+void SessionRecorder::writeLoop()
+{
+    const std::vector<int> png = {cv::IMWRITE_PNG_COMPRESSION, kPngLevel};
+    for (;;) {
+        std::pair<long long, cv::Mat> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;   // stopping and drained
+            item = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        space_.notify_one();
+
+        bool ok = false;
+        try { ok = cv::imwrite(framePath(dir_, item.first), item.second, png); }
+        catch (const cv::Exception&) {}
+        if (!ok) failed_++;
+    }
+}
+
+// -----------------------------------------------------------------------------
+bool SessionRecorder::stop()
+{
+    if (!recording()) return true;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) writer_.join();
+
+    const std::string path = (std::filesystem::path(dir_) / "session.yml").string();
+    bool ok = false;
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (fs.isOpened()) {
+            fs << "frames" << static_cast<int>(frames_);
+            fs << "times" << times_;
+            fs << "changes" << "[";
+            for (const SessionChange& c : changes_) {
+                fs << "{";
+                fs << "frame"  << static_cast<int>(c.frame);
+                fs << "timeMs" << c.timeMs;
+                fs << "cnn"    << (c.cnn ? 1 : 0);
+                writeParams(fs, "params", c.params);
+                fs << "}";
+            }
+            fs << "]";
+            ok = true;
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "[Session] " << e.what() << "\n";
+    }
+
+    if (ok)
+        std::cout << "[Session] Recorded " << frames_ << " frames, "
+                  << changes_.size() << " settings changes to " << dir_ << "\n";
+    else
+        std::cerr << "[Session] Cannot write " << path << "\n";
+    if (failed_ > 0)
+        std::cerr << "[Session] " << failed_ << " frames could not be written\n";
+
+    dir_.clear();
+    return ok && failed_ == 0;
+}
+
+// =============================================================================
+// SessionReplay
+// =============================================================================
+bool SessionReplay::open(const std::string& dir)
+{
+    const std::string path = (std::filesystem::path(dir) / "session.yml").string();
+    times_.clear();
+    changes_.clear();
+
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) {
+            std::cerr << "[Session] Cannot open " << path << "\n";
+            return false;
+        }
+        fs["times"] >> times_;
+        for (const cv::FileNode& n : fs["changes"]) {
+            SessionChange c;
+            int frame = 0, cnn = 0;
+            n["frame"]  >> frame;
+            n["timeMs"] >> c.timeMs;
+            n["cnn"]    >> cnn;
+            c.frame = frame;
+            c.cnn   = cnn != 0;
+            readParams(n["params"], c.params);
+            changes_.push_back(c);
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "[Session] Cannot read " << path << ": " << e.what() << "\n";
+        return false;
+    }
+
+    std::stable_sort(changes_.begin(), changes_.end(),
+                     [](const SessionChange& a, const SessionChange& b) {
+                         return a.frame < b.frame;
+                     });
+    if (times_.empty() || changes_.empty() || changes_.front().frame != 0) {
+        std::cerr << "[Session] No recorded frames in " << dir << "\n";
+        return false;
+    }
+    dir_ = dir;
+    std::cout << "[Session] " << dir_ << ": " << times_.size() << " frames, "
+              << changes_.size() << " settings changes\n";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+std::string SessionReplay::frameSpec() const
+{
+    return (std::filesystem::path(dir_) / "frames" / kFramePattern).string();
+}
+
+// -----------------------------------------------------------------------------
+double SessionReplay::timeMs(long long frame) const
+{
+    if (frame < 0 || frame >= frameCount()) return 0.0;
+    return times_[static_cast<size_t>(frame)];
+}
+
+// -----------------------------------------------------------------------------
+const SessionChange& SessionReplay::settingsAt(long long frame) const
+{
+    // Last change at or before the frame
+    auto it = std::upper_bound(changes_.begin(), changes_.end(), frame,
+                               [](long long f, const SessionChange& c) { return f < c.frame; });
+    return it == changes_.begin() ? changes_.front() : *std::prev(it);
+}
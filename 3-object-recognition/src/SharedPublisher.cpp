@@ -0,0 +1,192 @@
+/**
+ * @file    SharedPublisher.cpp
+ * @brief   Shared-memory frame and region ring implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "SharedPublisher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char kShmMagic[4] = {'O', 'R', 'S', 'H'};
+
+/** Round up to a cache line. */
+static inline size_t alignLine(size_t n)
+{
+    return (n + 63) & ~static_cast<size_t>(63);
+}
+
+// -----------------------------------------------------------------------------
+bool SharedPublisher::create(size_t pixelBytes)
+{
+    const size_t regionOffset = sizeof(ShmSlotHeader);
+    const size_t pixelOffset  = alignLine(regionOffset + kMaxRegions * sizeof(ShmRegion));
+    const size_t slotBytes    = alignLine(pixelOffset + pixelBytes);
+    const size_t total        = sizeof(ShmHeader) + kSlots * slotBytes;
+
+#ifdef _WIN32
+    const std::string name = "Local\\" + name_;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(static_cast<uint64_t>(total) >> 32),
+                                       static_cast<DWORD>(total & 0xFFFFFFFFu),
+                                       name.c_str());
+    if (!mapping) return false;
+    void* p = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, total);
+    if (!p) { CloseHandle(mapping); return false; }
+    mapping_ = mapping;
+#else
+    const std::string name = "/" + name_;
+    shm_unlink(name.c_str());   // a segment left by a crashed run
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);   // the mapping keeps the segment
+    if (p == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+#endif
+    base_ = static_cast<uint8_t*>(p);
+    size_ = total;
+
+    std::memset(base_, 0, sizeof(ShmHeader));
+    ShmHeader* h = reinterpret_cast<ShmHeader*>(base_);
+    h->version      = 1;
+    h->slotCount    = kSlots;
+    h->maxRegions   = kMaxRegions;
+    h->slotOffset   = sizeof(ShmHeader);
+    h->slotBytes    = slotBytes;
+    h->regionOffset = regionOffset;
+    h->pixelOffset  = pixelOffset;
+    h->pixelBytes   = pixelBytes;
+    new (&h->latest) std::atomic<uint64_t>(0);
+    for (int s = 0; s < kSlots; s++) {
+        uint8_t* slot = base_ + sizeof(ShmHeader) + s * slotBytes;
+        std::memset(slot, 0, sizeof(ShmSlotHeader));
+        new (&reinterpret_cast<ShmSlotHeader*>(slot)->sequence) std::atomic<uint64_t>(0);
+    }
+
+    // Magic last: a reader that sees it sees a complete header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(h->magic, kShmMagic, 4);
+
+    std::cout << "[SharedPublisher] " << name << ": " << kSlots << " slots of "
+              << slotBytes / 1024 << " KB\n";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool SharedPublisher::publish(const cv::Mat& frame, const std::vector<RegionInfo>& regions,
+                              long long frameNo)
+{
+    if (name_.empty() || failed_ || frame.empty()) return false;
+
+    const size_t rowBytes = frame.cols * frame.elemSize();
+    const size_t bytes    = rowBytes * frame.rows;
+    if (!base_ && !create(bytes)) {
+        std::cerr << "[SharedPublisher] Cannot create segment " << name_ << "\n";
+        failed_ = true;
+        return false;
+    }
+
+    ShmHeader* h = reinterpret_cast<ShmHeader*>(base_);
+    if (bytes > h->pixelBytes) {
+        if (!warned_)
+            std::cerr << "[SharedPublisher] " << frame.cols << "x" << frame.rows
+                      << " frame exceeds the segment; not published\n";
+        warned_ = true;
+        return false;
+    }
+
+    const uint64_t n    = h->latest.load(std::memory_order_relaxed) + 1;
+    uint8_t*       slot = base_ + h->slotOffset + ((n - 1) % kSlots) * h->slotBytes;
+    ShmSlotHeader* sh   = reinterpret_cast<ShmSlotHeader*>(slot);
+
+    // Odd: readers of this slot discard what they read from now on
+    const uint64_t seq = sh->sequence.load(std::memory_order_relaxed);
+    sh->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    sh->frame  = frameNo;
+    sh->timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    sh->width  = frame.cols;
+    sh->height = frame.rows;
+    sh->type   = frame.type();
+    sh->step   = static_cast<int32_t>(rowBytes);
+
+    const int count = std::min(static_cast<int>(regions.size()), kMaxRegions);
+    ShmRegion* out  = reinterpret_cast<ShmRegion*>(slot + h->regionOffset);
+    for (int i = 0; i < count; i++) {
+        const RegionInfo& r = regions[i];
+        ShmRegion&        o = out[i];
+        o.trackId    = r.trackId;
+        o.x          = r.boundingBox.x;
+        o.y          = r.boundingBox.y;
+        o.w          = r.boundingBox.width;
+        o.h          = r.boundingBox.height;
+        o.cx         = r.centroid.x;
+        o.cy         = r.centroid.y;
+        o.angle      = static_cast<float>(r.angle);
+        o.confidence = r.confidence;
+        o.area       = static_cast<float>(r.area);
+        o.fillRatio  = static_cast<float>(r.fillRatio);
+        o.bboxRatio  = static_cast<float>(r.bboxRatio);
+        const size_t len = std::min(r.label.size(), sizeof(o.label) - 1);
+        std::memcpy(o.label, r.label.data(), len);
+        std::memset(o.label + len, 0, sizeof(o.label) - len);
+    }
+    sh->regionCount = count;
+
+    // Packed rows: one copy when the frame is continuous
+    uint8_t* pixels = slot + h->pixelOffset;
+    if (frame.isContinuous()) {
+        std::memcpy(pixels, frame.data, bytes);
+    } else {
+        for (int y = 0; y < frame.rows; y++)
+            std::memcpy(pixels + y * rowBytes, frame.ptr(y), rowBytes);
+    }
+
+    sh->sequence.store(seq + 2, std::memory_order_release);
+    h->latest.store(n, std::memory_order_release);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void SharedPublisher::close()
+{
+    if (!base_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    munmap(base_, size_);
+    shm_unlink(("/" + name_).c_str());
+#endif
+    base_   = nullptr;
+    size_   = 0;
+    failed_ = false;
+    warned_ = false;
+}
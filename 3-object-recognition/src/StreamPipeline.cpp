@@ -0,0 +1,84 @@
+/**
+ * @file    StreamPipeline.cpp
+ * @brief   Band-streamed threshold → morphology → labeling implementation.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "StreamPipeline.h"
+#include "Profiler.h"
+#include "Threshold.h"
+#include "Morphology.h"
+#include "ConnectedComponents.h"
+#include <algorithm>
+#include <cstring>
+
+// Rows per band — even, so block labeling sees bands starting on even rows
+static constexpr int kBandRows = 64;
+
+// -----------------------------------------------------------------------------
+void runStreamedPipeline(const cv::Mat& frame, AppState& state,
+                         const PipelineParams& params,
+                         const PipelineViews& views, RegionRuns& runs)
+{
+    ProfileScope profile(ProfileStage::Streamed);
+    CV_Assert(!frame.empty());
+
+    const int rows  = frame.rows;
+    const int cols  = frame.cols;
+    const int reach = morphologyReach(params);
+
+    // ISODATA / Otsu takes precedence over adaptive / global, as in applyThreshold
+    const int isoThreshold = (!params.useSatIntensity && params.useKMeans)
+        ? computeFrameDynamicThreshold(frame, params) : -1;
+
+    if (views.thresholded) state.frameThresholded.create(rows, cols, CV_8UC1);
+    else                   state.frameThresholded.release();
+    if (views.cleaned)     state.frameCleaned.create(rows, cols, CV_8UC1);
+    else                   state.frameCleaned.release();
+
+    // Rolling window holding thresholded rows [winBegin, winEnd)
+    cv::Mat window(std::min(rows, kBandRows + 2 * reach), cols, CV_8UC1);
+    int winBegin = 0;
+    int winEnd   = 0;
+
+    StreamLabeler labeler;
+    labeler.begin(frame.size(), params.labelMode, runs);
+
+    cv::Mat cleaned;
+    for (int r0 = 0; r0 < rows; r0 += kBandRows) {
+        const int r1    = std::min(rows, r0 + kBandRows);
+        const int need0 = std::max(0, r0 - reach);
+        const int need1 = std::min(rows, r1 + reach);
+
+        // --- Slide the window: keep rows shared with the previous band ------
+        const int keep = std::max(0, winEnd - need0);
+        if (keep > 0 && need0 > winBegin)
+            std::memmove(window.ptr<uchar>(0), window.ptr<uchar>(need0 - winBegin),
+                         static_cast<size_t>(keep) * cols);
+        winBegin = need0;
+
+        // --- Task 1: threshold only the rows not yet in the window ----------
+        const int from = std::max(winEnd, need0);
+        if (need1 > from) {
+            cv::Mat fresh = window.rowRange(from - winBegin, need1 - winBegin);
+            applyThresholdRows(frame, from, need1, fresh, params, isoThreshold);
+            if (views.thresholded)
+                fresh.copyTo(state.frameThresholded.rowRange(from, need1));
+        }
+        winEnd = need1;
+
+        // --- Task 2: morphology on the window; the band's rows are exact ----
+        applyMorphology(window.rowRange(0, winEnd - winBegin), cleaned, params);
+        cv::Mat band = cleaned.rowRange(r0 - winBegin, r1 - winBegin);
+        if (views.cleaned)
+            band.copyTo(state.frameCleaned.rowRange(r0, r1));
+
+        // --- Task 3: first labeling pass ------------------------------------
+        labeler.addRows(band, r0);
+    }
+
+    labeler.finish();
+    collectRegions(runs, state, params, views.regions);
+}
@@ -0,0 +1,332 @@
+/**
+ * @file    TaskScheduler.cpp
+ * @brief   Work-stealing task pool implementation and OpenCV backend.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include "TaskScheduler.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+#if __has_include(<opencv2/core/parallel/parallel_backend.hpp>)
+#include <opencv2/core/parallel/parallel_backend.hpp>
+#define HAS_CV_PARALLEL_BACKEND 1
+#endif
+
+static thread_local TaskPriority tlsPriority = TaskPriority::Normal;
+static thread_local int          tlsWorker   = -1;
+
+static const std::chrono::milliseconds kStatsWindow(500);
+
+#ifdef HAS_CV_PARALLEL_BACKEND
+// =============================================================================
+// OpenCV parallel_for_ backend
+// =============================================================================
+class SchedulerBackend : public cv::parallel::ParallelForAPI {
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body, void* data) override
+    {
+        TaskScheduler::instance().parallelFor(0, tasks, [&](int begin, int end) {
+            body(begin, end, data);
+        });
+    }
+    int getThreadNum() const override { return TaskScheduler::workerIndex() + 1; }
+    int getNumThreads() const override { return TaskScheduler::instance().concurrency(); }
+    int setNumThreads(int) override { return getNumThreads(); }   // pool size is fixed
+    const char* getName() const override { return "objrec-tasks"; }
+};
+#endif
+
+// =============================================================================
+// TaskRing
+// =============================================================================
+void TaskScheduler::TaskRing::pushBack(Task&& task)
+{
+    if (count == slots.size()) {
+        std::vector<Task> grown(std::max<size_t>(16, slots.size() * 2));
+        for (size_t i = 0; i < count; i++)
+            grown[i] = std::move(slots[(head + i) & (slots.size() - 1)]);
+        slots.swap(grown);
+        head = 0;
+    }
+    slots[(head + count) & (slots.size() - 1)] = std::move(task);
+    count++;
+}
+
+// -----------------------------------------------------------------------------
+TaskScheduler::Task TaskScheduler::TaskRing::popBack()
+{
+    count--;
+    return std::move(slots[(head + count) & (slots.size() - 1)]);
+}
+
+// -----------------------------------------------------------------------------
+TaskScheduler::Task TaskScheduler::TaskRing::popFront()
+{
+    Task task = std::move(slots[head]);
+    head = (head + 1) & (slots.size() - 1);
+    count--;
+    return task;
+}
+
+// =============================================================================
+// TaskScheduler
+// =============================================================================
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+// -----------------------------------------------------------------------------
+TaskScheduler::~TaskScheduler()
+{
+    stop();
+}
+
+// -----------------------------------------------------------------------------
+void TaskScheduler::start(int workers)
+{
+    if (!workers_.empty()) return;
+    if (workers <= 0)
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+    stop_ = false;
+    for (int i = 0; i < workers; i++)
+        workers_.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < workers; i++)
+        workers_[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+
+    statsTime_ = std::chrono::steady_clock::now();
+    statsBusy_.assign(workers, 0);
+    statsUtil_.assign(workers, 0.f);
+    std::cout << "[Tasks] " << workers << " workers\n";
+}
+
+// -----------------------------------------------------------------------------
+void TaskScheduler::stop()
+{
+    if (workers_.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& w : workers_)
+        if (w->thread.joinable()) w->thread.join();
+    workers_.clear();   // an installed OpenCV backend now runs loops inline
+}
+
+// -----------------------------------------------------------------------------
+bool TaskScheduler::useForOpenCV()
+{
+#ifdef HAS_CV_PARALLEL_BACKEND
+    if (workers_.empty()) return false;
+    cv::parallel::setParallelForBackend(std::make_shared<SchedulerBackend>(), false);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+TaskPriority TaskScheduler::threadPriority()                { return tlsPriority; }
+void TaskScheduler::setThreadPriority(TaskPriority priority) { tlsPriority = priority; }
+int  TaskScheduler::workerIndex()                           { return tlsWorker; }
+
+// -----------------------------------------------------------------------------
+void TaskScheduler::push(std::vector<Task>& tasks, TaskPriority priority)
+{
+    const size_t p = static_cast<size_t>(priority);
+    const int    n = static_cast<int>(tasks.size());
+    if (tlsWorker >= 0) {
+        Worker& w = *workers_[tlsWorker];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        for (Task& t : tasks) w.queues[p].pushBack(std::move(t));
+    } else {
+        // Spread so each worker finds work in its own deque
+        const size_t count = workers_.size();
+        const size_t first = next_.fetch_add(n, std::memory_order_relaxed);
+        for (int i = 0; i < n; i++) {
+            Worker& w = *workers_[(first + i) % count];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            w.queues[p].pushBack(std::move(tasks[i]));
+        }
+    }
+    queued_[p] += n;
+    pending_   += n;
+
+    // Taking the lock orders the push before a worker's sleep check
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    if (n == 1) wake_.notify_one();
+    else        wake_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+bool TaskScheduler::runOne(int self, TaskPriority maxPriority)
+{
+    const int count = static_cast<int>(workers_.size());
+    if (count == 0 || pending_.load(std::memory_order_acquire) == 0) return false;
+
+    for (int p = 0; p <= static_cast<int>(maxPriority); p++) {
+        Task task;
+        bool stolen = false;
+
+        // Own deque from the back, then the others' from the front
+        if (self >= 0) {
+            Worker& w = *workers_[self];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (!w.queues[p].empty()) task = w.queues[p].popBack();
+        }
+        const int start = self >= 0 ? self + 1
+                                    : static_cast<int>(next_.load(std::memory_order_relaxed));
+        for (int k = 0; !task && k < count; k++) {
+            const int victim = (start + k) % count;
+            if (victim == self) continue;
+            Worker& w = *workers_[victim];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (!w.queues[p].empty()) {
+                task   = w.queues[p].popFront();
+                stolen = true;
+            }
+        }
+        if (!task) continue;
+
+        pending_--;
+        queued_[p]--;
+
+        // Nested loops inherit the task's priority
+        const TaskPriority saved = tlsPriority;
+        tlsPriority = static_cast<TaskPriority>(p);
+        const auto t0 = std::chrono::steady_clock::now();
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "[Tasks] Task failed: " << e.what() << "\n";
+        } catch (...) {
+            std::cerr << "[Tasks] Task failed\n";
+        }
+        tlsPriority = saved;
+
+        if (self >= 0) {
+            Worker& w = *workers_[self];
+            w.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - t0).count();
+            w.tasks++;
+            if (stolen) w.steals++;
+        }
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+void TaskScheduler::workerLoop(int index)
+{
+    tlsWorker = index;
+    for (;;) {
+        if (runOne(index, TaskPriority::Low)) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [&] { return stop_ || pending_.load() > 0; });
+        if (stop_ && pending_.load() == 0) return;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void TaskScheduler::submit(Task task, TaskPriority priority)
+{
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+    std::vector<Task> one;
+    one.push_back(std::move(task));
+    push(one, priority);
+}
+
+// -----------------------------------------------------------------------------
+void TaskScheduler::parallelFor(int begin, int end, const std::function<void(int, int)>& body,
+                                int grain)
+{
+    const int n = end - begin;
+    if (n <= 0) return;
+    grain = std::max(1, grain);
+
+    const int chunks = std::min((n + grain - 1) / grain, concurrency() * kChunksPerThread);
+    if (workers_.empty() || chunks <= 1) {
+        body(begin, end);
+        return;
+    }
+
+    // The waiter keeps this alive until every chunk has counted down
+    struct Join {
+        const std::function<void(int, int)>* body;
+        std::atomic<int>   left{0};
+        std::mutex         mutex;
+        std::exception_ptr error;
+
+        void run(int from, int to) {
+            try {
+                (*body)(from, to);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+        }
+    } join;
+    join.body = &body;
+    join.left = chunks - 1;
+
+    // A pointer and two ints: small enough for std::function to store
+    // without allocating.  The buffer is emptied by push() before any
+    // chunk runs, so a nested loop on this thread may reuse it.
+    static thread_local std::vector<Task> tasks;
+    tasks.clear();
+    for (int k = 1; k < chunks; k++) {
+        const int from = begin + static_cast<int>(static_cast<long long>(n) * k / chunks);
+        const int to   = begin + static_cast<int>(static_cast<long long>(n) * (k + 1) / chunks);
+        Join* j = &join;
+        tasks.push_back([j, from, to] {
+            j->run(from, to);
+            j->left.fetch_sub(1, std::memory_order_acq_rel);   // j is gone after this
+        });
+    }
+    const TaskPriority priority = tlsPriority;
+    push(tasks, priority);
+    tasks.clear();
+
+    join.run(begin, begin + n / chunks);
+    while (join.left.load(std::memory_order_acquire) > 0)
+        if (!runOne(tlsWorker, priority)) std::this_thread::yield();
+
+    if (join.error) std::rethrow_exception(join.error);
+}
+
+// -----------------------------------------------------------------------------
+TaskScheduler::Stats TaskScheduler::stats()
+{
+    Stats s;
+    for (int p = 0; p < kPriorities; p++) s.queued[p] = std::max(0, queued_[p].load());
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    const auto   now     = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double, std::nano>(now - statsTime_).count();
+    const bool   sample  = now - statsTime_ >= kStatsWindow;
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+        const Worker& w = *workers_[i];
+        if (sample) {
+            const long long busy = w.busyNs.load();
+            statsUtil_[i] = static_cast<float>(std::min(1.0, (busy - statsBusy_[i]) / elapsed));
+            statsBusy_[i] = busy;
+        }
+        s.workers.push_back({statsUtil_[i], w.tasks.load(), w.steals.load()});
+    }
+    if (sample) statsTime_ = now;
+    return s;
+}
@@ -7,49 +7,60 @@
  */
 
 #include "Threshold.h"
-#include <random>
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <mutex>
+#include <opencv2/core/hal/intrin.hpp>
 
 // -----------------------------------------------------------------------------
 void applyCustomSatIntensityThreshold(const cv::Mat& src, cv::Mat& dst,
                                       const PipelineParams& params)
 {
-    CV_Assert(!src.empty() && src.channels() == 3);
+    CV_Assert(!src.empty() && src.type() == CV_8UC3);
 
-    // Convert BGR → HSV for saturation and intensity access
-    cv::Mat hsv;
-    cv::cvtColor(src, hsv, cv::COLOR_BGR2HSV);
-
-    dst = cv::Mat::zeros(src.size(), CV_8UC1);
-
-    // Normalised threshold in [0..1] from integer param [0..255]
-    float thresh = params.thresholdValue / 255.f;
-
-    for (int r = 0; r < hsv.rows; r++) {
-        const cv::Vec3b* rowPtr = hsv.ptr<cv::Vec3b>(r);
-        uchar*           dstPtr = dst.ptr<uchar>(r);
-        for (int c = 0; c < hsv.cols; c++) {
-            // OpenCV HSV: H[0..179], S[0..255], V[0..255]
-            float S = rowPtr[c][1] / 255.f;  ///< Saturation [0..1]
-            float V = rowPtr[c][2] / 255.f;  ///< Value/intensity [0..1]
-
-            // score: high for white (low S, high V), low for dark/coloured
-            float score = (1.f - S) * V;
+    // With V = max(B,G,R) and S = (max - min) / max, the score (1 - S) * V
+    // is min(B,G,R): one fused pass replaces the HSV conversion.
+    dst.create(src.size(), CV_8UC1);
+    const uchar thresh = cv::saturate_cast<uchar>(params.thresholdValue);
+    const int   cols   = src.cols;
 
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int r = range.start; r < range.end; r++) {
+            const uchar* in  = src.ptr<uchar>(r);
+            uchar*       out = dst.ptr<uchar>(r);
+            int c = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+            const int           step = cv::VTraits<cv::v_uint8>::vlanes();
+            const cv::v_uint8   vt   = cv::vx_setall_u8(thresh);
+            for (; c + step <= cols; c += step) {
+                cv::v_uint8 b, g, rr;
+                cv::v_load_deinterleave(in + 3 * c, b, g, rr);
+                cv::v_store(out + c, cv::v_lt(cv::v_min(cv::v_min(b, g), rr), vt));
+            }
+#endif
             // Foreground (object) = score below threshold
-            dstPtr[c] = (score < thresh) ? 255 : 0;
+            for (; c < cols; c++) {
+                const uchar score = std::min({in[3*c], in[3*c + 1], in[3*c + 2]});
+                out[c] = (score < thresh) ? 255 : 0;
+            }
         }
-    }
+    });
 }
 
 // -----------------------------------------------------------------------------
-void applyBlur(const cv::Mat& src, cv::Mat& dst, const PipelineParams& params)
+void applyBlur(cv::InputArray src, cv::OutputArray dst, const PipelineParams& params)
 {
     int k = params.blurKernelSize;
     // Kernel must be odd and >= 1
     if (k < 1) k = 1;
     if (k % 2 == 0) k++;
-    cv::GaussianBlur(src, dst, cv::Size(k, k), 0);
+    switch (params.blurMode) {
+        case 1:  cv::blur(src, dst, cv::Size(k, k));                break; // running sums, O(1) in k
+        case 2:  cv::stackBlur(src, dst, cv::Size(k, k));           break; // Gaussian-like, O(1) in k
+        default: cv::GaussianBlur(src, dst, cv::Size(k, k), 0);     break;
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -63,35 +74,48 @@ void toGrayscale(const cv::Mat& src, cv::Mat& dst)
 }
 
 // -----------------------------------------------------------------------------
-int computeISODATAThreshold(const cv::Mat& gray)
+void computeHistogram(const cv::Mat& gray, int hist[256])
 {
     CV_Assert(gray.type() == CV_8UC1);
+    std::fill(hist, hist + 256, 0);
 
-    // Collect a random 1/16 sample of pixel values
-    std::vector<float> samples;
-    samples.reserve(gray.total() / 16 + 1);
-
-    std::mt19937 rng(42);
-    std::uniform_int_distribution<int> distR(0, gray.rows - 1);
-    std::uniform_int_distribution<int> distC(0, gray.cols - 1);
-
-    int nSamples = static_cast<int>(gray.total() / 16);
-    for (int i = 0; i < nSamples; i++) {
-        samples.push_back(static_cast<float>(
-            gray.at<uchar>(distR(rng), distC(rng))));
-    }
+    // One stripe per thread; four interleaved sub-histograms per stripe keep
+    // runs of equal pixels from serialising on the same counter.
+    std::mutex merge;
+    cv::parallel_for_(cv::Range(0, gray.rows), [&](const cv::Range& range) {
+        std::array<std::array<int, 256>, 4> sub{};
+        for (int r = range.start; r < range.end; r++) {
+            const uchar* p = gray.ptr<uchar>(r);
+            int c = 0;
+            for (; c + 4 <= gray.cols; c += 4) {
+                sub[0][p[c]]++;
+                sub[1][p[c + 1]]++;
+                sub[2][p[c + 2]]++;
+                sub[3][p[c + 3]]++;
+            }
+            for (; c < gray.cols; c++) sub[0][p[c]]++;
+        }
+        std::lock_guard<std::mutex> lock(merge);
+        for (int v = 0; v < 256; v++)
+            hist[v] += sub[0][v] + sub[1][v] + sub[2][v] + sub[3][v];
+    }, std::max(1, cv::getNumThreads()));
+}
 
-    // Two-cluster k-means (ISODATA): iterate until means stabilise
+// -----------------------------------------------------------------------------
+int computeISODATAThreshold(const int hist[256])
+{
+    // Two-cluster k-means (ISODATA) on the histogram bins: every pixel is
+    // counted, and each iteration costs 256 bins instead of N samples.
     float m1 = 80.f, m2 = 180.f; // initial guesses: dark / light
     for (int iter = 0; iter < 50; iter++) {
-        float sum1 = 0, sum2 = 0;
-        int   cnt1 = 0, cnt2 = 0;
-        for (float v : samples) {
-            if (std::fabs(v - m1) < std::fabs(v - m2)) { sum1 += v; cnt1++; }
-            else                                        { sum2 += v; cnt2++; }
+        double sum1 = 0, sum2 = 0;
+        long long cnt1 = 0, cnt2 = 0;
+        for (int v = 0; v < 256; v++) {
+            if (std::fabs(v - m1) < std::fabs(v - m2)) { sum1 += double(v) * hist[v]; cnt1 += hist[v]; }
+            else                                        { sum2 += double(v) * hist[v]; cnt2 += hist[v]; }
         }
-        float nm1 = cnt1 > 0 ? sum1 / cnt1 : m1;
-        float nm2 = cnt2 > 0 ? sum2 / cnt2 : m2;
+        float nm1 = cnt1 > 0 ? static_cast<float>(sum1 / cnt1) : m1;
+        float nm2 = cnt2 > 0 ? static_cast<float>(sum2 / cnt2) : m2;
         if (std::fabs(nm1 - m1) < 0.5f && std::fabs(nm2 - m2) < 0.5f) break;
         m1 = nm1; m2 = nm2;
     }
@@ -99,25 +123,81 @@ int computeISODATAThreshold(const cv::Mat& gray)
 }
 
 // -----------------------------------------------------------------------------
-void applyThreshold(const cv::Mat& src, cv::Mat& dst,
-                    const PipelineParams& params)
+int computeISODATAThreshold(const cv::Mat& gray)
 {
-    // 1. Blur to reduce noise
-    cv::Mat blurred;
-    applyBlur(src, blurred, params);
+    int hist[256];
+    computeHistogram(gray, hist);
+    return computeISODATAThreshold(hist);
+}
 
-    // 2. Convert to grayscale
-    cv::Mat gray;
-    toGrayscale(blurred, gray);
+// -----------------------------------------------------------------------------
+int computeOtsuThreshold(const int hist[256])
+{
+    double total = 0, sumAll = 0;
+    for (int v = 0; v < 256; v++) { total += hist[v]; sumAll += double(v) * hist[v]; }
+    if (total <= 0) return 127;
 
-    // 3. Threshold — select mode from params
+    // Maximise between-class variance of [0..t] vs [t+1..255]
+    double w0 = 0, sum0 = 0, bestVar = -1;
+    int    best = 127;
+    for (int t = 0; t < 255; t++) {
+        w0   += hist[t];
+        sum0 += double(t) * hist[t];
+        const double w1 = total - w0;
+        if (w0 == 0 || w1 == 0) continue;
+        const double mu0 = sum0 / w0;
+        const double mu1 = (sumAll - sum0) / w1;
+        const double var = w0 * w1 * (mu0 - mu1) * (mu0 - mu1);
+        if (var > bestVar) { bestVar = var; best = t; }
+    }
+    return best;
+}
+
+// -----------------------------------------------------------------------------
+int computeOtsuThreshold(const cv::Mat& gray)
+{
+    int hist[256];
+    computeHistogram(gray, hist);
+    return computeOtsuThreshold(hist);
+}
+
+// -----------------------------------------------------------------------------
+// Internal helper — ISODATA or Otsu, as selected by params.dynamicThresh
+// -----------------------------------------------------------------------------
+static int computeDynamicThreshold(const cv::Mat& gray, const PipelineParams& params)
+{
+    int hist[256];
+    computeHistogram(gray, hist);
+    return params.dynamicThresh == 1 ? computeOtsuThreshold(hist)
+                                     : computeISODATAThreshold(hist);
+}
+
+// -----------------------------------------------------------------------------
+// Adaptive threshold neighbourhood and offset
+// -----------------------------------------------------------------------------
+static constexpr int kAdaptiveBlock = 11;
+static constexpr int kAdaptiveC     = 2;
+
+// -----------------------------------------------------------------------------
+// Internal helper — threshold an already blurred frame (or band of rows).
+// isoThreshold < 0 computes the ISODATA / Otsu threshold from this input.
+// -----------------------------------------------------------------------------
+static void thresholdBlurred(const cv::Mat& blurred, cv::Mat& dst,
+                             const PipelineParams& params, int isoThreshold)
+{
     if (params.useSatIntensity) {
         // Custom saturation+intensity mode — works on blurred colour frame
         applyCustomSatIntensityThreshold(blurred, dst, params);
+        return;
+    }
 
-    } else if (params.useKMeans) {
+    // Convert to grayscale
+    cv::Mat gray;
+    toGrayscale(blurred, gray);
+
+    if (params.useKMeans) {
         // Dynamic threshold: midpoint of two dominant pixel clusters
-        int dynThresh = computeISODATAThreshold(gray);
+        int dynThresh = isoThreshold >= 0 ? isoThreshold : computeDynamicThreshold(gray, params);
         cv::threshold(gray, dst, dynThresh, 255, cv::THRESH_BINARY_INV);
 
     } else if (params.useAdaptive) {
@@ -125,7 +205,7 @@ void applyThreshold(const cv::Mat& src, cv::Mat& dst,
         cv::adaptiveThreshold(gray, dst, 255,
                               cv::ADAPTIVE_THRESH_GAUSSIAN_C,
                               cv::THRESH_BINARY_INV,
-                              11, 2);
+                              kAdaptiveBlock, kAdaptiveC);
 
     } else {
         // Global fixed threshold from params
@@ -134,3 +214,110 @@ void applyThreshold(const cv::Mat& src, cv::Mat& dst,
                       cv::THRESH_BINARY_INV);
     }
 }
+
+// -----------------------------------------------------------------------------
+void applyThreshold(const cv::Mat& src, cv::Mat& dst,
+                    const PipelineParams& params)
+{
+    ProfileScope profile(ProfileStage::Threshold);
+
+    // 1. Blur to reduce noise
+    cv::Mat blurred;
+    applyBlur(src, blurred, params);
+
+    // 2. Threshold — select mode from params
+    thresholdBlurred(blurred, dst, params, -1);
+}
+
+// -----------------------------------------------------------------------------
+void applyThreshold(const cv::Mat& src, cv::Mat& dst,
+                    const PipelineParams& params, cvcore::TileOccupancy& tiles)
+{
+    ProfileScope profile(ProfileStage::Threshold);
+
+    cv::Mat blurred;
+    applyBlur(src, blurred, params);
+    thresholdBlurred(blurred, dst, params, -1);
+    tiles.build(dst);
+}
+
+// -----------------------------------------------------------------------------
+void applyThreshold(const cv::UMat& src, cv::UMat& dst,
+                    const PipelineParams& params)
+{
+    ProfileScope profile(ProfileStage::Threshold);
+
+    cv::UMat blurred;
+    applyBlur(src, blurred, params);
+
+    if (params.useSatIntensity) {
+        // (1 - S) * V = min(B, G, R), as in the host version
+        std::vector<cv::UMat> bgr;
+        cv::split(blurred, bgr);
+        cv::UMat score;
+        cv::min(bgr[0], bgr[1], score);
+        cv::min(score, bgr[2], score);
+        cv::threshold(score, dst, params.thresholdValue - 1, 255, cv::THRESH_BINARY_INV);
+        return;
+    }
+
+    cv::UMat gray;
+    if (blurred.channels() == 1) gray = blurred;
+    else                         cv::cvtColor(blurred, gray, cv::COLOR_BGR2GRAY);
+
+    if (params.useKMeans) {
+        // Histogram on the device; 256 bins come back for ISODATA / Otsu
+        cv::UMat histU;
+        cv::calcHist(std::vector<cv::UMat>{gray}, {0}, cv::noArray(), histU,
+                     {256}, {0.f, 256.f});
+        cv::Mat histF = histU.getMat(cv::ACCESS_READ);
+        int hist[256];
+        for (int v = 0; v < 256; v++) hist[v] = cvRound(histF.at<float>(v));
+        histF.release();
+        const int t = params.dynamicThresh == 1 ? computeOtsuThreshold(hist)
+                                                : computeISODATAThreshold(hist);
+        cv::threshold(gray, dst, t, 255, cv::THRESH_BINARY_INV);
+
+    } else if (params.useAdaptive) {
+        cv::adaptiveThreshold(gray, dst, 255,
+                              cv::ADAPTIVE_THRESH_GAUSSIAN_C,
+                              cv::THRESH_BINARY_INV,
+                              kAdaptiveBlock, kAdaptiveC);
+
+    } else {
+        cv::threshold(gray, dst, params.thresholdValue, 255, cv::THRESH_BINARY_INV);
+    }
+}
+
+// -----------------------------------------------------------------------------
+int computeFrameDynamicThreshold(const cv::Mat& src, const PipelineParams& params)
+{
+    cv::Mat blurred, gray;
+    applyBlur(src, blurred, params);
+    toGrayscale(blurred, gray);
+    return computeDynamicThreshold(gray, params);
+}
+
+// -----------------------------------------------------------------------------
+void applyThresholdRows(const cv::Mat& src, int rowBegin, int rowEnd,
+                        cv::Mat& dst, const PipelineParams& params,
+                        int isoThreshold)
+{
+    CV_Assert(0 <= rowBegin && rowBegin < rowEnd && rowEnd <= src.rows);
+
+    // Adaptive means need the neighbouring rows of the band as well;
+    // stack blur treats the ROI edge as the image border, so it reads a
+    // halo of real rows instead
+    const bool adaptive = !params.useSatIntensity && !params.useKMeans && params.useAdaptive;
+    const int  halo     = (adaptive ? kAdaptiveBlock / 2 : 0) +
+                          (params.blurMode == 2 ? std::max(1, params.blurKernelSize) / 2 + 1 : 0);
+    const int  first    = std::max(0, rowBegin - halo);
+    const int  last     = std::min(src.rows, rowEnd + halo);
+
+    // A row-range ROI blurs with the real rows around it as border
+    cv::Mat blurred, mask;
+    applyBlur(src.rowRange(first, last), blurred, params);
+    thresholdBlurred(blurred, mask, params, isoThreshold);
+
+    mask.rowRange(rowBegin - first, rowEnd - first).copyTo(dst);
+}
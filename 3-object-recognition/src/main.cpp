@@ -5,7 +5,11 @@
  *          Usage:
  *            objectRecognition.exe --mode live  [--camera 0]
  *            objectRecognition.exe --mode image --input <path>
+ *            objectRecognition.exe --mode live  --input <video | rtsp://... | gst pipeline>
  *            objectRecognition.exe --mode train [--camera 0]
+ *            objectRecognition.exe --mode live  --shm <name>   (see SharedPublisher.h)
+ *            objectRecognition.exe --mode live  --record <dir>
+ *            objectRecognition.exe --replay <dir> [--replay-speed max|realtime]
  *
  *          Keyboard controls:
  *            t/T     threshold -/+5
@@ -16,6 +20,9 @@
  *            m/M     morph kernel -/+2
  *            i/I     morph iterations -/+1
  *            o       cycle morph mode
+ *            l       cycle labeling mode (parallel / block / sequential)
+ *            f       toggle streamed (row band) threshold-morph-label pipeline
+ *            g       toggle motion gate (skip unchanged frames)
  *            r/R     min region area -/+100
  *            n       enter train mode -- prompts for label
  *            c       capture shape feature sample
@@ -25,6 +32,7 @@
  *            j/J     K neighbours -/+1
  *            e       record eval sample
  *            p       print + save confusion matrix
+ *            w       write stage profile as Chrome trace (data/trace.json)
  *            1-3     toggle Threshold/Cleaned/Regions windows
  *            4-6     toggle Axes/BBox/FeatureText overlays
  *            7       toggle confusion matrix window
@@ -33,31 +41,71 @@
  *            0       toggle embedding scatter plot
  *            q/ESC   quit
  *
+ *          Threads:
+ *            decode      capture / video decoding into a latest-frame ring
+ *            processing  Tasks 1-4, tracking, classification
+ *            main        OpenCV windows, ImGui panels, keyboard, mouse
+ *          The processing thread publishes AppState snapshots and the main
+ *          thread publishes its PipelineParams through lock-free triple
+ *          buffers; neither waits on the other per frame.
+ *
+ *          Mouse (main window):
+ *            left-drag    set processing ROI (saved to data/config.yml)
+ *            right-click  clear processing ROI
+ *
  * @author  Krushna Sanjay Sharma
  * @date    February 2026
  */
 
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
 #include <string>
 #include <chrono>
 #include <cmath>
+#include <tuple>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
 
 #include "AppState.h"
 #include "Threshold.h"
 #include "Morphology.h"
 #include "ConnectedComponents.h"
+#include "StreamPipeline.h"
+#include "ScaledPipeline.h"
+#include "Config.h"
 #include "RegionFeatures.h"
+#include "RegionTracker.h"
+#include "MotionGate.h"
 #include "ObjectDB.h"
 #include "Classifier.h"
 #include "Evaluator.h"
 #include "Embedding.h"
+#include "AsyncEmbedder.h"
+#include "PrototypeCondenser.h"
 #include "EmbeddingPlot.h"
+#include "ModelManager.h"
+#include "FrameSource.h"
 #include "GUI.h"
+#include "TripleBuffer.h"
+#include "SharedPublisher.h"
+#include "Session.h"
+#include "TaskScheduler.h"
+#include "AllocCounter.h"
+#include "Profiler.h"
+#include <cvcore/matPool.hpp>
+#include <cvcore/metrics.hpp>
 
 // Unknown auto-prompt threshold -- frames before triggering popup
 static const int kUnknownFrameThresh = 60;
 
+// Persistent settings (processing ROI)
+static const std::string kConfigPath = "data/config.yml";
+
 // -----------------------------------------------------------------------------
 // Helpers
 // -----------------------------------------------------------------------------
@@ -112,7 +160,9 @@ static void overlayParams(cv::Mat& frame, const PipelineParams& p,
     put("MinA:" + std::to_string(p.minRegionArea), 3);
     put("Rgns:" + std::to_string(state.regions.size()), 4);
     put(std::string("Mode:") +
-        (state.embeddingMode_ ? "CNN" : "Shape Feature"), 5);
+        (!state.embeddingMode_ ? "Shape Feature"
+         : p.cnnCascade ? "CNN cascade" : "CNN") +
+        (state.embeddingMode_ && state.modelLoading ? " (loading)" : ""), 5);
     put("FPS:"  + std::to_string(static_cast<int>(state.fps)), 6);
 
     if (state.mode == AppState::Mode::Train) {
@@ -132,10 +182,12 @@ static void overlayParams(cv::Mat& frame, const PipelineParams& p,
 static void printParams(const PipelineParams& p)
 {
     static const char* morphNames[] = {"Open","Close","Erode","Dilate"};
+    static const char* labelNames[] = {"Par","Blk","Seq"};
     std::cout << "\r"
               << "T:" << p.thresholdValue
               << " B:" << p.blurKernelSize
               << " Morph:" << morphNames[p.morphMode]
+              << " Label:" << labelNames[p.labelMode]
               << " MinArea:" << p.minRegionArea
               << "   " << std::flush;
 }
@@ -145,11 +197,11 @@ static void printParams(const PipelineParams& p)
  *
  *        Builds a DBEntry from the top-ranked region's features, appends it
  *        to the object database, increments the per-label sample counter, and
- *        refits the classifier.
+ *        passes the new row to the classifier (index rebuilt in the background).
  *
  * @param state       App state — reads current label and top-ranked region.
  * @param db          Object database — entry is appended here.
- * @param classifier  Classifier — refitted after the append.
+ * @param classifier  Classifier — learns the appended row.
  */
 static void captureTrainingSample(AppState& state, ObjectDB& db,
                                    Classifier& classifier)
@@ -161,17 +213,403 @@ static void captureTrainingSample(AppState& state, ObjectDB& db,
         std::cout << "\n[Train] No region detected.\n"; return;
     }
     const RegionInfo& reg = state.regions[0];
-    if (reg.huMoments.empty()) {
+    if (!reg.hasShape) {
         std::cout << "\n[Train] Features not computed.\n"; return;
     }
     DBEntry entry = ObjectDB::entryFromRegion(reg, state.currentTrainLabel);
     db.append(entry);
     state.samplesThisLabel++;
-    classifier.refit(db);
+    classifier.learn(db);
     std::cout << "\n[Train] Captured sample " << state.samplesThisLabel
               << " for '" << state.currentTrainLabel << "'\n";
 }
 
+// -----------------------------------------------------------------------------
+// Processing ROI
+// -----------------------------------------------------------------------------
+/** Mouse drag state of the main window, shared with the callback. */
+struct RoiDrag {
+    bool      dragging = false;
+    cv::Point start;
+    cv::Point current;
+    bool      changed  = false;  ///< A new ROI (or clear) is in result
+    cv::Rect  result;
+};
+
+/**
+ * @brief Mouse callback for the main window: left-drag selects the
+ *        processing ROI, right-click clears it.
+ */
+static void onMainMouse(int event, int x, int y, int /*flags*/, void* userdata)
+{
+    RoiDrag& drag = *static_cast<RoiDrag*>(userdata);
+    switch (event) {
+        case cv::EVENT_LBUTTONDOWN:
+            drag.dragging = true;
+            drag.start = drag.current = {x, y};
+            break;
+        case cv::EVENT_MOUSEMOVE:
+            if (drag.dragging) drag.current = {x, y};
+            break;
+        case cv::EVENT_LBUTTONUP:
+            if (!drag.dragging) break;
+            drag.dragging = false;
+            drag.result   = cv::Rect(drag.start, cv::Point(x, y));
+            // Ignore clicks — a tiny ROI is never intended
+            if (drag.result.width >= 16 && drag.result.height >= 16) drag.changed = true;
+            break;
+        case cv::EVENT_RBUTTONDOWN:
+            drag.result  = cv::Rect();
+            drag.changed = true;
+            break;
+        default: break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Processing thread
+// -----------------------------------------------------------------------------
+/** Main-thread settings the processing thread applies from its next frame. */
+struct ControlSnapshot {
+    PipelineParams params;
+    PipelineViews  views;                    ///< Debug windows that are open
+    bool           showCrop         = false; ///< Crop windows open (keep CNN crops)
+    bool           embeddingMode    = false;
+    bool           autoLearnPending = false; ///< Prompt open in the GUI
+    int            autoLearnSeen    = 0;     ///< Last prompt the GUI picked up
+};
+
+/** Copy a debug view into a snapshot slot only while its window is open. */
+static void publishView(const cv::Mat& src, cv::Mat& dst, bool open)
+{
+    if (open) src.copyTo(dst);
+    else      dst.release();
+}
+
+/**
+ * @brief Copy one frame's results into a snapshot slot.
+ *
+ *        Capture and the pipeline refill the same frame buffers each frame,
+ *        so frames are deep-copied into the slot's own buffers (no
+ *        allocation once sizes settle).  Debug masks are copied only for
+ *        open windows.  Crops and embeddings are allocated afresh by the
+ *        classifiers and are shared.
+ */
+static void publishSnapshot(const AppState& work, AppState& out,
+                            const PipelineViews& views)
+{
+    work.frameOriginal.copyTo(out.frameOriginal);
+    publishView(work.frameThresholded, out.frameThresholded, views.thresholded);
+    publishView(work.frameCleaned,     out.frameCleaned,     views.cleaned);
+    publishView(work.frameRegions,     out.frameRegions,     views.regions);
+    out.regions         = work.regions;
+    out.croppedROIs     = work.croppedROIs;
+    out.lastCroppedROI  = work.lastCroppedROI;
+    out.fps             = work.fps;
+    out.embedQueueDepth = work.embedQueueDepth;
+    out.embedLatencyMs  = work.embedLatencyMs;
+    out.framesDecoded   = work.framesDecoded;
+    out.framesDropped   = work.framesDropped;
+    out.decodeFps       = work.decodeFps;
+    out.hwDecode        = work.hwDecode;
+    out.motionSkipRatio = work.motionSkipRatio;
+    out.prototypeCount  = work.prototypeCount;
+    out.cnnInvocationRate = work.cnnInvocationRate;
+    out.regionAllocs    = work.regionAllocs;
+    out.autoLearnSeq    = work.autoLearnSeq;
+    out.autoLearnRegion = work.autoLearnRegion;
+}
+
+/**
+ * @brief Take the processing results of a snapshot into the main thread's
+ *        state, leaving its own fields (mode, training, toggles) alone.
+ *
+ *        Frames are shared with the snapshot slot and stay valid until the
+ *        next TripleBuffer::update(), which is always followed by this call.
+ */
+static void adoptSnapshot(AppState& ui, const AppState& snap, int& autoLearnSeen)
+{
+    ui.frameOriginal    = snap.frameOriginal;
+    ui.frameThresholded = snap.frameThresholded;
+    ui.frameCleaned     = snap.frameCleaned;
+    ui.frameRegions     = snap.frameRegions;
+    ui.regions          = snap.regions;
+    ui.croppedROIs      = snap.croppedROIs;
+    ui.lastCroppedROI   = snap.lastCroppedROI;
+    ui.fps              = snap.fps;
+    ui.embedQueueDepth  = snap.embedQueueDepth;
+    ui.embedLatencyMs   = snap.embedLatencyMs;
+    ui.framesDecoded    = snap.framesDecoded;
+    ui.framesDropped    = snap.framesDropped;
+    ui.decodeFps        = snap.decodeFps;
+    ui.hwDecode         = snap.hwDecode;
+    ui.motionSkipRatio  = snap.motionSkipRatio;
+    ui.prototypeCount   = snap.prototypeCount;
+    ui.cnnInvocationRate = snap.cnnInvocationRate;
+    ui.regionAllocs     = snap.regionAllocs;
+
+    if (snap.autoLearnSeq != autoLearnSeen) {
+        autoLearnSeen       = snap.autoLearnSeq;
+        ui.autoLearnPending = true;
+        ui.autoLearnRegion  = snap.autoLearnRegion;
+    }
+}
+
+/**
+ * @brief Settings that change the output of Tasks 1-4 (and the debug views
+ *        they fill); a change forces the motion gate to reprocess.
+ */
+static std::vector<int> segmentationKey(const PipelineParams& p, const PipelineViews& v)
+{
+    return {p.thresholdValue, p.blurKernelSize, p.blurMode, p.downscaleLevel, p.useOpenCL,
+            p.processRoi.x, p.processRoi.y, p.processRoi.width, p.processRoi.height,
+            p.useAdaptive, p.useKMeans, p.dynamicThresh, p.useSatIntensity,
+            p.morphKernelSize, p.morphIterations, p.morphMode, p.labelMode,
+            p.streamPipeline, p.minRegionArea, p.maxRegions, p.momentMode,
+            v.thresholded, v.cleaned, v.regions};
+}
+
+/**
+ * @brief Processing thread body: next decoded frame, Tasks 1-4, tracking,
+ *        classification and auto-learn, one published snapshot per frame.
+ *        With the motion gate on, unchanged frames skip Tasks 1-4, tracking
+ *        and classification and carry the previous regions forward.
+ *
+ * @param source         Decode thread feeding frames (unused when image is set).
+ * @param image          Still image to process repeatedly, or empty.
+ * @param controls       Settings published by the main thread.
+ * @param snapshots      Results published to the main thread.
+ * @param modelMutex     Held while reading the databases and classifiers.
+ * @param db             Shape feature object database.
+ * @param classifier     Shape feature classifier.
+ * @param embDB          Embedding database.
+ * @param embClassifier  CNN embedding classifier.
+ * @param shm            Shared-memory publisher (idle unless named).
+ * @param recorder       Session recorder (idle unless started).
+ * @param replay         Recorded session whose settings override controls,
+ *                       or nullptr; the loop ends after its last frame.
+ * @param realtime       Pace a replay at the recorded frame times.
+ * @param published      Called after each snapshot (wakes an idle GUI), or empty.
+ * @param running        Cleared by either thread to stop both.
+ */
+static void processingLoop(FrameSource& source, const cv::Mat& image,
+                           TripleBuffer<ControlSnapshot>& controls,
+                           TripleBuffer<AppState>& snapshots,
+                           std::mutex& modelMutex,
+                           ObjectDB& db, Classifier& classifier,
+                           EmbeddingDB& embDB,
+                           EmbeddingClassifier& embClassifier,
+                           SharedPublisher& shm,
+                           SessionRecorder& recorder,
+                           const SessionReplay* replay, bool realtime,
+                           const std::function<void()>& published,
+                           std::atomic<bool>& running)
+{
+    AppState        work;
+    ControlSnapshot ctl;
+    AsyncEmbedder   asyncEmbedder(embClassifier);
+
+    // The displayed frame's loops go ahead of background tasks
+    TaskScheduler::setThreadPriority(TaskPriority::High);
+
+    // Live CNN matching against per-label prototypes, condensed in the background
+    PrototypeCondenser condenser;
+
+    // Region tracking: persistent ids, per-track labels and unknownFrames
+    RegionTracker tracker;
+    std::tuple<bool, int, int, int, float, int, bool, int, int, int,
+               bool, float, float> lastClassifierKey;
+
+    // CNN cascade: decayed counts of classified regions and of those sent to the CNN
+    float cascadeClassified = 0.f;
+    float cascadeDeferred   = 0.f;
+    MotionGate       motionGate;
+    std::vector<int> lastSegmentationKey;
+    auto tPrev = std::chrono::steady_clock::now();
+    const auto tStart = tPrev;
+    long long frameNo = 0;
+
+    // Stage timings arrive through the Profiler; these cover the loop itself
+    cvcore::MetricsRegistry& metrics = cvcore::MetricsRegistry::global();
+    cvcore::Histogram& frameMetric = metrics.histogram(
+        "objrec_frame_seconds", "Processing loop time per frame");
+    cvcore::Counter& framesMetric  = metrics.counter("objrec_frames_total", "Frames processed");
+    cvcore::Counter& droppedMetric = metrics.counter(
+        "objrec_dropped_frames_total", "Frames dropped by the decode ring");
+    cvcore::Gauge& embedQueueMetric = metrics.gauge(
+        "objrec_embed_queue_depth", "Crops waiting for the async embedder");
+
+    while (running) {
+        if (controls.update()) ctl = controls.read();
+
+        // Replay: the recorded settings for this frame, not the GUI's
+        if (replay) {
+            if (frameNo >= replay->frameCount()) break;
+            const SessionChange& s = replay->settingsAt(frameNo);
+            ctl.params            = s.params;
+            ctl.params.dropFrames = false;
+            ctl.embeddingMode     = s.cnn;
+            if (realtime)
+                std::this_thread::sleep_until(
+                    tStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double, std::milli>(
+                                     replay->timeMs(frameNo))));
+        }
+        const PipelineParams& params = ctl.params;
+        work.embeddingMode_ = ctl.embeddingMode;
+
+        if (image.empty()) {
+            source.setDropFrames(params.dropFrames);
+            if (!source.next(work.frameOriginal)) break;
+
+            const FrameSource::Stats cs = source.stats();
+            work.framesDecoded = cs.decoded;
+            work.framesDropped = cs.dropped;
+            droppedMetric.inc(cs.dropped - droppedMetric.value());
+            work.decodeFps     = cs.decodeFps;
+            work.hwDecode      = cs.hwDecode;
+        } else {
+            work.frameOriginal = image;
+        }
+        if (recorder.recording())
+            recorder.record(work.frameOriginal, params, ctl.embeddingMode);
+
+        const cv::Rect roi = params.processRoi &
+                             cv::Rect(0, 0, work.frameOriginal.cols, work.frameOriginal.rows);
+        const bool useRoi  = roi.area() > 0 && roi.size() != work.frameOriginal.size();
+
+        // Motion gate: reprocess on change, on settings changes and while
+        // async embeddings are still to be applied to the regions
+        std::vector<int> segKey = segmentationKey(params, ctl.views);
+        const bool segChanged   = segKey != lastSegmentationKey;
+        if (segChanged) lastSegmentationKey.swap(segKey);
+        const bool process = motionGate.update(work.frameOriginal, useRoi ? roi : cv::Rect(),
+                                               params,
+                                               segChanged || asyncEmbedder.queueDepth() > 0);
+        work.motionSkipRatio = motionGate.skipRatio();
+
+        // A ROI runs every stage on a sub-Mat view of the frame (no copy)
+        if (process) {
+            work.regionAllocs = 0;
+            runSegmentation(useRoi ? work.frameOriginal(roi) : work.frameOriginal,
+                            work, params, ctl.views);
+            if (useRoi) translateRegionGeometry(work.regions, roi.tl());
+        }
+
+        // Apply a DNN backend change from the GUI; crops only for open windows
+        if (params.dnnBackend != embClassifier.backend())
+            embClassifier.setBackend(params.dnnBackend);
+        embClassifier.setKeepCrops(ctl.showCrop);
+
+        {
+            std::lock_guard<std::mutex> lock(modelMutex);
+
+            // Build or load the HNSW graph when switched on
+            if (embDB.indexed() != params.embeddingIndex)
+                embDB.setIndexed(params.embeddingIndex);
+
+            // New samples are re-condensed on the worker; the full DB serves until then
+            condenser.update(embDB, params.prototypesPerLabel);
+            const EmbeddingDB& liveDB = condenser.live(embDB);
+            work.prototypeCount = &liveDB == &embDB ? 0 : liveDB.size();
+
+            // Reclassify every track when the classifier or its DB changes
+            auto classifierKey = std::make_tuple(work.embeddingMode_, db.size(), embDB.size(),
+                                                 params.kNeighbors, params.confidenceThresh,
+                                                 params.distanceMetric, params.nearestCentroid,
+                                                 embClassifier.modelGeneration(),
+                                                 classifier.generation(), condenser.version(),
+                                                 params.cnnCascade, params.cascadeConfidence,
+                                                 params.cascadeMargin);
+            const bool classifierChanged = classifierKey != lastClassifierKey;
+            if (classifierChanged) {
+                tracker.invalidate();
+                lastClassifierKey = classifierKey;
+            }
+
+            // Skipped frames keep their regions' labels unless the classifier changed
+            if (process || classifierChanged) {
+                // Associate regions with tracks; stable ones skip classification
+                {
+                    AllocScope allocs(work.regionAllocs);
+                    tracker.update(work.regions, params);
+                }
+
+                // CNN cascade: sure shape answers skip the network
+                const bool cascade = work.embeddingMode_ && params.cnnCascade &&
+                                     embClassifier.isReady() && !embDB.empty();
+                if (cascade) {
+                    const Classifier::CascadeCounts counts = classifier.cascadeAll(work, params);
+                    constexpr float kDecay = 0.95f;
+                    cascadeClassified = kDecay * cascadeClassified + counts.classified;
+                    cascadeDeferred   = kDecay * cascadeDeferred   + counts.deferred;
+                    if (cascadeClassified > 0.f)
+                        work.cnnInvocationRate = cascadeDeferred / cascadeClassified;
+                }
+
+                // Classify
+                if (!work.embeddingMode_)
+                    classifier.classifyAll(work, params);
+                else if (embClassifier.isReady() && !embDB.empty() && params.asyncEmbedding)
+                    asyncEmbedder.classifyAll(work.frameOriginal, work, liveDB,
+                                              EmbeddingClassifier::threshold(params),
+                                              params.distanceMetric);
+                else if (embClassifier.isReady() && !embDB.empty())
+                    embClassifier.classifyAll(work.frameOriginal, work, liveDB,
+                                              EmbeddingClassifier::threshold(params),
+                                              params.distanceMetric);
+            }
+        }
+        work.embedQueueDepth = asyncEmbedder.queueDepth();
+        embedQueueMetric.set(work.embedQueueDepth);
+        work.embedLatencyMs  = asyncEmbedder.latencyMs();
+
+        // Extension C: auto-prompt for unknown objects — not while a prompt
+        // is open or the last one raised has yet to reach the GUI
+        if (!ctl.autoLearnPending && ctl.autoLearnSeen == work.autoLearnSeq) {
+            for (auto& reg : work.regions) {
+                if (reg.label == "unknown") {
+                    reg.unknownFrames++;
+                    std::cout << "\r[AutoLearn] " << reg.unknownFrames
+                              << "/" << kUnknownFrameThresh << "   " << std::flush;
+                    if (reg.unknownFrames >= kUnknownFrameThresh &&
+                        reg.hasShape) {  // only trigger on valid region
+                        work.autoLearnSeq++;
+                        work.autoLearnRegion = reg; // copy not pointer
+                        reg.unknownFrames    = 0;
+                        std::cout << "\n[AutoLearn] Pending!\n";
+                        break;
+                    }
+                } else {
+                    reg.unknownFrames = 0;
+                }
+            }
+        }
+
+        // Save labels and unknownFrames for the next frame
+        tracker.store(work.regions);
+
+        // FPS of the processing loop
+        auto  tNow = std::chrono::steady_clock::now();
+        float dt   = std::chrono::duration<float>(tNow - tPrev).count();
+        work.fps   = dt > 0.f ? 1.f / dt : 0.f;
+        tPrev      = tNow;
+        frameMetric.observeMs(dt * 1000.0);
+        framesMetric.inc();
+
+        publishSnapshot(work, snapshots.writeBuffer(), ctl.views);
+        snapshots.publish();
+        if (published) published();
+        if (shm.enabled()) shm.publish(work.frameOriginal, work.regions, frameNo);
+        frameNo++;
+
+        // A still image has no capture to pace the loop
+        if (!image.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    running = false;
+}
+
 // -----------------------------------------------------------------------------
 // Keyboard handler
 // -----------------------------------------------------------------------------
@@ -186,6 +624,7 @@ static void captureTrainingSample(AppState& state, ObjectDB& db,
  * @param evaluator      Evaluator — records evaluation samples.
  * @param embDB          Embedding database — capture appended here.
  * @param embClassifier  CNN embedding classifier — used for embedding capture.
+ * @param modelMutex     Held while a capture edits the databases.
  * @param showThresh     Toggle for the Threshold debug window.
  * @param showCleaned    Toggle for the Cleaned debug window.
  * @param showRegions    Toggle for the Regions debug window.
@@ -198,6 +637,7 @@ static bool handleKeyboard(int key, PipelineParams& params, AppState& state,
                             Evaluator& evaluator,
                             EmbeddingDB& embDB,
                             EmbeddingClassifier& embClassifier,
+                            std::mutex& modelMutex,
                             bool& showThresh, bool& showCleaned,
                             bool& showRegions, bool& showMatrix,
                             bool& showCrop)
@@ -224,6 +664,9 @@ static bool handleKeyboard(int key, PipelineParams& params, AppState& state,
         case 'i': params.morphIterations = std::max(1,  params.morphIterations - 1); break;
         case 'I': params.morphIterations = std::min(10, params.morphIterations + 1); break;
         case 'o': params.morphMode = (params.morphMode + 1) % 4; break;
+        case 'l': params.labelMode = (params.labelMode + 1) % 3; break;
+        case 'f': params.streamPipeline = !params.streamPipeline; break;
+        case 'g': params.motionGate = !params.motionGate; break;
         case 'r': params.minRegionArea = std::max(100,   params.minRegionArea - 100); break;
         case 'R': params.minRegionArea = std::min(50000, params.minRegionArea + 100); break;
         case 'n': {
@@ -238,9 +681,11 @@ static bool handleKeyboard(int key, PipelineParams& params, AppState& state,
             }
             break;
         }
-        case 'c':
+        case 'c': {
+            std::lock_guard<std::mutex> lock(modelMutex);
             captureTrainingSample(state, db, classifier);
             break;
+        }
         case 'C': {
             if (state.regions.empty()) {
                 std::cout << "\n[EmbTrain] No region.\n"; break;
@@ -249,12 +694,13 @@ static bool handleKeyboard(int key, PipelineParams& params, AppState& state,
                 std::cout << "\n[EmbTrain] Set label first.\n"; break;
             }
             if (!embClassifier.isReady()) {
-                std::cout << "\n[EmbTrain] Model not loaded.\n"; break;
+                std::cout << "\n[EmbTrain] Model not loaded yet.\n"; break;
             }
             std::vector<float> emb;
             if (embClassifier.computeEmbedding(
                     const_cast<cv::Mat&>(state.frameOriginal),
                     state.regions[0], emb)) {
+                std::lock_guard<std::mutex> lock(modelMutex);
                 embDB.append({state.currentTrainLabel, emb});
                 std::cout << "\n[EmbTrain] Captured for '"
                           << state.currentTrainLabel << "'\n";
@@ -295,6 +741,9 @@ static bool handleKeyboard(int key, PipelineParams& params, AppState& state,
             evaluator.printMatrix();
             evaluator.saveMatrix();
             break;
+        case 'w':
+            Profiler::instance().exportChromeTrace("data/trace.json");
+            break;
         case '1': showThresh  = !showThresh;  break;
         case '2': showCleaned = !showCleaned; break;
         case '3': showRegions = !showRegions; break;
@@ -312,6 +761,46 @@ static bool handleKeyboard(int key, PipelineParams& params, AppState& state,
     return true;
 }
 
+/**
+ * @brief Print the per-stage timings of a replayed session and write them
+ *        to <dir>/replay_timings.csv.
+ *
+ * @param dir     Session folder.
+ * @param frames  Frames replayed.
+ * @param start   When processing started.
+ */
+static void reportReplay(const std::string& dir, long long frames,
+                         std::chrono::steady_clock::time_point start)
+{
+    const double wallMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    const std::string csvPath = (std::filesystem::path(dir) / "replay_timings.csv").string();
+    std::ofstream csv(csvPath);
+    csv << "stage,calls,total_ms,mean_ms,max_ms\n";
+
+    std::cout << "\n[Replay] " << frames << " frames in " << std::fixed
+              << std::setprecision(1) << wallMs << " ms ("
+              << (wallMs > 0.0 ? frames * 1000.0 / wallMs : 0.0) << " fps)\n";
+    std::cout << std::left << std::setw(16) << "stage" << std::right
+              << std::setw(8) << "calls" << std::setw(12) << "total ms"
+              << std::setw(10) << "mean ms" << std::setw(10) << "max ms" << "\n";
+    for (int i = 0; i < static_cast<int>(ProfileStage::Count); i++) {
+        const ProfileStage           stage = static_cast<ProfileStage>(i);
+        const Profiler::StageTotals  t     = Profiler::instance().totals(stage);
+        if (t.calls == 0) continue;
+        const double mean = t.totalMs / t.calls;
+        std::cout << std::left << std::setw(16) << Profiler::stageName(stage) << std::right
+                  << std::setw(8) << t.calls << std::setw(12) << t.totalMs
+                  << std::setprecision(2) << std::setw(10) << mean
+                  << std::setw(10) << t.maxMs << std::setprecision(1) << "\n";
+        csv << Profiler::stageName(stage) << "," << t.calls << "," << t.totalMs
+            << "," << mean << "," << t.maxMs << "\n";
+    }
+    std::cout << std::defaultfloat;
+    if (csv) std::cout << "[Replay] Timings written to " << csvPath << "\n";
+    else     std::cerr << "[Replay] Cannot write " << csvPath << "\n";
+}
+
 // -----------------------------------------------------------------------------
 // Main
 // -----------------------------------------------------------------------------
@@ -321,11 +810,27 @@ int main(int argc, char* argv[])
     std::string inputStr = getArg(argc, argv, "--input");
     std::string camStr   = getArg(argc, argv, "--camera");
     std::string dbPath   = getArg(argc, argv, "--db");
+    std::string shmName  = getArg(argc, argv, "--shm");
+    std::string recordDir = getArg(argc, argv, "--record");
+    std::string replayDir = getArg(argc, argv, "--replay");
+    const bool  realtime  = getArg(argc, argv, "--replay-speed") == "realtime";
     if (modeStr.empty()) modeStr = "live";
-    if (dbPath.empty())  dbPath  = "data/db/objects.csv";
+    if (dbPath.empty())  dbPath  = "data/db/objects.bin";
 
     AppState       state;
     PipelineParams params;
+    loadConfig(kConfigPath, params);
+
+    // Frame-sized Mats come from a huge-page pool instead of fresh mappings
+    cvcore::installMatPool();
+
+    // One worker pool for every stage, OpenCV's own loops included
+    TaskScheduler::instance().start();
+    if (!TaskScheduler::instance().useForOpenCV())
+        std::cout << "[Tasks] OpenCV keeps its own thread pool\n";
+
+    // Prometheus / StatsD export when CVCORE_METRICS_PORT / CVCORE_STATSD is set
+    cvcore::startMetricsFromEnvironment("objectRecognition");
 
     if      (modeStr == "train") state.mode = AppState::Mode::Train;
     else if (modeStr == "eval")  state.mode = AppState::Mode::Eval;
@@ -344,29 +849,36 @@ int main(int argc, char* argv[])
 
     Classifier          classifier(db, params);
     Evaluator           evaluator;
-    EmbeddingDB         embDB("data/db/embeddings.csv");
-    EmbeddingClassifier embClassifier;
-    embClassifier.loadModel("data/models/resnet18-v2-7.onnx");
+    EmbeddingDB         embDB("data/db/embeddings.bin");
+    EmbeddingClassifier embClassifier;   // model loaded in the background below
 
-    // Capture source
-    cv::VideoCapture cap;
-    bool imageMode = false;
+    // Capture source — decoded on its own thread
+    FrameSource   source;
+    cv::Mat       image;
+    SessionReplay replay;
 
-    if (modeStr == "image" && !inputStr.empty()) {
-        state.frameOriginal = cv::imread(inputStr);
-        if (state.frameOriginal.empty()) {
+    if (!replayDir.empty()) {
+        if (!replay.open(replayDir) || !source.open(replay.frameSpec(), 0, false)) {
+            std::cerr << "Error: cannot replay session: " << replayDir << "\n";
+            return 1;
+        }
+        state.sourceName = "replay " + replayDir;
+        std::cout << "[Replay] " << replay.frameCount() << " frames, "
+                  << (realtime ? "real time" : "as fast as possible") << "\n";
+    } else if (modeStr == "image" && !inputStr.empty()) {
+        image = cv::imread(inputStr);
+        if (image.empty()) {
             std::cerr << "Error: cannot open image: " << inputStr << "\n";
             return 1;
         }
-        imageMode = true;
     } else {
         int camIdx = camStr.empty() ? 0 : std::stoi(camStr);
-        if (!inputStr.empty()) cap.open(inputStr);
-        else                   cap.open(camIdx);
-        if (!cap.isOpened()) {
+        if (!source.open(inputStr, camIdx, params.dropFrames)) {
             std::cerr << "Error: cannot open capture source.\n";
             return 1;
         }
+        state.sourceName = source.description();
+        std::cout << "[Capture] " << state.sourceName << "\n";
     }
 
     // GUI
@@ -394,140 +906,154 @@ int main(int argc, char* argv[])
         cropWins.push_back("Crop[" + std::to_string(i) + "]");
     bool prevShowCrop = false;
 
+    // Embedding plot — incremental PCA, synced with embDB on the GUI thread
+    EmbeddingPlot embPlot(500);
+
     // Window toggle previous states
     bool prevThresh  = true;
     bool prevCleaned = true;
     bool prevShowRegions = true;
 
     cv::namedWindow(winMain, cv::WINDOW_AUTOSIZE);
+    RoiDrag roiDrag;
+    cv::setMouseCallback(winMain, onMainMouse, &roiDrag);
+    cv::Rect savedRoi = params.processRoi;
 
     printParams(params);
-    auto tPrev = std::chrono::steady_clock::now();
 
-    // Region persistence for unknownFrames
-    std::vector<RegionInfo> lastRegions;
+    // Thread handoff: snapshots in, settings out.  The databases and
+    // classifiers are only edited on user action, under modelMutex.
+    TripleBuffer<AppState>        snapshots;
+    TripleBuffer<ControlSnapshot> controls;
+    std::mutex                    modelMutex;
+    std::atomic<bool>             running{true};
+    int                           autoLearnSeen = 0;
+
+    // Frames and regions for other processes, written by the processing thread
+    SharedPublisher shm;
+    if (!shmName.empty()) shm.setName(shmName);
+
+    // Input and settings changes to a session folder, for later replay
+    SessionRecorder recorder;
+    if (!recordDir.empty() && replayDir.empty() && !recorder.start(recordDir))
+        return 1;
+
+    // Embedding models swapped in from the GUI, loaded in the background
+    ModelManager models(embClassifier, embDB, modelMutex);
+    models.scan();
+
+    // The default model loads while the live feed already runs; CNN mode
+    // shows "(loading)" and labels nothing until it is swapped in
+    models.swapTo("data/models/resnet18-v2-7.onnx", params.dnnBackend);
+
+    auto publishControls = [&]() {
+        ControlSnapshot& c   = controls.writeBuffer();
+        c.params             = params;
+        c.views.thresholded  = showThresh;
+        c.views.cleaned      = showCleaned;
+        c.views.regions      = showRegions;
+        c.showCrop           = showCrop;
+        c.embeddingMode      = state.embeddingMode_;
+        c.autoLearnPending   = state.autoLearnPending;
+        c.autoLearnSeen      = autoLearnSeen;
+        controls.publish();
+    };
+    publishControls();
+
+    // New results end the main loop's idle wait in the GUI
+    const std::function<void()> wakeGui = guiEnabled ? std::function<void()>(&GUI::wake)
+                                                     : std::function<void()>();
+
+    const auto  replayStart = std::chrono::steady_clock::now();
+    std::thread processing(processingLoop, std::ref(source), std::cref(image),
+                           std::ref(controls), std::ref(snapshots),
+                           std::ref(modelMutex), std::ref(db), std::ref(classifier),
+                           std::ref(embDB), std::ref(embClassifier),
+                           std::ref(shm), std::ref(recorder),
+                           replayDir.empty() ? nullptr : &replay, realtime,
+                           std::cref(wakeGui), std::ref(running));
+
+    // Set by keys and ROI drags so the GUI shows their settings
+    bool settingsChanged = true;
 
     // =========================================================================
-    // MAIN LOOP
+    // MAIN LOOP — display and controls; processing runs on its own thread
     // =========================================================================
-    while (state.running) {
+    while (running) {
 
-        if (!imageMode) {
-            cap >> state.frameOriginal;
-            if (state.frameOriginal.empty()) break;
-        }
+        // Newest processed frame, if one arrived since the last iteration
+        const bool freshFrame = snapshots.update();
+        if (freshFrame)
+            adoptSnapshot(state, snapshots.read(), autoLearnSeen);
 
-        // Pipeline
-        applyThreshold(state.frameOriginal,     state.frameThresholded, params);
-        applyMorphology(state.frameThresholded, state.frameCleaned,     params);
-
-        cv::Mat labelMap;
-        findRegions(state.frameCleaned, state, params, labelMap);
-        computeAllFeatures(labelMap, state);
-
-        // Persist unknownFrames across frames by centroid matching
-        for (auto& reg : state.regions) {
-            for (const auto& last : lastRegions) {
-                float dx = reg.centroid.x - last.centroid.x;
-                float dy = reg.centroid.y - last.centroid.y;
-                if (std::sqrt(dx*dx + dy*dy) < 150.f) { // wider tolerance
-                    reg.unknownFrames = last.unknownFrames;
-                    break;
-                }
-            }
+        // Processing ROI — from a mouse drag or the GUI, persisted on change
+        if (roiDrag.changed) {
+            roiDrag.changed   = false;
+            params.processRoi = roiDrag.result;
+            settingsChanged   = true;
         }
-
-        // Classify
-        if (!state.embeddingMode_)
-            classifier.classifyAll(state, params);
-        else if (embClassifier.isReady() && !embDB.empty())
-            embClassifier.classifyAll(state.frameOriginal, state, embDB,
-                                      params.confidenceThresh * 10000.f);
-
-        // Extension C: auto-prompt for unknown objects
-        if (!state.autoLearnPending) {
-            for (auto& reg : state.regions) {
-                if (reg.label == "unknown") {
-                    reg.unknownFrames++;
-                    std::cout << "\r[AutoLearn] " << reg.unknownFrames
-                              << "/" << kUnknownFrameThresh << "   " << std::flush;
-                    if (reg.unknownFrames >= kUnknownFrameThresh &&
-                        !reg.huMoments.empty()) {  // only trigger on valid region
-                        state.autoLearnPending = true;
-                        state.autoLearnRegion  = reg; // copy not pointer
-                        reg.unknownFrames      = 0;
-                        std::cout << "\n[AutoLearn] Pending!\n";
-                        break;
-                    }
-                } else {
-                    reg.unknownFrames = 0;
-                }
-            }
+        if (params.processRoi != savedRoi) {
+            savedRoi = params.processRoi;
+            saveConfig(kConfigPath, params);
         }
 
-        // Save regions for next frame
-        lastRegions = state.regions;
+        if (!state.frameOriginal.empty()) {
+            const cv::Rect roi = params.processRoi &
+                                 cv::Rect(0, 0, state.frameOriginal.cols, state.frameOriginal.rows);
+            const bool useRoi  = roi.area() > 0 && roi.size() != state.frameOriginal.size();
 
-        // Handle embedding capture request from GUI
-        if (state.captureRequested) {
-            state.captureRequested = false;
-            if (!state.regions.empty() && !state.currentTrainLabel.empty()
-                && embClassifier.isReady()) {
-                std::vector<float> emb;
-                if (embClassifier.computeEmbedding(
-                        const_cast<cv::Mat&>(state.frameOriginal),
-                        state.regions[0], emb)) {
-                    embDB.append({state.currentTrainLabel, emb});
-                    std::cout << "\n[EmbTrain] Captured for '"
-                              << state.currentTrainLabel << "'\n";
+            // Display
+            state.frameDisplay = state.frameOriginal.clone();
+            if (useRoi)
+                cv::rectangle(state.frameDisplay, roi, {255, 200, 0}, 1);
+            if (roiDrag.dragging)
+                cv::rectangle(state.frameDisplay, cv::Rect(roiDrag.start, roiDrag.current),
+                              {0, 255, 255}, 1);
+            drawFeatures(state.frameDisplay, state, params);
+
+            // Auto-learn progress bar
+            for (const auto& reg : state.regions) {
+                if (reg.label == "unknown" && reg.unknownFrames > 0) {
+                    float pct  = static_cast<float>(reg.unknownFrames) / kUnknownFrameThresh;
+                    int   barW = static_cast<int>(pct * 200);
+                    cv::rectangle(state.frameDisplay,
+                                  {10, state.frameDisplay.rows-35},
+                                  {210, state.frameDisplay.rows-25},
+                                  {60,60,60}, -1);
+                    cv::rectangle(state.frameDisplay,
+                                  {10, state.frameDisplay.rows-35},
+                                  {10+barW, state.frameDisplay.rows-25},
+                                  {0,140,255}, -1);
+                    cv::putText(state.frameDisplay, "Unknown...",
+                                {10, state.frameDisplay.rows-38},
+                                cv::FONT_HERSHEY_SIMPLEX, 0.4, {0,140,255}, 1);
+                    break;
                 }
             }
-        }
 
-        // Display
-        state.frameDisplay = state.frameOriginal.clone();
-        drawFeatures(state.frameDisplay, state, params);
-
-        // Auto-learn progress bar
-        for (const auto& reg : state.regions) {
-            if (reg.label == "unknown" && reg.unknownFrames > 0) {
-                float pct  = static_cast<float>(reg.unknownFrames) / kUnknownFrameThresh;
-                int   barW = static_cast<int>(pct * 200);
-                cv::rectangle(state.frameDisplay,
-                              {10, state.frameDisplay.rows-35},
-                              {210, state.frameDisplay.rows-25},
-                              {60,60,60}, -1);
-                cv::rectangle(state.frameDisplay,
-                              {10, state.frameDisplay.rows-35},
-                              {10+barW, state.frameDisplay.rows-25},
-                              {0,140,255}, -1);
-                cv::putText(state.frameDisplay, "Unknown...",
-                            {10, state.frameDisplay.rows-38},
-                            cv::FONT_HERSHEY_SIMPLEX, 0.4, {0,140,255}, 1);
-                break;
-            }
+            state.modelLoading = models.busy() && !embClassifier.isReady();
+            if (state.showOverlay)
+                overlayParams(state.frameDisplay, params, state);
+            cv::imshow(winMain, state.frameDisplay);
         }
 
-        if (state.showOverlay)
-            overlayParams(state.frameDisplay, params, state);
-        cv::imshow(winMain, state.frameDisplay);
-
-        // Secondary windows
+        // Secondary windows — masks go to HighGUI single-channel, and are
+        // only redrawn when a new frame arrived or the window just opened
         if (showThresh && !state.frameThresholded.empty()) {
             if (!prevThresh) cv::namedWindow(winThresh, cv::WINDOW_AUTOSIZE);
-            cv::imshow(winThresh, state.frameThresholded);
+            if (freshFrame || !prevThresh) cv::imshow(winThresh, state.frameThresholded);
         } else if (!showThresh && prevThresh)
             try { cv::destroyWindow(winThresh); } catch (...) {}
 
         if (showCleaned && !state.frameCleaned.empty()) {
             if (!prevCleaned) cv::namedWindow(winCleaned, cv::WINDOW_AUTOSIZE);
-            cv::imshow(winCleaned, state.frameCleaned);
+            if (freshFrame || !prevCleaned) cv::imshow(winCleaned, state.frameCleaned);
         } else if (!showCleaned && prevCleaned)
             try { cv::destroyWindow(winCleaned); } catch (...) {}
 
         if (showRegions && !state.frameRegions.empty()) {
             if (!prevShowRegions) cv::namedWindow(winRegions, cv::WINDOW_AUTOSIZE);
-            cv::imshow(winRegions, state.frameRegions);
+            if (freshFrame || !prevShowRegions) cv::imshow(winRegions, state.frameRegions);
         } else if (!showRegions && prevShowRegions)
             try { cv::destroyWindow(winRegions); } catch (...) {}
 
@@ -574,7 +1100,8 @@ int main(int argc, char* argv[])
         // Extension A: embedding scatter plot
         if (state.showPlot) {
             cv::Mat plotImg;
-            renderEmbeddingPlot(embDB, 500, plotImg);
+            embPlot.sync(embDB);
+            embPlot.render(state.regions, plotImg);
             if (cv::getWindowProperty(winPlot, cv::WND_PROP_VISIBLE) < 1)
                 cv::namedWindow(winPlot, cv::WINDOW_AUTOSIZE);
             cv::imshow(winPlot, plotImg);
@@ -582,30 +1109,71 @@ int main(int argc, char* argv[])
             try { cv::destroyWindow(winPlot); } catch (...) {}
         }
 
-        // GUI
+        // GUI — rebuilt only for new results, input or a settings change;
+        // panels may edit the databases, drawing waits outside the lock
         if (guiEnabled) {
             gui.pollEvents();
-            gui.render(params, state, db, classifier, evaluator, embDB,
-                       showThresh, showCleaned, showRegions, showMatrix,
-                       showCrop);
+            if (gui.needsFrame(freshFrame || settingsChanged)) {
+                ProfileScope profile(ProfileStage::GuiRender);
+                {
+                    std::lock_guard<std::mutex> lock(modelMutex);
+                    gui.render(params, state, db, classifier, evaluator, embDB, models,
+                               showThresh, showCleaned, showRegions, showMatrix,
+                               showCrop);
+                }
+                gui.present();
+            } else {
+                gui.repaint();
+            }
             if (!gui.isOpen()) state.running = false;
         }
+        settingsChanged = false;
 
-        // FPS
-        auto  tNow = std::chrono::steady_clock::now();
-        float dt   = std::chrono::duration<float>(tNow - tPrev).count();
-        state.fps  = dt > 0.f ? 1.f / dt : 0.f;
-        tPrev      = tNow;
+        // Handle embedding capture request from GUI
+        if (state.captureRequested) {
+            state.captureRequested = false;
+            if (!state.regions.empty() && !state.currentTrainLabel.empty()
+                && embClassifier.isReady()) {
+                std::vector<float> emb;
+                if (embClassifier.computeEmbedding(
+                        const_cast<cv::Mat&>(state.frameOriginal),
+                        state.regions[0], emb)) {
+                    std::lock_guard<std::mutex> lock(modelMutex);
+                    embDB.append({state.currentTrainLabel, emb});
+                    std::cout << "\n[EmbTrain] Captured for '"
+                              << state.currentTrainLabel << "'\n";
+                }
+            }
+        }
 
-        // Keyboard
-        int key = cv::waitKey(30) & 0xFF;
-        if (key != 255)
+        // Keyboard — with the GUI open the loop idles in GLFW, woken at once
+        // by GUI input or a new snapshot, and HighGUI is then only pumped
+        int key;
+        if (guiEnabled) {
+            gui.waitEvents(0.03);
+            key = cv::waitKey(1) & 0xFF;
+        } else {
+            key = cv::waitKey(30) & 0xFF;
+        }
+        if (key != 255) {
             handleKeyboard(key, params, state, db, classifier, evaluator,
-                           embDB, embClassifier,
+                           embDB, embClassifier, modelMutex,
                            showThresh, showCleaned, showRegions, showMatrix,
                            showCrop);
+            settingsChanged = true;
+        }
+
+        if (!state.running) running = false;
+        publishControls();
     }
 
+    running = false;
+    source.close();     // wakes the processing thread if it waits for a frame
+    processing.join();
+    recorder.stop();
+    if (!replayDir.empty())
+        reportReplay(replayDir, replay.frameCount(), replayStart);
+
     for (const auto& wn : cropWins)
         try { cv::destroyWindow(wn); } catch (...) {}
 
@@ -0,0 +1,330 @@
+/**
+ * @file    objrecEval.cpp
+ * @brief   Offline batch evaluation over a labelled image folder.
+ *
+ *          Usage:
+ *            objrecEval --input <dir> [--classifier shape|cnn|both]
+ *                       [--threads N] [--db data/db/objects.bin]
+ *                       [--embdb data/db/embeddings.bin]
+ *                       [--model data/models/resnet18-v2-7.onnx]
+ *                       [--save <dir>]
+ *
+ *          The folder holds one subfolder per true label:
+ *            <dir>/<label>/<image>.{jpg,png,bmp,tif}
+ *
+ *          Every image runs threshold → morphology → regions → features →
+ *          classify with the default PipelineParams, and the largest region's
+ *          label is recorded against the folder label — the same sample the
+ *          live app's 'e' key records.  An image without a region counts as
+ *          "none".  Images are shared out to worker threads; each worker
+ *          has its own AppState and, for CNN, its own network, so nothing
+ *          is locked per image.  Results are fed to one Evaluator per
+ *          classifier in file order, so the output is deterministic.
+ *
+ *          Prints the confusion matrix and accuracy per classifier plus
+ *          per-image latency (mean / p50 / p95 / max) per stage.  With
+ *          --save, matrices go to <dir>/confusion_shape.csv and
+ *          <dir>/confusion_cnn.csv.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AppState.h"
+#include "ScaledPipeline.h"
+#include "ObjectDB.h"
+#include "Classifier.h"
+#include "Evaluator.h"
+#include "Embedding.h"
+
+namespace fs = std::filesystem;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+/** One labelled input image. */
+struct EvalImage {
+    std::string path;
+    std::string trueLabel;
+};
+
+/** Predictions and stage timings for one image. */
+struct ImageResult {
+    bool        loaded     = false;
+    std::string shapeLabel = "none";
+    float       shapeConf  = 0.f;
+    std::string cnnLabel   = "none";
+    float       cnnConf    = 0.f;
+    double      segMs      = 0.0;   ///< Tasks 1-4
+    double      shapeMs    = 0.0;   ///< Shape feature classification
+    double      cnnMs      = 0.0;   ///< Embedding + nearest neighbour
+};
+
+/** Per-worker pipeline context. */
+struct WorkerContext {
+    EmbeddingClassifier embClassifier;   ///< Own network: no shared forward pass
+};
+
+/** Value of a --key argument, or an empty string. */
+static std::string getArg(int argc, char* argv[], const std::string& key)
+{
+    for (int i = 1; i < argc - 1; i++)
+        if (std::string(argv[i]) == key) return argv[i + 1];
+    return "";
+}
+
+/** True for the image extensions cv::imread is expected to handle. */
+static bool isImageFile(const fs::path& p)
+{
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" ||
+           ext == ".bmp" || ext == ".tif"  || ext == ".tiff";
+}
+
+/** All images under root/<label>/, sorted by path. */
+static std::vector<EvalImage> collectImages(const fs::path& root)
+{
+    std::vector<EvalImage> images;
+    for (const auto& dir : fs::directory_iterator(root)) {
+        if (!dir.is_directory()) continue;
+        const std::string label = dir.path().filename().string();
+        for (const auto& f : fs::recursive_directory_iterator(dir.path()))
+            if (f.is_regular_file() && isImageFile(f.path()))
+                images.push_back({f.path().string(), label});
+    }
+    std::sort(images.begin(), images.end(),
+              [](const EvalImage& a, const EvalImage& b) { return a.path < b.path; });
+    return images;
+}
+
+/** Milliseconds since t0. */
+static double msSince(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+/** Print mean / p50 / p95 / max of one stage's per-image latencies. */
+static void printLatency(const std::string& name, std::vector<double> ms)
+{
+    if (ms.empty()) return;
+    std::sort(ms.begin(), ms.end());
+    auto pct = [&](double p) {
+        size_t i = static_cast<size_t>(p * (ms.size() - 1) + 0.5);
+        return ms[std::min(i, ms.size() - 1)];
+    };
+    double mean = 0.0;
+    for (double v : ms) mean += v;
+    mean /= ms.size();
+
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << mean
+              << std::setw(10) << pct(0.50)
+              << std::setw(10) << pct(0.95)
+              << std::setw(10) << ms.back() << "\n";
+}
+
+// -----------------------------------------------------------------------------
+// Worker
+// -----------------------------------------------------------------------------
+/**
+ * @brief Run the full pipeline on one image.
+ *
+ * @param img         Image path and label.
+ * @param params      Pipeline parameters (read only, shared).
+ * @param classifier  Shape classifier (const, shared), or null to skip.
+ * @param embDB       Embedding DB (shared), or null to skip CNN.
+ * @param ctx         This worker's context.
+ * @param out         Result for the image.
+ */
+static void evaluateImage(const EvalImage& img, const PipelineParams& params,
+                          const Classifier* classifier,
+                          const EmbeddingDB* embDB,
+                          WorkerContext& ctx, ImageResult& out)
+{
+    cv::Mat frame = cv::imread(img.path);
+    if (frame.empty()) return;
+    out.loaded = true;
+
+    AppState state;
+    auto t0 = std::chrono::steady_clock::now();
+    runSegmentation(frame, state, params, PipelineViews{});
+    out.segMs = msSince(t0);
+    if (state.regions.empty()) return;
+
+    if (classifier) {
+        t0 = std::chrono::steady_clock::now();
+        classifier->classifyAll(state, params);
+        out.shapeMs    = msSince(t0);
+        out.shapeLabel = state.regions[0].label;
+        out.shapeConf  = state.regions[0].confidence;
+    }
+
+    if (embDB) {
+        t0 = std::chrono::steady_clock::now();
+        ctx.embClassifier.classifyAll(frame, state, *embDB,
+                                      EmbeddingClassifier::threshold(params),
+                                      params.distanceMetric);
+        out.cnnMs    = msSince(t0);
+        out.cnnLabel = state.regions[0].label;
+        out.cnnConf  = state.regions[0].confidence;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    std::string inputDir  = getArg(argc, argv, "--input");
+    std::string mode      = getArg(argc, argv, "--classifier");
+    std::string threadStr = getArg(argc, argv, "--threads");
+    std::string dbPath    = getArg(argc, argv, "--db");
+    std::string embPath   = getArg(argc, argv, "--embdb");
+    std::string modelPath = getArg(argc, argv, "--model");
+    std::string saveDir   = getArg(argc, argv, "--save");
+    if (mode.empty())      mode      = "both";
+    if (dbPath.empty())    dbPath    = "data/db/objects.bin";
+    if (embPath.empty())   embPath   = "data/db/embeddings.bin";
+    if (modelPath.empty()) modelPath = "data/models/resnet18-v2-7.onnx";
+
+    if (inputDir.empty() || !fs::is_directory(inputDir)) {
+        std::cerr << "Usage: objrecEval --input <dir> [--classifier shape|cnn|both]\n"
+                     "                  [--threads N] [--db <bin>] [--embdb <bin>]\n"
+                     "                  [--model <onnx>] [--save <dir>]\n"
+                     "  <dir> holds one subfolder of images per true label.\n";
+        return 1;
+    }
+
+    const std::vector<EvalImage> images = collectImages(inputDir);
+    if (images.empty()) {
+        std::cerr << "Error: no images under " << inputDir << "/<label>/\n";
+        return 1;
+    }
+
+    PipelineParams params;
+    bool useShape = mode == "shape" || mode == "both";
+    bool useCnn   = mode == "cnn"   || mode == "both";
+
+    ObjectDB    db(dbPath);
+    Classifier  classifier(db, params);
+    EmbeddingDB embDB(embPath);
+    if (useShape && db.size() == 0) {
+        std::cerr << "[Eval] Shape DB " << dbPath << " is empty — skipped.\n";
+        useShape = false;
+    }
+    if (useCnn && embDB.empty()) {
+        std::cerr << "[Eval] Embedding DB " << embPath << " is empty — skipped.\n";
+        useCnn = false;
+    }
+
+    int nThreads = threadStr.empty() ? static_cast<int>(std::thread::hardware_concurrency())
+                                     : std::stoi(threadStr);
+    nThreads = std::clamp(nThreads, 1, static_cast<int>(images.size()));
+
+    // One context per worker; CNN workers each load their own network
+    std::vector<std::unique_ptr<WorkerContext>> contexts;
+    for (int i = 0; i < nThreads; i++) {
+        contexts.push_back(std::make_unique<WorkerContext>());
+        contexts.back()->embClassifier.setKeepCrops(false);
+        if (useCnn && !contexts.back()->embClassifier.loadModel(modelPath, params.dnnBackend)) {
+            std::cerr << "[Eval] Cannot load " << modelPath << " — CNN skipped.\n";
+            useCnn = false;
+        }
+    }
+    if (!useShape && !useCnn) {
+        std::cerr << "Error: no classifier to evaluate.\n";
+        return 1;
+    }
+
+    // Images run in parallel; keep OpenCV's own loops serial per image
+    if (nThreads > 1) cv::setNumThreads(1);
+
+    std::cout << "[Eval] " << images.size() << " images, " << nThreads
+              << " threads, classifier: "
+              << (useShape && useCnn ? "both" : useShape ? "shape" : "cnn") << "\n";
+
+    std::vector<ImageResult> results(images.size());
+    std::atomic<size_t>      next{0};
+    const Classifier*  shapePtr = useShape ? &classifier : nullptr;
+    const EmbeddingDB* embPtr   = useCnn   ? &embDB      : nullptr;
+
+    auto tStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int w = 0; w < nThreads; w++) {
+        workers.emplace_back([&, w]() {
+            for (size_t i = next++; i < images.size(); i = next++)
+                evaluateImage(images[i], params, shapePtr, embPtr,
+                              *contexts[w], results[i]);
+        });
+    }
+    for (auto& t : workers) t.join();
+    const double wallMs = msSince(tStart);
+
+    // Aggregate in file order
+    Evaluator           shapeEval, cnnEval;
+    std::vector<double> segMs, shapeMs, cnnMs;
+    int                 failed = 0;
+    for (size_t i = 0; i < images.size(); i++) {
+        const ImageResult& r = results[i];
+        if (!r.loaded) {
+            std::cerr << "[Eval] Cannot read " << images[i].path << "\n";
+            failed++;
+            continue;
+        }
+        segMs.push_back(r.segMs);
+        if (useShape) {
+            shapeEval.record(images[i].trueLabel, r.shapeLabel, r.shapeConf);
+            shapeMs.push_back(r.shapeMs);
+        }
+        if (useCnn) {
+            cnnEval.record(images[i].trueLabel, r.cnnLabel, r.cnnConf);
+            cnnMs.push_back(r.cnnMs);
+        }
+    }
+
+    if (useShape) {
+        std::cout << "\n--- Shape features ---";
+        shapeEval.printMatrix();
+        if (!saveDir.empty())
+            shapeEval.saveMatrix((fs::path(saveDir) / "confusion_shape.csv").string());
+    }
+    if (useCnn) {
+        std::cout << "\n--- CNN embeddings ---";
+        cnnEval.printMatrix();
+        if (!saveDir.empty())
+            cnnEval.saveMatrix((fs::path(saveDir) / "confusion_cnn.csv").string());
+    }
+
+    std::cout << "Per-image latency (ms)\n"
+              << std::left << std::setw(16) << "Stage" << std::right
+              << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p95"  << std::setw(10) << "max" << "\n";
+    printLatency("Segmentation", segMs);
+    printLatency("Shape classify", shapeMs);
+    printLatency("CNN classify", cnnMs);
+
+    const size_t done = images.size() - failed;
+    std::cout << "\n" << done << " images in " << std::fixed << std::setprecision(0)
+              << wallMs << " ms (" << std::setprecision(1)
+              << (wallMs > 0.0 ? done * 1000.0 / wallMs : 0.0) << " images/s)";
+    if (failed) std::cout << ", " << failed << " unreadable";
+    std::cout << "\n";
+    return 0;
+}
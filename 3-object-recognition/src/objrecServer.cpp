@@ -0,0 +1,393 @@
+/**
+ * @file    objrecServer.cpp
+ * @brief   Headless multi-stream recognition server.
+ *
+ *          Usage:
+ *            objrecServer --input <spec> [--input <spec> ...]
+ *                         [--streams <file>] [--classifier shape|cnn]
+ *                         [--port N] [--db data/db/objects.bin]
+ *                         [--embdb data/db/embeddings.bin]
+ *                         [--model data/models/resnet18-v2-7.onnx]
+ *                         [--batch 32] [--batch-wait 4] [--no-drop]
+ *                         [--no-index] [--shm <prefix>]
+ *
+ *          A <spec> is anything FrameSource opens: a camera index, video
+ *          file, stream URL or GStreamer pipeline.  --streams reads one spec
+ *          per line (blank lines and '#' comments skipped).
+ *
+ *          One process serves every stream.  Each stream has its own decode
+ *          thread and a segmentation worker (Tasks 1-4, tracking,
+ *          classification); the object and embedding databases, the shape
+ *          classifier and the ResNet18 network are loaded once and shared
+ *          read-only.  In CNN mode the workers hand their regions to one
+ *          InferenceBatcher, which embeds the regions of all streams that
+ *          are waiting in a single forward pass.  Embeddings are matched
+ *          through the database's HNSW graph (embeddings.hnsw, built on the
+ *          first run) unless --no-index is given.
+ *
+ *          Each processed frame produces one JSON line:
+ *            {"stream":0,"frame":812,"time_ms":...,"regions":[{"track":3,
+ *             "label":"scissors","confidence":0.82,"x":..,"y":..,"w":..,
+ *             "h":..,"cx":..,"cy":..,"angle":..}]}
+ *          sent to every TCP client on --port, or printed to stdout without
+ *          it.  With --shm, each stream also publishes its frames and
+ *          regions to the shared-memory ring <prefix>_<stream> (see
+ *          SharedPublisher.h).  Throughput is reported on stderr every few
+ *          seconds.  Ctrl+C stops the server.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    February 2026
+ */
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AppState.h"
+#include "ScaledPipeline.h"
+#include "RegionTracker.h"
+#include "ObjectDB.h"
+#include "Classifier.h"
+#include "Embedding.h"
+#include "FrameSource.h"
+#include "InferenceBatcher.h"
+#include "ResultServer.h"
+#include "SharedPublisher.h"
+
+static constexpr int kReportSeconds = 5;
+
+static std::atomic<bool> gRunning{true};
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+/** One input stream and its worker. */
+struct Stream {
+    int                    id = 0;
+    std::string            spec;
+    FrameSource            source;
+    std::thread            worker;
+    std::atomic<long long> processed{0};
+    std::atomic<bool>      finished{false};   ///< Source ended or closed
+    SharedPublisher        shm;               ///< Idle unless --shm
+};
+
+/** Shared, read-only models plus the result output. */
+struct ServerContext {
+    PipelineParams          params;
+    const Classifier*       classifier = nullptr;   ///< Shape mode
+    const EmbeddingDB*      embDB      = nullptr;   ///< CNN mode
+    EmbeddingClassifier*    embClassifier = nullptr;
+    InferenceBatcher*       batcher    = nullptr;
+    ResultServer*           server     = nullptr;   ///< Null: stdout
+    std::mutex              stdoutMutex;
+};
+
+/** Value of a --key argument, or an empty string. */
+static std::string getArg(int argc, char* argv[], const std::string& key)
+{
+    for (int i = 1; i < argc - 1; i++)
+        if (std::string(argv[i]) == key) return argv[i + 1];
+    return "";
+}
+
+/** Every value of a repeatable --key argument. */
+static std::vector<std::string> getArgs(int argc, char* argv[], const std::string& key)
+{
+    std::vector<std::string> values;
+    for (int i = 1; i < argc - 1; i++)
+        if (std::string(argv[i]) == key) values.push_back(argv[++i]);
+    return values;
+}
+
+/** True if a --flag is present. */
+static bool hasFlag(int argc, char* argv[], const std::string& flag)
+{
+    for (int i = 1; i < argc; i++)
+        if (std::string(argv[i]) == flag) return true;
+    return false;
+}
+
+/** Stream specs from a file, one per line. */
+static std::vector<std::string> readStreamList(const std::string& path)
+{
+    std::vector<std::string> specs;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t b = line.find_first_not_of(" \t\r");
+        if (b == std::string::npos || line[b] == '#') continue;
+        const size_t e = line.find_last_not_of(" \t\r");
+        specs.push_back(line.substr(b, e - b + 1));
+    }
+    return specs;
+}
+
+/** A string as a JSON string literal. */
+static std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+/** One frame's results as a JSON line. */
+static std::string resultJson(int stream, long long frame,
+                              const std::vector<RegionInfo>& regions)
+{
+    const long long nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3)
+       << "{\"stream\":" << stream << ",\"frame\":" << frame
+       << ",\"time_ms\":" << nowMs << ",\"regions\":[";
+    for (size_t i = 0; i < regions.size(); i++) {
+        const RegionInfo& r = regions[i];
+        os << (i ? "," : "")
+           << "{\"track\":" << r.trackId
+           << ",\"label\":" << jsonString(r.label)
+           << ",\"confidence\":" << r.confidence
+           << ",\"x\":" << r.boundingBox.x << ",\"y\":" << r.boundingBox.y
+           << ",\"w\":" << r.boundingBox.width << ",\"h\":" << r.boundingBox.height
+           << ",\"cx\":" << r.centroid.x << ",\"cy\":" << r.centroid.y
+           << ",\"angle\":" << r.angle << "}";
+    }
+    os << "]}";
+    return os.str();
+}
+
+/** Ctrl+C: stop every stream. */
+static void onSignal(int)
+{
+    gRunning = false;
+}
+
+// -----------------------------------------------------------------------------
+// Worker
+// -----------------------------------------------------------------------------
+/**
+ * @brief Segmentation worker of one stream: decoded frames in, JSON out.
+ *
+ * @param s    The stream (its FrameSource is open).
+ * @param ctx  Shared models and output.
+ */
+static void runStream(Stream& s, ServerContext& ctx)
+{
+    AppState      work;
+    RegionTracker tracker;
+    const PipelineParams& params = ctx.params;
+    const float thresh = EmbeddingClassifier::threshold(params);
+
+    std::vector<RegionInfo>         batch;
+    std::vector<size_t>             index;
+    std::vector<std::vector<float>> embs;
+
+    for (long long frameNo = 0; gRunning && s.source.next(work.frameOriginal); frameNo++) {
+        runSegmentation(work.frameOriginal, work, params, PipelineViews{});
+        tracker.update(work.regions, params);
+
+        if (ctx.classifier) {
+            ctx.classifier->classifyAll(work, params);
+        } else {
+            // Regions the tracker flagged join the shared cross-stream batch
+            batch.clear();
+            index.clear();
+            for (size_t i = 0; i < work.regions.size(); i++) {
+                if (!work.regions[i].needsClassify) continue;
+                batch.push_back(work.regions[i]);
+                index.push_back(i);
+            }
+            ctx.batcher->embed(work.frameOriginal, batch, embs);
+
+            for (size_t j = 0; j < batch.size(); j++) {
+                if (embs[j].empty()) continue;
+                RegionInfo& reg = work.regions[index[j]];
+                float dist;
+                ctx.embClassifier->classify(embs[j], *ctx.embDB, thresh,
+                                            reg.label, dist, params.distanceMetric);
+                reg.confidence = EmbeddingClassifier::confidence(dist, params.distanceMetric);
+                reg.embedding  = std::move(embs[j]);
+            }
+        }
+        tracker.store(work.regions);
+
+        const std::string line = resultJson(s.id, frameNo, work.regions);
+        if (ctx.server) {
+            ctx.server->publish(line);
+        } else {
+            std::lock_guard<std::mutex> lock(ctx.stdoutMutex);
+            std::cout << line << "\n";
+        }
+        if (s.shm.enabled()) s.shm.publish(work.frameOriginal, work.regions, frameNo);
+        s.processed++;
+    }
+    s.finished = true;
+}
+
+// -----------------------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> specs = getArgs(argc, argv, "--input");
+    std::string listPath  = getArg(argc, argv, "--streams");
+    std::string mode      = getArg(argc, argv, "--classifier");
+    std::string portStr   = getArg(argc, argv, "--port");
+    std::string dbPath    = getArg(argc, argv, "--db");
+    std::string embPath   = getArg(argc, argv, "--embdb");
+    std::string modelPath = getArg(argc, argv, "--model");
+    std::string batchStr  = getArg(argc, argv, "--batch");
+    std::string waitStr   = getArg(argc, argv, "--batch-wait");
+    const bool  dropFrames = !hasFlag(argc, argv, "--no-drop");
+    const bool  useIndex   = !hasFlag(argc, argv, "--no-index");
+    const std::string shmPrefix = getArg(argc, argv, "--shm");
+    if (mode.empty())      mode      = "cnn";
+    if (dbPath.empty())    dbPath    = "data/db/objects.bin";
+    if (embPath.empty())   embPath   = "data/db/embeddings.bin";
+    if (modelPath.empty()) modelPath = "data/models/resnet18-v2-7.onnx";
+    if (!listPath.empty()) {
+        const auto listed = readStreamList(listPath);
+        specs.insert(specs.end(), listed.begin(), listed.end());
+    }
+
+    if (specs.empty() || (mode != "shape" && mode != "cnn")) {
+        std::cerr << "Usage: objrecServer --input <spec> [--input <spec> ...] [--streams <file>]\n"
+                     "                    [--classifier shape|cnn] [--port N]\n"
+                     "                    [--db <bin>] [--embdb <bin>] [--model <onnx>]\n"
+                     "                    [--batch N] [--batch-wait ms] [--no-drop] [--no-index]\n"
+                     "                    [--shm <prefix>]\n"
+                     "  <spec>: camera index, video file, stream URL or GStreamer pipeline.\n";
+        return 1;
+    }
+
+    // --- Shared models: loaded once for every stream -------------------------
+    ServerContext ctx;
+    ObjectDB            db(dbPath);
+    Classifier          classifier(db, ctx.params);
+    EmbeddingDB         embDB(embPath);
+    EmbeddingClassifier embClassifier;
+    std::unique_ptr<InferenceBatcher> batcher;
+
+    if (mode == "shape") {
+        if (db.empty()) { std::cerr << "Error: shape DB " << dbPath << " is empty.\n"; return 1; }
+        ctx.classifier = &classifier;
+    } else {
+        if (embDB.empty()) { std::cerr << "Error: embedding DB " << embPath << " is empty.\n"; return 1; }
+        embDB.setIndexed(useIndex);
+        if (!embClassifier.loadModel(modelPath, ctx.params.dnnBackend)) {
+            std::cerr << "Error: cannot load " << modelPath << "\n";
+            return 1;
+        }
+        embClassifier.setKeepCrops(false);
+        batcher = std::make_unique<InferenceBatcher>(
+            embClassifier,
+            batchStr.empty() ? 32 : std::stoi(batchStr),
+            waitStr.empty()  ? 4  : std::stoi(waitStr));
+        ctx.embDB         = &embDB;
+        ctx.embClassifier = &embClassifier;
+        ctx.batcher       = batcher.get();
+    }
+
+    ResultServer server;
+    if (!portStr.empty()) {
+        if (!server.start(std::stoi(portStr))) return 1;
+        ctx.server = &server;
+    }
+
+    // Streams run in parallel; keep OpenCV's own loops serial per frame
+    cv::setNumThreads(1);
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    // --- One decode thread + one segmentation worker per stream --------------
+    std::vector<std::unique_ptr<Stream>> streams;
+    for (const auto& spec : specs) {
+        auto s = std::make_unique<Stream>();
+        s->id   = static_cast<int>(streams.size());
+        s->spec = spec;
+
+        // A bare number is a camera index
+        const bool camera = !spec.empty() &&
+                            spec.find_first_not_of("0123456789") == std::string::npos;
+        if (!s->source.open(camera ? "" : spec, camera ? std::stoi(spec) : 0, dropFrames)) {
+            std::cerr << "[Server] Cannot open stream " << s->id << ": " << spec << "\n";
+            continue;
+        }
+        std::cerr << "[Server] Stream " << s->id << ": " << s->source.description() << "\n";
+        if (!shmPrefix.empty()) s->shm.setName(shmPrefix + "_" + std::to_string(s->id));
+        streams.push_back(std::move(s));
+    }
+    if (streams.empty()) return 1;
+
+    for (auto& s : streams)
+        s->worker = std::thread(runStream, std::ref(*s), std::ref(ctx));
+
+    std::cerr << "[Server] " << streams.size() << " streams, classifier: " << mode
+              << (ctx.server ? ", JSON over TCP" : ", JSON on stdout") << "\n";
+
+    // --- Periodic throughput report until Ctrl+C or every stream ends --------
+    std::vector<long long> lastProcessed(streams.size(), 0);
+    auto tLast = std::chrono::steady_clock::now();
+    while (gRunning) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        bool anyLive = false;
+        for (auto& s : streams) anyLive |= !s->finished;
+        if (!anyLive) break;
+
+        const auto  tNow = std::chrono::steady_clock::now();
+        const float dt   = std::chrono::duration<float>(tNow - tLast).count();
+        if (dt < kReportSeconds) continue;
+        tLast = tNow;
+
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1) << "[Server]";
+        for (size_t i = 0; i < streams.size(); i++) {
+            const long long n = streams[i]->processed;
+            const FrameSource::Stats st = streams[i]->source.stats();
+            os << "  #" << i << " " << (n - lastProcessed[i]) / dt << " fps"
+               << " (drop " << st.dropped << "/" << st.decoded << ")";
+            lastProcessed[i] = n;
+        }
+        if (batcher) {
+            const InferenceBatcher::Stats bs = batcher->stats();
+            os << "  | CNN " << bs.meanBatch << " regions/pass, "
+               << bs.latencyMs << " ms";
+        }
+        if (ctx.server) os << "  | " << server.clientCount() << " clients";
+        std::cerr << os.str() << "\n";
+    }
+
+    // Closing a source wakes its worker out of next()
+    for (auto& s : streams) s->source.close();
+    for (auto& s : streams) s->worker.join();
+    std::cerr << "[Server] Stopped.\n";
+    return 0;
+}
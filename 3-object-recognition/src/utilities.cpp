@@ -78,33 +78,78 @@ void prepEmbeddingImage(cv::Mat& frame, cv::Mat& embimage,
     extracted.copyTo(embimage);
 }
 
+// Penultimate flatten layer of resnet18-v2-7.onnx
+static const char* const kEmbeddingLayer = "onnx_node!resnetv22_flatten0_reshape0";
+
 // -----------------------------------------------------------------------------
 // Modified from Prof. Bruce Maxwell's getEmbedding()
 // -----------------------------------------------------------------------------
 int getEmbedding(cv::Mat& src, cv::Mat& embedding,
                  cv::dnn::Net& net, int debug)
 {
-    const int ORNet_size = 224;
+    const int ORNet_size = kORNetSize;
     cv::Mat   blob, resized;
 
     cv::resize(src, resized, cv::Size(ORNet_size, ORNet_size));
 
     cv::dnn::blobFromImage(resized,
                            blob,
-                           (1.0 / 255.0) * (1.0 / 0.226),   // scale
+                           kORNetScale,                       // scale
                            cv::Size(ORNet_size, ORNet_size),
-                           cv::Scalar(124, 116, 104),         // mean subtraction
+                           cv::Scalar(kORNetMean[0], kORNetMean[1],
+                                      kORNetMean[2]),         // mean subtraction
                            true,    // swapRB
                            false,   // center crop
                            CV_32F);
 
     net.setInput(blob);
 
-    // Layer name for resnet18-v2-7.onnx penultimate flatten layer
-    embedding = net.forward("onnx_node!resnetv22_flatten0_reshape0");
+    // Penultimate flatten layer for resnet18-v2-7.onnx, else the final output
+    embedding = net.forward(embeddingLayer(net)).reshape(1, 1);
 
     if (debug)
         std::cout << "Embedding size: " << embedding.size() << "\n";
 
     return 0;
 }
+
+// -----------------------------------------------------------------------------
+int getEmbeddings(const std::vector<cv::Mat>& srcs, cv::Mat& embeddings,
+                  cv::dnn::Net& net)
+{
+    if (srcs.empty()) return -1;
+
+    std::vector<cv::Mat> resized(srcs.size());
+    for (size_t i = 0; i < srcs.size(); i++)
+        cv::resize(srcs[i], resized[i], cv::Size(kORNetSize, kORNetSize));
+
+    // Same normalisation as getEmbedding(), one N x 3 x 224 x 224 blob
+    cv::Mat blob = cv::dnn::blobFromImages(resized,
+                                           kORNetScale,
+                                           cv::Size(kORNetSize, kORNetSize),
+                                           cv::Scalar(kORNetMean[0], kORNetMean[1],
+                                                      kORNetMean[2]),
+                                           true,    // swapRB
+                                           false,   // center crop
+                                           CV_32F);
+    return forwardEmbeddings(blob, embeddings, net, embeddingLayer(net));
+}
+
+// -----------------------------------------------------------------------------
+std::string embeddingLayer(const cv::dnn::Net& net)
+{
+    return net.getLayerId(kEmbeddingLayer) >= 0 ? kEmbeddingLayer : "";
+}
+
+// -----------------------------------------------------------------------------
+int forwardEmbeddings(const cv::Mat& blob, cv::Mat& embeddings,
+                      cv::dnn::Net& net, const std::string& layer)
+{
+    if (blob.empty()) return -1;
+    net.setInput(blob);
+
+    // One row per input image (N x 512 for ResNet18's flatten layer)
+    cv::Mat out = net.forward(layer);
+    embeddings = out.reshape(1, blob.size[0]);
+    return 0;
+}
@@ -0,0 +1,440 @@
+/*
+ * arBench.cpp - AR Tracking Benchmark Harness
+ * Author:      Krushna Sanjay Sharma
+ * Description: Plays a recorded clip through every tracker the apps use —
+ *              PoseEstimator (chessboard), SIFTTracker (bill) and
+ *              MultiTargetTracker (bill, shared-detection path) — and
+ *              reports, per tracker:
+ *                - mean ms per stage (gray, clahe, detect, flow, match,
+ *                  ransac, pnp, draw) from the trackers' StageTimings
+ *                - mean and 95th percentile ms per frame (track + draw)
+ *                - success rate (frames with a pose)
+ *                - reprojection error against ground truth: mean pixel
+ *                  distance of the target's outer corners projected with
+ *                  the tracked vs. the ground-truth pose
+ *                - jitter: RMS second difference of the projected corners
+ *                  over consecutive tracked frames (px) — zero for steady
+ *                  or constant-velocity motion, so it measures shake only
+ *              Results are printed and written as the shared harness report
+ *              (cvcore/benchmark.hpp): frame latency percentiles per tracker,
+ *              the metrics above as extra numbers, and an optional
+ *              comparison against a baseline report.
+ *
+ * Usage:
+ *   arBench.exe <calibrationFile> <clip> [referenceImage] [groundTruth]
+ *               [output.json] [backend] [model] [harness options]
+ *
+ *   calibrationFile : calibration XML of the camera that recorded the clip
+ *   clip            : recorded video
+ *   referenceImage  : flat photo of the bill; SIFT / multi-target runs are
+ *                     skipped without it (pass "-" to skip with later args)
+ *   groundTruth     : optional FileStorage file (.yml/.xml), "-" for none:
+ *                       target: "bill"          # or "chessboard"
+ *                       poses:
+ *                         - { frame: 0, rvec: [rx, ry, rz], tvec: [tx, ty, tz] }
+ *                     Poses in the target's units (cm for the bill, squares
+ *                     for the chessboard), frame = 0-based clip index
+ *   output.json     : results file (default: arBench.json)
+ *   backend         : sift | orb | akaze | superpoint | cuda-orb (default: sift)
+ *   model           : SuperPoint ONNX model (superpoint backend only)
+ *   harness options : --compare <baseline.json> --tolerance <frac> --metric
+ *                     <p50_ms|p95_ms|...> --filter <tracker> (--json overrides
+ *                     output.json)
+ *
+ * The pose measured is the one the apps render (smoothed for the feature
+ * trackers).
+ *
+ * Date: March 2026
+ */
+
+#include "MultiTargetTracker.h"
+#include "PoseEstimator.h"
+#include "SIFTTracker.h"
+#include "StageTimings.h"
+#include "VirtualObject.h"
+#include <cvcore/benchmark.hpp>
+#include <cvcore/capture.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+/* Ground-truth pose of one frame */
+struct GroundTruthPose
+{
+    cv::Mat rvec;
+    cv::Mat tvec;
+};
+
+/* One tracker under test — callbacks into the tracker object */
+struct BenchTracker
+{
+    std::string                          name;
+    std::string                          target;         // "chessboard" or "bill"
+    std::vector<cv::Point3f>             outline;        // target corners, world units
+    std::function<bool(const cv::Mat&)>  track;
+    std::function<const cv::Mat&()>      rvec;
+    std::function<const cv::Mat&()>      tvec;
+    std::function<const cv::Mat&()>      cameraMatrix;
+    std::function<const cv::Mat&()>      distCoeffs;
+    std::function<const StageTimings&()> timings;
+    const VirtualObject*                 object = nullptr;
+};
+
+/* Accumulated results for one tracker */
+struct BenchResult
+{
+    std::string         name;
+    std::string         target;
+    int                 frames  = 0;
+    int                 tracked = 0;
+    StageTimings        stageSum;
+    std::vector<double> frameMs;
+    double              reprojSum    = 0.0;
+    int                 reprojFrames = 0;
+    double              jitterSqSum  = 0.0;
+    int                 jitterCount  = 0;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+/* loadGroundTruth()
+ * Returns false only for a file that exists but cannot be parsed. */
+static bool loadGroundTruth(const std::string& path, std::string& target,
+                            std::map<int, GroundTruthPose>& poses)
+{
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        std::cerr << "[ERROR] Cannot open ground truth: " << path << "\n";
+        return false;
+    }
+
+    fs["target"] >> target;
+    cv::FileNode list = fs["poses"];
+    if (target.empty() || list.type() != cv::FileNode::SEQ)
+    {
+        std::cerr << "[ERROR] Ground truth needs 'target' and a 'poses' sequence.\n";
+        return false;
+    }
+
+    for (const auto& node : list)
+    {
+        std::vector<double> r, t;
+        node["rvec"] >> r;
+        node["tvec"] >> t;
+        if (r.size() != 3 || t.size() != 3) continue;
+
+        GroundTruthPose gt;
+        gt.rvec = cv::Mat(r, true);
+        gt.tvec = cv::Mat(t, true);
+        poses[static_cast<int>(node["frame"])] = gt;
+    }
+
+    std::cout << "[INFO] Ground truth: " << poses.size() << " poses for '"
+              << target << "'\n";
+    return true;
+}
+
+/* runTracker()
+ * Plays the whole clip through one tracker. Returns false if the clip
+ * cannot be opened. */
+static bool runTracker(BenchTracker& tracker, const std::string& clipPath,
+                       const std::string& gtTarget,
+                       const std::map<int, GroundTruthPose>& groundTruth,
+                       BenchResult& r)
+{
+    auto cap = cvcore::FrameSource::open(clipPath);
+    if (!cap)
+    {
+        std::cerr << "[ERROR] Cannot open clip: " << clipPath << "\n";
+        return false;
+    }
+
+    r.name   = tracker.name;
+    r.target = tracker.target;
+    const bool useGt = gtTarget == tracker.target;
+
+    // Projected outline of the last two consecutive tracked frames
+    std::vector<cv::Point2f> prev1, prev2;
+
+    cv::Mat frame, display;
+    for (int index = 0; cap->read(frame); ++index)
+    {
+        ++r.frames;
+        display = frame.clone();
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = tracker.track(frame);
+
+        StageTimings timings = tracker.timings();
+        if (ok && tracker.object)
+        {
+            StageTimer draw(timings, StageTimings::DRAW);
+            tracker.object->draw(display, tracker.rvec(), tracker.tvec(),
+                                 tracker.cameraMatrix(), tracker.distCoeffs());
+        }
+        r.frameMs.push_back(elapsedMs(t0));
+        for (int s = 0; s < StageTimings::STAGE_COUNT; ++s)
+            r.stageSum.ms[s] += timings.ms[s];
+
+        if (!ok)
+        {
+            prev1.clear();
+            prev2.clear();
+            continue;
+        }
+        ++r.tracked;
+
+        std::vector<cv::Point2f> projected;
+        cv::projectPoints(tracker.outline, tracker.rvec(), tracker.tvec(),
+                          tracker.cameraMatrix(), tracker.distCoeffs(), projected);
+
+        auto gt = groundTruth.find(index);
+        if (useGt && gt != groundTruth.end())
+        {
+            std::vector<cv::Point2f> expected;
+            cv::projectPoints(tracker.outline, gt->second.rvec, gt->second.tvec,
+                              tracker.cameraMatrix(), tracker.distCoeffs(), expected);
+            double err = 0.0;
+            for (size_t i = 0; i < expected.size(); ++i)
+                err += cv::norm(projected[i] - expected[i]);
+            r.reprojSum += err / expected.size();
+            ++r.reprojFrames;
+        }
+
+        if (!prev2.empty())
+        {
+            for (size_t i = 0; i < projected.size(); ++i)
+            {
+                const cv::Point2f a = projected[i] - 2.0f * prev1[i] + prev2[i];
+                r.jitterSqSum += a.dot(a);
+                ++r.jitterCount;
+            }
+        }
+        prev2 = prev1;
+        prev1 = projected;
+    }
+    return true;
+}
+
+/* percentile() - p in [0,1] of values (copied, nth_element) */
+static double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.0;
+    const size_t k = std::min(values.size() - 1,
+                              static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+static double mean(const std::vector<double>& values)
+{
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+/* addToSuite() - frame latency as the compared distribution, the rest as
+ * extra numbers; metrics without data (no ground truth, too few tracked
+ * frames) are left out */
+static void addToSuite(cvcore::BenchSuite& suite, const BenchResult& r,
+                       const std::string& clipPath, const std::string& gtPath,
+                       const std::string& backend)
+{
+    const double n = std::max(r.frames, 1);
+    cvcore::BenchResult& out = suite.addSamples(r.name, r.frameMs, 1.0, "frame");
+    out.labels["target"]  = r.target;
+    out.labels["backend"] = backend;
+    out.labels["clip"]    = clipPath;
+    if (!gtPath.empty()) out.labels["ground_truth"] = gtPath;
+
+    out.extra["frames"]       = r.frames;
+    out.extra["tracked"]      = r.tracked;
+    out.extra["success_rate"] = r.tracked / n;
+    for (int s = 0; s < StageTimings::STAGE_COUNT; ++s)
+        out.extra[std::string("stage_") + StageTimings::stageName(s) + "_ms"] =
+            r.stageSum.ms[s] / n;
+    out.extra["ground_truth_frames"] = r.reprojFrames;
+    if (r.reprojFrames)
+        out.extra["reprojection_error_px"] = r.reprojSum / r.reprojFrames;
+    if (r.jitterCount)
+        out.extra["jitter_px"] = std::sqrt(r.jitterSqSum / r.jitterCount);
+}
+
+int main(int argc, char* argv[])
+{
+    std::cout << "========================================\n";
+    std::cout << " AR Calibration System\n";
+    std::cout << " AR Tracking Benchmark\n";
+    std::cout << "========================================\n\n";
+
+    /* Harness options anywhere, the rest positional */
+    cvcore::BenchOptions options;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i)
+        if (!options.consume(i, argc, argv)) args.push_back(argv[i]);
+
+    if (args.size() < 2)
+    {
+        std::cerr << "Usage: arBench <calibrationFile> <clip> [referenceImage] "
+                     "[groundTruth] [output.json] [backend] [model] [harness options]\n"
+                  << cvcore::BenchOptions::usage();
+        return 1;
+    }
+
+    auto optionalArg = [&](size_t i) -> std::string
+    {
+        return args.size() > i && args[i] != "-" ? args[i] : "";
+    };
+
+    const std::string calibFile = args[0];
+    const std::string clipPath  = args[1];
+    const std::string refImage  = optionalArg(2);
+    const std::string gtPath    = optionalArg(3);
+    if (options.jsonPath.empty())
+        options.jsonPath = args.size() > 4 ? args[4] : "arBench.json";
+    FeatureBackend::Type backend = FeatureBackend::SIFT;
+    if (args.size() > 5 && !FeatureBackend::parseType(args[5], backend))
+        std::cerr << "[WARN] Unknown backend '" << args[5] << "', using SIFT.\n";
+    const std::string modelPath = optionalArg(6);
+
+    std::string gtTarget;
+    std::map<int, GroundTruthPose> groundTruth;
+    if (!gtPath.empty() && !loadGroundTruth(gtPath, gtTarget, groundTruth))
+        return 1;
+
+    std::vector<BenchTracker> trackers;
+
+    /* Chessboard — rocket as in augmentedReality */
+    PoseEstimator chess(calibFile);
+    VirtualObject chessRocket;
+    chessRocket.buildRocket();
+    if (chess.loadCalibration())
+    {
+        const float w = PoseEstimator::BOARD_WIDTH - 1.0f;
+        const float h = PoseEstimator::BOARD_HEIGHT - 1.0f;
+        BenchTracker t;
+        t.name         = "chessboard";
+        t.target       = "chessboard";
+        t.outline      = { { 0, 0, 0 }, { w, 0, 0 }, { w, -h, 0 }, { 0, -h, 0 } };
+        t.track        = [&chess](const cv::Mat& f)
+        {
+            std::vector<cv::Point2f> corners;
+            return chess.detectCorners(f, corners) && chess.estimatePose(corners);
+        };
+        t.rvec         = [&chess]() -> const cv::Mat& { return chess.getRvec(); };
+        t.tvec         = [&chess]() -> const cv::Mat& { return chess.getTvec(); };
+        t.cameraMatrix = [&chess]() -> const cv::Mat& { return chess.getCameraMatrix(); };
+        t.distCoeffs   = [&chess]() -> const cv::Mat& { return chess.getDistCoeffs(); };
+        t.timings      = [&chess]() -> const StageTimings& { return chess.getTimings(); };
+        t.object       = &chessRocket;
+        trackers.push_back(t);
+    }
+
+    /* Bill — rocket as in siftAR, for both feature trackers */
+    VirtualObject billRocket;
+    billRocket.buildRocket(cv::Vec3f(7.8f - 0.75f, 3.3f - 0.75f, 0.0f), 1.2f, true, true);
+    const std::vector<cv::Point3f> billOutline = {
+        { 0.0f, 0.0f, 0.0f }, { SIFTTracker::BILL_WIDTH_CM, 0.0f, 0.0f },
+        { SIFTTracker::BILL_WIDTH_CM, SIFTTracker::BILL_HEIGHT_CM, 0.0f },
+        { 0.0f, SIFTTracker::BILL_HEIGHT_CM, 0.0f }
+    };
+
+    SIFTTracker        sift(calibFile, refImage, 300, backend, modelPath);
+    MultiTargetTracker multi(calibFile, 300, backend, modelPath);
+    if (!refImage.empty())
+    {
+        if (sift.initialize())
+        {
+            BenchTracker t;
+            t.name         = "sift";
+            t.target       = "bill";
+            t.outline      = billOutline;
+            t.track        = [&sift](const cv::Mat& f) { return sift.track(f); };
+            t.rvec         = [&sift]() -> const cv::Mat& { return sift.getRvec(); };
+            t.tvec         = [&sift]() -> const cv::Mat& { return sift.getTvec(); };
+            t.cameraMatrix = [&sift]() -> const cv::Mat& { return sift.getCameraMatrix(); };
+            t.distCoeffs   = [&sift]() -> const cv::Mat& { return sift.getDistCoeffs(); };
+            t.timings      = [&sift]() -> const StageTimings& { return sift.getTimings(); };
+            t.object       = &billRocket;
+            trackers.push_back(t);
+        }
+
+        multi.addTarget("bill", refImage, SIFTTracker::BILL_WIDTH_CM,
+                        SIFTTracker::BILL_HEIGHT_CM);
+        if (multi.initialize())
+        {
+            BenchTracker t;
+            t.name         = "multiTarget";
+            t.target       = "bill";
+            t.outline      = billOutline;
+            t.track        = [&multi](const cv::Mat& f) { return multi.track(f) > 0; };
+            t.rvec         = [&multi]() -> const cv::Mat& { return multi.getRvec(0); };
+            t.tvec         = [&multi]() -> const cv::Mat& { return multi.getTvec(0); };
+            t.cameraMatrix = [&multi]() -> const cv::Mat& { return multi.getCameraMatrix(); };
+            t.distCoeffs   = [&multi]() -> const cv::Mat& { return multi.getDistCoeffs(); };
+            t.timings      = [&multi]() -> const StageTimings& { return multi.getTimings(); };
+            t.object       = &billRocket;
+            trackers.push_back(t);
+        }
+    }
+
+    if (trackers.empty())
+    {
+        std::cerr << "[FAILED] No tracker could be initialized.\n";
+        return 1;
+    }
+
+    cvcore::BenchSuite suite("arBench", options);
+    std::cout << "[INFO] ";
+    suite.printEnvironment(std::cout);
+
+    std::vector<BenchResult> results;
+    for (auto& t : trackers)
+    {
+        if (!suite.selected(t.name)) continue;
+        std::cout << "[INFO] Running " << t.name << " ...\n";
+        BenchResult r;
+        if (!runTracker(t, clipPath, gtTarget, groundTruth, r)) return 1;
+        results.push_back(r);
+        addToSuite(suite, r, clipPath, gtPath, FeatureBackend::typeName(backend));
+    }
+
+    /* Console table */
+    std::cout << "\n" << std::left << std::setw(13) << "Tracker" << std::right;
+    for (int s = 0; s < StageTimings::STAGE_COUNT; ++s)
+        std::cout << std::setw(8) << StageTimings::stageName(s);
+    std::cout << std::setw(9) << "frame" << std::setw(8) << "p95"
+              << std::setw(9) << "success" << std::setw(9) << "reproj"
+              << std::setw(8) << "jitter" << "\n";
+
+    for (const auto& r : results)
+    {
+        const double n = std::max(r.frames, 1);
+        std::cout << std::left << std::setw(13) << r.name << std::right
+                  << std::fixed << std::setprecision(2);
+        for (int s = 0; s < StageTimings::STAGE_COUNT; ++s)
+            std::cout << std::setw(8) << r.stageSum.ms[s] / n;
+        std::cout << std::setw(9) << mean(r.frameMs)
+                  << std::setw(8) << percentile(r.frameMs, 0.95)
+                  << std::setprecision(1) << std::setw(8) << 100.0 * r.tracked / n << "%"
+                  << std::setprecision(2);
+        if (r.reprojFrames) std::cout << std::setw(9) << r.reprojSum / r.reprojFrames;
+        else                std::cout << std::setw(9) << "-";
+        if (r.jitterCount)  std::cout << std::setw(8) << std::sqrt(r.jitterSqSum / r.jitterCount);
+        else                std::cout << std::setw(8) << "-";
+        std::cout << "\n";
+    }
+    std::cout << "(stage and frame columns in ms; reproj and jitter in px)\n";
+
+    return suite.finish() ? 0 : 1;
+}
@@ -7,19 +7,39 @@
  *   Task 6 - VirtualObject: render a 3D rocket floating above the board
  *
  * Usage:
- *   augmentedReality.exe [calibrationFile] [cameraId]
+ *   augmentedReality.exe [calibrationFile] [cameraId] [--gl [mesh.obj]] [--pipeline] [--fiducial]
+ *
+ *   --gl       : draw the rocket with the OpenGL renderer (AR_WITH_OPENGL builds)
+ *   mesh.obj   : also place three instances of an OBJ model on the board
+ *   --pipeline : capture / tracking / render threads (ARRuntime); draws
+ *                axes + rocket with the extrapolated pose, 'v' toggles
+ *                extrapolation
+ *   --fiducial : start on the ChArUco fiducial board instead of the
+ *                chessboard (AR_WITH_ARUCO builds); a printable board is
+ *                written to data/charuco_board.png if missing
  *
  * Controls:
  *   SPACE   - cycle Task 5 display mode (corners / axes / both)
  *   'r'     - toggle rocket visibility (Task 6)
+ *   't'     - toggle corner tracking (full chessboard search every frame when off)
+ *   'p'     - toggle pose solver (IPPE / iterative)
+ *   'u'     - toggle frame undistortion (precomputed maps)
+ *   'f'     - toggle target: chessboard / fiducial board
  *   'q'/ESC - quit
  *
  * Date: March 2026
  */
 
+#include "ARRuntime.h"
+#include "FrameUndistorter.h"
+#include "GLRenderer.h"
+#include "VirtualMesh.h"
 #include "PoseEstimator.h"
 #include "VirtualObject.h"
+#include <atomic>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <filesystem>
 
@@ -30,6 +50,9 @@ int main(int argc, char* argv[])
     std::cout << " Augmented Reality App (Tasks 4-6)\n";
     std::cout << "========================================\n\n";
 
+    const bool pipelined = ARRuntime::takeFlag(argc, argv, "--pipeline");
+    const bool fiducial  = ARRuntime::takeFlag(argc, argv, "--fiducial");
+
     /* Resolve calibration file path relative to the executable */
     std::filesystem::path exeDir =
         std::filesystem::path(argv[0]).parent_path();
@@ -44,6 +67,8 @@ int main(int argc, char* argv[])
         try   { cameraId = std::stoi(argv[2]); }
         catch (...) { std::cerr << "[WARN] Invalid camera ID, using 0.\n"; }
     }
+    bool useGL = argc >= 4 && std::string(argv[3]) == "--gl";
+    const std::string meshPath = useGL && argc >= 5 ? argv[4] : "";
 
     std::cout << "Calibration file : " << calibFile << "\n";
     std::cout << "Camera ID        : " << cameraId  << "\n\n";
@@ -52,6 +77,16 @@ int main(int argc, char* argv[])
     VirtualObject rocket;
     rocket.buildRocket();
 
+    /* Optional mesh — three instances along the middle board row, 2 squares
+     * tall, all drawn with one matrix upload per frame */
+    VirtualMesh mesh;
+    if (!meshPath.empty() && mesh.loadOBJ(meshPath, 2.0f, cv::Scalar(60, 160, 230)))
+    {
+        mesh.addInstance(cv::Vec3f(1.5f, -2.5f, 0.0f));
+        mesh.addInstance(cv::Vec3f(4.0f, -2.5f, 0.0f), 1.0f, 120.0f);
+        mesh.addInstance(cv::Vec3f(6.5f, -2.5f, 0.0f), 1.0f, 240.0f);
+    }
+
     /* Set up the pose estimator */
     PoseEstimator estimator(calibFile, cameraId);
 
@@ -62,8 +97,30 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    cv::VideoCapture cap(cameraId);
-    if (!cap.isOpened())
+    /* Fiducial board — same world frame and calibration as the chessboard */
+    if (fiducial && estimator.setTargetType(PoseEstimator::TargetType::FIDUCIAL))
+    {
+        const std::filesystem::path boardFile = exeDir / "data" / "charuco_board.png";
+        cv::Mat board;
+        if (!std::filesystem::exists(boardFile) && FiducialTarget::drawBoard(100, board))
+        {
+            cv::imwrite(boardFile.string(), board);
+            std::cout << "[INFO] Printable fiducial board written to " << boardFile.string() << "\n";
+        }
+    }
+
+    // 'f' — switch between the chessboard and the fiducial board
+    auto toggleTarget = [&]()
+    {
+        const bool toFiducial =
+            estimator.getTargetType() == PoseEstimator::TargetType::CHESSBOARD;
+        if (estimator.setTargetType(toFiducial ? PoseEstimator::TargetType::FIDUCIAL
+                                               : PoseEstimator::TargetType::CHESSBOARD))
+            std::cout << "[Mode] Target: " << (toFiducial ? "fiducial board" : "chessboard") << "\n";
+    };
+
+    auto cap = cvcore::FrameSource::open("", cameraId);
+    if (!cap)
     {
         std::cerr << "[FAILED] Cannot open camera " << cameraId << "\n";
         return 1;
@@ -72,10 +129,82 @@ int main(int argc, char* argv[])
     std::cout << "Controls:\n";
     std::cout << "  SPACE  - cycle axes/corners display mode\n";
     std::cout << "  'r'    - toggle rocket on/off\n";
+    std::cout << "  't'    - toggle corner tracking\n";
+    std::cout << "  'p'    - toggle pose solver IPPE/iterative\n";
+    std::cout << "  'u'    - toggle frame undistortion\n";
+    std::cout << "  'f'    - toggle target chessboard/fiducial\n";
     std::cout << "  'q'/ESC - quit\n\n";
 
     bool showRocket = true;
 
+    /* --pipeline: tracking runs on its own thread; the render thread draws
+     * every camera frame with the newest (extrapolated) board pose */
+    if (pipelined)
+    {
+        std::atomic<bool> rocketOn(true);
+        ARRuntime runtime(*cap,
+            [&](const cv::Mat& image, ARTrackResult& result)
+            {
+                std::vector<cv::Point2f> corners;
+                ARPose pose;
+                pose.valid = estimator.detectCorners(image, corners) &&
+                             estimator.estimatePose(corners);
+                if (pose.valid)
+                {
+                    pose.rvec = estimator.getRvec().clone();
+                    pose.tvec = estimator.getTvec().clone();
+                }
+                result.poses.push_back(pose);
+                result.cameraMatrix = estimator.getCameraMatrix();
+                result.distCoeffs   = estimator.getDistCoeffs();
+                result.status.push_back(!pose.valid ? "Board: searching..."
+                                        : estimator.cornersTracked() ? "Board: tracked corners"
+                                        : estimator.getTargetType() == PoseEstimator::TargetType::FIDUCIAL
+                                            ? "Board: fiducial markers"
+                                            : "Board: detected");
+            },
+            [&](cv::Mat& display, const ARTrackResult& result)
+            {
+                const ARPose& pose = result.poses[0];
+                if (!pose.valid) return;
+                cv::drawFrameAxes(display, result.cameraMatrix, result.distCoeffs,
+                                  pose.rvec, pose.tvec, 3.0f);
+                if (rocketOn)
+                    rocket.draw(display, pose.rvec, pose.tvec,
+                                result.cameraMatrix, result.distCoeffs);
+            },
+            [&](int key)
+            {
+                if (key == 'r') rocketOn = !rocketOn;
+                if (key == 't') estimator.setTrackingMode(!estimator.getTrackingMode());
+                if (key == 'f') toggleTarget();
+                if (key == 'p')
+                {
+                    PoseSolver& solver = estimator.getSolver();
+                    solver.setMethod(solver.getMethod() == PoseSolver::IPPE ? PoseSolver::ITERATIVE
+                                                                            : PoseSolver::IPPE);
+                    solver.reset();
+                }
+            });
+
+        std::cout << "  'v'    - toggle pose extrapolation (pipeline)\n\n";
+        runtime.run("Augmented Reality", 'v');
+        cap.reset();
+        cv::destroyAllWindows();
+        return 0;
+    }
+
+    // GPU wireframe renderer — opened on the first frame when requested
+    GLRenderer renderer;
+
+    // Optional undistortion — frames are remapped once and the tracker then
+    // works with the undistorted camera matrix and zero distortion
+    FrameUndistorter undistorter;
+    undistorter.setCacheDirectory((exeDir / "data" / "cache").string());
+    const cv::Mat calibK = estimator.getCameraMatrix().clone();
+    const cv::Mat calibD = estimator.getDistCoeffs().clone();
+    bool undistort = false;
+
     // Pre-build world points — convention (col, -row, 0)
     std::vector<cv::Vec3f> worldPoints;
     for (int row = 0; row < PoseEstimator::BOARD_HEIGHT; ++row)
@@ -86,8 +215,10 @@ int main(int argc, char* argv[])
 
     while (true)
     {
-        cap >> frame;
-        if (frame.empty()) break;
+        if (!cap->read(frame)) break;
+        if (undistort) undistorter.apply(frame, frame);
+        if (useGL && !renderer.isOpen())
+            useGL = renderer.open("Augmented Reality", frame.size());
 
         /* Tasks 4 + 5: detect, solve pose, draw axes/corners */
         std::vector<cv::Point2f> corners;
@@ -107,12 +238,24 @@ int main(int argc, char* argv[])
                 estimator.projectAxes(frame);
 
             /* Task 6: draw the rocket */
-            if (showRocket)
+            if (showRocket && renderer.isOpen())
+                rocket.draw(renderer,
+                            estimator.getRvec(),
+                            estimator.getTvec(),
+                            estimator.getCameraMatrix(),
+                            estimator.getDistCoeffs());
+            else if (showRocket)
                 rocket.draw(frame,
                             estimator.getRvec(),
                             estimator.getTvec(),
                             estimator.getCameraMatrix(),
                             estimator.getDistCoeffs());
+
+            if (renderer.isOpen() && !mesh.empty())
+            {
+                renderer.setCameraMatrix(estimator.getCameraMatrix());
+                renderer.addMesh(mesh, estimator.getRvec(), estimator.getTvec());
+            }
         }
 
         estimator.overlayStatus(frame, found && estimator.isPoseValid());
@@ -126,15 +269,61 @@ int main(int argc, char* argv[])
                     showRocket ? cv::Scalar(0, 255, 100)
                                : cv::Scalar(100, 100, 100), 1);
 
-        cv::imshow("Augmented Reality", frame);
+        // Undistortion stage timing
+        if (undistort)
+        {
+            std::ostringstream us;
+            us << "Undistort: " << std::fixed << std::setprecision(2)
+               << undistorter.averageMs() << " ms ("
+               << (undistorter.getUseOpenCL() ? "OpenCL" : "CPU") << ")";
+            cv::putText(frame, us.str(), cv::Point(10, frame.rows - 60),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
+        }
+
+        if (renderer.isOpen())
+        {
+            // CPU overlays are part of the background texture
+            renderer.setBackground(frame);
+            renderer.present();
+        }
+        else
+            cv::imshow("Augmented Reality", frame);
 
         char key = static_cast<char>(cv::waitKey(30));
         if (key == 'q' || key == 27) break;
         if (key == 'r') { showRocket = !showRocket; }
         if (key == ' ') { estimator.cycleDisplayMode(); }
+        if (key == 't')
+        {
+            estimator.setTrackingMode(!estimator.getTrackingMode());
+            std::cout << "[Mode] Corner tracking "
+                      << (estimator.getTrackingMode() ? "on" : "off") << "\n";
+        }
+        if (key == 'p')
+        {
+            PoseSolver& solver = estimator.getSolver();
+            solver.setMethod(solver.getMethod() == PoseSolver::IPPE ? PoseSolver::ITERATIVE
+                                                                    : PoseSolver::IPPE);
+            solver.reset();
+            std::cout << "[Mode] Pose solver: "
+                      << PoseSolver::methodName(solver.getMethod()) << "\n";
+        }
+        if (key == 'f') toggleTarget();
+        if (key == 'u')
+        {
+            // Maps are built once, on the first switch to undistorted frames
+            if (!undistorter.isReady())
+                undistorter.initialize(calibK, calibD, frame.size());
+            undistort = !undistort && undistorter.isReady();
+            if (undistort)
+                estimator.setIntrinsics(undistorter.getCameraMatrix(), undistorter.getDistCoeffs());
+            else
+                estimator.setIntrinsics(calibK, calibD);
+            std::cout << "[Mode] Undistortion " << (undistort ? "on" : "off") << "\n";
+        }
     }
 
-    cap.release();
+    cap.reset();
     cv::destroyAllWindows();
     return 0;
 }
@@ -0,0 +1,144 @@
+/*
+ * buildTargetDatabase.cpp - Offline Target Database Builder
+ * Author:      Krushna Sanjay Sharma
+ * Description: Builds a TargetDatabase (.ardb) from a list of flat
+ *              reference images — product packages, posters, covers.
+ *              Features of every target are detected (or taken from its
+ *              compiled .arref), a vocabulary tree is trained over all of
+ *              them, and the result is written as one file that
+ *              multiTargetAR loads to recognise any of the targets.
+ *
+ * Usage:
+ *   buildTargetDatabase.exe <targetList> [backend] [nfeatures] [model] [output]
+ *
+ *   targetList : text file, one target per line:
+ *                  image widthCm heightCm [name]
+ *                image paths relative to the list file; '#' starts a comment;
+ *                name defaults to the image file name without extension
+ *   backend    : sift | orb | akaze | superpoint | cuda-orb (default: sift) — must
+ *                match the backend multiTargetAR runs with
+ *   nfeatures  : features per reference image (default: 300)
+ *   model      : SuperPoint ONNX model (superpoint backend only)
+ *   output     : database file (default: list path with .ardb)
+ *
+ * Date: March 2026
+ */
+
+#include "FeatureBackend.h"
+#include "ReferenceCompiler.h"
+#include "SIFTTracker.h"
+#include "TargetDatabase.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    std::cout << "========================================\n";
+    std::cout << " AR Calibration System\n";
+    std::cout << " Target Database Builder\n";
+    std::cout << "========================================\n\n";
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: buildTargetDatabase <targetList> "
+                     "[backend] [nfeatures] [model] [output]\n";
+        return 1;
+    }
+
+    const std::filesystem::path listPath = argv[1];
+    FeatureBackend::Type backend = FeatureBackend::SIFT;
+    if (argc >= 3 && !FeatureBackend::parseType(argv[2], backend))
+    {
+        std::cerr << "[ERROR] Unknown backend: " << argv[2] << "\n";
+        return 1;
+    }
+    int nfeatures = 300;
+    if (argc >= 4)
+    {
+        try { nfeatures = std::stoi(argv[3]); }
+        catch (...) { std::cerr << "[WARN] Invalid nfeatures, using 300.\n"; }
+    }
+    const std::string modelPath = argc >= 5 ? argv[4] : "";
+    const std::string outPath   = argc >= 6 ? argv[5]
+                                  : std::filesystem::path(listPath).replace_extension(".ardb").string();
+
+    std::ifstream list(listPath);
+    if (!list)
+    {
+        std::cerr << "[ERROR] Cannot open target list: " << listPath.string() << "\n";
+        return 1;
+    }
+
+    cv::Ptr<FeatureBackend> features = FeatureBackend::create(backend, nfeatures, modelPath);
+    if (!features) return 1;
+    backend = features->type();     // CUDA-ORB may have fallen back to ORB
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(
+        SIFTTracker::CLAHE_CLIP, cv::Size(SIFTTracker::CLAHE_TILES, SIFTTracker::CLAHE_TILES));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<DatabaseTarget> targets;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(list, line))
+    {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string image;
+        DatabaseTarget t;
+        if (!(fields >> image)) continue;                     // blank / comment
+        if (!(fields >> t.widthCm >> t.heightCm) || t.widthCm <= 0.0f || t.heightCm <= 0.0f)
+        {
+            std::cerr << "[WARN] Line " << lineNo << ": expected image widthCm heightCm [name]\n";
+            continue;
+        }
+
+        const std::filesystem::path imagePath = listPath.parent_path() / image;
+        if (!(fields >> t.name)) t.name = imagePath.stem().string();
+
+        cv::Mat refGray = cv::imread(imagePath.string(), cv::IMREAD_GRAYSCALE);
+        if (refGray.empty())
+        {
+            std::cerr << "[WARN] Cannot load reference image: " << imagePath.string() << "\n";
+            continue;
+        }
+        t.refSize = refGray.size();
+
+        CompiledReference compiled;
+        if (ReferenceCompiler::loadFor(imagePath.string(), backend, t.refSize, compiled))
+        {
+            t.keypoints   = std::move(compiled.keypoints);
+            t.descriptors = compiled.descriptors;
+        }
+        else
+        {
+            cv::Mat refEnhanced;
+            clahe->apply(refGray, refEnhanced);
+            features->detectAndCompute(refEnhanced, cv::Mat(), t.keypoints, t.descriptors);
+        }
+        if (t.descriptors.empty())
+        {
+            std::cerr << "[WARN] No features on: " << imagePath.string() << "\n";
+            continue;
+        }
+
+        std::cout << "[INFO] Target " << targets.size() << " '" << t.name << "': "
+                  << t.keypoints.size() << " keypoints\n";
+        targets.push_back(std::move(t));
+    }
+
+    TargetDatabase db;
+    if (!db.build(std::move(targets), backend)) return 1;
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - t0).count();
+
+    if (!db.save(outPath)) return 1;
+
+    std::cout << "[INFO] Built in " << static_cast<int>(ms) << " ms\n";
+    std::cout << "[INFO] Saved: " << outPath << "\n";
+    return 0;
+}
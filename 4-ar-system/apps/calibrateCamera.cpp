@@ -8,13 +8,17 @@
  *
  * Usage:
  *   calibrateCamera.exe [cameraId] [outputFile]
+ *   calibrateCamera.exe --images <folder> [outputFile]
  *
  *   cameraId   : optional, webcam index (default: 0)
  *   outputFile : optional, path for calibration XML
  *                (default: data/calibration/calibration.xml)
+ *   --images   : offline mode - calibrate from every image in <folder>,
+ *                detecting corners in parallel on all cores
  *
  * Controls (shown in the live video window):
  *   's'      - Save current frame (only works when green corners are visible)
+ *   'a'      - Toggle auto-collect of views that add coverage
  *   'c'      - Run calibration (requires >= 5 saved frames)
  *   'q'/ESC  - Quit
  *
@@ -43,8 +47,15 @@ int main(int argc, char* argv[])
     int         cameraId   = 0;
     std::string outputFile = (exeDir / "data" / "calibration" / "calibration.xml")
                                 .string();
+    std::string imageFolder;
 
-    if (argc >= 2)
+    if (argc >= 3 && std::string(argv[1]) == "--images")
+    {
+        imageFolder = argv[2];
+        if (argc >= 4)
+            outputFile = argv[3];
+    }
+    else if (argc >= 2)
     {
         try
         {
@@ -57,17 +68,21 @@ int main(int argc, char* argv[])
         }
     }
 
-    if (argc >= 3)
+    if (imageFolder.empty() && argc >= 3)
     {
         outputFile = argv[2];
     }
 
-    std::cout << "Camera ID   : " << cameraId   << "\n";
+    if (imageFolder.empty())
+        std::cout << "Camera ID   : " << cameraId   << "\n";
+    else
+        std::cout << "Image folder: " << imageFolder << "\n";
     std::cout << "Output file : " << outputFile << "\n\n";
 
-    /* Run the calibration pipeline */
+    /* Run the calibration pipeline (live camera or offline folder) */
     CameraCalibration calib(cameraId, outputFile);
-    bool success = calib.run();
+    bool success = imageFolder.empty() ? calib.run()
+                                       : calib.calibrateFromImages(imageFolder);
 
     /* Report result */
     if (success)
@@ -0,0 +1,89 @@
+/*
+ * compileReference.cpp - Offline Reference Compiler
+ * Author:      Krushna Sanjay Sharma
+ * Description: Compiles a flat reference image into a multi-scale,
+ *              multi-viewpoint feature set (ReferenceCompiler) and writes it
+ *              next to the image as <name>.arref. SIFTTracker and
+ *              MultiTargetTracker load that file at startup instead of
+ *              detecting on the reference at a single scale, so matching
+ *              keeps working when the target is far away or tilted.
+ *
+ * Usage:
+ *   compileReference.exe <referenceImage> [backend] [nfeatures] [model] [output]
+ *
+ *   referenceImage : flat photo of the target (e.g. data/bill.jpg)
+ *   backend        : sift | orb | akaze | superpoint | cuda-orb (default: sift) — must
+ *                    match the backend the tracker runs with
+ *   nfeatures      : features per synthetic view (default: 300)
+ *   model          : SuperPoint ONNX model (superpoint backend only)
+ *   output         : compiled file (default: image path with .arref)
+ *
+ * Date: March 2026
+ */
+
+#include "FeatureBackend.h"
+#include "ReferenceCompiler.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    std::cout << "========================================\n";
+    std::cout << " AR Calibration System\n";
+    std::cout << " Reference Compiler\n";
+    std::cout << "========================================\n\n";
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: compileReference <referenceImage> "
+                     "[backend] [nfeatures] [model] [output]\n";
+        return 1;
+    }
+
+    const std::string refPath = argv[1];
+    FeatureBackend::Type backend = FeatureBackend::SIFT;
+    if (argc >= 3 && !FeatureBackend::parseType(argv[2], backend))
+    {
+        std::cerr << "[ERROR] Unknown backend: " << argv[2] << "\n";
+        return 1;
+    }
+    int nfeatures = 300;
+    if (argc >= 4)
+    {
+        try { nfeatures = std::stoi(argv[3]); }
+        catch (...) { std::cerr << "[WARN] Invalid nfeatures, using 300.\n"; }
+    }
+    const std::string modelPath = argc >= 5 ? argv[4] : "";
+    const std::string outPath   = argc >= 6 ? argv[5]
+                                            : ReferenceCompiler::compiledPath(refPath);
+
+    cv::Mat refGray = cv::imread(refPath, cv::IMREAD_GRAYSCALE);
+    if (refGray.empty())
+    {
+        std::cerr << "[ERROR] Cannot load reference image: " << refPath << "\n";
+        return 1;
+    }
+
+    cv::Ptr<FeatureBackend> features = FeatureBackend::create(backend, nfeatures, modelPath);
+    if (!features) return 1;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    CompiledReference compiled;
+    if (!ReferenceCompiler::compile(refGray, *features, compiled))
+    {
+        std::cerr << "[ERROR] No features found on: " << refPath << "\n";
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - t0).count();
+
+    if (!ReferenceCompiler::save(outPath, compiled)) return 1;
+
+    std::cout << "[INFO] Compiled in " << static_cast<int>(ms) << " ms\n";
+    std::cout << "[INFO] Saved: " << outPath << "\n";
+    if (outPath != ReferenceCompiler::compiledPath(refPath))
+        std::cout << "[INFO] Trackers only pick up "
+                  << ReferenceCompiler::compiledPath(refPath) << " automatically.\n";
+    return 0;
+}
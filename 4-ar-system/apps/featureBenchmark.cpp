@@ -0,0 +1,220 @@
+/*
+ * featureBenchmark.cpp - Feature Backend Benchmark
+ * Author:      Krushna Sanjay Sharma
+ * Description: Compares the FeatureBackend implementations on a recorded
+ *              clip of the dollar bill. For every backend it runs the same
+ *              steps as SIFTTracker (CLAHE, detect + describe, k=2 match with
+ *              ratio test, findHomography RANSAC) on each frame and reports:
+ *                - mean detection ms   (detectAndCompute)
+ *                - mean matching ms    (knnMatch + ratio test)
+ *                - inlier ratio        (RANSAC inliers / ratio-test matches)
+ *                - tracked frames      (>= SIFTTracker::MIN_INLIERS inliers)
+ *              The detect + match latency per frame goes to the shared
+ *              harness report (cvcore/benchmark.hpp) with the rest as extra
+ *              numbers, so --json / --compare work as in the other benches.
+ *
+ * Usage:
+ *   featureBenchmark.exe <referenceImage> <clip> [nfeatures] [superpointModel]
+ *                        [harness options]
+ *
+ *   referenceImage  : flat photo of the dollar bill
+ *   clip            : recorded video of the bill
+ *   nfeatures       : features per frame for every backend (default: 300)
+ *   superpointModel : SuperPoint ONNX model; SuperPoint is skipped without it
+ *
+ * Date: March 2026
+ */
+
+#include "FeatureBackend.h"
+#include "SIFTTracker.h"
+#include <cvcore/benchmark.hpp>
+#include <cvcore/capture.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/* Accumulated results for one backend */
+struct BenchResult
+{
+    double detectMs     = 0.0;
+    double matchMs      = 0.0;
+    long   matches      = 0;
+    long   inliers      = 0;
+    int    frames       = 0;
+    int    tracked      = 0;
+    int    refKeypoints = 0;
+    std::vector<double> frameMs;   // detect + match per frame
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+/* runBackend()
+ * Plays the whole clip through one backend. Returns false if the backend or
+ * the clip cannot be opened. */
+static bool runBackend(FeatureBackend& features, const cv::Mat& refGray,
+                       const std::string& clipPath, BenchResult& r)
+{
+    auto cap = cvcore::FrameSource::open(clipPath);
+    if (!cap)
+    {
+        std::cerr << "[ERROR] Cannot open clip: " << clipPath << "\n";
+        return false;
+    }
+
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(2.0, cv::Size(8, 8));
+
+    cv::Mat refEnhanced, refDescriptors;
+    std::vector<cv::KeyPoint> refKeypoints;
+    clahe->apply(refGray, refEnhanced);
+    features.detectAndCompute(refEnhanced, cv::Mat(), refKeypoints, refDescriptors);
+    r.refKeypoints = static_cast<int>(refKeypoints.size());
+    if (refDescriptors.empty()) return true;
+
+    cv::Ptr<cv::DescriptorMatcher> matcher = cv::BFMatcher::create(features.normType());
+    matcher->add(std::vector<cv::Mat>{ refDescriptors });
+    matcher->train();
+
+    const float ratio = features.isBinary() ? SIFTTracker::BINARY_RATIO_THRESHOLD
+                                            : SIFTTracker::RATIO_THRESHOLD;
+
+    cv::Mat frame, gray, enhanced;
+    while (cap->read(frame))
+    {
+        ++r.frames;
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        clahe->apply(gray, enhanced);
+
+        std::vector<cv::KeyPoint> keypoints;
+        cv::Mat descriptors;
+        auto t0 = std::chrono::steady_clock::now();
+        features.detectAndCompute(enhanced, cv::Mat(), keypoints, descriptors);
+        const double detectMs = elapsedMs(t0);
+        r.detectMs += detectMs;
+        if (descriptors.empty())
+        {
+            r.frameMs.push_back(detectMs);
+            continue;
+        }
+
+        t0 = std::chrono::steady_clock::now();
+        std::vector<std::vector<cv::DMatch>> knnMatches;
+        matcher->knnMatch(descriptors, knnMatches, 2);
+        std::vector<cv::Point2f> refPts, livePts;
+        for (const auto& m : knnMatches)
+        {
+            if (m.size() == 2 && m[0].distance < ratio * m[1].distance)
+            {
+                refPts.push_back(refKeypoints[m[0].trainIdx].pt);
+                livePts.push_back(keypoints[m[0].queryIdx].pt);
+            }
+        }
+        const double matchMs = elapsedMs(t0);
+        r.matchMs += matchMs;
+        r.frameMs.push_back(detectMs + matchMs);
+        r.matches += static_cast<long>(refPts.size());
+
+        if (static_cast<int>(refPts.size()) < SIFTTracker::MIN_INLIERS) continue;
+        cv::Mat inlierMask;
+        cv::Mat H = cv::findHomography(refPts, livePts, cv::RANSAC, 5.0, inlierMask);
+        if (H.empty()) continue;
+
+        const int inliers = cv::countNonZero(inlierMask);
+        r.inliers += inliers;
+        if (inliers >= SIFTTracker::MIN_INLIERS) ++r.tracked;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::cout << "========================================\n";
+    std::cout << " AR Calibration System\n";
+    std::cout << " Feature Backend Benchmark\n";
+    std::cout << "========================================\n\n";
+
+    /* Harness options anywhere, the rest positional */
+    cvcore::BenchOptions options;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i)
+        if (!options.consume(i, argc, argv)) args.push_back(argv[i]);
+
+    if (args.size() < 2)
+    {
+        std::cerr << "Usage: featureBenchmark <referenceImage> <clip> "
+                     "[nfeatures] [superpointModel] [harness options]\n"
+                  << cvcore::BenchOptions::usage();
+        return 1;
+    }
+
+    const std::string refPath  = args[0];
+    const std::string clipPath = args[1];
+    int nfeatures = 300;
+    if (args.size() >= 3)
+    {
+        try { nfeatures = std::stoi(args[2]); }
+        catch (...) { std::cerr << "[WARN] Invalid nfeatures, using 300.\n"; }
+    }
+    const std::string modelPath = args.size() >= 4 ? args[3] : "";
+
+    cv::Mat refGray = cv::imread(refPath, cv::IMREAD_GRAYSCALE);
+    if (refGray.empty())
+    {
+        std::cerr << "[ERROR] Cannot load reference image: " << refPath << "\n";
+        return 1;
+    }
+
+    cvcore::BenchSuite suite("featureBenchmark", options);
+    suite.printEnvironment(std::cout);
+    std::cout << "\n";
+
+    std::cout << std::left  << std::setw(12) << "Backend"
+              << std::right << std::setw(8)  << "RefKP"
+              << std::setw(12) << "Detect ms" << std::setw(12) << "Match ms"
+              << std::setw(10) << "Matches"   << std::setw(10) << "Inlier%"
+              << std::setw(12) << "Tracked" << "\n";
+
+    for (int t = 0; t < FeatureBackend::TYPE_COUNT; ++t)
+    {
+        const auto type = static_cast<FeatureBackend::Type>(t);
+        if (type == FeatureBackend::SUPERPOINT && modelPath.empty()) continue;
+        if (type == FeatureBackend::CUDA_ORB && !FeatureBackend::cudaAvailable()) continue;
+        if (!suite.selected(FeatureBackend::typeName(type))) continue;
+
+        cv::Ptr<FeatureBackend> features = FeatureBackend::create(type, nfeatures, modelPath);
+        BenchResult r;
+        if (!features || !runBackend(*features, refGray, clipPath, r)) continue;
+
+        const double n = std::max(r.frames, 1);
+        std::ostringstream tracked;
+        tracked << r.tracked << "/" << r.frames;
+        std::cout << std::left  << std::setw(12) << FeatureBackend::typeName(type)
+                  << std::right << std::setw(8)  << r.refKeypoints
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << r.detectMs / n
+                  << std::setw(12) << r.matchMs / n
+                  << std::setprecision(1)
+                  << std::setw(10) << r.matches / n
+                  << std::setw(10) << (r.matches ? 100.0 * r.inliers / r.matches : 0.0)
+                  << std::setw(12) << tracked.str() << "\n";
+
+        cvcore::BenchResult& out = suite.addSamples(FeatureBackend::typeName(type),
+                                                    r.frameMs, 1.0, "frame");
+        out.extra["nfeatures"]     = nfeatures;
+        out.extra["ref_keypoints"] = r.refKeypoints;
+        out.extra["detect_ms"]     = r.detectMs / n;
+        out.extra["match_ms"]      = r.matchMs / n;
+        out.extra["matches"]       = r.matches / n;
+        out.extra["inlier_ratio"]  = r.matches ? static_cast<double>(r.inliers) / r.matches : 0.0;
+        out.extra["frames"]        = r.frames;
+        out.extra["tracked"]       = r.tracked;
+    }
+
+    return suite.finish() ? 0 : 1;
+}
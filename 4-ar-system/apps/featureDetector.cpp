@@ -7,14 +7,17 @@
  *              Circle size shows feature scale, line shows orientation.
  *
  * Usage:
- *   featureDetector.exe [cameraId] [maxFeatures] [contrastThreshold]
+ *   featureDetector.exe [cameraId] [maxFeatures] [contrastThreshold] [backend] [model]
  *
  *   cameraId          : webcam index (default: 0)
- *   maxFeatures       : max SIFT features (default: 500, 0 = unlimited)
+ *   maxFeatures       : max features (default: 500, 0 = unlimited)
  *   contrastThreshold : SIFT sensitivity (default: 0.04, lower = more features)
+ *   backend           : sift | orb | akaze | superpoint | cuda-orb (default: sift)
+ *   model             : SuperPoint ONNX model (superpoint backend only)
  *
  * Controls:
  *   Trackbar  - drag to adjust max features in real time
+ *   'b'       - cycle feature backend
  *   'q' / ESC - quit
  *
  * Date: March 2026
@@ -51,13 +54,20 @@ int main(int argc, char* argv[])
         catch (...) { std::cerr << "[WARN] Invalid contrastThreshold, using 0.04\n"; }
     }
 
+    FeatureBackend::Type backend = FeatureBackend::SIFT;
+    if (argc >= 5 && !FeatureBackend::parseType(argv[4], backend))
+        std::cerr << "[WARN] Unknown backend '" << argv[4] << "', using SIFT\n";
+    std::string modelPath = argc >= 6 ? argv[5] : "";
+
     std::cout << "Camera ID           : " << cameraId          << "\n";
     std::cout << "Max features        : " << maxFeatures        << "\n";
-    std::cout << "Contrast threshold  : " << contrastThreshold  << "\n\n";
+    std::cout << "Contrast threshold  : " << contrastThreshold  << "\n";
+    std::cout << "Backend             : " << FeatureBackend::typeName(backend) << "\n\n";
     std::cout << "Point camera at a dollar bill or any richly textured pattern.\n";
     std::cout << "Drag the trackbar to control how many features are shown.\n\n";
 
-    FeatureDetector detector(cameraId, maxFeatures, contrastThreshold);
+    FeatureDetector detector(cameraId, maxFeatures, contrastThreshold,
+                             backend, modelPath);
 
     if (!detector.run())
     {
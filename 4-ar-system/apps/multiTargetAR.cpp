@@ -3,31 +3,58 @@
  * Author:      Krushna Sanjay Sharma
  * Description: Tracks two targets simultaneously in the same scene:
  *              1. Chessboard → 3D Rocket  (PoseEstimator + VirtualObject)
- *              2. Dollar bill → 3D Eagle  (SIFTTracker + VirtualEagleObject)
+ *              2. Dollar bill → 3D Eagle  (MultiTargetTracker + VirtualEagleObject)
+ *              3. Optional extra flat targets → 3D axes (MultiTargetTracker)
  *
- *              Both targets are always active. Place chessboard and dollar
+ *              All targets are always active. Place chessboard and dollar
  *              bill in the same camera view to see both AR objects at once.
+ *              The frame is converted to grayscale once (a
+ *              cvcore::FrameContext) and shared by both trackers, with
+ *              its CLAHE; the textured targets share one detection pass and
+ *              one combined reference index.
  *
  * Extension:   Multiple targets in the scene
  *
  * Usage:
- *   multiTargetAR.exe [calibrationFile] [billImage] [cameraId]
+ *   multiTargetAR.exe [calibrationFile] [billImage] [cameraId] [backend] [model]
+ *                     [image:widthCm:heightCm ...] [targets.ardb] [--gl] [--pipeline]
+ *
+ *   Every argument after model registers another flat target, e.g.
+ *   data/poster.jpg:42:29.7 for an A3 poster.
+ *   A .ardb file (buildTargetDatabase) adds all of its targets; each frame
+ *   then retrieves the few likely ones by vocabulary tree and matches
+ *   only those (bill and image:w:h targets are still matched every frame).
+ *   --gl draws rocket and eagle with the OpenGL renderer (AR_WITH_OPENGL).
+ *   --pipeline runs capture / tracking / render on separate threads
+ *   (ARRuntime): objects follow the extrapolated poses at camera rate,
+ *   'v' toggles extrapolation (no debug overlay, CPU drawing only).
  *
  * Controls:
  *   'r'     - toggle rocket visibility (chessboard)
  *   'e'     - toggle eagle visibility  (dollar bill)
- *   'd'     - toggle SIFT debug keypoints
+ *   'd'     - toggle feature debug overlay (inliers + outlines)
  *   SPACE   - cycle chessboard display mode (axes/corners/both)
+ *   'u'     - toggle frame undistortion (precomputed maps)
  *   'q'/ESC - quit
  *
  * Date: March 2026
  */
 
+#include "ARRuntime.h"
+#include "FrameUndistorter.h"
+#include "GLRenderer.h"
 #include "PoseEstimator.h"
+#include "MultiTargetTracker.h"
 #include "SIFTTracker.h"
 #include "VirtualObject.h"
 #include "VirtualEagleObject.h"
+#include <cvcore/assetLoader.hpp>
+#include <cvcore/matPool.hpp>
+#include <atomic>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <filesystem>
 
@@ -40,6 +67,11 @@ int main(int argc, char* argv[])
     std::cout << "   Dollar bill  → Eagle\n";
     std::cout << "========================================\n\n";
 
+    const bool pipelined = ARRuntime::takeFlag(argc, argv, "--pipeline");
+
+    // Frame-sized Mats come from a huge-page pool instead of fresh mappings
+    cvcore::installMatPool();
+
     /* Resolve paths */
     std::filesystem::path exeDir =
         std::filesystem::path(argv[0]).parent_path();
@@ -58,9 +90,16 @@ int main(int argc, char* argv[])
         catch (...) { std::cerr << "[WARN] Invalid camera ID, using 0.\n"; }
     }
 
+    // Per-target feature backend (default SIFT)
+    FeatureBackend::Type backend = FeatureBackend::SIFT;
+    if (argc >= 5 && !FeatureBackend::parseType(argv[4], backend))
+        std::cerr << "[WARN] Unknown backend '" << argv[4] << "', using SIFT.\n";
+    std::string modelPath = argc >= 6 ? argv[5] : "";
+
     std::cout << "Calibration : " << calibFile << "\n";
     std::cout << "Bill image  : " << billImage  << "\n";
-    std::cout << "Camera ID   : " << cameraId   << "\n\n";
+    std::cout << "Camera ID   : " << cameraId   << "\n";
+    std::cout << "Backend     : " << FeatureBackend::typeName(backend) << "\n\n";
 
     /* Target 1: Chessboard tracker */
     PoseEstimator chessTracker(calibFile, cameraId);
@@ -74,15 +113,69 @@ int main(int argc, char* argv[])
     VirtualObject rocket;
     rocket.buildRocket();
 
-    /* Target 2: Dollar bill tracker */
-    SIFTTracker billTracker(calibFile, billImage, 300);
-    if (!billTracker.initialize())
+    /* Targets 2+: dollar bill and any extra flat targets — one detection
+     * pass per frame for all of them */
+    // Reference features and undistortion maps survive restarts here
+    const std::string cacheDir = (exeDir / "data" / "cache").string();
+
+    bool useGL = false;
+    std::vector<std::string> targetArgs;
+    for (int i = 6; i < argc; ++i)
     {
-        std::cerr << "[FAILED] Cannot initialize bill tracker.\n";
-        std::cerr << "         Ensure bill.jpg exists at: " << billImage << "\n";
-        return 1;
+        if (std::string(argv[i]) == "--gl") { useGL = true; continue; }
+        targetArgs.push_back(argv[i]);
     }
 
+    /* Reference features (or their cache) and target databases are loaded
+     * on a background thread while the camera opens; the chessboard is
+     * tracked from the first frame, the flat targets once they are ready */
+    constexpr int billId = 0;   // first target added
+    cvcore::Asset<MultiTargetTracker> featureLoad;
+    featureLoad.start("Feature targets", [=]
+    {
+        auto featureTracker = std::make_unique<MultiTargetTracker>(calibFile, 300, backend, modelPath);
+        featureTracker->setCacheDirectory(cacheDir);
+        featureTracker->addTarget("bill", billImage,
+                                  SIFTTracker::BILL_WIDTH_CM, SIFTTracker::BILL_HEIGHT_CM);
+        for (const std::string& arg : targetArgs)
+        {
+            if (arg.size() > 5 && arg.compare(arg.size() - 5, 5, ".ardb") == 0)
+            {
+                if (!featureTracker->loadDatabase(arg))
+                    std::cerr << "[WARN] Ignoring target database '" << arg << "'.\n";
+                continue;
+            }
+
+            // image:widthCm:heightCm — split from the right so drive letters survive
+            const std::string& spec = arg;
+            const size_t h = spec.rfind(':');
+            const size_t w = h == std::string::npos ? h : spec.rfind(':', h - 1);
+            try
+            {
+                if (w == std::string::npos) throw std::invalid_argument(spec);
+                const std::string image = spec.substr(0, w);
+                featureTracker->addTarget(std::filesystem::path(image).stem().string(), image,
+                                          std::stof(spec.substr(w + 1, h - w - 1)),
+                                          std::stof(spec.substr(h + 1)));
+            }
+            catch (...)
+            {
+                std::cerr << "[WARN] Ignoring target '" << spec
+                          << "' (expected image:widthCm:heightCm).\n";
+            }
+        }
+
+        if (!featureTracker->initialize()) featureTracker.reset();
+        return featureTracker;
+    });
+    auto loadFailed = [&]()
+    {
+        if (!featureLoad.failed()) return false;
+        std::cerr << "[FAILED] Cannot initialize feature targets.\n";
+        std::cerr << "         Ensure bill.jpg exists at: " << billImage << "\n";
+        return true;
+    };
+
     /* Eagle on dollar bill
      * scale=1.2: wingspan ~7cm — fits inside bill without covering it
      * Z offset=2.0cm: floats visibly above bill surface */
@@ -95,8 +188,8 @@ int main(int argc, char* argv[])
     );
 
     /* Open webcam */
-    cv::VideoCapture cap(cameraId);
-    if (!cap.isOpened())
+    auto cap = cvcore::FrameSource::open("", cameraId);
+    if (!cap)
     {
         std::cerr << "[FAILED] Cannot open camera " << cameraId << "\n";
         return 1;
@@ -107,27 +200,147 @@ int main(int argc, char* argv[])
     bool showEagle  = true;
     bool showDebug  = false;
 
+    // GPU wireframe renderer — opened on the first frame when requested
+    GLRenderer renderer;
+
+    // Optional undistortion — frames are remapped once and the tracker then
+    // works with the undistorted camera matrix and zero distortion
+    FrameUndistorter undistorter;
+    undistorter.setCacheDirectory(cacheDir);
+    const cv::Mat calibK = chessTracker.getCameraMatrix().clone();
+    const cv::Mat calibD = chessTracker.getDistCoeffs().clone();
+    bool undistort = false;
+
+    // Per-frame grayscale / CLAHE cache, used only by the tracking thread
+    cvcore::FrameContext trackContext;
+
     std::cout << "Controls:\n";
     std::cout << "  'r'     - toggle rocket  (chessboard)\n";
     std::cout << "  'e'     - toggle eagle   (dollar bill)\n";
-    std::cout << "  'd'     - toggle SIFT debug keypoints\n";
+    std::cout << "  'd'     - toggle feature debug overlay\n";
     std::cout << "  SPACE   - cycle chessboard axes/corners mode\n";
+    std::cout << "  'u'     - toggle frame undistortion\n";
     std::cout << "  'q'/ESC - quit\n\n";
     std::cout << "Place chessboard AND dollar bill in view simultaneously.\n\n";
 
+    /* --pipeline: both trackers run on the tracking thread. Pose 0 is the
+     * chessboard, pose 1 + id the feature target id. */
+    if (pipelined)
+    {
+        std::atomic<bool> rocketOn(true), eagleOn(true);
+        ARRuntime runtime(*cap,
+            [&](const cv::Mat& image, ARTrackResult& result)
+            {
+                // Grayscale and CLAHE shared by both trackers
+                trackContext.reset(image);
+
+                std::vector<cv::Point2f> corners;
+                ARPose chess;
+                chess.valid = chessTracker.detectCorners(trackContext, corners) &&
+                              chessTracker.estimatePose(corners);
+                if (chess.valid)
+                {
+                    chess.rvec = chessTracker.getRvec().clone();
+                    chess.tvec = chessTracker.getTvec().clone();
+                }
+                result.poses.push_back(chess);
+                result.status.push_back(chess.valid ? "Chess: tracked" : "Chess: searching...");
+
+                MultiTargetTracker* featureTracker = featureLoad.get();
+                if (!featureTracker)
+                {
+                    result.status.push_back(featureLoad.status());
+                    result.cameraMatrix = chessTracker.getCameraMatrix();
+                    result.distCoeffs   = chessTracker.getDistCoeffs();
+                    return;
+                }
+                featureTracker->track(trackContext);
+                for (int id = 0; id < featureTracker->targetCount(); ++id)
+                {
+                    ARPose pose;
+                    pose.valid = featureTracker->isTracking(id);
+                    if (pose.valid)
+                    {
+                        pose.rvec = featureTracker->getRvec(id).clone();
+                        pose.tvec = featureTracker->getTvec(id).clone();
+                    }
+                    result.poses.push_back(pose);
+                }
+                result.status.push_back(featureTracker->isTracking(billId)
+                    ? "Bill:  tracked (" + std::to_string(featureTracker->getInlierCount(billId)) + " inliers)"
+                    : std::string("Bill:  searching..."));
+
+                result.cameraMatrix = featureTracker->getCameraMatrix();
+                result.distCoeffs   = featureTracker->getDistCoeffs();
+            },
+            [&](cv::Mat& display, const ARTrackResult& result)
+            {
+                const ARPose& chess = result.poses[0];
+                if (chess.valid && rocketOn)
+                    rocket.draw(display, chess.rvec, chess.tvec,
+                                result.cameraMatrix, result.distCoeffs);
+
+                for (int id = 0; id + 1 < static_cast<int>(result.poses.size()); ++id)
+                {
+                    const ARPose& pose = result.poses[id + 1];
+                    if (!pose.valid) continue;
+                    if (id == billId)
+                    {
+                        if (eagleOn)
+                            eagle.draw(display, pose.rvec, pose.tvec,
+                                       result.cameraMatrix, result.distCoeffs);
+                    }
+                    else
+                        cv::drawFrameAxes(display, result.cameraMatrix, result.distCoeffs,
+                                          pose.rvec, pose.tvec, 3.0f);
+                }
+            },
+            [&](int key)
+            {
+                if (key == 'r') rocketOn = !rocketOn;
+                if (key == 'e') eagleOn  = !eagleOn;
+            });
+
+        std::cout << "  'v'     - toggle pose extrapolation (pipeline)\n\n";
+        runtime.run("Multi-Target AR", 'v');
+        cap.reset();
+        cv::destroyAllWindows();
+        return loadFailed() ? 1 : 0;
+    }
+
     cv::Mat frame;
+    bool featuresReady = false;
+    int exitCode = 0;
 
     while (true)
     {
-        cap >> frame;
-        if (frame.empty()) break;
+        if (!cap->read(frame)) break;
+        if (loadFailed())
+        {
+            exitCode = 1;
+            break;
+        }
+        MultiTargetTracker* featureTracker = featureLoad.get();
+        if (featureTracker && !featuresReady)
+        {
+            // Undistortion may have been switched on while the targets loaded
+            featuresReady = true;
+            if (undistort)
+                featureTracker->setIntrinsics(undistorter.getCameraMatrix(), undistorter.getDistCoeffs());
+        }
+        if (undistort) undistorter.apply(frame, frame);
+        if (useGL && !renderer.isOpen())
+            useGL = renderer.open("Multi-Target AR", frame.size());
 
         cv::Mat display = frame.clone();
 
+        // Grayscale and CLAHE shared by both trackers
+        trackContext.reset(frame);
+
         /* Target 1: Chessboard → Rocket */
         {
             std::vector<cv::Point2f> corners;
-            bool found = chessTracker.detectCorners(frame, corners);
+            bool found = chessTracker.detectCorners(trackContext, corners);
 
             if (found && chessTracker.estimatePose(corners))
             {
@@ -141,7 +354,13 @@ int main(int argc, char* argv[])
                     chessTracker.projectAxes(display);
 
                 // Rocket
-                if (showRocket)
+                if (showRocket && renderer.isOpen())
+                    rocket.draw(renderer,
+                                chessTracker.getRvec(),
+                                chessTracker.getTvec(),
+                                chessTracker.getCameraMatrix(),
+                                chessTracker.getDistCoeffs());
+                else if (showRocket)
                     rocket.draw(display,
                                 chessTracker.getRvec(),
                                 chessTracker.getTvec(),
@@ -162,25 +381,47 @@ int main(int argc, char* argv[])
                         cv::FONT_HERSHEY_SIMPLEX, 0.6, col, 1);
         }
 
-        /* Target 2: Dollar bill → Eagle */
+        /* Targets 2+: Dollar bill → Eagle, extra targets → axes */
         {
-            bool tracked = billTracker.track(frame);
+            bool tracked = false;
+            if (featureTracker)
+            {
+                featureTracker->track(trackContext);
+                tracked = featureTracker->isTracking(billId);
+
+                if (showDebug)
+                    featureTracker->drawDebug(display);
 
-            if (showDebug)
-                billTracker.drawDebug(display);
+                if (tracked && showEagle && renderer.isOpen())
+                    eagle.draw(renderer,
+                               featureTracker->getRvec(billId),
+                               featureTracker->getTvec(billId),
+                               featureTracker->getCameraMatrix(),
+                               featureTracker->getDistCoeffs());
+                else if (tracked && showEagle)
+                    eagle.draw(display,
+                               featureTracker->getRvec(billId),
+                               featureTracker->getTvec(billId),
+                               featureTracker->getCameraMatrix(),
+                               featureTracker->getDistCoeffs());
 
-            if (tracked && showEagle)
-                eagle.draw(display,
-                           billTracker.getRvec(),
-                           billTracker.getTvec(),
-                           billTracker.getCameraMatrix(),
-                           billTracker.getDistCoeffs());
+                for (int id = 0; id < featureTracker->targetCount(); ++id)
+                {
+                    if (id == billId || !featureTracker->isTracking(id)) continue;
+                    cv::drawFrameAxes(display,
+                                      featureTracker->getCameraMatrix(),
+                                      featureTracker->getDistCoeffs(),
+                                      featureTracker->getRvec(id),
+                                      featureTracker->getTvec(id), 3.0f);
+                }
+            }
 
             // Status below chess status
             cv::Scalar col = tracked
                 ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 165, 255);
-            std::string billStr = tracked
-                ? "Bill:  tracked (" + std::to_string(billTracker.getInlierCount()) + " inliers)"
+            std::string billStr = !featureTracker ? featureLoad.status()
+                : tracked
+                ? "Bill:  tracked (" + std::to_string(featureTracker->getInlierCount(billId)) + " inliers)"
                 : "Bill:  searching...";
             cv::putText(display, billStr, cv::Point(10, 54),
                         cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0,0,0), 3);
@@ -196,7 +437,25 @@ int main(int argc, char* argv[])
                     cv::FONT_HERSHEY_SIMPLEX, 0.45,
                     cv::Scalar(180, 180, 180), 1);
 
-        cv::imshow("Multi-Target AR", display);
+        // Undistortion stage timing
+        if (undistort)
+        {
+            std::ostringstream us;
+            us << "Undistort: " << std::fixed << std::setprecision(2)
+               << undistorter.averageMs() << " ms ("
+               << (undistorter.getUseOpenCL() ? "OpenCL" : "CPU") << ")";
+            cv::putText(display, us.str(), cv::Point(10, display.rows - 35),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
+        }
+
+        if (renderer.isOpen())
+        {
+            // CPU overlays are part of the background texture
+            renderer.setBackground(display);
+            renderer.present();
+        }
+        else
+            cv::imshow("Multi-Target AR", display);
 
         /* Keys */
         char key = static_cast<char>(cv::waitKey(30));
@@ -205,9 +464,29 @@ int main(int argc, char* argv[])
         if (key == 'e') { showEagle  = !showEagle;  }
         if (key == 'd') { showDebug  = !showDebug;  }
         if (key == ' ') { chessTracker.cycleDisplayMode(); }
+        if (key == 'u')
+        {
+            // Maps are built once, on the first switch to undistorted frames
+            if (!undistorter.isReady())
+                undistorter.initialize(calibK, calibD, frame.size());
+            undistort = !undistort && undistorter.isReady();
+            if (undistort)
+            {
+                chessTracker.setIntrinsics(undistorter.getCameraMatrix(), undistorter.getDistCoeffs());
+                if (featureTracker)
+                    featureTracker->setIntrinsics(undistorter.getCameraMatrix(), undistorter.getDistCoeffs());
+            }
+            else
+            {
+                chessTracker.setIntrinsics(calibK, calibD);
+                if (featureTracker)
+                    featureTracker->setIntrinsics(calibK, calibD);
+            }
+            std::cout << "[Mode] Undistortion " << (undistort ? "on" : "off") << "\n";
+        }
     }
 
-    cap.release();
+    cap.reset();
     cv::destroyAllWindows();
-    return 0;
+    return exitCode;
 }
@@ -7,15 +7,31 @@
  *              from Tasks 1-3 and the same rocket VirtualObject from Task 6.
  *
  * Usage:
- *   siftAR.exe [calibrationFile] [referenceImage] [cameraId]
+ *   siftAR.exe [calibrationFile] [referenceImage] [cameraId] [backend] [model]
+ *              [--pipeline]
  *
  *   calibrationFile : path to calibration XML (default: exe-relative path)
  *   referenceImage  : flat photo of the dollar bill (default: data/bill.jpg)
  *   cameraId        : webcam index (default: 0)
+ *   backend         : sift | orb | akaze | superpoint | cuda-orb (default: sift)
+ *   model           : SuperPoint ONNX model (superpoint backend only)
+ *   --pipeline      : capture / tracking / render threads (ARRuntime); the
+ *                     rocket follows the extrapolated pose at camera rate,
+ *                     'v' toggles extrapolation (no debug overlay)
  *
  * Controls:
  *   'r'     - toggle rocket on/off
  *   'd'     - toggle debug overlay (inlier keypoints)
+ *   'm'     - cycle matcher (brute force / FLANN KD-forest / OpenCL brute force)
+ *   'x'     - toggle match cross-check
+ *   'o'     - toggle optical-flow tracking between SIFT detections
+ *   'w'     - toggle predicted-window (ROI) SIFT detection
+ *   'g'     - toggle guided matching (predicted homography) while tracking
+ *   'k'     - toggle keyframe relocalisation after tracking loss
+ *   'e'     - cycle outlier rejection (RANSAC / PROSAC / MAGSAC++ / PnP RANSAC)
+ *   's'     - toggle half-resolution SIFT detection
+ *   'l'     - cycle detection latency budget (off / 30 / 20 / 12 ms)
+ *   'u'     - toggle frame undistortion (precomputed maps)
  *   'q'/ESC - quit
  *
  * How to prepare the reference image:
@@ -27,12 +43,30 @@
  * Date: March 2026
  */
 
+#include "ARRuntime.h"
+#include "FrameUndistorter.h"
 #include "SIFTTracker.h"
 #include "VirtualObject.h"
+#include <cvcore/allocTracking.hpp>
+#include <cvcore/assetLoader.hpp>
+#include <cvcore/matPool.hpp>
+#include <cvcore/metrics.hpp>
+#include <atomic>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <filesystem>
 
+/* nextLatencyBudget() - 'l' key: off → 30 → 20 → 12 ms → off */
+static double nextLatencyBudget(double current)
+{
+    if (current <= 0.0)  return 30.0;
+    if (current > 20.0)  return 20.0;
+    if (current > 12.0)  return 12.0;
+    return 0.0;
+}
+
 int main(int argc, char* argv[])
 {
     std::cout << "========================================\n";
@@ -40,6 +74,11 @@ int main(int argc, char* argv[])
     std::cout << " SIFT AR App (Uber Extension 2)\n";
     std::cout << "========================================\n\n";
 
+    const bool pipelined = ARRuntime::takeFlag(argc, argv, "--pipeline");
+
+    // Frame-sized Mats come from a huge-page pool instead of fresh mappings
+    cvcore::installMatPool();
+
     /* Resolve default paths relative to executable */
     std::filesystem::path exeDir =
         std::filesystem::path(argv[0]).parent_path();
@@ -58,17 +97,38 @@ int main(int argc, char* argv[])
         catch (...) { std::cerr << "[WARN] Invalid camera ID, using 0.\n"; }
     }
 
+    // Per-target feature backend (default SIFT)
+    FeatureBackend::Type backend = FeatureBackend::SIFT;
+    if (argc >= 5 && !FeatureBackend::parseType(argv[4], backend))
+        std::cerr << "[WARN] Unknown backend '" << argv[4] << "', using SIFT.\n";
+    std::string modelPath = argc >= 6 ? argv[5] : "";
+
     std::cout << "Calibration : " << calibFile << "\n";
     std::cout << "Reference   : " << refImage  << "\n";
-    std::cout << "Camera ID   : " << cameraId  << "\n\n";
+    std::cout << "Camera ID   : " << cameraId  << "\n";
+    std::cout << "Backend     : " << FeatureBackend::typeName(backend) << "\n\n";
 
-    SIFTTracker tracker(calibFile, refImage, 300);
-    if (!tracker.initialize())
+    // Reference features and undistortion maps survive restarts here
+    const std::string cacheDir = (exeDir / "data" / "cache").string();
+
+    /* Reference features are computed (or read from the cache) on a
+     * background thread while the camera opens; the feed is shown at once
+     * and tracking starts when the tracker is ready */
+    cvcore::Asset<SIFTTracker> trackerLoad;
+    trackerLoad.start("Reference features", [=]
+    {
+        auto tracker = std::make_unique<SIFTTracker>(calibFile, refImage, 300, backend, modelPath);
+        tracker->setCacheDirectory(cacheDir);
+        if (!tracker->initialize()) tracker.reset();
+        return tracker;
+    });
+    auto loadFailed = [&]()
     {
+        if (!trackerLoad.failed()) return false;
         std::cerr << "[FAILED] Tracker initialization failed.\n";
         std::cerr << "Make sure bill.jpg exists at: " << refImage << "\n";
-        return 1;
-    }
+        return true;
+    };
 
     /* Build rocket for dollar bill
      * Bill: X right (0-15.6cm), Y down (0-6.6cm).
@@ -84,8 +144,8 @@ int main(int argc, char* argv[])
     );
 
     /* Open webcam */
-    cv::VideoCapture cap(cameraId);
-    if (!cap.isOpened())
+    auto cap = cvcore::FrameSource::open("", cameraId);
+    if (!cap)
     {
         std::cerr << "[FAILED] Cannot open camera " << cameraId << "\n";
         return 1;
@@ -94,35 +154,140 @@ int main(int argc, char* argv[])
     std::cout << "Controls:\n";
     std::cout << "  'r' - toggle rocket on/off\n";
     std::cout << "  'd' - toggle debug keypoints\n";
+    std::cout << "  'u' - toggle frame undistortion\n";
     std::cout << "  'q'/ESC - quit\n\n";
     std::cout << "Point camera at the dollar bill reference image.\n\n";
 
     bool showRocket = true;
     bool showDebug  = true;
+
+    /* --pipeline: SIFT runs on the tracking thread; the render thread draws
+     * every camera frame with the newest (extrapolated) bill pose */
+    if (pipelined)
+    {
+        std::atomic<bool> rocketOn(true);
+        ARRuntime runtime(*cap,
+            [&](const cv::Mat& image, ARTrackResult& result)
+            {
+                ARPose pose;
+                SIFTTracker* tracker = trackerLoad.get();
+                if (!tracker)
+                {
+                    result.poses.push_back(pose);
+                    result.status.push_back(trackerLoad.status());
+                    return;
+                }
+                pose.valid = tracker->track(image);
+                if (pose.valid)
+                {
+                    pose.rvec = tracker->getRvec().clone();
+                    pose.tvec = tracker->getTvec().clone();
+                }
+                result.poses.push_back(pose);
+                result.cameraMatrix = tracker->getCameraMatrix();
+                result.distCoeffs   = tracker->getDistCoeffs();
+                result.status.push_back(!pose.valid ? std::string("Bill: searching...")
+                    : "Bill: tracked (" + std::to_string(tracker->getInlierCount()) + " inliers"
+                      + (tracker->isFlowFrame() ? ", flow)" : ")"));
+            },
+            [&](cv::Mat& display, const ARTrackResult& result)
+            {
+                const ARPose& pose = result.poses[0];
+                if (pose.valid && rocketOn)
+                    rocket.draw(display, pose.rvec, pose.tvec,
+                                result.cameraMatrix, result.distCoeffs);
+            },
+            [&](int key)
+            {
+                if (key == 'r') rocketOn = !rocketOn;
+                SIFTTracker* tracker = trackerLoad.get();
+                if (!tracker) return;
+                if (key == 'm') tracker->cycleMatcher();
+                if (key == 'x') tracker->setCrossCheck(!tracker->getCrossCheck());
+                if (key == 'o') tracker->setOpticalFlow(!tracker->getOpticalFlow());
+                if (key == 'w') tracker->setRoiDetection(!tracker->getRoiDetection());
+                if (key == 'g') tracker->setGuidedMatching(!tracker->getGuidedMatching());
+                if (key == 'k') tracker->setRelocalisation(!tracker->getRelocalisation());
+                if (key == 'e') tracker->cycleRobustMethod();
+                if (key == 's') tracker->setDetectScale(tracker->getDetectScale() < 1.0 ? 1.0 : 0.5);
+                if (key == 'l') tracker->setLatencyBudget(nextLatencyBudget(tracker->getLatencyBudget()));
+            });
+
+        std::cout << "  'v' - toggle pose extrapolation (pipeline)\n\n";
+        runtime.run("SIFT AR - Dollar Bill", 'v');
+        cap.reset();
+        cv::destroyAllWindows();
+        return loadFailed() ? 1 : 0;
+    }
+
+    // Optional undistortion — frames are remapped once and the tracker then
+    // works with the undistorted camera matrix and zero distortion
+    FrameUndistorter undistorter;
+    undistorter.setCacheDirectory(cacheDir);
+    cv::Mat calibK, calibD;      // taken from the tracker once it is ready
+    bool undistort = false;
     cv::Mat frame;
+    int exitCode = 0;
+
+    // Allocations per tracked frame (CVCORE_ALLOC_TRACKING builds), shown
+    // with the debug overlay and exported with the metrics
+    cvcore::AllocStage& trackAllocs = cvcore::AllocStage::get("siftAR track");
+    cvcore::startMetricsFromEnvironment("siftAR");
 
     while (true)
     {
-        cap >> frame;
-        if (frame.empty()) break;
+        if (!cap->read(frame)) break;
+        if (loadFailed())
+        {
+            exitCode = 1;
+            break;
+        }
+        SIFTTracker* tracker = trackerLoad.get();
+        if (tracker && calibK.empty())
+        {
+            calibK = tracker->getCameraMatrix().clone();
+            calibD = tracker->getDistCoeffs().clone();
+        }
+        if (undistort) undistorter.apply(frame, frame);
 
         cv::Mat display = frame.clone();
 
         /* Track bill and estimate pose */
-        bool tracked = tracker.track(frame);
+        bool tracked = false;
+        if (tracker)
+        {
+            cvcore::AllocStageScope allocs(trackAllocs);
+            tracked = tracker->track(frame);
+        }
+        else
+        {
+            cv::putText(display, trackerLoad.status(), cv::Point(10, 30),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 200, 255), 2);
+        }
 
         /* Draw debug overlay */
-        if (showDebug)
-            tracker.drawDebug(display);
+        if (showDebug && tracker)
+        {
+            tracker->drawDebug(display);
+            if (cvcore::allocTrackingEnabled())
+            {
+                const cvcore::AllocCounts a = trackAllocs.last();
+                std::ostringstream as;
+                as << "Track allocs: " << a.heapCount << " new, " << a.matCount << " Mat ("
+                   << (a.heapBytes + a.matBytes) / 1024 << " KB)";
+                cv::putText(display, as.str(), cv::Point(10, display.rows - 80),
+                            cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
+            }
+        }
 
         /* Draw rocket if tracking */
         if (tracked && showRocket)
         {
             rocket.draw(display,
-                        tracker.getRvec(),
-                        tracker.getTvec(),
-                        tracker.getCameraMatrix(),
-                        tracker.getDistCoeffs());
+                        tracker->getRvec(),
+                        tracker->getTvec(),
+                        tracker->getCameraMatrix(),
+                        tracker->getDistCoeffs());
         }
 
         // Rocket toggle indicator
@@ -134,15 +299,48 @@ int main(int argc, char* argv[])
                     showRocket ? cv::Scalar(0, 255, 100)
                                : cv::Scalar(100, 100, 100), 1);
 
+        // Undistortion stage timing
+        if (undistort)
+        {
+            std::ostringstream us;
+            us << "Undistort: " << std::fixed << std::setprecision(2)
+               << undistorter.averageMs() << " ms ("
+               << (undistorter.getUseOpenCL() ? "OpenCL" : "CPU") << ")";
+            cv::putText(display, us.str(), cv::Point(10, display.rows - 60),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
+        }
+
         cv::imshow("SIFT AR - Dollar Bill", display);
 
         char key = static_cast<char>(cv::waitKey(30));
         if (key == 'q' || key == 27) break;
         if (key == 'r') showRocket = !showRocket;
         if (key == 'd') showDebug  = !showDebug;
+        if (!tracker) continue;     // tracker keys wait for the reference features
+        if (key == 'm') tracker->cycleMatcher();
+        if (key == 'x') tracker->setCrossCheck(!tracker->getCrossCheck());
+        if (key == 'o') tracker->setOpticalFlow(!tracker->getOpticalFlow());
+        if (key == 'w') tracker->setRoiDetection(!tracker->getRoiDetection());
+        if (key == 'g') tracker->setGuidedMatching(!tracker->getGuidedMatching());
+        if (key == 'k') tracker->setRelocalisation(!tracker->getRelocalisation());
+        if (key == 'e') tracker->cycleRobustMethod();
+        if (key == 's') tracker->setDetectScale(tracker->getDetectScale() < 1.0 ? 1.0 : 0.5);
+        if (key == 'l') tracker->setLatencyBudget(nextLatencyBudget(tracker->getLatencyBudget()));
+        if (key == 'u')
+        {
+            // Maps are built once, on the first switch to undistorted frames
+            if (!undistorter.isReady())
+                undistorter.initialize(calibK, calibD, frame.size());
+            undistort = !undistort && undistorter.isReady();
+            if (undistort)
+                tracker->setIntrinsics(undistorter.getCameraMatrix(), undistorter.getDistCoeffs());
+            else
+                tracker->setIntrinsics(calibK, calibD);
+            std::cout << "[Mode] Undistortion " << (undistort ? "on" : "off") << "\n";
+        }
     }
 
-    cap.release();
+    cap.reset();
     cv::destroyAllWindows();
-    return 0;
+    return exitCode;
 }
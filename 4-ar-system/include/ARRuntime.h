@@ -0,0 +1,254 @@
+/*
+ * ARRuntime.h - Pipelined Capture / Track / Render Runtime Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the ARRuntime class shared by augmentedReality,
+ *              siftAR and multiTargetAR (--pipeline). The serial app loops
+ *              run capture, tracking and drawing back to back, so one slow
+ *              SIFT frame stalls the video. Here each stage has its own
+ *              thread, connected by latest-value slots:
+ *
+ *   capture thread : FrameSource::read() → frame slot (timestamped)
+ *   tracking thread: newest frame → TrackFn (app) → pose slot
+ *   render thread  : every captured frame + newest poses, extrapolated to
+ *                    the frame's timestamp → RenderFn (app) → display slot
+ *   main thread    : imshow + waitKey (HighGUI must stay on it); keys are
+ *                    queued and handed to KeyFn on the tracking thread
+ *
+ * A latest-value slot keeps only the newest item; a slow consumer skips
+ * stale items instead of queueing them, so latency never builds up.
+ *
+ * Pose extrapolation:
+ *   Constant velocity from the last two valid poses of each target, in
+ *   rvec/tvec space, over at most MAX_EXTRAPOLATION_S. The overlay keeps
+ *   up with the video while the tracker works on an older frame.
+ *
+ * Threading contract:
+ *   TrackFn and KeyFn run on the tracking thread only, so they may use the
+ *   trackers freely. RenderFn runs on the render thread and must draw from
+ *   the ARTrackResult it receives (and immutable objects), never from
+ *   tracker state. Flags shared between KeyFn and RenderFn need atomics.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cvcore/capture.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* One target's pose as published by the tracking thread */
+struct ARPose
+{
+    cv::Mat rvec;
+    cv::Mat tvec;
+    bool    valid = false;
+};
+
+/* Everything RenderFn may use — filled by TrackFn */
+struct ARTrackResult
+{
+    std::vector<ARPose>      poses;        // app-defined target order
+    cv::Mat                  cameraMatrix; // intrinsics the poses belong to
+    cv::Mat                  distCoeffs;
+    std::vector<std::string> status;       // text lines, drawn top-left
+    double                   timestamp = 0.0;  // capture time of the frame (s)
+};
+
+/*
+ * LatestSlot
+ * Single-value channel: put() overwrites, readers wait for a value newer
+ * than the last one they saw. Any number of readers.
+ */
+template <typename T>
+class LatestSlot
+{
+public:
+    void put(const T& value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_value = value;
+            ++m_seq;
+        }
+        m_wake.notify_all();
+    }
+
+    /* waitNewer() - blocks until newer than seen or closed; false if closed */
+    bool waitNewer(uint64_t& seen, T& out)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [&] { return m_closed || m_seq > seen; });
+        if (m_seq <= seen) return false;
+        out  = m_value;
+        seen = m_seq;
+        return true;
+    }
+
+    /* waitNewerFor() - as waitNewer() with a timeout */
+    bool waitNewerFor(uint64_t& seen, T& out, int timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                        [&] { return m_closed || m_seq > seen; });
+        if (m_seq <= seen) return false;
+        out  = m_value;
+        seen = m_seq;
+        return true;
+    }
+
+    /* latest() - newest value without waiting; seen tells if it is new */
+    bool latest(uint64_t& seen, T& out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_seq <= seen) return false;
+        out  = m_value;
+        seen = m_seq;
+        return true;
+    }
+
+    /* reset() - empty and open again (no thread may be waiting) */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_value  = T{};
+        m_seq    = 0;
+        m_closed = false;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_wake.notify_all();
+    }
+
+private:
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    T                       m_value{};
+    uint64_t                m_seq    = 0;
+    bool                    m_closed = false;
+};
+
+/*
+ * ARRuntime
+ *
+ * Usage:
+ *   ARRuntime runtime(cap, trackFn, renderFn, keyFn);
+ *   runtime.run("SIFT AR", 'v');   // returns on 'q'/ESC or end of video
+ */
+class ARRuntime
+{
+public:
+    // Longest time a pose is carried forward by its velocity (seconds)
+    static constexpr double MAX_EXTRAPOLATION_S = 0.25;
+
+    // Rotation steps larger than this (rad) between poses are not
+    // extrapolated — rvec is not linear across the ±π wrap
+    static constexpr double MAX_ROTATION_STEP = 0.5;
+
+    using TrackFn  = std::function<void(const cv::Mat& frame, ARTrackResult& result)>;
+    using RenderFn = std::function<void(cv::Mat& display, const ARTrackResult& result)>;
+    using KeyFn    = std::function<void(int key)>;
+
+    ARRuntime(cvcore::FrameSource& source, TrackFn track, RenderFn render, KeyFn key = KeyFn());
+    ~ARRuntime();
+
+    ARRuntime(const ARRuntime&)            = delete;
+    ARRuntime& operator=(const ARRuntime&) = delete;
+
+    /*
+     * run()
+     * Starts the three worker threads and shows frames in windowName on
+     * the calling thread until 'q'/ESC or the capture ends.
+     * extrapolationKey (if >= 0) toggles pose extrapolation; all other keys
+     * go to KeyFn.
+     */
+    void run(const std::string& windowName, int extrapolationKey = -1);
+
+    /* setExtrapolation() - constant-velocity pose prediction (default on) */
+    void setExtrapolation(bool enabled) { m_extrapolate = enabled; }
+    bool getExtrapolation() const       { return m_extrapolate; }
+
+    /*
+     * takeFlag()
+     * Removes flag from argv if present (shifting the rest down) and
+     * returns true — lets apps accept --pipeline anywhere without
+     * disturbing their positional arguments.
+     */
+    static bool takeFlag(int& argc, char** argv, const std::string& flag);
+
+private:
+    /* A captured frame and its capture time */
+    struct Frame
+    {
+        cv::Mat image;
+        double  timestamp = 0.0;
+    };
+
+    /* Last two valid poses of one target (render thread only) */
+    struct PoseHistory
+    {
+        int     count = 0;
+        double  t0 = 0.0, t1 = 0.0;
+        cv::Mat r0, p0, r1, p1;
+    };
+
+    void captureLoop();
+    void trackLoop();
+    void renderLoop();
+    void stop();
+
+    /* updateHistory() - records a new tracking result */
+    void updateHistory(const ARTrackResult& result);
+
+    /* extrapolate() - poses of result moved to time t */
+    ARTrackResult extrapolate(const ARTrackResult& result, double t) const;
+
+    /* drawStatus() - the tracker's status lines, top-left */
+    static void drawStatus(cv::Mat& display, const std::vector<std::string>& lines);
+
+    /* drawStats() - stage rates and pose age, bottom-left */
+    void drawStats(cv::Mat& display, double poseAgeMs) const;
+
+    static double now();
+
+    cvcore::FrameSource& m_source;
+    TrackFn           m_track;
+    RenderFn          m_render;
+    KeyFn             m_key;
+
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_extrapolate;
+
+    LatestSlot<Frame>         m_frames;
+    LatestSlot<ARTrackResult> m_results;
+    LatestSlot<cv::Mat>       m_display;
+
+    std::thread m_captureThread;
+    std::thread m_trackThread;
+    std::thread m_renderThread;
+
+    // Keys from the main thread, drained by the tracking thread
+    std::mutex       m_keyMutex;
+    std::vector<int> m_pendingKeys;
+
+    // Render-thread pose history, one entry per target
+    std::vector<PoseHistory> m_history;
+
+    // Stage statistics (exponential averages)
+    std::atomic<double> m_trackMs;
+    std::atomic<double> m_trackFps;
+    double              m_renderFps = 0.0;   // render thread only
+};
@@ -0,0 +1,74 @@
+/*
+ * AssetCache.h - Binary Startup Asset Cache Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the AssetCache class which keeps expensive startup
+ *              results (reference keypoints/descriptors, undistortion maps
+ *              and the intrinsics they were built for) in binary files under
+ *              data/cache/, so a warm restart reads them back instead of
+ *              running SIFT on the reference JPEG or rebuilding the maps.
+ *
+ * Keys:
+ *   64-bit FNV-1a over everything the result depends on — the source file
+ *   BYTES (not its name or timestamp) plus the parameters (backend,
+ *   nfeatures, CLAHE settings, frame size ...). Changing the image or a
+ *   parameter gives a new key, so stale entries are never read.
+ *
+ * File (data/cache/<kind>_<key hex>.bin):
+ *   magic "ARCACHE1", key, mat count, then per cv::Mat rows/cols/type and
+ *   the raw pixel data. The whole file is read with ONE sequential read.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * AssetCache
+ *
+ * Usage:
+ *   AssetCache cache(dir);
+ *   uint64_t key = AssetCache::hashString(params, AssetCache::hashFile(src));
+ *   if (!cache.load("ref", key, mats)) { compute...; cache.store("ref", key, mats); }
+ */
+class AssetCache
+{
+public:
+    static constexpr uint64_t HASH_SEED = 14695981039346656037ull;   // FNV offset
+
+    explicit AssetCache(const std::string& directory);
+
+    /*
+     * load()
+     * Reads the entry for kind + key. Returns false if there is none or the
+     * file is damaged (the caller then recomputes and stores).
+     */
+    bool load(const std::string& kind, uint64_t key, std::vector<cv::Mat>& mats) const;
+
+    /* store() - writes the entry, creating the directory. Returns false on I/O error. */
+    bool store(const std::string& kind, uint64_t key, const std::vector<cv::Mat>& mats) const;
+
+    /* Hash helpers — chain them by passing the previous hash as seed */
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED);
+    static uint64_t hashString(const std::string& s, uint64_t seed = HASH_SEED);
+    static uint64_t hashMat(const cv::Mat& m, uint64_t seed = HASH_SEED);
+
+    /* hashFile() - hash of the file contents; 0 if it cannot be read */
+    static uint64_t hashFile(const std::string& path, uint64_t seed = HASH_SEED);
+
+    /* Keypoints as an N x 7 CV_32F Mat (x, y, size, angle, response, octave, class_id) */
+    static cv::Mat packKeypoints(const std::vector<cv::KeyPoint>& keypoints);
+    static void    unpackKeypoints(const cv::Mat& packed, std::vector<cv::KeyPoint>& keypoints);
+
+    const std::string& directory() const { return m_directory; }
+
+private:
+    /* entryPath() - data/cache/<kind>_<key hex>.bin */
+    std::string entryPath(const std::string& kind, uint64_t key) const;
+
+    std::string m_directory;
+};
@@ -22,6 +22,25 @@
  *   cv::calibrateCamera        - compute camera matrix + distortion coefficients
  *   cv::FileStorage            - save/load calibration results to XML/YAML
  *
+ * Threading:
+ *   Corner detection runs on a background worker. The preview loop hands it
+ *   the newest frame when it is idle and draws the latest result, so the
+ *   window never waits on findChessboardCorners. The board is searched on a
+ *   downscaled copy first and the corners are then refined at full
+ *   resolution with cornerSubPix. Once MIN_FRAMES are selected, every new
+ *   selected view starts a background calibration warm-started from the
+ *   previous estimate, so intrinsics and RMS error refine continuously
+ *   while views are collected. calibrateFromImages() calibrates offline
+ *   from a folder, with corner detection spread across all cores.
+ *
+ * View selection:
+ *   Every view is binned by board centre (POSITION_BINS^2 grid), apparent
+ *   size (SIZE_BINS) and perspective tilt about both axes (TILT_BINS^2).
+ *   A view is selected for calibrateCamera only if it covers a bin no
+ *   selected view covers yet (at most MAX_CALIB_VIEWS), so redundant saves
+ *   no longer slow the solve. The overlay shows whether the live board
+ *   would add coverage; auto-collect ('a') saves such views by itself.
+ *
  * Chessboard configuration (matches checkerboard.png):
  *   - 9 columns x 6 rows of internal corners  (BOARD_WIDTH x BOARD_HEIGHT)
  *   - World coordinates treat each square as 1x1 unit
@@ -33,6 +52,11 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <array>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -42,8 +66,10 @@
  * Manages the full calibration pipeline:
  *   1. Opens a webcam and streams live video
  *   2. Detects chessboard corners each frame (Task 1)
- *   3. On keypress 's', saves that frame's corners + world points (Task 2)
+ *   3. On keypress 's', saves that frame's corners + world points (Task 2);
+ *      'a' saves every view that adds coverage automatically
  *   4. On keypress 'c' (with >= MIN_FRAMES saved), runs calibration (Task 3)
+ *      on the selected views
  *   5. Prints camera matrix, distortion coefficients, and reprojection error
  *   6. Saves intrinsic parameters to an XML file for use in later tasks
  */
@@ -58,6 +84,25 @@ public:
     // Minimum number of frames required before calibration is allowed
     static constexpr int MIN_FRAMES = 5;
 
+    // Width of the downscaled copy the board is first searched in
+    static constexpr int DETECT_WIDTH = 640;
+
+    // Most views fed to calibrateCamera — the diverse ones
+    static constexpr int MAX_CALIB_VIEWS = 20;
+
+    // View-diversity bins: board centre grid (per axis), apparent size
+    // (fraction of the image), and tilt about each axis (left/right and
+    // top/bottom edge length ratio)
+    static constexpr int POSITION_BINS = 3;
+    static constexpr int SIZE_BINS     = 3;
+    static constexpr int TILT_BINS     = 3;
+
+    // Auto-collect: fewest preview frames between automatic saves
+    static constexpr int AUTO_SAVE_INTERVAL = 15;
+
+    // Levenberg-Marquardt iterations of a warm-started background estimate
+    static constexpr int REFINE_ITERATIONS = 10;
+
     /*
      * Constructor
      * cameraId     : index of the webcam to open (default 0)
@@ -71,12 +116,35 @@ public:
      * Starts the main video loop.
      * Controls:
      *   's' - save current frame for calibration (only when corners detected)
+     *   'a' - toggle auto-collect of views that add coverage
      *   'c' - run calibration (requires >= MIN_FRAMES saved)
      *   'q' / ESC - quit
      * Returns true if calibration was successfully completed.
      */
     bool run();
 
+    /*
+     * calibrateFromImages()
+     * Offline calibration from every image in 'folder' (png/jpg/bmp/tif).
+     * Corners are detected in parallel across cores; images without a
+     * board, or of a different size than the first, are skipped, and only
+     * the views selected for diversity are calibrated.
+     * Prints and saves the results like the live 'c' key.
+     * Returns true if calibration succeeded.
+     */
+    bool calibrateFromImages(const std::string& folder);
+
+    /*
+     * findBoardCorners()
+     * Coarse-to-fine chessboard detection on a grayscale image: the board
+     * is located in a copy downscaled to DETECT_WIDTH, then the corners are
+     * refined with cornerSubPix at full resolution.
+     * Thread-safe (no member state). Returns true if the board was found.
+     */
+    static bool findBoardCorners(const cv::Mat& gray,
+                                 const cv::Size& boardSize,
+                                 std::vector<cv::Point2f>& corners);
+
     /* Accessors - available after a successful calibration */
     const cv::Mat& getCameraMatrix()    const { return m_cameraMatrix; }
     const cv::Mat& getDistCoeffs()      const { return m_distCoeffs; }
@@ -85,21 +153,91 @@ public:
 
 private:
     /*
-     * detectCorners()
-     * Attempts to find chessboard corners in 'frame'.
-     * On success: refines with cornerSubPix and draws corners onto 'frame'.
-     * Returns true if corners were found; fills 'corners' output.
+     * DetectionResult
+     * Latest output of the background corner worker.
+     */
+    struct DetectionResult
+    {
+        std::vector<cv::Point2f> corners;
+        bool found   = false;
+        long frameId = -1;     // preview frame the corners belong to
+    };
+
+    /* Diversity bins of one board view (see viewBins()) */
+    struct ViewBins
+    {
+        int position = 0;   // board centre cell
+        int size     = 0;   // apparent size bin
+        int tilt     = 0;   // tiltX * TILT_BINS + tiltY
+    };
+
+    /* Result of a background calibration */
+    struct Estimate
+    {
+        double  rms = -1.0;  // < 0 = failed
+        cv::Mat cameraMatrix;
+        cv::Mat distCoeffs;
+    };
+
+    /*
+     * submitFrame() / latestDetection()
+     * Hand the worker a frame if it is idle (otherwise the frame is skipped)
+     * and read its newest result. Neither call blocks on detection.
+     */
+    void            submitFrame(const cv::Mat& frame, long frameId);
+    DetectionResult latestDetection();
+
+    /* Worker loop: grayscale + findBoardCorners on each submitted frame */
+    void detectionLoop();
+
+    /* Start / stop the worker thread */
+    void startDetection();
+    void stopDetection();
+
+    /*
+     * updateEstimate()
+     * Collects a finished background calibration and, when at least
+     * MIN_FRAMES calibration views exist and views were selected since the
+     * last estimate, starts a new one on a copy of them — warm-started
+     * from the previous estimate with REFINE_ITERATIONS LM steps.
      */
-    bool detectCorners(const cv::Mat& frame,
-                       std::vector<cv::Point2f>& corners);
+    void updateEstimate(const cv::Size& imageSize);
 
     /*
      * saveFrame()
      * Stores the most recently detected corner_set and the corresponding
      * 3D world point_set into corner_list and point_list respectively.
      * World coordinates: (col, -row, 0) in square units (Z=0, planar target).
+     * The view is selected for calibration when it adds coverage.
+     * Returns true if it was selected.
+     */
+    bool saveFrame(const std::vector<cv::Point2f>& corners, const cv::Size& imageSize);
+
+    /*
+     * viewBins()
+     * Bins a view by its outer corners: centroid cell, quadrilateral area
+     * over the image area, and log ratios of opposite edge lengths (a board
+     * turned about an axis shows a shorter far edge).
      */
-    void saveFrame(const std::vector<cv::Point2f>& corners);
+    ViewBins viewBins(const std::vector<cv::Point2f>& corners,
+                      const cv::Size& imageSize) const;
+
+    /* diversityScore() - bins of a view not yet covered by a selected view (0-3) */
+    int diversityScore(const ViewBins& bins) const;
+
+    /*
+     * calibrationViews()
+     * The selected views, or every saved view while fewer than MIN_FRAMES
+     * are selected (e.g. all saves from one spot).
+     */
+    void calibrationViews(std::vector<std::vector<cv::Vec3f>>&   points,
+                          std::vector<std::vector<cv::Point2f>>& corners) const;
+
+    /* calibrationViewCount() - number of views calibrationViews() returns */
+    int calibrationViewCount() const;
+
+    /* clearViews() - drops saved views, selection and coverage */
+    void clearViews();
 
     /*
      * buildWorldPoints()
@@ -115,7 +253,8 @@ private:
 
     /*
      * calibrate()
-     * Calls cv::calibrateCamera with the collected point_list and corner_list.
+     * Calls cv::calibrateCamera on calibrationViews(), starting from the
+     * latest background estimate when there is one.
      * Fills m_cameraMatrix, m_distCoeffs, m_reprojError.
      * Returns true on success.
      */
@@ -141,7 +280,15 @@ private:
      */
     void printStatus(cv::Mat& frame,
                      bool cornersFound,
-                     int savedFrames) const;
+                     int savedFrames,
+                     int viewScore) const;
+
+    /*
+     * drawCorners()
+     * Draws small green dots at each detected corner.
+     */
+    static void drawCorners(cv::Mat& frame,
+                            const std::vector<cv::Point2f>& corners);
 
     /* Member variables */
 
@@ -154,6 +301,13 @@ private:
     std::vector<std::vector<cv::Point2f>> m_cornerList;  // 2D image points
     std::vector<std::vector<cv::Vec3f>>   m_pointList;   // 3D world points
 
+    /* View selection — indices into the lists above, and the bins they cover */
+    std::vector<int> m_selected;
+    std::array<bool, POSITION_BINS * POSITION_BINS> m_positionCovered{};
+    std::array<bool, SIZE_BINS>                     m_sizeCovered{};
+    std::array<bool, TILT_BINS * TILT_BINS>         m_tiltCovered{};
+    bool             m_autoCollect = false;
+
     /* Results (Task 3) */
     cv::Mat m_cameraMatrix;   // 3x3 intrinsic matrix [fx,0,cx; 0,fy,cy; 0,0,1]
     cv::Mat m_distCoeffs;     // distortion coefficients [k1,k2,p1,p2,k3]
@@ -162,4 +316,22 @@ private:
 
     // Chessboard size as cv::Size (width x height of internal corners)
     cv::Size m_boardSize;
+
+    /* Background corner detection */
+    std::thread             m_detectThread;
+    std::mutex              m_detectMutex;   // guards the fields below
+    std::condition_variable m_detectWake;
+    cv::Mat                 m_pendingFrame;  // frame waiting for the worker
+    long                    m_pendingId  = -1;
+    bool                    m_detectBusy = false;
+    bool                    m_stopDetect = false;
+    DetectionResult         m_latest;
+
+    /* Progressive calibration estimate */
+    std::future<Estimate> m_estimate;        // calibration running in background
+    double              m_estimateError  = -1.0;
+    int                 m_estimateFrames = 0;
+    int                 m_pendingFrames  = 0;  // views in the running estimate
+    cv::Mat             m_estimateCamera;    // latest estimate (warm start)
+    cv::Mat             m_estimateDist;
 };
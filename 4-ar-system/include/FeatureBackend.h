@@ -0,0 +1,127 @@
+/*
+ * FeatureBackend.h - Pluggable Keypoint Detector/Descriptor Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the FeatureBackend interface used by SIFTTracker,
+ *              FeatureDetector and the featureBenchmark app, so each target
+ *              can pick its own detector instead of a hardcoded cv::SIFT.
+ *
+ * Backends:
+ *   SIFT       : 128-d float descriptors, L2 matching (original behaviour)
+ *   ORB        : 256-bit binary descriptors, Hamming matching (LSH for
+ *                FLANN) — by far the cheapest on ARM devices
+ *   AKAZE      : MLDB binary descriptors, Hamming matching
+ *   SUPERPOINT : 256-d float descriptors from a SuperPoint ONNX model run
+ *                through cv::dnn (outputs: 65-channel score map at 1/8
+ *                resolution + 256-channel descriptor map)
+ *   CUDA_ORB   : cv::cuda::ORB on the GPU (build with AR_WITH_CUDA and
+ *                OpenCV's cudafeatures2d). Frames are uploaded once,
+ *                descriptors stay on the device and can be matched there
+ *                (setMatchReference / knnMatchReference) so only the k-NN
+ *                matches come back. Without a CUDA device (or without
+ *                AR_WITH_CUDA) create() falls back to CPU ORB.
+ *
+ * nfeatures mapping (0 = backend default / unlimited):
+ *   SIFT, ORB  : passed to the detector's own nfeatures (CUDA_ORB too)
+ *   AKAZE      : strongest nfeatures kept with KeyPointsFilter::retainBest
+ *   SUPERPOINT : strongest nfeatures kept after non-maximum suppression
+ *
+ * setNFeatures() changes the limit of a live backend (LatencyController):
+ * ORB detectors take the new limit directly; SIFT keeps the strongest
+ * keypoints with retainBest once the limit drops below its own.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/features2d.hpp>
+#include <string>
+#include <vector>
+
+/*
+ * FeatureBackend
+ *
+ * Detects keypoints and computes descriptors on a grayscale image.
+ * normType() tells matchers which distance the descriptors use.
+ */
+class FeatureBackend
+{
+public:
+    enum Type { SIFT = 0, ORB, AKAZE, SUPERPOINT, CUDA_ORB, TYPE_COUNT };
+
+    virtual ~FeatureBackend() = default;
+
+    /*
+     * create()
+     * Builds a backend. modelPath is only used by SUPERPOINT and
+     * contrastThreshold only by SIFT (lower = more features).
+     * Returns nullptr (with an error printed) if the backend cannot be built,
+     * e.g. a missing SuperPoint model.
+     */
+    static cv::Ptr<FeatureBackend> create(Type type, int nfeatures,
+                                          const std::string& modelPath = "",
+                                          double contrastThreshold = 0.04);
+
+    /*
+     * detectAndCompute()
+     * gray : 8-bit single-channel image
+     * mask : optional 8-bit mask (empty = whole image)
+     */
+    virtual void detectAndCompute(const cv::Mat& gray, const cv::Mat& mask,
+                                  std::vector<cv::KeyPoint>& keypoints,
+                                  cv::Mat& descriptors) = 0;
+
+    /* normType() - cv::NORM_L2 or cv::NORM_HAMMING */
+    virtual int normType() const = 0;
+
+    /*
+     * setMatchReference()
+     * Uploads reference descriptors for device-side matching and switches
+     * detectAndCompute() to leave its descriptors on the device (the
+     * returned cv::Mat is then EMPTY — check keypoints instead). An empty
+     * Mat switches device matching off again. Returns false for backends
+     * without a device; the caller then matches on the CPU as before.
+     */
+    virtual bool setMatchReference(const cv::Mat& /*descriptors*/) { return false; }
+
+    /*
+     * knnMatchReference()
+     * k-NN of the last detectAndCompute() descriptors against the reference
+     * set, on the device; only the matches are downloaded. Returns false
+     * when device matching is off.
+     */
+    virtual bool knnMatchReference(std::vector<std::vector<cv::DMatch>>& /*matches*/,
+                                   int /*k*/) { return false; }
+
+    /* cudaAvailable() - built with AR_WITH_CUDA and a CUDA device present */
+    static bool cudaAvailable();
+
+    /*
+     * setNFeatures()
+     * Changes the feature limit for the following frames (same mapping as
+     * create(); 0 = backend default / unlimited).
+     */
+    virtual void setNFeatures(int nfeatures) { m_nfeatures = nfeatures; }
+
+    bool isBinary() const { return normType() == cv::NORM_HAMMING; }
+    Type type()     const { return m_type; }
+    int  nfeatures() const { return m_nfeatures; }
+
+    /* typeName() - printable backend name */
+    static const char* typeName(Type type);
+
+    /*
+     * parseType()
+     * Parses "sift", "orb", "akaze", "superpoint" or "cuda-orb" (case-insensitive).
+     * Returns false for an unknown name.
+     */
+    static bool parseType(const std::string& name, Type& type);
+
+protected:
+    FeatureBackend(Type type, int nfeatures)
+        : m_type(type), m_nfeatures(nfeatures) {}
+
+    Type m_type;
+    int  m_nfeatures;
+};
@@ -4,7 +4,8 @@
  * Description: Declares the FeatureDetector class responsible for detecting
  *              SIFT features in a live video stream and visualizing them.
  *              Uses a dollar bill / banknote as the target pattern.
- *              SIFT detector is cached and only recreated when trackbar changes.
+ *              Detector is a FeatureBackend (SIFT, ORB, AKAZE or SuperPoint),
+ *              cached and only recreated when the trackbar or backend changes.
  *
  * Task coverage:
  *   Task 7 - Detect robust SIFT features in a live video stream.
@@ -12,8 +13,8 @@
  *            Experiment with max features via trackbar.
  *
  * Key OpenCV functions used:
- *   cv::SIFT::create()           - creates SIFT detector instance
- *   sift->detectAndCompute()     - detects keypoints + 128-dim descriptors
+ *   FeatureBackend::create()     - creates SIFT/ORB/AKAZE/SuperPoint backend
+ *   detectAndCompute()           - detects keypoints + descriptors
  *   cv::drawKeypoints()          - draws keypoints with scale + orientation
  *   cv::createTrackbar()         - runtime feature count adjustment
  *
@@ -24,6 +25,7 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/features2d.hpp>
+#include "FeatureBackend.h"
 #include <string>
 
 /*
@@ -39,20 +41,27 @@ class FeatureDetector
 public:
     explicit FeatureDetector(int    cameraId          = 0,
                              int    nfeatures         = 500,
-                             double contrastThreshold = 0.04);
+                             double contrastThreshold = 0.04,
+                             FeatureBackend::Type backend = FeatureBackend::SIFT,
+                             const std::string& modelPath = "");
 
     bool run();
 
 private:
-    int  detectSIFT(const cv::Mat& frame, cv::Mat& displayFrame);
+    int  detectFeatures(const cv::Mat& frame, cv::Mat& displayFrame);
+
+    /* cycleBackend() - switches to the next backend that can be built */
+    void cycleBackend();
     void overlayInfo(cv::Mat& frame, int keypointCount) const;
 
     /* Member variables */
     int    m_cameraId;
     int    m_nfeatures;          // controlled by trackbar
     double m_contrastThreshold;
+    FeatureBackend::Type m_backendType;
+    std::string          m_modelPath;   // SuperPoint ONNX model
 
-    // Cached SIFT detector — recreated only when m_nfeatures changes
-    cv::Ptr<cv::SIFT> m_sift;
-    int               m_lastNfeatures;  // last value used to build m_sift
+    // Cached detector — recreated only when m_nfeatures or the backend changes
+    cv::Ptr<FeatureBackend> m_features;
+    int                     m_lastNfeatures;  // last value used to build m_features
 };
@@ -0,0 +1,95 @@
+/*
+ * FiducialTarget.h - ArUco / ChArUco Fiducial Target Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the FiducialTarget class, an alternative to the
+ *              chessboard search of PoseEstimator. The target is a ChArUco
+ *              board: a chessboard whose white squares carry ArUco markers.
+ *              Every marker is decoded on its own, so any visible part of
+ *              the board gives a pose — the markers form one rigid target.
+ *
+ * Detection per frame:
+ *   1. cv::aruco::ArucoDetector on a copy downscaled to DETECT_WIDTH
+ *   2. Marker corners scaled back and refined with cornerSubPix at full
+ *      resolution
+ *   3. Chessboard corners touching a detected marker predicted through the
+ *      board-to-image homography of the marker corners, then refined with
+ *      cornerSubPix (ChArUco interpolation)
+ *   4. Both point sets returned with their world points for PoseSolver
+ *
+ * World convention:
+ *   Same as CameraCalibration and PoseEstimator: square units, origin at
+ *   the top-left INTERNAL chessboard corner, (col, -row, 0). The default
+ *   10 x 7 square board has the 9 x 6 internal corners of the chessboard
+ *   target, so virtual objects placed for the chessboard sit at the same
+ *   spot on the fiducial board, and the same calibration is used.
+ *
+ * Requires OpenCV 4.7+ (aruco in objdetect), enabled with
+ * -DAR_WITH_ARUCO=ON. Without it isAvailable() is false and detect()
+ * always fails.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+
+/*
+ * FiducialTarget
+ *
+ * Usage:
+ *   FiducialTarget target;
+ *   target.detect(gray, imagePoints, objectPoints);
+ *   solver.solve(objectPoints, imagePoints, K, D, rvec, tvec);
+ */
+class FiducialTarget
+{
+public:
+    // Board layout — 10 x 7 squares, markers 0.75 of a square, DICT_4X4_50
+    static constexpr int   SQUARES_X     = 10;
+    static constexpr int   SQUARES_Y     = 7;
+    static constexpr float MARKER_LENGTH = 0.75f;
+
+    // Width of the copy the markers are searched on (same as the chessboard search)
+    static constexpr int   DETECT_WIDTH  = 640;
+
+    FiducialTarget();
+    ~FiducialTarget();
+
+    FiducialTarget(const FiducialTarget&) = delete;
+    FiducialTarget& operator=(const FiducialTarget&) = delete;
+
+    /* isAvailable() - true if built with ArUco support */
+    static bool isAvailable();
+
+    /*
+     * detect()
+     * gray         : full-resolution grayscale frame
+     * imagePoints  : OUTPUT refined chessboard corners, then marker corners
+     * objectPoints : OUTPUT matching world points (Z = 0 plane)
+     * Returns true if at least one board marker was found.
+     */
+    bool detect(const cv::Mat& gray,
+                std::vector<cv::Point2f>& imagePoints,
+                std::vector<cv::Vec3f>&   objectPoints);
+
+    /* Counts of the last detect() */
+    int markersFound() const { return m_markersFound; }
+    int cornersFound() const { return m_cornersFound; }
+
+    /*
+     * drawBoard()
+     * Printable board image, squarePx pixels per square plus a one-square
+     * white margin. Returns false without ArUco support.
+     */
+    static bool drawBoard(int squarePx, cv::Mat& image);
+
+private:
+    struct Impl;                        // cv::aruco objects (AR_WITH_ARUCO only)
+    std::unique_ptr<Impl> m_impl;
+
+    int m_markersFound;
+    int m_cornersFound;
+};
@@ -0,0 +1,96 @@
+/*
+ * FrameUndistorter.h - Precomputed Lens Undistortion Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the FrameUndistorter class which removes lens
+ *              distortion from whole frames with maps built ONCE from the
+ *              calibration. Trackers then detect, solve PnP and project with
+ *              the undistorted camera matrix and zero distortion, instead of
+ *              passing distortion coefficients into every projectPoints /
+ *              solvePnP call while matching in distorted image space.
+ *
+ * Maps:
+ *   cv::initUndistortRectifyMap with CV_16SC2 — fixed-point maps, the
+ *   fastest layout for cv::remap. Built in initialize(), reused every frame.
+ *
+ * GPU path:
+ *   With OpenCL available the maps are also kept as cv::UMat and remap runs
+ *   through the transparent API on the device; otherwise (or when disabled)
+ *   the CPU path is used.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+/*
+ * FrameUndistorter
+ *
+ * Usage:
+ *   FrameUndistorter undistorter;
+ *   undistorter.initialize(K, D, frameSize);
+ *   tracker.setIntrinsics(undistorter.getCameraMatrix(),
+ *                         undistorter.getDistCoeffs());
+ *   every frame: undistorter.apply(frame, frame);
+ */
+class FrameUndistorter
+{
+public:
+    FrameUndistorter();
+
+    /*
+     * initialize()
+     * cameraMatrix, distCoeffs : calibration of the camera
+     * imageSize                : frame size the maps are built for
+     * alpha                    : 0 = crop to valid pixels only,
+     *                            1 = keep every source pixel (black borders)
+     * Returns false if the calibration is empty.
+     */
+    bool initialize(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                    const cv::Size& imageSize, double alpha = 0.0);
+
+    /*
+     * apply()
+     * Remaps src into dst (may be the same Mat). Frames of another size than
+     * the maps are copied through unchanged. Timed for lastMs()/averageMs().
+     */
+    void apply(const cv::Mat& src, cv::Mat& dst);
+
+    /*
+     * setCacheDirectory()
+     * Stores the maps and undistorted camera matrix in an AssetCache in dir
+     * (keyed by calibration, frame size and alpha). Call before initialize().
+     */
+    void setCacheDirectory(const std::string& dir) { m_cacheDir = dir; }
+
+    /* setUseOpenCL() - remap on the OpenCL device when one is available */
+    void setUseOpenCL(bool enabled);
+
+    bool isReady()      const { return !m_map1.empty(); }
+    bool getUseOpenCL() const { return m_useOpenCL; }
+
+    /* Intrinsics of the undistorted frames — distortion is all zero */
+    const cv::Mat& getCameraMatrix() const { return m_newCameraMatrix; }
+    const cv::Mat& getDistCoeffs()   const { return m_zeroDist; }
+
+    /* Undistortion timing — last frame and exponential average (ms) */
+    double lastMs()    const { return m_lastMs; }
+    double averageMs() const { return m_avgMs; }
+
+private:
+    cv::Size m_imageSize;
+    cv::Mat  m_newCameraMatrix;
+    cv::Mat  m_zeroDist;
+
+    // Fixed-point maps (CV_16SC2 + CV_16UC1) and their device copies
+    cv::Mat  m_map1, m_map2;
+    cv::UMat m_map1Gpu, m_map2Gpu;
+    bool     m_useOpenCL;
+
+    double m_lastMs;
+    double m_avgMs;
+
+    std::string m_cacheDir;   // empty = no AssetCache
+};
@@ -0,0 +1,132 @@
+/*
+ * GLRenderer.h - OpenGL Overlay Renderer Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the GLRenderer class which draws the projected
+ *              wireframes of VirtualObject / VirtualEagleObject on the GPU,
+ *              composited over the camera frame uploaded as a texture.
+ *              The CPU path draws segments one at a time with cv::line into
+ *              the frame; here every segment of a frame goes into a vertex
+ *              batch and is drawn with one GL_LINES call per line width.
+ *
+ * Per frame:
+ *   1. setBackground(frame)   - camera image → cv::ogl::Texture2D
+ *   2. object.draw(renderer, rvec, tvec, K, D) - projected segments batched
+ *      renderer.addMesh(mesh, rvec, tvec)      - one model-view per target
+ *   3. present()              - window redraw: texture quad, meshes (depth
+ *                               tested, GL projection built from K), then
+ *                               the line batches
+ *
+ * Meshes go through the GL pipeline, which has no lens distortion model —
+ * they line up exactly when the frames are undistorted (FrameUndistorter).
+ *
+ * Requires OpenCV built WITH_OPENGL and this project configured with
+ * -DAR_WITH_OPENGL=ON. Otherwise open() returns false and the apps keep
+ * the cv::line path.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+class VirtualMesh;
+
+/*
+ * GLRenderer
+ *
+ * Usage:
+ *   GLRenderer renderer;
+ *   if (renderer.open("AR", frame.size())) each frame:
+ *       renderer.setBackground(frame);
+ *       rocket.draw(renderer, rvec, tvec, K, D);
+ *       renderer.present();
+ */
+class GLRenderer
+{
+public:
+    GLRenderer();
+    ~GLRenderer();
+
+    GLRenderer(const GLRenderer&)            = delete;
+    GLRenderer& operator=(const GLRenderer&) = delete;
+
+    /*
+     * open()
+     * Creates an OpenGL window (cv::WINDOW_OPENGL) of the given frame size.
+     * Returns false when OpenGL support is not available.
+     */
+    bool open(const std::string& windowName, const cv::Size& frameSize);
+
+    /* isOpen() - true after a successful open() */
+    bool isOpen() const { return m_open; }
+
+    /* frameSize() - size of the last background frame */
+    const cv::Size& frameSize() const { return m_frameSize; }
+
+    /* setBackground() - uploads the BGR camera frame drawn under the lines */
+    void setBackground(const cv::Mat& frame);
+
+    /*
+     * addLine()
+     * Queues one 2D segment (pixel coordinates) for this frame.
+     * color is BGR like cv::line; segments are grouped by thickness.
+     */
+    void addLine(const cv::Point2f& p1, const cv::Point2f& p2,
+                 const cv::Scalar& color, int thickness);
+
+    /*
+     * setCameraMatrix()
+     * Intrinsics for the mesh projection (3x3 CV_64F). Call when the
+     * tracker's intrinsics change.
+     */
+    void setCameraMatrix(const cv::Mat& cameraMatrix);
+
+    /*
+     * addMesh()
+     * Queues mesh for this frame at the target pose rvec/tvec (OpenCV
+     * camera convention). The mesh must outlive present().
+     */
+    void addMesh(const VirtualMesh& mesh, const cv::Mat& rvec, const cv::Mat& tvec);
+
+    /* present() - draws the background and all queued meshes and segments, then clears the queue */
+    void present();
+
+    /* segmentCount() - segments queued for the current frame */
+    int segmentCount() const;
+
+private:
+    /* One GL_LINES batch — all segments of one line width */
+    struct LineBatch
+    {
+        int                      thickness = 1;
+        std::vector<cv::Point2f> vertices;   // 2 per segment
+        std::vector<cv::Vec3b>   colors;     // RGB, one per vertex
+    };
+
+    /* One queued mesh and its column-major GL model-view matrix */
+    struct MeshDraw
+    {
+        const VirtualMesh* mesh = nullptr;
+        double             modelView[16];
+    };
+
+    /* drawCallback() - cv::setOpenGlDrawCallback entry point */
+    static void drawCallback(void* userdata);
+
+    /* render() - issues the GL draw calls (inside the window's GL context) */
+    void render();
+
+    std::string            m_windowName;
+    cv::Size               m_frameSize;
+    bool                   m_open;
+    std::vector<LineBatch> m_batches;
+    std::vector<MeshDraw>  m_meshes;
+    cv::Mat                m_cameraMatrix;
+
+    // GPU-side buffers — reused every frame
+    cv::ogl::Texture2D m_background;
+    cv::ogl::Arrays    m_arrays;
+};
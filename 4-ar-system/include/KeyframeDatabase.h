@@ -0,0 +1,124 @@
+/*
+ * KeyframeDatabase.h - Keyframe Store for Relocalisation Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the KeyframeDatabase class used by SIFTTracker to
+ *              reacquire the bill after tracking loss. Successfully tracked
+ *              views are stored as keyframes (pose, inlier keypoints, their
+ *              descriptors and the reference keypoint each one matched), and
+ *              indexed by a bag-of-words vocabulary built from the reference
+ *              descriptors.
+ *
+ * Vocabulary:
+ *   Float descriptors (SIFT, SuperPoint) — k-means centres of the reference
+ *   descriptors. Binary descriptors (ORB, AKAZE) — evenly spaced reference
+ *   descriptors as word medoids, compared with Hamming distance.
+ *   Each word is weighted by its idf over the reference: words shared by
+ *   many reference descriptors say little about the view.
+ *
+ * Query:
+ *   A frame's descriptors become an L1-normalised tf-idf vector; keyframes
+ *   sharing a word are found through an inverted index and scored with the
+ *   L1 similarity sum(min(q, k)) in [0, 1]. The lost tracker then matches
+ *   only against the few best keyframes' descriptor subsets instead of the
+ *   whole reference.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/features2d.hpp>
+#include <utility>
+#include <vector>
+
+/* One tracked view of the target */
+struct Keyframe
+{
+    cv::Mat                   rvec;         // raw pose when stored
+    cv::Mat                   tvec;
+    std::vector<cv::KeyPoint> keypoints;    // inlier live keypoints
+    cv::Mat                   descriptors;  // one row per keypoint
+    std::vector<int>          refIdx;       // reference keypoint matched by each row
+
+    // Sparse tf-idf vector: (word, weight) ascending by word, weights sum to 1
+    std::vector<std::pair<int, float>> bow;
+    long long                 lastUsed = 0; // stamp of the last add or reacquisition
+};
+
+/*
+ * KeyframeDatabase
+ *
+ * Usage:
+ *   db.buildVocabulary(refDescriptors, normType);   // once per reference
+ *   db.add(keyframe);                               // after good detections
+ *   for (int k : db.query(db.transform(liveDescriptors), 3)) ...
+ */
+class KeyframeDatabase
+{
+public:
+    using BowVector = std::vector<std::pair<int, float>>;
+
+    // Words in the vocabulary (fewer when the reference has fewer descriptors)
+    static constexpr int VOCABULARY_SIZE = 64;
+
+    // Stored keyframes; the least recently used one is replaced when full
+    static constexpr int MAX_KEYFRAMES = 24;
+
+    // A new view is stored only when no keyframe scores this high against it
+    static constexpr float NOVELTY_SCORE = 0.6f;
+
+    // Keyframes scoring below this are not worth matching
+    static constexpr float MIN_QUERY_SCORE = 0.1f;
+
+    /*
+     * buildVocabulary()
+     * Builds the words from the reference descriptors and clears the stored
+     * keyframes (their refIdx belong to the previous reference).
+     */
+    void buildVocabulary(const cv::Mat& refDescriptors, int normType);
+
+    /* clear() - drops the keyframes, keeps the vocabulary */
+    void clear();
+
+    /* transform() - tf-idf vector of a set of descriptors */
+    BowVector transform(const cv::Mat& descriptors) const;
+
+    /*
+     * add()
+     * Computes the keyframe's vector and stores it unless an existing
+     * keyframe already scores NOVELTY_SCORE or more against it. Returns true
+     * if it was stored.
+     */
+    bool add(Keyframe keyframe);
+
+    /*
+     * query()
+     * Indices of up to maxResults keyframes, best score first, scoring at
+     * least MIN_QUERY_SCORE against v.
+     */
+    std::vector<int> query(const BowVector& v, int maxResults) const;
+
+    /* touch() - marks a keyframe as used (reacquisition), delaying its eviction */
+    void touch(int index) { m_keyframes[index].lastUsed = ++m_clock; }
+
+    const Keyframe& keyframe(int index) const { return m_keyframes[index]; }
+    int  size()          const { return static_cast<int>(m_keyframes.size()); }
+    bool empty()         const { return m_keyframes.empty(); }
+    bool hasVocabulary() const { return !m_words.empty(); }
+
+private:
+    /* score() - L1 similarity of two normalised vectors */
+    static float score(const BowVector& a, const BowVector& b);
+
+    /* rebuildIndex() - inverted index from scratch (after a replacement) */
+    void rebuildIndex();
+
+    cv::Mat                        m_words;     // one word per row
+    std::vector<float>             m_idf;       // per word
+    cv::Ptr<cv::DescriptorMatcher> m_wordMatcher;
+
+    std::vector<Keyframe>          m_keyframes;
+    std::vector<std::vector<int>>  m_inverted;  // word → keyframes containing it
+    long long                      m_clock = 0;
+};
@@ -0,0 +1,101 @@
+/*
+ * LatencyController.h - Latency-Budget Quality Controller Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the LatencyController class used by SIFTTracker to
+ *              hold detection frames inside a per-frame time budget. The
+ *              cost of a detection frame varies with scene texture far more
+ *              than with nfeatures alone, so instead of one fixed setting
+ *              the tracker walks a ladder of quality levels from measured
+ *              stage timings and its inlier count.
+ *
+ * Quality ladder (level 0 = the tracker's own settings):
+ *   level  nfeatures  detect scale  ROI margin  robust iteration cap
+ *     0      1.00        1.00          0.30          2000
+ *     1      0.80        0.85          0.25          1000
+ *     2      0.60        0.70          0.20           500
+ *     3      0.45        0.55          0.15           250
+ *     4      0.30        0.40          0.10           100
+ *   nfeatures and detect scale multiply the tracker's values; the margin
+ *   and cap replace ROI_MARGIN and ROBUST_MAX_ITERS.
+ *
+ * Control (detection frames only — flow frames are not affected by any
+ * of the knobs):
+ *   - Frame time is smoothed with an exponential average (EMA_ALPHA).
+ *   - DOWNGRADE_FRAMES consecutive frames over budget → one level cheaper,
+ *     unless inliers are already scarce (fewer would lose the bill).
+ *   - UPGRADE_FRAMES consecutive frames under UPGRADE_HEADROOM × budget →
+ *     one level richer; STARVED_UPGRADE_FRAMES when inliers are scarce or
+ *     the bill is lost, as quality is what the tracker is short of.
+ *   - Both counters restart after every level change, and the average is
+ *     only trusted again after SETTLE_FRAMES, so one expensive frame never
+ *     moves the level twice.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+/*
+ * LatencyController
+ *
+ * Usage:
+ *   LatencyController ctl;
+ *   ctl.setBudget(25.0);
+ *   if (ctl.update(frameMs, tracking, inliers))
+ *       apply(ctl.settings());
+ */
+class LatencyController
+{
+public:
+    /* Knob values of one quality level */
+    struct Settings
+    {
+        double featureFraction;    // × the tracker's nfeatures
+        double scaleFraction;      // × the tracker's detect scale
+        float  roiMargin;          // predicted-window growth
+        int    maxRobustIters;     // robust estimation iteration cap
+    };
+
+    static constexpr int LEVEL_COUNT = 5;
+
+    // Hysteresis: consecutive detection frames before a level change
+    static constexpr int    DOWNGRADE_FRAMES       = 3;
+    static constexpr int    UPGRADE_FRAMES         = 15;
+    static constexpr int    STARVED_UPGRADE_FRAMES = 4;
+    static constexpr int    SETTLE_FRAMES          = 2;
+    static constexpr double UPGRADE_HEADROOM       = 0.6;
+    static constexpr double EMA_ALPHA              = 0.3;
+
+    LatencyController();
+
+    /* setBudget() - target ms per detection frame; 0 disables (level 0) */
+    void setBudget(double ms);
+
+    /*
+     * update()
+     * frameMs      : total stage time of the last detection frame
+     * tracking     : the frame produced a pose
+     * scarce       : inliers too few to drop features safely
+     * Returns true if the level changed.
+     */
+    bool update(double frameMs, bool tracking, bool scarce);
+
+    bool            isEnabled() const { return m_budgetMs > 0.0; }
+    double          budgetMs()  const { return m_budgetMs; }
+    double          averageMs() const { return m_avgMs; }
+    int             level()     const { return m_level; }
+    const Settings& settings()  const { return levelSettings(m_level); }
+
+    /* levelSettings() - knob values of a level (clamped to the ladder) */
+    static const Settings& levelSettings(int level);
+
+private:
+    void setLevel(int level);
+
+    double m_budgetMs;
+    double m_avgMs;
+    int    m_level;
+    int    m_overFrames;
+    int    m_underFrames;
+    int    m_settleFrames;
+};
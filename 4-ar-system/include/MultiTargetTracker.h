@@ -0,0 +1,244 @@
+/*
+ * MultiTargetTracker.h - Shared-Detection Planar Target Tracker Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the MultiTargetTracker class which tracks several
+ *              flat textured targets (dollar bill, posters, book covers ...)
+ *              with ONE detection pass per frame. SIFTTracker does the full
+ *              grayscale/CLAHE/detect/match pipeline per target; here those
+ *              steps run once and only RANSAC + pose solve run per target.
+ *
+ * Extension:   Multiple targets in the scene
+ *
+ * Pipeline per frame:
+ *   1. Grayscale (skipped when a gray frame is passed) + CLAHE — once
+ *   2. Detect keypoints + descriptors with one FeatureBackend — once
+ *   3. k=2 match against a combined reference index holding every target's
+ *      descriptors; DMatch::imgIdx is the target ID
+ *   4. Ratio test, then matches are grouped by target ID
+ *   5. Per target, in parallel (cv::parallel_for_):
+ *      findHomography RANSAC → PoseSolver (IPPE, warm) → EMA smoothing
+ *
+ * Database mode (loadDatabase, hundreds of targets):
+ *   A combined index over every target would make each frame's matching
+ *   grow with the catalogue. Instead step 3 becomes:
+ *   3a. TargetDatabase::query() — vocabulary-tree tf-idf retrieval of the
+ *       RETRIEVE_CANDIDATES best targets (about a millisecond)
+ *   3b. k=2 match + ratio test against each candidate's own index — the
+ *       candidates, the targets tracked in the previous frame and the
+ *       targets registered with addTarget() (always matched) — in parallel
+ *       with the per-target pose
+ *
+ * World coordinate convention (per target, same as SIFTTracker):
+ *   Target is a flat plane (Z=0), origin at its top-left corner,
+ *   X rightward, Y downward, Z toward the camera. Units = centimeters.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "FeatureBackend.h"
+#include "PoseSolver.h"
+#include "StageTimings.h"
+#include "TargetDatabase.h"
+#include <cvcore/frameContext.hpp>
+#include <string>
+#include <vector>
+
+/*
+ * MultiTargetTracker
+ *
+ * Register targets with addTarget() before initialize(). Pose getters take
+ * the target ID returned by addTarget().
+ */
+class MultiTargetTracker
+{
+public:
+    // Minimum inlier matches required to accept a pose estimate
+    static constexpr int MIN_INLIERS = 8;
+
+    // Database mode: targets retrieved per frame for full matching
+    static constexpr int RETRIEVE_CANDIDATES = 4;
+
+    /*
+     * Constructor
+     * calibrationFile : path to calibration XML (from calibrateCamera app)
+     * nfeatures       : reference features per target; the live frame gets
+     *                   nfeatures x target count so every target keeps its
+     *                   share when all are in view
+     * backend         : keypoint detector/descriptor shared by all targets
+     * modelPath       : SuperPoint ONNX model (backend == SUPERPOINT only)
+     */
+    explicit MultiTargetTracker(const std::string& calibrationFile,
+                                int nfeatures = 300,
+                                FeatureBackend::Type backend = FeatureBackend::SIFT,
+                                const std::string& modelPath = "");
+
+    /*
+     * addTarget()
+     * Registers a planar target. widthCm/heightCm are its physical size.
+     * Returns the target ID (0, 1, 2, ...).
+     */
+    int addTarget(const std::string& name, const std::string& referenceImage,
+                  float widthCm, float heightCm);
+
+    /*
+     * loadDatabase()
+     * Registers every target of a .ardb file (buildTargetDatabase app) with
+     * its stored features and switches to database mode. Call before
+     * initialize(); the database backend must be the tracker's. Targets
+     * added with addTarget() stay, and are matched on every frame. Returns
+     * false if the file cannot be read or was built for another backend.
+     */
+    bool loadDatabase(const std::string& path);
+
+    /*
+     * initialize()
+     * Loads calibration and every reference image, loads its compiled
+     * .arref features (ReferenceCompiler), cached features (AssetCache) or
+     * computes them, and builds the combined index. Returns false on failure.
+     */
+    bool initialize();
+
+    /*
+     * setCacheDirectory()
+     * Enables the AssetCache in dir for reference features (see
+     * SIFTTracker::setCacheDirectory). Call before initialize().
+     */
+    void setCacheDirectory(const std::string& dir) { m_cacheDir = dir; }
+
+    /*
+     * track()
+     * Runs one detection pass on frame (BGR or grayscale) and updates the
+     * pose of every target. Returns the number of targets tracked.
+     */
+    int track(const cv::Mat& frame);
+
+    /*
+     * track()
+     * Same, taking grayscale and CLAHE from the frame context: other
+     * consumers of the frame asking for the same CLAHE settings reuse them.
+     */
+    int track(cvcore::FrameContext& context);
+
+    /*
+     * setIntrinsics()
+     * Replaces the loaded calibration — e.g. with FrameUndistorter's camera
+     * matrix and zero distortion when frames are undistorted before track().
+     */
+    void setIntrinsics(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs);
+
+    /*
+     * drawDebug()
+     * Draws each tracked target's inlier keypoints and projected outline.
+     */
+    void drawDebug(cv::Mat& displayFrame) const;
+
+    /* Per-target accessors — return SMOOTHED pose for stable rendering */
+    const cv::Mat&     getRvec(int id)        const;
+    const cv::Mat&     getTvec(int id)        const;
+    bool               isTracking(int id)     const { return m_targets[id].tracking; }
+    int                getInlierCount(int id) const { return m_targets[id].inlierCount; }
+    const std::string& getName(int id)        const { return m_targets[id].name; }
+    int                targetCount()          const { return static_cast<int>(m_targets.size()); }
+
+    const cv::Mat& getCameraMatrix() const { return m_cameraMatrix; }
+    const cv::Mat& getDistCoeffs()   const { return m_distCoeffs; }
+
+    /* getTimings() - per-stage ms of the last track() (RANSAC/PNP summed over targets) */
+    const StageTimings& getTimings() const { return m_timings; }
+
+    /* Live keypoints and matches of the last frame (all targets) */
+    int getLastKeypointCount() const { return static_cast<int>(m_lastLiveKeypoints.size()); }
+    int getLastMatchCount()    const { return m_lastMatchCount; }
+
+    /* Database mode — retrieval of the last frame (candidates best first) */
+    bool                    hasDatabase()        const { return !m_database.empty(); }
+    const std::vector<int>& getLastCandidates()  const { return m_lastCandidates; }
+    double                  getLastRetrievalMs() const { return m_lastRetrievalMs; }
+
+private:
+    /* One registered target and its tracking state */
+    struct Target
+    {
+        std::string               name;
+        std::string               imagePath;
+        float                     widthCm  = 0.0f;
+        float                     heightCm = 0.0f;
+        cv::Size                  refSize;
+        std::vector<cv::KeyPoint> refKeypoints;
+        cv::Mat                   refDescriptors;
+
+        // Database mode: true for addTarget() targets (matched every
+        // frame), and the target's own index, built on first use
+        bool                           pinned = true;
+        cv::Ptr<cv::DescriptorMatcher> matcher;
+
+        // Pose state — same EMA smoothing as SIFTTracker
+        cv::Mat rvec, tvec;
+        cv::Mat rvecSmooth, tvecSmooth;
+        bool    hasSmooth   = false;
+        bool    tracking    = false;
+        int     inlierCount = 0;
+
+        // Previous raw pose for warm starts — reset when the target is lost
+        PoseSolver solver;
+
+        // This frame's inlier live points (debug drawing)
+        std::vector<cv::Point2f> inlierPts;
+
+        // This frame's RANSAC / PNP time — targets run in parallel, so each
+        // keeps its own and track() sums them
+        StageTimings timings;
+    };
+
+    /* loadCalibration() - reads camera_matrix and distortion_coefficients */
+    bool loadCalibration();
+
+    /* createMatcher() - FLANN index matching the backend (KD-forest or LSH) */
+    cv::Ptr<cv::DescriptorMatcher> createMatcher() const;
+
+    /* trackDatabase() - steps 3a/3b and per-target pose in database mode */
+    void trackDatabase(const cv::Mat& liveDescriptors,
+                       const std::vector<char>& wasTracking);
+
+    /*
+     * estimateTargetPose()
+     * findHomography RANSAC + PoseSolver for one target on its own matches.
+     * Touches only that target, so targets can run in parallel.
+     */
+    void estimateTargetPose(Target& target,
+                            const std::vector<cv::DMatch>& matches) const;
+
+    /* Member variables */
+    std::string          m_calibrationFile;
+    int                  m_nfeatures;
+    FeatureBackend::Type m_backendType;
+    std::string          m_modelPath;
+    std::string          m_cacheDir;
+    float                m_smoothAlpha;     // blend factor: 0=no update, 1=raw pose
+
+    // Calibration
+    cv::Mat m_cameraMatrix;
+    cv::Mat m_distCoeffs;
+
+    std::vector<Target> m_targets;
+
+    // Shared detection — created once in initialize()
+    cv::Ptr<FeatureBackend>        m_refFeatures;    // nfeatures per reference
+    cv::Ptr<FeatureBackend>        m_liveFeatures;   // nfeatures x targets
+    cv::Ptr<cv::CLAHE>             m_clahe;
+    cv::Ptr<cv::DescriptorMatcher> m_matcher;        // one train set per target
+
+    // Database mode — target i of m_database is m_targets[m_databaseOffset + i]
+    TargetDatabase                 m_database;
+    int                            m_databaseOffset;
+    std::vector<int>               m_lastCandidates;
+    double                         m_lastRetrievalMs;
+
+    // Last frame, for debug drawing
+    std::vector<cv::KeyPoint> m_lastLiveKeypoints;
+    int                       m_lastMatchCount;
+    StageTimings              m_timings;
+};
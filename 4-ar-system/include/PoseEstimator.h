@@ -3,7 +3,10 @@
  * Author:      Krushna Sanjay Sharma
  * Description: Declares the PoseEstimator class responsible for:
  *              - Loading camera intrinsics from a calibration XML file
- *              - Detecting chessboard corners each frame
+ *              - Detecting chessboard corners each frame — by tracking the
+ *                previous corners when possible (see detectCorners())
+ *              - Or, in FIDUCIAL target mode, detecting a ChArUco board
+ *                (FiducialTarget) that still gives a pose when partly hidden
  *              - Running cv::solvePnP to get board rotation and translation
  *              - Printing real-time rotation and translation to the console
  *              - Projecting outer board corners and 3D axes onto the image
@@ -45,6 +48,10 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include "FiducialTarget.h"
+#include "PoseSolver.h"
+#include "StageTimings.h"
+#include <cvcore/frameContext.hpp>
 #include <vector>
 #include <string>
 
@@ -66,6 +73,17 @@ public:
     static constexpr int BOARD_WIDTH  = 9;
     static constexpr int BOARD_HEIGHT = 6;
 
+    /* Corner tracking: max deviation of a corner from the midpoint of its two
+     * grid neighbours, as a fraction of the local square size */
+    static constexpr float GRID_TOLERANCE = 0.25f;
+
+    /* Target type — the printed chessboard or the ChArUco fiducial board */
+    enum class TargetType
+    {
+        CHESSBOARD,     // findChessboardCorners + corner tracking (default)
+        FIDUCIAL        // ArUco markers of a ChArUco board (AR_WITH_ARUCO builds)
+    };
+
     /* Display mode — toggled with spacebar during runtime */
     enum class DisplayMode
     {
@@ -119,9 +137,65 @@ public:
         }
     }
 
+    /*
+     * setTrackingMode()
+     * When enabled (default), detectCorners() follows the previous frame's
+     * corners instead of searching the whole frame.
+     */
+    void setTrackingMode(bool enabled) { m_trackingMode = enabled; m_prevCorners.clear(); }
+    bool getTrackingMode() const       { return m_trackingMode; }
+
+    /*
+     * setTargetType()
+     * Switches between the chessboard and the fiducial board. Both share the
+     * world convention and the calibration; only detection changes. Returns
+     * false (and keeps the chessboard) if FIDUCIAL is not available.
+     */
+    bool       setTargetType(TargetType type);
+    TargetType getTargetType() const { return m_targetType; }
+
+    /* getFiducialTarget() - marker / corner counts of the last fiducial detection */
+    const FiducialTarget& getFiducialTarget() const { return m_fiducial; }
+
+    /* getSolver() - pose solver settings and timing */
+    PoseSolver&       getSolver()       { return m_solver; }
+    const PoseSolver& getSolver() const { return m_solver; }
+
+    /* getTimings() - per-stage ms of the last detectCorners() + estimatePose() */
+    const StageTimings& getTimings() const { return m_timings; }
+
+    /* cornersTracked() - true if the last detectCorners() succeeded by tracking */
+    bool cornersTracked() const { return m_cornersTracked; }
+
     // Methods used directly by augmentedReality.cpp (Tasks 4-6)
     bool loadCalibration();
+
+    /*
+     * setIntrinsics()
+     * Replaces the loaded calibration — e.g. with FrameUndistorter's camera
+     * matrix and zero distortion when frames are undistorted before
+     * detectCorners(). Pass the loaded values back to switch off.
+     */
+    void setIntrinsics(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs);
+
+    /*
+     * detectCorners()
+     * frame : BGR or already converted grayscale frame
+     * With tracking mode on and corners found last frame:
+     *   1. Predict every corner with pyramidal LK from the previous frame
+     *   2. Refine with cornerSubPix in a small 5x5 window
+     *   3. Accept only if all corners were tracked and the grid is consistent
+     * Otherwise (or if tracking fails) runs the full search: downscaled
+     * findChessboardCorners with CALIB_CB_FAST_CHECK, refined at full
+     * resolution (CameraCalibration::findBoardCorners).
+     * In FIDUCIAL mode FiducialTarget::detect() runs instead; the number of
+     * points then varies with what is visible, and the world point of each
+     * is kept for the estimatePose() that follows.
+     */
     bool detectCorners(const cv::Mat& frame, std::vector<cv::Point2f>& corners);
+
+    /* detectCorners() - same, on the frame context's shared grayscale */
+    bool detectCorners(cvcore::FrameContext& context, std::vector<cv::Point2f>& corners);
     bool estimatePose(const std::vector<cv::Point2f>& corners);
     void printPose() const;
     void projectOuterCorners(cv::Mat& frame) const;
@@ -137,6 +211,18 @@ protected:
      */
     void buildWorldPoints(std::vector<cv::Vec3f>& pointSet) const;
 
+    /* trackCorners() - steps 1-3 of detectCorners() tracking mode */
+    bool trackCorners(const cv::Mat& gray, std::vector<cv::Point2f>& corners) const;
+
+    /*
+     * isGridConsistent()
+     * Every interior corner must lie within GRID_TOLERANCE x square size of
+     * the midpoint of its left/right and up/down neighbours — a perspective
+     * view of a square grid is locally almost affine, a corner snapped onto
+     * the wrong square is not.
+     */
+    bool isGridConsistent(const std::vector<cv::Point2f>& corners) const;
+
     /* Member variables */
 
     std::string  m_calibrationFile;  // path to calibration XML
@@ -151,7 +237,23 @@ protected:
     cv::Mat m_rvec;                 // rotation vector    (3x1, Rodrigues)
     cv::Mat m_tvec;                 // translation vector (3x1)
     bool    m_poseValid;            // true after at least one successful solve
+    PoseSolver m_solver;            // IPPE + LM, warm from the previous pose
 
     // Board size as cv::Size
     cv::Size m_boardSize;
+
+    // Target being tracked; world points of the last detectCorners() result
+    TargetType             m_targetType;
+    FiducialTarget         m_fiducial;
+    std::vector<cv::Vec3f> m_gridPoints;     // fixed chessboard world points
+    std::vector<cv::Vec3f> m_objectPoints;   // world point of each fiducial point found
+
+    // Corner tracking state — previous grayscale frame and its corners
+    bool                     m_trackingMode;
+    bool                     m_cornersTracked;
+    cv::Mat                  m_prevGray;
+    std::vector<cv::Point2f> m_prevCorners;
+
+    // Stage timings of the current frame
+    StageTimings m_timings;
 };
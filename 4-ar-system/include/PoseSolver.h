@@ -0,0 +1,104 @@
+/*
+ * PoseSolver.h - Warm-Started Planar Pose Solver Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the PoseSolver class shared by PoseEstimator,
+ *              SIFTTracker and MultiTargetTracker. Replaces solving
+ *              cv::solvePnP(SOLVEPNP_ITERATIVE) from scratch every frame.
+ *
+ * Strategy per frame:
+ *   Lost (no previous pose, or the last solve failed):
+ *     - caller asks for inliers → cv::solvePnPRansac to find them
+ *     - otherwise              → direct solve below without a guess
+ *   Tracking:
+ *     - IPPE   : closed-form planar solve (SOLVEPNP_IPPE). Of its two
+ *                solutions the one nearest the previous rotation is kept,
+ *                which removes the flip ambiguity of near-frontal targets.
+ *     - ITERATIVE : Levenberg-Marquardt warm-started from the previous
+ *                rvec/tvec (useExtrinsicGuess) — converges in a few steps.
+ *     - Caller asks for inliers → points within the reprojection threshold;
+ *       too few inliers counts as lost and falls back to RANSAC.
+ *   Optional LM refinement (cv::solvePnPRefineLM) runs on inliers only.
+ *
+ * All object points must lie on the Z=0 plane for IPPE (chessboard and
+ * dollar-bill conventions both do).
+ *
+ * Each solve() is timed; lastSolveMs()/averageSolveMs() expose the cost.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/*
+ * PoseSolver
+ *
+ * One instance per tracked target — it keeps that target's previous pose.
+ */
+class PoseSolver
+{
+public:
+    enum Method { ITERATIVE = 0, IPPE };
+
+    // Minimum fraction of points that must stay inliers while tracking
+    static constexpr double MIN_INLIER_FRACTION = 0.5;
+
+    explicit PoseSolver(Method method = IPPE, bool refineLM = true);
+
+    /*
+     * solve()
+     * objectPoints : 3D target points (Z = 0 plane)
+     * imagePoints  : matching 2D image points (>= 4)
+     * rvec, tvec   : OUTPUT pose (CV_64F 3x1)
+     * inliers      : when non-null, outliers are expected — filled with
+     *                indices of points within reprojErrorPx
+     * Returns false on failure; the solver is then lost until the next
+     * success.
+     */
+    bool solve(const std::vector<cv::Vec3f>&   objectPoints,
+               const std::vector<cv::Point2f>& imagePoints,
+               const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+               cv::Mat& rvec, cv::Mat& tvec,
+               std::vector<int>* inliers = nullptr,
+               double reprojErrorPx = 4.0);
+
+    /* reset() - forget the previous pose (target lost) */
+    void reset() { m_warm = false; }
+
+    void   setMethod(Method method) { m_method = method; }
+    void   setRefineLM(bool enabled) { m_refineLM = enabled; }
+    Method getMethod()   const { return m_method; }
+    bool   getRefineLM() const { return m_refineLM; }
+    bool   isWarm()      const { return m_warm; }
+
+    /* Solver timing — last call and exponential average (ms) */
+    double lastSolveMs()    const { return m_lastMs; }
+    double averageSolveMs() const { return m_avgMs; }
+
+    /* methodName() - printable name of a Method */
+    static const char* methodName(Method method);
+
+private:
+    /* solveDirect() - IPPE or warm-started ITERATIVE on the given points */
+    bool solveDirect(const std::vector<cv::Vec3f>&   objectPoints,
+                     const std::vector<cv::Point2f>& imagePoints,
+                     const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                     cv::Mat& rvec, cv::Mat& tvec) const;
+
+    /* selectInliers() - indices of points reprojecting within maxErrorPx */
+    static void selectInliers(const std::vector<cv::Vec3f>&   objectPoints,
+                              const std::vector<cv::Point2f>& imagePoints,
+                              const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                              const cv::Mat& rvec, const cv::Mat& tvec,
+                              double maxErrorPx, std::vector<int>& inliers);
+
+    Method  m_method;
+    bool    m_refineLM;
+    bool    m_warm;         // previous pose valid
+    cv::Mat m_prevRvec;
+    cv::Mat m_prevTvec;
+    double  m_lastMs;
+    double  m_avgMs;
+};
@@ -0,0 +1,109 @@
+/*
+ * ReferenceCompiler.h - Offline Multi-View Reference Compiler Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the ReferenceCompiler which turns a flat reference
+ *              image into a compiled feature set for SIFTTracker and
+ *              MultiTargetTracker. A single-scale detection on the reference
+ *              only matches while the target appears about as large as the
+ *              reference photo; far away or steeply tilted it loses.
+ *
+ * compile():
+ *   1. CLAHE on the reference (same enhancement the trackers apply live)
+ *   2. Scale pyramid: SCALES (1, 0.6, 0.35) with INTER_AREA
+ *   3. Per scale, synthetic viewpoints: the frontal view plus the view
+ *      tilted by TILT (about 50 degrees) along 3 directions, ASIFT-style —
+ *      rotate, anti-alias, compress one axis
+ *   4. Detect + describe on every view, map each keypoint back to
+ *      reference pixels with the inverse affine warp
+ *   5. Deduplicate: a keypoint is dropped when an already kept one lies
+ *      within a few reference pixels AND its descriptor is nearly the same
+ *      (frontal scale-1 features are visited first, so they win)
+ *
+ * Compiled file (.arref, binary, little-endian as written by the host):
+ *   magic "ARREF1\0\0", backend type, reference width/height,
+ *   keypoint count, keypoints (x, y, size, angle, response, octave),
+ *   descriptor rows/cols/type, raw descriptor data
+ *
+ * Keypoint coordinates are always in ORIGINAL reference pixels, so
+ * refPointTo3D() and homography code work unchanged.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "FeatureBackend.h"
+#include <string>
+#include <vector>
+
+/* Compiled reference features of one planar target */
+struct CompiledReference
+{
+    FeatureBackend::Type      backend = FeatureBackend::SIFT;
+    cv::Size                  refSize;
+    std::vector<cv::KeyPoint> keypoints;     // reference pixel coordinates
+    cv::Mat                   descriptors;   // one row per keypoint
+};
+
+/*
+ * ReferenceCompiler
+ *
+ * Static helpers only — compile once offline (compileReference app),
+ * load at tracker startup.
+ */
+class ReferenceCompiler
+{
+public:
+    // Tilt factor of the synthetic viewpoints (1/cos 51 degrees)
+    static constexpr double TILT = 1.6;
+
+    // Dedupe radius in reference pixels at scale 1 (x tilt / scale per view)
+    static constexpr double DEDUPE_RADIUS_PX = 2.0;
+
+    /*
+     * compile()
+     * refGray  : 8-bit grayscale reference image (CLAHE applied inside)
+     * features : backend used for every view; its nfeatures caps each view
+     * out      : compiled keypoints/descriptors in reference pixels
+     * Returns false if no features were found.
+     */
+    static bool compile(const cv::Mat& refGray, FeatureBackend& features,
+                        CompiledReference& out);
+
+    /* save() - writes the binary .arref file. Returns false on I/O error. */
+    static bool save(const std::string& path, const CompiledReference& ref);
+
+    /* load() - reads a .arref file. Returns false if missing or malformed. */
+    static bool load(const std::string& path, CompiledReference& ref);
+
+    /*
+     * compiledPath()
+     * Default compiled file for a reference image: same path with the
+     * extension replaced by ".arref" (bill.jpg → bill.arref).
+     */
+    static std::string compiledPath(const std::string& imagePath);
+
+    /*
+     * loadFor()
+     * Loads the compiled file next to imagePath if it exists AND matches
+     * backend and refSize; prints why a stale file is ignored.
+     */
+    static bool loadFor(const std::string& imagePath, FeatureBackend::Type backend,
+                        const cv::Size& refSize, CompiledReference& ref);
+
+private:
+    /* One synthetic view: warped image, detection mask, warp ref → view */
+    struct View
+    {
+        cv::Mat image;
+        cv::Mat mask;     // empty = whole image
+        cv::Mat warp;     // 2x3 CV_64F, reference pixels → view pixels
+        double  scale;    // pyramid scale
+        double  radius;   // dedupe radius in reference pixels
+    };
+
+    /* makeView() - pyramid level base at scale, tilted along angleDeg */
+    static View makeView(const cv::Mat& base, double scale,
+                         double tilt, double angleDeg);
+};
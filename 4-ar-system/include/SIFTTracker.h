@@ -3,24 +3,55 @@
  * Author:      Krushna Sanjay Sharma
  * Description: Declares the SIFTTracker class which replaces the chessboard
  *              target with a dollar bill tracked via SIFT feature matching.
+ *              The detector is a FeatureBackend chosen per target (SIFT by
+ *              default; ORB, AKAZE or SuperPoint for slower devices).
  *              Uses the same calibration XML from Tasks 1-3.
  *              Pose is estimated with cv::solvePnP on matched feature points.
  *
  * Extension:   Uber Extension 2 — AR with SIFT feature points
  *
- * Pipeline per frame:
- *   1. Detect SIFT keypoints on live frame
- *   2. Match against pre-computed reference keypoints (BFMatcher + ratio test)
- *   3. Filter outliers with cv::findHomography (RANSAC)
+ * Pipeline per detection frame:
+ *   1. Detect SIFT keypoints on live frame — only inside the predicted
+ *      bill window while tracking (full frame on loss), optionally on a
+ *      downscaled image
+ *   2. Match against the reference index built once in loadReference()
+ *      (brute force, FLANN KD-forest or OpenCL brute force) + ratio test
+ *      + optional cross-check — or, while tracking, guided matching: each
+ *      reference keypoint is compared only with live keypoints near its
+ *      position under the predicted homography
+ *   3. Filter outliers with a RobustMethod — homography RANSAC, PROSAC or
+ *      MAGSAC++, or solvePnPRansac directly on the 3D bill points — with
+ *      confidence-based early termination and a per-frame time budget
  *   4. Map inlier 2D reference points → 3D world points on bill surface
- *   5. cv::solvePnP → rvec, tvec
+ *   5. PoseSolver (IPPE, warm from the previous pose, LM refine) → rvec, tvec
  *   6. cv::projectPoints → draw rocket via VirtualObject
  *
+ * Between detections (hybrid mode):
+ *   The inlier points of the last pose are followed frame-to-frame with
+ *   pyramidal Lucas-Kanade and pose comes from the warm PoseSolver on the
+ *   tracked points. SIFT re-runs when fewer than MIN_FLOW_POINTS survive, when the
+ *   flow pose fails, or every REDETECT_INTERVAL frames to bound drift.
+ *
+ * Latency budget (optional, setLatencyBudget):
+ *   A LatencyController moves detection frames along a ladder of cheaper
+ *   settings — fewer features, a smaller detection scale, a tighter
+ *   predicted window and a lower robust-estimation iteration cap — while
+ *   they exceed the budget, and back once there is headroom.
+ *
+ * After a loss (relocalisation):
+ *   Good detections are kept as keyframes in a KeyframeDatabase. While the
+ *   bill is lost, the full-frame descriptors query its bag-of-words index
+ *   and are matched only against the inlier sets of the best
+ *   RELOC_CANDIDATES keyframes; the global matcher runs only when none of
+ *   them gives a pose.
+ *
  * Key OpenCV functions:
- *   cv::SIFT::create()          - SIFT detector
- *   cv::BFMatcher               - brute-force descriptor matching
+ *   FeatureBackend              - SIFT / ORB / AKAZE / SuperPoint detector
+ *   cv::BFMatcher               - brute-force descriptor matching (CPU/OpenCL)
+ *   cv::FlannBasedMatcher       - approximate matching on a KD-forest index
  *   cv::findHomography()        - compute homography + RANSAC outlier rejection
- *   cv::solvePnP()              - estimate pose from 3D-2D correspondences
+ *   cv::calcOpticalFlowPyrLK()  - track inlier points between detections
+ *   PoseSolver                  - IPPE / warm-started PnP from 3D-2D matches
  *   cv::projectPoints()         - project 3D object onto image (in VirtualObject)
  *
  * World coordinate convention:
@@ -38,6 +69,13 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/features2d.hpp>
+#include "FeatureBackend.h"
+#include "KeyframeDatabase.h"
+#include "LatencyController.h"
+#include "PoseSolver.h"
+#include "StageTimings.h"
+#include <cvcore/frameContext.hpp>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -58,16 +96,90 @@ public:
     // Minimum inlier matches required to accept a pose estimate
     static constexpr int MIN_INLIERS = 8;
 
+    // Hybrid tracking: optical-flow frames allowed before a forced SIFT pass,
+    // and tracked points required to keep following the bill by flow
+    static constexpr int REDETECT_INTERVAL = 15;
+    static constexpr int MIN_FLOW_POINTS   = 12;
+
+    // Predicted detection window: growth around the predicted outline (at
+    // full quality — LatencyController tightens it), and smallest side (px)
+    // worth cropping to — below that, detect full frame
+    static constexpr float ROI_MARGIN   = 0.3f;
+    static constexpr int   MIN_ROI_SIZE = 48;
+
+    // Guided matching: search radius (px) around a reference keypoint's
+    // predicted live position; also the bucket size of the live-keypoint grid
+    static constexpr float GUIDED_RADIUS = 24.0f;
+
+    // Relocalisation: keyframes tried per lost frame, inliers a detection
+    // needs to become a keyframe, and detections between keyframe attempts
+    static constexpr int RELOC_CANDIDATES    = 3;
+    static constexpr int MIN_KEYFRAME_POINTS = 20;
+    static constexpr int KEYFRAME_INTERVAL   = 3;
+
+    // Lowe's ratio test threshold — lower = fewer but more reliable matches
+    static constexpr float RATIO_THRESHOLD = 0.65f;
+
+    // Ratio threshold for binary (Hamming) descriptors, whose distances are
+    // coarser — 0.65 would reject most correct ORB/AKAZE matches
+    static constexpr float BINARY_RATIO_THRESHOLD = 0.75f;
+
+    // CLAHE applied to reference and live frames (part of the cache key)
+    static constexpr double CLAHE_CLIP  = 2.0;
+    static constexpr int    CLAHE_TILES = 8;
+
+    /*
+     * Descriptor matching strategy. The reference descriptors never change,
+     * so each matcher holds them as a trained index and only the live
+     * descriptors are sent per frame.
+     *   BRUTE_FORCE : exact L2 search on the CPU (original behaviour)
+     *   FLANN       : randomized KD-forest, approximate but much faster
+     *                 once the reference has several hundred keypoints
+     *   GPU_BRUTE   : exact search on the device — CUDA brute force next to
+     *                 the CUDA-ORB backend (descriptors never leave the GPU),
+     *                 otherwise OpenCL (T-API); falls back to BRUTE_FORCE
+     *                 when no device is available
+     */
+    enum MatcherType { BRUTE_FORCE = 0, FLANN, GPU_BRUTE, MATCHER_COUNT };
+
+    /*
+     * Outlier rejection before the pose solve. Matches reach it ordered by
+     * ratio-test score (best first), which PROSAC samples from.
+     *   RANSAC_H   : cv::findHomography RANSAC (original behaviour)
+     *   PROSAC     : USAC_PROSAC homography — progressive sampling from the
+     *                best-ranked matches
+     *   MAGSAC     : USAC_MAGSAC homography — MAGSAC++ scoring, less
+     *                sensitive to the threshold
+     *   PNP_RANSAC : cv::solvePnPRansac (PROSAC sampler) on the refPointTo3D
+     *                points — inliers judged on the pose, with distortion
+     */
+    enum RobustMethod { RANSAC_H = 0, PROSAC, MAGSAC, PNP_RANSAC, ROBUST_COUNT };
+
+    // Live-feature count the LatencyController scales when nfeatures is 0
+    static constexpr int LATENCY_BASE_FEATURES = 1000;
+
+    // Robust estimation: inlier threshold (px), confidence at which sampling
+    // stops early, and the iteration cap range of the time-budget control
+    // (the top of the range drops with the LatencyController level)
+    static constexpr double ROBUST_THRESHOLD_PX = 5.0;
+    static constexpr double ROBUST_CONFIDENCE   = 0.995;
+    static constexpr int    ROBUST_MAX_ITERS    = 2000;
+    static constexpr int    ROBUST_MIN_ITERS    = 50;
+
     /*
      * Constructor
      * calibrationFile : path to calibration XML (from calibrateCamera app)
      * referenceImage  : path to a flat photo of the dollar bill
-     * nfeatures       : max SIFT features per frame (0 = unlimited)
+     * nfeatures       : max features per frame (0 = backend default)
      *                   Higher = more matches but slower. 800 is a good balance.
+     * backend         : keypoint detector/descriptor for this target
+     * modelPath       : SuperPoint ONNX model (backend == SUPERPOINT only)
      */
     SIFTTracker(const std::string& calibrationFile,
                 const std::string& referenceImage,
-                int nfeatures = 300);
+                int nfeatures = 300,
+                FeatureBackend::Type backend = FeatureBackend::SIFT,
+                const std::string& modelPath = "");
 
     /*
      * initialize()
@@ -84,12 +196,109 @@ public:
      */
     bool track(const cv::Mat& frame);
 
+    /* track() - same, on the frame context's shared grayscale */
+    bool track(cvcore::FrameContext& context);
+
     /*
      * drawDebug()
      * Draws matched keypoints and inlier count on displayFrame.
      */
     void drawDebug(cv::Mat& displayFrame) const;
 
+    /*
+     * setMatcher()
+     * Selects the matching strategy and rebuilds the reference index.
+     * May be called before or after initialize().
+     */
+    void setMatcher(MatcherType type);
+
+    /* cycleMatcher() - switches to the next MatcherType */
+    void cycleMatcher();
+
+    /* setRobustMethod() - outlier rejection used by estimatePose() */
+    void setRobustMethod(RobustMethod method) { m_robustMethod = method; }
+
+    /* cycleRobustMethod() - switches to the next RobustMethod */
+    void cycleRobustMethod();
+
+    /*
+     * setRobustBudget()
+     * Time budget (ms) for outlier rejection per frame (default 5, 0 = no
+     * budget). When a solve runs over, the iteration cap is scaled down for
+     * the next frame; it grows back while solves stay under half the budget.
+     */
+    void setRobustBudget(double ms) { m_robustBudgetMs = ms; }
+
+    /*
+     * setCrossCheck()
+     * When enabled, a reference keypoint keeps only its closest live match,
+     * so two live points can no longer vote for the same reference point.
+     */
+    void setCrossCheck(bool enabled) { m_crossCheck = enabled; }
+
+    /*
+     * setOpticalFlow()
+     * Enables hybrid tracking (default on). When disabled, SIFT runs on
+     * every frame as before.
+     */
+    void setOpticalFlow(bool enabled);
+
+    /*
+     * setRoiDetection()
+     * While tracking, SIFT runs only inside the last bill outline moved by
+     * its last frame-to-frame motion and grown by ROI_MARGIN (default on).
+     */
+    void setRoiDetection(bool enabled) { m_useRoi = enabled; }
+
+    /*
+     * setLatencyBudget()
+     * Target ms per detection frame for the LatencyController; 0 (default)
+     * switches it off and restores the constructor's quality settings.
+     * Features are only ever reduced below the constructor's nfeatures
+     * (LATENCY_BASE_FEATURES when that is 0 = unlimited).
+     */
+    void setLatencyBudget(double ms);
+
+    /*
+     * setGuidedMatching()
+     * While tracking, matches each reference keypoint only against live
+     * keypoints within GUIDED_RADIUS of where the predicted homography puts
+     * it, instead of a global k-NN search (default on). Falls back to the
+     * global matcher when too few guided matches survive.
+     */
+    void setGuidedMatching(bool enabled) { m_useGuided = enabled; }
+
+    /*
+     * setRelocalisation()
+     * Stores keyframes of good detections and, while lost, matches against
+     * the best of them before the whole reference (default on). Disabling
+     * drops the stored keyframes.
+     */
+    void setRelocalisation(bool enabled);
+
+    /*
+     * setIntrinsics()
+     * Replaces the loaded calibration — e.g. with FrameUndistorter's camera
+     * matrix and zero distortion when frames are undistorted before track().
+     * Resets the temporal state (flow points, predicted window, warm pose).
+     */
+    void setIntrinsics(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs);
+
+    /*
+     * setCacheDirectory()
+     * Enables the AssetCache in dir (e.g. data/cache): reference keypoints
+     * and descriptors are stored after the first detection and read back on
+     * later starts. Call before initialize(). Empty = no cache (default).
+     */
+    void setCacheDirectory(const std::string& dir) { m_cacheDir = dir; }
+
+    /*
+     * setDetectScale()
+     * Resizes the detection image by scale (0.25-1.0, default 1.0) before
+     * SIFT. SIFT is scale invariant, so the full-size reference still matches.
+     */
+    void setDetectScale(double scale);
+
     /* Accessors — return SMOOTHED pose for stable rendering */
     const cv::Mat& getRvec()         const { return m_hasSmooth ? m_rvecSmooth : m_rvec; }
     const cv::Mat& getTvec()         const { return m_hasSmooth ? m_tvecSmooth : m_tvec; }
@@ -97,22 +306,66 @@ public:
     const cv::Mat& getDistCoeffs()   const { return m_distCoeffs; }
     bool           isTracking()      const { return m_tracking; }
     int            getInlierCount()  const { return m_inlierCount; }
+    MatcherType    getMatcher()      const { return m_matcherType; }
+    RobustMethod   getRobustMethod() const { return m_robustMethod; }
+    bool           getCrossCheck()   const { return m_crossCheck; }
+    bool           getOpticalFlow()  const { return m_useFlow; }
+    bool           isFlowFrame()     const { return m_flowFrame; }
+    bool           getRoiDetection() const { return m_useRoi; }
+    bool           getGuidedMatching() const { return m_useGuided; }
+    bool           getRelocalisation() const { return m_useReloc; }
+    bool           isRelocalised()   const { return m_relocFrame; }
+    int            getKeyframeCount() const { return m_keyframes.size(); }
+    double         getDetectScale()  const { return m_detectScale; }
+    double         getLatencyBudget() const { return m_latency.budgetMs(); }
+
+    /* getLatencyController() - level and smoothed frame time */
+    const LatencyController& getLatencyController() const { return m_latency; }
+
+    FeatureBackend::Type getBackend() const { return m_backendType; }
+
+    /* getSolver() - pose solver settings and timing */
+    PoseSolver&       getSolver()       { return m_solver; }
+    const PoseSolver& getSolver() const { return m_solver; }
+
+    /* getTimings() - per-stage ms of the last track() call */
+    const StageTimings& getTimings() const { return m_timings; }
+
+    /* matcherName() - printable name of a MatcherType */
+    static const char* matcherName(MatcherType type);
+
+    /* robustMethodName() - printable name of a RobustMethod */
+    static const char* robustMethodName(RobustMethod method);
+
+    /*
+     * referenceCacheKey()
+     * AssetCache key of a reference's features: image bytes, backend,
+     * nfeatures, model and CLAHE settings. 0 if the image cannot be read.
+     */
+    static uint64_t referenceCacheKey(const std::string& imagePath,
+                                      FeatureBackend::Type backend,
+                                      int nfeatures, const std::string& modelPath);
 
 private:
     /* loadCalibration() - reads camera_matrix and distortion_coefficients */
     bool loadCalibration();
 
-    /* loadReference() - loads reference image and computes SIFT features */
+    /* loadReference() - loads reference image and its compiled or fresh features */
     bool loadReference();
 
+    /* buildMatcher() - creates m_matcher and trains it on m_refDescriptors */
+    void buildMatcher();
+
+    /* matcherLabel() - matcher name with index kind and fallback state */
+    std::string matcherLabel() const;
+
     /*
      * matchFeatures()
-     * Matches live frame descriptors against reference descriptors.
-     * Applies Lowe's ratio test to filter weak matches.
+     * Matches live frame descriptors against the reference index.
+     * Applies Lowe's ratio test and the optional cross-check.
      * Returns good matches.
      */
-    std::vector<cv::DMatch> matchFeatures(
-        const cv::Mat& liveDescriptors) const;
+    std::vector<cv::DMatch> matchFeatures(const cv::Mat& liveDescriptors);
 
     /*
      * estimatePose()
@@ -124,6 +377,86 @@ private:
         const std::vector<cv::KeyPoint>& liveKeypoints,
         const std::vector<cv::DMatch>&   goodMatches);
 
+    /*
+     * trackFlow()
+     * Follows m_flowLivePts from m_prevGray into gray with pyramidal LK,
+     * then solves pose on the survivors (PoseSolver, RANSAC only if most
+     * points fail). Keeps only inliers for the next frame. Returns true on success.
+     */
+    bool trackFlow(const cv::Mat& gray);
+
+    /* smoothPose() - blends the raw pose into the EMA-smoothed pose */
+    void smoothPose();
+
+    /*
+     * detectAndEstimate()
+     * SIFT detection inside roi (whole frame if empty) masked by window,
+     * then matching (guided when requested and a prediction exists) and
+     * estimatePose(). Returns true on success.
+     */
+    bool detectAndEstimate(const cv::Mat& gray, const cv::Rect& roi,
+                           const std::vector<cv::Point>& window, bool guided);
+
+    /*
+     * matchGuided()
+     * Projects every reference keypoint with H (reference → live pixels) and
+     * compares it only with the live keypoints bucketed within
+     * GUIDED_RADIUS. Same ratio test and cross-check as matchFeatures().
+     */
+    std::vector<cv::DMatch> matchGuided(const std::vector<cv::KeyPoint>& liveKeypoints,
+                                        const cv::Mat& liveDescriptors,
+                                        const cv::Mat& H) const;
+
+    /*
+     * relocalise()
+     * Lost-mode matching: ranks the keyframes by bag-of-words score and runs
+     * estimatePose() on the matches against each of the best
+     * RELOC_CANDIDATES in turn. Returns true on the first pose.
+     */
+    bool relocalise(const std::vector<cv::KeyPoint>& liveKeypoints,
+                    const cv::Mat& liveDescriptors);
+
+    /*
+     * matchKeyframe()
+     * k=2 match of the live descriptors against one keyframe's descriptors,
+     * ratio test and cross-check as in matchFeatures(). trainIdx of the
+     * result is the REFERENCE keypoint, so estimatePose() takes it as is.
+     */
+    std::vector<cv::DMatch> matchKeyframe(const Keyframe& keyframe,
+                                          const cv::Mat& liveDescriptors) const;
+
+    /*
+     * addKeyframe()
+     * Offers the inliers of the pose just estimated to the keyframe store
+     * every KEYFRAME_INTERVAL detections with MIN_KEYFRAME_POINTS inliers.
+     */
+    void addKeyframe(const std::vector<cv::KeyPoint>& liveKeypoints,
+                     const cv::Mat& liveDescriptors,
+                     const std::vector<cv::DMatch>& goodMatches);
+
+    /*
+     * rejectOutliers()
+     * Runs m_robustMethod on the correspondences and fills inliers (one
+     * flag per match). Returns false when no model was found.
+     */
+    bool rejectOutliers(const std::vector<cv::Point2f>& refPts,
+                        const std::vector<cv::Point2f>& livePts,
+                        std::vector<bool>& inliers);
+
+    /* predictOutline() - last outline moved by its last frame-to-frame motion */
+    std::vector<cv::Point2f> predictOutline() const;
+
+    /* updateOutline() - projects the bill corners with the current pose */
+    void updateOutline();
+
+    /*
+     * predictWindow()
+     * Returns the detection ROI for the next SIFT pass and its polygon in
+     * window, or an empty rect when the whole frame should be searched.
+     */
+    cv::Rect predictWindow(const cv::Size& frameSize,
+                           std::vector<cv::Point>& window) const;
+
     /*
      * refPointTo3D()
      * Maps a 2D reference image point to a 3D world point on the bill surface.
@@ -132,10 +465,17 @@ private:
      */
     cv::Vec3f refPointTo3D(const cv::Point2f& refPt) const;
 
+    /* Knobs of the current LatencyController level */
+    void   applyLatencyLevel();
+    double effectiveDetectScale() const;
+
     /* Member variables */
     std::string m_calibrationFile;
     std::string m_referenceImagePath;
     int         m_nfeatures;
+    FeatureBackend::Type m_backendType;
+    std::string          m_modelPath;
+    std::string          m_cacheDir;
 
     // Calibration
     cv::Mat m_cameraMatrix;
@@ -146,9 +486,25 @@ private:
     std::vector<cv::KeyPoint>    m_refKeypoints;
     cv::Mat                      m_refDescriptors;
 
-    // SIFT detector and CLAHE enhancer — created once, reused every frame
-    cv::Ptr<cv::SIFT>  m_sift;
-    cv::Ptr<cv::CLAHE> m_clahe;
+    // Feature backend and CLAHE enhancer — created once, reused every frame
+    cv::Ptr<FeatureBackend> m_features;
+    cv::Ptr<cv::CLAHE>      m_clahe;
+
+    // Matcher trained on the reference descriptors — rebuilt only when the
+    // reference or the strategy changes
+    cv::Ptr<cv::DescriptorMatcher> m_matcher;
+    MatcherType                    m_matcherType;
+    bool                           m_useOpenCL;    // GPU_BRUTE active on a device
+    bool                           m_deviceMatching; // GPU_BRUTE inside the CUDA backend
+    bool                           m_crossCheck;
+
+    // Outlier rejection and its time-budgeted iteration cap
+    RobustMethod                   m_robustMethod;
+    double                         m_robustBudgetMs;
+    int                            m_robustIters;
+
+    // Pose solver — keeps the previous raw pose for warm starts
+    PoseSolver m_solver;
 
     // Current frame tracking state
     cv::Mat m_rvec;
@@ -162,8 +518,38 @@ private:
     bool    m_hasSmooth;          // true after first successful pose
     float   m_smoothAlpha;        // blend factor: 0=no update, 1=raw pose
 
+    // Hybrid tracking state — 3D bill points and their current image
+    // positions, carried from the last detection through the flow frames
+    bool                     m_useFlow;
+    bool                     m_flowFrame;         // last track() used flow
+    int                      m_framesSinceDetect;
+    cv::Mat                  m_prevGray;
+    std::vector<cv::Point2f> m_flowLivePts;
+    std::vector<cv::Vec3f>   m_flowObjPts;
+
+    // Predicted-window detection — bill outline in the last two tracked
+    // frames (constant-velocity prediction) and the window last searched
+    bool                     m_useRoi;
+    bool                     m_useGuided;
+    double                   m_detectScale;
+    std::vector<cv::Point2f> m_outline;
+    std::vector<cv::Point2f> m_prevOutline;
+    cv::Rect                 m_lastRoi;
+
+    // Keyframe relocalisation — views stored from good detections
+    bool                     m_useReloc;
+    bool                     m_relocFrame;        // last track() reacquired via a keyframe
+    int                      m_detectionsSinceKeyframe;
+    KeyframeDatabase         m_keyframes;
+
     // Last good matches for debug drawing
     std::vector<cv::KeyPoint> m_lastLiveKeypoints;
     std::vector<cv::DMatch>   m_lastGoodMatches;
     std::vector<bool>         m_lastInlierMask;
+
+    // Stage timings of the last track() call
+    StageTimings m_timings;
+
+    // Detection-frame quality vs. the per-frame latency budget
+    LatencyController m_latency;
 };
@@ -0,0 +1,93 @@
+/*
+ * StageTimings.h - Per-Frame Tracking Stage Timings
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares StageTimings, filled by PoseEstimator, SIFTTracker
+ *              and MultiTargetTracker on every frame, and the StageTimer
+ *              scope guard used to fill it. Read by the arBench app to
+ *              report where tracking time goes.
+ *
+ * Stages not run on a frame stay at 0 (e.g. DETECT on an optical-flow frame).
+ * FLOW is frame-to-frame tracking: LK on the bill inliers, or the chessboard
+ * corner tracker in PoseEstimator.
+ * MultiTargetTracker runs RANSAC and PNP per target in parallel; those two
+ * are summed over targets (CPU time, not wall time).
+ *
+ * StageTimer also attributes the allocations of its thread to the cvcore
+ * AllocStage "ar <stage>" (counted with CVCORE_ALLOC_TRACKING only).
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <cvcore/allocTracking.hpp>
+#include <array>
+#include <chrono>
+#include <string>
+
+/* Milliseconds spent in each tracking stage of the last frame */
+struct StageTimings
+{
+    enum Stage { GRAY = 0, CLAHE, DETECT, FLOW, MATCH, RANSAC, PNP, DRAW, STAGE_COUNT };
+
+    double ms[STAGE_COUNT] = {};
+
+    void clear()
+    {
+        for (double& v : ms) v = 0.0;
+    }
+
+    /* stageName() - lower-case name, also used as the JSON key */
+    static const char* stageName(int stage)
+    {
+        static const char* names[STAGE_COUNT] = {
+            "gray", "clahe", "detect", "flow", "match", "ransac", "pnp", "draw"
+        };
+        return stage >= 0 && stage < STAGE_COUNT ? names[stage] : "?";
+    }
+
+    /* allocStage() - allocation totals of a stage, looked up once */
+    static cvcore::AllocStage& allocStage(Stage stage)
+    {
+        static const std::array<cvcore::AllocStage*, STAGE_COUNT> stages = [] {
+            std::array<cvcore::AllocStage*, STAGE_COUNT> list{};
+            for (int i = 0; i < STAGE_COUNT; ++i)
+                list[i] = &cvcore::AllocStage::get(std::string("ar ") + stageName(i));
+            return list;
+        }();
+        return *stages[stage];
+    }
+};
+
+/*
+ * StageTimer
+ *
+ * Adds the time between construction and destruction to one stage:
+ *   { StageTimer t(m_timings, StageTimings::MATCH); ...matching...; }
+ */
+class StageTimer
+{
+public:
+    StageTimer(StageTimings& timings, StageTimings::Stage stage)
+        : m_timings(timings)
+        , m_stage(stage)
+        , m_allocs(StageTimings::allocStage(stage))
+        , m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~StageTimer()
+    {
+        m_timings.ms[m_stage] += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - m_start).count();
+    }
+
+    StageTimer(const StageTimer&)            = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    StageTimings&                         m_timings;
+    StageTimings::Stage                   m_stage;
+    cvcore::AllocStageScope               m_allocs;
+    std::chrono::steady_clock::time_point m_start;
+};
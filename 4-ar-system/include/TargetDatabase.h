@@ -0,0 +1,153 @@
+/*
+ * TargetDatabase.h - Vocabulary-Tree Target Database Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the TargetDatabase class which lets
+ *              MultiTargetTracker recognise one of several hundred flat
+ *              targets (product packages, posters, book covers). Matching
+ *              every live descriptor against every reference grows with the
+ *              number of targets; here each frame is first turned into a
+ *              bag-of-words vector and scored against all targets through an
+ *              inverted file, and full matching + pose run only on the few
+ *              best candidates.
+ *
+ * Vocabulary tree (Nister & Stewenius):
+ *   Hierarchical k-means over every reference descriptor: BRANCHING
+ *   children per node, DEPTH levels, leaves are the words (up to
+ *   BRANCHING^DEPTH). A descriptor is quantised by descending from the
+ *   root — BRANCHING x DEPTH distance computations instead of one per word.
+ *   Float descriptors (SIFT, SuperPoint) cluster with cv::kmeans; binary
+ *   ones (ORB, AKAZE) with k-majority (bitwise majority vote centres,
+ *   Hamming distance).
+ *
+ * Scoring:
+ *   Word weight idf = ln((1 + N) / n_w), N targets, n_w of them containing
+ *   the word. Target and frame vectors are tf x idf, L1-normalised, and
+ *   compared with sum(min(q, d)) in [0, 1] (= 1 - |q - d|_1 / 2, the same
+ *   similarity as KeyframeDatabase). Only targets sharing a word with the
+ *   frame are touched.
+ *
+ * Database file (.ardb, binary, little-endian as written by the host):
+ *   magic "ARTDB1\0\0", backend type, tree (node count, per node first
+ *   child / child count / word, centre matrix), word count and idf, target
+ *   count and per target: name, size in cm, reference size, keypoints,
+ *   descriptors and tf-idf vector. The inverted file is rebuilt on load.
+ *   Keypoints are in reference pixels, as in .arref files.
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "FeatureBackend.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+/* One target of the database — features and physical size */
+struct DatabaseTarget
+{
+    std::string               name;
+    float                     widthCm  = 0.0f;
+    float                     heightCm = 0.0f;
+    cv::Size                  refSize;
+    std::vector<cv::KeyPoint> keypoints;     // reference pixel coordinates
+    cv::Mat                   descriptors;   // one row per keypoint
+
+    // Sparse tf-idf vector: (word, weight) ascending by word, weights sum to 1
+    std::vector<std::pair<int, float>> bow;
+};
+
+/*
+ * TargetDatabase
+ *
+ * Usage:
+ *   Offline (buildTargetDatabase app):
+ *     db.build(targets, backend);  db.save("products.ardb");
+ *   Per frame:
+ *     for (const auto& c : db.query(liveDescriptors, 4)) ... c.target ...
+ */
+class TargetDatabase
+{
+public:
+    using BowVector = std::vector<std::pair<int, float>>;
+
+    // Tree shape — 10 x 4 gives up to 10 000 words
+    static constexpr int BRANCHING = 10;
+    static constexpr int DEPTH     = 4;
+
+    // Clustering iterations per node (k-means / k-majority)
+    static constexpr int CLUSTER_ITERATIONS = 10;
+
+    // Candidates scoring below this share too few words to be worth matching
+    static constexpr float MIN_QUERY_SCORE = 0.02f;
+
+    /* One retrieved target */
+    struct Candidate
+    {
+        int   target;
+        float score;
+    };
+
+    /*
+     * build()
+     * Trains the tree on every target's descriptors, then computes each
+     * target's vector and the inverted file. All targets must carry
+     * descriptors of the same backend. Returns false if none have any.
+     */
+    bool build(std::vector<DatabaseTarget> targets, FeatureBackend::Type backend);
+
+    /* save() - writes the .ardb file. Returns false on I/O error. */
+    bool save(const std::string& path) const;
+
+    /* load() - reads a .ardb file. Returns false if missing or malformed. */
+    bool load(const std::string& path);
+
+    /* transform() - tf-idf vector of a set of descriptors */
+    BowVector transform(const cv::Mat& descriptors) const;
+
+    /*
+     * query()
+     * Up to maxResults targets, best score first, scoring at least
+     * MIN_QUERY_SCORE against the descriptors.
+     */
+    std::vector<Candidate> query(const cv::Mat& descriptors, int maxResults) const;
+
+    const DatabaseTarget& target(int index) const { return m_targets[index]; }
+    int                   size()      const { return static_cast<int>(m_targets.size()); }
+    bool                  empty()     const { return m_targets.empty(); }
+    int                   wordCount() const { return static_cast<int>(m_idf.size()); }
+    FeatureBackend::Type  backend()   const { return m_backend; }
+
+private:
+    /* split() - clusters rows of node's descriptors into its children, recursively */
+    void split(const cv::Mat& descriptors, const std::vector<int>& rows,
+               int node, int level);
+
+    /* cluster() - k-means (float) or k-majority (binary) of samples into k centres */
+    static void cluster(const cv::Mat& samples, int k,
+                        std::vector<int>& labels, cv::Mat& centres);
+
+    /* quantize() - leaf word of one descriptor row */
+    int quantize(const uchar* descriptor) const;
+
+    /* distance() - squared L2 (float) or Hamming (binary) between two rows */
+    double distance(const uchar* a, const uchar* b) const;
+
+    /* rebuildIndex() - inverted file from the target vectors */
+    void rebuildIndex();
+
+    FeatureBackend::Type m_backend = FeatureBackend::SIFT;
+
+    // Tree: node i's centre is row i of m_centres (row 0, the root, unused);
+    // inner nodes have children [firstChild, firstChild + childCount),
+    // leaves have childCount 0 and a word index
+    cv::Mat          m_centres;
+    std::vector<int> m_firstChild;
+    std::vector<int> m_childCount;
+    std::vector<int> m_word;
+
+    std::vector<float>                                m_idf;       // per word
+    std::vector<DatabaseTarget>                       m_targets;
+    std::vector<std::vector<std::pair<int, float>>>   m_inverted;  // word → (target, weight)
+};
@@ -36,6 +36,8 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 
+class GLRenderer;
+
 /*
  * EagleLineSegment
  * Represents one 3D line — start point, end point, color, thickness.
@@ -52,8 +54,9 @@ struct EagleLineSegment
  * VirtualEagleObject
  *
  * Stores the eagle geometry as a list of EagleLineSegments in 3D world space.
- * On each frame, draw() collects all endpoints, calls cv::projectPoints() once,
- * then draws each line segment between its projected 2D positions.
+ * On each frame, draw() projects the packed endpoint buffer with one
+ * cv::projectPoints() call, then draws each line segment between its
+ * projected 2D positions (cv::line, or batched through a GLRenderer).
  *
  * Usage:
  *   VirtualEagleObject eagle;
@@ -92,8 +95,18 @@ public:
               const cv::Mat& cameraMatrix,
               const cv::Mat& distCoeffs) const;
 
+    /* draw() - GPU variant, segments queued on renderer */
+    void draw(GLRenderer&    renderer,
+              const cv::Mat& rvec,
+              const cv::Mat& tvec,
+              const cv::Mat& cameraMatrix,
+              const cv::Mat& distCoeffs) const;
+
     /* clear() */
-    void clear() { m_lines.clear(); }
+    void clear() { m_lines.clear(); m_vertices.clear(); }
+
+    /* segmentCount() */
+    int segmentCount() const { return static_cast<int>(m_lines.size()); }
 
 private:
     /* addLine() — appends one transformed EagleLineSegment
@@ -109,9 +122,19 @@ private:
     void buildWings();   // spread wings left and right
     void buildTail();    // fan of tail feathers
 
+    /* project() - projects m_vertices into m_projected and returns it */
+    const std::vector<cv::Point2f>& project(const cv::Mat& rvec,
+                                            const cv::Mat& tvec,
+                                            const cv::Mat& cameraMatrix,
+                                            const cv::Mat& distCoeffs) const;
+
     /* Line storage */
     std::vector<EagleLineSegment> m_lines;
 
+    /* Packed endpoints (i*2 = start, i*2+1 = end) and reused projection */
+    std::vector<cv::Vec3f>           m_vertices;
+    mutable std::vector<cv::Point2f> m_projected;
+
     /* Transform */
     cv::Vec3f m_offset;
     float     m_scale;
@@ -0,0 +1,104 @@
+/*
+ * VirtualMesh.h - Triangle Mesh Virtual Object Header
+ * Author:      Krushna Sanjay Sharma
+ * Description: Declares the VirtualMesh class — a virtual object loaded from
+ *              a Wavefront OBJ file instead of hand-built line segments, and
+ *              rendered as shaded triangles by GLRenderer.
+ *
+ * Buffers:
+ *   The OBJ is parsed once into a base vertex/index set. addInstance()
+ *   appends transformed copies of it (offset, scale, yaw) to ONE packed
+ *   vertex/colour/index buffer, which is uploaded to the GPU on the first
+ *   draw and never touched again. Per frame the only CPU→GPU traffic is the
+ *   target's model-view matrix (GLRenderer::addMesh), however many
+ *   instances the target carries.
+ *
+ * Shading:
+ *   Lambert shading against a fixed light is baked into per-vertex colours
+ *   at load time — no GL lighting state, the pose is the only input.
+ *
+ * Coordinate convention:
+ *   OBJ files are Y-up; the model is rotated so OBJ +Y becomes world +Z
+ *   (away from the target plane), rescaled so its largest extent is size,
+ *   and centred with its base on Z = 0. flipY/flipZ work as in
+ *   VirtualObject::buildRocket() (bill: both true).
+ *
+ * Date: March 2026
+ */
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/opengl.hpp>
+#include <string>
+#include <vector>
+
+/*
+ * VirtualMesh
+ *
+ * Usage:
+ *   VirtualMesh mesh;
+ *   mesh.loadOBJ("data/duck.obj", 2.0f);       // once
+ *   mesh.addInstance(cv::Vec3f(2, -2.5f, 0));  // once per copy
+ *   mesh.addInstance(cv::Vec3f(6, -2.5f, 0), 1.0f, 90.0f);
+ *   renderer.addMesh(mesh, rvec, tvec);        // each frame, per target
+ */
+class VirtualMesh
+{
+public:
+    VirtualMesh();
+
+    /*
+     * loadOBJ()
+     * path  : Wavefront OBJ (v / f records; polygons are fan-triangulated,
+     *         texture/normal indices and other records are ignored)
+     * size  : largest model extent after loading, in target units
+     * color : base BGR colour, shaded per vertex
+     * Clears existing instances. Returns false if the file has no triangles.
+     */
+    bool loadOBJ(const std::string& path,
+                 float              size  = 2.0f,
+                 const cv::Scalar&  color = cv::Scalar(180, 180, 180),
+                 bool               flipY = false,
+                 bool               flipZ = false);
+
+    /*
+     * addInstance()
+     * Appends one copy of the model at offset (target units), scaled and
+     * rotated by yawDeg about the target's Z axis.
+     */
+    void addInstance(const cv::Vec3f& offset, float scale = 1.0f, float yawDeg = 0.0f);
+
+    /* clearInstances() - removes all copies, keeps the loaded model */
+    void clearInstances();
+
+    bool empty()         const { return m_indices.empty(); }
+    int  instanceCount() const { return m_instances; }
+    int  triangleCount() const { return static_cast<int>(m_indices.size() / 3); }
+    int  vertexCount()   const { return static_cast<int>(m_vertices.size()); }
+
+    /*
+     * drawGL()
+     * Issues the indexed triangle draw with the current GL matrices.
+     * Must run inside the GL context (GLRenderer's draw callback); uploads
+     * the packed buffers on first use or after the instances changed.
+     */
+    void drawGL() const;
+
+private:
+    // Loaded model (after axis mapping, normalisation and flips)
+    std::vector<cv::Vec3f> m_baseVertices;
+    std::vector<cv::Vec3b> m_baseColors;     // RGB, shaded
+    std::vector<int>       m_baseIndices;
+
+    // Packed buffers — all instances
+    std::vector<cv::Vec3f> m_vertices;
+    std::vector<cv::Vec3b> m_colors;
+    std::vector<int>       m_indices;
+    int                    m_instances;
+
+    // GPU copies, created on the first drawGL() after a change
+    mutable cv::ogl::Arrays m_gpuArrays;
+    mutable cv::ogl::Buffer m_gpuIndices;
+    mutable bool            m_uploaded;
+};
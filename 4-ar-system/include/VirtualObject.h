@@ -29,6 +29,8 @@
  * Key OpenCV function:
  *   cv::projectPoints() — projects the 3D line endpoints onto the 2D image
  *   using rvec, tvec, cameraMatrix, distCoeffs from PoseEstimator.
+ *   Endpoints are packed into one vertex buffer at build time and projected
+ *   into a reused output buffer, so per-frame cost is the projection only.
  *
  * Date: March 2026
  */
@@ -38,6 +40,8 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 
+class GLRenderer;
+
 /*
  * LineSegment
  * Represents one 3D line — a start point, end point, and draw color.
@@ -55,9 +59,9 @@ struct LineSegment
  * VirtualObject
  *
  * Stores the rocket geometry as a list of LineSegments defined in 3D world
- * space. On each frame, draw() collects all unique endpoints, calls
- * cv::projectPoints() once to project them all to 2D, then draws each line
- * between its projected endpoints.
+ * space. On each frame, draw() projects the packed endpoint buffer with one
+ * cv::projectPoints() call, then draws each line between its projected
+ * endpoints — with cv::line, or batched on the GPU through a GLRenderer.
  *
  * Usage:
  *   VirtualObject rocket;
@@ -99,11 +103,25 @@ public:
               const cv::Mat& cameraMatrix,
               const cv::Mat& distCoeffs) const;
 
+    /*
+     * draw() - GPU variant
+     * Same projection; visible segments are queued on renderer and drawn by
+     * renderer.present() in one batch per line width.
+     */
+    void draw(GLRenderer&    renderer,
+              const cv::Mat& rvec,
+              const cv::Mat& tvec,
+              const cv::Mat& cameraMatrix,
+              const cv::Mat& distCoeffs) const;
+
     /*
      * clear()
      * Removes all line segments (useful for rebuilding geometry).
      */
-    void clear() { m_lines.clear(); }
+    void clear() { m_lines.clear(); m_vertices.clear(); }
+
+    /* segmentCount() - number of line segments in the model */
+    int segmentCount() const { return static_cast<int>(m_lines.size()); }
 
 private:
     /*
@@ -122,9 +140,20 @@ private:
     void buildExhaust();    // red exhaust triangle below the base
     void buildWindow();     // green square viewport on the front face
 
+    /* project() - projects m_vertices into m_projected and returns it */
+    const std::vector<cv::Point2f>& project(const cv::Mat& rvec,
+                                            const cv::Mat& tvec,
+                                            const cv::Mat& cameraMatrix,
+                                            const cv::Mat& distCoeffs) const;
+
     // All line segments making up the rocket
     std::vector<LineSegment> m_lines;
 
+    // Packed endpoints (index i*2 = start, i*2+1 = end) built with m_lines,
+    // and the projection output reused every frame
+    std::vector<cv::Vec3f>           m_vertices;
+    mutable std::vector<cv::Point2f> m_projected;
+
     // Transform applied to all geometry at build time
     cv::Vec3f m_offset;   // world position of rocket base
     float     m_scale;    // uniform scale factor
@@ -0,0 +1,309 @@
+/*
+ * ARRuntime.cpp - Pipelined Capture / Track / Render Runtime Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements the capture, tracking and render threads, the
+ *              constant-velocity pose extrapolation and the display loop.
+ *
+ * Date: March 2026
+ */
+
+#include "ARRuntime.h"
+#include <cvcore/metrics.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/* Constructor */
+ARRuntime::ARRuntime(cvcore::FrameSource& source, TrackFn track, RenderFn render, KeyFn key)
+    : m_source(source)
+    , m_track(std::move(track))
+    , m_render(std::move(render))
+    , m_key(std::move(key))
+    , m_running(false)
+    , m_extrapolate(true)
+    , m_trackMs(0.0)
+    , m_trackFps(0.0)
+{
+}
+
+/* Destructor */
+ARRuntime::~ARRuntime()
+{
+    stop();
+}
+
+/* now() - steady clock in seconds */
+double ARRuntime::now()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* takeFlag() */
+bool ARRuntime::takeFlag(int& argc, char** argv, const std::string& flag)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (flag != argv[i]) continue;
+        for (int j = i; j + 1 < argc; ++j)
+            argv[j] = argv[j + 1];
+        --argc;
+        return true;
+    }
+    return false;
+}
+
+/* run()
+ * The main thread only shows frames and polls keys; the 30 ms wait keeps
+ * waitKey() pumping window events even if the pipeline stalls. */
+void ARRuntime::run(const std::string& windowName, int extrapolationKey)
+{
+    stop();
+    m_running = true;
+    m_captureThread = std::thread(&ARRuntime::captureLoop, this);
+    m_trackThread   = std::thread(&ARRuntime::trackLoop,   this);
+    m_renderThread  = std::thread(&ARRuntime::renderLoop,  this);
+
+    std::cout << "[INFO] Pipelined runtime: capture / tracking / render threads\n";
+    cvcore::startMetricsFromEnvironment(windowName);
+
+    uint64_t seen = 0;
+    cv::Mat  display;
+    while (m_running)
+    {
+        if (m_display.waitNewerFor(seen, display, 30))
+            cv::imshow(windowName, display);
+
+        const int key = cv::waitKey(1);
+        if (key == 'q' || key == 27) break;
+        if (key >= 0 && key == extrapolationKey)
+        {
+            m_extrapolate = !m_extrapolate;
+        }
+        else if (key >= 0)
+        {
+            std::lock_guard<std::mutex> lock(m_keyMutex);
+            m_pendingKeys.push_back(key);
+        }
+    }
+
+    stop();
+}
+
+/* stop() - closes the slots so every waiting thread wakes, then joins */
+void ARRuntime::stop()
+{
+    m_running = false;
+    m_frames.close();
+    m_results.close();
+    m_display.close();
+    if (m_captureThread.joinable()) m_captureThread.join();
+    if (m_trackThread.joinable())   m_trackThread.join();
+    if (m_renderThread.joinable())  m_renderThread.join();
+
+    // Fresh slots for a later run()
+    m_frames.reset();
+    m_results.reset();
+    m_display.reset();
+    m_history.clear();
+}
+
+/* captureLoop()
+ * A new Mat per frame — readers may still hold the previous one. */
+void ARRuntime::captureLoop()
+{
+    cvcore::Counter& captured = cvcore::MetricsRegistry::global().counter(
+        "ar_frames_total", "Frames through each stage", "stage=\"capture\"");
+    while (m_running)
+    {
+        Frame f;
+        if (!m_source.read(f.image))
+        {
+            m_running = false;
+            break;
+        }
+        f.timestamp = now();
+        m_frames.put(f);
+        captured.inc();
+    }
+    m_frames.close();
+}
+
+/* trackLoop()
+ * Always works on the newest frame; frames captured while a track call runs
+ * are skipped, not queued. */
+void ARRuntime::trackLoop()
+{
+    cvcore::MetricsRegistry& metrics = cvcore::MetricsRegistry::global();
+    cvcore::Histogram& trackMetric = metrics.histogram(
+        "ar_track_seconds", "Tracking time per frame (TrackFn)");
+    cvcore::Counter& tracked = metrics.counter(
+        "ar_frames_total", "Frames through each stage", "stage=\"track\"");
+    cvcore::Counter& skipped = metrics.counter(
+        "ar_track_skipped_frames_total", "Frames captured while tracking was busy");
+
+    uint64_t seen = 0, lastSeen = 0;
+    Frame    f;
+    double   lastEnd = 0.0;
+    while (m_running && m_frames.waitNewer(seen, f))
+    {
+        // Slot sequence numbers count captured frames; the gap was skipped
+        skipped.inc(seen - lastSeen - 1);
+        lastSeen = seen;
+
+        std::vector<int> keys;
+        {
+            std::lock_guard<std::mutex> lock(m_keyMutex);
+            keys.swap(m_pendingKeys);
+        }
+        if (m_key)
+            for (int k : keys) m_key(k);
+
+        const double t0 = now();
+        ARTrackResult result;
+        m_track(f.image, result);
+        result.timestamp = f.timestamp;
+        m_results.put(result);
+
+        const double t1 = now();
+        const double ms = (t1 - t0) * 1000.0;
+        trackMetric.observeMs(ms);
+        tracked.inc();
+        m_trackMs = m_trackMs == 0.0 ? ms : 0.9 * m_trackMs + 0.1 * ms;
+        if (lastEnd > 0.0)
+        {
+            const double fps = 1.0 / std::max(t1 - lastEnd, 1e-6);
+            m_trackFps = m_trackFps == 0.0 ? fps : 0.9 * m_trackFps + 0.1 * fps;
+        }
+        lastEnd = t1;
+    }
+    m_results.close();
+}
+
+/* renderLoop()
+ * Runs once per captured frame with whatever poses are newest. */
+void ARRuntime::renderLoop()
+{
+    uint64_t      seenFrame = 0, seenResult = 0;
+    Frame         f;
+    ARTrackResult latest;
+    bool          haveResult = false;
+    double        lastEnd    = 0.0;
+
+    cvcore::MetricsRegistry& metrics = cvcore::MetricsRegistry::global();
+    cvcore::Histogram& poseAgeMetric = metrics.histogram(
+        "ar_pose_age_seconds", "Age of the tracked pose drawn on a frame");
+    cvcore::Histogram& latencyMetric = metrics.histogram(
+        "ar_frame_latency_seconds", "Capture to rendered display frame");
+    cvcore::Counter& rendered = metrics.counter(
+        "ar_frames_total", "Frames through each stage", "stage=\"render\"");
+
+    while (m_running && m_frames.waitNewer(seenFrame, f))
+    {
+        ARTrackResult fresh;
+        if (m_results.latest(seenResult, fresh))
+        {
+            latest     = fresh;
+            haveResult = true;
+            updateHistory(latest);
+        }
+
+        cv::Mat display = f.image.clone();
+        double  ageMs   = 0.0;
+        if (haveResult)
+        {
+            ageMs = (f.timestamp - latest.timestamp) * 1000.0;
+            poseAgeMetric.observeMs(ageMs);
+            m_render(display, m_extrapolate ? extrapolate(latest, f.timestamp) : latest);
+            drawStatus(display, latest.status);
+        }
+        drawStats(display, ageMs);
+        m_display.put(display);
+
+        const double t = now();
+        latencyMetric.observeMs((t - f.timestamp) * 1000.0);
+        rendered.inc();
+        if (lastEnd > 0.0)
+        {
+            const double fps = 1.0 / std::max(t - lastEnd, 1e-6);
+            m_renderFps = m_renderFps == 0.0 ? fps : 0.9 * m_renderFps + 0.1 * fps;
+        }
+        lastEnd = t;
+    }
+    m_display.close();
+}
+
+/* updateHistory()
+ * A lost target forgets its velocity, so it never drifts off after a loss. */
+void ARRuntime::updateHistory(const ARTrackResult& result)
+{
+    m_history.resize(result.poses.size());
+    for (size_t i = 0; i < result.poses.size(); ++i)
+    {
+        const ARPose& pose = result.poses[i];
+        PoseHistory&  h    = m_history[i];
+        if (!pose.valid || pose.rvec.empty() || pose.tvec.empty())
+        {
+            h.count = 0;
+            continue;
+        }
+
+        h.t0 = h.t1;
+        h.r0 = h.r1;
+        h.p0 = h.p1;
+        h.t1 = result.timestamp;
+        pose.rvec.convertTo(h.r1, CV_64F);
+        pose.tvec.convertTo(h.p1, CV_64F);
+        h.count = std::min(h.count + 1, 2);
+    }
+}
+
+/* extrapolate()
+ * x(t) = x1 + (x1 - x0) / (t1 - t0) * dt, dt clamped to MAX_EXTRAPOLATION_S. */
+ARTrackResult ARRuntime::extrapolate(const ARTrackResult& result, double t) const
+{
+    ARTrackResult out = result;
+    for (size_t i = 0; i < out.poses.size() && i < m_history.size(); ++i)
+    {
+        const PoseHistory& h = m_history[i];
+        if (!out.poses[i].valid || h.count < 2 || h.t1 <= h.t0) continue;
+
+        const double dt    = std::clamp(t - h.t1, 0.0, MAX_EXTRAPOLATION_S);
+        const double k     = dt / (h.t1 - h.t0);
+        out.poses[i].tvec  = h.p1 + (h.p1 - h.p0) * k;
+        if (cv::norm(h.r1 - h.r0) < MAX_ROTATION_STEP)
+            out.poses[i].rvec = h.r1 + (h.r1 - h.r0) * k;
+        else
+            out.poses[i].rvec = h.r1.clone();
+    }
+    return out;
+}
+
+/* drawStatus() - the tracker's status lines, top-left */
+void ARRuntime::drawStatus(cv::Mat& display, const std::vector<std::string>& lines)
+{
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const cv::Point org(10, 28 + 26 * static_cast<int>(i));
+        cv::putText(display, lines[i], org, cv::FONT_HERSHEY_SIMPLEX, 0.6,
+                    cv::Scalar(0, 0, 0), 3);
+        cv::putText(display, lines[i], org, cv::FONT_HERSHEY_SIMPLEX, 0.6,
+                    cv::Scalar(0, 255, 0), 1);
+    }
+}
+
+/* drawStats() */
+void ARRuntime::drawStats(cv::Mat& display, double poseAgeMs) const
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "Render " << m_renderFps << " fps | Track " << m_trackFps.load()
+       << " fps (" << m_trackMs.load() << " ms) | Pose age "
+       << std::setprecision(0) << poseAgeMs << " ms"
+       << (m_extrapolate ? " (extrapolated)" : "");
+    cv::putText(display, ss.str(), cv::Point(10, display.rows - 60),
+                cv::FONT_HERSHEY_SIMPLEX, 0.45, cv::Scalar(0, 0, 0), 3);
+    cv::putText(display, ss.str(), cv::Point(10, display.rows - 60),
+                cv::FONT_HERSHEY_SIMPLEX, 0.45, cv::Scalar(255, 255, 0), 1);
+}
@@ -0,0 +1,205 @@
+/*
+ * AssetCache.cpp - Binary Startup Asset Cache Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements content-hash keys and the binary cache file
+ *              reader/writer.
+ *
+ * Date: March 2026
+ */
+
+#include "AssetCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    const char     MAGIC[8]   = { 'A', 'R', 'C', 'A', 'C', 'H', 'E', '1' };
+    const uint64_t FNV_PRIME  = 1099511628211ull;
+    const int      KP_FIELDS  = 7;
+}
+
+/* Constructor */
+AssetCache::AssetCache(const std::string& directory)
+    : m_directory(directory)
+{
+}
+
+/* hashBytes() - FNV-1a, 64 bit */
+uint64_t AssetCache::hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+/* hashString() */
+uint64_t AssetCache::hashString(const std::string& s, uint64_t seed)
+{
+    return hashBytes(s.data(), s.size(), seed);
+}
+
+/* hashMat()
+ * Shape and type are part of the key, so a 3x1 and a 1x3 Mat with the same
+ * values differ. */
+uint64_t AssetCache::hashMat(const cv::Mat& m, uint64_t seed)
+{
+    const int header[3] = { m.rows, m.cols, m.type() };
+    uint64_t h = hashBytes(header, sizeof(header), seed);
+    const cv::Mat c = m.isContinuous() ? m : m.clone();
+    return hashBytes(c.data, c.total() * c.elemSize(), h);
+}
+
+/* hashFile() */
+uint64_t AssetCache::hashFile(const std::string& path, uint64_t seed)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+
+    uint64_t h = seed;
+    std::vector<char> buf(1 << 16);
+    while (in.read(buf.data(), buf.size()) || in.gcount() > 0)
+        h = hashBytes(buf.data(), static_cast<size_t>(in.gcount()), h);
+    return h;
+}
+
+/* entryPath() */
+std::string AssetCache::entryPath(const std::string& kind, uint64_t key) const
+{
+    std::ostringstream name;
+    name << kind << "_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return (std::filesystem::path(m_directory) / name.str()).string();
+}
+
+/* load()
+ * One read of the whole file, then the Mats are cut out of the buffer. */
+bool AssetCache::load(const std::string& kind, uint64_t key,
+                      std::vector<cv::Mat>& mats) const
+{
+    if (m_directory.empty() || key == 0) return false;
+
+    std::ifstream in(entryPath(kind, key), std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const std::streamsize size = in.tellg();
+    std::vector<char> buf(static_cast<size_t>(size));
+    in.seekg(0);
+    if (!in.read(buf.data(), size)) return false;
+
+    size_t pos = 0;
+    auto take = [&](void* dst, size_t n)
+    {
+        if (pos + n > buf.size()) return false;
+        if (n == 0) return true;
+        std::memcpy(dst, buf.data() + pos, n);
+        pos += n;
+        return true;
+    };
+
+    char     magic[sizeof(MAGIC)];
+    uint64_t fileKey = 0;
+    int32_t  count   = 0;
+    if (!take(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !take(&fileKey, sizeof(fileKey)) || fileKey != key ||
+        !take(&count, sizeof(count)) || count < 0)
+    {
+        std::cerr << "[WARN] Ignoring damaged cache entry: " << entryPath(kind, key) << "\n";
+        return false;
+    }
+
+    mats.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        int32_t hdr[3];
+        // Check the size before allocating — a damaged header must not
+        // turn into a huge allocation
+        if (!take(hdr, sizeof(hdr)) || hdr[0] < 0 || hdr[1] < 0 ||
+            static_cast<size_t>(hdr[0]) * hdr[1] * CV_ELEM_SIZE(hdr[2]) > buf.size() - pos)
+        {
+            std::cerr << "[WARN] Ignoring damaged cache entry: " << entryPath(kind, key) << "\n";
+            return false;
+        }
+
+        cv::Mat m(hdr[0], hdr[1], hdr[2]);
+        if (!take(m.data, m.total() * m.elemSize()))
+        {
+            std::cerr << "[WARN] Truncated cache entry: " << entryPath(kind, key) << "\n";
+            return false;
+        }
+        mats.push_back(m);
+    }
+    return true;
+}
+
+/* store() */
+bool AssetCache::store(const std::string& kind, uint64_t key,
+                       const std::vector<cv::Mat>& mats) const
+{
+    if (m_directory.empty() || key == 0) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    const std::string path = entryPath(kind, key);
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "[WARN] Cannot write cache entry: " << path << "\n";
+        return false;
+    }
+
+    const int32_t count = static_cast<int32_t>(mats.size());
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& mat : mats)
+    {
+        const cv::Mat m = mat.isContinuous() ? mat : mat.clone();
+        const int32_t hdr[3] = { m.rows, m.cols, m.type() };
+        out.write(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+        out.write(reinterpret_cast<const char*>(m.data),
+                  static_cast<std::streamsize>(m.total() * m.elemSize()));
+    }
+    return static_cast<bool>(out);
+}
+
+/* packKeypoints() */
+cv::Mat AssetCache::packKeypoints(const std::vector<cv::KeyPoint>& keypoints)
+{
+    cv::Mat packed(static_cast<int>(keypoints.size()), KP_FIELDS, CV_32F);
+    for (int i = 0; i < packed.rows; ++i)
+    {
+        const cv::KeyPoint& kp = keypoints[i];
+        float* row = packed.ptr<float>(i);
+        row[0] = kp.pt.x;
+        row[1] = kp.pt.y;
+        row[2] = kp.size;
+        row[3] = kp.angle;
+        row[4] = kp.response;
+        row[5] = static_cast<float>(kp.octave);
+        row[6] = static_cast<float>(kp.class_id);
+    }
+    return packed;
+}
+
+/* unpackKeypoints() */
+void AssetCache::unpackKeypoints(const cv::Mat& packed, std::vector<cv::KeyPoint>& keypoints)
+{
+    keypoints.clear();
+    if (packed.cols != KP_FIELDS || packed.type() != CV_32F) return;
+
+    keypoints.reserve(packed.rows);
+    for (int i = 0; i < packed.rows; ++i)
+    {
+        const float* row = packed.ptr<float>(i);
+        keypoints.emplace_back(cv::Point2f(row[0], row[1]), row[2], row[3], row[4],
+                               static_cast<int>(row[5]), static_cast<int>(row[6]));
+    }
+}
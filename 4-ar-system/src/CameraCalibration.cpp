@@ -14,6 +14,14 @@
  */
 
 #include "CameraCalibration.h"
+#include <cvcore/capture.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
 #include <iomanip>
 
@@ -38,8 +46,8 @@ CameraCalibration::CameraCalibration(int cameraId, const std::string& outputFile
 bool CameraCalibration::run()
 {
     // Open the webcam
-    cv::VideoCapture cap(m_cameraId);
-    if (!cap.isOpened())
+    auto cap = cvcore::FrameSource::open("", m_cameraId);
+    if (!cap)
     {
         std::cerr << "[ERROR] Cannot open camera with ID: " << m_cameraId << std::endl;
         return false;
@@ -52,17 +60,24 @@ bool CameraCalibration::run()
               << " internal corners\n";
     std::cout << " Controls:\n";
     std::cout << "   's'   - Save current frame (when corners detected)\n";
+    std::cout << "   'a'   - Auto-collect views that add coverage\n";
     std::cout << "   'c'   - Calibrate (need >= " << MIN_FRAMES << " frames)\n";
     std::cout << "   'q'/ESC - Quit\n";
     std::cout << "========================================\n\n";
 
     cv::Mat frame;
     cv::Size imageSize;
+    long frameId = 0;
+    long lastAutoSave = -AUTO_SAVE_INTERVAL;
+
+    // Corners older than this many preview frames are not shown or saved
+    const long maxResultAge = 3;
+
+    startDetection();
 
     while (true)
     {
-        cap >> frame;
-        if (frame.empty())
+        if (!cap->read(frame))
         {
             std::cerr << "[ERROR] Empty frame received from camera.\n";
             break;
@@ -80,12 +95,33 @@ bool CameraCalibration::run()
             m_cameraMatrix.at<double>(1, 2) = imageSize.height / 2.0;
         }
 
-        /* Task 1: Detect and draw chessboard corners */
-        std::vector<cv::Point2f> corners;
-        bool found = detectCorners(frame, corners);
+        /* Task 1: Detect chessboard corners on the worker thread and draw
+         * the newest result — the preview does not wait for detection */
+        submitFrame(frame, frameId);
+        DetectionResult detection = latestDetection();
+        bool found = detection.found && frameId - detection.frameId <= maxResultAge;
+        const std::vector<cv::Point2f>& corners = detection.corners;
+        if (found)
+            drawCorners(frame, corners);
+
+        // Bins this view would add to the selected set (-1 = no board)
+        const int viewScore = found ? diversityScore(viewBins(corners, imageSize)) : -1;
+
+        // Auto-collect: save views that add coverage, spaced out in time
+        if (m_autoCollect && viewScore > 0 && frameId - lastAutoSave >= AUTO_SAVE_INTERVAL)
+        {
+            saveFrame(corners, imageSize);
+            lastAutoSave = frameId;
+            std::cout << "[INFO] View auto-saved (+" << viewScore << " bins). Selected: "
+                      << m_selected.size() << " / " << m_cornerList.size() << " frames\n";
+        }
+        ++frameId;
+
+        // Pick up (or start) the background reprojection error estimate
+        updateEstimate(imageSize);
 
         // Overlay status info (frame count, instructions, calibration state)
-        printStatus(frame, found, static_cast<int>(m_cornerList.size()));
+        printStatus(frame, found, static_cast<int>(m_cornerList.size()), viewScore);
 
         cv::imshow("Camera Calibration", frame);
 
@@ -98,14 +134,21 @@ bool CameraCalibration::run()
             break;
         }
 
+        if (key == 'a')
+        {
+            m_autoCollect = !m_autoCollect;
+            std::cout << "[INFO] Auto-collect " << (m_autoCollect ? "on" : "off") << "\n";
+        }
+
         /* Task 2: Save frame for calibration */
         if (key == 's')
         {
             if (found)
             {
-                saveFrame(corners);
-                std::cout << "[INFO] Frame saved. Total frames: "
-                          << m_cornerList.size() << "\n";
+                const bool selected = saveFrame(corners, imageSize);
+                std::cout << "[INFO] Frame saved"
+                          << (selected ? "" : " (redundant view - not used for calibration)")
+                          << ". Total frames: " << m_cornerList.size() << "\n";
                 // Brief white flash to acknowledge save (like the OpenCV tutorial)
                 cv::bitwise_not(frame, frame);
                 cv::imshow("Camera Calibration", frame);
@@ -129,7 +172,7 @@ bool CameraCalibration::run()
             else
             {
                 std::cout << "\n[INFO] Running calibration with "
-                          << n << " frames...\n";
+                          << calibrationViewCount() << " of " << n << " frames...\n";
                 if (calibrate(imageSize))
                 {
                     printCalibrationResults();
@@ -144,21 +187,127 @@ bool CameraCalibration::run()
         }
     }
 
-    cap.release();
+    stopDetection();
+    cap.reset();
     cv::destroyAllWindows();
     return m_calibrated;
 }
 
-/* detectCorners() - Task 1
- * Finds internal chessboard corners in the given frame.
- * Uses cornerSubPix to refine corner positions to sub-pixel accuracy.
- * Draws corners on the frame for visual feedback. */
-bool CameraCalibration::detectCorners(const cv::Mat& frame,
-                                       std::vector<cv::Point2f>& corners)
+/* calibrateFromImages() - offline calibration from a folder of images */
+bool CameraCalibration::calibrateFromImages(const std::string& folder)
+{
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(folder, ec))
+    {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (entry.is_regular_file() &&
+            (ext == ".png" || ext == ".jpg" || ext == ".jpeg" ||
+             ext == ".bmp" || ext == ".tif" || ext == ".tiff"))
+            files.push_back(entry.path().string());
+    }
+    if (files.empty())
+    {
+        std::cerr << "[ERROR] No images found in: " << folder << "\n";
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+
+    std::cout << "[INFO] Detecting corners in " << files.size()
+              << " images on " << cv::getNumThreads() << " threads...\n";
+
+    /* Detect corners in parallel — one image per task, results by index so
+     * the frame order does not depend on thread scheduling */
+    const int n = static_cast<int>(files.size());
+    std::vector<std::vector<cv::Point2f>> corners(n);
+    std::vector<cv::Size> sizes(n);
+    std::vector<char>     found(n, 0);
+    std::atomic<int>      done{0};
+    std::mutex            printMutex;
+
+    cv::parallel_for_(cv::Range(0, n), [&](const cv::Range& range)
+    {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            cv::Mat gray = cv::imread(files[i], cv::IMREAD_GRAYSCALE);
+            if (!gray.empty())
+            {
+                sizes[i] = gray.size();
+                found[i] = findBoardCorners(gray, m_boardSize, corners[i]) ? 1 : 0;
+            }
+
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << "  [" << ++done << "/" << n << "] "
+                      << fs::path(files[i]).filename().string()
+                      << (gray.empty() ? " - unreadable\n"
+                          : found[i]   ? " - corners found\n"
+                                       : " - no board\n");
+        }
+    }, n);
+
+    /* Keep the boards of images matching the first detected size */
+    cv::Size imageSize;
+    clearViews();
+    for (int i = 0; i < n; ++i)
+    {
+        if (!found[i])
+            continue;
+        if (imageSize.empty())
+            imageSize = sizes[i];
+        if (sizes[i] != imageSize)
+        {
+            std::cout << "[WARN] Skipping " << files[i] << " (size "
+                      << sizes[i].width << "x" << sizes[i].height << ")\n";
+            continue;
+        }
+        saveFrame(corners[i], imageSize);
+    }
+
+    int used = static_cast<int>(m_cornerList.size());
+    if (used < MIN_FRAMES)
+    {
+        std::cerr << "[ERROR] Need at least " << MIN_FRAMES
+                  << " images with a detected board. Found: " << used << "\n";
+        return false;
+    }
+
+    m_cameraMatrix = cv::Mat::eye(3, 3, CV_64F);
+    m_cameraMatrix.at<double>(0, 2) = imageSize.width  / 2.0;
+    m_cameraMatrix.at<double>(1, 2) = imageSize.height / 2.0;
+    m_distCoeffs = cv::Mat::zeros(5, 1, CV_64F);
+
+    std::cout << "\n[INFO] Running calibration with " << calibrationViewCount()
+              << " of " << used << " images (selected for view diversity)...\n";
+    if (!calibrate(imageSize))
+    {
+        std::cerr << "[ERROR] Calibration failed.\n";
+        return false;
+    }
+    printCalibrationResults();
+    saveCalibration(imageSize);
+    m_calibrated = true;
+    return true;
+}
+
+/* findBoardCorners() - Task 1
+ * Finds internal chessboard corners coarse-to-fine: the board is located in
+ * a copy downscaled to DETECT_WIDTH (findChessboardCorners cost grows with
+ * the pixel count), then cornerSubPix refines the upscaled corners against
+ * the full-resolution image. */
+bool CameraCalibration::findBoardCorners(const cv::Mat& gray,
+                                         const cv::Size& boardSize,
+                                         std::vector<cv::Point2f>& corners)
 {
-    // Convert to grayscale - findChessboardCorners works on grayscale
-    cv::Mat gray;
-    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    double scale = gray.cols > DETECT_WIDTH
+                 ? static_cast<double>(DETECT_WIDTH) / gray.cols
+                 : 1.0;
+    cv::Mat small = gray;
+    if (scale < 1.0)
+        cv::resize(gray, small, cv::Size(), scale, scale, cv::INTER_AREA);
 
     /* Flags recommended by the OpenCV tutorial for reliable detection:
      *   CALIB_CB_ADAPTIVE_THRESH - adapts threshold for uneven lighting
@@ -168,43 +317,206 @@ bool CameraCalibration::detectCorners(const cv::Mat& frame,
               | cv::CALIB_CB_NORMALIZE_IMAGE
               | cv::CALIB_CB_FAST_CHECK;
 
-    bool found = cv::findChessboardCorners(gray, m_boardSize, corners, flags);
+    if (!cv::findChessboardCorners(small, boardSize, corners, flags))
+        return false;
 
-    if (found)
+    // Back to full-resolution coordinates
+    if (scale < 1.0)
     {
-        // Refine corner positions to sub-pixel accuracy.
-        cv::cornerSubPix(
-            gray, corners,
-            cv::Size(11, 11),
-            cv::Size(-1, -1),
-            cv::TermCriteria(
-                cv::TermCriteria::EPS + cv::TermCriteria::COUNT,
-                30, 0.001
-            )
-        );
+        const float inv = static_cast<float>(1.0 / scale);
+        for (auto& pt : corners)
+            pt *= inv;
+    }
+
+    // Refine corner positions to sub-pixel accuracy at full resolution.
+    cv::cornerSubPix(
+        gray, corners,
+        cv::Size(11, 11),
+        cv::Size(-1, -1),
+        cv::TermCriteria(
+            cv::TermCriteria::EPS + cv::TermCriteria::COUNT,
+            30, 0.001
+        )
+    );
+    return true;
+}
+
+/* startDetection() / stopDetection() - corner worker lifetime */
+void CameraCalibration::startDetection()
+{
+    stopDetection();
+    m_stopDetect = false;
+    m_detectBusy = false;
+    m_pendingFrame.release();
+    m_latest     = DetectionResult();
+    m_detectThread = std::thread(&CameraCalibration::detectionLoop, this);
+}
+
+void CameraCalibration::stopDetection()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_detectMutex);
+        m_stopDetect = true;
+    }
+    m_detectWake.notify_all();
+    if (m_detectThread.joinable())
+        m_detectThread.join();
+}
+
+/* submitFrame()
+ * Copies the frame for the worker only when it is idle; while a detection
+ * is running, frames are simply not submitted (the newest wins next time). */
+void CameraCalibration::submitFrame(const cv::Mat& frame, long frameId)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_detectMutex);
+        if (m_detectBusy || !m_pendingFrame.empty())
+            return;
+        frame.copyTo(m_pendingFrame);
+        m_pendingId = frameId;
+    }
+    m_detectWake.notify_one();
+}
+
+/* latestDetection() - newest worker result (copied) */
+CameraCalibration::DetectionResult CameraCalibration::latestDetection()
+{
+    std::lock_guard<std::mutex> lock(m_detectMutex);
+    return m_latest;
+}
+
+/* detectionLoop() - corner worker */
+void CameraCalibration::detectionLoop()
+{
+    cv::Mat frame, gray;
+    while (true)
+    {
+        long frameId;
+        {
+            std::unique_lock<std::mutex> lock(m_detectMutex);
+            m_detectWake.wait(lock, [this] { return m_stopDetect || !m_pendingFrame.empty(); });
+            if (m_stopDetect)
+                return;
+            std::swap(frame, m_pendingFrame);
+            m_pendingFrame.release();
+            frameId      = m_pendingId;
+            m_detectBusy = true;
+        }
+
+        // Convert to grayscale - findChessboardCorners works on grayscale
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+
+        DetectionResult result;
+        result.frameId = frameId;
+        result.found   = findBoardCorners(gray, m_boardSize, result.corners);
 
         // Print info about the first corner
-        if (!corners.empty())
+        if (result.found && !result.corners.empty())
         {
-            std::cout << "[Task 1] Corners found: " << corners.size()
+            std::cout << "[Task 1] Corners found: " << result.corners.size()
                       << " | First corner: ("
                       << std::fixed << std::setprecision(1)
-                      << corners[0].x << ", " << corners[0].y << ")\n";
+                      << result.corners[0].x << ", " << result.corners[0].y << ")\n";
         }
 
-        // Draw small green dots at each corner — no rainbow grid lines
-        for (const auto& pt : corners)
-            cv::circle(const_cast<cv::Mat&>(frame), pt, 3,
-                       cv::Scalar(0, 255, 0), -1);
+        std::lock_guard<std::mutex> lock(m_detectMutex);
+        m_latest     = std::move(result);
+        m_detectBusy = false;
     }
+}
 
-    return found;
+/* updateEstimate()
+ * Progressive calibration: calibrateCamera on a copy of the calibration
+ * views runs in the background; its RMS and intrinsics are shown in the
+ * overlay. After the first estimate each run starts from the previous one
+ * (CALIB_USE_INTRINSIC_GUESS) and is capped at REFINE_ITERATIONS — one new
+ * view moves the optimum only slightly, so a few LM steps converge. */
+void CameraCalibration::updateEstimate(const cv::Size& imageSize)
+{
+    if (m_estimate.valid() &&
+        m_estimate.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        Estimate estimate = m_estimate.get();
+        if (estimate.rms >= 0.0)
+        {
+            m_estimateError  = estimate.rms;
+            m_estimateFrames = m_pendingFrames;
+            m_estimateCamera = estimate.cameraMatrix;
+            m_estimateDist   = estimate.distCoeffs;
+            std::cout << "[INFO] Calibration estimate: RMS " << std::fixed
+                      << std::setprecision(4) << estimate.rms << " px, fx "
+                      << std::setprecision(1) << m_estimateCamera.at<double>(0, 0)
+                      << " (" << m_estimateFrames << " views)\n";
+        }
+    }
+
+    int n = calibrationViewCount();
+    if (m_estimate.valid() || n < MIN_FRAMES || n == m_pendingFrames)
+        return;
+
+    std::vector<std::vector<cv::Vec3f>>   points;
+    std::vector<std::vector<cv::Point2f>> corners;
+    calibrationViews(points, corners);
+
+    const bool warm = !m_estimateCamera.empty();
+    m_pendingFrames = n;
+    m_estimate = std::async(std::launch::async,
+        [points = std::move(points), corners = std::move(corners), imageSize, warm,
+         cameraMatrix = (warm ? m_estimateCamera : m_cameraMatrix).clone(),
+         distCoeffs   = warm ? m_estimateDist.clone() : cv::Mat()]() mutable
+        {
+            int flags = cv::CALIB_FIX_ASPECT_RATIO;
+            cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS,
+                                      30, DBL_EPSILON);
+            if (warm)
+            {
+                flags   |= cv::CALIB_USE_INTRINSIC_GUESS;
+                criteria.maxCount = REFINE_ITERATIONS;
+            }
+
+            Estimate estimate;
+            std::vector<cv::Mat> rvecs, tvecs;
+            try
+            {
+                estimate.rms = cv::calibrateCamera(points, corners, imageSize,
+                                                   cameraMatrix, distCoeffs, rvecs, tvecs,
+                                                   flags, criteria);
+                estimate.cameraMatrix = cameraMatrix;
+                estimate.distCoeffs   = distCoeffs;
+            }
+            catch (const cv::Exception&)
+            {
+                estimate.rms = -1.0;
+            }
+            return estimate;
+        });
+}
+
+/* drawCorners()
+ * Draws small green dots at each corner — no rainbow grid lines. */
+void CameraCalibration::drawCorners(cv::Mat& frame,
+                                    const std::vector<cv::Point2f>& corners)
+{
+    for (const auto& pt : corners)
+        cv::circle(frame, pt, 3, cv::Scalar(0, 255, 0), -1);
 }
 
 /* saveFrame() - Task 2
- * Saves the detected 2D corners and the corresponding 3D world points. */
-void CameraCalibration::saveFrame(const std::vector<cv::Point2f>& corners)
+ * Saves the detected 2D corners and the corresponding 3D world points, and
+ * selects the view when it covers a new bin. */
+bool CameraCalibration::saveFrame(const std::vector<cv::Point2f>& corners,
+                                  const cv::Size& imageSize)
 {
+    const ViewBins bins     = viewBins(corners, imageSize);
+    const bool     selected = diversityScore(bins) > 0;
+    if (selected)
+    {
+        m_selected.push_back(static_cast<int>(m_cornerList.size()));
+        m_positionCovered[bins.position] = true;
+        m_sizeCovered[bins.size]         = true;
+        m_tiltCovered[bins.tilt]         = true;
+    }
+
     // Store the 2D image corners for this frame
     m_cornerList.push_back(corners);
 
@@ -213,6 +525,94 @@ void CameraCalibration::saveFrame(const std::vector<cv::Point2f>& corners)
     std::vector<cv::Vec3f> pointSet;
     buildWorldPoints(pointSet);
     m_pointList.push_back(pointSet);
+    return selected;
+}
+
+/* viewBins()
+ * Size bins: < 8%, 8-25%, > 25% of the image. Tilt bins: an edge-length
+ * log ratio beyond +-0.1 (about a 10% shorter far edge) counts as tilted
+ * that way, otherwise fronto-parallel. */
+CameraCalibration::ViewBins CameraCalibration::viewBins(
+    const std::vector<cv::Point2f>& corners, const cv::Size& imageSize) const
+{
+    ViewBins bins;
+    const int w = m_boardSize.width, h = m_boardSize.height;
+    if (static_cast<int>(corners.size()) != w * h || imageSize.empty())
+        return bins;
+
+    const cv::Point2f tl = corners[0];
+    const cv::Point2f tr = corners[w - 1];
+    const cv::Point2f bl = corners[(h - 1) * w];
+    const cv::Point2f br = corners[w * h - 1];
+
+    const cv::Point2f centre = (tl + tr + bl + br) * 0.25f;
+    const int cx = std::clamp(static_cast<int>(centre.x / imageSize.width  * POSITION_BINS),
+                              0, POSITION_BINS - 1);
+    const int cy = std::clamp(static_cast<int>(centre.y / imageSize.height * POSITION_BINS),
+                              0, POSITION_BINS - 1);
+    bins.position = cy * POSITION_BINS + cx;
+
+    const double area = cv::contourArea(std::vector<cv::Point2f>{ tl, tr, br, bl })
+                      / imageSize.area();
+    bins.size = (area >= 0.08 ? 1 : 0) + (area >= 0.25 ? 1 : 0);
+
+    auto tiltBin = [](double a, double b)
+    {
+        const double r = std::log(std::max(a, 1e-3) / std::max(b, 1e-3));
+        return r < -0.1 ? 0 : r > 0.1 ? TILT_BINS - 1 : 1;
+    };
+    const int tiltX = tiltBin(cv::norm(bl - tl), cv::norm(br - tr));   // left vs right edge
+    const int tiltY = tiltBin(cv::norm(tr - tl), cv::norm(br - bl));   // top vs bottom edge
+    bins.tilt = tiltX * TILT_BINS + tiltY;
+    return bins;
+}
+
+/* diversityScore() */
+int CameraCalibration::diversityScore(const ViewBins& bins) const
+{
+    if (static_cast<int>(m_selected.size()) >= MAX_CALIB_VIEWS)
+        return 0;
+    return (m_positionCovered[bins.position] ? 0 : 1)
+         + (m_sizeCovered[bins.size]         ? 0 : 1)
+         + (m_tiltCovered[bins.tilt]         ? 0 : 1);
+}
+
+/* calibrationViewCount() */
+int CameraCalibration::calibrationViewCount() const
+{
+    const int selected = static_cast<int>(m_selected.size());
+    return selected >= MIN_FRAMES ? selected : static_cast<int>(m_cornerList.size());
+}
+
+/* calibrationViews() */
+void CameraCalibration::calibrationViews(std::vector<std::vector<cv::Vec3f>>&   points,
+                                         std::vector<std::vector<cv::Point2f>>& corners) const
+{
+    if (static_cast<int>(m_selected.size()) < MIN_FRAMES)
+    {
+        points  = m_pointList;
+        corners = m_cornerList;
+        return;
+    }
+
+    points.clear();
+    corners.clear();
+    for (int i : m_selected)
+    {
+        points.push_back(m_pointList[i]);
+        corners.push_back(m_cornerList[i]);
+    }
+}
+
+/* clearViews() */
+void CameraCalibration::clearViews()
+{
+    m_cornerList.clear();
+    m_pointList.clear();
+    m_selected.clear();
+    m_positionCovered.fill(false);
+    m_sizeCovered.fill(false);
+    m_tiltCovered.fill(false);
 }
 
 /* buildWorldPoints()
@@ -249,10 +649,15 @@ void CameraCalibration::buildWorldPoints(std::vector<cv::Vec3f>& pointSet) const
 }
 
 /* calibrate() - Task 3
- * Runs cv::calibrateCamera with all collected frames.
+ * Runs cv::calibrateCamera with the selected frames, warm-started from the
+ * background estimate when one exists (the final solve then only polishes).
  * Fills m_cameraMatrix, m_distCoeffs, m_reprojError. */
 bool CameraCalibration::calibrate(const cv::Size& imageSize)
 {
+    std::vector<std::vector<cv::Vec3f>>   points;
+    std::vector<std::vector<cv::Point2f>> corners;
+    calibrationViews(points, corners);
+
     /* These will hold per-frame rotation and translation vectors.
      * rvecs[i] and tvecs[i] describe the board pose for calibration frame i. */
     std::vector<cv::Mat> rvecs, tvecs;
@@ -260,14 +665,20 @@ bool CameraCalibration::calibrate(const cv::Size& imageSize)
     /* Use CALIB_FIX_ASPECT_RATIO to assume square pixels (fx = fy).
      * This is appropriate for modern cameras as noted in the OpenCV tutorial. */
     int calibFlags = cv::CALIB_FIX_ASPECT_RATIO;
+    if (!m_estimateCamera.empty())
+    {
+        m_estimateCamera.copyTo(m_cameraMatrix);
+        m_estimateDist.copyTo(m_distCoeffs);
+        calibFlags |= cv::CALIB_USE_INTRINSIC_GUESS;
+    }
 
     try
     {
         /* cv::calibrateCamera returns the RMS re-projection error.
          * A value < 1.0 pixel indicates a good calibration. */
         m_reprojError = cv::calibrateCamera(
-            m_pointList,    // 3D world points (same set repeated per frame)
-            m_cornerList,   // 2D image points collected from each frame
+            points,         // 3D world points (same set repeated per frame)
+            corners,        // 2D image points of the selected frames
             imageSize,      // size of the calibration images
             m_cameraMatrix, // OUTPUT: 3x3 intrinsic matrix
             m_distCoeffs,   // OUTPUT: distortion coefficients
@@ -312,7 +723,7 @@ void CameraCalibration::saveCalibration(const cv::Size& imageSize) const
     fs << "image_height"      << imageSize.height;
     fs << "board_width"       << BOARD_WIDTH;
     fs << "board_height"      << BOARD_HEIGHT;
-    fs << "num_frames"        << static_cast<int>(m_cornerList.size());
+    fs << "num_frames"        << calibrationViewCount();
     fs << "reprojection_error" << m_reprojError;
 
     // Write the two key matrices
@@ -364,7 +775,8 @@ void CameraCalibration::printCalibrationResults() const
  * Overlays frame count, corner detection status, and key hints onto the frame. */
 void CameraCalibration::printStatus(cv::Mat& frame,
                                      bool cornersFound,
-                                     int savedFrames) const
+                                     int savedFrames,
+                                     int viewScore) const
 {
     // Choose color based on corner detection state
     cv::Scalar color = cornersFound
@@ -372,9 +784,10 @@ void CameraCalibration::printStatus(cv::Mat& frame,
         : cv::Scalar(0, 0, 255);   // red when not found
 
     // Detection status line
-    std::string statusMsg = cornersFound
-        ? "Corners detected - press 's' to save"
-        : "No corners - aim at chessboard";
+    std::string statusMsg = !cornersFound ? "No corners - aim at chessboard"
+                          : viewScore > 0  ? "New view (+" + std::to_string(viewScore)
+                                             + " bins) - press 's' to save"
+                                           : "Corners detected - redundant view, move the board";
     cv::putText(frame, statusMsg, cv::Point(10, 30),
                 cv::FONT_HERSHEY_SIMPLEX, 0.7, color, 2);
 
@@ -392,6 +805,32 @@ void CameraCalibration::printStatus(cv::Mat& frame,
                     cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 255), 1);
     }
 
+    // Progressive reprojection error estimate
+    if (m_estimateError >= 0.0)
+    {
+        cv::putText(frame,
+                    cv::format("RMS estimate: %.3f px  fx %.1f  (%d frames)",
+                               m_estimateError, m_estimateCamera.at<double>(0, 0),
+                               m_estimateFrames),
+                    cv::Point(10, 120),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 0), 1);
+    }
+
+    // View coverage of the selected set
+    auto covered = [](const auto& bins)
+    {
+        return static_cast<int>(std::count(bins.begin(), bins.end(), true));
+    };
+    cv::putText(frame,
+                cv::format("Coverage: position %d/%d  size %d/%d  tilt %d/%d  |  selected %d%s",
+                           covered(m_positionCovered), POSITION_BINS * POSITION_BINS,
+                           covered(m_sizeCovered), SIZE_BINS,
+                           covered(m_tiltCovered), TILT_BINS * TILT_BINS,
+                           static_cast<int>(m_selected.size()),
+                           m_autoCollect ? "  |  AUTO" : ""),
+                cv::Point(10, 150),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 200, 0), 1);
+
     // Calibrated state
     if (m_calibrated)
     {
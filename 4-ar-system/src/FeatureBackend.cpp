@@ -0,0 +1,388 @@
+/*
+ * FeatureBackend.cpp - Pluggable Keypoint Detector/Descriptor Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements the SIFT/ORB/AKAZE backends on top of
+ *              cv::Feature2D, the SuperPoint backend on top of cv::dnn and
+ *              the CUDA ORB backend on top of cv::cuda::ORB.
+ *
+ * Date: March 2026
+ */
+
+#include "FeatureBackend.h"
+#include <opencv2/dnn.hpp>
+#ifdef AR_WITH_CUDA
+#include <opencv2/cudafeatures2d.hpp>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+
+/*
+ * Feature2DBackend
+ *
+ * Wraps a cv::Feature2D. When the detector has no feature limit of its own
+ * (AKAZE), or the limit was lowered below it (SIFT after setNFeatures()),
+ * detection and description are split so only the strongest nfeatures
+ * keypoints are described.
+ */
+class Feature2DBackend : public FeatureBackend
+{
+public:
+    Feature2DBackend(Type type, int nfeatures, cv::Ptr<cv::Feature2D> impl,
+                     int norm, bool retainBest)
+        : FeatureBackend(type, nfeatures)
+        , m_impl(impl)
+        , m_norm(norm)
+        , m_retainBest(retainBest)
+        , m_ownLimit(retainBest ? 0 : nfeatures)
+    {
+    }
+
+    void detectAndCompute(const cv::Mat& gray, const cv::Mat& mask,
+                          std::vector<cv::KeyPoint>& keypoints,
+                          cv::Mat& descriptors) override
+    {
+        const bool split = m_nfeatures > 0 &&
+                           (m_retainBest || m_ownLimit <= 0 || m_nfeatures < m_ownLimit);
+        if (!split)
+        {
+            m_impl->detectAndCompute(gray, mask, keypoints, descriptors);
+            return;
+        }
+
+        m_impl->detect(gray, keypoints, mask);
+        cv::KeyPointsFilter::retainBest(keypoints, m_nfeatures);
+        m_impl->compute(gray, keypoints, descriptors);
+    }
+
+    int normType() const override { return m_norm; }
+
+    void setNFeatures(int nfeatures) override
+    {
+        m_nfeatures = nfeatures;
+
+        // ORB prunes per pyramid level while detecting, so the limit goes in
+        cv::Ptr<cv::ORB> orb = m_impl.dynamicCast<cv::ORB>();
+        if (orb)
+        {
+            orb->setMaxFeatures(m_nfeatures > 0 ? m_nfeatures : 500);
+            m_ownLimit = m_nfeatures;
+        }
+    }
+
+private:
+    cv::Ptr<cv::Feature2D> m_impl;
+    int                    m_norm;
+    bool                   m_retainBest;
+    int                    m_ownLimit;       // detector's own nfeatures (0 = none)
+};
+
+/*
+ * SuperPointBackend
+ *
+ * Runs a SuperPoint ONNX export with one 1x1xHxW input (gray / 255, H and W
+ * multiples of 8) and two outputs: a 1x65x(H/8)x(W/8) score map (64 cell
+ * positions + "no keypoint" bin) and a 1x256x(H/8)x(W/8) descriptor map.
+ */
+class SuperPointBackend : public FeatureBackend
+{
+public:
+    // Keypoint score threshold and non-maximum suppression radius (px)
+    static constexpr float SCORE_THRESHOLD = 0.015f;
+    static constexpr int   NMS_RADIUS      = 4;
+
+    SuperPointBackend(int nfeatures, cv::dnn::Net net)
+        : FeatureBackend(SUPERPOINT, nfeatures), m_net(net)
+    {
+    }
+
+    void detectAndCompute(const cv::Mat& gray, const cv::Mat& mask,
+                          std::vector<cv::KeyPoint>& keypoints,
+                          cv::Mat& descriptors) override;
+
+    int normType() const override { return cv::NORM_L2; }
+
+private:
+    cv::dnn::Net m_net;
+};
+
+/* SuperPointBackend::detectAndCompute()
+ * 1. Softmax over the 65 score channels per 8x8 cell → full-res heatmap
+ * 2. Threshold + dilate-based NMS, keep the strongest nfeatures
+ * 3. Bilinearly sample the coarse descriptor map, L2-normalise */
+void SuperPointBackend::detectAndCompute(const cv::Mat& gray, const cv::Mat& mask,
+                                         std::vector<cv::KeyPoint>& keypoints,
+                                         cv::Mat& descriptors)
+{
+    keypoints.clear();
+    descriptors.release();
+
+    const int w = gray.cols / 8 * 8;
+    const int h = gray.rows / 8 * 8;
+    if (w == 0 || h == 0) return;
+    const float sx = static_cast<float>(gray.cols) / w;
+    const float sy = static_cast<float>(gray.rows) / h;
+
+    cv::Mat blob = cv::dnn::blobFromImage(gray, 1.0 / 255.0, cv::Size(w, h));
+    m_net.setInput(blob);
+
+    std::vector<cv::Mat> outs;
+    m_net.forward(outs, m_net.getUnconnectedOutLayersNames());
+    if (outs.size() < 2 || outs[0].dims != 4 || outs[1].dims != 4) return;
+    const cv::Mat& semi = outs[0].size[1] == 65 ? outs[0] : outs[1];
+    const cv::Mat& desc = outs[0].size[1] == 65 ? outs[1] : outs[0];
+
+    const int hc = semi.size[2], wc = semi.size[3];
+    const int plane = hc * wc;
+    const float* sp = semi.ptr<float>();
+
+    // Step 1: per-cell softmax, dustbin channel dropped
+    cv::Mat heat(hc * 8, wc * 8, CV_32F);
+    for (int cy = 0; cy < hc; ++cy)
+    {
+        for (int cx = 0; cx < wc; ++cx)
+        {
+            const int cell = cy * wc + cx;
+            float maxv = sp[cell];
+            for (int c = 1; c < 65; ++c) maxv = std::max(maxv, sp[c * plane + cell]);
+
+            float e[65], sum = 0.0f;
+            for (int c = 0; c < 65; ++c)
+            {
+                e[c] = std::exp(sp[c * plane + cell] - maxv);
+                sum += e[c];
+            }
+            for (int c = 0; c < 64; ++c)
+                heat.at<float>(cy * 8 + c / 8, cx * 8 + c % 8) = e[c] / sum;
+        }
+    }
+
+    // Step 2: local maxima above threshold
+    cv::Mat dilated;
+    cv::dilate(heat, dilated, cv::getStructuringElement(
+        cv::MORPH_RECT, cv::Size(2 * NMS_RADIUS + 1, 2 * NMS_RADIUS + 1)));
+
+    for (int y = 0; y < heat.rows; ++y)
+    {
+        const float* hr = heat.ptr<float>(y);
+        const float* dr = dilated.ptr<float>(y);
+        for (int x = 0; x < heat.cols; ++x)
+        {
+            if (hr[x] < SCORE_THRESHOLD || hr[x] < dr[x]) continue;
+            const cv::Point2f pt(x * sx, y * sy);
+            if (!mask.empty() &&
+                !mask.at<uchar>(cvRound(pt.y), cvRound(pt.x))) continue;
+            keypoints.emplace_back(pt, 8.0f * sx, -1.0f, hr[x]);
+        }
+    }
+    if (m_nfeatures > 0) cv::KeyPointsFilter::retainBest(keypoints, m_nfeatures);
+    if (keypoints.empty()) return;
+
+    // Step 3: descriptors at keypoint positions (cell-centre convention)
+    const int dim = desc.size[1];
+    const float* dp = desc.ptr<float>();
+    descriptors.create(static_cast<int>(keypoints.size()), dim, CV_32F);
+    for (int i = 0; i < static_cast<int>(keypoints.size()); ++i)
+    {
+        const float fx = std::clamp((keypoints[i].pt.x / sx + 0.5f) / 8.0f - 0.5f,
+                                    0.0f, static_cast<float>(wc - 1));
+        const float fy = std::clamp((keypoints[i].pt.y / sy + 0.5f) / 8.0f - 0.5f,
+                                    0.0f, static_cast<float>(hc - 1));
+        const int   x0 = static_cast<int>(fx), y0 = static_cast<int>(fy);
+        const int   x1 = std::min(x0 + 1, wc - 1), y1 = std::min(y0 + 1, hc - 1);
+        const float ax = fx - x0, ay = fy - y0;
+
+        float* row = descriptors.ptr<float>(i);
+        for (int c = 0; c < dim; ++c)
+        {
+            const float* ch = dp + c * plane;
+            row[c] = (1 - ay) * ((1 - ax) * ch[y0 * wc + x0] + ax * ch[y0 * wc + x1])
+                   +      ay  * ((1 - ax) * ch[y1 * wc + x0] + ax * ch[y1 * wc + x1]);
+        }
+        cv::normalize(descriptors.row(i), descriptors.row(i));
+    }
+}
+
+#ifdef AR_WITH_CUDA
+/*
+ * CudaOrbBackend
+ *
+ * cv::cuda::ORB with device buffers reused across frames. Only the gray
+ * frame (and mask) go up and the keypoints come down; descriptors come down
+ * only while device matching is off.
+ */
+class CudaOrbBackend : public FeatureBackend
+{
+public:
+    explicit CudaOrbBackend(int nfeatures)
+        : FeatureBackend(CUDA_ORB, nfeatures)
+        , m_orb(cv::cuda::ORB::create(nfeatures > 0 ? nfeatures : 500))
+        , m_matcher(cv::cuda::DescriptorMatcher::createBFMatcher(cv::NORM_HAMMING))
+        , m_deviceMatching(false)
+    {
+    }
+
+    void detectAndCompute(const cv::Mat& gray, const cv::Mat& mask,
+                          std::vector<cv::KeyPoint>& keypoints,
+                          cv::Mat& descriptors) override
+    {
+        m_frame.upload(gray, m_stream);
+        if (mask.empty())
+            m_mask.release();
+        else
+            m_mask.upload(mask, m_stream);
+
+        m_orb->detectAndComputeAsync(m_frame, m_mask, m_keypointsGpu,
+                                     m_descriptorsGpu, false, m_stream);
+        m_stream.waitForCompletion();
+        m_orb->convert(m_keypointsGpu, keypoints);
+
+        if (m_deviceMatching || m_descriptorsGpu.empty())
+            descriptors.release();
+        else
+            m_descriptorsGpu.download(descriptors);
+    }
+
+    int normType() const override { return cv::NORM_HAMMING; }
+
+    void setNFeatures(int nfeatures) override
+    {
+        m_nfeatures = nfeatures;
+        m_orb->setMaxFeatures(nfeatures > 0 ? nfeatures : 500);
+    }
+
+    bool setMatchReference(const cv::Mat& descriptors) override
+    {
+        m_matcher->clear();
+        m_deviceMatching = !descriptors.empty();
+        if (m_deviceMatching)
+        {
+            m_matcher->add(std::vector<cv::cuda::GpuMat>{ cv::cuda::GpuMat(descriptors) });
+            m_matcher->train();
+        }
+        return m_deviceMatching;
+    }
+
+    bool knnMatchReference(std::vector<std::vector<cv::DMatch>>& matches, int k) override
+    {
+        matches.clear();
+        if (!m_deviceMatching) return false;
+        if (m_descriptorsGpu.empty()) return true;
+
+        m_matcher->knnMatchAsync(m_descriptorsGpu, m_matchesGpu, k,
+                                 cv::cuda::GpuMat(), m_stream);
+        m_stream.waitForCompletion();
+        m_matcher->knnMatchConvert(m_matchesGpu, matches);
+        return true;
+    }
+
+private:
+    cv::Ptr<cv::cuda::ORB>               m_orb;
+    cv::Ptr<cv::cuda::DescriptorMatcher> m_matcher;
+    cv::cuda::Stream                     m_stream;
+    cv::cuda::GpuMat                     m_frame, m_mask;
+    cv::cuda::GpuMat                     m_keypointsGpu, m_descriptorsGpu;
+    cv::cuda::GpuMat                     m_matchesGpu;
+    bool                                 m_deviceMatching;
+};
+#endif
+
+/* cudaAvailable() */
+bool FeatureBackend::cudaAvailable()
+{
+#ifdef AR_WITH_CUDA
+    return cv::cuda::getCudaEnabledDeviceCount() > 0;
+#else
+    return false;
+#endif
+}
+
+/* create() */
+cv::Ptr<FeatureBackend> FeatureBackend::create(Type type, int nfeatures,
+                                               const std::string& modelPath,
+                                               double contrastThreshold)
+{
+    switch (type)
+    {
+        case CUDA_ORB:
+#ifdef AR_WITH_CUDA
+            if (cudaAvailable())
+                return cv::makePtr<CudaOrbBackend>(nfeatures);
+#endif
+            std::cerr << "[WARN] No CUDA device (or built without AR_WITH_CUDA)"
+                         " - falling back to CPU ORB.\n";
+            [[fallthrough]];
+
+        case ORB:
+            // ORB has no "unlimited" setting — 0 maps to its default of 500
+            return cv::makePtr<Feature2DBackend>(
+                ORB, nfeatures,
+                cv::ORB::create(nfeatures > 0 ? nfeatures : 500),
+                cv::NORM_HAMMING, false);
+
+        case AKAZE:
+            return cv::makePtr<Feature2DBackend>(
+                AKAZE, nfeatures, cv::AKAZE::create(),
+                cv::NORM_HAMMING, true);
+
+        case SUPERPOINT:
+        {
+            if (modelPath.empty())
+            {
+                std::cerr << "[ERROR] SuperPoint backend needs an ONNX model path.\n";
+                return nullptr;
+            }
+            cv::dnn::Net net;
+            try { net = cv::dnn::readNetFromONNX(modelPath); }
+            catch (const cv::Exception&) {}
+            if (net.empty())
+            {
+                std::cerr << "[ERROR] Cannot load SuperPoint model: " << modelPath << "\n";
+                return nullptr;
+            }
+            return cv::makePtr<SuperPointBackend>(nfeatures, net);
+        }
+
+        default:
+            // 300 features with threshold 0.04 gives good coverage of bill details
+            return cv::makePtr<Feature2DBackend>(
+                SIFT, nfeatures,
+                cv::SIFT::create(nfeatures, 3, contrastThreshold, 10, 1.6),
+                cv::NORM_L2, false);
+    }
+}
+
+/* typeName() */
+const char* FeatureBackend::typeName(Type type)
+{
+    switch (type)
+    {
+        case ORB:        return "ORB";
+        case AKAZE:      return "AKAZE";
+        case SUPERPOINT: return "SuperPoint";
+        case CUDA_ORB:   return "CUDA-ORB";
+        default:         return "SIFT";
+    }
+}
+
+/* parseType() */
+bool FeatureBackend::parseType(const std::string& name, Type& type)
+{
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    for (int t = 0; t < TYPE_COUNT; ++t)
+    {
+        std::string candidate = typeName(static_cast<Type>(t));
+        std::transform(candidate.begin(), candidate.end(), candidate.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lower == candidate)
+        {
+            type = static_cast<Type>(t);
+            return true;
+        }
+    }
+    return false;
+}
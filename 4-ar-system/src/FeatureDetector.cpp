@@ -14,16 +14,21 @@
  */
 
 #include "FeatureDetector.h"
+#include <cvcore/capture.hpp>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 
 /* Constructor */
 FeatureDetector::FeatureDetector(int cameraId, int nfeatures,
-                                  double contrastThreshold)
+                                  double contrastThreshold,
+                                  FeatureBackend::Type backend,
+                                  const std::string& modelPath)
     : m_cameraId(cameraId)
     , m_nfeatures(nfeatures)
     , m_contrastThreshold(contrastThreshold)
+    , m_backendType(backend)
+    , m_modelPath(modelPath)
     , m_lastNfeatures(-1)   // force creation on first frame
 {
 }
@@ -31,8 +36,8 @@ FeatureDetector::FeatureDetector(int cameraId, int nfeatures,
 /* run() - Main video loop for Task 7 */
 bool FeatureDetector::run()
 {
-    cv::VideoCapture cap(m_cameraId);
-    if (!cap.isOpened())
+    auto cap = cvcore::FrameSource::open("", m_cameraId);
+    if (!cap)
     {
         std::cerr << "[ERROR] Cannot open camera ID: " << m_cameraId << "\n";
         return false;
@@ -42,9 +47,10 @@ bool FeatureDetector::run()
     std::cout << " Feature Detector - Task 7\n";
     std::cout << "========================================\n";
     std::cout << " Pattern : Dollar bill / banknote\n";
-    std::cout << " Method  : SIFT\n";
+    std::cout << " Method  : " << FeatureBackend::typeName(m_backendType) << "\n";
     std::cout << " Controls:\n";
     std::cout << "   Trackbar - max features (0 = unlimited)\n";
+    std::cout << "   'b'      - cycle backend (SIFT/ORB/AKAZE/SuperPoint)\n";
     std::cout << "   'q'/ESC  - quit\n";
     std::cout << "========================================\n\n";
 
@@ -58,51 +64,67 @@ bool FeatureDetector::run()
 
     while (true)
     {
-        cap >> frame;
-        if (frame.empty()) break;
+        if (!cap->read(frame)) break;
 
         cv::Mat display = frame.clone();
 
-        int count = detectSIFT(frame, display);
+        int count = detectFeatures(frame, display);
         overlayInfo(display, count);
 
         cv::imshow(windowName, display);
 
         char key = static_cast<char>(cv::waitKey(30));
         if (key == 'q' || key == 27) break;
+        if (key == 'b') cycleBackend();
     }
 
-    cap.release();
+    cap.reset();
     cv::destroyAllWindows();
     return true;
 }
 
-/* detectSIFT() - Core of Task 7
- * Recreates SIFT detector only when trackbar value changes — not every frame. */
-int FeatureDetector::detectSIFT(const cv::Mat& frame, cv::Mat& displayFrame)
+/* cycleBackend()
+ * Skips SuperPoint when no model was given — it cannot be built — and
+ * CUDA-ORB when there is no CUDA device (it would just be ORB again). */
+void FeatureDetector::cycleBackend()
+{
+    int next = (m_backendType + 1) % FeatureBackend::TYPE_COUNT;
+    if (next == FeatureBackend::SUPERPOINT && m_modelPath.empty())
+        next = (next + 1) % FeatureBackend::TYPE_COUNT;
+    if (next == FeatureBackend::CUDA_ORB && !FeatureBackend::cudaAvailable())
+        next = (next + 1) % FeatureBackend::TYPE_COUNT;
+    m_backendType = static_cast<FeatureBackend::Type>(next);
+    m_features.reset();     // rebuilt on the next frame
+}
+
+/* detectFeatures() - Core of Task 7
+ * Recreates the detector only when trackbar value or backend changes — not
+ * every frame. Falls back to SIFT if the backend cannot be built. */
+int FeatureDetector::detectFeatures(const cv::Mat& frame, cv::Mat& displayFrame)
 {
     cv::Mat gray;
     cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
 
-    // Recreate SIFT only when trackbar value changes
-    if (!m_sift || m_nfeatures != m_lastNfeatures)
+    // Recreate detector only when trackbar value or backend changes
+    if (!m_features || m_nfeatures != m_lastNfeatures)
     {
-        m_sift = cv::SIFT::create(
-            m_nfeatures,
-            3,
-            m_contrastThreshold,
-            10,
-            1.6
-        );
+        m_features = FeatureBackend::create(m_backendType, m_nfeatures,
+                                            m_modelPath, m_contrastThreshold);
+        if (!m_features)
+        {
+            m_backendType = FeatureBackend::SIFT;
+            m_features    = FeatureBackend::create(m_backendType, m_nfeatures,
+                                                   "", m_contrastThreshold);
+        }
         m_lastNfeatures = m_nfeatures;
     }
 
     // Detect keypoints and compute descriptors using cached detector
     std::vector<cv::KeyPoint> keypoints;
     cv::Mat descriptors;
-    m_sift->detectAndCompute(
+    m_features->detectAndCompute(
         gray,
-        cv::noArray(),
+        cv::Mat(),
         keypoints,
         descriptors
     );
@@ -132,7 +154,7 @@ void FeatureDetector::overlayInfo(cv::Mat& frame, int keypointCount) const
     };
 
     std::ostringstream ss;
-    ss << "SIFT keypoints: " << keypointCount;
+    ss << FeatureBackend::typeName(m_backendType) << " keypoints: " << keypointCount;
     putText2(ss.str(), cv::Point(10, 30), 0.65, cv::Scalar(0, 255, 255));
 
     std::ostringstream ms;
@@ -146,6 +168,6 @@ void FeatureDetector::overlayInfo(cv::Mat& frame, int keypointCount) const
     putText2("Point at dollar bill or any textured pattern",
              cv::Point(10, 100), 0.5, cv::Scalar(180, 220, 180));
 
-    putText2("q/ESC: quit",
+    putText2("b: backend  |  q/ESC: quit",
              cv::Point(10, frame.rows - 15), 0.5, cv::Scalar(180, 180, 180));
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+/*
+ * FiducialTarget.cpp - ArUco / ChArUco Fiducial Target Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements downscaled marker detection, full-resolution
+ *              corner refinement and ChArUco corner interpolation.
+ *
+ * Reference:
+ *   OpenCV Documentation - Detection of ChArUco Boards
+ *   https://docs.opencv.org/4.x/df/d4a/tutorial_charuco_detection.html
+ *
+ * Date: March 2026
+ */
+
+#include "FiducialTarget.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#ifdef AR_WITH_ARUCO
+#include <opencv2/objdetect/aruco_detector.hpp>
+#include <opencv2/objdetect/charuco_detector.hpp>
+
+struct FiducialTarget::Impl
+{
+    cv::aruco::Dictionary   dictionary;
+    cv::aruco::CharucoBoard board;
+    cv::aruco::ArucoDetector detector;
+
+    // Per marker id (index into board ids): its 4 corners in world points
+    std::vector<int>                    markerIds;
+    std::vector<std::vector<cv::Vec3f>> markerWorld;
+
+    // Internal chessboard corners, world points and adjacent marker indices
+    std::vector<cv::Vec3f>        cornerWorld;
+    std::vector<std::vector<int>> cornerMarkers;
+
+    Impl()
+        : dictionary(cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50))
+        , board(cv::Size(SQUARES_X, SQUARES_Y), 1.0f, MARKER_LENGTH, dictionary)
+    {
+        // Corners are refined at full resolution instead
+        cv::aruco::DetectorParameters params;
+        params.cornerRefinementMethod = cv::aruco::CORNER_REFINE_NONE;
+        detector = cv::aruco::ArucoDetector(dictionary, params);
+
+        /* Board coordinates: square units, origin at the board's top-left
+         * outer corner, y down. World: origin one square in, (col, -row, 0). */
+        auto toWorld = [](const cv::Point3f& p) {
+            return cv::Vec3f(p.x - 1.0f, -(p.y - 1.0f), 0.0f);
+        };
+
+        markerIds = board.getIds();
+        std::vector<cv::Point2f> centres;
+        for (const auto& corners : board.getObjPoints())
+        {
+            std::vector<cv::Vec3f> world;
+            cv::Point2f centre(0.0f, 0.0f);
+            for (const cv::Point3f& p : corners)
+            {
+                world.push_back(toWorld(p));
+                centre += cv::Point2f(p.x, p.y) * 0.25f;
+            }
+            markerWorld.push_back(world);
+            centres.push_back(centre);
+        }
+
+        // A chessboard corner touches the (up to two) marker squares
+        // diagonal to it, whose centres are ~0.71 squares away
+        for (const cv::Point3f& p : board.getChessboardCorners())
+        {
+            cornerWorld.push_back(toWorld(p));
+            std::vector<int> adjacent;
+            for (size_t m = 0; m < centres.size(); ++m)
+                if (cv::norm(centres[m] - cv::Point2f(p.x, p.y)) < 0.75)
+                    adjacent.push_back(static_cast<int>(m));
+            cornerMarkers.push_back(adjacent);
+        }
+    }
+};
+#else
+struct FiducialTarget::Impl {};
+#endif
+
+/* Constructor */
+FiducialTarget::FiducialTarget()
+    : m_markersFound(0)
+    , m_cornersFound(0)
+{
+#ifdef AR_WITH_ARUCO
+    m_impl = std::make_unique<Impl>();
+#endif
+}
+
+FiducialTarget::~FiducialTarget() = default;
+
+/* isAvailable() */
+bool FiducialTarget::isAvailable()
+{
+#ifdef AR_WITH_ARUCO
+    return true;
+#else
+    return false;
+#endif
+}
+
+/* detect()
+ * Marker search on the downscaled copy finds the squares; all precision
+ * comes from the two cornerSubPix passes at full resolution, with windows
+ * sized to the marker's apparent size so small markers are not blurred
+ * into their neighbours. */
+bool FiducialTarget::detect(const cv::Mat& gray,
+                            std::vector<cv::Point2f>& imagePoints,
+                            std::vector<cv::Vec3f>&   objectPoints)
+{
+    imagePoints.clear();
+    objectPoints.clear();
+    m_markersFound = 0;
+    m_cornersFound = 0;
+
+#ifdef AR_WITH_ARUCO
+    if (gray.empty()) return false;
+
+    /* 1. Detect markers on the downscaled copy */
+    const double scale = gray.cols > DETECT_WIDTH
+                         ? static_cast<double>(DETECT_WIDTH) / gray.cols : 1.0;
+    cv::Mat small;
+    if (scale < 1.0)
+        cv::resize(gray, small, cv::Size(), scale, scale, cv::INTER_AREA);
+    else
+        small = gray;
+
+    std::vector<std::vector<cv::Point2f>> markerCorners;
+    std::vector<int> ids;
+    m_impl->detector.detectMarkers(small, markerCorners, ids);
+
+    /* 2. Keep board markers, scale corners back to full resolution */
+    const cv::TermCriteria criteria(
+        cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.01);
+    std::vector<bool>        found(m_impl->markerIds.size(), false);
+    std::vector<cv::Point2f> boardPlane;   // world x, y of every marker corner
+    double sidePx = 0.0;                   // mean marker side length
+
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        auto it = std::find(m_impl->markerIds.begin(), m_impl->markerIds.end(), ids[i]);
+        if (it == m_impl->markerIds.end()) continue;
+        const size_t m = static_cast<size_t>(it - m_impl->markerIds.begin());
+        if (found[m]) continue;     // duplicate id — ignore the second copy
+        found[m] = true;
+
+        std::vector<cv::Point2f> corners = markerCorners[i];
+        for (cv::Point2f& p : corners) p *= static_cast<float>(1.0 / scale);
+
+        double side = 0.0;
+        for (int k = 0; k < 4; ++k) side += cv::norm(corners[k] - corners[(k + 1) % 4]);
+        side *= 0.25;
+        sidePx += side;
+
+        const int win = std::clamp(static_cast<int>(side * 0.1), 2, 5);
+        cv::cornerSubPix(gray, corners, cv::Size(win, win), cv::Size(-1, -1), criteria);
+
+        for (int k = 0; k < 4; ++k)
+        {
+            imagePoints.push_back(corners[k]);
+            objectPoints.push_back(m_impl->markerWorld[m][k]);
+            boardPlane.emplace_back(m_impl->markerWorld[m][k][0], m_impl->markerWorld[m][k][1]);
+        }
+        ++m_markersFound;
+    }
+    if (m_markersFound == 0) return false;
+    sidePx /= m_markersFound;
+
+    /* 3. ChArUco corners: predict through the homography, snap with cornerSubPix */
+    const cv::Mat H = cv::findHomography(boardPlane, imagePoints, 0);
+    if (H.empty()) return true;
+
+    std::vector<cv::Point2f> plane;
+    std::vector<cv::Vec3f>   world;
+    for (size_t c = 0; c < m_impl->cornerWorld.size(); ++c)
+    {
+        const auto& adjacent = m_impl->cornerMarkers[c];
+        const bool touched = std::any_of(adjacent.begin(), adjacent.end(),
+                                         [&](int m) { return found[m]; });
+        if (!touched) continue;
+        plane.emplace_back(m_impl->cornerWorld[c][0], m_impl->cornerWorld[c][1]);
+        world.push_back(m_impl->cornerWorld[c]);
+    }
+    if (plane.empty()) return true;
+
+    std::vector<cv::Point2f> predicted;
+    cv::perspectiveTransform(plane, predicted, H);
+
+    // One square is 1 / MARKER_LENGTH marker sides
+    const int win = std::clamp(static_cast<int>(sidePx / MARKER_LENGTH * 0.2), 2, 5);
+    const cv::Rect2f inner(static_cast<float>(win + 1), static_cast<float>(win + 1),
+                           static_cast<float>(gray.cols - 2 * (win + 1)),
+                           static_cast<float>(gray.rows - 2 * (win + 1)));
+    std::vector<cv::Point2f> refined;
+    std::vector<cv::Vec3f>   refinedWorld;
+    for (size_t c = 0; c < predicted.size(); ++c)
+    {
+        if (!inner.contains(predicted[c])) continue;
+        refined.push_back(predicted[c]);
+        refinedWorld.push_back(world[c]);
+    }
+    if (refined.empty()) return true;
+
+    const std::vector<cv::Point2f> before = refined;
+    cv::cornerSubPix(gray, refined, cv::Size(win, win), cv::Size(-1, -1), criteria);
+
+    // A corner that wandered a whole window away snapped onto something else
+    std::vector<cv::Point2f> corners;
+    std::vector<cv::Vec3f>   cornerWorld;
+    for (size_t c = 0; c < refined.size(); ++c)
+    {
+        if (cv::norm(refined[c] - before[c]) > win) continue;
+        corners.push_back(refined[c]);
+        cornerWorld.push_back(refinedWorld[c]);
+    }
+    m_cornersFound = static_cast<int>(corners.size());
+
+    /* 4. Chessboard corners first (the precise ones), then marker corners */
+    imagePoints.insert(imagePoints.begin(), corners.begin(), corners.end());
+    objectPoints.insert(objectPoints.begin(), cornerWorld.begin(), cornerWorld.end());
+    return true;
+#else
+    (void)gray;
+    return false;
+#endif
+}
+
+/* drawBoard() */
+bool FiducialTarget::drawBoard(int squarePx, cv::Mat& image)
+{
+#ifdef AR_WITH_ARUCO
+    Impl impl;
+    impl.board.generateImage(cv::Size((SQUARES_X + 2) * squarePx, (SQUARES_Y + 2) * squarePx),
+                             image, squarePx);
+    return true;
+#else
+    (void)squarePx;
+    (void)image;
+    std::cerr << "[WARN] Built without AR_WITH_ARUCO — no fiducial board.\n";
+    return false;
+#endif
+}
@@ -0,0 +1,223 @@
+/*
+ * GLRenderer.cpp - OpenGL Overlay Renderer Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements the GPU wireframe overlay on top of the camera
+ *              texture using the cv::ogl wrappers of OpenCV's OpenGL window.
+ *
+ * Date: March 2026
+ */
+
+#include "GLRenderer.h"
+#include "VirtualMesh.h"
+#include <opencv2/core/opengl.hpp>
+#include <iostream>
+
+#ifdef AR_WITH_OPENGL
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#endif
+
+/* Constructor */
+GLRenderer::GLRenderer()
+    : m_open(false)
+{
+}
+
+/* Destructor */
+GLRenderer::~GLRenderer()
+{
+#ifdef AR_WITH_OPENGL
+    if (m_open) cv::setOpenGlDrawCallback(m_windowName, nullptr, nullptr);
+#endif
+}
+
+/* open()
+ * namedWindow throws when OpenCV has no OpenGL backend — that is the
+ * "not available" case, not an error. */
+bool GLRenderer::open(const std::string& windowName, const cv::Size& frameSize)
+{
+#ifdef AR_WITH_OPENGL
+    try
+    {
+        cv::namedWindow(windowName, cv::WINDOW_OPENGL | cv::WINDOW_AUTOSIZE);
+        cv::resizeWindow(windowName, frameSize.width, frameSize.height);
+        cv::setOpenGlDrawCallback(windowName, &GLRenderer::drawCallback, this);
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "[WARN] OpenGL window unavailable: " << e.what() << "\n";
+        return false;
+    }
+
+    m_windowName = windowName;
+    m_frameSize  = frameSize;
+    m_open       = true;
+    std::cout << "[INFO] OpenGL renderer: " << frameSize.width << "x"
+              << frameSize.height << "\n";
+    return true;
+#else
+    (void)windowName;
+    (void)frameSize;
+    std::cerr << "[WARN] Built without AR_WITH_OPENGL — using CPU line drawing.\n";
+    return false;
+#endif
+}
+
+/* setBackground() */
+void GLRenderer::setBackground(const cv::Mat& frame)
+{
+    if (!m_open) return;
+    m_frameSize = frame.size();
+    m_background.copyFrom(frame);
+}
+
+/* addLine()
+ * Batches are few (one per thickness in use), so a linear search is enough. */
+void GLRenderer::addLine(const cv::Point2f& p1, const cv::Point2f& p2,
+                         const cv::Scalar& color, int thickness)
+{
+    LineBatch* batch = nullptr;
+    for (auto& b : m_batches)
+        if (b.thickness == thickness) { batch = &b; break; }
+    if (!batch)
+    {
+        m_batches.push_back(LineBatch());
+        batch = &m_batches.back();
+        batch->thickness = thickness;
+    }
+
+    const cv::Vec3b rgb(cv::saturate_cast<uchar>(color[2]),
+                        cv::saturate_cast<uchar>(color[1]),
+                        cv::saturate_cast<uchar>(color[0]));
+    batch->vertices.push_back(p1);
+    batch->vertices.push_back(p2);
+    batch->colors.push_back(rgb);
+    batch->colors.push_back(rgb);
+}
+
+/* setCameraMatrix() */
+void GLRenderer::setCameraMatrix(const cv::Mat& cameraMatrix)
+{
+    cameraMatrix.convertTo(m_cameraMatrix, CV_64F);
+}
+
+/* addMesh()
+ * Model-view = OpenCV→GL axis flip (y and z negated) × [R | t]. This 4x4 is
+ * the only per-frame data the mesh needs. */
+void GLRenderer::addMesh(const VirtualMesh& mesh, const cv::Mat& rvec, const cv::Mat& tvec)
+{
+    if (mesh.empty() || rvec.empty() || tvec.empty()) return;
+
+    cv::Mat R, t;
+    cv::Rodrigues(rvec, R);
+    tvec.convertTo(t, CV_64F);
+
+    MeshDraw d;
+    d.mesh = &mesh;
+    for (int col = 0; col < 4; ++col)
+        for (int row = 0; row < 4; ++row)
+        {
+            double v = 0.0;
+            if (row < 3)
+            {
+                v = col < 3 ? R.at<double>(row, col) : t.at<double>(row);
+                if (row > 0) v = -v;
+            }
+            else if (col == 3)
+                v = 1.0;
+            d.modelView[col * 4 + row] = v;
+        }
+    m_meshes.push_back(d);
+}
+
+/* segmentCount() */
+int GLRenderer::segmentCount() const
+{
+    size_t n = 0;
+    for (const auto& b : m_batches) n += b.vertices.size() / 2;
+    return static_cast<int>(n);
+}
+
+/* present()
+ * updateWindow triggers drawCallback synchronously in the GL context. */
+void GLRenderer::present()
+{
+    if (m_open) cv::updateWindow(m_windowName);
+    for (auto& b : m_batches)
+    {
+        b.vertices.clear();
+        b.colors.clear();
+    }
+    m_meshes.clear();
+}
+
+/* drawCallback() */
+void GLRenderer::drawCallback(void* userdata)
+{
+    static_cast<GLRenderer*>(userdata)->render();
+}
+
+/* render()
+ * Background: textured quad over the whole viewport. Meshes: perspective
+ * projection from the camera matrix, so a mesh vertex lands on the same
+ * pixel as cv::projectPoints without distortion. Lines: pixel coordinates
+ * through an orthographic projection with y pointing down, matching the
+ * image convention of cv::projectPoints. */
+void GLRenderer::render()
+{
+#ifdef AR_WITH_OPENGL
+    if (!m_background.empty())
+        cv::ogl::render(m_background);
+
+    if (!m_meshes.empty() && !m_cameraMatrix.empty())
+    {
+        const double w  = m_frameSize.width,  h  = m_frameSize.height;
+        const double fx = m_cameraMatrix.at<double>(0, 0);
+        const double fy = m_cameraMatrix.at<double>(1, 1);
+        const double cx = m_cameraMatrix.at<double>(0, 2);
+        const double cy = m_cameraMatrix.at<double>(1, 2);
+        const double n  = 0.1, f = 1000.0;   // target units (squares / cm)
+
+        // Column-major; pixel (0,0) is the top-left corner
+        const double proj[16] = {
+            2.0 * fx / w, 0.0,              0.0,                     0.0,
+            0.0,          2.0 * fy / h,     0.0,                     0.0,
+            1.0 - 2.0 * cx / w, 2.0 * cy / h - 1.0, -(f + n) / (f - n), -1.0,
+            0.0,          0.0,              -2.0 * f * n / (f - n),  0.0
+        };
+
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixd(proj);
+        glMatrixMode(GL_MODELVIEW);
+        glDisable(GL_TEXTURE_2D);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_DEPTH_TEST);
+
+        for (const auto& d : m_meshes)
+        {
+            glLoadMatrixd(d.modelView);
+            d.mesh->drawGL();
+        }
+        glDisable(GL_DEPTH_TEST);
+    }
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, m_frameSize.width, m_frameSize.height, 0.0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_LINE_SMOOTH);
+
+    for (const auto& b : m_batches)
+    {
+        if (b.vertices.empty()) continue;
+        glLineWidth(static_cast<GLfloat>(b.thickness));
+        m_arrays.setVertexArray(b.vertices);
+        m_arrays.setColorArray(b.colors);
+        cv::ogl::render(m_arrays, cv::ogl::LINES);
+    }
+#endif
+}
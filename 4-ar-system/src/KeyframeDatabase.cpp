@@ -0,0 +1,189 @@
+/*
+ * KeyframeDatabase.cpp - Keyframe Store for Relocalisation Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements the bag-of-words vocabulary, keyframe storage with
+ *              least-recently-used replacement, and inverted-index queries
+ *              used by SIFTTracker to reacquire the bill after a loss.
+ *
+ * Date: March 2026
+ */
+
+#include "KeyframeDatabase.h"
+#include <algorithm>
+#include <cmath>
+
+/* buildVocabulary()
+ * k-means runs from a fixed RNG state so every start (and every arBench run)
+ * gets the same words; the global RNG is restored afterwards. */
+void KeyframeDatabase::buildVocabulary(const cv::Mat& refDescriptors, int normType)
+{
+    m_words.release();
+    m_idf.clear();
+    m_wordMatcher.release();
+    clear();
+    if (refDescriptors.empty()) return;
+
+    const int words = std::min(VOCABULARY_SIZE, refDescriptors.rows);
+    if (refDescriptors.type() == CV_32F)
+    {
+        cv::RNG&       rng   = cv::theRNG();
+        const uint64_t saved = rng.state;
+        rng.state = 0x4b465644;
+
+        cv::Mat labels;
+        cv::kmeans(refDescriptors, words, labels,
+                   cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 10, 1e-3),
+                   1, cv::KMEANS_PP_CENTERS, m_words);
+        rng.state = saved;
+    }
+    else
+    {
+        // Binary descriptors have no mean — use evenly spaced ones as medoids
+        for (int w = 0; w < words; ++w)
+            m_words.push_back(refDescriptors.row(
+                static_cast<int>(static_cast<long long>(w) * refDescriptors.rows / words)));
+    }
+
+    m_wordMatcher = cv::BFMatcher::create(normType);
+    m_wordMatcher->add(std::vector<cv::Mat>{ m_words });
+    m_wordMatcher->train();
+
+    // idf over the reference descriptors
+    std::vector<cv::DMatch> assigned;
+    m_wordMatcher->match(refDescriptors, assigned);
+    std::vector<int> counts(m_words.rows, 0);
+    for (const auto& m : assigned)
+        ++counts[m.trainIdx];
+
+    m_idf.resize(m_words.rows);
+    for (int w = 0; w < m_words.rows; ++w)
+        m_idf[w] = std::log(static_cast<float>(refDescriptors.rows) / (1.0f + counts[w])) + 1.0f;
+    m_inverted.assign(m_words.rows, {});
+}
+
+/* clear() */
+void KeyframeDatabase::clear()
+{
+    m_keyframes.clear();
+    m_inverted.assign(m_words.rows, {});
+}
+
+/* transform()
+ * Nearest word per descriptor, then tf * idf per word, L1-normalised. */
+KeyframeDatabase::BowVector KeyframeDatabase::transform(const cv::Mat& descriptors) const
+{
+    BowVector v;
+    if (!hasVocabulary() || descriptors.empty() || descriptors.type() != m_words.type())
+        return v;
+
+    std::vector<cv::DMatch> assigned;
+    m_wordMatcher->match(descriptors, assigned);
+
+    std::vector<float> weights(m_words.rows, 0.0f);
+    for (const auto& m : assigned)
+        weights[m.trainIdx] += m_idf[m.trainIdx];
+
+    float total = 0.0f;
+    for (float w : weights)
+        total += w;
+    if (total <= 0.0f) return v;
+
+    for (int w = 0; w < m_words.rows; ++w)
+        if (weights[w] > 0.0f)
+            v.emplace_back(w, weights[w] / total);
+    return v;
+}
+
+/* score()
+ * Both vectors are ascending by word: one merge pass. For L1-normalised
+ * vectors sum(min) equals 1 - |a - b|_1 / 2. */
+float KeyframeDatabase::score(const BowVector& a, const BowVector& b)
+{
+    float  s = 0.0f;
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (a[i].first < b[j].first)      ++i;
+        else if (b[j].first < a[i].first) ++j;
+        else
+        {
+            s += std::min(a[i].second, b[j].second);
+            ++i;
+            ++j;
+        }
+    }
+    return s;
+}
+
+/* add()
+ * A full store replaces the keyframe least recently added or used for a
+ * reacquisition — views the camera keeps returning to survive. */
+bool KeyframeDatabase::add(Keyframe keyframe)
+{
+    if (!hasVocabulary() || keyframe.descriptors.empty()) return false;
+
+    keyframe.bow = transform(keyframe.descriptors);
+    if (keyframe.bow.empty()) return false;
+
+    const std::vector<int> similar = query(keyframe.bow, 1);
+    if (!similar.empty() && score(keyframe.bow, m_keyframes[similar[0]].bow) >= NOVELTY_SCORE)
+        return false;
+
+    keyframe.lastUsed = ++m_clock;
+    if (size() < MAX_KEYFRAMES)
+    {
+        const int index = size();
+        for (const auto& w : keyframe.bow)
+            m_inverted[w.first].push_back(index);
+        m_keyframes.push_back(std::move(keyframe));
+    }
+    else
+    {
+        auto oldest = std::min_element(m_keyframes.begin(), m_keyframes.end(),
+                                       [](const Keyframe& a, const Keyframe& b)
+                                       { return a.lastUsed < b.lastUsed; });
+        *oldest = std::move(keyframe);
+        rebuildIndex();
+    }
+    return true;
+}
+
+/* query()
+ * Only keyframes sharing at least one word with v are scored. */
+std::vector<int> KeyframeDatabase::query(const BowVector& v, int maxResults) const
+{
+    std::vector<char> seen(m_keyframes.size(), 0);
+    std::vector<int>  candidates;
+    for (const auto& w : v)
+    {
+        for (int k : m_inverted[w.first])
+        {
+            if (!seen[k]) candidates.push_back(k);
+            seen[k] = 1;
+        }
+    }
+
+    std::vector<std::pair<float, int>> ranked;
+    for (int k : candidates)
+    {
+        const float s = score(v, m_keyframes[k].bow);
+        if (s >= MIN_QUERY_SCORE) ranked.emplace_back(s, k);
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const std::pair<float, int>& a, const std::pair<float, int>& b)
+              { return a.first > b.first; });
+
+    std::vector<int> result;
+    for (int i = 0; i < static_cast<int>(ranked.size()) && i < maxResults; ++i)
+        result.push_back(ranked[i].second);
+    return result;
+}
+
+/* rebuildIndex() */
+void KeyframeDatabase::rebuildIndex()
+{
+    m_inverted.assign(m_words.rows, {});
+    for (int k = 0; k < size(); ++k)
+        for (const auto& w : m_keyframes[k].bow)
+            m_inverted[w.first].push_back(k);
+}
@@ -0,0 +1,98 @@
+/*
+ * LatencyController.cpp - Latency-Budget Quality Controller Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements the quality ladder and the hysteresis that moves
+ *              SIFTTracker along it from detection-frame timings.
+ *
+ * Date: March 2026
+ */
+
+#include "LatencyController.h"
+#include <algorithm>
+
+/* Constructor */
+LatencyController::LatencyController()
+    : m_budgetMs(0.0)
+    , m_avgMs(0.0)
+    , m_level(0)
+    , m_overFrames(0)
+    , m_underFrames(0)
+    , m_settleFrames(0)
+{
+}
+
+/* levelSettings() */
+const LatencyController::Settings& LatencyController::levelSettings(int level)
+{
+    static const Settings ladder[LEVEL_COUNT] = {
+        { 1.00, 1.00, 0.30f, 2000 },
+        { 0.80, 0.85, 0.25f, 1000 },
+        { 0.60, 0.70, 0.20f,  500 },
+        { 0.45, 0.55, 0.15f,  250 },
+        { 0.30, 0.40, 0.10f,  100 },
+    };
+    return ladder[std::clamp(level, 0, LEVEL_COUNT - 1)];
+}
+
+/* setBudget() */
+void LatencyController::setBudget(double ms)
+{
+    m_budgetMs = std::max(0.0, ms);
+    m_avgMs    = 0.0;
+    setLevel(0);
+}
+
+/* setLevel() */
+void LatencyController::setLevel(int level)
+{
+    m_level        = std::clamp(level, 0, LEVEL_COUNT - 1);
+    m_overFrames   = 0;
+    m_underFrames  = 0;
+    m_settleFrames = SETTLE_FRAMES;
+}
+
+/* update()
+ * The average is reseeded from the first frame after a level change, so it
+ * measures the new settings rather than the tail of the old ones. */
+bool LatencyController::update(double frameMs, bool tracking, bool scarce)
+{
+    if (!isEnabled()) return false;
+
+    if (m_settleFrames > 0)
+    {
+        if (m_settleFrames-- == SETTLE_FRAMES) m_avgMs = frameMs;
+        else m_avgMs += EMA_ALPHA * (frameMs - m_avgMs);
+        return false;
+    }
+    m_avgMs += EMA_ALPHA * (frameMs - m_avgMs);
+
+    const bool starved = scarce || !tracking;
+
+    if (m_avgMs > m_budgetMs)
+    {
+        m_underFrames = 0;
+        if (++m_overFrames >= DOWNGRADE_FRAMES && !starved &&
+            m_level < LEVEL_COUNT - 1)
+        {
+            setLevel(m_level + 1);
+            return true;
+        }
+    }
+    else if (m_avgMs < UPGRADE_HEADROOM * m_budgetMs)
+    {
+        m_overFrames = 0;
+        const int needed = starved ? STARVED_UPGRADE_FRAMES : UPGRADE_FRAMES;
+        if (++m_underFrames >= needed && m_level > 0)
+        {
+            setLevel(m_level - 1);
+            return true;
+        }
+    }
+    else
+    {
+        // Inside the dead band — hold the level
+        m_overFrames  = 0;
+        m_underFrames = 0;
+    }
+    return false;
+}
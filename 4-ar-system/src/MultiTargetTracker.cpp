@@ -0,0 +1,532 @@
+/*
+ * MultiTargetTracker.cpp - Shared-Detection Planar Target Tracker Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements one-pass detection and combined-index matching for
+ *              several planar targets, with per-target pose estimation run
+ *              in parallel.
+ *
+ * Extension:   Multiple targets in the scene
+ *
+ * Date: March 2026
+ */
+
+#include "MultiTargetTracker.h"
+#include "SIFTTracker.h"
+#include "ReferenceCompiler.h"
+#include "AssetCache.h"
+#include <opencv2/flann.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/* Constructor */
+MultiTargetTracker::MultiTargetTracker(const std::string& calibrationFile,
+                                       int nfeatures,
+                                       FeatureBackend::Type backend,
+                                       const std::string& modelPath)
+    : m_calibrationFile(calibrationFile)
+    , m_nfeatures(nfeatures)
+    , m_backendType(backend)
+    , m_modelPath(modelPath)
+    , m_smoothAlpha(0.35f)   // same responsiveness as SIFTTracker
+    , m_lastMatchCount(0)
+    , m_databaseOffset(0)
+    , m_lastRetrievalMs(0.0)
+{
+}
+
+/* addTarget() */
+int MultiTargetTracker::addTarget(const std::string& name,
+                                  const std::string& referenceImage,
+                                  float widthCm, float heightCm)
+{
+    Target t;
+    t.name       = name;
+    t.imagePath  = referenceImage;
+    t.widthCm    = widthCm;
+    t.heightCm   = heightCm;
+    t.rvec       = cv::Mat::zeros(3, 1, CV_64F);
+    t.tvec       = cv::Mat::zeros(3, 1, CV_64F);
+    t.rvecSmooth = cv::Mat::zeros(3, 1, CV_64F);
+    t.tvecSmooth = cv::Mat::zeros(3, 1, CV_64F);
+    m_targets.push_back(t);
+    return static_cast<int>(m_targets.size()) - 1;
+}
+
+/* loadDatabase()
+ * Database targets arrive with their features, so initialize() neither
+ * reads their images nor builds a combined index over them. */
+bool MultiTargetTracker::loadDatabase(const std::string& path)
+{
+    if (hasDatabase())
+    {
+        std::cerr << "[ERROR] MultiTargetTracker already has a target database.\n";
+        return false;
+    }
+
+    TargetDatabase db;
+    if (!db.load(path)) return false;
+
+    // CUDA-ORB descriptors are ORB descriptors
+    auto descriptorType = [](FeatureBackend::Type t) {
+        return t == FeatureBackend::CUDA_ORB ? FeatureBackend::ORB : t;
+    };
+    if (descriptorType(db.backend()) != descriptorType(m_backendType))
+    {
+        std::cerr << "[ERROR] " << path << " was built for "
+                  << FeatureBackend::typeName(db.backend()) << ", not "
+                  << FeatureBackend::typeName(m_backendType) << ".\n";
+        return false;
+    }
+
+    m_databaseOffset = targetCount();
+    for (int i = 0; i < db.size(); ++i)
+    {
+        const DatabaseTarget& d = db.target(i);
+        const int id = addTarget(d.name, "", d.widthCm, d.heightCm);
+        Target& t = m_targets[id];
+        t.refSize        = d.refSize;
+        t.refKeypoints   = d.keypoints;
+        t.refDescriptors = d.descriptors;
+        t.pinned         = false;
+    }
+    m_database = std::move(db);
+    return true;
+}
+
+/* initialize()
+ * Reference features per target (compiled .arref, else the AssetCache,
+ * else detected and cached), then one index over all of them. The
+ * matcher keeps each target's descriptors as a separate train set, so
+ * DMatch::imgIdx identifies the target without any lookup table. */
+bool MultiTargetTracker::initialize()
+{
+    if (m_targets.empty())
+    {
+        std::cerr << "[ERROR] MultiTargetTracker has no targets.\n";
+        return false;
+    }
+    if (!loadCalibration()) return false;
+
+    // The live frame gets a share per target that can be matched at once
+    int matchedTargets = targetCount();
+    if (hasDatabase())
+        matchedTargets = std::min(targetCount(), m_databaseOffset + RETRIEVE_CANDIDATES);
+
+    m_refFeatures  = FeatureBackend::create(m_backendType, m_nfeatures, m_modelPath);
+    m_liveFeatures = FeatureBackend::create(
+        m_backendType, m_nfeatures * matchedTargets, m_modelPath);
+    if (!m_refFeatures || !m_liveFeatures) return false;
+    m_backendType = m_refFeatures->type();  // CUDA-ORB may have fallen back to ORB
+    m_clahe = cv::createCLAHE(SIFTTracker::CLAHE_CLIP,
+                              cv::Size(SIFTTracker::CLAHE_TILES, SIFTTracker::CLAHE_TILES));
+    const AssetCache cache(m_cacheDir);
+
+    std::vector<cv::Mat> trainSets;
+    for (auto& t : m_targets)
+    {
+        if (!t.pinned) continue;      // database target — features already loaded
+
+        cv::Mat refGray = cv::imread(t.imagePath, cv::IMREAD_GRAYSCALE);
+        if (refGray.empty())
+        {
+            std::cerr << "[ERROR] Cannot load reference image: " << t.imagePath << "\n";
+            return false;
+        }
+        t.refSize = refGray.size();
+
+        // Gray comes from IMREAD_GRAYSCALE here, so entries are kept apart
+        // from SIFTTracker's ("mref" vs "ref")
+        const uint64_t cacheKey = m_cacheDir.empty() ? 0 :
+            SIFTTracker::referenceCacheKey(t.imagePath, m_backendType,
+                                           m_nfeatures, m_modelPath);
+
+        CompiledReference    compiled;
+        std::vector<cv::Mat> cached;
+        if (ReferenceCompiler::loadFor(t.imagePath, m_backendType, t.refSize, compiled))
+        {
+            t.refKeypoints   = std::move(compiled.keypoints);
+            t.refDescriptors = compiled.descriptors;
+        }
+        else if (cache.load("mref", cacheKey, cached) && cached.size() == 2)
+        {
+            AssetCache::unpackKeypoints(cached[0], t.refKeypoints);
+            t.refDescriptors = cached[1];
+        }
+        else
+        {
+            cv::Mat refEnhanced;
+            m_clahe->apply(refGray, refEnhanced);
+            m_refFeatures->detectAndCompute(refEnhanced, cv::Mat(),
+                                            t.refKeypoints, t.refDescriptors);
+            if (!t.refDescriptors.empty())
+                cache.store("mref", cacheKey,
+                            { AssetCache::packKeypoints(t.refKeypoints), t.refDescriptors });
+        }
+        if (t.refDescriptors.empty())
+        {
+            std::cerr << "[ERROR] No features on reference: " << t.imagePath << "\n";
+            return false;
+        }
+
+        trainSets.push_back(t.refDescriptors);
+        std::cout << "[INFO] Target " << trainSets.size() - 1 << " '" << t.name
+                  << "': " << t.refKeypoints.size() << " keypoints\n";
+    }
+
+    if (hasDatabase())
+    {
+        // Per-target indices — database targets get theirs when first retrieved
+        for (auto& t : m_targets)
+        {
+            if (!t.pinned) continue;
+            t.matcher = createMatcher();
+            t.matcher->add(std::vector<cv::Mat>{ t.refDescriptors });
+            t.matcher->train();
+        }
+        std::cout << "[INFO] Database mode: " << m_database.size() << " database + "
+                  << m_databaseOffset << " pinned targets ("
+                  << FeatureBackend::typeName(m_backendType) << ")\n";
+        return true;
+    }
+
+    m_matcher = createMatcher();
+    m_matcher->add(trainSets);
+    m_matcher->train();
+
+    std::cout << "[INFO] Combined index: " << m_targets.size() << " targets ("
+              << FeatureBackend::typeName(m_backendType) << ")\n";
+    return true;
+}
+
+/* createMatcher()
+ * FLANN — the combined index grows with targets, brute force would too. */
+cv::Ptr<cv::DescriptorMatcher> MultiTargetTracker::createMatcher() const
+{
+    if (m_liveFeatures->isBinary())
+        return cv::makePtr<cv::FlannBasedMatcher>(
+            cv::makePtr<cv::flann::LshIndexParams>(6, 12, 1),
+            cv::makePtr<cv::flann::SearchParams>(32));
+    return cv::makePtr<cv::FlannBasedMatcher>(
+        cv::makePtr<cv::flann::KDTreeIndexParams>(4),
+        cv::makePtr<cv::flann::SearchParams>(32));
+}
+
+/* loadCalibration() */
+bool MultiTargetTracker::loadCalibration()
+{
+    cv::FileStorage fs(m_calibrationFile, cv::FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        std::cerr << "[ERROR] Cannot open calibration: " << m_calibrationFile << "\n";
+        return false;
+    }
+
+    fs["camera_matrix"]           >> m_cameraMatrix;
+    fs["distortion_coefficients"] >> m_distCoeffs;
+    fs.release();
+
+    if (m_cameraMatrix.empty() || m_distCoeffs.empty())
+    {
+        std::cerr << "[ERROR] Calibration file missing keys.\n";
+        return false;
+    }
+    return true;
+}
+
+/* track()
+ * One grayscale/CLAHE/detect/match pass for all targets; only RANSAC and
+ * the pose solve are per target. Cost grows with the number of matches, not with
+ * the number of registered targets (database mode: see trackDatabase()). */
+int MultiTargetTracker::track(const cv::Mat& frame)
+{
+    cvcore::FrameContext context(frame);
+    return track(context);
+}
+
+int MultiTargetTracker::track(cvcore::FrameContext& context)
+{
+    std::vector<char> wasTracking(m_targets.size());
+    for (size_t i = 0; i < m_targets.size(); ++i)
+        wasTracking[i] = m_targets[i].tracking;
+
+    for (auto& t : m_targets)
+    {
+        t.tracking    = false;
+        t.inlierCount = 0;
+        t.inlierPts.clear();
+        t.timings.clear();
+    }
+    m_lastMatchCount = 0;
+    m_lastCandidates.clear();
+    m_timings.clear();
+
+    cv::Mat enhanced;
+    {
+        StageTimer st(m_timings, StageTimings::GRAY);
+        context.gray();
+    }
+    {
+        StageTimer st(m_timings, StageTimings::CLAHE);
+        enhanced = context.clahe(SIFTTracker::CLAHE_CLIP,
+                                 cv::Size(SIFTTracker::CLAHE_TILES, SIFTTracker::CLAHE_TILES));
+    }
+
+    cv::Mat liveDescriptors;
+    m_lastLiveKeypoints.clear();
+    {
+        StageTimer st(m_timings, StageTimings::DETECT);
+        m_liveFeatures->detectAndCompute(enhanced, cv::Mat(),
+                                         m_lastLiveKeypoints, liveDescriptors);
+    }
+    if (liveDescriptors.empty()) return 0;
+
+    if (hasDatabase())
+        trackDatabase(liveDescriptors, wasTracking);
+    else
+    {
+        /* Ratio test over the combined index — a live feature that resembles
+         * two targets equally is ambiguous and dropped, like a repeated
+         * pattern within one target */
+        std::vector<std::vector<cv::DMatch>> perTarget(m_targets.size());
+        {
+            StageTimer st(m_timings, StageTimings::MATCH);
+            std::vector<std::vector<cv::DMatch>> knnMatches;
+            m_matcher->knnMatch(liveDescriptors, knnMatches, 2);
+
+            const float ratio = m_liveFeatures->isBinary() ? SIFTTracker::BINARY_RATIO_THRESHOLD
+                                                           : SIFTTracker::RATIO_THRESHOLD;
+            for (const auto& m : knnMatches)
+            {
+                if (m.size() == 2 && m[0].distance < ratio * m[1].distance)
+                {
+                    perTarget[m[0].imgIdx].push_back(m[0]);
+                    ++m_lastMatchCount;
+                }
+            }
+        }
+
+        const int n = static_cast<int>(m_targets.size());
+        cv::parallel_for_(cv::Range(0, n), [&](const cv::Range& range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+                if (static_cast<int>(perTarget[i].size()) >= MIN_INLIERS)
+                    estimateTargetPose(m_targets[i], perTarget[i]);
+        });
+    }
+
+    for (auto& t : m_targets)
+    {
+        if (!t.tracking) t.solver.reset();
+        m_timings.ms[StageTimings::MATCH]  += t.timings.ms[StageTimings::MATCH];
+        m_timings.ms[StageTimings::RANSAC] += t.timings.ms[StageTimings::RANSAC];
+        m_timings.ms[StageTimings::PNP]    += t.timings.ms[StageTimings::PNP];
+    }
+
+    int tracked = 0;
+    for (const auto& t : m_targets)
+        if (t.tracking) ++tracked;
+    return tracked;
+}
+
+/* trackDatabase()
+ * Retrieval picks which targets are worth matching; each of them is then
+ * matched against its own index, so the ratio test compares neighbours
+ * within one target only, as in SIFTTracker. Targets tracked in the last
+ * frame stay active even when retrieval misses them (a small or partly
+ * covered target shares few words with the whole frame). */
+void MultiTargetTracker::trackDatabase(const cv::Mat& liveDescriptors,
+                                       const std::vector<char>& wasTracking)
+{
+    std::vector<char> active(m_targets.size(), 0);
+    for (size_t i = 0; i < m_targets.size(); ++i)
+        active[i] = m_targets[i].pinned || wasTracking[i];
+
+    {
+        StageTimer st(m_timings, StageTimings::MATCH);
+        const auto t0 = std::chrono::steady_clock::now();
+        for (const auto& c : m_database.query(liveDescriptors, RETRIEVE_CANDIDATES))
+        {
+            const int id = m_databaseOffset + c.target;
+            m_lastCandidates.push_back(id);
+            active[id] = 1;
+        }
+        m_lastRetrievalMs = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - t0).count();
+    }
+
+    std::vector<int> ids;
+    for (int i = 0; i < targetCount(); ++i)
+    {
+        Target& t = m_targets[i];
+        if (!active[i] || t.refDescriptors.empty()) continue;
+        if (!t.matcher)
+        {
+            t.matcher = createMatcher();
+            t.matcher->add(std::vector<cv::Mat>{ t.refDescriptors });
+            t.matcher->train();
+        }
+        ids.push_back(i);
+    }
+
+    const float ratio = m_liveFeatures->isBinary() ? SIFTTracker::BINARY_RATIO_THRESHOLD
+                                                   : SIFTTracker::RATIO_THRESHOLD;
+    std::vector<int> matchCounts(ids.size(), 0);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(ids.size())), [&](const cv::Range& range)
+    {
+        for (int k = range.start; k < range.end; ++k)
+        {
+            Target& t = m_targets[ids[k]];
+            std::vector<cv::DMatch> matches;
+            {
+                StageTimer st(t.timings, StageTimings::MATCH);
+                std::vector<std::vector<cv::DMatch>> knnMatches;
+                t.matcher->knnMatch(liveDescriptors, knnMatches, 2);
+                for (const auto& m : knnMatches)
+                    if (m.size() == 2 && m[0].distance < ratio * m[1].distance)
+                        matches.push_back(m[0]);
+            }
+            matchCounts[k] = static_cast<int>(matches.size());
+            if (matchCounts[k] >= MIN_INLIERS)
+                estimateTargetPose(t, matches);
+        }
+    });
+
+    for (int count : matchCounts)
+        m_lastMatchCount += count;
+}
+
+/* estimateTargetPose()
+ * Same steps as SIFTTracker::estimatePose(): RANSAC homography (5px) to
+ * reject outliers, reference pixel → cm on the target plane, the target's
+ * own PoseSolver (IPPE, warm while tracking), then EMA smoothing. */
+void MultiTargetTracker::estimateTargetPose(Target& t,
+                                            const std::vector<cv::DMatch>& matches) const
+{
+    std::vector<cv::Point2f> refPts, livePts;
+    for (const auto& m : matches)
+    {
+        refPts.push_back(t.refKeypoints[m.trainIdx].pt);
+        livePts.push_back(m_lastLiveKeypoints[m.queryIdx].pt);
+    }
+
+    cv::Mat inlierMask, H;
+    {
+        StageTimer st(t.timings, StageTimings::RANSAC);
+        H = cv::findHomography(refPts, livePts, cv::RANSAC, 5.0, inlierMask);
+    }
+    if (H.empty()) return;
+
+    std::vector<cv::Vec3f>   objPoints;
+    std::vector<cv::Point2f> imgPoints;
+    for (int i = 0; i < inlierMask.rows; ++i)
+    {
+        if (!inlierMask.at<uchar>(i)) continue;
+        objPoints.emplace_back(refPts[i].x / t.refSize.width  * t.widthCm,
+                               refPts[i].y / t.refSize.height * t.heightCm,
+                               0.0f);
+        imgPoints.push_back(livePts[i]);
+    }
+    t.inlierCount = static_cast<int>(imgPoints.size());
+    if (t.inlierCount < MIN_INLIERS) return;
+
+    bool ok;
+    {
+        StageTimer st(t.timings, StageTimings::PNP);
+        ok = t.solver.solve(objPoints, imgPoints, m_cameraMatrix, m_distCoeffs,
+                            t.rvec, t.tvec);
+    }
+    if (!ok) return;
+
+    t.tracking  = true;
+    t.inlierPts = imgPoints;
+
+    if (!t.hasSmooth)
+    {
+        t.rvec.copyTo(t.rvecSmooth);
+        t.tvec.copyTo(t.tvecSmooth);
+        t.hasSmooth = true;
+    }
+    else
+    {
+        t.rvecSmooth = m_smoothAlpha * t.rvec + (1.0 - m_smoothAlpha) * t.rvecSmooth;
+        t.tvecSmooth = m_smoothAlpha * t.tvec + (1.0 - m_smoothAlpha) * t.tvecSmooth;
+    }
+}
+
+/* setIntrinsics() */
+void MultiTargetTracker::setIntrinsics(const cv::Mat& cameraMatrix,
+                                       const cv::Mat& distCoeffs)
+{
+    m_cameraMatrix = cameraMatrix.clone();
+    m_distCoeffs   = distCoeffs.clone();
+    for (auto& t : m_targets) t.solver.reset();
+}
+
+/* getRvec() / getTvec() */
+const cv::Mat& MultiTargetTracker::getRvec(int id) const
+{
+    const Target& t = m_targets[id];
+    return t.hasSmooth ? t.rvecSmooth : t.rvec;
+}
+
+const cv::Mat& MultiTargetTracker::getTvec(int id) const
+{
+    const Target& t = m_targets[id];
+    return t.hasSmooth ? t.tvecSmooth : t.tvec;
+}
+
+/* drawDebug()
+ * Inlier points and projected outline per tracked target, one colour each. */
+void MultiTargetTracker::drawDebug(cv::Mat& displayFrame) const
+{
+    static const cv::Scalar colours[] = {
+        cv::Scalar(0, 165, 255), cv::Scalar(255, 255, 0),
+        cv::Scalar(255, 0, 255), cv::Scalar(0, 255, 0)
+    };
+
+    for (int id = 0; id < targetCount(); ++id)
+    {
+        const Target& t = m_targets[id];
+        if (!t.tracking) continue;
+        const cv::Scalar& col = colours[id % 4];
+
+        for (const auto& pt : t.inlierPts)
+            cv::circle(displayFrame, pt, 4, col, 1);
+
+        std::vector<cv::Point3f> corners = {
+            { 0.0f,      0.0f,       0.0f }, { t.widthCm, 0.0f,       0.0f },
+            { t.widthCm, t.heightCm, 0.0f }, { 0.0f,      t.heightCm, 0.0f }
+        };
+        std::vector<cv::Point2f> projected;
+        cv::projectPoints(corners, t.rvec, t.tvec,
+                          m_cameraMatrix, m_distCoeffs, projected);
+        std::vector<cv::Point> outline(projected.begin(), projected.end());
+        cv::polylines(displayFrame, outline, true, col, 2);
+        cv::putText(displayFrame, t.name, outline[0] + cv::Point(4, -6),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, col, 1);
+    }
+
+    std::ostringstream ss;
+    ss << FeatureBackend::typeName(m_backendType) << "  keypoints: "
+       << m_lastLiveKeypoints.size() << "  matches: " << m_lastMatchCount;
+    cv::putText(displayFrame, ss.str(), cv::Point(10, 80),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 3);
+    cv::putText(displayFrame, ss.str(), cv::Point(10, 80),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 1);
+
+    if (hasDatabase())
+    {
+        std::ostringstream db;
+        db << "database: " << m_database.size() << " targets  retrieval "
+           << std::fixed << std::setprecision(2) << m_lastRetrievalMs << " ms ->";
+        for (int id : m_lastCandidates)
+            db << " " << m_targets[id].name;
+        cv::putText(displayFrame, db.str(), cv::Point(10, 100),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 3);
+        cv::putText(displayFrame, db.str(), cv::Point(10, 100),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 1);
+    }
+}
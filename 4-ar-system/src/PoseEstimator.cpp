@@ -13,6 +13,9 @@
  */
 
 #include "PoseEstimator.h"
+#include "CameraCalibration.h"
+#include <cvcore/capture.hpp>
+#include <opencv2/video/tracking.hpp>
 #include <iostream>
 #include <iomanip>
 
@@ -23,11 +26,33 @@ PoseEstimator::PoseEstimator(const std::string& calibrationFile, int cameraId)
     , m_displayMode(DisplayMode::AXES_ONLY)
     , m_poseValid(false)
     , m_boardSize(BOARD_WIDTH, BOARD_HEIGHT)
+    , m_targetType(TargetType::CHESSBOARD)
+    , m_trackingMode(true)
+    , m_cornersTracked(false)
 {
     /* Initialize rvec and tvec as empty 3x1 double matrices.
      * solvePnP will fill these each frame. */
     m_rvec = cv::Mat::zeros(3, 1, CV_64F);
     m_tvec = cv::Mat::zeros(3, 1, CV_64F);
+
+    buildWorldPoints(m_gridPoints);
+}
+
+/* setTargetType()
+ * The previous target's corners and pose say nothing about the new one. */
+bool PoseEstimator::setTargetType(TargetType type)
+{
+    if (type == TargetType::FIDUCIAL && !FiducialTarget::isAvailable())
+    {
+        std::cerr << "[WARN] Built without AR_WITH_ARUCO — fiducial target unavailable.
+";
+        return false;
+    }
+    m_targetType = type;
+    m_objectPoints.clear();
+    m_prevCorners.clear();
+    m_solver.reset();
+    return true;
 }
 
 /* run() - Main video loop for Task 4 */
@@ -42,8 +67,8 @@ bool PoseEstimator::run()
     }
 
     /* Open webcam */
-    cv::VideoCapture cap(m_cameraId);
-    if (!cap.isOpened())
+    auto cap = cvcore::FrameSource::open("", m_cameraId);
+    if (!cap)
     {
         std::cerr << "[ERROR] Cannot open camera ID: " << m_cameraId << "\n";
         return false;
@@ -68,8 +93,7 @@ bool PoseEstimator::run()
 
     while (true)
     {
-        cap >> frame;
-        if (frame.empty()) break;
+        if (!cap->read(frame)) break;
 
         std::vector<cv::Point2f> corners;
         bool found = detectCorners(frame, corners);
@@ -113,7 +137,7 @@ bool PoseEstimator::run()
         }
     }
 
-    cap.release();
+    cap.reset();
     cv::destroyAllWindows();
     return true;
 }
@@ -149,35 +173,144 @@ bool PoseEstimator::loadCalibration()
     return true;
 }
 
+/* setIntrinsics()
+ * Swapping intrinsics changes the pixel geometry, so the tracked corners
+ * and the warm pose no longer apply. */
+void PoseEstimator::setIntrinsics(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs)
+{
+    m_cameraMatrix = cameraMatrix.clone();
+    m_distCoeffs   = distCoeffs.clone();
+    m_prevCorners.clear();
+    m_solver.reset();
+}
+
 /* detectCorners()
- * Finds and refines chessboard corners. Reuses the same approach as Task 1. */
+ * Tracks the previous corners when possible; otherwise runs the same
+ * coarse-to-fine search as Task 1. Accepts a BGR frame or an already
+ * converted grayscale frame, so callers sharing one conversion between
+ * trackers skip the second cvtColor. */
 bool PoseEstimator::detectCorners(const cv::Mat& frame,
                                    std::vector<cv::Point2f>& corners)
 {
-    cv::Mat gray;
-    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    cvcore::FrameContext context(frame);
+    return detectCorners(context, corners);
+}
 
-    int flags = cv::CALIB_CB_ADAPTIVE_THRESH
-              | cv::CALIB_CB_NORMALIZE_IMAGE
-              | cv::CALIB_CB_FAST_CHECK;
+/* detectCorners()
+ * The context's grayscale is shared with the other trackers of the frame;
+ * keeping it as m_prevGray makes the context allocate a fresh one for the
+ * next frame instead of overwriting it. */
+bool PoseEstimator::detectCorners(cvcore::FrameContext& context,
+                                   std::vector<cv::Point2f>& corners)
+{
+    m_timings.clear();
 
-    bool found = cv::findChessboardCorners(gray, m_boardSize, corners, flags);
+    cv::Mat gray;
+    {
+        StageTimer t(m_timings, StageTimings::GRAY);
+        gray = context.gray();
+        if (gray.data == context.frame().data)
+            gray = gray.clone();   // kept as m_prevGray — must not alias the caller's buffer
+    }
+
+    if (m_targetType == TargetType::FIDUCIAL)
+    {
+        // Marker decoding is cheap enough to run every frame — no tracking
+        StageTimer t(m_timings, StageTimings::DETECT);
+        m_cornersTracked = false;
+        const bool found = m_fiducial.detect(gray, corners, m_objectPoints);
+        if (!found) m_solver.reset();
+        return found;
+    }
 
-    if (found)
+    bool found;
     {
-        // Refine to sub-pixel accuracy — no drawing, pure detection only
-        cv::cornerSubPix(
-            gray, corners,
-            cv::Size(11, 11),
-            cv::Size(-1, -1),
-            cv::TermCriteria(
-                cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.001)
-        );
+        // Corner tracking counts as FLOW, the full board search as DETECT
+        StageTimer t(m_timings, StageTimings::FLOW);
+        m_cornersTracked = m_trackingMode && !m_prevCorners.empty() &&
+                           m_prevGray.size() == gray.size() &&
+                           trackCorners(gray, corners);
     }
+    {
+        StageTimer t(m_timings, StageTimings::DETECT);
+        found = m_cornersTracked ||
+                CameraCalibration::findBoardCorners(gray, m_boardSize, corners);
+    }
+
+    m_prevGray = gray;
+    if (found && m_trackingMode)
+        m_prevCorners = corners;
+    else
+        m_prevCorners.clear();
+
+    // Board lost — the next pose must not be seeded from a stale one
+    if (!found) m_solver.reset();
 
     return found;
 }
 
+/* trackCorners()
+ * LK: 21x21 window, 3 pyramid levels. cornerSubPix then snaps each
+ * prediction onto the true saddle point in a 5x5 window — small enough not
+ * to jump to a neighbouring corner, and far cheaper than the 11x11 window of
+ * the full search. */
+bool PoseEstimator::trackCorners(const cv::Mat& gray,
+                                 std::vector<cv::Point2f>& corners) const
+{
+    std::vector<uchar> status;
+    std::vector<float> err;
+    cv::calcOpticalFlowPyrLK(m_prevGray, gray, m_prevCorners, corners,
+                             status, err, cv::Size(21, 21), 3);
+
+    const cv::Rect2f bounds(0.0f, 0.0f,
+                            static_cast<float>(gray.cols), static_cast<float>(gray.rows));
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        // Every corner is needed for solvePnP's fixed world point set
+        if (!status[i] || !bounds.contains(corners[i])) return false;
+    }
+
+    cv::cornerSubPix(
+        gray, corners,
+        cv::Size(5, 5),
+        cv::Size(-1, -1),
+        cv::TermCriteria(
+            cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.01)
+    );
+
+    return isGridConsistent(corners);
+}
+
+/* isGridConsistent()
+ * Corners are row-major, m_boardSize.width per row. */
+bool PoseEstimator::isGridConsistent(const std::vector<cv::Point2f>& corners) const
+{
+    const int w = m_boardSize.width;
+    const int h = m_boardSize.height;
+    if (static_cast<int>(corners.size()) != w * h) return false;
+
+    auto check = [&](const cv::Point2f& a, const cv::Point2f& c, const cv::Point2f& b)
+    {
+        const float square = 0.5f * static_cast<float>(cv::norm(b - a));
+        return cv::norm(c - 0.5f * (a + b)) <= GRID_TOLERANCE * square;
+    };
+
+    for (int r = 0; r < h; ++r)
+    {
+        for (int c = 0; c < w; ++c)
+        {
+            const cv::Point2f& p = corners[r * w + c];
+            if (c > 0 && c < w - 1 &&
+                !check(corners[r * w + c - 1], p, corners[r * w + c + 1]))
+                return false;
+            if (r > 0 && r < h - 1 &&
+                !check(corners[(r - 1) * w + c], p, corners[(r + 1) * w + c]))
+                return false;
+        }
+    }
+    return true;
+}
+
 /* buildWorldPoints()
  * Fixed 3D world coordinates for all internal chessboard corners.
  * Convention: (col, -row, 0)
@@ -205,8 +338,12 @@ void PoseEstimator::buildWorldPoints(std::vector<cv::Vec3f>& pointSet) const
  *   distCoeffs    : distortion coefficients from calibration
  *   rvec          : OUTPUT rotation vector (Rodrigues, 3x1)
  *   tvec          : OUTPUT translation vector (3x1, in world units = squares)
- *   useExtrinsicGuess : false — compute from scratch each frame
- *   flags         : SOLVEPNP_ITERATIVE — Levenberg-Marquardt, best for planar
+ *
+ * Solved through m_solver (PoseSolver): closed-form SOLVEPNP_IPPE for the
+ * planar board, disambiguated by the previous pose, then LM refinement.
+ * Every corner is an inlier (the grid was validated, or the markers were
+ * decoded), so no RANSAC. The world points are those of the last
+ * detectCorners(): the full grid, or the fiducial points found.
  *
  * What the outputs mean (Task 4 requirement):
  *   rvec: axis-angle rotation. ||rvec|| = angle in radians.
@@ -218,31 +355,24 @@ void PoseEstimator::buildWorldPoints(std::vector<cv::Vec3f>& pointSet) const
  *         Move camera closer → tvec[2] decreases. */
 bool PoseEstimator::estimatePose(const std::vector<cv::Point2f>& corners)
 {
-    std::vector<cv::Vec3f> worldPoints;
-    buildWorldPoints(worldPoints);
-
-    try
+    const std::vector<cv::Vec3f>& worldPoints =
+        m_targetType == TargetType::FIDUCIAL ? m_objectPoints : m_gridPoints;
+    if (worldPoints.size() != corners.size() || corners.size() < 4)
     {
-        bool ok = cv::solvePnP(
-            worldPoints,      // 3D object points in world space
-            corners,          // 2D image points detected this frame
-            m_cameraMatrix,   // intrinsic matrix (from calibration XML)
-            m_distCoeffs,     // distortion coefficients (from calibration XML)
-            m_rvec,           // OUTPUT: rotation vector  (Rodrigues)
-            m_tvec,           // OUTPUT: translation vector
-            false,            // useExtrinsicGuess: false = solve from scratch
-            cv::SOLVEPNP_ITERATIVE  // method: Levenberg-Marquardt
-        );
-
-        m_poseValid = ok;
-        return ok;
-    }
-    catch (const cv::Exception& e)
-    {
-        std::cerr << "[ERROR] solvePnP failed: " << e.what() << "\n";
         m_poseValid = false;
         return false;
     }
+
+    StageTimer t(m_timings, StageTimings::PNP);
+    m_poseValid = m_solver.solve(
+        worldPoints,      // 3D object points in world space
+        corners,          // 2D image points detected this frame
+        m_cameraMatrix,   // intrinsic matrix (from calibration XML)
+        m_distCoeffs,     // distortion coefficients (from calibration XML)
+        m_rvec,           // OUTPUT: rotation vector  (Rodrigues)
+        m_tvec            // OUTPUT: translation vector
+    );
+    return m_poseValid;
 }
 
 /* printPose()
@@ -444,7 +574,13 @@ void PoseEstimator::overlayStatus(cv::Mat& frame, bool poseFound) const
         : cv::Scalar(0, 0, 255);
 
     // Line 1: pose status
-    std::string status = poseFound ? "Pose estimated" : "No board detected";
+    std::string status = !poseFound       ? "No board detected"
+                       : m_cornersTracked ? "Pose estimated (tracked corners)"
+                       : m_targetType == TargetType::FIDUCIAL
+                           ? "Pose estimated (" + std::to_string(m_fiducial.markersFound())
+                             + " markers, " + std::to_string(m_fiducial.cornersFound())
+                             + " corners)"
+                           : "Pose estimated";
     cv::putText(frame, status, cv::Point(10, 30),
                 cv::FONT_HERSHEY_SIMPLEX, 0.7, color, 2);
 
@@ -488,5 +624,15 @@ void PoseEstimator::overlayStatus(cv::Mat& frame, bool poseFound) const
                     cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,0,0), 3);
         cv::putText(frame, modeStr, cv::Point(10, 95),
                     cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 200, 200), 1);
+
+        // Line 5: pose solver and its average cost
+        std::string solverStr = std::string("Solver: ")
+            + PoseSolver::methodName(m_solver.getMethod())
+            + (m_solver.getRefineLM() ? "+LM " : " ")
+            + fmt(m_solver.averageSolveMs()) + " ms";
+        cv::putText(frame, solverStr, cv::Point(10, 115),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,0,0), 3);
+        cv::putText(frame, solverStr, cv::Point(10, 115),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 200, 200), 1);
     }
 }
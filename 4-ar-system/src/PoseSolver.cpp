@@ -0,0 +1,171 @@
+/*
+ * PoseSolver.cpp - Warm-Started Planar Pose Solver Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements IPPE / warm-started iterative PnP with RANSAC only
+ *              after the target was lost, optional LM refinement on inliers,
+ *              and per-solve timing.
+ *
+ * Date: March 2026
+ */
+
+#include "PoseSolver.h"
+#include <chrono>
+#include <iostream>
+
+/* Constructor */
+PoseSolver::PoseSolver(Method method, bool refineLM)
+    : m_method(method)
+    , m_refineLM(refineLM)
+    , m_warm(false)
+    , m_lastMs(0.0)
+    , m_avgMs(0.0)
+{
+}
+
+/* methodName() */
+const char* PoseSolver::methodName(Method method)
+{
+    return method == IPPE ? "IPPE" : "Iterative";
+}
+
+/* solve() */
+bool PoseSolver::solve(const std::vector<cv::Vec3f>&   objectPoints,
+                       const std::vector<cv::Point2f>& imagePoints,
+                       const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                       cv::Mat& rvec, cv::Mat& tvec,
+                       std::vector<int>* inliers, double reprojErrorPx)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    bool ok = false;
+
+    try
+    {
+        if (objectPoints.size() >= 4 && objectPoints.size() == imagePoints.size())
+        {
+            std::vector<int> idx;
+            bool needRansac = inliers && !m_warm;
+
+            // Tracking: direct solve on all points, outliers by reprojection
+            if (!needRansac)
+            {
+                ok = solveDirect(objectPoints, imagePoints, cameraMatrix, distCoeffs,
+                                 rvec, tvec);
+                if (ok && inliers)
+                {
+                    selectInliers(objectPoints, imagePoints, cameraMatrix, distCoeffs,
+                                  rvec, tvec, reprojErrorPx, idx);
+                    needRansac = idx.size() < MIN_INLIER_FRACTION * objectPoints.size();
+                }
+            }
+
+            // Lost, or tracking broke down: robust search
+            if (needRansac)
+            {
+                idx.clear();
+                ok = cv::solvePnPRansac(objectPoints, imagePoints,
+                                        cameraMatrix, distCoeffs, rvec, tvec,
+                                        false, 100, static_cast<float>(reprojErrorPx),
+                                        0.99, idx,
+                                        m_method == IPPE ? cv::SOLVEPNP_IPPE
+                                                         : cv::SOLVEPNP_ITERATIVE)
+                     && idx.size() >= 4;
+            }
+
+            // LM polish on inliers only
+            if (ok && m_refineLM)
+            {
+                if (inliers)
+                {
+                    std::vector<cv::Vec3f>   obj;
+                    std::vector<cv::Point2f> img;
+                    for (int i : idx)
+                    {
+                        obj.push_back(objectPoints[i]);
+                        img.push_back(imagePoints[i]);
+                    }
+                    cv::solvePnPRefineLM(obj, img, cameraMatrix, distCoeffs, rvec, tvec);
+                }
+                else if (m_method == IPPE)
+                {
+                    // ITERATIVE is already LM — only IPPE benefits here
+                    cv::solvePnPRefineLM(objectPoints, imagePoints,
+                                         cameraMatrix, distCoeffs, rvec, tvec);
+                }
+            }
+
+            if (inliers) *inliers = idx;
+        }
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "[WARN] Pose solve failed: " << e.what() << "\n";
+        ok = false;
+    }
+
+    m_warm = ok;
+    if (ok)
+    {
+        rvec.copyTo(m_prevRvec);
+        tvec.copyTo(m_prevTvec);
+    }
+
+    m_lastMs = std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - t0).count();
+    m_avgMs  = m_avgMs == 0.0 ? m_lastMs : 0.9 * m_avgMs + 0.1 * m_lastMs;
+    return ok;
+}
+
+/* solveDirect()
+ * IPPE returns two planar solutions sorted by reprojection error. Near a
+ * frontal view both fit about equally well, so while tracking the one
+ * whose rotation is closest to the previous frame wins. */
+bool PoseSolver::solveDirect(const std::vector<cv::Vec3f>&   objectPoints,
+                             const std::vector<cv::Point2f>& imagePoints,
+                             const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                             cv::Mat& rvec, cv::Mat& tvec) const
+{
+    if (m_method == ITERATIVE)
+    {
+        if (m_warm)
+        {
+            m_prevRvec.copyTo(rvec);
+            m_prevTvec.copyTo(tvec);
+        }
+        return cv::solvePnP(objectPoints, imagePoints, cameraMatrix, distCoeffs,
+                            rvec, tvec, m_warm, cv::SOLVEPNP_ITERATIVE);
+    }
+
+    std::vector<cv::Mat> rvecs, tvecs;
+    const int n = cv::solvePnPGeneric(objectPoints, imagePoints, cameraMatrix,
+                                      distCoeffs, rvecs, tvecs, false,
+                                      cv::SOLVEPNP_IPPE);
+    if (n == 0) return false;
+
+    int best = 0;
+    if (m_warm && n > 1 &&
+        cv::norm(rvecs[1], m_prevRvec) < cv::norm(rvecs[0], m_prevRvec))
+        best = 1;
+
+    rvecs[best].convertTo(rvec, CV_64F);
+    tvecs[best].convertTo(tvec, CV_64F);
+    return true;
+}
+
+/* selectInliers() */
+void PoseSolver::selectInliers(const std::vector<cv::Vec3f>&   objectPoints,
+                               const std::vector<cv::Point2f>& imagePoints,
+                               const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                               const cv::Mat& rvec, const cv::Mat& tvec,
+                               double maxErrorPx, std::vector<int>& inliers)
+{
+    std::vector<cv::Point2f> projected;
+    cv::projectPoints(objectPoints, rvec, tvec, cameraMatrix, distCoeffs, projected);
+
+    inliers.clear();
+    const double maxSq = maxErrorPx * maxErrorPx;
+    for (int i = 0; i < static_cast<int>(projected.size()); ++i)
+    {
+        const cv::Point2f d = projected[i] - imagePoints[i];
+        if (d.dot(d) <= maxSq) inliers.push_back(i);
+    }
+}
@@ -0,0 +1,338 @@
+/*
+ * ReferenceCompiler.cpp - Offline Multi-View Reference Compiler Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements the scale pyramid + synthetic affine viewpoints,
+ *              keypoint back-projection and deduplication, and the binary
+ *              .arref reader/writer.
+ *
+ * Date: March 2026
+ */
+
+#include "ReferenceCompiler.h"
+#include "SIFTTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    const char   MAGIC[8]   = { 'A', 'R', 'R', 'E', 'F', '1', '\0', '\0' };
+    const double SCALES[]   = { 1.0, 0.6, 0.35 };
+    const double ANGLES[]   = { 0.0, 60.0, 120.0 };
+    const int    MIN_VIEW_PX = 64;    // skip pyramid levels smaller than this
+    const int    CELL_PX     = 8;     // dedupe grid cell, reference pixels
+
+    /* to3x3() - 2x3 affine → 3x3 homogeneous */
+    cv::Mat to3x3(const cv::Mat& affine)
+    {
+        cv::Mat m = cv::Mat::eye(3, 3, CV_64F);
+        affine.copyTo(m.rowRange(0, 2));
+        return m;
+    }
+
+    template <typename T>
+    void writePod(std::ofstream& out, const T& v)
+    {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    bool readPod(std::ifstream& in, T& v)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+    }
+}
+
+/* makeView()
+ * ASIFT-style tilt: rotate by angleDeg on an enlarged canvas, blur along x
+ * by 0.8*sqrt(t^2-1) against aliasing, then compress x by 1/t. The mask
+ * excludes the canvas padding and its artificial border edge. */
+ReferenceCompiler::View ReferenceCompiler::makeView(const cv::Mat& base, double scale,
+                                                    double tilt, double angleDeg)
+{
+    View v;
+    v.scale  = scale;
+    v.radius = DEDUPE_RADIUS_PX * tilt / scale;
+    cv::Mat S = (cv::Mat_<double>(2, 3) << scale, 0, 0, 0, scale, 0);
+
+    if (tilt <= 1.0)
+    {
+        v.image = base;
+        v.warp  = S;
+        return v;
+    }
+
+    const cv::Point2f center(base.cols * 0.5f, base.rows * 0.5f);
+    cv::Mat R = cv::getRotationMatrix2D(center, angleDeg, 1.0);
+
+    std::vector<cv::Point2f> corners = {
+        { 0.0f, 0.0f }, { static_cast<float>(base.cols), 0.0f },
+        { static_cast<float>(base.cols), static_cast<float>(base.rows) },
+        { 0.0f, static_cast<float>(base.rows) }
+    };
+    std::vector<cv::Point2f> rotated;
+    cv::transform(corners, rotated, R);
+    const cv::Rect bbox = cv::boundingRect(rotated);
+    R.at<double>(0, 2) -= bbox.x;
+    R.at<double>(1, 2) -= bbox.y;
+
+    cv::Mat canvas, canvasMask;
+    cv::warpAffine(base, canvas, R, bbox.size(), cv::INTER_LINEAR,
+                   cv::BORDER_CONSTANT, cv::Scalar(0));
+    cv::warpAffine(cv::Mat(base.size(), CV_8U, cv::Scalar(255)), canvasMask, R,
+                   bbox.size(), cv::INTER_NEAREST, cv::BORDER_CONSTANT, cv::Scalar(0));
+
+    cv::GaussianBlur(canvas, canvas, cv::Size(0, 0),
+                     0.8 * std::sqrt(tilt * tilt - 1.0), 0.01);
+
+    const cv::Size viewSize(cvRound(bbox.width / tilt), bbox.height);
+    cv::resize(canvas,     v.image, viewSize, 0, 0, cv::INTER_LINEAR);
+    cv::resize(canvasMask, v.mask,  viewSize, 0, 0, cv::INTER_NEAREST);
+    cv::erode(v.mask, v.mask, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(9, 9)));
+
+    cv::Mat T = (cv::Mat_<double>(3, 3) << 1.0 / tilt, 0, 0, 0, 1, 0, 0, 0, 1);
+    v.warp = (T * to3x3(R) * to3x3(S)).rowRange(0, 2).clone();
+    return v;
+}
+
+/* compile()
+ * Views are visited frontal-first and coarse-last, so the dedupe keeps the
+ * original scale-1 keypoint and only ADDS what the pyramid and tilted views
+ * see that the frontal detection does not. */
+bool ReferenceCompiler::compile(const cv::Mat& refGray, FeatureBackend& features,
+                                CompiledReference& out)
+{
+    out.backend  = features.type();
+    out.refSize  = refGray.size();
+    out.keypoints.clear();
+    out.descriptors.release();
+
+    cv::Mat enhanced;
+    cv::createCLAHE(SIFTTracker::CLAHE_CLIP,
+                    cv::Size(SIFTTracker::CLAHE_TILES, SIFTTracker::CLAHE_TILES))
+        ->apply(refGray, enhanced);
+
+    std::vector<View> views;
+    for (double s : SCALES)
+    {
+        cv::Mat base = enhanced;
+        if (s != 1.0)
+            cv::resize(enhanced, base, cv::Size(), s, s, cv::INTER_AREA);
+        if (std::min(base.cols, base.rows) < MIN_VIEW_PX) break;
+
+        views.push_back(makeView(base, s, 1.0, 0.0));
+        for (double a : ANGLES)
+            views.push_back(makeView(base, s, TILT, a));
+    }
+
+    // Coarse grid over the reference for the neighbour search
+    const int gridW = out.refSize.width  / CELL_PX + 1;
+    const int gridH = out.refSize.height / CELL_PX + 1;
+    std::vector<std::vector<int>> grid(static_cast<size_t>(gridW) * gridH);
+
+    const bool binary = features.isBinary();
+    const int  norm   = features.normType();
+    int detected = 0;
+
+    for (size_t vi = 0; vi < views.size(); ++vi)
+    {
+        const View& v = views[vi];
+        std::vector<cv::KeyPoint> kps;
+        cv::Mat desc;
+        features.detectAndCompute(v.image, v.mask, kps, desc);
+        detected += static_cast<int>(kps.size());
+        if (desc.empty()) continue;
+
+        cv::Mat inv;
+        cv::invertAffineTransform(v.warp, inv);
+        const double r2 = v.radius * v.radius;
+
+        for (int k = 0; k < static_cast<int>(kps.size()); ++k)
+        {
+            cv::KeyPoint kp = kps[k];
+            const double x = inv.at<double>(0, 0) * kp.pt.x + inv.at<double>(0, 1) * kp.pt.y
+                           + inv.at<double>(0, 2);
+            const double y = inv.at<double>(1, 0) * kp.pt.x + inv.at<double>(1, 1) * kp.pt.y
+                           + inv.at<double>(1, 2);
+            if (x < 0 || y < 0 || x >= out.refSize.width || y >= out.refSize.height)
+                continue;
+
+            const cv::Mat d = desc.row(k);
+            bool duplicate = false;
+            const int cx0 = std::max(0, static_cast<int>((x - v.radius) / CELL_PX));
+            const int cx1 = std::min(gridW - 1, static_cast<int>((x + v.radius) / CELL_PX));
+            const int cy0 = std::max(0, static_cast<int>((y - v.radius) / CELL_PX));
+            const int cy1 = std::min(gridH - 1, static_cast<int>((y + v.radius) / CELL_PX));
+            for (int cy = cy0; cy <= cy1 && !duplicate; ++cy)
+            {
+                for (int cx = cx0; cx <= cx1 && !duplicate; ++cx)
+                {
+                    for (int j : grid[static_cast<size_t>(cy) * gridW + cx])
+                    {
+                        const cv::Point2f dp = out.keypoints[j].pt
+                                             - cv::Point2f(static_cast<float>(x),
+                                                           static_cast<float>(y));
+                        if (dp.dot(dp) > r2) continue;
+
+                        const cv::Mat kept = out.descriptors.row(j);
+                        // Nearly the same: 10% of the bits, or 25% of the L2 norm
+                        const double limit = binary ? 0.10 * kept.cols * 8
+                                                    : 0.25 * cv::norm(kept, cv::NORM_L2);
+                        if (cv::norm(d, kept, norm) <= limit)
+                        {
+                            duplicate = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (duplicate) continue;
+
+            kp.pt       = cv::Point2f(static_cast<float>(x), static_cast<float>(y));
+            kp.size    /= static_cast<float>(v.scale);
+            kp.class_id = static_cast<int>(vi);
+            grid[static_cast<size_t>(y / CELL_PX) * gridW + static_cast<int>(x / CELL_PX)]
+                .push_back(static_cast<int>(out.keypoints.size()));
+            out.keypoints.push_back(kp);
+            out.descriptors.push_back(d);
+        }
+    }
+
+    std::cout << "[INFO] Compiled reference: " << views.size() << " views, "
+              << detected << " keypoints detected, " << out.keypoints.size()
+              << " kept after dedupe (" << FeatureBackend::typeName(out.backend) << ")\n";
+    return !out.keypoints.empty();
+}
+
+/* save() */
+bool ReferenceCompiler::save(const std::string& path, const CompiledReference& ref)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "[ERROR] Cannot write compiled reference: " << path << "\n";
+        return false;
+    }
+
+    cv::Mat desc = ref.descriptors.isContinuous() ? ref.descriptors
+                                                  : ref.descriptors.clone();
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writePod(out, static_cast<int32_t>(ref.backend));
+    writePod(out, static_cast<int32_t>(ref.refSize.width));
+    writePod(out, static_cast<int32_t>(ref.refSize.height));
+
+    writePod(out, static_cast<int32_t>(ref.keypoints.size()));
+    for (const auto& kp : ref.keypoints)
+    {
+        writePod(out, kp.pt.x);
+        writePod(out, kp.pt.y);
+        writePod(out, kp.size);
+        writePod(out, kp.angle);
+        writePod(out, kp.response);
+        writePod(out, static_cast<int32_t>(kp.octave));
+    }
+
+    writePod(out, static_cast<int32_t>(desc.rows));
+    writePod(out, static_cast<int32_t>(desc.cols));
+    writePod(out, static_cast<int32_t>(desc.type()));
+    out.write(reinterpret_cast<const char*>(desc.data),
+              static_cast<std::streamsize>(desc.total() * desc.elemSize()));
+
+    if (!out)
+    {
+        std::cerr << "[ERROR] Write failed: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/* load() */
+bool ReferenceCompiler::load(const std::string& path, CompiledReference& ref)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[sizeof(MAGIC)];
+    int32_t backend = 0, w = 0, h = 0, count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !readPod(in, backend) || !readPod(in, w) || !readPod(in, h) || !readPod(in, count) ||
+        backend < 0 || backend >= FeatureBackend::TYPE_COUNT || count <= 0)
+    {
+        std::cerr << "[WARN] Not a compiled reference: " << path << "\n";
+        return false;
+    }
+
+    ref.backend = static_cast<FeatureBackend::Type>(backend);
+    ref.refSize = cv::Size(w, h);
+    ref.keypoints.resize(count);
+    for (auto& kp : ref.keypoints)
+    {
+        int32_t octave = 0;
+        if (!readPod(in, kp.pt.x) || !readPod(in, kp.pt.y) || !readPod(in, kp.size) ||
+            !readPod(in, kp.angle) || !readPod(in, kp.response) || !readPod(in, octave))
+        {
+            std::cerr << "[WARN] Truncated compiled reference: " << path << "\n";
+            return false;
+        }
+        kp.octave = octave;
+    }
+
+    int32_t rows = 0, cols = 0, type = 0;
+    if (!readPod(in, rows) || !readPod(in, cols) || !readPod(in, type) ||
+        rows != count || cols <= 0 || (type != CV_8U && type != CV_32F))
+    {
+        std::cerr << "[WARN] Bad descriptor block in: " << path << "\n";
+        return false;
+    }
+
+    ref.descriptors.create(rows, cols, type);
+    if (!in.read(reinterpret_cast<char*>(ref.descriptors.data),
+                 static_cast<std::streamsize>(ref.descriptors.total() *
+                                              ref.descriptors.elemSize())))
+    {
+        std::cerr << "[WARN] Truncated compiled reference: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/* compiledPath() */
+std::string ReferenceCompiler::compiledPath(const std::string& imagePath)
+{
+    const size_t slash = imagePath.find_last_of("/\\");
+    const size_t dot   = imagePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return imagePath + ".arref";
+    return imagePath.substr(0, dot) + ".arref";
+}
+
+/* loadFor() */
+bool ReferenceCompiler::loadFor(const std::string& imagePath, FeatureBackend::Type backend,
+                                const cv::Size& refSize, CompiledReference& ref)
+{
+    const std::string path = compiledPath(imagePath);
+    if (!std::ifstream(path).good()) return false;
+    if (!load(path, ref)) return false;
+
+    if (ref.backend != backend)
+    {
+        std::cerr << "[WARN] " << path << " was compiled for "
+                  << FeatureBackend::typeName(ref.backend) << ", not "
+                  << FeatureBackend::typeName(backend) << " — ignoring it.\n";
+        return false;
+    }
+    if (ref.refSize != refSize)
+    {
+        std::cerr << "[WARN] " << path << " does not match the reference image size"
+                  << " — recompile it. Ignoring.\n";
+        return false;
+    }
+
+    std::cout << "[INFO] Compiled reference loaded: " << path << " ("
+              << ref.keypoints.size() << " keypoints)\n";
+    return true;
+}
@@ -11,22 +11,69 @@
  */
 
 #include "SIFTTracker.h"
+#include "ReferenceCompiler.h"
+#include "AssetCache.h"
+#include <opencv2/core/ocl.hpp>
+#include <opencv2/flann.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <numeric>
+
+namespace
+{
+    /* sortByScore() - reorders matches by ascending score (best ratio first) */
+    void sortByScore(std::vector<cv::DMatch>& matches, const std::vector<float>& scores)
+    {
+        std::vector<int> order(matches.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](int a, int b) { return scores[a] < scores[b]; });
+
+        std::vector<cv::DMatch> sorted;
+        sorted.reserve(matches.size());
+        for (int i : order)
+            sorted.push_back(matches[i]);
+        matches.swap(sorted);
+    }
+}
 
 /* Constructor */
 SIFTTracker::SIFTTracker(const std::string& calibrationFile,
                           const std::string& referenceImage,
-                          int nfeatures)
+                          int nfeatures,
+                          FeatureBackend::Type backend,
+                          const std::string& modelPath)
     : m_calibrationFile(calibrationFile)
     , m_referenceImagePath(referenceImage)
     , m_nfeatures(nfeatures)
+    , m_backendType(backend)
+    , m_modelPath(modelPath)
+    , m_matcherType(BRUTE_FORCE)
+    , m_useOpenCL(false)
+    , m_deviceMatching(false)
+    , m_crossCheck(true)
+    , m_robustMethod(RANSAC_H)
+    , m_robustBudgetMs(5.0)
+    , m_robustIters(ROBUST_MAX_ITERS)
     , m_tracking(false)
     , m_inlierCount(0)
     , m_hasSmooth(false)
     , m_smoothAlpha(0.35f)   // 0.35 = responsive but smooth
                               // lower = smoother but more lag
                               // higher = less lag but shakier
+    , m_useFlow(true)
+    , m_flowFrame(false)
+    , m_framesSinceDetect(0)
+    , m_useRoi(true)
+    , m_useGuided(true)
+    , m_detectScale(1.0)
+    , m_useReloc(true)
+    , m_relocFrame(false)
+    , m_detectionsSinceKeyframe(0)
 {
     m_rvec       = cv::Mat::zeros(3, 1, CV_64F);
     m_tvec       = cv::Mat::zeros(3, 1, CV_64F);
@@ -67,8 +114,11 @@ bool SIFTTracker::loadCalibration()
 }
 
 /* loadReference()
- * Loads reference bill image and computes SIFT keypoints + descriptors.
- * These are computed once and reused every frame. */
+ * Loads reference bill image and its keypoints + descriptors: the compiled
+ * multi-view set next to the image when one exists for this backend (see
+ * compileReference), else the AssetCache entry of an earlier start, else a
+ * single-scale detection with the selected backend (then cached). Either
+ * way they are computed once and reused every frame. */
 bool SIFTTracker::loadReference()
 {
     m_refImage = cv::imread(m_referenceImagePath, cv::IMREAD_COLOR);
@@ -79,51 +129,422 @@ bool SIFTTracker::loadReference()
         return false;
     }
 
-    // More features + lower contrast = more candidates to match from
-    // 300 features with threshold 0.04 gives good coverage of bill details
-    m_sift  = cv::SIFT::create(m_nfeatures, 3, 0.04, 10, 1.6);
-    m_clahe = cv::createCLAHE(2.0, cv::Size(8, 8));
+    m_features = FeatureBackend::create(m_backendType, m_nfeatures, m_modelPath);
+    if (!m_features) return false;
+    m_backendType = m_features->type();     // CUDA-ORB may have fallen back to ORB
+    m_clahe = cv::createCLAHE(CLAHE_CLIP, cv::Size(CLAHE_TILES, CLAHE_TILES));
 
-    cv::Mat refGray, refEnhanced;
-    cv::cvtColor(m_refImage, refGray, cv::COLOR_BGR2GRAY);
-    m_clahe->apply(refGray, refEnhanced);
+    const AssetCache cache(m_cacheDir);
+    const uint64_t   cacheKey = m_cacheDir.empty() ? 0 :
+        referenceCacheKey(m_referenceImagePath, m_backendType, m_nfeatures, m_modelPath);
 
-    m_sift->detectAndCompute(
-        refEnhanced,
-        cv::noArray(),
-        m_refKeypoints,
-        m_refDescriptors
-    );
+    CompiledReference    compiled;
+    std::vector<cv::Mat> cached;
+    if (ReferenceCompiler::loadFor(m_referenceImagePath, m_backendType,
+                                   m_refImage.size(), compiled))
+    {
+        m_refKeypoints   = std::move(compiled.keypoints);
+        m_refDescriptors = compiled.descriptors;
+    }
+    else if (cache.load("ref", cacheKey, cached) && cached.size() == 2)
+    {
+        AssetCache::unpackKeypoints(cached[0], m_refKeypoints);
+        m_refDescriptors = cached[1];
+        std::cout << "[INFO] Reference features read from cache.\n";
+    }
+    else
+    {
+        cv::Mat refGray, refEnhanced;
+        cv::cvtColor(m_refImage, refGray, cv::COLOR_BGR2GRAY);
+        m_clahe->apply(refGray, refEnhanced);
+
+        m_features->detectAndCompute(
+            refEnhanced,
+            cv::Mat(),
+            m_refKeypoints,
+            m_refDescriptors
+        );
+        if (!m_refDescriptors.empty())
+            cache.store("ref", cacheKey,
+                        { AssetCache::packKeypoints(m_refKeypoints), m_refDescriptors });
+    }
 
     std::cout << "[INFO] Reference image loaded: " << m_referenceImagePath << "\n";
-    std::cout << "[INFO] Reference keypoints: "    << m_refKeypoints.size() << "\n";
+    std::cout << "[INFO] Reference keypoints: "    << m_refKeypoints.size()
+              << " (" << FeatureBackend::typeName(m_backendType) << ")\n";
     std::cout << "[INFO] Reference size: "
               << m_refImage.cols << " x " << m_refImage.rows << " px\n";
 
+    buildMatcher();
+    m_keyframes.buildVocabulary(m_refDescriptors, m_features->normType());
+    applyLatencyLevel();        // the reference itself always uses nfeatures
     return true;
 }
 
+/* referenceCacheKey() */
+uint64_t SIFTTracker::referenceCacheKey(const std::string& imagePath,
+                                        FeatureBackend::Type backend,
+                                        int nfeatures, const std::string& modelPath)
+{
+    const uint64_t fileHash = AssetCache::hashFile(imagePath);
+    if (!fileHash) return 0;
+    return AssetCache::hashString(
+        std::string(FeatureBackend::typeName(backend))
+        + ";n=" + std::to_string(nfeatures) + ";model=" + modelPath
+        + ";clahe=" + std::to_string(CLAHE_CLIP) + "/" + std::to_string(CLAHE_TILES),
+        fileHash);
+}
+
+/* matcherName() */
+const char* SIFTTracker::matcherName(MatcherType type)
+{
+    switch (type)
+    {
+        case FLANN:     return "FLANN";
+        case GPU_BRUTE: return "OpenCL brute force";
+        default:        return "Brute force";
+    }
+}
+
+/* setMatcher() */
+void SIFTTracker::setMatcher(MatcherType type)
+{
+    m_matcherType = type;
+    if (!m_refDescriptors.empty()) buildMatcher();
+}
+
+/* cycleMatcher() */
+void SIFTTracker::cycleMatcher()
+{
+    setMatcher(static_cast<MatcherType>((m_matcherType + 1) % MATCHER_COUNT));
+}
+
+/* robustMethodName() */
+const char* SIFTTracker::robustMethodName(RobustMethod method)
+{
+    switch (method)
+    {
+        case PROSAC:     return "PROSAC";
+        case MAGSAC:     return "MAGSAC++";
+        case PNP_RANSAC: return "PnP RANSAC";
+        default:         return "RANSAC";
+    }
+}
+
+/* cycleRobustMethod() */
+void SIFTTracker::cycleRobustMethod()
+{
+    m_robustMethod = static_cast<RobustMethod>((m_robustMethod + 1) % ROBUST_COUNT);
+    m_robustIters  = m_latency.settings().maxRobustIters;
+    std::cout << "[INFO] Outlier rejection: " << robustMethodName(m_robustMethod) << "\n";
+}
+
+/* buildMatcher()
+ * Trains the chosen matcher on the reference descriptors once, so track()
+ * no longer constructs a matcher or re-uploads the reference every frame.
+ * Brute force uses the backend's norm (L2 or Hamming).
+ *   FLANN     : float descriptors — 4 randomized KD-trees, 32 leaf checks
+ *               per query, plenty for a few hundred 128-d SIFT descriptors;
+ *               binary descriptors — LSH (6 tables, 12-bit keys)
+ *   GPU_BRUTE : with the CUDA-ORB backend the reference is uploaded to the
+ *               backend's own CUDA matcher, so live descriptors are matched
+ *               where they were computed and only the k-NN lists come back.
+ *               Otherwise the reference is kept as a UMat so it stays on the
+ *               OpenCL device; BFMatcher takes its OpenCL path when the
+ *               query is a UMat */
+void SIFTTracker::buildMatcher()
+{
+    m_useOpenCL      = false;
+    m_deviceMatching = false;
+    m_features->setMatchReference(cv::Mat());
+
+    switch (m_matcherType)
+    {
+        case FLANN:
+            if (m_features->isBinary())
+                m_matcher = cv::makePtr<cv::FlannBasedMatcher>(
+                    cv::makePtr<cv::flann::LshIndexParams>(6, 12, 1),
+                    cv::makePtr<cv::flann::SearchParams>(32));
+            else
+                m_matcher = cv::makePtr<cv::FlannBasedMatcher>(
+                    cv::makePtr<cv::flann::KDTreeIndexParams>(4),
+                    cv::makePtr<cv::flann::SearchParams>(32));
+            m_matcher->add(std::vector<cv::Mat>{ m_refDescriptors });
+            break;
+
+        case GPU_BRUTE:
+            if (m_features->setMatchReference(m_refDescriptors))
+            {
+                m_deviceMatching = true;
+                std::cout << "[INFO] Matcher: " << matcherLabel() << "\n";
+                return;
+            }
+            if (cv::ocl::haveOpenCL())
+            {
+                cv::ocl::setUseOpenCL(true);
+                m_matcher = cv::BFMatcher::create(m_features->normType());
+                m_matcher->add(std::vector<cv::UMat>{
+                    m_refDescriptors.getUMat(cv::ACCESS_READ).clone() });
+                m_useOpenCL = true;
+                break;
+            }
+            std::cerr << "[WARN] No OpenCL device — using CPU brute force.\n";
+            [[fallthrough]];
+
+        default:
+            m_matcher = cv::BFMatcher::create(m_features->normType());
+            m_matcher->add(std::vector<cv::Mat>{ m_refDescriptors });
+            break;
+    }
+
+    m_matcher->train();
+    std::cout << "[INFO] Matcher: " << matcherLabel() << "\n";
+}
+
+/* matcherLabel()
+ * Matcher name with its index kind and fallback state, for logs and overlay. */
+std::string SIFTTracker::matcherLabel() const
+{
+    if (m_deviceMatching) return "CUDA brute force";
+
+    std::string label = matcherName(m_matcherType);
+    if (m_matcherType == FLANN)
+        label += m_features && m_features->isBinary() ? " LSH" : " KD-forest";
+    if (m_matcherType == GPU_BRUTE && !m_useOpenCL)
+        label += " (CPU fallback)";
+    return label;
+}
+
+/* setIntrinsics()
+ * Tracked points, outlines and the warm pose are in the old pixel geometry —
+ * drop them so the next frame runs a full detection. */
+void SIFTTracker::setIntrinsics(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs)
+{
+    m_cameraMatrix = cameraMatrix.clone();
+    m_distCoeffs   = distCoeffs.clone();
+    m_prevGray.release();
+    m_flowLivePts.clear();
+    m_flowObjPts.clear();
+    m_outline.clear();
+    m_prevOutline.clear();
+    m_solver.reset();
+}
+
+/* setOpticalFlow() */
+void SIFTTracker::setOpticalFlow(bool enabled)
+{
+    m_useFlow = enabled;
+    m_flowLivePts.clear();
+    m_flowObjPts.clear();
+}
+
+/* setRelocalisation() */
+void SIFTTracker::setRelocalisation(bool enabled)
+{
+    m_useReloc = enabled;
+    m_detectionsSinceKeyframe = 0;
+    if (!enabled) m_keyframes.clear();
+}
+
+/* setDetectScale() */
+void SIFTTracker::setDetectScale(double scale)
+{
+    m_detectScale = std::clamp(scale, 0.25, 1.0);
+}
+
+/* setLatencyBudget() */
+void SIFTTracker::setLatencyBudget(double ms)
+{
+    m_latency.setBudget(ms);
+    applyLatencyLevel();
+    if (ms > 0.0)
+        std::cout << "[INFO] Latency budget: " << ms << " ms per detection frame\n";
+    else
+        std::cout << "[INFO] Latency budget off\n";
+}
+
+/* applyLatencyLevel()
+ * Pushes the level's feature count into the backend and caps the robust
+ * iterations; scale and ROI margin are read per frame. */
+void SIFTTracker::applyLatencyLevel()
+{
+    const LatencyController::Settings& s = m_latency.settings();
+    if (m_features)
+    {
+        const int base = m_nfeatures > 0 ? m_nfeatures : LATENCY_BASE_FEATURES;
+        m_features->setNFeatures(m_latency.level() == 0 ? m_nfeatures
+                                 : std::max(1, static_cast<int>(base * s.featureFraction)));
+    }
+    m_robustIters = std::min(m_robustIters, s.maxRobustIters);
+}
+
+/* effectiveDetectScale() */
+double SIFTTracker::effectiveDetectScale() const
+{
+    return std::max(0.25, m_detectScale * m_latency.settings().scaleFraction);
+}
+
 /* track()
- * Main per-frame tracking function. */
+ * Main per-frame tracking function.
+ * Follows the last inliers by optical flow when possible; falls back to a
+ * full SIFT detection when flow loses the bill or REDETECT_INTERVAL expires. */
 bool SIFTTracker::track(const cv::Mat& frame)
+{
+    cvcore::FrameContext context(frame);
+    return track(context);
+}
+
+bool SIFTTracker::track(cvcore::FrameContext& context)
 {
     m_tracking    = false;
     m_inlierCount = 0;
+    m_flowFrame   = false;
+    m_relocFrame  = false;
+    m_timings.clear();
+
+    cv::Mat gray;
+    {
+        StageTimer t(m_timings, StageTimings::GRAY);
+        gray = context.gray();
+        if (gray.data == context.frame().data)
+            gray = gray.clone();   // kept as m_prevGray
+    }
+
+    // Step 1: cheap path — optical flow on the points of the last pose
+    if (m_useFlow && !m_flowLivePts.empty() && !m_prevGray.empty() &&
+        m_framesSinceDetect < REDETECT_INTERVAL)
+    {
+        m_flowFrame = trackFlow(gray);
+        if (m_flowFrame) ++m_framesSinceDetect;
+    }
+    m_prevGray = gray;
+
+    if (m_flowFrame)
+    {
+        m_tracking = true;
+        smoothPose();
+        updateOutline();
+        return true;
+    }
+
+    // Full detection — first inside the predicted window, then on the
+    // whole frame if the window misses the bill
+    m_flowLivePts.clear();
+    m_flowObjPts.clear();
+
+    std::vector<cv::Point> window;
+    cv::Rect roi = predictWindow(gray.size(), window);
+    m_lastRoi    = roi;
+
+    const bool guided = m_useGuided && m_outline.size() == 4;
+    m_tracking = detectAndEstimate(gray, roi, window, guided);
+    if (!m_tracking && (roi.area() > 0 || guided))
+    {
+        m_lastRoi  = cv::Rect();
+        m_tracking = detectAndEstimate(gray, cv::Rect(), {}, false);
+    }
 
-    // Convert to grayscale and apply CLAHE — reuse m_clahe created in initialize()
-    cv::Mat gray, enhanced;
-    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-    m_clahe->apply(gray, enhanced);
+    if (m_tracking)
+    {
+        m_framesSinceDetect = 0;
+        smoothPose();
+        updateOutline();
+    }
+    else
+    {
+        m_outline.clear();
+        m_prevOutline.clear();
+        m_solver.reset();
+    }
+
+    // Only detection frames feed the controller — flow frames use no knob
+    double frameMs = 0.0;
+    for (double ms : m_timings.ms) frameMs += ms;
+    if (m_latency.update(frameMs, m_tracking, m_inlierCount < 2 * MIN_INLIERS))
+        applyLatencyLevel();
+
+    return m_tracking;
+}
+
+/* detectAndEstimate()
+ * CLAHE + SIFT on the ROI crop (whole frame when roi is empty), optionally
+ * downscaled by effectiveDetectScale(). Keypoints are mapped back to full-frame
+ * pixels before matching, so estimatePose() and the debug overlay are
+ * unaffected. window (full-frame coordinates) becomes the detection mask.
+ * guided: the homography from the reference corners to the predicted
+ * outline drives matchGuided(); fewer than MIN_INLIERS guided matches (or
+ * descriptors kept on the device) fall back to the global matcher. */
+bool SIFTTracker::detectAndEstimate(const cv::Mat& gray, const cv::Rect& roi,
+                                    const std::vector<cv::Point>& window, bool guided)
+{
+    const cv::Rect area = roi.area() > 0 ? roi : cv::Rect(0, 0, gray.cols, gray.rows);
+    const double   scale = effectiveDetectScale();
+
+    // Apply CLAHE, reusing m_clahe created in initialize()
+    cv::Mat crop, enhanced;
+    {
+        StageTimer t(m_timings, StageTimings::CLAHE);
+        if (scale < 1.0)
+            cv::resize(gray(area), crop, cv::Size(), scale, scale, cv::INTER_AREA);
+        else
+            crop = gray(area);
+        m_clahe->apply(crop, enhanced);
+    }
+
+    cv::Mat mask;
+    if (!window.empty())
+    {
+        std::vector<cv::Point> local;
+        for (const auto& p : window)
+            local.emplace_back(cv::saturate_cast<int>((p.x - area.x) * scale),
+                               cv::saturate_cast<int>((p.y - area.y) * scale));
+        mask = cv::Mat::zeros(enhanced.size(), CV_8U);
+        cv::fillConvexPoly(mask, local, cv::Scalar(255));
+    }
 
     std::vector<cv::KeyPoint> liveKeypoints;
     cv::Mat                   liveDescriptors;
-    m_sift->detectAndCompute(enhanced, cv::noArray(),
-                              liveKeypoints, liveDescriptors);
+    {
+        StageTimer t(m_timings, StageTimings::DETECT);
+        m_features->detectAndCompute(enhanced, mask, liveKeypoints, liveDescriptors);
+    }
+
+    // With device matching the descriptors stay on the GPU and come back empty
+    if ((liveDescriptors.empty() && !m_deviceMatching) || liveKeypoints.empty())
+        return false;
+
+    // Back to full-frame pixels
+    for (auto& kp : liveKeypoints)
+    {
+        kp.pt   = cv::Point2f(static_cast<float>(kp.pt.x / scale + area.x),
+                              static_cast<float>(kp.pt.y / scale + area.y));
+        kp.size = static_cast<float>(kp.size / scale);
+    }
 
-    if (liveDescriptors.empty() || liveKeypoints.empty()) return false;
+    // Lost: the stored views first, the whole reference only if they fail
+    if (m_useReloc && m_outline.empty() && !liveDescriptors.empty() &&
+        relocalise(liveKeypoints, liveDescriptors))
+    {
+        m_relocFrame = true;
+        return true;
+    }
 
     // Step 2: match descriptors
-    std::vector<cv::DMatch> goodMatches = matchFeatures(liveDescriptors);
+    std::vector<cv::DMatch> goodMatches;
+    {
+        StageTimer t(m_timings, StageTimings::MATCH);
+        const std::vector<cv::Point2f> predicted = predictOutline();
+        if (guided && !liveDescriptors.empty() && predicted.size() == 4)
+        {
+            const float w = static_cast<float>(m_refImage.cols);
+            const float h = static_cast<float>(m_refImage.rows);
+            const std::vector<cv::Point2f> refCorners = { { 0, 0 }, { w, 0 }, { w, h }, { 0, h } };
+            goodMatches = matchGuided(liveKeypoints, liveDescriptors,
+                                      cv::getPerspectiveTransform(refCorners, predicted));
+        }
+        if (static_cast<int>(goodMatches.size()) < MIN_INLIERS)
+            goodMatches = matchFeatures(liveDescriptors);
+    }
     if (static_cast<int>(goodMatches.size()) < MIN_INLIERS) return false;
 
     // Save for debug drawing
@@ -131,57 +552,454 @@ bool SIFTTracker::track(const cv::Mat& frame)
     m_lastGoodMatches   = goodMatches;
 
     // Step 3: estimate pose
-    m_tracking = estimatePose(liveKeypoints, goodMatches);
+    if (!estimatePose(liveKeypoints, goodMatches)) return false;
 
-    /* Step 4: apply exponential moving average smoothing to reduce shakiness
-     * Blends current raw pose with previous smoothed pose:
-     *   smoothed = alpha * raw + (1 - alpha) * previous_smoothed
-     * This reduces frame-to-frame jitter without introducing much lag. */
-    if (m_tracking)
+    if (m_useReloc && !liveDescriptors.empty())
+        addKeyframe(liveKeypoints, liveDescriptors, goodMatches);
+    return true;
+}
+
+/* relocalise()
+ * The query costs one match against the vocabulary words; each candidate
+ * then costs a match against its inlier set (tens to a few hundred rows)
+ * instead of every reference descriptor. A keyframe that gives the pose is
+ * touched so it stays in the store. */
+bool SIFTTracker::relocalise(const std::vector<cv::KeyPoint>& liveKeypoints,
+                             const cv::Mat& liveDescriptors)
+{
+    if (m_keyframes.empty()) return false;
+
+    std::vector<int> candidates;
     {
-        if (!m_hasSmooth)
+        StageTimer t(m_timings, StageTimings::MATCH);
+        candidates = m_keyframes.query(m_keyframes.transform(liveDescriptors),
+                                       RELOC_CANDIDATES);
+    }
+
+    for (int k : candidates)
+    {
+        std::vector<cv::DMatch> matches;
         {
-            // First successful frame — initialize smoother with raw pose
-            m_rvec.copyTo(m_rvecSmooth);
-            m_tvec.copyTo(m_tvecSmooth);
-            m_hasSmooth = true;
+            StageTimer t(m_timings, StageTimings::MATCH);
+            matches = matchKeyframe(m_keyframes.keyframe(k), liveDescriptors);
         }
-        else
+        if (static_cast<int>(matches.size()) < MIN_INLIERS) continue;
+
+        m_lastLiveKeypoints = liveKeypoints;
+        m_lastGoodMatches   = matches;
+        if (estimatePose(liveKeypoints, matches))
         {
-            // Blend raw pose toward smoothed pose
-            m_rvecSmooth = m_smoothAlpha * m_rvec
-                         + (1.0 - m_smoothAlpha) * m_rvecSmooth;
-            m_tvecSmooth = m_smoothAlpha * m_tvec
-                         + (1.0 - m_smoothAlpha) * m_tvecSmooth;
+            m_keyframes.touch(k);
+            return true;
         }
     }
+    return false;
+}
 
-    return m_tracking;
+/* matchKeyframe()
+ * Keyframes are small, so a throwaway brute-force matcher is cheaper than
+ * keeping a trained index per keyframe. */
+std::vector<cv::DMatch> SIFTTracker::matchKeyframe(const Keyframe& keyframe,
+                                                   const cv::Mat& liveDescriptors) const
+{
+    std::vector<std::vector<cv::DMatch>> knnMatches;
+    cv::BFMatcher(m_features->normType()).knnMatch(liveDescriptors, keyframe.descriptors,
+                                                   knnMatches, 2);
+
+    const float ratio = m_features->isBinary() ? BINARY_RATIO_THRESHOLD
+                                               : RATIO_THRESHOLD;
+
+    std::vector<cv::DMatch> matches;
+    std::vector<float>      scores;
+    for (const auto& m : knnMatches)
+    {
+        if (m.size() == 2 && m[0].distance < ratio * m[1].distance)
+        {
+            matches.emplace_back(m[0].queryIdx, keyframe.refIdx[m[0].trainIdx], m[0].distance);
+            scores.push_back(m[0].distance / m[1].distance);
+        }
+    }
+
+    if (m_crossCheck)
+    {
+        std::vector<int> bestForRef(m_refKeypoints.size(), -1);
+        for (int i = 0; i < static_cast<int>(matches.size()); ++i)
+        {
+            int& best = bestForRef[matches[i].trainIdx];
+            if (best < 0 || matches[i].distance < matches[best].distance)
+                best = i;
+        }
+
+        std::vector<cv::DMatch> kept;
+        std::vector<float>      keptScores;
+        for (int i = 0; i < static_cast<int>(matches.size()); ++i)
+        {
+            if (bestForRef[matches[i].trainIdx] == i)
+            {
+                kept.push_back(matches[i]);
+                keptScores.push_back(scores[i]);
+            }
+        }
+        matches.swap(kept);
+        scores.swap(keptScores);
+    }
+
+    sortByScore(matches, scores);
+    return matches;
+}
+
+/* addKeyframe()
+ * The keyframe keeps the live keypoints that were pose inliers, their
+ * descriptors and the reference keypoint each matched; the store rejects it
+ * when it adds nothing over an existing view. */
+void SIFTTracker::addKeyframe(const std::vector<cv::KeyPoint>& liveKeypoints,
+                              const cv::Mat& liveDescriptors,
+                              const std::vector<cv::DMatch>& goodMatches)
+{
+    if (++m_detectionsSinceKeyframe < KEYFRAME_INTERVAL ||
+        m_inlierCount < MIN_KEYFRAME_POINTS)
+        return;
+    m_detectionsSinceKeyframe = 0;
+
+    Keyframe keyframe;
+    keyframe.rvec = m_rvec.clone();
+    keyframe.tvec = m_tvec.clone();
+    for (int i = 0; i < static_cast<int>(goodMatches.size()); ++i)
+    {
+        if (!m_lastInlierMask[i]) continue;
+        keyframe.keypoints.push_back(liveKeypoints[goodMatches[i].queryIdx]);
+        keyframe.descriptors.push_back(liveDescriptors.row(goodMatches[i].queryIdx));
+        keyframe.refIdx.push_back(goodMatches[i].trainIdx);
+    }
+    m_keyframes.add(std::move(keyframe));
+}
+
+/* updateOutline()
+ * Projects the four bill corners with the raw pose. The previous outline is
+ * kept for the constant-velocity prediction in predictWindow(). */
+void SIFTTracker::updateOutline()
+{
+    const std::vector<cv::Point3f> corners = {
+        { 0.0f,          0.0f,           0.0f },
+        { BILL_WIDTH_CM, 0.0f,           0.0f },
+        { BILL_WIDTH_CM, BILL_HEIGHT_CM, 0.0f },
+        { 0.0f,          BILL_HEIGHT_CM, 0.0f }
+    };
+
+    m_prevOutline = m_outline;
+    cv::projectPoints(corners, m_rvec, m_tvec,
+                      m_cameraMatrix, m_distCoeffs, m_outline);
+    if (m_prevOutline.size() != m_outline.size()) m_prevOutline = m_outline;
+}
+
+/* predictWindow()
+ * Predicted bill outline = last outline + last frame-to-frame motion, grown
+ * by the level's ROI margin (ROI_MARGIN at full quality) around its centroid. Returns the clipped bounding box and
+ * fills window with the grown polygon; returns an empty rect (full-frame
+ * detection) when there is no outline or the window is degenerate. */
+cv::Rect SIFTTracker::predictWindow(const cv::Size& frameSize,
+                                    std::vector<cv::Point>& window) const
+{
+    window.clear();
+    if (!m_useRoi || m_outline.size() != 4) return cv::Rect();
+
+    const std::vector<cv::Point2f> predicted = predictOutline();
+    const float margin = m_latency.settings().roiMargin;
+    cv::Point2f centroid(0.0f, 0.0f);
+    for (const auto& p : predicted)
+        centroid += p * 0.25f;
+
+    for (const auto& p : predicted)
+        window.emplace_back(centroid + (p - centroid) * (1.0f + margin));
+
+    const cv::Rect roi = cv::boundingRect(window)
+                       & cv::Rect(0, 0, frameSize.width, frameSize.height);
+    if (roi.width < MIN_ROI_SIZE || roi.height < MIN_ROI_SIZE)
+    {
+        window.clear();
+        return cv::Rect();
+    }
+    return roi;
+}
+
+/* predictOutline()
+ * Constant-velocity prediction shared by the detection window and guided
+ * matching. Empty when there is no outline. */
+std::vector<cv::Point2f> SIFTTracker::predictOutline() const
+{
+    std::vector<cv::Point2f> predicted;
+    if (m_outline.size() != 4) return predicted;
+
+    for (int i = 0; i < 4; ++i)
+        predicted.push_back(m_outline[i] + (m_outline[i] - m_prevOutline[i]));
+    return predicted;
+}
+
+/* smoothPose()
+ * Exponential moving average smoothing to reduce shakiness.
+ * Blends current raw pose with previous smoothed pose:
+ *   smoothed = alpha * raw + (1 - alpha) * previous_smoothed
+ * This reduces frame-to-frame jitter without introducing much lag. */
+void SIFTTracker::smoothPose()
+{
+    if (!m_hasSmooth)
+    {
+        // First successful frame — initialize smoother with raw pose
+        m_rvec.copyTo(m_rvecSmooth);
+        m_tvec.copyTo(m_tvecSmooth);
+        m_hasSmooth = true;
+    }
+    else
+    {
+        // Blend raw pose toward smoothed pose
+        m_rvecSmooth = m_smoothAlpha * m_rvec
+                     + (1.0 - m_smoothAlpha) * m_rvecSmooth;
+        m_tvecSmooth = m_smoothAlpha * m_tvec
+                     + (1.0 - m_smoothAlpha) * m_tvecSmooth;
+    }
+}
+
+/* trackFlow()
+ * 21x21 window, 3 pyramid levels — enough for hand-held motion at 30 fps.
+ * Lost points are dropped; the warm pose solver then rejects points that
+ * slid along edges (4px reprojection, RANSAC only if most points fail), so
+ * drift cannot accumulate in the point set. */
+bool SIFTTracker::trackFlow(const cv::Mat& gray)
+{
+    std::vector<cv::Point2f> nextPts;
+    std::vector<uchar>       status;
+    std::vector<float>       err;
+    {
+        StageTimer t(m_timings, StageTimings::FLOW);
+        cv::calcOpticalFlowPyrLK(m_prevGray, gray, m_flowLivePts, nextPts,
+                                 status, err, cv::Size(21, 21), 3);
+    }
+
+    std::vector<cv::Point2f> livePts;
+    std::vector<cv::Vec3f>   objPts;
+    for (size_t i = 0; i < status.size(); ++i)
+    {
+        if (!status[i]) continue;
+        livePts.push_back(nextPts[i]);
+        objPts.push_back(m_flowObjPts[i]);
+    }
+    if (static_cast<int>(livePts.size()) < MIN_FLOW_POINTS) return false;
+
+    std::vector<int> inliers;
+    bool ok;
+    {
+        StageTimer t(m_timings, StageTimings::PNP);
+        ok = m_solver.solve(objPts, livePts, m_cameraMatrix, m_distCoeffs,
+                            m_rvec, m_tvec, &inliers, 4.0);
+    }
+    if (!ok || static_cast<int>(inliers.size()) < MIN_FLOW_POINTS)
+        return false;
+
+    m_flowLivePts.clear();
+    m_flowObjPts.clear();
+    for (int idx : inliers)
+    {
+        m_flowLivePts.push_back(livePts[idx]);
+        m_flowObjPts.push_back(objPts[idx]);
+    }
+    m_inlierCount = static_cast<int>(inliers.size());
+    return true;
 }
 
 /* matchFeatures()
- * BFMatcher with L2 norm (correct for SIFT float descriptors).
+ * k=2 query against the reference index built in buildMatcher().
  * Applies Lowe's ratio test: keeps match only if best match is significantly
- * better than second best (ratio < 0.75). */
-std::vector<cv::DMatch> SIFTTracker::matchFeatures(
-    const cv::Mat& liveDescriptors) const
+ * better than second best (ratio < RATIO_THRESHOLD, or
+ * BINARY_RATIO_THRESHOLD for Hamming descriptors).
+ * Cross-check: one pass over the surviving matches records the closest live
+ * match per reference keypoint; every other live point claiming that
+ * reference keypoint is dropped. This gives the mutual-best-match filtering
+ * of a cross-checked matcher without a second, reverse knnMatch.
+ * The result is ordered by ratio (best/second distance), best first. */
+std::vector<cv::DMatch> SIFTTracker::matchFeatures(const cv::Mat& liveDescriptors)
 {
-    // BFMatcher with L2 norm — appropriate for SIFT float descriptors
-    cv::BFMatcher matcher(cv::NORM_L2);
-
-    // knnMatch: find 2 best matches per descriptor
     std::vector<std::vector<cv::DMatch>> knnMatches;
-    matcher.knnMatch(liveDescriptors, m_refDescriptors, knnMatches, 2);
+    if (m_deviceMatching)
+        m_features->knnMatchReference(knnMatches, 2);
+    else if (m_useOpenCL)
+        m_matcher->knnMatch(liveDescriptors.getUMat(cv::ACCESS_READ), knnMatches, 2);
+    else
+        m_matcher->knnMatch(liveDescriptors, knnMatches, 2);
 
-    /* Lowe's ratio test — 0.7 is standard, use 0.65 for stricter matching
-     * Lower ratio = fewer but more reliable matches = less shakiness */
-    std::vector<cv::DMatch> goodMatches;
+    const float ratio = m_features->isBinary() ? BINARY_RATIO_THRESHOLD
+                                               : RATIO_THRESHOLD;
+
+    std::vector<cv::DMatch> ratioMatches;
+    std::vector<float>      ratioScores;
+    ratioMatches.reserve(knnMatches.size());
+    ratioScores.reserve(knnMatches.size());
     for (const auto& m : knnMatches)
     {
-        if (m.size() == 2 && m[0].distance < 0.65f * m[1].distance)
-            goodMatches.push_back(m[0]);
+        if (m.size() == 2 && m[0].distance < ratio * m[1].distance)
+        {
+            ratioMatches.push_back(m[0]);
+            ratioScores.push_back(m[0].distance / m[1].distance);
+        }
+    }
+
+    if (!m_crossCheck)
+    {
+        sortByScore(ratioMatches, ratioScores);
+        return ratioMatches;
+    }
+
+    // Closest surviving match index per reference keypoint (-1 = none)
+    std::vector<int> bestForRef(m_refKeypoints.size(), -1);
+    for (int i = 0; i < static_cast<int>(ratioMatches.size()); ++i)
+    {
+        int& best = bestForRef[ratioMatches[i].trainIdx];
+        if (best < 0 || ratioMatches[i].distance < ratioMatches[best].distance)
+            best = i;
+    }
+
+    std::vector<cv::DMatch> goodMatches;
+    std::vector<float>      goodScores;
+    goodMatches.reserve(ratioMatches.size());
+    for (int i = 0; i < static_cast<int>(ratioMatches.size()); ++i)
+    {
+        if (bestForRef[ratioMatches[i].trainIdx] == i)
+        {
+            goodMatches.push_back(ratioMatches[i]);
+            goodScores.push_back(ratioScores[i]);
+        }
+    }
+
+    sortByScore(goodMatches, goodScores);
+    return goodMatches;
+}
+
+/* matchGuided()
+ * Live keypoints go into a grid of GUIDED_RADIUS cells (counting sort: cell
+ * counts, prefix sums, then indices), so each projected reference keypoint
+ * only visits the 3x3 cells around it. Cost grows with the keypoint count
+ * instead of reference x live, and wrong matches from elsewhere on the
+ * frame never reach findHomography.
+ * A reference keypoint with a single candidate in range has no second
+ * neighbour for the ratio test and is kept with score 1 (ranked last);
+ * RANSAC drops the rare coincidence. */
+std::vector<cv::DMatch> SIFTTracker::matchGuided(
+    const std::vector<cv::KeyPoint>& liveKeypoints,
+    const cv::Mat& liveDescriptors, const cv::Mat& H) const
+{
+    std::vector<cv::DMatch> matches;
+    std::vector<float>      scores;
+    if (liveKeypoints.empty() || m_refKeypoints.empty()) return matches;
+
+    // Bucket the live keypoints
+    float minX = liveKeypoints[0].pt.x, minY = liveKeypoints[0].pt.y;
+    float maxX = minX, maxY = minY;
+    for (const auto& kp : liveKeypoints)
+    {
+        minX = std::min(minX, kp.pt.x);  maxX = std::max(maxX, kp.pt.x);
+        minY = std::min(minY, kp.pt.y);  maxY = std::max(maxY, kp.pt.y);
+    }
+    const int gridW = static_cast<int>((maxX - minX) / GUIDED_RADIUS) + 1;
+    const int gridH = static_cast<int>((maxY - minY) / GUIDED_RADIUS) + 1;
+    auto cellOf = [&](const cv::Point2f& p)
+    {
+        return static_cast<int>((p.y - minY) / GUIDED_RADIUS) * gridW
+             + static_cast<int>((p.x - minX) / GUIDED_RADIUS);
+    };
+
+    std::vector<int> cellStart(gridW * gridH + 1, 0);
+    for (const auto& kp : liveKeypoints)
+        ++cellStart[cellOf(kp.pt) + 1];
+    for (size_t c = 1; c < cellStart.size(); ++c)
+        cellStart[c] += cellStart[c - 1];
+    std::vector<int> cellItems(liveKeypoints.size());
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < static_cast<int>(liveKeypoints.size()); ++i)
+        cellItems[fill[cellOf(liveKeypoints[i].pt)]++] = i;
+
+    // Project the reference keypoints
+    std::vector<cv::Point2f> refPts, projected;
+    refPts.reserve(m_refKeypoints.size());
+    for (const auto& kp : m_refKeypoints)
+        refPts.push_back(kp.pt);
+    cv::perspectiveTransform(refPts, projected, H);
+
+    const int   norm   = m_features->normType();
+    const float ratio  = m_features->isBinary() ? BINARY_RATIO_THRESHOLD
+                                                : RATIO_THRESHOLD;
+    const float r2     = GUIDED_RADIUS * GUIDED_RADIUS;
+
+    for (int j = 0; j < static_cast<int>(projected.size()); ++j)
+    {
+        const cv::Point2f& p = projected[j];
+        const int cx = static_cast<int>(std::floor((p.x - minX) / GUIDED_RADIUS));
+        const int cy = static_cast<int>(std::floor((p.y - minY) / GUIDED_RADIUS));
+        if (cx < -1 || cy < -1 || cx > gridW || cy > gridH) continue;
+
+        int    best = -1;
+        double bestDist = 0.0, secondDist = -1.0;
+        for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, gridH - 1); ++y)
+        {
+            for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, gridW - 1); ++x)
+            {
+                const int c = y * gridW + x;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; ++k)
+                {
+                    const int i = cellItems[k];
+                    const cv::Point2f d = liveKeypoints[i].pt - p;
+                    if (d.dot(d) > r2) continue;
+
+                    const double dist = cv::norm(liveDescriptors.row(i),
+                                                 m_refDescriptors.row(j), norm);
+                    if (best < 0 || dist < bestDist)
+                    {
+                        if (best >= 0) secondDist = bestDist;
+                        best     = i;
+                        bestDist = dist;
+                    }
+                    else if (secondDist < 0.0 || dist < secondDist)
+                    {
+                        secondDist = dist;
+                    }
+                }
+            }
+        }
+
+        if (best >= 0 && (secondDist < 0.0 || bestDist < ratio * secondDist))
+        {
+            matches.emplace_back(best, j, static_cast<float>(bestDist));
+            scores.push_back(secondDist > 0.0 ? static_cast<float>(bestDist / secondDist) : 1.0f);
+        }
+    }
+
+    if (!m_crossCheck)
+    {
+        sortByScore(matches, scores);
+        return matches;
+    }
+
+    // Each reference keypoint already has one match — keep the closest
+    // reference keypoint per live keypoint
+    std::vector<int> bestForLive(liveKeypoints.size(), -1);
+    for (int i = 0; i < static_cast<int>(matches.size()); ++i)
+    {
+        int& best = bestForLive[matches[i].queryIdx];
+        if (best < 0 || matches[i].distance < matches[best].distance)
+            best = i;
+    }
+
+    std::vector<cv::DMatch> goodMatches;
+    std::vector<float>      goodScores;
+    goodMatches.reserve(matches.size());
+    for (int i = 0; i < static_cast<int>(matches.size()); ++i)
+    {
+        if (bestForLive[matches[i].queryIdx] == i)
+        {
+            goodMatches.push_back(matches[i]);
+            goodScores.push_back(scores[i]);
+        }
     }
 
+    sortByScore(goodMatches, goodScores);
     return goodMatches;
 }
 
@@ -204,22 +1022,16 @@ bool SIFTTracker::estimatePose(
         livePts.push_back(liveKeypoints[m.queryIdx].pt);
     }
 
-    /* RANSAC threshold 5.0px — more tolerant of camera noise
-     * giving more inliers while still filtering wrong matches */
-    cv::Mat inlierMask;
-    cv::Mat H = cv::findHomography(refPts, livePts,
-                                    cv::RANSAC, 5.0, inlierMask);
-
-    if (H.empty()) return false;
+    std::vector<bool> inliers;
+    {
+        StageTimer t(m_timings, StageTimings::RANSAC);
+        if (!rejectOutliers(refPts, livePts, inliers)) return false;
+    }
 
     // Count inliers
-    std::vector<bool> inliers(inlierMask.rows);
     int inlierCount = 0;
-    for (int i = 0; i < inlierMask.rows; ++i)
-    {
-        inliers[i] = (inlierMask.at<uchar>(i) != 0);
-        if (inliers[i]) ++inlierCount;
-    }
+    for (bool in : inliers)
+        if (in) ++inlierCount;
     m_lastInlierMask = inliers;
     m_inlierCount    = inlierCount;
 
@@ -238,29 +1050,90 @@ bool SIFTTracker::estimatePose(
         imgPoints.push_back(livePts[i]);
     }
 
-    /* solvePnP: compute rotation and translation
+    /* Pose from the homography inliers — IPPE (bill is planar), picked
+     * against the previous pose while tracking, then LM refinement.
      * Uses same calibration matrix as Tasks 4-6 */
-    try
-    {
-        /* Use previous pose as initial guess when available —
-         * significantly improves stability at steep angles */
-        bool ok = cv::solvePnP(
-            objPoints,
-            imgPoints,
-            m_cameraMatrix,
-            m_distCoeffs,
-            m_rvec,
-            m_tvec,
-            m_hasSmooth,              // useExtrinsicGuess = true after first frame
-            cv::SOLVEPNP_ITERATIVE
-        );
-        return ok;
+    bool ok;
+    {
+        StageTimer t(m_timings, StageTimings::PNP);
+        ok = m_solver.solve(objPoints, imgPoints,
+                            m_cameraMatrix, m_distCoeffs, m_rvec, m_tvec);
     }
-    catch (const cv::Exception& e)
+
+    // Seed optical flow with the inliers that produced this pose
+    if (ok && m_useFlow)
     {
-        std::cerr << "[WARN] solvePnP failed: " << e.what() << "\n";
-        return false;
+        m_flowObjPts  = objPoints;
+        m_flowLivePts = imgPoints;
     }
+    return ok;
+}
+
+/* rejectOutliers()
+ * Threshold 5.0px — more tolerant of camera noise, giving more inliers
+ * while still filtering wrong matches. Every method stops early once
+ * ROBUST_CONFIDENCE is reached; m_robustIters caps the rest and follows
+ * the time budget: scaled down by budget/elapsed after a slow frame,
+ * doubled (up to the LatencyController level's cap, ROBUST_MAX_ITERS at
+ * full quality) after a frame under half the budget.
+ * PNP_RANSAC only picks the inliers — the pose itself still comes from
+ * PoseSolver on them, like the homography methods. */
+bool SIFTTracker::rejectOutliers(const std::vector<cv::Point2f>& refPts,
+                                 const std::vector<cv::Point2f>& livePts,
+                                 std::vector<bool>& inliers)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    inliers.assign(refPts.size(), false);
+    bool found = false;
+
+    if (m_robustMethod == PNP_RANSAC)
+    {
+        std::vector<cv::Vec3f> objPts;
+        objPts.reserve(refPts.size());
+        for (const auto& p : refPts)
+            objPts.push_back(refPointTo3D(p));
+
+        cv::UsacParams params;
+        params.sampler       = cv::SAMPLING_PROSAC;
+        params.threshold     = ROBUST_THRESHOLD_PX;
+        params.confidence    = ROBUST_CONFIDENCE;
+        params.maxIterations = m_robustIters;
+
+        cv::Mat rvec, tvec;
+        std::vector<int> idx;
+        try
+        {
+            found = cv::solvePnPRansac(objPts, livePts, m_cameraMatrix, m_distCoeffs,
+                                       rvec, tvec, idx, params);
+        }
+        catch (const cv::Exception&) { found = false; }
+        for (int i : idx)
+            inliers[i] = true;
+    }
+    else
+    {
+        const int method = m_robustMethod == PROSAC ? cv::USAC_PROSAC
+                         : m_robustMethod == MAGSAC ? cv::USAC_MAGSAC
+                         : cv::RANSAC;
+        cv::Mat inlierMask;
+        const cv::Mat H = cv::findHomography(refPts, livePts, method, ROBUST_THRESHOLD_PX,
+                                             inlierMask, m_robustIters, ROBUST_CONFIDENCE);
+        found = !H.empty();
+        for (int i = 0; found && i < inlierMask.rows; ++i)
+            inliers[i] = inlierMask.at<uchar>(i) != 0;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - t0).count();
+    if (m_robustBudgetMs > 0.0)
+    {
+        if (ms > m_robustBudgetMs)
+            m_robustIters = std::max(ROBUST_MIN_ITERS,
+                                     static_cast<int>(m_robustIters * m_robustBudgetMs / ms));
+        else if (ms < 0.5 * m_robustBudgetMs)
+            m_robustIters = std::min(m_latency.settings().maxRobustIters, m_robustIters * 2);
+    }
+    return found;
 }
 
 /* refPointTo3D()
@@ -290,8 +1163,17 @@ void SIFTTracker::drawDebug(cv::Mat& displayFrame) const
         cv::putText(displayFrame, t, p, cv::FONT_HERSHEY_SIMPLEX, s, c, 1);
     };
 
-    // Draw inlier keypoints as small circles
-    if (m_tracking)
+    // Predicted detection window used by the last detection pass
+    if (m_lastRoi.area() > 0 && !m_flowFrame)
+        cv::rectangle(displayFrame, m_lastRoi, cv::Scalar(255, 0, 255), 1);
+
+    // Draw inlier keypoints as small circles — flow points in cyan
+    if (m_tracking && m_flowFrame)
+    {
+        for (const auto& pt : m_flowLivePts)
+            cv::circle(displayFrame, pt, 4, cv::Scalar(255, 255, 0), 1);
+    }
+    else if (m_tracking)
     {
         for (int i = 0; i < static_cast<int>(m_lastGoodMatches.size()); ++i)
         {
@@ -310,9 +1192,10 @@ void SIFTTracker::drawDebug(cv::Mat& displayFrame) const
     cv::Scalar statusColor = m_tracking
         ? cv::Scalar(0, 255, 0)
         : cv::Scalar(0, 0, 255);
-    std::string statusStr = m_tracking
-        ? "Tracking bill - pose estimated"
-        : "No bill detected";
+    std::string statusStr = !m_tracking  ? "No bill detected"
+                          : m_flowFrame  ? "Tracking bill - optical flow"
+                          : m_relocFrame ? "Tracking bill - keyframe relocalisation"
+                                         : "Tracking bill - feature detection";
     putText2(statusStr, cv::Point(10, 30), 0.65, statusColor);
 
     // Inlier count
@@ -321,10 +1204,51 @@ void SIFTTracker::drawDebug(cv::Mat& displayFrame) const
        << "  (need >= " << MIN_INLIERS << ")";
     putText2(ss.str(), cv::Point(10, 55), 0.55, cv::Scalar(0, 255, 255));
 
+    // Active matcher
+    std::string matcherStr = std::string(FeatureBackend::typeName(m_backendType))
+        + "  |  Matcher: " + matcherLabel()
+        + "  |  " + robustMethodName(m_robustMethod)
+        + (m_crossCheck ? "  +cross-check" : "")
+        + (m_useFlow ? "  +flow" : "")
+        + (m_useRoi ? "  +ROI" : "")
+        + (m_useGuided ? "  +guided" : "")
+        + (m_useReloc ? "  +keyframes " + std::to_string(m_keyframes.size()) : "");
+    {
+        std::ostringstream sv;
+        sv << "  |  " << PoseSolver::methodName(m_solver.getMethod())
+           << std::fixed << std::setprecision(2) << " " << m_solver.averageSolveMs() << " ms";
+        matcherStr += sv.str();
+    }
+    if (effectiveDetectScale() < 1.0)
+    {
+        std::ostringstream sc;
+        sc << "  @" << std::setprecision(2) << effectiveDetectScale() << "x";
+        matcherStr += sc.str();
+    }
+    putText2(matcherStr, cv::Point(10, 101), 0.5, cv::Scalar(200, 200, 255));
+
+    // Latency controller — level, smoothed detection-frame time vs budget
+    if (m_latency.isEnabled())
+    {
+        const LatencyController::Settings& s = m_latency.settings();
+        const bool over = m_latency.averageMs() > m_latency.budgetMs();
+        std::ostringstream lc;
+        lc << std::fixed << std::setprecision(1)
+           << "Budget " << m_latency.budgetMs() << " ms  |  detect avg "
+           << m_latency.averageMs() << " ms  |  level " << m_latency.level()
+           << "/" << LatencyController::LEVEL_COUNT - 1
+           << "  |  " << (m_features ? m_features->nfeatures() : 0) << " feat"
+           << std::setprecision(2) << "  @" << effectiveDetectScale() << "x"
+           << "  ROI +" << s.roiMargin << "  iters " << m_robustIters
+           << "/" << s.maxRobustIters;
+        putText2(lc.str(), cv::Point(10, 124), 0.5,
+                 over ? cv::Scalar(0, 140, 255) : cv::Scalar(200, 255, 200));
+    }
+
     // Instructions
     putText2("Point camera at the dollar bill reference image",
              cv::Point(10, 78), 0.5, cv::Scalar(180, 220, 180));
-    putText2("'r' toggle rocket  |  'q' quit",
+    putText2("'r' toggle rocket  |  'm' matcher  |  'x' cross-check  |  'o' flow  |  'w' ROI  |  'g' guided  |  'k' keyframes  |  'e' estimator  |  's' scale  |  'l' budget  |  'q' quit",
              cv::Point(10, displayFrame.rows - 15), 0.5,
              cv::Scalar(180, 180, 180));
 }
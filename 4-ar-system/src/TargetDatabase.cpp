@@ -0,0 +1,504 @@
+/*
+ * TargetDatabase.cpp - Vocabulary-Tree Target Database Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements hierarchical k-means / k-majority vocabulary
+ *              training, tf-idf target vectors, inverted-file retrieval and
+ *              the .ardb reader/writer.
+ *
+ * Reference:
+ *   D. Nister, H. Stewenius - Scalable Recognition with a Vocabulary Tree
+ *   (CVPR 2006)
+ *
+ * Date: March 2026
+ */
+
+#include "TargetDatabase.h"
+#include <opencv2/core/hal/hal.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+    const char MAGIC[8] = { 'A', 'R', 'T', 'D', 'B', '1', '\0', '\0' };
+
+    template <typename T>
+    void writePod(std::ofstream& out, const T& v)
+    {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    bool readPod(std::ifstream& in, T& v)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+    }
+
+    void writeMat(std::ofstream& out, const cv::Mat& m)
+    {
+        const cv::Mat c = m.isContinuous() ? m : m.clone();
+        writePod(out, static_cast<int32_t>(c.rows));
+        writePod(out, static_cast<int32_t>(c.cols));
+        writePod(out, static_cast<int32_t>(c.type()));
+        out.write(reinterpret_cast<const char*>(c.data),
+                  static_cast<std::streamsize>(c.total() * c.elemSize()));
+    }
+
+    bool readMat(std::ifstream& in, cv::Mat& m)
+    {
+        int32_t rows = 0, cols = 0, type = 0;
+        if (!readPod(in, rows) || !readPod(in, cols) || !readPod(in, type) ||
+            rows < 0 || cols <= 0 || (type != CV_8U && type != CV_32F))
+            return false;
+        m.create(rows, cols, type);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(m.data),
+                                         static_cast<std::streamsize>(m.total() * m.elemSize())));
+    }
+}
+
+/* build()
+ * Clustering runs from a fixed RNG state so the same references always
+ * give the same tree; the global RNG is restored afterwards. */
+bool TargetDatabase::build(std::vector<DatabaseTarget> targets, FeatureBackend::Type backend)
+{
+    m_backend = backend;
+    m_centres.release();
+    m_firstChild.clear();
+    m_childCount.clear();
+    m_word.clear();
+    m_idf.clear();
+    m_targets.clear();
+    m_inverted.clear();
+
+    cv::Mat all;
+    for (const auto& t : targets)
+    {
+        if (t.descriptors.empty()) continue;
+        if (!all.empty() && (t.descriptors.type() != all.type() || t.descriptors.cols != all.cols))
+        {
+            std::cerr << "[ERROR] Target '" << t.name << "' has descriptors of another backend.\n";
+            return false;
+        }
+        all.push_back(t.descriptors);
+    }
+    if (all.empty())
+    {
+        std::cerr << "[ERROR] No target descriptors to build a vocabulary from.\n";
+        return false;
+    }
+
+    m_centres = cv::Mat::zeros(1, all.cols, all.type());
+    m_firstChild.assign(1, -1);
+    m_childCount.assign(1, 0);
+    m_word.assign(1, -1);
+
+    cv::RNG&       rng   = cv::theRNG();
+    const uint64_t saved = rng.state;
+    rng.state = 0x41524442;
+    std::vector<int> rows(all.rows);
+    std::iota(rows.begin(), rows.end(), 0);
+    split(all, rows, 0, 0);
+    rng.state = saved;
+
+    // idf over targets: in how many targets each word occurs
+    m_targets = std::move(targets);
+    std::vector<int> containing(wordCount(), 0);
+    for (const auto& t : m_targets)
+    {
+        std::vector<char> seen(wordCount(), 0);
+        for (int r = 0; r < t.descriptors.rows; ++r)
+        {
+            const int w = quantize(t.descriptors.ptr(r));
+            if (!seen[w]) ++containing[w];
+            seen[w] = 1;
+        }
+    }
+    const float n = static_cast<float>(m_targets.size());
+    for (int w = 0; w < wordCount(); ++w)
+        m_idf[w] = std::log((1.0f + n) / std::max(1, containing[w]));
+
+    for (auto& t : m_targets)
+        t.bow = transform(t.descriptors);
+    rebuildIndex();
+
+    std::cout << "[INFO] Vocabulary tree: " << wordCount() << " words from "
+              << all.rows << " descriptors of " << m_targets.size() << " targets ("
+              << FeatureBackend::typeName(m_backend) << ")\n";
+    return true;
+}
+
+/* split()
+ * A node with at most BRANCHING descriptors (or at DEPTH) is a leaf:
+ * splitting it further would give one word per descriptor. */
+void TargetDatabase::split(const cv::Mat& descriptors, const std::vector<int>& rows,
+                           int node, int level)
+{
+    if (level == DEPTH || static_cast<int>(rows.size()) <= BRANCHING)
+    {
+        m_word[node] = wordCount();
+        m_idf.push_back(0.0f);
+        return;
+    }
+
+    cv::Mat samples(static_cast<int>(rows.size()), descriptors.cols, descriptors.type());
+    for (size_t i = 0; i < rows.size(); ++i)
+        descriptors.row(rows[i]).copyTo(samples.row(static_cast<int>(i)));
+
+    std::vector<int> labels;
+    cv::Mat          centres;
+    cluster(samples, BRANCHING, labels, centres);
+
+    const int first = m_centres.rows;
+    m_centres.push_back(centres);
+    m_firstChild[node] = first;
+    m_childCount[node] = centres.rows;
+    m_firstChild.resize(m_centres.rows, -1);
+    m_childCount.resize(m_centres.rows, 0);
+    m_word.resize(m_centres.rows, -1);
+
+    std::vector<std::vector<int>> members(centres.rows);
+    for (size_t i = 0; i < rows.size(); ++i)
+        members[labels[i]].push_back(rows[i]);
+    for (int c = 0; c < centres.rows; ++c)
+        split(descriptors, members[c], first + c, level + 1);
+}
+
+/* cluster()
+ * Binary descriptors have no mean: k-majority seeds the centres with evenly
+ * spaced samples, then alternates Hamming assignment with a per-bit
+ * majority vote of each cluster's members. */
+void TargetDatabase::cluster(const cv::Mat& samples, int k,
+                             std::vector<int>& labels, cv::Mat& centres)
+{
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS,
+                                    CLUSTER_ITERATIONS, 1e-3);
+    if (samples.type() == CV_32F)
+    {
+        cv::Mat l;
+        cv::kmeans(samples, k, l, criteria, 1, cv::KMEANS_PP_CENTERS, centres);
+        labels.assign(l.begin<int>(), l.end<int>());
+        return;
+    }
+
+    const int bytes = samples.cols;
+    centres.create(k, bytes, CV_8U);
+    for (int c = 0; c < k; ++c)
+        samples.row(static_cast<int>(static_cast<long long>(c) * samples.rows / k))
+               .copyTo(centres.row(c));
+
+    labels.assign(samples.rows, -1);
+    std::vector<int> bitCounts(static_cast<size_t>(k) * bytes * 8);
+    std::vector<int> sizes(k);
+    for (int it = 0; it < CLUSTER_ITERATIONS; ++it)
+    {
+        bool changed = false;
+        for (int i = 0; i < samples.rows; ++i)
+        {
+            int best = 0, bestDist = INT_MAX;
+            for (int c = 0; c < k; ++c)
+            {
+                const int d = cv::hal::normHamming(samples.ptr(i), centres.ptr(c), bytes);
+                if (d < bestDist) { bestDist = d; best = c; }
+            }
+            changed |= labels[i] != best;
+            labels[i] = best;
+        }
+        if (!changed) break;
+
+        std::fill(bitCounts.begin(), bitCounts.end(), 0);
+        std::fill(sizes.begin(), sizes.end(), 0);
+        for (int i = 0; i < samples.rows; ++i)
+        {
+            const uchar* p = samples.ptr(i);
+            int* counts = &bitCounts[static_cast<size_t>(labels[i]) * bytes * 8];
+            ++sizes[labels[i]];
+            for (int b = 0; b < bytes; ++b)
+                for (int j = 0; j < 8; ++j)
+                    counts[b * 8 + j] += (p[b] >> j) & 1;
+        }
+        for (int c = 0; c < k; ++c)
+        {
+            if (sizes[c] == 0) continue;    // keep the seed of an empty cluster
+            const int* counts = &bitCounts[static_cast<size_t>(c) * bytes * 8];
+            uchar* centre = centres.ptr(c);
+            for (int b = 0; b < bytes; ++b)
+            {
+                uchar v = 0;
+                for (int j = 0; j < 8; ++j)
+                    if (2 * counts[b * 8 + j] > sizes[c]) v |= static_cast<uchar>(1 << j);
+                centre[b] = v;
+            }
+        }
+    }
+}
+
+/* distance() */
+double TargetDatabase::distance(const uchar* a, const uchar* b) const
+{
+    if (m_centres.type() == CV_32F)
+        return cv::normL2Sqr<float, float>(reinterpret_cast<const float*>(a),
+                                           reinterpret_cast<const float*>(b), m_centres.cols);
+    return cv::hal::normHamming(a, b, m_centres.cols);
+}
+
+/* quantize() */
+int TargetDatabase::quantize(const uchar* descriptor) const
+{
+    int node = 0;
+    while (m_childCount[node] > 0)
+    {
+        const int first = m_firstChild[node];
+        int    best     = first;
+        double bestDist = distance(descriptor, m_centres.ptr(first));
+        for (int c = first + 1; c < first + m_childCount[node]; ++c)
+        {
+            const double d = distance(descriptor, m_centres.ptr(c));
+            if (d < bestDist) { bestDist = d; best = c; }
+        }
+        node = best;
+    }
+    return m_word[node];
+}
+
+/* transform()
+ * Words of all descriptors, sorted, so each run is one word's tf. */
+TargetDatabase::BowVector TargetDatabase::transform(const cv::Mat& descriptors) const
+{
+    BowVector v;
+    if (m_idf.empty() || descriptors.empty() || descriptors.type() != m_centres.type() ||
+        descriptors.cols != m_centres.cols)
+        return v;
+
+    std::vector<int> words(descriptors.rows);
+    for (int r = 0; r < descriptors.rows; ++r)
+        words[r] = quantize(descriptors.ptr(r));
+    std::sort(words.begin(), words.end());
+
+    float total = 0.0f;
+    for (size_t i = 0; i < words.size();)
+    {
+        size_t j = i;
+        while (j < words.size() && words[j] == words[i]) ++j;
+        const float weight = static_cast<float>(j - i) * m_idf[words[i]];
+        if (weight > 0.0f)
+        {
+            v.emplace_back(words[i], weight);
+            total += weight;
+        }
+        i = j;
+    }
+    if (total <= 0.0f) return BowVector();
+    for (auto& w : v)
+        w.second /= total;
+    return v;
+}
+
+/* query()
+ * sum(min(q, d)) accumulated word by word through the inverted file. */
+std::vector<TargetDatabase::Candidate> TargetDatabase::query(const cv::Mat& descriptors,
+                                                             int maxResults) const
+{
+    std::vector<Candidate> result;
+    const BowVector q = transform(descriptors);
+    if (q.empty()) return result;
+
+    std::vector<float> scores(m_targets.size(), 0.0f);
+    for (const auto& w : q)
+        for (const auto& posting : m_inverted[w.first])
+            scores[posting.first] += std::min(w.second, posting.second);
+
+    for (int t = 0; t < size(); ++t)
+        if (scores[t] >= MIN_QUERY_SCORE)
+            result.push_back({ t, scores[t] });
+
+    const size_t keep = std::min(result.size(), static_cast<size_t>(std::max(0, maxResults)));
+    std::partial_sort(result.begin(), result.begin() + keep, result.end(),
+                      [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+    result.resize(keep);
+    return result;
+}
+
+/* rebuildIndex() */
+void TargetDatabase::rebuildIndex()
+{
+    m_inverted.assign(wordCount(), {});
+    for (int t = 0; t < size(); ++t)
+        for (const auto& w : m_targets[t].bow)
+            m_inverted[w.first].emplace_back(t, w.second);
+}
+
+/* save() */
+bool TargetDatabase::save(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "[ERROR] Cannot write target database: " << path << "\n";
+        return false;
+    }
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writePod(out, static_cast<int32_t>(m_backend));
+
+    writePod(out, static_cast<int32_t>(m_centres.rows));
+    for (int i = 0; i < m_centres.rows; ++i)
+    {
+        writePod(out, static_cast<int32_t>(m_firstChild[i]));
+        writePod(out, static_cast<int32_t>(m_childCount[i]));
+        writePod(out, static_cast<int32_t>(m_word[i]));
+    }
+    writeMat(out, m_centres);
+
+    writePod(out, static_cast<int32_t>(m_idf.size()));
+    out.write(reinterpret_cast<const char*>(m_idf.data()),
+              static_cast<std::streamsize>(m_idf.size() * sizeof(float)));
+
+    writePod(out, static_cast<int32_t>(m_targets.size()));
+    for (const auto& t : m_targets)
+    {
+        writePod(out, static_cast<int32_t>(t.name.size()));
+        out.write(t.name.data(), static_cast<std::streamsize>(t.name.size()));
+        writePod(out, t.widthCm);
+        writePod(out, t.heightCm);
+        writePod(out, static_cast<int32_t>(t.refSize.width));
+        writePod(out, static_cast<int32_t>(t.refSize.height));
+
+        writePod(out, static_cast<int32_t>(t.keypoints.size()));
+        for (const auto& kp : t.keypoints)
+        {
+            writePod(out, kp.pt.x);
+            writePod(out, kp.pt.y);
+            writePod(out, kp.size);
+            writePod(out, kp.angle);
+            writePod(out, kp.response);
+            writePod(out, static_cast<int32_t>(kp.octave));
+        }
+        writeMat(out, t.descriptors);
+
+        writePod(out, static_cast<int32_t>(t.bow.size()));
+        for (const auto& w : t.bow)
+        {
+            writePod(out, static_cast<int32_t>(w.first));
+            writePod(out, w.second);
+        }
+    }
+
+    if (!out)
+    {
+        std::cerr << "[ERROR] Write failed: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/* load()
+ * Every index read from the file is range-checked before use, so a
+ * damaged file fails here instead of in quantize(). */
+bool TargetDatabase::load(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "[ERROR] Cannot open target database: " << path << "\n";
+        return false;
+    }
+
+    auto bad = [&](const char* what) {
+        std::cerr << "[ERROR] " << what << " in target database: " << path << "\n";
+        m_targets.clear();
+        m_idf.clear();
+        return false;
+    };
+
+    char    magic[sizeof(MAGIC)];
+    int32_t backend = 0, nodes = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !readPod(in, backend) || backend < 0 || backend >= FeatureBackend::TYPE_COUNT ||
+        !readPod(in, nodes) || nodes <= 0)
+        return bad("Bad header");
+    m_backend = static_cast<FeatureBackend::Type>(backend);
+
+    m_firstChild.resize(nodes);
+    m_childCount.resize(nodes);
+    m_word.resize(nodes);
+    for (int i = 0; i < nodes; ++i)
+    {
+        int32_t first = 0, count = 0, word = 0;
+        if (!readPod(in, first) || !readPod(in, count) || !readPod(in, word))
+            return bad("Truncated tree");
+        m_firstChild[i] = first;
+        m_childCount[i] = count;
+        m_word[i]       = word;
+    }
+    if (!readMat(in, m_centres) || m_centres.rows != nodes)
+        return bad("Bad centre block");
+
+    int32_t words = 0;
+    if (!readPod(in, words) || words <= 0)
+        return bad("Bad vocabulary");
+    m_idf.resize(words);
+    if (!in.read(reinterpret_cast<char*>(m_idf.data()),
+                 static_cast<std::streamsize>(m_idf.size() * sizeof(float))))
+        return bad("Truncated vocabulary");
+
+    for (int i = 0; i < nodes; ++i)
+    {
+        const bool inner = m_childCount[i] > 0;
+        if (inner ? (m_firstChild[i] <= i || m_firstChild[i] + m_childCount[i] > nodes)
+                  : (m_word[i] < 0 || m_word[i] >= words))
+            return bad("Bad tree node");
+    }
+
+    int32_t count = 0;
+    if (!readPod(in, count) || count < 0)
+        return bad("Bad target count");
+    m_targets.assign(count, DatabaseTarget());
+    for (auto& t : m_targets)
+    {
+        int32_t nameLength = 0, w = 0, h = 0, keypoints = 0, bowSize = 0;
+        if (!readPod(in, nameLength) || nameLength < 0 || nameLength > 4096)
+            return bad("Bad target name");
+        t.name.resize(nameLength);
+        if (!in.read(&t.name[0], nameLength) ||
+            !readPod(in, t.widthCm) || !readPod(in, t.heightCm) ||
+            !readPod(in, w) || !readPod(in, h) || !readPod(in, keypoints) || keypoints < 0)
+            return bad("Truncated target");
+        t.refSize = cv::Size(w, h);
+
+        t.keypoints.resize(keypoints);
+        for (auto& kp : t.keypoints)
+        {
+            int32_t octave = 0;
+            if (!readPod(in, kp.pt.x) || !readPod(in, kp.pt.y) || !readPod(in, kp.size) ||
+                !readPod(in, kp.angle) || !readPod(in, kp.response) || !readPod(in, octave))
+                return bad("Truncated keypoints");
+            kp.octave = octave;
+        }
+        if (!readMat(in, t.descriptors) || t.descriptors.rows != keypoints ||
+            (keypoints > 0 && (t.descriptors.type() != m_centres.type() ||
+                               t.descriptors.cols != m_centres.cols)))
+            return bad("Bad descriptor block");
+
+        if (!readPod(in, bowSize) || bowSize < 0)
+            return bad("Bad target vector");
+        t.bow.resize(bowSize);
+        for (auto& v : t.bow)
+        {
+            int32_t word = 0;
+            if (!readPod(in, word) || !readPod(in, v.second) || word < 0 || word >= words)
+                return bad("Bad target vector");
+            v.first = word;
+        }
+    }
+
+    rebuildIndex();
+    std::cout << "[INFO] Target database loaded: " << path << " (" << size()
+              << " targets, " << wordCount() << " words, "
+              << FeatureBackend::typeName(m_backend) << ")\n";
+    return true;
+}
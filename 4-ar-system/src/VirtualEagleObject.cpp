@@ -3,7 +3,8 @@
  * Author:      Krushna Sanjay Sharma
  * Description: Implements a 3D wireframe eagle floating above the dollar bill.
  *              Geometry defined in local space, transformed at build time.
- *              cv::projectPoints() projects all endpoints in one batch call.
+ *              cv::projectPoints() projects the packed endpoints in one
+ *              batch call; lines go to cv::line or a GLRenderer batch.
  *
  * Extension:   Multiple targets in the scene
  *
@@ -11,6 +12,7 @@
  */
 
 #include "VirtualEagleObject.h"
+#include "GLRenderer.h"
 #include <iostream>
 #include <cmath>
 
@@ -33,13 +35,15 @@ void VirtualEagleObject::addLine(const cv::Vec3f& start,
     s = s * m_scale + m_offset;
     e = e * m_scale + m_offset;
     m_lines.push_back({ s, e, color, thickness });
+    m_vertices.push_back(s);
+    m_vertices.push_back(e);
 }
 
 /* build() */
 void VirtualEagleObject::build(cv::Vec3f offset, float scale,
                                  bool flipY, bool flipZ)
 {
-    m_lines.clear();
+    clear();
     m_offset = offset;
     m_scale  = scale;
     m_ySign  = flipY ? -1.0f : 1.0f;
@@ -186,8 +190,23 @@ void VirtualEagleObject::buildTail()
     addLine(tM, tR, COLOR_TAIL, 1);
 }
 
+/* project()
+ * Endpoints were packed at build time; the output buffer keeps its capacity. */
+const std::vector<cv::Point2f>& VirtualEagleObject::project(const cv::Mat& rvec,
+                                                            const cv::Mat& tvec,
+                                                            const cv::Mat& cameraMatrix,
+                                                            const cv::Mat& distCoeffs) const
+{
+    cv::projectPoints(
+        m_vertices, rvec, tvec,
+        cameraMatrix, distCoeffs,
+        m_projected, cv::noArray(), 0
+    );
+    return m_projected;
+}
+
 /* draw() - Core rendering
- * Collects all 3D endpoints, calls cv::projectPoints() once, draws lines. */
+ * Projects all endpoints with one cv::projectPoints() call, draws lines. */
 void VirtualEagleObject::draw(cv::Mat&        frame,
                                 const cv::Mat& rvec,
                                 const cv::Mat& tvec,
@@ -196,22 +215,8 @@ void VirtualEagleObject::draw(cv::Mat&        frame,
 {
     if (m_lines.empty()) return;
 
-    // Collect all 3D endpoints — index i*2 = start, i*2+1 = end
-    std::vector<cv::Vec3f> pts3D;
-    pts3D.reserve(m_lines.size() * 2);
-    for (const auto& seg : m_lines)
-    {
-        pts3D.push_back(seg.start);
-        pts3D.push_back(seg.end);
-    }
-
-    // Project all points in one cv::projectPoints call
-    std::vector<cv::Point2f> pts2D;
-    cv::projectPoints(
-        pts3D, rvec, tvec,
-        cameraMatrix, distCoeffs,
-        pts2D, cv::noArray(), 0
-    );
+    const std::vector<cv::Point2f>& pts2D =
+        project(rvec, tvec, cameraMatrix, distCoeffs);
 
     // Draw each segment
     cv::Rect bounds(0, 0, frame.cols, frame.rows);
@@ -223,3 +228,27 @@ void VirtualEagleObject::draw(cv::Mat&        frame,
         cv::line(frame, p1, p2, m_lines[i].color, m_lines[i].thickness);
     }
 }
+
+/* draw() - GPU variant */
+void VirtualEagleObject::draw(GLRenderer&    renderer,
+                                const cv::Mat& rvec,
+                                const cv::Mat& tvec,
+                                const cv::Mat& cameraMatrix,
+                                const cv::Mat& distCoeffs) const
+{
+    if (m_lines.empty()) return;
+
+    const std::vector<cv::Point2f>& pts2D =
+        project(rvec, tvec, cameraMatrix, distCoeffs);
+
+    const cv::Rect2f bounds(0.0f, 0.0f,
+                            static_cast<float>(renderer.frameSize().width),
+                            static_cast<float>(renderer.frameSize().height));
+    for (size_t i = 0; i < m_lines.size(); ++i)
+    {
+        const cv::Point2f& p1 = pts2D[i * 2    ];
+        const cv::Point2f& p2 = pts2D[i * 2 + 1];
+        if (!bounds.contains(p1) || !bounds.contains(p2)) continue;
+        renderer.addLine(p1, p2, m_lines[i].color, m_lines[i].thickness);
+    }
+}
@@ -0,0 +1,203 @@
+/*
+ * VirtualMesh.cpp - Triangle Mesh Virtual Object Implementation
+ * Author:      Krushna Sanjay Sharma
+ * Description: Implements OBJ loading into packed buffers, baked instancing
+ *              and the indexed GL draw used by GLRenderer.
+ *
+ * Date: March 2026
+ */
+
+#include "VirtualMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef AR_WITH_OPENGL
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#endif
+
+/* Light direction for the baked shading — above and slightly in front */
+static const cv::Vec3f LIGHT_DIR = cv::normalize(cv::Vec3f(0.3f, -0.4f, 1.0f));
+
+/* Constructor */
+VirtualMesh::VirtualMesh()
+    : m_instances(0)
+    , m_uploaded(false)
+{
+}
+
+/* parseIndex()
+ * One OBJ face token ("7", "7/2", "7//3", "7/2/3", negative = relative).
+ * Returns the 0-based vertex index, or -1 if invalid. */
+static int parseIndex(const std::string& token, int vertexCount)
+{
+    int idx = 0;
+    try { idx = std::stoi(token.substr(0, token.find('/'))); }
+    catch (...) { return -1; }
+
+    idx = idx < 0 ? vertexCount + idx : idx - 1;
+    return (idx >= 0 && idx < vertexCount) ? idx : -1;
+}
+
+/* loadOBJ() */
+bool VirtualMesh::loadOBJ(const std::string& path, float size,
+                          const cv::Scalar& color, bool flipY, bool flipZ)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "[ERROR] Cannot open mesh: " << path << "\n";
+        return false;
+    }
+
+    std::vector<cv::Vec3f> verts;
+    std::vector<int>       indices;
+    std::string            line;
+    while (std::getline(file, line))
+    {
+        std::istringstream ss(line);
+        std::string tag;
+        ss >> tag;
+        if (tag == "v")
+        {
+            float x = 0, y = 0, z = 0;
+            ss >> x >> y >> z;
+            verts.emplace_back(x, -z, y);   // OBJ Y-up → world Z-up
+        }
+        else if (tag == "f")
+        {
+            std::vector<int> face;
+            std::string token;
+            while (ss >> token)
+            {
+                const int idx = parseIndex(token, static_cast<int>(verts.size()));
+                if (idx >= 0) face.push_back(idx);
+            }
+            for (size_t k = 2; k < face.size(); ++k)
+            {
+                indices.push_back(face[0]);
+                indices.push_back(face[k - 1]);
+                indices.push_back(face[k]);
+            }
+        }
+    }
+
+    if (indices.empty())
+    {
+        std::cerr << "[ERROR] No triangles in mesh: " << path << "\n";
+        return false;
+    }
+
+    // Normalise: largest extent = size, centred in X/Y, base on Z = 0
+    cv::Vec3f lo = verts[0], hi = verts[0];
+    for (const auto& v : verts)
+        for (int a = 0; a < 3; ++a)
+        {
+            lo[a] = std::min(lo[a], v[a]);
+            hi[a] = std::max(hi[a], v[a]);
+        }
+    const float extent = std::max({ hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2], 1e-6f });
+    const float k      = size / extent;
+    const cv::Vec3f origin((lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, lo[2]);
+    const float ySign = flipY ? -1.0f : 1.0f;
+    const float zSign = flipZ ? -1.0f : 1.0f;
+    for (auto& v : verts)
+    {
+        v = (v - origin) * k;
+        v[1] *= ySign;
+        v[2] *= zSign;
+    }
+
+    // Bake shading — vertex normal = sum of adjacent face normals. Two-sided
+    // (|n·L|), so flips and inconsistent OBJ winding still shade correctly.
+    std::vector<cv::Vec3f> normals(verts.size(), cv::Vec3f(0, 0, 0));
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        const cv::Vec3f& a = verts[indices[t]];
+        const cv::Vec3f  n = (verts[indices[t + 1]] - a).cross(verts[indices[t + 2]] - a);
+        for (int c = 0; c < 3; ++c) normals[indices[t + c]] += n;
+    }
+
+    m_baseColors.resize(verts.size());
+    for (size_t i = 0; i < verts.size(); ++i)
+    {
+        const double len   = cv::norm(normals[i]);
+        const double lit   = len > 0.0 ? std::abs(normals[i].dot(LIGHT_DIR)) / len : 1.0;
+        const double shade = 0.35 + 0.65 * lit;
+        m_baseColors[i] = cv::Vec3b(cv::saturate_cast<uchar>(color[2] * shade),
+                                    cv::saturate_cast<uchar>(color[1] * shade),
+                                    cv::saturate_cast<uchar>(color[0] * shade));
+    }
+
+    m_baseVertices = verts;
+    m_baseIndices  = indices;
+    clearInstances();
+
+    std::cout << "[VirtualMesh] Loaded " << path << ": " << verts.size()
+              << " vertices, " << indices.size() / 3 << " triangles\n";
+    return true;
+}
+
+/* addInstance()
+ * Copies are baked into the packed buffers — the instances of one target are
+ * static relative to it, so the GPU keeps them and only the target's matrix
+ * changes per frame. */
+void VirtualMesh::addInstance(const cv::Vec3f& offset, float scale, float yawDeg)
+{
+    if (m_baseVertices.empty()) return;
+
+    const float yaw = yawDeg * static_cast<float>(CV_PI) / 180.0f;
+    const float c = std::cos(yaw), s = std::sin(yaw);
+    const int   base = static_cast<int>(m_vertices.size());
+
+    for (const auto& v : m_baseVertices)
+        m_vertices.emplace_back((c * v[0] - s * v[1]) * scale + offset[0],
+                                (s * v[0] + c * v[1]) * scale + offset[1],
+                                v[2] * scale + offset[2]);
+    m_colors.insert(m_colors.end(), m_baseColors.begin(), m_baseColors.end());
+    for (int idx : m_baseIndices)
+        m_indices.push_back(base + idx);
+
+    ++m_instances;
+    m_uploaded = false;
+}
+
+/* clearInstances() */
+void VirtualMesh::clearInstances()
+{
+    m_vertices.clear();
+    m_colors.clear();
+    m_indices.clear();
+    m_instances = 0;
+    m_uploaded  = false;
+}
+
+/* drawGL()
+ * Indices go into an element buffer as 32-bit values; cv::ogl::render()
+ * would pass CV_32S as GL_INT, which glDrawElements rejects, so the draw
+ * call is issued directly with GL_UNSIGNED_INT. */
+void VirtualMesh::drawGL() const
+{
+#ifdef AR_WITH_OPENGL
+    if (m_indices.empty()) return;
+
+    if (!m_uploaded)
+    {
+        m_gpuArrays.setVertexArray(m_vertices);
+        m_gpuArrays.setColorArray(m_colors);
+        m_gpuIndices.copyFrom(m_indices, cv::ogl::Buffer::ELEMENT_ARRAY_BUFFER);
+        m_uploaded = true;
+    }
+
+    m_gpuArrays.bind();
+    m_gpuIndices.bind(cv::ogl::Buffer::ELEMENT_ARRAY_BUFFER);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_indices.size()),
+                   GL_UNSIGNED_INT, nullptr);
+    cv::ogl::Buffer::unbind(cv::ogl::Buffer::ELEMENT_ARRAY_BUFFER);
+#endif
+}
@@ -4,7 +4,8 @@
  * Description: Implements the rocket 3D virtual object. Geometry is defined
  *              as line segments in world space. cv::projectPoints() is used
  *              each frame to project the 3D endpoints onto the 2D image plane,
- *              then cv::line() draws each segment in its assigned color.
+ *              then cv::line() (or a GLRenderer batch) draws each segment in
+ *              its assigned color.
  *
  * Task coverage:
  *   Task 6 - Virtual 3D rocket floating above the chessboard target
@@ -13,6 +14,7 @@
  */
 
 #include "VirtualObject.h"
+#include "GLRenderer.h"
 #include <iostream>
 
 /* Draw colors (BGR) */
@@ -34,6 +36,8 @@ void VirtualObject::addLine(const cv::Vec3f& start,
     s = s * m_scale + m_offset;
     e = e * m_scale + m_offset;
     m_lines.push_back({ s, e, color, thickness });
+    m_vertices.push_back(s);
+    m_vertices.push_back(e);
 }
 
 /* buildRocket()
@@ -41,7 +45,7 @@ void VirtualObject::addLine(const cv::Vec3f& start,
  * All geometry constants are multiplied by scale and shifted by offset. */
 void VirtualObject::buildRocket(cv::Vec3f offset, float scale, bool flipY, bool flipZ)
 {
-    m_lines.clear();
+    clear();
     m_scale  = scale;
     m_offset = offset;
     m_ySign  = flipY ? -1.0f : 1.0f;
@@ -206,60 +210,63 @@ void VirtualObject::buildWindow()
     addLine(BR, TL, COLOR_WINDOW, 1);
 }
 
-/* draw() - Core of Task 6
+/* project()
+ *
+ * The endpoints were packed into m_vertices by addLine(), so this is a
+ * single cv::projectPoints() call into a buffer that keeps its capacity
+ * between frames — no per-frame repacking or allocation.
  *
- * Strategy: collect ALL unique 3D endpoints from every line segment into one
- * vector, call cv::projectPoints() ONCE, then draw each line using the
- * pre-projected 2D indices. This is more efficient than calling projectPoints
- * per line and is the correct pattern for multi-line virtual objects.
+ * Full signature:
+ *   void cv::projectPoints(
+ *       InputArray  objectPoints,       // 3D world points (Vec3f, Nx3)
+ *       InputArray  rvec,               // rotation vector from solvePnP
+ *       InputArray  tvec,               // translation vector from solvePnP
+ *       InputArray  cameraMatrix,       // 3x3 intrinsic matrix
+ *       InputArray  distCoeffs,         // distortion coefficients
+ *       OutputArray imagePoints,        // OUTPUT: projected 2D pixel coords
+ *       OutputArray jacobian=noArray(), // not needed for rendering
+ *       double      aspectRatio=0       // 0 = unconstrained
+ *   )
  *
  * cv::projectPoints() transformation chain:
  *   3D world point → camera space (rvec/tvec) → normalize → distort
  *   → pixel coords (cameraMatrix) */
-void VirtualObject::draw(cv::Mat&        frame,
-                          const cv::Mat& rvec,
-                          const cv::Mat& tvec,
-                          const cv::Mat& cameraMatrix,
-                          const cv::Mat& distCoeffs) const
+const std::vector<cv::Point2f>& VirtualObject::project(const cv::Mat& rvec,
+                                                       const cv::Mat& tvec,
+                                                       const cv::Mat& cameraMatrix,
+                                                       const cv::Mat& distCoeffs) const
 {
-    if (m_lines.empty()) return;
-
-    /* Step 1: Collect all 3D endpoints into one flat vector
-     * Each line contributes 2 points → index i*2 = start, i*2+1 = end */
-    std::vector<cv::Vec3f> points3D;
-    points3D.reserve(m_lines.size() * 2);
-
-    for (const auto& seg : m_lines)
-    {
-        points3D.push_back(seg.start);
-        points3D.push_back(seg.end);
-    }
-
-    /* Step 2: Project ALL points in one cv::projectPoints call
-     * Full signature:
-     *   void cv::projectPoints(
-     *       InputArray  objectPoints,       // 3D world points (Vec3f, Nx3)
-     *       InputArray  rvec,               // rotation vector from solvePnP
-     *       InputArray  tvec,               // translation vector from solvePnP
-     *       InputArray  cameraMatrix,       // 3x3 intrinsic matrix
-     *       InputArray  distCoeffs,         // distortion coefficients
-     *       OutputArray imagePoints,        // OUTPUT: projected 2D pixel coords
-     *       OutputArray jacobian=noArray(), // not needed for rendering
-     *       double      aspectRatio=0       // 0 = unconstrained
-     *   ) */
-    std::vector<cv::Point2f> points2D;
     cv::projectPoints(
-        points3D,       // all 3D line endpoints in one batch
+        m_vertices,     // all 3D line endpoints in one batch
         rvec,           // rotation from solvePnP
         tvec,           // translation from solvePnP
         cameraMatrix,   // intrinsic matrix from calibration
         distCoeffs,     // distortion coefficients from calibration
-        points2D,       // OUTPUT: 2D projected pixel positions
+        m_projected,    // OUTPUT: 2D projected pixel positions
         cv::noArray(),  // jacobian: not needed for drawing
         0               // aspectRatio: 0 = unconstrained
     );
+    return m_projected;
+}
 
-    /* Step 3: Draw each line segment using its projected 2D endpoints */
+/* draw() - Core of Task 6
+ *
+ * Strategy: project the packed endpoint buffer ONCE, then draw each line
+ * using the pre-projected 2D indices. This is more efficient than calling
+ * projectPoints per line and is the correct pattern for multi-line virtual
+ * objects. */
+void VirtualObject::draw(cv::Mat&        frame,
+                          const cv::Mat& rvec,
+                          const cv::Mat& tvec,
+                          const cv::Mat& cameraMatrix,
+                          const cv::Mat& distCoeffs) const
+{
+    if (m_lines.empty()) return;
+
+    const std::vector<cv::Point2f>& points2D =
+        project(rvec, tvec, cameraMatrix, distCoeffs);
+
+    /* Draw each line segment using its projected 2D endpoints */
     cv::Rect imgBounds(0, 0, frame.cols, frame.rows);
 
     for (size_t i = 0; i < m_lines.size(); ++i)
@@ -274,3 +281,30 @@ void VirtualObject::draw(cv::Mat&        frame,
         cv::line(frame, p1, p2, m_lines[i].color, m_lines[i].thickness);
     }
 }
+
+/* draw() - GPU variant
+ * Same visibility rule as the CPU path; segments keep sub-pixel endpoints. */
+void VirtualObject::draw(GLRenderer&    renderer,
+                          const cv::Mat& rvec,
+                          const cv::Mat& tvec,
+                          const cv::Mat& cameraMatrix,
+                          const cv::Mat& distCoeffs) const
+{
+    if (m_lines.empty()) return;
+
+    const std::vector<cv::Point2f>& points2D =
+        project(rvec, tvec, cameraMatrix, distCoeffs);
+
+    const cv::Rect2f imgBounds(0.0f, 0.0f,
+                               static_cast<float>(renderer.frameSize().width),
+                               static_cast<float>(renderer.frameSize().height));
+
+    for (size_t i = 0; i < m_lines.size(); ++i)
+    {
+        const cv::Point2f& p1 = points2D[i * 2    ];
+        const cv::Point2f& p2 = points2D[i * 2 + 1];
+        if (!imgBounds.contains(p1) || !imgBounds.contains(p2)) continue;
+
+        renderer.addLine(p1, p2, m_lines[i].color, m_lines[i].thickness);
+    }
+}
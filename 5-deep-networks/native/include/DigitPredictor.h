@@ -0,0 +1,89 @@
+/**
+ * @file    DigitPredictor.h
+ * @brief   Native counterpart of src/inference/live_predictor.py: centred
+ *          ROI, MNIST preprocessing and ONNX inference for one frame.
+ *
+ *          Preprocessing matches the Python pipeline (greyscale -> Otsu
+ *          threshold -> invert -> 28x28 area resize -> normalise) on the
+ *          shared cvcore kernels: bgrToGray, a countJoint8u histogram for
+ *          the Otsu level, and a single applyLut pass that thresholds and
+ *          inverts together.  The normalised values are written straight
+ *          into the session's persistent input buffer through a 256-entry
+ *          table; the intermediate images keep their buffers between frames.
+ *
+ *          The models come from tasks/export_onnx.py and output
+ *          log-probabilities of shape (1, 10).
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#pragma once
+
+#include <cvcore/inference.hpp>
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// DigitPrediction — result of one frame
+// =============================================================================
+struct DigitPrediction {
+    int                   digit        = -1;
+    float                 confidence   = 0.f;   ///< Probability of digit
+    std::array<float, 10> probs{};              ///< exp(log_probs)
+    double                preprocessMs = 0.0;
+    double                inferenceMs  = 0.0;
+};
+
+// =============================================================================
+// DigitPredictor
+// =============================================================================
+class DigitPredictor {
+public:
+    static constexpr float ROI_FRACTION = 0.4f;     ///< Of the smaller frame side
+    static constexpr int   INPUT_SIZE   = 28;
+    static constexpr int   NUM_CLASSES  = 10;
+    static constexpr float MNIST_MEAN   = 0.1307f;
+    static constexpr float MNIST_STD    = 0.3081f;
+
+    /**
+     * @brief Load an exported model and run it once so provider setup is
+     *        not charged to the first frame.
+     * @throws Ort::Exception when the model cannot be loaded
+     */
+    DigitPredictor(const std::string& modelPath, const cvcore::InferenceOptions& options);
+
+    /** Centred square ROI for a frame of the given size. */
+    static cv::Rect roiRect(cv::Size frame);
+
+    /**
+     * @brief Preprocess the ROI of a BGR frame and classify it.
+     * @return False if the frame is empty or the run failed.
+     */
+    bool predict(const cv::Mat& frame, DigitPrediction& result);
+
+    /** 28x28 uint8 image the network saw last (white digit on black). */
+    const cv::Mat& networkInput() const { return digit_; }
+
+    const std::string& providers() const { return session_.providers(); }
+
+    /** Milliseconds the warm-up run took. */
+    double warmupMs() const { return warmupMs_; }
+
+private:
+    /** ROI -> digit_ (threshold, invert, resize). */
+    void preprocess(const cv::Mat& roi);
+
+    /** Otsu level of a 256-bin histogram (cv::THRESH_OTSU semantics). */
+    static int otsuLevel(const std::vector<uint32_t>& hist, double total);
+
+    cvcore::InferenceSession session_;
+    double                   warmupMs_ = -1.0;
+
+    cv::Mat gray_, binary_, digit_;
+    uchar   lut_[256];
+    float   normalise_[256];   ///< (v / 255 - mean) / std
+};
@@ -0,0 +1,111 @@
+/**
+ * @file    DigitPredictor.cpp
+ * @brief   ROI preprocessing and ONNX inference for live digit recognition.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#include "DigitPredictor.h"
+#include <cvcore/color.hpp>
+#include <cvcore/histogram.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+static const std::vector<int64_t> kInputShape = {1, 1, DigitPredictor::INPUT_SIZE,
+                                                 DigitPredictor::INPUT_SIZE};
+
+static double elapsedMs(int64 since)
+{
+    return (cv::getTickCount() - since) * 1000.0 / cv::getTickFrequency();
+}
+
+// =============================================================================
+// DigitPredictor
+// =============================================================================
+DigitPredictor::DigitPredictor(const std::string& modelPath,
+                               const cvcore::InferenceOptions& options)
+    : session_(modelPath, options)
+{
+    for (int v = 0; v < 256; v++)
+        normalise_[v] = (v / 255.f - MNIST_MEAN) / MNIST_STD;
+    warmupMs_ = session_.warmup(kInputShape, 3);
+}
+
+// -----------------------------------------------------------------------------
+cv::Rect DigitPredictor::roiRect(cv::Size frame)
+{
+    const int size = static_cast<int>(std::min(frame.width, frame.height) * ROI_FRACTION);
+    return {(frame.width - size) / 2, (frame.height - size) / 2, size, size};
+}
+
+// -----------------------------------------------------------------------------
+int DigitPredictor::otsuLevel(const std::vector<uint32_t>& hist, double total)
+{
+    // Maximise the between-class variance over every split
+    double sumAll = 0.0;
+    for (int v = 0; v < 256; v++) sumAll += v * static_cast<double>(hist[v]);
+
+    double wBelow = 0.0, sumBelow = 0.0, best = -1.0;
+    int    level  = 0;
+    for (int t = 0; t < 256; t++) {
+        wBelow   += hist[t];
+        sumBelow += t * static_cast<double>(hist[t]);
+        const double wAbove = total - wBelow;
+        if (wBelow == 0.0 || wAbove == 0.0) continue;
+
+        const double d   = sumBelow / wBelow - (sumAll - sumBelow) / wAbove;
+        const double var = wBelow * wAbove * d * d;
+        if (var > best) {
+            best  = var;
+            level = t;
+        }
+    }
+    return level;
+}
+
+// -----------------------------------------------------------------------------
+void DigitPredictor::preprocess(const cv::Mat& roi)
+{
+    cvcore::bgrToGray(roi, gray_);
+
+    // Otsu's THRESH_BINARY (v > t -> 255) followed by the inversion is one
+    // table: dark ink becomes the white MNIST stroke
+    const int level = otsuLevel(cvcore::countJoint8u(gray_, 256),
+                                static_cast<double>(gray_.total()));
+    for (int v = 0; v < 256; v++) lut_[v] = v > level ? 0 : 255;
+    cvcore::applyLut(gray_, lut_, binary_);
+
+    cv::resize(binary_, digit_, cv::Size(INPUT_SIZE, INPUT_SIZE), 0, 0, cv::INTER_AREA);
+}
+
+// -----------------------------------------------------------------------------
+bool DigitPredictor::predict(const cv::Mat& frame, DigitPrediction& result)
+{
+    if (frame.empty()) return false;
+
+    const int64 t0 = cv::getTickCount();
+    preprocess(frame(roiRect(frame.size())));
+
+    float* input = session_.input(kInputShape);
+    for (int y = 0; y < INPUT_SIZE; y++) {
+        const uchar* row = digit_.ptr<uchar>(y);
+        for (int x = 0; x < INPUT_SIZE; x++) *input++ = normalise_[row[x]];
+    }
+    result.preprocessMs = elapsedMs(t0);
+
+    const int64 t1 = cv::getTickCount();
+    if (!session_.run() || session_.outputSize() < static_cast<size_t>(NUM_CLASSES))
+        return false;
+    result.inferenceMs = elapsedMs(t1);
+
+    const float* logProbs = session_.output();
+    result.digit = 0;
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        result.probs[c] = std::exp(logProbs[c]);
+        if (logProbs[c] > logProbs[result.digit]) result.digit = c;
+    }
+    result.confidence = result.probs[result.digit];
+    return true;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file    livePredictor.cpp
+ * @brief   Native live digit recognition — C++ counterpart of
+ *          tasks/ext3_live_recognition.py on the ONNX exports.
+ *
+ *          A capture thread reads the camera through cvcore::FrameSource
+ *          into a latest-frame slot; the main thread takes the newest frame,
+ *          runs DigitPredictor on it and draws the result, so a slow
+ *          inference or display never stalls the driver and stale frames are
+ *          dropped instead of queued.
+ *
+ * Controls:
+ *   Q / Esc — quit
+ *   S       — save screenshot and network input to outputs/
+ *   R       — reset the latency averages
+ *
+ * Usage:
+ *   livePredictor [--model models/mnist_cnn.onnx] [--camera 0|spec]
+ *                 [--providers cpu] [--threads 1] [--output-dir outputs]
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#include "DigitPredictor.h"
+#include <cvcore/capture.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+static const char*  kWindow       = "Live Digit Recognition — Native";
+static const double kLatencyAlpha = 0.05;   ///< EMA weight of the newest frame
+static const int    kPreviewSize  = 112;
+
+// =============================================================================
+// LatestFrame — single-slot hand-off from the capture thread
+// =============================================================================
+class LatestFrame {
+public:
+    /** Publish a frame; swaps buffers so neither side allocates. */
+    void put(cvcore::Frame& frame)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(slot_, frame);
+            fresh_ = true;
+        }
+        ready_.notify_one();
+    }
+
+    /** Wait for a frame newer than the last take(); false once closed. */
+    bool take(cvcore::Frame& frame)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return fresh_ || closed_; });
+        if (!fresh_) return false;
+        std::swap(slot_, frame);
+        fresh_ = false;
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_one();
+    }
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable ready_;
+    cvcore::Frame           slot_;
+    bool                    fresh_  = false;
+    bool                    closed_ = false;
+};
+
+// -----------------------------------------------------------------------------
+static void captureLoop(cvcore::FrameSource& source, LatestFrame& latest,
+                        const std::atomic<bool>& stop)
+{
+    cvcore::Frame frame;
+    while (!stop) {
+        if (!source.read(frame)) {
+            if (source.live() && source.reopen()) continue;
+            break;
+        }
+        latest.put(frame);
+    }
+    latest.close();
+}
+
+// -----------------------------------------------------------------------------
+static cv::Scalar confidenceColor(float confidence)
+{
+    if (confidence >= 0.80f) return {0, 255, 0};     // green
+    if (confidence >= 0.50f) return {0, 200, 255};   // yellow
+    return {0, 0, 255};                              // red
+}
+
+// -----------------------------------------------------------------------------
+static void drawOverlay(cv::Mat& frame, const DigitPredictor& predictor,
+                        const DigitPrediction& p, double inferMs, double totalMs,
+                        const std::string& providers)
+{
+    const cv::Rect   roi   = DigitPredictor::roiRect(frame.size());
+    const cv::Scalar color = confidenceColor(p.confidence);
+    const auto       font  = cv::FONT_HERSHEY_SIMPLEX;
+    char text[96];
+
+    cv::rectangle(frame, roi, {0, 255, 0}, 2);
+    std::snprintf(text, sizeof(text), "%d  (%.1f%%)", p.digit, p.confidence * 100.f);
+    cv::putText(frame, text, {roi.x, std::max(24, roi.y - 10)}, font, 0.9, color, 2, cv::LINE_AA);
+
+    // Top 3
+    std::array<int, DigitPredictor::NUM_CLASSES> order;
+    for (int c = 0; c < DigitPredictor::NUM_CLASSES; c++) order[c] = c;
+    std::partial_sort(order.begin(), order.begin() + 3, order.end(),
+                      [&](int a, int b) { return p.probs[a] > p.probs[b]; });
+    for (int k = 0; k < 3; k++) {
+        std::snprintf(text, sizeof(text), "%d: %5.1f%%", order[k], p.probs[order[k]] * 100.f);
+        cv::putText(frame, text, {10, 24 + 20 * k}, font, 0.5, {230, 230, 230}, 1, cv::LINE_AA);
+    }
+
+    std::snprintf(text, sizeof(text), "infer %.3f ms  frame %.2f ms  [%s]",
+                  inferMs, totalMs, providers.c_str());
+    cv::putText(frame, text, {10, frame.rows - 10}, font, 0.45, {160, 160, 160}, 1, cv::LINE_AA);
+
+    // Network input preview, top right
+    const cv::Rect preview(frame.cols - kPreviewSize - 8, 8, kPreviewSize, kPreviewSize);
+    if (preview.x > 0 && preview.br().y < frame.rows && !predictor.networkInput().empty()) {
+        cv::Mat big, bgr;
+        cv::resize(predictor.networkInput(), big, preview.size(), 0, 0, cv::INTER_NEAREST);
+        cv::cvtColor(big, bgr, cv::COLOR_GRAY2BGR);
+        bgr.copyTo(frame(preview));
+        cv::rectangle(frame, preview, {255, 255, 255}, 2);
+    }
+}
+
+// -----------------------------------------------------------------------------
+static void saveScreenshot(const cv::Mat& display, const cv::Mat& input, int digit,
+                           const std::string& outputDir)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(outputDir, ec);
+
+    char stamp[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+
+    const std::filesystem::path dir(outputDir);
+    const std::string framePath = (dir / ("native_screenshot_" + std::string(stamp) + ".png")).string();
+    const std::string roiPath   = (dir / ("native_roi_" + std::string(stamp) + "_pred" +
+                                          std::to_string(digit) + ".png")).string();
+    cv::Mat big;
+    cv::resize(input, big, cv::Size(140, 140), 0, 0, cv::INTER_NEAREST);
+    if (cv::imwrite(framePath, display) && cv::imwrite(roiPath, big))
+        std::cout << "[INFO] Saved " << framePath << "\n";
+    else
+        std::cerr << "[ERROR] Cannot write to " << outputDir << "\n";
+}
+
+// =============================================================================
+// main
+// =============================================================================
+int main(int argc, char** argv)
+{
+    std::string modelPath = "models/mnist_cnn.onnx";
+    std::string camera    = "0";
+    std::string outputDir = "outputs";
+    cvcore::InferenceOptions options;
+    options.providers      = {cvcore::Provider::CPU};   // a 28x28 input is not worth a GPU copy
+    options.intraOpThreads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg  = argv[i];
+        const bool        more = i + 1 < argc;
+        if      (arg == "--model" && more)      modelPath = argv[++i];
+        else if (arg == "--camera" && more)     camera = argv[++i];
+        else if (arg == "--output-dir" && more) outputDir = argv[++i];
+        else if (arg == "--threads" && more)    options.intraOpThreads = std::atoi(argv[++i]);
+        else if (arg == "--providers" && more) {
+            if (!options.parseProviders(argv[++i]))
+                std::cerr << "[WARN] No known provider in " << argv[i] << ", using CPU\n";
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--model path.onnx] [--camera index|spec]"
+                      << " [--providers list] [--threads n] [--output-dir dir]\n";
+            return 1;
+        }
+    }
+
+    std::unique_ptr<DigitPredictor> predictor;
+    try {
+        predictor = std::make_unique<DigitPredictor>(modelPath, options);
+    } catch (const Ort::Exception& e) {
+        std::cerr << "[ERROR] Cannot load " << modelPath << ": " << e.what() << "\n"
+                  << "        Export it with: python tasks/export_onnx.py\n";
+        return 1;
+    }
+    std::cout << "[INFO] " << modelPath << " on " << predictor->providers()
+              << ", warm-up " << predictor->warmupMs() << " ms\n";
+
+    auto source = cvcore::FrameSource::open(camera);
+    if (!source) {
+        std::cerr << "[ERROR] Cannot open camera " << camera << "\n";
+        return 1;
+    }
+    std::cout << "[INFO] " << source->description() << "\n"
+              << "[INFO] Hold a digit inside the green box.  Q = quit | S = screenshot | R = reset\n";
+
+    LatestFrame       latest;
+    std::atomic<bool> stop{false};
+    std::thread       capture(captureLoop, std::ref(*source), std::ref(latest), std::cref(stop));
+
+    cv::namedWindow(kWindow, cv::WINDOW_NORMAL);
+    cvcore::Frame   frame;
+    DigitPrediction prediction;
+    double inferEma = 0.0, totalEma = 0.0;
+    bool   first    = true;
+
+    while (latest.take(frame)) {
+        if (!predictor->predict(frame.image, prediction)) continue;
+
+        // Per-digit latency: preprocessing + run; frame latency: capture to result
+        const double inferMs = prediction.preprocessMs + prediction.inferenceMs;
+        const double totalMs = frame.ageMs();
+        inferEma = first ? inferMs : inferEma + kLatencyAlpha * (inferMs - inferEma);
+        totalEma = first ? totalMs : totalEma + kLatencyAlpha * (totalMs - totalEma);
+        first    = false;
+
+        drawOverlay(frame.image, *predictor, prediction, inferEma, totalEma, predictor->providers());
+        cv::imshow(kWindow, frame.image);
+
+        const int key = cv::waitKey(1) & 0xFF;
+        if (key == 'q' || key == 27) break;
+        if (key == 's') saveScreenshot(frame.image, predictor->networkInput(), prediction.digit, outputDir);
+        if (key == 'r') {
+            std::cout << "[INFO] Reset. Mean latency " << inferEma << " ms per digit, "
+                      << totalEma << " ms capture to result\n";
+            first = true;
+        }
+    }
+
+    stop = true;
+    capture.join();
+    cv::destroyAllWindows();
+    return 0;
+}
@@ -0,0 +1,151 @@
+# tasks/export_onnx.py
+# Project 5: Recognition using Deep Networks
+# Author: Krushna Sanjay Sharma
+# Description: Exports the trained MNIST models to ONNX for the native C++
+#              live predictor (native/livePredictor). Each model is loaded
+#              through ModelIO exactly as the Python tasks load it, then
+#              traced with a single (1, 1, 28, 28) normalised input. The batch
+#              dimension is left dynamic; the outputs stay log-probabilities.
+#
+# Usage:
+#   python tasks/export_onnx.py                    # both models
+#   python tasks/export_onnx.py --model cnn
+#   python tasks/export_onnx.py --model transformer --model-dir ./models
+
+import sys
+import os
+import argparse
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), ".."))
+
+import torch
+
+from src.network.digit_network       import DigitNetwork
+from src.utils.model_io              import ModelIO
+from tasks.task4_transformer         import task4_build_transformer
+
+
+# ------------------------------------------------------------------
+# Defaults
+# ------------------------------------------------------------------
+
+DEFAULT_MODEL_DIR = "./models"
+ONNX_OPSET        = 17
+
+# name -> (.pth file, .onnx file)
+MODEL_FILES = {
+    "cnn":         ("mnist_cnn.pth",         "mnist_cnn.onnx"),
+    "transformer": ("mnist_transformer.pth", "mnist_transformer.onnx"),
+}
+
+
+# ------------------------------------------------------------------
+# Export
+# ------------------------------------------------------------------
+
+def build_model(name: str) -> torch.nn.Module:
+    """
+    Builds an untrained model with the architecture of the saved weights.
+
+    Args:
+        name (str): "cnn" or "transformer".
+
+    Returns:
+        DigitNetwork or NetTransformer on the CPU.
+    """
+    if name == "cnn":
+        return DigitNetwork()
+    model, _ = task4_build_transformer(torch.device("cpu"))
+    return model
+
+
+def export_model(name: str, model_dir: str) -> str:
+    """
+    Loads one trained model and writes its ONNX export next to it.
+
+    Args:
+        name      (str): "cnn" or "transformer".
+        model_dir (str): Directory holding the .pth file.
+
+    Returns:
+        str: Path of the written .onnx file.
+    """
+    pth_file, onnx_file = MODEL_FILES[name]
+
+    model_io = ModelIO(model_dir=model_dir)
+    model    = build_model(name)
+    model_io.load(model, pth_file)   # also calls model.eval() internally
+    model    = model.to("cpu")
+
+    dummy     = torch.zeros(1, 1, 28, 28)
+    onnx_path = os.path.join(model_dir, onnx_file)
+    torch.onnx.export(
+        model,
+        dummy,
+        onnx_path,
+        input_names   = ["input"],
+        output_names  = ["log_probs"],
+        dynamic_axes  = {"input": {0: "batch"}, "log_probs": {0: "batch"}},
+        opset_version = ONNX_OPSET,
+    )
+    print(f"  [export_onnx] {pth_file} -> {onnx_path}")
+    return onnx_path
+
+
+# ------------------------------------------------------------------
+# Main entry point
+# ------------------------------------------------------------------
+
+def parse_args(argv: list) -> argparse.Namespace:
+    """
+    Parses CLI arguments.
+
+    Args:
+        argv (list): sys.argv
+
+    Returns:
+        argparse.Namespace with models and model_dir.
+    """
+    parser = argparse.ArgumentParser(
+        description="Export trained MNIST models to ONNX for the C++ live predictor."
+    )
+    parser.add_argument(
+        "--model",
+        dest    = "models",
+        nargs   = "+",
+        choices = list(MODEL_FILES),
+        default = list(MODEL_FILES),
+        help    = "Model(s) to export (default: all)",
+    )
+    parser.add_argument(
+        "--model-dir",
+        dest    = "model_dir",
+        default = DEFAULT_MODEL_DIR,
+        help    = f"Directory containing saved models (default: {DEFAULT_MODEL_DIR})",
+    )
+    return parser.parse_args(argv[1:])
+
+
+def main(argv: list) -> None:
+    """
+    Exports every requested model that has been trained.
+
+    Args:
+        argv (list): sys.argv
+    """
+    args = parse_args(argv)
+
+    print("=" * 60)
+    print("  export_onnx — Export Models for the Native Predictor")
+    print("=" * 60)
+
+    for name in args.models:
+        pth_path = os.path.join(args.model_dir, MODEL_FILES[name][0])
+        if not os.path.exists(pth_path):
+            print(f"  [export_onnx] {pth_path} not found — train it first, skipping.")
+            continue
+        export_model(name, args.model_dir)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,70 @@
+/**
+ * @file    BoundedQueue.h
+ * @brief   Blocking FIFO of fixed capacity connecting two pipeline stages.
+ *
+ *          push() waits while the queue is full, so a fast producer (the
+ *          slide decoder) cannot run ahead of a slow consumer (inference)
+ *          and memory stays bounded by the capacities.  close() ends the
+ *          stream: pop() drains what is left and then returns false.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    /** Wait for space and append; false (item dropped) once closed. */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [&] { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(item));
+        lock.unlock();
+        ready_.notify_one();
+        return true;
+    }
+
+    /** Wait for an item; false when closed and drained. */
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        space_.notify_one();
+        return true;
+    }
+
+    /** No more pushes; wakes every waiter. */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+        space_.notify_all();
+    }
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<T>           items_;
+    size_t                  capacity_;
+    bool                    closed_ = false;
+};
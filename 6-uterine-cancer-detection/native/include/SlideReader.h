@@ -0,0 +1,58 @@
+/**
+ * @file    SlideReader.h
+ * @brief   Random-access tile reads from a whole-slide image that never
+ *          decodes the whole slide.
+ *
+ *          Implementations:
+ *            - MappedPpmReader: binary PPM (P6, 8-bit), e.g. written by
+ *              `vips copy slide.svs slide.ppm`.  The file is memory-mapped
+ *              through cvcore::MappedFile and a tile is a strided view of
+ *              the mapping, so only the pages under the tiles being read are
+ *              ever resident.
+ *            - OpenSlideReader (built with OpenSlide, USE_OPENSLIDE): .svs,
+ *              .ndpi, .mrxs, pyramidal TIFF...; a downsampled tile is read
+ *              from the best pyramid level.
+ *            - ImageReader: any other format cv::imread understands.  It
+ *              decodes the whole image and is meant for small test images.
+ *
+ *          readTile() is called from one thread at a time.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+
+// =============================================================================
+// SlideReader
+// =============================================================================
+class SlideReader {
+public:
+    virtual ~SlideReader() = default;
+
+    /**
+     * @brief Open a slide, choosing the reader from the file.
+     * @return The reader, or nullptr if the slide cannot be opened.
+     */
+    static std::unique_ptr<SlideReader> open(const std::string& path);
+
+    /** Full-resolution (level 0) size in pixels. */
+    virtual cv::Size size() const = 0;
+
+    /**
+     * @brief Read a level-0 region, scaled to outSize, as BGR.
+     *
+     * Parts of the region outside the slide are white (background).
+     * dst keeps its buffer when it already has the right size and type.
+     *
+     * @return False on a read error.
+     */
+    virtual bool readTile(const cv::Rect& region, cv::Size outSize, cv::Mat& dst) = 0;
+
+    /** Reader and file, e.g. "mapped PPM 98304x76800". */
+    virtual std::string description() const = 0;
+};
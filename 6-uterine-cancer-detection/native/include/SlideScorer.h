@@ -0,0 +1,114 @@
+/**
+ * @file    SlideScorer.h
+ * @brief   Pipelined whole-slide scoring with one of the exported transfer
+ *          models (ResNet, ViT, GaborResNet, DenseNet).
+ *
+ *          The slide is cut into a grid of tiles, each covering
+ *          tileSize * downsample level-0 pixels and scaled to the model's
+ *          tileSize input, and three stages run concurrently:
+ *
+ *            decode      SlideReader::readTile() in raster order
+ *            preprocess  tissue test, then ImageNet normalisation of tissue
+ *                        tiles into the next [N, 3, S, S] batch
+ *            inference   InferenceSession run per batch; softmax P(cancerous)
+ *                        into the heatmap cell of every tile in the batch
+ *
+ *          They are connected by BoundedQueues and recycle a fixed pool of
+ *          tile images and batch buffers, so memory is a few batches
+ *          whatever the slide size.  Inference runs on the calling thread.
+ *
+ *          Background test: the rg chromaticity histogram of the tile
+ *          (cvcore::countRgChromaticity, 32 bins) gives the share of pixels
+ *          whose chromaticity lies at least minChroma from neutral grey.
+ *          Glass and white background are neutral, stained tissue is not;
+ *          tiles below minTissue are skipped without reaching the network.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#pragma once
+
+#include "SlideReader.h"
+#include <cvcore/inference.hpp>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// SlideScoreOptions
+// =============================================================================
+struct SlideScoreOptions {
+    int   tileSize   = 224;     ///< Model input side (the training patch size)
+    int   downsample = 1;       ///< Level-0 pixels per input pixel
+    int   batchSize  = 16;      ///< Tissue tiles per inference run
+    float minChroma  = 0.05f;   ///< rg distance from neutral counted as stained
+    float minTissue  = 0.25f;   ///< Stained share needed to score a tile
+    int   thumbCell  = 8;       ///< Thumbnail pixels per tile side
+};
+
+// =============================================================================
+// SlideScore — result of one slide
+// =============================================================================
+struct SlideScore {
+    cv::Mat heatmap;            ///< CV_32F, one cell per tile, P(cancerous); NaN = background
+    cv::Mat thumbnail;          ///< BGR, thumbCell pixels per tile
+    long long tiles       = 0;
+    long long tissueTiles = 0;
+    long long batches     = 0;
+    double decodeMs     = 0.0;  ///< Busy time per stage
+    double preprocessMs = 0.0;
+    double inferenceMs  = 0.0;
+    double wallMs       = 0.0;
+    bool   complete     = false;  ///< False if a read or run failed part-way
+};
+
+// =============================================================================
+// SlideScorer
+// =============================================================================
+class SlideScorer {
+public:
+    static constexpr int CANCER_CLASS      = 1;    ///< "cancerous" in the training labels
+    static constexpr int TISSUE_BINS       = 32;   ///< rg histogram bins per axis
+    static constexpr int BATCHES_IN_FLIGHT = 3;    ///< Being filled, queued, running
+
+    /**
+     * @brief Load an exported model and warm it up at the batch size.
+     * @throws Ort::Exception when the model cannot be loaded
+     */
+    SlideScorer(const std::string& modelPath, const cvcore::InferenceOptions& inference,
+                const SlideScoreOptions& options);
+
+    /** Score every tile of a slide. */
+    SlideScore score(SlideReader& reader);
+
+    const std::string& providers() const { return session_.providers(); }
+
+private:
+    struct Tile {
+        int     index = -1;   ///< Heatmap cell, row-major
+        cv::Mat image;        ///< BGR, tileSize x tileSize
+    };
+
+    struct Batch {
+        std::vector<float> data;      ///< batchSize * 3 * S * S
+        std::vector<int>   indices;   ///< Heatmap cell of each filled sample
+    };
+
+    /** True if enough of the tile is stained to be tissue. */
+    bool isTissue(const cv::Mat& tile) const;
+
+    /** ImageNet-normalised planar RGB of a BGR tile into dst (3 * S * S). */
+    void normalise(const cv::Mat& tile, float* dst) const;
+
+    /** Run one batch; falls back to single runs if the model rejects it. */
+    bool infer(Batch& batch, cv::Mat& heatmap);
+
+    /** Softmax P(cancerous) from one row of logits. */
+    static float cancerProbability(const float* logits, int classes);
+
+    cvcore::InferenceSession session_;
+    SlideScoreOptions        options_;
+    float                    lut_[3][256];   ///< Per RGB channel: (v / 255 - mean) / std
+    bool                     singleOnly_ = false;
+};
@@ -0,0 +1,258 @@
+/**
+ * @file    SlideReader.cpp
+ * @brief   Mapped-PPM, OpenSlide and imread slide readers.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#include "SlideReader.h"
+#include <cvcore/mappedFile.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#ifdef USE_OPENSLIDE
+#include <openslide.h>
+#endif
+
+/**
+ * Build the tile for region from the part of it inside the slide.
+ * inside is a view of that part; code converts it to BGR (-1: already BGR).
+ * The rest of the region is white; the result is scaled to outSize.
+ */
+static void composeTile(const cv::Mat& inside, int code, const cv::Rect& region,
+                        const cv::Rect& clipped, cv::Size outSize, cv::Mat& canvas, cv::Mat& dst)
+{
+    auto convert = [&](cv::Mat& to) {
+        if (code < 0) inside.copyTo(to);
+        else          cv::cvtColor(inside, to, code);
+    };
+
+    if (clipped == region && region.size() == outSize) {
+        convert(dst);
+        return;
+    }
+    if (clipped == region) {
+        convert(canvas);
+    } else {
+        canvas.create(region.size(), CV_8UC3);
+        canvas.setTo(cv::Scalar::all(255));
+        if (!clipped.empty()) {
+            cv::Mat part = canvas(clipped - region.tl());
+            convert(part);
+        }
+    }
+    cv::resize(canvas, dst, outSize, 0, 0, cv::INTER_AREA);
+}
+
+// =============================================================================
+// MappedPpmReader
+// =============================================================================
+class MappedPpmReader : public SlideReader {
+public:
+    bool open(const std::string& path)
+    {
+        if (!file_.open(path)) return false;
+
+        // "P6" <ws> width <ws> height <ws> maxval <single ws> pixels; '#' comments
+        const char* p   = file_.data();
+        const char* end = p + file_.size();
+        auto skip = [&] {
+            while (p < end && (std::isspace(static_cast<unsigned char>(*p)) || *p == '#')) {
+                if (*p == '#') while (p < end && *p != '\n') p++;
+                else           p++;
+            }
+        };
+        auto number = [&](long long& value) {
+            skip();
+            if (p >= end || !std::isdigit(static_cast<unsigned char>(*p))) return false;
+            value = 0;
+            while (p < end && std::isdigit(static_cast<unsigned char>(*p)))
+                value = value * 10 + (*p++ - '0');
+            return true;
+        };
+
+        long long width = 0, height = 0, maxval = 0;
+        if (file_.size() < 2 || p[0] != 'P' || p[1] != '6') return false;
+        p += 2;
+        if (!number(width) || !number(height) || !number(maxval) || p >= end) return false;
+        p++;   // the single whitespace before the pixels
+
+        if (maxval != 255 || width <= 0 || height <= 0 || width > INT32_MAX / 3 ||
+            height > INT32_MAX ||
+            static_cast<unsigned long long>(end - p) < static_cast<unsigned long long>(width) * height * 3) {
+            std::cerr << "[SlideReader] " << path << ": unsupported or truncated PPM\n";
+            return false;
+        }
+
+        // Copy-on-write mapping: the view is never written through
+        image_ = cv::Mat(static_cast<int>(height), static_cast<int>(width), CV_8UC3,
+                         const_cast<char*>(p));
+        description_ = "mapped PPM " + std::to_string(width) + "x" + std::to_string(height);
+        return true;
+    }
+
+    cv::Size size() const override { return image_.size(); }
+
+    bool readTile(const cv::Rect& region, cv::Size outSize, cv::Mat& dst) override
+    {
+        const cv::Rect clipped = region & cv::Rect(cv::Point(), image_.size());
+        composeTile(clipped.empty() ? cv::Mat() : image_(clipped), cv::COLOR_RGB2BGR,
+                    region, clipped, outSize, canvas_, dst);
+        return true;
+    }
+
+    std::string description() const override { return description_; }
+
+private:
+    cvcore::MappedFile file_;
+    cv::Mat            image_;    ///< RGB view of the mapping
+    cv::Mat            canvas_;
+    std::string        description_;
+};
+
+#ifdef USE_OPENSLIDE
+// =============================================================================
+// OpenSlideReader
+// =============================================================================
+class OpenSlideReader : public SlideReader {
+public:
+    ~OpenSlideReader() override
+    {
+        if (slide_) openslide_close(slide_);
+    }
+
+    bool open(const std::string& path)
+    {
+        slide_ = openslide_open(path.c_str());
+        if (!slide_) return false;
+        if (const char* error = openslide_get_error(slide_)) {
+            std::cerr << "[SlideReader] " << path << ": " << error << "\n";
+            return false;
+        }
+        int64_t w = 0, h = 0;
+        openslide_get_level0_dimensions(slide_, &w, &h);
+        size_ = cv::Size(static_cast<int>(w), static_cast<int>(h));
+
+        const char* vendor = openslide_detect_vendor(path.c_str());
+        description_ = std::string("OpenSlide (") + (vendor ? vendor : "?") + ") " +
+                       std::to_string(w) + "x" + std::to_string(h) + ", " +
+                       std::to_string(openslide_get_level_count(slide_)) + " levels";
+        return true;
+    }
+
+    cv::Size size() const override { return size_; }
+
+    bool readTile(const cv::Rect& region, cv::Size outSize, cv::Mat& dst) override
+    {
+        // Read from the pyramid level closest to the requested downsample
+        const double wanted = static_cast<double>(region.width) / outSize.width;
+        const int    level  = openslide_get_best_level_for_downsample(slide_, wanted);
+        const double scale  = openslide_get_level_downsample(slide_, level);
+        const cv::Size levelSize(std::max(1, static_cast<int>(std::ceil(region.width / scale))),
+                                 std::max(1, static_cast<int>(std::ceil(region.height / scale))));
+
+        // Premultiplied ARGB words are BGRA bytes on little-endian hosts
+        argb_.create(levelSize, CV_8UC4);
+        openslide_read_region(slide_, argb_.ptr<uint32_t>(), region.x, region.y, level,
+                              levelSize.width, levelSize.height);
+        if (openslide_get_error(slide_)) return false;
+
+        // Un-premultiply; transparent pixels (outside the scanned area) are white
+        bgr_.create(levelSize, CV_8UC3);
+        for (int y = 0; y < levelSize.height; y++) {
+            const uchar* s = argb_.ptr<uchar>(y);
+            uchar*       d = bgr_.ptr<uchar>(y);
+            for (int x = 0; x < levelSize.width; x++, s += 4, d += 3) {
+                const int a = s[3];
+                if (a == 255) {
+                    d[0] = s[0]; d[1] = s[1]; d[2] = s[2];
+                } else if (a == 0) {
+                    d[0] = d[1] = d[2] = 255;
+                } else {
+                    for (int c = 0; c < 3; c++)
+                        d[c] = static_cast<uchar>(std::min(255, (s[c] * 255 + a / 2) / a));
+                }
+            }
+        }
+        const cv::Rect whole(cv::Point(), levelSize);
+        composeTile(bgr_, -1, whole, whole, outSize, canvas_, dst);
+        return true;
+    }
+
+    std::string description() const override { return description_; }
+
+private:
+    openslide_t* slide_ = nullptr;
+    cv::Size     size_;
+    cv::Mat      argb_, bgr_, canvas_;
+    std::string  description_;
+};
+#endif
+
+// =============================================================================
+// ImageReader
+// =============================================================================
+class ImageReader : public SlideReader {
+public:
+    bool open(const std::string& path)
+    {
+        image_ = cv::imread(path, cv::IMREAD_COLOR);
+        if (image_.empty()) return false;
+        description_ = "decoded image " + std::to_string(image_.cols) + "x" +
+                       std::to_string(image_.rows);
+        return true;
+    }
+
+    cv::Size size() const override { return image_.size(); }
+
+    bool readTile(const cv::Rect& region, cv::Size outSize, cv::Mat& dst) override
+    {
+        const cv::Rect clipped = region & cv::Rect(cv::Point(), image_.size());
+        composeTile(clipped.empty() ? cv::Mat() : image_(clipped), -1,
+                    region, clipped, outSize, canvas_, dst);
+        return true;
+    }
+
+    std::string description() const override { return description_; }
+
+private:
+    cv::Mat     image_;
+    cv::Mat     canvas_;
+    std::string description_;
+};
+
+// =============================================================================
+// SlideReader::open
+// =============================================================================
+std::unique_ptr<SlideReader> SlideReader::open(const std::string& path)
+{
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (ext == ".ppm" || ext == ".pnm") {
+        auto reader = std::make_unique<MappedPpmReader>();
+        if (reader->open(path)) return reader;
+        return nullptr;
+    }
+#ifdef USE_OPENSLIDE
+    if (openslide_detect_vendor(path.c_str())) {
+        auto reader = std::make_unique<OpenSlideReader>();
+        if (reader->open(path)) return reader;
+        return nullptr;
+    }
+#endif
+    auto reader = std::make_unique<ImageReader>();
+    if (!reader->open(path)) return nullptr;
+    std::cerr << "[SlideReader] " << path << " is decoded whole; convert large slides to"
+              << " PPM (vips copy in.svs out.ppm) or build with OpenSlide\n";
+    return reader;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file    SlideScorer.cpp
+ * @brief   Decode / preprocess / inference pipeline over a slide's tiles.
+ *
+ * @author  Krushna Sanjay Sharma
+ * @date    March 2026
+ */
+
+#include "SlideScorer.h"
+#include "BoundedQueue.h"
+#include <cvcore/chromaticity.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+// ImageNet statistics, RGB order — PatchTransforms.MEAN / STD
+static const float kMean[3] = {0.485f, 0.456f, 0.406f};
+static const float kStd[3]  = {0.229f, 0.224f, 0.225f};
+
+static double elapsedMs(int64 since)
+{
+    return (cv::getTickCount() - since) * 1000.0 / cv::getTickFrequency();
+}
+
+// =============================================================================
+// SlideScorer
+// =============================================================================
+SlideScorer::SlideScorer(const std::string& modelPath, const cvcore::InferenceOptions& inference,
+                         const SlideScoreOptions& options)
+    : session_(modelPath, inference), options_(options)
+{
+    options_.tileSize   = std::max(1, options_.tileSize);
+    options_.downsample = std::max(1, options_.downsample);
+    options_.batchSize  = std::max(1, options_.batchSize);
+    options_.thumbCell  = std::max(1, options_.thumbCell);
+
+    for (int c = 0; c < 3; c++)
+        for (int v = 0; v < 256; v++)
+            lut_[c][v] = (v / 255.f - kMean[c]) / kStd[c];
+
+    // Provider setup (and, for a fixed-batch export, the batch check) now
+    const int64_t S = options_.tileSize;
+    if (options_.batchSize > 1 && session_.warmup({options_.batchSize, 3, S, S}) < 0) {
+        std::cerr << "[SlideScorer] Model rejected a batch of " << options_.batchSize
+                  << "; scoring one tile per run\n";
+        singleOnly_ = true;
+    }
+    if (singleOnly_ || options_.batchSize == 1) session_.warmup({1, 3, S, S});
+}
+
+// -----------------------------------------------------------------------------
+bool SlideScorer::isTissue(const cv::Mat& tile) const
+{
+    // Serial count: the pipeline stages already occupy their own threads
+    const std::vector<uint32_t> counts = cvcore::countRgChromaticity(tile, TISSUE_BINS, false);
+    return cvcore::chromaticFraction(counts, TISSUE_BINS, options_.minChroma) >= options_.minTissue;
+}
+
+// -----------------------------------------------------------------------------
+void SlideScorer::normalise(const cv::Mat& tile, float* dst) const
+{
+    const int plane = options_.tileSize * options_.tileSize;
+    float* r = dst;
+    float* g = dst + plane;
+    float* b = dst + 2 * plane;
+    for (int y = 0; y < tile.rows; y++) {
+        const uchar* p = tile.ptr<uchar>(y);
+        for (int x = 0; x < tile.cols; x++, p += 3) {
+            *b++ = lut_[2][p[0]];
+            *g++ = lut_[1][p[1]];
+            *r++ = lut_[0][p[2]];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+float SlideScorer::cancerProbability(const float* logits, int classes)
+{
+    float top = logits[0];
+    for (int c = 1; c < classes; c++) top = std::max(top, logits[c]);
+    float sum = 0.f;
+    for (int c = 0; c < classes; c++) sum += std::exp(logits[c] - top);
+    return std::exp(logits[CANCER_CLASS] - top) / sum;
+}
+
+// -----------------------------------------------------------------------------
+bool SlideScorer::infer(Batch& batch, cv::Mat& heatmap)
+{
+    const int64_t S      = options_.tileSize;
+    const size_t  sample = static_cast<size_t>(3 * S * S);
+    const int     n      = static_cast<int>(batch.indices.size());
+    float*        cells  = heatmap.ptr<float>();
+
+    auto scatter = [&](int first, int count) {
+        const std::vector<int64_t>& shape = session_.outputShape();
+        const int classes = shape.empty() ? 0 : static_cast<int>(shape.back());
+        if (classes <= CANCER_CLASS ||
+            session_.outputSize() != static_cast<size_t>(count) * classes)
+            return false;
+        for (int i = 0; i < count; i++)
+            cells[batch.indices[first + i]] =
+                cancerProbability(session_.output() + static_cast<size_t>(i) * classes, classes);
+        return true;
+    };
+
+    if (!singleOnly_ && n > 1) {
+        float* input = session_.input({n, 3, S, S});
+        std::memcpy(input, batch.data.data(), n * sample * sizeof(float));
+        if (session_.run()) return scatter(0, n);
+
+        std::cerr << "[SlideScorer] Batch of " << n << " failed; scoring one tile per run\n";
+        singleOnly_ = true;
+    }
+    for (int i = 0; i < n; i++) {
+        float* input = session_.input({1, 3, S, S});
+        std::memcpy(input, batch.data.data() + i * sample, sample * sizeof(float));
+        if (!session_.run() || !scatter(i, 1)) return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+SlideScore SlideScorer::score(SlideReader& reader)
+{
+    const int64    t0     = cv::getTickCount();
+    const int      S      = options_.tileSize;
+    const int      span   = S * options_.downsample;
+    const int      cell   = options_.thumbCell;
+    const cv::Size slide  = reader.size();
+    const int      cols   = (slide.width + span - 1) / span;
+    const int      rows   = (slide.height + span - 1) / span;
+    const int      total  = rows * cols;
+    const size_t   sample = static_cast<size_t>(3) * S * S;
+
+    SlideScore result;
+    result.heatmap   = cv::Mat(rows, cols, CV_32F, cv::Scalar(std::numeric_limits<float>::quiet_NaN()));
+    result.thumbnail = cv::Mat(rows * cell, cols * cell, CV_8UC3, cv::Scalar::all(255));
+    if (total == 0) {
+        result.complete = true;
+        return result;
+    }
+
+    // Recycled buffers: tiles between decode and preprocess, batches between
+    // preprocess and inference
+    const int           poolTiles = 2 * options_.batchSize;
+    BoundedQueue<Tile>  freeTiles(poolTiles), tiles(poolTiles);
+    BoundedQueue<Batch> freeBatches(BATCHES_IN_FLIGHT), batches(BATCHES_IN_FLIGHT);
+    for (int i = 0; i < poolTiles; i++) freeTiles.push(Tile());
+    for (int i = 0; i < BATCHES_IN_FLIGHT; i++) {
+        Batch batch;
+        batch.data.resize(options_.batchSize * sample);
+        batch.indices.reserve(options_.batchSize);
+        freeBatches.push(std::move(batch));
+    }
+
+    std::atomic<bool> failed{false};
+
+    // Decode: raster order, so consecutive reads share mapped pages / slide tiles
+    std::thread decoder([&] {
+        Tile tile;
+        for (int index = 0; index < total && freeTiles.pop(tile); index++) {
+            const int64 t = cv::getTickCount();
+            const cv::Rect region((index % cols) * span, (index / cols) * span, span, span);
+            if (!reader.readTile(region, cv::Size(S, S), tile.image)) {
+                std::cerr << "[SlideScorer] Cannot read tile at " << region.x << ","
+                          << region.y << "\n";
+                failed = true;
+                break;
+            }
+            tile.index = index;
+            result.decodeMs += elapsedMs(t);
+            if (!tiles.push(std::move(tile))) break;
+        }
+        tiles.close();
+    });
+
+    // Preprocess: thumbnail cell, tissue test, normalise into the open batch
+    std::thread preprocessor([&] {
+        Batch batch;
+        bool  open = freeBatches.pop(batch);
+        Tile  tile;
+        while (open && tiles.pop(tile)) {
+            const int64 t = cv::getTickCount();
+            const int   x = tile.index % cols, y = tile.index / cols;
+            cv::Mat thumb = result.thumbnail(cv::Rect(x * cell, y * cell, cell, cell));
+            cv::resize(tile.image, thumb, thumb.size(), 0, 0, cv::INTER_AREA);
+
+            if (isTissue(tile.image)) {
+                normalise(tile.image, batch.data.data() + batch.indices.size() * sample);
+                batch.indices.push_back(tile.index);
+            }
+            result.tiles++;
+            freeTiles.push(std::move(tile));
+            result.preprocessMs += elapsedMs(t);
+
+            if (static_cast<int>(batch.indices.size()) == options_.batchSize) {
+                if (!batches.push(std::move(batch))) break;
+                open = freeBatches.pop(batch);
+                batch.indices.clear();
+            }
+        }
+        if (open && !batch.indices.empty()) batches.push(std::move(batch));
+        batches.close();
+    });
+
+    // Inference on this thread
+    Batch batch;
+    while (batches.pop(batch)) {
+        const int64 t = cv::getTickCount();
+        if (!infer(batch, result.heatmap)) {
+            std::cerr << "[SlideScorer] Inference failed\n";
+            failed = true;
+            break;
+        }
+        result.inferenceMs += elapsedMs(t);
+        result.tissueTiles += static_cast<long long>(batch.indices.size());
+        result.batches++;
+        batch.indices.clear();
+        freeBatches.push(std::move(batch));
+    }
+
+    // On failure every queue is closed so the other stages drain and stop
+    if (failed) {
+        tiles.close();
+        batches.close();
+        freeTiles.close();
+        freeBatches.close();
+    }
+    decoder.join();
+    preprocessor.join();
+
+    result.complete = !failed && result.tiles == total;
+    result.wallMs   = elapsedMs(t0);
+    return result;
+}
@@ -0,0 +1,89 @@
+"""
+Author: Krushna Sanjay Sharma
+Description: Utility script exporting the trained transfer models to ONNX for the
+native whole-slide engine (native/slideHeatmap).
+
+Each model is rebuilt with its training architecture, loaded through ModelIO and
+traced with a (1, 3, 224, 224) ImageNet-normalised input. The batch dimension is
+left dynamic so the engine can score tissue tiles in batches; the output stays the
+raw (N, 2) logits ("normal", "cancerous").
+
+Usage (run from project root):
+    python -m src.utils.export_onnx                      # every trained model
+    python -m src.utils.export_onnx --model resnet vit
+"""
+
+import os
+import argparse
+import torch
+
+from src.data.patch_transforms import PatchTransforms
+from src.network.vit_transfer import PretrainedViT
+from src.network.resnet_transfer import PretrainedResNet
+from src.network.densenet_transfer import PretrainedDenseNet
+from src.network.gabor_resnet import GaborResNet
+from src.utils.model_io import ModelIO
+
+ONNX_OPSET = 17
+
+# name -> (constructor, trained weights, ONNX export)
+MODELS = {
+    "resnet":       (lambda: PretrainedResNet(num_classes=2),
+                     "models/resnet_transfer.pth", "models/resnet_transfer.onnx"),
+    "vit":          (lambda: PretrainedViT(num_classes=2),
+                     "models/vit_transfer.pth", "models/vit_transfer.onnx"),
+    "gabor_resnet": (lambda: GaborResNet(num_classes=2, num_filters=64, kernel_size=7),
+                     "models/gabor_resnet.pth", "models/gabor_resnet.onnx"),
+    "densenet":     (lambda: PretrainedDenseNet(num_classes=2),
+                     "models/densenet_transfer.pth", "models/densenet_transfer.onnx"),
+}
+
+
+def export_model(name: str) -> str:
+    """
+    Loads one trained model on the CPU and writes its ONNX export.
+
+    Args:
+        name (str): Key of MODELS.
+
+    Returns:
+        str: Path of the written .onnx file.
+    """
+    build, weights, onnx_path = MODELS[name]
+    model = build()
+    ModelIO.load_checkpoint(model, weights, torch.device("cpu"))
+    model.eval()
+
+    size = PatchTransforms.PATCH_SIZE
+    dummy = torch.zeros(1, 3, size, size)
+    torch.onnx.export(
+        model,
+        dummy,
+        onnx_path,
+        input_names=["input"],
+        output_names=["logits"],
+        dynamic_axes={"input": {0: "batch"}, "logits": {0: "batch"}},
+        opset_version=ONNX_OPSET,
+    )
+    print(f"Exported {weights} -> {onnx_path}")
+    return onnx_path
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(
+        description="Export the trained transfer models to ONNX for the whole-slide engine."
+    )
+    parser.add_argument("--model", nargs="+", choices=list(MODELS), default=list(MODELS),
+                        help="Model(s) to export (default: every trained model).")
+    args = parser.parse_args()
+
+    for name in args.model:
+        weights = MODELS[name][1]
+        if not os.path.exists(weights):
+            print(f"[WARNING] {weights} not found! Skipping {name}.")
+            continue
+        export_model(name)
+
+
+if __name__ == "__main__":
+    main()
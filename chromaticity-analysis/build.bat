@@ -56,6 +56,9 @@ echo.
 echo Usage:
 echo    cd ..\bin\Release
 echo    chromaticity_analysis.exe ..\..\data\shadow.jpg
+echo    chromaticity_analysis.exe --batch ..\..\data\frames [outputDir]
+echo    chromaticity_analysis.exe --batch ..\..\data\frames [outputDir] --gpu
+echo    chromaticity_analysis.exe --stream ..\..\data\scan.tif [output.tif]
 echo.
 
 cd ..
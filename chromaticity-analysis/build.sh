@@ -39,4 +39,7 @@ echo
 echo "Usage:"
 echo "   cd ../bin"
 echo "   ./chromaticity_analysis ../data/shadow.jpg"
+echo "   ./chromaticity_analysis --batch ../data/frames [outputDir]"
+echo "   ./chromaticity_analysis --batch ../data/frames [outputDir] --gpu"
+echo "   ./chromaticity_analysis --stream ../data/scan.tif [output.tif]"
 echo
@@ -7,49 +7,66 @@
   2. Generates an rg chromaticity 2D histogram
   3. Creates a chromaticity visualization of the original image
      (all pixels at same intensity, shadows should disappear)
+
+  Steps 2 and 3 share one pass over the image (computeChromaticity).
+
+  Batch mode (--batch <directory | list.txt> [output directory]) does 2 and 3
+  headless for every image, in parallel, writes <name>_histogram.png and
+  <name>_chromaticity.png, plus the aggregated dataset histogram as
+  dataset_histogram.bin (binary matrix) and dataset_histogram.png, and
+  reports throughput in images per second.
+
+  With --gpu the batch histograms are counted on the OpenCL device
+  (cvcore::OclChromaticityCounter): the next image is decoded and uploaded
+  while the current one is counted, and only the counts come back, so the
+  per-image chromaticity images are not written.
+
+  Streamed mode (--stream <image> [output.tif | output.ppm]) is for scans too
+  large to decode whole: the image is read in strips of rows (stripIO.hpp),
+  each strip is counted and converted by computeChromaticity, and the
+  chromaticity image is written strip by strip, as a tiled TIFF when built
+  with libtiff. Memory is a few strips whatever the image height.
 */
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include <cvcore/chromaticity.hpp>
+#include <cvcore/histogram.hpp>
+#include "stripIO.hpp"
+
+// Function to normalize bin counts into the float histogram
+cv::Mat normalizeHistogram(const std::vector<uint32_t>& counts, int histsize, double pixels) {
+    cv::Mat hist;
+    cv::Mat(histsize, histsize, CV_32SC1, (void*)counts.data())
+        .convertTo(hist, CV_32FC1, 1.0 / pixels);
+    return hist;
+}
 
 // Function to create rg chromaticity histogram
+// Counting is cvcore::countRgChromaticity (integer sub-histograms per row
+// stripe); the largest bucket is found and the float normalisation applied
+// once, after counting.
 cv::Mat createChromaticityHistogram(const cv::Mat& src, int histsize = 256) {
-    cv::Mat hist = cv::Mat::zeros(cv::Size(histsize, histsize), CV_32FC1);
-    float max = 0;
-
-    // Loop over all pixels
-    for (int i = 0; i < src.rows; i++) {
-        const cv::Vec3b* ptr = src.ptr<cv::Vec3b>(i);
-        for (int j = 0; j < src.cols; j++) {
-            float B = ptr[j][0];
-            float G = ptr[j][1];
-            float R = ptr[j][2];
-
-            // Compute the r,g chromaticity
-            float divisor = R + G + B;
-            divisor = divisor > 0.0 ? divisor : 1.0;
-            float r = R / divisor;
-            float g = G / divisor;
-
-            // Compute indexes
-            int rindex = (int)(r * (histsize - 1) + 0.5);
-            int gindex = (int)(g * (histsize - 1) + 0.5);
+    std::vector<uint32_t> counts = cvcore::countRgChromaticity(src, histsize);
 
-            // Increment the histogram
-            hist.at<float>(rindex, gindex)++;
-            float newvalue = hist.at<float>(rindex, gindex);
-            max = newvalue > max ? newvalue : max;
-        }
-    }
+    int max = *std::max_element(counts.begin(), counts.end());
+    printf("Histogram: Largest bucket has %d pixels\n", max);
 
-    printf("Histogram: Largest bucket has %d pixels\n", (int)max);
-    
     // Normalize by number of pixels
-    hist /= (src.rows * src.cols);
-    
-    return hist;
+    return normalizeHistogram(counts, histsize, (double)src.rows * src.cols);
 }
 
 // Function to visualize the histogram
@@ -113,6 +130,340 @@ cv::Mat createChromaticityImage(const cv::Mat& src, float intensity = 200.0f) {
     return dst;
 }
 
+// Function to compute the chromaticity image and the histogram counts in one
+// sweep (the standard use case — same results as createChromaticityImage
+// and cvcore::countRgChromaticity, with half the passes over the image).
+//
+// R+G+B is formed once per pixel and indexes two reciprocal tables:
+// binScale = (histsize - 1) / sum for the bins and pixScale = intensity / sum
+// for the output. Each row is done in two loops: a branch-free arithmetic
+// loop that writes the output pixels and the bin index per pixel into a
+// row buffer (vectorisable), then a scatter loop that counts the indexes.
+// Row bands run in parallel with their own integer sub-histograms.
+void computeChromaticity(const cv::Mat& src, int histsize, float intensity,
+                         std::vector<uint32_t>& counts, cv::Mat& dst, bool parallel = true) {
+    float binScale[766], pixScale[766];
+    binScale[0] = (float)(histsize - 1);
+    pixScale[0] = intensity;
+    for (int sum = 1; sum < 766; sum++) {
+        binScale[sum] = (float)(histsize - 1) / sum;
+        pixScale[sum] = intensity / sum;
+    }
+
+    dst.create(src.size(), CV_8UC3);
+    const int minRows = parallel ? 1 : std::max(1, src.rows);
+    counts = cvcore::parallelHistogram(src.rows, histsize * histsize,
+                                       [&](const cv::Range& range, uint32_t* bins) {
+        std::vector<int> index(src.cols);
+        for (int i = range.start; i < range.end; i++) {
+            const uchar* srcPtr = src.ptr<uchar>(i);
+            uchar* dstPtr = dst.ptr<uchar>(i);
+            int* idx = index.data();
+
+            for (int j = 0; j < src.cols; j++) {
+                const int B = srcPtr[3 * j];
+                const int G = srcPtr[3 * j + 1];
+                const int R = srcPtr[3 * j + 2];
+                const int sum = R + G + B;
+
+                // Bin index from the r,g chromaticity
+                const float k = binScale[sum];
+                idx[j] = (int)(R * k + 0.5f) * histsize + (int)(G * k + 0.5f);
+
+                // Output pixel at constant intensity, b = 1 - r - g
+                const float p = pixScale[sum];
+                const float r = R * p;
+                const float g = G * p;
+                dstPtr[3 * j] = cv::saturate_cast<uchar>(intensity - r - g);
+                dstPtr[3 * j + 1] = cv::saturate_cast<uchar>(g);
+                dstPtr[3 * j + 2] = cv::saturate_cast<uchar>(r);
+            }
+
+            for (int j = 0; j < src.cols; j++) {
+                bins[idx[j]]++;
+            }
+        }
+    }, minRows);
+}
+
+// Function to list the images of a batch: every image file in a directory
+// (sorted by name), or one path per line of a text file list
+std::vector<std::string> listBatchImages(const std::string& input) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+
+    if (fs::is_directory(input)) {
+        for (const auto& entry : fs::directory_iterator(input)) {
+            if (!entry.is_regular_file()) continue;
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(),
+                           [](unsigned char c) { return (char)std::tolower(c); });
+            if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" ||
+                ext == ".bmp" || ext == ".tif" || ext == ".tiff") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        std::ifstream list(input);
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) files.push_back(line);
+        }
+    }
+    return files;
+}
+
+// Function to write the dataset histogram as a binary matrix:
+// int32 rows, int32 cols, int32 OpenCV type (CV_64FC1), then rows*cols
+// doubles in row-major order (fraction of all pixels in the batch)
+bool writeBinaryMatrix(const std::string& path, const cv::Mat& m) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    const int32_t header[3] = { m.rows, m.cols, m.type() };
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (int i = 0; i < m.rows; i++) {
+        out.write(reinterpret_cast<const char*>(m.ptr(i)), m.cols * m.elemSize());
+    }
+    return (bool)out;
+}
+
+// Function to count the batch on the OpenCL device
+// One image is in flight on the device while the next is decoded (on a
+// worker thread) and uploaded into the other counter slot; its counts are
+// then read back and the next kernel launched. Returns false, before
+// touching any image, when no OpenCL device is usable.
+bool countBatchGpu(const std::vector<std::string>& files, const std::string& outDir, int histsize,
+                   std::vector<int64_t>& datasetCounts, int64_t& datasetPixels, int& processed,
+                   std::vector<std::string>& failed) {
+    cvcore::OclChromaticityCounter counter(histsize);
+    if (!counter.available()) {
+        return false;
+    }
+    std::cout << "GPU: " << cv::ocl::Device::getDefault().name()
+              << (counter.usesLocalMemory() ? " (local sub-histograms)" : " (global atomics)")
+              << std::endl;
+
+    auto decode = [&files](int f) {
+        return std::async(std::launch::async, [&files, f] { return cv::imread(files[f]); });
+    };
+
+    std::vector<uint32_t> counts;
+    auto finish = [&](int f, int slot, int64_t pixels) {
+        if (!counter.download(slot, counts)) {
+            failed.push_back(files[f]);
+            return;
+        }
+        for (int b = 0; b < histsize * histsize; b++) {
+            datasetCounts[b] += counts[b];
+        }
+        datasetPixels += pixels;
+
+        const std::string stem = std::filesystem::path(files[f]).stem().string();
+        const std::filesystem::path base = std::filesystem::path(outDir) / stem;
+        cv::Mat hist = normalizeHistogram(counts, histsize, (double)pixels);
+        cv::imwrite(base.string() + "_histogram.png", visualizeHistogram(hist));
+        processed++;
+    };
+
+    int pending = -1, pendingSlot = 0, slot = 0;
+    int64_t pendingPixels = 0;
+    std::future<cv::Mat> next = decode(0);
+    for (int f = 0; f < (int)files.size(); f++) {
+        cv::Mat src = next.get();
+        if (f + 1 < (int)files.size()) {
+            next = decode(f + 1);
+        }
+        if (src.empty() || !counter.upload(slot, src)) {
+            failed.push_back(files[f]);
+            continue;
+        }
+
+        // The upload above overlapped the pending kernel; collect it, then
+        // start this image
+        if (pending >= 0) {
+            finish(pending, pendingSlot, pendingPixels);
+        }
+        pending = -1;
+        if (!counter.launch(slot)) {
+            failed.push_back(files[f]);
+            continue;
+        }
+        pending = f;
+        pendingSlot = slot;
+        pendingPixels = (int64_t)src.rows * src.cols;
+        slot ^= 1;
+    }
+    if (pending >= 0) {
+        finish(pending, pendingSlot, pendingPixels);
+    }
+    return true;
+}
+
+// Function to run the headless batch mode
+// Images are processed in parallel, one image per task (the histogram kernel
+// itself then runs single-threaded). Each task block keeps its own 64-bit
+// dataset counts, merged once per block. With gpu the counting runs on the
+// OpenCL device instead (countBatchGpu), falling back to the CPU when none
+// is available.
+int runBatch(const std::string& input, const std::string& outDir, bool gpu, int histsize = 256) {
+    std::vector<std::string> files = listBatchImages(input);
+    if (files.empty()) {
+        std::cout << "Error: No images found in " << input << std::endl;
+        return -2;
+    }
+    std::filesystem::create_directories(outDir);
+    std::cout << "Batch: " << files.size() << " images -> " << outDir << std::endl;
+
+    std::vector<int64_t> datasetCounts(histsize * histsize, 0);
+    int64_t datasetPixels = 0;
+    int processed = 0;
+    std::vector<std::string> failed;
+    std::mutex mergeMutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (gpu && !countBatchGpu(files, outDir, histsize, datasetCounts, datasetPixels,
+                              processed, failed)) {
+        std::cout << "Warning: No OpenCL device available, counting on the CPU" << std::endl;
+        gpu = false;
+    }
+    if (!gpu) {
+        cv::parallel_for_(cv::Range(0, (int)files.size()), [&](const cv::Range& range) {
+            std::vector<int64_t> localCounts(histsize * histsize, 0);
+            int64_t localPixels = 0;
+            int localProcessed = 0;
+            std::vector<std::string> localFailed;
+
+            for (int f = range.start; f < range.end; f++) {
+                cv::Mat src = cv::imread(files[f]);
+                if (src.empty()) {
+                    localFailed.push_back(files[f]);
+                    continue;
+                }
+
+                std::vector<uint32_t> counts;
+                cv::Mat chromaImage;
+                computeChromaticity(src, histsize, 200.0f, counts, chromaImage, false);
+                for (int b = 0; b < histsize * histsize; b++) {
+                    localCounts[b] += counts[b];
+                }
+                localPixels += (int64_t)src.rows * src.cols;
+
+                const std::string stem = std::filesystem::path(files[f]).stem().string();
+                const std::filesystem::path base = std::filesystem::path(outDir) / stem;
+                cv::Mat hist = normalizeHistogram(counts, histsize, (double)src.rows * src.cols);
+                cv::imwrite(base.string() + "_histogram.png", visualizeHistogram(hist));
+                cv::imwrite(base.string() + "_chromaticity.png", chromaImage);
+                localProcessed++;
+            }
+
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            for (int b = 0; b < histsize * histsize; b++) {
+                datasetCounts[b] += localCounts[b];
+            }
+            datasetPixels += localPixels;
+            processed += localProcessed;
+            failed.insert(failed.end(), localFailed.begin(), localFailed.end());
+        });
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const auto& name : failed) {
+        std::cout << "Warning: Unable to read file " << name << std::endl;
+    }
+
+    // Aggregated dataset histogram
+    cv::Mat dataset(histsize, histsize, CV_64FC1);
+    for (int b = 0; b < histsize * histsize; b++) {
+        dataset.at<double>(b / histsize, b % histsize) =
+            datasetPixels > 0 ? (double)datasetCounts[b] / datasetPixels : 0.0;
+    }
+    const std::string binPath = (std::filesystem::path(outDir) / "dataset_histogram.bin").string();
+    const std::string pngPath = (std::filesystem::path(outDir) / "dataset_histogram.png").string();
+    if (writeBinaryMatrix(binPath, dataset)) {
+        std::cout << "Saved: " << binPath << std::endl;
+    }
+    cv::Mat datasetFloat;
+    dataset.convertTo(datasetFloat, CV_32FC1);
+    cv::imwrite(pngPath, visualizeHistogram(datasetFloat));
+    std::cout << "Saved: " << pngPath << std::endl;
+
+    printf("Processed %d images (%d failed) in %.2f s: %.1f images/s\n",
+           processed, (int)failed.size(), seconds, seconds > 0 ? processed / seconds : 0.0);
+    return processed > 0 ? 0 : -2;
+}
+
+// Function to run the streamed mode
+// Strips of STREAM_ROWS rows are read, counted into 64-bit totals and their
+// chromaticity rows written before the next strip is read. Writes the image
+// histogram next to the output as <output>_histogram.png and .bin.
+int runStream(const std::string& input, const std::string& output, int histsize = 256) {
+    const int STREAM_ROWS = 256;
+
+    std::unique_ptr<StripReader> reader = StripReader::open(input);
+    if (!reader) {
+        std::cout << "Error: Unable to read file " << input << std::endl;
+        return -2;
+    }
+    const cv::Size size = reader->size();
+    std::cout << "Streaming " << input << ": " << size.width << " x " << size.height
+              << " pixels (" << reader->description() << ")" << std::endl;
+
+    std::unique_ptr<StripWriter> writer = StripWriter::create(output, size);
+    if (!writer) {
+        std::cout << "Error: Unable to write " << output << std::endl;
+        return -2;
+    }
+
+    std::vector<int64_t> totals(histsize * histsize, 0);
+    std::vector<uint32_t> counts;
+    cv::Mat strip, chromaStrip;
+    int rows = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (reader->read(STREAM_ROWS, strip) && !strip.empty()) {
+        computeChromaticity(strip, histsize, 200.0f, counts, chromaStrip);
+        for (int b = 0; b < histsize * histsize; b++) {
+            totals[b] += counts[b];
+        }
+        if (!writer->write(chromaStrip)) {
+            std::cout << "Error: Writing " << output << " failed" << std::endl;
+            return -2;
+        }
+        rows += strip.rows;
+    }
+    if (!writer->close() || rows != size.height) {
+        std::cout << "Error: Stopped after " << rows << " of " << size.height << " rows" << std::endl;
+        return -2;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Saved: " << output << std::endl;
+
+    const double pixels = (double)size.width * size.height;
+    printf("Histogram: Largest bucket has %lld pixels\n",
+           (long long)*std::max_element(totals.begin(), totals.end()));
+    cv::Mat hist(histsize, histsize, CV_64FC1);
+    for (int b = 0; b < histsize * histsize; b++) {
+        hist.at<double>(b / histsize, b % histsize) = totals[b] / pixels;
+    }
+    const std::filesystem::path out(output);
+    const std::string base = (out.parent_path() / out.stem()).string();
+    if (writeBinaryMatrix(base + "_histogram.bin", hist)) {
+        std::cout << "Saved: " << base << "_histogram.bin" << std::endl;
+    }
+    cv::Mat histFloat;
+    hist.convertTo(histFloat, CV_32FC1);
+    cv::imwrite(base + "_histogram.png", visualizeHistogram(histFloat));
+    std::cout << "Saved: " << base << "_histogram.png" << std::endl;
+
+    printf("Streamed %d rows in %.2f s: %.1f Mpixels/s\n",
+           rows, seconds, seconds > 0 ? pixels / seconds / 1e6 : 0.0);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     cv::Mat src;
     std::string filename;
@@ -120,8 +471,39 @@ int main(int argc, char* argv[]) {
     // Check arguments
     if (argc < 2) {
         std::cout << "Usage: " << argv[0] << " <image filename>" << std::endl;
+        std::cout << "       " << argv[0] << " --batch <directory | list.txt> [output directory] [--gpu]" << std::endl;
+        std::cout << "       " << argv[0] << " --stream <image> [output.tif | output.ppm]" << std::endl;
         return -1;
     }
+
+    // Streamed mode for images too large to decode whole
+    if (std::strcmp(argv[1], "--stream") == 0) {
+        if (argc < 3) {
+            std::cout << "Usage: " << argv[0] << " --stream <image> [output.tif | output.ppm]" << std::endl;
+            return -1;
+        }
+#ifdef USE_LIBTIFF
+        const char* defaultOutput = "chromaticity_image.tif";
+#else
+        const char* defaultOutput = "chromaticity_image.ppm";
+#endif
+        return runStream(argv[2], argc >= 4 ? argv[3] : defaultOutput);
+    }
+
+    // Headless batch mode
+    if (std::strcmp(argv[1], "--batch") == 0) {
+        if (argc < 3) {
+            std::cout << "Usage: " << argv[0] << " --batch <directory | list.txt> [output directory] [--gpu]" << std::endl;
+            return -1;
+        }
+        std::string outDir = "chromaticity_batch";
+        bool gpu = false;
+        for (int i = 3; i < argc; i++) {
+            if (std::strcmp(argv[i], "--gpu") == 0) gpu = true;
+            else outDir = argv[i];
+        }
+        return runBatch(argv[2], outDir, gpu);
+    }
     
     filename = argv[1];
     
@@ -134,17 +516,20 @@ int main(int argc, char* argv[]) {
     
     std::cout << "Image loaded: " << src.cols << " x " << src.rows << " pixels" << std::endl;
     
-    // 1. Create chromaticity histogram
-    std::cout << "\nCreating rg chromaticity histogram..." << std::endl;
-    cv::Mat hist = createChromaticityHistogram(src);
+    // 1 + 3. Create chromaticity histogram and chromaticity image
+    //        (constant intensity = 200) in one pass
+    std::cout << "\nCreating rg chromaticity histogram and chromaticity image..." << std::endl;
+    const int histsize = 256;
+    std::vector<uint32_t> counts;
+    cv::Mat chromaImage;
+    computeChromaticity(src, histsize, 200.0f, counts, chromaImage);
+    printf("Histogram: Largest bucket has %d pixels\n",
+           *std::max_element(counts.begin(), counts.end()));
+    cv::Mat hist = normalizeHistogram(counts, histsize, (double)src.rows * src.cols);
     
     // 2. Visualize the histogram
     cv::Mat histVis = visualizeHistogram(hist);
     
-    // 3. Create chromaticity image (constant intensity = 200)
-    std::cout << "Creating chromaticity visualization image..." << std::endl;
-    cv::Mat chromaImage = createChromaticityImage(src, 200.0f);
-    
     // Resize images for display if they're too large
     cv::Mat srcDisplay, chromaDisplay;
     double scale = 1.0;
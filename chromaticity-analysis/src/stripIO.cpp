@@ -0,0 +1,452 @@
+/*
+  Strip readers and writers for the streamed mode (see stripIO.hpp)
+*/
+
+#include "stripIO.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <cvcore/mappedFile.hpp>
+
+#ifdef USE_LIBTIFF
+#include <tiffio.h>
+#endif
+#ifdef USE_LIBJPEG
+#include <csetjmp>
+#include <jpeglib.h>
+#endif
+
+// Function to convert one row of 8-bit grey, RGB or RGBA samples to BGR
+static void rowToBgr(const uchar* src, int samples, int width, uchar* dst) {
+    for (int x = 0; x < width; x++, src += samples, dst += 3) {
+        if (samples < 3) {
+            dst[0] = dst[1] = dst[2] = src[0];
+        } else {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+}
+
+// Function to get the lower-case extension of a path
+static std::string lowerExtension(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    return ext;
+}
+
+// =============================================================================
+// Readers
+// =============================================================================
+
+// Binary PPM (P6, maxval 255), memory-mapped: a strip touches only its pages
+class PpmStripReader : public StripReader {
+public:
+    bool open(const std::string& path) {
+        if (!file_.open(path)) return false;
+
+        // "P6" <ws> width <ws> height <ws> maxval <single ws> pixels; '#' comments
+        const char* p = file_.data();
+        const char* end = p + file_.size();
+        auto skip = [&] {
+            while (p < end && (std::isspace((unsigned char)*p) || *p == '#')) {
+                if (*p == '#') while (p < end && *p != '\n') p++;
+                else p++;
+            }
+        };
+        auto number = [&](long long& value) {
+            skip();
+            if (p >= end || !std::isdigit((unsigned char)*p)) return false;
+            value = 0;
+            while (p < end && std::isdigit((unsigned char)*p)) value = value * 10 + (*p++ - '0');
+            return true;
+        };
+
+        long long width = 0, height = 0, maxval = 0;
+        if (file_.size() < 2 || p[0] != 'P' || p[1] != '6') return false;
+        p += 2;
+        if (!number(width) || !number(height) || !number(maxval) || p >= end) return false;
+        p++;
+
+        if (maxval != 255 || width <= 0 || height <= 0 || width > INT32_MAX / 3 || height > INT32_MAX ||
+            (unsigned long long)(end - p) < (unsigned long long)width * height * 3) {
+            std::cout << "Error: " << path << " is not an 8-bit binary PPM" << std::endl;
+            return false;
+        }
+        image_ = cv::Mat((int)height, (int)width, CV_8UC3, const_cast<char*>(p));
+        return true;
+    }
+
+    cv::Size size() const override { return image_.size(); }
+
+    bool read(int rows, cv::Mat& strip) override {
+        const int n = std::min(rows, image_.rows - row_);
+        if (n <= 0) {
+            strip.release();
+            return true;
+        }
+        cv::cvtColor(image_.rowRange(row_, row_ + n), strip, cv::COLOR_RGB2BGR);
+        row_ += n;
+        return true;
+    }
+
+    std::string description() const override { return "mapped PPM"; }
+
+private:
+    cvcore::MappedFile file_;
+    cv::Mat image_;   // RGB view of the mapping
+    int row_ = 0;
+};
+
+#ifdef USE_LIBTIFF
+// 8-bit grey / RGB / RGBA TIFF, contiguous samples, striped or tiled
+class TiffStripReader : public StripReader {
+public:
+    ~TiffStripReader() override {
+        if (tif_) TIFFClose(tif_);
+    }
+
+    bool open(const std::string& path) {
+        tif_ = TIFFOpen(path.c_str(), "r");
+        if (!tif_) return false;
+
+        uint32_t width = 0, height = 0;
+        uint16_t samples = 1, bits = 8, planar = PLANARCONFIG_CONTIG, photometric = 0;
+        TIFFGetField(tif_, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tif_, TIFFTAG_IMAGELENGTH, &height);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_SAMPLESPERPIXEL, &samples);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_BITSPERSAMPLE, &bits);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_PLANARCONFIG, &planar);
+        TIFFGetField(tif_, TIFFTAG_PHOTOMETRIC, &photometric);
+
+        const bool grey = samples == 1 && photometric == PHOTOMETRIC_MINISBLACK;
+        const bool rgb = (samples == 3 || samples == 4) && photometric == PHOTOMETRIC_RGB;
+        if (bits != 8 || planar != PLANARCONFIG_CONTIG || !(grey || rgb) ||
+            width == 0 || height == 0 || width > INT32_MAX / 4 || height > INT32_MAX) {
+            return false;
+        }
+        size_ = cv::Size((int)width, (int)height);
+        samples_ = samples;
+
+        if (TIFFIsTiled(tif_)) {
+            TIFFGetField(tif_, TIFFTAG_TILEWIDTH, &tileWidth_);
+            TIFFGetField(tif_, TIFFTAG_TILELENGTH, &tileHeight_);
+            if (tileWidth_ == 0 || tileHeight_ == 0) return false;
+            tile_.resize(TIFFTileSize(tif_));
+            band_.resize((size_t)tileHeight_ * width * samples);
+        } else {
+            scanline_.resize(TIFFScanlineSize(tif_));
+        }
+        return true;
+    }
+
+    cv::Size size() const override { return size_; }
+
+    bool read(int rows, cv::Mat& strip) override {
+        const int n = std::min(rows, size_.height - row_);
+        if (n <= 0) {
+            strip.release();
+            return true;
+        }
+        strip.create(n, size_.width, CV_8UC3);
+        for (int r = 0; r < n; r++, row_++) {
+            const uchar* src = nullptr;
+            if (tileHeight_ > 0) {
+                const int bandStart = row_ - row_ % (int)tileHeight_;
+                if (bandStart != bandStart_ && !loadBand(bandStart)) return false;
+                src = band_.data() + (size_t)(row_ - bandStart) * size_.width * samples_;
+            } else {
+                if (TIFFReadScanline(tif_, scanline_.data(), (uint32_t)row_, 0) < 0) return false;
+                src = scanline_.data();
+            }
+            rowToBgr(src, samples_, size_.width, strip.ptr<uchar>(r));
+        }
+        return true;
+    }
+
+    std::string description() const override {
+        return tileHeight_ > 0 ? "libtiff, tiled" : "libtiff, scanlines";
+    }
+
+private:
+    // Decode the tile row starting at image row y into band_
+    bool loadBand(int y) {
+        const int rows = std::min((int)tileHeight_, size_.height - y);
+        const size_t rowBytes = (size_t)size_.width * samples_;
+        for (int x = 0; x < size_.width; x += (int)tileWidth_) {
+            if (TIFFReadTile(tif_, tile_.data(), (uint32_t)x, (uint32_t)y, 0, 0) < 0) return false;
+            const int cols = std::min((int)tileWidth_, size_.width - x);
+            for (int r = 0; r < rows; r++) {
+                std::copy_n(tile_.data() + (size_t)r * tileWidth_ * samples_, (size_t)cols * samples_,
+                            band_.data() + r * rowBytes + (size_t)x * samples_);
+            }
+        }
+        bandStart_ = y;
+        return true;
+    }
+
+    TIFF* tif_ = nullptr;
+    cv::Size size_;
+    int samples_ = 3;
+    int row_ = 0;
+    uint32_t tileWidth_ = 0, tileHeight_ = 0;
+    int bandStart_ = -1;
+    std::vector<uchar> scanline_, tile_, band_;
+};
+#endif
+
+#ifdef USE_LIBJPEG
+// libjpeg errors jump back into the reader instead of exiting
+struct JpegErrorManager {
+    jpeg_error_mgr manager;
+    jmp_buf jump;
+};
+
+static void onJpegError(j_common_ptr info) {
+    longjmp(reinterpret_cast<JpegErrorManager*>(info->err)->jump, 1);
+}
+
+// JPEG decoded scanline by scanline
+class JpegStripReader : public StripReader {
+public:
+    ~JpegStripReader() override {
+        if (created_) jpeg_destroy_decompress(&info_);
+        if (file_) std::fclose(file_);
+    }
+
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) return false;
+
+        info_.err = jpeg_std_error(&error_.manager);
+        error_.manager.error_exit = onJpegError;
+        if (setjmp(error_.jump)) return false;
+
+        jpeg_create_decompress(&info_);
+        created_ = true;
+        jpeg_stdio_src(&info_, file_);
+        jpeg_read_header(&info_, TRUE);
+        info_.out_color_space = info_.num_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+        jpeg_start_decompress(&info_);
+        row_.resize((size_t)info_.output_width * info_.output_components);
+        return true;
+    }
+
+    cv::Size size() const override { return cv::Size((int)info_.output_width, (int)info_.output_height); }
+
+    bool read(int rows, cv::Mat& strip) override {
+        const int n = std::min(rows, (int)(info_.output_height - info_.output_scanline));
+        if (n <= 0) {
+            strip.release();
+            return true;
+        }
+        strip.create(n, (int)info_.output_width, CV_8UC3);
+        if (setjmp(error_.jump)) return false;
+        for (int r = 0; r < n; r++) {
+            JSAMPROW row = row_.data();
+            if (jpeg_read_scanlines(&info_, &row, 1) != 1) return false;
+            rowToBgr(row_.data(), info_.output_components, (int)info_.output_width, strip.ptr<uchar>(r));
+        }
+        return true;
+    }
+
+    std::string description() const override { return "libjpeg scanlines"; }
+
+private:
+    FILE* file_ = nullptr;
+    jpeg_decompress_struct info_ = {};
+    JpegErrorManager error_ = {};
+    bool created_ = false;
+    std::vector<JSAMPLE> row_;
+};
+#endif
+
+// Any other format: decoded whole by cv::imread, then handed out in strips
+class ImageStripReader : public StripReader {
+public:
+    bool open(const std::string& path) {
+        image_ = cv::imread(path);
+        return !image_.empty();
+    }
+
+    cv::Size size() const override { return image_.size(); }
+
+    bool read(int rows, cv::Mat& strip) override {
+        const int n = std::min(rows, image_.rows - row_);
+        if (n <= 0) {
+            strip.release();
+            return true;
+        }
+        strip = image_.rowRange(row_, row_ + n);
+        row_ += n;
+        return true;
+    }
+
+    std::string description() const override { return "cv::imread (whole image in memory)"; }
+
+private:
+    cv::Mat image_;
+    int row_ = 0;
+};
+
+std::unique_ptr<StripReader> StripReader::open(const std::string& path) {
+    const std::string ext = lowerExtension(path);
+    if (ext == ".ppm" || ext == ".pnm") {
+        auto reader = std::make_unique<PpmStripReader>();
+        if (reader->open(path)) return reader;
+        return nullptr;
+    }
+#ifdef USE_LIBTIFF
+    if (ext == ".tif" || ext == ".tiff") {
+        auto reader = std::make_unique<TiffStripReader>();
+        if (reader->open(path)) return reader;
+    }
+#endif
+#ifdef USE_LIBJPEG
+    if (ext == ".jpg" || ext == ".jpeg") {
+        auto reader = std::make_unique<JpegStripReader>();
+        if (reader->open(path)) return reader;
+    }
+#endif
+    auto reader = std::make_unique<ImageStripReader>();
+    if (reader->open(path)) return reader;
+    return nullptr;
+}
+
+// =============================================================================
+// Writers
+// =============================================================================
+
+#ifdef USE_LIBTIFF
+// Tiled RGB TIFF: rows are buffered until a full row of tiles is ready
+class TiffStripWriter : public StripWriter {
+public:
+    static const int TILE = 256;
+
+    ~TiffStripWriter() override {
+        if (tif_) TIFFClose(tif_);
+    }
+
+    bool create(const std::string& path, cv::Size size) {
+        // Classic TIFF offsets are 32-bit; larger outputs need BigTIFF
+        const bool big = (uint64_t)size.width * size.height * 3 > 0xF0000000ull;
+        tif_ = TIFFOpen(path.c_str(), big ? "w8" : "w");
+        if (!tif_) return false;
+
+        TIFFSetField(tif_, TIFFTAG_IMAGEWIDTH, (uint32_t)size.width);
+        TIFFSetField(tif_, TIFFTAG_IMAGELENGTH, (uint32_t)size.height);
+        TIFFSetField(tif_, TIFFTAG_SAMPLESPERPIXEL, 3);
+        TIFFSetField(tif_, TIFFTAG_BITSPERSAMPLE, 8);
+        TIFFSetField(tif_, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+        TIFFSetField(tif_, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+        TIFFSetField(tif_, TIFFTAG_COMPRESSION, COMPRESSION_ADOBE_DEFLATE);
+        TIFFSetField(tif_, TIFFTAG_TILEWIDTH, (uint32_t)TILE);
+        TIFFSetField(tif_, TIFFTAG_TILELENGTH, (uint32_t)TILE);
+
+        size_ = size;
+        band_ = cv::Mat(TILE, size.width, CV_8UC3);
+        tile_.resize((size_t)TILE * TILE * 3);
+        return true;
+    }
+
+    bool write(const cv::Mat& strip) override {
+        CV_Assert(strip.type() == CV_8UC3 && strip.cols == size_.width);
+        for (int r = 0; r < strip.rows; r++) {
+            cv::Mat row = band_.row(bandRows_++);
+            cv::cvtColor(strip.row(r), row, cv::COLOR_BGR2RGB);
+            if (bandRows_ == TILE && !flushBand()) return false;
+        }
+        return true;
+    }
+
+    bool close() override {
+        bool ok = bandRows_ == 0 || flushBand();
+        TIFFClose(tif_);
+        tif_ = nullptr;
+        return ok;
+    }
+
+private:
+    // Write the buffered rows as one row of tiles, zero-padded at the edges
+    bool flushBand() {
+        for (int x = 0; x < size_.width; x += TILE) {
+            const int cols = std::min(TILE, size_.width - x);
+            std::fill(tile_.begin(), tile_.end(), 0);
+            for (int r = 0; r < bandRows_; r++) {
+                std::copy_n(band_.ptr<uchar>(r) + (size_t)x * 3, (size_t)cols * 3,
+                            tile_.data() + (size_t)r * TILE * 3);
+            }
+            if (TIFFWriteTile(tif_, tile_.data(), (uint32_t)x, (uint32_t)bandY_, 0, 0) < 0) return false;
+        }
+        bandY_ += bandRows_;
+        bandRows_ = 0;
+        return true;
+    }
+
+    TIFF* tif_ = nullptr;
+    cv::Size size_;
+    cv::Mat band_;        // RGB rows of the current tile row
+    int bandRows_ = 0;
+    int bandY_ = 0;
+    std::vector<uchar> tile_;
+};
+#endif
+
+// Binary PPM written row by row
+class PpmStripWriter : public StripWriter {
+public:
+    bool create(const std::string& path, cv::Size size) {
+        out_.open(path, std::ios::binary);
+        if (!out_) return false;
+        out_ << "P6\n" << size.width << " " << size.height << "\n255\n";
+        width_ = size.width;
+        return (bool)out_;
+    }
+
+    bool write(const cv::Mat& strip) override {
+        CV_Assert(strip.type() == CV_8UC3 && strip.cols == width_);
+        for (int r = 0; r < strip.rows; r++) {
+            cv::cvtColor(strip.row(r), row_, cv::COLOR_BGR2RGB);
+            out_.write(reinterpret_cast<const char*>(row_.data), (std::streamsize)width_ * 3);
+        }
+        return (bool)out_;
+    }
+
+    bool close() override {
+        out_.close();
+        return !out_.fail();
+    }
+
+private:
+    std::ofstream out_;
+    int width_ = 0;
+    cv::Mat row_;
+};
+
+std::unique_ptr<StripWriter> StripWriter::create(const std::string& path, cv::Size size) {
+    const std::string ext = lowerExtension(path);
+    if (ext == ".tif" || ext == ".tiff") {
+#ifdef USE_LIBTIFF
+        auto writer = std::make_unique<TiffStripWriter>();
+        if (writer->create(path, size)) return writer;
+#else
+        std::cout << "Error: Built without libtiff; write a .ppm instead" << std::endl;
+#endif
+        return nullptr;
+    }
+    if (ext == ".ppm") {
+        auto writer = std::make_unique<PpmStripWriter>();
+        if (writer->create(path, size)) return writer;
+    }
+    return nullptr;
+}
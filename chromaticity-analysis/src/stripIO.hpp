@@ -0,0 +1,59 @@
+/*
+  Strip I/O for the streamed mode of chromaticity-analysis
+
+  Very large scans are read and written a band of rows at a time, so memory
+  is a few strips whatever the image height:
+
+  StripReader  binary PPM (memory-mapped, always), striped or tiled 8-bit
+               TIFF (libtiff) and JPEG (libjpeg scanlines) when the build
+               found those libraries; other formats are decoded whole with
+               cv::imread.
+  StripWriter  tiled TIFF (libtiff, 256x256 deflate tiles, BigTIFF when
+               needed) or binary PPM streamed row by row.
+
+  Strips are BGR CV_8UC3, like cv::imread.
+*/
+
+#ifndef STRIP_IO_HPP
+#define STRIP_IO_HPP
+
+#include <memory>
+#include <string>
+#include <opencv2/core.hpp>
+
+// Reads an image top to bottom in strips
+class StripReader {
+public:
+    virtual ~StripReader() = default;
+
+    // Full image size
+    virtual cv::Size size() const = 0;
+
+    // Reads the next min(rows, remaining) rows into strip (width x n BGR);
+    // an empty strip marks the end, false a read error
+    virtual bool read(int rows, cv::Mat& strip) = 0;
+
+    // Format and how it is read, for the log
+    virtual std::string description() const = 0;
+
+    // Picks the reader from the extension; nullptr if the file cannot be read
+    static std::unique_ptr<StripReader> open(const std::string& path);
+};
+
+// Writes an image top to bottom in strips
+class StripWriter {
+public:
+    virtual ~StripWriter() = default;
+
+    // Appends strip (BGR, the image width); the rows must add up to the
+    // height given to create()
+    virtual bool write(const cv::Mat& strip) = 0;
+
+    // Flushes buffered rows and finishes the file
+    virtual bool close() = 0;
+
+    // .tif / .tiff (needs libtiff) or .ppm; nullptr if unsupported
+    static std::unique_ptr<StripWriter> create(const std::string& path, cv::Size size);
+};
+
+#endif // STRIP_IO_HPP
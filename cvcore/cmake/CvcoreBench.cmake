@@ -0,0 +1,77 @@
+# cvcore_add_benchmark - registers a module benchmark with the shared harness
+#
+# Included by cvcore/CMakeLists.txt, so every module that adds cvcore can call
+#
+#   cvcore_add_benchmark(<target> [ARGS <arg>...] [DATA <entry>...])
+#
+# after add_executable(<target> ...). The benchmark then runs as part of
+#
+#   bench                    every benchmark; writes <build>/bench/<target>.json
+#                            and compares it with <CVCORE_BENCH_BASELINES>/<target>.json
+#                            when that file exists (fails beyond CVCORE_BENCH_TOLERANCE)
+#   bench-update-baselines   every benchmark; stores the results as the new baselines
+#   bench-<target>           this benchmark alone
+#   bench-data               fetches the datasets of cvcore/bench/datasets.txt
+#
+# ARGS are passed before the harness options; @DATA@ in them is replaced by the
+# dataset cache directory. A benchmark whose DATA entries (paths relative to
+# the cache) are missing is skipped with a message instead of failing.
+# Benchmarks run in the console pool, one at a time under Ninja; with
+# Makefiles build the bench targets without -j.
+
+set(CVCORE_BENCH_TOLERANCE 0.10 CACHE STRING
+    "Allowed slowdown against the baseline before 'bench' fails (fraction)")
+set(CVCORE_BENCH_METRIC p50_ms CACHE STRING
+    "Compared latency: p50_ms, p95_ms, p99_ms or mean_ms")
+set(CVCORE_BENCH_BASELINES ${CMAKE_SOURCE_DIR}/bench/baselines CACHE PATH
+    "Directory of the stored baseline reports")
+set(CVCORE_BENCH_DATA "" CACHE PATH
+    "Dataset cache (empty: the CVCORE_BENCH_DATA environment variable or the user cache)")
+
+set(CVCORE_BENCH_SCRIPTS ${CMAKE_CURRENT_LIST_DIR} CACHE INTERNAL "")
+set(CVCORE_BENCH_MANIFEST ${CMAKE_CURRENT_LIST_DIR}/../bench/datasets.txt CACHE INTERNAL "")
+
+function(cvcore_add_benchmark target)
+    cmake_parse_arguments(BENCH "" "" "ARGS;DATA" ${ARGN})
+
+    if(NOT TARGET bench)
+        add_custom_target(bench)
+        add_custom_target(bench-update-baselines)
+        get_filename_component(repo_root ${CVCORE_BENCH_SCRIPTS}/../.. ABSOLUTE)
+        add_custom_target(bench-data
+            COMMAND ${CMAKE_COMMAND}
+                    -DMANIFEST=${CVCORE_BENCH_MANIFEST}
+                    -DSOURCE_ROOT=${repo_root}
+                    -DDATA_DIR=${CVCORE_BENCH_DATA}
+                    -P ${CVCORE_BENCH_SCRIPTS}/fetchBenchData.cmake
+            COMMENT "Fetching benchmark datasets"
+            USES_TERMINAL VERBATIM)
+    endif()
+
+    # Lists cross the -D boundary joined with '|'
+    string(REPLACE ";" "|" bench_args "${BENCH_ARGS}")
+    string(REPLACE ";" "|" bench_data "${BENCH_DATA}")
+    set(run_args
+        -DBENCH=$<TARGET_FILE:${target}>
+        -DNAME=${target}
+        -DOUTPUT=${CMAKE_BINARY_DIR}/bench/${target}.json
+        -DBASELINE=${CVCORE_BENCH_BASELINES}/${target}.json
+        -DTOLERANCE=${CVCORE_BENCH_TOLERANCE}
+        -DMETRIC=${CVCORE_BENCH_METRIC}
+        -DDATA_DIR=${CVCORE_BENCH_DATA}
+        "-DARGS=${bench_args}"
+        "-DDATA=${bench_data}")
+
+    add_custom_target(bench-${target}
+        COMMAND ${CMAKE_COMMAND} ${run_args} -P ${CVCORE_BENCH_SCRIPTS}/runBench.cmake
+        DEPENDS ${target}
+        COMMENT "Benchmark ${target}"
+        USES_TERMINAL VERBATIM)
+    add_custom_target(bench-update-${target}
+        COMMAND ${CMAKE_COMMAND} ${run_args} -DUPDATE=ON -P ${CVCORE_BENCH_SCRIPTS}/runBench.cmake
+        DEPENDS ${target}
+        COMMENT "Baseline ${target}"
+        USES_TERMINAL VERBATIM)
+    add_dependencies(bench bench-${target})
+    add_dependencies(bench-update-baselines bench-update-${target})
+endfunction()
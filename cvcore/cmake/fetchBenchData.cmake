@@ -0,0 +1,102 @@
+# Fills the benchmark dataset cache from the manifest (cmake -P, the
+# bench-data target; see CvcoreBench.cmake)
+#
+#   MANIFEST     cvcore/bench/datasets.txt
+#   SOURCE_ROOT  repository root, for entries that are paths in the repo
+#   DATA_DIR     dataset cache (empty: environment / user cache)
+#
+# Each manifest line is "<entry> <source> [SHA256=<hash>]". The source is a
+# path relative to the repository root, an absolute path, or a URL
+# (http, https, file). .zip / .tar.* archives are extracted into <entry>/,
+# anything else is copied to <entry>. Entries already in the cache are kept.
+
+cmake_minimum_required(VERSION 3.15)
+
+if(NOT DATA_DIR)
+    if(DEFINED ENV{CVCORE_BENCH_DATA})
+        set(DATA_DIR $ENV{CVCORE_BENCH_DATA})
+    elseif(WIN32)
+        set(DATA_DIR $ENV{LOCALAPPDATA}/cvcore-bench)
+    elseif(DEFINED ENV{XDG_CACHE_HOME})
+        set(DATA_DIR $ENV{XDG_CACHE_HOME}/cvcore-bench)
+    else()
+        set(DATA_DIR $ENV{HOME}/.cache/cvcore-bench)
+    endif()
+endif()
+file(MAKE_DIRECTORY ${DATA_DIR})
+message(STATUS "Benchmark datasets: ${DATA_DIR}")
+
+file(STRINGS ${MANIFEST} lines)
+foreach(line IN LISTS lines)
+    string(STRIP "${line}" line)
+    if(line STREQUAL "" OR line MATCHES "^#")
+        continue()
+    endif()
+    string(REGEX REPLACE "[ \t]+" ";" fields "${line}")
+    list(GET fields 0 entry)
+    list(GET fields 1 source)
+    set(hash "")
+    list(LENGTH fields count)
+    if(count GREATER 2)
+        list(GET fields 2 hash)
+        string(REGEX REPLACE "^SHA256=" "" hash "${hash}")
+    endif()
+
+    set(target ${DATA_DIR}/${entry})
+    if(EXISTS ${target})
+        message(STATUS "  ${entry}: cached")
+        continue()
+    endif()
+
+    # Local sources are used in place, URLs go through a download
+    if(source MATCHES "^(https?|file)://")
+        get_filename_component(file_name ${source} NAME)
+        set(local ${DATA_DIR}/.download/${file_name})
+        if(hash)
+            file(DOWNLOAD ${source} ${local} EXPECTED_HASH SHA256=${hash} STATUS status)
+        else()
+            file(DOWNLOAD ${source} ${local} STATUS status)
+        endif()
+        list(GET status 0 code)
+        if(NOT code EQUAL 0)
+            list(GET status 1 reason)
+            message(WARNING "  ${entry}: download of ${source} failed (${reason})")
+            continue()
+        endif()
+    else()
+        if(IS_ABSOLUTE ${source})
+            set(local ${source})
+        else()
+            set(local ${SOURCE_ROOT}/${source})
+        endif()
+        if(NOT EXISTS ${local})
+            message(WARNING "  ${entry}: ${local} not found")
+            continue()
+        endif()
+        if(hash AND NOT IS_DIRECTORY ${local})
+            file(SHA256 ${local} actual)
+            if(NOT actual STREQUAL hash)
+                message(WARNING "  ${entry}: SHA256 mismatch for ${local}")
+                continue()
+            endif()
+        endif()
+    endif()
+
+    if(local MATCHES "\\.(zip|tar|tar\\.gz|tgz|tar\\.bz2|tar\\.xz)$")
+        file(MAKE_DIRECTORY ${target})
+        execute_process(COMMAND ${CMAKE_COMMAND} -E tar xf ${local}
+                        WORKING_DIRECTORY ${target} RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            file(REMOVE_RECURSE ${target})
+            message(WARNING "  ${entry}: cannot extract ${local}")
+            continue()
+        endif()
+    elseif(IS_DIRECTORY ${local})
+        file(COPY ${local}/ DESTINATION ${target})
+    else()
+        get_filename_component(target_dir ${target} DIRECTORY)
+        file(MAKE_DIRECTORY ${target_dir})
+        configure_file(${local} ${target} COPYONLY)
+    endif()
+    message(STATUS "  ${entry}: ${source}")
+endforeach()
@@ -0,0 +1,54 @@
+# Runs one benchmark for the bench targets (cmake -P, see CvcoreBench.cmake)
+#
+#   BENCH      executable          NAME       target name
+#   OUTPUT     report to write     BASELINE   stored report to compare with
+#   TOLERANCE  allowed slowdown    METRIC     compared latency
+#   DATA_DIR   dataset cache (empty: environment / user cache)
+#   ARGS       '|'-separated arguments, @DATA@ = dataset cache
+#   DATA       '|'-separated dataset entries the benchmark needs
+#   UPDATE     ON: copy the report over the baseline instead of comparing
+
+cmake_minimum_required(VERSION 3.15)
+
+# Same lookup as cvcore::benchDataDir()
+if(NOT DATA_DIR)
+    if(DEFINED ENV{CVCORE_BENCH_DATA})
+        set(DATA_DIR $ENV{CVCORE_BENCH_DATA})
+    elseif(WIN32)
+        set(DATA_DIR $ENV{LOCALAPPDATA}/cvcore-bench)
+    elseif(DEFINED ENV{XDG_CACHE_HOME})
+        set(DATA_DIR $ENV{XDG_CACHE_HOME}/cvcore-bench)
+    else()
+        set(DATA_DIR $ENV{HOME}/.cache/cvcore-bench)
+    endif()
+endif()
+
+string(REPLACE "|" ";" DATA "${DATA}")
+foreach(entry IN LISTS DATA)
+    if(NOT EXISTS ${DATA_DIR}/${entry})
+        message(STATUS "${NAME}: skipped, ${DATA_DIR}/${entry} not found (build bench-data)")
+        return()
+    endif()
+endforeach()
+
+string(REPLACE "@DATA@" "${DATA_DIR}" ARGS "${ARGS}")
+string(REPLACE "|" ";" ARGS "${ARGS}")
+
+get_filename_component(output_dir ${OUTPUT} DIRECTORY)
+file(MAKE_DIRECTORY ${output_dir})
+set(command ${BENCH} ${ARGS} --json ${OUTPUT} --metric ${METRIC})
+if(NOT UPDATE AND EXISTS ${BASELINE})
+    list(APPEND command --compare ${BASELINE} --tolerance ${TOLERANCE})
+endif()
+
+execute_process(COMMAND ${command} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NAME}: failed or regressed (exit ${result})")
+endif()
+
+if(UPDATE)
+    get_filename_component(baseline_dir ${BASELINE} DIRECTORY)
+    file(MAKE_DIRECTORY ${baseline_dir})
+    configure_file(${OUTPUT} ${BASELINE} COPYONLY)
+    message(STATUS "${NAME}: baseline ${BASELINE} updated")
+endif()
@@ -0,0 +1,149 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Opt-in allocation accounting for hot loops. With the
+           CVCORE_ALLOC_TRACKING build option, cvcore replaces the global
+           operator new and wraps OpenCV's default cv::Mat allocator, counting
+           allocations and bytes per thread; AllocStageScope attributes them
+           to named pipeline stages, which are exported as metrics.
+*/
+
+#ifndef CVCORE_ALLOC_TRACKING_HPP
+#define CVCORE_ALLOC_TRACKING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cvcore {
+
+class Counter;
+
+/**
+ * @brief Allocations made by one thread (or within one scope)
+ */
+struct AllocCounts {
+    uint64_t heapCount = 0;   ///< operator new calls (containers, strings, new)
+    uint64_t heapBytes = 0;
+    uint64_t matCount = 0;    ///< cv::Mat buffers from the default allocator
+    uint64_t matBytes = 0;
+
+    AllocCounts operator-(const AllocCounts &other) const {
+        AllocCounts d;
+        d.heapCount = heapCount - other.heapCount;
+        d.heapBytes = heapBytes - other.heapBytes;
+        d.matCount = matCount - other.matCount;
+        d.matBytes = matBytes - other.matBytes;
+        return d;
+    }
+};
+
+/**
+ * @brief True if cvcore was built with CVCORE_ALLOC_TRACKING
+ *
+ * Without it every count stays 0 and the scopes cost two thread-local reads.
+ */
+bool allocTrackingEnabled();
+
+/**
+ * @brief Allocations made by the calling thread so far
+ */
+AllocCounts threadAllocCounts();
+
+/**
+ * @brief Wrap cv::Mat's default allocator with the counting one (once)
+ *
+ * Called by the first AllocStage::get(); Mats allocated before then are not
+ * counted. No-op without CVCORE_ALLOC_TRACKING.
+ */
+void installMatAllocCounter();
+
+/**
+ * @class AllocStage
+ * @brief Allocation totals of one named pipeline stage
+ *
+ * Stages live for the whole process. Totals go to the metrics registry as
+ * alloc_total / alloc_bytes_total{stage="...",kind="heap"|"mat"}; the
+ * counts of the most recent scope are kept for overlays, where a non-zero
+ * value shows a loop that still allocates per frame.
+ */
+class AllocStage {
+public:
+    /**
+     * @brief The stage called name, created on first use (takes a lock)
+     */
+    static AllocStage &get(const std::string &name);
+
+    /**
+     * @brief Every stage created so far, in creation order
+     */
+    static std::vector<AllocStage *> all();
+
+    const std::string &name() const { return name_; }
+
+    /** @brief Add the allocations of one scope */
+    void add(const AllocCounts &delta);
+
+    /** @brief Counts of the most recent scope */
+    AllocCounts last() const;
+
+    /** @brief Counts over every scope since start-up */
+    AllocCounts total() const;
+
+private:
+    explicit AllocStage(const std::string &name);
+
+    std::string name_;
+    std::atomic<uint64_t> lastHeapCount_{0};
+    std::atomic<uint64_t> lastHeapBytes_{0};
+    std::atomic<uint64_t> lastMatCount_{0};
+    std::atomic<uint64_t> lastMatBytes_{0};
+    Counter *heapCount_ = nullptr;   ///< Registry metrics, null when disabled
+    Counter *heapBytes_ = nullptr;
+    Counter *matCount_ = nullptr;
+    Counter *matBytes_ = nullptr;
+};
+
+/**
+ * @class AllocStageScope
+ * @brief Adds the calling thread's allocations during its lifetime to a stage
+ *
+ * Allocations made by worker threads the scope waits on (parallel_for_
+ * bodies, thread pools) are counted on those threads, not here.
+ */
+class AllocStageScope {
+public:
+    explicit AllocStageScope(AllocStage &stage) : stage_(stage), begin_(threadAllocCounts()) {}
+    ~AllocStageScope() { stage_.add(threadAllocCounts() - begin_); }
+
+    AllocStageScope(const AllocStageScope &) = delete;
+    AllocStageScope &operator=(const AllocStageScope &) = delete;
+
+private:
+    AllocStage &stage_;
+    AllocCounts begin_;
+};
+
+} // namespace cvcore
+
+#define CVCORE_ALLOC_CONCAT_(a, b) a##b
+#define CVCORE_ALLOC_CONCAT(a, b) CVCORE_ALLOC_CONCAT_(a, b)
+
+/**
+ * CVCORE_ALLOC_SCOPE("stage name") counts the rest of the enclosing scope
+ * into that stage. The stage is looked up once per call site, so the name
+ * must not change between calls. Compiles to nothing without
+ * CVCORE_ALLOC_TRACKING.
+ */
+#ifdef CVCORE_ALLOC_TRACKING
+#define CVCORE_ALLOC_SCOPE(name)                                                                  \
+    static cvcore::AllocStage &CVCORE_ALLOC_CONCAT(cvcoreAllocStage_, __LINE__) =                 \
+        cvcore::AllocStage::get(name);                                                            \
+    cvcore::AllocStageScope CVCORE_ALLOC_CONCAT(cvcoreAllocScope_, __LINE__)(                     \
+        CVCORE_ALLOC_CONCAT(cvcoreAllocStage_, __LINE__))
+#else
+#define CVCORE_ALLOC_SCOPE(name) ((void)0)
+#endif
+
+#endif // CVCORE_ALLOC_TRACKING_HPP
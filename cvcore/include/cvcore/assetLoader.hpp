@@ -0,0 +1,151 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Background loading of models and reference assets at startup, so
+           an app can show its live feed while networks and databases load.
+*/
+
+#ifndef CVCORE_ASSET_LOADER_HPP
+#define CVCORE_ASSET_LOADER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace cvcore {
+
+/**
+ * @class AssetLoad
+ * @brief State of one load running on its own thread (type-independent part of Asset)
+ *
+ * The load goes Idle -> Loading -> Ready or Failed. The state is polled from
+ * the frame loop without blocking; modes that need the asset show status()
+ * until it is ready.
+ */
+class AssetLoad {
+public:
+    enum class State { Idle, Loading, Ready, Failed };
+
+    AssetLoad() = default;
+
+    /**
+     * @brief Destructor - waits for a running load
+     */
+    virtual ~AssetLoad();
+
+    AssetLoad(const AssetLoad &) = delete;
+    AssetLoad &operator=(const AssetLoad &) = delete;
+
+    State state() const { return state_.load(std::memory_order_acquire); }
+    bool ready() const { return state() == State::Ready; }
+    bool loading() const { return state() == State::Loading; }
+    bool failed() const { return state() == State::Failed; }
+
+    /**
+     * @brief Name given to start(), used in messages
+     */
+    const std::string &name() const { return name_; }
+
+    /**
+     * @brief Failure message (empty unless failed)
+     */
+    std::string error() const;
+
+    /**
+     * @brief Load time in ms once finished, time since start while loading
+     */
+    double elapsedMs() const;
+
+    /**
+     * @brief One-line status for an overlay, e.g. "Depth model: loading (1.2 s)"
+     */
+    std::string status() const;
+
+    /**
+     * @brief Block until the load has finished
+     *
+     * @param timeoutMs Longest wait, negative waits indefinitely
+     * @return bool True if the asset is ready
+     */
+    bool wait(double timeoutMs = -1.0) const;
+
+protected:
+    /**
+     * @brief Run body on a new thread; body returns false (or throws) on failure
+     *
+     * The error string passed to body may be filled with the reason.
+     */
+    void launch(const std::string &name, std::function<bool(std::string &)> body);
+
+    /**
+     * @brief Wait for the load thread - called by derived destructors first
+     */
+    void join();
+
+private:
+    std::string name_;
+    std::atomic<State> state_{State::Idle};
+    std::thread thread_;
+
+    mutable std::mutex mutex_;               ///< Guards error_ and the times
+    mutable std::condition_variable finished_;
+    std::string error_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point end_;
+};
+
+/**
+ * @class Asset
+ * @brief A T loaded in the background and owned once ready
+ *
+ * Usage:
+ *   cvcore::Asset<Network> net;
+ *   net.start("Depth model", [] { return std::make_unique<Network>("model.onnx"); });
+ *   ...per frame...
+ *   if (Network *n = net.get()) n->run(frame); else draw(net.status());
+ *
+ * The loader runs on the load thread and returns nullptr (or throws) on
+ * failure. Nothing else touches the value until the state is Ready.
+ */
+template <typename T>
+class Asset : public AssetLoad {
+public:
+    Asset() = default;
+
+    /**
+     * @brief Destructor - waits for a running load before freeing the value
+     */
+    ~Asset() override { join(); }
+
+    /**
+     * @brief Start loading; ignored if a load was already started
+     *
+     * @param name Asset name for messages
+     * @param loader Callable returning std::unique_ptr<T>
+     */
+    template <typename Loader>
+    void start(const std::string &name, Loader loader) {
+        launch(name, [this, loader](std::string &error) mutable {
+            value_ = loader();
+            if (!value_) error = "load failed";
+            return value_ != nullptr;
+        });
+    }
+
+    /**
+     * @brief The loaded value, nullptr until ready
+     */
+    T *get() const { return ready() ? value_.get() : nullptr; }
+
+private:
+    std::unique_ptr<T> value_;
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_ASSET_LOADER_HPP
@@ -0,0 +1,180 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Common benchmark harness for the module benchmarks: timed loops
+           with warm-up, latency percentiles and throughput, allocations per
+           call, CPU / build capture, a JSON report and comparison against a
+           stored baseline with a regression threshold. Synthetic inputs and
+           the fetched dataset cache are shared as well.
+*/
+
+#ifndef CVCORE_BENCHMARK_HPP
+#define CVCORE_BENCHMARK_HPP
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Machine and build a benchmark ran on, stored with every report
+ */
+struct BenchEnvironment {
+    std::string cpuModel;       ///< "unknown" where it cannot be read
+    double cpuMHz = 0.0;        ///< Nominal / current clock, 0 if unknown
+    std::string cpuFeatures;    ///< SIMD extensions OpenCV detected ("SSE4_2 AVX2 ...")
+    int logicalCores = 0;
+    int threads = 0;            ///< cv::getNumThreads()
+    std::string opencvVersion;
+    bool optimized = false;     ///< cv::useOptimized()
+    bool allocTracking = false; ///< Allocation columns are measured
+
+    static BenchEnvironment capture();
+};
+
+/**
+ * @brief One benchmark case: latency distribution and throughput
+ *
+ * Latencies are per call in milliseconds. Allocation counts are -1 when
+ * cvcore was built without CVCORE_ALLOC_TRACKING or the case was not timed
+ * by the harness.
+ */
+struct BenchResult {
+    std::string name;           ///< Unique in the suite, e.g. "blur5x5_simd@1080p"
+    std::string unit = "call";  ///< What throughput counts (pixel, frame, query)
+    int iterations = 0;
+    double meanMs = 0.0;
+    double minMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double throughput = 0.0;    ///< unit per second at the median latency
+    double heapAllocsPerCall = -1.0;
+    double matAllocsPerCall = -1.0;
+    std::map<std::string, double> extra;        ///< Module-specific numbers
+    std::map<std::string, std::string> labels;  ///< Module-specific strings
+
+    /** @brief Value of a comparable metric ("p50_ms", "p95_ms", ...), -1 if unknown */
+    double metric(const std::string &key) const;
+};
+
+/**
+ * @brief Harness options shared by every benchmark executable
+ *
+ *   --json <file>       write the report
+ *   --compare <file>    compare with a baseline report, fail on regression
+ *   --tolerance <frac>  allowed slowdown for --compare (default 0.10)
+ *   --metric <key>      compared latency: p50_ms, p95_ms, p99_ms, mean_ms
+ *   --filter <text>     only run cases whose name contains text
+ *   --min-time <sec>    minimum timed duration per case (default 0.3)
+ *   --warmup <n>        untimed calls before timing (default 1)
+ *
+ * Benchmarks loop over argv and hand each argument to consume() before
+ * their own options.
+ */
+struct BenchOptions {
+    std::string jsonPath;
+    std::string comparePath;
+    std::string filter;
+    std::string metric = "p50_ms";
+    double tolerance = 0.10;
+    double minSeconds = 0.3;
+    int minIterations = 3;
+    int maxIterations = 1000;
+    int warmup = 1;
+
+    /**
+     * @brief Take argv[i] (and its value) if it is a harness option
+     * @return bool True if consumed; i then points at the last argument used
+     */
+    bool consume(int &i, int argc, char **argv);
+
+    /** @brief Help lines for the harness options */
+    static const char *usage();
+};
+
+/**
+ * @class BenchSuite
+ * @brief Collects the cases of one benchmark executable and reports them
+ *
+ * run() times a callable itself; benchmarks with their own measurement loop
+ * (a whole clip, a query set) hand their per-call samples to addSamples().
+ * finish() writes the JSON report and compares it with the baseline.
+ */
+class BenchSuite {
+public:
+    BenchSuite(const std::string &name, const BenchOptions &options);
+
+    /** @brief False if --filter excludes the case */
+    bool selected(const std::string &name) const;
+
+    /**
+     * @brief Time fn: warm-up calls, then at least minIterations calls and
+     *        until minSeconds have elapsed (at most maxIterations)
+     *
+     * @param fn Returns false on error, which aborts the case
+     * @param itemsPerCall Units processed per call (pixels, frames)
+     * @return BenchResult* The recorded result, null if skipped or failed
+     */
+    BenchResult *run(const std::string &name, const std::function<bool()> &fn,
+                     double itemsPerCall = 1.0, const std::string &unit = "call");
+
+    /**
+     * @brief Record a case measured by the caller
+     * @param samplesMs Latency of each call in milliseconds
+     * @param itemsPerCall Units processed per call
+     */
+    BenchResult &addSamples(const std::string &name, std::vector<double> samplesMs,
+                            double itemsPerCall = 1.0, const std::string &unit = "call");
+
+    const std::vector<BenchResult> &results() const { return results_; }
+    const BenchEnvironment &environment() const { return environment_; }
+
+    /** @brief One line with the CPU, clock, SIMD and thread count */
+    void printEnvironment(std::ostream &out) const;
+
+    /**
+     * @brief Write --json and check --compare
+     * @return bool False if a file could not be written or read, or a case
+     *         regressed beyond the tolerance
+     */
+    bool finish();
+
+private:
+    std::string name_;
+    BenchOptions options_;
+    BenchEnvironment environment_;
+    std::vector<BenchResult> results_;
+};
+
+/**
+ * @brief Deterministic synthetic frame: smooth gradients (blur / quantize
+ *        paths), hard-edged discs (edges) and mild noise
+ *
+ * @param type CV_8UC1 or CV_8UC3
+ */
+cv::Mat syntheticImage(cv::Size size, int type = CV_8UC3, uint64_t seed = 12345);
+
+/**
+ * @brief Directory of the fetched benchmark datasets
+ *
+ * CVCORE_BENCH_DATA if set, otherwise cvcore-bench under the user cache
+ * directory (XDG_CACHE_HOME or ~/.cache, LOCALAPPDATA on Windows). The
+ * bench-data build target fills it from cvcore/bench/datasets.txt.
+ */
+std::string benchDataDir();
+
+/**
+ * @brief Path of one dataset entry, empty if it has not been fetched
+ */
+std::string benchDataPath(const std::string &name);
+
+} // namespace cvcore
+
+#endif // CVCORE_BENCHMARK_HPP
@@ -0,0 +1,133 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Frame sources shared by every app: cameras, video files, network
+           streams, GStreamer pipelines and image sequences behind one
+           interface. Every frame carries its sequence number and capture
+           timestamp, and read() refills the caller's buffer instead of
+           allocating a new cv::Mat per frame.
+*/
+
+#ifndef CVCORE_CAPTURE_HPP
+#define CVCORE_CAPTURE_HPP
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace cvcore {
+
+/**
+ * @brief One captured frame
+ */
+struct Frame {
+    cv::Mat image;          ///< BGR frame; its buffer is reused by the next read()
+    cv::Mat raw;            ///< Zero-copy view of the driver buffer (V4L2 only),
+                            ///< valid until the next read(); empty otherwise
+    int64_t sequence = 0;   ///< Index among all frames read from the source (from 1)
+    int64_t ticks = 0;      ///< cv::getTickCount() right after the read returned
+    double deviceMs = -1.0; ///< Driver / stream timestamp in ms, -1 if unavailable
+
+    /**
+     * @brief Milliseconds since the frame was read
+     */
+    double ageMs() const {
+        return (cv::getTickCount() - ticks) * 1000.0 / cv::getTickFrequency();
+    }
+};
+
+/**
+ * @class FrameSource
+ * @brief Sequential frame reader
+ *
+ * Open one with FrameSource::open(). A spec selects the implementation:
+ *   - empty or all digits: camera index. On Linux the device is read
+ *     through V4L2 memory-mapped driver buffers (no copy before the colour
+ *     conversion) when its pixel format is supported, otherwise through
+ *     cv::VideoCapture
+ *   - "/dev/videoN": that V4L2 device
+ *   - contains " ! ": GStreamer pipeline
+ *   - contains "://": network stream (RTSP, HTTP, ...), reopened by reopen()
+ *   - a directory, a printf pattern ("frames/%04d.png") or a .txt list of
+ *     paths: image sequence, decoded ahead on a prefetch thread
+ *   - anything else: video file
+ * Files and streams ask for hardware decoding (NVDEC, VAAPI, D3D11, ... via
+ * CAP_PROP_HW_ACCELERATION) and fall back to software.
+ *
+ * A source is read by one thread at a time.
+ */
+class FrameSource {
+public:
+    enum class Kind { Camera, File, Network, GStreamer, ImageSequence };
+
+    virtual ~FrameSource() = default;
+
+    /**
+     * @brief Open a source
+     *
+     * @param spec See the class description
+     * @param camera Camera index used when spec is empty
+     * @return The source, or nullptr if it cannot be opened
+     */
+    static std::unique_ptr<FrameSource> open(const std::string &spec, int camera = 0);
+
+    /**
+     * @brief Read the next frame into frame, reusing its image buffer
+     *
+     * @return False at the end of a file or sequence, or when the device
+     *         stopped delivering
+     */
+    virtual bool read(Frame &frame) = 0;
+
+    /**
+     * @brief Read the next frame's image only (sequence and timestamp are
+     *        still counted)
+     */
+    bool read(cv::Mat &image);
+
+    /**
+     * @brief Close and open the source again, e.g. after a dropped stream
+     *
+     * @return False if it cannot be reopened
+     */
+    virtual bool reopen() = 0;
+
+    /// Frame size, or an empty size when the source does not report it
+    virtual cv::Size frameSize() const = 0;
+
+    /// Nominal frame rate, 0 if unknown
+    virtual double fps() const = 0;
+
+    /// True when frames are decoded in hardware
+    virtual bool hardwareDecode() const { return false; }
+
+    Kind kind() const { return kind_; }
+
+    /// True for cameras and network streams (frames arrive in real time)
+    bool live() const { return kind_ == Kind::Camera || kind_ == Kind::Network; }
+
+    /// Human-readable source and backend, e.g. "rtsp://... (FFMPEG, HW decode)"
+    const std::string &description() const { return description_; }
+
+protected:
+    explicit FrameSource(Kind kind) : kind_(kind) {}
+
+    /// Number and timestamp a frame that was just read
+    void stamp(Frame &frame, double deviceMs) {
+        frame.sequence = ++sequence_;
+        frame.ticks = cv::getTickCount();
+        frame.deviceMs = deviceMs;
+    }
+
+    Kind kind_;
+    std::string description_;
+    int64_t sequence_ = 0;
+
+private:
+    Frame scratch_;   ///< Used by read(cv::Mat&)
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_CAPTURE_HPP
@@ -0,0 +1,123 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: rg chromaticity kernels shared by chromaticity-analysis and the
+           whole-slide engine in 6-uterine-cancer-detection. r = R / (R+G+B)
+           and g = G / (R+G+B) drop the intensity, so white and grey pixels
+           (slide background, shadows) all sit at the neutral point (1/3, 1/3)
+           and stained tissue stands out by its distance from it.
+           OclChromaticityCounter counts on an OpenCL device through the
+           T-API, for dataset-scale batches.
+*/
+
+#ifndef CVCORE_CHROMATICITY_HPP
+#define CVCORE_CHROMATICITY_HPP
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/ocl.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Count pixels per rg chromaticity bin
+ *
+ * Bin (i, j) at index i * histsize + j holds the pixels with
+ * round(r * (histsize - 1)) = i and round(g * (histsize - 1)) = j. Each pixel
+ * costs one table lookup and two multiplies: a table holds
+ * (histsize - 1) / (R+G+B) for every sum in [0, 765] (a black pixel counts
+ * as sum 1, bin (0, 0)).
+ *
+ * @param src CV_8UC3 BGR image
+ * @param histsize Bins per axis
+ * @param parallel Count row stripes in parallel (parallelHistogram); pass
+ *                 false when the caller already runs images in parallel
+ * @return Counts, histsize * histsize entries
+ */
+std::vector<uint32_t> countRgChromaticity(const cv::Mat &src, int histsize, bool parallel = true);
+
+/**
+ * @brief Fraction of the counted pixels at least minDistance from neutral
+ *
+ * A cheap saturation measure: the distance of (r, g) from (1/3, 1/3) grows
+ * with the colour's saturation and ignores its brightness.
+ *
+ * @param counts countRgChromaticity() result
+ * @param histsize Bins per axis used for counts
+ * @param minDistance Distance in rg units (0 - ~0.75)
+ * @return Fraction in [0, 1], 0 for an empty histogram
+ */
+double chromaticFraction(const std::vector<uint32_t> &counts, int histsize, float minDistance);
+
+/**
+ * @class OclChromaticityCounter
+ * @brief countRgChromaticity on the default OpenCL device
+ *
+ * Each work-item strides over the pixels and counts into a work-group
+ * sub-histogram in local memory, merged into the global histogram with
+ * atomic adds; when histsize * histsize counters do not fit in half the
+ * device's local memory (256 bins per axis need 256 KB), work-items count
+ * with global atomics instead. Bins use the same float table and rounding
+ * as countRgChromaticity, so the counts are identical. Only the counts are
+ * read back.
+ *
+ * Two slots let the caller overlap transfers with compute: uploads and
+ * downloads go through the default queue, kernels through a second queue,
+ * so upload(next) runs while the kernel of the current slot is executing:
+ *
+ *   upload(0, a); launch(0);
+ *   upload(1, b);             // overlaps kernel 0
+ *   download(0, counts);      // waits for kernel 0 only
+ *   launch(1); ...
+ */
+class OclChromaticityCounter {
+public:
+    static constexpr int SLOTS = 2;
+
+    /**
+     * @brief Build the kernel for histsize bins per axis
+     *
+     * available() is false when OpenCL is missing or the build failed.
+     */
+    explicit OclChromaticityCounter(int histsize);
+
+    bool available() const { return !kernel_.empty(); }
+    int histsize() const { return histsize_; }
+    bool usesLocalMemory() const { return local_; }
+
+    /**
+     * @brief Copy a CV_8UC3 BGR image to the device and clear the slot's counts
+     *
+     * Blocks until the copy is done; the slot must not have a launched,
+     * undownloaded kernel.
+     */
+    bool upload(int slot, const cv::Mat &src);
+
+    /** @brief Enqueue counting of the slot's image without waiting */
+    bool launch(int slot);
+
+    /**
+     * @brief Wait for the launched kernels and read the slot's counts
+     *
+     * @param counts Resized to histsize * histsize
+     */
+    bool download(int slot, std::vector<uint32_t> &counts);
+
+private:
+    struct Slot {
+        cv::UMat image;
+        cv::UMat counts;   ///< histsize x histsize CV_32S
+    };
+
+    int histsize_;
+    bool local_ = false;
+    cv::ocl::Kernel kernel_;
+    cv::ocl::Queue computeQueue_;
+    cv::UMat scale_;                 ///< (histsize - 1) / sum, sum in [0, 765]
+    Slot slots_[SLOTS];
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_CHROMATICITY_HPP
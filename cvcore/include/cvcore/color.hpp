@@ -0,0 +1,61 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Colour conversion and lookup-table primitives shared by the
+           modules.
+*/
+
+#ifndef CVCORE_COLOR_HPP
+#define CVCORE_COLOR_HPP
+
+#include <opencv2/core.hpp>
+
+namespace cvcore {
+
+/// Fixed-point BT.601 luma weights with GRAY_SHIFT fractional bits
+const int GRAY_SHIFT = 14;
+const int GRAY_B = 1868;
+const int GRAY_G = 9617;
+const int GRAY_R = 4899;
+
+/**
+ * @brief Convert one interleaved BGR row to grey
+ *
+ * gray = (B * GRAY_B + G * GRAY_G + R * GRAY_R + 2^13) >> 14, the same
+ * fixed-point weights cv::cvtColor uses for COLOR_BGR2GRAY.
+ *
+ * @param bgr Source row, 3 * cols bytes
+ * @param gray Destination row, cols bytes
+ * @param cols Number of pixels
+ */
+void bgrToGrayRow(const uchar *bgr, uchar *gray, int cols);
+
+/**
+ * @brief Convert a BGR image to grey in parallel row bands
+ *
+ * @param src CV_8UC3 source
+ * @param dst Output CV_8UC1 image
+ */
+void bgrToGray(const cv::Mat &src, cv::Mat &dst);
+
+/**
+ * @brief Apply a 256-entry lookup table to every channel of an 8-bit image
+ *
+ * @param src CV_8U source with any number of channels
+ * @param lut 256 output values, indexed by the source value
+ * @param dst Output of the same type; may alias src
+ */
+void applyLut(const cv::Mat &src, const uchar *lut, cv::Mat &dst);
+
+/**
+ * @brief Apply one 256-entry lookup table per channel
+ *
+ * @param src CV_8U source with cn channels
+ * @param luts cn tables of 256 entries, table c for channel c
+ * @param dst Output of the same type; may alias src
+ */
+void applyLutPerChannel(const cv::Mat &src, const uchar (*luts)[256], cv::Mat &dst);
+
+} // namespace cvcore
+
+#endif // CVCORE_COLOR_HPP
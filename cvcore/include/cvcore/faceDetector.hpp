@@ -0,0 +1,124 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: YuNet face detection (cv::FaceDetectorYN) shared by the modules:
+           one service per model file holding a pool of detectors, so any
+           number of threads can detect at once and a batch of images is
+           spread across the pool. Images are shrunk to a small input size
+           before detection, which keeps the cost per image nearly constant.
+*/
+
+#ifndef CVCORE_FACE_DETECTOR_HPP
+#define CVCORE_FACE_DETECTOR_HPP
+
+#include <opencv2/core.hpp>
+#include <opencv2/objdetect.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Detector configuration
+ */
+struct FaceDetectorOptions {
+    int inputSize = 320;          ///< Longest side of the detector input (smaller images are not enlarged)
+    float scoreThreshold = 0.8f;  ///< Minimum face score in [0, 1]
+    float nmsThreshold = 0.3f;    ///< IoU above which overlapping boxes are merged
+    int topK = 50;                ///< Candidates kept before NMS
+    int detectors = 0;            ///< Pooled detectors; 0 = cv::getNumThreads()
+};
+
+/**
+ * @brief Pooled YuNet face detection for one model
+ *
+ * cv::FaceDetectorYN is not thread-safe and is bound to one input size, so
+ * the service keeps up to options.detectors instances. detect() borrows one
+ * for the call (waiting if all are busy), and detectBatch() runs a whole
+ * list of images across the pool in parallel. Greyscale input is accepted
+ * and replicated to three channels.
+ *
+ * Usage:
+ *   auto yunet = FaceDetectorService::shared("face_detection_yunet_2023mar.onnx");
+ *   std::vector<cv::Rect> faces = yunet->detect(frame);
+ */
+class FaceDetectorService {
+public:
+    /**
+     * @brief Load the model (one detector; the rest are created on demand)
+     *
+     * @param modelPath YuNet ONNX file
+     * @param options Input size, thresholds and pool size
+     * @throws cv::Exception when the model cannot be loaded
+     */
+    explicit FaceDetectorService(const std::string &modelPath,
+                                 const FaceDetectorOptions &options = FaceDetectorOptions());
+    ~FaceDetectorService();
+
+    FaceDetectorService(const FaceDetectorService &) = delete;
+    FaceDetectorService &operator=(const FaceDetectorService &) = delete;
+
+    /**
+     * @brief Service for a model shared by every caller in the process
+     *
+     * The first call for a path loads it; later calls with the same path
+     * return the same service (their options are ignored).
+     *
+     * @return The service, or nullptr if the model cannot be loaded
+     */
+    static std::shared_ptr<FaceDetectorService> shared(const std::string &modelPath,
+                                                       const FaceDetectorOptions &options = FaceDetectorOptions());
+
+    /**
+     * @brief Detect faces in one image (thread-safe)
+     *
+     * @param image BGR (CV_8UC3) or greyscale (CV_8UC1) image
+     * @param scores Optional output, one score per returned box
+     * @return Face boxes in image coordinates
+     */
+    std::vector<cv::Rect> detect(const cv::Mat &image, std::vector<float> *scores = nullptr);
+
+    /**
+     * @brief Detect faces in many images, spread across the detector pool
+     *
+     * @return One box list per image, in order
+     */
+    std::vector<std::vector<cv::Rect>> detectBatch(const std::vector<cv::Mat> &images);
+
+    const FaceDetectorOptions &options() const { return options_; }
+    const std::string &modelPath() const { return modelPath_; }
+
+    /**
+     * @brief Short description of the model and its parameters, for cache tags
+     */
+    std::string tag() const;
+
+    long long images() const;   ///< Images detected since construction
+
+private:
+    struct Detector {
+        cv::Ptr<cv::FaceDetectorYN> net;
+        cv::Size inputSize;       ///< Size the net is currently set up for
+    };
+
+    std::unique_ptr<Detector> createDetector() const;
+    std::unique_ptr<Detector> acquire();
+    void release(std::unique_ptr<Detector> detector);
+
+    std::string modelPath_;
+    FaceDetectorOptions options_;
+    int maxDetectors_;
+
+    mutable std::mutex mutex_;               ///< Guards everything below
+    std::condition_variable available_;      ///< A detector was returned
+    std::vector<std::unique_ptr<Detector>> idle_;
+    int created_ = 0;
+    long long images_ = 0;
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_FACE_DETECTOR_HPP
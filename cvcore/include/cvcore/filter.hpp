@@ -0,0 +1,79 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Integer stencil filters shared by the modules: 3x3 Sobel gradients
+           and separable convolution of 8-bit images. Borders follow
+           cv::BORDER_REFLECT_101 so results match the OpenCV calls they
+           replace.
+*/
+
+#ifndef CVCORE_FILTER_HPP
+#define CVCORE_FILTER_HPP
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief cv::BORDER_REFLECT_101 index
+ *
+ * @param index Possibly out-of-range index, at most length - 1 outside
+ * @param length Row or column length
+ * @return Index in [0, length)
+ */
+inline int reflect101(int index, int length) {
+    if (length == 1) {
+        return 0;
+    }
+    if (index < 0) {
+        return -index;
+    }
+    return index >= length ? 2 * length - 2 - index : index;
+}
+
+/**
+ * @brief 3x3 Sobel gradients of one row
+ *
+ * The three input rows are padded: element 0 is column -1 and element
+ * cols + 1 is column cols, already filled with the reflected border. The
+ * sums are exact integers, the same values cv::Sobel produces with ksize 3.
+ *
+ * @param up Padded row above (cols + 2 elements)
+ * @param mid Padded centre row
+ * @param down Padded row below
+ * @param cols Number of output columns
+ * @param gx Horizontal gradient, cols elements
+ * @param gy Vertical gradient, cols elements
+ */
+void sobel3x3Row(const uchar *up, const uchar *mid, const uchar *down, int cols,
+                 short *gx, short *gy);
+
+/**
+ * @brief 3x3 Sobel gradients of a greyscale image
+ *
+ * @param gray CV_8UC1 source
+ * @param gx Output CV_16SC1 horizontal gradient
+ * @param gy Output CV_16SC1 vertical gradient
+ */
+void sobel3x3(const cv::Mat &gray, cv::Mat &gx, cv::Mat &gy);
+
+/**
+ * @brief Separable integer convolution of an 8-bit image
+ *
+ * Each output is saturate((sum_i sum_j ky[i] * kx[j] * src + round) >> shift)
+ * with round = 1 << (shift - 1). Both kernels must have odd length and the
+ * absolute tap sums must keep the 2-D sum within int range.
+ *
+ * @param src CV_8UC1 or CV_8UC3 source
+ * @param dst Output of the same type; must not alias src
+ * @param kx Horizontal taps
+ * @param ky Vertical taps
+ * @param shift Right shift applied to the 2-D sum
+ */
+void separableFilter8u(const cv::Mat &src, cv::Mat &dst, const std::vector<int> &kx,
+                       const std::vector<int> &ky, int shift);
+
+} // namespace cvcore
+
+#endif // CVCORE_FILTER_HPP
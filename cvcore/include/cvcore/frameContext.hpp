@@ -0,0 +1,122 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Per-frame cache of derived images (grey, HSV, Lab, grey pyramid,
+           CLAHE). Each representation is computed on first request and
+           reused by every later consumer of the same frame, so independent
+           stages (face detection, thresholds, trackers) convert at most
+           once per frame.
+*/
+
+#ifndef CVCORE_FRAME_CONTEXT_HPP
+#define CVCORE_FRAME_CONTEXT_HPP
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <deque>
+
+namespace cvcore {
+
+/**
+ * @class FrameContext
+ * @brief Lazily computed, memoised representations of one frame
+ *
+ * Consumers take a FrameContext instead of a raw frame and ask for the
+ * representation they need; the first request computes it, later requests
+ * return the cached image. Conversions use cv::cvtColor, so results match
+ * consumers converting on their own.
+ *
+ * reset() starts the next frame and reuses the buffers of the previous
+ * one, so a steady stream of frames does not reallocate. A buffer a
+ * consumer still holds (e.g. a tracker's previous grey frame) is left to
+ * that consumer and replaced by a fresh one. A context is used by one
+ * thread at a time; the returned references stay valid until reset().
+ *
+ * Usage example:
+ * @code
+ *   cvcore::FrameContext context;
+ *   while (source.read(frame)) {
+ *       context.reset(frame);
+ *       faces = detector.detect(context.gray());          // converts
+ *       tracker.track(context);                           // reuses gray()
+ *   }
+ * @endcode
+ */
+class FrameContext {
+public:
+    FrameContext() = default;
+
+    /**
+     * @brief Context of one frame
+     * @param frame BGR, BGRA or grey CV_8U frame (not copied)
+     */
+    explicit FrameContext(const cv::Mat &frame) { reset(frame); }
+
+    /**
+     * @brief Start a new frame and drop every memoised representation
+     * @param frame BGR, BGRA or grey CV_8U frame (not copied; must outlive
+     *              the frame's use of the context)
+     */
+    void reset(const cv::Mat &frame);
+
+    /** @brief The frame passed to reset() */
+    const cv::Mat &frame() const { return frame_; }
+
+    /** @brief 3-channel BGR (the frame itself when it already is BGR) */
+    const cv::Mat &bgr();
+
+    /** @brief 8-bit grey (the frame itself when it already is grey) */
+    const cv::Mat &gray();
+
+    /** @brief 8-bit HSV of bgr() (H in [0, 180)) */
+    const cv::Mat &hsv();
+
+    /** @brief 8-bit Lab of bgr() */
+    const cv::Mat &lab();
+
+    /**
+     * @brief Level of the grey Gaussian pyramid
+     * @param level 0 is gray(), each level halves the previous with cv::pyrDown
+     */
+    const cv::Mat &grayPyramid(int level);
+
+    /**
+     * @brief CLAHE-equalised gray()
+     *
+     * Memoised per (clipLimit, tiles): consumers asking with the same
+     * settings share one result. The CLAHE objects themselves are kept
+     * across frames.
+     */
+    const cv::Mat &clahe(double clipLimit = 2.0, cv::Size tiles = cv::Size(8, 8));
+
+    /** @brief Representations computed for the current frame (not reused ones) */
+    int conversions() const { return conversions_; }
+
+private:
+    struct ClaheEntry {
+        double clipLimit;
+        cv::Size tiles;
+        cv::Ptr<cv::CLAHE> clahe;
+        cv::Mat result;
+        bool valid;
+    };
+
+    // Gives up a buffer some consumer still references (or the frame's own)
+    static void releaseIfShared(cv::Mat &image);
+
+    cv::Mat frame_;
+    cv::Mat bgr_, gray_, hsv_, lab_;
+    // Deques: growing them keeps earlier references valid
+    std::deque<cv::Mat> pyramid_;    ///< Levels 1..n of the grey pyramid
+    std::deque<ClaheEntry> clahe_;
+    bool bgrValid_ = false;
+    bool grayValid_ = false;
+    bool hsvValid_ = false;
+    bool labValid_ = false;
+    int pyramidValid_ = 0;           ///< Levels of pyramid_ computed this frame
+    int conversions_ = 0;
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_FRAME_CONTEXT_HPP
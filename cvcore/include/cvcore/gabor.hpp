@@ -0,0 +1,137 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Gabor filter bank shared by the CBIR Gabor texture feature and the
+           cbir Python module. Kernels are built once; each response is
+           computed by the cheapest exact-enough path (frequency domain,
+           low-rank separable or dense spatial) and all kernels of the bank
+           are evaluated in one parallel pass over the image.
+*/
+
+#ifndef CVCORE_GABOR_HPP
+#define CVCORE_GABOR_HPP
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Parameters of one kernel, as passed to cv::getGaborKernel
+ *
+ * G(x,y) = exp(-(x'^2 + gamma^2 y'^2) / (2 sigma^2)) * cos(2 pi x' / lambda + psi)
+ * with (x', y') the coordinates rotated by theta.
+ */
+struct GaborParams {
+    double sigma;    ///< Gaussian envelope std dev
+    double theta;    ///< Orientation in radians
+    double lambda;   ///< Carrier wavelength
+    double gamma;    ///< Spatial aspect ratio
+    double psi;      ///< Phase offset
+};
+
+/**
+ * @brief How a kernel's response is computed
+ */
+enum class GaborPath {
+    Fourier,     ///< Product with the cached kernel spectrum
+    Separable,   ///< Sum of rank() row/column passes (truncated SVD)
+    Dense        ///< cv::filter2D with the full kernel
+};
+
+/**
+ * @class GaborBank
+ * @brief Fixed bank of square Gabor kernels evaluated together
+ *
+ * Responses equal cv::filter2D(src, dst, CV_32F, kernel) with the default
+ * BORDER_REFLECT_101, up to float rounding and, on the separable path, the
+ * truncation error below.
+ *
+ * - Fourier (ksize >= fftMinKsize, unless disabled): the padded image is
+ *   transformed once per call and multiplied by each kernel's spectrum.
+ *   Spectra are cached for the last two DFT sizes.
+ * - Separable: the SVD of each kernel is truncated to the smallest rank
+ *   whose relative Frobenius error is at most separableError. Kernels along
+ *   the axes are rank 1; a rank r kernel is used when its 2 r passes cost
+ *   less than half the dense stencil.
+ * - Dense otherwise.
+ *
+ * Like the feature extractors, a bank serves one thread at a time (the
+ * spectrum cache is not locked); each call spreads its kernels over
+ * cv::parallel_for_.
+ */
+class GaborBank {
+public:
+    /**
+     * @brief Build the kernels and their separable factors
+     *
+     * @param ksize Odd kernel side
+     * @param params One entry per kernel, in response order
+     * @param separableError Largest relative error accepted for the
+     *                       separable path (0 disables it)
+     * @param fftMinKsize Smallest ksize filtered in the frequency domain
+     */
+    GaborBank(int ksize, const std::vector<GaborParams> &params, double separableError = 1e-4,
+              int fftMinKsize = 21);
+
+    int size() const { return static_cast<int>(kernels_.size()); }
+    int ksize() const { return ksize_; }
+
+    /** @brief Kernel k (CV_32F, ksize x ksize) */
+    const cv::Mat &kernel(int k) const { return kernels_[k]; }
+
+    /** @brief Separable rank of kernel k, 0 if it is not used separably */
+    int rank(int k) const { return static_cast<int>(factors_[k].size()); }
+
+    /** @brief Path that computes response k with the current settings */
+    GaborPath path(int k) const;
+
+    /** @brief Allow the frequency-domain path (default on) */
+    void setUseFFT(bool useFFT) { useFFT_ = useFFT; }
+    bool getUseFFT() const { return useFFT_; }
+
+    /**
+     * @brief Filter with every kernel and hand each response to visit
+     *
+     * visit(k, response) is called from worker threads, once per kernel and
+     * concurrently for different k; response (CV_32F, src size) is only
+     * valid during the call. At most one response per thread is alive.
+     *
+     * @param src Single-channel image (converted to CV_32F)
+     * @param visit Consumer of the responses
+     */
+    void forEachResponse(const cv::Mat &src,
+                         const std::function<void(int, const cv::Mat &)> &visit) const;
+
+    /**
+     * @brief All responses, responses[k] for kernel k
+     */
+    void filter(const cv::Mat &src, std::vector<cv::Mat> &responses) const;
+
+private:
+    /// Rank-one term: column taps (ky) times row taps (kx)
+    struct Factor {
+        cv::Mat kx;   ///< 1 x ksize, CV_32F, scaled by the singular value
+        cv::Mat ky;   ///< ksize x 1, CV_32F
+    };
+
+    /// Kernel spectra for one padded DFT size
+    struct SpectrumSet {
+        cv::Size dftSize;
+        std::vector<cv::Mat> spectra;   ///< DFT of each flipped, zero-padded kernel
+    };
+
+    const std::vector<cv::Mat> &kernelSpectra(const cv::Size &dftSize) const;
+
+    int ksize_;
+    int fftMinKsize_;
+    bool useFFT_ = true;
+    std::vector<cv::Mat> kernels_;
+    std::vector<std::vector<Factor>> factors_;   ///< Empty when not separable
+    mutable std::vector<SpectrumSet> spectrumCache_;
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_GABOR_HPP
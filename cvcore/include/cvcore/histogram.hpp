@@ -0,0 +1,55 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Parallel histogram accumulation shared by the modules. Every
+           worker counts into its own integer sub-histogram, so there are no
+           atomics or locks on the hot path, and the sub-histograms are summed
+           once at the end.
+*/
+
+#ifndef CVCORE_HISTOGRAM_HPP
+#define CVCORE_HISTOGRAM_HPP
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Count a histogram over rows [0, rows) in parallel stripes
+ *
+ * The rows are cut into one stripe per OpenCV worker thread (fewer when the
+ * image has fewer than minRowsPerStripe rows per stripe). The body is called
+ * once per stripe with its row range and a zeroed sub-histogram of `bins`
+ * counters; it must only increment that sub-histogram. Integer counts make
+ * the result independent of the split.
+ *
+ * @param rows Number of rows to cover
+ * @param bins Number of histogram bins
+ * @param body Function counting the rows of one stripe
+ * @param minRowsPerStripe Lower bound on the stripe height
+ * @return Summed counts, `bins` entries
+ */
+std::vector<uint32_t> parallelHistogram(
+    int rows, int bins,
+    const std::function<void(const cv::Range &, uint32_t *)> &body,
+    int minRowsPerStripe = 32);
+
+/**
+ * @brief Joint histogram of an 8-bit image, one bin index per pixel
+ *
+ * binOf maps each channel value (0-255) to its per-channel bin; the bin of a
+ * pixel is the row-major flattening over the channels in memory order, e.g.
+ * (binB * n + binG) * n + binR for BGR with n bins per channel.
+ *
+ * @param src CV_8UC1 or CV_8UC3 image
+ * @param binsPerChannel Number of bins per channel
+ * @return Counts, binsPerChannel^channels entries
+ */
+std::vector<uint32_t> countJoint8u(const cv::Mat &src, int binsPerChannel);
+
+} // namespace cvcore
+
+#endif // CVCORE_HISTOGRAM_HPP
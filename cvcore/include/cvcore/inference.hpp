@@ -0,0 +1,261 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: ONNX Runtime inference shared by the modules: execution provider
+           selection, one process-wide Ort::Env, sessions with persistent
+           IoBinding buffers, and a service that pools sessions and batches
+           single-sample requests from many threads within a latency window.
+           Only built when ONNX Runtime is found (USE_ONNXRUNTIME).
+*/
+
+#ifndef CVCORE_INFERENCE_HPP
+#define CVCORE_INFERENCE_HPP
+
+#include <onnxruntime_cxx_api.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Execution providers, tried in the order given in InferenceOptions
+ *
+ * Providers that are not compiled into the linked ONNX Runtime are skipped;
+ * the CPU provider is always available and ends every chain.
+ */
+enum class Provider { TensorRT, CUDA, OpenVINO, CPU };
+
+/**
+ * @brief Session and batching configuration
+ */
+struct InferenceOptions {
+    std::vector<Provider> providers{Provider::CUDA, Provider::CPU};
+    int deviceId = 0;
+    std::string trtCacheDir = "trt_cache";  ///< TensorRT engine cache
+    bool trtFp16 = true;
+    bool trtInt8 = false;                   ///< Needs a calibrated / QDQ model
+    std::string openvinoDevice = "CPU";
+    int intraOpThreads = 0;                 ///< 0 = ONNX Runtime default
+
+    int sessions = 1;        ///< Pooled sessions in an InferenceService
+    int maxBatch = 8;        ///< Samples per run before it starts at once
+    int maxLatencyMs = 4;    ///< How long the first request waits for others
+
+    /**
+     * @brief Parse a comma separated provider list, e.g. "tensorrt,cuda,cpu"
+     *
+     * Unknown names are ignored.
+     *
+     * @return False if nothing was recognised (providers unchanged)
+     */
+    bool parseProviders(const std::string &list);
+};
+
+/**
+ * @brief Display name of a provider ("TensorRT", "CUDA", ...)
+ */
+const char *providerLabel(Provider provider);
+
+/**
+ * @brief The process-wide ONNX Runtime environment
+ *
+ * Every session in the process shares it, so there is one logger and one
+ * global thread pool setup instead of one per wrapper.
+ */
+Ort::Env &sharedEnv();
+
+/**
+ * @brief Register the provider chain of options on session options
+ *
+ * @param sessionOptions Options to append the providers to
+ * @param options Provider list and provider settings
+ * @param logTag Prefix for messages about unavailable providers
+ * @return The providers actually registered, e.g. "CUDA > CPU"
+ */
+std::string configureProviders(Ort::SessionOptions &sessionOptions,
+                               const InferenceOptions &options,
+                               const std::string &logTag = "cvcore");
+
+/**
+ * @brief One ONNX Runtime session with a single float input and output
+ *
+ * The input tensor wraps a persistent host buffer and the output is bound
+ * through IoBinding to a persistent buffer once its shape is known, so
+ * steady-state runs at an unchanged shape allocate nothing. Not thread-safe;
+ * InferenceService gives each pooled session its own worker.
+ */
+class InferenceSession {
+public:
+    /**
+     * @brief Load a model
+     *
+     * @param modelPath ONNX file
+     * @param options Provider chain
+     * @param inputName Input to feed; empty = the model's first input
+     * @param outputName Output to read; empty = the model's first output
+     * @throws Ort::Exception when the model cannot be loaded
+     */
+    InferenceSession(const std::string &modelPath, const InferenceOptions &options,
+                     const std::string &inputName = "", const std::string &outputName = "");
+
+    /**
+     * @brief Writable input buffer for the given shape
+     *
+     * Reallocates (and rebinds) only when the shape changes.
+     */
+    float *input(const std::vector<int64_t> &shape);
+
+    /**
+     * @brief Run on the buffer filled through input()
+     *
+     * @return False on failure (e.g. a batch size the model rejects)
+     */
+    bool run();
+
+    /// Output of the last successful run
+    const float *output() const { return outputData_.data(); }
+    const std::vector<int64_t> &outputShape() const { return outputShape_; }
+    size_t outputSize() const { return outputData_.size(); }
+
+    /// Providers the session was created with, e.g. "CUDA > CPU"
+    const std::string &providers() const { return providers_; }
+
+    /**
+     * @brief Run a zero input of the given shape so that provider setup
+     *        (CUDA context, cuDNN autotuning, TensorRT build) happens now
+     *
+     * @return Milliseconds the runs took, or -1 on failure
+     */
+    double warmup(const std::vector<int64_t> &shape, int runs = 1);
+
+private:
+    std::unique_ptr<Ort::Session> session_;
+    std::string inputName_, outputName_;
+    std::string providers_;
+    Ort::MemoryInfo memoryInfo_ = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    Ort::IoBinding binding_{nullptr};
+
+    std::vector<float> inputData_;
+    std::vector<int64_t> inputShape_;
+    Ort::Value inputTensor_{nullptr};
+
+    std::vector<float> outputData_;
+    std::vector<int64_t> outputShape_;
+    Ort::Value outputTensor_{nullptr};
+
+    bool bindingsDirty_ = true;
+    bool outputBound_ = false;
+};
+
+/**
+ * @brief Pooled, dynamically batched inference for one model
+ *
+ * Callers submit single samples of a fixed shape from any thread. One worker
+ * per pooled session takes the first waiting request, waits up to
+ * maxLatencyMs for more (or until maxBatch are queued), runs them as one
+ * [N, ...] batch and hands every caller its slice of the output. Models
+ * exported with a fixed batch of 1 are detected on the first rejected batch
+ * and served one sample per run from then on.
+ *
+ * Usage:
+ *   auto service = InferenceService::shared("resnet18.onnx", {3, 224, 224}, opts);
+ *   std::vector<float> embedding = service->infer(std::move(sample));
+ */
+class InferenceService {
+public:
+    /// Throughput counters
+    struct Stats {
+        long long runs = 0;
+        long long samples = 0;
+        double meanBatch = 0.0;    ///< Samples per run
+        double meanRunMs = 0.0;    ///< Run latency (moving average)
+    };
+
+    /**
+     * @brief Load options.sessions sessions and start their workers
+     *
+     * @param modelPath ONNX file
+     * @param sampleShape Shape of one sample without the batch dimension
+     * @param options Providers, pool size and batching window
+     * @throws Ort::Exception when the model cannot be loaded
+     */
+    InferenceService(const std::string &modelPath, const std::vector<int64_t> &sampleShape,
+                     const InferenceOptions &options = InferenceOptions());
+
+    /// Stop the workers; pending requests fail with std::runtime_error
+    ~InferenceService();
+
+    InferenceService(const InferenceService &) = delete;
+    InferenceService &operator=(const InferenceService &) = delete;
+
+    /**
+     * @brief Service for a model shared by every caller in the process
+     *
+     * The first call for a path loads it; later calls with the same path
+     * return the same service (their options are ignored).
+     *
+     * @return The service, or nullptr if the model cannot be loaded
+     */
+    static std::shared_ptr<InferenceService> shared(const std::string &modelPath,
+                                                    const std::vector<int64_t> &sampleShape,
+                                                    const InferenceOptions &options = InferenceOptions());
+
+    /**
+     * @brief Queue one sample for the next batch
+     *
+     * @param sample sampleElements() floats
+     * @return The model output for this sample
+     */
+    std::future<std::vector<float>> submit(std::vector<float> sample);
+
+    /// submit() and wait
+    std::vector<float> infer(std::vector<float> sample) { return submit(std::move(sample)).get(); }
+
+    /**
+     * @brief Run every pooled session at batch 1 and maxBatch
+     *
+     * Call before the first submit(): the runs use the sessions directly.
+     * A model that rejects maxBatch is switched to single-sample runs.
+     *
+     * @return False if a warm-up run failed
+     */
+    bool warmup();
+
+    size_t sampleElements() const { return sampleElements_; }
+    const std::string &providers() const { return sessions_.front()->providers(); }
+    Stats stats() const;
+
+private:
+    struct Request {
+        std::vector<float> sample;
+        std::promise<std::vector<float>> result;
+    };
+
+    void workerLoop(InferenceSession &session);
+    bool runBatch(InferenceSession &session, std::vector<Request> &batch);
+
+    std::vector<int64_t> sampleShape_;
+    size_t sampleElements_ = 1;
+    int maxBatch_;
+    int maxLatencyMs_;
+    std::vector<std::unique_ptr<InferenceSession>> sessions_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;       ///< Guards everything below
+    std::condition_variable wake_;   ///< New request or stop
+    std::deque<Request> queue_;
+    bool stop_ = false;
+    bool singleOnly_ = false;        ///< Model rejected a batch > 1
+    Stats stats_;
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_INFERENCE_HPP
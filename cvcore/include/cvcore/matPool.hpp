@@ -0,0 +1,86 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Pooled cv::MatAllocator for frame-sized buffers. Large cv::Mat
+           allocations are served from size-class free lists of blocks
+           mapped with 2 MB pages where the OS allows, with a small cache per
+           thread in front of the shared lists; small ones go to OpenCV's
+           allocator unchanged.
+*/
+
+#ifndef CVCORE_MAT_POOL_HPP
+#define CVCORE_MAT_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cvcore {
+
+/**
+ * @brief Settings of the pool, fixed when it is installed
+ */
+struct MatPoolOptions {
+    size_t minBytes = 256 * 1024;                  ///< Smaller buffers use the previous allocator (min. 64 KB)
+    bool hugePages = true;                         ///< Try 2 MB pages (see installMatPool)
+    size_t threadCacheBytes = 32u * 1024 * 1024;   ///< Free blocks kept per thread
+    size_t maxCachedBytes = 512u * 1024 * 1024;    ///< Free blocks kept in the shared lists; more are unmapped
+};
+
+/**
+ * @brief Pool counters since installation
+ */
+struct MatPoolStats {
+    uint64_t hits = 0;          ///< Pooled allocations served from a free block
+    uint64_t misses = 0;        ///< Pooled allocations that mapped a new block
+    uint64_t passthrough = 0;   ///< Allocations below minBytes (or wrapping user data)
+    uint64_t released = 0;      ///< Blocks unmapped because the caches were full
+    uint64_t mappedBytes = 0;   ///< Bytes currently mapped by the pool
+    uint64_t cachedBytes = 0;   ///< Of these, bytes in free blocks
+    uint64_t hugeBytes = 0;     ///< Of these, bytes on 2 MB pages (explicit or transparent)
+};
+
+/**
+ * @brief Make the pool cv::Mat's default allocator (once per process)
+ *
+ * Buffers of at least minBytes are rounded up to a multiple of 64 KB (their
+ * size class) and taken from, in order: the calling thread's cache, the
+ * shared free list of the class, a new mapping. Released buffers go back to
+ * the releasing thread's cache, then to the shared list; beyond
+ * maxCachedBytes they are unmapped. A frame loop that allocates the same
+ * sizes every frame therefore stops mapping memory and faulting pages
+ * after its first frames.
+ *
+ * New blocks of 2 MB and more, with hugePages, are mapped with explicit
+ * huge pages (MAP_HUGETLB / MEM_LARGE_PAGES) when the system has them
+ * reserved, otherwise 2 MB-aligned with transparent huge pages advised
+ * (MADV_HUGEPAGE, Linux), otherwise with normal pages.
+ *
+ * Mats allocated before installation keep their allocator. Setting
+ * CVCORE_MAT_POOL=0 in the environment leaves the default allocator in
+ * place (for comparisons). Counters are exported as matpool_* metrics.
+ *
+ * @return bool True if the pool is installed (now or by an earlier call)
+ */
+bool installMatPool(const MatPoolOptions &options = MatPoolOptions());
+
+/**
+ * @brief True once installMatPool() has installed the pool
+ */
+bool matPoolInstalled();
+
+/**
+ * @brief Counters of the pool (all 0 if it is not installed)
+ */
+MatPoolStats matPoolStats();
+
+/**
+ * @brief Unmap every block in the shared free lists
+ *
+ * Blocks in per-thread caches stay until their thread reuses or releases
+ * them.
+ */
+void trimMatPool();
+
+} // namespace cvcore
+
+#endif // CVCORE_MAT_POOL_HPP
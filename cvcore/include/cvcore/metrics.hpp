@@ -0,0 +1,198 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Process-wide metrics for the long-running apps: counters, gauges
+           and log-linear latency histograms updated lock-free on the hot
+           path, exposed in the Prometheus text format over HTTP and / or
+           pushed to a StatsD daemon.
+*/
+
+#ifndef CVCORE_METRICS_HPP
+#define CVCORE_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace cvcore {
+
+/**
+ * @brief Monotonic count (frames, requests, drops)
+ */
+class Counter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief Value that goes up and down (queue depth, fps)
+ */
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    void add(double delta);
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @brief Latency distribution in microsecond buckets (HDR-style)
+ *
+ * Each power of two is split into SUB_BUCKETS linear buckets, so any
+ * duration from 1 us to days is kept to within 1 / SUB_BUCKETS (6 %) with a
+ * fixed array of atomic counts: observe() is one bit scan and one relaxed
+ * atomic add, safe from any number of threads. Quantiles and the
+ * Prometheus buckets are computed from the counts when read.
+ */
+class Histogram {
+public:
+    static const int SUB_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    /** @brief Record one duration in milliseconds */
+    void observeMs(double ms);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    /** @brief Sum of the recorded durations in seconds */
+    double sumSeconds() const { return sumUs_.load(std::memory_order_relaxed) * 1e-6; }
+
+    /**
+     * @brief Duration in milliseconds below which a fraction q of the samples lie
+     *
+     * Midpoint of the bucket holding the q-th sample; 0 when empty.
+     */
+    double quantileMs(double q) const;
+
+    /** @brief Samples of at most limitUs microseconds (bucket resolution) */
+    uint64_t countAtMostUs(uint64_t limitUs) const;
+
+private:
+    static int bucketOf(uint64_t us);
+    static uint64_t bucketLow(int bucket);
+    static uint64_t bucketHigh(int bucket);
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sumUs_{0};
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Named metrics of the process
+ *
+ * Lookups take a lock, so apps fetch each metric once and keep the
+ * reference (it lives as long as the process). A metric is identified by
+ * its name and an optional Prometheus label set such as
+ * "stage=\"capture\""; metrics sharing a name share its help text.
+ * Histograms are exposed as Prometheus histograms in seconds.
+ */
+class MetricsRegistry {
+public:
+    static MetricsRegistry &global();
+
+    Counter &counter(const std::string &name, const std::string &help,
+                     const std::string &labels = "");
+    Gauge &gauge(const std::string &name, const std::string &help,
+                 const std::string &labels = "");
+    Histogram &histogram(const std::string &name, const std::string &help,
+                         const std::string &labels = "");
+
+    /** @brief Every metric in the Prometheus text exposition format */
+    std::string prometheusText() const;
+
+    /**
+     * @brief StatsD lines since the previous call
+     *
+     * Counters as deltas ("|c"), gauges ("|g"), histograms as p50 / p95 /
+     * p99 gauges in milliseconds; labels become name suffixes.
+     */
+    std::string statsdText();
+
+private:
+    enum class Kind { Counter, Gauge, Histogram };
+
+    struct Family {
+        Kind kind;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;       ///< By label set
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        std::map<std::string, uint64_t> pushed;   ///< Counter values sent to StatsD
+    };
+
+    Family &family(const std::string &name, const std::string &help, Kind kind);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+/**
+ * @class MetricsExporter
+ * @brief Background threads publishing a registry
+ *
+ * startHttp() serves GET /metrics (Prometheus scrape) from one thread;
+ * startStatsd() sends the registry to a StatsD daemon over UDP every
+ * interval. Both stop in the destructor.
+ */
+class MetricsExporter {
+public:
+    explicit MetricsExporter(MetricsRegistry &registry = MetricsRegistry::global());
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+    /**
+     * @brief Listen for scrapes on host:port
+     * @return bool False if the port could not be bound
+     */
+    bool startHttp(int port, const std::string &host = "0.0.0.0");
+
+    /**
+     * @brief Push to a StatsD daemon every intervalMs
+     * @return bool False if host is not an IPv4 address
+     */
+    bool startStatsd(const std::string &host, int port, int intervalMs = 10000);
+
+    void stop();
+
+private:
+    void httpLoop();
+    void statsdLoop(int intervalMs);
+
+    MetricsRegistry &registry_;
+    std::atomic<bool> running_{false};
+    std::intptr_t listenSocket_;
+    std::intptr_t statsdSocket_;
+    std::thread httpThread_;
+    std::thread statsdThread_;
+};
+
+/**
+ * @brief Start the process exporter from the environment (once)
+ *
+ * CVCORE_METRICS_PORT=9464 serves /metrics on that port;
+ * CVCORE_STATSD=host:port pushes to StatsD. Apps call this at startup, so
+ * metrics cost nothing beyond the atomic updates unless a variable is set.
+ *
+ * @param app Name printed in the log line
+ * @return bool True if an exporter is running
+ */
+bool startMetricsFromEnvironment(const std::string &app);
+
+} // namespace cvcore
+
+#endif // CVCORE_METRICS_HPP
@@ -0,0 +1,56 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Row-band tiling shared by every module's per-pixel kernels.
+           Frames are split into cache-sized bands of rows which are
+           processed in parallel with cv::parallel_for_.
+*/
+
+#ifndef CVCORE_PARALLEL_HPP
+#define CVCORE_PARALLEL_HPP
+
+#include <opencv2/core.hpp>
+#include <functional>
+
+namespace cvcore {
+
+/**
+ * @brief Target working-set size of a single band in bytes
+ *
+ * Chosen so that one band of source + destination rows stays resident in a
+ * typical per-core L2 cache (256 KB - 1 MB) while a worker processes it.
+ */
+const size_t TILE_BAND_BYTES = 256 * 1024;
+
+/**
+ * @brief Compute how many rows go into one band
+ *
+ * @param rows Total number of rows in the frame
+ * @param bytesPerRow Bytes read and written per row by the filter
+ *                    (sum over all inputs, outputs and temporaries)
+ * @return Rows per band, at least 8 and at most rows
+ */
+int tileBandRows(int rows, size_t bytesPerRow);
+
+/**
+ * @brief Run a row-range body over a frame split into cache-sized row bands
+ *
+ * Bands are dispatched with cv::parallel_for_, so the thread count follows
+ * cv::setNumThreads(). The body receives a half-open row range [start, end)
+ * and must only write destination rows inside that range. Stencil filters
+ * may read source rows outside the range (the halo); they must not write
+ * shared temporaries, so any intermediate rows needed for the halo are
+ * recomputed into band-local buffers. Because every output pixel is computed
+ * by exactly the same arithmetic as the serial loop, results are
+ * bit-identical to single-threaded execution.
+ *
+ * @param rows Total number of rows in the frame
+ * @param bytesPerRow Bytes touched per row, used to size the bands
+ * @param body Function called once per band with its row range
+ */
+void parallelRowBands(int rows, size_t bytesPerRow,
+                      const std::function<void(const cv::Range &)> &body);
+
+} // namespace cvcore
+
+#endif // CVCORE_PARALLEL_HPP
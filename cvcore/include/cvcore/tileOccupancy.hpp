@@ -0,0 +1,93 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: One bit per 32 x 32 tile of a binary mask telling whether the
+           tile holds any foreground, so kernels on mostly-empty masks
+           (morphology, labelling) can skip the empty tiles.
+*/
+
+#ifndef CVCORE_TILE_OCCUPANCY_HPP
+#define CVCORE_TILE_OCCUPANCY_HPP
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace cvcore {
+
+/**
+ * @brief Occupancy of a mask's 32 x 32 tiles
+ *
+ * Tile (ty, tx) covers rows [32 ty, 32 ty + 32) and columns [32 tx, 32 tx + 32),
+ * clipped to the mask. A set bit may be conservative (the tile is empty
+ * after all) but a clear bit always means every pixel of the tile is 0;
+ * the sparse kernels rely only on that.
+ */
+class TileOccupancy {
+public:
+    static constexpr int kTileShift = 5;
+    static constexpr int kTileSize  = 1 << kTileShift;   ///< 32 pixels
+
+    TileOccupancy() = default;
+
+    /** All tiles of a mask of this size clear. */
+    void reset(cv::Size size);
+
+    /**
+     * @brief Set the tiles of mask holding a nonzero pixel
+     *
+     * @param mask CV_8UC1 mask
+     * @param within If given, only its set tiles are scanned; the others
+     *               are known to be empty and stay clear
+     */
+    void build(const cv::Mat &mask, const TileOccupancy *within = nullptr);
+
+    cv::Size size() const { return size_; }          ///< Mask size in pixels
+    int tileRows() const { return tileRows_; }
+    int tileCols() const { return tileCols_; }
+    bool empty() const { return tileRows_ == 0 || tileCols_ == 0; }
+
+    bool test(int ty, int tx) const {
+        return (row(ty)[tx >> 6] >> (tx & 63)) & 1;
+    }
+
+    /** Number of set tiles. */
+    int count() const;
+
+    /** Set tiles over all tiles, 0 for an empty map. */
+    double fraction() const;
+
+    /**
+     * @brief Tiles within radius pixels (Chebyshev) of a set tile
+     *
+     * Everything a (2 radius + 1) square operation reads for a pixel of a
+     * set tile, and everything a dilation by it can reach, lies in the
+     * grown tiles.
+     */
+    TileOccupancy grown(int radius) const;
+
+    /**
+     * @brief Runs of consecutive set tiles in a tile row
+     *
+     * @param ty Tile row
+     * @param spans Output half-open tile column ranges, left to right
+     */
+    void spans(int ty, std::vector<cv::Range> &spans) const;
+
+    /** Pixel rectangle of tiles [tx0, tx1) of tile row ty, clipped to the mask. */
+    cv::Rect pixelRect(int ty, int tx0, int tx1) const;
+
+private:
+    cv::Size size_;
+    int tileRows_ = 0;
+    int tileCols_ = 0;
+    int words_    = 0;                ///< 64-bit words per tile row
+    std::vector<uint64_t> bits_;      ///< tileRows_ x words_
+
+    uint64_t*       row(int ty)       { return bits_.data() + static_cast<size_t>(ty) * words_; }
+    const uint64_t* row(int ty) const { return bits_.data() + static_cast<size_t>(ty) * words_; }
+};
+
+} // namespace cvcore
+
+#endif // CVCORE_TILE_OCCUPANCY_HPP
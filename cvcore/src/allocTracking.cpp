@@ -0,0 +1,206 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the allocation counters: the replacement
+           operator new and the counting cv::MatAllocator (only with
+           CVCORE_ALLOC_TRACKING) and the per-stage totals.
+*/
+
+#include "cvcore/allocTracking.hpp"
+#include "cvcore/metrics.hpp"
+#include <opencv2/core.hpp>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace cvcore {
+
+namespace {
+
+// Constant-initialised: safe to touch from operator new at any point,
+// including before main() and during thread exit
+thread_local AllocCounts tlsCounts;
+
+#ifdef CVCORE_ALLOC_TRACKING
+
+/**
+ * Forwards to the allocator it replaced and counts the buffers it creates.
+ * The inner allocator stays the buffers' currAllocator, so releasing,
+ * mapping and copying go to it directly.
+ */
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    explicit CountingMatAllocator(cv::MatAllocator *inner) : inner_(inner) {}
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        cv::UMatData *u = inner_->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u && !data) {
+            tlsCounts.matCount++;
+            tlsCounts.matBytes += u->size;
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData *data, cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override {
+        return inner_->allocate(data, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData *data) const override { inner_->deallocate(data); }
+
+    cv::BufferPoolController *getBufferPoolController(const char *id) const override {
+        return inner_->getBufferPoolController(id);
+    }
+
+private:
+    cv::MatAllocator *inner_;
+};
+
+#endif
+
+std::mutex &stagesMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<std::unique_ptr<AllocStage>> &stages() {
+    static std::vector<std::unique_ptr<AllocStage>> list;
+    return list;
+}
+
+} // namespace
+
+bool allocTrackingEnabled() {
+#ifdef CVCORE_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocCounts threadAllocCounts() {
+    return tlsCounts;
+}
+
+void installMatAllocCounter() {
+#ifdef CVCORE_ALLOC_TRACKING
+    static std::once_flag once;
+    std::call_once(once, [] {
+        // Never freed: Mats may outlive every static destructor
+        cv::Mat::setDefaultAllocator(new CountingMatAllocator(cv::Mat::getDefaultAllocator()));
+    });
+#endif
+}
+
+// =============================================================================
+// AllocStage
+// =============================================================================
+
+AllocStage::AllocStage(const std::string &name) : name_(name) {
+    if (!allocTrackingEnabled()) {
+        return;
+    }
+    MetricsRegistry &metrics = MetricsRegistry::global();
+    const std::string stage = "stage=\"" + name + "\"";
+    heapCount_ = &metrics.counter("alloc_total", "Allocations per pipeline stage",
+                                  stage + ",kind=\"heap\"");
+    heapBytes_ = &metrics.counter("alloc_bytes_total", "Bytes allocated per pipeline stage",
+                                  stage + ",kind=\"heap\"");
+    matCount_ = &metrics.counter("alloc_total", "Allocations per pipeline stage",
+                                 stage + ",kind=\"mat\"");
+    matBytes_ = &metrics.counter("alloc_bytes_total", "Bytes allocated per pipeline stage",
+                                 stage + ",kind=\"mat\"");
+}
+
+AllocStage &AllocStage::get(const std::string &name) {
+    installMatAllocCounter();
+
+    std::lock_guard<std::mutex> lock(stagesMutex());
+    for (const auto &stage : stages()) {
+        if (stage->name_ == name) {
+            return *stage;
+        }
+    }
+    stages().emplace_back(new AllocStage(name));
+    return *stages().back();
+}
+
+std::vector<AllocStage *> AllocStage::all() {
+    std::lock_guard<std::mutex> lock(stagesMutex());
+    std::vector<AllocStage *> list;
+    for (const auto &stage : stages()) {
+        list.push_back(stage.get());
+    }
+    return list;
+}
+
+void AllocStage::add(const AllocCounts &delta) {
+    if (!heapCount_) {
+        return;
+    }
+    lastHeapCount_.store(delta.heapCount, std::memory_order_relaxed);
+    lastHeapBytes_.store(delta.heapBytes, std::memory_order_relaxed);
+    lastMatCount_.store(delta.matCount, std::memory_order_relaxed);
+    lastMatBytes_.store(delta.matBytes, std::memory_order_relaxed);
+    heapCount_->inc(delta.heapCount);
+    heapBytes_->inc(delta.heapBytes);
+    matCount_->inc(delta.matCount);
+    matBytes_->inc(delta.matBytes);
+}
+
+AllocCounts AllocStage::last() const {
+    AllocCounts counts;
+    counts.heapCount = lastHeapCount_.load(std::memory_order_relaxed);
+    counts.heapBytes = lastHeapBytes_.load(std::memory_order_relaxed);
+    counts.matCount = lastMatCount_.load(std::memory_order_relaxed);
+    counts.matBytes = lastMatBytes_.load(std::memory_order_relaxed);
+    return counts;
+}
+
+AllocCounts AllocStage::total() const {
+    AllocCounts counts;
+    if (heapCount_) {
+        counts.heapCount = heapCount_->value();
+        counts.heapBytes = heapBytes_->value();
+        counts.matCount = matCount_->value();
+        counts.matBytes = matBytes_->value();
+    }
+    return counts;
+}
+
+} // namespace cvcore
+
+#ifdef CVCORE_ALLOC_TRACKING
+
+// Array and nothrow forms default to these, so they are counted as well;
+// over-aligned new keeps the library version
+void *operator new(std::size_t size) {
+    cvcore::tlsCounts.heapCount++;
+    cvcore::tlsCounts.heapBytes += size;
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (void *p = std::malloc(size)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
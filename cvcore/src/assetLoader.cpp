@@ -0,0 +1,99 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of background asset loading.
+*/
+
+#include "cvcore/assetLoader.hpp"
+#include <cstdio>
+#include <exception>
+#include <iostream>
+
+namespace cvcore {
+
+AssetLoad::~AssetLoad() {
+    join();
+}
+
+std::string AssetLoad::error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+double AssetLoad::elapsedMs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const State s = state();
+    if (s == State::Idle) return 0.0;
+    const auto end = s == State::Loading ? std::chrono::steady_clock::now() : end_;
+    return std::chrono::duration<double, std::milli>(end - start_).count();
+}
+
+std::string AssetLoad::status() const {
+    char text[64];
+    switch (state()) {
+    case State::Idle:
+        return name_ + ": not loaded";
+    case State::Loading:
+        std::snprintf(text, sizeof(text), ": loading (%.1f s)", elapsedMs() / 1000.0);
+        return name_ + text;
+    case State::Ready:
+        return name_ + ": ready";
+    case State::Failed:
+    default:
+        return name_ + ": unavailable (" + error() + ")";
+    }
+}
+
+bool AssetLoad::wait(double timeoutMs) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto done = [this] { return state() != State::Loading; };
+    if (timeoutMs < 0.0)
+        finished_.wait(lock, done);
+    else
+        finished_.wait_for(lock, std::chrono::duration<double, std::milli>(timeoutMs), done);
+    return state() == State::Ready;
+}
+
+// The state is published under the mutex so wait() cannot miss the wake-up
+void AssetLoad::launch(const std::string &name, std::function<bool(std::string &)> body) {
+    if (state() != State::Idle) return;
+    name_ = name;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        start_ = std::chrono::steady_clock::now();
+        state_.store(State::Loading, std::memory_order_release);
+    }
+
+    thread_ = std::thread([this, body] {
+        std::string message;
+        bool ok = false;
+        try {
+            ok = body(message);
+        } catch (const std::exception &e) {
+            message = e.what();
+        } catch (...) {
+            message = "unknown error";
+        }
+
+        double ms;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            end_ = std::chrono::steady_clock::now();
+            ms = std::chrono::duration<double, std::milli>(end_ - start_).count();
+            if (!ok) error_ = message;
+            state_.store(ok ? State::Ready : State::Failed, std::memory_order_release);
+        }
+        finished_.notify_all();
+
+        if (ok)
+            std::cout << "Asset: " << name_ << " ready in " << static_cast<int>(ms) << " ms" << std::endl;
+        else
+            std::cerr << "Asset: " << name_ << " failed (" << message << ")" << std::endl;
+    });
+}
+
+void AssetLoad::join() {
+    if (thread_.joinable()) thread_.join();
+}
+
+} // namespace cvcore
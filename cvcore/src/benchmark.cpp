@@ -0,0 +1,433 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the benchmark harness: timing loop, percentile
+           summary, CPU capture (/proc and sysfs on Linux, the registry on
+           Windows, sysctl on macOS), JSON report and baseline comparison.
+*/
+
+#include "cvcore/benchmark.hpp"
+#include "cvcore/allocTracking.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+namespace cvcore {
+
+namespace {
+
+// Runtime-detected extensions worth knowing when comparing two reports
+const struct {
+    int feature;
+    const char *name;
+} CPU_FEATURES[] = {
+    {CV_CPU_SSE4_2, "SSE4_2"},
+    {CV_CPU_AVX, "AVX"},
+    {CV_CPU_FMA3, "FMA3"},
+    {CV_CPU_AVX2, "AVX2"},
+    {CV_CPU_AVX_512F, "AVX512F"},
+    {CV_CPU_AVX512_SKX, "AVX512_SKX"},
+    {CV_CPU_NEON, "NEON"},
+    {CV_CPU_FP16, "FP16"},
+};
+
+/**
+ * Nearest-rank percentile of sorted samples, p in [0, 1]
+ */
+double percentileSorted(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t k = std::min(sorted.size() - 1,
+                              static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    return sorted[k];
+}
+
+void summarize(BenchResult &r, std::vector<double> samplesMs, double itemsPerCall) {
+    std::sort(samplesMs.begin(), samplesMs.end());
+    double sum = 0.0;
+    for (double ms : samplesMs) {
+        sum += ms;
+    }
+    r.iterations = static_cast<int>(samplesMs.size());
+    if (samplesMs.empty()) {
+        return;
+    }
+    r.meanMs = sum / samplesMs.size();
+    r.minMs = samplesMs.front();
+    r.maxMs = samplesMs.back();
+    r.p50Ms = percentileSorted(samplesMs, 0.50);
+    r.p95Ms = percentileSorted(samplesMs, 0.95);
+    r.p99Ms = percentileSorted(samplesMs, 0.99);
+    r.throughput = r.p50Ms > 0.0 ? itemsPerCall * 1000.0 / r.p50Ms : 0.0;
+}
+
+#if defined(__linux__)
+std::string cpuInfoField(const std::string &key) {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, key.size(), key) == 0) {
+            const size_t value = line.find_first_not_of(" \t", line.find(':') + 1);
+            return value == std::string::npos ? "" : line.substr(value);
+        }
+    }
+    return "";
+}
+#endif
+
+void captureCpu(BenchEnvironment &env) {
+#if defined(__linux__)
+    env.cpuModel = cpuInfoField("model name");
+    if (env.cpuModel.empty()) {
+        env.cpuModel = cpuInfoField("Model");   // ARM boards
+    }
+    // Maximum clock from cpufreq; /proc/cpuinfo only has the current one
+    std::ifstream maxFreq("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    double kHz = 0.0;
+    if (maxFreq >> kHz) {
+        env.cpuMHz = kHz / 1000.0;
+    } else {
+        env.cpuMHz = std::atof(cpuInfoField("cpu MHz").c_str());
+    }
+#elif defined(_WIN32)
+    const char *KEY = "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
+    char name[256];
+    DWORD size = sizeof(name);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, KEY, "ProcessorNameString", RRF_RT_REG_SZ, nullptr,
+                     name, &size) == ERROR_SUCCESS) {
+        env.cpuModel = name;
+    }
+    DWORD mhz = 0;
+    size = sizeof(mhz);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, KEY, "~MHz", RRF_RT_REG_DWORD, nullptr, &mhz,
+                     &size) == ERROR_SUCCESS) {
+        env.cpuMHz = mhz;
+    }
+#elif defined(__APPLE__)
+    char name[256];
+    size_t size = sizeof(name);
+    if (sysctlbyname("machdep.cpu.brand_string", name, &size, nullptr, 0) == 0) {
+        env.cpuModel = name;
+    }
+    uint64_t hz = 0;
+    size = sizeof(hz);
+    if (sysctlbyname("hw.cpufrequency", &hz, &size, nullptr, 0) == 0) {
+        env.cpuMHz = hz / 1e6;
+    }
+#endif
+    // Trim the padding some vendors put in the brand string
+    const size_t first = env.cpuModel.find_first_not_of(' ');
+    env.cpuModel = first == std::string::npos
+                       ? "unknown"
+                       : env.cpuModel.substr(first, env.cpuModel.find_last_not_of(' ') - first + 1);
+}
+
+} // namespace
+
+// =============================================================================
+// BenchEnvironment / BenchResult
+// =============================================================================
+
+BenchEnvironment BenchEnvironment::capture() {
+    BenchEnvironment env;
+    captureCpu(env);
+    for (const auto &f : CPU_FEATURES) {
+        if (cv::checkHardwareSupport(f.feature)) {
+            env.cpuFeatures += (env.cpuFeatures.empty() ? "" : " ") + std::string(f.name);
+        }
+    }
+    env.logicalCores = static_cast<int>(std::thread::hardware_concurrency());
+    env.threads = cv::getNumThreads();
+    env.opencvVersion = CV_VERSION;
+    env.optimized = cv::useOptimized();
+    env.allocTracking = allocTrackingEnabled();
+    return env;
+}
+
+double BenchResult::metric(const std::string &key) const {
+    if (key == "p50_ms") return p50Ms;
+    if (key == "p95_ms") return p95Ms;
+    if (key == "p99_ms") return p99Ms;
+    if (key == "mean_ms") return meanMs;
+    if (key == "min_ms") return minMs;
+    return -1.0;
+}
+
+// =============================================================================
+// BenchOptions
+// =============================================================================
+
+bool BenchOptions::consume(int &i, int argc, char **argv) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) {
+        return false;
+    }
+    const char *value = argv[i + 1];
+    if (arg == "--json") jsonPath = value;
+    else if (arg == "--compare") comparePath = value;
+    else if (arg == "--tolerance") tolerance = std::atof(value);
+    else if (arg == "--metric") metric = value;
+    else if (arg == "--filter") filter = value;
+    else if (arg == "--min-time") minSeconds = std::atof(value);
+    else if (arg == "--warmup") warmup = std::max(0, std::atoi(value));
+    else return false;
+    ++i;
+    return true;
+}
+
+const char *BenchOptions::usage() {
+    return "  --json <file>       write results as JSON\n"
+           "  --compare <file>    compare with a baseline JSON; fails on regression\n"
+           "  --tolerance <frac>  allowed slowdown for --compare (default: 0.10)\n"
+           "  --metric <key>      compared latency: p50_ms, p95_ms, p99_ms, mean_ms (default: p50_ms)\n"
+           "  --filter <text>     only run cases whose name contains text\n"
+           "  --min-time <sec>    minimum timed duration per case (default: 0.3)\n"
+           "  --warmup <n>        untimed calls before timing (default: 1)\n";
+}
+
+// =============================================================================
+// BenchSuite
+// =============================================================================
+
+BenchSuite::BenchSuite(const std::string &name, const BenchOptions &options)
+    : name_(name), options_(options), environment_(BenchEnvironment::capture()) {
+    installMatAllocCounter();
+}
+
+bool BenchSuite::selected(const std::string &name) const {
+    return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+}
+
+BenchResult *BenchSuite::run(const std::string &name, const std::function<bool()> &fn,
+                             double itemsPerCall, const std::string &unit) {
+    if (!selected(name)) {
+        return nullptr;
+    }
+    for (int i = 0; i < options_.warmup; i++) {
+        if (!fn()) {
+            return nullptr;
+        }
+    }
+
+    // Reserved up front so the loop itself does not allocate
+    std::vector<double> times;
+    times.reserve(options_.maxIterations);
+    const AllocCounts before = threadAllocCounts();
+
+    double total = 0.0;
+    while (static_cast<int>(times.size()) < options_.minIterations ||
+           (total < options_.minSeconds &&
+            static_cast<int>(times.size()) < options_.maxIterations)) {
+        const auto start = std::chrono::steady_clock::now();
+        const bool ok = fn();
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!ok) {
+            return nullptr;
+        }
+        times.push_back(seconds * 1000.0);
+        total += seconds;
+    }
+
+    const AllocCounts delta = threadAllocCounts() - before;
+    BenchResult &r = addSamples(name, std::move(times), itemsPerCall, unit);
+    if (environment_.allocTracking) {
+        r.heapAllocsPerCall = static_cast<double>(delta.heapCount) / r.iterations;
+        r.matAllocsPerCall = static_cast<double>(delta.matCount) / r.iterations;
+    }
+    return &r;
+}
+
+BenchResult &BenchSuite::addSamples(const std::string &name, std::vector<double> samplesMs,
+                                    double itemsPerCall, const std::string &unit) {
+    BenchResult r;
+    r.name = name;
+    r.unit = unit;
+    summarize(r, std::move(samplesMs), itemsPerCall);
+    results_.push_back(r);
+    return results_.back();
+}
+
+void BenchSuite::printEnvironment(std::ostream &out) const {
+    const BenchEnvironment &e = environment_;
+    out << e.cpuModel;
+    if (e.cpuMHz > 0.0) {
+        out << " @ " << static_cast<int>(e.cpuMHz) << " MHz";
+    }
+    out << " (" << e.logicalCores << " cores; " << (e.cpuFeatures.empty() ? "-" : e.cpuFeatures)
+        << "), OpenCV " << e.opencvVersion << ", SIMD " << (e.optimized ? "on" : "off") << ", "
+        << e.threads << " threads" << std::endl;
+}
+
+bool BenchSuite::finish() {
+    bool ok = true;
+
+    if (!options_.jsonPath.empty()) {
+        cv::FileStorage fs(options_.jsonPath,
+                           cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
+        if (!fs.isOpened()) {
+            std::cerr << "Error: Unable to write " << options_.jsonPath << std::endl;
+            return false;
+        }
+        const BenchEnvironment &e = environment_;
+        fs << "suite" << name_;
+        fs << "environment" << "{";
+        fs << "cpu_model" << e.cpuModel << "cpu_mhz" << e.cpuMHz;
+        fs << "cpu_features" << e.cpuFeatures << "logical_cores" << e.logicalCores;
+        fs << "threads" << e.threads << "opencv_version" << e.opencvVersion;
+        fs << "simd" << (e.optimized ? 1 : 0) << "alloc_tracking" << (e.allocTracking ? 1 : 0);
+        fs << "}";
+        fs << "results" << "[";
+        for (const BenchResult &r : results_) {
+            fs << "{";
+            fs << "name" << r.name << "unit" << r.unit << "iterations" << r.iterations;
+            fs << "mean_ms" << r.meanMs << "min_ms" << r.minMs << "p50_ms" << r.p50Ms;
+            fs << "p95_ms" << r.p95Ms << "p99_ms" << r.p99Ms << "max_ms" << r.maxMs;
+            fs << "throughput" << r.throughput;
+            fs << "heap_allocs_per_call" << r.heapAllocsPerCall;
+            fs << "mat_allocs_per_call" << r.matAllocsPerCall;
+            if (!r.extra.empty()) {
+                fs << "extra" << "{";
+                for (const auto &kv : r.extra) {
+                    fs << kv.first << kv.second;
+                }
+                fs << "}";
+            }
+            if (!r.labels.empty()) {
+                fs << "labels" << "{";
+                for (const auto &kv : r.labels) {
+                    fs << kv.first << kv.second;
+                }
+                fs << "}";
+            }
+            fs << "}";
+        }
+        fs << "]";
+        std::cout << "\nResults written: " << options_.jsonPath << std::endl;
+    }
+
+    if (options_.comparePath.empty()) {
+        return ok;
+    }
+
+    cv::FileStorage fs(options_.comparePath, cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+    if (!fs.isOpened()) {
+        std::cerr << "Error: Unable to read baseline " << options_.comparePath << std::endl;
+        return false;
+    }
+    std::map<std::string, double> baseline;
+    const cv::FileNode list = fs["results"];
+    for (cv::FileNodeIterator it = list.begin(); it != list.end(); ++it) {
+        const cv::FileNode value = (*it)[options_.metric];
+        if (!value.empty()) {
+            baseline[(std::string)(*it)["name"]] = (double)value;
+        }
+    }
+
+    std::cout << "\n=== Comparison with " << options_.comparePath << " (" << options_.metric
+              << ", tolerance " << std::fixed << std::setprecision(0)
+              << options_.tolerance * 100.0 << "%) ===" << std::endl;
+    const std::string baselineCpu = (std::string)fs["environment"]["cpu_model"];
+    if (!baselineCpu.empty() && baselineCpu != environment_.cpuModel) {
+        std::cout << "Note: baseline was recorded on " << baselineCpu << std::endl;
+    }
+
+    int regressions = 0;
+    for (const BenchResult &r : results_) {
+        const auto found = baseline.find(r.name);
+        const double current = r.metric(options_.metric);
+        if (found == baseline.end() || found->second <= 0.0 || current < 0.0) {
+            continue;
+        }
+        const double change = current / found->second - 1.0;
+        const bool regressed = change > options_.tolerance;
+        regressions += regressed ? 1 : 0;
+        if (regressed || change < -options_.tolerance) {
+            std::cout << "  " << std::left << std::setw(44) << r.name << std::right << std::showpos
+                      << std::setprecision(1) << std::setw(8) << change * 100.0 << "%"
+                      << std::noshowpos << (regressed ? "  REGRESSION" : "  faster") << std::endl;
+        }
+    }
+    if (regressions == 0) {
+        std::cout << "No regressions" << std::endl;
+    } else {
+        std::cout << "Regressions: " << regressions << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// =============================================================================
+// Inputs
+// =============================================================================
+
+cv::Mat syntheticImage(cv::Size size, int type, uint64_t seed) {
+    CV_Assert(type == CV_8UC3 || type == CV_8UC1);
+
+    cv::Mat color(size, CV_8UC3);
+    for (int y = 0; y < size.height; y++) {
+        cv::Vec3b *row = color.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < size.width; x++) {
+            row[x] = cv::Vec3b(static_cast<uchar>(255 * x / size.width),
+                               static_cast<uchar>(255 * y / size.height),
+                               static_cast<uchar>(128 + 127 * ((x + y) % 64) / 64));
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        const cv::Point c(size.width * (i + 1) / 9,
+                          size.height / 2 + (i % 2 ? 1 : -1) * size.height / 5);
+        cv::circle(color, c, size.height / 10, cv::Scalar(40 * i, 255 - 30 * i, 90), cv::FILLED);
+    }
+    cv::Mat noise(size, CV_8UC3);
+    cv::RNG rng(seed);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(16));
+    cv::add(color, noise, color);
+
+    if (type == CV_8UC1) {
+        cv::Mat gray;
+        cv::cvtColor(color, gray, cv::COLOR_BGR2GRAY);
+        return gray;
+    }
+    return color;
+}
+
+std::string benchDataDir() {
+    if (const char *dir = std::getenv("CVCORE_BENCH_DATA")) {
+        return dir;
+    }
+#ifdef _WIN32
+    const char *cache = std::getenv("LOCALAPPDATA");
+    return std::string(cache ? cache : ".") + "\\cvcore-bench";
+#else
+    if (const char *cache = std::getenv("XDG_CACHE_HOME")) {
+        return std::string(cache) + "/cvcore-bench";
+    }
+    const char *home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.cache/cvcore-bench";
+#endif
+}
+
+std::string benchDataPath(const std::string &name) {
+    const std::filesystem::path path = std::filesystem::path(benchDataDir()) / name;
+    std::error_code ec;
+    return std::filesystem::exists(path, ec) ? path.string() : std::string();
+}
+
+} // namespace cvcore
@@ -0,0 +1,324 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: cv::VideoCapture and image-sequence frame sources, and the spec
+           parsing that picks a source.
+*/
+
+#include "cvcore/capture.hpp"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/videoio.hpp>
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cvcore {
+
+#ifdef CVCORE_WITH_V4L2
+// v4l2Source.cpp
+std::unique_ptr<FrameSource> openV4l2Source(const std::string &device);
+#endif
+
+namespace {
+
+const int NETWORK_TIMEOUT_MS = 5000;
+const int PREFETCH_FRAMES = 4;
+
+/**
+ * cv::VideoCapture source: cameras without V4L2, files, streams, GStreamer
+ */
+class VideoCaptureSource : public FrameSource {
+public:
+    VideoCaptureSource(Kind kind, const std::string &spec, int camera)
+        : FrameSource(kind), spec_(spec), camera_(camera) {}
+
+    bool reopen() override {
+        cap_.release();
+        if (kind_ == Kind::Camera) {
+            if (!cap_.open(camera_)) {
+                return false;
+            }
+        } else if (!openStream()) {
+            return false;
+        }
+
+        hwDecode_ = cap_.get(cv::CAP_PROP_HW_ACCELERATION) > 0;
+        description_ = (kind_ == Kind::Camera ? "camera " + std::to_string(camera_) : spec_) +
+                       " (" + cap_.getBackendName() + (hwDecode_ ? ", HW decode)" : ")");
+        return true;
+    }
+
+    bool read(Frame &frame) override {
+        frame.raw.release();
+        if (!cap_.read(frame.image) || frame.image.empty()) {
+            return false;
+        }
+        const double ms = cap_.get(cv::CAP_PROP_POS_MSEC);
+        stamp(frame, ms > 0.0 ? ms : -1.0);
+        return true;
+    }
+
+    cv::Size frameSize() const override {
+        return cv::Size(static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH)),
+                        static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    }
+
+    double fps() const override { return std::max(0.0, cap_.get(cv::CAP_PROP_FPS)); }
+
+    bool hardwareDecode() const override { return hwDecode_; }
+
+private:
+    // Hardware decoding where the backend supports it, software otherwise
+    bool openStream() {
+        std::vector<int> props = {cv::CAP_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_ANY};
+        if (kind_ == Kind::Network) {
+            props.insert(props.end(), {cv::CAP_PROP_OPEN_TIMEOUT_MSEC, NETWORK_TIMEOUT_MS,
+                                       cv::CAP_PROP_READ_TIMEOUT_MSEC, NETWORK_TIMEOUT_MS});
+        }
+        const int api = kind_ == Kind::GStreamer ? cv::CAP_GSTREAMER : cv::CAP_FFMPEG;
+
+        if (cap_.open(spec_, api, props)) {
+            return true;
+        }
+        if (cap_.open(spec_, api)) {
+            return true;
+        }
+        return kind_ != Kind::GStreamer && cap_.open(spec_, cv::CAP_ANY);
+    }
+
+    mutable cv::VideoCapture cap_;
+    std::string spec_;
+    int camera_;
+    bool hwDecode_ = false;
+};
+
+/**
+ * Image sequence: a prefetch thread decodes up to PREFETCH_FRAMES images
+ * ahead, so read() rarely waits for imread. Decoded buffers are recycled.
+ */
+class ImageSequenceSource : public FrameSource {
+public:
+    ImageSequenceSource(const std::string &spec, std::vector<std::string> paths)
+        : FrameSource(Kind::ImageSequence), spec_(spec), paths_(std::move(paths)) {}
+
+    ~ImageSequenceSource() override { stop(); }
+
+    bool reopen() override {
+        stop();
+        if (paths_.empty()) {
+            return false;
+        }
+        const cv::Mat first = cv::imread(paths_.front(), cv::IMREAD_COLOR);
+        if (first.empty()) {
+            return false;
+        }
+        size_ = first.size();
+        description_ = spec_ + " (" + std::to_string(paths_.size()) + " images)";
+
+        next_ = 0;
+        stop_ = false;
+        ready_.clear();
+        prefetcher_ = std::thread(&ImageSequenceSource::prefetch, this);
+        return true;
+    }
+
+    bool read(Frame &frame) override {
+        frame.raw.release();
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return !ready_.empty() || done_; });
+        if (ready_.empty()) {
+            return false;
+        }
+
+        // Hand the decoded image over and give the caller's buffer back
+        std::swap(frame.image, ready_.front());
+        spare_.push_back(std::move(ready_.front()));
+        ready_.pop_front();
+        lock.unlock();
+        wake_.notify_all();
+
+        stamp(frame, -1.0);
+        return !frame.image.empty();
+    }
+
+    cv::Size frameSize() const override { return size_; }
+
+    double fps() const override { return 0.0; }
+
+private:
+    void prefetch() {
+        for (;;) {
+            cv::Mat buffer;
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] {
+                    return stop_ || static_cast<int>(ready_.size()) < PREFETCH_FRAMES;
+                });
+                if (stop_ || next_ >= paths_.size()) {
+                    break;
+                }
+                index = next_++;
+                if (!spare_.empty()) {
+                    buffer = std::move(spare_.back());
+                    spare_.pop_back();
+                }
+            }
+
+            // Unreadable files are skipped
+            cv::Mat decoded = cv::imread(paths_[index], cv::IMREAD_COLOR);
+            if (decoded.empty()) {
+                continue;
+            }
+            if (buffer.size() == decoded.size() && buffer.type() == decoded.type()) {
+                decoded.copyTo(buffer);
+            } else {
+                buffer = decoded;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(std::move(buffer));
+            wake_.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+        wake_.notify_all();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        if (prefetcher_.joinable()) {
+            prefetcher_.join();
+        }
+        done_ = false;
+    }
+
+    std::string spec_;
+    std::vector<std::string> paths_;
+    cv::Size size_;
+
+    std::mutex mutex_;               ///< Guards everything below
+    std::condition_variable wake_;   ///< Image ready / slot freed / stop
+    std::deque<cv::Mat> ready_;
+    std::vector<cv::Mat> spare_;
+    size_t next_ = 0;
+    bool stop_ = false;
+    bool done_ = false;
+    std::thread prefetcher_;
+};
+
+bool isImagePath(const std::filesystem::path &path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" ||
+           ext == ".tif" || ext == ".tiff" || ext == ".ppm" || ext == ".pgm" || ext == ".webp";
+}
+
+/// Paths of an image sequence spec, empty if spec is not one
+std::vector<std::string> sequencePaths(const std::string &spec) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+    std::error_code ec;
+
+    if (fs::is_directory(spec, ec)) {
+        for (const auto &entry : fs::directory_iterator(spec, ec)) {
+            if (entry.is_regular_file(ec) && isImagePath(entry.path())) {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+    } else if (spec.find('%') != std::string::npos) {
+        // printf pattern: from index 0 or 1 until the first missing file
+        char name[4096];
+        for (int i = 0;; i++) {
+            std::snprintf(name, sizeof(name), spec.c_str(), i);
+            if (!fs::exists(name, ec)) {
+                if (i == 0) {
+                    continue;
+                }
+                break;
+            }
+            paths.push_back(name);
+        }
+    } else if (fs::path(spec).extension() == ".txt") {
+        std::ifstream list(spec);
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                paths.push_back(line);
+            }
+        }
+    }
+    return paths;
+}
+
+bool allDigits(const std::string &s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(),
+                                     [](unsigned char c) { return std::isdigit(c) != 0; });
+}
+
+} // namespace
+
+bool FrameSource::read(cv::Mat &image) {
+    std::swap(scratch_.image, image);
+    const bool ok = read(scratch_);
+    std::swap(scratch_.image, image);
+    return ok;
+}
+
+std::unique_ptr<FrameSource> FrameSource::open(const std::string &spec, int camera) {
+    std::unique_ptr<FrameSource> source;
+
+    if (spec.empty() || allDigits(spec)) {
+        const int index = spec.empty() ? camera : std::stoi(spec);
+#ifdef CVCORE_WITH_V4L2
+        source = openV4l2Source("/dev/video" + std::to_string(index));
+        if (source) {
+            return source;
+        }
+#endif
+        source = std::make_unique<VideoCaptureSource>(Kind::Camera, "", index);
+    } else if (spec.rfind("/dev/video", 0) == 0) {
+#ifdef CVCORE_WITH_V4L2
+        source = openV4l2Source(spec);
+        if (source) {
+            return source;
+        }
+#endif
+        source = std::make_unique<VideoCaptureSource>(Kind::File, spec, 0);
+    } else if (spec.find(" ! ") != std::string::npos) {
+        source = std::make_unique<VideoCaptureSource>(Kind::GStreamer, spec, 0);
+    } else if (spec.find("://") != std::string::npos) {
+        source = std::make_unique<VideoCaptureSource>(Kind::Network, spec, 0);
+    } else {
+        std::vector<std::string> paths = sequencePaths(spec);
+        if (!paths.empty()) {
+            source = std::make_unique<ImageSequenceSource>(spec, std::move(paths));
+        } else {
+            source = std::make_unique<VideoCaptureSource>(Kind::File, spec, 0);
+        }
+    }
+
+    if (!source->reopen()) {
+        return nullptr;
+    }
+    return source;
+}
+
+} // namespace cvcore
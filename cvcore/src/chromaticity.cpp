@@ -0,0 +1,177 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the rg chromaticity kernels.
+*/
+
+#include "cvcore/chromaticity.hpp"
+#include "cvcore/histogram.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace cvcore {
+
+namespace {
+
+/// Bin scale (histsize - 1) / (R+G+B) for every sum; black counts as sum 1
+void fillBinScale(float *scale, int histsize) {
+    scale[0] = static_cast<float>(histsize - 1);
+    for (int sum = 1; sum < 766; sum++) {
+        scale[sum] = static_cast<float>(histsize - 1) / sum;
+    }
+}
+
+/// Work-items per work-group of the OpenCL counter
+const int OCL_GROUP_SIZE = 256;
+
+/// Work-groups per compute unit (each work-item strides over the image)
+const int OCL_GROUPS_PER_UNIT = 4;
+
+const char *RG_CHROMATICITY_KERNEL =
+    "#pragma OPENCL FP_CONTRACT OFF\n"
+    "__kernel void rgChromaticity(\n"
+    "    __global const uchar *src, int src_step, int src_offset, int rows, int cols,\n"
+    "    __global const float *scale, __global uint *counts)\n"
+    "{\n"
+    "#ifdef LOCAL_BINS\n"
+    "    __local uint bins[BINS];\n"
+    "    for (int i = get_local_id(0); i < BINS; i += get_local_size(0)) bins[i] = 0;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "#else\n"
+    "    __global uint *bins = counts;\n"
+    "#endif\n"
+    "    const int total = rows * cols;\n"
+    "    for (int p = get_global_id(0); p < total; p += get_global_size(0)) {\n"
+    "        const int y = p / cols;\n"
+    "        __global const uchar *s = src + mad24(y, src_step, src_offset + (p - y * cols) * 3);\n"
+    "        const int B = s[0], G = s[1], R = s[2];\n"
+    "        const float k = scale[R + G + B];\n"
+    "        atomic_inc(&bins[(int)(R * k + 0.5f) * HISTSIZE + (int)(G * k + 0.5f)]);\n"
+    "    }\n"
+    "#ifdef LOCAL_BINS\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    for (int i = get_local_id(0); i < BINS; i += get_local_size(0))\n"
+    "        if (bins[i]) atomic_add(&counts[i], bins[i]);\n"
+    "#endif\n"
+    "}\n";
+
+} // namespace
+
+std::vector<uint32_t> countRgChromaticity(const cv::Mat &src, int histsize, bool parallel) {
+    CV_Assert(src.type() == CV_8UC3 && histsize > 1);
+
+    float scale[766];
+    fillBinScale(scale, histsize);
+
+    // One stripe per thread, or the whole image as one stripe when serial
+    const int minRows = parallel ? 1 : std::max(1, src.rows);
+    return parallelHistogram(src.rows, histsize * histsize,
+                             [&](const cv::Range &range, uint32_t *bins) {
+        for (int i = range.start; i < range.end; i++) {
+            const cv::Vec3b *ptr = src.ptr<cv::Vec3b>(i);
+            for (int j = 0; j < src.cols; j++) {
+                const int B = ptr[j][0];
+                const int G = ptr[j][1];
+                const int R = ptr[j][2];
+
+                const float k = scale[R + G + B];
+                const int rindex = static_cast<int>(R * k + 0.5f);
+                const int gindex = static_cast<int>(G * k + 0.5f);
+
+                bins[rindex * histsize + gindex]++;
+            }
+        }
+    }, minRows);
+}
+
+double chromaticFraction(const std::vector<uint32_t> &counts, int histsize, float minDistance) {
+    const float neutral = 1.0f / 3.0f;
+    const float step = 1.0f / (histsize - 1);
+    const float minSquared = minDistance * minDistance;
+
+    uint64_t total = 0, chromatic = 0;
+    for (int i = 0; i < histsize; i++) {
+        const float dr = i * step - neutral;
+        for (int j = 0; j < histsize; j++) {
+            const uint32_t n = counts[static_cast<size_t>(i) * histsize + j];
+            const float dg = j * step - neutral;
+            total += n;
+            if (dr * dr + dg * dg >= minSquared) {
+                chromatic += n;
+            }
+        }
+    }
+    return total > 0 ? static_cast<double>(chromatic) / total : 0.0;
+}
+
+OclChromaticityCounter::OclChromaticityCounter(int histsize) : histsize_(histsize) {
+    CV_Assert(histsize > 1);
+    if (!cv::ocl::haveOpenCL()) {
+        return;
+    }
+    cv::ocl::setUseOpenCL(true);
+
+    const cv::ocl::Device &device = cv::ocl::Device::getDefault();
+    const size_t bins = static_cast<size_t>(histsize) * histsize;
+    local_ = bins * sizeof(uint32_t) <= device.localMemSize() / 2;
+
+    cv::String buildErrors;
+    cv::ocl::ProgramSource source(RG_CHROMATICITY_KERNEL);
+    const cv::String options = cv::format("-D HISTSIZE=%d -D BINS=%d%s", histsize,
+                                          static_cast<int>(bins), local_ ? " -D LOCAL_BINS" : "");
+    if (!kernel_.create("rgChromaticity", source, options, &buildErrors)) {
+        std::cerr << "OclChromaticityCounter: kernel build failed" << std::endl;
+        return;
+    }
+    if (!computeQueue_.create(cv::ocl::Context::getDefault(), device)) {
+        kernel_ = cv::ocl::Kernel();
+        return;
+    }
+
+    cv::Mat scale(1, 766, CV_32F);
+    fillBinScale(scale.ptr<float>(), histsize);
+    scale.copyTo(scale_);
+}
+
+bool OclChromaticityCounter::upload(int slot, const cv::Mat &src) {
+    CV_Assert(src.type() == CV_8UC3 && slot >= 0 && slot < SLOTS);
+    if (!available()) {
+        return false;
+    }
+    Slot &s = slots_[slot];
+    src.copyTo(s.image);
+    s.counts.create(histsize_, histsize_, CV_32S);
+    s.counts.setTo(cv::Scalar(0));
+    // The kernel runs on the other queue: the copy and the clear must be done
+    cv::ocl::Queue::getDefault().finish();
+    return true;
+}
+
+bool OclChromaticityCounter::launch(int slot) {
+    CV_Assert(slot >= 0 && slot < SLOTS);
+    if (!available() || slots_[slot].image.empty()) {
+        return false;
+    }
+    const cv::ocl::Device &device = cv::ocl::Device::getDefault();
+    size_t localSize[1] = {std::min<size_t>(OCL_GROUP_SIZE, device.maxWorkGroupSize())};
+    size_t globalSize[1] = {localSize[0] * std::max(1, device.maxComputeUnits()) * OCL_GROUPS_PER_UNIT};
+
+    Slot &s = slots_[slot];
+    kernel_.args(cv::ocl::KernelArg::ReadOnly(s.image), cv::ocl::KernelArg::PtrReadOnly(scale_),
+                 cv::ocl::KernelArg::PtrReadWrite(s.counts));
+    return kernel_.run(1, globalSize, localSize, false, computeQueue_);
+}
+
+bool OclChromaticityCounter::download(int slot, std::vector<uint32_t> &counts) {
+    CV_Assert(slot >= 0 && slot < SLOTS);
+    if (!available() || slots_[slot].counts.empty()) {
+        return false;
+    }
+    computeQueue_.finish();
+    counts.resize(static_cast<size_t>(histsize_) * histsize_);
+    cv::Mat host(histsize_, histsize_, CV_32S, counts.data());
+    slots_[slot].counts.copyTo(host);
+    return true;
+}
+
+} // namespace cvcore
@@ -0,0 +1,109 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the shared colour conversion and LUT kernels.
+*/
+
+#include "cvcore/color.hpp"
+#include "cvcore/parallel.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+
+namespace cvcore {
+
+void bgrToGrayRow(const uchar *bgr, uchar *gray, int cols) {
+    int x = 0;
+#if CV_SIMD128
+    if (cv::useOptimized()) {
+        const cv::v_uint32x4 wb = cv::v_setall_u32(GRAY_B);
+        const cv::v_uint32x4 wg = cv::v_setall_u32(GRAY_G);
+        const cv::v_uint32x4 wr = cv::v_setall_u32(GRAY_R);
+        const cv::v_uint32x4 half = cv::v_setall_u32(1u << (GRAY_SHIFT - 1));
+        for (; x + 16 <= cols; x += 16) {
+            cv::v_uint8x16 b, g, r;
+            cv::v_load_deinterleave(bgr + 3 * x, b, g, r);
+
+            cv::v_uint16x8 b16[2], g16[2], r16[2];
+            cv::v_expand(b, b16[0], b16[1]);
+            cv::v_expand(g, g16[0], g16[1]);
+            cv::v_expand(r, r16[0], r16[1]);
+
+            cv::v_uint16x8 y16[2];
+            for (int h = 0; h < 2; h++) {
+                cv::v_uint32x4 bLo, bHi, gLo, gHi, rLo, rHi;
+                cv::v_expand(b16[h], bLo, bHi);
+                cv::v_expand(g16[h], gLo, gHi);
+                cv::v_expand(r16[h], rLo, rHi);
+                cv::v_uint32x4 lo = bLo * wb + gLo * wg + rLo * wr + half;
+                cv::v_uint32x4 hi = bHi * wb + gHi * wg + rHi * wr + half;
+                y16[h] = cv::v_pack(cv::v_shr<GRAY_SHIFT>(lo), cv::v_shr<GRAY_SHIFT>(hi));
+            }
+            cv::v_store(gray + x, cv::v_pack(y16[0], y16[1]));
+        }
+    }
+#endif
+    for (; x < cols; x++) {
+        const uchar *p = bgr + 3 * x;
+        gray[x] = static_cast<uchar>((p[0] * GRAY_B + p[1] * GRAY_G + p[2] * GRAY_R +
+                                      (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+    }
+}
+
+void bgrToGray(const cv::Mat &src, cv::Mat &dst) {
+    CV_Assert(src.type() == CV_8UC3);
+    cv::Mat gray(src.size(), CV_8UC1);
+    parallelRowBands(src.rows, static_cast<size_t>(src.cols) * 4, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            bgrToGrayRow(src.ptr<uchar>(y), gray.ptr<uchar>(y), src.cols);
+        }
+    });
+    dst = gray;
+}
+
+void applyLut(const cv::Mat &src, const uchar *lut, cv::Mat &dst) {
+    CV_Assert(src.depth() == CV_8U && lut != nullptr);
+    dst.create(src.size(), src.type());
+    const int n = src.cols * src.channels();
+
+    parallelRowBands(src.rows, static_cast<size_t>(n) * 2, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            const uchar *in = src.ptr<uchar>(y);
+            uchar *out = dst.ptr<uchar>(y);
+            int i = 0;
+            // Four independent lookups per step hide the load latency
+            for (; i + 4 <= n; i += 4) {
+                const uchar a = lut[in[i]];
+                const uchar b = lut[in[i + 1]];
+                const uchar c = lut[in[i + 2]];
+                const uchar d = lut[in[i + 3]];
+                out[i] = a;
+                out[i + 1] = b;
+                out[i + 2] = c;
+                out[i + 3] = d;
+            }
+            for (; i < n; i++) {
+                out[i] = lut[in[i]];
+            }
+        }
+    });
+}
+
+void applyLutPerChannel(const cv::Mat &src, const uchar (*luts)[256], cv::Mat &dst) {
+    CV_Assert(src.depth() == CV_8U && luts != nullptr);
+    dst.create(src.size(), src.type());
+    const int cn = src.channels();
+    const int cols = src.cols;
+
+    parallelRowBands(src.rows, static_cast<size_t>(cols) * cn * 2, [&](const cv::Range &band) {
+        for (int y = band.start; y < band.end; y++) {
+            const uchar *in = src.ptr<uchar>(y);
+            uchar *out = dst.ptr<uchar>(y);
+            for (int x = 0; x < cols; x++, in += cn, out += cn) {
+                for (int c = 0; c < cn; c++) {
+                    out[c] = luts[c][in[c]];
+                }
+            }
+        }
+    });
+}
+
+} // namespace cvcore
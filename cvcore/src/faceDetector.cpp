@@ -0,0 +1,176 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the pooled YuNet face detection service.
+*/
+
+#include "cvcore/faceDetector.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace cvcore {
+
+FaceDetectorService::FaceDetectorService(const std::string &modelPath,
+                                         const FaceDetectorOptions &options)
+    : modelPath_(modelPath),
+      options_(options),
+      maxDetectors_(std::max(1, options.detectors > 0 ? options.detectors : cv::getNumThreads())) {
+    options_.inputSize = std::max(32, options_.inputSize);
+
+    // Load one detector now so a missing or broken model fails here
+    idle_.push_back(createDetector());
+    created_ = 1;
+}
+
+FaceDetectorService::~FaceDetectorService() = default;
+
+std::shared_ptr<FaceDetectorService> FaceDetectorService::shared(const std::string &modelPath,
+                                                                 const FaceDetectorOptions &options) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<FaceDetectorService>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (std::shared_ptr<FaceDetectorService> existing = registry[modelPath].lock()) {
+        return existing;
+    }
+
+    try {
+        auto service = std::make_shared<FaceDetectorService>(modelPath, options);
+        registry[modelPath] = service;
+        return service;
+    } catch (const cv::Exception &e) {
+        std::cerr << "FaceDetectorService: Cannot load " << modelPath << " (" << e.what() << ")"
+                  << std::endl;
+        return nullptr;
+    }
+}
+
+std::unique_ptr<FaceDetectorService::Detector> FaceDetectorService::createDetector() const {
+    std::unique_ptr<Detector> detector(new Detector());
+    detector->inputSize = cv::Size(options_.inputSize, options_.inputSize);
+    detector->net = cv::FaceDetectorYN::create(modelPath_, "", detector->inputSize,
+                                               options_.scoreThreshold, options_.nmsThreshold,
+                                               options_.topK);
+    if (detector->net.empty()) {
+        CV_Error(cv::Error::StsError, "FaceDetectorYN::create failed");
+    }
+    return detector;
+}
+
+std::unique_ptr<FaceDetectorService::Detector> FaceDetectorService::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (!idle_.empty()) {
+            std::unique_ptr<Detector> detector = std::move(idle_.back());
+            idle_.pop_back();
+            return detector;
+        }
+        if (created_ < maxDetectors_) {
+            // Load outside the lock; other callers keep using the pool
+            created_++;
+            lock.unlock();
+            try {
+                return createDetector();
+            } catch (...) {
+                lock.lock();
+                created_--;
+                throw;
+            }
+        }
+        available_.wait(lock);
+    }
+}
+
+void FaceDetectorService::release(std::unique_ptr<Detector> detector) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(std::move(detector));
+        images_++;
+    }
+    available_.notify_one();
+}
+
+std::vector<cv::Rect> FaceDetectorService::detect(const cv::Mat &image, std::vector<float> *scores) {
+    std::vector<cv::Rect> faces;
+    if (scores) {
+        scores->clear();
+    }
+    if (image.empty() || image.depth() != CV_8U ||
+        (image.channels() != 1 && image.channels() != 3)) {
+        return faces;
+    }
+
+    // Shrink so the longest side is at most inputSize; never enlarge
+    const int longest = std::max(image.cols, image.rows);
+    const double scale = longest > options_.inputSize
+                             ? static_cast<double>(options_.inputSize) / longest : 1.0;
+    cv::Mat input = image;
+    if (scale < 1.0) {
+        cv::resize(image, input,
+                   cv::Size(std::max(1, cvRound(image.cols * scale)),
+                            std::max(1, cvRound(image.rows * scale))),
+                   0, 0, cv::INTER_AREA);
+    }
+    if (input.channels() == 1) {
+        cv::cvtColor(input, input, cv::COLOR_GRAY2BGR);
+    }
+
+    std::unique_ptr<Detector> detector = acquire();
+    cv::Mat found;
+    try {
+        if (detector->inputSize != input.size()) {
+            detector->net->setInputSize(input.size());
+            detector->inputSize = input.size();
+        }
+        detector->net->detect(input, found);
+    } catch (const cv::Exception &e) {
+        std::cerr << "FaceDetectorService: Detection failed (" << e.what() << ")" << std::endl;
+        found.release();
+    }
+    release(std::move(detector));
+
+    // Rows are x, y, w, h, five landmarks (x, y), score
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    for (int i = 0; i < found.rows; i++) {
+        const float *row = found.ptr<float>(i);
+        const cv::Rect box = cv::Rect(cvRound(row[0] / scale), cvRound(row[1] / scale),
+                                      cvRound(row[2] / scale), cvRound(row[3] / scale)) & bounds;
+        if (box.area() == 0) {
+            continue;
+        }
+        faces.push_back(box);
+        if (scores) {
+            scores->push_back(row[14]);
+        }
+    }
+    return faces;
+}
+
+std::vector<std::vector<cv::Rect>> FaceDetectorService::detectBatch(const std::vector<cv::Mat> &images) {
+    std::vector<std::vector<cv::Rect>> faces(images.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(images.size())), [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; i++) {
+            faces[i] = detect(images[i]);
+        }
+    }, maxDetectors_);
+    return faces;
+}
+
+std::string FaceDetectorService::tag() const {
+    const size_t slash = modelPath_.find_last_of("/\\");
+    std::ostringstream out;
+    out << (slash == std::string::npos ? modelPath_ : modelPath_.substr(slash + 1))
+        << ",input=" << options_.inputSize << ",score=" << options_.scoreThreshold
+        << ",nms=" << options_.nmsThreshold;
+    return out.str();
+}
+
+long long FaceDetectorService::images() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return images_;
+}
+
+} // namespace cvcore
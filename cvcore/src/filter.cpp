@@ -0,0 +1,141 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the shared integer stencil filters.
+*/
+
+#include "cvcore/filter.hpp"
+#include "cvcore/parallel.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+
+namespace cvcore {
+
+void sobel3x3Row(const uchar *up, const uchar *mid, const uchar *down, int cols,
+                 short *gx, short *gy) {
+    int x = 0;
+#if CV_SIMD128
+    if (cv::useOptimized()) {
+        for (; x + 8 <= cols; x += 8) {
+            cv::v_int16x8 uL = cv::v_reinterpret_as_s16(cv::v_load_expand(up + x));
+            cv::v_int16x8 uC = cv::v_reinterpret_as_s16(cv::v_load_expand(up + x + 1));
+            cv::v_int16x8 uR = cv::v_reinterpret_as_s16(cv::v_load_expand(up + x + 2));
+            cv::v_int16x8 mL = cv::v_reinterpret_as_s16(cv::v_load_expand(mid + x));
+            cv::v_int16x8 mR = cv::v_reinterpret_as_s16(cv::v_load_expand(mid + x + 2));
+            cv::v_int16x8 dL = cv::v_reinterpret_as_s16(cv::v_load_expand(down + x));
+            cv::v_int16x8 dC = cv::v_reinterpret_as_s16(cv::v_load_expand(down + x + 1));
+            cv::v_int16x8 dR = cv::v_reinterpret_as_s16(cv::v_load_expand(down + x + 2));
+
+            // |gx|, |gy| <= 1020, so 16-bit lanes cannot overflow
+            cv::v_int16x8 m = mR - mL;
+            cv::v_store(gx + x, (uR - uL) + m + m + (dR - dL));
+            cv::v_int16x8 c = dC - uC;
+            cv::v_store(gy + x, (dL + dR) - (uL + uR) + c + c);
+        }
+    }
+#endif
+    for (; x < cols; x++) {
+        gx[x] = static_cast<short>((up[x + 2] - up[x]) + 2 * (mid[x + 2] - mid[x]) +
+                                   (down[x + 2] - down[x]));
+        gy[x] = static_cast<short>((down[x] + 2 * down[x + 1] + down[x + 2]) -
+                                   (up[x] + 2 * up[x + 1] + up[x + 2]));
+    }
+}
+
+void sobel3x3(const cv::Mat &gray, cv::Mat &gx, cv::Mat &gy) {
+    CV_Assert(gray.type() == CV_8UC1);
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    gx.create(rows, cols, CV_16SC1);
+    gy.create(rows, cols, CV_16SC1);
+    if (gray.empty()) {
+        return;
+    }
+
+    // Source rows in, two gradient rows out, plus three padded rows per band
+    const size_t bytesPerRow = static_cast<size_t>(cols) * 5;
+    parallelRowBands(rows, bytesPerRow, [&](const cv::Range &band) {
+        std::vector<uchar> padded(3 * static_cast<size_t>(cols + 2));
+        auto pad = [&](int slot, int y) {
+            uchar *row = &padded[slot * static_cast<size_t>(cols + 2)];
+            const uchar *src = gray.ptr<uchar>(reflect101(y, rows));
+            std::copy(src, src + cols, row + 1);
+            row[0] = row[1 + reflect101(-1, cols)];
+            row[cols + 1] = row[1 + reflect101(cols, cols)];
+            return row;
+        };
+
+        for (int y = band.start; y < band.end; y++) {
+            const uchar *up = pad(0, y - 1);
+            const uchar *mid = pad(1, y);
+            const uchar *down = pad(2, y + 1);
+            sobel3x3Row(up, mid, down, cols, gx.ptr<short>(y), gy.ptr<short>(y));
+        }
+    });
+}
+
+void separableFilter8u(const cv::Mat &src, cv::Mat &dst, const std::vector<int> &kx,
+                       const std::vector<int> &ky, int shift) {
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3));
+    CV_Assert(kx.size() % 2 == 1 && ky.size() % 2 == 1 && shift >= 0 && shift < 31);
+    CV_Assert(dst.data != src.data || dst.empty());
+
+    const int rows = src.rows;
+    const int cols = src.cols;
+    const int cn = src.channels();
+    const int n = cols * cn;
+    const int rx = static_cast<int>(kx.size()) / 2;
+    const int ry = static_cast<int>(ky.size()) / 2;
+    const int round = shift > 0 ? 1 << (shift - 1) : 0;
+    dst.create(src.size(), src.type());
+    if (src.empty()) {
+        return;
+    }
+
+    // Padded column index of every tap, built once for all rows
+    std::vector<int> colIndex(static_cast<size_t>(cols + 2 * rx));
+    for (int x = -rx; x < cols + rx; x++) {
+        colIndex[x + rx] = reflect101(std::max(-cols + 1, std::min(x, 2 * cols - 2)), cols);
+    }
+
+    const size_t bytesPerRow = static_cast<size_t>(n) * (2 + sizeof(int) * ky.size());
+    parallelRowBands(rows, bytesPerRow, [&](const cv::Range &band) {
+        // Horizontal sums of the band rows plus the vertical halo
+        const int first = band.start - ry;
+        const int count = band.end - band.start + 2 * ry;
+        std::vector<int> hsum(static_cast<size_t>(count) * n);
+
+        for (int i = 0; i < count; i++) {
+            const int y = std::max(-rows + 1, std::min(first + i, 2 * rows - 2));
+            const uchar *in = src.ptr<uchar>(reflect101(y, rows));
+            int *out = &hsum[static_cast<size_t>(i) * n];
+            for (int x = 0; x < cols; x++) {
+                for (int c = 0; c < cn; c++) {
+                    int sum = 0;
+                    for (int k = 0; k <= 2 * rx; k++) {
+                        sum += kx[k] * in[colIndex[x + k] * cn + c];
+                    }
+                    out[x * cn + c] = sum;
+                }
+            }
+        }
+
+        std::vector<int> acc(n);
+        for (int y = band.start; y < band.end; y++) {
+            std::fill(acc.begin(), acc.end(), round);
+            for (int k = 0; k <= 2 * ry; k++) {
+                const int *h = &hsum[static_cast<size_t>(y - band.start + k) * n];
+                const int w = ky[k];
+                for (int i = 0; i < n; i++) {
+                    acc[i] += w * h[i];
+                }
+            }
+            uchar *out = dst.ptr<uchar>(y);
+            for (int i = 0; i < n; i++) {
+                out[i] = cv::saturate_cast<uchar>(acc[i] >> shift);
+            }
+        }
+    });
+}
+
+} // namespace cvcore
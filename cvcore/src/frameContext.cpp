@@ -0,0 +1,131 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the per-frame representation cache.
+*/
+
+#include "cvcore/frameContext.hpp"
+
+namespace cvcore {
+
+void FrameContext::releaseIfShared(cv::Mat &image) {
+    // refcount counts every Mat header on the buffer, this one included.
+    // Without u the header wraps user memory (an aliased frame): never
+    // write into it
+    if (image.u == nullptr || CV_XADD(&image.u->refcount, 0) > 1) {
+        image.release();
+    }
+}
+
+void FrameContext::reset(const cv::Mat &frame) {
+    CV_Assert(frame.empty() || frame.depth() == CV_8U);
+    frame_ = frame;
+
+    releaseIfShared(bgr_);
+    releaseIfShared(gray_);
+    releaseIfShared(hsv_);
+    releaseIfShared(lab_);
+    for (cv::Mat &level : pyramid_) {
+        releaseIfShared(level);
+    }
+    for (ClaheEntry &entry : clahe_) {
+        releaseIfShared(entry.result);
+        entry.valid = false;
+    }
+
+    bgrValid_ = false;
+    grayValid_ = false;
+    hsvValid_ = false;
+    labValid_ = false;
+    pyramidValid_ = 0;
+    conversions_ = 0;
+}
+
+const cv::Mat &FrameContext::bgr() {
+    if (!bgrValid_) {
+        if (frame_.channels() == 3) {
+            bgr_ = frame_;
+        } else {
+            if (frame_.channels() == 4) {
+                cv::cvtColor(frame_, bgr_, cv::COLOR_BGRA2BGR);
+            } else {
+                cv::cvtColor(frame_, bgr_, cv::COLOR_GRAY2BGR);
+            }
+            conversions_++;
+        }
+        bgrValid_ = true;
+    }
+    return bgr_;
+}
+
+const cv::Mat &FrameContext::gray() {
+    if (!grayValid_) {
+        if (frame_.channels() == 1) {
+            gray_ = frame_;
+        } else {
+            cv::cvtColor(frame_, gray_,
+                         frame_.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+            conversions_++;
+        }
+        grayValid_ = true;
+    }
+    return gray_;
+}
+
+const cv::Mat &FrameContext::hsv() {
+    if (!hsvValid_) {
+        cv::cvtColor(bgr(), hsv_, cv::COLOR_BGR2HSV);
+        conversions_++;
+        hsvValid_ = true;
+    }
+    return hsv_;
+}
+
+const cv::Mat &FrameContext::lab() {
+    if (!labValid_) {
+        cv::cvtColor(bgr(), lab_, cv::COLOR_BGR2Lab);
+        conversions_++;
+        labValid_ = true;
+    }
+    return lab_;
+}
+
+const cv::Mat &FrameContext::grayPyramid(int level) {
+    CV_Assert(level >= 0);
+    if (level == 0) {
+        return gray();
+    }
+    if (static_cast<int>(pyramid_.size()) < level) {
+        pyramid_.resize(level);
+    }
+    // Each level only from the one above it
+    while (pyramidValid_ < level) {
+        const cv::Mat &above = pyramidValid_ == 0 ? gray() : pyramid_[pyramidValid_ - 1];
+        cv::pyrDown(above, pyramid_[pyramidValid_]);
+        conversions_++;
+        pyramidValid_++;
+    }
+    return pyramid_[level - 1];
+}
+
+const cv::Mat &FrameContext::clahe(double clipLimit, cv::Size tiles) {
+    ClaheEntry *entry = nullptr;
+    for (ClaheEntry &candidate : clahe_) {
+        if (candidate.clipLimit == clipLimit && candidate.tiles == tiles) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (entry == nullptr) {
+        clahe_.push_back({clipLimit, tiles, cv::createCLAHE(clipLimit, tiles), cv::Mat(), false});
+        entry = &clahe_.back();
+    }
+    if (!entry->valid) {
+        entry->clahe->apply(gray(), entry->result);
+        conversions_++;
+        entry->valid = true;
+    }
+    return entry->result;
+}
+
+} // namespace cvcore
@@ -0,0 +1,164 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the Gabor filter bank.
+*/
+
+#include "cvcore/gabor.hpp"
+#include <opencv2/imgproc.hpp>
+
+namespace cvcore {
+
+namespace {
+
+/// Padded image sizes whose kernel spectra are kept per bank
+const size_t MAX_CACHED_DFT_SIZES = 2;
+
+} // namespace
+
+GaborBank::GaborBank(int ksize, const std::vector<GaborParams> &params, double separableError,
+                     int fftMinKsize)
+    : ksize_(ksize), fftMinKsize_(fftMinKsize) {
+    CV_Assert(ksize > 0 && ksize % 2 == 1);
+
+    for (const GaborParams &p : params) {
+        kernels_.push_back(cv::getGaborKernel(cv::Size(ksize, ksize), p.sigma, p.theta, p.lambda,
+                                              p.gamma, p.psi, CV_32F));
+
+        // Smallest rank within separableError, kept if 2 r passes of ksize
+        // taps cost less than half the ksize^2 stencil
+        std::vector<Factor> factors;
+        if (separableError > 0.0) {
+            cv::Mat k64, w, u, vt;
+            kernels_.back().convertTo(k64, CV_64F);
+            cv::SVD::compute(k64, w, u, vt);
+
+            double total = 0.0;
+            for (int i = 0; i < w.rows; i++) {
+                total += w.at<double>(i) * w.at<double>(i);
+            }
+            double residual = total;
+            int rank = 0;
+            while (rank < w.rows &&
+                   residual > separableError * separableError * total) {
+                residual -= w.at<double>(rank) * w.at<double>(rank);
+                rank++;
+            }
+            if (total > 0.0 && 4 * rank < ksize) {
+                for (int i = 0; i < rank; i++) {
+                    Factor factor;
+                    cv::Mat(vt.row(i) * w.at<double>(i)).convertTo(factor.kx, CV_32F);
+                    u.col(i).convertTo(factor.ky, CV_32F);
+                    factors.push_back(factor);
+                }
+            }
+        }
+        factors_.push_back(std::move(factors));
+    }
+}
+
+GaborPath GaborBank::path(int k) const {
+    if (useFFT_ && ksize_ >= fftMinKsize_) {
+        return GaborPath::Fourier;
+    }
+    return factors_[k].empty() ? GaborPath::Dense : GaborPath::Separable;
+}
+
+/**
+ * filter2D correlates, so each kernel is flipped before its transform:
+ * multiplying spectra then gives the same correlation. Kernels sit at the
+ * top-left of the zero-padded plane; forEachResponse() offsets the output
+ * window accordingly.
+ */
+const std::vector<cv::Mat> &GaborBank::kernelSpectra(const cv::Size &dftSize) const {
+    for (const auto &set : spectrumCache_) {
+        if (set.dftSize == dftSize) {
+            return set.spectra;
+        }
+    }
+
+    if (spectrumCache_.size() >= MAX_CACHED_DFT_SIZES) {
+        spectrumCache_.erase(spectrumCache_.begin());
+    }
+
+    SpectrumSet set;
+    set.dftSize = dftSize;
+    set.spectra.resize(kernels_.size());
+    cv::parallel_for_(cv::Range(0, size()), [&](const cv::Range &range) {
+        for (int k = range.start; k < range.end; k++) {
+            cv::Mat flipped;
+            cv::flip(kernels_[k], flipped, -1);
+
+            cv::Mat placed = cv::Mat::zeros(dftSize, CV_32F);
+            flipped.copyTo(placed(cv::Rect(0, 0, flipped.cols, flipped.rows)));
+            cv::dft(placed, set.spectra[k], 0, flipped.rows);
+        }
+    });
+    spectrumCache_.push_back(std::move(set));
+    return spectrumCache_.back().spectra;
+}
+
+void GaborBank::forEachResponse(const cv::Mat &src,
+                                const std::function<void(int, const cv::Mat &)> &visit) const {
+    CV_Assert(src.channels() == 1);
+    if (kernels_.empty() || src.empty()) {
+        return;
+    }
+
+    cv::Mat image = src;
+    if (src.depth() != CV_32F) {
+        src.convertTo(image, CV_32F);
+    }
+
+    // Frequency domain: pad like filter2D's border and transform once
+    cv::Mat imageSpectrum;
+    const std::vector<cv::Mat> *spectra = nullptr;
+    const cv::Rect valid(ksize_ - 1, ksize_ - 1, image.cols, image.rows);
+    if (path(0) == GaborPath::Fourier) {
+        const int border = ksize_ / 2;
+        cv::Mat padded;
+        cv::copyMakeBorder(image, padded, border, border, border, border, cv::BORDER_REFLECT_101);
+
+        cv::Size dftSize(cv::getOptimalDFTSize(padded.cols), cv::getOptimalDFTSize(padded.rows));
+        cv::Mat plane = cv::Mat::zeros(dftSize, CV_32F);
+        padded.copyTo(plane(cv::Rect(0, 0, padded.cols, padded.rows)));
+        cv::dft(plane, imageSpectrum, 0, padded.rows);
+
+        spectra = &kernelSpectra(dftSize);
+    }
+
+    // One pass over the bank: kernels are spread over the worker threads
+    cv::parallel_for_(cv::Range(0, size()), [&](const cv::Range &range) {
+        cv::Mat product, response, term;
+        for (int k = range.start; k < range.end; k++) {
+            switch (path(k)) {
+            case GaborPath::Fourier:
+                cv::mulSpectrums(imageSpectrum, (*spectra)[k], product, 0);
+                cv::dft(product, response, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+                visit(k, response(valid));
+                break;
+            case GaborPath::Separable: {
+                const std::vector<Factor> &factors = factors_[k];
+                cv::sepFilter2D(image, response, CV_32F, factors[0].kx, factors[0].ky);
+                for (size_t i = 1; i < factors.size(); i++) {
+                    cv::sepFilter2D(image, term, CV_32F, factors[i].kx, factors[i].ky);
+                    response += term;
+                }
+                visit(k, response);
+                break;
+            }
+            case GaborPath::Dense:
+                cv::filter2D(image, response, CV_32F, kernels_[k]);
+                visit(k, response);
+                break;
+            }
+        }
+    });
+}
+
+void GaborBank::filter(const cv::Mat &src, std::vector<cv::Mat> &responses) const {
+    responses.resize(kernels_.size());
+    forEachResponse(src, [&](int k, const cv::Mat &response) { response.copyTo(responses[k]); });
+}
+
+} // namespace cvcore
@@ -0,0 +1,78 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the parallel histogram helpers.
+*/
+
+#include "cvcore/histogram.hpp"
+#include <algorithm>
+
+namespace cvcore {
+
+std::vector<uint32_t> parallelHistogram(
+    int rows, int bins,
+    const std::function<void(const cv::Range &, uint32_t *)> &body,
+    int minRowsPerStripe) {
+    std::vector<uint32_t> total(std::max(0, bins), 0);
+    if (rows <= 0 || bins <= 0) {
+        return total;
+    }
+
+    const int maxStripes = std::max(1, rows / std::max(1, minRowsPerStripe));
+    const int stripes = std::max(1, std::min(cv::getNumThreads(), maxStripes));
+
+    // Single stripe: count straight into the result
+    if (stripes == 1) {
+        body(cv::Range(0, rows), total.data());
+        return total;
+    }
+
+    std::vector<uint32_t> partial(static_cast<size_t>(stripes) * bins, 0);
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range &range) {
+        for (int s = range.start; s < range.end; s++) {
+            const int begin = static_cast<int>(static_cast<int64_t>(rows) * s / stripes);
+            const int end = static_cast<int>(static_cast<int64_t>(rows) * (s + 1) / stripes);
+            body(cv::Range(begin, end), &partial[static_cast<size_t>(s) * bins]);
+        }
+    });
+
+    for (int s = 0; s < stripes; s++) {
+        const uint32_t *counts = &partial[static_cast<size_t>(s) * bins];
+        for (int b = 0; b < bins; b++) {
+            total[b] += counts[b];
+        }
+    }
+    return total;
+}
+
+std::vector<uint32_t> countJoint8u(const cv::Mat &src, int binsPerChannel) {
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3));
+    CV_Assert(binsPerChannel > 0 && binsPerChannel <= 256);
+
+    const int channels = src.channels();
+    const int n = binsPerChannel;
+    const int bins = channels == 1 ? n : n * n * n;
+
+    // Channel value -> bin, same rounding as value * n / 256
+    int binOf[256];
+    for (int v = 0; v < 256; v++) {
+        binOf[v] = v * n / 256;
+    }
+
+    return parallelHistogram(src.rows, bins, [&](const cv::Range &range, uint32_t *counts) {
+        for (int y = range.start; y < range.end; y++) {
+            const uchar *p = src.ptr<uchar>(y);
+            if (channels == 1) {
+                for (int x = 0; x < src.cols; x++) {
+                    counts[binOf[p[x]]]++;
+                }
+            } else {
+                for (int x = 0; x < src.cols; x++, p += 3) {
+                    counts[(binOf[p[0]] * n + binOf[p[1]]) * n + binOf[p[2]]]++;
+                }
+            }
+        }
+    });
+}
+
+} // namespace cvcore
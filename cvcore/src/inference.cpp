@@ -0,0 +1,417 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the shared ONNX Runtime sessions and the pooled,
+           batching inference service.
+*/
+
+#include "cvcore/inference.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+namespace cvcore {
+
+bool InferenceOptions::parseProviders(const std::string &list) {
+    std::vector<Provider> parsed;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        const std::string name = list.substr(start, end - start);
+        if (name == "tensorrt" || name == "trt") {
+            parsed.push_back(Provider::TensorRT);
+        } else if (name == "cuda") {
+            parsed.push_back(Provider::CUDA);
+        } else if (name == "openvino") {
+            parsed.push_back(Provider::OpenVINO);
+        } else if (name == "cpu") {
+            parsed.push_back(Provider::CPU);
+        }
+        start = end + 1;
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    providers = parsed;
+    return true;
+}
+
+const char *providerLabel(Provider provider) {
+    switch (provider) {
+        case Provider::TensorRT: return "TensorRT";
+        case Provider::CUDA: return "CUDA";
+        case Provider::OpenVINO: return "OpenVINO";
+        case Provider::CPU: return "CPU";
+    }
+    return "unknown";
+}
+
+Ort::Env &sharedEnv() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "cvcore");
+    return env;
+}
+
+// Appends one provider; false (options unchanged) when ORT lacks it
+static bool appendProvider(Ort::SessionOptions &sessionOptions, Provider provider,
+                           const InferenceOptions &options, const std::string &logTag) {
+    try {
+        switch (provider) {
+            case Provider::TensorRT: {
+                OrtTensorRTProviderOptions trt{};
+                trt.device_id = options.deviceId;
+                trt.trt_max_workspace_size = 1ULL << 30;
+                trt.trt_fp16_enable = options.trtFp16 ? 1 : 0;
+                trt.trt_int8_enable = options.trtInt8 ? 1 : 0;
+                trt.trt_engine_cache_enable = options.trtCacheDir.empty() ? 0 : 1;
+                trt.trt_engine_cache_path = options.trtCacheDir.c_str();
+                sessionOptions.AppendExecutionProvider_TensorRT(trt);
+                return true;
+            }
+            case Provider::CUDA: {
+                OrtCUDAProviderOptions cuda;
+                cuda.device_id = options.deviceId;
+                cuda.arena_extend_strategy = 0;
+                cuda.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchExhaustive;
+                cuda.do_copy_in_default_stream = 1;
+                sessionOptions.AppendExecutionProvider_CUDA(cuda);
+                return true;
+            }
+            case Provider::OpenVINO: {
+                OrtOpenVINOProviderOptions ov;
+                ov.device_type = options.openvinoDevice.c_str();
+                sessionOptions.AppendExecutionProvider_OpenVINO(ov);
+                return true;
+            }
+            case Provider::CPU:
+                // Always registered by ONNX Runtime; only the thread count is set
+                if (options.intraOpThreads > 0) {
+                    sessionOptions.SetIntraOpNumThreads(options.intraOpThreads);
+                }
+                return true;
+        }
+    } catch (const Ort::Exception &e) {
+        std::cerr << logTag << ": " << providerLabel(provider) << " unavailable ("
+                  << e.what() << ")" << std::endl;
+    }
+    return false;
+}
+
+std::string configureProviders(Ort::SessionOptions &sessionOptions,
+                               const InferenceOptions &options, const std::string &logTag) {
+    // Registered in priority order; ORT assigns each node to the first
+    // provider that supports it and falls back to CPU for the rest
+    std::string chain;
+    for (Provider provider : options.providers) {
+        if (provider == Provider::CPU) {
+            appendProvider(sessionOptions, provider, options, logTag);
+            break;
+        }
+        if (appendProvider(sessionOptions, provider, options, logTag)) {
+            chain += std::string(providerLabel(provider)) + " > ";
+        }
+    }
+    return chain + "CPU";
+}
+
+// -----------------------------------------------------------------------------
+// InferenceSession
+// -----------------------------------------------------------------------------
+
+InferenceSession::InferenceSession(const std::string &modelPath, const InferenceOptions &options,
+                                   const std::string &inputName, const std::string &outputName) {
+    Ort::SessionOptions sessionOptions;
+    providers_ = configureProviders(sessionOptions, options);
+    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+#ifdef _WIN32
+    const std::wstring widePath(modelPath.begin(), modelPath.end());
+    session_ = std::make_unique<Ort::Session>(sharedEnv(), widePath.c_str(), sessionOptions);
+#else
+    session_ = std::make_unique<Ort::Session>(sharedEnv(), modelPath.c_str(), sessionOptions);
+#endif
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    inputName_ = !inputName.empty() ? inputName
+                                    : session_->GetInputNameAllocated(0, allocator).get();
+    outputName_ = !outputName.empty() ? outputName
+                                      : session_->GetOutputNameAllocated(0, allocator).get();
+    binding_ = Ort::IoBinding(*session_);
+}
+
+float *InferenceSession::input(const std::vector<int64_t> &shape) {
+    if (shape != inputShape_) {
+        size_t total = 1;
+        for (int64_t d : shape) {
+            total *= static_cast<size_t>(std::max<int64_t>(d, 0));
+        }
+        inputShape_ = shape;
+        inputData_.resize(total);
+        inputTensor_ = Ort::Value::CreateTensor<float>(memoryInfo_, inputData_.data(),
+                                                       inputData_.size(), inputShape_.data(),
+                                                       inputShape_.size());
+        bindingsDirty_ = true;
+    }
+    return inputData_.data();
+}
+
+bool InferenceSession::run() {
+    if (!session_ || inputShape_.empty()) {
+        return false;
+    }
+
+    try {
+        if (bindingsDirty_) {
+            // New input shape: rebind input, let ORT allocate the first output
+            binding_.ClearBoundInputs();
+            binding_.ClearBoundOutputs();
+            binding_.BindInput(inputName_.c_str(), inputTensor_);
+            binding_.BindOutput(outputName_.c_str(), memoryInfo_);
+            outputBound_ = false;
+            bindingsDirty_ = false;
+        }
+
+        session_->Run(Ort::RunOptions{nullptr}, binding_);
+
+        if (!outputBound_) {
+            std::vector<Ort::Value> outputs = binding_.GetOutputValues();
+            if (outputs.empty()) {
+                return false;
+            }
+            const Ort::TensorTypeAndShapeInfo info = outputs[0].GetTensorTypeAndShapeInfo();
+            const float *data = outputs[0].GetTensorData<float>();
+            if (data == nullptr) {
+                return false;
+            }
+
+            // Keep this result, then bind a persistent buffer for later runs
+            outputShape_ = info.GetShape();
+            outputData_.assign(data, data + info.GetElementCount());
+            outputTensor_ = Ort::Value::CreateTensor<float>(memoryInfo_, outputData_.data(),
+                                                            outputData_.size(), outputShape_.data(),
+                                                            outputShape_.size());
+            binding_.ClearBoundOutputs();
+            binding_.BindOutput(outputName_.c_str(), outputTensor_);
+            outputBound_ = true;
+        }
+        return true;
+    } catch (const Ort::Exception &) {
+        // Rebind from scratch next time (e.g. after a rejected batch size)
+        bindingsDirty_ = true;
+        return false;
+    }
+}
+
+double InferenceSession::warmup(const std::vector<int64_t> &shape, int runs) {
+    float *data = input(shape);
+    std::fill(data, data + inputData_.size(), 0.0f);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < std::max(1, runs); i++) {
+        if (!run()) {
+            return -1.0;
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// -----------------------------------------------------------------------------
+// InferenceService
+// -----------------------------------------------------------------------------
+
+InferenceService::InferenceService(const std::string &modelPath,
+                                   const std::vector<int64_t> &sampleShape,
+                                   const InferenceOptions &options)
+    : sampleShape_(sampleShape),
+      maxBatch_(std::max(1, options.maxBatch)),
+      maxLatencyMs_(std::max(0, options.maxLatencyMs)) {
+    for (int64_t d : sampleShape_) {
+        sampleElements_ *= static_cast<size_t>(std::max<int64_t>(d, 1));
+    }
+
+    const int count = std::max(1, options.sessions);
+    for (int i = 0; i < count; i++) {
+        sessions_.push_back(std::make_unique<InferenceSession>(modelPath, options));
+    }
+    std::cout << "InferenceService: " << modelPath << " (" << count << " session(s), "
+              << sessions_.front()->providers() << ")" << std::endl;
+
+    for (auto &session : sessions_) {
+        workers_.emplace_back(&InferenceService::workerLoop, this, std::ref(*session));
+    }
+}
+
+InferenceService::~InferenceService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+
+    for (Request &request : queue_) {
+        request.result.set_exception(
+            std::make_exception_ptr(std::runtime_error("InferenceService stopped")));
+    }
+}
+
+std::shared_ptr<InferenceService> InferenceService::shared(const std::string &modelPath,
+                                                           const std::vector<int64_t> &sampleShape,
+                                                           const InferenceOptions &options) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<InferenceService>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (std::shared_ptr<InferenceService> existing = registry[modelPath].lock()) {
+        return existing;
+    }
+
+    try {
+        auto service = std::make_shared<InferenceService>(modelPath, sampleShape, options);
+        registry[modelPath] = service;
+        return service;
+    } catch (const Ort::Exception &e) {
+        std::cerr << "InferenceService: Cannot load " << modelPath << " (" << e.what() << ")"
+                  << std::endl;
+        return nullptr;
+    }
+}
+
+std::future<std::vector<float>> InferenceService::submit(std::vector<float> sample) {
+    Request request;
+    std::future<std::vector<float>> result = request.result.get_future();
+    if (sample.size() != sampleElements_) {
+        request.result.set_exception(
+            std::make_exception_ptr(std::invalid_argument("InferenceService: wrong sample size")));
+        return result;
+    }
+
+    request.sample = std::move(sample);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(request));
+    }
+    wake_.notify_one();
+    return result;
+}
+
+bool InferenceService::warmup() {
+    std::vector<int64_t> shape = sampleShape_;
+    shape.insert(shape.begin(), 1);
+
+    bool ok = true;
+    for (auto &session : sessions_) {
+        shape[0] = 1;
+        const double ms = session->warmup(shape);
+        ok = ok && ms >= 0.0;
+
+        if (maxBatch_ > 1 && !singleOnly_) {
+            shape[0] = maxBatch_;
+            if (session->warmup(shape) < 0.0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                singleOnly_ = true;
+            }
+        }
+        std::cout << "InferenceService: Warm-up took " << ms << " ms" << std::endl;
+    }
+    return ok;
+}
+
+InferenceService::Stats InferenceService::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void InferenceService::workerLoop(InferenceSession &session) {
+    for (;;) {
+        std::vector<Request> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+
+            // Give other callers up to the latency window to join the batch
+            const size_t limit = singleOnly_ ? 1 : static_cast<size_t>(maxBatch_);
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::milliseconds(maxLatencyMs_);
+            wake_.wait_until(lock, deadline, [&] { return stop_ || queue_.size() >= limit; });
+            if (stop_) {
+                return;
+            }
+
+            // Another worker may have taken the queue meanwhile
+            const size_t n = std::min(limit, queue_.size());
+            for (size_t i = 0; i < n; i++) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+        if (!batch.empty()) {
+            runBatch(session, batch);
+        }
+    }
+}
+
+bool InferenceService::runBatch(InferenceSession &session, std::vector<Request> &batch) {
+    std::vector<int64_t> shape = sampleShape_;
+    shape.insert(shape.begin(), static_cast<int64_t>(batch.size()));
+
+    const auto start = std::chrono::steady_clock::now();
+    float *in = session.input(shape);
+    for (size_t i = 0; i < batch.size(); i++) {
+        std::memcpy(in + i * sampleElements_, batch[i].sample.data(),
+                    sampleElements_ * sizeof(float));
+    }
+
+    if (!session.run()) {
+        if (batch.size() > 1) {
+            // Fixed batch-1 export: serve one sample per run from now on
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!singleOnly_) {
+                    std::cerr << "InferenceService: Model rejected a batch of " << batch.size()
+                              << ", running samples one at a time" << std::endl;
+                }
+                singleOnly_ = true;
+            }
+            bool ok = true;
+            for (Request &request : batch) {
+                std::vector<Request> single;
+                single.push_back(std::move(request));
+                ok = runBatch(session, single) && ok;
+            }
+            return ok;
+        }
+        batch.front().result.set_exception(
+            std::make_exception_ptr(std::runtime_error("InferenceService: run failed")));
+        return false;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start).count();
+
+    // Split the output along the batch dimension
+    const size_t per = session.outputSize() / batch.size();
+    const float *out = session.output();
+    for (size_t i = 0; i < batch.size(); i++) {
+        batch[i].result.set_value(std::vector<float>(out + i * per, out + (i + 1) * per));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.runs++;
+    stats_.samples += static_cast<long long>(batch.size());
+    stats_.meanBatch = static_cast<double>(stats_.samples) / stats_.runs;
+    stats_.meanRunMs = stats_.runs == 1 ? ms : 0.9 * stats_.meanRunMs + 0.1 * ms;
+    return true;
+}
+
+} // namespace cvcore
@@ -0,0 +1,411 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the pooled cv::MatAllocator: size-class free
+           lists, per-thread caches and huge-page block mapping.
+*/
+
+#include "cvcore/matPool.hpp"
+#include "cvcore/metrics.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace cvcore {
+
+namespace {
+
+const size_t CLASS_GRANULE = 64 * 1024;
+const size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+enum class PageKind { Normal, Transparent, Huge };
+
+// A free block: start of the buffer and its size class
+struct Block {
+    void *data;
+    size_t bytes;
+};
+
+// What was mapped for a block (explicit huge pages round the length up)
+struct Mapping {
+    size_t length;
+    PageKind kind;
+};
+
+size_t roundUp(size_t bytes, size_t granule) {
+    return (bytes + granule - 1) / granule * granule;
+}
+
+size_t sizeClass(size_t bytes) {
+    return roundUp(bytes, CLASS_GRANULE);
+}
+
+// Huge pages only when rounding up to them wastes at most 1/8 of the block
+bool hugeFits(size_t bytes, size_t length) {
+    return length - bytes <= length / 8;
+}
+
+// Maps one block of bytes (a multiple of 64 KB), nullptr on failure
+void *mapBlock(size_t bytes, bool hugePages, Mapping &mapping) {
+#ifdef _WIN32
+    const size_t large = hugePages && bytes >= HUGE_PAGE ? GetLargePageMinimum() : 0;
+    if (large != 0 && hugeFits(bytes, roundUp(bytes, large))) {
+        // Needs SeLockMemoryPrivilege; fails quietly without it
+        mapping.length = roundUp(bytes, large);
+        void *p = VirtualAlloc(nullptr, mapping.length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                               PAGE_READWRITE);
+        if (p) {
+            mapping.kind = PageKind::Huge;
+            return p;
+        }
+    }
+    mapping.length = bytes;
+    mapping.kind = PageKind::Normal;
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    if (hugePages && bytes >= HUGE_PAGE) {
+#ifdef MAP_HUGETLB
+        // Pages reserved in /proc/sys/vm/nr_hugepages; none are by default
+        const size_t length = roundUp(bytes, HUGE_PAGE);
+        if (hugeFits(bytes, length)) {
+            void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                mapping.length = length;
+                mapping.kind = PageKind::Huge;
+                return p;
+            }
+        }
+#endif
+#ifdef MADV_HUGEPAGE
+        // Over-map by one huge page and trim to a 2 MB-aligned start, so
+        // every whole 2 MB of the block can become one transparent huge page
+        void *raw = mmap(nullptr, bytes + HUGE_PAGE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+            const uintptr_t aligned = roundUp(start, HUGE_PAGE);
+            if (aligned > start) {
+                munmap(raw, aligned - start);
+            }
+            const size_t tail = start + bytes + HUGE_PAGE - (aligned + bytes);
+            if (tail > 0) {
+                munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+            }
+            void *p = reinterpret_cast<void *>(aligned);
+            mapping.length = bytes;
+            mapping.kind = madvise(p, bytes, MADV_HUGEPAGE) == 0 ? PageKind::Transparent
+                                                                 : PageKind::Normal;
+            return p;
+        }
+#endif
+    }
+    void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    mapping.length = bytes;
+    mapping.kind = PageKind::Normal;
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+void unmapBlock(void *data, const Mapping &mapping) {
+#ifdef _WIN32
+    (void)mapping;
+    VirtualFree(data, 0, MEM_RELEASE);
+#else
+    munmap(data, mapping.length);
+#endif
+}
+
+/**
+ * The allocator. Buffers it creates have it as currAllocator, so
+ * deallocate() sees only pooled blocks; everything else is created by the
+ * allocator it replaced and released there directly.
+ */
+class MatPool : public cv::MatAllocator {
+public:
+    MatPool(cv::MatAllocator *inner, const MatPoolOptions &options);
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+
+    bool allocate(cv::UMatData *data, cv::AccessFlag, cv::UMatUsageFlags) const override {
+        return data != nullptr;
+    }
+
+    void deallocate(cv::UMatData *data) const override;
+
+    /** Moves a free block to the shared lists (or unmaps it) */
+    void toShared(const Block &block) const;
+
+    void trim() const;
+    MatPoolStats stats() const;
+
+private:
+    void *take(size_t bytes) const;
+    void release(const Block &block) const;
+    void unmapLocked(const Block &block) const;   // caller holds mutex_
+
+    cv::MatAllocator *inner_;
+    MatPoolOptions options_;
+
+    mutable std::mutex mutex_;   ///< Guards the maps and sharedBytes_
+    mutable std::unordered_map<size_t, std::vector<void *>> free_;   ///< By size class
+    mutable std::unordered_map<void *, Mapping> mappings_;
+    mutable size_t sharedBytes_ = 0;
+
+    Counter &hits_;
+    Counter &misses_;
+    Counter &passthrough_;
+    Counter &released_;
+    Gauge &mappedBytes_;
+    Gauge &cachedBytes_;
+    Gauge &hugeBytes_;
+};
+
+std::atomic<MatPool *> installedPool{nullptr};
+
+/**
+ * Free blocks of one thread, newest last. Producer / consumer threads
+ * release on one thread and allocate on another; those blocks reach the
+ * allocating thread through the shared lists once this cache is full.
+ */
+struct ThreadCache {
+    std::vector<Block> blocks;
+    size_t bytes = 0;
+    bool alive = true;   // false once destroyed at thread exit
+
+    ~ThreadCache() {
+        alive = false;
+        if (MatPool *pool = installedPool.load(std::memory_order_acquire)) {
+            for (const Block &block : blocks) {
+                pool->toShared(block);
+            }
+        }
+    }
+};
+
+thread_local ThreadCache tlsCache;
+
+MatPool::MatPool(cv::MatAllocator *inner, const MatPoolOptions &options)
+    : inner_(inner), options_(options),
+      hits_(MetricsRegistry::global().counter("matpool_allocations_total",
+                                              "Frame-sized cv::Mat allocations",
+                                              "result=\"hit\"")),
+      misses_(MetricsRegistry::global().counter("matpool_allocations_total",
+                                                "Frame-sized cv::Mat allocations",
+                                                "result=\"miss\"")),
+      passthrough_(MetricsRegistry::global().counter("matpool_allocations_total",
+                                                     "Frame-sized cv::Mat allocations",
+                                                     "result=\"passthrough\"")),
+      released_(MetricsRegistry::global().counter("matpool_released_blocks_total",
+                                                  "Free blocks unmapped because the pool was full")),
+      mappedBytes_(MetricsRegistry::global().gauge("matpool_bytes", "Memory held by the cv::Mat pool",
+                                                   "state=\"mapped\"")),
+      cachedBytes_(MetricsRegistry::global().gauge("matpool_bytes", "Memory held by the cv::Mat pool",
+                                                   "state=\"cached\"")),
+      hugeBytes_(MetricsRegistry::global().gauge("matpool_bytes", "Memory held by the cv::Mat pool",
+                                                 "state=\"huge\"")) {
+    options_.minBytes = std::max(options_.minBytes, CLASS_GRANULE);
+}
+
+// Same layout as OpenCV's own allocator: continuous, rows packed
+cv::UMatData *MatPool::allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                                cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const {
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        total *= sizes[i];
+    }
+
+    void *block = (data || total < options_.minBytes) ? nullptr : take(sizeClass(total));
+    if (!block) {
+        passthrough_.inc();
+        return inner_->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    if (step) {
+        size_t rowStep = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--) {
+            step[i] = rowStep;
+            rowStep *= sizes[i];
+        }
+    }
+    cv::UMatData *u = new cv::UMatData(this);
+    u->data = u->origdata = static_cast<uchar *>(block);
+    u->size = total;
+    return u;
+}
+
+void MatPool::deallocate(cv::UMatData *u) const {
+    if (!u) {
+        return;
+    }
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+    if (u->origdata && !(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        release(Block{u->origdata, sizeClass(u->size)});
+        u->origdata = nullptr;
+    }
+    delete u;
+}
+
+// Thread cache, then shared list, then a new mapping
+void *MatPool::take(size_t bytes) const {
+    ThreadCache &cache = tlsCache;
+    if (cache.alive) {
+        for (size_t i = cache.blocks.size(); i-- > 0;) {
+            if (cache.blocks[i].bytes == bytes) {
+                void *data = cache.blocks[i].data;
+                cache.blocks.erase(cache.blocks.begin() + i);
+                cache.bytes -= bytes;
+                hits_.inc();
+                cachedBytes_.add(-static_cast<double>(bytes));
+                return data;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = free_.find(bytes);
+        if (it != free_.end() && !it->second.empty()) {
+            void *data = it->second.back();
+            it->second.pop_back();
+            sharedBytes_ -= bytes;
+            hits_.inc();
+            cachedBytes_.add(-static_cast<double>(bytes));
+            return data;
+        }
+    }
+
+    Mapping mapping;
+    void *data = mapBlock(bytes, options_.hugePages, mapping);
+    if (!data) {
+        return nullptr;
+    }
+    misses_.inc();
+    mappedBytes_.add(static_cast<double>(mapping.length));
+    if (mapping.kind != PageKind::Normal) {
+        hugeBytes_.add(static_cast<double>(mapping.length));
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    mappings_[data] = mapping;
+    return data;
+}
+
+// Into the thread cache, evicting its oldest blocks to the shared lists
+void MatPool::release(const Block &block) const {
+    cachedBytes_.add(static_cast<double>(block.bytes));
+    ThreadCache &cache = tlsCache;
+    if (!cache.alive || block.bytes > options_.threadCacheBytes) {
+        toShared(block);
+        return;
+    }
+    while (cache.bytes + block.bytes > options_.threadCacheBytes) {
+        toShared(cache.blocks.front());
+        cache.bytes -= cache.blocks.front().bytes;
+        cache.blocks.erase(cache.blocks.begin());
+    }
+    cache.blocks.push_back(block);
+    cache.bytes += block.bytes;
+}
+
+void MatPool::toShared(const Block &block) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sharedBytes_ + block.bytes <= options_.maxCachedBytes) {
+        free_[block.bytes].push_back(block.data);
+        sharedBytes_ += block.bytes;
+        return;
+    }
+    unmapLocked(block);
+    released_.inc();
+}
+
+void MatPool::unmapLocked(const Block &block) const {
+    auto it = mappings_.find(block.data);
+    if (it == mappings_.end()) {
+        return;
+    }
+    const Mapping mapping = it->second;
+    mappings_.erase(it);
+    unmapBlock(block.data, mapping);
+    cachedBytes_.add(-static_cast<double>(block.bytes));
+    mappedBytes_.add(-static_cast<double>(mapping.length));
+    if (mapping.kind != PageKind::Normal) {
+        hugeBytes_.add(-static_cast<double>(mapping.length));
+    }
+}
+
+void MatPool::trim() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &entry : free_) {
+        for (void *data : entry.second) {
+            unmapLocked(Block{data, entry.first});
+        }
+        entry.second.clear();
+    }
+    sharedBytes_ = 0;
+}
+
+MatPoolStats MatPool::stats() const {
+    MatPoolStats s;
+    s.hits = hits_.value();
+    s.misses = misses_.value();
+    s.passthrough = passthrough_.value();
+    s.released = released_.value();
+    s.mappedBytes = static_cast<uint64_t>(std::max(0.0, mappedBytes_.value()));
+    s.cachedBytes = static_cast<uint64_t>(std::max(0.0, cachedBytes_.value()));
+    s.hugeBytes = static_cast<uint64_t>(std::max(0.0, hugeBytes_.value()));
+    return s;
+}
+
+} // namespace
+
+bool installMatPool(const MatPoolOptions &options) {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (installedPool.load(std::memory_order_acquire)) {
+        return true;
+    }
+    const char *env = std::getenv("CVCORE_MAT_POOL");
+    if (env && std::strcmp(env, "0") == 0) {
+        std::cout << "[MatPool] Disabled by CVCORE_MAT_POOL=0" << std::endl;
+        return false;
+    }
+
+    // Never freed: Mats may outlive every static destructor
+    MatPool *pool = new MatPool(cv::Mat::getDefaultAllocator(), options);
+    cv::Mat::setDefaultAllocator(pool);
+    installedPool.store(pool, std::memory_order_release);
+    return true;
+}
+
+bool matPoolInstalled() {
+    return installedPool.load(std::memory_order_acquire) != nullptr;
+}
+
+MatPoolStats matPoolStats() {
+    MatPool *pool = installedPool.load(std::memory_order_acquire);
+    return pool ? pool->stats() : MatPoolStats();
+}
+
+void trimMatPool() {
+    if (MatPool *pool = installedPool.load(std::memory_order_acquire)) {
+        pool->trim();
+    }
+}
+
+} // namespace cvcore
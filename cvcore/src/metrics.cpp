@@ -0,0 +1,525 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the metrics registry and its HTTP / StatsD
+           exporter (Winsock on Windows, BSD sockets elsewhere).
+*/
+
+#include "cvcore/metrics.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace cvcore {
+
+namespace {
+
+#ifdef _WIN32
+typedef SOCKET NativeSocket;
+const std::intptr_t NO_SOCKET = static_cast<std::intptr_t>(INVALID_SOCKET);
+void closeSocket(std::intptr_t s) { closesocket(static_cast<SOCKET>(s)); }
+const int SEND_FLAGS = 0;
+#else
+typedef int NativeSocket;
+const std::intptr_t NO_SOCKET = -1;
+void closeSocket(std::intptr_t s) { ::close(static_cast<int>(s)); }
+const int SEND_FLAGS = MSG_NOSIGNAL;   // a scraper hanging up is not fatal
+#endif
+
+/// Accept loop wake-up interval for checking the stop flag
+const int ACCEPT_POLL_MS = 200;
+
+/// Largest scrape request read (request line and headers)
+const size_t MAX_REQUEST_BYTES = 8192;
+
+/// Largest StatsD datagram; longer pushes are split at line ends
+const size_t MAX_DATAGRAM_BYTES = 1400;
+
+/// Prometheus histogram bucket bounds in seconds
+const double BUCKET_BOUNDS_S[] = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                  0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0};
+
+std::string withLabels(const std::string &name, const std::string &labels,
+                       const std::string &extra = "") {
+    std::string all = labels;
+    if (!extra.empty()) {
+        all += all.empty() ? extra : "," + extra;
+    }
+    return all.empty() ? name : name + "{" + all + "}";
+}
+
+/// Label values appended to the name: stage="capture" -> name.capture
+std::string statsdName(const std::string &name, const std::string &labels) {
+    std::string out = name;
+    size_t pos = 0;
+    while ((pos = labels.find('"', pos)) != std::string::npos) {
+        const size_t end = labels.find('"', pos + 1);
+        if (end == std::string::npos) {
+            break;
+        }
+        out += '.';
+        for (size_t i = pos + 1; i < end; i++) {
+            const unsigned char c = static_cast<unsigned char>(labels[i]);
+            out += std::isalnum(c) ? static_cast<char>(c) : '_';
+        }
+        pos = end + 1;
+    }
+    return out;
+}
+
+std::string formatNumber(double value) {
+    std::ostringstream out;
+    out.precision(9);
+    out << value;
+    return out.str();
+}
+
+void sendAll(std::intptr_t socket, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+#ifdef _WIN32
+        const int n = send(static_cast<SOCKET>(socket), data.data() + sent,
+                           static_cast<int>(data.size() - sent), SEND_FLAGS);
+#else
+        const ssize_t n = send(static_cast<int>(socket), data.data() + sent, data.size() - sent,
+                               SEND_FLAGS);
+#endif
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// Gauge / Histogram
+// =============================================================================
+
+void Gauge::add(double delta) {
+    double current = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+int Histogram::bucketOf(uint64_t us) {
+    if (us < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(us);
+    }
+    int msb = 63;
+    while (!(us >> msb)) {
+        msb--;
+    }
+    const int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((us >> shift) - SUB_BUCKETS);
+}
+
+uint64_t Histogram::bucketLow(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    const int shift = bucket / SUB_BUCKETS - 1;
+    return static_cast<uint64_t>(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+}
+
+uint64_t Histogram::bucketHigh(int bucket) {
+    return bucket + 1 < BUCKETS ? bucketLow(bucket + 1) - 1 : UINT64_MAX;
+}
+
+void Histogram::observeMs(double ms) {
+    const uint64_t us = ms > 0.0 ? static_cast<uint64_t>(ms * 1000.0 + 0.5) : 0;
+    buckets_[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(us, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+double Histogram::quantileMs(double q) const {
+    uint64_t total = 0;
+    for (const auto &bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += buckets_[b].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return (bucketLow(b) + bucketHigh(b)) * 0.5e-3;
+        }
+    }
+    return bucketLow(BUCKETS - 1) * 1e-3;
+}
+
+uint64_t Histogram::countAtMostUs(uint64_t limitUs) const {
+    uint64_t n = 0;
+    for (int b = 0; b < BUCKETS && bucketHigh(b) <= limitUs; b++) {
+        n += buckets_[b].load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+// =============================================================================
+// MetricsRegistry
+// =============================================================================
+
+MetricsRegistry &MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Family &MetricsRegistry::family(const std::string &name, const std::string &help,
+                                                 Kind kind) {
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        it = families_.emplace(name, Family()).first;
+        it->second.kind = kind;
+        it->second.help = help;
+    }
+    CV_DbgAssert(it->second.kind == kind);
+    return it->second;
+}
+
+Counter &MetricsRegistry::counter(const std::string &name, const std::string &help,
+                                  const std::string &labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slot = family(name, help, Kind::Counter).counters[labels];
+    if (!slot) {
+        slot.reset(new Counter());
+    }
+    return *slot;
+}
+
+Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help,
+                              const std::string &labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slot = family(name, help, Kind::Gauge).gauges[labels];
+    if (!slot) {
+        slot.reset(new Gauge());
+    }
+    return *slot;
+}
+
+Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                      const std::string &labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slot = family(name, help, Kind::Histogram).histograms[labels];
+    if (!slot) {
+        slot.reset(new Histogram());
+    }
+    return *slot;
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    for (const auto &entry : families_) {
+        const std::string &name = entry.first;
+        const Family &f = entry.second;
+        out << "# HELP " << name << " " << f.help << "\n";
+        switch (f.kind) {
+        case Kind::Counter:
+            out << "# TYPE " << name << " counter\n";
+            for (const auto &c : f.counters) {
+                out << withLabels(name, c.first) << " " << c.second->value() << "\n";
+            }
+            break;
+        case Kind::Gauge:
+            out << "# TYPE " << name << " gauge\n";
+            for (const auto &g : f.gauges) {
+                out << withLabels(name, g.first) << " " << formatNumber(g.second->value()) << "\n";
+            }
+            break;
+        case Kind::Histogram:
+            out << "# TYPE " << name << " histogram\n";
+            for (const auto &h : f.histograms) {
+                const Histogram &histogram = *h.second;
+                // Count first: buckets read afterwards include at least these samples
+                const uint64_t count = histogram.count();
+                for (double bound : BUCKET_BOUNDS_S) {
+                    const uint64_t n = histogram.countAtMostUs(static_cast<uint64_t>(bound * 1e6));
+                    out << withLabels(name + "_bucket", h.first, "le=\"" + formatNumber(bound) + "\"")
+                        << " " << std::min(n, count) << "\n";
+                }
+                out << withLabels(name + "_bucket", h.first, "le=\"+Inf\"") << " " << count << "\n";
+                out << withLabels(name + "_sum", h.first) << " "
+                    << formatNumber(histogram.sumSeconds()) << "\n";
+                out << withLabels(name + "_count", h.first) << " " << count << "\n";
+            }
+            break;
+        }
+    }
+    return out.str();
+}
+
+std::string MetricsRegistry::statsdText() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    for (auto &entry : families_) {
+        Family &f = entry.second;
+        for (const auto &c : f.counters) {
+            const uint64_t value = c.second->value();
+            uint64_t &pushed = f.pushed[c.first];
+            if (value > pushed) {
+                out << statsdName(entry.first, c.first) << ":" << value - pushed << "|c\n";
+            }
+            pushed = value;
+        }
+        for (const auto &g : f.gauges) {
+            out << statsdName(entry.first, g.first) << ":" << formatNumber(g.second->value())
+                << "|g\n";
+        }
+        for (const auto &h : f.histograms) {
+            const std::string base = statsdName(entry.first, h.first);
+            out << base << ".p50:" << formatNumber(h.second->quantileMs(0.50)) << "|g\n"
+                << base << ".p95:" << formatNumber(h.second->quantileMs(0.95)) << "|g\n"
+                << base << ".p99:" << formatNumber(h.second->quantileMs(0.99)) << "|g\n";
+        }
+    }
+    return out.str();
+}
+
+// =============================================================================
+// MetricsExporter
+// =============================================================================
+
+MetricsExporter::MetricsExporter(MetricsRegistry &registry)
+    : registry_(registry), listenSocket_(NO_SOCKET), statsdSocket_(NO_SOCKET) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::startHttp(int port, const std::string &host) {
+    if (listenSocket_ != NO_SOCKET) {
+        return false;
+    }
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        return false;
+    }
+#endif
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "[Metrics] Invalid IPv4 address: " << host << std::endl;
+        return false;
+    }
+
+    const std::intptr_t s = static_cast<std::intptr_t>(socket(AF_INET, SOCK_STREAM, 0));
+    if (s == NO_SOCKET) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(static_cast<NativeSocket>(s), SOL_SOCKET, SO_REUSEADDR,
+               reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+    if (bind(static_cast<NativeSocket>(s), reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(static_cast<NativeSocket>(s), 8) != 0) {
+        std::cerr << "[Metrics] Cannot listen on port " << port << std::endl;
+        closeSocket(s);
+        return false;
+    }
+
+    listenSocket_ = s;
+    running_ = true;
+    httpThread_ = std::thread(&MetricsExporter::httpLoop, this);
+    return true;
+}
+
+bool MetricsExporter::startStatsd(const std::string &host, int port, int intervalMs) {
+    if (statsdSocket_ != NO_SOCKET) {
+        return false;
+    }
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        return false;
+    }
+#endif
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "[Metrics] Invalid StatsD address: " << host << std::endl;
+        return false;
+    }
+
+    const std::intptr_t s = static_cast<std::intptr_t>(socket(AF_INET, SOCK_DGRAM, 0));
+    if (s == NO_SOCKET) {
+        return false;
+    }
+    // Connected UDP: send() goes to the daemon, nothing waits for replies
+    if (connect(static_cast<NativeSocket>(s), reinterpret_cast<sockaddr *>(&address),
+                sizeof(address)) != 0) {
+        closeSocket(s);
+        return false;
+    }
+
+    statsdSocket_ = s;
+    running_ = true;
+    statsdThread_ = std::thread(&MetricsExporter::statsdLoop, this, std::max(100, intervalMs));
+    return true;
+}
+
+void MetricsExporter::stop() {
+    running_ = false;
+    if (httpThread_.joinable()) {
+        httpThread_.join();
+    }
+    if (statsdThread_.joinable()) {
+        statsdThread_.join();
+    }
+    for (std::intptr_t *s : {&listenSocket_, &statsdSocket_}) {
+        if (*s != NO_SOCKET) {
+            closeSocket(*s);
+            *s = NO_SOCKET;
+#ifdef _WIN32
+            WSACleanup();
+#endif
+        }
+    }
+}
+
+void MetricsExporter::httpLoop() {
+    while (running_) {
+        // Poll so stop() is noticed without closing the socket under accept()
+#ifdef _WIN32
+        WSAPOLLFD pfd{static_cast<SOCKET>(listenSocket_), POLLRDNORM, 0};
+        if (WSAPoll(&pfd, 1, ACCEPT_POLL_MS) <= 0) continue;
+        const std::intptr_t client =
+            static_cast<std::intptr_t>(accept(static_cast<SOCKET>(listenSocket_), nullptr, nullptr));
+#else
+        pollfd pfd{static_cast<int>(listenSocket_), POLLIN, 0};
+        if (poll(&pfd, 1, ACCEPT_POLL_MS) <= 0) continue;
+        const std::intptr_t client = accept(static_cast<int>(listenSocket_), nullptr, nullptr);
+#endif
+        if (client == NO_SOCKET) {
+            continue;
+        }
+
+        // Request line and headers; scrapes carry no body
+        std::string request;
+        char buffer[1024];
+        while (request.size() < MAX_REQUEST_BYTES && request.find("\r\n\r\n") == std::string::npos) {
+#ifdef _WIN32
+            WSAPOLLFD rfd{static_cast<SOCKET>(client), POLLRDNORM, 0};
+            if (WSAPoll(&rfd, 1, 1000) <= 0) break;
+            const int n = recv(static_cast<SOCKET>(client), buffer, sizeof(buffer), 0);
+#else
+            pollfd rfd{static_cast<int>(client), POLLIN, 0};
+            if (poll(&rfd, 1, 1000) <= 0) break;
+            const ssize_t n = recv(static_cast<int>(client), buffer, sizeof(buffer), 0);
+#endif
+            if (n <= 0) break;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        const bool scrape = request.compare(0, 13, "GET /metrics ") == 0 ||
+                            request.compare(0, 13, "GET /metrics?") == 0;
+        const std::string body = scrape ? registry_.prometheusText() : "Not Found\n";
+        std::ostringstream response;
+        response << "HTTP/1.1 " << (scrape ? "200 OK" : "404 Not Found") << "\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        sendAll(client, response.str());
+        closeSocket(client);
+    }
+}
+
+void MetricsExporter::statsdLoop(int intervalMs) {
+    auto next = std::chrono::steady_clock::now();
+    while (running_) {
+        next += std::chrono::milliseconds(intervalMs);
+        while (running_ && std::chrono::steady_clock::now() < next) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_POLL_MS));
+        }
+
+        // Whole lines per datagram
+        const std::string text = registry_.statsdText();
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = start;
+            while (end < text.size()) {
+                const size_t line = text.find('\n', end);
+                const size_t stop = line == std::string::npos ? text.size() : line + 1;
+                if (stop - start > MAX_DATAGRAM_BYTES && end > start) {
+                    break;
+                }
+                end = stop;
+            }
+            sendAll(statsdSocket_, text.substr(start, end - start));
+            start = end;
+        }
+    }
+}
+
+// =============================================================================
+// startMetricsFromEnvironment
+// =============================================================================
+
+bool startMetricsFromEnvironment(const std::string &app) {
+    static std::mutex mutex;
+    static std::unique_ptr<MetricsExporter> exporter;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (exporter) {
+        return true;
+    }
+
+    const char *port = std::getenv("CVCORE_METRICS_PORT");
+    const char *statsd = std::getenv("CVCORE_STATSD");
+    if (!port && !statsd) {
+        return false;
+    }
+
+    std::unique_ptr<MetricsExporter> candidate(new MetricsExporter());
+    bool started = false;
+    if (port && candidate->startHttp(std::atoi(port))) {
+        std::cout << "[Metrics] " << app << ": Prometheus metrics on :" << port << "/metrics"
+                  << std::endl;
+        started = true;
+    }
+    if (statsd) {
+        const std::string target = statsd;
+        const size_t colon = target.rfind(':');
+        const std::string host = colon == std::string::npos ? target : target.substr(0, colon);
+        const int statsdPort = colon == std::string::npos ? 8125 : std::atoi(target.c_str() + colon + 1);
+        if (candidate->startStatsd(host, statsdPort)) {
+            std::cout << "[Metrics] " << app << ": pushing to StatsD " << host << ":" << statsdPort
+                      << std::endl;
+            started = true;
+        }
+    }
+    if (started) {
+        exporter = std::move(candidate);
+    }
+    return started;
+}
+
+} // namespace cvcore
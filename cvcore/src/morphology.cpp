@@ -0,0 +1,334 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the bit-packed binary morphology. Bit i of word w
+           is column 64w+i; padding bits past the last column hold the
+           identity of the running operation (ones for erosion, zeros for
+           dilation), which is also how pixels outside the image are treated.
+
+           The sparse overloads run the same kernel on halo-padded strips of
+           occupied tiles. A pixel's result depends only on the source
+           within radius of it, so cutting the input at the halo edge (where
+           the padding identity takes over) cannot change the strip's centre.
+*/
+
+#include "cvcore/morphology.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace cvcore {
+
+namespace {
+
+struct BitMask {
+    int rows  = 0;
+    int cols  = 0;
+    int words = 0;                 ///< 64-bit words per row
+    std::vector<uint64_t> bits;    ///< rows x words
+
+    uint64_t*       row(int r)       { return bits.data() + static_cast<size_t>(r) * words; }
+    const uint64_t* row(int r) const { return bits.data() + static_cast<size_t>(r) * words; }
+};
+
+constexpr uint64_t kAllOnes = ~uint64_t(0);
+
+/** Pack nonzero pixels as set bits; padding bits past cols are set to fill. */
+void packMask(const cv::Mat& src, BitMask& m, uint64_t fill) {
+    CV_Assert(src.type() == CV_8UC1);
+    m.rows  = src.rows;
+    m.cols  = src.cols;
+    m.words = (src.cols + 63) / 64;
+    m.bits.assign(static_cast<size_t>(m.rows) * m.words, 0);
+
+    const int tail = src.cols % 64;
+    cv::parallel_for_(cv::Range(0, m.rows), [&](const cv::Range& range) {
+        for (int r = range.start; r < range.end; r++) {
+            const uchar* in  = src.ptr<uchar>(r);
+            uint64_t*    out = m.row(r);
+            for (int w = 0; w < m.words; w++) {
+                const int base = w * 64;
+                const int n    = std::min(64, m.cols - base);
+                uint64_t word = 0;
+                for (int b = 0; b < n; b++)
+                    word |= uint64_t(in[base + b] != 0) << b;
+                out[w] = word;
+            }
+            if (tail) out[m.words - 1] |= fill & (kAllOnes << tail);
+        }
+    });
+}
+
+/** Expand set bits to 255 and clear bits to 0. */
+void unpackMask(const BitMask& m, cv::Mat& dst) {
+    dst.create(m.rows, m.cols, CV_8UC1);
+    cv::parallel_for_(cv::Range(0, m.rows), [&](const cv::Range& range) {
+        for (int r = range.start; r < range.end; r++) {
+            const uint64_t* in  = m.row(r);
+            uchar*          out = dst.ptr<uchar>(r);
+            for (int c = 0; c < m.cols; c++)
+                out[c] = ((in[c >> 6] >> (c & 63)) & 1) ? 255 : 0;
+        }
+    });
+}
+
+/**
+ * dst[c] = src[c + s] (towards column 0) when down, else src[c - s];
+ * columns shifted in from outside the row take the fill value.
+ */
+void shiftRow(const uint64_t* src, uint64_t* dst, int words,
+              int s, bool down, uint64_t fill) {
+    const int q = s >> 6;
+    const int b = s & 63;
+    for (int w = 0; w < words; w++) {
+        uint64_t lo, hi;
+        if (down) {
+            lo = (w + q     < words) ? src[w + q]     : fill;
+            hi = (w + q + 1 < words) ? src[w + q + 1] : fill;
+            dst[w] = b ? (lo >> b) | (hi << (64 - b)) : lo;
+        } else {
+            hi = (w - q     >= 0) ? src[w - q]     : fill;
+            lo = (w - q - 1 >= 0) ? src[w - q - 1] : fill;
+            dst[w] = b ? (hi << b) | (lo >> (64 - b)) : hi;
+        }
+    }
+}
+
+/**
+ * Combine each bit with the next len-1 bits in one direction:
+ * acc[c] = op(x[c .. c+len-1]) when down, op(x[c-len+1 .. c]) otherwise.
+ */
+void rowRun(const uint64_t* x, uint64_t* acc, uint64_t* tmp, int words,
+            int len, bool down, bool erode) {
+    const uint64_t fill = erode ? kAllOnes : 0;
+    std::copy(x, x + words, acc);
+
+    int span = 1;
+    while (span < len) {
+        const int step = std::min(span, len - span);
+        shiftRow(acc, tmp, words, step, down, fill);
+        if (erode) for (int w = 0; w < words; w++) acc[w] &= tmp[w];
+        else       for (int w = 0; w < words; w++) acc[w] |= tmp[w];
+        span += step;
+    }
+}
+
+/** Horizontal pass: window of 2*half+1 columns centred on each pixel. */
+void rowPass(BitMask& m, int half, bool erode) {
+    if (half <= 0) return;
+    const int tail = m.cols % 64;
+    const uint64_t fill = erode ? kAllOnes : 0;
+
+    cv::parallel_for_(cv::Range(0, m.rows), [&](const cv::Range& range) {
+        std::vector<uint64_t> fwd(m.words), bwd(m.words), tmp(m.words);
+        for (int r = range.start; r < range.end; r++) {
+            uint64_t* x = m.row(r);
+            rowRun(x, fwd.data(), tmp.data(), m.words, half + 1, true,  erode);
+            rowRun(x, bwd.data(), tmp.data(), m.words, half + 1, false, erode);
+            if (erode) for (int w = 0; w < m.words; w++) x[w] = fwd[w] & bwd[w];
+            else       for (int w = 0; w < m.words; w++) x[w] = fwd[w] | bwd[w];
+
+            // The backward run carries pixels into the padding bits
+            if (tail) {
+                x[m.words - 1] &= ~(kAllOnes << tail);
+                x[m.words - 1] |= fill & (kAllOnes << tail);
+            }
+        }
+    });
+}
+
+/**
+ * Vertical pass: window of 2*half+1 rows (van Herk / Gil-Werman).
+ *
+ * The column of words is padded by half rows of fill on each side and cut
+ * into blocks of L = 2*half+1 rows.  Within each block, g holds running
+ * values from the block start and h from the block end, so any window
+ * [p, p+L-1] is h[p] op g[p+L-1].
+ */
+void colPass(BitMask& m, int half, bool erode) {
+    if (half <= 0 || m.rows == 0) return;
+    const int      L    = 2 * half + 1;
+    const int      P    = m.rows + 2 * half;
+    const uint64_t fill = erode ? kAllOnes : 0;
+
+    // Split word columns across threads; each keeps its own block buffers
+    cv::parallel_for_(cv::Range(0, m.words), [&](const cv::Range& range) {
+        const int span = range.end - range.start;
+        std::vector<uint64_t> g(static_cast<size_t>(P) * span);
+        std::vector<uint64_t> h(static_cast<size_t>(P) * span);
+        auto value = [&](int p) -> const uint64_t* {
+            const int r = p - half;
+            return (r >= 0 && r < m.rows) ? m.row(r) + range.start : nullptr;
+        };
+
+        for (int p = 0; p < P; p++) {
+            const uint64_t* v    = value(p);
+            uint64_t*       cur  = &g[static_cast<size_t>(p) * span];
+            const uint64_t* prev = (p % L) ? cur - span : nullptr;
+            for (int w = 0; w < span; w++) {
+                const uint64_t x = v ? v[w] : fill;
+                cur[w] = !prev ? x : erode ? (prev[w] & x) : (prev[w] | x);
+            }
+        }
+        for (int p = P - 1; p >= 0; p--) {
+            const uint64_t* v    = value(p);
+            uint64_t*       cur  = &h[static_cast<size_t>(p) * span];
+            const uint64_t* next = (p % L != L - 1 && p + 1 < P) ? cur + span : nullptr;
+            for (int w = 0; w < span; w++) {
+                const uint64_t x = v ? v[w] : fill;
+                cur[w] = !next ? x : erode ? (next[w] & x) : (next[w] | x);
+            }
+        }
+
+        for (int r = 0; r < m.rows; r++) {
+            const uint64_t* a   = &h[static_cast<size_t>(r) * span];
+            const uint64_t* b   = &g[static_cast<size_t>(r + L - 1) * span];
+            uint64_t*       out = m.row(r) + range.start;
+            if (erode) for (int w = 0; w < span; w++) out[w] = a[w] & b[w];
+            else       for (int w = 0; w < span; w++) out[w] = a[w] | b[w];
+        }
+    });
+}
+
+/** Erosion / dilation of a packed mask by a (2*half+1) square. */
+void morphPacked(BitMask& m, int half, bool erode) {
+    rowPass(m, half, erode);
+    colPass(m, half, erode);
+}
+
+/** Switch the padding bits to the identity of the next operation. */
+void setPadding(BitMask& m, uint64_t fill) {
+    const int tail = m.cols % 64;
+    if (!tail) return;
+    const uint64_t pad = kAllOnes << tail;
+    for (int r = 0; r < m.rows; r++) {
+        uint64_t& last = m.row(r)[m.words - 1];
+        last = (last & ~pad) | (fill & pad);
+    }
+}
+
+/** Above this share of tiles to visit the dense pass is as cheap. */
+constexpr double kSparseMaxFraction = 0.5;
+
+/** Erosion / dilation of the active tiles of src into dst, zero elsewhere. */
+void morphTiles(const cv::Mat& src, cv::Mat& dst, int radius, bool erode,
+                const TileOccupancy& tiles, TileOccupancy* dstTiles) {
+    CV_Assert(src.type() == CV_8UC1 && tiles.size() == src.size());
+    radius = std::max(0, radius);
+
+    // Erosion cannot create foreground; dilation reaches radius further
+    const TileOccupancy active = erode ? tiles : tiles.grown(radius);
+    if (active.fraction() > kSparseMaxFraction) {
+        if (erode) erodeBinary(src, dst, radius);
+        else       dilateBinary(src, dst, radius);
+        if (dstTiles) dstTiles->build(dst, &active);
+        return;
+    }
+
+    cv::Mat out;
+    if (!src.empty() && dst.data == src.data) {
+        out.create(src.size(), CV_8UC1);
+    } else {
+        dst.create(src.size(), CV_8UC1);
+        out = dst;
+    }
+    out.setTo(0);
+
+    // Tile rows write disjoint rows of out; the kernel's own parallel_for_
+    // runs serially inside this one
+    const cv::Rect image(0, 0, src.cols, src.rows);
+    cv::parallel_for_(cv::Range(0, active.tileRows()), [&](const cv::Range& range) {
+        std::vector<cv::Range> spans;
+        cv::Mat strip;
+        for (int ty = range.start; ty < range.end; ty++) {
+            active.spans(ty, spans);
+            for (const cv::Range& span : spans) {
+                const cv::Rect rect = active.pixelRect(ty, span.start, span.end);
+                const cv::Rect halo = cv::Rect(rect.x - radius, rect.y - radius,
+                                               rect.width + 2 * radius,
+                                               rect.height + 2 * radius) & image;
+                if (erode) erodeBinary(src(halo), strip, radius);
+                else       dilateBinary(src(halo), strip, radius);
+                strip(rect - halo.tl()).copyTo(out(rect));
+            }
+        }
+    });
+
+    if (out.data != dst.data) dst = out;
+    if (dstTiles) dstTiles->build(dst, &active);
+}
+
+} // namespace
+
+void erodeBinary(const cv::Mat& src, cv::Mat& dst, int radius) {
+    BitMask m;
+    packMask(src, m, kAllOnes);
+    morphPacked(m, std::max(0, radius), true);
+    unpackMask(m, dst);
+}
+
+void dilateBinary(const cv::Mat& src, cv::Mat& dst, int radius) {
+    BitMask m;
+    packMask(src, m, 0);
+    morphPacked(m, std::max(0, radius), false);
+    unpackMask(m, dst);
+}
+
+void openBinary(const cv::Mat& src, cv::Mat& dst, int radius) {
+    BitMask m;
+    packMask(src, m, kAllOnes);
+    morphPacked(m, std::max(0, radius), true);
+    setPadding(m, 0);
+    morphPacked(m, std::max(0, radius), false);
+    unpackMask(m, dst);
+}
+
+void closeBinary(const cv::Mat& src, cv::Mat& dst, int radius) {
+    BitMask m;
+    packMask(src, m, 0);
+    morphPacked(m, std::max(0, radius), false);
+    setPadding(m, kAllOnes);
+    morphPacked(m, std::max(0, radius), true);
+    unpackMask(m, dst);
+}
+
+void erodeBinary(const cv::Mat& src, cv::Mat& dst, int radius,
+                 const TileOccupancy& tiles, TileOccupancy* dstTiles) {
+    morphTiles(src, dst, radius, true, tiles, dstTiles);
+}
+
+void dilateBinary(const cv::Mat& src, cv::Mat& dst, int radius,
+                  const TileOccupancy& tiles, TileOccupancy* dstTiles) {
+    morphTiles(src, dst, radius, false, tiles, dstTiles);
+}
+
+void openBinary(const cv::Mat& src, cv::Mat& dst, int radius,
+                const TileOccupancy& tiles, TileOccupancy* dstTiles) {
+    if (tiles.fraction() > kSparseMaxFraction) {
+        openBinary(src, dst, radius);
+        if (dstTiles) dstTiles->build(dst, &tiles);    // opening only removes
+        return;
+    }
+    cv::Mat       eroded;
+    TileOccupancy erodedTiles;
+    erodeBinary(src, eroded, radius, tiles, &erodedTiles);
+    dilateBinary(eroded, dst, radius, erodedTiles, dstTiles);
+}
+
+void closeBinary(const cv::Mat& src, cv::Mat& dst, int radius,
+                 const TileOccupancy& tiles, TileOccupancy* dstTiles) {
+    if (tiles.fraction() > kSparseMaxFraction) {
+        closeBinary(src, dst, radius);
+        if (dstTiles) {
+            const TileOccupancy reach = tiles.grown(radius);
+            dstTiles->build(dst, &reach);
+        }
+        return;
+    }
+    cv::Mat       dilated;
+    TileOccupancy dilatedTiles;
+    dilateBinary(src, dilated, radius, tiles, &dilatedTiles);
+    erodeBinary(dilated, dst, radius, dilatedTiles, dstTiles);
+}
+
+} // namespace cvcore
@@ -0,0 +1,48 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the row-band tiling layer for parallel kernels.
+*/
+
+#include "cvcore/parallel.hpp"
+#include <algorithm>
+
+namespace cvcore {
+
+int tileBandRows(int rows, size_t bytesPerRow) {
+    if (bytesPerRow == 0) {
+        return std::max(1, rows);
+    }
+
+    int bandRows = static_cast<int>(TILE_BAND_BYTES / bytesPerRow);
+
+    // Very small bands spend more time scheduling than computing
+    bandRows = std::max(bandRows, 8);
+    return std::max(1, std::min(bandRows, rows));
+}
+
+void parallelRowBands(int rows, size_t bytesPerRow,
+                      const std::function<void(const cv::Range &)> &body) {
+    if (rows <= 0) {
+        return;
+    }
+
+    const int bandRows = tileBandRows(rows, bytesPerRow);
+    const int numBands = (rows + bandRows - 1) / bandRows;
+
+    // Single band: run inline and skip the thread pool entirely
+    if (numBands == 1) {
+        body(cv::Range(0, rows));
+        return;
+    }
+
+    cv::parallel_for_(cv::Range(0, numBands), [&](const cv::Range &bands) {
+        for (int b = bands.start; b < bands.end; b++) {
+            int start = b * bandRows;
+            int end = std::min(rows, start + bandRows);
+            body(cv::Range(start, end));
+        }
+    });
+}
+
+} // namespace cvcore
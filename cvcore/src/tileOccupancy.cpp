@@ -0,0 +1,129 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Implementation of the tile occupancy map. Bit tx of word tx / 64
+           of a tile row is tile (ty, tx); bits past the last tile stay 0.
+*/
+
+#include "cvcore/tileOccupancy.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace cvcore {
+
+namespace {
+
+/** True if any of the n bytes at p is nonzero, eight at a time. */
+bool anyNonzero(const uchar* p, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        if (word) return true;
+    }
+    for (; i < n; i++)
+        if (p[i]) return true;
+    return false;
+}
+
+int popcount64(uint64_t x) {
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+}
+
+} // namespace
+
+void TileOccupancy::reset(cv::Size size) {
+    size_     = size;
+    tileRows_ = (size.height + kTileSize - 1) >> kTileShift;
+    tileCols_ = (size.width  + kTileSize - 1) >> kTileShift;
+    words_    = (tileCols_ + 63) / 64;
+    bits_.assign(static_cast<size_t>(tileRows_) * words_, 0);
+}
+
+void TileOccupancy::build(const cv::Mat& mask, const TileOccupancy* within) {
+    CV_Assert(mask.type() == CV_8UC1);
+    CV_Assert(!within || within->size() == mask.size());
+    reset(mask.size());
+
+    // Row by row across the tile row, so the mask is read in memory order;
+    // a tile stops being scanned once a pixel has set it
+    cv::parallel_for_(cv::Range(0, tileRows_), [&](const cv::Range& range) {
+        for (int ty = range.start; ty < range.end; ty++) {
+            uint64_t*       bits   = row(ty);
+            const uint64_t* wanted = within ? within->row(ty) : nullptr;
+            const int r0 = ty << kTileShift;
+            const int r1 = std::min(r0 + kTileSize, size_.height);
+            for (int r = r0; r < r1; r++) {
+                const uchar* p = mask.ptr<uchar>(r);
+                for (int tx = 0; tx < tileCols_; tx++) {
+                    const uint64_t bit = uint64_t(1) << (tx & 63);
+                    if ((bits[tx >> 6] & bit) || (wanted && !(wanted[tx >> 6] & bit)))
+                        continue;
+                    const int c0 = tx << kTileShift;
+                    if (anyNonzero(p + c0, std::min(kTileSize, size_.width - c0)))
+                        bits[tx >> 6] |= bit;
+                }
+            }
+        }
+    });
+}
+
+int TileOccupancy::count() const {
+    int n = 0;
+    for (uint64_t word : bits_) n += popcount64(word);
+    return n;
+}
+
+double TileOccupancy::fraction() const {
+    const int total = tileRows_ * tileCols_;
+    return total > 0 ? double(count()) / total : 0.0;
+}
+
+TileOccupancy TileOccupancy::grown(int radius) const {
+    const int reach = (std::max(0, radius) + kTileSize - 1) >> kTileShift;
+    if (reach == 0) return *this;
+
+    // Separable: widen each tile row, then take the union over tile rows
+    TileOccupancy wide;
+    wide.reset(size_);
+    for (int ty = 0; ty < tileRows_; ty++)
+        for (int tx = 0; tx < tileCols_; tx++)
+            if (test(ty, tx)) {
+                const int x1 = std::min(tx + reach, tileCols_ - 1);
+                for (int x = std::max(0, tx - reach); x <= x1; x++)
+                    wide.row(ty)[x >> 6] |= uint64_t(1) << (x & 63);
+            }
+
+    TileOccupancy out;
+    out.reset(size_);
+    for (int ty = 0; ty < tileRows_; ty++) {
+        const int y1 = std::min(ty + reach, tileRows_ - 1);
+        for (int y = std::max(0, ty - reach); y <= y1; y++)
+            for (int w = 0; w < words_; w++)
+                out.row(ty)[w] |= wide.row(y)[w];
+    }
+    return out;
+}
+
+void TileOccupancy::spans(int ty, std::vector<cv::Range>& spans) const {
+    spans.clear();
+    int tx = 0;
+    while (tx < tileCols_) {
+        if (!test(ty, tx)) { tx++; continue; }
+        const int start = tx;
+        while (tx < tileCols_ && test(ty, tx)) tx++;
+        spans.emplace_back(start, tx);
+    }
+}
+
+cv::Rect TileOccupancy::pixelRect(int ty, int tx0, int tx1) const {
+    const int x0 = tx0 << kTileShift;
+    const int y0 = ty << kTileShift;
+    return cv::Rect(x0, y0,
+                    std::min(tx1 << kTileShift, size_.width) - x0,
+                    std::min(y0 + kTileSize, size_.height) - y0);
+}
+
+} // namespace cvcore
@@ -0,0 +1,280 @@
+/*
+  Author: Krushna Sanjay Sharma
+  Date: March 2026
+  Purpose: Linux V4L2 camera source reading memory-mapped driver buffers.
+           The dequeued buffer is wrapped as a cv::Mat without a copy (Frame::raw)
+           and converted straight into the caller's BGR image; it goes back to
+           the driver on the next read. Only built when linux/videodev2.h is
+           available (CVCORE_WITH_V4L2).
+*/
+
+#include "cvcore/capture.hpp"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace cvcore {
+
+namespace {
+
+const int V4L2_BUFFERS = 4;
+const int V4L2_TIMEOUT_MS = 2000;
+
+int xioctl(int fd, unsigned long request, void *arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+/// Pixel formats we convert, in order of preference
+const uint32_t SUPPORTED_FORMATS[] = {
+    V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_UYVY, V4L2_PIX_FMT_BGR24,
+    V4L2_PIX_FMT_RGB24, V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_MJPEG,
+};
+
+class V4l2Source : public FrameSource {
+public:
+    explicit V4l2Source(const std::string &device) : FrameSource(Kind::Camera), device_(device) {}
+
+    ~V4l2Source() override { close(); }
+
+    bool reopen() override {
+        close();
+        fd_ = ::open(device_.c_str(), O_RDWR | O_NONBLOCK);
+        if (fd_ < 0) {
+            return false;
+        }
+        if (!configure() || !mapBuffers() || !start()) {
+            close();
+            return false;
+        }
+        char fourcc[5] = {0};
+        std::memcpy(fourcc, &format_.pixelformat, 4);
+        description_ = device_ + " (V4L2 mmap, " + fourcc + ")";
+        return true;
+    }
+
+    bool read(Frame &frame) override {
+        requeue();
+        frame.raw.release();
+
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready;
+        do {
+            ready = poll(&pfd, 1, V4L2_TIMEOUT_MS);
+        } while (ready == -1 && errno == EINTR);
+        if (ready <= 0) {
+            return false;
+        }
+
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
+            return false;
+        }
+        held_ = static_cast<int>(buf.index);
+
+        uchar *data = static_cast<uchar *>(buffers_[buf.index].start);
+        const int w = static_cast<int>(format_.width);
+        const int h = static_cast<int>(format_.height);
+        const size_t step = format_.bytesperline;
+
+        switch (format_.pixelformat) {
+        case V4L2_PIX_FMT_YUYV:
+            frame.raw = cv::Mat(h, w, CV_8UC2, data, step);
+            cv::cvtColor(frame.raw, frame.image, cv::COLOR_YUV2BGR_YUYV);
+            break;
+        case V4L2_PIX_FMT_UYVY:
+            frame.raw = cv::Mat(h, w, CV_8UC2, data, step);
+            cv::cvtColor(frame.raw, frame.image, cv::COLOR_YUV2BGR_UYVY);
+            break;
+        case V4L2_PIX_FMT_BGR24:
+            frame.raw = cv::Mat(h, w, CV_8UC3, data, step);
+            frame.raw.copyTo(frame.image);
+            break;
+        case V4L2_PIX_FMT_RGB24:
+            frame.raw = cv::Mat(h, w, CV_8UC3, data, step);
+            cv::cvtColor(frame.raw, frame.image, cv::COLOR_RGB2BGR);
+            break;
+        case V4L2_PIX_FMT_GREY:
+            frame.raw = cv::Mat(h, w, CV_8UC1, data, step);
+            cv::cvtColor(frame.raw, frame.image, cv::COLOR_GRAY2BGR);
+            break;
+        default:  // MJPEG: compressed payload of buf.bytesused bytes
+            frame.raw = cv::Mat(1, static_cast<int>(buf.bytesused), CV_8UC1, data);
+            cv::imdecode(frame.raw, cv::IMREAD_COLOR, &frame.image);
+            break;
+        }
+        if (frame.image.empty()) {
+            return false;
+        }
+
+        const double deviceMs = buf.timestamp.tv_sec * 1000.0 + buf.timestamp.tv_usec / 1000.0;
+        stamp(frame, deviceMs > 0.0 ? deviceMs : -1.0);
+        return true;
+    }
+
+    cv::Size frameSize() const override {
+        return cv::Size(static_cast<int>(format_.width), static_cast<int>(format_.height));
+    }
+
+    double fps() const override { return fps_; }
+
+private:
+    struct Buffer {
+        void *start = MAP_FAILED;
+        size_t length = 0;
+    };
+
+    // Keep the driver's current size, pick the first supported pixel format
+    bool configure() {
+        v4l2_capability cap{};
+        if (xioctl(fd_, VIDIOC_QUERYCAP, &cap) < 0 ||
+            !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+            !(cap.capabilities & V4L2_CAP_STREAMING)) {
+            return false;
+        }
+
+        v4l2_format fmt{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(fd_, VIDIOC_G_FMT, &fmt) < 0) {
+            return false;
+        }
+        for (uint32_t pixelformat : SUPPORTED_FORMATS) {
+            v4l2_format trial = fmt;
+            trial.fmt.pix.pixelformat = pixelformat;
+            trial.fmt.pix.field = V4L2_FIELD_NONE;
+            if (xioctl(fd_, VIDIOC_S_FMT, &trial) == 0 &&
+                trial.fmt.pix.pixelformat == pixelformat) {
+                format_ = trial.fmt.pix;
+                break;
+            }
+        }
+        if (format_.pixelformat == 0) {
+            return false;
+        }
+        if (format_.bytesperline == 0) {
+            format_.bytesperline = format_.width *
+                (format_.pixelformat == V4L2_PIX_FMT_GREY ? 1 :
+                 format_.pixelformat == V4L2_PIX_FMT_BGR24 ||
+                 format_.pixelformat == V4L2_PIX_FMT_RGB24 ? 3 : 2);
+        }
+
+        v4l2_streamparm parm{};
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(fd_, VIDIOC_G_PARM, &parm) == 0 &&
+            parm.parm.capture.timeperframe.numerator > 0) {
+            fps_ = static_cast<double>(parm.parm.capture.timeperframe.denominator) /
+                   parm.parm.capture.timeperframe.numerator;
+        }
+        return true;
+    }
+
+    bool mapBuffers() {
+        v4l2_requestbuffers req{};
+        req.count = V4L2_BUFFERS;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd_, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+            return false;
+        }
+
+        buffers_.resize(req.count);
+        for (unsigned i = 0; i < req.count; i++) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
+                return false;
+            }
+            buffers_[i].length = buf.length;
+            buffers_[i].start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED, fd_, buf.m.offset);
+            if (buffers_[i].start == MAP_FAILED) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool start() {
+        for (unsigned i = 0; i < buffers_.size(); i++) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
+                return false;
+            }
+        }
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        streaming_ = xioctl(fd_, VIDIOC_STREAMON, &type) == 0;
+        return streaming_;
+    }
+
+    // Give the buffer behind the previous frame back to the driver
+    void requeue() {
+        if (held_ < 0) {
+            return;
+        }
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = static_cast<unsigned>(held_);
+        xioctl(fd_, VIDIOC_QBUF, &buf);
+        held_ = -1;
+    }
+
+    void close() {
+        if (fd_ < 0) {
+            return;
+        }
+        if (streaming_) {
+            v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(fd_, VIDIOC_STREAMOFF, &type);
+            streaming_ = false;
+        }
+        for (Buffer &b : buffers_) {
+            if (b.start != MAP_FAILED) {
+                munmap(b.start, b.length);
+            }
+        }
+        buffers_.clear();
+        ::close(fd_);
+        fd_ = -1;
+        held_ = -1;
+        format_ = v4l2_pix_format{};
+    }
+
+    std::string device_;
+    int fd_ = -1;
+    v4l2_pix_format format_{};
+    double fps_ = 0.0;
+    std::vector<Buffer> buffers_;
+    int held_ = -1;            ///< Buffer index behind the last frame, -1 if none
+    bool streaming_ = false;
+};
+
+} // namespace
+
+std::unique_ptr<FrameSource> openV4l2Source(const std::string &device) {
+    auto source = std::make_unique<V4l2Source>(device);
+    if (!source->reopen()) {
+        return nullptr;
+    }
+    return source;
+}
+
+} // namespace cvcore